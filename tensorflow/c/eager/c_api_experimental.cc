@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/c/eager/c_api_experimental.h"
 
+#include <memory>
 #include <vector>
 
 #include "absl/strings/match.h"
@@ -28,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/lazy_graph.h"
 #include "tensorflow/core/distributed_runtime/coordination/coordination_service_error_util.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
@@ -53,6 +55,20 @@ void TFE_OpReset(TFE_Op* op_to_reset, const char* op_or_function_name,
   }
 }
 
+TFE_OpAttrsToken TFE_OpGetAttrsToken(TFE_Op* op) {
+  tensorflow::Fprint128 fingerprint =
+      tensorflow::OperationFromInterface(tensorflow::unwrap(op))
+          ->MutableAttrs()
+          ->AttrsFingerprint();
+  return {fingerprint.low64, fingerprint.high64};
+}
+
+void TFE_OpSetAttrsToken(TFE_Op* op, TFE_OpAttrsToken token) {
+  tensorflow::OperationFromInterface(tensorflow::unwrap(op))
+      ->MutableAttrs()
+      ->SetAttrsFingerprint({token.low, token.high});
+}
+
 void TFE_ContextEnableGraphCollection(TFE_Context* ctx) {
   tensorflow::unwrap(ctx)->SetShouldStoreGraphs(true);
 }
@@ -601,6 +617,19 @@ TFE_Executor* TFE_ContextGetExecutorForThread(TFE_Context* ctx) {
   return new TFE_Executor(&tensorflow::unwrap(ctx)->Executor());
 }
 
+void TFE_ContextSetLazyExecution(TFE_Context* ctx, unsigned char enable,
+                                 TF_Status* status) {
+  tensorflow::EagerContext* context =
+      tensorflow::ContextFromInterface(tensorflow::unwrap(ctx));
+  if (enable) {
+    context->EnableLazyExecution(
+        std::make_unique<tensorflow::LazyGraph>(context));
+    status->status = ::tensorflow::OkStatus();
+  } else {
+    status->status = context->DisableLazyExecution();
+  }
+}
+
 void TFE_HostAddressSpace(TFE_Context* ctx, TF_Buffer* buf) {
   auto address_space = tensorflow::DeviceNameUtils::AddressSpace(
       tensorflow::unwrap(ctx)->HostCPUParsedName());
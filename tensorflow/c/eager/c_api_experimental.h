@@ -34,6 +34,26 @@ TF_CAPI_EXPORT extern void TFE_OpReset(TFE_Op* op_to_reset,
                                        const char* raw_device_name,
                                        TF_Status* status);
 
+// A precomputed fingerprint of the name and attributes of an op. A call site
+// that repeatedly executes the same op with the same attributes can fetch it
+// once, and set it on later executions so that the attributes are not
+// fingerprinted again when looking up the cached kernel.
+typedef struct TFE_OpAttrsToken {
+  uint64_t low;
+  uint64_t high;
+} TFE_OpAttrsToken;
+
+// Returns the token for the name of `op` and the attributes set so far.
+TF_CAPI_EXPORT extern TFE_OpAttrsToken TFE_OpGetAttrsToken(TFE_Op* op);
+
+// Makes `op` use `token` instead of fingerprinting its name and attributes.
+// Must be called after all attributes of `op` have been set, since setting an
+// attribute discards the token. `token` must have been returned by
+// TFE_OpGetAttrsToken for an op with the same name and attributes, otherwise
+// the wrong kernel may be executed.
+TF_CAPI_EXPORT extern void TFE_OpSetAttrsToken(TFE_Op* op,
+                                               TFE_OpAttrsToken token);
+
 // Enables only graph collection in RunMetadata on the functions executed from
 // this context.
 TF_CAPI_EXPORT extern void TFE_ContextEnableGraphCollection(TFE_Context* ctx);
@@ -380,6 +400,18 @@ TF_CAPI_EXPORT extern void TFE_ContextSetExecutorForThread(TFE_Context*,
 TF_CAPI_EXPORT extern TFE_Executor* TFE_ContextGetExecutorForThread(
     TFE_Context*);
 
+// Enables or disables lazy execution. While it is enabled, stateless ops on
+// local devices are not executed when they are issued, but recorded and later
+// executed together as a single function, once one of their outputs is needed
+// or when too many ops have been recorded. Errors of recorded ops are then
+// reported when their outputs are used.
+//
+// Disabling lazy execution executes the ops that have been recorded, and sets
+// `status` to their error, if any.
+TF_CAPI_EXPORT extern void TFE_ContextSetLazyExecution(TFE_Context* ctx,
+                                                       unsigned char enable,
+                                                       TF_Status* status);
+
 // -----------------------------------------------------------------------------
 // Dynamic cluster API.
 
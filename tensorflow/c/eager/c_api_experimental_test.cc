@@ -365,6 +365,92 @@ void Executor_MatMul_CPU(bool async) {
   EXPECT_EQ(22, product[3]);
   TF_DeleteStatus(status);
 }
+TEST(CAPI, AttrsToken) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* m = TestMatrixTensorHandle(ctx);
+  TFE_Op* matmul = MatMulOp(ctx, m, m);
+  TFE_OpAttrsToken token = TFE_OpGetAttrsToken(matmul);
+  TFE_Op* other_matmul = MatMulOp(ctx, m, m);
+  TFE_OpAttrsToken other_token = TFE_OpGetAttrsToken(other_matmul);
+  EXPECT_EQ(token.low, other_token.low);
+  EXPECT_EQ(token.high, other_token.high);
+  TFE_OpSetAttrBool(other_matmul, "transpose_a", true);
+  other_token = TFE_OpGetAttrsToken(other_matmul);
+  EXPECT_NE(token.low, other_token.low);
+  TFE_DeleteOp(other_matmul);
+
+  TFE_OpSetAttrsToken(matmul, token);
+  TFE_TensorHandle* retvals[1] = {nullptr};
+  int num_retvals = 1;
+  TFE_Execute(matmul, &retvals[0], &num_retvals, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteOp(matmul);
+  TFE_DeleteTensorHandle(m);
+
+  TF_Tensor* t = TFE_TensorHandleResolve(retvals[0], status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteTensorHandle(retvals[0]);
+  TFE_DeleteContext(ctx);
+  float product[4] = {0};
+  EXPECT_EQ(sizeof(product), TF_TensorByteSize(t));
+  memcpy(&product[0], TF_TensorData(t), TF_TensorByteSize(t));
+  TF_DeleteTensor(t);
+  EXPECT_EQ(7, product[0]);
+  EXPECT_EQ(22, product[3]);
+  TF_DeleteStatus(status);
+}
+
+TEST(CAPI, LazyExecution) {
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+  TFE_ContextSetLazyExecution(ctx, true, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  TFE_TensorHandle* m = TestMatrixTensorHandle(ctx);
+  TFE_TensorHandle* square = nullptr;
+  int num_retvals = 1;
+  TFE_Op* matmul = MatMulOp(ctx, m, m);
+  TFE_Execute(matmul, &square, &num_retvals, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteOp(matmul);
+  // The shape is inferred without executing the op.
+  EXPECT_EQ(2, TFE_TensorHandleNumDims(square, status));
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+
+  TFE_TensorHandle* cube = nullptr;
+  matmul = MatMulOp(ctx, square, m);
+  TFE_Execute(matmul, &cube, &num_retvals, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteOp(matmul);
+  TFE_DeleteTensorHandle(square);
+  TFE_DeleteTensorHandle(m);
+
+  TF_Tensor* t = TFE_TensorHandleResolve(cube, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteTensorHandle(cube);
+  float product[4] = {0};
+  EXPECT_EQ(sizeof(product), TF_TensorByteSize(t));
+  memcpy(&product[0], TF_TensorData(t), TF_TensorByteSize(t));
+  TF_DeleteTensor(t);
+  EXPECT_EQ(37, product[0]);
+  EXPECT_EQ(54, product[1]);
+  EXPECT_EQ(81, product[2]);
+  EXPECT_EQ(118, product[3]);
+
+  TFE_ContextSetLazyExecution(ctx, false, status);
+  ASSERT_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContext(ctx);
+  TF_DeleteStatus(status);
+}
+
 TEST(CAPI, Executor_MatMul_CPU) { Executor_MatMul_CPU(false); }
 TEST(CAPI, Executor_MatMul_CPUAsync) { Executor_MatMul_CPU(true); }
 
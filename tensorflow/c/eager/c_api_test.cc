@@ -149,6 +149,43 @@ void BM_Execute_Identity(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Execute_Identity)->Arg(0)->Arg(1);
 
+// Measures the per-op dispatch cost of a call site that reuses the token of
+// its op's attributes, compared to one that does not.
+void BM_Execute_AttrsToken(::testing::benchmark::State& state) {
+  const int use_token = state.range(0);
+  state.SetLabel(use_token ? "ExecuteWithAttrsToken" : "ExecuteWithoutToken");
+  TF_Status* status = TF_NewStatus();
+  TFE_ContextOptions* opts = TFE_NewContextOptions();
+  TFE_Context* ctx = TFE_NewContext(opts, status);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TFE_DeleteContextOptions(opts);
+
+  TFE_TensorHandle* m = TestMatrixTensorHandle(ctx);
+  TFE_Op* matmul = MatMulOp(ctx, m, m);
+  // The attributes of `matmul` are the ones inferred from its inputs.
+  const TFE_OpAttrsToken token = TFE_OpGetAttrsToken(matmul);
+  TFE_TensorHandle* retvals[1];
+  int num_retvals = 1;
+  for (auto s : state) {
+    TFE_OpReset(matmul, "MatMul", nullptr, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpAddInput(matmul, m, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_OpAddInput(matmul, m, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    if (use_token) TFE_OpSetAttrsToken(matmul, token);
+    TFE_Execute(matmul, &retvals[0], &num_retvals, status);
+    CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+    TFE_DeleteTensorHandle(retvals[0]);
+  }
+  TFE_DeleteOp(matmul);
+  TFE_DeleteTensorHandle(m);
+  TFE_DeleteContext(ctx);
+  CHECK_EQ(TF_OK, TF_GetCode(status)) << TF_Message(status);
+  TF_DeleteStatus(status);
+}
+BENCHMARK(BM_Execute_AttrsToken)->Arg(0)->Arg(1);
+
 TEST(CAPI, Context) {
   TF_Status* status = TF_NewStatus();
   TFE_ContextOptions* opts = TFE_NewContextOptions();
@@ -86,6 +86,17 @@ auto* checkpoint_read_durations = monitoring::Sampler<1>::New(
     // Scale of 1000, growth factor of 1.5 with upper bound of ~184 minutes.
     monitoring::Buckets::Exponential(1000, 1.5, 41));
 
+// Distribution of checkpoint read throughputs.
+auto* checkpoint_read_throughputs = monitoring::Sampler<1>::New(
+    {
+        "/tensorflow/core/checkpoint/read/read_throughput",  // Metric name.
+        "Distribution of the throughput in megabytes per second of the "
+        "checkpoint read operation.",  // Metric description.
+        "api_label"                    // Cell label.
+    },
+    // Scale of 1, growth factor of 1.5 with upper bound of ~2 TB/s.
+    monitoring::Buckets::Exponential(1, 1.5, 36));
+
 // Distribution of async checkpoint write durations.
 auto* async_checkpoint_write_durations = monitoring::Sampler<1>::New(
     {
@@ -146,6 +157,11 @@ monitoring::SamplerCell& CheckpointReadDuration(absl::string_view api_label) {
   return *checkpoint_read_durations->GetCell(std::string(api_label));
 }
 
+monitoring::SamplerCell& CheckpointReadThroughput(
+    absl::string_view api_label) {
+  return *checkpoint_read_throughputs->GetCell(std::string(api_label));
+}
+
 monitoring::SamplerCell& CheckpointWriteDuration(absl::string_view api_label) {
   return *checkpoint_write_durations->GetCell(std::string(api_label));
 }
@@ -63,6 +63,10 @@ monitoring::CounterCell& SavedModelReadApi(absl::string_view api_label);
 // field `api_label`.
 monitoring::SamplerCell& CheckpointReadDuration(absl::string_view api_label);
 
+// Returns "/tensorflow/core/checkpoint/read/read_throughput" cell belonging to
+// field `api_label`. Samples are in megabytes per second.
+monitoring::SamplerCell& CheckpointReadThroughput(absl::string_view api_label);
+
 // Returns "/tensorflow/core/checkpoint/write/write_durations" cell belonging to
 // field `api_label`.
 monitoring::SamplerCell& CheckpointWriteDuration(absl::string_view api_label);
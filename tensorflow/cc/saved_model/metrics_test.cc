@@ -49,6 +49,12 @@ TEST(MetricsTest, TestCheckpointRead) {
   EXPECT_EQ(CheckpointReadDuration("foo").value().num(), 1);
 }
 
+TEST(MetricsTest, TestCheckpointReadThroughput) {
+  EXPECT_EQ(CheckpointReadThroughput("foo").value().num(), 0);
+  CheckpointReadThroughput("foo").Add(100);
+  EXPECT_EQ(CheckpointReadThroughput("foo").value().num(), 1);
+}
+
 TEST(MetricsTest, TestCheckpointWrite) {
   EXPECT_EQ(CheckpointWriteDuration("foo").value().num(), 0);
   CheckpointWriteDuration("foo").Add(100);
@@ -389,6 +389,23 @@ TEST_F(LoaderTest, UpdateMetricsV1) {
   EXPECT_EQ(metrics::SavedModelReadApi(kCCLoadLabel).value(), api_count + 1);
 }
 
+TEST_F(LoaderTest, UpdateCheckpointReadMetrics) {
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+  const string kCCLoadLabel = "cc_load";
+
+  const int64_t read_count =
+      metrics::CheckpointReadDuration(kCCLoadLabel).value().num();
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  TF_ASSERT_OK(LoadSavedModel(session_options, run_options, export_dir,
+                              {kSavedModelTagServe}, &bundle));
+
+  EXPECT_EQ(metrics::CheckpointReadDuration(kCCLoadLabel).value().num(),
+            read_count + 1);
+}
+
 TEST_F(LoaderTest, UpdateFingerprintMetrics) {
   SavedModelBundle bundle;
   SessionOptions session_options;
@@ -0,0 +1,107 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warmup_artifacts.h"
+
+#include <string>
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kWarmupArtifactsDirectory[] = "warmup_artifacts";
+constexpr char kAutotuneMapsFilename[] = "autotune_maps.pb";
+constexpr char kGrapplerDirectory[] = "grappler";
+constexpr char kXlaDirectory[] = "xla";
+
+}  // namespace
+
+std::string GetWarmupArtifactsDirectory(const std::string& export_dir) {
+  return io::JoinPath(export_dir, kSavedModelAssetsExtraDirectory,
+                      kWarmupArtifactsDirectory);
+}
+
+Status LoadWarmupArtifacts(const std::string& export_dir) {
+  Env* env = Env::Default();
+  const std::string dir = GetWarmupArtifactsDirectory(export_dir);
+
+  // XLA executables are read from, and new ones written to, the directory of
+  // the model being warmed up. The flag is process-wide, so the first model
+  // wins if several are loaded.
+  std::string& xla_cache_dir =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_directory;
+  if (xla_cache_dir.empty()) {
+    xla_cache_dir = io::JoinPath(dir, kXlaDirectory);
+  } else {
+    VLOG(1) << "Keeping the XLA persistent cache in " << xla_cache_dir;
+  }
+
+  if (!env->IsDirectory(dir).ok()) {
+    VLOG(1) << "No warmup artifacts in " << dir;
+    return OkStatus();
+  }
+
+  const std::string autotune_maps_path =
+      io::JoinPath(dir, kAutotuneMapsFilename);
+  if (env->FileExists(autotune_maps_path).ok()) {
+    std::string autotune_maps;
+    TF_RETURN_IF_ERROR(
+        ReadFileToString(env, autotune_maps_path, &autotune_maps));
+    TF_RETURN_IF_ERROR(LoadSerializedAutotuneMaps(autotune_maps));
+  }
+
+  grappler::MetaOptimizerCache* grappler_cache =
+      grappler::MetaOptimizerCache::Global();
+  const std::string grappler_dir = io::JoinPath(dir, kGrapplerDirectory);
+  if (grappler_cache != nullptr && env->IsDirectory(grappler_dir).ok()) {
+    TF_RETURN_IF_ERROR(grappler_cache->Import(grappler_dir));
+  }
+
+  LOG(INFO) << "Loaded the warmup artifacts in " << dir;
+  return OkStatus();
+}
+
+Status SaveWarmupArtifacts(const std::string& export_dir) {
+  Env* env = Env::Default();
+  const std::string dir = GetWarmupArtifactsDirectory(export_dir);
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+
+  std::string autotune_maps;
+  TF_RETURN_IF_ERROR(SerializeAutotuneMaps(&autotune_maps));
+  TF_RETURN_IF_ERROR(WriteStringToFile(
+      env, io::JoinPath(dir, kAutotuneMapsFilename), autotune_maps));
+
+  grappler::MetaOptimizerCache* grappler_cache =
+      grappler::MetaOptimizerCache::Global();
+  if (grappler_cache != nullptr) {
+    TF_RETURN_IF_ERROR(
+        grappler_cache->Export(io::JoinPath(dir, kGrapplerDirectory)));
+  } else {
+    VLOG(1) << "Not saving the Grappler graphs, since its cache is disabled";
+  }
+
+  LOG(INFO) << "Saved the warmup artifacts in " << dir;
+  return OkStatus();
+}
+
+}  // namespace tensorflow
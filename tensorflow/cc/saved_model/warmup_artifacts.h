@@ -0,0 +1,56 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Persists what warming up a SavedModel computes, so that a cold replica of a
+// model server reaches steady-state latency without recompiling XLA clusters,
+// re-autotuning convolutions or re-running Grappler. The artifacts live next to
+// the model:
+//
+//   <export_dir>/assets.extra/warmup_artifacts/
+//       autotune_maps.pb  Convolution autotune maps, see autotune_serialize.h.
+//       grappler/         Graphs optimized by Grappler, if its cache is
+//                         enabled, see meta_optimizer_cache.h.
+//       xla/              XLA executables, see device_executable_persistor.h.
+//
+// A model server calls LoadWarmupArtifacts() before loading the SavedModel and
+// replaying its warmup requests, then SaveWarmupArtifacts() once they ran.
+
+#ifndef TENSORFLOW_CC_SAVED_MODEL_WARMUP_ARTIFACTS_H_
+#define TENSORFLOW_CC_SAVED_MODEL_WARMUP_ARTIFACTS_H_
+
+#include <string>
+
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// Returns the directory of the warmup artifacts of the SavedModel in
+// `export_dir`.
+std::string GetWarmupArtifactsDirectory(const std::string& export_dir);
+
+// Loads the warmup artifacts of the SavedModel in `export_dir` into the
+// process-wide caches, and points the XLA persistent cache at them unless
+// --tf_xla_persistent_cache_directory is already set. Returns OK if the model
+// has no artifacts yet.
+Status LoadWarmupArtifacts(const std::string& export_dir);
+
+// Saves the warmup artifacts of the SavedModel in `export_dir`. The XLA
+// executables are already written by the XLA persistent cache as the clusters
+// are compiled.
+Status SaveWarmupArtifacts(const std::string& export_dir);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CC_SAVED_MODEL_WARMUP_ARTIFACTS_H_
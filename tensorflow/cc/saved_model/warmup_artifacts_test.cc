@@ -0,0 +1,61 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/cc/saved_model/warmup_artifacts.h"
+
+#include <string>
+
+#include "tensorflow/cc/saved_model/constants.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WarmupArtifactsTest, Directory) {
+  EXPECT_EQ(GetWarmupArtifactsDirectory("/models/m/1"),
+            io::JoinPath("/models/m/1", kSavedModelAssetsExtraDirectory,
+                         "warmup_artifacts"));
+}
+
+TEST(WarmupArtifactsTest, SaveAndLoad) {
+  const std::string export_dir =
+      io::JoinPath(testing::TmpDir(), "warmup_artifacts_model");
+  std::string& xla_cache_dir =
+      GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_directory;
+  xla_cache_dir.clear();
+
+  // A model without artifacts.
+  TF_ASSERT_OK(LoadWarmupArtifacts(export_dir));
+  const std::string dir = GetWarmupArtifactsDirectory(export_dir);
+  EXPECT_EQ(xla_cache_dir, io::JoinPath(dir, "xla"));
+
+  TF_ASSERT_OK(SaveWarmupArtifacts(export_dir));
+  TF_EXPECT_OK(
+      Env::Default()->FileExists(io::JoinPath(dir, "autotune_maps.pb")));
+  TF_ASSERT_OK(LoadWarmupArtifacts(export_dir));
+
+  // An XLA cache directory set explicitly is kept.
+  xla_cache_dir = "/xla_cache";
+  TF_ASSERT_OK(LoadWarmupArtifacts(export_dir));
+  EXPECT_EQ(xla_cache_dir, "/xla_cache");
+  xla_cache_dir.clear();
+}
+
+}  // namespace
+}  // namespace tensorflow
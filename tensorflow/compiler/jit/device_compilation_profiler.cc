@@ -55,6 +55,7 @@ void RegisterExecutionForCluster(
             << " as megamorphic, compile_count=" << stats->compile_count
             << " execution_count=" << stats->execution_count;
     stats->is_megamorphic = true;
+    metrics::RecordXlaMegamorphicCluster();
   }
 }
 
@@ -89,6 +90,15 @@ void DeviceCompilationProfiler::RegisterExecution(
   RegisterExecutionForCluster(function, &it->second);
 }
 
+void DeviceCompilationProfiler::RegisterFallback(
+    const NameAttrList& function) {
+  mutex_lock lock(cluster_compile_stats_mu_);
+  auto it =
+      cluster_compile_stats_.emplace(function.name(), ClusterCompileStats{})
+          .first;
+  it->second.fallback_count++;
+}
+
 Status DeviceCompilationProfiler::RegisterCompilation(
     const NameAttrList& function, int64_t compile_time_us,
     bool used_persistent_cache) {
@@ -105,6 +115,7 @@ Status DeviceCompilationProfiler::RegisterCompilation(
   const uint64 compile_time_s = compile_time_us / 1.0e6;
   it->second.compile_count++;
   it->second.cumulative_compile_time_us += compile_time_us;
+  if (it->second.compile_count > 1) metrics::RecordXlaRecompilation();
   VLOG(1) << "Compiled " << function_name << " " << it->second.compile_count
           << " times, compile time: " << compile_time_us
           << " us, cumulative: " << it->second.cumulative_compile_time_us
@@ -40,6 +40,10 @@ class DeviceCompilationProfiler : public ResourceBase {
     // Cumulative time spent compiling the cluster.
     int64_t cumulative_compile_time_us = 0;
 
+    // Number of executions that ran the cluster's TensorFlow ops because no
+    // executable was available, e.g. while it compiled in the background.
+    int64_t fallback_count = 0;
+
     // True if we have decided that this cluster is too dynamic (i.e. its shapes
     // change too frequently) to profitably JIT compile.  Once a cluster is
     // tagged megamorphic, it stays megamorphic forever.
@@ -50,7 +54,7 @@ class DeviceCompilationProfiler : public ResourceBase {
           "DeviceCompilationProfiler::ClusterCompileStats {compile_count=",
           compile_count, ", execution_count=", execution_count,
           ", cumulative_compile_time_us=", cumulative_compile_time_us,
-          ", is_megamorphic=", is_megamorphic, "}");
+          ", fallback_count=", fallback_count, ", is_megamorphic=", is_megamorphic, "}");
     }
   };
 
@@ -77,6 +81,11 @@ class DeviceCompilationProfiler : public ResourceBase {
                              int64_t compile_time_us,
                              bool used_persistent_cache);
 
+  // Registers an execution of the cluster that runs its TensorFlow ops instead
+  // of an executable, because the cluster is not compiled (yet) for the
+  // signature.
+  void RegisterFallback(const NameAttrList& function);
+
   void IncrementOngoingAsyncCompilations();
   void DecrementOngoingAsyncCompilations();
   int64_t GetNumOngoingAsyncCompilations() const;
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/tests/xla_compilation_cache_test_helper.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/lib/monitoring/cell_reader.h"
 
 namespace tensorflow {
 namespace {
@@ -42,6 +43,23 @@ TEST(DeviceCompilationProfilerTest, RegisterExecution) {
   EXPECT_EQ(stats.execution_count, 5);
 }
 
+TEST(DeviceCompilationProfilerTest, RegisterFallback) {
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  for (int i = 0; i < 3; ++i) {
+    profiler->RegisterExecution(function);
+    profiler->RegisterFallback(function);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(auto stats, profiler->GetCompileStats(function));
+  EXPECT_EQ(stats.execution_count, 3);
+  EXPECT_EQ(stats.fallback_count, 3);
+  EXPECT_EQ(stats.compile_count, 0);
+}
+
 TEST(DeviceCompilationProfilerTest, RegisterCompilation) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
@@ -81,6 +99,30 @@ TEST(DeviceCompilationProfilerTest, RegisterCompilation) {
   }
 }
 
+TEST(DeviceCompilationProfilerTest, RecompilationMetrics) {
+  monitoring::testing::CellReader<int64_t> recompilations(
+      "/tensorflow/core/xla_recompilations");
+  monitoring::testing::CellReader<int64_t> megamorphic_clusters(
+      "/tensorflow/core/xla_megamorphic_clusters");
+  DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
+  core::ScopedUnref profiler_ref(profiler);
+
+  NameAttrList function;
+  function.set_name("TestFunc");
+
+  // The first compilation is not a recompilation.
+  const int64_t kCompileThreshold = 10;
+  for (int i = 0; i < kCompileThreshold + 1; ++i) {
+    EXPECT_TRUE(profiler->RegisterCompilation(function, 1, false).ok());
+  }
+  EXPECT_EQ(recompilations.Delta(), kCompileThreshold);
+
+  // Marking the cluster megamorphic is recorded once.
+  profiler->RegisterExecution(function);
+  profiler->RegisterExecution(function);
+  EXPECT_EQ(megamorphic_clusters.Delta(), 1);
+}
+
 TEST(DeviceCompilationProfilerTest, OngoingAsyncCompilations) {
   DeviceCompilationProfiler* profiler = new DeviceCompilationProfiler();
   core::ScopedUnref profiler_ref(profiler);
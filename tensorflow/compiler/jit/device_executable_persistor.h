@@ -16,16 +16,24 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 #define TENSORFLOW_COMPILER_JIT_DEVICE_EXECUTABLE_PERSISTOR_H_
 
+#include <algorithm>
 #include <optional>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/compiler/xla/service/hlo.pb.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -36,6 +44,12 @@ namespace tensorflow {
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
 // (if one was provided during construction) on disk  using `ClientType`.
+//
+// Entries are keyed by the fingerprints of the cluster signature, the HLO and
+// the XLA compiler flags, and by the device type, so processes sharing a
+// directory, e.g. the replicas of a model server, compile each cluster once.
+// Entries are written to a temporary file and renamed into place, so
+// concurrent readers and writers never see partial entries.
 template <typename ExecutableType, typename ClientType>
 class DeviceExecutablePersistor {
  public:
@@ -44,10 +58,12 @@ class DeviceExecutablePersistor {
     Config() = default;
     explicit Config(absl::string_view persistent_cache_directory,
                     bool disable_strict_signature_checks,
-                    absl::string_view persistence_prefix)
+                    absl::string_view persistence_prefix,
+                    int64_t persistent_cache_max_bytes = 0)
         : persistent_cache_directory(persistent_cache_directory),
           disable_strict_signature_checks(disable_strict_signature_checks),
-          persistence_prefix(persistence_prefix) {}
+          persistence_prefix(persistence_prefix),
+          persistent_cache_max_bytes(persistent_cache_max_bytes) {}
 
     // If non-empty, JIT-compiled executables are saved to and loaded from the
     // specified file system directory path.
@@ -59,6 +75,11 @@ class DeviceExecutablePersistor {
 
     // The cache persistence prefix to use if serializing/deserialzing entries.
     std::string persistence_prefix;
+
+    // If positive, the least recently written entries with
+    // `persistence_prefix` are deleted after persisting an entry, until the
+    // remaining ones take up at most this many bytes.
+    int64_t persistent_cache_max_bytes = 0;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -111,6 +132,10 @@ class DeviceExecutablePersistor {
   // construction of this class. Overwrites existing entries.
   Status SaveSerializedEntry(const XlaSerializedCacheEntry& entry) const;
 
+  // Deletes the oldest entries with `persistence_prefix_` until the remaining
+  // ones take up at most `persistent_cache_max_bytes_`.
+  Status EvictEntries() const;
+
   // Tries to read a cache entry given a `key` by searching the file directory
   // supplied during the construction of this class. Returns std::nullopt if no
   // cache entry is found.
@@ -129,6 +154,10 @@ class DeviceExecutablePersistor {
   const DeviceType device_type_;
   const bool disable_strict_signature_checks_;
   const std::string persistence_prefix_;
+  const int64_t persistent_cache_max_bytes_;
+  // Fingerprint of the XLA compiler flags, which affect the executables
+  // compiled from the same HLO.
+  const uint64 compiler_flags_fingerprint_;
 
   // If non-empty, JIT-compiled executables are saved to and loaded from the
   // specified file system directory path.
@@ -144,6 +173,9 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
     : device_type_(device_type),
       disable_strict_signature_checks_(config.disable_strict_signature_checks),
       persistence_prefix_(config.persistence_prefix),
+      persistent_cache_max_bytes_(config.persistent_cache_max_bytes),
+      compiler_flags_fingerprint_(
+          DeterministicProtoHash64(xla::GetDebugOptionsFromFlags())),
       persistent_cache_directory_(config.persistent_cache_directory) {}
 
 template <typename ExecutableType, typename ClientType>
@@ -154,6 +186,7 @@ std::string DeviceExecutablePersistor<ExecutableType, ClientType>::
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
+      key.compiler_flags_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.device_type());
 }
 
@@ -173,6 +206,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   serialized_cache_key.set_signature_fingerprint(signature_hash);
   serialized_cache_key.set_cluster_fingerprint(
       DeterministicProtoHash64(hlo_module));
+  serialized_cache_key.set_compiler_flags_fingerprint(
+      compiler_flags_fingerprint_);
   serialized_cache_key.set_device_type(device_type().type_string());
   serialized_cache_key.set_prefix(persistence_prefix());
   return serialized_cache_key;
@@ -189,7 +224,12 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   }
 
   XlaSerializedCacheEntry entry;
-  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(env, file_path, &entry));
+  Status status = ReadTextOrBinaryProto(env, file_path, &entry);
+  if (errors::IsNotFound(status)) {
+    // Another process evicted the entry after the check above.
+    return StatusOr<std::optional<XlaSerializedCacheEntry>>(std::nullopt);
+  }
+  TF_RETURN_IF_ERROR(status);
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
@@ -234,7 +274,58 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::SaveSerializedEntry(
   Env* env = Env::Default();
   TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(persistent_cache_directory_));
   const std::string file_path = GetFilePath(entry.key());
-  return WriteBinaryProto(env, file_path, entry);
+  // Writers of the same entry each write a temporary file of their own, and
+  // the last rename wins.
+  std::string temp_path = file_path;
+  if (!env->CreateUniqueFileName(&temp_path, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name for ",
+                            file_path);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, temp_path, entry));
+  Status status = env->RenameFile(temp_path, file_path);
+  if (!status.ok()) {
+    env->DeleteFile(temp_path).IgnoreError();
+    return status;
+  }
+  if (persistent_cache_max_bytes_ > 0) {
+    TF_RETURN_IF_ERROR(EvictEntries());
+  }
+  return OkStatus();
+}
+
+template <typename ExecutableType, typename ClientType>
+Status DeviceExecutablePersistor<ExecutableType, ClientType>::EvictEntries()
+    const {
+  Env* env = Env::Default();
+  std::vector<std::string> children;
+  TF_RETURN_IF_ERROR(env->GetChildren(persistent_cache_directory_, &children));
+  const std::string name_prefix = persistence_prefix_.empty()
+                                      ? ""
+                                      : absl::StrCat(persistence_prefix_, "__");
+  // (write time, size, path) of every entry.
+  std::vector<std::tuple<int64_t, int64_t, std::string>> entries;
+  int64_t total_bytes = 0;
+  for (const std::string& child : children) {
+    if (!absl::StartsWith(child, name_prefix) ||
+        !absl::EndsWith(child, ".pb")) {
+      continue;
+    }
+    const std::string path = io::JoinPath(persistent_cache_directory_, child);
+    FileStatistics stat;
+    // Skips entries that other processes evict meanwhile.
+    if (!env->Stat(path, &stat).ok() || stat.is_directory) continue;
+    entries.emplace_back(stat.mtime_nsec, stat.length, path);
+    total_bytes += stat.length;
+  }
+  std::sort(entries.begin(), entries.end());
+  for (const auto& [mtime_nsec, length, path] : entries) {
+    if (total_bytes <= persistent_cache_max_bytes_) break;
+    VLOG(1) << "Evicting persisted cache entry " << path;
+    Status status = env->DeleteFile(path);
+    if (!status.ok() && !errors::IsNotFound(status)) return status;
+    total_bytes -= length;
+  }
+  return OkStatus();
 }
 
 template <typename ExecutableType, typename ClientType>
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/client/client_library.h"
 #include "tensorflow/compiler/xla/client/executable_build_options.h"
 #include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/debug_options_flags.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status_matchers.h"
@@ -146,6 +147,7 @@ std::string GetFilePath(XlaSerializedCacheKey key,
       key.prefix(), key.prefix().empty() ? "" : kXlaSerializedCacheKeySeparator,
       key.signature_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.cluster_fingerprint(), kXlaSerializedCacheKeySeparator,
+      key.compiler_flags_fingerprint(), kXlaSerializedCacheKeySeparator,
       key.device_type(), ".pb");
 
   return io::JoinPath(persistent_cache_dir, file_name);
@@ -167,6 +169,8 @@ XlaSerializedCacheKey CreateCacheKey(
   key.set_signature_fingerprint(signature_hash);
   key.set_cluster_fingerprint(
       DeterministicProtoHash64(compilation_result.computation->proto()));
+  key.set_compiler_flags_fingerprint(
+      DeterministicProtoHash64(xla::GetDebugOptionsFromFlags()));
   key.set_device_type(device_type.type_string());
   key.set_prefix(persistence_prefix);
   return key;
@@ -478,5 +482,79 @@ TEST_F(DeviceExecutionPersistorTest, LoadSerializedExecutableEmpty) {
               testing::StatusIs(error::INVALID_ARGUMENT));
 }
 
+TEST_F(DeviceExecutionPersistorTest, PersistLeavesNoTemporaryFiles) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "no_temporary_files");
+  XlaDeviceExecutablePersistor::Config config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor persistor(config, DefaultOptions().device_type);
+
+  MockCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .Times(2)
+      .WillRepeatedly(Return(StatusOr<std::string>(serialized_executable_)));
+
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  // Persisting the same entry again replaces it.
+  for (int i = 0; i < 2; ++i) {
+    TF_EXPECT_OK(persistor.TryToPersistExecutable(
+        /*signature_hash=*/123, "signature_string", DefaultOptions(),
+        compilation_result_add_, *executable, &mock_client));
+  }
+
+  auto key =
+      CreateCacheKey(/*signature_hash=*/123, compilation_result_add_,
+                     persistor.device_type(), persistor.persistence_prefix());
+  std::vector<std::string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &children));
+  EXPECT_THAT(children, ::testing::ElementsAre(io::Basename(
+                            GetFilePath(key, cache_dir))));
+}
+
+TEST_F(DeviceExecutionPersistorTest, PersistEvictsOldestEntries) {
+  const std::string cache_dir = io::JoinPath(cache_dir_, "evict");
+  MockCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .Times(2)
+      .WillRepeatedly(Return(StatusOr<std::string>(serialized_executable_)));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+
+  XlaDeviceExecutablePersistor::Config unbounded_config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla");
+  XlaDeviceExecutablePersistor unbounded_persistor(
+      unbounded_config, DefaultOptions().device_type);
+  TF_ASSERT_OK(unbounded_persistor.TryToPersistExecutable(
+      /*signature_hash=*/1, "signature_string", DefaultOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  auto key1 = CreateCacheKey(/*signature_hash=*/1, compilation_result_add_,
+                             unbounded_persistor.device_type(),
+                             unbounded_persistor.persistence_prefix());
+  uint64 entry_bytes;
+  TF_ASSERT_OK(
+      Env::Default()->GetFileSize(GetFilePath(key1, cache_dir), &entry_bytes));
+
+  // Room for one entry only.
+  XlaDeviceExecutablePersistor::Config bounded_config(
+      /*persistent_cache_directory=*/cache_dir,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"xla",
+      /*persistent_cache_max_bytes=*/entry_bytes * 3 / 2);
+  XlaDeviceExecutablePersistor bounded_persistor(bounded_config,
+                                                 DefaultOptions().device_type);
+  TF_ASSERT_OK(bounded_persistor.TryToPersistExecutable(
+      /*signature_hash=*/2, "signature_string", DefaultOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  auto key2 = CreateCacheKey(/*signature_hash=*/2, compilation_result_add_,
+                             bounded_persistor.device_type(),
+                             bounded_persistor.persistence_prefix());
+
+  EXPECT_FALSE(ReadCacheEntryFromFile(key1, cache_dir).ok());
+  TF_ASSERT_OK_AND_ASSIGN(auto entry, ReadCacheEntryFromFile(key2, cache_dir));
+  EXPECT_EQ(entry.executable(), serialized_executable_);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -93,6 +93,11 @@ struct MarkForCompilationPassFlags {
   // specified file system directory path.
   std::string tf_xla_persistent_cache_directory;
 
+  // If positive, the oldest entries in `tf_xla_persistent_cache_directory` are
+  // deleted to keep the entries with `tf_xla_persistent_cache_prefix` within
+  // this many bytes.
+  int64_t tf_xla_persistent_cache_max_bytes;
+
   // If true, entries loaded into the XLA compile cache will not have their
   // signatures checked strictly. This should generally not be disabled except
   // for debugging. Defaults to false.
@@ -122,6 +127,10 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile compiles the cluster asynchronously with respect to
   // the main execution. The fallback path is taken while compilation happens.
   bool tf_xla_async_compilation;
+  // If true, _XlaRun launches XLA:CPU clusters with static shapes and no
+  // resource variables through the calling convention of tfcompile's AOT
+  // functions, skipping most of the per-launch bookkeeping.
+  bool tf_xla_cpu_fast_launch;
 };
 
 // Flags for the build_xla_ops pass.
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
+#include "tensorflow/compiler/jit/xla_cpu_fast_launch.h"
 #include "tensorflow/compiler/jit/xla_platform_info.h"
 #include "tensorflow/compiler/tf2xla/tf2xla_util.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
@@ -596,6 +597,22 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
 XlaRunOp::XlaRunOp(OpKernelConstruction* ctx)
     : OpKernel(ctx), platform_info_(XlaPlatformInfoFromDevice(ctx->device())) {}
 
+const XlaCpuFastLaunch* XlaRunOp::GetCpuFastLaunch(
+    const xla::LocalExecutable* executable,
+    const XlaCompiler::CompilationResult& compilation_result) {
+  mutex_lock lock(mu_);
+  auto it = cpu_fast_launches_.find(executable);
+  if (it == cpu_fast_launches_.end()) {
+    it = cpu_fast_launches_
+             .emplace(executable,
+                      XlaCpuFastLaunch::Create(*executable, compilation_result))
+             .first;
+    VLOG(2) << "XlaRunOp " << def().name() << " can "
+            << (it->second ? "" : "not ") << "use the CPU fast launch path";
+  }
+  return it->second.get();
+}
+
 void XlaRunOp::Compute(OpKernelContext* ctx) {
   VLOG(3) << "XlaRunOp " << def().name();
   Tensor key_tensor = ctx->input(ctx->num_inputs() - 1);
@@ -603,6 +620,22 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
 
   XlaExecutableClosure closure =
       XlaExecutableClosureStore::Global()->Consume(key);
+
+  if (GetXlaOpsCommonFlags().tf_xla_cpu_fast_launch &&
+      platform_info_.device_type() == DEVICE_CPU &&
+      closure.resource_var_snapshots().empty()) {
+    const XlaCpuFastLaunch* fast_launch =
+        GetCpuFastLaunch(closure.executable(), *closure.compilation_result());
+    if (fast_launch != nullptr) {
+      StatusOr<bool> launched = fast_launch->Run(
+          ctx, /*missing_ctx_input_prefix=*/closure.num_constant_args());
+      OP_REQUIRES_OK(ctx, launched.status());
+      if (*launched) {
+        return;
+      }
+    }
+  }
+
   std::shared_ptr<se::DeviceMemoryAllocator> allocator =
       GetAllocator(ctx->device(), GetStream(ctx), platform_info_);
   XlaComputationLaunchContext launch_context =
@@ -17,8 +17,11 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_JIT_KERNELS_XLA_OPS_H_
 
 #include <atomic>
+#include <memory>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
+#include "tensorflow/compiler/jit/xla_cpu_fast_launch.h"
 #include "tensorflow/compiler/jit/xla_device.h"
 #include "tensorflow/compiler/jit/xla_launch_util.h"
 #include "tensorflow/compiler/jit/xla_platform_info.h"
@@ -124,7 +127,19 @@ class XlaRunOp : public OpKernel {
   void Compute(OpKernelContext* ctx) override;
 
  private:
+  // Returns the fast launch path for `executable`, or nullptr if it can't be
+  // launched that way.
+  const XlaCpuFastLaunch* GetCpuFastLaunch(
+      const xla::LocalExecutable* executable,
+      const XlaCompiler::CompilationResult& compilation_result);
+
   const XlaPlatformInfo platform_info_;
+
+  mutex mu_;
+  // Null entries record the executables that can't use the fast launch path.
+  absl::flat_hash_map<const xla::LocalExecutable*,
+                      std::unique_ptr<XlaCpuFastLaunch>>
+      cpu_fast_launches_ TF_GUARDED_BY(mu_);
 };
 
 class XlaMergeOp : public OpKernel {
@@ -275,6 +275,11 @@ Status XlaCompilationCache::CompileAsynchronous(
     profiler->DecrementOngoingAsyncCompilations();
     // Update compilation status in cache.
     if (!s.ok()) {
+      // The cluster stays in the kCompiling state, so that its executions
+      // keep running its TensorFlow ops.
+      LOG(WARNING) << "Asynchronous compilation of cluster " << function_name
+                   << " failed, running its TensorFlow ops instead: "
+                   << s.status();
       cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
                     std::nullopt);
     }
@@ -356,6 +361,7 @@ Status XlaCompilationCache::CompileImpl(
     if (!profiler->ShouldCompileCluster(function, compile_mode,
                                         current_request_count)) {
       VLOG(2) << "Not compiling for signature: " << human_signature;
+      profiler->RegisterFallback(function);
       return OkStatus();
     } else if (compile_mode == DeviceCompileMode::kAsync) {
       VLOG(2) << "Queueing asynchronous compilation for signature: "
@@ -363,6 +369,7 @@ Status XlaCompilationCache::CompileImpl(
       TF_RETURN_IF_ERROR(CompileAsynchronous(signature, compile_options,
                                              options, args, function, scope,
                                              ctx, profiler));
+      profiler->RegisterFallback(function);
       return OkStatus();
     } else {
       VLOG(2) << "Instantly compiling for signature: " << human_signature;
@@ -374,6 +381,7 @@ Status XlaCompilationCache::CompileImpl(
   } else if (state == DeviceCompileState::kCompiling) {
     VLOG(2) << "Ongoing asynchronous compilation for signature: "
             << human_signature;
+    profiler->RegisterFallback(function);
     return OkStatus();
   } else if (state == DeviceCompileState::kCompiled) {
     VLOG(2) << "Already Compiled for signature: " << human_signature;
@@ -0,0 +1,153 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_cpu_fast_launch.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/compiler/xla/service/cpu/buffer_info_util.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+bool IsStaticArray(const xla::Shape& shape) {
+  return shape.IsArray() && shape.is_static();
+}
+
+}  // namespace
+
+/*static*/ std::unique_ptr<XlaCpuFastLaunch> XlaCpuFastLaunch::Create(
+    const xla::LocalExecutable& executable,
+    const XlaCompiler::CompilationResult& compilation_result) {
+  // The static_cast is safe because the executable was compiled for the host
+  // platform.
+  const auto* cpu_executable =
+      static_cast<const xla::cpu::CpuExecutable*>(executable.executable());
+  if (cpu_executable->IsXlaRuntime() ||
+      cpu_executable->hlo_profiling_enabled()) {
+    return nullptr;
+  }
+  if (!compilation_result.resource_updates.empty()) {
+    return nullptr;
+  }
+  for (const xla::Shape& shape : compilation_result.xla_input_shapes) {
+    if (!IsStaticArray(shape)) {
+      return nullptr;
+    }
+  }
+  const xla::Shape& output_shape = compilation_result.xla_output_shape;
+  if (!output_shape.IsTuple() ||
+      output_shape.tuple_shapes_size() != compilation_result.outputs.size()) {
+    return nullptr;
+  }
+  for (int i = 0; i < compilation_result.outputs.size(); ++i) {
+    const XlaOutputDescription& output = compilation_result.outputs[i];
+    if (output.is_constant || output.type == DT_RESOURCE ||
+        output.type == DT_VARIANT ||
+        !IsStaticArray(output_shape.tuple_shapes(i))) {
+      return nullptr;
+    }
+  }
+  bool has_alias = false;
+  executable.executable()->module().input_output_alias_config().ForEachAlias(
+      [&](const xla::ShapeIndex&, const xla::HloInputOutputAliasConfig::Alias&) {
+        has_alias = true;
+      });
+  if (has_alias) {
+    return nullptr;
+  }
+
+  const xla::BufferAssignment& buffer_assignment =
+      cpu_executable->buffer_assignment();
+  StatusOr<xla::BufferAllocation::Slice> result_slice =
+      buffer_assignment.GetUniqueTopLevelOutputSlice();
+  if (!result_slice.ok()) {
+    return nullptr;
+  }
+
+  std::unique_ptr<XlaCpuFastLaunch> launch(new XlaCpuFastLaunch);
+  launch->buffer_infos_ =
+      xla::cpu::CreateBufferInfosFromBufferAssignment(buffer_assignment);
+  launch->arg_index_table_ =
+      xla::cpu::CreateArgIndexTableFromBufferInfos(launch->buffer_infos_);
+  if (launch->arg_index_table_.size() !=
+      compilation_result.xla_input_shapes.size()) {
+    return nullptr;
+  }
+  XlaCompiledCpuFunction::StaticData& static_data = launch->static_data_;
+  XlaCompiledCpuFunction::set_static_data_raw_function(
+      &static_data, cpu_executable->compute_function());
+  XlaCompiledCpuFunction::set_static_data_buffer_infos(
+      &static_data, launch->buffer_infos_.data());
+  XlaCompiledCpuFunction::set_static_data_num_buffers(
+      &static_data, launch->buffer_infos_.size());
+  XlaCompiledCpuFunction::set_static_data_arg_index_table(
+      &static_data, launch->arg_index_table_.data());
+  XlaCompiledCpuFunction::set_static_data_num_args(
+      &static_data, launch->arg_index_table_.size());
+  XlaCompiledCpuFunction::set_static_data_result_index(&static_data,
+                                                       result_slice->index());
+
+  launch->input_mapping_ = compilation_result.input_mapping;
+  for (const XlaOutputDescription& output : compilation_result.outputs) {
+    launch->output_types_.push_back(output.type);
+    launch->output_shapes_.push_back(output.shape);
+  }
+  return launch;
+}
+
+StatusOr<bool> XlaCpuFastLaunch::Run(OpKernelContext* ctx,
+                                     int missing_ctx_input_prefix) const {
+  XlaCompiledCpuFunction function(
+      static_data_,
+      XlaCompiledCpuFunction::AllocMode::RESULTS_PROFILES_AND_TEMPS_ONLY);
+  for (int i = 0; i < input_mapping_.size(); ++i) {
+    const Tensor& input =
+        ctx->input(input_mapping_[i] - missing_ctx_input_prefix);
+    const char* data = input.tensor_data().data();
+    if (function.arg_size(i) >= xla::cpu_function_runtime::MinAlign() &&
+        reinterpret_cast<uintptr_t>(data) %
+                xla::cpu_function_runtime::MinAlign() !=
+            0) {
+      VLOG(2) << "Input " << i << " is underaligned for the fast launch path";
+      return false;
+    }
+    function.set_arg_data(i, data);
+  }
+  function.set_thread_pool(&ctx->eigen_cpu_device());
+
+  if (!function.Run()) {
+    return errors::Internal("XLA:CPU computation failed");
+  }
+
+  for (int i = 0; i < output_shapes_.size(); ++i) {
+    Tensor* output;
+    TF_RETURN_IF_ERROR(ctx->allocate_output(i, output_shapes_[i], &output));
+    TF_RET_CHECK(output->dtype() == output_types_[i]);
+    if (output->TotalBytes() > 0) {
+      std::memcpy(const_cast<char*>(output->tensor_data().data()),
+                  function.result_data(i), output->TotalBytes());
+    }
+  }
+  return true;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,76 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Contains a lean launch path for small XLA:CPU clusters.
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_CPU_FAST_LAUNCH_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_CPU_FAST_LAUNCH_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/compiler/tf2xla/xla_compiled_cpu_function.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/compiler/xla/client/local_client.h"
+#include "tensorflow/compiler/xla/cpu_function_runtime.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+
+// Runs an XLA:CPU executable through the calling convention of tfcompile's AOT
+// functions (see XlaCompiledCpuFunction): the input tensors' buffers are passed
+// to the generated code directly and its results are copied into the output
+// tensors, without building ExecutionInputs, ShapedBuffers or a device memory
+// allocator. For very small clusters that bookkeeping costs more than running
+// the compiled code.
+//
+// Only clusters with static shapes, no resource variables, no constant or
+// aliased outputs and array-shaped parameters and results can be launched
+// this way.
+class XlaCpuFastLaunch {
+ public:
+  // Returns nullptr if `executable`, which must have been compiled for the
+  // host platform, can't be launched this way. `executable` and
+  // `compilation_result` must outlive the returned object.
+  static std::unique_ptr<XlaCpuFastLaunch> Create(
+      const xla::LocalExecutable& executable,
+      const XlaCompiler::CompilationResult& compilation_result);
+
+  // Runs the executable on the inputs of `ctx`, skipping the first
+  // `missing_ctx_input_prefix` XLA arguments like
+  // XlaComputationLaunchContext::PopulateInputs, and sets the outputs of
+  // `ctx`. Returns false without running anything if an input is not aligned
+  // as the generated code requires, in which case the caller should take the
+  // regular launch path.
+  StatusOr<bool> Run(OpKernelContext* ctx, int missing_ctx_input_prefix) const;
+
+ private:
+  XlaCpuFastLaunch() = default;
+
+  std::vector<xla::cpu_function_runtime::BufferInfo> buffer_infos_;
+  std::vector<int32> arg_index_table_;
+  XlaCompiledCpuFunction::StaticData static_data_;
+
+  // Indices of the kernel inputs passed as the XLA parameters.
+  std::vector<int> input_mapping_;
+  std::vector<DataType> output_types_;
+  std::vector<TensorShape> output_shapes_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_CPU_FAST_LAUNCH_H_
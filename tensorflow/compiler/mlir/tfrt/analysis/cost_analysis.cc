@@ -201,15 +201,22 @@ void CostAnalysis::EvaluateCost(mlir::Operation* op) {
   cost_map_[op] = cost;
 }
 
-Status CostAnalysis::ReadMeasuredCosts() {
+Status CostAnalysis::ReadMeasuredCosts(absl::string_view measured_cost_path) {
+  tensorflow::Env* env = Env::Default();
+  if (!measured_cost_path.empty()) {
+    const std::string path(measured_cost_path);
+    // The costs have not been measured yet, e.g. on the first load of a model.
+    if (!env->FileExists(path).ok()) return OkStatus();
+    return ReadTextProto(env, path, &op_cost_map_proto_);
+  }
+
   const char* env_var = getenv("TF_TFRT_MEASURED_COST_PATH");
   // No need to read because the cost measurement is disabled.
   if (env_var == nullptr) return OkStatus();
 
-  tensorflow::Env* env = Env::Default();
-  const std::string measured_cost_path(env_var);
-  TF_RETURN_IF_ERROR(env->FileExists(measured_cost_path));
-  return ReadTextProto(env, measured_cost_path, &op_cost_map_proto_);
+  const std::string env_path(env_var);
+  TF_RETURN_IF_ERROR(env->FileExists(env_path));
+  return ReadTextProto(env, env_path, &op_cost_map_proto_);
 }
 
 }  // namespace tfrt_compiler
@@ -34,11 +34,16 @@ namespace tfrt_compiler {
 // threshold to decide whether a cost is cheap or expensive), as it might not be
 // accurate in some cases.
 //
+// Costs measured by tfrt_stub::CostRecorder take precedence over the heuristic.
+// They are read from `measured_cost_path` if it is not empty and the file
+// exists, and otherwise from the file named by TF_TFRT_MEASURED_COST_PATH.
+//
 class CostAnalysis {
  public:
-  explicit CostAnalysis(mlir::func::FuncOp func_op) {
+  explicit CostAnalysis(mlir::func::FuncOp func_op,
+                        absl::string_view measured_cost_path = "") {
     AnalyzeArguments(func_op);
-    TF_CHECK_OK(ReadMeasuredCosts());
+    TF_CHECK_OK(ReadMeasuredCosts(measured_cost_path));
     AnalyzeBlock(&func_op.front());
   }
 
@@ -48,7 +53,7 @@ class CostAnalysis {
   void AnalyzeArguments(mlir::func::FuncOp func_op);
   void AnalyzeBlock(mlir::Block* block);
   void EvaluateCost(mlir::Operation* op);
-  Status ReadMeasuredCosts();
+  Status ReadMeasuredCosts(absl::string_view measured_cost_path);
 
   int64_t max_arg_size_ = 1;
   llvm::DenseMap<mlir::Operation*, int64_t> cost_map_;
@@ -193,6 +193,12 @@ struct TfrtPipelineOptions
           "The threshold to limit the merging of dependent sequence."),
       llvm::cl::init(-1)};
 
+  Option<std::string> measured_cost_path{
+      *this, "tfrt-measured-cost-path",
+      llvm::cl::desc("The file of op costs measured by previous runs, which "
+                     "take precedence over the estimated costs."),
+      llvm::cl::init("")};
+
   Option<bool> merge_inter_dependent_streams{
       *this, "tfrt-merge-inter-dependent-streams",
       llvm::cl::desc("If true, streams with inter data depenedencies will be "
@@ -1484,6 +1484,7 @@ class TfToTfrtConversionPass
         options.use_tpu_host_allocator_for_inputs;
     cost_threshold_ = options.cost_threshold;
     upper_cost_threshold_ = options.upper_cost_threshold;
+    measured_cost_path_ = options.measured_cost_path;
     merge_inter_dependent_streams_ = options.merge_inter_dependent_streams;
     func_use_fallback_tensor_ = options.func_use_fallback_tensor;
     enable_while_parallel_iterations_ =
@@ -1502,7 +1503,7 @@ class TfToTfrtConversionPass
     mlir::ConversionTarget target(context);
     mlir::RewritePatternSet patterns(&getContext());
     CoreRTConverter corert_converter(&context, &side_effect_analysis);
-    tfrt_compiler::CostAnalysis cost_analysis(func);
+    tfrt_compiler::CostAnalysis cost_analysis(func, measured_cost_path_);
 
     if (target_tpurt_)
       AddTPUTargetDialectAndPatterns(
@@ -1743,6 +1744,12 @@ class TfToTfrtConversionPass
           "The threshold to limit the merging of dependent sequence."),
       llvm::cl::init(-1)};
 
+  Option<std::string> measured_cost_path_{
+      *this, "tfrt-measured-cost-path",
+      llvm::cl::desc("The file of op costs measured by previous runs, which "
+                     "take precedence over the estimated costs."),
+      llvm::cl::init("")};
+
   Option<bool> merge_inter_dependent_streams_{
       *this, "tfrt-merge-inter-dependent-streams",
       llvm::cl::desc("If true, streams with inter data depenedencies will be "
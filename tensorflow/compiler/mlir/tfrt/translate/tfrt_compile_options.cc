@@ -63,6 +63,7 @@ std::ostream& operator<<(std::ostream& os, const TfrtCompileOptions& options) {
             << options.auto_fusion_min_cluster_size
             << ", cost_threshold = " << options.cost_threshold
             << ", upper_cost_threshold = " << options.upper_cost_threshold
+            << ", measured_cost_path = " << options.measured_cost_path
             << ", merge_inter_dependent_streams = "
             << options.merge_inter_dependent_streams
             << ", decompose_resource_ops = " << options.decompose_resource_ops
@@ -116,6 +116,14 @@ struct TfrtCompileOptions {
   // sequences. The default is -1 which means no limit.
   int64_t upper_cost_threshold = -1;
 
+  // The file of op costs measured by previous runs with cost measurement
+  // enabled, as written by tfrt_stub::CostRecorder::WriteToFile(). If the file
+  // exists, the measured costs replace the estimated ones in the decisions
+  // above, so that a model reloaded next to this file starts with the
+  // execution plan tuned by its previous runs. Ignored if empty or if the file
+  // does not exist.
+  std::string measured_cost_path;
+
   // If true, streams with inter data depenedencies will be preferred to be
   // merged for inline execution.
   bool merge_inter_dependent_streams = true;
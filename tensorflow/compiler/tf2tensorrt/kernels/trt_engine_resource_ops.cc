@@ -17,6 +17,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
@@ -35,12 +36,31 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
+#include "third_party/gpus/cuda/include/cuda_runtime_api.h"
 #include "third_party/tensorrt/NvInfer.h"
 
 namespace tensorflow {
 namespace tensorrt {
 using ::nvinfer1::IRuntime;
 
+namespace {
+
+// Returns the model and compute capability of the GPU of `ctx`, or an empty
+// string if it cannot be determined. Serialized engines can only be loaded
+// on the GPU model they were built for.
+string GetGpuModel(OpKernelContext* ctx) {
+  const auto* device_info =
+      ctx->device()->tensorflow_accelerator_device_info();
+  if (device_info == nullptr || device_info->gpu_id < 0) return "";
+  cudaDeviceProp prop;
+  if (cudaGetDeviceProperties(&prop, device_info->gpu_id) != cudaSuccess) {
+    return "";
+  }
+  return absl::StrCat(prop.name, " sm_", prop.major, prop.minor);
+}
+
+}  // namespace
+
 class CreateTRTResourceHandle : public OpKernel {
  public:
   explicit CreateTRTResourceHandle(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -124,8 +144,10 @@ class InitializeTRTResource : public OpKernel {
     OP_REQUIRES_OK(ctx, ctx->env()->NewRandomAccessFile(filename, &file));
     auto reader = std::make_unique<io::RecordReader>(file.get());
 
+    const string gpu_model = GetGpuModel(ctx);
     uint64 offset = 0;
     int num_loaded_engine = 0;
+    int num_restored_shapes = 0;
     do {
       tstring record;
       Status status = reader->ReadRecord(&offset, &record);
@@ -133,6 +155,32 @@ class InitializeTRTResource : public OpKernel {
 
       TRTEngineInstance engine_instance;
       engine_instance.ParseFromString(record);
+
+      // Restore the shapes collected for the profiles, so that if no engine
+      // can be loaded, the engine built on the first call covers all the
+      // shapes seen by earlier deployments instead of only the first one.
+      if (!resource->profiles_.HasShape()) {
+        for (const TRTInputShapes& profile_shapes :
+             engine_instance.profile_input_shapes()) {
+          std::vector<TensorShape> shapes;
+          shapes.reserve(profile_shapes.shapes_size());
+          for (const TensorShapeProto& shape : profile_shapes.shapes()) {
+            shapes.emplace_back(shape);
+          }
+          resource->profiles_.AddShape(shapes);
+          ++num_restored_shapes;
+        }
+      }
+
+      if (engine_instance.serialized_engine().empty()) continue;
+      if (!engine_instance.gpu_model().empty() && !gpu_model.empty() &&
+          engine_instance.gpu_model() != gpu_model) {
+        VLOG(1) << "Skipping TRT engine for op " << handle.name()
+                << " built for " << engine_instance.gpu_model()
+                << " on a " << gpu_model;
+        continue;
+      }
+
       std::vector<TensorShape> engine_input_shapes;
       const auto& input_shapes = engine_instance.input_shapes();
       engine_input_shapes.reserve(input_shapes.size());
@@ -167,7 +215,8 @@ class InitializeTRTResource : public OpKernel {
                                    std::move(engine), std::move(ctx_vec)));
       ++num_loaded_engine;
     } while (1);
-    VLOG(1) << "Loaded " << num_loaded_engine << " TRT engines for op "
+    VLOG(1) << "Loaded " << num_loaded_engine << " TRT engines and "
+            << num_restored_shapes << " profile shapes for op "
             << handle.name() << " on device " << ctx->device()->name()
             << " from file " << filename;
   }
@@ -219,6 +268,18 @@ class SerializeTRTResource : public OpKernel {
     OP_REQUIRES_OK(ctx, ctx->env()->NewWritableFile(filename, &file));
     auto writer = std::make_unique<io::RecordWriter>(file.get());
 
+    const string gpu_model = GetGpuModel(ctx);
+    // The collected profile shapes are written with the first record only.
+    auto add_profile_shapes = [&](TRTEngineInstance* engine_instance) {
+      for (const auto& shapes : resource->profiles_.GetCollectedShapes()) {
+        TRTInputShapes* profile_shapes =
+            engine_instance->add_profile_input_shapes();
+        for (const TensorShape& shape : shapes) {
+          shape.AsProto(profile_shapes->add_shapes());
+        }
+      }
+    };
+
     int num_serialized_engines = 0;
     if (save_gpu_specific_engines_) {
       // If user requests TRT engines export, recursively create
@@ -238,6 +299,8 @@ class SerializeTRTResource : public OpKernel {
         if (!engine || !engine->GetCudaEngine()) continue;
 
         TRTEngineInstance engine_instance;
+        engine_instance.set_gpu_model(gpu_model);
+        if (num_serialized_engines == 0) add_profile_shapes(&engine_instance);
         // Add input shapes.
         const std::vector<TensorShape>& engine_input_shapes = pair.first;
         for (const TensorShape& shape : engine_input_shapes) {
@@ -275,7 +338,16 @@ class SerializeTRTResource : public OpKernel {
             ctx, writer->WriteRecord(engine_instance.SerializeAsString()));
         ++num_serialized_engines;
       }
-    } else {
+    }
+    if (num_serialized_engines == 0 && resource->profiles_.HasShape()) {
+      // Keep the profile shapes even without an engine, so that the engine
+      // built from them covers all the shapes seen so far.
+      TRTEngineInstance engine_instance;
+      add_profile_shapes(&engine_instance);
+      OP_REQUIRES_OK(ctx,
+                     writer->WriteRecord(engine_instance.SerializeAsString()));
+    }
+    if (!save_gpu_specific_engines_) {
       VLOG(1) << "TRT Engines are not serialized for op: " << resource_name;
     }
     VLOG(1) << "Serialized " << num_serialized_engines << " TRT engines for op "
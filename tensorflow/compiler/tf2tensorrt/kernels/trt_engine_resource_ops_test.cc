@@ -406,6 +406,89 @@ TEST_P(TRTEngineResourceOpsTest, Basic) {
   resource->Unref();
 }
 
+TEST_P(TRTEngineResourceOpsTest, ProfileShapesWithoutEngines) {
+  std::unique_ptr<Device> device(
+      DeviceFactory::NewDevice("GPU", {}, "/job:worker/replica:0/task:0"));
+  ResourceMgr* rm = device->resource_manager();
+  SetDevice(DEVICE_GPU, std::move(device));
+
+  const string container(kTfTrtContainerName);
+  const string resource_name = "profile_shapes_resource";
+  Reset();
+  TF_ASSERT_OK(NodeDefBuilder("op", "CreateTRTResourceHandle")
+                   .Attr("resource_name", resource_name)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  TF_ASSERT_OK(RunOpKernel());
+  ResourceHandle handle =
+      context_->mutable_output(0)->scalar<ResourceHandle>()();
+
+  // Initializes the resource from `filename`.
+  auto initialize = [&](const string& filename) {
+    Reset();
+    TF_ASSERT_OK(NodeDefBuilder("op", "InitializeTRTResource")
+                     .Input(FakeInput(DT_RESOURCE))
+                     .Input(FakeInput(DT_STRING))
+                     .Attr("max_cached_engines_count", 1)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<ResourceHandle>(TensorShape({}), {handle});
+    AddInputFromArray<tstring>(TensorShape({}), {filename});
+    TF_ASSERT_OK(RunOpKernel());
+  };
+
+  Env* env = Env::Default();
+  const string empty_filename =
+      io::JoinPath(testing::TmpDir(), "trt_empty_engine_file");
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_ASSERT_OK(env->NewWritableFile(empty_filename, &file));
+  }
+  initialize(empty_filename);
+  TRTEngineCacheResource* resource = nullptr;
+  TF_ASSERT_OK(rm->Lookup(container, resource_name, &resource));
+  resource->profiles_.AddShape({TensorShape({1, 2})});
+  resource->profiles_.AddShape({TensorShape({8, 2})});
+  resource->Unref();
+
+  // Serialize the collected shapes without any engine.
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "trt_profile_shapes_file");
+  Reset();
+  TF_ASSERT_OK(NodeDefBuilder("op", "SerializeTRTResource")
+                   .Attr("delete_resource", true)
+                   .Attr("save_gpu_specific_engines", false)
+                   .Input(FakeInput(DT_STRING))
+                   .Input(FakeInput(DT_STRING))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInputFromArray<tstring>(TensorShape({}), {resource_name});
+  AddInputFromArray<tstring>(TensorShape({}), {filename});
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(env->NewRandomAccessFile(filename, &file));
+  auto reader = std::make_unique<io::RecordReader>(file.get());
+  uint64 offset = 0;
+  tstring record;
+  TF_ASSERT_OK(reader->ReadRecord(&offset, &record));
+  TRTEngineInstance engine_instance;
+  engine_instance.ParseFromString(record);
+  EXPECT_TRUE(engine_instance.serialized_engine().empty());
+  ASSERT_EQ(2, engine_instance.profile_input_shapes_size());
+  EXPECT_EQ(8, engine_instance.profile_input_shapes(1).shapes(0).dim(0).size());
+  EXPECT_TRUE(errors::IsOutOfRange(reader->ReadRecord(&offset, &record)));
+
+  // A new resource gets the shapes back, but no engine.
+  initialize(filename);
+  TF_ASSERT_OK(rm->Lookup(container, resource_name, &resource));
+  core::ScopedUnref unref(resource);
+  EXPECT_EQ(0, resource->cache_.size());
+  ASSERT_EQ(2, resource->profiles_.GetCollectedShapes().size());
+  EXPECT_EQ(TensorShape({8, 2}),
+            resource->profiles_.GetCollectedShapes()[1][0]);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
@@ -257,6 +257,11 @@ class TrtShapeOptimizationProfile {
   int GetNumProfiles() const;
 
   bool HasShape() const { return !input_shapes_.empty(); }
+
+  // Returns the input shapes collected so far.
+  const std::vector<std::vector<TensorShape>>& GetCollectedShapes() const {
+    return input_shapes_;
+  }
   bool NeedProfiles() const { return need_profiles_; }
 
   // Restores profiles from the engine (used after deserialization).
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/types.h"
 #include "tensorflow/tsl/profiler/backends/cpu/host_tracer_utils.h"
+#include "tensorflow/tsl/profiler/backends/cpu/perf_counters.h"
 #include "tensorflow/tsl/profiler/backends/cpu/traceme_recorder.h"
 #include "tensorflow/tsl/profiler/lib/profiler_interface.h"
 #include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
@@ -39,7 +40,8 @@ namespace {
 // Thread-safety: This class is go/thread-compatible.
 class HostTracer : public tsl::profiler::ProfilerInterface {
  public:
-  explicit HostTracer(int host_trace_level);
+  HostTracer(int host_trace_level, size_t max_events_per_thread,
+             bool enable_perf_counters);
   ~HostTracer() override;
 
   tsl::Status Start() override;  // TENSORFLOW_STATUS_OK
@@ -53,9 +55,18 @@ class HostTracer : public tsl::profiler::ProfilerInterface {
   // Level of host tracing.
   const int host_trace_level_;
 
+  // Maximum number of events buffered per thread.
+  const size_t max_events_per_thread_;
+
+  // Whether to collect hardware performance counters.
+  const bool enable_perf_counters_;
+
   // True if currently recording.
   bool recording_ = false;
 
+  // True if currently collecting hardware performance counters.
+  bool collecting_perf_counters_ = false;
+
   // Timestamp at the start of tracing.
   uint64_t start_timestamp_ns_ = 0;
 
@@ -63,8 +74,11 @@ class HostTracer : public tsl::profiler::ProfilerInterface {
   tsl::profiler::TraceMeRecorder::Events events_;
 };
 
-HostTracer::HostTracer(int host_trace_level)
-    : host_trace_level_(host_trace_level) {}
+HostTracer::HostTracer(int host_trace_level, size_t max_events_per_thread,
+                       bool enable_perf_counters)
+    : host_trace_level_(host_trace_level),
+      max_events_per_thread_(max_events_per_thread),
+      enable_perf_counters_(enable_perf_counters) {}
 
 HostTracer::~HostTracer() { Stop().IgnoreError(); }  // NOLINT
 
@@ -77,10 +91,14 @@ tsl::Status HostTracer::Start() {  // TENSORFLOW_STATUS_OK
   // start_timestamp_ns_ to prevent timestamp underflow in XPlane.
   // Therefore this have to be done before TraceMeRecorder::Start.
   start_timestamp_ns_ = tsl::profiler::GetCurrentTimeNanos();
-  recording_ = tsl::profiler::TraceMeRecorder::Start(host_trace_level_);
+  recording_ = tsl::profiler::TraceMeRecorder::Start(host_trace_level_,
+                                                     max_events_per_thread_);
   if (!recording_) {
     return tsl::errors::Internal("Failed to start TraceMeRecorder");
   }
+  if (enable_perf_counters_) {
+    collecting_perf_counters_ = tsl::profiler::PerfCounters::Start();
+  }
   return tsl::OkStatus();
 }
 
@@ -88,6 +106,10 @@ tsl::Status HostTracer::Stop() {  // TENSORFLOW_STATUS_OK
   if (!recording_) {
     return tsl::errors::Internal("TraceMeRecorder not started");
   }
+  if (collecting_perf_counters_) {
+    tsl::profiler::PerfCounters::Stop();
+    collecting_perf_counters_ = false;
+  }
   events_ = tsl::profiler::TraceMeRecorder::Stop();
   recording_ = false;
   return tsl::OkStatus();
@@ -115,7 +137,9 @@ tsl::Status HostTracer::CollectData(  // TENSORFLOW_STATUS_OK
 std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
     const HostTracerOptions& options) {
   if (options.trace_level == 0) return nullptr;
-  return std::make_unique<HostTracer>(options.trace_level);
+  return std::make_unique<HostTracer>(options.trace_level,
+                                      options.max_events_per_thread,
+                                      options.enable_perf_counters);
 }
 
 }  // namespace profiler
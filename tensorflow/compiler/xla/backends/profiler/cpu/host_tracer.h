@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_BACKENDS_PROFILER_CPU_HOST_TRACER_H_
 #define TENSORFLOW_COMPILER_XLA_BACKENDS_PROFILER_CPU_HOST_TRACER_H_
 
+#include <cstddef>
 #include <memory>
 
 #include "tensorflow/tsl/profiler/lib/profiler_interface.h"
@@ -32,6 +33,15 @@ struct HostTracerOptions {
   // - Level 3 enables tracing of all level 2 TraceMe(s) and more verbose
   //           (low-level) program execution details (cheap TF ops, etc).
   int trace_level = 2;
+
+  // Maximum number of TraceMe events buffered per thread during a capture.
+  // Further events are dropped and counted. Zero means unbounded.
+  size_t max_events_per_thread = 0;
+
+  // Whether to collect hardware performance counters of the ops executed on
+  // host threads, attached to their events. Tracing proceeds without them if
+  // they're unavailable.
+  bool enable_perf_counters = false;
 };
 
 std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
@@ -74,6 +74,8 @@ DebugOptions DefaultDebugOptionsIgnoringFlags() {
 
   // TODO(b/258036887): Remove this flag once CUDA Graphs are fully supported.
   opts.set_xla_gpu_enable_cuda_graphs(false);
+  opts.set_xla_gpu_enable_dot_grouping(false);
+  opts.set_xla_gpu_enable_memory_limit_rematerialization(false);
 
   // Despite the name, fast min/max on GPUs does not seem to be any faster, and
   // adds very counter-intuitive "NaN-swallowing" behavior.
@@ -756,6 +758,25 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       bool_setter_for(&DebugOptions::set_xla_gpu_enable_cuda_graphs),
       debug_options->xla_gpu_enable_cuda_graphs(),
       "Use CUDA graphs to execute XLA GPU executables when possible."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_autotune_cache_dir",
+      string_setter_for(&DebugOptions::set_xla_gpu_autotune_cache_dir),
+      debug_options->xla_gpu_autotune_cache_dir(),
+      "If non-empty, shares autotuning results with other compilations "
+      "through files in this directory, e.g. on a shared file system."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_dot_grouping",
+      bool_setter_for(&DebugOptions::set_xla_gpu_enable_dot_grouping),
+      debug_options->xla_gpu_enable_dot_grouping(),
+      "Run small independent dots of similar shapes as one batched dot, "
+      "padding them to the same shape."));
+  flag_list->push_back(tsl::Flag(
+      "xla_gpu_enable_memory_limit_rematerialization",
+      bool_setter_for(
+          &DebugOptions::set_xla_gpu_enable_memory_limit_rematerialization),
+      debug_options->xla_gpu_enable_memory_limit_rematerialization(),
+      "Rematerialize instructions that are cheap to recompute so that the "
+      "peak memory use of the module fits in the device memory."));
   flag_list->push_back(
       tsl::Flag("xla_dump_disable_metadata",
                 bool_setter_for(&DebugOptions::set_xla_dump_disable_metadata),
@@ -824,6 +845,14 @@ void MakeDebugOptionsFlags(std::vector<tsl::Flag>* flag_list,
       "By default, XLA:CPU will run fp16 dot/conv as fp32, as this is "
       "generally (much) faster on our hardware.  Set this flag to true to "
       "disable this behavior."));
+  flag_list->push_back(tsl::Flag(
+      "xla_cpu_force_compilation_parallelism",
+      int32_setter_for(
+          &DebugOptions::set_xla_cpu_force_compilation_parallelism),
+      debug_options->xla_cpu_force_compilation_parallelism(),
+      "Splits the LLVM module of a CPU executable into this many parts that "
+      "are compiled on as many threads. Setting to 0 (the default value) or 1 "
+      "compiles the module as a whole."));
 }  // NOLINT(readability/fn_size)
 
 // Allocates flag_values and flag_objects; this function must not be called more
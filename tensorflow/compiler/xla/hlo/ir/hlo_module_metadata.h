@@ -98,6 +98,18 @@ class HloModuleMetadata {
           pass_metadata->set_module_id(module_id);
         });
   }
+  Status set_current_pass_start_instruction_count(int64_t count) {
+    return MutateCurrentHloPassMetadata(
+        [&count](HloPassMetadata* pass_metadata) {
+          pass_metadata->set_start_instruction_count(count);
+        });
+  }
+  Status set_current_pass_end_instruction_count(int64_t count) {
+    return MutateCurrentHloPassMetadata(
+        [&count](HloPassMetadata* pass_metadata) {
+          pass_metadata->set_end_instruction_count(count);
+        });
+  }
   Status add_current_pass_module_group_module_id(int64_t module_id) {
     return MutateCurrentHloPassMetadata(
         [&module_id](HloPassMetadata* pass_metadata) {
@@ -0,0 +1,121 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/output_buffer_pool.h"
+
+#include <utility>
+#include <vector>
+
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace xla {
+
+OutputBufferPool::OutputBufferPool(se::DeviceMemoryAllocator* allocator,
+                                   int64_t max_pooled_bytes)
+    : se::DeviceMemoryAllocator(allocator->platform()),
+      allocator_(allocator),
+      max_pooled_bytes_(max_pooled_bytes) {}
+
+OutputBufferPool::~OutputBufferPool() { Flush(); }
+
+StatusOr<se::OwningDeviceMemory> OutputBufferPool::Allocate(
+    int device_ordinal, uint64_t size, bool retry_on_failure,
+    int64_t memory_space) {
+  if (size == 0) {
+    return se::OwningDeviceMemory();
+  }
+  if (memory_space == 0) {
+    absl::MutexLock lock(&mu_);
+    auto it = pooled_.find(std::make_pair(device_ordinal, size));
+    if (it != pooled_.end() && !it->second.empty()) {
+      void* ptr = it->second.back();
+      it->second.pop_back();
+      pooled_bytes_ -= size;
+      allocated_sizes_[ptr] = size;
+      return se::OwningDeviceMemory(se::DeviceMemoryBase(ptr, size),
+                                    device_ordinal, this);
+    }
+  }
+
+  StatusOr<se::OwningDeviceMemory> memory = allocator_->Allocate(
+      device_ordinal, size, retry_on_failure, memory_space);
+  if (!memory.ok() && pooled_bytes() > 0) {
+    // The pooled buffers of other sizes may be what the allocation is
+    // missing.
+    VLOG(1) << "Allocation of " << size << " bytes failed, freeing "
+            << pooled_bytes() << " pooled bytes and retrying: "
+            << memory.status();
+    Flush();
+    memory = allocator_->Allocate(device_ordinal, size, retry_on_failure,
+                                  memory_space);
+  }
+  TF_RETURN_IF_ERROR(memory.status());
+  se::DeviceMemoryBase mem = memory->Release();
+  if (memory_space == 0) {
+    absl::MutexLock lock(&mu_);
+    allocated_sizes_[mem.opaque()] = size;
+  }
+  return se::OwningDeviceMemory(mem, device_ordinal, this);
+}
+
+Status OutputBufferPool::Deallocate(int device_ordinal,
+                                    se::DeviceMemoryBase mem) {
+  if (mem.is_null()) {
+    return OkStatus();
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = allocated_sizes_.find(mem.opaque());
+    if (it != allocated_sizes_.end()) {
+      // Use the size the buffer was allocated with; callers may free a buffer
+      // through a DeviceMemoryBase of a different size.
+      uint64_t size = it->second;
+      allocated_sizes_.erase(it);
+      mem = se::DeviceMemoryBase(mem.opaque(), size);
+      if (pooled_bytes_ + static_cast<int64_t>(size) <= max_pooled_bytes_) {
+        pooled_[std::make_pair(device_ordinal, size)].push_back(mem.opaque());
+        pooled_bytes_ += size;
+        return OkStatus();
+      }
+    }
+  }
+  return allocator_->Deallocate(device_ordinal, mem);
+}
+
+int64_t OutputBufferPool::pooled_bytes() const {
+  absl::MutexLock lock(&mu_);
+  return pooled_bytes_;
+}
+
+void OutputBufferPool::Flush() {
+  absl::flat_hash_map<std::pair<int, uint64_t>, std::vector<void*>> pooled;
+  {
+    absl::MutexLock lock(&mu_);
+    std::swap(pooled, pooled_);
+    pooled_bytes_ = 0;
+  }
+  for (const auto& [key, ptrs] : pooled) {
+    for (void* ptr : ptrs) {
+      Status status = allocator_->Deallocate(
+          key.first, se::DeviceMemoryBase(ptr, key.second));
+      if (!status.ok()) {
+        LOG(ERROR) << "Failed to free pooled buffer: " << status;
+      }
+    }
+  }
+}
+
+}  // namespace xla
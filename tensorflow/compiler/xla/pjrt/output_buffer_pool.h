@@ -0,0 +1,86 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_PJRT_OUTPUT_BUFFER_POOL_H_
+#define TENSORFLOW_COMPILER_XLA_PJRT_OUTPUT_BUFFER_POOL_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/compiler/xla/stream_executor/device_memory_allocator.h"
+
+namespace xla {
+
+// An allocator that keeps the buffers freed through it, up to
+// `max_pooled_bytes` of them, and hands them out again for allocations of the
+// same size on the same device instead of allocating from `allocator`.
+//
+// Executions of the same executable allocate outputs (and temporary buffers)
+// of the same sizes, so in steady state, when the outputs of earlier
+// executions have been released, they run without allocating from
+// `allocator` even if their callers don't donate any input.
+//
+// Buffers that were not allocated through the pool are passed through to
+// `allocator` when freed, as are those of memory spaces other than the
+// default one. A pooled buffer is freed to `allocator` if an allocation from
+// it fails, or when the pool is destroyed.
+class OutputBufferPool : public se::DeviceMemoryAllocator {
+ public:
+  OutputBufferPool(se::DeviceMemoryAllocator* allocator,
+                   int64_t max_pooled_bytes);
+  ~OutputBufferPool() override;
+
+  StatusOr<se::OwningDeviceMemory> Allocate(int device_ordinal, uint64_t size,
+                                            bool retry_on_failure,
+                                            int64_t memory_space) override;
+  using se::DeviceMemoryAllocator::Allocate;
+
+  Status Deallocate(int device_ordinal, se::DeviceMemoryBase mem) override;
+
+  bool AllowsAsynchronousDeallocation() const override {
+    return allocator_->AllowsAsynchronousDeallocation();
+  }
+
+  StatusOr<se::Stream*> GetStream(int device_ordinal) override {
+    return allocator_->GetStream(device_ordinal);
+  }
+
+  // Returns the number of bytes held by the pool for reuse.
+  int64_t pooled_bytes() const;
+
+ private:
+  // Frees all pooled buffers to `allocator_`.
+  void Flush();
+
+  se::DeviceMemoryAllocator* const allocator_;
+  const int64_t max_pooled_bytes_;
+
+  mutable absl::Mutex mu_;
+  // The size of each buffer allocated through the pool and not freed yet.
+  absl::flat_hash_map<void*, uint64_t> allocated_sizes_ ABSL_GUARDED_BY(mu_);
+  // Freed buffers by device ordinal and size.
+  absl::flat_hash_map<std::pair<int, uint64_t>, std::vector<void*>> pooled_
+      ABSL_GUARDED_BY(mu_);
+  int64_t pooled_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_PJRT_OUTPUT_BUFFER_POOL_H_
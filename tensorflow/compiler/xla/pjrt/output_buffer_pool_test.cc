@@ -0,0 +1,100 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/pjrt/output_buffer_pool.h"
+
+#include <cstdlib>
+
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+
+namespace xla {
+namespace {
+
+// Allocates host memory and counts the calls made to it.
+class CountingAllocator : public se::DeviceMemoryAllocator {
+ public:
+  CountingAllocator() : se::DeviceMemoryAllocator(/*platform=*/nullptr) {}
+
+  StatusOr<se::OwningDeviceMemory> Allocate(int device_ordinal, uint64_t size,
+                                            bool retry_on_failure,
+                                            int64_t memory_space) override {
+    ++allocations;
+    return se::OwningDeviceMemory(
+        se::DeviceMemoryBase(std::malloc(size), size), device_ordinal, this);
+  }
+  using se::DeviceMemoryAllocator::Allocate;
+
+  Status Deallocate(int device_ordinal, se::DeviceMemoryBase mem) override {
+    if (!mem.is_null()) {
+      ++deallocations;
+      std::free(mem.opaque());
+    }
+    return OkStatus();
+  }
+
+  StatusOr<se::Stream*> GetStream(int device_ordinal) override {
+    return Unimplemented("GetStream");
+  }
+
+  int allocations = 0;
+  int deallocations = 0;
+};
+
+TEST(OutputBufferPoolTest, ReusesBuffersOfTheSameSize) {
+  CountingAllocator allocator;
+  {
+    OutputBufferPool pool(&allocator, /*max_pooled_bytes=*/1024);
+    TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory a, pool.Allocate(0, 256));
+    void* ptr = a->opaque();
+    TF_ASSERT_OK(a.Free());
+    EXPECT_EQ(pool.pooled_bytes(), 256);
+
+    TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory b, pool.Allocate(0, 256));
+    EXPECT_EQ(b->opaque(), ptr);
+    EXPECT_EQ(pool.pooled_bytes(), 0);
+    EXPECT_EQ(allocator.allocations, 1);
+
+    // Buffers of another size or on another device are not reused.
+    TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory c, pool.Allocate(0, 128));
+    TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory d, pool.Allocate(1, 256));
+    EXPECT_EQ(allocator.allocations, 3);
+  }
+  EXPECT_EQ(allocator.deallocations, 3);
+}
+
+TEST(OutputBufferPoolTest, FreesBuffersBeyondTheLimit) {
+  CountingAllocator allocator;
+  OutputBufferPool pool(&allocator, /*max_pooled_bytes=*/300);
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory a, pool.Allocate(0, 200));
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory b, pool.Allocate(0, 200));
+  TF_ASSERT_OK(a.Free());
+  TF_ASSERT_OK(b.Free());
+  EXPECT_EQ(pool.pooled_bytes(), 200);
+  EXPECT_EQ(allocator.deallocations, 1);
+}
+
+TEST(OutputBufferPoolTest, PassesThroughForeignBuffers) {
+  CountingAllocator allocator;
+  OutputBufferPool pool(&allocator, /*max_pooled_bytes=*/1024);
+  TF_ASSERT_OK_AND_ASSIGN(se::OwningDeviceMemory a,
+                          allocator.Allocate(0, 64));
+  TF_ASSERT_OK(pool.Deallocate(0, a.Release()));
+  EXPECT_EQ(pool.pooled_bytes(), 0);
+  EXPECT_EQ(allocator.deallocations, 1);
+}
+
+}  // namespace
+}  // namespace xla
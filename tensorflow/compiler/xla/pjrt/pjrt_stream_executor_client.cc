@@ -90,12 +90,14 @@ limitations under the License.
 #include "tensorflow/compiler/xla/cpu_function_runtime.h"
 #include "tensorflow/compiler/xla/executable_run_options.h"
 #include "tensorflow/compiler/xla/layout.h"
+#include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/pjrt/distributed/protocol.pb.h"
 #include "tensorflow/compiler/xla/pjrt/event_pool.h"
 #include "tensorflow/compiler/xla/pjrt/local_device_state.h"
 #include "tensorflow/compiler/xla/pjrt/metrics.h"
 #include "tensorflow/compiler/xla/pjrt/mlir_to_hlo.h"
+#include "tensorflow/compiler/xla/pjrt/output_buffer_pool.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_future.h"
 #include "tensorflow/compiler/xla/pjrt/tracked_device_buffer.h"
@@ -123,6 +125,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/statusor.h"
 #include "tensorflow/tsl/profiler/lib/connected_traceme.h"
 #include "tensorflow/tsl/profiler/lib/traceme.h"
+#include "tensorflow/tsl/util/env_var.h"
 
 namespace xla {
 
@@ -225,6 +228,18 @@ PjRtStreamExecutorClient::PjRtStreamExecutorClient(
     allocator_ = client_->backend().memory_allocator();
   }
 
+  // Opt-in recycling of the buffers allocated by executions. Executables that
+  // are run repeatedly then reuse the buffers of their earlier outputs once
+  // those are deleted, even if the caller does not donate any input.
+  int64_t output_buffer_pool_bytes;
+  TF_CHECK_OK(tsl::ReadInt64FromEnvVar("XLA_PJRT_OUTPUT_BUFFER_POOL_BYTES",
+                                       /*default_val=*/0,
+                                       &output_buffer_pool_bytes));
+  if (output_buffer_pool_bytes > 0) {
+    output_buffer_pool_ = std::make_unique<OutputBufferPool>(
+        allocator_, output_buffer_pool_bytes);
+  }
+
   if (!host_memory_allocator_) {
     host_memory_allocator_ = std::make_unique<CpuAllocator>();
   }
@@ -899,6 +914,137 @@ PjRtStreamExecutorClient::BufferFromHostBuffer(
   return std::unique_ptr<PjRtBuffer>(std::move(py_buffer));
 }
 
+StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>>
+PjRtStreamExecutorClient::BuffersFromHostBuffers(
+    absl::Span<const HostBuffer> host_buffers, PjRtDevice* device) {
+  tsl::profiler::TraceMe traceme(
+      "PjRtStreamExecutorClient::BuffersFromHostBuffers");
+  VLOG(1) << "PjRtStreamExecutorClient::BuffersFromHostBuffers: "
+          << host_buffers.size() << " buffers, device: "
+          << device->DebugString();
+  TF_ASSIGN_OR_RETURN(LocalDeviceState * local_device,
+                      tensorflow::down_cast<PjRtStreamExecutorDevice*>(device)
+                          ->GetLocalDeviceState());
+  TransferManager* transfer_manager = client()->backend().transfer_manager();
+
+  std::vector<std::unique_ptr<PjRtBuffer>> buffers(host_buffers.size());
+  // The buffers transferred through the staging allocation, and their offsets
+  // in it.
+  std::vector<int> batched;
+  std::vector<Shape> compact_shapes;
+  std::vector<int64_t> offsets;
+  int64_t staging_size = 0;
+  for (int i = 0; i < host_buffers.size(); ++i) {
+    const HostBuffer& host_buffer = host_buffers[i];
+    Shape shape = ShapeUtil::MakeShape(host_buffer.type, host_buffer.dims);
+    TF_ASSIGN_OR_RETURN(Shape compact_shape,
+                        transfer_manager->ChooseCompactLayoutForShape(shape));
+    if (!LayoutUtil::IsMonotonicWithDim0Major(compact_shape.layout())) {
+      // The device wants another dimension order, which would need a
+      // transpose into the staging allocation. Leave it to
+      // BufferFromHostBuffer.
+      TF_ASSIGN_OR_RETURN(
+          buffers[i],
+          BufferFromHostBuffer(
+              host_buffer.data, host_buffer.type, host_buffer.dims,
+              /*byte_strides=*/std::nullopt,
+              HostBufferSemantics::kImmutableOnlyDuringCall,
+              /*on_done_with_host_buffer=*/nullptr, device));
+      continue;
+    }
+    batched.push_back(i);
+    compact_shapes.push_back(std::move(compact_shape));
+    offsets.push_back(staging_size);
+    staging_size += RoundUpTo<int64_t>(ShapeUtil::ByteSizeOf(shape),
+                                       tsl::Allocator::kAllocatorAlignment);
+  }
+  if (batched.empty()) {
+    return buffers;
+  }
+
+  // All the batched buffers are defined by the same copy. Allocate them all
+  // before acquiring any hold, so that a failed allocation leaves no hold
+  // behind.
+  auto definition_event = std::make_shared<BufferSequencingEvent>();
+  std::vector<std::unique_ptr<PjRtStreamExecutorBuffer>> py_buffers;
+  for (const Shape& compact_shape : compact_shapes) {
+    TF_ASSIGN_OR_RETURN(
+        py_buffers.emplace_back(),
+        AllocateDestinationBuffer(compact_shape, device, local_device,
+                                  local_device->host_to_device_stream(),
+                                  /*is_uninitialized_create=*/false, this,
+                                  definition_event));
+  }
+  std::vector<PjRtStreamExecutorBuffer::ScopedHold::ForClosure> device_buffers;
+  std::vector<Shape> on_device_shapes;
+  for (int j = 0; j < batched.size(); ++j) {
+    PjRtStreamExecutorBuffer::ScopedHold device_buffer(
+        py_buffers[j]->GetBufferWithUsageHold());
+    CHECK(device_buffer.ok());
+    device_buffers.push_back(device_buffer.ToClosure());
+    on_device_shapes.push_back(py_buffers[j]->on_device_shape());
+    buffers[batched[j]] = std::move(py_buffers[j]);
+  }
+
+  void* ptr = host_memory_allocator()->AllocateRaw(
+      tsl::Allocator::kAllocatorAlignment, staging_size);
+  std::shared_ptr<void> staging_buffer(
+      ptr, [host_memory_allocator = host_memory_allocator()](void* ptr) {
+        host_memory_allocator->DeallocateRaw(ptr);
+      });
+  for (int j = 0; j < batched.size(); ++j) {
+    int64_t size = ShapeUtil::ByteSizeOf(compact_shapes[j]);
+    if (size > 0) {
+      std::memcpy(static_cast<char*>(staging_buffer.get()) + offsets[j],
+                  host_buffers[batched[j]].data, size);
+    }
+  }
+
+  // As in BufferFromHostBuffer, the transfers are enqueued on a thread pool.
+  // It is OK to capture the buffers because they can't be deleted until all
+  // the usage holds have gone away.
+  auto transfer_h2d = [transfer_manager, local_device,
+                       device_buffers{std::move(device_buffers)},
+                       on_device_shapes{std::move(on_device_shapes)},
+                       offsets{std::move(offsets)},
+                       staging_buffer{std::move(staging_buffer)},
+                       definition_event]() {
+    // This function uses TF_CHECK_OK and value() since we have no way to
+    // report failures from a callback, see BufferFromHostBuffer.
+    se::Stream* h2d_stream = local_device->host_to_device_stream();
+    std::vector<PjRtStreamExecutorBuffer::ScopedHold> holds;
+    holds.reserve(device_buffers.size());
+    for (int j = 0; j < device_buffers.size(); ++j) {
+      holds.emplace_back(device_buffers[j]);
+      ShapedBuffer buffer = holds.back()->AsShapedBuffer(on_device_shapes[j]);
+      BorrowingLiteral literal(
+          static_cast<const char*>(staging_buffer.get()) + offsets[j],
+          ShapeUtil::DeviceShapeToHostShape(on_device_shapes[j]));
+      TF_CHECK_OK(transfer_manager->TransferLiteralToDeviceAsync(
+          h2d_stream, literal, buffer));
+    }
+
+    StatusOr<EventPool::Handle> event_or =
+        local_device->event_pool().ThenAllocateAndRecordEvent(h2d_stream);
+    if (!event_or.ok()) {
+      StallStreamOnError(local_device, h2d_stream);
+    }
+    definition_event->SetSequencingEvent(std::move(event_or).value(),
+                                         h2d_stream);
+    for (PjRtStreamExecutorBuffer::ScopedHold& hold : holds) {
+      // See AddDestinationBufferSynchronization.
+      RecordUsage(std::move(hold), local_device, local_device,
+                  definition_event, h2d_stream,
+                  /*prefer_to_retain_reference=*/false);
+    }
+
+    local_device->ThenExecuteCallback(
+        h2d_stream, [staging_buffer{std::move(staging_buffer)}]() {});
+  };
+  thread_pool()->Schedule(transfer_h2d);
+  return buffers;
+}
+
 StatusOr<std::unique_ptr<PjRtBuffer>>
 PjRtStreamExecutorClient::CreateUninitializedBuffer(const Shape& shape,
                                                     PjRtDevice* device) {
@@ -1889,7 +2035,7 @@ PjRtStreamExecutorExecutable::MakeExecutionInputsAndWaitForEvents(
       ShapeTree<MaybeOwningDeviceMemory>::iterator iterator_end =
           execution_input.MutableBuffers()->end();
       device_buffers[i].AddToInput(&input_iterator, iterator_end,
-                                   &execution_input, client_->allocator());
+                                   &execution_input, client_->execute_allocator());
       CHECK(input_iterator == iterator_end);
     }
   }
@@ -2008,7 +2154,7 @@ StatusOr<ScopedShapedBuffer> PjRtStreamExecutorExecutable::EnqueueExecution(
   ExecutableRunOptions run_options;
   run_options.set_stream(device_state->compute_stream());
   run_options.set_host_to_device_stream(device_state->host_to_device_stream());
-  run_options.set_allocator(client_->allocator());
+  run_options.set_allocator(client_->execute_allocator());
   run_options.set_intra_op_thread_pool(
       client_->client()->backend().eigen_intra_op_thread_pool_device());
   run_options.set_device_assignment(device_assignment.get());
@@ -2063,8 +2209,8 @@ StatusOr<ScopedShapedBuffer> PjRtStreamExecutorExecutable::EnqueueExecution(
     compute_callbacks.push_back(
         [references{std::make_tuple(executables_[executable_idx],
                                     compute_reservation, device_assignment)},
-         donated_ptrs{std::move(donated_ptrs)}, allocator{client_->allocator()},
-         device_ordinal]() {
+         donated_ptrs{std::move(donated_ptrs)},
+         allocator{client_->execute_allocator()}, device_ordinal]() {
           for (const auto& ptr : donated_ptrs) {
             TF_CHECK_OK(allocator->Deallocate(device_ordinal, ptr));
           }
@@ -2108,7 +2254,8 @@ PjRtStreamExecutorExecutable::MakeOutputBuffers(
       ShapedBuffer root_buffer_holder = result_buffer.release();
       se::DeviceMemoryBase root_buffer = root_buffer_holder.root_buffer();
       compute_callbacks.push_back(
-          [root_buffer, allocator{client_->allocator()}, device_ordinal]() {
+          [root_buffer, allocator{client_->execute_allocator()},
+           device_ordinal]() {
             TF_CHECK_OK(allocator->Deallocate(device_ordinal, root_buffer));
           });
     }
@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/layout.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/pjrt/local_device_state.h"
+#include "tensorflow/compiler/xla/pjrt/output_buffer_pool.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_client.h"
 #include "tensorflow/compiler/xla/pjrt/pjrt_future.h"
 #include "tensorflow/compiler/xla/pjrt/tracked_device_buffer.h"
@@ -238,6 +239,24 @@ class PjRtStreamExecutorClient : public PjRtClient {
       std::function<void()> on_done_with_host_buffer,
       PjRtDevice* device) override;
 
+  // A dense array in major-to-minor layout to transfer with
+  // BuffersFromHostBuffers.
+  struct HostBuffer {
+    const void* data;
+    PrimitiveType type;
+    absl::Span<int64_t const> dims;
+  };
+
+  // Transfers several host buffers to `device` like BufferFromHostBuffer with
+  // kImmutableOnlyDuringCall semantics, but packs them into one staging
+  // allocation, copies them to the device in one task on the host-to-device
+  // stream and records one definition event shared by all the returned
+  // buffers. This avoids the per-transfer staging allocation, thread hop and
+  // event of BufferFromHostBuffer, which dominate the transfer of many small
+  // buffers, e.g. the parameters of a model.
+  StatusOr<std::vector<std::unique_ptr<PjRtBuffer>>> BuffersFromHostBuffers(
+      absl::Span<const HostBuffer> host_buffers, PjRtDevice* device);
+
   StatusOr<std::unique_ptr<PjRtBuffer>> BufferFromHostLiteral(
       const LiteralSlice& literal, PjRtDevice* device) override;
 
@@ -277,6 +296,12 @@ class PjRtStreamExecutorClient : public PjRtClient {
   }
   LocalClient* client() const { return client_; }
   se::DeviceMemoryAllocator* allocator() const { return allocator_; }
+  // Allocator for the buffers allocated by executions: the output buffer pool
+  // if one is enabled, else allocator().
+  se::DeviceMemoryAllocator* execute_allocator() const {
+    return output_buffer_pool_ != nullptr ? output_buffer_pool_.get()
+                                          : allocator_;
+  }
   tsl::Allocator* host_memory_allocator() const {
     return host_memory_allocator_.get();
   }
@@ -347,6 +372,9 @@ class PjRtStreamExecutorClient : public PjRtClient {
   // complete.
   se::DeviceMemoryAllocator* allocator_;
   std::unique_ptr<se::DeviceMemoryAllocator> owned_allocator_;
+  // Recycles the buffers freed after executions when
+  // XLA_PJRT_OUTPUT_BUFFER_POOL_BYTES is set; wraps allocator_.
+  std::unique_ptr<OutputBufferPool> output_buffer_pool_;
 
   // Includes all devices, including non-local devices on multi-host platforms.
   std::vector<std::unique_ptr<PjRtStreamExecutorDevice>> owned_devices_;
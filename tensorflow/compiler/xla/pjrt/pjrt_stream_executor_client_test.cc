@@ -114,5 +114,36 @@ TEST(PjRtStreamExecutorClientTest, DonateSameBufferTwice) {
               ::testing::HasSubstr("f(donate(a), donate(a))"));
 }
 
+TEST(PjRtStreamExecutorClientTest, BuffersFromHostBuffers) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetClient());
+  TF_ASSERT_OK_AND_ASSIGN(auto* device0, client->LookupDevice(0));
+  std::vector<float> a = {1, 2, 3};
+  std::vector<int32_t> b = {4, 5, 6, 7};
+  std::vector<float> c;
+  std::vector<int64_t> a_dims = {3};
+  std::vector<int64_t> b_dims = {2, 2};
+  std::vector<int64_t> c_dims = {0};
+  std::vector<PjRtStreamExecutorClient::HostBuffer> host_buffers = {
+      {a.data(), F32, a_dims}, {b.data(), S32, b_dims}, {c.data(), F32, c_dims}};
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<std::unique_ptr<PjRtBuffer>> buffers,
+      client->BuffersFromHostBuffers(host_buffers, device0));
+  // The host buffers only need to live for the duration of the call.
+  a.assign(a.size(), 0);
+  b.assign(b.size(), 0);
+  ASSERT_EQ(buffers.size(), 3);
+
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> a_literal,
+                          buffers[0]->ToLiteralSync());
+  EXPECT_THAT(a_literal->data<float>(), ::testing::ElementsAre(1, 2, 3));
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> b_literal,
+                          buffers[1]->ToLiteralSync());
+  EXPECT_EQ(b_literal->shape(), ShapeUtil::MakeShape(S32, {2, 2}));
+  EXPECT_THAT(b_literal->data<int32_t>(), ::testing::ElementsAre(4, 5, 6, 7));
+  TF_ASSERT_OK_AND_ASSIGN(std::shared_ptr<Literal> c_literal,
+                          buffers[2]->ToLiteralSync());
+  EXPECT_EQ(c_literal->element_count(), 0);
+}
+
 }  // namespace
 }  // namespace xla
@@ -120,6 +120,23 @@ static void EnqueueWorkWhenReady(
   });
 }
 
+// An Eigen device over an execution's share of the client's intra-op threads,
+// for as long as the execution runs. See TfrtCpuClient::StartIntraOpBudget().
+class ScopedIntraOpDevice {
+ public:
+  explicit ScopedIntraOpDevice(TfrtCpuClient* client)
+      : client_(client),
+        device_(client->eigen_intraop_pool()->AsEigenThreadPool(),
+                client->StartIntraOpBudget()) {}
+  ~ScopedIntraOpDevice() { client_->EndIntraOpBudget(); }
+
+  Eigen::ThreadPoolDevice* get() { return &device_; }
+
+ private:
+  TfrtCpuClient* client_;
+  Eigen::ThreadPoolDevice device_;
+};
+
 TfrtCpuDevice::TfrtCpuDevice(int id, bool asynchronous)
     : id_(id),
       max_inflight_computations_semaphore_(/*capacity=*/asynchronous ? 32 : 1) {
@@ -1623,6 +1640,8 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
     tsl::port::ScopedSetRound round(FE_TONEAREST);
 
     XlaCustomCallStatus status;
+    ScopedIntraOpDevice intra_op_device(client_);
+    run_options.set_intra_op_thread_pool(intra_op_device.get());
 
     // Call generated function.
     if (cpu_executable->IsXlaRuntime()) {
@@ -1660,7 +1679,7 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
         CopyAsyncValues(input_deps);
     EnqueueWorkWhenReady(
         client()->pjrt_client_thread_pool(), input_deps,
-        [cpu_executable, result_buffer,
+        [client = client_, cpu_executable, result_buffer,
          buffer_pointers = std::move(buffer_pointers),
          buffer_table = std::move(buffer_table),
          run_options = std::move(run_options),
@@ -1684,6 +1703,9 @@ StatusOr<PjRtLoadedExecutable::Result> TfrtCpuExecutable::ExecuteHelper(
           tsl::port::ScopedFlushDenormal flush;
           tsl::port::ScopedSetRound round(FE_TONEAREST);
 
+          ScopedIntraOpDevice intra_op_device(client);
+          run_options.set_intra_op_thread_pool(intra_op_device.get());
+
           // Call generated function.
           std::optional<absl::string_view> error_message;
           if (cpu_executable->IsXlaRuntime()) {
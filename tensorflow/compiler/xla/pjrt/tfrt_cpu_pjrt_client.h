@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_PJRT_TFRT_CPU_PJRT_CLIENT_H_
 #define TENSORFLOW_COMPILER_XLA_PJRT_TFRT_CPU_PJRT_CLIENT_H_
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <optional>
@@ -232,6 +234,22 @@ class TfrtCpuClient final : public PjRtClient {
     return eigen_intraop_device_.get();
   }
 
+  // Budgets the intra-op parallelism of executions: the intra-op threads are
+  // split evenly between the executions running concurrently, so that serving
+  // several programs at once doesn't oversubscribe the pool, while an
+  // execution running alone still gets all of them. Returns the number of
+  // threads an execution starting now may use; it must call
+  // EndIntraOpBudget() when it finishes.
+  int StartIntraOpBudget() {
+    int running = num_running_executions_.fetch_add(1) + 1;
+    return std::max(1, eigen_intraop_pool_->NumThreads() / running);
+  }
+  void EndIntraOpBudget() { num_running_executions_.fetch_sub(1); }
+
+  tsl::thread::ThreadPool* eigen_intraop_pool() const {
+    return eigen_intraop_pool_.get();
+  }
+
   tfrt::AsyncValueRef<CpuEvent> GetLastCollectiveLaunchEvent() {
     absl::MutexLock lock(&mu_);
     return last_collective_launch_event_.CopyRef();
@@ -260,6 +278,8 @@ class TfrtCpuClient final : public PjRtClient {
   // TODO(zhangqiaorjc): Use tfrt::compat::EigenHostContextThreadPool.
   std::unique_ptr<tsl::thread::ThreadPool> eigen_intraop_pool_;
   std::unique_ptr<Eigen::ThreadPoolDevice> eigen_intraop_device_;
+  // Number of executions running, see StartIntraOpBudget().
+  std::atomic<int> num_running_executions_{0};
 
   // Launching collectives are prone to deadlock when we use fixed-sized
   // threadpools since ExecuteHelper will block until all replicas reach the
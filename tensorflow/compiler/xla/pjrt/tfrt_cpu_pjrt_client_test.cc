@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/pjrt/tfrt_cpu_pjrt_client.h"
 
+#include <algorithm>
 #include <vector>
 
 #include <gmock/gmock.h>
@@ -22,6 +23,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/custom_call_status.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/tsl/platform/casts.h"
 
 namespace xla {
 namespace {
@@ -72,5 +74,18 @@ ENTRY DonationWithExecutionError() -> f32[2, 2] {
               ::testing::HasSubstr("buffer has been deleted or donated."));
 }
 
+TEST(TfrtCpuClientTest, IntraOpBudgetIsSplitBetweenExecutions) {
+  TF_ASSERT_OK_AND_ASSIGN(auto client, GetTfrtCpuClient(/*asynchronous=*/true));
+  auto* cpu_client = tensorflow::down_cast<TfrtCpuClient*>(client.get());
+  int num_threads = cpu_client->eigen_intraop_pool()->NumThreads();
+
+  EXPECT_EQ(cpu_client->StartIntraOpBudget(), num_threads);
+  EXPECT_EQ(cpu_client->StartIntraOpBudget(), std::max(1, num_threads / 2));
+  cpu_client->EndIntraOpBudget();
+  cpu_client->EndIntraOpBudget();
+  EXPECT_EQ(cpu_client->StartIntraOpBudget(), num_threads);
+  cpu_client->EndIntraOpBudget();
+}
+
 }  // namespace
 }  // namespace xla
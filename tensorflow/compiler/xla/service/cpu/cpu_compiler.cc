@@ -18,6 +18,7 @@ limitations under the License.
 #include <stddef.h>
 #include <string.h>
 
+#include <algorithm>
 #include <functional>
 #include <map>
 #include <memory>
@@ -37,7 +38,11 @@ limitations under the License.
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Mangler.h"
@@ -47,9 +52,12 @@ limitations under the License.
 #include "llvm/Object/ObjectFile.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "mlir/Conversion/AffineToStandard/AffineToStandard.h"  // from @llvm-project
 #include "mlir/Conversion/ReconcileUnrealizedCasts/ReconcileUnrealizedCasts.h"  // from @llvm-project
 #include "mlir/Dialect/Affine/IR/AffineOps.h"  // from @llvm-project
@@ -181,8 +189,10 @@ limitations under the License.
 #include "tensorflow/compiler/xla/translate/hlo_to_mhlo/hlo_to_mlir_hlo.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
+#include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 #include "tensorflow/tsl/protobuf/error_codes.pb.h"
 
 namespace {
@@ -879,6 +889,37 @@ Status VerifyLlvmModule(const llvm::Module& llvm_module) {
   return OkStatus();
 }
 
+// Splits `llvm_module` into up to `max_parts` modules that can be compiled
+// concurrently. Each part gets a context of its own, and the internal
+// functions and globals that the parts share are made hidden external ones.
+std::vector<llvm::orc::ThreadSafeModule> SplitLlvmModule(
+    llvm::Module& llvm_module, int max_parts) {
+  int num_functions = 0;
+  for (const llvm::Function& function : llvm_module.functions()) {
+    if (!function.isDeclaration()) ++num_functions;
+  }
+  std::vector<llvm::orc::ThreadSafeModule> parts;
+  llvm::SplitModule(
+      llvm_module, std::max(1, std::min(max_parts, num_functions)),
+      [&](std::unique_ptr<llvm::Module> part) {
+        // The parts share the context of `llvm_module`, so move each one to
+        // its own context by round-tripping it through bitcode.
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream os(bitcode);
+        llvm::WriteBitcodeToFile(*part, os);
+        auto context = std::make_unique<llvm::LLVMContext>();
+        std::unique_ptr<llvm::Module> module = llvm::cantFail(
+            llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(
+                    llvm::StringRef(bitcode.data(), bitcode.size()),
+                    part->getModuleIdentifier()),
+                *context));
+        parts.emplace_back(std::move(module), std::move(context));
+      },
+      /*PreserveLocals=*/false);
+  return parts;
+}
+
 Status CreateHloProfilingArtifacts(
     const HloModule& module,
     absl::flat_hash_map<const HloInstruction*, int64_t>*
@@ -1306,9 +1347,28 @@ CpuCompiler::CompileLegacyCpuExecutable(std::unique_ptr<HloModule> module) {
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
   // JIT compile the LLVM IR module to in-memory machine code.
-  llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
-                                                 std::move(llvm_context));
-  cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  const int compilation_parallelism =
+      module->config().debug_options().xla_cpu_force_compilation_parallelism();
+  // The IR hooks and dumps expect to see the whole module, so it is not split
+  // when they are in use.
+  if (compilation_parallelism > 1 && !DumpingEnabledForHloModule(*module) &&
+      !user_pre_optimization_hook_ && !user_post_optimization_hook_) {
+    std::vector<llvm::orc::ThreadSafeModule> parts =
+        SplitLlvmModule(*llvm_module, compilation_parallelism);
+    VLOG(1) << "Compiling " << module->name() << " in " << parts.size()
+            << " parts";
+    tsl::thread::ThreadPool thread_pool(tsl::Env::Default(), "xla_cpu_codegen",
+                                        parts.size());
+    if (llvm::Error err =
+            (*jit)->AddModulesInParallel(std::move(parts), &thread_pool)) {
+      return InternalError("Compiling LLVM IR failed: %s",
+                           llvm::toString(std::move(err)));
+    }
+  } else {
+    llvm::orc::ThreadSafeModule thread_safe_module(std::move(llvm_module),
+                                                   std::move(llvm_context));
+    cantFail((*jit)->AddModule(std::move(thread_safe_module)));
+  }
 
   auto cpu_executable = std::make_unique<CpuExecutable>(
       std::move(*jit), std::move(assignment), std::move(module), function_name,
@@ -1913,7 +1913,11 @@ Status IrEmitter::HandleReduce(HloInstruction* reduce) {
   auto cleanup = absl::MakeCleanup([saved_allow_reassociation, this]() {
     allow_reassociation_ = saved_allow_reassociation;
   });
-  if (!options::VectorizedReduceDisabled(hlo_module_config_)) {
+  // The vectorized reduction computes the whole output, so it would be repeated
+  // by every parallel task. The parallel loop emitter splits the output
+  // between them instead.
+  if (!options::VectorizedReduceDisabled(hlo_module_config_) &&
+      !ShouldEmitParallelLoopFor(*reduce)) {
     std::string vectorization_failure_reason;
     TF_ASSIGN_OR_RETURN(
         bool vectorization_successful,
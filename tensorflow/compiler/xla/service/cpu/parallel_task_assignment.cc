@@ -80,8 +80,12 @@ class DefaultCostModel : public ParallelCostModel {
       // TODO(b/29630486) Develop system bandwidth model.
       max_parallelism = std::min<int64_t>(
           max_parallelism_, std::ceil(std::sqrt(tsl::port::MaxParallelism())));
-      // Use shape size instruction cost and L2 cache size min per-thread cost.
-      instruction_cost = shape_size_(instruction->shape());
+      // Use the bytes read and written as instruction cost, so that e.g.
+      // reductions of large arrays to small ones are split as well, and L2
+      // cache size min per-thread cost.
+      instruction_cost =
+          std::max(cost_analysis_->bytes_accessed(*instruction),
+                   shape_size_(instruction->shape()));
       min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     } else {
       // Use max parallelism for compute bound instructions.
@@ -115,10 +119,15 @@ ParallelTaskAssignment::ParallelTaskAssignment(
     const TargetMachineFeatures* target_machine_features)
     : target_machine_features_(*target_machine_features) {
   VLOG(1) << "ParallelTaskAssignment max_parallelism: " << max_parallelism;
-  // Run cost analysis on 'module'.
+  // Run cost analysis on 'module'. Instructions are assigned parallel tasks in
+  // the bodies of while loops and called computations too, so all of their
+  // costs are needed.
   auto cost_analysis = std::make_unique<HloCostAnalysis>(shape_size);
-  HloComputation* computation = module->entry_computation();
-  Status status = computation->root_instruction()->Accept(cost_analysis.get());
+  Status status = OkStatus();
+  for (HloComputation* computation : module->MakeNonfusionComputations()) {
+    status = computation->Accept(cost_analysis.get());
+    if (!status.ok()) break;
+  }
   if (status.ok()) {
     // Set default cost model based on 'cost_analysis'.
     cost_model_.reset(new DefaultCostModel(max_parallelism, shape_size,
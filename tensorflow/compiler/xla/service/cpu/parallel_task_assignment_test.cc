@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/test.h"
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/cpu_info.h"
 
 namespace xla {
 namespace {
@@ -206,5 +207,44 @@ TEST_F(ParallelTaskAssignmentTest, ConstantNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, ReduceInWhileBodyParallelized) {
+  // Reductions are I/O bound, and their parallelism is limited to the square
+  // root of the number of cores.
+  if (tsl::port::MaxParallelism() < 4) {
+    GTEST_SKIP() << "Needs at least 4 cores";
+  }
+  constexpr char hlo_string[] = R"(
+  HloModule TestTaskParallel_reduce_in_while
+    add {
+      lhs = f32[] parameter(0)
+      rhs = f32[] parameter(1)
+      ROOT add = f32[] add(lhs, rhs)
+    }
+    body {
+      param = (f32[256,65536], f32[256]) parameter(0)
+      input = f32[256,65536] get-tuple-element(param), index=0
+      zero = f32[] constant(0)
+      reduce = f32[256] reduce(input, zero), dimensions={1}, to_apply=add
+      ROOT tuple = (f32[256,65536], f32[256]) tuple(input, reduce)
+    }
+    cond {
+      param = (f32[256,65536], f32[256]) parameter(0)
+      ROOT pred = pred[] constant(true)
+    }
+    ENTRY main {
+      input = f32[256,65536] parameter(0)
+      init = f32[256] parameter(1)
+      tuple = (f32[256,65536], f32[256]) tuple(input, init)
+      ROOT while = (f32[256,65536], f32[256]) while(tuple), condition=cond,
+        body=body
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+}
+
 }  // namespace
 }  // namespace xla
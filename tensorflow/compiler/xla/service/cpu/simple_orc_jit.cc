@@ -21,7 +21,9 @@ limitations under the License.
 #include <cstdio>
 #include <list>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
@@ -55,6 +57,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/logging.h"
 
 // Provided by compiler-rt and MLIR.
@@ -107,6 +110,14 @@ SimpleOrcJIT::SimpleOrcJIT(
     LLVMCompiler::ModuleHook post_optimization_hook,
     std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
     : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+      target_options_(target_options),
+      opt_level_(opt_level),
+      optimize_for_size_(optimize_for_size),
+      disable_expensive_passes_(disable_expensive_passes),
+      fast_math_flags_(fast_math_flags),
+      pre_optimization_hook_(pre_optimization_hook),
+      post_optimization_hook_(post_optimization_hook),
+      post_codegen_hook_(post_codegen_hook),
       target_triple_(target_machine_->getTargetTriple()),
       data_layout_(target_machine_->createDataLayout()),
       target_process_control_(std::move(target_process_control)),
@@ -121,8 +132,8 @@ SimpleOrcJIT::SimpleOrcJIT(
           std::make_unique<CompilerFunctor>(
               target_machine_.get(), opt_level, optimize_for_size,
               disable_expensive_passes, fast_math_flags,
-              std::move(pre_optimization_hook),
-              std::move(post_optimization_hook), std::move(post_codegen_hook))),
+              pre_optimization_hook, post_optimization_hook,
+              post_codegen_hook)),
       main_jit_dylib_(&execution_session_->createBareJITDylib("<main>")),
       gdb_jit_event_listener_(
           llvm::JITEventListener::createGDBRegistrationListener()) {
@@ -236,6 +247,52 @@ llvm::Error SimpleOrcJIT::AddModule(llvm::orc::ThreadSafeModule module) {
   return compile_layer_.add(*main_jit_dylib_, std::move(module));
 }
 
+llvm::Error SimpleOrcJIT::AddModulesInParallel(
+    std::vector<llvm::orc::ThreadSafeModule> modules,
+    tsl::thread::ThreadPool* thread_pool) {
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects(modules.size());
+  std::vector<std::string> errors(modules.size());
+  tsl::BlockingCounter counter(modules.size());
+  for (size_t i = 0; i < modules.size(); ++i) {
+    thread_pool->Schedule([this, &modules, &objects, &errors, &counter, i]() {
+      // Target machines are not thread-safe, so each module gets its own.
+      std::unique_ptr<llvm::TargetMachine> target_machine =
+          InferTargetMachineForJIT(target_options_, opt_level_);
+      CompilerFunctor compiler(target_machine.get(), opt_level_,
+                               optimize_for_size_, disable_expensive_passes_,
+                               fast_math_flags_, pre_optimization_hook_,
+                               post_optimization_hook_, post_codegen_hook_);
+      modules[i].withModuleDo([&](llvm::Module& module) {
+        llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> object =
+            compiler(module);
+        if (object) {
+          objects[i] = std::move(*object);
+        } else {
+          errors[i] = llvm::toString(object.takeError());
+        }
+      });
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+
+  for (const std::string& error : errors) {
+    if (!error.empty()) {
+      return llvm::make_error<llvm::StringError>(
+          error, llvm::inconvertibleErrorCode());
+    }
+  }
+  // The objects are linked against each other when their symbols are first
+  // looked up.
+  for (std::unique_ptr<llvm::MemoryBuffer>& object : objects) {
+    if (llvm::Error err =
+            object_layer_.add(*main_jit_dylib_, std::move(object))) {
+      return err;
+    }
+  }
+  return llvm::Error::success();
+}
+
 void SimpleOrcJIT::DoneCompiling() {
   // The target machine takes a non-trivial amount of memory, so once we are
   // done compiling throw it away.
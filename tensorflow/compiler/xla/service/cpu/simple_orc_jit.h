@@ -31,6 +31,7 @@ limitations under the License.
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 
 namespace xla {
 namespace cpu {
@@ -40,7 +41,7 @@ namespace cpu {
 // This class wraps Orc's functionality into a single interface that only
 // exposes what we need for XLA.
 //
-// Supports JIT-ing multiple modules but without cross-module linking.
+// Supports JIT-ing multiple modules, which may reference each other's symbols.
 // Implements eager compilation - the module is lowered to binary as soon as
 // it's added to the JIT.
 class SimpleOrcJIT : public llvm::JITEventListener {
@@ -79,6 +80,14 @@ class SimpleOrcJIT : public llvm::JITEventListener {
 
   llvm::Error AddModule(llvm::orc::ThreadSafeModule module);
 
+  // Optimizes and compiles `modules` to object code concurrently on
+  // `thread_pool` and adds them to the JIT. Every module must have its own
+  // context. The optimization and codegen hooks run concurrently, once per
+  // module.
+  llvm::Error AddModulesInParallel(
+      std::vector<llvm::orc::ThreadSafeModule> modules,
+      tsl::thread::ThreadPool* thread_pool);
+
   // Discards objects we no longer need once we are done compiling.
   void DoneCompiling();
 
@@ -109,6 +118,15 @@ class SimpleOrcJIT : public llvm::JITEventListener {
   void notifyFreeingObject(llvm::JITEventListener::ObjectKey key) override;
 
   std::unique_ptr<llvm::TargetMachine> target_machine_;
+  // Options to create the compilers of AddModulesInParallel with.
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const bool optimize_for_size_;
+  const bool disable_expensive_passes_;
+  const llvm::FastMathFlags fast_math_flags_;
+  const LLVMCompiler::ModuleHook pre_optimization_hook_;
+  const LLVMCompiler::ModuleHook post_optimization_hook_;
+  const std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook_;
   llvm::Triple target_triple_;
   const llvm::DataLayout data_layout_;
   std::unique_ptr<llvm::orc::ExecutorProcessControl> target_process_control_;
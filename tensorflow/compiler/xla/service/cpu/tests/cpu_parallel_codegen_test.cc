@@ -0,0 +1,90 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/compiler/xla/service/cpu/tests/cpu_codegen_test.h"
+#include "tensorflow/compiler/xla/tests/literal_test_util.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class CpuParallelCodegenTest : public CpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = CpuCodegenTest::GetDebugOptionsForTest();
+    debug_options.set_xla_cpu_force_compilation_parallelism(4);
+    return debug_options;
+  }
+};
+
+// The subcomputations end up in different parts of the split module, so the
+// entry computation calls into the other parts.
+TEST_F(CpuParallelCodegenTest, SubcomputationsInOtherParts) {
+  const std::string hlo_text = R"(
+HloModule module
+
+add {
+  add.p0 = f32[] parameter(0)
+  add.p1 = f32[] parameter(1)
+  ROOT add.sum = f32[] add(add.p0, add.p1)
+}
+
+max {
+  max.p0 = f32[] parameter(0)
+  max.p1 = f32[] parameter(1)
+  ROOT max.max = f32[] maximum(max.p0, max.p1)
+}
+
+body {
+  body.p0 = (s32[], f32[4]) parameter(0)
+  body.i = s32[] get-tuple-element(body.p0), index=0
+  body.c1 = s32[] constant(1)
+  body.next = s32[] add(body.i, body.c1)
+  body.x = f32[4] get-tuple-element(body.p0), index=1
+  ROOT body.root = (s32[], f32[4]) tuple(body.next, body.x)
+}
+
+cond {
+  cond.p0 = (s32[], f32[4]) parameter(0)
+  cond.i = s32[] get-tuple-element(cond.p0), index=0
+  cond.c3 = s32[] constant(3)
+  ROOT cond.root = pred[] compare(cond.i, cond.c3), direction=LT
+}
+
+ENTRY entry {
+  entry.x = f32[4] constant({1, 2, 3, 4})
+  entry.c0 = s32[] constant(0)
+  entry.init = (s32[], f32[4]) tuple(entry.c0, entry.x)
+  entry.while = (s32[], f32[4]) while(entry.init), condition=cond, body=body
+  entry.y = f32[4] get-tuple-element(entry.while), index=1
+  entry.zero = f32[] constant(0)
+  entry.sum = f32[] reduce(entry.y, entry.zero), dimensions={0}, to_apply=add
+  entry.max = f32[] reduce(entry.y, entry.zero), dimensions={0}, to_apply=max
+  ROOT entry.root = f32[] add(entry.sum, entry.max)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+
+  auto result = ExecuteAndTransfer(std::move(module), {});
+
+  LiteralTestUtil::ExpectR0Equal(14.0f, result);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,308 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/dot_grouper.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/graphcycles/graphcycles.h"
+#include "tensorflow/compiler/xla/service/hlo_creation_utils.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/compiler/xla/util.h"
+
+namespace xla {
+namespace {
+
+// Groups with fewer dots than this don't save enough kernel launches to pay
+// for copying their operands.
+constexpr int64_t kMinGroupSize = 3;
+
+// The padded work and operands of a group may be at most this many times
+// those of its dots.
+constexpr int64_t kMaxPaddingFactor = 2;
+
+// Returns true if `dot` is a matrix multiplication [m,k] x [k,n] -> [m,n].
+bool IsPlainMatmul(const HloInstruction* dot) {
+  if (dot->opcode() != HloOpcode::kDot || dot->shape().rank() != 2 ||
+      dot->operand(0)->shape().rank() != 2 ||
+      dot->operand(1)->shape().rank() != 2) {
+    return false;
+  }
+  const DotDimensionNumbers& dnums = dot->dot_dimension_numbers();
+  return dnums.lhs_batch_dimensions_size() == 0 &&
+         dnums.lhs_contracting_dimensions_size() == 1 &&
+         dnums.lhs_contracting_dimensions(0) == 1 &&
+         dnums.rhs_contracting_dimensions_size() == 1 &&
+         dnums.rhs_contracting_dimensions(0) == 0;
+}
+
+// Returns true if `a` and `b` may run as one batched dot.
+bool AreGroupable(const HloInstruction* a, const HloInstruction* b) {
+  return a->operand(0)->shape().element_type() ==
+             b->operand(0)->shape().element_type() &&
+         a->operand(1)->shape().element_type() ==
+             b->operand(1)->shape().element_type() &&
+         a->shape().element_type() == b->shape().element_type() &&
+         absl::c_equal(a->precision_config().operand_precision(),
+                       b->precision_config().operand_precision());
+}
+
+struct MatmulDims {
+  int64_t m = 0;
+  int64_t k = 0;
+  int64_t n = 0;
+
+  explicit MatmulDims(const HloInstruction* dot)
+      : m(dot->shape().dimensions(0)),
+        k(dot->operand(0)->shape().dimensions(1)),
+        n(dot->shape().dimensions(1)) {}
+
+  int64_t work() const { return m * k * n; }
+  int64_t operand_elements() const { return m * k + k * n; }
+};
+
+// Returns true if padding `group` plus `candidate` to the largest dimensions
+// among them at most multiplies their work and operands by
+// kMaxPaddingFactor.
+bool PaddingIsAffordable(absl::Span<HloInstruction* const> group,
+                         HloInstruction* candidate) {
+  MatmulDims max_dims(candidate);
+  int64_t work = max_dims.work();
+  int64_t operand_elements = max_dims.operand_elements();
+  for (const HloInstruction* dot : group) {
+    MatmulDims dims(dot);
+    max_dims.m = std::max(max_dims.m, dims.m);
+    max_dims.k = std::max(max_dims.k, dims.k);
+    max_dims.n = std::max(max_dims.n, dims.n);
+    work += dims.work();
+    operand_elements += dims.operand_elements();
+  }
+  const int64_t group_size = group.size() + 1;
+  return group_size * max_dims.work() <= kMaxPaddingFactor * work &&
+         group_size * max_dims.operand_elements() <=
+             kMaxPaddingFactor * operand_elements;
+}
+
+// Pads operand `operand_index` of each of `dots` with zeros to
+// [rows, cols] and stacks them into one [dots.size(), rows, cols] array.
+StatusOr<HloInstruction*> PadAndStack(absl::Span<HloInstruction* const> dots,
+                                      int64_t operand_index, int64_t rows,
+                                      int64_t cols) {
+  std::vector<HloInstruction*> stacked;
+  stacked.reserve(dots.size());
+  for (HloInstruction* dot : dots) {
+    HloInstruction* operand = dot->mutable_operand(operand_index);
+    const Shape& shape = operand->shape();
+    if (shape.dimensions(0) != rows || shape.dimensions(1) != cols) {
+      HloInstruction* zero =
+          dot->parent()->AddInstruction(HloInstruction::CreateConstant(
+              LiteralUtil::Zero(shape.element_type())));
+      PaddingConfig padding_config = MakeNoPaddingConfig(2);
+      padding_config.mutable_dimensions(0)->set_edge_padding_high(
+          rows - shape.dimensions(0));
+      padding_config.mutable_dimensions(1)->set_edge_padding_high(
+          cols - shape.dimensions(1));
+      TF_ASSIGN_OR_RETURN(operand, MakePadHlo(operand, zero, padding_config));
+    }
+    TF_ASSIGN_OR_RETURN(operand, MakeReshapeHlo({1, rows, cols}, operand));
+    stacked.push_back(operand);
+  }
+  return MakeConcatHlo(stacked, /*dimension=*/0);
+}
+
+// Replaces `dots` with slices of one batched dot.  Returns the batched dot.
+StatusOr<HloInstruction*> GroupDots(absl::Span<HloInstruction* const> dots) {
+  VLOG(2) << "Grouping " << dots.size() << " dots, the first one is "
+          << dots.front()->ToString();
+  MatmulDims max_dims(dots.front());
+  for (const HloInstruction* dot : dots) {
+    MatmulDims dims(dot);
+    max_dims.m = std::max(max_dims.m, dims.m);
+    max_dims.k = std::max(max_dims.k, dims.k);
+    max_dims.n = std::max(max_dims.n, dims.n);
+  }
+  TF_ASSIGN_OR_RETURN(HloInstruction * lhs,
+                      PadAndStack(dots, 0, max_dims.m, max_dims.k));
+  TF_ASSIGN_OR_RETURN(HloInstruction * rhs,
+                      PadAndStack(dots, 1, max_dims.k, max_dims.n));
+
+  DotDimensionNumbers dnums;
+  dnums.add_lhs_batch_dimensions(0);
+  dnums.add_rhs_batch_dimensions(0);
+  dnums.add_lhs_contracting_dimensions(2);
+  dnums.add_rhs_contracting_dimensions(1);
+  const HloInstruction* with_metadata = dots.front();
+  for (const HloInstruction* dot : dots) {
+    if (!dot->metadata().op_name().empty()) {
+      with_metadata = dot;
+      break;
+    }
+  }
+  TF_ASSIGN_OR_RETURN(
+      HloInstruction * grouped,
+      MakeDotHlo(lhs, rhs, dnums, dots.front()->precision_config(),
+                 /*preferred_element_type=*/dots.front()->shape().element_type(),
+                 &with_metadata->metadata()));
+
+  for (int64_t i = 0; i < dots.size(); ++i) {
+    HloInstruction* dot = dots[i];
+    TF_ASSIGN_OR_RETURN(
+        HloInstruction * slice,
+        MakeSliceHlo(grouped, {i, 0, 0},
+                     {i + 1, dot->shape().dimensions(0),
+                      dot->shape().dimensions(1)},
+                     {1, 1, 1}));
+    TF_ASSIGN_OR_RETURN(HloInstruction * result,
+                        MakeReshapeHlo(dot->shape(), slice));
+    // As in DotMerger, the old dots must live until the end of the pass.
+    TF_RETURN_IF_ERROR(dot->ReplaceAllUsesWith(result));
+  }
+  return grouped;
+}
+
+StatusOr<bool> GroupDotsInComputation(HloComputation* comp,
+                                      int64_t max_size_to_group) {
+  // Buckets of dots that AreGroupable() with each other, in post order.
+  std::vector<std::vector<HloInstruction*>> buckets;
+  for (HloInstruction* instr : comp->MakeInstructionPostOrder()) {
+    if (!IsPlainMatmul(instr) || !instr->control_predecessors().empty() ||
+        !instr->control_successors().empty()) {
+      continue;
+    }
+    int64_t bytes = ShapeUtil::ByteSizeOfElements(instr->shape());
+    for (const HloInstruction* operand : instr->operands()) {
+      bytes += ShapeUtil::ByteSizeOfElements(operand->shape());
+    }
+    if (bytes > max_size_to_group) {
+      continue;
+    }
+    auto bucket = absl::c_find_if(buckets, [&](const auto& existing) {
+      return AreGroupable(existing.front(), instr);
+    });
+    if (bucket == buckets.end()) {
+      buckets.push_back({instr});
+    } else {
+      bucket->push_back(instr);
+    }
+  }
+  if (absl::c_none_of(buckets, [](const auto& bucket) {
+        return bucket.size() >= kMinGroupSize;
+      })) {
+    return false;
+  }
+
+  // Build a dependency graph representing the whole computation, as in
+  // DotMerger.
+  tensorflow::GraphCycles graph;
+  absl::flat_hash_map<HloInstruction*, int32_t> graph_ids_map;
+  auto graph_id = [&](HloInstruction* instr) {
+    auto [it, inserted] = graph_ids_map.emplace(instr, -1);
+    if (inserted) {
+      it->second = graph.NewNode();
+    }
+    return it->second;
+  };
+  for (HloInstruction* instr : comp->MakeInstructionPostOrder()) {
+    int32_t id = graph_id(instr);
+    for (HloInstruction* operand : instr->operands()) {
+      CHECK(graph.InsertEdge(graph_id(operand), id));
+    }
+    for (HloInstruction* control_pred : instr->control_predecessors()) {
+      CHECK(graph.InsertEdge(graph_id(control_pred), id));
+    }
+  }
+
+  std::vector<HloInstruction*> dead_instrs;
+  for (std::vector<HloInstruction*>& bucket : buckets) {
+    // Grouping dots of similar sizes keeps the padding small.
+    absl::c_stable_sort(bucket,
+                        [](const HloInstruction* a, const HloInstruction* b) {
+                          return MatmulDims(a).work() < MatmulDims(b).work();
+                        });
+    std::vector<bool> used(bucket.size(), false);
+    for (int64_t i = 0; i < bucket.size(); ++i) {
+      if (used[i]) {
+        continue;
+      }
+      std::vector<HloInstruction*> group = {bucket[i]};
+      std::vector<int64_t> members = {i};
+      for (int64_t j = i + 1; j < bucket.size(); ++j) {
+        if (used[j]) {
+          continue;
+        }
+        // Dots that are independent pairwise can run as one.
+        int32_t candidate = graph_id(bucket[j]);
+        bool independent = absl::c_all_of(group, [&](HloInstruction* member) {
+          int32_t member_id = graph_id(member);
+          return !graph.IsReachableNonConst(member_id, candidate) &&
+                 !graph.IsReachableNonConst(candidate, member_id);
+        });
+        if (!independent || !PaddingIsAffordable(group, bucket[j])) {
+          continue;
+        }
+        group.push_back(bucket[j]);
+        members.push_back(j);
+      }
+      if (group.size() < kMinGroupSize) {
+        continue;
+      }
+      TF_ASSIGN_OR_RETURN(HloInstruction * grouped, GroupDots(group));
+      // The grouped dot depends on the operands of every member, and their
+      // users depend on it.
+      int32_t grouped_id = graph_id(grouped);
+      for (HloInstruction* member : group) {
+        int32_t member_id = graph_id(member);
+        CHECK(graph.InsertEdge(member_id, grouped_id));
+        for (int32_t succ : graph.SuccessorsCopy(member_id)) {
+          if (succ != grouped_id) {
+            CHECK(graph.InsertEdge(grouped_id, succ));
+          }
+        }
+      }
+      for (int64_t member : members) {
+        used[member] = true;
+      }
+      dead_instrs.insert(dead_instrs.end(), group.begin(), group.end());
+    }
+  }
+
+  for (HloInstruction* instr : dead_instrs) {
+    TF_RETURN_IF_ERROR(comp->RemoveInstruction(instr));
+  }
+  return !dead_instrs.empty();
+}
+
+}  // namespace
+
+StatusOr<bool> DotGrouper::Run(
+    HloModule* module,
+    const absl::flat_hash_set<absl::string_view>& execution_threads) {
+  bool changed = false;
+  for (HloComputation* comp :
+       module->MakeNonfusionComputations(execution_threads)) {
+    TF_ASSIGN_OR_RETURN(bool changed_computation,
+                        GroupDotsInComputation(comp, max_size_to_group_));
+    changed |= changed_computation;
+  }
+  return changed;
+}
+
+}  // namespace xla
@@ -0,0 +1,67 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_DOT_GROUPER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_DOT_GROUPER_H_
+
+#include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
+
+namespace xla {
+
+// Groups independent matrix multiplications that do not share an operand
+// into one batched dot.  Transforms
+//
+//   x = f32[16,20] dot(f32[16,30] a, f32[30,20] b)
+//   y = f32[16,16] dot(f32[16,32] c, f32[32,16] d)
+//   z = f32[12,16] dot(f32[12,32] e, f32[32,16] f)
+//
+// into
+//
+//   lhs = f32[3,16,32] concat(reshape(pad(a)), reshape(c), reshape(pad(e)))
+//   rhs = f32[3,32,20] concat(reshape(pad(b)), reshape(pad(d)),
+//                             reshape(pad(f)))
+//   w = f32[3,16,20] dot(lhs, rhs), lhs_batch_dims={0}, rhs_batch_dims={0}
+//   x = reshape(slice(w)), y = reshape(slice(w)), z = reshape(slice(w))
+//
+// The operands are padded with zeros to the largest shape in the group, which
+// leaves the products of the smaller dots unchanged.  This lets a backend run
+// many small dots, e.g. those of the experts of a mixture-of-experts layer, as
+// one batched GEMM, at the cost of copying their operands and doing the work
+// of the padding.  Dots are therefore only grouped if their input+output bytes
+// are at most `max_size_to_group`, the padding at most doubles the work and
+// the operands, and at least three of them can be grouped.
+//
+// Like DotMerger, this requires the grouped dots to be independent of each
+// other and extends the live ranges of their results to that of the group.
+// Only dots without batch dimensions, with lhs contracting dimension 1 and rhs
+// contracting dimension 0, are grouped.
+class DotGrouper : public HloModulePass {
+ public:
+  explicit DotGrouper(int64_t max_size_to_group)
+      : max_size_to_group_(max_size_to_group) {}
+
+  absl::string_view name() const override { return "dot-grouper"; }
+  using HloPassInterface::Run;
+  StatusOr<bool> Run(
+      HloModule* module,
+      const absl::flat_hash_set<absl::string_view>& execution_threads) override;
+
+ private:
+  int64_t max_size_to_group_;
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_DOT_GROUPER_H_
@@ -0,0 +1,134 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/dot_grouper.h"
+
+#include <limits>
+
+#include "tensorflow/compiler/xla/service/pattern_matcher.h"
+#include "tensorflow/compiler/xla/service/pattern_matcher_gmock.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+
+namespace xla {
+namespace {
+
+namespace m = ::xla::match;
+
+class DotGrouperTest : public HloTestBase {
+ public:
+  DotGrouperTest()
+      : HloTestBase(/*verifier_layout_sensitive=*/false,
+                    /*allow_mixed_precision_in_hlo_verifier=*/false) {}
+};
+
+TEST_F(DotGrouperTest, GroupDifferentlyShapedDots) {
+  absl::string_view module_string = R"(
+  HloModule module
+
+  ENTRY main {
+    a = f32[16,30] parameter(0)
+    b = f32[30,20] parameter(1)
+    c = f32[16,32] parameter(2)
+    d = f32[32,16] parameter(3)
+    e = f32[12,32] parameter(4)
+    f = f32[32,16] parameter(5)
+    x = f32[16,20] dot(a, b), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    y = f32[16,16] dot(c, d), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    z = f32[12,16] dot(e, f), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    ROOT tuple = (f32[16,20], f32[16,16], f32[12,16]) tuple(x, y, z)
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_string));
+  DotGrouper pass(/*max_size_to_group=*/std::numeric_limits<int64_t>::max());
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunHloPass(&pass, module.get()));
+  EXPECT_TRUE(changed);
+
+  const HloInstruction* dot0 = nullptr;
+  const HloInstruction* dot1 = nullptr;
+  const HloInstruction* dot2 = nullptr;
+  ASSERT_THAT(module->entry_computation()->root_instruction(),
+              GmockMatch(m::Tuple(m::Reshape(m::Slice(m::Dot(&dot0))),
+                                  m::Reshape(m::Slice(m::Dot(&dot1))),
+                                  m::Reshape(m::Slice(m::Dot(&dot2))))));
+  EXPECT_EQ(dot0, dot1);
+  EXPECT_EQ(dot0, dot2);
+  EXPECT_TRUE(ShapeUtil::Equal(dot0->shape(),
+                               ShapeUtil::MakeShape(F32, {3, 16, 20})));
+}
+
+TEST_F(DotGrouperTest, NoGroupingOfDependentDots) {
+  absl::string_view module_string = R"(
+  HloModule module
+
+  ENTRY main {
+    a = f32[16,16] parameter(0)
+    b = f32[16,16] parameter(1)
+    c = f32[16,16] parameter(2)
+    x = f32[16,16] dot(a, b), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    y = f32[16,16] dot(x, c), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    z = f32[16,16] dot(y, a), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    ROOT tuple = (f32[16,16], f32[16,16], f32[16,16]) tuple(x, y, z)
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_string));
+  DotGrouper pass(/*max_size_to_group=*/std::numeric_limits<int64_t>::max());
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunHloPass(&pass, module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(DotGrouperTest, NoGroupingOfTooDifferentDots) {
+  // Padding the small dots to the large one would do 3x the work.
+  absl::string_view module_string = R"(
+  HloModule module
+
+  ENTRY main {
+    a = f32[64,64] parameter(0)
+    b = f32[8,8] parameter(1)
+    c = f32[8,8] parameter(2)
+    x = f32[64,64] dot(a, a), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    y = f32[8,8] dot(b, b), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    z = f32[8,8] dot(c, c), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    ROOT tuple = (f32[64,64], f32[8,8], f32[8,8]) tuple(x, y, z)
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_string));
+  DotGrouper pass(/*max_size_to_group=*/std::numeric_limits<int64_t>::max());
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunHloPass(&pass, module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(DotGrouperTest, NoGroupingOfLargeDots) {
+  absl::string_view module_string = R"(
+  HloModule module
+
+  ENTRY main {
+    a = f32[16,16] parameter(0)
+    b = f32[16,16] parameter(1)
+    c = f32[16,16] parameter(2)
+    x = f32[16,16] dot(a, b), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    y = f32[16,16] dot(b, c), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    z = f32[16,16] dot(c, a), lhs_contracting_dims={1}, rhs_contracting_dims={0}
+    ROOT tuple = (f32[16,16], f32[16,16], f32[16,16]) tuple(x, y, z)
+  })";
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                          ParseAndReturnVerifiedModule(module_string));
+  DotGrouper pass(/*max_size_to_group=*/1024);
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunHloPass(&pass, module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace xla
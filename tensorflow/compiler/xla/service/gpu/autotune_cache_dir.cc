@@ -0,0 +1,146 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache_dir.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/xla/stream_executor/dnn.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/path.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+// The version of the AutotuneResults written by SerializeAutotuneResults() in
+// autotune_serialize.cc. Files of another version are ignored and replaced.
+constexpr int kVersion = 1;
+
+// Keeps the characters that are safe in a file name on any file system.
+std::string SanitizeFileName(absl::string_view name) {
+  std::string result(name);
+  for (char& c : result) {
+    if (!absl::ascii_isalnum(c) && c != '.' && c != '-') c = '_';
+  }
+  return result;
+}
+
+template <typename Entries>
+void SortEntries(Entries* entries) {
+  std::sort(entries->pointer_begin(), entries->pointer_end(),
+            [](const auto* a, const auto* b) {
+              return std::make_pair(absl::string_view(a->device()),
+                                    absl::string_view(a->hlo())) <
+                     std::make_pair(absl::string_view(b->device()),
+                                    absl::string_view(b->hlo()));
+            });
+}
+
+// Appends the entries of `from` whose device and HLO no entry of `to` has,
+// only those for `device` if it is not empty. Returns the number of entries
+// appended.
+template <typename Entries>
+int MergeEntries(const Entries& from, Entries* to,
+                 absl::string_view device = "") {
+  absl::flat_hash_set<std::pair<std::string, std::string>> keys;
+  for (const auto& entry : *to) keys.emplace(entry.device(), entry.hlo());
+  int num_added = 0;
+  for (const auto& entry : from) {
+    if (!device.empty() && entry.device() != device) continue;
+    if (keys.emplace(entry.device(), entry.hlo()).second) {
+      *to->Add() = entry;
+      ++num_added;
+    }
+  }
+  SortEntries(to);
+  return num_added;
+}
+
+}  // namespace
+
+std::string AutotuneCacheFile(absl::string_view dir,
+                              se::StreamExecutor* stream_exec) {
+  const se::DeviceDescription& desc = stream_exec->GetDeviceDescription();
+  std::string name = absl::StrCat(desc.name(), "_driver", desc.driver_version(),
+                                  "_runtime", desc.runtime_version());
+  if (se::dnn::DnnSupport* dnn = stream_exec->AsDnn()) {
+    auto version = dnn->GetVersion();
+    if (version.ok()) {
+      absl::StrAppend(&name, "_dnn", version->major_version(), ".",
+                      version->minor_version(), ".", version->patch());
+    }
+  }
+  return tsl::io::JoinPath(dir, absl::StrCat(SanitizeFileName(name), ".pb"));
+}
+
+Status ReadAutotuneCacheFile(const std::string& path,
+                             AutotuneResults* results) {
+  tsl::Env* env = tsl::Env::Default();
+  if (!env->FileExists(path).ok()) return OkStatus();
+  AutotuneResults stored;
+  TF_RETURN_IF_ERROR(tsl::ReadBinaryProto(env, path, &stored));
+  if (stored.version() != kVersion) {
+    LOG(WARNING) << "Ignoring the autotune results in " << path
+                 << " of version " << stored.version() << ", expected "
+                 << kVersion;
+    return OkStatus();
+  }
+  results->set_version(kVersion);
+  MergeEntries(stored.dots(), results->mutable_dots());
+  MergeEntries(stored.convs(), results->mutable_convs());
+  return OkStatus();
+}
+
+Status MergeIntoAutotuneCacheFile(const std::string& path,
+                                  absl::string_view device,
+                                  const AutotuneResults& results) {
+  tsl::Env* env = tsl::Env::Default();
+  TF_RETURN_IF_ERROR(
+      env->RecursivelyCreateDir(std::string(tsl::io::Dirname(path))));
+  // Rereads the file just before replacing it to keep the results that other
+  // processes merged in since it was last read.
+  AutotuneResults merged;
+  TF_RETURN_IF_ERROR(ReadAutotuneCacheFile(path, &merged));
+  merged.set_version(kVersion);
+  const int num_added =
+      MergeEntries(results.dots(), merged.mutable_dots(), device) +
+      MergeEntries(results.convs(), merged.mutable_convs(), device);
+  if (num_added == 0) return OkStatus();
+
+  std::string tmp_path = path;
+  if (!env->CreateUniqueFileName(&tmp_path, ".tmp")) {
+    return tsl::errors::Internal("Failed to create a temporary file name for ",
+                                 path);
+  }
+  TF_RETURN_IF_ERROR(tsl::WriteBinaryProto(env, tmp_path, merged));
+  Status status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    env->DeleteFile(tmp_path).IgnoreError();
+    return status;
+  }
+  VLOG(1) << "Added " << num_added << " autotune results to " << path;
+  return OkStatus();
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,53 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_CACHE_DIR_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_CACHE_DIR_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/autotune_results.pb.h"
+#include "tensorflow/compiler/xla/status.h"
+#include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
+
+namespace xla {
+namespace gpu {
+
+// Autotuning results that processes share through the directory set by
+// --xla_gpu_autotune_cache_dir, e.g. on a shared file system. The directory
+// holds one file of AutotuneResults per GPU model, driver and library
+// version, which the autotuners read before they profile and merge the
+// results they find into.
+
+// Returns the file in `dir` that holds the results for the GPU of
+// `stream_exec`.
+std::string AutotuneCacheFile(absl::string_view dir,
+                              se::StreamExecutor* stream_exec);
+
+// Adds the results stored in `path` to `results`. A file that does not exist
+// holds no results.
+Status ReadAutotuneCacheFile(const std::string& path, AutotuneResults* results);
+
+// Adds the entries of `results` for `device`, a device_description_str(), that
+// are not in `path` yet to it. Other processes read either the old or the new
+// contents of `path`, never a partially written file.
+Status MergeIntoAutotuneCacheFile(const std::string& path,
+                                  absl::string_view device,
+                                  const AutotuneResults& results);
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_AUTOTUNE_CACHE_DIR_H_
@@ -0,0 +1,78 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache_dir.h"
+
+#include <string>
+
+#include "tensorflow/compiler/xla/autotune_results.pb.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/path.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+void AddDot(absl::string_view device, absl::string_view hlo, int algorithm,
+            AutotuneResults* results) {
+  auto& entry = *results->add_dots();
+  entry.set_device(std::string(device));
+  entry.set_hlo(std::string(hlo));
+  entry.mutable_result()->mutable_gemm()->set_algorithm(algorithm);
+}
+
+std::string CacheFile(absl::string_view name) {
+  return tsl::io::JoinPath(tsl::testing::TmpDir(), "autotune_cache_dir_test",
+                           name);
+}
+
+TEST(AutotuneCacheDirTest, MissingFileHoldsNoResults) {
+  AutotuneResults results;
+  TF_ASSERT_OK(ReadAutotuneCacheFile(CacheFile("missing.pb"), &results));
+  EXPECT_EQ(results.dots_size(), 0);
+  EXPECT_EQ(results.convs_size(), 0);
+}
+
+TEST(AutotuneCacheDirTest, MergeKeepsExistingResults) {
+  const std::string path = CacheFile("merge.pb");
+  tsl::Env::Default()->DeleteFile(path).IgnoreError();
+
+  AutotuneResults first;
+  AddDot("gpu0", "dot.1", 1, &first);
+  AddDot("gpu1", "dot.1", 2, &first);
+  TF_ASSERT_OK(MergeIntoAutotuneCacheFile(path, "gpu0", first));
+
+  // Results the file already has are not replaced, so processes that merge
+  // concurrently agree on them.
+  AutotuneResults second;
+  AddDot("gpu0", "dot.1", 3, &second);
+  AddDot("gpu0", "dot.0", 4, &second);
+  TF_ASSERT_OK(MergeIntoAutotuneCacheFile(path, "gpu0", second));
+
+  AutotuneResults results;
+  TF_ASSERT_OK(ReadAutotuneCacheFile(path, &results));
+  EXPECT_EQ(results.version(), 1);
+  ASSERT_EQ(results.dots_size(), 2);
+  EXPECT_EQ(results.dots(0).hlo(), "dot.0");
+  EXPECT_EQ(results.dots(0).result().gemm().algorithm(), 4);
+  EXPECT_EQ(results.dots(1).hlo(), "dot.1");
+  EXPECT_EQ(results.dots(1).result().gemm().algorithm(), 1);
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,195 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/gpu/captured_thunk_sequence.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+#if GOOGLE_CUDA
+#include "absl/cleanup/cleanup.h"
+#include "third_party/gpus/cuda/include/cuda_runtime_api.h"
+#include "tensorflow/compiler/xla/stream_executor/gpu/gpu_stream.h"
+#endif  // #if GOOGLE_CUDA
+
+namespace xla {
+namespace gpu {
+
+#if GOOGLE_CUDA
+
+struct CapturedThunkSequence::Graph {
+  ~Graph() {
+    if (exec == nullptr) return;
+    cudaError_t err = cudaGraphExecDestroy(exec);
+    CHECK(err == cudaSuccess)
+        << "Failed to destroy CUDA graph instance: " << cudaGetErrorString(err);
+  }
+
+  // The graph is captured on a stream of its own, so that work that other
+  // threads enqueue concurrently on the execution stream stays out of it.
+  std::unique_ptr<se::Stream> capture_stream;
+  cudaGraphExec_t exec = nullptr;
+  // The buffer addresses that `exec` was captured with.
+  std::vector<const void*> buffers;
+};
+
+namespace {
+
+// Captures `sequences` into a CUDA graph on `capture_stream` and updates `exec`
+// to it, instantiating a new one if `exec` is null or cannot be updated.
+Status CaptureGraph(const std::vector<SequentialThunk*>& sequences,
+                    const Thunk::ExecuteParams& params,
+                    se::Stream* capture_stream, cudaGraphExec_t* exec) {
+  Thunk::ExecuteParams capture_params = params;
+  capture_params.stream = capture_stream;
+  cudaStream_t stream = se::gpu::AsGpuStreamValue(capture_stream);
+
+  if (cudaError_t err =
+          cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal);
+      err != cudaSuccess) {
+    return InternalError("Stream begin capture failed: %s",
+                         cudaGetErrorString(err));
+  }
+  Status captured = OkStatus();
+  for (SequentialThunk* sequence : sequences) {
+    captured = sequence->ExecuteOnStream(capture_params);
+    if (!captured.ok()) break;
+  }
+  // Always stop capturing before checking whether the thunks succeeded.
+  cudaGraph_t graph;
+  cudaError_t end_err = cudaStreamEndCapture(stream, &graph);
+  TF_RETURN_IF_ERROR(captured);
+  if (end_err != cudaSuccess) {
+    return InternalError("Stream end capture failed: %s",
+                         cudaGetErrorString(end_err));
+  }
+  absl::Cleanup destroy_graph = [graph] { cudaGraphDestroy(graph); };
+
+  if (*exec != nullptr) {
+    cudaGraphExecUpdateResult update_result;
+    cudaGraphNode_t error_node;
+    if (cudaGraphExecUpdate(*exec, graph, &error_node, &update_result) ==
+            cudaSuccess &&
+        update_result == cudaGraphExecUpdateSuccess) {
+      return OkStatus();
+    }
+    VLOG(3) << "Failed to update CUDA graph instance, instantiating it anew";
+    cudaGraphExecDestroy(*exec);
+    *exec = nullptr;
+  }
+  if (cudaError_t err = cudaGraphInstantiate(exec, graph, nullptr, nullptr, 0);
+      err != cudaSuccess) {
+    *exec = nullptr;
+    return InternalError("Graph instantiation failed: %s",
+                         cudaGetErrorString(err));
+  }
+  return OkStatus();
+}
+
+}  // namespace
+
+#else  // #if !GOOGLE_CUDA
+
+struct CapturedThunkSequence::Graph {};
+
+#endif  // #if GOOGLE_CUDA
+
+CapturedThunkSequence::CapturedThunkSequence(
+    std::vector<SequentialThunk*> sequences)
+    : sequences_(std::move(sequences)) {}
+
+CapturedThunkSequence::~CapturedThunkSequence() = default;
+
+bool CapturedThunkSequence::CanCapture(const ThunkSequence& thunks) {
+#if GOOGLE_CUDA
+  for (const auto& thunk : thunks) {
+    switch (thunk->kind()) {
+      case Thunk::kCopy:
+      case Thunk::kKernel:
+      case Thunk::kMemset32BitValue:
+      case Thunk::kMemzero:
+        break;
+      case Thunk::kSequential:
+        if (!CanCapture(static_cast<SequentialThunk*>(thunk.get())->thunks())) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+#else   // #if !GOOGLE_CUDA
+  return false;
+#endif  // #if GOOGLE_CUDA
+}
+
+Status CapturedThunkSequence::Initialize(se::StreamExecutor* executor) {
+#if GOOGLE_CUDA
+  absl::MutexLock lock(&mutex_);
+  if (graphs_.contains(executor)) return OkStatus();
+  auto graph = std::make_unique<Graph>();
+  graph->capture_stream = std::make_unique<se::Stream>(executor);
+  graph->capture_stream->Init();
+  if (!graph->capture_stream->ok()) {
+    return InternalError("Failed to create a stream for CUDA graph capture");
+  }
+  graphs_.emplace(executor, std::move(graph));
+  return OkStatus();
+#else   // #if !GOOGLE_CUDA
+  return Unimplemented("CUDA graphs are not supported");
+#endif  // #if GOOGLE_CUDA
+}
+
+Status CapturedThunkSequence::Execute(const Thunk::ExecuteParams& params) {
+#if GOOGLE_CUDA
+  absl::MutexLock lock(&mutex_);
+  auto it = graphs_.find(params.stream->parent());
+  TF_RET_CHECK(it != graphs_.end())
+      << "CapturedThunkSequence was not initialized on this executor";
+  Graph& graph = *it->second;
+
+  std::vector<const void*> buffers;
+  buffers.reserve(params.buffer_allocations->size());
+  for (BufferAllocation::Index i = 0; i < params.buffer_allocations->size();
+       ++i) {
+    buffers.push_back(params.buffer_allocations->GetDeviceAddress(i).opaque());
+  }
+  if (graph.exec == nullptr || graph.buffers != buffers) {
+    VLOG(3) << "Capturing CUDA graph";
+    TF_RETURN_IF_ERROR(CaptureGraph(sequences_, params,
+                                    graph.capture_stream.get(), &graph.exec));
+    graph.buffers = std::move(buffers);
+  }
+
+  if (cudaError_t err =
+          cudaGraphLaunch(graph.exec, se::gpu::AsGpuStreamValue(params.stream));
+      err != cudaSuccess) {
+    return InternalError("Failed to launch CUDA graph: %s",
+                         cudaGetErrorString(err));
+  }
+  return OkStatus();
+#else   // #if !GOOGLE_CUDA
+  return Unimplemented("CUDA graphs are not supported");
+#endif  // #if GOOGLE_CUDA
+}
+
+}  // namespace gpu
+}  // namespace xla
@@ -0,0 +1,68 @@
+/* Copyright 2017 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_CAPTURED_THUNK_SEQUENCE_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_CAPTURED_THUNK_SEQUENCE_H_
+
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
+#include "tensorflow/compiler/xla/service/gpu/thunk.h"
+#include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
+
+namespace xla {
+namespace gpu {
+
+// Executes thunk sequences by replaying a CUDA graph captured from them, which
+// launches their work with a single call instead of one per thunk. Loop thunks
+// use it to cut the launch overhead of every iteration.
+//
+// The graph is captured on the first execution and captured again whenever
+// the buffer addresses change. Only sequences of kernel launches, memsets and
+// device-to-device copies can be captured; see CanCapture.
+class CapturedThunkSequence {
+ public:
+  // Executes `sequences` in order. They are owned by the caller.
+  explicit CapturedThunkSequence(std::vector<SequentialThunk*> sequences);
+  ~CapturedThunkSequence();
+
+  // Returns whether `thunks` only does work that a CUDA graph can capture.
+  // Always false in builds without CUDA.
+  static bool CanCapture(const ThunkSequence& thunks);
+
+  // Prepares capturing on `executor`. The sequences must be initialized on
+  // `executor` too.
+  Status Initialize(se::StreamExecutor* executor);
+
+  // Runs the sequences on `params.stream`.
+  Status Execute(const Thunk::ExecuteParams& params);
+
+ private:
+  struct Graph;
+
+  const std::vector<SequentialThunk*> sequences_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<se::StreamExecutor*, std::unique_ptr<Graph>> graphs_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace gpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_GPU_CAPTURED_THUNK_SEQUENCE_H_
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/tsl/platform/errors.h"
@@ -25,18 +26,28 @@ namespace xla {
 namespace gpu {
 
 ForThunk::ForThunk(ThunkInfo thunk_info, const int64_t loop_limit,
-                   std::unique_ptr<ThunkSequence> body_thunk_sequence)
+                   std::unique_ptr<ThunkSequence> body_thunk_sequence,
+                   bool enable_cuda_graphs)
     : Thunk(Kind::kFor, thunk_info),
       loop_limit_(loop_limit),
       body_thunk_sequence_(std::make_unique<SequentialThunk>(
           // Pass nullptr as the HloInstruction* to the body_thunk_sequence_
           // constructor because this SequentialThunk is logically "part of"
           // this ForThunk, and shouldn't be profiled separately from it.
-          ThunkInfo(thunk_info.op), std::move(*body_thunk_sequence))) {}
+          ThunkInfo(thunk_info.op), std::move(*body_thunk_sequence))) {
+  if (enable_cuda_graphs &&
+      CapturedThunkSequence::CanCapture(body_thunk_sequence_->thunks())) {
+    captured_body_ = std::make_unique<CapturedThunkSequence>(
+        std::vector<SequentialThunk*>{body_thunk_sequence_.get()});
+  }
+}
 
 Status ForThunk::Initialize(const GpuExecutable& executable,
                             se::StreamExecutor* executor) {
   TF_RETURN_IF_ERROR(body_thunk_sequence_->Initialize(executable, executor));
+  if (captured_body_) {
+    TF_RETURN_IF_ERROR(captured_body_->Initialize(executor));
+  }
   return OkStatus();
 }
 
@@ -45,7 +56,11 @@ Status ForThunk::ExecuteOnStream(const ExecuteParams& params) {
   for (int64_t i = 0; i < loop_limit_; ++i) {
     VLOG(3) << "Executing iteration # " << i;
     // Invoke loop body thunk sequence.
-    TF_RETURN_IF_ERROR(body_thunk_sequence_->ExecuteOnStream(params));
+    if (captured_body_) {
+      TF_RETURN_IF_ERROR(captured_body_->Execute(params));
+    } else {
+      TF_RETURN_IF_ERROR(body_thunk_sequence_->ExecuteOnStream(params));
+    }
   }
   return OkStatus();
 }
@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FOR_THUNK_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_FOR_THUNK_H_
 
+#include <memory>
 #include <vector>
 
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/captured_thunk_sequence.h"
 #include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk.h"
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
@@ -27,11 +29,14 @@ limitations under the License.
 namespace xla {
 namespace gpu {
 
-// ForThunk executes 'loop_limit' invocations of 'body_thunk_sequence'.
+// ForThunk executes 'loop_limit' invocations of 'body_thunk_sequence'. If
+// `enable_cuda_graphs` is set and the body can be captured, each invocation
+// launches it as one CUDA graph.
 class ForThunk : public Thunk {
  public:
   ForThunk(ThunkInfo thunk_info, const int64_t loop_limit,
-           std::unique_ptr<ThunkSequence> body_thunk_sequence);
+           std::unique_ptr<ThunkSequence> body_thunk_sequence,
+           bool enable_cuda_graphs = false);
   ForThunk(const ForThunk&) = delete;
   ForThunk& operator=(const ForThunk&) = delete;
 
@@ -44,6 +49,7 @@ class ForThunk : public Thunk {
  private:
   const int64_t loop_limit_;
   std::unique_ptr<SequentialThunk> body_thunk_sequence_;
+  std::unique_ptr<CapturedThunkSequence> captured_body_;
 };
 
 }  // namespace gpu
@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/gpu/autotune_cache_dir.h"
 #include "tensorflow/compiler/xla/service/gpu/backend_configs.pb.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_comparator.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_asm_opts_util.h"
@@ -496,6 +497,27 @@ StatusOr<bool> GemmAlgorithmPicker::Run(
     return false;
   }
 
+  // Failing to share the results with other processes only costs time, so it
+  // does not fail the compilation.
+  const std::string& cache_dir =
+      module->config().debug_options().xla_gpu_autotune_cache_dir();
+  std::string cache_file;
+  if (!cache_dir.empty()) {
+    cache_file = AutotuneCacheFile(cache_dir, stream_exec_);
+    AutotuneResults results;
+    Status status = ReadAutotuneCacheFile(cache_file, &results);
+    if (status.ok()) status = LoadAutotuneResults(results);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to read autotune results from " << cache_file
+                   << ": " << status;
+    }
+  }
+  int64_t misses_before;
+  {
+    absl::MutexLock lock(&autotune_cache_mu);
+    misses_before = autotune_cache_misses;
+  }
+
   bool changed = false;
   for (HloComputation* computation :
        module->MakeNonfusionComputations(execution_threads)) {
@@ -503,6 +525,22 @@ StatusOr<bool> GemmAlgorithmPicker::Run(
         bool result, RunOnComputation(computation, stream_exec_, allocator_));
     changed |= result;
   }
+
+  bool tuned;
+  {
+    absl::MutexLock lock(&autotune_cache_mu);
+    tuned = autotune_cache_misses > misses_before;
+  }
+  if (!cache_file.empty() && tuned) {
+    AutotuneResults results;
+    TF_RETURN_IF_ERROR(WriteAutotuneResults(&results));
+    Status status = MergeIntoAutotuneCacheFile(
+        cache_file, stream_exec_->device_description_str(), results);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write autotune results to " << cache_file
+                   << ": " << status;
+    }
+  }
   return changed;
 }
 
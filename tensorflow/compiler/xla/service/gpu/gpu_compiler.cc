@@ -72,6 +72,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/convolution_pred_expander.h"
 #include "tensorflow/compiler/xla/service/copy_insertion.h"
 #include "tensorflow/compiler/xla/service/dot_decomposer.h"
+#include "tensorflow/compiler/xla/service/dot_grouper.h"
 #include "tensorflow/compiler/xla/service/dot_merger.h"
 #include "tensorflow/compiler/xla/service/dump.h"
 #include "tensorflow/compiler/xla/service/dynamic_dimension_simplifier.h"
@@ -97,6 +98,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_hlo_schedule.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_layout_assignment.h"
+#include "tensorflow/compiler/xla/service/gpu/gpu_performance_model.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_reduce_scatter_creator.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_sanitize_constant_names.h"
 #include "tensorflow/compiler/xla/service/gpu/gpu_scatter_expander.h"
@@ -131,6 +133,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_parser.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_fix.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
+#include "tensorflow/compiler/xla/service/hlo_rematerialization.h"
 #include "tensorflow/compiler/xla/service/hlo_verifier.h"
 #include "tensorflow/compiler/xla/service/layout_normalization.h"
 #include "tensorflow/compiler/xla/service/llvm_ir/llvm_util.h"
@@ -544,6 +547,11 @@ Status GpuCompiler::OptimizeHloModule(
       pipeline.AddPass<HloDCE>();
     }();
 
+    if (debug_options.xla_gpu_enable_dot_grouping()) {
+      // Only group dots that are small enough to be merged too.
+      pipeline.AddPass<DotGrouper>(/*max_size_to_group=*/int64_t{16} << 20);
+    }
+
     // ConvertMover and ReshapeMover fight with each other: ConvertMover wants
     // to move some converts down the graph, but ReshapeMover wants to move them
     // up the graph.  As a compromise, let ReshapeMover run to a fixed point,
@@ -1042,6 +1050,64 @@ static void ForAllThunks(const std::function<void(Thunk*)>& fn,
   }
 }
 
+// Rematerializes instructions of `hlo_module` scheduled by `hlo_schedule` until
+// its peak memory use fits in the memory of the device of `stream_exec`. Among
+// the candidates freeing memory, the ones that are cheapest to recompute
+// according to GpuPerformanceModel are preferred. Returns the updated schedule.
+static StatusOr<HloSchedule> RematerializeToDeviceMemoryLimit(
+    HloModule* hlo_module, HloSchedule hlo_schedule,
+    const GpuDeviceInfo& gpu_device_info, int pointer_size,
+    se::StreamExecutor* stream_exec) {
+  const int64_t memory_limit_bytes =
+      stream_exec->GetDeviceDescription().device_memory_size();
+  if (memory_limit_bytes <= 0) {
+    return hlo_schedule;
+  }
+  auto size_function = [pointer_size](const Shape& shape) {
+    return GetSizeOfShape(shape, pointer_size);
+  };
+
+  HloCostAnalysis::Options options{size_function};
+  options.set_bytes_per_second(gpu_device_info.memory_bandwidth);
+  options.set_flops_per_second(2 * 1e9 * gpu_device_info.clock_rate_ghz *
+                               gpu_device_info.core_count *
+                               gpu_device_info.fpus_per_core);
+  GpuHloCostAnalysis cost_analysis(options);
+  TF_RETURN_IF_ERROR(hlo_module->entry_computation()->Accept(&cost_analysis));
+  // Instructions outside of the entry computation have no cost estimate and
+  // are ranked by the memory they free only.
+  auto compute_cost_function =
+      [&](const HloInstruction* instruction) -> int64_t {
+    absl::Duration time =
+        instruction->opcode() == HloOpcode::kFusion
+            ? GpuPerformanceModel::EstimateRunTimes(instruction, &cost_analysis,
+                                                    gpu_device_info)
+                  .time_unfused
+            : absl::Seconds(cost_analysis.optimal_seconds(*instruction));
+    return absl::ToInt64Nanoseconds(time);
+  };
+
+  TF_RETURN_IF_ERROR(hlo_module->set_schedule(std::move(hlo_schedule)));
+  HloRematerialization::RematerializationSizes sizes;
+  HloRematerialization rematerialization(
+      size_function, memory_limit_bytes, &sizes,
+      HloRematerialization::RematerializationPass::kPostFusion,
+      /*block_size_limit=*/1, /*block_rematerialization_factor=*/1,
+      /*compact_shape_function=*/nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeOnly,
+      /*min_remat_size=*/0, compute_cost_function);
+  TF_ASSIGN_OR_RETURN(bool changed, rematerialization.Run(hlo_module));
+  if (changed) {
+    VLOG(1) << "Rematerialization reduced the peak memory of "
+            << hlo_module->name() << " from "
+            << tsl::strings::HumanReadableNumBytes(sizes.before_bytes) << " to "
+            << tsl::strings::HumanReadableNumBytes(sizes.after_bytes);
+  }
+  HloSchedule result = hlo_module->schedule();
+  hlo_module->clear_schedule();
+  return result;
+}
+
 // The order of `thunk_sequence` corresponds to
 // `hlo_schedule->ThunkLaunchOrder()`.
 static Status CompileModuleToLlvmIrImpl(
@@ -1060,6 +1126,15 @@ static Status CompileModuleToLlvmIrImpl(
 
   TF_ASSIGN_OR_RETURN(HloSchedule hlo_schedule,
                       ScheduleGpuModule(hlo_module, pointer_size));
+  if (hlo_module->config()
+          .debug_options()
+          .xla_gpu_enable_memory_limit_rematerialization() &&
+      stream_exec != nullptr) {
+    TF_ASSIGN_OR_RETURN(hlo_schedule,
+                        RematerializeToDeviceMemoryLimit(
+                            hlo_module, std::move(hlo_schedule),
+                            gpu_device_info, pointer_size, stream_exec));
+  }
 
   auto buffer_size_bytes_function =
       [pointer_size](const BufferValue& buffer_value) -> int64_t {
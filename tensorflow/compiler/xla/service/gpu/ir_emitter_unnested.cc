@@ -3332,7 +3332,9 @@ StatusOr<std::unique_ptr<Thunk>> IrEmitterUnnested::BuildWhileThunk(
   return std::unique_ptr<Thunk>(
       new WhileThunk(thunk_info, cond_result_slice,
                      ir_emitter_condition->ConsumeThunkSequence(),
-                     ir_emitter_body->ConsumeThunkSequence()));
+                     ir_emitter_body->ConsumeThunkSequence(),
+                     hlo_module_config_.debug_options()
+                         .xla_gpu_enable_cuda_graphs()));
 }
 
 StatusOr<std::unique_ptr<Thunk>> IrEmitterUnnested::BuildForThunk(
@@ -3345,7 +3347,8 @@ StatusOr<std::unique_ptr<Thunk>> IrEmitterUnnested::BuildForThunk(
   TF_RETURN_IF_ERROR(ir_emitter_body->EmitLmhloRegion(&while_op.getBody()));
 
   return std::unique_ptr<Thunk>(new ForThunk(
-      thunk_info, loop_limit, ir_emitter_body->ConsumeThunkSequence()));
+      thunk_info, loop_limit, ir_emitter_body->ConsumeThunkSequence(),
+      hlo_module_config_.debug_options().xla_gpu_enable_cuda_graphs()));
 }
 
 Status IrEmitterUnnested::EmitTargetElementLoop(
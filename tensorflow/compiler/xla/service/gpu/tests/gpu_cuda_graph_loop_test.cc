@@ -0,0 +1,113 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <utility>
+#include <vector>
+
+#include "tensorflow/compiler/xla/literal.h"
+#include "tensorflow/compiler/xla/literal_util.h"
+#include "tensorflow/compiler/xla/service/gpu/tests/gpu_codegen_test.h"
+
+namespace xla {
+namespace gpu {
+namespace {
+
+class CudaGraphLoopTest : public GpuCodegenTest {
+  DebugOptions GetDebugOptionsForTest() override {
+    DebugOptions debug_options = GpuCodegenTest::GetDebugOptionsForTest();
+    // Loops are only captured by the thunk runtime.
+    debug_options.set_xla_gpu_enable_xla_runtime_executable(false);
+    debug_options.set_xla_gpu_enable_cuda_graphs(true);
+    return debug_options;
+  }
+};
+
+// The trip count is only known at run time, so this runs as a WhileThunk.
+TEST_F(CudaGraphLoopTest, WhileLoop) {
+  const char* hlo_text = R"(
+HloModule module
+
+body {
+  body.p0 = (s32[], s32[], f32[1024]) parameter(0)
+  body.i = s32[] get-tuple-element(body.p0), index=0
+  body.n = s32[] get-tuple-element(body.p0), index=1
+  body.one = s32[] constant(1)
+  body.next = s32[] add(body.i, body.one)
+  body.x = f32[1024] get-tuple-element(body.p0), index=2
+  body.two = f32[] constant(2)
+  body.twos = f32[1024] broadcast(body.two), dimensions={}
+  body.y = f32[1024] multiply(body.x, body.twos)
+  ROOT body.root = (s32[], s32[], f32[1024]) tuple(body.next, body.n, body.y)
+}
+
+cond {
+  cond.p0 = (s32[], s32[], f32[1024]) parameter(0)
+  cond.i = s32[] get-tuple-element(cond.p0), index=0
+  cond.n = s32[] get-tuple-element(cond.p0), index=1
+  ROOT cond.root = pred[] compare(cond.i, cond.n), direction=LT
+}
+
+ENTRY entry {
+  entry.n = s32[] parameter(0)
+  entry.x = f32[1024] parameter(1)
+  entry.zero = s32[] constant(0)
+  entry.init = (s32[], s32[], f32[1024]) tuple(entry.zero, entry.n, entry.x)
+  entry.while = (s32[], s32[], f32[1024]) while(entry.init), condition=cond, body=body
+  ROOT entry.root = f32[1024] get-tuple-element(entry.while), index=2
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module, ParseAndReturnVerifiedModule(hlo_text));
+  Literal n = LiteralUtil::CreateR0<int32_t>(5);
+  Literal x = LiteralUtil::CreateR1<float>(std::vector<float>(1024, 1.0f));
+  EXPECT_TRUE(
+      RunAndCompare(std::move(module), {&n, &x}, ErrorSpec{1e-5, 1e-5}));
+}
+
+// The trip count is known at compile time, so this runs as a ForThunk.
+TEST_F(CudaGraphLoopTest, ForLoop) {
+  const char* hlo_text = R"(
+HloModule module
+
+body {
+  body.p0 = (s32[], f32[1024]) parameter(0)
+  body.i = s32[] get-tuple-element(body.p0), index=0
+  body.one = s32[] constant(1)
+  body.next = s32[] add(body.i, body.one)
+  body.x = f32[1024] get-tuple-element(body.p0), index=1
+  body.y = f32[1024] add(body.x, body.x)
+  ROOT body.root = (s32[], f32[1024]) tuple(body.next, body.y)
+}
+
+cond {
+  cond.p0 = (s32[], f32[1024]) parameter(0)
+  cond.i = s32[] get-tuple-element(cond.p0), index=0
+  cond.n = s32[] constant(10)
+  ROOT cond.root = pred[] compare(cond.i, cond.n), direction=LT
+}
+
+ENTRY entry {
+  entry.x = f32[1024] parameter(0)
+  entry.zero = s32[] constant(0)
+  entry.init = (s32[], f32[1024]) tuple(entry.zero, entry.x)
+  entry.while = (s32[], f32[1024]) while(entry.init), condition=cond, body=body
+  ROOT entry.root = f32[1024] get-tuple-element(entry.while), index=1
+}
+)";
+  EXPECT_TRUE(RunAndCompare(hlo_text, ErrorSpec{1e-5, 1e-5}));
+}
+
+}  // namespace
+}  // namespace gpu
+}  // namespace xla
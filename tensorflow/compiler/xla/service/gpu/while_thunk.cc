@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/tsl/platform/errors.h"
@@ -28,19 +29,31 @@ WhileThunk::WhileThunk(
     ThunkInfo thunk_info,
     const BufferAllocation::Slice& condition_result_buffer_index,
     std::unique_ptr<ThunkSequence> condition_thunk_sequence,
-    std::unique_ptr<ThunkSequence> body_thunk_sequence)
+    std::unique_ptr<ThunkSequence> body_thunk_sequence,
+    bool enable_cuda_graphs)
     : Thunk(Kind::kWhile, thunk_info),
       condition_result_buffer_index_(condition_result_buffer_index),
       condition_thunk_sequence_(std::make_unique<SequentialThunk>(
           ThunkInfo(thunk_info.op), std::move(*condition_thunk_sequence))),
       body_thunk_sequence_(std::make_unique<SequentialThunk>(
-          ThunkInfo(thunk_info.op), std::move(*body_thunk_sequence))) {}
+          ThunkInfo(thunk_info.op), std::move(*body_thunk_sequence))) {
+  if (enable_cuda_graphs &&
+      CapturedThunkSequence::CanCapture(condition_thunk_sequence_->thunks()) &&
+      CapturedThunkSequence::CanCapture(body_thunk_sequence_->thunks())) {
+    captured_iteration_ = std::make_unique<CapturedThunkSequence>(
+        std::vector<SequentialThunk*>{body_thunk_sequence_.get(),
+                                      condition_thunk_sequence_.get()});
+  }
+}
 
 Status WhileThunk::Initialize(const GpuExecutable& executable,
                               se::StreamExecutor* executor) {
   TF_RETURN_IF_ERROR(
       condition_thunk_sequence_->Initialize(executable, executor));
   TF_RETURN_IF_ERROR(body_thunk_sequence_->Initialize(executable, executor));
+  if (captured_iteration_) {
+    TF_RETURN_IF_ERROR(captured_iteration_->Initialize(executor));
+  }
   return OkStatus();
 }
 
@@ -51,11 +64,11 @@ Status WhileThunk::ExecuteOnStream(const ExecuteParams& params) {
       params.buffer_allocations->GetDeviceAddress(
           condition_result_buffer_index_);
 
-  while (true) {
-    // Invoke thunk sequence for while 'condition' computation.
-    VLOG(3) << "Executing condition computation";
-    TF_RETURN_IF_ERROR(condition_thunk_sequence_->ExecuteOnStream(params));
+  // Invoke thunk sequence for while 'condition' computation.
+  VLOG(3) << "Executing condition computation";
+  TF_RETURN_IF_ERROR(condition_thunk_sequence_->ExecuteOnStream(params));
 
+  while (true) {
     // Copy the result of condition computation and break the loop if 'false'.
     bool condition_result;
     stream.ThenMemcpy(&condition_result, condition_result_data, sizeof(bool));
@@ -71,9 +84,18 @@ Status WhileThunk::ExecuteOnStream(const ExecuteParams& params) {
       break;
     }
 
+    if (captured_iteration_) {
+      VLOG(3) << "Executing body and condition computations as a CUDA graph";
+      TF_RETURN_IF_ERROR(captured_iteration_->Execute(params));
+      continue;
+    }
+
     VLOG(3) << "Executing body computation";
     // Invoke thunk sequence for while 'body' computation.
     TF_RETURN_IF_ERROR(body_thunk_sequence_->ExecuteOnStream(params));
+
+    VLOG(3) << "Executing condition computation";
+    TF_RETURN_IF_ERROR(condition_thunk_sequence_->ExecuteOnStream(params));
   }
   return OkStatus();
 }
@@ -16,10 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_GPU_WHILE_THUNK_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_GPU_WHILE_THUNK_H_
 
+#include <memory>
 #include <vector>
 
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/gpu/buffer_allocations.h"
+#include "tensorflow/compiler/xla/service/gpu/captured_thunk_sequence.h"
 #include "tensorflow/compiler/xla/service/gpu/sequential_thunk.h"
 #include "tensorflow/compiler/xla/service/gpu/thunk.h"
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
@@ -34,14 +36,17 @@ namespace gpu {
 // allocation:
 //   init, condition.parameter, body.parameter, body.root, while.result
 // WhileThunk synchronizes the stream to test the result of the 'condition'
-// computation.
+// computation. If `enable_cuda_graphs` is set and both computations can be
+// captured, every iteration after the first evaluation of the 'condition'
+// launches 'body' and 'condition' together as one CUDA graph.
 class WhileThunk : public Thunk {
  public:
   // Constructs a WhileThunk to compute while instruction 'hlo'.
   WhileThunk(ThunkInfo thunk_info,
              const BufferAllocation::Slice& condition_result_buffer_index,
              std::unique_ptr<ThunkSequence> condition_thunk_sequence,
-             std::unique_ptr<ThunkSequence> body_thunk_sequence);
+             std::unique_ptr<ThunkSequence> body_thunk_sequence,
+             bool enable_cuda_graphs = false);
   WhileThunk(const WhileThunk&) = delete;
   WhileThunk& operator=(const WhileThunk&) = delete;
 
@@ -58,6 +63,8 @@ class WhileThunk : public Thunk {
   const BufferAllocation::Slice condition_result_buffer_index_;
   std::unique_ptr<SequentialThunk> condition_thunk_sequence_;
   std::unique_ptr<SequentialThunk> body_thunk_sequence_;
+  // Runs 'body' followed by 'condition', if they can be captured.
+  std::unique_ptr<CapturedThunkSequence> captured_iteration_;
 };
 
 }  // namespace gpu
@@ -0,0 +1,162 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compile-time benchmarks of HLO passes over a corpus of generated modules.
+// Each corpus entry builds a module whose size scales with the benchmark
+// argument, so that passes that are superlinear in the module size show up as
+// regressions.
+//
+// Run with --benchmarks=all.
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
+#include "tensorflow/compiler/xla/service/algebraic_simplifier.h"
+#include "tensorflow/compiler/xla/service/hlo_cse.h"
+#include "tensorflow/compiler/xla/service/hlo_dce.h"
+#include "tensorflow/compiler/xla/service/hlo_parser.h"
+#include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
+#include "tensorflow/compiler/xla/service/hlo_verifier.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/test_benchmark.h"
+
+namespace xla {
+namespace {
+
+// A chain of elementwise ops interleaved with algebraic identities, e.g.
+// x + 0 and x * 1.
+std::string MakeElementwiseModule(int size) {
+  std::string body = R"(
+  p0 = f32[64,64] parameter(0)
+  zero = f32[] constant(0)
+  one = f32[] constant(1)
+  zeros = f32[64,64] broadcast(zero), dimensions={}
+  ones = f32[64,64] broadcast(one), dimensions={}
+  v0 = f32[64,64] add(p0, zeros)
+)";
+  for (int i = 0; i < size; ++i) {
+    absl::StrAppend(&body, "  m", i, " = f32[64,64] multiply(v", i, ", ones)\n",
+                    "  n", i, " = f32[64,64] negate(m", i, ")\n", "  e", i,
+                    " = f32[64,64] exponential(n", i, ")\n", "  v", i + 1,
+                    " = f32[64,64] add(e", i, ", zeros)\n");
+  }
+  return absl::StrCat("HloModule elementwise\n\nENTRY main {\n", body,
+                      "  ROOT root = f32[64,64] copy(v", size, ")\n}\n");
+}
+
+// A chain of transposes and reshapes which cancel each other out.
+std::string MakeReshapeModule(int size) {
+  std::string body = "  v0 = f32[32,64] parameter(0)\n";
+  for (int i = 0; i < size; ++i) {
+    absl::StrAppend(&body, "  t", i, " = f32[64,32] transpose(v", i,
+                    "), dimensions={1,0}\n", "  r", i,
+                    " = f32[2048] reshape(t", i, ")\n", "  s", i,
+                    " = f32[64,32] reshape(r", i, ")\n", "  v", i + 1,
+                    " = f32[32,64] transpose(s", i, "), dimensions={1,0}\n");
+  }
+  return absl::StrCat("HloModule reshape\n\nENTRY main {\n", body,
+                      "  ROOT root = f32[32,64] copy(v", size, ")\n}\n");
+}
+
+// Slices of a parameter concatenated back together, with duplicated
+// computations for CSE to find.
+std::string MakeSliceConcatModule(int size) {
+  std::string body = "  v0 = f32[128] parameter(0)\n";
+  for (int i = 0; i < size; ++i) {
+    absl::StrAppend(&body, "  a", i, " = f32[64] slice(v", i,
+                    "), slice={[0:64]}\n", "  b", i, " = f32[64] slice(v", i,
+                    "), slice={[64:128]}\n", "  c", i, " = f32[64] slice(v", i,
+                    "), slice={[64:128]}\n", "  d", i,
+                    " = f32[64] add(b", i, ", c", i, ")\n", "  v", i + 1,
+                    " = f32[128] concatenate(a", i, ", d", i,
+                    "), dimensions={0}\n");
+  }
+  return absl::StrCat("HloModule slice_concat\n\nENTRY main {\n", body,
+                      "  ROOT root = f32[128] copy(v", size, ")\n}\n");
+}
+
+struct CorpusEntry {
+  absl::string_view name;
+  std::string (*make_module)(int size);
+};
+
+constexpr CorpusEntry kCorpus[] = {
+    {"elementwise", MakeElementwiseModule},
+    {"reshape", MakeReshapeModule},
+    {"slice_concat", MakeSliceConcatModule},
+};
+
+TEST(HloPassBenchmarkTest, CorpusModulesAreValid) {
+  for (const CorpusEntry& entry : kCorpus) {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> module,
+                            ParseAndReturnUnverifiedModule(entry.make_module(
+                                /*size=*/4)));
+    TF_EXPECT_OK(HloVerifier(/*layout_sensitive=*/false,
+                             /*allow_mixed_precision=*/false)
+                     .Run(module.get())
+                     .status());
+  }
+}
+
+// Runs `pass` on the corpus entry state.range(0) of size state.range(1). Only
+// the pass is timed, not the parsing of the module.
+void RunPassOnCorpus(::testing::benchmark::State& state,
+                     HloPassInterface& pass) {
+  const CorpusEntry& entry = kCorpus[state.range(0)];
+  state.SetLabel(std::string(entry.name));
+  const std::string hlo_string = entry.make_module(state.range(1));
+  for (auto s : state) {
+    state.PauseTiming();
+    std::unique_ptr<HloModule> module =
+        ParseAndReturnUnverifiedModule(hlo_string).value();
+    state.ResumeTiming();
+    TF_CHECK_OK(pass.Run(module.get()).status());
+  }
+}
+
+void BM_AlgebraicSimplifier(::testing::benchmark::State& state) {
+  AlgebraicSimplifier pass{AlgebraicSimplifierOptions()};
+  RunPassOnCorpus(state, pass);
+}
+
+void BM_SimplificationPipeline(::testing::benchmark::State& state) {
+  HloPassPipeline pipeline("simplification");
+  pipeline.AddPass<AlgebraicSimplifier>(AlgebraicSimplifierOptions());
+  pipeline.AddPass<HloCSE>(/*is_layout_sensitive=*/false);
+  pipeline.AddPass<HloDCE>();
+  RunPassOnCorpus(state, pipeline);
+}
+
+BENCHMARK(BM_AlgebraicSimplifier)
+    ->ArgPair(0, 256)
+    ->ArgPair(0, 2048)
+    ->ArgPair(1, 256)
+    ->ArgPair(1, 2048)
+    ->ArgPair(2, 256)
+    ->ArgPair(2, 2048);
+BENCHMARK(BM_SimplificationPipeline)
+    ->ArgPair(0, 256)
+    ->ArgPair(0, 2048)
+    ->ArgPair(1, 256)
+    ->ArgPair(1, 2048)
+    ->ArgPair(2, 256)
+    ->ArgPair(2, 2048);
+
+}  // namespace
+}  // namespace xla
@@ -397,6 +397,10 @@ TEST_F(HloPassPipelineTest, SetHloModuleMetadata) {
       EXPECT_GT(pass_metadata.start_timestamp_usec(), 0);
       EXPECT_LE(pass_metadata.start_timestamp_usec(),
                 pass_metadata.end_timestamp_usec());
+      EXPECT_EQ(pass_metadata.start_instruction_count(),
+                module->instruction_count());
+      EXPECT_EQ(pass_metadata.end_instruction_count(),
+                module->instruction_count());
     }
   }
 }
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <iterator>
+#include <limits>
 #include <memory>
 #include <set>
 #include <string>
@@ -37,6 +38,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_module.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
 #include "tensorflow/compiler/xla/map_util.h"
+#include "tensorflow/compiler/xla/overflow_util.h"
 #include "tensorflow/compiler/xla/primitive_util.h"
 #include "tensorflow/compiler/xla/service/buffer_value.h"
 #include "tensorflow/compiler/xla/service/flatten_call_graph.h"
@@ -508,7 +510,8 @@ class MemoryUsageTracker {
       const HloRematerialization::CompactShapeFunction& compact_shape_function,
       const HloDataflowAnalysis& dataflow_analysis,
       const InstructionList& instruction_list,
-      HloRematerialization::RematerializationMode mode);
+      HloRematerialization::RematerializationMode mode,
+      const HloRematerialization::ComputeCostFunction& compute_cost_function);
 
   // Starts the placement of the given instruction. This adds the sizes of the
   // HloValues defined by the instruction to the current memory
@@ -540,7 +543,19 @@ class MemoryUsageTracker {
 
     CHECK_GT(memory_reduced, 0);
     // Return the inverse of the benefit of rematerialization.
-    return memory_limit_bytes / memory_reduced;
+    const int64_t cost_per_byte = memory_limit_bytes / memory_reduced;
+    if (!compute_cost_function_) {
+      return cost_per_byte;
+    }
+    // Weigh the benefit by the work that has to be redone, so that cheap
+    // instructions are preferred among those freeing similar amounts of memory.
+    int64_t compute_cost = 1;
+    for (auto* item : items) {
+      compute_cost += std::max<int64_t>(
+          0, compute_cost_function_(item->instruction));
+    }
+    const int64_t cost = MultiplyWithoutOverflow(cost_per_byte, compute_cost);
+    return cost < 0 ? std::numeric_limits<int64_t>::max() : cost;
   }
 
   // Finishes the placement of the current instruction. This frees any dead
@@ -793,6 +808,10 @@ class MemoryUsageTracker {
   Item* in_progress_item_ = nullptr;
 
   HloRematerialization::RematerializationMode mode_;
+
+  // Estimates the cost of recomputing an instruction. May be null.
+  const HloRematerialization::ComputeCostFunction& compute_cost_function_;
+
   // All buffers in the computation.
   std::vector<Buffer> buffers_;
 };
@@ -803,12 +822,14 @@ MemoryUsageTracker::MemoryUsageTracker(
     const HloRematerialization::CompactShapeFunction& compact_shape_function,
     const HloDataflowAnalysis& dataflow_analysis,
     const InstructionList& instruction_list,
-    HloRematerialization::RematerializationMode mode)
+    HloRematerialization::RematerializationMode mode,
+    const HloRematerialization::ComputeCostFunction& compute_cost_function)
     : computation_(computation),
       instruction_list_(instruction_list),
       size_function_(size_function),
       compact_shape_function_(compact_shape_function),
-      mode_(mode) {
+      mode_(mode),
+      compute_cost_function_(compute_cost_function) {
   tsl::gtl::CompactPointerSet<const HloValue*> live_out_set;
   for (auto& [_, hlo_value_set] : dataflow_analysis.GetInstructionValueSet(
            computation_->root_instruction())) {
@@ -1506,7 +1527,7 @@ MemoryUsageTracker::PickRematerializationCandidates(
       const int64_t memory_reduced = MemoryReducedIfRematerialized(block);
       effort++;
       if (memory_reduced > 0) {
-        const int cost =
+        const int64_t cost =
             RematerializationCost(block, memory_reduced, memory_limit_bytes);
 
         VLOG(5) << "Candidate block of size " << block.size()
@@ -1862,7 +1883,7 @@ StatusOr<int64_t> HloRematerialization::ComputePeakMemory(
   InstructionList instruction_list(order);
   MemoryUsageTracker tracker(computation, size_function_,
                              compact_shape_function_, *dataflow_analysis_,
-                             instruction_list, mode_);
+                             instruction_list, mode_, compute_cost_function_);
   int64_t peak_memory = tracker.memory_usage();
   for (auto* item = instruction_list.first(); item != nullptr;
        item = instruction_list.next(item)) {
@@ -1919,7 +1940,7 @@ StatusOr<bool> HloRematerialization::RematerializeComputation(
   InstructionList instruction_list(schedule->sequence(computation));
   MemoryUsageTracker memory_tracker(
       computation, size_function_, compact_shape_function_, *dataflow_analysis_,
-      instruction_list, mode_);
+      instruction_list, mode_, compute_cost_function_);
 
   instruction_list.PromoteNodesToSkip([&](Item* item) {
     return memory_tracker.AllocatedSize(item) >= min_remat_size;
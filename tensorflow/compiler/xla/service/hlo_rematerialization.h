@@ -42,6 +42,10 @@ class HloRematerialization : public HloModulePass {
 
   using CompactShapeFunction = std::function<StatusOr<Shape>(const Shape&)>;
 
+  // Returns an estimate of the cost of running the given instruction once, in
+  // arbitrary nonnegative units (e.g. nanoseconds).
+  using ComputeCostFunction = std::function<int64_t(const HloInstruction*)>;
+
   // Helper struct that communicates the before / after sizes for the
   // rematerialization process.
   struct RematerializationSizes {
@@ -80,13 +84,18 @@ class HloRematerialization : public HloModulePass {
   //
   //   compact_shape_function: Function which returns the compact form of a
   //   shape. If nullptr is provided, an default identity function is used.
+  //
+  //   compute_cost_function: Function which estimates the cost of recomputing
+  //   an instruction. If provided, recomputation candidates are ranked by
+  //   compute cost per byte of memory saved instead of by memory saved only.
   explicit HloRematerialization(
       const ShapeSizeFunction& size_function, int64_t memory_limit_bytes,
       RematerializationSizes* sizes, RematerializationPass pass_location,
       int block_size_limit, int block_rematerialization_factor,
       CompactShapeFunction compact_shape_function = nullptr,
       RematerializationMode mode = RematerializationMode::kRecomputeAndCompress,
-      int64_t min_remat_size = 0)
+      int64_t min_remat_size = 0,
+      ComputeCostFunction compute_cost_function = nullptr)
       : size_function_(size_function),
         memory_limit_bytes_(memory_limit_bytes),
         sizes_(sizes),
@@ -97,7 +106,8 @@ class HloRematerialization : public HloModulePass {
                                     ? DefaultCompactShapeFunction
                                     : std::move(compact_shape_function)),
         mode_(mode),
-        min_remat_size_(min_remat_size) {}
+        min_remat_size_(min_remat_size),
+        compute_cost_function_(std::move(compute_cost_function)) {}
   ~HloRematerialization() override = default;
 
   absl::string_view name() const override { return "rematerialization"; }
@@ -224,6 +234,9 @@ class HloRematerialization : public HloModulePass {
 
   int64_t min_remat_size_;
 
+  // Estimates the cost of recomputing an instruction. May be null.
+  const ComputeCostFunction compute_cost_function_;
+
   // Tracking available channel id numbers to use to apply to rematerialized
   // channel instructions
   int64_t next_channel_id_;
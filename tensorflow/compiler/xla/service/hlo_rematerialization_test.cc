@@ -1197,6 +1197,50 @@ ENTRY %entry {
                       op::Fusion(AllOf(op::Fusion(), ::testing::Ne(fusion0)))));
 }
 
+// Test that with a compute cost function the cheaper of two candidates which
+// free the same amount of memory is rematerialized.
+TEST_F(HloRematerializationTest, ComputeCostPrefersCheapCandidate) {
+  const std::string& hlo_string = R"(
+HloModule fusion, is_scheduled=true
+
+ENTRY %mycomp (param: f32[1024]) -> f32[1024] {
+  %param = f32[1024]{0} parameter(0)
+  %constant = f32[] constant(1)
+  %exponential = f32[1024]{0} exponential(f32[1024]{0} %param)
+  %broadcast = f32[1024]{0} broadcast(f32[] %constant), dimensions={}
+  %multiply = f32[1024]{0} multiply(f32[1024]{0} %exponential, f32[1024]{0} %broadcast)
+  %broadcast.1 = f32[4096]{0} broadcast(f32[] %constant), dimensions={}
+  %slice = f32[16]{0} slice(f32[4096]{0} %broadcast.1), slice={[0:16]}
+  %add = f32[1024]{0} add(f32[1024]{0} %exponential, f32[1024]{0} %broadcast)
+  ROOT %add.1 = f32[1024]{0} add(f32[1024]{0} %add, f32[1024]{0} %param)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  const HloComputation* computation = module->entry_computation();
+  const HloInstruction* add = computation->root_instruction()->operand(0);
+  const HloInstruction* exponential = add->operand(0);
+  const HloInstruction* broadcast = add->operand(1);
+
+  // Both the exponential and the broadcast free 4KB while the 16KB broadcast
+  // is live; the exponential is much more expensive to recompute.
+  HloRematerialization remat(
+      ByteSizeOf, /*memory_limit_bytes=*/30 * 1024,
+      /*sizes=*/nullptr,
+      HloRematerialization::RematerializationPass::kPostFusion,
+      /*block_size_limit=*/1, /*block_rematerialization_factor=*/1, nullptr,
+      HloRematerialization::RematerializationMode::kRecomputeOnly,
+      /*min_remat_size=*/0, [](const HloInstruction* instruction) -> int64_t {
+        return instruction->opcode() == HloOpcode::kExponential ? 1000 : 1;
+      });
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, remat.Run(module.get()));
+  EXPECT_TRUE(changed);
+  EXPECT_EQ(add->operand(0), exponential);
+  EXPECT_THAT(add->operand(1),
+              AllOf(op::Broadcast(), ::testing::Ne(broadcast)));
+}
+
 }  // namespace
 
 }  // namespace xla
@@ -40,15 +40,38 @@ limitations under the License.
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instructions.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_opcode.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_schedule.h"
+#include "tensorflow/compiler/xla/layout.h"
 #include "tensorflow/compiler/xla/map_util.h"
 #include "tensorflow/compiler/xla/service/hlo_alias_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_buffer.h"
 #include "tensorflow/compiler/xla/service/hlo_reachability.h"
+#include "tensorflow/compiler/xla/shape.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/status.h"
 #include "tensorflow/compiler/xla/util.h"
 
 namespace xla {
 
+namespace {
+
+// Returns the resource used by `copy_start` if it offloads a buffer to host
+// memory or prefetches one from it, and kNoResource otherwise.
+ResourceType HostCopyResource(const HloInstruction& copy_start) {
+  auto in_host_memory = [](const Shape& shape) {
+    return shape.has_layout() &&
+           shape.layout().memory_space() == Layout::kHostMemorySpace;
+  };
+  if (in_host_memory(ShapeUtil::GetTupleElementShape(copy_start.shape(), 0))) {
+    return ResourceType::kCopyToHost;
+  }
+  if (in_host_memory(copy_start.operand(0)->shape())) {
+    return ResourceType::kCopyFromHost;
+  }
+  return ResourceType::kNoResource;
+}
+
+}  // namespace
+
 LatencyEstimator::TimeCost ApproximateLatencyEstimator::GetLatencyBetween(
     const HloGraphNode& from, const HloGraphNode& target) const {
   // These values are empirically derived to obtain an overlap of one output
@@ -76,6 +99,12 @@ LatencyEstimator::TimeCost ApproximateLatencyEstimator::GetLatencyBetween(
         return kHighLatency;
       }
       break;
+    case HloOpcode::kCopyStart:
+      if (target.GetInstr().opcode() == HloOpcode::kCopyDone &&
+          HostCopyResource(from.GetInstr()) != ResourceType::kNoResource) {
+        return kHighLatency;
+      }
+      break;
     default:
       break;
   }
@@ -120,6 +149,8 @@ bool AsyncTracker::IsSupportedAsyncDone(const HloInstruction& hlo) const {
     case HloOpcode::kSendDone:
     case HloOpcode::kRecvDone:
       return config_.schedule_send_recvs;
+    case HloOpcode::kCopyDone:
+      return HostCopyResource(*hlo.operand(0)) != ResourceType::kNoResource;
     default:
       return false;
   }
@@ -146,6 +177,8 @@ bool AsyncTracker::IsSupportedAsyncStart(const HloInstruction& hlo) const {
     case HloOpcode::kSend:
     case HloOpcode::kRecv:
       return config_.schedule_send_recvs;
+    case HloOpcode::kCopyStart:
+      return HostCopyResource(hlo) != ResourceType::kNoResource;
     default:
       return false;
   }
@@ -202,6 +235,14 @@ ResourcesVector AsyncTracker::GetResourcesFromInstruction(
                                ResourceUsageType::kResourceRelease)
               : std::make_pair(ResourceType::kSendRecv,
                                ResourceUsageType::kResourceRelease)};
+    case HloOpcode::kCopyStart: {
+      const ResourceType resource = HostCopyResource(hlo);
+      if (resource == ResourceType::kNoResource) {
+        return ResourcesVector{};
+      }
+      return ResourcesVector{
+          std::make_pair(resource, ResourceUsageType::kResourceRelease)};
+    }
     case HloOpcode::kAsyncDone:
       switch (hlo.async_wrapped_opcode()) {
         case HloOpcode::kAllToAll:
@@ -240,6 +281,14 @@ ResourcesVector AsyncTracker::GetResourcesFromInstruction(
                                ResourceUsageType::kResourceOccupy)
               : std::make_pair(ResourceType::kSendRecv,
                                ResourceUsageType::kResourceOccupy)};
+    case HloOpcode::kCopyDone: {
+      const ResourceType resource = HostCopyResource(*hlo.operand(0));
+      if (resource == ResourceType::kNoResource) {
+        return ResourcesVector{};
+      }
+      return ResourcesVector{
+          std::make_pair(resource, ResourceUsageType::kResourceOccupy)};
+    }
     case HloOpcode::kSendDone:
       return ResourcesVector{
           static_cast<const HloSendRecvInstruction*>(hlo.operand(0))
@@ -1242,6 +1291,10 @@ DefaultSchedulerCore::ScheduleComputation(const HloComputation* computation) {
       config_.send_recv_host_overlap_limit;
   sched_state.max_concurrent_async[ResourceType::kRecvHost] =
       config_.send_recv_host_overlap_limit;
+  sched_state.max_concurrent_async[ResourceType::kCopyToHost] =
+      config_.copy_to_host_overlap_limit;
+  sched_state.max_concurrent_async[ResourceType::kCopyFromHost] =
+      config_.copy_from_host_overlap_limit;
   // Collect the bottom roots of the graph (nodes that don't have any
   // successor)
   // We are going to use them as starting point for scheduling.
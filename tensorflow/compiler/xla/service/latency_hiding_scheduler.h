@@ -26,11 +26,13 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/inlined_vector.h"
+#include "tensorflow/compiler/xla/layout.h"
 #include "tensorflow/compiler/xla/service/hlo_alias_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_dataflow_analysis.h"
 #include "tensorflow/compiler/xla/service/hlo_pass_interface.h"
 #include "tensorflow/compiler/xla/service/tuple_points_to_analysis.h"
+#include "tensorflow/compiler/xla/shape.h"
 
 namespace xla {
 
@@ -46,7 +48,9 @@ enum class ResourceType {
   kSendRecv = 5,
   kSendHost = 6,
   kRecvHost = 7,
-  kNumResources = 8,
+  kCopyToHost = 8,
+  kCopyFromHost = 9,
+  kNumResources = 10,
 };
 
 enum class ResourceUsageType {
@@ -72,6 +76,10 @@ struct SchedulerConfig {
   int64_t all_reduce_overlap_limit = 1;
   int64_t send_recv_overlap_limit = 1;
   int64_t send_recv_host_overlap_limit = 1;
+  // Limits of the copies that offload buffers to host memory and that prefetch
+  // them back, which are in flight at once.
+  int64_t copy_to_host_overlap_limit = 1;
+  int64_t copy_from_host_overlap_limit = 1;
   bool schedule_send_recvs = false;
   // Consider send recv as the same resource. Some platforms do not take well
   // overlapping the send/recv ops between themselves.
@@ -341,10 +349,15 @@ class BufferInfoTracker {
   static ValueInfo CreateBufferInfo(
       const HloBuffer* value, const HloInstruction* first_definition,
       const HloCostAnalysis::ShapeSizeFunction& shape_size_bytes) {
+    const Shape& shape = value->values()[0]->shape();
+    // Buffers offloaded to host memory take up no device memory.
+    const bool in_host_memory =
+        shape.has_layout() &&
+        shape.layout().memory_space() == Layout::kHostMemorySpace;
     return ValueInfo{
         .value = value,
         .first_definition = first_definition,
-        .buffer_size = shape_size_bytes(value->values()[0]->shape())};
+        .buffer_size = in_host_memory ? 0 : shape_size_bytes(shape)};
   }
   const ValueInfo& GetBufferInfo(HloBuffer::Id id) const {
     return buffer_infos_[id];
@@ -2440,4 +2440,50 @@ ENTRY %module {
                                         new_instruction_sequence, "ata1"));
 }
 
+TEST_F(LatencyHidingSchedulerTest, HostOffloadCopiesOverlapCompute) {
+  absl::string_view hlo_string = R"(
+HloModule module, is_scheduled=true
+
+ENTRY entry {
+  p0 = f32[16,64,256]{2,1,0} parameter(0)
+  p1 = f32[16,64,256]{2,1,0} parameter(1)
+  p2 = f32[16,256,256]{2,1,0} parameter(2)
+  p3 = f32[16,256,256]{2,1,0:S(5)} parameter(3)
+  offload-start = (f32[16,256,256]{2,1,0:S(5)}, f32[16,256,256]{2,1,0}, u32[]) copy-start(p2)
+  offload-done = f32[16,256,256]{2,1,0:S(5)} copy-done(offload-start)
+  prefetch-start = (f32[16,256,256]{2,1,0}, f32[16,256,256]{2,1,0:S(5)}, u32[]) copy-start(p3)
+  prefetch-done = f32[16,256,256]{2,1,0} copy-done(prefetch-start)
+  c0 = f32[16,256,256]{2,1,0} convolution(p0, p1),
+    window={size=16 stride=15 lhs_dilate=16}, dim_labels=0fb_0io->0fb
+  a0 = f32[16,256,256]{2,1,0} add(prefetch-done, c0)
+  ROOT t = (f32[16,256,256]{2,1,0:S(5)}, f32[16,256,256]{2,1,0}) tuple(offload-done, a0)
+}
+)";
+
+  TF_ASSERT_OK_AND_ASSIGN(auto hlo_module, ParseHloText(hlo_string));
+  HloSchedule& module_schedule = hlo_module->schedule();
+  EXPECT_TRUE(hlo_module->has_entry_computation());
+  HloComputation* entry_computation = hlo_module->entry_computation();
+
+  EXPECT_TRUE(RunScheduler(hlo_module.get()).ok());
+  std::vector<HloInstruction*> new_instruction_sequence =
+      module_schedule.sequence(entry_computation).instructions();
+
+  if (VLOG_IS_ON(1)) {
+    for (auto* new_i : new_instruction_sequence) {
+      VLOG(1) << new_i->ToString();
+    }
+  }
+
+  // Both the offload and the prefetch are in flight during the convolution.
+  EXPECT_LT(GetIndex(new_instruction_sequence, "offload-start"),
+            GetIndex(new_instruction_sequence, "c0"));
+  EXPECT_GT(GetIndex(new_instruction_sequence, "offload-done"),
+            GetIndex(new_instruction_sequence, "c0"));
+  EXPECT_LT(GetIndex(new_instruction_sequence, "prefetch-start"),
+            GetIndex(new_instruction_sequence, "c0"));
+  EXPECT_GT(GetIndex(new_instruction_sequence, "prefetch-done"),
+            GetIndex(new_instruction_sequence, "c0"));
+}
+
 }  // namespace xla
@@ -27,6 +27,7 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/array2d.h"
 #include "tensorflow/compiler/xla/client/client_library.h"
+#include "tensorflow/compiler/xla/client/lib/arithmetic.h"
 #include "tensorflow/compiler/xla/client/xla_builder.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_computation.h"
 #include "tensorflow/compiler/xla/hlo/ir/hlo_instruction.h"
@@ -970,5 +971,76 @@ void BM_ParallelFusion(::testing::benchmark::State& state) {
 
 BENCHMARK(BM_ParallelFusion)->UseRealTime();
 
+void BM_ParallelReduce(::testing::benchmark::State& state) {
+  // Row reduction of an element-wise product, to benchmark how parallel tasks
+  // for reductions scale with the number of threads running them. The local
+  // client, which is shared by all runs, splits the reduction for 24 threads.
+  const int64_t num_threads = state.range(0);
+
+  se::Platform* platform = PlatformUtil::GetDefaultPlatform().value();
+  auto executors = PlatformUtil::GetStreamExecutors(platform).value();
+  se::StreamExecutorMemoryAllocator allocator(platform, executors);
+
+  const int64_t intra_op_parallelism_threads = 24;
+  xla::LocalClientOptions client_options;
+  client_options.set_platform(platform);
+  client_options.set_intra_op_parallelism_threads(intra_op_parallelism_threads);
+  auto client = ClientLibrary::GetOrCreateLocalClient(client_options).value();
+
+  int device_ordinal = client->default_device_ordinal();
+
+  const int64_t rows = 1024;
+  const int64_t cols = 4096;
+
+  XlaBuilder builder("ParallelReduce");
+  Shape shape = ShapeUtil::MakeShape(F32, {rows, cols});
+  auto param0 = Parameter(&builder, 0, shape, "param0");
+  auto param1 = Parameter(&builder, 1, shape, "param1");
+  XlaComputation add = CreateScalarAddComputation(F32, &builder);
+  Reduce(Mul(param0, param1), ConstantR0<float>(&builder, 0.0f), add, {1});
+  auto computation = builder.Build().value();
+
+  auto literal = LiteralUtil::CreateR2F32Linspace(1.0, 2.0, rows, cols);
+  ScopedShapedBuffer buffer0 =
+      client->LiteralToShapedBuffer(literal, device_ordinal).value();
+  ScopedShapedBuffer buffer1 =
+      client->LiteralToShapedBuffer(literal, device_ordinal).value();
+
+  ExecutableBuildOptions build_options;
+  build_options.set_device_ordinal(device_ordinal);
+  auto executables =
+      client
+          ->Compile(computation,
+                    {&buffer0.on_host_shape(), &buffer1.on_host_shape()},
+                    build_options)
+          .value();
+  auto executable = std::move(executables[0]);
+
+  se::Stream stream(executors[device_ordinal]);
+  stream.Init();
+
+  tsl::thread::ThreadPool pool(tsl::Env::Default(), "XLAEigen", num_threads);
+  Eigen::ThreadPoolDevice device(pool.AsEigenThreadPool(), pool.NumThreads());
+
+  ExecutableRunOptions options;
+  options.set_allocator(&allocator).set_stream(&stream);
+  options.set_intra_op_thread_pool(&device);
+
+  const int kWarmups = 2;
+  for (int i = 0; i < kWarmups; ++i) {
+    auto result = executable->Run({&buffer0, &buffer1}, options);
+    ASSERT_TRUE(result.ok());
+  }
+
+  for (auto s : state) {
+    auto result = executable->Run({&buffer0, &buffer1}, options);
+    ASSERT_TRUE(result.ok());
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * 2 * rows *
+                          cols * sizeof(float));
+}
+
+BENCHMARK(BM_ParallelReduce)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
 }  // namespace
 }  // namespace xla
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/base_collective_executor.h"
 
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <utility>
 
@@ -33,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/tracing.h"
@@ -227,6 +229,47 @@ CollectiveAdapter* MakeCollectiveAdapter(Tensor* output, int num_chunks,
   }
 }
 
+/*static*/
+CollectiveBucketSizeEstimator* CollectiveBucketSizeEstimator::Global() {
+  static CollectiveBucketSizeEstimator* estimator =
+      new CollectiveBucketSizeEstimator;
+  return estimator;
+}
+
+void CollectiveBucketSizeEstimator::Record(int64_t bytes, int64_t micros) {
+  mutex_lock l(mu_);
+  samples_.emplace_back(bytes, micros);
+  if (samples_.size() > static_cast<size_t>(kMaxSamples)) {
+    samples_.pop_front();
+  }
+}
+
+int64_t CollectiveBucketSizeEstimator::SuggestedBucketBytes() const {
+  double n, sum_x = 0, sum_y = 0, sum_xx = 0, sum_xy = 0;
+  {
+    mutex_lock l(mu_);
+    if (samples_.size() < static_cast<size_t>(kMinSamples)) return 0;
+    n = samples_.size();
+    for (const auto& sample : samples_) {
+      const double x = sample.first;
+      const double y = sample.second;
+      sum_x += x;
+      sum_y += y;
+      sum_xx += x * x;
+      sum_xy += x * y;
+    }
+  }
+  // Least squares fit of micros = latency + micros_per_byte * bytes.
+  const double denominator = n * sum_xx - sum_x * sum_x;
+  if (denominator <= 0) return 0;
+  const double micros_per_byte = (n * sum_xy - sum_x * sum_y) / denominator;
+  const double latency = (sum_y - micros_per_byte * sum_x) / n;
+  if (micros_per_byte <= 0 || latency <= 0) return 0;
+  const double bytes = kLatencyMultiple * latency / micros_per_byte;
+  return std::min<double>(std::max<double>(bytes, kMinBucketBytes),
+                          kMaxBucketBytes);
+}
+
 BaseCollectiveExecutor::~BaseCollectiveExecutor() {}
 
 void BaseCollectiveExecutor::StartAbort(const Status& s) {
@@ -273,6 +316,9 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
                                           const CollectiveParams* col_params,
                                           const string& exec_key,
                                           StatusCallback done) {
+  if (col_params->instance.type == REDUCTION_COLLECTIVE) {
+    done = RecordReduction(ctx->input(0).TotalBytes(), std::move(done));
+  }
   // See CompleteParamsAsync() how done() and the timeout callback interacts.
   const auto is_callback_called = std::make_shared<std::atomic<bool>>(false);
   auto done_safe = [this, done, ctx, is_callback_called](const Status& s) {
@@ -353,6 +399,28 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
   });
 }
 
+StatusCallback BaseCollectiveExecutor::RecordReduction(int64_t bytes,
+                                                      StatusCallback done) {
+  const int64_t start_micros = Env::Default()->NowMicros();
+  return [bytes, start_micros, done = std::move(done)](const Status& s) {
+    if (s.ok()) {
+      CollectiveBucketSizeEstimator* estimator =
+          CollectiveBucketSizeEstimator::Global();
+      estimator->Record(bytes, Env::Default()->NowMicros() - start_micros);
+      static std::atomic<bool> logged(false);
+      if (!logged.load(std::memory_order_relaxed)) {
+        const int64_t bucket_bytes = estimator->SuggestedBucketBytes();
+        if (bucket_bytes > 0 && !logged.exchange(true)) {
+          LOG(INFO) << "Measured collective all-reduce cost suggests packing "
+                       "gradients into buckets of "
+                    << bucket_bytes << " bytes (bytes_per_pack).";
+        }
+      }
+    }
+    done(s);
+  };
+}
+
 void BaseCollectiveExecutor::CompleteParamsAsync(
     const DeviceAttributes& device, CollectiveParams* cp,
     CancellationManager* cancel_mgr, StatusCallback done) {
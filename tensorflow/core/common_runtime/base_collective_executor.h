@@ -15,12 +15,15 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_BASE_COLLECTIVE_EXECUTOR_H_
 
+#include <deque>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
 
 namespace tensorflow {
@@ -90,6 +93,38 @@ CollectiveAdapter* MakeCollectiveAdapter(Tensor* output, int num_chunks,
                                          Allocator* allocator,
                                          bool align_chunks = true);
 
+// Estimates the all-reduce bucket size that amortizes the fixed cost of a
+// collective, from the reductions this process has run.  Each sample is the
+// size of a reduction and its wall time, which is fitted as
+// `micros = latency + bytes / bandwidth`; the suggested size is the one whose
+// transfer time is kLatencyMultiple times the latency, so that the latency is
+// at most 10% of the time of a bucket.
+//
+// The suggestion is only advisory: every worker must pack its gradients into
+// the same buckets, so it is logged for use as the `bytes_per_pack` of the
+// collective all-reduce rather than applied by the runtime.
+class CollectiveBucketSizeEstimator {
+ public:
+  static constexpr int kMaxSamples = 1024;
+  static constexpr int kMinSamples = 32;
+  static constexpr double kLatencyMultiple = 9.0;
+  static constexpr int64_t kMinBucketBytes = 1 << 20;
+  static constexpr int64_t kMaxBucketBytes = 256 << 20;
+
+  // Returns the estimator for the reductions of this process.
+  static CollectiveBucketSizeEstimator* Global();
+
+  void Record(int64_t bytes, int64_t micros) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the suggested bucket size in bytes, or 0 if there are too few
+  // samples, or they are too alike, to fit.
+  int64_t SuggestedBucketBytes() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutable mutex mu_;
+  std::deque<std::pair<int64_t, int64_t>> samples_ TF_GUARDED_BY(mu_);
+};
+
 // Default implementation of CollectiveExecutor.  Delegates the actual
 // work of moving data to a class specialized for the operation type,
 // arguments and device+interconnect topology.
@@ -152,6 +187,9 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
  private:
   Status CreateCollective(const CollectiveParams& col_params,
                           CollectiveImplementationInterface** col_impl);
+  // Wraps `done` to record the wall time of a reduction of `bytes` in
+  // CollectiveBucketSizeEstimator::Global().
+  static StatusCallback RecordReduction(int64_t bytes, StatusCallback done);
   // Check if all ops on which this collective depends on have launched.
   bool CheckDependencies(const CollectiveParams& col_params)
       TF_EXCLUSIVE_LOCKS_REQUIRED(launch_mu_);
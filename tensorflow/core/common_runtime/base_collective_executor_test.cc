@@ -0,0 +1,60 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(CollectiveBucketSizeEstimatorTest, TooFewSamples) {
+  CollectiveBucketSizeEstimator estimator;
+  for (int i = 0; i < CollectiveBucketSizeEstimator::kMinSamples - 1; ++i) {
+    estimator.Record((i + 1) << 20, 100 + i);
+  }
+  EXPECT_EQ(estimator.SuggestedBucketBytes(), 0);
+}
+
+TEST(CollectiveBucketSizeEstimatorTest, SameSizes) {
+  CollectiveBucketSizeEstimator estimator;
+  for (int i = 0; i < CollectiveBucketSizeEstimator::kMinSamples; ++i) {
+    estimator.Record(1 << 20, 100 + i);
+  }
+  EXPECT_EQ(estimator.SuggestedBucketBytes(), 0);
+}
+
+TEST(CollectiveBucketSizeEstimatorTest, FitsLatencyAndBandwidth) {
+  // 500us of latency and 1 GB/s, i.e. 1us per KB.
+  CollectiveBucketSizeEstimator estimator;
+  for (int i = 0; i < CollectiveBucketSizeEstimator::kMinSamples; ++i) {
+    const int64_t bytes = (i + 1) * 100 * 1000;
+    estimator.Record(bytes, 500 + bytes / 1000);
+  }
+  const int64_t expected = 9 * 500 * 1000;
+  EXPECT_NEAR(estimator.SuggestedBucketBytes(), expected, expected / 100);
+}
+
+TEST(CollectiveBucketSizeEstimatorTest, Clamped) {
+  CollectiveBucketSizeEstimator estimator;
+  for (int i = 0; i < CollectiveBucketSizeEstimator::kMinSamples; ++i) {
+    const int64_t bytes = (i + 1) * 1000;
+    estimator.Record(bytes, 1 + bytes);
+  }
+  EXPECT_EQ(estimator.SuggestedBucketBytes(),
+            CollectiveBucketSizeEstimator::kMinBucketBytes);
+}
+
+}  // namespace
+}  // namespace tensorflow
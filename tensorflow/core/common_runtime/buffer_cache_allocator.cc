@@ -0,0 +1,133 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/buffer_cache_allocator.h"
+
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the size class of a request of `num_bytes`, or -1 if it is not
+// cached.
+int SizeClass(size_t num_bytes) {
+  if (num_bytes == 0 || num_bytes > BufferCacheAllocator::kMaxCachedSize) {
+    return -1;
+  }
+  int size_class = 0;
+  while ((BufferCacheAllocator::kMinCachedSize << size_class) < num_bytes) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+}  // namespace
+
+BufferCacheAllocator::BufferCacheAllocator(Allocator* underlying,
+                                           size_t max_cached_bytes)
+    : underlying_(underlying),
+      max_cached_bytes_(max_cached_bytes),
+      free_buffers_(SizeClass(kMaxCachedSize) + 1) {
+  CHECK(underlying_ != nullptr);
+}
+
+BufferCacheAllocator::~BufferCacheAllocator() { ClearCache(); }
+
+void BufferCacheAllocator::ClearCache() {
+  std::vector<std::vector<void*>> free_buffers(free_buffers_.size());
+  {
+    mutex_lock l(mu_);
+    free_buffers.swap(free_buffers_);
+    cached_bytes_ = 0;
+  }
+  for (const std::vector<void*>& buffers : free_buffers) {
+    for (void* buffer : buffers) underlying_->DeallocateRaw(buffer);
+  }
+}
+
+void BufferCacheAllocator::Release() {
+  ClearCache();
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    if (live_allocations_ > 0) return;
+  }
+  delete this;
+}
+
+size_t BufferCacheAllocator::cached_bytes() const {
+  tf_shared_lock l(mu_);
+  return cached_bytes_;
+}
+
+void* BufferCacheAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  const int size_class =
+      alignment <= Allocator::kAllocatorAlignment ? SizeClass(num_bytes) : -1;
+  void* ptr = nullptr;
+  if (size_class >= 0) {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    std::vector<void*>& buffers = free_buffers_[size_class];
+    if (!buffers.empty()) {
+      ptr = buffers.back();
+      buffers.pop_back();
+      cached_bytes_ -= kMinCachedSize << size_class;
+      live_buffers_.emplace(ptr, size_class);
+      ++live_allocations_;
+      return ptr;
+    }
+  }
+  if (size_class >= 0) {
+    ptr = underlying_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                   kMinCachedSize << size_class,
+                                   allocation_attr);
+  } else {
+    ptr = underlying_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    if (size_class >= 0) live_buffers_.emplace(ptr, size_class);
+    ++live_allocations_;
+  }
+  return ptr;
+}
+
+void BufferCacheAllocator::DeallocateRaw(void* ptr) {
+  bool keep = false;
+  bool last_deallocation;
+  {
+    mutex_lock l(mu_);
+    auto it = live_buffers_.find(ptr);
+    if (it != live_buffers_.end()) {
+      const size_t size = kMinCachedSize << it->second;
+      if (!released_ && cached_bytes_ + size <= max_cached_bytes_) {
+        free_buffers_[it->second].push_back(ptr);
+        cached_bytes_ += size;
+        keep = true;
+      }
+      live_buffers_.erase(it);
+    }
+    DCHECK_GT(live_allocations_, 0);
+    last_deallocation = --live_allocations_ == 0 && released_;
+  }
+  if (!keep) underlying_->DeallocateRaw(ptr);
+  if (last_deallocation) delete this;
+}
+
+}  // namespace tensorflow
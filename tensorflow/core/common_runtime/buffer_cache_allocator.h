@@ -0,0 +1,93 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_BUFFER_CACHE_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_BUFFER_CACHE_ALLOCATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Recycles freed buffers by size class.
+//
+// Eager ops allocate and free their outputs at a high rate, mostly with the
+// same few sizes. Requests of at most kMaxCachedSize bytes are rounded up to a
+// power of two, of at least kMinCachedSize, and served from the buffers of
+// that size that were freed earlier. A freed buffer is kept for reuse unless
+// the cache already holds `max_cached_bytes`, in which case it is returned to
+// `underlying`. Larger requests, and requests for an alignment larger than
+// Allocator::kAllocatorAlignment, are forwarded to `underlying`.
+//
+// Tensors may outlive the owner of the cache: an instance deletes itself once
+// Release() has been called and every buffer it handed out has been freed.
+class BufferCacheAllocator : public Allocator {
+ public:
+  static constexpr size_t kMinCachedSize = 256;
+  static constexpr size_t kMaxCachedSize = 1 << 20;
+
+  // Does not take ownership of `underlying`, which must outlive this object.
+  BufferCacheAllocator(Allocator* underlying, size_t max_cached_bytes);
+
+  // Returns the cached buffers to `underlying`.
+  void ClearCache() TF_LOCKS_EXCLUDED(mu_);
+
+  // Clears the cache. The object is deleted once all of its allocations have
+  // been deallocated, which may be immediately.
+  void Release() TF_LOCKS_EXCLUDED(mu_);
+
+  // The total size of the buffers that are kept for reuse.
+  size_t cached_bytes() const TF_LOCKS_EXCLUDED(mu_);
+
+  std::string Name() override { return "buffer_cache"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr)
+      TF_LOCKS_EXCLUDED(mu_) override;
+  void DeallocateRaw(void* ptr) TF_LOCKS_EXCLUDED(mu_) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return underlying_->GetMemoryType();
+  }
+
+ private:
+  ~BufferCacheAllocator() override;
+
+  Allocator* const underlying_;  // Not owned.
+  const size_t max_cached_bytes_;
+
+  mutable mutex mu_;
+  // Indexed by size class: the freed buffers of size kMinCachedSize << class.
+  std::vector<std::vector<void*>> free_buffers_ TF_GUARDED_BY(mu_);
+  size_t cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+  // The size class of every live buffer that is recycled when freed.
+  absl::flat_hash_map<void*, int> live_buffers_ TF_GUARDED_BY(mu_);
+  // Including the allocations forwarded to `underlying_`.
+  int64_t live_allocations_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BufferCacheAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_BUFFER_CACHE_ALLOCATOR_H_
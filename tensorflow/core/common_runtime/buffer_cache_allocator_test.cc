@@ -0,0 +1,115 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/buffer_cache_allocator.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Forwards to cpu_allocator() and counts live allocations.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations() const { return num_allocations_; }
+  int num_live() const { return num_live_; }
+
+ private:
+  int num_allocations_ = 0;
+  int num_live_ = 0;
+};
+
+TEST(BufferCacheAllocatorTest, RecyclesBuffersOfTheSameSizeClass) {
+  CountingAllocator underlying;
+  BufferCacheAllocator* cache =
+      new BufferCacheAllocator(&underlying, /*max_cached_bytes=*/1 << 20);
+  void* ptr = cache->AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  ASSERT_NE(ptr, nullptr);
+  cache->DeallocateRaw(ptr);
+  EXPECT_EQ(cache->cached_bytes(), 1024);
+  EXPECT_EQ(underlying.num_live(), 1);
+
+  // 900 bytes also round up to 1KiB.
+  EXPECT_EQ(cache->AllocateRaw(Allocator::kAllocatorAlignment, 900), ptr);
+  EXPECT_EQ(underlying.num_allocations(), 1);
+  EXPECT_EQ(cache->cached_bytes(), 0);
+  // Another size class.
+  void* other = cache->AllocateRaw(Allocator::kAllocatorAlignment, 2000);
+  EXPECT_NE(other, ptr);
+  EXPECT_EQ(underlying.num_allocations(), 2);
+  cache->DeallocateRaw(ptr);
+  cache->DeallocateRaw(other);
+
+  cache->ClearCache();
+  EXPECT_EQ(underlying.num_live(), 0);
+  cache->Release();
+}
+
+TEST(BufferCacheAllocatorTest, LargeAllocationsAreNotCached) {
+  CountingAllocator underlying;
+  BufferCacheAllocator* cache =
+      new BufferCacheAllocator(&underlying, /*max_cached_bytes=*/16 << 20);
+  void* ptr = cache->AllocateRaw(Allocator::kAllocatorAlignment,
+                                 BufferCacheAllocator::kMaxCachedSize + 1);
+  ASSERT_NE(ptr, nullptr);
+  cache->DeallocateRaw(ptr);
+  EXPECT_EQ(underlying.num_live(), 0);
+  EXPECT_EQ(cache->cached_bytes(), 0);
+  cache->Release();
+}
+
+TEST(BufferCacheAllocatorTest, MaxCachedBytes) {
+  CountingAllocator underlying;
+  BufferCacheAllocator* cache =
+      new BufferCacheAllocator(&underlying, /*max_cached_bytes=*/2048);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 4; ++i) {
+    ptrs.push_back(cache->AllocateRaw(Allocator::kAllocatorAlignment, 1024));
+  }
+  for (void* ptr : ptrs) cache->DeallocateRaw(ptr);
+  // Only two buffers fit in the cache.
+  EXPECT_EQ(cache->cached_bytes(), 2048);
+  EXPECT_EQ(underlying.num_live(), 2);
+  cache->Release();
+  EXPECT_EQ(underlying.num_live(), 0);
+}
+
+TEST(BufferCacheAllocatorTest, TensorsOutliveRelease) {
+  CountingAllocator underlying;
+  BufferCacheAllocator* cache =
+      new BufferCacheAllocator(&underlying, /*max_cached_bytes=*/1 << 20);
+  Tensor escaped(cache, DT_FLOAT, TensorShape({16}));
+  escaped.flat<float>().setConstant(1.0f);
+  cache->Release();
+  EXPECT_EQ(underlying.num_live(), 1);
+  EXPECT_EQ(escaped.flat<float>()(15), 1.0f);
+  escaped = Tensor();
+  EXPECT_EQ(underlying.num_live(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,227 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks the collective implementations against each other, and writes
+// the fastest one per tensor size as a table that
+// CollectiveParamResolverLocal reads from TF_COLLECTIVE_IMPL_TABLE, e.g.
+//
+//   TF_COLLECTIVE_BENCHMARK_TABLE=/tmp/impl_table collective_benchmark_test
+//
+// The members run in this process on CPU devices, so the numbers measure the
+// algorithms and their overheads rather than a particular network.
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+struct Implementation {
+  const char* name;
+  CollectiveType type;
+};
+
+constexpr Implementation kImplementations[] = {
+    {"RingReduce", REDUCTION_COLLECTIVE},
+    {"HierarchicalReduce", REDUCTION_COLLECTIVE},
+    {"RingGather", GATHER_COLLECTIVE},
+    {"HierarchicalTreeBroadcast", BROADCAST_COLLECTIVE},
+};
+
+// Runs `impl` once on every member of `test_env`, on float tensors of
+// `num_elements`. The members of one run share their keys, so runs must not
+// overlap.
+void RunCollectiveOnAllMembers(CollectiveTestEnv* test_env,
+                               const Implementation& impl, int num_elements) {
+  const int group_size =
+      test_env->num_workers * test_env->num_devices_per_worker;
+  const TensorShape shape({num_elements});
+  BlockingCounter counter(group_size);
+  for (int rank = 0; rank < group_size; ++rank) {
+    SchedClosure([test_env, &impl, &shape, rank, group_size, &counter]() {
+      auto col_params = CreateCollectiveParams(*test_env, rank, impl.name,
+                                               impl.type, DT_FLOAT, shape);
+      if (impl.type == BROADCAST_COLLECTIVE) {
+        col_params->is_source = (rank == 0);
+        col_params->source_rank = 0;
+      }
+      Device* device = nullptr;
+      TF_CHECK_OK(test_env->device_mgr->LookupDevice(
+          col_params->group.members[rank].device.name(), &device));
+      Tensor input(DT_FLOAT, shape);
+      input.flat<float>().setConstant(rank);
+      TensorShape output_shape = shape;
+      if (impl.type == GATHER_COLLECTIVE) {
+        output_shape.set_dim(0, num_elements * group_size);
+      }
+      Tensor output(DT_FLOAT, output_shape);
+      TF_CHECK_OK(RunCollective(test_env, col_params.get(), device, &input,
+                                &output));
+      counter.DecrementCount();
+    });
+  }
+  counter.Wait();
+}
+
+void BM_Collective(::testing::benchmark::State& state) {
+  const Implementation& impl = kImplementations[state.range(0)];
+  const int num_workers = state.range(1);
+  const int num_devices_per_worker = state.range(2);
+  const int num_elements = state.range(3);
+  auto test_env =
+      CreateCollectiveTestEnv(num_workers, num_devices_per_worker, DEVICE_CPU);
+  for (auto s : state) {
+    RunCollectiveOnAllMembers(test_env.get(), impl, num_elements);
+  }
+  state.SetLabel(impl.name);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_elements * sizeof(float));
+}
+
+void CollectiveArgs(::testing::benchmark::internal::Benchmark* b) {
+  for (int i = 0; i < static_cast<int>(std::size(kImplementations)); ++i) {
+    for (const auto& topology : {std::make_pair(2, 2), std::make_pair(4, 4)}) {
+      for (int num_elements : {1 << 8, 1 << 14, 1 << 20}) {
+        b->Args({i, topology.first, topology.second, num_elements});
+      }
+    }
+  }
+}
+
+BENCHMARK(BM_Collective)->Apply(CollectiveArgs);
+
+// Returns the mean time in microseconds of `impl` on `num_elements`.
+double MeanMicros(CollectiveTestEnv* test_env, const Implementation& impl,
+                  int num_elements, int num_runs) {
+  // Leaves the first run, which warms up the thread pool, out of the mean.
+  RunCollectiveOnAllMembers(test_env, impl, num_elements);
+  const uint64 start_micros = Env::Default()->NowMicros();
+  for (int i = 0; i < num_runs; ++i) {
+    RunCollectiveOnAllMembers(test_env, impl, num_elements);
+  }
+  return static_cast<double>(Env::Default()->NowMicros() - start_micros) /
+         num_runs;
+}
+
+// Sweeps the tensor sizes and writes the fastest implementation of each type
+// to the file named by TF_COLLECTIVE_BENCHMARK_TABLE, starting a new line
+// of the table wherever the fastest one changes.
+TEST(CollectiveBenchmarkTest, WriteImplTable) {
+  string path;
+  TF_ASSERT_OK(
+      ReadStringFromEnvVar("TF_COLLECTIVE_BENCHMARK_TABLE", "", &path));
+  if (path.empty()) {
+    GTEST_SKIP() << "TF_COLLECTIVE_BENCHMARK_TABLE is not set";
+  }
+  int64_t num_workers, num_devices_per_worker, num_runs;
+  TF_ASSERT_OK(
+      ReadInt64FromEnvVar("TF_COLLECTIVE_BENCHMARK_WORKERS", 2, &num_workers));
+  TF_ASSERT_OK(ReadInt64FromEnvVar("TF_COLLECTIVE_BENCHMARK_DEVICES", 2,
+                                   &num_devices_per_worker));
+  TF_ASSERT_OK(
+      ReadInt64FromEnvVar("TF_COLLECTIVE_BENCHMARK_RUNS", 10, &num_runs));
+  auto test_env =
+      CreateCollectiveTestEnv(num_workers, num_devices_per_worker, DEVICE_CPU);
+  const bool hierarchical = num_workers >= 2 && num_devices_per_worker >= 2;
+  collective_util::CollectiveImplTable table;
+  for (CollectiveType type :
+       {REDUCTION_COLLECTIVE, GATHER_COLLECTIVE, BROADCAST_COLLECTIVE}) {
+    string previous;
+    for (int num_elements = 1; num_elements <= (1 << 22); num_elements *= 4) {
+      const Implementation* fastest = nullptr;
+      double fastest_micros = 0;
+      for (const Implementation& impl : kImplementations) {
+        if (impl.type != type ||
+            (!hierarchical && string(impl.name) == "HierarchicalReduce")) {
+          continue;
+        }
+        const double micros =
+            MeanMicros(test_env.get(), impl, num_elements, num_runs);
+        VLOG(1) << impl.name << " " << num_elements << ": " << micros << "us";
+        if (fastest == nullptr || micros < fastest_micros) {
+          fastest = &impl;
+          fastest_micros = micros;
+        }
+      }
+      if (fastest->name != previous) {
+        // Sizes from the previous one up belong to the new fastest one.
+        const int64_t min_bytes =
+            previous.empty() ? 0 : num_elements / 4 * sizeof(float) + 1;
+        table.Add(type, DEVICE_CPU, min_bytes, fastest->name);
+        previous = fastest->name;
+      }
+    }
+  }
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, table.ToString()));
+}
+
+TEST(CollectiveImplTableTest, ParseAndLookup) {
+  collective_util::CollectiveImplTable table;
+  TF_ASSERT_OK(collective_util::CollectiveImplTable::Parse(
+      "# Measured on 2 workers with 2 devices each.\n"
+      "reduction CPU 0 RingReduce\n"
+      "reduction CPU 65536 HierarchicalReduce  # Past the crossover.\n"
+      "\n"
+      "gather GPU 0 RingGather\n",
+      &table));
+  EXPECT_EQ(table.Lookup(REDUCTION_COLLECTIVE, DEVICE_CPU, 0), "RingReduce");
+  EXPECT_EQ(table.Lookup(REDUCTION_COLLECTIVE, DEVICE_CPU, 65535),
+            "RingReduce");
+  EXPECT_EQ(table.Lookup(REDUCTION_COLLECTIVE, DEVICE_CPU, 65536),
+            "HierarchicalReduce");
+  EXPECT_EQ(table.Lookup(REDUCTION_COLLECTIVE, DEVICE_GPU, 65536), "");
+  EXPECT_EQ(table.Lookup(GATHER_COLLECTIVE, DEVICE_CPU, 4), "");
+  EXPECT_EQ(table.Lookup(GATHER_COLLECTIVE, DEVICE_GPU, 4), "RingGather");
+  EXPECT_EQ(table.Lookup(BROADCAST_COLLECTIVE, DEVICE_CPU, 4), "");
+
+  collective_util::CollectiveImplTable reparsed;
+  TF_ASSERT_OK(
+      collective_util::CollectiveImplTable::Parse(table.ToString(), &reparsed));
+  EXPECT_EQ(reparsed.ToString(), table.ToString());
+}
+
+TEST(CollectiveImplTableTest, ParseError) {
+  collective_util::CollectiveImplTable table;
+  EXPECT_FALSE(collective_util::CollectiveImplTable::Parse(
+                   "reduction CPU 0 RingReduce\npermute CPU 0 Permute\n",
+                   &table)
+                   .ok());
+  EXPECT_FALSE(collective_util::CollectiveImplTable::Parse(
+                   "reduction CPU -1 RingReduce\n", &table)
+                   .ok());
+  EXPECT_FALSE(
+      collective_util::CollectiveImplTable::Parse("reduction CPU 0\n", &table)
+          .ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -34,11 +35,13 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -47,12 +50,35 @@ CollectiveParamResolverLocal::CollectiveParamResolverLocal(
     DeviceResolverInterface* dev_resolver,
     NcclCommunicatorInterface* nccl_communicator, const string& task_name)
     : nccl_(config.experimental().collective_nccl()),
+      hierarchical_reduce_(false),
+      bf16_wire_format_(false),
       dev_mgr_(dev_mgr),
       dev_resolver_(dev_resolver),
       nccl_communicator_(nccl_communicator),
       task_name_(task_name),
       gpu_ring_order_(
-          config.gpu_options().experimental().collective_ring_order()) {}
+          config.gpu_options().experimental().collective_ring_order()) {
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_COLLECTIVE_HIERARCHICAL_REDUCE",
+                                 /*default_val=*/false,
+                                 &hierarchical_reduce_));
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_COLLECTIVE_BF16_WIRE_FORMAT",
+                                 /*default_val=*/false, &bf16_wire_format_));
+  string impl_table_path;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_COLLECTIVE_IMPL_TABLE",
+                                   /*default_val=*/"", &impl_table_path));
+  if (!impl_table_path.empty()) {
+    string text;
+    Status s = ReadFileToString(Env::Default(), impl_table_path, &text);
+    if (s.ok()) {
+      s = collective_util::CollectiveImplTable::Parse(text, &impl_table_);
+    }
+    if (!s.ok()) {
+      LOG(ERROR) << "Ignoring collective implementation table "
+                 << impl_table_path << ": " << s;
+      impl_table_ = collective_util::CollectiveImplTable();
+    }
+  }
+}
 
 void CollectiveParamResolverLocal::CompleteGroupAsync(
     const DeviceAttributes& device, CollGroupParams* group_params,
@@ -708,6 +734,44 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // The implementation table, e.g. as written by collective_benchmark_test,
+  // picks among the registered implementations by tensor size unless
+  // `communication_hint` asks for a particular one.
+  const string& hint = cp->instance.impl_details.communication_hint;
+  std::vector<std::vector<int>> task_ranks;
+  if (!use_nccl && !impl_table_.empty() && (hint.empty() || hint == "auto")) {
+    const int64_t bytes = cp->instance.shape.num_elements() *
+                          DataTypeSize(cp->instance.data_type);
+    const string name = impl_table_.Lookup(
+        cp->instance.type, cp->group.device_type.type_string(), bytes);
+    if (!name.empty() &&
+        CollectiveRegistry::LookupParamResolverInstance(name, &col_impl).ok() &&
+        (name != "HierarchicalReduce" ||
+         collective_util::GetTaskRanks(cp->group, &task_ranks))) {
+      cp->instance.impl_details.collective_name = name;
+    }
+  }
+  // Reductions over groups that span several tasks, each with several
+  // devices, may reduce within each task first, so that only part of the
+  // tensor crosses the network from each device. This is used if indicated
+  // either in `communication_hint` or by TF_COLLECTIVE_HIERARCHICAL_REDUCE.
+  if (!use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      (hierarchical_reduce_ ||
+       cp->instance.impl_details.communication_hint == "hierarchical") &&
+      collective_util::GetTaskRanks(cp->group, &task_ranks)) {
+    cp->instance.impl_details.collective_name = "HierarchicalReduce";
+  }
+  // Float ring reductions on CPU may send their data as bfloat16, halving the
+  // bytes on the wire at the cost of precision. This is used if indicated
+  // either in `communication_hint` or by TF_COLLECTIVE_BF16_WIRE_FORMAT.
+  cp->instance.impl_details.wire_dtype = DT_INVALID;
+  if (cp->instance.impl_details.collective_name == "RingReduce" &&
+      cp->instance.data_type == DT_FLOAT &&
+      cp->group.device_type == DEVICE_CPU &&
+      (bf16_wire_format_ ||
+       cp->instance.impl_details.communication_hint == "ring_bf16")) {
+    cp->instance.impl_details.wire_dtype = DT_BFLOAT16;
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
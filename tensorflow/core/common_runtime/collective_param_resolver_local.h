@@ -22,6 +22,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/collective_util.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
@@ -186,6 +187,16 @@ class CollectiveParamResolverLocal : public ParamResolverInterface {
       TF_LOCKS_EXCLUDED(status_mu_, group_mu_, instance_mu_);
 
   const bool nccl_;
+  // Whether to all-reduce hierarchically in groups that span several tasks,
+  // set by TF_COLLECTIVE_HIERARCHICAL_REDUCE.
+  bool hierarchical_reduce_;
+  // Whether to send the data of float reductions on CPU as bfloat16, set by
+  // TF_COLLECTIVE_BF16_WIRE_FORMAT.
+  bool bf16_wire_format_;
+  // Implementations to use by tensor size, read from the file named by
+  // TF_COLLECTIVE_IMPL_TABLE. Every task must read the same table, since the
+  // members of a collective have to agree on its implementation.
+  collective_util::CollectiveImplTable impl_table_;
   const DeviceMgr* dev_mgr_;
   DeviceResolverInterface* dev_resolver_;  // Not owned.
   NcclCommunicatorInterface* nccl_communicator_;  // Not owned.
@@ -15,8 +15,13 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/collective_util.h"
 
 #include <memory>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/collective.h"
@@ -80,6 +85,98 @@ string SubdivPermDebugString(const CollectiveParams& col_params) {
   return buf;
 }
 
+bool GetTaskRanks(const CollGroupParams& group,
+                  std::vector<std::vector<int>>* task_ranks) {
+  task_ranks->clear();
+  absl::flat_hash_map<string, int> task_index;
+  for (int rank = 0; rank < group.members.size(); ++rank) {
+    auto it = task_index
+                  .emplace(group.members[rank].task,
+                           static_cast<int>(task_ranks->size()))
+                  .first;
+    if (it->second == task_ranks->size()) {
+      task_ranks->emplace_back();
+    }
+    (*task_ranks)[it->second].push_back(rank);
+  }
+  if (task_ranks->size() < 2) return false;
+  for (const std::vector<int>& ranks : *task_ranks) {
+    if (ranks.size() < 2 || ranks.size() != task_ranks->front().size()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace {
+
+// Names of the collective types in the text form of CollectiveImplTable.
+constexpr std::pair<CollectiveType, const char*> kTableTypeNames[] = {
+    {REDUCTION_COLLECTIVE, "reduction"},
+    {BROADCAST_COLLECTIVE, "broadcast"},
+    {GATHER_COLLECTIVE, "gather"},
+};
+
+}  // namespace
+
+/*static*/
+Status CollectiveImplTable::Parse(StringPiece text,
+                                  CollectiveImplTable* table) {
+  int line_number = 0;
+  for (StringPiece line : absl::StrSplit(text, '\n')) {
+    ++line_number;
+    line = line.substr(0, line.find('#'));
+    std::vector<StringPiece> fields =
+        absl::StrSplit(line, absl::ByAnyChar(" \t"), absl::SkipWhitespace());
+    if (fields.empty()) continue;
+    const CollectiveType* type = nullptr;
+    for (const auto& type_name : kTableTypeNames) {
+      if (fields[0] == type_name.second) type = &type_name.first;
+    }
+    int64_t min_bytes;
+    if (fields.size() != 4 || type == nullptr ||
+        !absl::SimpleAtoi(fields[2], &min_bytes) || min_bytes < 0) {
+      return errors::InvalidArgument(
+          "Line ", line_number, " of collective implementation table \"", line,
+          "\" is not \"<reduction|broadcast|gather> <device type> <min bytes> "
+          "<implementation>\"");
+    }
+    table->Add(*type, string(fields[1]), min_bytes, string(fields[3]));
+  }
+  return OkStatus();
+}
+
+void CollectiveImplTable::Add(CollectiveType type, const string& device_type,
+                              int64_t min_bytes,
+                              const string& implementation) {
+  entries_[std::make_tuple(type, device_type, min_bytes)] = implementation;
+}
+
+string CollectiveImplTable::Lookup(CollectiveType type,
+                                   const string& device_type,
+                                   int64_t bytes) const {
+  auto it = entries_.upper_bound(std::make_tuple(type, device_type, bytes));
+  if (it == entries_.begin()) return "";
+  --it;
+  if (std::get<0>(it->first) != type || std::get<1>(it->first) != device_type) {
+    return "";
+  }
+  return it->second;
+}
+
+string CollectiveImplTable::ToString() const {
+  string text;
+  for (const auto& entry : entries_) {
+    for (const auto& type_name : kTableTypeNames) {
+      if (std::get<0>(entry.first) != type_name.first) continue;
+      strings::StrAppend(&text, type_name.second, " ", std::get<1>(entry.first),
+                         " ", std::get<2>(entry.first), " ", entry.second,
+                         "\n");
+    }
+  }
+  return text;
+}
+
 SubContext::SubContext(OpKernelContext* ctx, OpKernelContext::Params* params,
                        OpKernel* op, Tensor* output, Tensor* input)
     : sub_params_(*params),
@@ -15,7 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_UTIL_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_COLLECTIVE_UTIL_H_
 
+#include <map>
 #include <string>
+#include <tuple>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -23,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
 
 namespace tensorflow {
 namespace collective_util {
@@ -32,6 +36,41 @@ Status InitializeDeviceAndLocality(const DeviceMgr* dev_mgr,
                                    DeviceLocality* device_locality);
 string SubdivPermDebugString(const CollectiveParams& col_params);
 
+// Splits the ranks of the members of `group` by task, in the order of the
+// members. Returns false unless the group spans at least two tasks with the
+// same number, at least two, of members each, as hierarchical collectives
+// require.
+bool GetTaskRanks(const CollGroupParams& group,
+                  std::vector<std::vector<int>>* task_ranks);
+
+// Implementations to use for collectives by type, device type and tensor size,
+// e.g. the fastest ones measured by collective_benchmark_test. Each line of
+// the text form reads "<type> <device type> <min bytes> <implementation>",
+// where <type> is "reduction", "broadcast" or "gather". Text after "#" is
+// ignored.
+class CollectiveImplTable {
+ public:
+  static Status Parse(StringPiece text, CollectiveImplTable* table);
+
+  // Uses `implementation` for tensors of at least `min_bytes`, up to the next
+  // larger `min_bytes` added for the same type and device type.
+  void Add(CollectiveType type, const string& device_type, int64_t min_bytes,
+           const string& implementation);
+
+  // Returns the implementation for a tensor of `bytes`, or "" if there is
+  // none.
+  string Lookup(CollectiveType type, const string& device_type,
+                int64_t bytes) const;
+
+  bool empty() const { return entries_.empty(); }
+
+  // Returns the text form, which Parse accepts.
+  string ToString() const;
+
+ private:
+  std::map<std::tuple<CollectiveType, string, int64_t>, string> entries_;
+};
+
 // Used for executing a sub-operation, e.g. a merge_op instance, with
 // an OpKernelContext based on the one passed into this Op.
 class SubContext {
@@ -0,0 +1,408 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/communication_minimizing_placement_pass.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/utils.h"
+#include "tensorflow/core/grappler/costs/virtual_placer.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Sending a byte to another task, e.g. over RPC, is assumed to cost this many
+// times as much as sending it to another device of the same task.
+constexpr int64_t kCrossTaskCostFactor = 4;
+
+// Devices are filled up to this fraction of their memory, leaving the rest to
+// the temporaries of the kernels.
+constexpr double kMaxMemoryFraction = 0.8;
+
+constexpr int kMaxRefinementRounds = 4;
+
+// The nodes of a placed graph, the devices they are placed on and the size of
+// their outputs.
+class PlacementRefiner {
+ public:
+  PlacementRefiner(Graph* graph, const DeviceSet& device_set)
+      : graph_(graph), device_set_(device_set) {}
+
+  // Returns false if the graph can't be refined, e.g. because shape inference
+  // failed.
+  bool Init(const FunctionLibraryDefinition* flib_def);
+
+  // Returns the bytes sent between devices by the current placement,
+  // weighted by kCrossTaskCostFactor across tasks.
+  int64_t TotalCost() const;
+
+  // Moves nodes while that lowers TotalCost(), and returns how many nodes
+  // moved.
+  int Refine();
+
+  // Assigns the nodes to the devices they were moved to.
+  void Apply();
+
+ private:
+  struct DeviceInfo {
+    string name;
+    string type;
+    // Zero if the device is not in the device set, e.g. a device of another
+    // job, or its memory is unknown.
+    int64_t memory_limit = 0;
+    int64_t memory_used = 0;
+    bool in_device_set = false;
+  };
+
+  int DeviceIndex(const string& name);
+  int64_t TransferCost(int src_device, int dst_device) const;
+  int64_t OutputBytes(const Node* node, int port) const;
+  // Returns the bytes sent to or from other devices because of `node`, if it
+  // was placed on `device`.
+  int64_t PlacementCost(const Node* node, int device) const;
+  bool IsMovable(const Node* node) const;
+
+  Graph* const graph_;
+  const DeviceSet& device_set_;
+  std::vector<DeviceInfo> devices_;
+  absl::flat_hash_map<string, int> device_indices_;
+  // Indexed by node id.
+  std::vector<int> node_devices_;
+  std::vector<std::vector<int64_t>> output_bytes_;
+  absl::flat_hash_set<string> colocated_nodes_;
+  std::vector<Node*> order_;
+};
+
+bool PlacementRefiner::Init(const FunctionLibraryDefinition* flib_def) {
+  // Canonicalizes the assigned device names with the virtual placer, so that
+  // they match the names of the device set.
+  std::unordered_map<string, DeviceProperties> device_properties;
+  for (const Device* device : device_set_.devices()) {
+    DeviceProperties& properties = device_properties[device->name()];
+    properties.set_type(device->device_type());
+    properties.set_memory_size(device->attributes().memory_limit());
+  }
+  grappler::VirtualPlacer placer(device_properties);
+  for (const Device* device : device_set_.devices()) {
+    const int index = DeviceIndex(device->name());
+    DeviceInfo& info = devices_[index];
+    info.type = device->device_type();
+    info.memory_limit = device->attributes().memory_limit();
+    info.in_device_set = true;
+  }
+
+  node_devices_.assign(graph_->num_node_ids(), -1);
+  absl::flat_hash_map<string, int> canonical_devices;
+  for (Node* node : graph_->op_nodes()) {
+    const string& assigned = node->assigned_device_name();
+    if (assigned.empty()) return false;
+    auto it = canonical_devices.find(assigned);
+    if (it == canonical_devices.end()) {
+      string canonical = assigned;
+      if (device_properties.count(assigned) == 0) {
+        // The virtual placer falls back to a default device, which is only
+        // used if it matches the assigned name.
+        NodeDef node_def;
+        node_def.set_device(assigned);
+        const string match = placer.get_canonical_device_name(node_def);
+        DeviceNameUtils::ParsedName assigned_name, match_name;
+        if (DeviceNameUtils::ParseFullName(assigned, &assigned_name) &&
+            DeviceNameUtils::ParseFullName(match, &match_name) &&
+            DeviceNameUtils::IsSpecification(assigned_name, match_name)) {
+          canonical = match;
+        }
+      }
+      it = canonical_devices.emplace(assigned, DeviceIndex(canonical)).first;
+    }
+    node_devices_[node->id()] = it->second;
+
+    std::vector<string> groups;
+    if (TryGetNodeAttr(node->attrs(), kColocationAttrName, &groups) &&
+        !groups.empty()) {
+      colocated_nodes_.insert(node->name());
+      for (const string& group : groups) {
+        if (absl::StartsWith(group, kColocationGroupPrefix)) {
+          colocated_nodes_.insert(
+              group.substr(strlen(kColocationGroupPrefix)));
+        }
+      }
+    }
+  }
+
+  grappler::GrapplerItem item;
+  graph_->ToGraphDef(&item.graph);
+  if (flib_def != nullptr) *item.graph.mutable_library() = flib_def->ToProto();
+  grappler::GraphProperties properties(item);
+  Status s = properties.InferStatically(/*assume_valid_feeds=*/false,
+                                        /*aggressive_shape_inference=*/false,
+                                        /*include_tensor_values=*/false);
+  if (!s.ok()) {
+    VLOG(1) << "Not refining the placement, shape inference failed: " << s;
+    return false;
+  }
+  output_bytes_.resize(graph_->num_node_ids());
+  for (Node* node : graph_->op_nodes()) {
+    std::vector<int64_t>& bytes = output_bytes_[node->id()];
+    bytes.assign(node->num_outputs(), 0);
+    if (!properties.HasOutputProperties(node->name())) continue;
+    const auto& outputs = properties.GetOutputProperties(node->name());
+    for (int i = 0; i < bytes.size() && i < outputs.size(); ++i) {
+      bytes[i] =
+          std::max<int64_t>(grappler::CalculateTensorSize(outputs[i]), 0);
+    }
+    const int device = node_devices_[node->id()];
+    for (int64_t b : bytes) devices_[device].memory_used += b;
+  }
+
+  GetReversePostOrder(*graph_, &order_);
+  return true;
+}
+
+int PlacementRefiner::DeviceIndex(const string& name) {
+  auto it = device_indices_.find(name);
+  if (it != device_indices_.end()) return it->second;
+  devices_.emplace_back();
+  devices_.back().name = name;
+  device_indices_.emplace(name, devices_.size() - 1);
+  return devices_.size() - 1;
+}
+
+int64_t PlacementRefiner::TransferCost(int src_device, int dst_device) const {
+  if (src_device == dst_device) return 0;
+  return DeviceNameUtils::IsSameAddressSpace(devices_[src_device].name,
+                                             devices_[dst_device].name)
+             ? 1
+             : kCrossTaskCostFactor;
+}
+
+int64_t PlacementRefiner::OutputBytes(const Node* node, int port) const {
+  const std::vector<int64_t>& bytes = output_bytes_[node->id()];
+  return port < bytes.size() ? bytes[port] : 0;
+}
+
+int64_t PlacementRefiner::PlacementCost(const Node* node, int device) const {
+  int64_t cost = 0;
+  // The outputs of `node` are sent once to each other device consuming them.
+  absl::flat_hash_map<int, absl::flat_hash_set<int>> consumer_devices;
+  for (const Edge* edge : node->out_edges()) {
+    if (edge->IsControlEdge() || !edge->dst()->IsOp()) continue;
+    consumer_devices[edge->src_output()].insert(
+        node_devices_[edge->dst()->id()]);
+  }
+  for (const auto& it : consumer_devices) {
+    const int64_t bytes = OutputBytes(node, it.first);
+    for (int consumer_device : it.second) {
+      cost += bytes * TransferCost(device, consumer_device);
+    }
+  }
+
+  // The inputs of `node` are sent to `device`, unless they are produced or
+  // already consumed there.
+  absl::flat_hash_set<std::pair<const Node*, int>> inputs;
+  for (const Edge* edge : node->in_edges()) {
+    if (edge->IsControlEdge() || !edge->src()->IsOp()) continue;
+    const Node* src = edge->src();
+    if (!inputs.emplace(src, edge->src_output()).second) continue;
+    const int src_device = node_devices_[src->id()];
+    if (src_device == device) continue;
+    bool consumed_on_device = false;
+    for (const Edge* out : src->out_edges()) {
+      if (out->dst() != node && out->src_output() == edge->src_output() &&
+          node_devices_[out->dst()->id()] == device) {
+        consumed_on_device = true;
+        break;
+      }
+    }
+    if (!consumed_on_device) {
+      cost += OutputBytes(src, edge->src_output()) *
+              TransferCost(src_device, device);
+    }
+  }
+  return cost;
+}
+
+int64_t PlacementRefiner::TotalCost() const {
+  int64_t cost = 0;
+  for (const Node* node : graph_->op_nodes()) {
+    absl::flat_hash_set<std::pair<int, int>> sent;
+    const int device = node_devices_[node->id()];
+    for (const Edge* edge : node->out_edges()) {
+      if (edge->IsControlEdge() || !edge->dst()->IsOp()) continue;
+      const int dst_device = node_devices_[edge->dst()->id()];
+      if (sent.emplace(edge->src_output(), dst_device).second) {
+        cost += OutputBytes(node, edge->src_output()) *
+                TransferCost(device, dst_device);
+      }
+    }
+  }
+  return cost;
+}
+
+bool PlacementRefiner::IsMovable(const Node* node) const {
+  if (!node->IsOp() || node->IsArg() || node->IsRetval() || node->IsSend() ||
+      node->IsRecv() || node->IsControlFlow() || node->IsFunctionCall()) {
+    return false;
+  }
+  // Honor what the placer honored: the requested devices and colocation
+  // groups. Stateful ops and resources stay with the state they access.
+  if (!node->requested_device().empty() ||
+      colocated_nodes_.contains(node->name()) ||
+      node->op_def().is_stateful()) {
+    return false;
+  }
+  for (DataType type : node->input_types()) {
+    if (IsRefType(type) || type == DT_RESOURCE) return false;
+  }
+  for (DataType type : node->output_types()) {
+    if (IsRefType(type) || type == DT_RESOURCE) return false;
+  }
+  return devices_[node_devices_[node->id()]].in_device_set;
+}
+
+int PlacementRefiner::Refine() {
+  int num_moved = 0;
+  absl::flat_hash_set<const Node*> moved;
+  for (int round = 0; round < kMaxRefinementRounds; ++round) {
+    int num_moves = 0;
+    for (const Node* node : order_) {
+      if (!IsMovable(node)) continue;
+      const int device = node_devices_[node->id()];
+      const DeviceInfo& info = devices_[device];
+
+      // Only the devices of the neighbors can lower the cost.
+      absl::flat_hash_set<int> candidates;
+      for (const Edge* edge : node->in_edges()) {
+        if (!edge->IsControlEdge()) {
+          candidates.insert(node_devices_[edge->src()->id()]);
+        }
+      }
+      for (const Edge* edge : node->out_edges()) {
+        if (!edge->IsControlEdge() && edge->dst()->IsOp()) {
+          candidates.insert(node_devices_[edge->dst()->id()]);
+        }
+      }
+
+      int64_t node_bytes = 0;
+      for (int64_t bytes : output_bytes_[node->id()]) node_bytes += bytes;
+      int best_device = device;
+      int64_t best_cost = PlacementCost(node, device);
+      for (int candidate : candidates) {
+        if (candidate == device || candidate < 0) continue;
+        const DeviceInfo& candidate_info = devices_[candidate];
+        if (!candidate_info.in_device_set || candidate_info.type != info.type) {
+          continue;
+        }
+        if (candidate_info.memory_limit > 0 &&
+            candidate_info.memory_used + node_bytes >
+                kMaxMemoryFraction * candidate_info.memory_limit) {
+          continue;
+        }
+        const int64_t cost = PlacementCost(node, candidate);
+        // Ties are broken by the device name, so that the refinement is
+        // deterministic.
+        if (cost < best_cost ||
+            (cost == best_cost && best_device != device &&
+             candidate_info.name < devices_[best_device].name)) {
+          best_device = candidate;
+          best_cost = cost;
+        }
+      }
+      if (best_device == device) continue;
+
+      VLOG(2) << "Moving " << node->name() << " from " << info.name << " to "
+              << devices_[best_device].name;
+      devices_[device].memory_used -= node_bytes;
+      devices_[best_device].memory_used += node_bytes;
+      node_devices_[node->id()] = best_device;
+      if (moved.insert(node).second) ++num_moved;
+      ++num_moves;
+    }
+    if (num_moves == 0) break;
+  }
+  return num_moved;
+}
+
+void PlacementRefiner::Apply() {
+  for (Node* node : graph_->op_nodes()) {
+    const string& device = devices_[node_devices_[node->id()]].name;
+    if (node->assigned_device_name() != device &&
+        devices_[node_devices_[node->id()]].in_device_set) {
+      node->set_assigned_device_name(device);
+    }
+  }
+}
+
+}  // namespace
+
+Status CommunicationMinimizingPlacementPass::Run(
+    const GraphOptimizationPassOptions& options) {
+  bool enabled = false;
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar("TF_COMMUNICATION_MINIMIZING_PLACEMENT",
+                                        false, &enabled));
+  if (!enabled || options.graph == nullptr || options.device_set == nullptr ||
+      options.device_set->devices().size() < 2) {
+    return OkStatus();
+  }
+
+  Graph* graph = options.graph->get();
+  PlacementRefiner refiner(graph, *options.device_set);
+  if (!refiner.Init(options.flib_def)) return OkStatus();
+
+  const int64_t cost_before = refiner.TotalCost();
+  if (cost_before == 0) return OkStatus();
+  const int num_moved = refiner.Refine();
+  if (num_moved == 0) {
+    VLOG(1) << "Communication-minimizing placement kept the placement, "
+            << "estimated cross-device traffic: " << cost_before << " bytes";
+    return OkStatus();
+  }
+  const int64_t cost_after = refiner.TotalCost();
+  refiner.Apply();
+
+  LOG(INFO) << "Communication-minimizing placement moved " << num_moved
+            << " of " << graph->num_op_nodes()
+            << " nodes, estimated cross-device traffic: " << cost_before
+            << " -> " << cost_after << " bytes";
+  if (VLOG_IS_ON(1)) {
+    DumpGraphToFile("communication_minimizing_placement", *graph,
+                    options.flib_def);
+  }
+  return OkStatus();
+}
+
+// Runs before the other post-placement passes, e.g. the NCCL rewrite, which
+// read the placement.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_PLACEMENT, -10,
+                      CommunicationMinimizingPlacementPass);
+
+}  // namespace tensorflow
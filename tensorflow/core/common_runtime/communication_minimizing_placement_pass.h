@@ -0,0 +1,48 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COMMUNICATION_MINIMIZING_PLACEMENT_PASS_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COMMUNICATION_MINIMIZING_PLACEMENT_PASS_H_
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+namespace tensorflow {
+
+// Refines the placement of a graph to reduce the bytes that the partitioned
+// graph sends between devices. The placer only honors the device constraints
+// and colocation groups, so model-parallel graphs often bounce tensors between
+// devices, e.g. when a node without a requested device lands on the default
+// device while all its inputs and consumers are on another one.
+//
+// The pass weighs each edge with the size of its tensor, as inferred by
+// grappler::GraphProperties, and greedily moves nodes to the device of one of
+// their neighbors while that lowers the weight of the cut, as a
+// Fiduccia-Mattheyses style refinement of the placement. A tensor consumed by
+// several nodes on the same device is only sent once, and sending it to
+// another task costs more than to another device of the same task. Only nodes
+// the placer was free to place are moved, and only between devices of the
+// same type, without filling a device past 80% of its memory.
+//
+// The pass is disabled by default. Setting
+// TF_COMMUNICATION_MINIMIZING_PLACEMENT=true enables it; it then logs the
+// estimated cross-device traffic before and after the refinement.
+class CommunicationMinimizingPlacementPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COMMUNICATION_MINIMIZING_PLACEMENT_PASS_H_
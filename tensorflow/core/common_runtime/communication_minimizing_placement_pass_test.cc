@@ -0,0 +1,112 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/communication_minimizing_placement_pass.h"
+
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCpu0[] = "/job:a/replica:0/task:0/device:CPU:0";
+constexpr char kCpu1[] = "/job:a/replica:0/task:0/device:CPU:1";
+
+class CommunicationMinimizingPlacementPassTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SessionOptions options;
+    options.config.mutable_device_count()->insert({"CPU", 2});
+    TF_ASSERT_OK(DeviceFactory::AddDevices(options, "/job:a/replica:0/task:0",
+                                           &devices_));
+    for (const auto& device : devices_) device_set_.AddDevice(device.get());
+    setenv("TF_COMMUNICATION_MINIMIZING_PLACEMENT", "true", 1);
+  }
+
+  void TearDown() override {
+    unsetenv("TF_COMMUNICATION_MINIMIZING_PLACEMENT");
+  }
+
+  // Builds a -> b -> c, where `a` and `c` request CPU:0 and `b` was placed
+  // on CPU:1 with `b_device` requested.
+  std::unique_ptr<Graph> MakeGraph(const string& b_device) {
+    Scope s = Scope::NewRootScope().ExitOnError();
+    auto a = ops::Const(s.WithOpName("a").WithDevice(kCpu0),
+                        Input::Initializer(1.0f, TensorShape({1024})));
+    auto b = ops::Identity(s.WithOpName("b").WithDevice(b_device), a);
+    ops::Identity(s.WithOpName("c").WithDevice(kCpu0), b);
+    auto graph = std::make_unique<Graph>(OpRegistry::Global());
+    TF_CHECK_OK(s.ToGraph(graph.get()));
+    for (Node* node : graph->op_nodes()) {
+      node->set_assigned_device_name(node->name() == "b" ? kCpu1 : kCpu0);
+    }
+    return graph;
+  }
+
+  Status RunPass(std::unique_ptr<Graph>* graph) {
+    GraphOptimizationPassOptions options;
+    options.graph = graph;
+    options.device_set = &device_set_;
+    CommunicationMinimizingPlacementPass pass;
+    return pass.Run(options);
+  }
+
+  static string AssignedDevice(const Graph& graph, const string& name) {
+    for (const Node* node : graph.op_nodes()) {
+      if (node->name() == name) return node->assigned_device_name();
+    }
+    return "";
+  }
+
+  std::vector<std::unique_ptr<Device>> devices_;
+  DeviceSet device_set_;
+};
+
+TEST_F(CommunicationMinimizingPlacementPassTest, MovesNodeToItsNeighbors) {
+  std::unique_ptr<Graph> graph = MakeGraph(/*b_device=*/"");
+  TF_ASSERT_OK(RunPass(&graph));
+  EXPECT_EQ(AssignedDevice(*graph, "a"), kCpu0);
+  EXPECT_EQ(AssignedDevice(*graph, "b"), kCpu0);
+  EXPECT_EQ(AssignedDevice(*graph, "c"), kCpu0);
+}
+
+TEST_F(CommunicationMinimizingPlacementPassTest, KeepsRequestedDevice) {
+  std::unique_ptr<Graph> graph = MakeGraph(/*b_device=*/kCpu1);
+  TF_ASSERT_OK(RunPass(&graph));
+  EXPECT_EQ(AssignedDevice(*graph, "b"), kCpu1);
+}
+
+TEST_F(CommunicationMinimizingPlacementPassTest, DisabledByDefault) {
+  unsetenv("TF_COMMUNICATION_MINIMIZING_PLACEMENT");
+  std::unique_ptr<Graph> graph = MakeGraph(/*b_device=*/"");
+  TF_ASSERT_OK(RunPass(&graph));
+  EXPECT_EQ(AssignedDevice(*graph, "b"), kCpu1);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 
+#include <algorithm>
+
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
@@ -22,12 +25,12 @@ limitations under the License.
 namespace tensorflow {
 
 namespace {
-// The EventMgr has 1 thread for the polling loop and one to execute
+// The EventMgr has 1 thread for each polling loop and one to execute
 // event callback functions. Issues for reconsideration:
 //  - Is this the right number of threads?
 //  - Should EventMgrs be shared between devices on a machine with multiple
 //  devices of the same type?
-static const int kNumThreads = 2;
+static const int kNumCallbackThreads = 1;
 }  // namespace
 
 namespace device_event_mgr {
@@ -95,7 +98,15 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
-      threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
+      polling_spin_usecs_(std::max(
+          0, gpu_options.experimental().event_mgr_polling_spin_usecs())),
+      max_polling_delay_usecs_(std::max(
+          polling_active_delay_usecs_,
+          gpu_options.experimental().event_mgr_max_polling_delay_usecs())),
+      num_polling_threads_(std::max(
+          1, gpu_options.experimental().event_mgr_num_polling_threads())),
+      threadpool_(Env::Default(), "Device_Event_Manager",
+                  num_polling_threads_ + kNumCallbackThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
   StartPollingLoop();
 }
@@ -120,9 +131,12 @@ void EventMgr::StartPollingLoop() {
   {
     mutex_lock l(mu_);
     stop_polling_ = false;
+    num_running_poll_loops_ = num_polling_threads_;
   }
   polling_stopped_.reset(new Notification);
-  threadpool_.Schedule([this]() { PollLoop(); });
+  for (int i = 0; i < num_polling_threads_; ++i) {
+    threadpool_.Schedule([this]() { PollLoop(); });
+  }
 }
 
 void EventMgr::StopPollingLoop() {
@@ -141,8 +155,16 @@ void EventMgr::StopPollingLoop() {
 //
 // While one or more events is outstanding, poll for completed events.  When no
 // events are outstanding, we sleep until one is enqueued.
+//
+// For polling_spin_usecs_ after the last poll that completed an event we poll
+// again immediately. After that we sleep between polls, starting at
+// polling_active_delay_usecs_ and doubling the delay after every poll that
+// completes no event, up to max_polling_delay_usecs_.
 void EventMgr::PollLoop() {
   ToFreeVector to_free;
+  Env* env = Env::Default();
+  int32 delay_usecs = polling_active_delay_usecs_;
+  uint64 last_progress_usecs = 0;
   while (true) {
     bool events_still_pending;
     {
@@ -156,14 +178,53 @@ void EventMgr::PollLoop() {
       PollEvents(true, &to_free);
       events_still_pending = !used_events_.empty();
     }
+    const bool made_progress = !to_free.empty();
     FreeMemory(to_free);
     to_free.clear();
 
     if (events_still_pending) {
-      Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+      if (made_progress) {
+        delay_usecs = polling_active_delay_usecs_;
+        if (polling_spin_usecs_ > 0) last_progress_usecs = env->NowMicros();
+      }
+      if (polling_spin_usecs_ > 0 &&
+          env->NowMicros() - last_progress_usecs <
+              static_cast<uint64>(polling_spin_usecs_)) {
+        continue;
+      }
+      env->SleepForMicroseconds(delay_usecs);
+      if (!made_progress) {
+        delay_usecs = std::min(2 * delay_usecs, max_polling_delay_usecs_);
+      }
+    } else {
+      delay_usecs = polling_active_delay_usecs_;
     }
   }
-  polling_stopped_->Notify();
+  bool last_poll_loop;
+  {
+    mutex_lock l(mu_);
+    last_poll_loop = --num_running_poll_loops_ == 0;
+  }
+  if (last_poll_loop) polling_stopped_->Notify();
+}
+
+void EventMgr::FreeMemory(const ToFreeVector& to_free) {
+  // The functions must be called in another thread. All functions that became
+  // ready in the same poll are run by a single closure, which saves a
+  // threadpool handoff per callback.
+  std::vector<std::function<void()>> funcs;
+  for (const auto& iu : to_free) {
+    if (iu.func != nullptr) funcs.push_back(iu.func);
+  }
+  if (funcs.empty()) return;
+  const uint64 ready_usecs = Env::Default()->NowMicros();
+  threadpool_.Schedule([ready_usecs, funcs = std::move(funcs)]() {
+    for (const auto& func : funcs) {
+      metrics::UpdateEventMgrCallbackDelay(Env::Default()->NowMicros() -
+                                           ready_usecs);
+      func();
+    }
+  });
 }
 
 void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
@@ -252,9 +313,9 @@ EventMgr* EventMgrFactory::GetEventMgr(se::StreamExecutor* se,
                                        const GPUOptions& gpu_options) {
   mutex_lock l(mu_);
   // TODO(laigd): consider making gpu_options part of the key. It's not
-  // currently since EventMgr depends only rely on field deferred_deletion_bytes
-  // and polling_active_delay_usecs from gpu_options which are not used or
-  // rarely used.
+  // currently since EventMgr depends only rely on field deferred_deletion_bytes,
+  // polling_active_delay_usecs and the experimental event_mgr_* polling options
+  // from gpu_options which are not used or rarely used.
   auto itr = event_mgr_map_.find(se);
   if (itr == event_mgr_map_.end()) {
     auto event_mgr = new EventMgr(se, gpu_options);
@@ -69,7 +69,9 @@ class EventMgr {
 
   // Execute func when all pending stream actions have completed.
   // func must be brief and non-blocking since it executes in the one
-  // thread used for all such callbacks and also buffer deletions.
+  // thread used for all such callbacks and also buffer deletions. Callbacks
+  // whose events are found complete by the same poll run one after the other
+  // in a single closure.
   inline void ThenExecute(se::Stream* stream, std::function<void()> func) {
     ToFreeVector to_free;
     {
@@ -86,6 +88,9 @@ class EventMgr {
   friend class EventMgrFactory;
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  const int32 polling_spin_usecs_;
+  const int32 max_polling_delay_usecs_;
+  const int32 num_polling_threads_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -98,12 +103,8 @@ class EventMgr {
 
   EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options);
 
-  void FreeMemory(const ToFreeVector& to_free) {
-    for (const auto& iu : to_free) {
-      // The function must be called in another thread.
-      if (iu.func != nullptr) threadpool_.Schedule(iu.func);
-    }
-  }
+  // Runs the callbacks of 'to_free' in the threadpool.
+  void FreeMemory(const ToFreeVector& to_free);
 
   // Stream-enqueue an unused Event and save with it a collection of
   // Tensors and/or a BufRec to be deleted only after the Event
@@ -125,7 +126,7 @@ class EventMgr {
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // An internal polling loop that runs at a low frequency to clear
-  // straggler Events.
+  // straggler Events. num_polling_threads_ instances run concurrently.
   void PollLoop();
 
   // Setup/Teardown functions for the polling loop.
@@ -139,9 +140,13 @@ class EventMgr {
   std::deque<InUse> used_events_ TF_GUARDED_BY(mu_);
 
   bool stop_polling_ TF_GUARDED_BY(mu_);
+  // The number of PollLoop() instances that have not exited yet. The last
+  // one to exit notifies polling_stopped_.
+  int num_running_poll_loops_ TF_GUARDED_BY(mu_) = 0;
   std::unique_ptr<Notification> polling_stopped_;
 
-  // The main PollLoop for the event manager runs in this threadpool.
+  // The PollLoops for the event manager and the callbacks run in this
+  // threadpool.
   thread::ThreadPool threadpool_;
 };
 
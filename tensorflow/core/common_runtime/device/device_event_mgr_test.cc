@@ -140,6 +140,34 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that all callbacks run with adaptive polling and several polling
+// threads.
+TEST(EventMgr, AdaptivePolling) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_mgr_polling_spin_usecs(100);
+  gpu_options.mutable_experimental()->set_event_mgr_max_polling_delay_usecs(
+      1000);
+  gpu_options.mutable_experimental()->set_event_mgr_num_polling_threads(2);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  th.StartPollingLoop();
+  constexpr int kNumCallbacks = 100;
+  std::atomic<int> num_done(0);
+  Notification note;
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [&num_done, &note]() {
+      if (++num_done == kNumCallbacks) note.Notify();
+    });
+  }
+  note.WaitForNotification();
+  th.StopPollingLoop();
+  EXPECT_EQ(0, th.queue_size());
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/graph_def_util.h"
+#include "tensorflow/core/framework/latency_breakdown.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/logging.h"
 #include "tensorflow/core/framework/metrics.h"
@@ -355,6 +356,21 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.error_message();
   }
+  const Status step_arena_status =
+      ReadBoolFromEnvVar("TF_USE_STEP_ARENA", false, &use_step_arena_);
+  if (!step_arena_status.ok()) {
+    LOG(ERROR) << step_arena_status.error_message();
+  }
+  const Status plan_memory_status =
+      ReadBoolFromEnvVar("TF_PLAN_EXECUTOR_MEMORY", false, &plan_memory_);
+  if (!plan_memory_status.ok()) {
+    LOG(ERROR) << plan_memory_status.error_message();
+  }
+  const Status forward_inputs_status = ReadBoolFromEnvVar(
+      "TF_STATIC_INPUT_FORWARDING", false, &forward_inputs_statically_);
+  if (!forward_inputs_status.ok()) {
+    LOG(ERROR) << forward_inputs_status.error_message();
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   int devices_added = 0;
@@ -667,9 +683,17 @@ Status DirectSession::RunInternal(
   args.sync_on_finish = sync_on_finish_;
   args.user_intra_op_threadpool = threadpool_options.intra_op_threadpool;
   args.run_all_kernels_inline = pool == nullptr;
+  args.use_step_arena = use_step_arena_;
   args.start_time_usecs = start_time_usecs;
   args.deadline = deadline;
 
+  std::unique_ptr<LatencyBreakdownCollector> latency_breakdown;
+  if (run_metadata != nullptr &&
+      run_options.experimental().collect_latency_breakdown()) {
+    latency_breakdown = std::make_unique<LatencyBreakdownCollector>();
+    args.latency_breakdown = latency_breakdown.get();
+  }
+
   const bool do_trace = (run_options.trace_level() > RunOptions::NO_TRACE);
 
   bool update_cost_model = false;
@@ -730,6 +754,7 @@ Status DirectSession::RunInternal(
         }
       };
 
+  const uint64 executors_start_usecs = options_.env->NowMicros();
   if (can_execute_synchronously) {
     PrivateIntraProcessRendezvous rendezvous(device_mgr_.get());
     args.rendezvous = &rendezvous;
@@ -766,6 +791,10 @@ Status DirectSession::RunInternal(
       run_status = run_state.status;
     }
   }
+  if (latency_breakdown) {
+    latency_breakdown->AddExecutorUsecs(options_.env->NowMicros() -
+                                        executors_start_usecs);
+  }
 
   if (step_cancellation_manager.IsCancelled()) {
     run_status.Update(errors::Cancelled("Run call was cancelled"));
@@ -828,6 +857,14 @@ Status DirectSession::RunInternal(
       }
     }
   }
+  if (latency_breakdown) {
+    RunMetadata::LatencyBreakdown* breakdown =
+        run_metadata->mutable_latency_breakdown();
+    latency_breakdown->ToProto(breakdown);
+    metrics::UpdateLatencyBreakdown(
+        breakdown->executor_usecs(), breakdown->queue_wait_usecs(),
+        breakdown->kernel_usecs(), breakdown->recv_wait_usecs());
+  }
   metrics::UpdateGraphExecTime(options_.env->NowMicros() - start_time_usecs);
 
   return OkStatus();
@@ -1389,6 +1426,8 @@ Status DirectSession::CreateExecutors(
     params.device = device;
     params.session_metadata = session_metadata;
     params.function_library = lib;
+    params.plan_memory = plan_memory_;
+    params.forward_inputs_statically = forward_inputs_statically_;
     auto opseg = device->op_segment();
     params.create_kernel =
         [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
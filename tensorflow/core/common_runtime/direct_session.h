@@ -355,6 +355,16 @@ class DirectSession : public Session {
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
+  // If true, CPU intermediate tensors are allocated from a per-step arena.
+  bool use_step_arena_ = false;
+
+  // If true, executors statically plan the memory of fixed-shape outputs.
+  bool plan_memory_ = false;
+
+  // If true, executors reserve the inputs of element-wise ops that can be
+  // forwarded safely for their outputs.
+  bool forward_inputs_statically_ = false;
+
   std::vector<std::unique_ptr<FunctionInfo>> functions_
       TF_GUARDED_BY(executor_lock_);
 
@@ -153,6 +153,33 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkWithLatencyBreakdown) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  std::vector<Tensor> outputs;
+  RunOptions run_options;
+  RunMetadata run_metadata;
+  TF_ASSERT_OK(session->Run(run_options, {}, {y_ + ":0"}, {y_neg_}, &outputs,
+                            &run_metadata));
+  EXPECT_FALSE(run_metadata.has_latency_breakdown());
+
+  run_options.mutable_experimental()->set_collect_latency_breakdown(true);
+  TF_ASSERT_OK(session->Run(run_options, {}, {y_ + ":0"}, {y_neg_}, &outputs,
+                            &run_metadata));
+  ASSERT_TRUE(run_metadata.has_latency_breakdown());
+  const RunMetadata::LatencyBreakdown& breakdown =
+      run_metadata.latency_breakdown();
+  EXPECT_GE(breakdown.executor_usecs(), 0);
+  EXPECT_GE(breakdown.kernel_usecs(), 0);
+  // Nothing is batched or received from another device.
+  EXPECT_EQ(breakdown.queue_wait_usecs(), 0);
+  EXPECT_EQ(breakdown.recv_wait_usecs(), 0);
+  EXPECT_FLOAT_EQ(5.0, outputs[0].matrix<float>()(0, 0));
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
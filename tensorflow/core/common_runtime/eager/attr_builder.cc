@@ -254,6 +254,8 @@ const NodeDef& AttrBuilder::BuildNodeDef() {
 void AttrBuilder::CopyAttributes(const AttrBuilder& other) {
   encoded_attrs_.insert(other.encoded_attrs_.begin(),
                         other.encoded_attrs_.end());
+  cached_cache_key_ = absl::nullopt;
+  cached_attrs_fingerprint_ = absl::nullopt;
 }
 
 Status AttrTypeByName(const AttrTypeMap& m, const string& attr_name,
@@ -306,15 +308,28 @@ tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
   return *cached_cache_key_;
 }
 
-tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
-    const StringPiece device) const {
-  tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name());
-  f = tensorflow::FingerprintCat128(f, tensorflow::Fingerprint128(device));
-  for (const auto& p : encoded_attrs_) {
-    CombineUnordered(
-        CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
+tensorflow::Fprint128 AttrBuilder::AttrsFingerprint() {
+  if (!cached_attrs_fingerprint_) {
+    tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name());
+    for (const auto& p : encoded_attrs_) {
+      CombineUnordered(
+          CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
+    }
+    cached_attrs_fingerprint_ = f;
   }
-  return f;
+  return *cached_attrs_fingerprint_;
+}
+
+void AttrBuilder::SetAttrsFingerprint(
+    const tensorflow::Fprint128& fingerprint) {
+  cached_attrs_fingerprint_ = fingerprint;
+  cached_cache_key_ = absl::nullopt;
+}
+
+tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
+    const StringPiece device) {
+  return tensorflow::FingerprintCat128(AttrsFingerprint(),
+                                       tensorflow::Fingerprint128(device));
 }
 
 void AttrBuilder::InitializeNodeDef() {
@@ -108,6 +108,7 @@ class AttrBuilder : public AbstractOpAttrs {
     node_def_finalized_ = false;
     cached_cache_key_ = absl::nullopt;
     device_for_cached_cache_key_.clear();
+    cached_attrs_fingerprint_ = absl::nullopt;
   }
 
   const string& op_name() const { return op_name_; }
@@ -120,6 +121,7 @@ class AttrBuilder : public AbstractOpAttrs {
     SetAttrValue(value, &attr_tmp_);
     AddAttrIfNotPresent(attr_name, attr_tmp_);
     cached_cache_key_ = absl::nullopt;
+    cached_attrs_fingerprint_ = absl::nullopt;
     return *this;
   }
 
@@ -128,6 +130,7 @@ class AttrBuilder : public AbstractOpAttrs {
   AttrBuilder& Set(StringPiece attr_name, const AttrValue& value) {
     AddAttrIfNotPresent(attr_name, value);
     cached_cache_key_ = absl::nullopt;
+    cached_attrs_fingerprint_ = absl::nullopt;
     return *this;
   }
 
@@ -149,6 +152,16 @@ class AttrBuilder : public AbstractOpAttrs {
 
   tensorflow::Fprint128 CacheKey(const StringPiece device);
 
+  // Returns a fingerprint of the op name and of the attributes set so far.
+  // Unlike CacheKey, it does not depend on the device.
+  tensorflow::Fprint128 AttrsFingerprint();
+
+  // Makes AttrsFingerprint return `fingerprint` until the next call to Reset,
+  // Set or CopyAttributes, so that callers that always set the same
+  // attributes can skip fingerprinting them. `fingerprint` must have been
+  // returned by AttrsFingerprint for the same op name and attributes.
+  void SetAttrsFingerprint(const tensorflow::Fprint128& fingerprint);
+
   // Fill `m` with the attr-value pairs set via AttrBuilder::Set() so far, as
   // well as any default attr-value pairs from the associated op_def, if there
   // is one.
@@ -180,7 +193,7 @@ class AttrBuilder : public AbstractOpAttrs {
       absl::InlinedVector<DataType, 4>* type_list) const override;
 
  private:
-  tensorflow::Fprint128 BuildCacheKeyForDevice(const StringPiece device) const;
+  tensorflow::Fprint128 BuildCacheKeyForDevice(const StringPiece device);
 
   // Initialize the node_def_ object.
   // REQUIRES: node_def_initialized_ = false
@@ -208,6 +221,7 @@ class AttrBuilder : public AbstractOpAttrs {
 
   absl::optional<tensorflow::Fprint128> cached_cache_key_;
   string device_for_cached_cache_key_;
+  absl::optional<tensorflow::Fprint128> cached_attrs_fingerprint_;
 };
 
 template <>
@@ -85,6 +85,25 @@ TEST(AttrTypeMap, CacheKey) {
   ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
 }
 
+TEST(AttrBuilder, AttrsFingerprint) {
+  AttrBuilder a("op_name");
+  a.Set("T", TF_FLOAT);
+  tensorflow::Fprint128 fingerprint = a.AttrsFingerprint();
+  tensorflow::Fprint128 cache_key = a.CacheKey("cpu:0");
+
+  AttrBuilder b("op_name");
+  b.Set("T", TF_FLOAT);
+  ASSERT_TRUE(fingerprint == b.AttrsFingerprint());
+  b.Set("x", 1.0);
+  ASSERT_FALSE(fingerprint == b.AttrsFingerprint());
+
+  // A precomputed fingerprint is used as is, and discarded by Set.
+  b.SetAttrsFingerprint(fingerprint);
+  ASSERT_TRUE(cache_key == b.CacheKey("cpu:0"));
+  b.Set("y", 1.0);
+  ASSERT_FALSE(cache_key == b.CacheKey("cpu:0"));
+}
+
 string ToString(const AttrValueMap& m) {
   std::vector<string> strs;
   for (const auto& e : m) {
@@ -209,6 +209,15 @@ EagerContext::EagerContext(
   // depends on the former.
   local_rendezvous_table_ = std::make_unique<LocalRendezvousTable>();
   ResetGlobalRendezvousForFunction();
+
+  int64_t host_buffer_cache_mb;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_HOST_BUFFER_CACHE_MB", 0,
+                                  &host_buffer_cache_mb));
+  if (host_buffer_cache_mb > 0) {
+    host_buffer_cache_ = new BufferCacheAllocator(
+        host_cpu_device_->GetAllocator(AllocatorAttributes()),
+        host_buffer_cache_mb << 20);
+  }
 }
 
 AbstractTensorInterface* EagerContext::CreateInt64Scalar(int64_t value) {
@@ -498,6 +507,9 @@ void EagerContext::ClearCachesAndDefaultExecutor() {
     step_container_.reset(new ScopedStepContainer(
         0, [this](const string& name) { ClearResourceContainer(name); }));
   }
+  if (host_buffer_cache_ != nullptr) {
+    host_buffer_cache_->ClearCache();
+  }
 }
 
 void EagerContext::SetThreadLocalDevicePlacementPolicy(
@@ -631,6 +643,13 @@ EagerContext::~EagerContext() {
   // don't send RPCs and block in destructor.
   WaitForAndCloseRemoteContexts();
 
+  // Recorded ops may use any context component.
+  Status s = DisableLazyExecution();
+  if (!s.ok()) {
+    LOG(ERROR) << "Failed to execute lazily recorded ops: " << s;
+  }
+  pending_ops_.reset();
+
   // Custom devices may have obtained references to various context components
   // (executors, thread pool). It's safer to run their destructors early.
   custom_device_op_handler_.Clear();
@@ -701,6 +720,9 @@ EagerContext::~EagerContext() {
   if (resource_deallocator_ != nullptr) {
     resource_deallocator_();
   }
+  if (host_buffer_cache_ != nullptr) {
+    host_buffer_cache_->Release();
+  }
 }
 
 bool EagerContext::FindFunctionByName(const string& name) const {
@@ -757,6 +779,20 @@ void EagerContext::SetJitCompileRewrite(bool enable) {
   jit_compile_rewrite_ = enable;
 }
 
+void EagerContext::EnableLazyExecution(
+    std::unique_ptr<PendingEagerOps> pending_ops) {
+  mutex_lock l(pending_ops_mu_);
+  if (pending_ops_ == nullptr) pending_ops_ = std::move(pending_ops);
+  lazy_execution_.store(true, std::memory_order_release);
+}
+
+Status EagerContext::DisableLazyExecution() {
+  mutex_lock l(pending_ops_mu_);
+  lazy_execution_.store(false, std::memory_order_release);
+  if (pending_ops_ == nullptr) return OkStatus();
+  return pending_ops_->Flush();
+}
+
 void EagerContext::ListDevices(
     std::vector<tensorflow::DeviceAttributes>* device_attributes) {
   std::vector<Device*> devices = ListAllTfDevices();
@@ -16,6 +16,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_CONTEXT_H_
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <map>
 #include <memory>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/types/optional.h"
 #include "tensorflow/c/eager/immediate_execution_context.h"
+#include "tensorflow/core/common_runtime/buffer_cache_allocator.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
@@ -84,6 +86,22 @@ class RemoteMgr;
 class TensorHandle;
 class EagerOperation;
 
+// Ops that EagerExecute records instead of executing in lazy execution mode.
+// Implemented by LazyGraph.
+class PendingEagerOps {
+ public:
+  virtual ~PendingEagerOps() = default;
+
+  // Records `op` if it can be recorded, in which case `retvals` are set to
+  // handles that become ready once the recorded ops are executed, and
+  // `*recorded` to true.
+  virtual Status MaybeRecord(EagerOperation* op, TensorHandle** retvals,
+                             int* num_retvals, bool* recorded) = 0;
+
+  // Executes the ops recorded so far.
+  virtual Status Flush() = 0;
+};
+
 class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
  public:
   static constexpr uint64 kInvalidContextId = 0;
@@ -155,6 +173,21 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   void SetJitCompileRewrite(bool enable) override;
 
+  // Enables lazy execution mode, in which EagerExecute records primitive ops
+  // into `pending_ops` instead of executing them. `pending_ops` is only used
+  // the first time lazy execution is enabled.
+  void EnableLazyExecution(std::unique_ptr<PendingEagerOps> pending_ops);
+
+  // Disables lazy execution mode, and executes the ops recorded so far.
+  Status DisableLazyExecution();
+
+  // Returns the ops recorded in lazy execution mode, or nullptr if it is
+  // disabled.
+  PendingEagerOps* LazyExecutionOps() const {
+    return lazy_execution_.load(std::memory_order_acquire) ? pending_ops_.get()
+                                                           : nullptr;
+  }
+
   void ListDevices(std::vector<DeviceAttributes>* devices) override;
 
   Status AddDevices(std::vector<std::unique_ptr<Device>> devices) override;
@@ -532,6 +565,11 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
 
   bool PinSmallOpsToCPU() const { return pin_small_ops_to_cpu_; }
 
+  // Returns the allocator that recycles the buffers of tensors allocated by
+  // ops on the host CPU, or nullptr if buffers are not cached. Enabled by
+  // setting TF_EAGER_HOST_BUFFER_CACHE_MB to the maximum size of the cache.
+  Allocator* HostBufferCache() const { return host_buffer_cache_; }
+
   tensorflow::Env* TFEnv() const { return env_; }
 
   Status FindDeviceFromName(const char* device_name, Device** device) const;
@@ -870,6 +908,15 @@ class EagerContext : public ImmediateExecutionContext, public core::RefCounted {
   std::function<void()> resource_deallocator_ = nullptr;
   bool run_eager_op_as_function_;
   bool jit_compile_rewrite_;
+
+  // Only set once, before lazy_execution_ is first set to true.
+  mutex pending_ops_mu_;
+  std::unique_ptr<PendingEagerOps> pending_ops_;
+  std::atomic<bool> lazy_execution_{false};
+
+  // Wraps the allocator of the host CPU, which is process-wide. Released,
+  // rather than deleted, since tensors may outlive the context.
+  BufferCacheAllocator* host_buffer_cache_ = nullptr;
 };
 
 inline EagerContext* ContextFromInterface(ImmediateExecutionContext* context) {
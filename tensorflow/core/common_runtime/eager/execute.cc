@@ -1238,7 +1238,8 @@ Status GetOrCreateKernelAndDevice(
               << ". Full node_def=" << ndef.DebugString();
       kernel.reset(new KernelAndDeviceOp(
           ctx.GetRendezvous(), ctx.LogMemory(), flr, runner,
-          ctx.GetCollectiveExecutorHandle(), ctx.HostCPU()));
+          ctx.GetCollectiveExecutorHandle(), ctx.HostCPU(),
+          ctx.HostBufferCache()));
     }
 
     TF_RETURN_IF_ERROR(
@@ -1812,6 +1813,13 @@ Status EagerExecute(EagerOperation* op, TensorHandle** retvals,
     if (out_op) {
       op = out_op.get();
     }
+    PendingEagerOps* pending_ops = op->EagerContext().LazyExecutionOps();
+    if (pending_ops != nullptr) {
+      bool recorded;
+      TF_RETURN_IF_ERROR(
+          pending_ops->MaybeRecord(op, retvals, num_retvals, &recorded));
+      if (recorded) return OkStatus();
+    }
     TF_RETURN_IF_ERROR(MaybePackInputTensor(op));
     return EagerLocalExecute(op, retvals, num_retvals);
   }
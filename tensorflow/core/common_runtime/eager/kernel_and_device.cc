@@ -43,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 #if !defined(IS_MOBILE_PLATFORM)
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -98,6 +99,22 @@ KernelAndDeviceFunc::~KernelAndDeviceFunc() {
   }
 }
 
+namespace {
+
+// The number of runs with the same input shapes after which a shape
+// specialized kernel is created. Non-positive disables shape specialization.
+int64_t ShapeSpecializationThreshold() {
+  static const int64_t threshold = [] {
+    int64_t result;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_SHAPE_SPECIALIZATION_THRESHOLD",
+                                    16, &result));
+    return result;
+  }();
+  return threshold;
+}
+
+}  // namespace
+
 Status KernelAndDeviceOp::Init(const bool log_device_placement,
                                const NodeDef& ndef,
                                GraphCollector* graph_collector) {
@@ -112,6 +129,16 @@ Status KernelAndDeviceOp::Init(const bool log_device_placement,
       ndef, flr_->GetFunctionLibraryDefinition(), &props));
   TF_RETURN_IF_ERROR(flr_->CreateKernel(props, &k));
   kernel_.reset(k);
+  {
+    mutex_lock l(shape_specializations_mu_);
+    shape_specializations_.clear();
+  }
+  shape_specialized_kernel_factory_ =
+      ShapeSpecializationThreshold() > 0 && k->AsAsync() == nullptr
+          ? ShapeSpecializedKernelRegistry::Global()->Find(
+                device_->device_type(), ndef.op())
+          : nullptr;
+  props_ = std::move(props);
   const auto* op_reg_data = OpRegistry::Global()->LookUp(ndef.op());
   if (op_reg_data != nullptr) {
     is_distributed_communication_op_ =
@@ -267,11 +294,14 @@ Status KernelAndDeviceOp::Run(
     const absl::optional<EagerFunctionParams>& eager_func_params,
     const absl::optional<ManagedStackTrace>& stack_trace,
     tsl::CoordinationServiceAgent* coordination_service_agent) {
+  OpKernel* kernel = shape_specialized_kernel_factory_ == nullptr
+                         ? kernel_.get()
+                         : KernelForInputs(inputs);
   OpKernelContext::Params params;
   params.device = device_;
   params.frame_iter = FrameAndIter(0, 0);
   params.inputs = *inputs.GetTensorValues();
-  params.op_kernel = kernel_.get();
+  params.op_kernel = kernel;
   params.resource_manager = device_->resource_manager();
   params.input_alloc_attrs = input_alloc_attrs_;
   params.output_attr_array = output_alloc_attrs_.data();
@@ -279,12 +309,15 @@ Status KernelAndDeviceOp::Run(
   params.slice_reader_cache = &slice_reader_cache_;
   params.rendezvous = rendezvous_;
   params.stack_trace = stack_trace;
+  if (device_ == host_cpu_device_) {
+    params.step_allocator = host_buffer_cache_;
+  }
   OpExecutionState* op_execution_state = nullptr;
 
   CancellationManager default_cancellation_manager;
   if (cancellation_manager) {
     params.cancellation_manager = cancellation_manager;
-  } else if (kernel_->is_deferred()) {
+  } else if (kernel->is_deferred()) {
     op_execution_state = new OpExecutionState;
     params.cancellation_manager = &op_execution_state->cancellation_manager;
     params.inc_num_deferred_ops_function = [op_execution_state]() {
@@ -316,9 +349,9 @@ Status KernelAndDeviceOp::Run(
     // 'AnnotatedTraceMe' will trace both scheduling time on host and execution
     // time on device of the OpKernel.
     profiler::AnnotatedTraceMe activity(
-        [&] { return kernel_->TraceString(context, /*verbose=*/false); },
+        [&] { return kernel->TraceString(context, /*verbose=*/false); },
         profiler::TraceMeLevel::kInfo);
-    device_->Compute(kernel_.get(), &context);
+    device_->Compute(kernel, &context);
   }
 
   // Clean up execution op_execution_state if deferred ops aren't running.
@@ -329,7 +362,7 @@ Status KernelAndDeviceOp::Run(
   Status s = context.status();
   if (TF_PREDICT_FALSE(!s.ok())) {
     if (errors::IsUnavailable(s) && !is_distributed_communication_op_) {
-      s = errors::ReplaceErrorFromNonCommunicationOps(s, kernel_->name());
+      s = errors::ReplaceErrorFromNonCommunicationOps(s, kernel->name());
     }
     return s;
   }
@@ -348,6 +381,58 @@ Status KernelAndDeviceOp::Run(
   return OkStatus();
 }
 
+OpKernel* KernelAndDeviceOp::KernelForInputs(const EagerKernelArgs& inputs) {
+  const gtl::InlinedVector<TensorValue, 4>& values = *inputs.GetTensorValues();
+  std::vector<int64_t> key;
+  for (const TensorValue& value : values) {
+    if (value.tensor == nullptr) return kernel_.get();
+    key.push_back(value->dims());
+    for (int d = 0; d < value->dims(); ++d) key.push_back(value->dim_size(d));
+  }
+  {
+    mutex_lock l(shape_specializations_mu_);
+    auto it = shape_specializations_.find(key);
+    if (it == shape_specializations_.end()) {
+      if (shape_specializations_.size() >= kMaxShapeSpecializations) {
+        return kernel_.get();
+      }
+      it = shape_specializations_.emplace(key, ShapeSpecialization()).first;
+    }
+    if (it->second.kernel != nullptr) return it->second.kernel.get();
+    // Specialize only once, when the threshold is reached.
+    if (++it->second.num_runs != ShapeSpecializationThreshold()) {
+      return kernel_.get();
+    }
+  }
+
+  std::vector<TensorShape> shapes;
+  shapes.reserve(values.size());
+  for (const TensorValue& value : values) shapes.push_back(value->shape());
+  StatusOr<std::unique_ptr<OpKernel>> specialized =
+      shape_specialized_kernel_factory_->Create(props_, flr_, shapes);
+  if (!specialized.ok()) {
+    VLOG(1) << "Failed to specialize " << kernel_->name()
+            << " to its input shapes: " << specialized.status();
+    return kernel_.get();
+  }
+  std::unique_ptr<OpKernel> kernel = std::move(specialized).value();
+  if (kernel == nullptr) return kernel_.get();
+  if (kernel->AsAsync() != nullptr ||
+      kernel->input_types() != kernel_->input_types() ||
+      kernel->output_types() != kernel_->output_types() ||
+      kernel->input_memory_types() != kernel_->input_memory_types() ||
+      kernel->output_memory_types() != kernel_->output_memory_types()) {
+    LOG(WARNING) << "Ignoring incompatible shape specialized kernel for "
+                 << kernel_->name();
+    return kernel_.get();
+  }
+  VLOG(2) << "Running a shape specialized kernel for " << kernel_->name();
+  mutex_lock l(shape_specializations_mu_);
+  ShapeSpecialization& specialization = shape_specializations_[key];
+  specialization.kernel = std::move(kernel);
+  return specialization.kernel.get();
+}
+
 std::shared_ptr<FunctionLibraryRuntime::Options>
 KernelAndDeviceFunc::PrepareForRun(
     ScopedStepContainer* step_container, std::vector<EagerKernelRet>* outputs,
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 // clang-format off
 // Required for IS_MOBILE_PLATFORM
@@ -30,6 +31,7 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/eager/shape_specialized_kernel.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -40,6 +42,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 #if !defined(IS_MOBILE_PLATFORM)
@@ -202,11 +206,12 @@ class KernelAndDeviceOp final : public KernelAndDevice {
       FunctionLibraryRuntime* flr,
       std::function<void(std::function<void()>)>* runner,
       std::unique_ptr<CollectiveExecutor::Handle> collective_executor,
-      Device* host_cpu_device)
+      Device* host_cpu_device, Allocator* host_buffer_cache = nullptr)
       : KernelAndDevice(flr, runner, std::move(collective_executor),
                         host_cpu_device),
         rendezvous_(rendezvous),
-        log_memory_(log_memory) {}
+        log_memory_(log_memory),
+        host_buffer_cache_(host_buffer_cache) {}
 
   ~KernelAndDeviceOp() override {}
 
@@ -249,8 +254,29 @@ class KernelAndDeviceOp final : public KernelAndDevice {
   int num_outputs() const override { return kernel_->num_outputs(); }
   const string& name() const override { return kernel_->name(); }
 
+  // The maximum number of distinct input shapes that are considered for
+  // shape specialization.
+  static constexpr int kMaxShapeSpecializations = 32;
+
  private:
+  // A kernel specialized to one signature of input shapes.
+  struct ShapeSpecialization {
+    int64_t num_runs = 0;
+    std::unique_ptr<OpKernel> kernel;
+  };
+
+  // Returns the kernel to run for the shapes of `inputs`, which is a shape
+  // specialized kernel if `shape_specialized_kernel_factory_` created one.
+  OpKernel* KernelForInputs(const EagerKernelArgs& inputs)
+      TF_LOCKS_EXCLUDED(shape_specializations_mu_);
+
   std::unique_ptr<OpKernel> kernel_;
+  std::shared_ptr<const NodeProperties> props_;
+  ShapeSpecializedKernelFactory* shape_specialized_kernel_factory_ = nullptr;
+  mutex shape_specializations_mu_;
+  // Keyed by the rank and dimensions of every input.
+  absl::flat_hash_map<std::vector<int64_t>, ShapeSpecialization>
+      shape_specializations_ TF_GUARDED_BY(shape_specializations_mu_);
   bool is_distributed_communication_op_;
   gtl::InlinedVector<AllocatorAttributes, 4> input_alloc_attrs_;
   std::vector<Device*> input_devices_;
@@ -258,6 +284,9 @@ class KernelAndDeviceOp final : public KernelAndDevice {
   Rendezvous* const rendezvous_;
   checkpoint::TensorSliceReaderCacheWrapper slice_reader_cache_;
   const bool log_memory_;
+  // Used for the outputs and temporaries of kernels on the host CPU, if not
+  // null. Not owned.
+  Allocator* const host_buffer_cache_;
 };
 
 // Represents a multi-device function. Functions can also be run using
@@ -27,8 +27,13 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/eager/attr_builder.h"
+#include "tensorflow/core/common_runtime/eager/shape_specialized_kernel.h"
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -144,5 +149,83 @@ void BM_KernelAndDeviceRun(::testing::benchmark::State& state) {
   }
 }
 BENCHMARK(BM_KernelAndDeviceRun);
+
+REGISTER_OP("ShapeSpecializationTest").Input("x: float").Output("y: int32");
+
+// Outputs `kValue`.
+template <int kValue>
+class ConstantValueOp : public OpKernel {
+ public:
+  explicit ConstantValueOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+  void Compute(OpKernelContext* ctx) override {
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    output->scalar<int32>()() = kValue;
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("ShapeSpecializationTest").Device(DEVICE_CPU),
+                        ConstantValueOp<0>);
+REGISTER_KERNEL_BUILDER(
+    Name("ShapeSpecializationTest").Device(DEVICE_CPU).Label("specialized"),
+    ConstantValueOp<1>);
+
+// Specializes inputs of shape [2] to the "specialized" kernel.
+class TestShapeSpecializedKernelFactory : public ShapeSpecializedKernelFactory {
+ public:
+  StatusOr<std::unique_ptr<OpKernel>> Create(
+      const std::shared_ptr<const NodeProperties>& props,
+      FunctionLibraryRuntime* flr,
+      absl::Span<const TensorShape> input_shapes) override {
+    if (input_shapes[0] != TensorShape({2})) {
+      return std::unique_ptr<OpKernel>();
+    }
+    NodeDef ndef = props->node_def;
+    AddNodeAttr("_kernel", "specialized", &ndef);
+    std::shared_ptr<const NodeProperties> specialized_props;
+    TF_RETURN_IF_ERROR(NodeProperties::CreateFromNodeDef(
+        ndef, flr->GetFunctionLibraryDefinition(), &specialized_props));
+    OpKernel* kernel;
+    TF_RETURN_IF_ERROR(flr->CreateKernel(specialized_props, &kernel));
+    return std::unique_ptr<OpKernel>(kernel);
+  }
+};
+
+REGISTER_SHAPE_SPECIALIZED_KERNEL(DEVICE_CPU, "ShapeSpecializationTest",
+                                  TestShapeSpecializedKernelFactory);
+
+int32 RunShapeSpecializationTest(KernelAndDeviceOp* k, Tensor input) {
+  gtl::InlinedVector<TensorValue, 4> inputs;
+  inputs.push_back(TensorValue(&input));
+  const EagerKernelArgs args(std::move(inputs));
+  std::vector<EagerKernelRet> outputs;
+  TF_CHECK_OK(k->Run(nullptr, args, &outputs, nullptr, absl::nullopt,
+                     absl::nullopt, nullptr));
+  return absl::get<Tensor>(outputs[0]).scalar<int32>()();
+}
+
+TEST(KernelAndDeviceTest, ShapeSpecializedKernel) {
+  NodeDef ndef(
+      AttrBuilder("ShapeSpecializationTest").NumInputs(1).BuildNodeDef());
+  TestEnv env;
+  KernelAndDeviceOp k(nullptr, false, env.function_library_runtime(), nullptr,
+                      nullptr, env.cpu_device());
+  TF_ASSERT_OK(k.Init({}, ndef, nullptr));
+
+  // The default threshold for specialization is 16 runs.
+  const Tensor specialized_input(DT_FLOAT, TensorShape({2}));
+  const Tensor other_input(DT_FLOAT, TensorShape({3}));
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_EQ(RunShapeSpecializationTest(&k, specialized_input), 0);
+    EXPECT_EQ(RunShapeSpecializationTest(&k, other_input), 0);
+  }
+  EXPECT_EQ(RunShapeSpecializationTest(&k, specialized_input), 1);
+  EXPECT_EQ(RunShapeSpecializationTest(&k, specialized_input), 1);
+  // The factory does not specialize other shapes.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(RunShapeSpecializationTest(&k, other_input), 0);
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
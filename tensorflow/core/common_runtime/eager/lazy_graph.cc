@@ -0,0 +1,285 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/lazy_graph.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/variant.h"
+#include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/shape_inference.h"
+#include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/graph_to_functiondef.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace {
+
+bool IsResourceOrRef(DataType dtype) {
+  return dtype == DT_RESOURCE || IsRefType(dtype);
+}
+
+}  // namespace
+
+LazyGraph::LazyGraph(EagerContext* ctx)
+    : ctx_(ctx), executor_(/*async=*/false) {}
+
+LazyGraph::~LazyGraph() {
+  Segment segment;
+  {
+    mutex_lock l(mu_);
+    std::swap(segment, segment_);
+  }
+  Release(errors::Cancelled("Lazy eager execution was disabled."), &segment);
+}
+
+Device* LazyGraph::RecordableDevice(EagerOperation* op, NodeDef* node_def,
+                                    DataTypeVector* output_types) const {
+  if (!op->IsLocal() || op->is_function() || op->eager_func_params() ||
+      op->OpDef() == nullptr || op->OpDef()->is_stateful()) {
+    return nullptr;
+  }
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  if (!op->TensorHandleInputs(&inputs).ok()) return nullptr;
+  for (const TensorHandle* input : *inputs) {
+    if (input->Type() != TensorHandle::LOCAL ||
+        IsResourceOrRef(input->dtype)) {
+      return nullptr;
+    }
+  }
+
+  *node_def = op->MutableAttrs()->BuildNodeDef();
+  AddDefaultsToNodeDef(*op->OpDef(), node_def);
+  if (!OutputTypesForNode(*node_def, *op->OpDef(), output_types).ok() ||
+      output_types->empty()) {
+    return nullptr;
+  }
+  for (DataType dtype : *output_types) {
+    if (IsResourceOrRef(dtype)) return nullptr;
+  }
+
+  VariantDevice variant_device = op->Device();
+  if (!absl::holds_alternative<Device*>(variant_device)) return nullptr;
+  Device* device = absl::get<Device*>(variant_device);
+  if (device == nullptr) {
+    DeviceNameUtils::ParsedName preferred = op->GetDeviceParsedName();
+    if (!DeviceNameUtils::HasSomeDetails(preferred)) {
+      preferred = DeviceNameUtils::AddressSpace(ctx_->HostCPUParsedName());
+    }
+    if (!ctx_->SelectDevice(preferred, *node_def, &device).ok()) {
+      return nullptr;
+    }
+  }
+  return device;
+}
+
+Status LazyGraph::MaybeRecord(EagerOperation* op, TensorHandle** retvals,
+                              int* num_retvals, bool* recorded) {
+  *recorded = false;
+  NodeDef node_def;
+  DataTypeVector output_types;
+  Device* device = RecordableDevice(op, &node_def, &output_types);
+  if (device == nullptr || *num_retvals < static_cast<int>(output_types.size())) {
+    return OkStatus();
+  }
+  const absl::InlinedVector<TensorHandle*, 4>* inputs;
+  TF_RETURN_IF_ERROR(op->TensorHandleInputs(&inputs));
+
+  Segment previous;
+  absl::InlinedVector<TensorHandle*, 2> outputs(output_types.size());
+  {
+    mutex_lock l(mu_);
+    if ((segment_.device != nullptr && segment_.device != device) ||
+        segment_.nodes.size() >= kMaxOps) {
+      std::swap(previous, segment_);
+    }
+    segment_.device = device;
+
+    const string node_name = absl::StrCat("op", segment_.nodes.size());
+    node_def.set_name(node_name);
+    node_def.set_device(device->name());
+    node_def.clear_input();
+    for (TensorHandle* input : *inputs) {
+      auto it = segment_.output_index.find(input);
+      if (it != segment_.output_index.end()) {
+        node_def.add_input(segment_.outputs[it->second].tensor_name);
+        continue;
+      }
+      auto inserted =
+          segment_.arg_index.emplace(input, segment_.args.size());
+      if (inserted.second) {
+        input->Ref();
+        segment_.args.push_back(input);
+      }
+      node_def.add_input(absl::StrCat("arg", inserted.first->second));
+    }
+
+    for (int i = 0; i < output_types.size(); ++i) {
+      // Outputs that the kernel places in host memory are kept on the host
+      // CPU, as EagerLocalExecute would.
+      Device* handle_device =
+          device->device_type() != DEVICE_CPU &&
+                  MTypeFromDType(output_types[i]) == HOST_MEMORY
+              ? nullptr
+              : ctx_->CanonicalDevice(device);
+      TensorHandle* handle = TensorHandle::CreateEmptyLocalHandle(
+          handle_device, /*op_device=*/device, /*resource_device=*/nullptr,
+          output_types[i], ctx_);
+      handle->SetFlushBeforeWait([this]() { Flush().IgnoreError(); });
+      handle->Ref();
+      segment_.output_index.emplace(handle, segment_.outputs.size());
+      segment_.outputs.push_back(
+          {handle, handle_device, absl::StrCat(node_name, ":", i)});
+      outputs[i] = handle;
+    }
+    segment_.nodes.push_back(node_def);
+  }
+  if (previous.device != nullptr) {
+    // Errors surface through the outputs of the previous segment.
+    Execute(&previous).IgnoreError();
+  }
+
+  Status s = eager::RunShapeInference(node_def, *ctx_->FuncLibDef(), *inputs,
+                                      outputs);
+  if (!s.ok()) {
+    // The op would fail at execution. Its outputs are released, so that it
+    // is pruned rather than failing the rest of the segment.
+    for (TensorHandle* handle : outputs) handle->Unref();
+    return s;
+  }
+  for (int i = 0; i < outputs.size(); ++i) retvals[i] = outputs[i];
+  *num_retvals = outputs.size();
+  *recorded = true;
+  return OkStatus();
+}
+
+Status LazyGraph::Flush() {
+  Segment segment;
+  {
+    mutex_lock l(mu_);
+    if (segment_.nodes.empty()) return OkStatus();
+    std::swap(segment, segment_);
+  }
+  return Execute(&segment);
+}
+
+Status LazyGraph::Execute(Segment* segment) {
+  // Only the outputs that are still referenced outside of the segment are
+  // returned, so that the ops computing the others are pruned.
+  std::vector<int> live_outputs;
+  for (int i = 0; i < segment->outputs.size(); ++i) {
+    if (!segment->outputs[i].handle->RefCountIsOne()) live_outputs.push_back(i);
+  }
+  if (live_outputs.empty()) {
+    Release(OkStatus(), segment);
+    return OkStatus();
+  }
+
+  GraphDef graph_def;
+  graph_def.mutable_versions()->set_producer(TF_GRAPH_DEF_VERSION);
+  for (int i = 0; i < segment->args.size(); ++i) {
+    NodeDef* arg = graph_def.add_node();
+    arg->set_name(absl::StrCat("arg", i));
+    arg->set_op(FunctionLibraryDefinition::kArgOp);
+    AddNodeAttr("T", segment->args[i]->dtype, arg);
+    AddNodeAttr("index", i, arg);
+  }
+  for (NodeDef& node : segment->nodes) {
+    *graph_def.add_node() = std::move(node);
+  }
+  for (int i = 0; i < live_outputs.size(); ++i) {
+    const Output& output = segment->outputs[live_outputs[i]];
+    NodeDef* ret = graph_def.add_node();
+    ret->set_name(absl::StrCat("ret", i));
+    ret->set_op(FunctionLibraryDefinition::kRetOp);
+    ret->add_input(output.tensor_name);
+    AddNodeAttr("T", output.handle->dtype, ret);
+    AddNodeAttr("index", i, ret);
+  }
+
+  // Segments with the same ops share a function, and thus a cached kernel.
+  string serialized;
+  SerializeToStringDeterministic(graph_def, &serialized);
+  const string function_name =
+      absl::StrCat("__lazy_eager_", Fingerprint64(serialized));
+
+  Status s;
+  if (ctx_->FindFunctionDef(function_name) == nullptr) {
+    Graph graph(ctx_->FuncLibDef());
+    s = ConvertGraphDefToGraph(GraphConstructorOptions(), std::move(graph_def),
+                               &graph);
+    FunctionDef fdef;
+    if (s.ok()) s = GraphToFunctionDef(graph, function_name, &fdef);
+    if (s.ok()) s = ctx_->AddFunctionDef(fdef);
+  }
+
+  absl::InlinedVector<TensorHandle*, 2> results(live_outputs.size());
+  if (s.ok()) {
+    VLOG(2) << "Executing " << segment->nodes.size() << " lazily recorded ops "
+            << "as " << function_name << " on " << segment->device->name();
+    EagerOperation call(ctx_);
+    s = call.Reset(function_name.c_str(), segment->device->name().c_str(),
+                   /*remote=*/false, &executor_);
+    for (int i = 0; s.ok() && i < segment->args.size(); ++i) {
+      s = call.AddInput(segment->args[i]);
+    }
+    int num_results = results.size();
+    if (s.ok()) s = EagerExecute(&call, results.data(), &num_results);
+  }
+
+  for (int i = 0; s.ok() && i < live_outputs.size(); ++i) {
+    Output& output = segment->outputs[live_outputs[i]];
+    Tensor tensor;
+    s = results[i]->CopyToDevice(*ctx_, output.handle_device, &tensor);
+    if (s.ok()) {
+      s = output.handle->SetTensor(std::move(tensor), output.handle_device);
+    }
+    output.ready = s.ok();
+  }
+  for (TensorHandle* result : results) {
+    if (result != nullptr) result->Unref();
+  }
+  Release(s, segment);
+  return s;
+}
+
+void LazyGraph::Release(const Status& status, Segment* segment) {
+  for (Output& output : segment->outputs) {
+    if (!output.ready) {
+      output.handle->Poison(
+          status.ok() ? errors::Cancelled("The output was not needed.")
+                      : status,
+          output.handle_device);
+    }
+    output.handle->Unref();
+  }
+  for (TensorHandle* arg : segment->args) arg->Unref();
+  *segment = Segment();
+}
+
+}  // namespace tensorflow
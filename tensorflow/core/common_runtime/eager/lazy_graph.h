@@ -0,0 +1,109 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_GRAPH_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_GRAPH_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/common_runtime/eager/eager_executor.h"
+#include "tensorflow/core/common_runtime/eager/eager_operation.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Records primitive ops in lazy execution mode, and executes them as a single
+// function call once one of their outputs is needed.
+//
+// Only stateless ops on a local device, without resource inputs or outputs,
+// are recorded, so that running them later than requested is not observable.
+// The outputs of recorded ops are non-ready handles, which flush the graph
+// once their value is needed, or their shape if shape inference could not
+// determine it. The graph is also flushed when it holds kMaxOps ops, and when
+// an op is placed on another device than the recorded ones.
+//
+// Like the body of a tf.function, the function is optimized when it is
+// instantiated: ops whose outputs are no longer referenced at flush time are
+// pruned, and the function is clustered for XLA if auto-clustering is enabled.
+// Segments with the same ops reuse the same function and cached kernel.
+class LazyGraph : public PendingEagerOps {
+ public:
+  // The maximum number of ops that are recorded before flushing.
+  static constexpr int kMaxOps = 256;
+
+  // `ctx` must outlive this object.
+  explicit LazyGraph(EagerContext* ctx);
+  ~LazyGraph() override;
+
+  Status MaybeRecord(EagerOperation* op, TensorHandle** retvals,
+                     int* num_retvals, bool* recorded) override;
+
+  Status Flush() override;
+
+ private:
+  // An output of a recorded op.
+  struct Output {
+    TensorHandle* handle;   // Owned. Not ready until the segment is executed.
+    Device* handle_device;  // The device `handle` was created with.
+    std::string tensor_name;
+    bool ready = false;
+  };
+
+  // The ops recorded since the last flush.
+  struct Segment {
+    // The device of all recorded ops.
+    Device* device = nullptr;
+    std::vector<NodeDef> nodes;
+    // The inputs that are not outputs of recorded ops. Owned.
+    std::vector<TensorHandle*> args;
+    absl::flat_hash_map<const TensorHandle*, int> arg_index;
+    std::vector<Output> outputs;
+    absl::flat_hash_map<const TensorHandle*, int> output_index;
+  };
+
+  // Returns the device to record `op` on, or nullptr if `op` cannot be
+  // recorded. Sets `node_def` and `output_types` if it can.
+  Device* RecordableDevice(EagerOperation* op, NodeDef* node_def,
+                           DataTypeVector* output_types) const;
+
+  // Executes the ops of `segment`, and makes its outputs ready.
+  Status Execute(Segment* segment);
+
+  // Releases the handles of `segment`, poisoning the outputs that were not
+  // set with `status`.
+  static void Release(const Status& status, Segment* segment);
+
+  EagerContext* const ctx_;  // Not owned.
+  // Executes the functions synchronously, since Flush can be called from the
+  // threads of asynchronous executors.
+  EagerExecutor executor_;
+
+  mutex mu_;
+  Segment segment_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(LazyGraph);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_LAZY_GRAPH_H_
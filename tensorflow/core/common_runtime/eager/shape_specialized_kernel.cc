@@ -0,0 +1,47 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/eager/shape_specialized_kernel.h"
+
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+ShapeSpecializedKernelRegistry* ShapeSpecializedKernelRegistry::Global() {
+  static ShapeSpecializedKernelRegistry* registry =
+      new ShapeSpecializedKernelRegistry;
+  return registry;
+}
+
+void ShapeSpecializedKernelRegistry::Register(
+    const std::string& device_type, const std::string& op,
+    std::unique_ptr<ShapeSpecializedKernelFactory> factory) {
+  mutex_lock l(mu_);
+  const bool inserted =
+      factories_.emplace(std::make_pair(device_type, op), std::move(factory))
+          .second;
+  CHECK(inserted) << "Shape specialized kernel for " << op << " on "
+                  << device_type << " is registered twice.";
+}
+
+ShapeSpecializedKernelFactory* ShapeSpecializedKernelRegistry::Find(
+    const std::string& device_type, const std::string& op) const {
+  tf_shared_lock l(mu_);
+  auto it = factories_.find(std::make_pair(device_type, op));
+  return it == factories_.end() ? nullptr : it->second.get();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,104 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SHAPE_SPECIALIZED_KERNEL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SHAPE_SPECIALIZED_KERNEL_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/node_properties.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Creates kernels that are specialized to the shapes of their inputs, e.g.
+// with a fixed-size Eigen expression or a single-op XLA executable.
+//
+// KernelAndDeviceOp asks the factory registered for its op and device type
+// for a specialized kernel once it has run often enough with the same input
+// shapes, and then runs that kernel for those shapes. A specialized kernel
+// must be synchronous, and must have the input and output types and memory
+// types of the kernel it replaces.
+class ShapeSpecializedKernelFactory {
+ public:
+  virtual ~ShapeSpecializedKernelFactory() = default;
+
+  // Returns a kernel for `props` specialized to `input_shapes`, or nullptr if
+  // there is none for these shapes.
+  virtual StatusOr<std::unique_ptr<OpKernel>> Create(
+      const std::shared_ptr<const NodeProperties>& props,
+      FunctionLibraryRuntime* flr,
+      absl::Span<const TensorShape> input_shapes) = 0;
+};
+
+class ShapeSpecializedKernelRegistry {
+ public:
+  static ShapeSpecializedKernelRegistry* Global();
+
+  // Registers `factory` for `op` on devices of type `device_type`. At most
+  // one factory may be registered per op and device type.
+  void Register(const std::string& device_type, const std::string& op,
+                std::unique_ptr<ShapeSpecializedKernelFactory> factory)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the factory for `op` on `device_type`, or nullptr.
+  ShapeSpecializedKernelFactory* Find(const std::string& device_type,
+                                      const std::string& op) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutable mutex mu_;
+  absl::flat_hash_map<std::pair<std::string, std::string>,
+                      std::unique_ptr<ShapeSpecializedKernelFactory>>
+      factories_ TF_GUARDED_BY(mu_);
+};
+
+namespace shape_specialized_kernel_registration {
+
+class Registrar {
+ public:
+  Registrar(const std::string& device_type, const std::string& op,
+            std::unique_ptr<ShapeSpecializedKernelFactory> factory) {
+    ShapeSpecializedKernelRegistry::Global()->Register(device_type, op,
+                                                       std::move(factory));
+  }
+};
+
+}  // namespace shape_specialized_kernel_registration
+
+// Registers a ShapeSpecializedKernelFactory subclass, which must be default
+// constructible, for `op` on `device_type`.
+#define REGISTER_SHAPE_SPECIALIZED_KERNEL(device_type, op, factory)           \
+  REGISTER_SHAPE_SPECIALIZED_KERNEL_UNIQ_HELPER(__COUNTER__, device_type, op, \
+                                                factory)
+#define REGISTER_SHAPE_SPECIALIZED_KERNEL_UNIQ_HELPER(ctr, device_type, op, \
+                                                      factory)              \
+  REGISTER_SHAPE_SPECIALIZED_KERNEL_UNIQ(ctr, device_type, op, factory)
+#define REGISTER_SHAPE_SPECIALIZED_KERNEL_UNIQ(ctr, device_type, op, factory) \
+  static ::tensorflow::shape_specialized_kernel_registration::Registrar       \
+      shape_specialized_kernel_registrar_##ctr TF_ATTRIBUTE_UNUSED(           \
+          device_type, op, std::make_unique<factory>())
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_EAGER_SHAPE_SPECIALIZED_KERNEL_H_
@@ -23,6 +23,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/base/config.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/variant.h"
 #include "tensorflow/c/tf_tensor_internal.h"
@@ -62,8 +63,49 @@ string SafeDeviceDebugString(Device* device) {
     return device->DebugString();
   }
 }
+
+// The memory of deleted TensorHandles.
+struct TensorHandlePool {
+  mutex mu;
+  std::vector<void*> free TF_GUARDED_BY(mu);
+};
+
+TensorHandlePool* GetTensorHandlePool() {
+  static TensorHandlePool* pool = new TensorHandlePool;
+  return pool;
+}
 }  // namespace
 
+void* TensorHandle::operator new(size_t size) {
+#ifndef ABSL_HAVE_ADDRESS_SANITIZER
+  // Reuse would hide use-after-free bugs from ASAN.
+  if (size == sizeof(TensorHandle)) {
+    TensorHandlePool* pool = GetTensorHandlePool();
+    mutex_lock l(pool->mu);
+    if (!pool->free.empty()) {
+      void* ptr = pool->free.back();
+      pool->free.pop_back();
+      return ptr;
+    }
+  }
+#endif  // ABSL_HAVE_ADDRESS_SANITIZER
+  return ::operator new(size);
+}
+
+void TensorHandle::operator delete(void* ptr, size_t size) {
+#ifndef ABSL_HAVE_ADDRESS_SANITIZER
+  if (size == sizeof(TensorHandle)) {
+    TensorHandlePool* pool = GetTensorHandlePool();
+    mutex_lock l(pool->mu);
+    if (pool->free.size() < kMaxPooledHandles) {
+      pool->free.push_back(ptr);
+      return;
+    }
+  }
+#endif  // ABSL_HAVE_ADDRESS_SANITIZER
+  ::operator delete(ptr);
+}
+
 TensorHandle::PackedTensorHandleData::PackedTensorHandleData(
     std::vector<TensorHandle*>&& handles, const TensorShape& shape)
     : handles_(std::move(handles)), shape_(shape) {
@@ -430,10 +472,17 @@ bool TensorHandle::IsReady() const {
 }
 
 Status TensorHandle::WaitReady(const char* caller) const {
+  MaybeFlushBeforeWait();
   return absl::visit([caller](auto& data) { return data.WaitReady(caller); },
                      data_);
 }
 
+void TensorHandle::MaybeFlushBeforeWait() const {
+  if (flush_before_wait_ && !IsReady()) {
+    flush_before_wait_();
+  }
+}
+
 TensorHandle::HandleType TensorHandle::Type() const {
   if (data_.index() == 0) {
     return LOCAL;
@@ -462,6 +511,7 @@ Status TensorHandle::Tensor(const tensorflow::Tensor** t) const {
                             " handle: ", this);
   }
 
+  MaybeFlushBeforeWait();
   auto& data = absl::get<LocalTensorHandleData>(data_);
   return data.Tensor(t);
 }
@@ -476,6 +526,7 @@ Status TensorHandle::TensorFromDevice(const Device* d,
                               " handle: ", this);
     }
 
+    MaybeFlushBeforeWait();
     auto& data = absl::get<LocalTensorHandleData>(data_);
     return data.Tensor(t);
   }
@@ -500,6 +551,7 @@ Status TensorHandle::TensorValue(const Device* d, tensorflow::TensorValue* t) {
                               " handle: ", this);
     }
 
+    MaybeFlushBeforeWait();
     auto& data = absl::get<LocalTensorHandleData>(data_);
     return data.TensorValue(t);
   }
@@ -536,6 +588,7 @@ Status TensorHandle::Shape(tensorflow::TensorShape* shape) {
     DCHECK(fill);
     return OkStatus();
   } else {
+    MaybeFlushBeforeWait();
     return absl::visit([shape](auto& data) { return data.Shape(shape); },
                        data_);
   }
@@ -611,6 +664,7 @@ Status TensorHandle::Shape(tensorflow::PartialTensorShape* shape) const {
     *shape = inference_shape_;
     return OkStatus();
   } else {
+    MaybeFlushBeforeWait();
     auto result = absl::visit(
         [](auto& data) {
           TensorShape shape;
@@ -630,6 +684,7 @@ Status TensorHandle::NumDims(int* num_dims) const {
     *num_dims = inference_shape_.dims();
     return OkStatus();
   } else {
+    MaybeFlushBeforeWait();
     return absl::visit(
         [num_dims](auto& data) { return data.NumDims(num_dims); }, data_);
   }
@@ -642,6 +697,7 @@ Status TensorHandle::Dim(int dim_index, int64_t* dim) const {
     *dim = inference_shape_.dim_size(dim_index);
     return OkStatus();
   } else {
+    MaybeFlushBeforeWait();
     return absl::visit(
         [dim_index, dim](auto& data) { return data.Dim(dim_index, dim); },
         data_);
@@ -654,6 +710,7 @@ Status TensorHandle::NumElements(int64_t* num_elements) const {
     *num_elements = inference_shape_.num_elements();
     return OkStatus();
   } else {
+    MaybeFlushBeforeWait();
     return absl::visit(
         [num_elements](auto& data) { return data.NumElements(num_elements); },
         data_);
@@ -17,10 +17,12 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <queue>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 // clang-format off
@@ -230,6 +232,15 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   // tensor for a specific device.
   void Poison(Status status, const Device* d);
 
+  // Makes this non-ready local handle call `flush` before waiting until it is
+  // ready, for handles whose producer only runs once it is needed. `flush`
+  // must eventually make the handle ready by calling SetTensor or Poison, but
+  // may return before, e.g. if another thread is already running the
+  // producer. Must be called before the handle is shared.
+  void SetFlushBeforeWait(std::function<void()> flush) {
+    flush_before_wait_ = std::move(flush);
+  }
+
   // TODO(b/154282629): Consider moving it to EagerContext.
   // Copies to the tensor on the given device `d`, or to host iff `d` is null.
   Status CopyToDevice(const EagerContext& ctx, tensorflow::Device* d,
@@ -271,6 +282,12 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
     return ptr->getKind() == kEager;
   }
 
+  // A handle is created for every output of every eager op, so the memory of
+  // deleted handles is kept in a pool of up to kMaxPooledHandles for reuse.
+  static constexpr int kMaxPooledHandles = 1024;
+  static void* operator new(size_t size);
+  static void operator delete(void* ptr, size_t size);
+
  private:
   friend class PackedTensorHandleTest;
 
@@ -287,6 +304,9 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   bool IsReady() const;
   Status WaitReady(const char* caller) const;
 
+  // Calls flush_before_wait_ if it is set and the handle is not ready.
+  void MaybeFlushBeforeWait() const;
+
   tensorflow::Device* device_;
 
   // Device in which the op producing this tensor was executed. Equals to
@@ -390,6 +410,9 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
 #endif
 
   PartialTensorShape inference_shape_;
+
+  // See SetFlushBeforeWait. Immutable once the handle is shared.
+  std::function<void()> flush_before_wait_;
 };
 
 // Returns the device backing the resource. Else, returns nullptr.
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 
+#include "absl/base/config.h"
 #include "tensorflow/core/common_runtime/composite_device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -66,6 +67,19 @@ TEST(TensorHandle_ShapeTest, AsyncShape) {
   ctx->Unref();
 }
 
+#ifndef ABSL_HAVE_ADDRESS_SANITIZER
+TEST(TensorHandle_PoolTest, ReusesDeletedHandles) {
+  TensorHandle* first = TensorHandle::CreateLocalHandle(Tensor(1.0f));
+  first->Unref();
+  TensorHandle* second = TensorHandle::CreateLocalHandle(Tensor(2.0f));
+  EXPECT_EQ(first, second);
+  const Tensor* t = nullptr;
+  TF_ASSERT_OK(second->Tensor(&t));
+  EXPECT_EQ(t->scalar<float>()(), 2.0f);
+  second->Unref();
+}
+#endif  // ABSL_HAVE_ADDRESS_SANITIZER
+
 static Device* CreateDevice(const char* type, const char* name,
                             bool is_local = true) {
   class FakeDevice : public Device {
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
@@ -29,16 +30,19 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
+#include "tensorflow/core/common_runtime/memory_planner.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/control_flow.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/latency_breakdown.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -48,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/edgeset.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
@@ -60,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -70,6 +76,7 @@ limitations under the License.
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/backends/cpu/perf_counters.h"
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/connected_traceme.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
@@ -79,6 +86,7 @@ limitations under the License.
 #include "tensorflow/core/util/determinism.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/ThreadPool"
 
 namespace tensorflow {
 
@@ -142,13 +150,136 @@ struct KernelTimer {
 typedef gtl::InlinedVector<TensorValue, 4> TensorValueVec;
 typedef gtl::InlinedVector<AllocatorAttributes, 4> AllocatorAttributeVec;
 
+// A set of per-worker ready queues, used by the "WORK_STEALING_EXECUTOR".
+//
+// Each worker of a step owns one `Eigen::RunQueue`. A worker pushes the nodes
+// that become ready on it to the front of its own queue and pops from the
+// front without taking a lock; when its own queue is empty it steals from the
+// back of the other workers' queues. At most `num_workers()` workers are
+// active at any time, so the number of closures handed to the inter-op
+// threadpool is bounded by the number of workers instead of the number of
+// ready nodes.
+template <typename TaggedNode>
+class WorkStealingReadyQueues {
+ public:
+  // The worker slots are tracked in a 64-bit mask.
+  static constexpr int kMaxWorkers = 64;
+
+  explicit WorkStealingReadyQueues(int num_workers)
+      : num_workers_(std::min(std::max(num_workers, 1), kMaxWorkers)),
+        queues_(new Queue[num_workers_]) {}
+
+  int num_workers() const { return num_workers_; }
+
+  // Claims an unused worker slot and returns its index, or returns -1 if all
+  // `num_workers()` slots are in use.
+  int TryClaimWorker() {
+    uint64 active = active_workers_.load();
+    while (true) {
+      const int index = LowestUnsetBit(active);
+      if (index >= num_workers_) return -1;
+      if (active_workers_.compare_exchange_weak(active,
+                                                active | (uint64{1} << index))) {
+        return index;
+      }
+    }
+  }
+
+  // Releases a slot returned by `TryClaimWorker()`.
+  void ReleaseWorker(int worker) {
+    active_workers_.fetch_and(~(uint64{1} << worker));
+  }
+
+  // Enqueues `node`. `worker` is the slot owned by the calling thread, or -1 if
+  // the calling thread is not a worker of this step. Returns false if the
+  // target queue is full, in which case the caller must run `node` itself.
+  bool Push(int worker, const TaggedNode& node) {
+    if (worker >= 0) {
+      return queues_[worker].PushFront(node).node_item == nullptr;
+    }
+    const int index =
+        next_queue_.fetch_add(1, std::memory_order_relaxed) % num_workers_;
+    return queues_[index].PushBack(node).node_item == nullptr;
+  }
+
+  // Dequeues a node for `worker`, first from its own queue and then by
+  // stealing from the other queues. Returns false if no node was found.
+  bool Pop(int worker, TaggedNode* node) {
+    *node = queues_[worker].PopFront();
+    if (node->node_item != nullptr) return true;
+    for (int i = 1; i < num_workers_; ++i) {
+      *node = queues_[(worker + i) % num_workers_].PopBack();
+      if (node->node_item != nullptr) return true;
+    }
+    return false;
+  }
+
+  bool Empty() const {
+    for (int i = 0; i < num_workers_; ++i) {
+      if (!queues_[i].Empty()) return false;
+    }
+    return true;
+  }
+
+ private:
+  typedef Eigen::RunQueue<TaggedNode, 256> Queue;
+
+  static int LowestUnsetBit(uint64 mask) {
+    int index = 0;
+    while (index < kMaxWorkers && (mask & (uint64{1} << index))) ++index;
+    return index;
+  }
+
+  const int num_workers_;
+  std::unique_ptr<Queue[]> queues_;
+  std::atomic<uint64> active_workers_{0};
+  std::atomic<uint32> next_queue_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(WorkStealingReadyQueues);
+};
+
+// The work-stealing worker slot owned by the current thread. `queues` is
+// type-erased because it may belong to any `ExecutorState` instantiation.
+struct WorkStealingWorkerSlot {
+  const void* queues = nullptr;
+  int index = -1;
+};
+thread_local WorkStealingWorkerSlot current_work_stealing_worker;
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  // If `use_work_stealing` is true, each step schedules its ready nodes
+  // through per-worker `WorkStealingReadyQueues`.
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool use_work_stealing = false)
+      : immutable_state_(p),
+        num_work_stealing_workers_(use_work_stealing ? port::MaxParallelism()
+                                                     : 0) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
-    kernel_stats_.Initialize(immutable_state_.graph_view());
+    kernel_stats_.Initialize(immutable_state_.graph_view(), graph,
+                             immutable_state_.params().cost_model);
+    if (immutable_state_.params().plan_memory) {
+      const GraphView& gview = immutable_state_.graph_view();
+      memory_plan_ =
+          MemoryPlan::Build(graph, [&gview](const Node* n, int output) {
+            const NodeItem* item = gview.node(n->id());
+            return item != nullptr && item->outputs_are_step_local &&
+                   item->const_tensor == nullptr &&
+                   item->output_attrs()[output].value == 0 &&
+                   item->output_attrs()[output].scope_id == 0;
+          });
+    }
+    for (const Node* n : graph.op_nodes()) {
+      if (!n->IsRetval()) continue;
+      int index;
+      TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+      for (const Edge* e : n->in_edges()) {
+        if (e->IsControlEdge()) continue;
+        retval_producers_.push_back({e->src()->id(), e->src_output(), index});
+      }
+    }
     return OkStatus();
   }
 
@@ -163,15 +294,33 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
+    // If `cost_model` is not null, the measured compute time of each node
+    // that it has seen replaces the static `OpKernel::IsExpensive()` marker
+    // as the initial cost estimate.
+    void Initialize(const GraphView& gview, const Graph& graph,
+                    const CostModel* cost_model) {
       is_expensive_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
+      const double cycles_per_usec =
+          cost_model ? 1.0 / profile_utils::CpuUtils::GetMicroSecPerClock()
+                     : 0.0;
       for (int32_t i = 0; i < gview.num_nodes(); ++i) {
         if (gview.node(i)) {
           is_expensive_[i] =
               gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
           cost_estimates_[i] = kInitialCostEstimateCycles;
+          const Node* node = cost_model ? graph.FindNodeId(i) : nullptr;
+          if (node != nullptr && node->IsOp() && gview.node(i)->kernel &&
+              cost_model->TotalCount(node) > 0) {
+            const uint64 measured_cycles = static_cast<uint64>(
+                cost_model->TimeEstimate(node).value() * cycles_per_usec);
+            // Keep tracking the cost of every node with a measurement, so
+            // that kernels which are not marked expensive but turn out to be
+            // slow are dispatched to the threadpool.
+            is_expensive_[i] = true;
+            cost_estimates_[i] = measured_cycles;
+          }
         }
       }
     }
@@ -185,7 +334,8 @@ class ExecutorImpl : public Executor {
               kOpIsExpensiveThresholdCycles);
     }
 
-    // Returns the value of kernel->IsExpensive().
+    // Returns true iff the cost of the given node is tracked, i.e. if
+    // kernel->IsExpensive() is true or the node has a measured cost.
     bool HasExpensiveMarker(const NodeItem& node) const {
       return is_expensive_[node.node_id];
     }
@@ -222,6 +372,19 @@ class ExecutorImpl : public Executor {
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // Number of work-stealing workers per step, or 0 if work stealing is off.
+  const int num_work_stealing_workers_;
+  // Static assignment of node outputs to per-step memory, or nullptr if
+  // memory planning is disabled or found nothing to plan.
+  std::unique_ptr<MemoryPlan> memory_plan_;
+
+  // The output that each `_Retval` node returns.
+  struct RetvalProducer {
+    int node_id;
+    int output;
+    int index;  // Of the retval.
+  };
+  std::vector<RetvalProducer> retval_producers_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
@@ -280,7 +443,10 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                int num_work_stealing_workers, const MemoryPlan* memory_plan,
+                const std::vector<ExecutorImpl::RetvalProducer>&
+                    retval_producers);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -291,6 +457,7 @@ class ExecutorState {
   typedef
       typename PropagatorStateType::TaggedNodeReadyQueue TaggedNodeReadyQueue;
   typedef typename PropagatorStateType::TaggedNodeSeq TaggedNodeSeq;
+  typedef WorkStealingReadyQueues<TaggedNode> WorkQueues;
 
   struct AsyncState;
 
@@ -336,6 +503,21 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Pushes `nodes` onto the work-stealing queues and wakes up idle workers to
+  // run them.
+  //
+  // REQUIRES: `work_queues_ != nullptr`.
+  void PushToWorkQueues(const TaggedNodeSeq& nodes, int64_t scheduled_nsec);
+
+  // Runs the nodes in `queues` on the current thread, as worker `worker`, until
+  // all queues are empty.
+  //
+  // This is a static function because `state` may be deleted as soon as the
+  // last node of the step completes; it is only dereferenced to process a node
+  // that has been dequeued, which keeps the step alive.
+  static void RunWorker(ExecutorState* state, std::shared_ptr<WorkQueues> queues,
+                        int worker, bool record_scheduled_time);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
@@ -375,6 +557,7 @@ class ExecutorState {
   // Step-local container.
   ScopedStepContainer* step_container_;
   StepStatsCollectorInterface* const stats_collector_;
+  LatencyBreakdownCollector* const latency_breakdown_;
   const tracing::EventCollector* const event_collector_;
   Context context_;
 
@@ -395,6 +578,22 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // Per-worker ready queues, or nullptr if work stealing is disabled. Shared
+  // with the running workers, which may outlive this `ExecutorState`.
+  std::shared_ptr<WorkQueues> work_queues_;
+
+  // Allocator for step-local tensors, or nullptr if the step arena is
+  // disabled. Released when this `ExecutorState` is destroyed.
+  StepArenaAllocator* step_arena_ = nullptr;
+
+  // This step's planned output buffers, or nullptr if memory planning is
+  // disabled. Released when this `ExecutorState` is destroyed.
+  PlannedMemory* planned_memory_ = nullptr;
+
+  // Keyed by node id: the allocators from `Args::retval_allocators` for the
+  // outputs of the nodes that produce retvals, indexed by output number.
+  absl::flat_hash_map<int, std::vector<Allocator*>> retval_output_allocators_;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
@@ -413,7 +612,9 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, int num_work_stealing_workers,
+    const MemoryPlan* memory_plan,
+    const std::vector<ExecutorImpl::RetvalProducer>& retval_producers)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -427,6 +628,7 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
       stats_collector_(args.stats_collector),
+      latency_breakdown_(args.latency_breakdown),
       event_collector_(
           tracing::GetEventCollector(tracing::EventCategory::kCompute)),
       context_(ContextKind::kThread),
@@ -442,11 +644,42 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
       num_outstanding_ops_(0) {
+  // Work stealing relies on dispatching ready nodes to other threads, so it is
+  // not compatible with running all kernels inline.
+  if (num_work_stealing_workers > 0 && !run_all_kernels_inline_) {
+    work_queues_ = std::make_shared<WorkQueues>(num_work_stealing_workers);
+  }
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (args.use_step_arena) {
+    Device* device = immutable_state_.params().device;
+    if (device->device_type() == DEVICE_CPU) {
+      step_arena_ =
+          new StepArenaAllocator(device->GetAllocator(AllocatorAttributes()));
+    }
+  }
+  if (memory_plan != nullptr) {
+    planned_memory_ = new PlannedMemory(
+        memory_plan,
+        immutable_state_.params().device->GetAllocator(AllocatorAttributes()));
+  }
+  if (args.retval_allocators != nullptr) {
+    const std::vector<Allocator*>& retval_allocators = *args.retval_allocators;
+    for (const auto& producer : retval_producers) {
+      if (producer.index >= static_cast<int>(retval_allocators.size()) ||
+          retval_allocators[producer.index] == nullptr) {
+        continue;
+      }
+      std::vector<Allocator*>& allocators =
+          retval_output_allocators_[producer.node_id];
+      allocators.resize(
+          immutable_state_.graph_view().node(producer.node_id)->num_outputs);
+      allocators[producer.output] = retval_allocators[producer.index];
+    }
+  }
 }
 
 template <class PropagatorStateType>
@@ -455,6 +688,12 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (step_arena_) {
+    step_arena_->Release();
+  }
+  if (planned_memory_) {
+    planned_memory_->Release();
+  }
 }
 
 template <class PropagatorStateType>
@@ -541,6 +780,8 @@ struct ExecutorState<PropagatorStateType>::AsyncState {
   const NodeItem* item;
   Entry* first_input;
   OpKernelContext ctx;
+  // Start of the kernel, only set if the latency breakdown is collected.
+  uint64 start_usecs = 0;
   NodeExecStatsInterface* stats;
 
  private:
@@ -584,6 +825,8 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   OpKernel* op_kernel = item.kernel;
   Device* device = immutable_state_.params().device;
   const bool is_expensive = kernel_stats_->IsExpensive(item);
+  const uint64 start_usecs =
+      latency_breakdown_ != nullptr ? EnvTime::NowMicros() : 0;
 
   if (TF_PREDICT_FALSE(MightTrace(event_collector_, is_expensive))) {
     tracing::ScopedRegion region(tracing::EventCategory::kCompute,
@@ -594,7 +837,12 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
               ctx, /*verbose=*/profiler::TfOpDetailsEnabled());
         },
         profiler::GetTFTraceMeLevel(is_expensive));
+    profiler::ScopedPerfCounters perf_counters;
     device->Compute(op_kernel, &ctx);
+    if (TF_PREDICT_FALSE(perf_counters.valid())) {
+      activity.AppendMetadata(
+          [&perf_counters] { return perf_counters.EncodeDeltas(); });
+    }
   } else if (kernel_stats_->HasExpensiveMarker(item)) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
@@ -609,6 +857,9 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   } else {
     device->Compute(op_kernel, &ctx);
   }
+  if (TF_PREDICT_FALSE(latency_breakdown_ != nullptr)) {
+    latency_breakdown_->AddKernelUsecs(EnvTime::NowMicros() - start_usecs);
+  }
   nodestats::SetOpEnd(stats);
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
@@ -632,6 +883,11 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
     Entry* first_input = state->first_input;       // Shorthand
 
     nodestats::SetOpEnd(stats);
+    if (TF_PREDICT_FALSE(latency_breakdown_ != nullptr) &&
+        state->item->is_transfer_node) {
+      latency_breakdown_->AddRecvWaitUsecs(EnvTime::NowMicros() -
+                                           state->start_usecs);
+    }
     EntryVector outputs(state->item->num_outputs);
     Status s = ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
     nodestats::SetMemory(stats, &state->ctx);
@@ -659,6 +915,9 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
     if (completed) ScheduleFinish();
   };
   nodestats::SetOpStart(stats);
+  if (TF_PREDICT_FALSE(latency_breakdown_ != nullptr)) {
+    state->start_usecs = EnvTime::NowMicros();
+  }
   {
     profiler::AnnotatedTraceMe activity(
         [async_kernel, state] {
@@ -738,6 +997,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params.runner = &runner_;
   params.run_all_kernels_inline = run_all_kernels_inline_;
   params.stats_collector = stats_collector_;
+  params.latency_breakdown = latency_breakdown_;
   params.inc_num_deferred_ops_function = [this]() {
     mutex_lock lock(num_deferred_ops_mu_);
     num_deferred_ops_++;
@@ -759,6 +1019,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
 
   // Set the device_context for this device, if it exists.
   params.op_device_context = device_context_;
+  const bool has_device_context_map = immutable_state_.has_device_context_map();
 
   Status s;
   NodeExecStatsInterface* stats = nullptr;
@@ -792,6 +1053,12 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
     inline_ready->pop_front();
     const NodeItem& item = tagged_node.get_node_item();
     const int id = item.node_id;
+    if (has_device_context_map) {
+      DeviceContext* node_device_context = immutable_state_.device_context(id);
+      params.op_device_context = node_device_context != nullptr
+                                     ? node_device_context
+                                     : device_context_;
+    }
 
     propagator_.MaybeMarkStarted(tagged_node);
     const activity_watcher::ActivityId activity_id =
@@ -812,6 +1079,8 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
             /*level=*/2);
 
     params.track_allocations = false;
+    params.step_allocator =
+        item.outputs_are_step_local ? step_arena_ : nullptr;
     stats = nullptr;
     if (stats_collector_ && !tagged_node.get_is_dead()) {
       stats = stats_collector_->CreateNodeExecStats(&item.kernel->def());
@@ -821,6 +1090,18 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
       nodestats::SetScheduled(stats, scheduled_nsec);
       nodestats::SetAllStart(stats);
     }
+    // Planned buffers bypass the allocator that tracking would wrap.
+    params.output_allocator_array =
+        planned_memory_ && !params.track_allocations
+            ? planned_memory_->OutputAllocators(id)
+            : nullptr;
+    if (!retval_output_allocators_.empty() && !params.track_allocations) {
+      // Retvals are never planned, since they outlive the step.
+      auto it = retval_output_allocators_.find(id);
+      if (it != retval_output_allocators_.end()) {
+        params.output_allocator_array = it->second.data();
+      }
+    }
 
     if (vlog_) {
       VLOG(1) << "Process node: " << id << " step " << params.step_id << " "
@@ -1255,11 +1536,35 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     TaggedNodeSeq expensive_nodes;
-    if (inline_ready == nullptr) {
-      // Schedule to run all the ready ops in thread pool.
+    if (inline_ready == nullptr && work_queues_) {
+      PushToWorkQueues(*ready, scheduled_nsec);
+    } else if (inline_ready == nullptr) {
+      // Schedule to run all the expensive ready ops in thread pool, and batch
+      // the inexpensive ones into a single closure to avoid paying for one
+      // threadpool handoff per cheap kernel.
+      TaggedNodeSeq inexpensive_nodes;
       for (auto& tagged_node : *ready) {
+        const NodeItem& item = *tagged_node.node_item;
+        if (tagged_node.get_is_dead() || !kernel_stats_->IsExpensive(item)) {
+          inexpensive_nodes.push_back(tagged_node);
+        } else {
+          RunTask([=]() { Process(tagged_node, scheduled_nsec); },
+                  /*sample_rate=*/ready->size());
+        }
+      }
+      if (inexpensive_nodes.size() == 1) {
+        const TaggedNode tagged_node = inexpensive_nodes.front();
         RunTask([=]() { Process(tagged_node, scheduled_nsec); },
                 /*sample_rate=*/ready->size());
+      } else if (!inexpensive_nodes.empty()) {
+        RunTask([this, inexpensive_nodes = std::move(inexpensive_nodes),
+                 scheduled_nsec]() {
+          TaggedNodeReadyQueue batch_ready;
+          for (auto& tagged_node : inexpensive_nodes) {
+            batch_ready.push_back(tagged_node);
+          }
+          ProcessInline(&batch_ready, scheduled_nsec);
+        });
       }
     } else {
       for (auto& tagged_node : *ready) {
@@ -1285,7 +1590,11 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       }
     }
     if (!expensive_nodes.empty()) {
-      if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
+      if (work_queues_) {
+        // Pushing to the work-stealing queues is cheap, so there is no need
+        // to split large batches across child threads.
+        PushToWorkQueues(expensive_nodes, scheduled_nsec);
+      } else if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
         for (auto& tagged_node : expensive_nodes) {
           RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
                             scheduled_nsec),
@@ -1329,6 +1638,75 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::PushToWorkQueues(
+    const TaggedNodeSeq& nodes, int64_t scheduled_nsec) {
+  DCHECK(work_queues_ != nullptr);
+  // Hold an extra outstanding op while pushing: once a node is in a queue, any
+  // worker may run it, and without this the step could complete and delete
+  // `this` before we finish waking up workers.
+  num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+
+  const int worker = current_work_stealing_worker.queues == work_queues_.get()
+                         ? current_work_stealing_worker.index
+                         : -1;
+  for (const TaggedNode& tagged_node : nodes) {
+    if (!work_queues_->Push(worker, tagged_node)) {
+      // The queue is full, so fall back to the inter-op threadpool.
+      RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
+                        scheduled_nsec),
+              /*sample_rate=*/nodes.size());
+    }
+  }
+
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  // Wake up one idle worker per pushed node. A worker checks all queues again
+  // after releasing its slot, so nodes pushed while every slot is taken will
+  // not be stranded.
+  const bool record_scheduled_time = stats_collector_ != nullptr;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    const int new_worker = work_queues_->TryClaimWorker();
+    if (new_worker < 0) break;
+    RunTask(
+        [this, queues = work_queues_, new_worker, record_scheduled_time]() {
+          RunWorker(this, std::move(queues), new_worker,
+                    record_scheduled_time);
+        },
+        /*sample_rate=*/nodes.size());
+  }
+
+  if (num_outstanding_ops_.fetch_sub(1) == 1) ScheduleFinish();
+}
+
+// static
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::RunWorker(
+    ExecutorState* state, std::shared_ptr<WorkQueues> queues, int worker,
+    bool record_scheduled_time) {
+  profiler::TraceMe activity(
+      [&]() {
+        return strings::StrCat("ExecutorState::RunWorker#worker=", worker, "#");
+      },
+      profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+  // Executors may be nested on the same thread, e.g. when a function is run
+  // inline, so restore the enclosing worker slot when we are done.
+  const WorkStealingWorkerSlot enclosing_slot = current_work_stealing_worker;
+  TaggedNode tagged_node;
+  while (worker >= 0) {
+    current_work_stealing_worker = {queues.get(), worker};
+    while (queues->Pop(worker, &tagged_node)) {
+      state->Process(tagged_node,
+                     record_scheduled_time ? nodestats::NowInNsec() : 0);
+    }
+    current_work_stealing_worker = enclosing_slot;
+    queues->ReleaseWorker(worker);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // A node may have been pushed after the last `Pop()` while this slot was
+    // still claimed, in which case the pusher did not wake up a new worker.
+    worker = queues->Empty() ? -1 : queues->TryClaimWorker();
+  }
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleFinish() {
   // Checks condition to decide if needs to invoke Finish(). If there are
@@ -1466,15 +1844,22 @@ void ExecutorState<PropagatorStateType>::Finish() {
 
 void ExecutorImpl::RunAsync(const Args& args, DoneCallback done) {
   if (OpOrderDeterminismRequired()) {
-    (new ExecutorState<OrderedPropagatorState>(args, immutable_state_,
-                                               &kernel_stats_))
+    // Op order determinism requires a single global ready queue, so work
+    // stealing is disabled.
+    (new ExecutorState<OrderedPropagatorState>(
+         args, immutable_state_, &kernel_stats_,
+         /*num_work_stealing_workers=*/0, memory_plan_.get(),
+         retval_producers_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(
+         args, immutable_state_, &kernel_stats_, num_work_stealing_workers_,
+         memory_plan_.get(), retval_producers_))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, num_work_stealing_workers_,
+         memory_plan_.get(), retval_producers_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1528,6 +1913,30 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers the "WORK_STEALING_EXECUTOR", a variant of the default executor
+// that dispatches ready nodes through per-worker work-stealing queues instead
+// of handing each of them to the inter-op threadpool. This reduces contention
+// on the threadpool queue for wide graphs on hosts with many cores.
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING_EXECUTOR", new Factory());
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl = std::make_unique<ExecutorImpl>(params,
+                                                 /*use_work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
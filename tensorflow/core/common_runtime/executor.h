@@ -93,6 +93,8 @@ class Executor {
     int64_t step_id = 0;
     RendezvousInterface* rendezvous = nullptr;
     StepStatsCollectorInterface* stats_collector = nullptr;
+    // If not null, the executor adds the time spent in kernels to it.
+    LatencyBreakdownCollector* latency_breakdown = nullptr;
     CallFrameInterface* call_frame = nullptr;
     CancellationManager* cancellation_manager = nullptr;
     SessionState* session_state = nullptr;
@@ -118,6 +120,16 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If true and the executor runs on a CPU device, kernels whose outputs do
+    // not outlive the step allocate from an arena that is freed in one go at
+    // the end of the step. See StepArenaAllocator.
+    bool use_step_arena = false;
+
+    // If not null, indexed by `_Retval` index: allocators for the outputs of
+    // the nodes that produce the retvals. See
+    // FunctionLibraryRuntime::Options::retval_allocators.
+    const std::vector<Allocator*>* retval_allocators = nullptr;
   };
   typedef std::function<void(const Status&)> DoneCallback;
   virtual void RunAsync(const Args& args, DoneCallback done) = 0;
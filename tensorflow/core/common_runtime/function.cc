@@ -418,6 +418,9 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
     string executor_type;
     bool allow_small_function_optimizations = false;
     bool allow_control_flow_sync_execution = false;
+    // Whether running `graph` may use the rendezvous of the call. If not,
+    // calls with `create_rendezvous` set skip creating one.
+    bool needs_rendezvous = true;
 
     ~Item() {
       delete this->func_graph;
@@ -456,6 +459,12 @@ class FunctionLibraryRuntimeImpl : public FunctionLibraryRuntime {
       Handle handle, Options* run_opts, Item** out_item,
       std::unique_ptr<PrivateIntraProcessRendezvous>* out_rendezvous);
 
+  // If `run_opts->create_rendezvous` is set, creates the rendezvous of a call
+  // to `item`, which is null for functions of other devices, and makes `done`
+  // release it. Does nothing if `item` does not use the rendezvous.
+  void MaybeCreateRendezvous(const Item* item, Options* run_opts,
+                             DoneCallback* done);
+
   void ExecutorArgsFromOptions(const FunctionLibraryRuntime::Options& run_opts,
                                CallFrameInterface* frame,
                                Executor::Args* exec_args);
@@ -919,6 +928,24 @@ void PruneFunctionBody(const FunctionDef& fdef, Graph* g) {
   }
 }
 
+// Returns whether running `g` may use the rendezvous of the call: it does if
+// it has send or receive nodes, or nodes that call functions, since those
+// pass the rendezvous on to the functions they call.
+bool GraphNeedsRendezvous(const Graph& g,
+                          const FunctionLibraryDefinition& lib_def) {
+  for (const Node* n : g.op_nodes()) {
+    if (n->IsSend() || n->IsRecv() || lib_def.Find(n->type_string())) {
+      return true;
+    }
+    for (const auto& attr : n->attrs()) {
+      if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
 Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
@@ -977,11 +1004,13 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
                                     : "default");
 
   TF_RETURN_IF_ERROR(NewExecutor(executor_type, params, *g, &exec));
+  const bool needs_rendezvous = GraphNeedsRendezvous(*g, *lib_def);
   {
     // Guard item since it is already inserted in items_.
     mutex_lock l(mu_);
     if ((*item)->exec == nullptr) {
       (*item)->graph = std::move(g);
+      (*item)->needs_rendezvous = needs_rendezvous;
       (*item)->exec = exec.release();
     }
   }
@@ -1027,6 +1056,7 @@ void FunctionLibraryRuntimeImpl::ExecutorArgsFromOptions(
   exec_args->user_intra_op_threadpool = run_opts.user_intra_op_threadpool;
   exec_args->coordination_service_agent = run_opts.coordination_service_agent;
   exec_args->stack_trace = run_opts.stack_trace;
+  exec_args->retval_allocators = run_opts.retval_allocators;
 }
 
 void FunctionLibraryRuntimeImpl::RunRemote(const Options& opts, Handle handle,
@@ -1133,18 +1163,9 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
     return;
   }
   Options run_opts = opts;
-  if (opts.create_rendezvous) {
-    auto* rendezvous = new RefCountedIntraProcessRendezvous(device_mgr_);
-    run_opts.rendezvous = rendezvous;
-    run_opts.create_rendezvous = false;
-    done = [done = std::move(done), rendezvous](const Status& status) mutable {
-      rendezvous->Unref();
-      done(status);
-    };
-  }
-
   LocalHandle local_handle = parent_->GetHandleOnDevice(device_name_, handle);
   if (local_handle == kInvalidLocalHandle) {
+    MaybeCreateRendezvous(/*item=*/nullptr, &run_opts, &done);
     parent_->Run(run_opts, handle, args, rets, done);
     return;
   }
@@ -1160,6 +1181,8 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
     done(s);
     return;
   }
+  MaybeCreateRendezvous(run_opts.remote_execution ? nullptr : item, &run_opts,
+                        &done);
 
   if (run_opts.remote_execution) {
     // NOTE(mrry): `RunRemote()` will set `exec_args->call_frame` for us.
@@ -1213,19 +1236,10 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   }
 
   Options run_opts = opts;
-  if (opts.create_rendezvous) {
-    auto* rendezvous = new RefCountedIntraProcessRendezvous(device_mgr_);
-    run_opts.rendezvous = rendezvous;
-    run_opts.create_rendezvous = false;
-    done = [done = std::move(done), rendezvous](const Status& status) mutable {
-      rendezvous->Unref();
-      done(status);
-    };
-  }
-
   LocalHandle local_handle = parent_->GetHandleOnDevice(
       device_name_, handle, /*include_multi_device=*/true);
   if (local_handle == kInvalidLocalHandle) {
+    MaybeCreateRendezvous(/*item=*/nullptr, &run_opts, &done);
     parent_->Run(run_opts, handle, frame, done);
     return;
   }
@@ -1245,6 +1259,7 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
     done(s);
     return;
   }
+  MaybeCreateRendezvous(item, &run_opts, &done);
   if (run_opts.runner == nullptr) {
     run_opts.runner = &default_runner_;
   }
@@ -1264,6 +1279,20 @@ void FunctionLibraryRuntimeImpl::Run(const Options& opts, Handle handle,
   item->exec->RunAsync(exec_args, std::move(done));
 }
 
+void FunctionLibraryRuntimeImpl::MaybeCreateRendezvous(const Item* item,
+                                                       Options* run_opts,
+                                                       DoneCallback* done) {
+  if (!run_opts->create_rendezvous) return;
+  run_opts->create_rendezvous = false;
+  if (item != nullptr && !item->needs_rendezvous) return;
+  auto* rendezvous = new RefCountedIntraProcessRendezvous(device_mgr_);
+  run_opts->rendezvous = rendezvous;
+  *done = [done = std::move(*done), rendezvous](const Status& status) mutable {
+    rendezvous->Unref();
+    done(status);
+  };
+}
+
 Status FunctionLibraryRuntimeImpl::PrepareRunSync(
     Handle handle, Options* run_opts, Item** out_item,
     std::unique_ptr<PrivateIntraProcessRendezvous>* out_rendezvous) {
@@ -1280,21 +1309,21 @@ Status FunctionLibraryRuntimeImpl::PrepareRunSync(
     return errors::Unimplemented("Remote calling with RunSync()");
   }
 
-  if (run_opts->create_rendezvous) {
-    *out_rendezvous =
-        std::make_unique<PrivateIntraProcessRendezvous>(device_mgr_);
-    run_opts->rendezvous = out_rendezvous->get();
-    run_opts->create_rendezvous = false;
-  }
-
   LocalHandle local_handle = parent_->GetHandleOnDevice(
       device_name_, handle, /*include_multi_device=*/true);
-  if (local_handle == kInvalidLocalHandle) {
-    *out_item = nullptr;
-    return OkStatus();
+  *out_item = nullptr;
+  if (local_handle != kInvalidLocalHandle) {
+    TF_RETURN_IF_ERROR(GetOrCreateItem(local_handle, out_item));
   }
 
-  TF_RETURN_IF_ERROR(GetOrCreateItem(local_handle, out_item));
+  if (run_opts->create_rendezvous &&
+      (*out_item == nullptr || (*out_item)->needs_rendezvous)) {
+    *out_rendezvous =
+        std::make_unique<PrivateIntraProcessRendezvous>(device_mgr_);
+    run_opts->rendezvous = out_rendezvous->get();
+  }
+  run_opts->create_rendezvous = false;
+  if (*out_item == nullptr) return OkStatus();
 
   if (run_opts->runner == nullptr) {
     run_opts->runner = &default_runner_;
@@ -376,6 +376,45 @@ TEST_F(FunctionLibraryRuntimeTest, XTimesTwo) {
   test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
 }
 
+TEST_F(FunctionLibraryRuntimeTest, XTimesTwo_RetvalAllocators) {
+  // Forwards to cpu_allocator() and records the returned buffers.
+  class RecordingAllocator : public Allocator {
+   public:
+    std::string Name() override { return "recording"; }
+    void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+      void* ptr = cpu_allocator()->AllocateRaw(alignment, num_bytes);
+      mutex_lock l(mu_);
+      allocated_.push_back(ptr);
+      return ptr;
+    }
+    void DeallocateRaw(void* ptr) override {
+      cpu_allocator()->DeallocateRaw(ptr);
+    }
+    std::vector<void*> allocated() {
+      mutex_lock l(mu_);
+      return allocated_;
+    }
+
+   private:
+    mutex mu_;
+    std::vector<void*> allocated_;
+  };
+
+  Init({test::function::XTimesTwo()});
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, &handle));
+  RecordingAllocator allocator;
+  std::vector<Allocator*> retval_allocators = {&allocator};
+  FunctionLibraryRuntime::Options opts;
+  opts.retval_allocators = &retval_allocators;
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  Tensor y;
+  TF_CHECK_OK(Run(flr0_, handle, opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  // The output of `Mul` was allocated by `allocator`.
+  EXPECT_EQ(allocator.allocated(), std::vector<void*>({y.data()}));
+}
+
 TEST_F(FunctionLibraryRuntimeTest, InstantiationStackTraceCopying) {
   class DummyStackTrace : public AbstractStackTrace {
     absl::Span<StackFrame const> ToFrames() const override { return {}; }
@@ -525,6 +564,33 @@ TEST_F(FunctionLibraryRuntimeTest, XTimesN) {
   test::ExpectTensorEqual<float>(y, test::AsTensor<float>({16, 32, 48, 64}));
 }
 
+TEST_F(FunctionLibraryRuntimeTest, CreateRendezvous) {
+  Init({test::function::XTimesTwo(), test::function::XTimesFour()});
+  auto x = test::AsTensor<float>({1, 2, 3, 4});
+  FunctionLibraryRuntime::Options opts;
+  opts.create_rendezvous = true;
+
+  // XTimesTwo does not use the rendezvous, XTimesFour passes it on to the
+  // XTimesTwo calls it makes.
+  FunctionLibraryRuntime::Handle two;
+  TF_ASSERT_OK(Instantiate(flr0_, "XTimesTwo", {{"T", DT_FLOAT}}, &two));
+  FunctionLibraryRuntime::Handle four;
+  TF_ASSERT_OK(Instantiate(flr0_, "XTimesFour", {{"T", DT_FLOAT}}, &four));
+
+  Tensor y;
+  TF_ASSERT_OK(Run(flr0_, two, opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({2, 4, 6, 8}));
+  TF_ASSERT_OK(Run(flr0_, four, opts, {x}, {&y}));
+  test::ExpectTensorEqual<float>(y, test::AsTensor<float>({4, 8, 12, 16}));
+
+  std::vector<Tensor> rets;
+  TF_ASSERT_OK(flr0_->RunSync(opts, two, {x}, &rets));
+  test::ExpectTensorEqual<float>(rets[0], test::AsTensor<float>({2, 4, 6, 8}));
+  TF_ASSERT_OK(flr0_->RunSync(opts, four, {x}, &rets));
+  test::ExpectTensorEqual<float>(rets[0],
+                                 test::AsTensor<float>({4, 8, 12, 16}));
+}
+
 TEST_F(FunctionLibraryRuntimeTest, XTimesNInLibDef) {
   Init({});
   FunctionDefLibrary proto;
@@ -28,8 +28,10 @@ limitations under the License.
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <list>
 #include <map>
+#include <memory>
 #include <optional>
 #include <tuple>
 #include <vector>
@@ -42,8 +44,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_bfc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -54,6 +58,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
+#include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -381,6 +386,105 @@ class BaseGPUDevice::StreamGroupFactory {
   TF_DISALLOW_COPY_AND_ASSIGN(StreamGroupFactory);
 };
 
+// Defers deallocations until every compute stream of the device has completed
+// the work that was enqueued before the deallocation. With one compute stream,
+// stream order guarantees that a kernel that reuses a buffer runs after all
+// kernels that used it. With several compute streams, a kernel on another
+// stream could otherwise overwrite the buffer while it is still being read.
+class BaseGPUDevice::DeferredDeallocAllocator : public Allocator {
+ public:
+  // Does not take ownership of 'allocator', 'compute_streams' or 'em', which
+  // must outlive all deferred deallocations.
+  DeferredDeallocAllocator(Allocator* allocator,
+                           gtl::InlinedVector<se::Stream*, 4> compute_streams,
+                           EventMgr* em)
+      : allocator_(allocator),
+        compute_streams_(std::move(compute_streams)),
+        em_(em) {}
+
+  ~DeferredDeallocAllocator() override { Flush(); }
+
+  std::string Name() override { return allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    AllocationAttributes no_retry_attr = allocation_attr;
+    no_retry_attr.retry_on_failure = false;
+    void* ptr = allocator_->AllocateRaw(alignment, num_bytes, no_retry_attr);
+    if (ptr == nullptr && allocation_attr.retry_on_failure) {
+      // Release the deferred deallocations, which the allocator waits for
+      // while it retries.
+      Flush();
+      ptr = allocator_->AllocateRaw(alignment, num_bytes, allocation_attr);
+    }
+    return ptr;
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    mutex_lock l(mu_);
+    pending_.push_back(ptr);
+  }
+
+  // Deallocates the pending buffers once all compute streams have completed
+  // the work enqueued so far.
+  void Flush() {
+    std::shared_ptr<Batch> batch;
+    {
+      mutex_lock l(mu_);
+      if (pending_.empty()) return;
+      batch = std::make_shared<Batch>(compute_streams_.size());
+      batch->ptrs.swap(pending_);
+    }
+    Allocator* allocator = allocator_;
+    for (se::Stream* stream : compute_streams_) {
+      em_->ThenExecute(stream, [allocator, batch]() {
+        if (batch->pending_streams.fetch_sub(1) == 1) {
+          for (void* ptr : batch->ptrs) allocator->DeallocateRaw(ptr);
+        }
+      });
+    }
+  }
+
+  bool TracksAllocationSizes() const override {
+    return allocator_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return allocator_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return allocator_->AllocatedSize(ptr);
+  }
+  int64_t AllocationId(const void* ptr) const override {
+    return allocator_->AllocationId(ptr);
+  }
+  absl::optional<AllocatorStats> GetStats() override {
+    return allocator_->GetStats();
+  }
+  bool ClearStats() override { return allocator_->ClearStats(); }
+  AllocatorMemoryType GetMemoryType() const override {
+    return allocator_->GetMemoryType();
+  }
+
+ private:
+  struct Batch {
+    explicit Batch(int num_streams) : pending_streams(num_streams) {}
+    std::atomic<int> pending_streams;
+    std::vector<void*> ptrs;
+  };
+
+  Allocator* const allocator_;  // Not owned.
+  const gtl::InlinedVector<se::Stream*, 4> compute_streams_;
+  EventMgr* const em_;  // Not owned.
+  mutex mu_;
+  std::vector<void*> pending_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(DeferredDeallocAllocator);
+};
+
 BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
                              Bytes memory_limit, const DeviceLocality& locality,
                              tsl::TfDeviceId tf_device_id,
@@ -403,15 +507,19 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
 
 BaseGPUDevice::~BaseGPUDevice() {
   delete accelerator_device_info_;
-  if (scratch_) gpu_allocator_->DeallocateRaw(scratch_);
+  for (char* scratch : scratch_) gpu_allocator_->DeallocateRaw(scratch);
   device_context_->Unref();
+  mutex_lock l(device_contexts_mu_);
+  for (auto& item : device_contexts_) item.second->Unref();
 }
 
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
-  if (!scratch_) {
-    DCHECK(stream_);
+  DCHECK(stream_);
+  // Each compute stream needs its own scratch buffer, since the semaphore in
+  // it is only valid while one kernel uses it at a time.
+  while (scratch_.size() < stream_groups_.size()) {
     size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
     profiler::ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
     void* scratch_buffer = gpu_allocator_->AllocateRaw(
@@ -423,9 +531,13 @@ Status BaseGPUDevice::InitScratchBuffers() {
     }
     se::DeviceMemory<char> mem(
         se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
-    TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
-        &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    Status status = executor_->SynchronousMemZero(
+        &mem, Eigen::kGpuScratchSize + sizeof(unsigned int));
+    if (!status.ok()) {
+      gpu_allocator_->DeallocateRaw(scratch_buffer);
+      return status;
+    }
+    scratch_.push_back(static_cast<char*>(scratch_buffer));
   }
   return OkStatus();
 }
@@ -442,6 +554,7 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
 
   stream_ = StreamGroupFactory::Global().GetOrCreate(
       tf_device_id_, 0, executor_, options.config.gpu_options());
+  stream_groups_.push_back(stream_);
 
   // Get an allocator that allocates pinned memory on host.
   AllocatorAttributes attr;
@@ -456,6 +569,9 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
 #endif
                            stream_->host_to_device, stream_->device_to_host,
                            stream_->device_to_device, host_memory_allocator);
+  device_context_->set_host_staging_ring(
+      GPUProcessState::singleton()->GetGpuHostStagingRing(
+          options.config.gpu_options(), attributes().locality().numa_node()));
 
   em_ = EventMgrFactory::Singleton()->GetEventMgr(executor_,
                                                   options.config.gpu_options());
@@ -485,6 +601,43 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
   }
 
+  int num_compute_streams =
+      options.config.gpu_options().experimental().num_compute_streams();
+  if (num_compute_streams == 0) num_compute_streams = 1;
+  constexpr int kMaxComputeStreams = 8;
+  if (num_compute_streams < 1 || num_compute_streams > kMaxComputeStreams) {
+    LOG(ERROR) << "Illegal GPUOptions.experimental.num_compute_streams="
+               << num_compute_streams << " set to 1 instead.";
+    num_compute_streams = 1;
+  }
+  if (num_compute_streams > 1 && kernel_tracker_) {
+    // The kernel tracker and the timestamped allocator only know about the
+    // primary compute stream.
+    LOG(WARNING) << "Ignoring GPUOptions.experimental.num_compute_streams="
+                 << num_compute_streams
+                 << " because kernel tracking is enabled.";
+    num_compute_streams = 1;
+  }
+  for (int i = 1; i < num_compute_streams; ++i) {
+    stream_groups_.push_back(StreamGroupFactory::Global().GetOrCreate(
+        tf_device_id_, i, executor_, options.config.gpu_options()));
+  }
+  if (stream_groups_.size() > 1) {
+    gtl::InlinedVector<se::Stream*, 4> compute_streams;
+    for (const StreamGroup* group : stream_groups_) {
+      compute_streams.push_back(group->compute);
+    }
+    deferred_dealloc_allocator_ = std::make_unique<DeferredDeallocAllocator>(
+        gpu_allocator_, std::move(compute_streams), em_);
+    gpu_allocator_ = deferred_dealloc_allocator_.get();
+    VLOG(1) << "Using " << stream_groups_.size() << " compute streams on "
+            << name();
+  }
+  if (options.config.gpu_options().experimental().defragment_gpu_memory()) {
+    defragment_allocator_ =
+        GPUProcessState::singleton()->GetGPUBFCAllocator(tf_device_id_);
+  }
+
   accelerator_device_info_ = new DeviceBase::AcceleratorDeviceInfo;
   accelerator_device_info_->stream = stream_->compute;
   accelerator_device_info_->default_context = device_context_;
@@ -677,7 +830,9 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
     LogInputs(op_kernel, context);
   }
 
+  WaitForStreams(gpu_device_context);
   op_kernel->Compute(context);
+  if (deferred_dealloc_allocator_) deferred_dealloc_allocator_->Flush();
 
   if (should_log_inputs_and_outputs) {
     LogOutputs(op_kernel, context);
@@ -732,7 +887,45 @@ Status BaseGPUDevice::Sync() {
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  for (StreamGroup* group : stream_groups_) {
+    TF_RETURN_IF_ERROR(group->compute->BlockHostUntilDone());
+  }
+  if (deferred_dealloc_allocator_) deferred_dealloc_allocator_->Flush();
+  if (defragment_allocator_ != nullptr) MaybeDefragmentMemory();
+  return OkStatus();
+}
+
+void BaseGPUDevice::MaybeDefragmentMemory() {
+  // Only defragment when at least half of the free memory is not part of the
+  // largest free chunk.
+  constexpr double kMinFragmentation = 0.5;
+  absl::optional<AllocatorStats> stats = defragment_allocator_->GetStats();
+  if (!stats || stats->fragmentation < kMinFragmentation) return;
+  if (defragmentation_pending_.exchange(true)) return;
+
+  struct Reservation {
+    explicit Reservation(int num_streams) : pending_streams(num_streams) {}
+    std::vector<void*> ptrs;
+    std::atomic<int> pending_streams;
+  };
+  auto reservation = std::make_shared<Reservation>(stream_groups_.size());
+  reservation->ptrs = defragment_allocator_->ReserveFreeGranules();
+  if (reservation->ptrs.empty()) {
+    defragmentation_pending_ = false;
+    return;
+  }
+  // Kernels that used the reserved memory before it was freed may still be
+  // running, and unmapping it is not ordered with respect to the streams.
+  GPUBFCAllocator* allocator = defragment_allocator_;
+  std::atomic<bool>* pending = &defragmentation_pending_;
+  for (StreamGroup* group : stream_groups_) {
+    em_->ThenExecute(group->compute, [allocator, pending, reservation]() {
+      if (reservation->pending_streams.fetch_sub(1) == 1) {
+        allocator->ReleaseReservedGranules(reservation->ptrs);
+        *pending = false;
+      }
+    });
+  }
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
@@ -763,7 +956,76 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
   }
 
   ScopedActivateExecutorContext scoped_activation{stream->parent()};
+  WaitForStreams(gpu_device_context);
   op_kernel->ComputeAsync(context, std::move(done));
+  if (deferred_dealloc_allocator_) deferred_dealloc_allocator_->Flush();
+}
+
+void BaseGPUDevice::WaitForStreams(const GPUDeviceContext* context) {
+  for (se::Stream* wait_stream : context->wait_streams()) {
+    context->stream()->ThenWaitFor(wait_stream);
+  }
+}
+
+GPUDeviceContext* BaseGPUDevice::GetOrCreateDeviceContext(int stream_id,
+                                                          uint32 wait_mask) {
+  mutex_lock l(device_contexts_mu_);
+  GPUDeviceContext*& context = device_contexts_[{stream_id, wait_mask}];
+  if (context == nullptr) {
+    const StreamGroup* group = stream_groups_[stream_id];
+    context = new GPUDeviceContext(
+        stream_id, group->compute,
+#if TENSORFLOW_USE_ROCM
+        group->nccl,
+#endif
+        group->host_to_device, group->device_to_host, group->device_to_device,
+        device_context_->host_memory_allocator());
+    context->set_host_staging_ring(device_context_->host_staging_ring());
+    gtl::InlinedVector<se::Stream*, 4> wait_streams;
+    for (int i = 0; i < static_cast<int>(stream_groups_.size()); ++i) {
+      if (wait_mask & (1u << i)) {
+        wait_streams.push_back(stream_groups_[i]->compute);
+      }
+    }
+    context->set_wait_streams(std::move(wait_streams));
+  }
+  return context;
+}
+
+Status BaseGPUDevice::FillContextMap(
+    const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+  if (stream_groups_.size() <= 1) return OkStatus();
+
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = stream_groups_.size();
+  std::vector<int> node_to_stream_id;
+  TF_RETURN_IF_ERROR(
+      gpu_stream_util::AssignStreams(graph, opts, &node_to_stream_id));
+
+  device_context_map->assign(graph->num_node_ids(), nullptr);
+  int num_nodes_off_default_stream = 0;
+  for (const Node* n : graph->op_nodes()) {
+    const int stream_id = node_to_stream_id[n->id()];
+    // A node waits for every compute stream that one of its inputs was
+    // produced on. Constants are computed once and cached by the executor.
+    uint32 wait_mask = 0;
+    for (const Edge* e : n->in_edges()) {
+      const Node* src = e->src();
+      if (!src->IsOp() || src->IsConstant()) continue;
+      const int src_stream_id = node_to_stream_id[src->id()];
+      if (src_stream_id != stream_id) wait_mask |= 1u << src_stream_id;
+    }
+    if (stream_id == 0 && wait_mask == 0) continue;
+    if (stream_id != 0) ++num_nodes_off_default_stream;
+    GPUDeviceContext* context = GetOrCreateDeviceContext(stream_id, wait_mask);
+    context->Ref();
+    (*device_context_map)[n->id()] = context;
+  }
+  VLOG(1) << "Assigned " << num_nodes_off_default_stream << " of "
+          << graph->num_op_nodes() << " nodes to the "
+          << stream_groups_.size() - 1 << " additional compute streams of "
+          << name();
+  return OkStatus();
 }
 
 Status BaseGPUDevice::MaybeCopyTensorToGPU(
@@ -1157,11 +1419,12 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
+  DCHECK_LT(stream_id, static_cast<int>(stream_groups_.size()));
   const gpuStream_t* gpu_stream = reinterpret_cast<const gpuStream_t*>(
-      stream_->compute->implementation()->GpuStreamMemberHack());
+      stream_groups_[stream_id]->compute->implementation()
+          ->GpuStreamMemberHack());
   concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
-                                scratch_);
+                                scratch_[stream_id]);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1178,7 +1441,7 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
+    CHECK_LT(stream_id, static_cast<int>(stream_groups_.size()));
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
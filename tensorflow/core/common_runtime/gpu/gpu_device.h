@@ -20,6 +20,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_DEVICE_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_DEVICE_H_
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <set>
@@ -28,6 +29,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/common_runtime/device_factory.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -54,6 +56,7 @@ class StreamInterface;
 }
 
 namespace tensorflow {
+class GPUBFCAllocator;
 class GPUKernelTracker;
 
 class ConcretePerOpGpuDevice : public PerOpGpuDevice {
@@ -110,6 +113,12 @@ class BaseGPUDevice : public LocalDevice {
                                DeviceContext* dc,
                                Allocator* allocator) override;
 
+  // Assigns the nodes of 'graph' to compute streams if the device has more
+  // than one. See GPUOptions.Experimental.num_compute_streams.
+  Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override;
+
   // Returns the platform GPU id of this device within the native driver system;
   // e.g., for CUDA and ROCm this is the ordinal of the GPU within the system.
   int gpu_id() const {
@@ -170,11 +179,23 @@ class BaseGPUDevice : public LocalDevice {
     int priority = 0;
   };
   class StreamGroupFactory;
+  class DeferredDeallocAllocator;
 
   StreamGroup* stream_;
+  // The stream groups of all compute streams, starting with 'stream_'.
+  gtl::InlinedVector<StreamGroup*, 4> stream_groups_;
   mutex scratch_init_mutex_;
-  char* scratch_ = nullptr;
+  // The scratch buffer used by Eigen on each compute stream.
+  gtl::InlinedVector<char*, 4> scratch_;
   GPUDeviceContext* device_context_;
+  // Set if there is more than one compute stream. Wraps the allocator that
+  // 'gpu_allocator_' was constructed with, and replaces it.
+  std::unique_ptr<DeferredDeallocAllocator> deferred_dealloc_allocator_;
+  mutex device_contexts_mu_;
+  // The contexts handed out by FillContextMap(), keyed by compute stream and
+  // by the mask of the other compute streams that they wait for.
+  absl::flat_hash_map<std::pair<int, uint32>, GPUDeviceContext*>
+      device_contexts_ TF_GUARDED_BY(device_contexts_mu_);
   DeviceBase::AcceleratorDeviceInfo* accelerator_device_info_ = nullptr;
   mutex trace_mu_;
   tsl::TfDeviceId tf_device_id_;
@@ -185,6 +206,10 @@ class BaseGPUDevice : public LocalDevice {
   int32 pending_cap_ = 0;
   bool timestamped_allocator_ = false;
   NodeFileWriter* node_file_writer_ = nullptr;  // not owned
+  // Set if GPUOptions.experimental.defragment_gpu_memory is enabled and the
+  // allocator supports it.
+  GPUBFCAllocator* defragment_allocator_ = nullptr;  // not owned
+  std::atomic<bool> defragmentation_pending_{false};
 
   // Initialize scratch buffers used by Eigen.
   Status InitScratchBuffers();
@@ -192,6 +217,19 @@ class BaseGPUDevice : public LocalDevice {
   void ReinitializeDevice(OpKernelContext* context, PerOpGpuDevice* device,
                           int stream_id, Allocator* allocator);
 
+  // Returns a context that runs kernels on compute stream 'stream_id' after
+  // waiting for the compute streams in 'wait_mask'. The device keeps the
+  // reference.
+  GPUDeviceContext* GetOrCreateDeviceContext(int stream_id, uint32 wait_mask);
+
+  // Makes the stream of 'gpu_device_context' wait for the streams it depends
+  // on.
+  void WaitForStreams(const GPUDeviceContext* gpu_device_context);
+
+  // Returns the free memory of a fragmented allocator to its sub-allocator
+  // once the compute streams have completed the work enqueued so far.
+  void MaybeDefragmentMemory();
+
   std::string ComputeOpKernelDebugString(const OpKernel& op_kernel,
                                          const int& stream_id);
 
@@ -0,0 +1,58 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/gpu/gpu_host_staging_ring.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+GpuHostStagingRing::GpuHostStagingRing(Allocator* host_allocator,
+                                       int num_buffers, size_t buffer_bytes)
+    : host_allocator_(host_allocator), buffer_bytes_(buffer_bytes) {
+  mutex_lock l(mu_);
+  for (int i = 0; i < num_buffers; ++i) {
+    void* buffer = host_allocator_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                                buffer_bytes_);
+    if (buffer == nullptr) {
+      LOG(WARNING) << "Created " << i << " of " << num_buffers
+                   << " host staging buffers of " << buffer_bytes_
+                   << " bytes.";
+      break;
+    }
+    free_buffers_.push_back(buffer);
+  }
+  num_buffers_ = free_buffers_.size();
+}
+
+GpuHostStagingRing::~GpuHostStagingRing() {
+  mutex_lock l(mu_);
+  DCHECK_EQ(static_cast<int>(free_buffers_.size()), num_buffers_);
+  for (void* buffer : free_buffers_) host_allocator_->DeallocateRaw(buffer);
+}
+
+void* GpuHostStagingRing::TryAcquire() {
+  mutex_lock l(mu_);
+  if (free_buffers_.empty()) return nullptr;
+  void* buffer = free_buffers_.back();
+  free_buffers_.pop_back();
+  return buffer;
+}
+
+void GpuHostStagingRing::Release(void* buffer) {
+  mutex_lock l(mu_);
+  free_buffers_.push_back(buffer);
+}
+
+}  // namespace tensorflow
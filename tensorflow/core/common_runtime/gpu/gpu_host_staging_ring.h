@@ -0,0 +1,70 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_STAGING_RING_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_STAGING_RING_H_
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A fixed set of equally sized pinned host buffers for staging host-to-device
+// copies of pageable tensors.
+//
+// A copy through the ring is split into chunks of at most buffer_bytes(). Each
+// chunk is copied into a free buffer and its transfer is enqueued before the
+// next chunk is copied, so the host memcpy of a chunk overlaps the DMA of the
+// previous one. A buffer is released once its transfer has completed.
+// Acquiring never blocks: when all buffers are in use the caller falls back to
+// allocating its staging memory.
+class GpuHostStagingRing {
+ public:
+  // Allocates 'num_buffers' buffers of 'buffer_bytes' from 'host_allocator',
+  // which must outlive this object. Fewer buffers are created if an allocation
+  // fails.
+  GpuHostStagingRing(Allocator* host_allocator, int num_buffers,
+                     size_t buffer_bytes);
+
+  // REQUIRES: All buffers have been released.
+  ~GpuHostStagingRing();
+
+  size_t buffer_bytes() const { return buffer_bytes_; }
+  int num_buffers() const { return num_buffers_; }
+
+  // Returns a free buffer of buffer_bytes(), or nullptr if none is free.
+  void* TryAcquire() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns 'buffer', which must have been returned by TryAcquire(), to the
+  // ring.
+  void Release(void* buffer) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  Allocator* const host_allocator_;  // Not owned.
+  const size_t buffer_bytes_;
+  int num_buffers_ = 0;
+
+  mutex mu_;
+  std::vector<void*> free_buffers_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuHostStagingRing);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_HOST_STAGING_RING_H_
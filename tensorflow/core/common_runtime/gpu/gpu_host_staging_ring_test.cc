@@ -0,0 +1,53 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/gpu/gpu_host_staging_ring.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(GpuHostStagingRingTest, AcquireAndRelease) {
+  GpuHostStagingRing ring(cpu_allocator(), /*num_buffers=*/2,
+                          /*buffer_bytes=*/1024);
+  EXPECT_EQ(ring.num_buffers(), 2);
+  EXPECT_EQ(ring.buffer_bytes(), 1024);
+  void* a = ring.TryAcquire();
+  void* b = ring.TryAcquire();
+  ASSERT_NE(a, nullptr);
+  ASSERT_NE(b, nullptr);
+  EXPECT_NE(a, b);
+  // Acquiring does not block when the ring is exhausted.
+  EXPECT_EQ(ring.TryAcquire(), nullptr);
+  ring.Release(a);
+  EXPECT_EQ(ring.TryAcquire(), a);
+  ring.Release(a);
+  ring.Release(b);
+}
+
+TEST(GpuHostStagingRingTest, BuffersAreUsable) {
+  GpuHostStagingRing ring(cpu_allocator(), /*num_buffers=*/1,
+                          /*buffer_bytes=*/256);
+  char* buffer = static_cast<char*>(ring.TryAcquire());
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_EQ(
+      reinterpret_cast<uintptr_t>(buffer) % Allocator::kAllocatorAlignment, 0);
+  for (int i = 0; i < 256; ++i) buffer[i] = i;
+  EXPECT_EQ(buffer[255], static_cast<char>(255));
+  ring.Release(buffer);
+}
+
+}  // namespace
+}  // namespace tensorflow
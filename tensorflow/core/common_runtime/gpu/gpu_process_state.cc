@@ -133,13 +133,15 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
 
     // Adjust virtual address space to be slightly larger than the physical
     // address space in case the BFC allocator performs suboptimal garbage
-    // collection.
+    // collection. Defragmentation leaves holes in the va space that are only
+    // re-used once its end is reached, so reserve more in that case.
     // TODO(imintz): Update BFC allocator to ensure it doesn't create holes in
     // the va space.
+    const bool defragment = options.experimental().defragment_gpu_memory();
     return GpuVirtualMemAllocator::Create(
                alloc_visitors, {}, *gpu_context, platform_device_id,
-               /*virtual_address_space_size=*/total_bytes * 2,
-               platform_peer_gpu_ids_vec)
+               /*virtual_address_space_size=*/total_bytes * (defragment ? 4 : 2),
+               platform_peer_gpu_ids_vec, /*allow_partial_free=*/defragment)
         .value()
         .release();
   }
@@ -197,6 +199,18 @@ Allocator* GPUProcessState::GetGPUAllocator(
               !options.experimental().disallow_retry_on_allocation_failure();
           o.fragmentation_fraction =
               options.experimental().internal_fragmentation_fraction();
+#if GOOGLE_CUDA && CUDA_VERSION >= 10020
+          if (options.experimental().defragment_gpu_memory()) {
+            auto* vmem_allocator =
+                dynamic_cast<GpuVirtualMemAllocator*>(sub_allocator_ptr);
+            if (vmem_allocator != nullptr) {
+              o.defragmentation_granularity = vmem_allocator->granularity();
+            } else {
+              LOG(WARNING) << "defragment_gpu_memory requires the virtual "
+                              "memory allocator; ignoring it.";
+            }
+          }
+#endif  // GOOGLE_CUDA && CUDA_VERSION >= 10020
           return o;
         }());
     Allocator* gpu_allocator = gpu_bfc_allocator.get();
@@ -264,6 +278,15 @@ Allocator* GPUProcessState::GetGPUAllocator(
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+GPUBFCAllocator* GPUProcessState::GetGPUBFCAllocator(
+    tsl::TfDeviceId tf_device_id) {
+  mutex_lock l(mu_);
+  if (tf_device_id.value() >= static_cast<int64_t>(gpu_allocators_.size())) {
+    return nullptr;
+  }
+  return gpu_allocators_[tf_device_id.value()].bfc_allocator;
+}
+
 SharedCounter* GPUProcessState::GPUAllocatorCounter(
     tsl::TfDeviceId tf_device_id) {
   DCHECK(process_state_);
@@ -446,6 +469,28 @@ void GPUProcessState::AddGpuHostFreeVisitor(
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 }
 
+GpuHostStagingRing* GPUProcessState::GetGpuHostStagingRing(
+    const GPUOptions& options, int numa_node) {
+  CHECK(process_state_);
+  const int num_buffers = options.experimental().num_host_staging_buffers();
+  if (num_buffers <= 0 || !HasGPUDevice() ||
+      !process_state_->ProcessState::FLAGS_brain_mem_reg_gpu_dma) {
+    return nullptr;
+  }
+  Allocator* host_allocator = GetGpuHostAllocator(options, numa_node);
+  mutex_lock lock(mu_);
+  if (!gpu_host_staging_ring_created_) {
+    gpu_host_staging_ring_created_ = true;
+    int64_t buffer_kb = options.experimental().host_staging_buffer_size_kb();
+    if (buffer_kb <= 0) buffer_kb = 4096;
+    gpu_host_staging_ring_ = std::make_unique<GpuHostStagingRing>(
+        host_allocator, num_buffers, buffer_kb * 1024);
+    VLOG(1) << "Created " << gpu_host_staging_ring_->num_buffers()
+            << " host staging buffers of " << buffer_kb << " KiB";
+  }
+  return gpu_host_staging_ring_.get();
+}
+
 void GPUProcessState::TestOnlyReset() {
   if (process_state_) {
     process_state_->ProcessState::TestOnlyReset();
@@ -453,6 +498,9 @@ void GPUProcessState::TestOnlyReset() {
   {
     mutex_lock lock(mu_);
     gpu_device_enabled_ = false;
+    // The staging buffers are returned to the host allocator.
+    gpu_host_staging_ring_.reset();
+    gpu_host_staging_ring_created_ = false;
     gpu_allocators_.clear();
     gpu_visitors_.clear();
     gpu_host_allocators_.clear();
@@ -22,6 +22,7 @@ limitations under the License.
 #include <unordered_map>
 #include <vector>
 
+#include "tensorflow/core/common_runtime/gpu/gpu_host_staging_ring.h"
 #include "tensorflow/core/common_runtime/process_state.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -92,6 +93,10 @@ class GPUProcessState {
                            /*peer_gpu_ids=*/{});
   }
 
+  // Returns the BFC allocator of GPU 'tf_device_id', or nullptr if it has not
+  // been created or the GPU does not use one.
+  GPUBFCAllocator* GetGPUBFCAllocator(tsl::TfDeviceId tf_device_id);
+
   int NumGPUAllocators() {
     mutex_lock l(mu_);
     return gpu_allocators_.size();
@@ -103,6 +108,13 @@ class GPUProcessState {
   virtual Allocator* GetGpuHostAllocator(const GPUOptions& options,
                                          int numa_node);
 
+  // Returns the ring of pinned buffers for staging host-to-device copies, or
+  // nullptr if GPUOptions.experimental.num_host_staging_buffers is 0 or host
+  // memory is not pinned. Like the GpuHostAllocator, the ring is shared by all
+  // NUMA nodes, and `options` is only read on the first call.
+  virtual GpuHostStagingRing* GetGpuHostStagingRing(const GPUOptions& options,
+                                                    int numa_node);
+
   // Registers a Visitor to be invoked on new chunks of memory allocated by the
   // SubAllocator of every GPU proximate to the specified bus.  The AllocVisitor
   // is provided with a memory pointer, a GPU id, and the size of the area it
@@ -168,6 +180,10 @@ class GPUProcessState {
       TF_GUARDED_BY(mu_);
   std::vector<std::vector<SubAllocator::Visitor>> gpu_host_free_visitors_
       TF_GUARDED_BY(mu_);
+
+  bool gpu_host_staging_ring_created_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<GpuHostStagingRing> gpu_host_staging_ring_
+      TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tensorflow
@@ -0,0 +1,78 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+namespace {
+
+bool RunsOnDefaultStream(const Node* n) {
+  return n->IsSend() || n->IsRecv() || n->IsArg() || n->IsRetval() ||
+         n->IsFunctionCall() || n->IsIfNode() || n->IsWhileNode() ||
+         n->IsCaseNode() || n->IsCollective() || n->IsControlFlow() ||
+         n->IsConstant() || n->IsScopedAllocator() ||
+         absl::StartsWith(n->type_string(), "Nccl");
+}
+
+}  // namespace
+
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::vector<int>* node_to_stream_id) {
+  if (opts.max_streams < 1) {
+    return errors::InvalidArgument("max_streams must be positive, got ",
+                                   opts.max_streams);
+  }
+  node_to_stream_id->assign(graph->num_node_ids(), 0);
+  if (opts.max_streams == 1) return OkStatus();
+
+  // Whether the stream of a node has been continued by one of its consumers.
+  std::vector<bool> continued(graph->num_node_ids(), false);
+  // New branches start on the other streams first, since stream 0 also runs
+  // the nodes that must use it.
+  int next_stream = 1;
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  for (const Node* n : order) {
+    if (!n->IsOp() || RunsOnDefaultStream(n)) continue;
+    const Edge* branch = nullptr;
+    for (const Edge* e : n->in_edges()) {
+      const Node* src = e->src();
+      if (e->IsControlEdge() || !src->IsOp() || src->IsConstant() ||
+          continued[src->id()]) {
+        continue;
+      }
+      if (branch == nullptr || e->dst_input() < branch->dst_input()) {
+        branch = e;
+      }
+    }
+    int stream;
+    if (branch != nullptr) {
+      continued[branch->src()->id()] = true;
+      stream = (*node_to_stream_id)[branch->src()->id()];
+    } else {
+      stream = next_stream;
+      next_stream = (next_stream + 1) % opts.max_streams;
+    }
+    (*node_to_stream_id)[n->id()] = stream;
+  }
+  return OkStatus();
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -0,0 +1,49 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+struct AssignStreamsOpts {
+  // The number of compute streams the nodes are assigned to.
+  int32 max_streams = 1;
+};
+
+// Assigns the nodes of 'graph' to compute streams so that independent
+// branches of the graph run on different streams. On return,
+// '(*node_to_stream_id)[id]' is the stream of the node with that id, in
+// [0, opts.max_streams).
+//
+// A node continues the stream of its first data input that has not already
+// been continued by another consumer, and otherwise starts a new branch on the
+// next stream in round-robin order. Nodes that exchange tensors with other
+// executors or devices (sends, receives, function arguments and results,
+// function calls and collectives), and control flow nodes, run on stream 0.
+// Constants run on stream 0 and are never continued, since their value is
+// computed when the kernel is created.
+Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                     std::vector<int>* node_to_stream_id);
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
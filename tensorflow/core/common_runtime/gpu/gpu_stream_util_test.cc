@@ -0,0 +1,125 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <set>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+namespace {
+
+Tensor V(const float val) {
+  Tensor tensor(DT_FLOAT, TensorShape({}));
+  tensor.scalar<float>()() = val;
+  return tensor;
+}
+
+class GpuStreamUtilTest : public ::testing::Test {
+ protected:
+  GpuStreamUtilTest() : graph_(OpRegistry::Global()) {}
+
+  std::vector<int> Assign(int max_streams) {
+    AssignStreamsOpts opts;
+    opts.max_streams = max_streams;
+    std::vector<int> node_to_stream_id;
+    TF_CHECK_OK(AssignStreams(&graph_, opts, &node_to_stream_id));
+    return node_to_stream_id;
+  }
+
+  Graph graph_;
+};
+
+TEST_F(GpuStreamUtilTest, InvalidMaxStreams) {
+  AssignStreamsOpts opts;
+  opts.max_streams = 0;
+  std::vector<int> node_to_stream_id;
+  EXPECT_FALSE(AssignStreams(&graph_, opts, &node_to_stream_id).ok());
+}
+
+TEST_F(GpuStreamUtilTest, SingleStream) {
+  Node* a = test::graph::Constant(&graph_, V(1.0));
+  Node* b = test::graph::Unary(&graph_, "Relu", a);
+  Node* c = test::graph::Unary(&graph_, "Relu", a);
+  const std::vector<int> streams = Assign(1);
+  ASSERT_EQ(streams.size(), graph_.num_node_ids());
+  EXPECT_EQ(streams[b->id()], 0);
+  EXPECT_EQ(streams[c->id()], 0);
+}
+
+TEST_F(GpuStreamUtilTest, ChainStaysOnOneStream) {
+  Node* a = test::graph::Constant(&graph_, V(1.0));
+  Node* b = test::graph::Unary(&graph_, "Relu", a);
+  Node* c = test::graph::Unary(&graph_, "Relu", b);
+  Node* d = test::graph::Unary(&graph_, "Relu", c);
+  const std::vector<int> streams = Assign(4);
+  EXPECT_EQ(streams[a->id()], 0);
+  EXPECT_EQ(streams[c->id()], streams[b->id()]);
+  EXPECT_EQ(streams[d->id()], streams[b->id()]);
+}
+
+TEST_F(GpuStreamUtilTest, IndependentBranches) {
+  // x feeds three branches that are joined again by `sum`.
+  Node* a = test::graph::Constant(&graph_, V(1.0));
+  Node* x = test::graph::Unary(&graph_, "Relu", a);
+  std::vector<Node*> branches;
+  for (int i = 0; i < 3; ++i) {
+    Node* y = test::graph::Unary(&graph_, "Relu", x);
+    branches.push_back(test::graph::Unary(&graph_, "Relu", y));
+  }
+  Node* sum = test::graph::Binary(&graph_, "Add", branches[0], branches[1]);
+  const std::vector<int> streams = Assign(3);
+
+  std::set<int> branch_streams;
+  for (Node* branch : branches) branch_streams.insert(streams[branch->id()]);
+  EXPECT_EQ(branch_streams.size(), 3);
+  EXPECT_EQ(branch_streams.count(streams[x->id()]), 1);
+  EXPECT_EQ(streams[sum->id()], streams[branches[0]->id()]);
+}
+
+TEST_F(GpuStreamUtilTest, StreamsAreReusedRoundRobin) {
+  Node* a = test::graph::Constant(&graph_, V(1.0));
+  for (int i = 0; i < 8; ++i) {
+    test::graph::Unary(&graph_, "Relu", a);
+  }
+  const std::vector<int> streams = Assign(2);
+  int on_stream_1 = 0;
+  for (const Node* n : graph_.op_nodes()) {
+    EXPECT_LT(streams[n->id()], 2);
+    if (streams[n->id()] == 1) ++on_stream_1;
+  }
+  EXPECT_EQ(on_stream_1, 4);
+}
+
+TEST_F(GpuStreamUtilTest, SendAndRecvUseDefaultStream) {
+  const string device = "/job:a/replica:0/task:0/device:GPU:0";
+  Node* recv = test::graph::Recv(&graph_, "input", "float", device, 1, device);
+  Node* x = test::graph::Unary(&graph_, "Relu", recv);
+  Node* y = test::graph::Unary(&graph_, "Relu", recv);
+  Node* send = test::graph::Send(&graph_, y, "output", device, 1, device);
+  const std::vector<int> streams = Assign(4);
+  EXPECT_EQ(streams[recv->id()], 0);
+  EXPECT_EQ(streams[send->id()], 0);
+  EXPECT_NE(streams[x->id()], streams[y->id()]);
+}
+
+}  // namespace
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
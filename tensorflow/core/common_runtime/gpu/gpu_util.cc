@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device/device_event_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_host_staging_ring.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -187,6 +188,40 @@ void GPUUtil::SetProtoFromGPU(const Tensor& tensor, Device* dev,
       });
 }
 
+namespace {
+
+// Copies [src, src + total_bytes) on the device of 'send_stream' to 'dst' on
+// the device of 'recv_stream' in chunks through the buffers of 'ring', for as
+// long as the ring has free buffers. Each chunk is copied to the host on
+// 'send_stream' and then to 'dst' on 'recv_stream', so that the two transfers
+// of consecutive chunks overlap. Returns the number of leading bytes that
+// were copied.
+int64_t CopyDeviceToDeviceThroughStagingRing(GpuHostStagingRing* ring,
+                                             EventMgr* recv_em,
+                                             se::Stream* send_stream,
+                                             se::Stream* recv_stream,
+                                             char* src, char* dst,
+                                             int64_t total_bytes) {
+  int64_t offset = 0;
+  while (offset < total_bytes) {
+    void* buffer = ring->TryAcquire();
+    if (buffer == nullptr) break;
+    const int64_t chunk_bytes =
+        std::min<int64_t>(ring->buffer_bytes(), total_bytes - offset);
+    DeviceMemoryBase gpu_src_chunk(src + offset, chunk_bytes);
+    send_stream->ThenMemcpy(buffer, gpu_src_chunk, chunk_bytes);
+    recv_stream->ThenWaitFor(send_stream);
+    DeviceMemoryBase gpu_dst_chunk(dst + offset, chunk_bytes);
+    recv_stream->ThenMemcpy(&gpu_dst_chunk, buffer, chunk_bytes);
+    recv_em->ThenExecute(recv_stream,
+                         [ring, buffer]() { ring->Release(buffer); });
+    offset += chunk_bytes;
+  }
+  return offset;
+}
+
+}  // namespace
+
 // static
 void GPUUtil::DeviceToDeviceCopy(
     DeviceContext* send_dev_context, DeviceContext* recv_dev_context,
@@ -215,9 +250,7 @@ void GPUUtil::DeviceToDeviceCopy(
   const int64_t total_bytes = input->TotalBytes();
   if (total_bytes > 0) {
     void* src_ptr = GetBase(input);
-    DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
     void* dst_ptr = GetBase(output);
-    DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
     auto recv_stream =
         static_cast<const GPUDeviceContext*>(recv_dev_context)->stream();
     if (recv_stream == nullptr) {
@@ -232,8 +265,47 @@ void GPUUtil::DeviceToDeviceCopy(
     send_device_to_device_stream->ThenWaitFor(recv_stream);
 
     VLOG(2) << "src_ptr " << src_ptr << " dst_ptr " << dst_ptr;
-    send_device_to_device_stream->ThenMemcpy(&gpu_dst_ptr, gpu_src_ptr,
-                                             total_bytes);
+    // Without peer access the driver stages the copy through host memory one
+    // synchronous transfer at a time. Stage it through the pinned ring instead,
+    // overlapping the device-to-host transfer of a chunk with the
+    // host-to-device transfer of the previous one.
+    int64_t staged_bytes = 0;
+    GpuHostStagingRing* ring =
+        static_cast<const GPUDeviceContext*>(send_dev_context)
+            ->host_staging_ring();
+    se::Stream* recv_host_to_device_stream =
+        static_cast<const GPUDeviceContext*>(recv_dev_context)
+            ->host_to_device_stream();
+    const DeviceBase::AcceleratorDeviceInfo* recv_dev_info =
+        dst->tensorflow_accelerator_device_info();
+    const bool use_staging =
+        ring != nullptr && recv_host_to_device_stream != nullptr &&
+        recv_dev_info != nullptr &&
+        send_stream->parent() != recv_stream->parent() &&
+        !send_stream->parent()->CanEnablePeerAccessTo(recv_stream->parent());
+    if (use_staging) {
+      recv_host_to_device_stream->ThenWaitFor(recv_stream);
+      staged_bytes = CopyDeviceToDeviceThroughStagingRing(
+          ring, recv_dev_info->event_mgr, send_device_to_device_stream,
+          recv_host_to_device_stream, static_cast<char*>(src_ptr),
+          static_cast<char*>(dst_ptr), total_bytes);
+      VLOG(2) << "Staged " << staged_bytes << " of " << total_bytes
+              << " bytes through the host";
+    }
+    if (staged_bytes < total_bytes) {
+      DeviceMemoryBase gpu_src_remaining(
+          static_cast<char*>(src_ptr) + staged_bytes,
+          total_bytes - staged_bytes);
+      DeviceMemoryBase gpu_dst_remaining(
+          static_cast<char*>(dst_ptr) + staged_bytes,
+          total_bytes - staged_bytes);
+      send_device_to_device_stream->ThenMemcpy(
+          &gpu_dst_remaining, gpu_src_remaining, total_bytes - staged_bytes);
+    }
+    if (staged_bytes > 0) {
+      // Completes the copy once the staged chunks have arrived as well.
+      send_device_to_device_stream->ThenWaitFor(recv_host_to_device_stream);
+    }
   }
 
   // Use of input may outlive stack scope, so keep a ref.
@@ -264,6 +336,28 @@ bool NeedStaging(const Tensor* tensor) {
   return tensor->GetMemoryType() == AllocatorMemoryType::kHostPageable;
 }
 
+// Copies [src, src + total_bytes) to 'dst' on 'stream' in chunks through the
+// buffers of 'ring', for as long as the ring has free buffers. Each buffer is
+// returned to the ring once its transfer has completed. Returns the number of
+// leading bytes that were copied.
+int64_t CopyThroughStagingRing(GpuHostStagingRing* ring, EventMgr* em,
+                               se::Stream* stream, const char* src, char* dst,
+                               int64_t total_bytes) {
+  int64_t offset = 0;
+  while (offset < total_bytes) {
+    void* buffer = ring->TryAcquire();
+    if (buffer == nullptr) break;
+    const int64_t chunk_bytes =
+        std::min<int64_t>(ring->buffer_bytes(), total_bytes - offset);
+    std::memcpy(buffer, src + offset, chunk_bytes);
+    DeviceMemoryBase gpu_dst_chunk(dst + offset, chunk_bytes);
+    stream->ThenMemcpy(&gpu_dst_chunk, buffer, chunk_bytes);
+    em->ThenExecute(stream, [ring, buffer]() { ring->Release(buffer); });
+    offset += chunk_bytes;
+  }
+  return offset;
+}
+
 }  // namespace
 
 // static
@@ -364,13 +458,31 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
     }
 
     if (do_staging) {
-      staging_buffer = host_memory_allocator->AllocateRaw(
-          tensorflow::Allocator::kAllocatorAlignment, total_bytes);
-      std::memcpy(staging_buffer, src_ptr, total_bytes);
+      // Stage through the shared ring first, so that the host copy of a chunk
+      // overlaps the transfer of the previous one, and allocate staging memory
+      // for whatever does not fit into the free buffers of the ring.
+      int64_t ring_bytes = 0;
+      GpuHostStagingRing* ring =
+          static_cast<const GPUDeviceContext*>(device_context)
+              ->host_staging_ring();
+      if (ring != nullptr) {
+        ring_bytes = CopyThroughStagingRing(
+            ring, dev_info->event_mgr, recv_host_to_device_stream,
+            static_cast<const char*>(src_ptr), static_cast<char*>(dst_ptr),
+            total_bytes);
+      }
+      if (ring_bytes < total_bytes) {
+        const int64_t remaining_bytes = total_bytes - ring_bytes;
+        staging_buffer = host_memory_allocator->AllocateRaw(
+            tensorflow::Allocator::kAllocatorAlignment, remaining_bytes);
+        std::memcpy(staging_buffer, static_cast<char*>(src_ptr) + ring_bytes,
+                    remaining_bytes);
+        DeviceMemoryBase gpu_dst_remaining(
+            static_cast<char*>(dst_ptr) + ring_bytes, remaining_bytes);
+        recv_host_to_device_stream->ThenMemcpy(
+            &gpu_dst_remaining, staging_buffer, remaining_bytes);
+      }
       input_ref.Unref();
-
-      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, staging_buffer,
-                                             total_bytes);
     } else {
       recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr,
                                              total_bytes);
@@ -382,7 +494,9 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
       [recv_host_to_device_stream, done, input_ref, do_staging, staging_buffer,
        host_memory_allocator]() {
         if (do_staging) {
-          host_memory_allocator->DeallocateRaw(staging_buffer);
+          if (staging_buffer != nullptr) {
+            host_memory_allocator->DeallocateRaw(staging_buffer);
+          }
         } else {
           input_ref.Unref();
         }
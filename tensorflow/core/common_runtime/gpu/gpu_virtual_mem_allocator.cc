@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "absl/strings/str_format.h"
 #include "tensorflow/compiler/xla/stream_executor/lib/status.h"
 #include "tensorflow/compiler/xla/stream_executor/stream_executor.h"
@@ -65,7 +68,8 @@ GpuVirtualMemAllocator::Create(
     const std::vector<Visitor>& alloc_visitors,
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids) {
+    const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+    bool allow_partial_free) {
   tsl::profiler::TraceMe traceme("GpuVirtualMemAllocator::Create");
 
   std::vector<GpuDeviceHandle> access_gpu_handles;
@@ -109,7 +113,8 @@ GpuVirtualMemAllocator::Create(
 
   return std::unique_ptr<GpuVirtualMemAllocator>(new GpuVirtualMemAllocator(
       alloc_visitors, free_visitors, gpu_context, gpu_id,
-      std::move(access_gpu_handles), vmem, max_granularity));
+      std::move(access_gpu_handles), vmem, max_granularity,
+      allow_partial_free));
 }
 
 GpuVirtualMemAllocator::GpuVirtualMemAllocator(
@@ -117,13 +122,14 @@ GpuVirtualMemAllocator::GpuVirtualMemAllocator(
     const std::vector<Visitor>& free_visitors, GpuContext& gpu_context,
     tsl::PlatformDeviceId gpu_id,
     const std::vector<GpuDeviceHandle> access_gpu_handles,
-    GpuDriver::VmemSpan vmem, size_t granularity)
+    GpuDriver::VmemSpan vmem, size_t granularity, bool allow_partial_free)
     : SubAllocator(alloc_visitors, free_visitors),
       gpu_context_(gpu_context),
       gpu_id_(gpu_id),
       access_gpu_handles_(access_gpu_handles),
       vmem_(vmem),
-      granularity_(granularity) {}
+      granularity_(granularity),
+      allow_partial_free_(allow_partial_free) {}
 
 GpuVirtualMemAllocator::~GpuVirtualMemAllocator() {
   for (const auto mapping : mappings_) {
@@ -146,6 +152,9 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
   // virtual memory at the specific address at the end of the initial vmem
   // reservation.
   if (next_va + padded_bytes > vmem_.base + vmem_.size_bytes) {
+    next_va = FindHole(padded_bytes);
+  }
+  if (next_va == 0) {
     LOG(ERROR) << "OOM in GPU virtual memory allocator when attempting to "
                   "allocate {request: "
                << tsl::strings::HumanReadableNumBytes(num_bytes)
@@ -153,25 +162,47 @@ void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes,
     return nullptr;
   }
 
-  // Create physical memory backing allocation.
-  auto maybe_handle =
-      GpuDriver::CreateMemoryHandle(&gpu_context_, padded_bytes);
-  if (!maybe_handle.ok()) {
-    LOG(ERROR) << maybe_handle.status();
-    return nullptr;
+  // Create physical memory backing allocation and map VAs for it, in one
+  // mapping or one mapping per granule.
+  const size_t mapping_bytes = allow_partial_free_ ? granularity_ : padded_bytes;
+  std::vector<Mapping> new_mappings;
+  auto unmap_new_mappings = [&]() {
+    for (auto& mapping : new_mappings) {
+      GpuDriver::UnmapMemory(&gpu_context_, mapping.va, mapping.physical.bytes);
+      GpuDriver::ReleaseMemoryHandle(&gpu_context_,
+                                     std::move(mapping.physical));
+    }
+  };
+  for (size_t offset = 0; offset < padded_bytes; offset += mapping_bytes) {
+    auto maybe_handle =
+        GpuDriver::CreateMemoryHandle(&gpu_context_, mapping_bytes);
+    if (!maybe_handle.ok()) {
+      LOG(ERROR) << maybe_handle.status();
+      unmap_new_mappings();
+      return nullptr;
+    }
+    GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).value();
+
+    auto status = GpuDriver::MapMemory(&gpu_context_, next_va + offset, handle,
+                                       access_gpu_handles_);
+    if (!status.ok()) {
+      LOG(ERROR) << status;
+      GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
+      unmap_new_mappings();
+      return nullptr;
+    }
+    new_mappings.push_back({next_va + offset, std::move(handle)});
   }
-  GpuDriver::GenericMemoryHandle handle = std::move(maybe_handle).value();
-
-  // Map VAs for this physical memory.
-  auto status =
-      GpuDriver::MapMemory(&gpu_context_, next_va, handle, access_gpu_handles_);
-  if (!status.ok()) {
-    LOG(ERROR) << status;
-    GpuDriver::ReleaseMemoryHandle(&gpu_context_, std::move(handle));
-    return nullptr;
+  if (next_va == vmem_.base + next_alloc_offset_) {
+    next_alloc_offset_ += padded_bytes;
   }
-  next_alloc_offset_ += handle.bytes;
-  mappings_.push_back({next_va, std::move(handle)});
+  auto insert_it =
+      std::lower_bound(mappings_.begin(), mappings_.end(), next_va,
+                       [](const Mapping& mapping, GpuDevicePtr va) {
+                         return mapping.va < va;
+                       });
+  mappings_.insert(insert_it, std::make_move_iterator(new_mappings.begin()),
+                   std::make_move_iterator(new_mappings.end()));
   VisitAlloc(reinterpret_cast<void*>(next_va), gpu_id_.value(), padded_bytes);
   *bytes_received = padded_bytes;
   return reinterpret_cast<void*>(next_va);
@@ -195,7 +226,7 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   }
 
   int num_mappings_to_free = 0;
-  int total_bytes = 0;
+  size_t total_bytes = 0;
   for (auto it = mapping_it; it != mappings_.end() && total_bytes < num_bytes;
        ++it) {
     ++num_mappings_to_free;
@@ -226,6 +257,15 @@ void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
   VisitFree(ptr, gpu_id_.value(), num_bytes);
 }
 
+GpuDevicePtr GpuVirtualMemAllocator::FindHole(size_t num_bytes) const {
+  GpuDevicePtr hole_begin = vmem_.base;
+  for (const Mapping& mapping : mappings_) {
+    if (mapping.va - hole_begin >= num_bytes) return hole_begin;
+    hole_begin = mapping.va + mapping.physical.bytes;
+  }
+  return 0;
+}
+
 }  // namespace tensorflow
 
 #endif
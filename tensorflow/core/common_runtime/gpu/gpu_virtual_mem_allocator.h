@@ -40,6 +40,11 @@ namespace tensorflow {
 // reserving a large chunk of virtual addresses at construction and then mapping
 // physical memory pages to this virtual address range as requested.
 //
+// If 'allow_partial_free' is true, each granule of physical memory is mapped
+// separately, so that Free() accepts any granularity-aligned part of previous
+// allocations. This lets BFCAllocator return the memory under free chunks, see
+// BFCAllocator::ReserveFreeGranules().
+//
 // This class is not thread-safe.
 class GpuVirtualMemAllocator : public tsl::SubAllocator {
  public:
@@ -49,7 +54,8 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
          const std::vector<Visitor>& free_visitors,
          stream_executor::gpu::GpuContext& gpu_context,
          tsl::PlatformDeviceId gpu_id, size_t virtual_address_space_size,
-         const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids);
+         const std::vector<tsl::PlatformDeviceId>& peer_gpu_ids,
+         bool allow_partial_free = false);
   ~GpuVirtualMemAllocator() override;
 
   // Allocates memory at least as large as requested by num_bytes. Will be
@@ -63,16 +69,21 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   // allocation happens at the end, then the next_alloc_offset_ is moved back,
   // otherwise a hole is created.
   //
-  // Holes are not re-used, all allocations continue to come at the end of the
-  // next_alloc_offset_. To accommodate this, the virtual_address_space_size
-  // should be much larger than the max physical size of the allocator.
+  // Holes are only re-used once the virtual address space beyond
+  // next_alloc_offset_ is exhausted, so that allocations keep extending the
+  // last region of the BFC allocator. To accommodate this, the
+  // virtual_address_space_size should be larger than the max physical size of
+  // the allocator.
   //
-  // In practice, since the BFC allocator coalesces adjacent AllocationRegions,
-  // this free function should never be invoked.
+  // Without 'allow_partial_free', since the BFC allocator coalesces adjacent
+  // AllocationRegions, this free function should never be invoked.
   void Free(void* ptr, size_t num_bytes) override;
 
   bool SupportsCoalescing() const override { return true; }
 
+  // The granularity of physical memory mappings.
+  size_t granularity() const { return granularity_; }
+
  private:
   GpuVirtualMemAllocator(
       const std::vector<Visitor>& alloc_visitors,
@@ -80,7 +91,12 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
       stream_executor::gpu::GpuContext& gpu_context,
       tsl::PlatformDeviceId gpu_id,
       std::vector<stream_executor::gpu::GpuDeviceHandle> access_device_handles,
-      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity);
+      stream_executor::gpu::GpuDriver::VmemSpan vmem, size_t granularity,
+      bool allow_partial_free);
+
+  // Returns the start of a hole of at least 'num_bytes' left by Free() below
+  // next_alloc_offset_, or 0 if there is none.
+  stream_executor::gpu::GpuDevicePtr FindHole(size_t num_bytes) const;
 
   stream_executor::gpu::GpuContext& gpu_context_;
   tsl::PlatformDeviceId gpu_id_;
@@ -101,6 +117,9 @@ class GpuVirtualMemAllocator : public tsl::SubAllocator {
   // Smallest allocation as determined by CUDA.
   const size_t granularity_;
 
+  // Whether each granule is mapped separately.
+  const bool allow_partial_free_;
+
   struct Mapping {
     stream_executor::gpu::GpuDevicePtr va;
     stream_executor::gpu::GpuDriver::GenericMemoryHandle physical;
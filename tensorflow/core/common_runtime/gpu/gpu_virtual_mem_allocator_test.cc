@@ -34,7 +34,8 @@ using ::stream_executor::gpu::GpuDriver;
 constexpr size_t k2MiB{2 << 20};
 
 // Creates an allocator with 8 MiB of virtual address space.
-std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator() {
+std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator(
+    bool allow_partial_free = false) {
   tsl::PlatformDeviceId gpu_id(0);
   auto executor = se::DeviceIdUtil::ExecutorForPlatformDeviceId(
                       se::GPUMachineManager(), gpu_id)
@@ -43,7 +44,7 @@ std::unique_ptr<GpuVirtualMemAllocator> CreateAllocator() {
       executor->implementation()->GpuContextHack());
   return GpuVirtualMemAllocator::Create(
              {}, {}, *gpu_context, gpu_id,
-             /*virtual_address_space_size=*/4 * k2MiB, {})
+             /*virtual_address_space_size=*/4 * k2MiB, {}, allow_partial_free)
       .value();
 }
 
@@ -179,6 +180,31 @@ TEST(GpuVirtualMemAllocatorTest, FreeRange) {
   ASSERT_EQ(re_alloc, first_alloc);
 }
 
+TEST(GpuVirtualMemAllocatorTest, PartialFreeReusesHoles) {
+  auto allocator = CreateAllocator(/*allow_partial_free=*/true);
+  size_t bytes_received;  // Ignored in this test.
+  void* alloc = allocator->Alloc(/*alignment=*/0, /*num_bytes=*/4 * k2MiB,
+                                 &bytes_received);
+  ASSERT_NE(alloc, nullptr);
+
+  // Free the middle of the allocation.
+  void* hole = reinterpret_cast<char*>(alloc) + k2MiB;
+  allocator->Free(hole, 2 * k2MiB);
+
+  // The end of the virtual address space is reached, so the hole is re-used.
+  void* first_alloc =
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received);
+  ASSERT_EQ(first_alloc, hole);
+  void* second_alloc =
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received);
+  ASSERT_EQ(second_alloc, reinterpret_cast<char*>(hole) + k2MiB);
+  ASSERT_EQ(
+      allocator->Alloc(/*alignment=*/0, /*num_bytes=*/k2MiB, &bytes_received),
+      nullptr);
+
+  allocator->Free(alloc, 4 * k2MiB);
+}
+
 }  // namespace
 }  // namespace tensorflow
 
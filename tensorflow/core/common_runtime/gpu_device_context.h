@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
+#include <utility>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -26,6 +28,8 @@ class Stream;
 
 namespace tensorflow {
 
+class GpuHostStagingRing;
+
 class GPUDeviceContext : public DeviceContext {
  public:
   // Does not take ownership of streams.
@@ -60,10 +64,26 @@ class GPUDeviceContext : public DeviceContext {
     return device_to_device_stream_[index % device_to_device_stream_.size()];
   }
   int stream_id() const { return stream_id_; }
+
+  // The compute streams that stream() waits for before each kernel that runs
+  // in this context, when a device uses more than one compute stream.
+  const gtl::InlinedVector<se::Stream*, 4>& wait_streams() const {
+    return wait_streams_;
+  }
+  void set_wait_streams(gtl::InlinedVector<se::Stream*, 4> wait_streams) {
+    wait_streams_ = std::move(wait_streams);
+  }
   Allocator* host_memory_allocator() const override {
     return host_memory_allocator_;
   }
 
+  // The ring of pinned buffers used to stage host-to-device copies, or nullptr
+  // if copies allocate their staging memory from host_memory_allocator().
+  GpuHostStagingRing* host_staging_ring() const { return host_staging_ring_; }
+  void set_host_staging_ring(GpuHostStagingRing* ring) {
+    host_staging_ring_ = ring;
+  }
+
   void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
                              Tensor* device_tensor, StatusCallback done,
                              bool sync_dst_compute) const override;
@@ -97,9 +117,13 @@ class GPUDeviceContext : public DeviceContext {
   se::Stream* device_to_host_stream_;
   // Streams to use for copying data between GPUs.
   gtl::InlinedVector<se::Stream*, 4> device_to_device_stream_;
+  // Compute streams of the same device that stream_ waits for.
+  gtl::InlinedVector<se::Stream*, 4> wait_streams_;
   // The allocator to use for allocating pinned host memory.
   // Not owned.
   Allocator* host_memory_allocator_;
+  // Not owned.
+  GpuHostStagingRing* host_staging_ring_ = nullptr;
 };
 
 }  // namespace tensorflow
@@ -23,6 +23,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
@@ -45,9 +46,13 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/public/version.h"
 
 namespace tensorflow {
@@ -58,6 +63,11 @@ namespace {
 // can skip expensive duplicates check in 'AddControlEdge'.
 static constexpr const bool kDoNotCheckDuplicates = true;
 
+// Graphs with at least this many nodes have their NodeDefs validated on a
+// thread pool before they are added to the graph. Below this, starting the
+// threads costs more than it saves.
+static constexpr const int kMinNodesToPrepareInParallel = 10000;
+
 inline bool IsMerge(const NodeDef& node_def) {
   return node_def.op() == "Merge" || node_def.op() == "RefMerge" ||
          node_def.op() == "_XlaMerge";
@@ -216,6 +226,11 @@ class GraphConstructor {
   Status ValidateInputMapAndControlDependencies();
   Status BuildNodeIndex();
   Status InitFromEdges();
+  // Looks up the OpDef of every NodeDef, adds its default attributes and
+  // validates it on a thread pool, moving the NodeDefs into *node_defs. Only
+  // valid when not importing, where the NodeDefs are not rewritten before
+  // being added to the graph.
+  Status PrepareNodeDefs(std::vector<NodeDef>* node_defs);
   Status Convert();
   Status AddBackEdges();
   Status UpdateVersionDef();
@@ -289,7 +304,7 @@ class GraphConstructor {
   virtual const NodeDef& get_node_def(int i) const = 0;
   // Destructively reads the i^th node in the graph, avoiding a copy if
   // possible. After calling this method, the result of get_node_def(i) is
-  // undefined.
+  // undefined. May be called concurrently for different nodes.
   virtual NodeDef consume_node_def(int i) = 0;
   // Returns the version information for the graph, or nullptr if none is
   // available.
@@ -439,7 +454,7 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
       : GraphConstructor(opts, g, refiner, return_tensors, return_nodes,
                          missing_unused_input_map_keys),
         graph_def_(std::move(graph_def)),
-        is_consumed_(graph_def_.node_size(), false) {}
+        is_consumed_(graph_def_.node_size(), 0) {}
 
  private:
   size_t node_def_count() const override { return graph_def_.node().size(); }
@@ -459,7 +474,8 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
   }
 
   GraphDef graph_def_;
-  std::vector<bool> is_consumed_;
+  // Not a vector<bool>, whose elements cannot be written concurrently.
+  std::vector<uint8> is_consumed_;
 };
 
 bool ForwardCompatibilityWindowPassed(const VersionDef& versions) {
@@ -1121,6 +1137,59 @@ void GraphConstructor::PrintCycles() {
   }
 }
 
+Status GraphConstructor::PrepareNodeDefs(std::vector<NodeDef>* node_defs) {
+  DCHECK(!opts_.importing);
+  const int num_nodes = node_def_count();
+  node_defs->resize(num_nodes);
+
+  mutex mu;
+  // The error of the first invalid NodeDef, so that the error does not depend
+  // on the scheduling of the shards.
+  int first_error_index = num_nodes;
+  Status first_error;
+  auto prepare_node_defs = [&](int64_t begin, int64_t end) {
+    // A graph is made of a few distinct ops, so the lookups in the shared op
+    // registry are cached for each shard.
+    absl::flat_hash_map<std::string, const OpDef*> op_defs;
+    for (int64_t i = begin; i < end; ++i) {
+      NodeDef& node_def = (*node_defs)[i];
+      node_def = consume_node_def(i);
+      const OpDef* op_def;
+      auto it = op_defs.find(node_def.op());
+      Status s;
+      if (it != op_defs.end()) {
+        op_def = it->second;
+      } else {
+        s = g_->op_registry()->LookUpOpDef(node_def.op(), &op_def);
+        if (s.ok()) op_defs.emplace(node_def.op(), op_def);
+      }
+      if (s.ok()) {
+        if (opts_.add_default_attributes) {
+          AddDefaultsToNodeDef(*op_def, &node_def);
+        }
+        if (opts_.validate_nodes) {
+          s = ValidateNodeDef(node_def, *op_def);
+        }
+      }
+      if (!s.ok()) {
+        mutex_lock l(mu);
+        if (i < first_error_index) {
+          first_error_index = i;
+          first_error = s;
+        }
+        return;
+      }
+    }
+  };
+
+  thread::ThreadPool thread_pool(Env::Default(), "graph_constructor",
+                                 port::MaxParallelism());
+  // Roughly the cost of copying and validating a NodeDef with a few attrs.
+  const int64_t kCostPerNode = 10000;
+  thread_pool.ParallelFor(num_nodes, kCostPerNode, prepare_node_defs);
+  return first_error;
+}
+
 Status GraphConstructor::Convert() {
   // Import functions before adding nodes, since imported nodes may refer to
   // functions
@@ -1135,6 +1204,14 @@ Status GraphConstructor::Convert() {
 
   std::vector<bool> input_already_exists;
 
+  // NodeDefs already validated by PrepareNodeDefs(), indexed like
+  // node_defs_. Empty if the NodeDefs are validated one by one below.
+  std::vector<NodeDef> prepared_node_defs;
+  if (!opts_.importing && node_def_count() >= kMinNodesToPrepareInParallel) {
+    TF_RETURN_IF_ERROR(PrepareNodeDefs(&prepared_node_defs));
+  }
+  const bool node_defs_prepared = !prepared_node_defs.empty();
+
   // Process the NodeDefs in topological order.
   // (InitFromEdges() sets this up by filling in ready_ with nodes that have no
   // inputs, pending_counts_ with the number of inputs for each node and
@@ -1146,7 +1223,8 @@ Status GraphConstructor::Convert() {
     inputs.clear();
     bool has_data_back_edge = false;
 
-    NodeDef node_def = consume_node_def(o);
+    NodeDef node_def = node_defs_prepared ? std::move(prepared_node_defs[o])
+                                          : consume_node_def(o);
 
     // input_already_exists[i] is true iff the i-th input of the node we're
     // importing refers to a preexisting node in g_ (i.e. input[i] existed prior
@@ -1242,7 +1320,7 @@ Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
-    } else {
+    } else if (!node_defs_prepared) {
       const OpDef* op_def;
       TF_RETURN_IF_ERROR(
           g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
@@ -1291,7 +1369,9 @@ Status GraphConstructor::Convert() {
                  << " NODES IN A CYCLE";
     for (int64_t i = 0; i < node_def_count(); i++) {
       if (pending_count_[i] != 0) {
-        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(get_node_def(i))
+        const NodeDef& node_def =
+            node_defs_prepared ? prepared_node_defs[i] : get_node_def(i);
+        LOG(WARNING) << "PENDING: " << SummarizeNodeDef(node_def)
                      << " WITH PENDING COUNT = " << pending_count_[i];
       }
     }
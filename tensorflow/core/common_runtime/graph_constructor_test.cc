@@ -914,6 +914,55 @@ TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   EXPECT_TRUE(HasControlEdge("t1", "t2"));
 }
 
+// Large enough for the NodeDefs to be validated on a thread pool.
+GraphDef LargeChainGraphDef(int num_nodes) {
+  GraphDef def;
+  NodeDef* input = def.add_node();
+  input->set_name("input");
+  input->set_op("TestParams");
+  for (int i = 1; i < num_nodes; ++i) {
+    NodeDef* node = def.add_node();
+    node->set_name(strings::StrCat("t", i));
+    node->set_op("TestMul");
+    node->add_input(i == 1 ? "input" : strings::StrCat("t", i - 1));
+    node->add_input("input");
+  }
+  NodeDef* default_attr = def.add_node();
+  default_attr->set_name("default_attr");
+  default_attr->set_op("TestDefaultAttr");
+  return def;
+}
+
+TEST_F(GraphConstructorTest, LargeModel) {
+  const int kNumNodes = 20000;
+  GraphDef def = LargeChainGraphDef(kNumNodes);
+  GraphConstructorOptions opts;
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, def, &graph_));
+  EXPECT_EQ(kNumNodes + 1 + 2, graph_.num_nodes());
+  EXPECT_TRUE(HasEdge("input", 0, "t1", 0));
+  EXPECT_TRUE(HasEdge("t1", 0, "t2", 0));
+  EXPECT_TRUE(HasEdge(strings::StrCat("t", kNumNodes - 2), 0,
+                      strings::StrCat("t", kNumNodes - 1), 0));
+  EXPECT_TRUE(HasEdge("input", 0, strings::StrCat("t", kNumNodes - 1), 1));
+  int default_int;
+  TF_ASSERT_OK(GetNodeAttr(FindNode("default_attr")->attrs(), "default_int",
+                           &default_int));
+  EXPECT_EQ(31415, default_int);
+}
+
+TEST_F(GraphConstructorTest, LargeModelWithInvalidNodes) {
+  const string original_graph_description = GraphDebugString();
+  GraphDef def = LargeChainGraphDef(20000);
+  // The first invalid NodeDef in the GraphDef is reported.
+  def.mutable_node(15000)->set_op("TestOneInputOneOutput");
+  def.mutable_node(17000)->set_op("NotAnOp");
+  GraphConstructorOptions opts;
+  Status s = ConvertGraphDefToGraph(opts, def, &graph_);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+  EXPECT_TRUE(s.error_message().find("t15000") != string::npos) << s;
+  EXPECT_EQ(original_graph_description, GraphDebugString());
+}
+
 TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
   ExpectError(
       "node { name: 'W1' op: 'TestParams' }"
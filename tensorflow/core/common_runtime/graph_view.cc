@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_view.h"
 
+#include <algorithm>
 #include <atomic>
 #include <deque>
 #include <memory>
@@ -244,7 +245,50 @@ char* GraphView::InitializeNode(char* ptr, const Node* n) {
   return ptr;
 }
 
+std::vector<const Node*> GraphView::LayoutOrder(const Graph& g) {
+  std::vector<const Node*> order;
+  order.reserve(g.num_nodes());
+  if (OpOrderDeterminismRequired()) {
+    // For OpOrder determinism, we need node_id's to be stable across runs. We
+    // assign node_ids in the order in which `InitializeNode` is called on each
+    // node. However, `g` exposes a NodeIter of nodes, which does not guarantee
+    // a deterministic ordering across runs. Since NodeIter is immutable, we
+    // must sort a local copy. We sort by node_name, which is set in the
+    // GraphDef, so must be stable across runs.
+    for (const Node* n : g.nodes()) order.push_back(n);
+    std::sort(order.begin(), order.end(), NodeComparatorName());
+    return order;
+  }
+
+  std::vector<bool> visited(g.num_node_ids(), false);
+  auto visit_from = [&](const Node* root) {
+    if (visited[root->id()]) return;
+    visited[root->id()] = true;
+    // `order` doubles as the BFS queue.
+    size_t next = order.size();
+    order.push_back(root);
+    while (next < order.size()) {
+      const Node* n = order[next++];
+      for (const Edge* e : n->out_edges()) {
+        const Node* dst = e->dst();
+        if (!visited[dst->id()]) {
+          visited[dst->id()] = true;
+          order.push_back(dst);
+        }
+      }
+    }
+  };
+  visit_from(g.source_node());
+  for (const Node* n : g.nodes()) visit_from(n);
+  return order;
+}
+
 Status GraphView::Initialize(const Graph* g) {
+  return Initialize(g, LayoutOrder(*g));
+}
+
+Status GraphView::Initialize(const Graph* g,
+                             const std::vector<const Node*>& order) {
   CHECK(node_offsets_ == nullptr);
   const int num_nodes = g->num_node_ids();
   num_nodes_ = num_nodes;
@@ -266,28 +310,32 @@ Status GraphView::Initialize(const Graph* g) {
 
   space_ = new char[total_bytes];  // NodeItem objects are allocated here
   char* ptr = space_;
-  auto it = g->nodes();
-  if (OpOrderDeterminismRequired()) {
-    // For OpOrder determinism, we need node_id's to be stable across runs. We
-    // assign node_ids in the order in which `InitializeNode` is called on each
-    // node. However, `g` exposes a NodeIter of nodes, which does not guarantee
-    // a deterministic ordering across runs. Since NodeIter is immutable, we
-    // must sort a local copy. We sort by node_name, which is set in the
-    // GraphDef, so must be stable across runs.
-    std::vector<Node*> nodes(it.begin(), it.end());
-    std::sort(nodes.begin(), nodes.end(), NodeComparatorName());
-    for (const Node* n : nodes) {
-      ptr = InitializeNode(ptr, n);
-    }
-  } else {
-    for (const Node* n : it) {
-      ptr = InitializeNode(ptr, n);
-    }
+  for (const Node* n : order) {
+    ptr = InitializeNode(ptr, n);
   }
   CHECK_EQ(ptr, space_ + total_bytes);
   return OkStatus();
 }
 
+void GraphView::ReserveInputForwarding(const std::vector<const Node*>& nodes) {
+  for (const Node* n : nodes) {
+    const Edge* input_edge;
+    if (!n->input_edge(0, &input_edge).ok()) continue;
+    NodeItem* item = node(n->id());
+    const NodeItem* producer = node(input_edge->src()->id());
+    int* forward_from = item->forward_from_base();
+    const OpKernel* kernel = item->kernel;
+    if (forward_from[0] != OpKernelContext::Params::kNoReservation ||
+        !item->output_attrs()[0].IsEqualOrLessRestrictiveThan(
+            producer->output_attrs()[input_edge->src_output()]) ||
+        kernel->input_memory_types()[0] != kernel->output_memory_types()[0]) {
+      continue;
+    }
+    VLOG(2) << "Reserving input 0 of " << n->name() << " for output 0";
+    forward_from[0] = 0;
+  }
+}
+
 namespace {
 // If a Node has been marked to use a ScopedAllocator x for output i, then
 // sc_attr will contain the subsequence (i, x) at an even offset.  This function
@@ -85,6 +85,10 @@ struct NodeItem {
                                     // node's input types.
   bool is_distributed_communication : 1;  // True iff the op is registered to
                                           // use distributed communication.
+  bool outputs_are_step_local : 1;  // True iff the op is not stateful, and
+                                    // no consumer is stateful or a _Retval,
+                                    // so its outputs should not outlive the
+                                    // step.
 
   // The kernel for this node.
   OpKernel* kernel = nullptr;
@@ -211,9 +215,18 @@ class GraphView {
   GraphView() : space_(nullptr) {}
   ~GraphView();
 
+  // Lays out the `NodeItem`s of `g` in the order returned by `LayoutOrder()`.
   Status Initialize(const Graph* g);
+  // Lays out the `NodeItem`s of `g` in `order`, which must contain every node
+  // of `g` exactly once.
+  Status Initialize(const Graph* g, const std::vector<const Node*>& order);
   Status SetAllocAttrs(const Graph* g, const Device* device);
   void SetScopedAllocatorAttrs(const std::vector<const Node*>& sa_nodes);
+  // Reserves input 0 of each of `nodes` for its output 0, unless the output
+  // already has a reservation, or its allocator attributes or memory type are
+  // incompatible with those of the input. Must be called after
+  // SetAllocAttrs().
+  void ReserveInputForwarding(const std::vector<const Node*>& nodes);
 
   // Returns a mutable pointer to the `NodeItem` with the given `id` if it
   // exists in the graph, or `nullptr` if it does not.
@@ -239,6 +252,13 @@ class GraphView {
 
   int32 num_nodes() const { return num_nodes_; }
 
+  // Returns the nodes of `g` in breadth-first order from the source node, so
+  // that the consumers of a node, which are activated together when it
+  // completes, are next to each other. Nodes that are not reachable from the
+  // source node follow in id order. If op order determinism is required, the
+  // nodes are instead sorted by name, which is stable across runs.
+  static std::vector<const Node*> LayoutOrder(const Graph& g);
+
  private:
   char* InitializeNode(char* ptr, const Node* n);
   size_t NodeItemBytes(const Node* n);
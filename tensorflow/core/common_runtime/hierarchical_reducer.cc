@@ -0,0 +1,332 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+constexpr char kReduceScatterPhase[] = "rs";
+constexpr char kAllReducePhase[] = "ar";
+constexpr char kAllGatherPhase[] = "ag";
+}  // namespace
+
+HierarchicalReducer::HierarchicalReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      local_index_(-1),
+      task_index_(-1) {}
+
+Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalReduce expects a reduction, got ",
+                            col_params->instance.type);
+  }
+  std::vector<std::vector<int>> task_ranks;
+  if (!collective_util::GetTaskRanks(col_params->group, &task_ranks)) {
+    return errors::InvalidArgument(
+        "HierarchicalReduce requires at least two tasks with the same number, "
+        "at least two, of devices each in group ",
+        col_params->group.group_key);
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  std::vector<std::vector<int>> task_ranks;
+  if (!collective_util::GetTaskRanks(col_params_->group, &task_ranks)) {
+    return errors::Internal("Group ", col_params_->group.group_key,
+                            " does not support HierarchicalReduce");
+  }
+  const int rank = col_params_->default_rank;
+  for (int t = 0; t < task_ranks.size(); ++t) {
+    for (int l = 0; l < task_ranks[t].size(); ++l) {
+      if (task_ranks[t][l] == rank) {
+        task_index_ = t;
+        local_index_ = l;
+      }
+    }
+  }
+  if (task_index_ < 0) {
+    return errors::Internal("Rank ", rank, " is not in group ",
+                            col_params_->group.group_key);
+  }
+  task_ranks_ = task_ranks[task_index_];
+  peer_ranks_.clear();
+  for (const std::vector<int>& ranks : task_ranks) {
+    peer_ranks_.push_back(ranks[local_index_]);
+  }
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  // Since `HierarchicalReducer` doesn't require non-overlapping collectives,
+  // unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+  VLOG(1) << "HierarchicalReducer::Run for device " << col_ctx_->device_name
+          << " default_rank " << col_params_->default_rank << " task "
+          << task_index_ << " local index " << local_index_;
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  Status s;
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    s = CopyChunk(col_ctx_->input, col_ctx_->output);
+  }
+  if (s.ok()) {
+    AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+    ca_.reset(MakeCollectiveAdapter(col_ctx_->output, task_ranks_.size(),
+                                    col_ctx_->device->GetAllocator(attr)));
+    s = RunPhases();
+  }
+  if (s.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  }
+  ca_.reset();
+  done(s);
+}
+
+Status HierarchicalReducer::RunPhases() {
+  {
+    profiler::TraceMe activity("ReduceScatterInTask",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(ReduceScatterInTask());
+  }
+  {
+    profiler::TraceMe activity("AllReduceAcrossTasks",
+                               profiler::TraceMeLevel::kInfo);
+    TF_RETURN_IF_ERROR(AllReduceAcrossTasks());
+  }
+  profiler::TraceMe activity("AllGatherInTask", profiler::TraceMeLevel::kInfo);
+  return AllGatherInTask();
+}
+
+Status HierarchicalReducer::ReduceScatterInTask() {
+  // Send each chunk to the member of the task that reduces it, and receive
+  // the chunk that this member reduces from the others. Tail chunks may be
+  // empty, and are then not sent.
+  const int num_local = task_ranks_.size();
+  const int rank = col_params_->default_rank;
+  std::vector<Tensor> chunks(num_local);
+  std::vector<Tensor> received(num_local);
+  std::vector<Transfer> transfers;
+  for (int l = 0; l < num_local; ++l) {
+    chunks[l] = ca_->ChunkAlias(l);
+  }
+  for (int l = 0; l < num_local; ++l) {
+    if (l == local_index_) continue;
+    const int peer = task_ranks_[l];
+    if (ca_->ChunkBytes(l) > 0) {
+      transfers.push_back({/*is_send=*/true, peer,
+                           TransferKey(kReduceScatterPhase, rank, peer),
+                           &chunks[l]});
+    }
+    if (ca_->ChunkBytes(local_index_) > 0) {
+      received[l] = ca_->TempChunk(local_index_);
+      transfers.push_back({/*is_send=*/false, peer,
+                           TransferKey(kReduceScatterPhase, peer, rank),
+                           &received[l]});
+    }
+  }
+  TF_RETURN_IF_ERROR(Exchange(transfers));
+  if (ca_->ChunkBytes(local_index_) == 0) return OkStatus();
+  for (int l = 0; l < num_local; ++l) {
+    if (l == local_index_) continue;
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, &chunks[local_index_], &received[l]));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::AllReduceAcrossTasks() {
+  if (ca_->ChunkBytes(local_index_) == 0) return OkStatus();
+  // Exchange the chunk with the members that hold it in the other tasks.
+  const int num_tasks = peer_ranks_.size();
+  const int rank = col_params_->default_rank;
+  Tensor chunk = ca_->ChunkAlias(local_index_);
+  std::vector<Tensor> received(num_tasks);
+  std::vector<Transfer> transfers;
+  for (int t = 0; t < num_tasks; ++t) {
+    if (t == task_index_) continue;
+    const int peer = peer_ranks_[t];
+    received[t] = ca_->TempChunk(local_index_);
+    transfers.push_back({/*is_send=*/true, peer,
+                         TransferKey(kAllReducePhase, rank, peer), &chunk});
+    transfers.push_back({/*is_send=*/false, peer,
+                         TransferKey(kAllReducePhase, peer, rank),
+                         &received[t]});
+  }
+  TF_RETURN_IF_ERROR(Exchange(transfers));
+
+  // Reduce in the order of the tasks, so that all of them compute the same
+  // value.
+  auto contribution = [&](int t) {
+    return t == task_index_ ? &chunk : &received[t];
+  };
+  Tensor* sum = contribution(0);
+  for (int t = 1; t < num_tasks; ++t) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, sum, contribution(t)));
+  }
+  if (sum != &chunk) {
+    TF_RETURN_IF_ERROR(CopyChunk(sum, &chunk));
+  }
+  if (col_params_->final_op) {
+    Tensor group_size;
+    TF_RETURN_IF_ERROR(GroupSizeTensor(&group_size));
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op, &chunk, &group_size));
+  }
+  return OkStatus();
+}
+
+Status HierarchicalReducer::AllGatherInTask() {
+  const int num_local = task_ranks_.size();
+  const int rank = col_params_->default_rank;
+  std::vector<Tensor> chunks(num_local);
+  std::vector<Transfer> transfers;
+  for (int l = 0; l < num_local; ++l) {
+    chunks[l] = ca_->ChunkAlias(l);
+  }
+  for (int l = 0; l < num_local; ++l) {
+    if (l == local_index_) continue;
+    const int peer = task_ranks_[l];
+    if (ca_->ChunkBytes(local_index_) > 0) {
+      transfers.push_back({/*is_send=*/true, peer,
+                           TransferKey(kAllGatherPhase, rank, peer),
+                           &chunks[local_index_]});
+    }
+    if (ca_->ChunkBytes(l) > 0) {
+      transfers.push_back({/*is_send=*/false, peer,
+                           TransferKey(kAllGatherPhase, peer, rank),
+                           &chunks[l]});
+    }
+  }
+  return Exchange(transfers);
+}
+
+string HierarchicalReducer::TransferKey(const char* phase, int src_rank,
+                                        int dst_rank) const {
+  return strings::StrCat(col_ctx_->exec_key, ":", phase, ":", src_rank, ":",
+                         dst_rank);
+}
+
+Status HierarchicalReducer::Exchange(const std::vector<Transfer>& transfers) {
+  mutex mu;
+  Status status;
+  BlockingCounter pending(transfers.size());
+  auto transfer_done = [&mu, &status, &pending](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  for (const Transfer& transfer : transfers) {
+    const CollGroupMember& peer =
+        col_params_->group.members[transfer.peer_rank];
+    if (transfer.is_send) {
+      col_ctx_->col_exec->remote_access()->PostToPeer(
+          peer.device.name(), peer.task, transfer.key, col_ctx_->device,
+          col_ctx_->op_ctx->op_device_context(),
+          col_ctx_->op_ctx->output_alloc_attr(0), transfer.chunk,
+          col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+          transfer_done);
+    } else {
+      col_ctx_->col_exec->remote_access()->RecvFromPeer(
+          peer.device.name(), peer.task, peer.is_local, transfer.key,
+          col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+          col_ctx_->op_ctx->output_alloc_attr(0), transfer.chunk,
+          col_ctx_->device_locality, /*dev_to_dev_stream_index=*/0,
+          col_ctx_->op_ctx->cancellation_manager(), transfer_done);
+    }
+  }
+  pending.Wait();
+  mutex_lock l(mu);
+  return status;
+}
+
+Status HierarchicalReducer::CopyChunk(const Tensor* src, Tensor* dst) {
+  // We are running in a blockable thread and the callback can't block so
+  // just wait here on the copy.
+  Notification note;
+  Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+      col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+      col_ctx_->op_ctx->output_alloc_attr(0), src, dst,
+      /*dev_to_dev_stream_index=*/0, [&note, &status](const Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+Status HierarchicalReducer::GroupSizeTensor(Tensor* group_size) {
+  Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+  if (col_params_->group.device_type == "CPU") {
+    *group_size = group_size_val;
+    return OkStatus();
+  }
+  *group_size = ca_->Scalar(
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+      AllocationAttributes());
+  Notification note;
+  Status status;
+  col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+      &group_size_val, col_ctx_->device, group_size,
+      [&note, &status](const Status& s) {
+        status = s;
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,92 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Hierarchical implementation of collective all-reduce, for groups that span
+// several tasks with the same number of devices each, e.g. multi-GPU hosts.
+// With L devices per task, the tensor is split into L chunks and each device
+//   1. reduce-scatters the tensor with the devices of its task, so that it
+//      holds the task's sum of one chunk,
+//   2. all-reduces that chunk with the devices that hold it in the other
+//      tasks,
+//   3. all-gathers the chunks with the devices of its task.
+// Only 1/L of the tensor then crosses the network from each device.
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer();
+  ~HierarchicalReducer() override = default;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Begins execution of the hierarchical reduce. Must be called in a
+  // blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // A chunk sent to or received from another member of the group.
+  struct Transfer {
+    bool is_send;
+    int peer_rank;
+    string key;
+    Tensor* chunk;
+  };
+
+  Status RunPhases();
+  Status ReduceScatterInTask();
+  Status AllReduceAcrossTasks();
+  Status AllGatherInTask();
+
+  // Returns the key of the transfer from `src_rank` to `dst_rank` in `phase`.
+  string TransferKey(const char* phase, int src_rank, int dst_rank) const;
+
+  // Starts all `transfers` and waits for them to finish.
+  Status Exchange(const std::vector<Transfer>& transfers);
+
+  // Copies `src` into `dst` on the device of this member.
+  Status CopyChunk(const Tensor* src, Tensor* dst);
+
+  // Returns the group size as a scalar on the device of this member, for the
+  // final op.
+  Status GroupSizeTensor(Tensor* group_size);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  // Ranks of the members of the task of this member, and of the members with
+  // the same index in each task.
+  std::vector<int> task_ranks_;
+  std::vector<int> peer_ranks_;
+  // Indexes of this member in task_ranks_ and peer_ranks_.
+  int local_index_;
+  int task_index_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
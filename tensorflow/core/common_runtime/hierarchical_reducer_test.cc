@@ -0,0 +1,110 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  // Sums, over all members, tensors of `num_elements` where member `r` holds
+  // r+1 everywhere, and checks the result on every member.
+  void RunTest(int num_workers, int num_devices_per_worker,
+               int num_elements) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices_per_worker,
+                                        DEVICE_CPU);
+    const int group_size = num_workers * num_devices_per_worker;
+    std::vector<Tensor> tensors;
+    for (int i = 0; i < group_size; ++i) {
+      Tensor t(DT_FLOAT, TensorShape({num_elements}));
+      test::FillFn<float>(&t, [i](int) { return static_cast<float>(i + 1); });
+      tensors.push_back(t);
+    }
+    BlockingCounter counter(group_size);
+    for (int i = 0; i < group_size; ++i) {
+      SchedClosure([this, &tensors, i, &counter]() {
+        auto col_params = CreateCollectiveParams(
+            *test_env_, i, "HierarchicalReduce", REDUCTION_COLLECTIVE,
+            DT_FLOAT, tensors[i].shape());
+        Device* device = nullptr;
+        TF_CHECK_OK(test_env_->device_mgr->LookupDevice(
+            col_params->group.members[i].device.name(), &device));
+        TF_CHECK_OK(RunCollective(test_env_.get(), col_params.get(), device,
+                                  &tensors[i], &tensors[i]));
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+    Tensor expected(DT_FLOAT, TensorShape({num_elements}));
+    test::FillFn<float>(&expected, [group_size](int) {
+      return static_cast<float>(group_size * (group_size + 1) / 2);
+    });
+    for (int i = 0; i < group_size; ++i) {
+      test::ExpectTensorEqual<float>(tensors[i], expected);
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+};
+
+TEST_F(HierarchicalReducerTest, TwoWorkersTwoDevices) { RunTest(2, 2, 16); }
+
+TEST_F(HierarchicalReducerTest, ThreeWorkersFourDevices) {
+  RunTest(3, 4, 1001);
+}
+
+TEST_F(HierarchicalReducerTest, FewerElementsThanDevices) {
+  RunTest(2, 4, 3);
+}
+
+TEST(GetTaskRanksTest, EqualTasks) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers*/ 2,
+                                          /*num_devices_per_worker*/ 2,
+                                          DEVICE_CPU);
+  auto col_params =
+      CreateCollectiveParams(*test_env, 0, "HierarchicalReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({4}));
+  std::vector<std::vector<int>> task_ranks;
+  ASSERT_TRUE(collective_util::GetTaskRanks(col_params->group, &task_ranks));
+  ASSERT_EQ(task_ranks.size(), 2);
+  EXPECT_EQ(task_ranks[0].size(), 2);
+  EXPECT_EQ(task_ranks[1].size(), 2);
+}
+
+TEST(GetTaskRanksTest, SingleTask) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers*/ 1,
+                                          /*num_devices_per_worker*/ 4,
+                                          DEVICE_CPU);
+  auto col_params =
+      CreateCollectiveParams(*test_env, 0, "HierarchicalReduce",
+                             REDUCTION_COLLECTIVE, DT_FLOAT, TensorShape({4}));
+  std::vector<std::vector<int>> task_ranks;
+  EXPECT_FALSE(collective_util::GetTaskRanks(col_params->group, &task_ranks));
+}
+
+}  // namespace
+}  // namespace tensorflow
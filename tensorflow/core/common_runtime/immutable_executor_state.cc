@@ -16,6 +16,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
 #include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/input_forwarding.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -40,6 +42,9 @@ ImmutableExecutorState::~ImmutableExecutorState() {
       params_.delete_kernel(item->kernel);
     }
   }
+  for (DeviceContext* device_context : device_context_map_) {
+    if (device_context != nullptr) device_context->Unref();
+  }
 }
 
 namespace {
@@ -82,7 +87,12 @@ ImmutableExecutorState::FrameInfo* ImmutableExecutorState::EnsureFrameInfo(
 }
 
 Status ImmutableExecutorState::Initialize(const Graph& graph) {
-  TF_RETURN_IF_ERROR(gview_.Initialize(&graph));
+  // Visit the nodes in the order of their `NodeItem`s, so that the pending
+  // counts of nodes that are activated together are also next to each other.
+  const std::vector<const Node*> order = GraphView::LayoutOrder(graph);
+  TF_RETURN_IF_ERROR(gview_.Initialize(&graph, order));
+  TF_RETURN_IF_ERROR(
+      params_.device->FillContextMap(&graph, &device_context_map_));
 
   // Build the information about frames in this subgraph.
   ControlFlowInfo cf_info;
@@ -99,7 +109,7 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Preprocess every node in the graph to create an instance of op
   // kernel for each node.
   requires_control_flow_ = false;
-  for (const Node* n : graph.nodes()) {
+  for (const Node* n : order) {
     if (IsSink(n)) continue;
     if (IsSwitch(n) || IsMerge(n) || IsEnter(n) || IsExit(n)) {
       requires_control_flow_ = true;
@@ -196,6 +206,13 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
+    item->outputs_are_step_local = !n->op_def().is_stateful();
+    for (const Node* consumer : n->out_nodes()) {
+      if (consumer->op_def().is_stateful() || consumer->IsRetval()) {
+        item->outputs_are_step_local = false;
+        break;
+      }
+    }
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
@@ -259,7 +276,12 @@ Status ImmutableExecutorState::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
-  return gview_.SetAllocAttrs(&graph, params_.device);
+  TF_RETURN_IF_ERROR(gview_.SetAllocAttrs(&graph, params_.device));
+  if (params_.forward_inputs_statically &&
+      params_.device->device_type() == DEVICE_CPU) {
+    gview_.ReserveInputForwarding(FindStaticallyForwardableNodes(graph));
+  }
+  return OkStatus();
 }
 
 namespace {
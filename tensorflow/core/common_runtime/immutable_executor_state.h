@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
@@ -101,6 +102,18 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns true if the device runs some nodes in their own DeviceContext. See
+  // `Device::FillContextMap()`.
+  bool has_device_context_map() const { return !device_context_map_.empty(); }
+
+  // Returns the DeviceContext in which to run the node with the given id, or
+  // nullptr if it runs in the context of the step.
+  DeviceContext* device_context(int node_id) const {
+    return node_id < static_cast<int>(device_context_map_.size())
+               ? device_context_map_[node_id]
+               : nullptr;
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -155,6 +168,10 @@ class ImmutableExecutorState {
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // Indexed by node id, as filled in by `Device::FillContextMap()`. Holds one
+  // reference on each non-null entry.
+  std::vector<DeviceContext*> device_context_map_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ImmutableExecutorState);
 };
 
@@ -0,0 +1,75 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/input_forwarding.h"
+
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/types.h"
+
+namespace tensorflow {
+namespace {
+
+// Element-wise ops whose CPU kernels (`UnaryOp` and `UnaryElementWiseOp`)
+// forward input 0 to output 0 whenever the input and output types match.
+bool IsForwardingOp(const Node* n) {
+  static const auto* const kForwardingOps = new absl::flat_hash_set<string>({
+      "Abs", "Ceil", "Elu", "Exp", "Floor", "Log", "Neg", "Reciprocal", "Relu",
+      "Relu6", "Rsqrt", "Selu", "Sigmoid", "Softplus", "Sqrt", "Square",
+      "Tanh",
+  });
+  return kForwardingOps->contains(n->type_string());
+}
+
+// Ops whose output 0 is either newly allocated or forwarded from an input
+// that had no other reference, and that do not keep a reference to it.
+bool HasExclusiveOutput(const Node* n) {
+  static const auto* const kExclusiveOutputOps =
+      new absl::flat_hash_set<string>({
+          "Add", "AddV2", "BatchMatMulV2", "BiasAdd", "Conv2D", "MatMul",
+          "Maximum", "Minimum", "Mul", "RealDiv", "Sub",
+      });
+  return IsForwardingOp(n) || kExclusiveOutputOps->contains(n->type_string());
+}
+
+}  // namespace
+
+std::vector<const Node*> FindStaticallyForwardableNodes(const Graph& graph) {
+  std::vector<const Node*> result;
+  for (const Node* n : graph.op_nodes()) {
+    if (!IsForwardingOp(n) || n->num_inputs() != 1 || n->num_outputs() != 1 ||
+        IsRefType(n->input_type(0)) ||
+        n->input_type(0) != n->output_type(0)) {
+      continue;
+    }
+    const Edge* input_edge;
+    if (!n->input_edge(0, &input_edge).ok()) continue;
+    const Node* producer = input_edge->src();
+    const int output = input_edge->src_output();
+    if (!HasExclusiveOutput(producer) || output != 0 ||
+        IsRefType(producer->output_type(output)) ||
+        producer->assigned_device_name() != n->assigned_device_name()) {
+      continue;
+    }
+    int num_consumers = 0;
+    for (const Edge* e : producer->out_edges()) {
+      if (!e->IsControlEdge() && e->src_output() == output) ++num_consumers;
+    }
+    if (num_consumers == 1) result.push_back(n);
+  }
+  return result;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,44 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_INPUT_FORWARDING_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_INPUT_FORWARDING_H_
+
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// Returns the nodes of `graph` whose input 0 can be forwarded to output 0
+// without the runtime check that the input buffer has no other reference.
+//
+// A node is returned only if
+//   * it is an element-wise op whose CPU kernel always forwards input 0 to
+//     output 0 through `forward_input_or_allocate_output()`, and its input
+//     and output have the same type, and
+//   * its input is produced by an op that returns a buffer that no kernel
+//     holds on to, such as a MatMul or another such element-wise op, and
+//     that output has no other consumer.
+//
+// For these nodes, reserving input 0 for output 0 makes chains of element-wise
+// ops update their buffer in place without depending on the refcount check in
+// `OpKernelContext::forward_input()`. The caller must make sure that the graph
+// is executed on a CPU device, and that the allocator attributes and memory
+// types of the input are compatible with those of the output.
+std::vector<const Node*> FindStaticallyForwardableNodes(const Graph& graph);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_INPUT_FORWARDING_H_
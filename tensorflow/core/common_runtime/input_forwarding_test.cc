@@ -0,0 +1,81 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/input_forwarding.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor Matrix() {
+  Tensor tensor(DT_FLOAT, TensorShape({2, 2}));
+  tensor.flat<float>().setConstant(1.0f);
+  return tensor;
+}
+
+bool Contains(const std::vector<const Node*>& nodes, const Node* n) {
+  return std::find(nodes.begin(), nodes.end(), n) != nodes.end();
+}
+
+TEST(InputForwardingTest, ElementWiseChain) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Matrix());
+  Node* matmul = test::graph::Matmul(&g, a, a, false, false);
+  Node* relu = test::graph::Unary(&g, "Relu", matmul);
+  Node* tanh = test::graph::Unary(&g, "Tanh", relu);
+  std::vector<const Node*> nodes = FindStaticallyForwardableNodes(g);
+  EXPECT_EQ(nodes.size(), 2);
+  EXPECT_TRUE(Contains(nodes, relu));
+  EXPECT_TRUE(Contains(nodes, tanh));
+}
+
+TEST(InputForwardingTest, ConstantIsNotForwarded) {
+  // The kernel of a Const op holds on to its output.
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Matrix());
+  test::graph::Unary(&g, "Relu", a);
+  EXPECT_TRUE(FindStaticallyForwardableNodes(g).empty());
+}
+
+TEST(InputForwardingTest, AliasingProducerIsNotForwarded) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Matrix());
+  Node* matmul = test::graph::Matmul(&g, a, a, false, false);
+  Node* identity = test::graph::Identity(&g, matmul);
+  test::graph::Unary(&g, "Relu", identity);
+  EXPECT_TRUE(FindStaticallyForwardableNodes(g).empty());
+}
+
+TEST(InputForwardingTest, SharedInputIsNotForwarded) {
+  Graph g(OpRegistry::Global());
+  Node* a = test::graph::Constant(&g, Matrix());
+  Node* matmul = test::graph::Matmul(&g, a, a, false, false);
+  Node* relu = test::graph::Unary(&g, "Relu", matmul);
+  test::graph::Unary(&g, "Tanh", matmul);
+  // Only the sole consumer of `relu` forwards.
+  Node* sqrt = test::graph::Unary(&g, "Sqrt", relu);
+  std::vector<const Node*> nodes = FindStaticallyForwardableNodes(g);
+  EXPECT_EQ(nodes.size(), 1);
+  EXPECT_TRUE(Contains(nodes, sqrt));
+}
+
+}  // namespace
+}  // namespace tensorflow
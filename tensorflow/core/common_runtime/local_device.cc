@@ -91,14 +91,18 @@ struct LocalDevice::EigenThreadPoolInfo {
         options.env, thread_opts, strings::StrCat("numa_", numa_node, "_Eigen"),
         intra_op_parallelism_threads,
         !options.config.experimental().disable_thread_spinning(),
-        /*allocator=*/nullptr);
+        /*allocator=*/nullptr,
+        options.config.experimental().pin_intra_op_threads_to_physical_cores()
+            ? thread::ThreadPool::CpuAffinity::kPhysicalCoresFirst
+            : thread::ThreadPool::CpuAffinity::kNone);
     Eigen::ThreadPoolInterface* threadpool =
         eigen_worker_threads_.workers->AsEigenThreadPool();
     if (allocator != nullptr) {
       eigen_allocator_.reset(new EigenAllocator(allocator));
     }
     eigen_device_.reset(new Eigen::ThreadPoolDevice(
-        threadpool, eigen_worker_threads_.num_threads, eigen_allocator_.get()));
+        threadpool, eigen_worker_threads_.workers->NumEigenDeviceThreads(),
+        eigen_allocator_.get()));
   }
 
   ~EigenThreadPoolInfo() {
@@ -149,9 +153,14 @@ LocalDevice::LocalDevice(const SessionOptions& options,
   } else {
     // Each LocalDevice owns a separate ThreadPoolDevice for numerical
     // computations.
-    // TODO(tucker): NUMA for these too?
+    int numa_node = port::kNUMANoAffinity;
+    Allocator* numa_allocator = nullptr;
+    if (options.config.experimental().use_numa_affinity()) {
+      numa_node = attributes.locality().numa_node();
+      numa_allocator = ProcessState::singleton()->GetCPUAllocator(numa_node);
+    }
     owned_tp_info_.reset(new LocalDevice::EigenThreadPoolInfo(
-        options, port::kNUMANoAffinity, nullptr));
+        options, numa_node, numa_allocator));
     tp_info = owned_tp_info_.get();
   }
   set_tensorflow_cpu_worker_threads(&tp_info->eigen_worker_threads_);
@@ -23,6 +23,7 @@ namespace tsl {
 class Status;
 }
 namespace tensorflow {
+class CostModel;
 class Device;
 class StepStatsCollector;
 class SessionMetadata;
@@ -52,6 +53,22 @@ struct LocalExecutorParams {
 
   // Whether control flow nodes are allowed to be executed synchronously.
   bool allow_control_flow_sync_execution = false;
+
+  // If not null, the measured per-node compute times (e.g. from a session's
+  // `CostModelManager`) that the executor uses instead of the static
+  // `OpKernel::IsExpensive()` marker to decide which nodes to run inline.
+  // Must outlive the executor's `Initialize()`.
+  const CostModel* cost_model = nullptr;
+
+  // If true, outputs whose shapes are fully defined by the "_output_shapes"
+  // attribute are assigned offsets in one block of memory per step, instead of
+  // being allocated dynamically. See MemoryPlan.
+  bool plan_memory = false;
+
+  // If true, element-wise ops on CPU that are the only consumer of a buffer
+  // that no other kernel holds on to update it in place, without a runtime
+  // refcount check. See FindStaticallyForwardableNodes().
+  bool forward_inputs_statically = false;
 };
 
 }  // end namespace tensorflow
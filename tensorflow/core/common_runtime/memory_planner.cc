@@ -0,0 +1,318 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/memory_planner.h"
+
+#include <algorithm>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kOutputShapesAttr[] = "_output_shapes";
+
+int64_t RoundUpToAlignment(int64_t bytes) {
+  constexpr int64_t kAlignment = Allocator::kAllocatorAlignment;
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// A fixed-size set of producer indices.
+class Bitset {
+ public:
+  explicit Bitset(int size = 0) : words_((size + 63) / 64, 0) {}
+
+  void Set(int i) { words_[i / 64] |= uint64{1} << (i % 64); }
+  bool Test(int i) const { return (words_[i / 64] >> (i % 64)) & 1; }
+  void Union(const Bitset& other) {
+    for (size_t i = 0; i < words_.size(); ++i) words_[i] |= other.words_[i];
+  }
+  void Intersect(const Bitset& other) {
+    for (size_t i = 0; i < words_.size(); ++i) words_[i] &= other.words_[i];
+  }
+
+ private:
+  std::vector<uint64> words_;
+};
+
+}  // namespace
+
+std::unique_ptr<MemoryPlan> MemoryPlan::Build(
+    const Graph& graph, const std::function<bool(const Node*, int)>& can_plan) {
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsEnter() || n->IsExit() || n->IsNextIteration()) {
+      VLOG(1) << "Not planning memory for a graph with loops.";
+      return nullptr;
+    }
+  }
+
+  // Collect the outputs whose size is statically known.
+  std::vector<Buffer> candidates;
+  for (const Node* n : graph.op_nodes()) {
+    std::vector<PartialTensorShape> shapes;
+    if (n->attrs().Find(kOutputShapesAttr) == nullptr ||
+        !GetNodeAttr(n->attrs(), kOutputShapesAttr, &shapes).ok() ||
+        shapes.size() != n->num_outputs()) {
+      continue;
+    }
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      const DataType dtype = n->output_type(i);
+      if (IsRefType(dtype) || !DataTypeCanUseMemcpy(dtype) ||
+          !shapes[i].IsFullyDefined()) {
+        continue;
+      }
+      const int64_t bytes = shapes[i].num_elements() * DataTypeSize(dtype);
+      if (bytes <= 0 || !can_plan(n, i)) continue;
+      candidates.push_back(
+          {n->id(), i, /*offset=*/0, RoundUpToAlignment(bytes)});
+    }
+  }
+  if (candidates.empty()) return nullptr;
+
+  // Plan the largest buffers first, which also keeps the largest ones if there
+  // are too many.
+  std::stable_sort(candidates.begin(), candidates.end(),
+                   [](const Buffer& a, const Buffer& b) {
+                     return a.size > b.size;
+                   });
+  if (candidates.size() > kMaxBuffers) candidates.resize(kMaxBuffers);
+
+  // Number the producers of the candidate buffers.
+  absl::flat_hash_map<int, int> producer_index;
+  for (const Buffer& buffer : candidates) {
+    producer_index.emplace(buffer.node_id, producer_index.size());
+  }
+  const int num_producers = producer_index.size();
+
+  // descendants[id] is the set of producers that node `id` is a strict
+  // ancestor of. Post order visits every node after all of its descendants.
+  std::vector<Bitset> descendants(graph.num_node_ids(), Bitset(num_producers));
+  std::vector<Node*> order;
+  GetPostOrder(graph, &order);
+  for (const Node* n : order) {
+    Bitset bits(num_producers);
+    for (const Node* out : n->out_nodes()) {
+      bits.Union(descendants[out->id()]);
+      auto it = producer_index.find(out->id());
+      if (it != producer_index.end()) bits.Set(it->second);
+    }
+    descendants[n->id()] = std::move(bits);
+  }
+
+  // after[b] is the set of producers that start only once buffer `b` is dead,
+  // i.e. those that every consumer of `b` is a strict ancestor of.
+  std::vector<Bitset> after;
+  after.reserve(candidates.size());
+  for (const Buffer& buffer : candidates) {
+    const Node* n = graph.FindNodeId(buffer.node_id);
+    bool has_consumer = false;
+    Bitset bits;
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge() || e->src_output() != buffer.output) continue;
+      if (!has_consumer) {
+        bits = descendants[e->dst()->id()];
+        has_consumer = true;
+      } else {
+        bits.Intersect(descendants[e->dst()->id()]);
+      }
+    }
+    after.push_back(has_consumer ? std::move(bits) : descendants[n->id()]);
+  }
+  auto interferes = [&](int a, int b) {
+    return !after[a].Test(producer_index[candidates[b].node_id]) &&
+           !after[b].Test(producer_index[candidates[a].node_id]);
+  };
+
+  // Greedily assign each buffer the lowest offset that does not overlap an
+  // interfering buffer that was already placed.
+  const int num_buffers = candidates.size();
+  std::unique_ptr<MemoryPlan> plan(new MemoryPlan);
+  std::vector<std::pair<int64_t, int64_t>> ranges;
+  for (int b = 0; b < num_buffers; ++b) {
+    ranges.clear();
+    for (int placed = 0; placed < b; ++placed) {
+      if (interferes(b, placed)) {
+        const Buffer& other = candidates[placed];
+        ranges.emplace_back(other.offset, other.offset + other.size);
+      }
+    }
+    std::sort(ranges.begin(), ranges.end());
+    int64_t offset = 0;
+    for (const auto& range : ranges) {
+      if (range.first - offset >= candidates[b].size) break;
+      offset = std::max(offset, range.second);
+    }
+    candidates[b].offset = offset;
+    plan->total_bytes_ =
+        std::max(plan->total_bytes_, offset + candidates[b].size);
+  }
+
+  plan->first_output_index_.resize(graph.num_node_ids(), 0);
+  plan->has_planned_output_.resize(graph.num_node_ids(), false);
+  int num_outputs = 0;
+  for (int id = 0; id < graph.num_node_ids(); ++id) {
+    plan->first_output_index_[id] = num_outputs;
+    const Node* n = graph.FindNodeId(id);
+    if (n != nullptr) num_outputs += n->num_outputs();
+  }
+  plan->output_buffer_index_.resize(num_outputs, -1);
+  for (int b = 0; b < num_buffers; ++b) {
+    const Buffer& buffer = candidates[b];
+    plan->output_buffer_index_[plan->first_output_index_[buffer.node_id] +
+                               buffer.output] = b;
+    plan->has_planned_output_[buffer.node_id] = true;
+  }
+  plan->buffers_ = std::move(candidates);
+  VLOG(1) << "Planned " << plan->buffers_.size() << " outputs into "
+          << plan->total_bytes_ << " bytes.";
+  return plan;
+}
+
+// Hands out one planned buffer.
+class PlannedMemory::BufferAllocator : public Allocator {
+ public:
+  void Init(PlannedMemory* memory, int index) {
+    memory_ = memory;
+    index_ = index;
+    const MemoryPlan::Buffer& buffer = memory->plan_->buffers()[index];
+    ptr_ = memory->block_ + buffer.offset;
+    size_ = buffer.size;
+  }
+
+  std::string Name() override { return "planned_memory"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    if (num_bytes <= size_ && alignment <= Allocator::kAllocatorAlignment &&
+        memory_->TryAcquire(index_)) {
+      return ptr_;
+    }
+    void* ptr =
+        memory_->fallback_->AllocateRaw(alignment, num_bytes, allocation_attr);
+    if (ptr != nullptr) memory_->AddFallbackAllocation();
+    return ptr;
+  }
+  void DeallocateRaw(void* ptr) override {
+    // Both calls may delete `this`.
+    if (ptr == ptr_) {
+      memory_->ReleaseBuffer(index_);
+    } else {
+      memory_->fallback_->DeallocateRaw(ptr);
+      memory_->RemoveFallbackAllocation();
+    }
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return memory_->fallback_->GetMemoryType();
+  }
+
+ private:
+  PlannedMemory* memory_ = nullptr;
+  int index_ = -1;
+  char* ptr_ = nullptr;
+  size_t size_ = 0;
+};
+
+PlannedMemory::PlannedMemory(const MemoryPlan* plan, Allocator* fallback)
+    : plan_(plan), fallback_(fallback) {
+  block_ = static_cast<char*>(fallback_->AllocateRaw(
+      Allocator::kAllocatorAlignment, plan_->total_bytes()));
+  if (block_ == nullptr) {
+    LOG(WARNING) << "Failed to allocate " << plan_->total_bytes()
+                 << " bytes for planned memory; allocating outputs "
+                 << "dynamically.";
+    return;
+  }
+  const int num_buffers = plan_->buffers().size();
+  buffer_allocators_.reset(new BufferAllocator[num_buffers]);
+  for (int i = 0; i < num_buffers; ++i) {
+    buffer_allocators_[i].Init(this, i);
+  }
+  output_allocators_.resize(plan_->output_buffer_index_.size(), nullptr);
+  for (size_t i = 0; i < output_allocators_.size(); ++i) {
+    const int index = plan_->output_buffer_index_[i];
+    if (index >= 0) output_allocators_[i] = &buffer_allocators_[index];
+  }
+}
+
+PlannedMemory::~PlannedMemory() {
+  if (block_ != nullptr) fallback_->DeallocateRaw(block_);
+}
+
+Allocator* const* PlannedMemory::OutputAllocators(int node_id) const {
+  if (block_ == nullptr ||
+      node_id >= static_cast<int>(plan_->has_planned_output_.size()) ||
+      !plan_->has_planned_output_[node_id]) {
+    return nullptr;
+  }
+  return &output_allocators_[plan_->first_output_index_[node_id]];
+}
+
+void PlannedMemory::Release() {
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    if (live_allocations_ > 0) return;
+  }
+  delete this;
+}
+
+bool PlannedMemory::TryAcquire(int index) {
+  const MemoryPlan::Buffer& buffer = plan_->buffers()[index];
+  mutex_lock l(mu_);
+  for (int live : live_buffers_) {
+    const MemoryPlan::Buffer& other = plan_->buffers()[live];
+    if (buffer.offset < other.offset + other.size &&
+        other.offset < buffer.offset + buffer.size) {
+      return false;
+    }
+  }
+  live_buffers_.push_back(index);
+  ++live_allocations_;
+  return true;
+}
+
+void PlannedMemory::ReleaseBuffer(int index) {
+  {
+    mutex_lock l(mu_);
+    auto it = std::find(live_buffers_.begin(), live_buffers_.end(), index);
+    DCHECK(it != live_buffers_.end());
+    *it = live_buffers_.back();
+    live_buffers_.pop_back();
+    if (--live_allocations_ > 0 || !released_) return;
+  }
+  delete this;
+}
+
+void PlannedMemory::AddFallbackAllocation() {
+  mutex_lock l(mu_);
+  ++live_allocations_;
+}
+
+void PlannedMemory::RemoveFallbackAllocation() {
+  {
+    mutex_lock l(mu_);
+    if (--live_allocations_ > 0 || !released_) return;
+  }
+  delete this;
+}
+
+}  // namespace tensorflow
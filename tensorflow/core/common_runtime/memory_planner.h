@@ -0,0 +1,149 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A static assignment of node outputs to offsets in a single block of memory.
+//
+// Only outputs whose size is known before execution are planned. The sizes
+// come from the "_output_shapes" attribute, as written for instance by
+// `GraphProperties::AnnotateOutputShapes()`. Two outputs may share memory only
+// if every consumer of one is a strict ancestor of the producer of the other,
+// so the plan is valid for any execution order that respects the graph edges.
+// Graphs with loops are not planned, since nodes in a loop run more than once
+// per step.
+class MemoryPlan {
+ public:
+  struct Buffer {
+    int node_id;
+    int output;
+    int64_t offset;
+    int64_t size;
+  };
+
+  // The maximum number of outputs that are planned. When a graph has more
+  // plannable outputs, the largest ones are planned.
+  static constexpr int kMaxBuffers = 4096;
+
+  // Returns a plan for `graph`, or nullptr if no output can be planned.
+  // `can_plan(node, output)` must return false for outputs that may outlive
+  // the step, or that need memory other than the default for the device.
+  static std::unique_ptr<MemoryPlan> Build(
+      const Graph& graph, const std::function<bool(const Node*, int)>& can_plan);
+
+  // The size of the block that all buffers are assigned into.
+  int64_t total_bytes() const { return total_bytes_; }
+
+  // The planned buffers, in no particular order.
+  const std::vector<Buffer>& buffers() const { return buffers_; }
+
+  // Returns the index in `buffers()` of the buffer assigned to output `output`
+  // of node `node_id`, or -1 if it is not planned.
+  int BufferIndex(int node_id, int output) const {
+    if (node_id >= static_cast<int>(first_output_index_.size())) return -1;
+    return output_buffer_index_[first_output_index_[node_id] + output];
+  }
+
+ private:
+  friend class PlannedMemory;
+
+  MemoryPlan() = default;
+
+  int64_t total_bytes_ = 0;
+  std::vector<Buffer> buffers_;
+  // Indexed by node id: the position of the node's first output in
+  // `output_buffer_index_`.
+  std::vector<int> first_output_index_;
+  // The buffer index of every node output, or -1 if it is not planned.
+  std::vector<int> output_buffer_index_;
+  // Indexed by node id: true iff any output of the node is planned.
+  std::vector<bool> has_planned_output_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryPlan);
+};
+
+// The memory for one execution of a `MemoryPlan`.
+//
+// Each planned buffer is handed out by its own `Allocator`, so allocating a
+// planned output does not go through the device allocator. A buffer is used
+// only if the request fits and no overlapping buffer is still alive, which
+// can happen when a kernel forwards its input to an output; otherwise the
+// request is forwarded to `fallback`.
+//
+// Tensors that outlive the step remain valid: an instance deletes itself once
+// Release() has been called and every allocation has been deallocated.
+class PlannedMemory {
+ public:
+  // Does not take ownership of `plan`, which must outlive the step, or of
+  // `fallback`, which must outlive this object.
+  PlannedMemory(const MemoryPlan* plan, Allocator* fallback);
+
+  // Returns an array indexed by output number of the allocators for the
+  // outputs of `node_id`, where unplanned outputs have a null allocator.
+  // Returns nullptr if none of its outputs are planned.
+  Allocator* const* OutputAllocators(int node_id) const;
+
+  // Marks the end of the step. The object is deleted once all of its
+  // allocations have been deallocated, which may be immediately.
+  void Release() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  class BufferAllocator;
+
+  ~PlannedMemory();
+
+  // Returns true if buffer `index` does not overlap a live buffer, and marks
+  // it as live.
+  bool TryAcquire(int index) TF_LOCKS_EXCLUDED(mu_);
+  // Marks buffer `index` as dead. Deletes `this` if it was the last
+  // allocation after Release().
+  void ReleaseBuffer(int index) TF_LOCKS_EXCLUDED(mu_);
+  // Records an allocation forwarded to `fallback_`.
+  void AddFallbackAllocation() TF_LOCKS_EXCLUDED(mu_);
+  void RemoveFallbackAllocation() TF_LOCKS_EXCLUDED(mu_);
+
+  const MemoryPlan* const plan_;  // Not owned.
+  Allocator* const fallback_;     // Not owned.
+  char* block_ = nullptr;
+  std::unique_ptr<BufferAllocator[]> buffer_allocators_;
+  // Laid out like `MemoryPlan::output_buffer_index_`.
+  std::vector<Allocator*> output_allocators_;
+
+  mutex mu_;
+  // Indices of the planned buffers that are currently allocated.
+  std::vector<int> live_buffers_ TF_GUARDED_BY(mu_);
+  int64_t live_allocations_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(PlannedMemory);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
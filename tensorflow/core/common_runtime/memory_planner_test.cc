@@ -0,0 +1,147 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/memory_planner.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Tensor V(const float val) {
+  Tensor tensor(DT_FLOAT, TensorShape({}));
+  tensor.scalar<float>()() = val;
+  return tensor;
+}
+
+void SetOutputShape(Node* n, const TensorShape& shape) {
+  n->AddAttr("_output_shapes", std::vector<PartialTensorShape>{shape});
+}
+
+bool CanPlanAll(const Node*, int) { return true; }
+
+class MemoryPlanTest : public ::testing::Test {
+ protected:
+  MemoryPlanTest() : graph_(OpRegistry::Global()) {}
+
+  std::unique_ptr<MemoryPlan> Build(
+      const std::function<bool(const Node*, int)>& can_plan = CanPlanAll) {
+    FixupSourceAndSinkEdges(&graph_);
+    return MemoryPlan::Build(graph_, can_plan);
+  }
+
+  const MemoryPlan::Buffer& BufferFor(const MemoryPlan& plan, const Node* n) {
+    const int index = plan.BufferIndex(n->id(), 0);
+    CHECK_GE(index, 0) << n->name();
+    return plan.buffers()[index];
+  }
+
+  Graph graph_;
+};
+
+TEST_F(MemoryPlanTest, NoShapes) {
+  Node* a = test::graph::Constant(&graph_, V(1.0));
+  test::graph::Unary(&graph_, "Relu", a);
+  EXPECT_EQ(Build(), nullptr);
+}
+
+TEST_F(MemoryPlanTest, ChainReusesDeadBuffers) {
+  // a -> b -> c -> d: `a` is dead once `b` has run, so `c` can reuse it.
+  Node* a = test::graph::Constant(&graph_, V(1.0));
+  Node* b = test::graph::Unary(&graph_, "Relu", a);
+  Node* c = test::graph::Unary(&graph_, "Relu", b);
+  Node* d = test::graph::Unary(&graph_, "Relu", c);
+  for (Node* n : {a, b, c, d}) SetOutputShape(n, TensorShape({256}));
+
+  std::unique_ptr<MemoryPlan> plan = Build();
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->buffers().size(), 4);
+  EXPECT_EQ(plan->total_bytes(), 2 * 1024);
+  EXPECT_NE(BufferFor(*plan, a).offset, BufferFor(*plan, b).offset);
+  EXPECT_NE(BufferFor(*plan, b).offset, BufferFor(*plan, c).offset);
+  EXPECT_NE(BufferFor(*plan, c).offset, BufferFor(*plan, d).offset);
+  EXPECT_EQ(BufferFor(*plan, a).offset, BufferFor(*plan, c).offset);
+}
+
+TEST_F(MemoryPlanTest, ConcurrentBranchesDoNotShare) {
+  // `b` and `c` may run concurrently, and `a` is alive until both have run.
+  Node* a = test::graph::Constant(&graph_, V(1.0));
+  Node* b = test::graph::Unary(&graph_, "Relu", a);
+  Node* c = test::graph::Unary(&graph_, "Relu", a);
+  Node* d = test::graph::Binary(&graph_, "Add", b, c);
+  for (Node* n : {a, b, c, d}) SetOutputShape(n, TensorShape({256}));
+
+  std::unique_ptr<MemoryPlan> plan = Build();
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->total_bytes(), 3 * 1024);
+  // Only `d` can reuse the buffer of `a`.
+  EXPECT_EQ(BufferFor(*plan, a).offset, BufferFor(*plan, d).offset);
+}
+
+TEST_F(MemoryPlanTest, RespectsCanPlan) {
+  Node* a = test::graph::Constant(&graph_, V(1.0));
+  Node* b = test::graph::Unary(&graph_, "Relu", a);
+  for (Node* n : {a, b}) SetOutputShape(n, TensorShape({16}));
+
+  std::unique_ptr<MemoryPlan> plan =
+      Build([a](const Node* n, int output) { return n != a; });
+  ASSERT_NE(plan, nullptr);
+  EXPECT_EQ(plan->BufferIndex(a->id(), 0), -1);
+  EXPECT_GE(plan->BufferIndex(b->id(), 0), 0);
+}
+
+TEST_F(MemoryPlanTest, PlannedMemoryFallsBackWhenBufferIsBusy) {
+  Node* a = test::graph::Constant(&graph_, V(1.0));
+  Node* b = test::graph::Unary(&graph_, "Relu", a);
+  Node* c = test::graph::Unary(&graph_, "Relu", b);
+  for (Node* n : {a, b, c}) SetOutputShape(n, TensorShape({256}));
+  std::unique_ptr<MemoryPlan> plan = Build();
+  ASSERT_NE(plan, nullptr);
+  ASSERT_EQ(BufferFor(*plan, a).offset, BufferFor(*plan, c).offset);
+
+  PlannedMemory* memory = new PlannedMemory(plan.get(), cpu_allocator());
+  Allocator* a_allocator = memory->OutputAllocators(a->id())[0];
+  Allocator* c_allocator = memory->OutputAllocators(c->id())[0];
+  ASSERT_NE(a_allocator, nullptr);
+  ASSERT_NE(c_allocator, nullptr);
+
+  Tensor a_out(a_allocator, DT_FLOAT, TensorShape({256}));
+  {
+    // `a` is still alive, e.g. because it was forwarded, so `c` must not
+    // reuse its buffer.
+    Tensor c_out(c_allocator, DT_FLOAT, TensorShape({256}));
+    EXPECT_NE(a_out.data(), c_out.data());
+  }
+  void* a_data = a_out.data();
+  a_out = Tensor();
+  Tensor c_out(c_allocator, DT_FLOAT, TensorShape({256}));
+  EXPECT_EQ(c_out.data(), a_data);
+  // Larger than planned: allocated dynamically.
+  Tensor large(c_allocator, DT_FLOAT, TensorShape({1024}));
+  EXPECT_TRUE(large.IsInitialized());
+
+  // `c_out` and `large` outlive the step.
+  memory->Release();
+  c_out.flat<float>().setZero();
+  large.flat<float>().setZero();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,154 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Appends `piece` to `material` with its length, so that different sequences
+// of pieces never produce the same material.
+void AddPiece(StringPiece piece, string* material) {
+  absl::StrAppend(material, piece.size(), ":", piece);
+}
+
+void AddProto(const protobuf::MessageLite& proto, string* material) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AddPiece(serialized, material);
+}
+
+void AddStrings(const std::vector<string>& pieces, string* material) {
+  AddPiece(absl::StrCat(pieces.size()), material);
+  for (const string& piece : pieces) AddPiece(piece, material);
+}
+
+}  // namespace
+
+OptimizedFunctionGraphCache* OptimizedFunctionGraphCache::Global() {
+  static OptimizedFunctionGraphCache* cache =
+      []() -> OptimizedFunctionGraphCache* {
+    bool enabled = false;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_ENABLE_FUNCTION_GRAPH_CACHE", false,
+                                   &enabled));
+    if (!enabled) return nullptr;
+    VLOG(1) << "Caching optimized function graphs";
+    return new OptimizedFunctionGraphCache();
+  }();
+  return cache;
+}
+
+string OptimizedFunctionGraphCache::Key(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const FunctionLibraryDefinition& lib_def, const DeviceSet& dev_set,
+    const std::vector<CompositeDevice*>& composite_devices,
+    const Device* default_device) {
+  string material;
+  AddPiece(TF_VERSION_STRING, &material);
+  AddPiece(absl::StrCat(TF_GRAPH_DEF_VERSION), &material);
+
+  // The function, the functions it calls and its attrs.
+  AddPiece(Canonicalize(function_name, attrs), &material);
+  const FunctionDef* fdef = lib_def.Find(function_name);
+  if (fdef != nullptr) {
+    AddProto(*fdef, &material);
+    AddProto(lib_def.ReachableDefinitions(*fdef).ToProto(), &material);
+  }
+
+  // The options read by OptimizeFunctionGraph(). Unlike Canonicalize(), which
+  // keys the runtime's own table, this doesn't depend on `options.lib_def`,
+  // whose address differs across runtimes.
+  AddPiece(options.target, &material);
+  AddStrings(options.input_devices, &material);
+  AddStrings(options.output_devices, &material);
+  std::vector<int> resource_args;
+  for (const auto& it : options.input_resource_dtypes_and_shapes) {
+    resource_args.push_back(it.first);
+  }
+  std::sort(resource_args.begin(), resource_args.end());
+  for (int index : resource_args) {
+    const DtypeAndPartialTensorShape& resource =
+        options.input_resource_dtypes_and_shapes.at(index);
+    AddPiece(absl::StrCat(index, ":", DataTypeString(resource.dtype), ":",
+                          resource.shape.DebugString()),
+             &material);
+  }
+  AddPiece(FunctionLibraryRuntime::ExecutorType(options, attrs), &material);
+  AddProto(options.config_proto, &material);
+  AddPiece(options.xla_compile_device_type, &material);
+  for (bool option : {options.is_component_function,
+                      options.shape_inference_on_tfe_dialect_import,
+                      options.optimize_graph_fn != nullptr}) {
+    AddPiece(option ? "1" : "0", &material);
+  }
+
+  // The devices the graph is placed on.
+  std::vector<string> devices;
+  for (const Device* device : dev_set.devices()) {
+    devices.push_back(absl::StrCat(device->name(), ":", device->device_type()));
+  }
+  std::sort(devices.begin(), devices.end());
+  AddStrings(devices, &material);
+  for (const CompositeDevice* device : composite_devices) {
+    AddPiece(device->name(), &material);
+    AddStrings(*device->underlying_devices(), &material);
+  }
+  AddPiece(default_device == nullptr ? "" : default_device->name(), &material);
+
+  const Fprint128 fingerprint = Fingerprint128(material);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+StatusOr<OptimizedFunctionGraphInfo> OptimizedFunctionGraphCache::Lookup(
+    const string& key) {
+  std::shared_ptr<const OptimizedFunctionGraph> graph;
+  {
+    mutex_lock lock(mu_);
+    auto it = graphs_.find(key);
+    if (it == graphs_.end()) {
+      return errors::NotFound("No optimized function graph cached under ",
+                              key);
+    }
+    graph = it->second;
+  }
+  // Converts outside of the lock, since it copies the whole graph.
+  return OptimizedFunctionGraphInfo::FromProto(*graph);
+}
+
+void OptimizedFunctionGraphCache::Insert(
+    const string& key, const OptimizedFunctionGraphInfo& info) {
+  auto graph = std::make_shared<const OptimizedFunctionGraph>(
+      OptimizedFunctionGraphInfo::ToProto(info));
+  mutex_lock lock(mu_);
+  if (graphs_.size() >= kMaxEntries) graphs_.clear();
+  graphs_[key] = std::move(graph);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,78 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/composite_device.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_info.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/optimized_function_graph.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A process-wide cache of the graphs output by OptimizeFunctionGraph(), shared
+// by the ProcessFunctionLibraryRuntimes of all sessions. A server loading many
+// SavedModels with identical functions then runs the function optimization
+// passes and the placer once per function, and each later instantiation only
+// deserializes the cached OptimizedFunctionGraph.
+//
+// Thread-safe.
+class OptimizedFunctionGraphCache {
+ public:
+  // Maximum number of cached graphs. The cache is cleared when it is full.
+  static constexpr int kMaxEntries = 1000;
+
+  OptimizedFunctionGraphCache() = default;
+
+  // Returns the cache used by ProcessFunctionLibraryRuntime, or nullptr if
+  // TF_ENABLE_FUNCTION_GRAPH_CACHE isn't set to true.
+  static OptimizedFunctionGraphCache* Global();
+
+  // Returns a fingerprint of everything OptimizeFunctionGraph() depends on:
+  // the function and the functions it calls in `lib_def`, its attrs, the
+  // instantiation options and the devices. Options that can't be fingerprinted,
+  // such as `options.optimize_graph_fn`, are assumed to behave the same across
+  // runtimes.
+  static string Key(const string& function_name, AttrSlice attrs,
+                    const FunctionLibraryRuntime::InstantiateOptions& options,
+                    const FunctionLibraryDefinition& lib_def,
+                    const DeviceSet& dev_set,
+                    const std::vector<CompositeDevice*>& composite_devices,
+                    const Device* default_device);
+
+  // Returns the graph cached under `key`, or a NotFound error.
+  StatusOr<OptimizedFunctionGraphInfo> Lookup(const string& key);
+
+  // Caches `info` under `key`.
+  void Insert(const string& key, const OptimizedFunctionGraphInfo& info);
+
+ private:
+  mutex mu_;
+  absl::flat_hash_map<string, std::shared_ptr<const OptimizedFunctionGraph>>
+      graphs_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_FUNCTION_GRAPH_CACHE_H_
@@ -0,0 +1,123 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/function_testlib.h"
+#include "tensorflow/core/common_runtime/optimize_function_graph_utils.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/status.h"
+
+namespace tensorflow {
+namespace {
+using ::testing::ElementsAre;
+
+class OptimizedFunctionGraphCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    SessionOptions options;
+    options.config.mutable_device_count()->insert({"CPU", 2});
+    TF_ASSERT_OK(DeviceFactory::AddDevices(options, "/job:a/replica:0/task:0",
+                                           &devices_));
+    device_set_ = std::make_shared<DeviceSet>();
+    for (const auto& device : devices_) device_set_->AddDevice(device.get());
+  }
+
+  // Returns a library with `fdef`, as the runtime of each session has its own.
+  static std::unique_ptr<FunctionLibraryDefinition> MakeLibDef(
+      const FunctionDef& fdef) {
+    FunctionDefLibrary proto;
+    *proto.add_function() = fdef;
+    return std::make_unique<FunctionLibraryDefinition>(OpRegistry::Global(),
+                                                       proto);
+  }
+
+  string Key(const FunctionLibraryRuntime::InstantiateOptions& opts,
+             const FunctionLibraryDefinition& lib_def,
+             const DeviceSet& device_set) {
+    return OptimizedFunctionGraphCache::Key("FindDevice", {}, opts, lib_def,
+                                            device_set,
+                                            /*composite_devices=*/{},
+                                            devices_[1].get());
+  }
+
+  std::vector<std::unique_ptr<Device>> devices_;
+  std::shared_ptr<DeviceSet> device_set_;
+};
+
+TEST_F(OptimizedFunctionGraphCacheTest, KeyDependsOnInputs) {
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  const auto lib_def = MakeLibDef(test::function::FindDevice());
+  const string key = Key(opts, *lib_def, *device_set_);
+
+  // Same function in the library of another runtime.
+  FunctionLibraryRuntime::InstantiateOptions other_lib_def_opts = opts;
+  const auto other_lib_def = MakeLibDef(test::function::FindDevice());
+  other_lib_def_opts.lib_def = other_lib_def.get();
+  EXPECT_EQ(key, Key(other_lib_def_opts, *other_lib_def, *device_set_));
+
+  FunctionDef other_fdef = test::function::FindDevice();
+  other_fdef.mutable_node_def(0)->set_device("/device:CPU:1");
+  EXPECT_NE(key, Key(opts, *MakeLibDef(other_fdef), *device_set_));
+
+  FunctionLibraryRuntime::InstantiateOptions other_opts = opts;
+  other_opts.config_proto.set_allow_soft_placement(true);
+  EXPECT_NE(key, Key(other_opts, *lib_def, *device_set_));
+
+  DeviceSet other_device_set;
+  other_device_set.AddDevice(devices_[0].get());
+  EXPECT_NE(key, Key(opts, *lib_def, other_device_set));
+}
+
+TEST_F(OptimizedFunctionGraphCacheTest, LookupAndInsert) {
+  FunctionLibraryRuntime::InstantiateOptions opts;
+  opts.is_multi_device_function = true;
+  const auto lib_def = MakeLibDef(test::function::FindDevice());
+  const string key = Key(opts, *lib_def, *device_set_);
+
+  OptimizedFunctionGraphCache cache;
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup(key).status()));
+
+  StatusOr<OptimizedFunctionGraphInfo> optimized = OptimizeFunctionGraph(
+      "FindDevice", {}, opts, device_set_, lib_def.get(),
+      /*composite_devices=*/{}, devices_[0].get(), devices_[1].get(),
+      Env::Default());
+  TF_ASSERT_OK(optimized.status());
+  cache.Insert(key, *optimized);
+
+  StatusOr<OptimizedFunctionGraphInfo> cached = cache.Lookup(key);
+  TF_ASSERT_OK(cached.status());
+  EXPECT_EQ(cached->name, "FindDevice");
+  EXPECT_EQ(cached->num_return_nodes, 1);
+  EXPECT_THAT(cached->ret_types, ElementsAre(DT_STRING));
+  // The cached graph keeps the placement.
+  for (const Node* node : cached->function_graph->op_nodes()) {
+    EXPECT_FALSE(node->assigned_device_name().empty()) << node->name();
+  }
+}
+
+}  // namespace
+}  // namespace tensorflow
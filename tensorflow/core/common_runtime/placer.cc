@@ -259,6 +259,14 @@ Status Placer::Run(const GraphOptimizationPassOptions& options) {
       }
     }
 
+    // Heuristic C: If the node would be placed on a CPU device, but its
+    // first data input is on a CPU device that is bound to another NUMA node,
+    // then place the node with its input, so that a chain of ops stays on the
+    // NUMA node it started on instead of moving its data across sockets.
+    if (assigned_device == -1) {
+      assigned_device = NumaLocalInputDevice(node, *devices);
+    }
+
     // Provide the default, if necessary.
     if (assigned_device == -1) {
       assigned_device = graph_->InternDeviceName((*devices)[0]->name());
@@ -319,6 +327,27 @@ Status Placer::Run(const GraphOptimizationPassOptions& options) {
   return OkStatus();
 }
 
+int Placer::NumaLocalInputDevice(const Node* node,
+                                 const std::vector<Device*>& devices) const {
+  const Device* default_device = devices[0];
+  if (default_device->device_type() != DEVICE_CPU) return -1;
+  const Edge* input_edge;
+  if (node->num_inputs() == 0 || !node->input_edge(0, &input_edge).ok()) {
+    return -1;
+  }
+  const Node* input = input_edge->src();
+  if (!input->has_assigned_device_name()) return -1;
+  const Device* input_device =
+      devices_->FindDeviceByName(input->assigned_device_name());
+  if (input_device == nullptr || input_device->device_type() != DEVICE_CPU ||
+      input_device->attributes().locality().numa_node() ==
+          default_device->attributes().locality().numa_node() ||
+      !CanAssignToDevice(input->assigned_device_name(), devices)) {
+    return -1;
+  }
+  return input->assigned_device_name_index();
+}
+
 bool Placer::CanAssignToDevice(const string& candidate_device_name,
                                const std::vector<Device*>& devices) const {
   if (!candidate_device_name.empty()) {
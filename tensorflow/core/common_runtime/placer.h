@@ -95,6 +95,12 @@ class Placer {
   bool CanAssignToDevice(const string& candidate_device_name,
                          const std::vector<Device*>& devices) const;
 
+  // Returns the assigned device of the first input of 'node' if that is a
+  // CPU device in 'devices' on a different NUMA node than 'devices[0]', or
+  // -1 otherwise.
+  int NumaLocalInputDevice(const Node* node,
+                           const std::vector<Device*>& devices) const;
+
   Graph* const graph_;  // Not owned.
   const string function_name_;
   const FunctionLibraryDefinition* const flib_def_;  // Not owned.
@@ -100,6 +100,16 @@ class FakeDevice : public Device {
     return std::unique_ptr<Device>(new FakeDevice(device_attributes));
   }
 
+  static std::unique_ptr<Device> MakeDevice(const string& name,
+                                            const string& device_type,
+                                            int numa_node) {
+    DeviceAttributes device_attributes;
+    device_attributes.set_name(name);
+    device_attributes.set_device_type(device_type);
+    device_attributes.mutable_locality()->set_numa_node(numa_node);
+    return std::unique_ptr<Device>(new FakeDevice(device_attributes));
+  }
+
   static std::unique_ptr<Device> MakeCPU(const string& name) {
     return MakeDevice(name, "FakeCPU");
   }
@@ -168,6 +178,8 @@ REGISTER_KERNEL_BUILDER(Name("AssignGPU").Device("FakeGPU"), DummyOp);
 
 REGISTER_OP("TestInput").Output("a: float").Output("b: float");
 REGISTER_KERNEL_BUILDER(Name("TestInput").Device("FakeCPU"), DummyOp);
+REGISTER_KERNEL_BUILDER(Name("TestInput").Device(DEVICE_CPU), DummyOp);
+REGISTER_KERNEL_BUILDER(Name("TestRelu").Device(DEVICE_CPU), DummyOp);
 
 // Op producing an output that can be placed on CPU or GPU.
 REGISTER_OP("TestCPUGPUOutput").Output("a: float");
@@ -802,6 +814,62 @@ TEST_F(PlacerTest, TestIgnoreGeneratorHeuristicIfWrongDevice) {
   EXPECT_COLOCATED(g, "var_cpu", "assign");
 }
 
+// Heuristic C: ops follow their input to the CPU device of another NUMA node.
+TEST_F(PlacerTest, TestNumaLocalInputHeuristic) {
+  Graph g(OpRegistry::Global());
+  {  // Scope for temporary variables used to construct g.
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* input = ops::SourceOp("TestInput", b.opts().WithName("in"));
+    Node* relu = ops::UnaryOp("TestRelu", ops::NodeOut(input, 0),
+                              b.opts().WithName("relu"));
+    ops::UnaryOp("TestRelu", relu, b.opts().WithName("relu_2"));
+    ops::UnaryOp("TestRelu", ops::NodeOut(input, 1),
+                 b.opts().WithName("relu_3").WithDevice("/device:CPU:0"));
+    TF_EXPECT_OK(BuildGraph(b, &g));
+  }
+  GetNodeByName(g, "in")->set_assigned_device_name(
+      "/job:a/replica:0/task:0/device:CPU:1");
+
+  std::vector<std::unique_ptr<Device>> numa_devices;
+  DeviceSet devices;
+  for (int i = 0; i < 2; ++i) {
+    numa_devices.push_back(FakeDevice::MakeDevice(
+        strings::StrCat("/job:a/replica:0/task:0/device:CPU:", i), DEVICE_CPU,
+        /*numa_node=*/i));
+    devices.AddDevice(numa_devices.back().get());
+  }
+
+  TF_EXPECT_OK(Place(&g, &devices));
+  EXPECT_DEVICE_CONTAINS(g, "relu", "/device:CPU:1");
+  EXPECT_DEVICE_CONTAINS(g, "relu_2", "/device:CPU:1");
+  // Explicitly requested devices are respected.
+  EXPECT_DEVICE_CONTAINS(g, "relu_3", "/device:CPU:0");
+}
+
+// Without NUMA localities, ops are placed on the first CPU device.
+TEST_F(PlacerTest, TestNumaLocalInputHeuristicNeedsDistinctNumaNodes) {
+  Graph g(OpRegistry::Global());
+  {  // Scope for temporary variables used to construct g.
+    GraphDefBuilder b(GraphDefBuilder::kFailImmediately);
+    Node* input = ops::SourceOp("TestInput", b.opts().WithName("in"));
+    ops::UnaryOp("TestRelu", ops::NodeOut(input, 0), b.opts().WithName("relu"));
+    TF_EXPECT_OK(BuildGraph(b, &g));
+  }
+  GetNodeByName(g, "in")->set_assigned_device_name(
+      "/job:a/replica:0/task:0/device:CPU:1");
+
+  std::vector<std::unique_ptr<Device>> cpu_devices;
+  DeviceSet devices;
+  for (int i = 0; i < 2; ++i) {
+    cpu_devices.push_back(FakeDevice::MakeDevice(
+        strings::StrCat("/job:a/replica:0/task:0/device:CPU:", i), DEVICE_CPU));
+    devices.AddDevice(cpu_devices.back().get());
+  }
+
+  TF_EXPECT_OK(Place(&g, &devices));
+  EXPECT_DEVICE_CONTAINS(g, "relu", "/device:CPU:0");
+}
+
 TEST_F(PlacerTest, TestIgnoreGeneratorHeuristicIfWrongPartialDevice) {
   Graph g(OpRegistry::Global());
   {  // Scope for temporary variables used to construct g.
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/function_optimization_registry.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/optimize_function_graph_utils.h"
+#include "tensorflow/core/common_runtime/optimized_function_graph_cache.h"
 #include "tensorflow/core/common_runtime/partitioning_utils.h"
 #include "tensorflow/core/common_runtime/placer.h"
 #include "tensorflow/core/common_runtime/rendezvous_util.h"
@@ -412,6 +413,46 @@ Status FunctionRetsToTensors(const std::vector<FunctionRet>* function_rets,
   }
   return OkStatus();
 }
+
+// Runs OptimizeFunctionGraph(), or reuses the graph that a runtime of this
+// process already optimized for the same function, options and devices.
+StatusOr<OptimizedFunctionGraphInfo> OptimizeFunctionGraphOrReadFromCache(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const std::shared_ptr<DeviceSet>& dev_set,
+    const FunctionLibraryDefinition* input_lib_def,
+    const std::vector<CompositeDevice*>& composite_devices, Device* cpu_device,
+    Device* default_device, Env* env) {
+  OptimizedFunctionGraphCache* cache = OptimizedFunctionGraphCache::Global();
+  // The graph collector expects the graphs of every optimization stage.
+  if (cache == nullptr || options.graph_collector != nullptr) {
+    return OptimizeFunctionGraph(function_name, attrs, options, dev_set,
+                                 input_lib_def, composite_devices, cpu_device,
+                                 default_device, env);
+  }
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? input_lib_def : options.lib_def;
+  const string key = OptimizedFunctionGraphCache::Key(
+      function_name, attrs, options, *lib_def, *dev_set, composite_devices,
+      default_device);
+  StatusOr<OptimizedFunctionGraphInfo> cached = cache->Lookup(key);
+  if (cached.ok()) {
+    VLOG(1) << "Reusing the cached optimized graph of function \""
+            << function_name << "\"";
+    return cached;
+  }
+  if (!errors::IsNotFound(cached.status())) {
+    LOG(WARNING) << "Ignoring the cached optimized graph of function \""
+                 << function_name << "\": " << cached.status();
+  }
+  TF_ASSIGN_OR_RETURN(
+      OptimizedFunctionGraphInfo info,
+      OptimizeFunctionGraph(function_name, attrs, options, dev_set,
+                            input_lib_def, composite_devices, cpu_device,
+                            default_device, env));
+  cache->Insert(key, info);
+  return info;
+}
 }  // namespace
 
 ProcessFunctionLibraryRuntime::AsyncAttributes::Summary
@@ -558,7 +599,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
 
   const uint64 optimization_start_time_usecs = Env::Default()->NowMicros();
   TF_ASSIGN_OR_RETURN(auto optimized_graph_info,
-                      OptimizeFunctionGraph(
+                      OptimizeFunctionGraphOrReadFromCache(
                           function_name, attrs, options, dev_set, lib_def_,
                           composite_devices, cpu_device, default_device, env_));
 
@@ -911,6 +952,8 @@ Status ProcessFunctionLibraryRuntime::RunMultiDeviceSync(
   }
 
   FunctionLibraryRuntime::Options opts_copy = opts;
+  // Retval indices of the components differ from those of the function.
+  opts_copy.retval_allocators = nullptr;
 
   // Sort the subgraphs topologically before execution to avoid deadlock:
   //
@@ -1023,6 +1066,8 @@ void ProcessFunctionLibraryRuntime::RunMultiDeviceAsync(
   }
 
   FunctionLibraryRuntime::Options opts_copy = opts;
+  // Retval indices of the components differ from those of the function.
+  opts_copy.retval_allocators = nullptr;
   for (const auto& pair : data->glue_) {
     const string& target = pair.first;
     const ComponentFunctionData& comp_data = pair.second;
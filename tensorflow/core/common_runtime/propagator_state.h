@@ -133,8 +133,21 @@ class PropagatorState {
           counts(*pending_counts) {  // Initialize with copy of *pending_counts
     }
 
-    const int64_t
-        iter_num;  // The index of this iteration in the enclosing loop.
+    // Prepares a finished iteration state to be reused as iteration
+    // `new_iter_num` of the same frame, which saves reallocating the input
+    // tensors and pending counts for every iteration of long loops.
+    void Reset(int64_t new_iter_num, const PendingCounts* pending_counts,
+               int total_input_tensors) {
+      iter_num = new_iter_num;
+      for (int i = 0; i < total_input_tensors; ++i) {
+        input_tensors[i].ClearVal();
+      }
+      outstanding_ops = 0;
+      outstanding_frame_count = 0;
+      counts.CopyFrom(*pending_counts);
+    }
+
+    int64_t iter_num;  // The index of this iteration in the enclosing loop.
 
     // One copy per iteration. For iteration k, i-th node's j-th input is in
     // input_tensors[k][immutable_state_.nodes[i].input_start + j]. An entry is
@@ -284,6 +297,10 @@ class PropagatorState {
     gtl::InlinedVector<IterationState*, 12> iterations;
     IterationState** const iterations_raw TF_GUARDED_BY(mu);
     IterationState* iterations_first TF_GUARDED_BY(mu);
+    // The state of the last completed iteration, reused by the next new
+    // iteration. A loop creates and completes iterations at the same pace, so
+    // a single spare state is enough to make iterations allocation free.
+    IterationState* free_iteration TF_GUARDED_BY(mu) = nullptr;
 
    public:
     // The NextIteration nodes to enter a new iteration. If the number of
@@ -417,6 +434,7 @@ class PropagatorState {
         delete iterations[i];
         iterations[i] = nullptr;
       }
+      delete free_iteration;
     }
 
    private:
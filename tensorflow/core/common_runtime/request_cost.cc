@@ -36,4 +36,16 @@ absl::flat_hash_map<std::string, absl::Duration> RequestCost::GetCosts() const {
   return cost_map_;
 }
 
+void RequestCost::RecordBatchMetrics(
+    const std::vector<BatchMetrics>& batch_metrics) {
+  absl::MutexLock lock(&mutex_);
+  batch_metrics_.insert(batch_metrics_.end(), batch_metrics.begin(),
+                        batch_metrics.end());
+}
+
+std::vector<RequestCost::BatchMetrics> RequestCost::GetBatchMetrics() const {
+  absl::MutexLock lock(&mutex_);
+  return batch_metrics_;
+}
+
 }  // namespace tensorflow
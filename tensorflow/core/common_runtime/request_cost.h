@@ -16,12 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_REQUEST_COST_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_REQUEST_COST_H_
 
+#include <cstdint>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 
 namespace tensorflow {
@@ -39,11 +41,32 @@ class RequestCost {
   // rpc request, when all the costs have been collected.
   absl::flat_hash_map<std::string, absl::Duration> GetCosts() const;
 
+  // Describes a batch that (part of) the request was processed in, so that
+  // the request's share of the batch costs can be audited.
+  struct BatchMetrics {
+    // The size of the processed batch, including padding.
+    int64_t processed_size = 0;
+    // The size of the request's part of the batch.
+    int64_t input_size = 0;
+    // The padding added to the batch.
+    int64_t padding_size = 0;
+    // The costs of the whole batch, by cost type.
+    absl::flat_hash_map<std::string, absl::Duration> batch_costs;
+  };
+
+  // Records the batches the request was processed in. It's thread-safe.
+  void RecordBatchMetrics(const std::vector<BatchMetrics>& batch_metrics);
+
+  // Gets the batches the request was processed in, in recording order. It's
+  // thread-safe.
+  std::vector<BatchMetrics> GetBatchMetrics() const;
+
  private:
   mutable absl::Mutex mutex_;
   // Map from cost type to cost.
   absl::flat_hash_map<std::string, absl::Duration> cost_map_
       ABSL_GUARDED_BY(mutex_);
+  std::vector<BatchMetrics> batch_metrics_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace tensorflow
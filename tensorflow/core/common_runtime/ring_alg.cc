@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
 #include <utility>
@@ -39,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 // Set true for greater intelligibility of debug mode log messages.
 #define READABLE_KEYS false
@@ -53,6 +55,12 @@ constexpr size_t kMaxChunkSizeBytes = (4 * 1024 * 1024);
 // through the collectives API. A reasonable value would be a small
 // multiple of the number of NICs adjacent to each device.
 constexpr int kMaxSubdivsPerDeviceDefault = 2;
+// Both may be overridden by TF_RING_MAX_CHUNK_SIZE_BYTES and
+// TF_RING_MAX_SUBDIVS_PER_DEVICE, which must then be set alike in every task.
+// Since every subdivision keeps its chunks in flight at once, more and smaller
+// chunks pipeline deeper, which pays off on links where the per-hop latency
+// rather than the bandwidth dominates.  The latter also subdivides the
+// collectives that do not ask for subdivisions (max_subdivs_per_device == -1).
 
 namespace tensorflow {
 namespace {
@@ -107,12 +115,34 @@ RingAlg::RingAlg(CollectiveType type, const string& name)
       num_subdivs_(-1) {}
 
 namespace {
+size_t MaxChunkSizeBytes() {
+  static const size_t max_chunk_size_bytes = [] {
+    int64_t value;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_RING_MAX_CHUNK_SIZE_BYTES",
+                                    kMaxChunkSizeBytes, &value));
+    return value > 0 ? static_cast<size_t>(value) : kMaxChunkSizeBytes;
+  }();
+  return max_chunk_size_bytes;
+}
+
+// Returns 0 if TF_RING_MAX_SUBDIVS_PER_DEVICE is not set.
+int MaxSubdivsPerDeviceOverride() {
+  static const int max_subdivs_per_device = [] {
+    int64_t value;
+    TF_CHECK_OK(
+        ReadInt64FromEnvVar("TF_RING_MAX_SUBDIVS_PER_DEVICE", 0, &value));
+    return static_cast<int>(std::max<int64_t>(value, 0));
+  }();
+  return max_subdivs_per_device;
+}
+
 Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
   // This function generates subdivision_offsets. Expect it to be empty when
   // called.
   DCHECK(col_params->instance.impl_details.subdiv_offsets.empty());
 
-  if (col_params->instance.impl_details.max_subdivs_per_device == -1) {
+  if (col_params->instance.impl_details.max_subdivs_per_device == -1 &&
+      MaxSubdivsPerDeviceOverride() == 0) {
     col_params->instance.impl_details.subdiv_offsets = {0};
     VLOG(2) << "Limiting to 1 subdivision as max_subdivs_per_device == -1";
     return OkStatus();
@@ -123,10 +153,13 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
   }
   const int kAvgDevPerTask =
       col_params->group.group_size / col_params->group.num_tasks;
-  const int max_subdivs_per_device =
+  int max_subdivs_per_device =
       (col_params->instance.impl_details.max_subdivs_per_device > 0)
           ? col_params->instance.impl_details.max_subdivs_per_device
           : kMaxSubdivsPerDeviceDefault;
+  if (MaxSubdivsPerDeviceOverride() > 0) {
+    max_subdivs_per_device = MaxSubdivsPerDeviceOverride();
+  }
   const int kMaxNumSubdivs = max_subdivs_per_device * kAvgDevPerTask;
   if (kMaxNumSubdivs <= 0) {
     return errors::Internal("Unexpected kMaxNumSubdivs ", kMaxNumSubdivs,
@@ -147,7 +180,7 @@ Status GenerateSubdivsInCollectiveParams(CollectiveParams* col_params) {
     chunk_size = tensor_size / num_chunks;
     VLOG(2) << "num_subdivs " << num_subdivs << " num_chunks " << num_chunks
             << " chunk_size " << chunk_size;
-  } while (chunk_size > kMaxChunkSizeBytes && num_subdivs < kMaxNumSubdivs);
+  } while (chunk_size > MaxChunkSizeBytes() && num_subdivs < kMaxNumSubdivs);
   if (num_subdivs <= 0) {
     return errors::Internal("Unexpected num_subdivs ", num_subdivs, " in ",
                             col_params->instance.impl_details.collective_name);
@@ -404,11 +437,13 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  Tensor* src_tensor =
+      rf->wire_chunk.IsInitialized() ? &rf->wire_chunk : &rf->chunk;
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), src_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
       done);
 }
@@ -424,6 +459,7 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  if (rf->wire_chunk.IsInitialized()) dst_tensor = &rf->wire_chunk;
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
@@ -19,7 +19,9 @@ limitations under the License.
 #include <atomic>
 #include <functional>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/collective_util.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
@@ -28,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/bfloat16.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -38,10 +41,29 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 
 namespace tensorflow {
+namespace {
+
+// Returns the rounding error of the chunk `key` sent as bfloat16 by a previous
+// execution, or zeros if there is none of `num_elements`.  The tensor is
+// shared, so updates to it are seen by the next execution.
+Tensor GetWireResidual(const string& key, int64_t num_elements) {
+  static mutex* mu = new mutex;
+  static auto* residuals = new absl::flat_hash_map<string, Tensor>;
+  mutex_lock l(*mu);
+  Tensor& residual = (*residuals)[key];
+  if (!residual.IsInitialized() || residual.NumElements() != num_elements) {
+    residual = Tensor(DT_FLOAT, TensorShape({num_elements}));
+    residual.flat<float>().setZero();
+  }
+  return residual;
+}
+
+}  // namespace
 
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
@@ -61,6 +83,9 @@ void RingReducer::Run(StatusCallback done) {
 
   done_ = std::move(done);
   group_size_ = col_params_->group.group_size;
+  bf16_wire_ = col_params_->instance.impl_details.wire_dtype == DT_BFLOAT16 &&
+               col_params_->instance.data_type == DT_FLOAT &&
+               col_params_->group.device_type == DEVICE_CPU;
   num_subdivs_ = static_cast<int>(
       col_params_->instance.impl_details.subdiv_permutations.size());
   CHECK_GT(num_subdivs_, 0);
@@ -167,6 +192,37 @@ void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
   if (rf->do_recv) {
     rf->tmp_chunk = ca_->TempChunk(rf->sc_idx);
   }
+  if (bf16_wire_ && ca_->ChunkBytes(rf->sc_idx) > 0) {
+    rf->wire_chunk =
+        Tensor(DT_BFLOAT16, TensorShape({rf->chunk.NumElements()}));
+  }
+}
+
+void RingReducer::EncodeChunk(RingField* rf) {
+  const int64_t n = rf->chunk.NumElements();
+  float* chunk = rf->chunk.flat<float>().data();
+  bfloat16* wire = rf->wire_chunk.flat<bfloat16>().data();
+  if (rf->second_pass) {
+    RoundFloatToBFloat16(chunk, wire, n);
+    BFloat16ToFloat(wire, chunk, n);
+    return;
+  }
+  Tensor residual_tensor = GetWireResidual(
+      strings::StrCat(col_params_->group.group_key, ":",
+                      col_params_->instance.instance_key, ":",
+                      col_params_->default_rank, ":", rf->sc_idx),
+      n);
+  float* residual = residual_tensor.flat<float>().data();
+  for (int64_t i = 0; i < n; ++i) {
+    const float value = chunk[i] + residual[i];
+    wire[i] = static_cast<bfloat16>(value);
+    residual[i] = value - static_cast<float>(wire[i]);
+  }
+}
+
+void RingReducer::DecodeChunk(RingField* rf, Tensor* dst) {
+  BFloat16ToFloat(rf->wire_chunk.flat<bfloat16>().data(),
+                  dst->flat<float>().data(), dst->NumElements());
 }
 
 // At the beginning of the algorithm initialize a RingField struct for
@@ -212,7 +268,13 @@ bool RingReducer::RunAsyncParts() {
   int field_done_count = 0;
   int send_pending_count = 0;
   int recv_pending_count = 0;
+  int reduce_pending_count = 0;
   std::atomic<bool> aborted(false);
+  // On CPU the reductions run off this thread, so that sends and receives of
+  // other fields are dispatched while a chunk is being reduced.  On GPU they
+  // are only enqueued on a stream.
+  const bool async_reduce = col_params_->group.device_type == DEVICE_CPU;
+  std::vector<bool> reduce_pending(rfv_.size(), false);
 
   {
     profiler::TraceMe activity("Loop", profiler::TraceMeLevel::kInfo);
@@ -252,8 +314,29 @@ bool RingReducer::RunAsyncParts() {
           case RF_RECV:
             CHECK_GT(recv_pending_count, 0);
             --recv_pending_count;
+            if (bf16_wire_) {
+              DecodeChunk(rf, rf->second_pass ? &rf->chunk : &rf->tmp_chunk);
+            }
             if (!rf->second_pass) {
               rf->action = RF_REDUCE;
+              if (async_reduce) {
+                reduce_pending[rf->sc_idx] = true;
+                ++reduce_pending_count;
+                col_ctx_->col_exec->RunClosure(
+                    [this, rf, &ready_queue, &aborted]() {
+                      Status s = collective_util::ComputeBinOp(
+                          col_ctx_->op_ctx, col_ctx_->op_params,
+                          col_ctx_->device, col_params_->merge_op,
+                          &rf->chunk, &rf->tmp_chunk);
+                      if (!s.ok()) {
+                        aborted = true;
+                        StartAbort(s);
+                      }
+                      ready_queue.Enqueue(rf);
+                    });
+                dispatched = true;
+                break;
+              }
               Status s = collective_util::ComputeBinOp(
                   col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
                   col_params_->merge_op, &rf->chunk, &rf->tmp_chunk);
@@ -266,6 +349,10 @@ bool RingReducer::RunAsyncParts() {
             }
             break;
           case RF_REDUCE:
+            if (reduce_pending[rf->sc_idx]) {
+              reduce_pending[rf->sc_idx] = false;
+              --reduce_pending_count;
+            }
             if (!rf->second_pass && col_params_->final_op && rf->is_final) {
               rf->action = RF_FINALIZE;
               group_size_tensor_ready_.WaitForNotification();
@@ -286,6 +373,7 @@ bool RingReducer::RunAsyncParts() {
           case RF_SEND_READY:
             if (rf->do_send) {
               rf->action = RF_SEND;
+              if (bf16_wire_) EncodeChunk(rf);
               auto send_complete = [this, rf, &ready_queue,
                                     &aborted](Status s) {
                 if (!s.ok()) {
@@ -324,8 +412,14 @@ bool RingReducer::RunAsyncParts() {
     if (aborted) {
       // All of the pending data actions should be aborted; field the
       // callbacks and clear the queue before quitting.
-      while ((send_pending_count > 0) || (recv_pending_count > 0)) {
+      while ((send_pending_count > 0) || (recv_pending_count > 0) ||
+             (reduce_pending_count > 0)) {
         RingField* rf = ready_queue.Dequeue();
+        if (reduce_pending[rf->sc_idx]) {
+          reduce_pending[rf->sc_idx] = false;
+          --reduce_pending_count;
+          continue;
+        }
         switch (rf->action) {
           case RF_RECV:
             --recv_pending_count;
@@ -342,6 +436,7 @@ bool RingReducer::RunAsyncParts() {
 
   CHECK_EQ(send_pending_count, 0);
   CHECK_EQ(recv_pending_count, 0);
+  CHECK_EQ(reduce_pending_count, 0);
 
   VLOG(2) << this << " device=" << col_ctx_->device_name << " finish;"
           << " final value " << TensorDebugString(ca_->Value());
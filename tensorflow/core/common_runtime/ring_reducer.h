@@ -28,6 +28,13 @@ namespace tensorflow {
 class Device;
 
 // Ring-algorithm implementation of collective all-reduce.
+//
+// If impl_details.wire_dtype is DT_BFLOAT16, a DT_FLOAT reduction on CPU sends
+// its chunks as bfloat16 and accumulates them as float.  The rounding error of
+// each chunk sent while reducing is kept per collective instance and added to
+// the same chunk of its next execution, so that it is delayed rather than
+// lost.  The reduced chunks are rounded once by the member that finalizes
+// them, so all members end with the same value.
 class RingReducer : public RingAlg {
  public:
   RingReducer() : RingAlg(REDUCTION_COLLECTIVE, "Reduce") {}
@@ -49,6 +56,16 @@ class RingReducer : public RingAlg {
   void ContinueAfterInputCopy();
   bool RunAsyncParts();
 
+  // Fills rf->wire_chunk with rf->chunk rounded to bfloat16.  In the first
+  // pass the rounding error of previous executions is added, and the new one
+  // kept; in the second pass rf->chunk is rounded too.
+  void EncodeChunk(RingField* rf);
+  // Converts rf->wire_chunk into `dst`.
+  void DecodeChunk(RingField* rf, Tensor* dst);
+
+  // Whether the chunks are sent as bfloat16.
+  bool bf16_wire_ = false;
+
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
 
@@ -154,6 +154,54 @@ class RingReducerTest : public ::testing::Test {
     }
   }
 
+  // Averages, with the data sent as bfloat16, tensors whose values are
+  // exactly representable in bfloat16 when summed, then ones that are not.
+  void RunBf16WireTest(int num_workers, int num_devices, int tensor_len) {
+    Init(num_workers, num_devices, DT_FLOAT, TensorShape({tensor_len}),
+         DEVICE_CPU, /*num_subdivs=*/1, /*fail_after=*/0);
+    for (auto& di : instances_) {
+      di->col_params_->instance.impl_details.wire_dtype = DT_BFLOAT16;
+      di->InitTensor([](Tensor* t) {
+        for (int i = 0; i < t->NumElements(); ++i) {
+          t->flat<float>()(i) = i % 16;
+        }
+      });
+    }
+    Reduce(/*fail_after=*/0);
+    std::vector<float> expected(tensor_len);
+    for (int i = 0; i < tensor_len; ++i) expected[i] = i % 16;
+    for (auto& di : instances_) {
+      TF_EXPECT_OK(di->status_);
+      test::ExpectTensorEqual<float>(test::AsTensor<float>(expected),
+                                     di->tensor());
+    }
+
+    std::fill(expected.begin(), expected.end(), 0.0f);
+    for (int di = 0; di < static_cast<int>(instances_.size()); ++di) {
+      instances_[di]->InitTensor([&expected, di](Tensor* t) {
+        for (int i = 0; i < t->NumElements(); ++i) {
+          const float value = 1.0f / (di + i + 3);
+          t->flat<float>()(i) = value;
+          expected[i] += value;
+        }
+      });
+    }
+    Reduce(/*fail_after=*/0);
+    for (int i = 0; i < tensor_len; ++i) {
+      expected[i] /= static_cast<float>(num_workers * num_devices);
+    }
+    for (auto& di : instances_) {
+      TF_EXPECT_OK(di->status_);
+      // All members end with the same value, within bfloat16 precision of
+      // the exact one.
+      test::ExpectTensorEqual<float>(instances_[0]->tensor(), di->tensor());
+      for (int i = 0; i < tensor_len; ++i) {
+        EXPECT_NEAR(di->tensor().flat<float>()(i), expected[i],
+                    expected[i] * 0.02);
+      }
+    }
+  }
+
   class DeviceInstance {
    public:
     DeviceInstance(int rank, int num_subdivs, DataType dtype,
@@ -403,6 +451,10 @@ TEST_F(RingReducerInitParamsTest, AutomaticSubdivDisabled) {
 
 #if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
 // Success tests
+TEST_F(RingReducerTest, Bf16WireSingleWorker) { RunBf16WireTest(1, 4, 1001); }
+
+TEST_F(RingReducerTest, Bf16WireMultiWorker) { RunBf16WireTest(2, 4, 4095); }
+
 DEF_TEST(FLOAT, CPU, 1, 2, 1, 1, 0)
 DEF_TEST(FLOAT, CPU, 1, 2, 1, 2, 0)
 DEF_TEST(FLOAT, CPU, 1, 2, 1, 8, 0)
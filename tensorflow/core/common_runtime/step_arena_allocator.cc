@@ -0,0 +1,103 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace {
+
+char* AlignUp(char* ptr, size_t alignment) {
+  return reinterpret_cast<char*>(
+      (reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(alignment - 1));
+}
+
+}  // namespace
+
+StepArenaAllocator::StepArenaAllocator(Allocator* fallback, size_t block_size,
+                                       int max_blocks)
+    : fallback_(fallback), block_size_(block_size), max_blocks_(max_blocks) {
+  CHECK(fallback_ != nullptr);
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  VLOG(2) << "~StepArenaAllocator " << this << " returning " << blocks_.size()
+          << " blocks";
+  for (void* block : blocks_) {
+    fallback_->DeallocateRaw(block);
+  }
+}
+
+void StepArenaAllocator::Release() {
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    if (live_allocations_ > 0) return;
+  }
+  delete this;
+}
+
+void* StepArenaAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  alignment = std::max(alignment, Allocator::kAllocatorAlignment);
+  if (num_bytes <= block_size_ / 4) {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    char* ptr = AlignUp(next_, alignment);
+    if (next_ == nullptr || ptr + num_bytes > limit_) {
+      ptr = nullptr;
+      if (blocks_.size() < static_cast<size_t>(max_blocks_)) {
+        char* block = static_cast<char*>(fallback_->AllocateRaw(
+            Allocator::kAllocatorAlignment, block_size_, allocation_attr));
+        if (block != nullptr) {
+          blocks_.push_back(block);
+          limit_ = block + block_size_;
+          ptr = AlignUp(block, alignment);
+        }
+      }
+    }
+    if (ptr != nullptr && ptr + num_bytes <= limit_) {
+      next_ = ptr + num_bytes;
+      ++live_allocations_;
+      return ptr;
+    }
+  }
+  void* ptr = fallback_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    fallback_allocations_.insert(ptr);
+    ++live_allocations_;
+  }
+  return ptr;
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  bool from_fallback;
+  bool last_deallocation;
+  {
+    mutex_lock l(mu_);
+    from_fallback = fallback_allocations_.erase(ptr) > 0;
+    DCHECK_GT(live_allocations_, 0);
+    last_deallocation = --live_allocations_ == 0 && released_;
+  }
+  if (from_fallback) fallback_->DeallocateRaw(ptr);
+  if (last_deallocation) delete this;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,91 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A bump-pointer allocator for the intermediate tensors of a single step.
+//
+// Allocations are carved out of large blocks obtained from `fallback`, and are
+// never reused within the step: DeallocateRaw() only decrements a count of live
+// allocations. All blocks are returned to `fallback` at once when the step has
+// called Release() and every allocation has been deallocated. Tensors that
+// outlive the step therefore remain valid, but keep their blocks alive, so
+// callers should route such tensors to `fallback` directly.
+//
+// Requests larger than a quarter of a block, and requests made after
+// `max_blocks` blocks are in use, are forwarded to `fallback`.
+//
+// An instance deletes itself; it must be destroyed by calling Release().
+class StepArenaAllocator : public Allocator {
+ public:
+  static constexpr size_t kDefaultBlockSize = 1 << 20;
+  static constexpr int kDefaultMaxBlocks = 64;
+
+  // Does not take ownership of `fallback`, which must outlive this object.
+  explicit StepArenaAllocator(Allocator* fallback,
+                              size_t block_size = kDefaultBlockSize,
+                              int max_blocks = kDefaultMaxBlocks);
+
+  // Marks the end of the step. The object is deleted once all of its
+  // allocations have been deallocated, which may be immediately.
+  void Release() TF_LOCKS_EXCLUDED(mu_);
+
+  std::string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr)
+      TF_LOCKS_EXCLUDED(mu_) override;
+  void DeallocateRaw(void* ptr) TF_LOCKS_EXCLUDED(mu_) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return fallback_->GetMemoryType();
+  }
+
+ private:
+  ~StepArenaAllocator() override;
+
+  Allocator* const fallback_;  // Not owned.
+  const size_t block_size_;
+  const int max_blocks_;
+
+  mutex mu_;
+  std::vector<void*> blocks_ TF_GUARDED_BY(mu_);
+  // Unused range of the most recently allocated block.
+  char* next_ TF_GUARDED_BY(mu_) = nullptr;
+  char* limit_ TF_GUARDED_BY(mu_) = nullptr;
+  // Allocations forwarded to `fallback_`.
+  absl::flat_hash_set<void*> fallback_allocations_ TF_GUARDED_BY(mu_);
+  int64_t live_allocations_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepArenaAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
@@ -0,0 +1,115 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Forwards to cpu_allocator() and counts live allocations.
+class CountingAllocator : public Allocator {
+ public:
+  std::string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    ++num_live_;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    --num_live_;
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations() const { return num_allocations_; }
+  int num_live() const { return num_live_; }
+
+ private:
+  int num_allocations_ = 0;
+  int num_live_ = 0;
+};
+
+TEST(StepArenaAllocatorTest, SmallAllocationsShareBlocks) {
+  CountingAllocator fallback;
+  StepArenaAllocator* arena =
+      new StepArenaAllocator(&fallback, /*block_size=*/4096);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+    ASSERT_NE(ptr, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % Allocator::kAllocatorAlignment,
+              0);
+    ptrs.push_back(ptr);
+  }
+  // 8 allocations of 128 rounded bytes fit in a single 4KiB block.
+  EXPECT_EQ(fallback.num_allocations(), 1);
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  // Blocks are only returned at the end of the step.
+  EXPECT_EQ(fallback.num_live(), 1);
+  arena->Release();
+  EXPECT_EQ(fallback.num_live(), 0);
+}
+
+TEST(StepArenaAllocatorTest, LargeAllocationsUseFallback) {
+  CountingAllocator fallback;
+  StepArenaAllocator* arena =
+      new StepArenaAllocator(&fallback, /*block_size=*/4096);
+  void* ptr = arena->AllocateRaw(Allocator::kAllocatorAlignment, 2048);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_EQ(fallback.num_allocations(), 1);
+  arena->DeallocateRaw(ptr);
+  // Returned to the fallback immediately.
+  EXPECT_EQ(fallback.num_live(), 0);
+  arena->Release();
+}
+
+TEST(StepArenaAllocatorTest, MaxBlocks) {
+  CountingAllocator fallback;
+  StepArenaAllocator* arena =
+      new StepArenaAllocator(&fallback, /*block_size=*/4096, /*max_blocks=*/1);
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, 1024));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  // One block holds four allocations; the rest go to the fallback.
+  EXPECT_EQ(fallback.num_allocations(), 1 + 60);
+  for (void* ptr : ptrs) arena->DeallocateRaw(ptr);
+  EXPECT_EQ(fallback.num_live(), 1);
+  arena->Release();
+  EXPECT_EQ(fallback.num_live(), 0);
+}
+
+TEST(StepArenaAllocatorTest, TensorsOutliveRelease) {
+  CountingAllocator fallback;
+  StepArenaAllocator* arena =
+      new StepArenaAllocator(&fallback, /*block_size=*/4096);
+  Tensor escaped(arena, DT_FLOAT, TensorShape({16}));
+  escaped.flat<float>().setConstant(1.0f);
+  {
+    Tensor temp(arena, DT_FLOAT, TensorShape({16}));
+  }
+  arena->Release();
+  // The escaped tensor keeps the arena alive.
+  EXPECT_EQ(fallback.num_live(), 1);
+  EXPECT_EQ(escaped.flat<float>()(15), 1.0f);
+  escaped = Tensor();
+  EXPECT_EQ(fallback.num_live(), 0);
+}
+
+}  // namespace
+}  // namespace tensorflow
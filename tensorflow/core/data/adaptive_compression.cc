@@ -0,0 +1,137 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/adaptive_compression.h"
+
+#include <algorithm>
+#include <ctime>
+#include <functional>
+#include <utility>
+
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Weight of a new measurement in the moving averages.
+constexpr double kSmoothing = 0.1;
+// Utilizations above this are treated as saturated, which bounds the cost
+// multiplier below.
+constexpr double kMaxCpuUtilization = 0.95;
+
+double Smooth(double average, double sample) {
+  if (average < 0) return sample;
+  return (1 - kSmoothing) * average + kSmoothing * sample;
+}
+
+// Returns a function computing the fraction of the schedulable CPUs the process
+// used since the previous call.
+std::function<double()> ProcessCpuUtilization() {
+  struct Sample {
+    std::clock_t cpu = std::clock();
+    int64_t wall_micros = EnvTime::NowMicros();
+  };
+  return [last = Sample()]() mutable {
+    Sample now;
+    const double cpu_micros =
+        1e6 * static_cast<double>(now.cpu - last.cpu) / CLOCKS_PER_SEC;
+    const double wall_micros =
+        static_cast<double>(now.wall_micros - last.wall_micros) *
+        std::max(port::NumSchedulableCPUs(), 1);
+    last = now;
+    if (wall_micros <= 0) return 0.0;
+    return std::clamp(cpu_micros / wall_micros, 0.0, 1.0);
+  };
+}
+
+}  // namespace
+
+AdaptiveCompressionPolicy::AdaptiveCompressionPolicy(
+    std::function<double()> cpu_utilization)
+    : cpu_utilization_fn_(std::move(cpu_utilization)) {}
+
+AdaptiveCompressionPolicy& AdaptiveCompressionPolicy::Global() {
+  static AdaptiveCompressionPolicy* policy =
+      new AdaptiveCompressionPolicy(ProcessCpuUtilization());
+  return *policy;
+}
+
+void AdaptiveCompressionPolicy::SetEnabled(bool enabled) {
+  mutex_lock l(mu_);
+  enabled_ = enabled;
+}
+
+bool AdaptiveCompressionPolicy::ShouldCompress() {
+  mutex_lock l(mu_);
+  if (!enabled_ || compression_micros_per_byte_ < 0 ||
+      transfer_micros_per_byte_ < 0) {
+    return true;
+  }
+  MaybeSampleCpuUtilization();
+  // Compressing saves sending `1 - ratio` of each byte. It costs its CPU time,
+  // weighted by how much it delays the rest of the pipeline: with the CPUs
+  // busy a fraction `u` of the time, work queues for `u / (1 - u)` times its
+  // own duration.
+  const double saved_micros_per_byte =
+      (1 - compression_ratio_) * transfer_micros_per_byte_;
+  const double u = std::min(cpu_utilization_, kMaxCpuUtilization);
+  const double cost_micros_per_byte =
+      compression_micros_per_byte_ * u / (1 - u);
+  if (saved_micros_per_byte >= cost_micros_per_byte) {
+    num_skipped_ = 0;
+    return true;
+  }
+  if (++num_skipped_ >= kProbeInterval) {
+    num_skipped_ = 0;
+    return true;
+  }
+  return false;
+}
+
+void AdaptiveCompressionPolicy::RecordCompression(int64_t uncompressed_bytes,
+                                                  int64_t compressed_bytes,
+                                                  int64_t micros) {
+  if (uncompressed_bytes <= 0) return;
+  mutex_lock l(mu_);
+  compression_micros_per_byte_ =
+      Smooth(compression_micros_per_byte_,
+             static_cast<double>(micros) / uncompressed_bytes);
+  compression_ratio_ =
+      Smooth(compression_ratio_,
+             static_cast<double>(compressed_bytes) / uncompressed_bytes);
+}
+
+void AdaptiveCompressionPolicy::RecordTransfer(int64_t bytes, int64_t micros) {
+  if (bytes <= 0 || micros < 0) return;
+  mutex_lock l(mu_);
+  transfer_micros_per_byte_ = Smooth(transfer_micros_per_byte_,
+                                     static_cast<double>(micros) / bytes);
+}
+
+void AdaptiveCompressionPolicy::MaybeSampleCpuUtilization() {
+  const int64_t now = EnvTime::NowMicros();
+  if (now - last_cpu_sample_micros_ < kCpuSamplingIntervalMicros) return;
+  last_cpu_sample_micros_ = now;
+  cpu_utilization_ = cpu_utilization_fn_();
+  VLOG(3) << "Adaptive compression: CPU utilization " << cpu_utilization_
+          << ", compression ratio " << compression_ratio_ << ", "
+          << compression_micros_per_byte_ << "us/byte to compress, "
+          << transfer_micros_per_byte_ << "us/byte to transfer.";
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,96 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_ADAPTIVE_COMPRESSION_H_
+#define TENSORFLOW_CORE_DATA_ADAPTIVE_COMPRESSION_H_
+
+#include <cstdint>
+#include <functional>
+
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Decides whether the elements a tf.data service worker sends should be
+// compressed.
+//
+// Compressing an element pays off when the transfer time it saves exceeds the
+// time it costs the input pipeline. The policy measures both sides:
+// - the snappy throughput and compression ratio, from `RecordCompression`,
+// - the throughput of the link to the clients, from `RecordTransfer`,
+// - the CPU utilization of the process, which determines how much compressing
+//   delays the rest of the pipeline.
+//
+// Elements are compressed by a dataset op running inside the worker's input
+// pipelines, which have no handle on the worker, so the worker shares its
+// policy through `Global()`. The policy is disabled, i.e. always compresses,
+// until a worker enables it.
+class AdaptiveCompressionPolicy {
+ public:
+  // `cpu_utilization` returns the fraction of the available CPU time the
+  // process has used recently. It is called at most every
+  // `kCpuSamplingIntervalMicros`.
+  explicit AdaptiveCompressionPolicy(std::function<double()> cpu_utilization);
+
+  // Returns the policy shared by the workers and the ops of a process. It
+  // samples the CPU time used by the process.
+  static AdaptiveCompressionPolicy& Global();
+
+  void SetEnabled(bool enabled) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns whether the next element should be compressed. Returns true if the
+  // policy is disabled or has not measured both compression and transfers yet.
+  // While compression is off, one in `kProbeInterval` elements is still
+  // compressed to keep the compression measurements current.
+  bool ShouldCompress() TF_LOCKS_EXCLUDED(mu_);
+
+  // Records that compressing `uncompressed_bytes` into `compressed_bytes` took
+  // `micros`.
+  void RecordCompression(int64_t uncompressed_bytes, int64_t compressed_bytes,
+                         int64_t micros) TF_LOCKS_EXCLUDED(mu_);
+
+  // Records that sending `bytes` to a client took `micros`.
+  void RecordTransfer(int64_t bytes, int64_t micros) TF_LOCKS_EXCLUDED(mu_);
+
+  static constexpr int64_t kCpuSamplingIntervalMicros = 500 * 1000;
+  static constexpr int64_t kProbeInterval = 64;
+
+ private:
+  // Samples the CPU utilization if the last sample is too old.
+  void MaybeSampleCpuUtilization() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::function<double()> cpu_utilization_fn_;
+
+  mutex mu_;
+  bool enabled_ TF_GUARDED_BY(mu_) = false;
+  // Exponential moving averages of the measurements. Negative until the first
+  // measurement.
+  double compression_micros_per_byte_ TF_GUARDED_BY(mu_) = -1;
+  double compression_ratio_ TF_GUARDED_BY(mu_) = -1;
+  double transfer_micros_per_byte_ TF_GUARDED_BY(mu_) = -1;
+  double cpu_utilization_ TF_GUARDED_BY(mu_) = 0;
+  int64_t last_cpu_sample_micros_ TF_GUARDED_BY(mu_) = 0;
+  // Number of elements left uncompressed since the last compressed one.
+  int64_t num_skipped_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AdaptiveCompressionPolicy);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_ADAPTIVE_COMPRESSION_H_
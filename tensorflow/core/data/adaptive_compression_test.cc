@@ -0,0 +1,86 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/adaptive_compression.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Compresses 1MB into 0.5MB in 1ms.
+void RecordSnappyLikeCompression(AdaptiveCompressionPolicy& policy) {
+  policy.RecordCompression(/*uncompressed_bytes=*/1 << 20,
+                           /*compressed_bytes=*/1 << 19, /*micros=*/1000);
+}
+
+TEST(AdaptiveCompressionPolicyTest, DisabledAlwaysCompresses) {
+  AdaptiveCompressionPolicy policy([] { return 1.0; });
+  RecordSnappyLikeCompression(policy);
+  policy.RecordTransfer(/*bytes=*/1 << 20, /*micros=*/1);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_TRUE(policy.ShouldCompress());
+  }
+}
+
+TEST(AdaptiveCompressionPolicyTest, CompressesUntilMeasured) {
+  AdaptiveCompressionPolicy policy([] { return 1.0; });
+  policy.SetEnabled(true);
+  EXPECT_TRUE(policy.ShouldCompress());
+  RecordSnappyLikeCompression(policy);
+  EXPECT_TRUE(policy.ShouldCompress());
+}
+
+TEST(AdaptiveCompressionPolicyTest, SkipsOnFastLinkAndBusyCpu) {
+  AdaptiveCompressionPolicy policy([] { return 0.9; });
+  policy.SetEnabled(true);
+  RecordSnappyLikeCompression(policy);
+  // 100GB/s.
+  policy.RecordTransfer(/*bytes=*/100 << 20, /*micros=*/1000);
+  EXPECT_FALSE(policy.ShouldCompress());
+}
+
+TEST(AdaptiveCompressionPolicyTest, ProbesWhileSkipping) {
+  AdaptiveCompressionPolicy policy([] { return 0.9; });
+  policy.SetEnabled(true);
+  RecordSnappyLikeCompression(policy);
+  policy.RecordTransfer(/*bytes=*/100 << 20, /*micros=*/1000);
+  int num_compressed = 0;
+  for (int i = 0; i < 2 * AdaptiveCompressionPolicy::kProbeInterval; ++i) {
+    num_compressed += policy.ShouldCompress();
+  }
+  EXPECT_EQ(num_compressed, 2);
+}
+
+TEST(AdaptiveCompressionPolicyTest, CompressesOnSlowLink) {
+  AdaptiveCompressionPolicy policy([] { return 0.9; });
+  policy.SetEnabled(true);
+  RecordSnappyLikeCompression(policy);
+  // 10MB/s.
+  policy.RecordTransfer(/*bytes=*/10 << 20, /*micros=*/1000 * 1000);
+  EXPECT_TRUE(policy.ShouldCompress());
+}
+
+TEST(AdaptiveCompressionPolicyTest, CompressesWithIdleCpu) {
+  AdaptiveCompressionPolicy policy([] { return 0.0; });
+  policy.SetEnabled(true);
+  RecordSnappyLikeCompression(policy);
+  policy.RecordTransfer(/*bytes=*/100 << 20, /*micros=*/1000);
+  EXPECT_TRUE(policy.ShouldCompress());
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
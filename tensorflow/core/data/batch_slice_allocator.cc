@@ -0,0 +1,80 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/batch_slice_allocator.h"
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace data {
+
+BatchSliceAllocator::BatchSliceAllocator(const Tensor& batch, int64_t index,
+                                         Allocator* fallback)
+    : batch_(batch),
+      slice_(static_cast<char*>(batch_.data()) +
+             index * (batch_.TotalBytes() / batch_.dim_size(0))),
+      slice_bytes_(batch_.TotalBytes() / batch_.dim_size(0)),
+      fallback_(fallback) {
+  DCHECK(DataTypeCanUseMemcpy(batch_.dtype()));
+  DCHECK_LT(index, batch_.dim_size(0));
+  CHECK(fallback_ != nullptr);
+}
+
+bool BatchSliceAllocator::Holds(const Tensor& element) const {
+  return element.IsInitialized() && element.dtype() == batch_.dtype() &&
+         element.data() == slice_ && element.TotalBytes() == slice_bytes_;
+}
+
+void BatchSliceAllocator::Release() {
+  {
+    mutex_lock l(mu_);
+    DCHECK(!released_);
+    released_ = true;
+    if (live_allocations_ > 0) return;
+  }
+  delete this;
+}
+
+void* BatchSliceAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  {
+    mutex_lock l(mu_);
+    if (!slice_used_ && num_bytes == slice_bytes_ &&
+        reinterpret_cast<uintptr_t>(slice_) % alignment == 0) {
+      slice_used_ = true;
+      ++live_allocations_;
+      return slice_;
+    }
+  }
+  void* ptr = fallback_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  if (ptr != nullptr) {
+    mutex_lock l(mu_);
+    ++live_allocations_;
+  }
+  return ptr;
+}
+
+void BatchSliceAllocator::DeallocateRaw(void* ptr) {
+  if (ptr != slice_) fallback_->DeallocateRaw(ptr);
+  {
+    mutex_lock l(mu_);
+    DCHECK_GT(live_allocations_, 0);
+    if (--live_allocations_ > 0 || !released_) return;
+  }
+  delete this;
+}
+
+}  // namespace data
+}  // namespace tensorflow
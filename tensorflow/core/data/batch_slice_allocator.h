@@ -0,0 +1,85 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_BATCH_SLICE_ALLOCATOR_H_
+#define TENSORFLOW_CORE_DATA_BATCH_SLICE_ALLOCATOR_H_
+
+#include <string>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// Hands out the memory of one slice of a batch, so that the function that
+// computes an element of the batch can write it in place instead of having it
+// copied into the batch afterwards.
+//
+// Only the first request of exactly the size of the slice gets the slice; the
+// others are forwarded to `fallback`. Since a kernel may keep its output alive
+// after the batch is complete, an instance keeps the batch alive and deletes
+// itself once Release() has been called and every allocation has been
+// deallocated.
+class BatchSliceAllocator : public Allocator {
+ public:
+  // `batch` must be initialized and have at least one dimension, and its
+  // dtype must support memcpy. Does not take ownership of `fallback`, which
+  // must outlive this object.
+  BatchSliceAllocator(const Tensor& batch, int64_t index, Allocator* fallback);
+
+  // Returns true if `element` is stored in the slice, in which case it does
+  // not need to be copied into the batch.
+  bool Holds(const Tensor& element) const;
+
+  // The object is deleted once all of its allocations have been deallocated,
+  // which may be immediately.
+  void Release() TF_LOCKS_EXCLUDED(mu_);
+
+  std::string Name() override { return "batch_slice"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr)
+      TF_LOCKS_EXCLUDED(mu_) override;
+  void DeallocateRaw(void* ptr) TF_LOCKS_EXCLUDED(mu_) override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return fallback_->GetMemoryType();
+  }
+
+ private:
+  ~BatchSliceAllocator() override = default;
+
+  const Tensor batch_;  // Keeps the slice alive.
+  char* const slice_;
+  const size_t slice_bytes_;
+  Allocator* const fallback_;  // Not owned.
+
+  mutex mu_;
+  bool slice_used_ TF_GUARDED_BY(mu_) = false;
+  int64_t live_allocations_ TF_GUARDED_BY(mu_) = 0;
+  bool released_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(BatchSliceAllocator);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_BATCH_SLICE_ALLOCATOR_H_
@@ -0,0 +1,70 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/batch_slice_allocator.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(BatchSliceAllocatorTest, WritesIntoSlice) {
+  Tensor batch(DT_FLOAT, TensorShape({4, 16}));
+  batch.flat<float>().setZero();
+  BatchSliceAllocator* allocator =
+      new BatchSliceAllocator(batch, /*index=*/2, cpu_allocator());
+  Tensor element(allocator, DT_FLOAT, TensorShape({16}));
+  EXPECT_TRUE(allocator->Holds(element));
+  element.flat<float>().setConstant(1.0f);
+  EXPECT_EQ(batch.matrix<float>()(2, 0), 1.0f);
+  EXPECT_EQ(batch.matrix<float>()(1, 15), 0.0f);
+  EXPECT_EQ(batch.matrix<float>()(3, 0), 0.0f);
+
+  // The slice is handed out only once.
+  Tensor other(allocator, DT_FLOAT, TensorShape({16}));
+  EXPECT_FALSE(allocator->Holds(other));
+  allocator->Release();
+}
+
+TEST(BatchSliceAllocatorTest, MismatchedSizeUsesFallback) {
+  Tensor batch(DT_FLOAT, TensorShape({4, 16}));
+  BatchSliceAllocator* allocator =
+      new BatchSliceAllocator(batch, /*index=*/0, cpu_allocator());
+  Tensor element(allocator, DT_FLOAT, TensorShape({8}));
+  EXPECT_FALSE(allocator->Holds(element));
+  element.flat<float>().setZero();
+  allocator->Release();
+}
+
+TEST(BatchSliceAllocatorTest, ElementsOutliveReleaseAndBatch) {
+  Tensor element;
+  {
+    Tensor batch(DT_INT32, TensorShape({2, 16}));
+    BatchSliceAllocator* allocator =
+        new BatchSliceAllocator(batch, /*index=*/1, cpu_allocator());
+    element = Tensor(allocator, DT_INT32, TensorShape({16}));
+    allocator->Release();
+  }
+  // The element keeps the batch alive.
+  element.flat<int32>().setConstant(7);
+  EXPECT_EQ(element.flat<int32>()(15), 7);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/captured_function.h"
 
+#include <algorithm>
+#include <array>
 #include <utility>
 
 #include "absl/time/clock.h"
@@ -47,6 +49,15 @@ namespace {
 constexpr char kAllowSmallFunctionOptimizations[] =
     "allow_small_function_optimizations";
 
+// The maximum number of nodes of a function that is considered cheap.
+constexpr int kMaxCheapFunctionNodes = 8;
+
+// Ops that do not compute anything, or only convert the element type, and
+// whose cost is therefore dominated by the overhead of dispatching them.
+constexpr std::array<const char*, 11> kCheapOps = {
+    "Bitcast", "Cast",  "Const", "ExpandDims", "Identity",    "Rank",
+    "Reshape", "Shape", "Size",  "Squeeze",    "StopGradient"};
+
 // Simplistic implementation of the `StepStatsCollectorInterface` that only
 // cares about collecting the CPU time needed to execute a captured function.
 class SimpleStepStatsCollector : public StepStatsCollectorInterface {
@@ -225,6 +236,19 @@ Status CreateShortCircuitInfo(OpKernelConstruction* ctx,
   return OkStatus();
 }
 
+// Returns true if `fdef` only consists of a few cheap ops, in which case
+// running it inline is faster than dispatching it to another thread.
+bool IsCheapFunction(const FunctionDef& fdef) {
+  if (fdef.node_def_size() > kMaxCheapFunctionNodes) return false;
+  for (const NodeDef& node : fdef.node_def()) {
+    if (std::find(kCheapOps.begin(), kCheapOps.end(), node.op()) ==
+        kCheapOps.end()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 Status CreateFunctionLibraryDefinition(
     const FunctionLibraryDefinition* lib_def, const string& func_name,
     std::unique_ptr<FunctionLibraryDefinition>* result) {
@@ -450,6 +474,7 @@ Status FunctionMetadata::Create(
   const FunctionDef* fdef;
   TF_RETURN_IF_ERROR(LookupFunction(*(*out_metadata)->lib_def(),
                                     (*out_metadata)->func().name(), &fdef));
+  (*out_metadata)->is_cheap_ = IsCheapFunction(*fdef);
 
   auto attr = fdef->attr().find(FunctionLibraryDefinition::kIntsOnDeviceAttr);
   if (attr != fdef->attr().end() && attr->second.b()) {
@@ -550,7 +575,7 @@ Status CapturedFunction::Instantiate(
   if (GetExperiments().contains(kAllowSmallFunctionOptimizations)) {
     inst_opts.allow_small_function_optimizations = true;
   } else {
-    if (!metadata_->use_inter_op_parallelism()) {
+    if (!metadata_->use_inter_op_parallelism() || metadata_->is_cheap()) {
       inst_opts.executor_type = "SINGLE_THREADED_EXECUTOR";
     }
   }
@@ -938,7 +963,8 @@ Status InstantiatedCapturedFunction::RunInstantiated(
 void InstantiatedCapturedFunction::RunAsync(
     IteratorContext* ctx, std::vector<Tensor>&& args, std::vector<Tensor>* rets,
     FunctionLibraryRuntime::DoneCallback done,
-    const std::shared_ptr<model::Node>& node) const {
+    const std::shared_ptr<model::Node>& node,
+    const std::vector<Allocator*>* retval_allocators) const {
   auto& info = captured_func_->short_circuit_info();
   if (!info.indices.empty()) {
     // Run the `done` callback on a threadpool thread, because it will
@@ -970,6 +996,7 @@ void InstantiatedCapturedFunction::RunAsync(
       std::make_unique<CancellationManager>(ctx->cancellation_manager());
   f_opts.cancellation_manager = cancellation_manager.get();
   f_opts.collective_executor = ctx->collective_executor();
+  f_opts.retval_allocators = retval_allocators;
 
   std::shared_ptr<SimpleStepStatsCollector> stats_collector;
   if (node || ctx->stats_aggregator()) {
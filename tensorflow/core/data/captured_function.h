@@ -111,6 +111,10 @@ class FunctionMetadata {
   // Indicates whether the function should a multi-device function backend.
   bool use_multi_device_function() const { return use_multi_device_function_; }
 
+  // Indicates whether the function only consists of a few ops that are cheap
+  // enough to run inline on the calling thread.
+  bool is_cheap() const { return is_cheap_; }
+
  private:
   FunctionMetadata(NameAttrList&& func, Params params)
       : func_(std::move(func)),
@@ -123,6 +127,7 @@ class FunctionMetadata {
   bool use_default_device_ = true;
   bool use_inter_op_parallelism_ = true;
   bool use_multi_device_function_ = true;
+  bool is_cheap_ = false;
 };
 
 // Constructs and stores the parameters for the CapturedFunction Instantiate
@@ -210,6 +215,10 @@ class CapturedFunction {
     return metadata_->use_inter_op_parallelism();
   }
 
+  // Indicates whether the function is cheap enough to run inline on the
+  // calling thread instead of being dispatched to a runner thread.
+  bool is_cheap() const { return metadata_->is_cheap(); }
+
  private:
   CapturedFunction(std::shared_ptr<const FunctionMetadata> metadata,
                    std::vector<Tensor> captured_inputs);
@@ -287,10 +296,14 @@ class InstantiatedCapturedFunction {
   // record processing time for modeling Iterator's GetNext() resource usage.
   // When non-null node is provided, the pre-requisite is that the calling
   // thread has previously called `DatasetBaseIterator::RecordStart().
+  // If not null, `retval_allocators` must outlive the call, and is used as
+  // FunctionLibraryRuntime::Options::retval_allocators.
   void RunAsync(IteratorContext* ctx, std::vector<Tensor>&& args,
                 std::vector<Tensor>* rets,
                 FunctionLibraryRuntime::DoneCallback done,
-                const std::shared_ptr<model::Node>& node) const;
+                const std::shared_ptr<model::Node>& node,
+                const std::vector<Allocator*>* retval_allocators =
+                    nullptr) const;
 
  private:
   friend class CapturedFunction;
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <cstring>
 #include <limits>
 #include <string>
 #include <vector>
@@ -36,7 +37,12 @@ namespace {
 // Increment this when making changes to the `CompressedElement` proto. The
 // `UncompressElement` function will determine what to read according to the
 // version.
-constexpr int kCompressedElementVersion = 0;
+constexpr int kCompressedElementVersion = 1;
+
+// Snappy-compressed elements are written with the version that introduced
+// them, so that readers predating `data_uncompressed` can still read them.
+constexpr int kSnappyElementVersion = 0;
+constexpr int kUncompressedDataElementVersion = 1;
 
 }  // namespace
 
@@ -65,6 +71,11 @@ class Iov {
 
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out) {
+  return CompressElement(element, /*compress=*/true, out);
+}
+
+Status CompressElement(const std::vector<Tensor>& element, bool compress,
+                       CompressedElement* out) {
   // First pass: preprocess the non`memcpy`able tensors.
   size_t num_string_tensors = 0;
   size_t num_string_tensor_strings = 0;
@@ -127,11 +138,23 @@ Status CompressElement(const std::vector<Tensor>& element,
                               iov.NumBytes(),
                               ", exceeding the 4GB Snappy limit.");
   }
+  if (!compress) {
+    std::string* data = out->mutable_data();
+    data->resize(iov.NumBytes());
+    char* pos = &(*data)[0];
+    for (size_t i = 0; i < iov.NumPieces(); ++i) {
+      memcpy(pos, iov.Data()[i].iov_base, iov.Data()[i].iov_len);
+      pos += iov.Data()[i].iov_len;
+    }
+    out->set_data_uncompressed(true);
+    out->set_version(kUncompressedDataElementVersion);
+    return OkStatus();
+  }
   if (!port::Snappy_CompressFromIOVec(iov.Data(), iov.NumBytes(),
                                       out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
-  out->set_version(kCompressedElementVersion);
+  out->set_version(kSnappyElementVersion);
   VLOG(3) << "Compressed element from " << iov.NumBytes() << " bytes to "
           << out->data().size() << " bytes";
   return OkStatus();
@@ -139,7 +162,9 @@ Status CompressElement(const std::vector<Tensor>& element,
 
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  if (compressed.version() > kCompressedElementVersion ||
+      (compressed.data_uncompressed() &&
+       compressed.version() < kUncompressedDataElementVersion)) {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
   }
@@ -193,22 +218,37 @@ Status UncompressElement(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
-  size_t uncompressed_size;
-  if (!port::Snappy_GetUncompressedLength(
-          compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
-    return errors::Internal(
-        "Could not get snappy uncompressed length. Compressed data size: ",
-        compressed_data.size());
-  }
-  if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
-    return errors::Internal(
-        "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
-        " whereas the tensor metadata suggests ", iov.NumBytes());
-  }
-  if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
-                                      compressed_data.size(), iov.Data(),
-                                      iov.NumPieces())) {
-    return errors::Internal("Failed to perform snappy decompression.");
+  if (compressed.data_uncompressed()) {
+    if (compressed_data.size() != iov.NumBytes()) {
+      return errors::Internal("Uncompressed size mismatch. The element holds ",
+                              compressed_data.size(),
+                              " bytes whereas the tensor metadata suggests ",
+                              iov.NumBytes());
+    }
+    const char* pos = compressed_data.data();
+    for (size_t i = 0; i < iov.NumPieces(); ++i) {
+      memcpy(iov.Data()[i].iov_base, pos, iov.Data()[i].iov_len);
+      pos += iov.Data()[i].iov_len;
+    }
+  } else {
+    size_t uncompressed_size;
+    if (!port::Snappy_GetUncompressedLength(compressed_data.data(),
+                                            compressed_data.size(),
+                                            &uncompressed_size)) {
+      return errors::Internal(
+          "Could not get snappy uncompressed length. Compressed data size: ",
+          compressed_data.size());
+    }
+    if (uncompressed_size != static_cast<size_t>(iov.NumBytes())) {
+      return errors::Internal(
+          "Uncompressed size mismatch. Snappy expects ", uncompressed_size,
+          " whereas the tensor metadata suggests ", iov.NumBytes());
+    }
+    if (!port::Snappy_UncompressToIOVec(compressed_data.data(),
+                                        compressed_data.size(), iov.Data(),
+                                        iov.NumPieces())) {
+      return errors::Internal("Failed to perform snappy decompression.");
+    }
   }
 
   // Third pass: deserialize nonstring, non`memcpy`able tensors.
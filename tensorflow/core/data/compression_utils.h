@@ -35,6 +35,13 @@ namespace data {
 Status CompressElement(const std::vector<Tensor>& element,
                        CompressedElement* out);
 
+// Like the above, but stores the component bytes without compressing them if
+// `compress` is false. Used when compression is not expected to pay off, e.g.
+// when the network is faster than snappy. The result is still read with
+// `UncompressElement`.
+Status CompressElement(const std::vector<Tensor>& element, bool compress,
+                       CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status UncompressElement(const CompressedElement& compressed,
                          std::vector<Tensor>* out);
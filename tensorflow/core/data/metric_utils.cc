@@ -19,10 +19,12 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/metrics.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/platform/env.h"
@@ -32,11 +34,34 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+// The minimum time between two exports of the buffered bytes by an iterator.
+constexpr uint64_t kBufferedBytesExportPeriodUs = 10 * 1000 * 1000;
+
 // Safely subtracts `x` from `y` avoiding underflow.
 uint64_t safe_sub(uint64_t x, uint64_t y) { return x >= y ? x - y : 0; }
 
 }  // namespace
 
+void RecordAutotuneBufferedBytes() {
+  static mutex* mu = new mutex();
+  // The dataset types exported by the previous call.
+  static auto* exported_names = new absl::flat_hash_set<std::string>();
+  model::Node::NodeValues buffered_bytes =
+      model::MemoryArbiter::Global()->BufferedBytesByNodeName();
+  mutex_lock l(*mu);
+  for (const std::string& name : *exported_names) {
+    if (!buffered_bytes.contains(name)) {
+      metrics::RecordTFDataAutotuneBufferedBytes(name, 0);
+    }
+  }
+  exported_names->clear();
+  for (const auto& pair : buffered_bytes) {
+    metrics::RecordTFDataAutotuneBufferedBytes(
+        pair.first, static_cast<int64_t>(pair.second));
+    exported_names->insert(pair.first);
+  }
+}
+
 IteratorMetricsCollector::IteratorMetricsCollector(
     const std::string& device_type, const Env& env)
     : device_type_(device_type), env_(env) {}
@@ -74,13 +99,24 @@ void IteratorMetricsCollector::RecordStop(absl::Time start_time,
   const uint64_t end_time_us = env_.NowMicros();
   AddLatencySample(safe_sub(end_time_us, absl::ToUnixMicros(start_time)));
   IncrementThroughput(GetTotalBytes(output));
-  mutex_lock l(mu_);
-  metrics::RecordTFDataIteratorLifetime(safe_sub(end_time_us, end_time_us_));
-  end_time_us_ = std::max(end_time_us_, end_time_us);
-  num_active_calls_--;
-  if (num_active_calls_ == 0) {
-    metrics::RecordTFDataIteratorBusy(
-        safe_sub(end_time_us_, first_start_time_us_));
+  bool export_buffered_bytes = false;
+  {
+    mutex_lock l(mu_);
+    metrics::RecordTFDataIteratorLifetime(safe_sub(end_time_us, end_time_us_));
+    end_time_us_ = std::max(end_time_us_, end_time_us);
+    num_active_calls_--;
+    if (num_active_calls_ == 0) {
+      metrics::RecordTFDataIteratorBusy(
+          safe_sub(end_time_us_, first_start_time_us_));
+    }
+    if (safe_sub(end_time_us, buffered_bytes_export_time_us_) >=
+        kBufferedBytesExportPeriodUs) {
+      buffered_bytes_export_time_us_ = end_time_us;
+      export_buffered_bytes = true;
+    }
+  }
+  if (export_buffered_bytes) {
+    RecordAutotuneBufferedBytes();
   }
 }
 
@@ -28,6 +28,11 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
+// Exports the number of bytes buffered by the autotuned input pipelines of the
+// process, as last reported to `model::MemoryArbiter::Global()`, by dataset
+// type. `IteratorMetricsCollector` calls this periodically.
+void RecordAutotuneBufferedBytes();
+
 // Exports the metrics for `GetNext` calls by tf.data iterators. When the user
 // calls `RecordStart` and `RecordStop`, it will export a latency sample. It
 // also exports throughput, tf.data iterator life time, etc. This class is
@@ -78,6 +83,10 @@ class IteratorMetricsCollector {
   // Records the end time (in microseconds) of the most recent `RecordStop()`
   // call.
   uint64_t end_time_us_ TF_GUARDED_BY(mu_) = 0;
+
+  // Records the time (in microseconds) at which `RecordStop()` last exported
+  // the buffered bytes.
+  uint64_t buffered_bytes_export_time_us_ TF_GUARDED_BY(mu_) = 0;
 };
 
 }  // namespace data
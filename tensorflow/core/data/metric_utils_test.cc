@@ -19,6 +19,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/monitoring/cell_reader.h"
 #include "tensorflow/core/lib/monitoring/test_utils.h"
@@ -70,6 +71,23 @@ TEST(MetricUtilsTest, ShouldNotCollectMetrics) {
   EXPECT_EQ(iterator_busy.Delta(), 0);
 }
 
+TEST(MetricUtilsTest, RecordAutotuneBufferedBytes) {
+  CellReader<int64_t> buffered_bytes("/tensorflow/data/autotune_buffered_bytes");
+  {
+    model::Model model;
+    model::MemoryArbiter::Global()->Report(
+        &model, /*max_buffered_bytes=*/1024,
+        /*buffered_bytes=*/{{"ParallelMapV2", 256}, {"Prefetch", 512}});
+    RecordAutotuneBufferedBytes();
+    EXPECT_EQ(buffered_bytes.Read("ParallelMapV2"), 256);
+    EXPECT_EQ(buffered_bytes.Read("Prefetch"), 512);
+  }
+  // Destroying the model removes its buffers from the export.
+  RecordAutotuneBufferedBytes();
+  EXPECT_EQ(buffered_bytes.Read("ParallelMapV2"), 0);
+  EXPECT_EQ(buffered_bytes.Read("Prefetch"), 0);
+}
+
 TEST(MetricUtilsTest, ConcurrentThreads) {
   CellReader<Histogram> latency("/tensorflow/data/getnext_duration");
   CellReader<int64_t> iterator_lifetime("/tensorflow/data/iterator_lifetime");
@@ -0,0 +1,138 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/readahead_file.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+
+struct ReadAheadFile::Block {
+  explicit Block(size_t size) : data(new char[size]) {}
+
+  std::unique_ptr<char[]> data;
+  // The following are set when the read completes, under `mu_`.
+  bool done = false;
+  size_t size = 0;
+  Status status;
+};
+
+ReadAheadFile::ReadAheadFile(RandomAccessFile* file,
+                             thread::ThreadPool* thread_pool, size_t block_size,
+                             int max_blocks)
+    : file_(file),
+      thread_pool_(thread_pool),
+      block_size_(block_size),
+      max_blocks_(std::max(max_blocks, 1)),
+      last_block_(std::numeric_limits<uint64>::max()) {
+  DCHECK_GT(block_size_, 0);
+}
+
+ReadAheadFile::~ReadAheadFile() {
+  // The pending reads use `file_` and `this`.
+  mutex_lock l(mu_);
+  while (num_pending_reads_ > 0) {
+    cond_var_.wait(l);
+  }
+}
+
+Status ReadAheadFile::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ReadAheadFile::Read(uint64 offset, size_t n, StringPiece* result,
+                           char* scratch) const {
+  size_t bytes_read = 0;
+  mutex_lock l(mu_);
+  while (bytes_read < n) {
+    const uint64 position = offset + bytes_read;
+    const uint64 block_index = position / block_size_;
+    if (block_index > last_block_) break;
+    AdvanceWindow(block_index);
+    std::shared_ptr<Block> block = blocks_.front();
+    while (!block->done) {
+      cond_var_.wait(l);
+    }
+    if (!block->status.ok() && !errors::IsOutOfRange(block->status)) {
+      Status status = block->status;
+      // Retry the block on the next read.
+      blocks_.clear();
+      return status;
+    }
+    const size_t block_offset = position - block_index * block_size_;
+    if (block_offset < block->size) {
+      const size_t to_copy = std::min(n - bytes_read, block->size - block_offset);
+      memcpy(scratch + bytes_read, block->data.get() + block_offset, to_copy);
+      bytes_read += to_copy;
+    }
+    if (block->size < block_size_) {
+      // The file ends in this block.
+      last_block_ = block_index;
+      break;
+    }
+  }
+  *result = StringPiece(scratch, bytes_read);
+  if (bytes_read < n) {
+    return errors::OutOfRange("EOF reached, ", bytes_read,
+                              " bytes were read out of ", n,
+                              " bytes requested.");
+  }
+  return OkStatus();
+}
+
+void ReadAheadFile::AdvanceWindow(uint64 block_index) const {
+  if (block_index < first_block_ ||
+      block_index >= first_block_ + blocks_.size()) {
+    blocks_.clear();
+    first_block_ = block_index;
+  }
+  while (first_block_ < block_index) {
+    blocks_.pop_front();
+    ++first_block_;
+  }
+  while (blocks_.size() < static_cast<size_t>(max_blocks_)) {
+    const uint64 next_block = first_block_ + blocks_.size();
+    if (next_block > last_block_) break;
+    Schedule(next_block);
+  }
+}
+
+void ReadAheadFile::Schedule(uint64 block_index) const {
+  auto block = std::make_shared<Block>(block_size_);
+  blocks_.push_back(block);
+  ++num_pending_reads_;
+  thread_pool_->Schedule([this, block, block_index]() {
+    StringPiece result;
+    Status status = file_->Read(block_index * block_size_, block_size_, &result,
+                                block->data.get());
+    if (result.data() != block->data.get()) {
+      memmove(block->data.get(), result.data(), result.size());
+    }
+    mutex_lock l(mu_);
+    block->done = true;
+    block->size = result.size();
+    block->status = std::move(status);
+    --num_pending_reads_;
+    cond_var_.notify_all();
+  });
+}
+
+}  // namespace data
+}  // namespace tensorflow
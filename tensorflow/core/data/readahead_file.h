@@ -0,0 +1,89 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_READAHEAD_FILE_H_
+#define TENSORFLOW_CORE_DATA_READAHEAD_FILE_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stringpiece.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A `RandomAccessFile` that keeps several block reads of another file in
+// flight, for readers that consume files front to back, such as
+// `io::RecordReader`.
+//
+// The file is read in aligned blocks of `block_size` bytes on `thread_pool`.
+// Up to `max_blocks` consecutive blocks starting at the block of the last read
+// are requested at any time, and reads are served from completed blocks. A
+// read outside of the requested window discards the window and restarts it at
+// the new offset, so seeking works but is not faster than without read-ahead.
+class ReadAheadFile : public RandomAccessFile {
+ public:
+  // Does not take ownership of `file` or `thread_pool`, which must outlive this
+  // object.
+  ReadAheadFile(RandomAccessFile* file, thread::ThreadPool* thread_pool,
+                size_t block_size, int max_blocks);
+  ~ReadAheadFile() override;
+
+  Status Name(StringPiece* result) const override;
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override;
+
+ private:
+  struct Block;
+
+  // Discards the requested blocks that precede `block_index`, or all of them
+  // if `block_index` is outside of the window, and requests blocks up to
+  // `max_blocks_`.
+  void AdvanceWindow(uint64 block_index) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Requests block `block_index` from `file_`.
+  void Schedule(uint64 block_index) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  RandomAccessFile* const file_;         // Not owned.
+  thread::ThreadPool* const thread_pool_;  // Not owned.
+  const size_t block_size_;
+  const int max_blocks_;
+
+  mutable mutex mu_;
+  mutable condition_variable cond_var_;
+  // The requested blocks, for consecutive block indices starting at
+  // `first_block_`.
+  mutable std::deque<std::shared_ptr<Block>> blocks_ TF_GUARDED_BY(mu_);
+  mutable uint64 first_block_ TF_GUARDED_BY(mu_) = 0;
+  // The index of a block known to end the file. No later block is requested.
+  mutable uint64 last_block_ TF_GUARDED_BY(mu_);
+  // The number of reads of `file_` that have not completed, including those of
+  // discarded blocks.
+  mutable int64_t num_pending_reads_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ReadAheadFile);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_READAHEAD_FILE_H_
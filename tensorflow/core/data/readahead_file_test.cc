@@ -0,0 +1,129 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/readahead_file.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/threadpool.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+class ReadAheadFileTest : public ::testing::Test {
+ protected:
+  ReadAheadFileTest()
+      : thread_pool_(Env::Default(), "readahead_file_test", /*num_threads=*/4) {}
+
+  // Writes `contents` to a new file and opens it.
+  std::unique_ptr<RandomAccessFile> OpenFile(const std::string& contents) {
+    const std::string filename =
+        io::JoinPath(testing::TmpDir(), "readahead_file_test");
+    TF_CHECK_OK(WriteStringToFile(Env::Default(), filename, contents));
+    std::unique_ptr<RandomAccessFile> file;
+    TF_CHECK_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+    return file;
+  }
+
+  thread::ThreadPool thread_pool_;
+};
+
+std::string Contents(int size) {
+  std::string contents(size, '\0');
+  for (int i = 0; i < size; ++i) contents[i] = 'a' + i % 26;
+  return contents;
+}
+
+TEST_F(ReadAheadFileTest, ReadsAcrossBlocks) {
+  const std::string contents = Contents(1000);
+  std::unique_ptr<RandomAccessFile> file = OpenFile(contents);
+  ReadAheadFile readahead(file.get(), &thread_pool_, /*block_size=*/64,
+                          /*max_blocks=*/4);
+  char scratch[100];
+  StringPiece result;
+  for (uint64 offset = 0; offset + 100 <= 1000; offset += 100) {
+    TF_ASSERT_OK(readahead.Read(offset, 100, &result, scratch));
+    EXPECT_EQ(result, contents.substr(offset, 100));
+  }
+}
+
+TEST_F(ReadAheadFileTest, ShortReadAtEnd) {
+  const std::string contents = Contents(130);
+  std::unique_ptr<RandomAccessFile> file = OpenFile(contents);
+  ReadAheadFile readahead(file.get(), &thread_pool_, /*block_size=*/64,
+                          /*max_blocks=*/2);
+  char scratch[100];
+  StringPiece result;
+  TF_ASSERT_OK(readahead.Read(0, 100, &result, scratch));
+  Status s = readahead.Read(100, 100, &result, scratch);
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_EQ(result, contents.substr(100));
+  s = readahead.Read(130, 10, &result, scratch);
+  EXPECT_TRUE(errors::IsOutOfRange(s)) << s;
+  EXPECT_TRUE(result.empty());
+}
+
+TEST_F(ReadAheadFileTest, Seek) {
+  const std::string contents = Contents(1000);
+  std::unique_ptr<RandomAccessFile> file = OpenFile(contents);
+  ReadAheadFile readahead(file.get(), &thread_pool_, /*block_size=*/64,
+                          /*max_blocks=*/2);
+  char scratch[50];
+  StringPiece result;
+  for (uint64 offset : {900, 10, 500, 0, 950}) {
+    TF_ASSERT_OK(readahead.Read(offset, 50, &result, scratch));
+    EXPECT_EQ(result, contents.substr(offset, 50));
+  }
+}
+
+TEST_F(ReadAheadFileTest, FeedsRecordReader) {
+  const std::string filename =
+      io::JoinPath(testing::TmpDir(), "readahead_file_test_records");
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_ASSERT_OK(Env::Default()->NewWritableFile(filename, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 100; ++i) {
+      TF_ASSERT_OK(writer.WriteRecord(Contents(i * 7)));
+    }
+    TF_ASSERT_OK(writer.Close());
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(filename, &file));
+  ReadAheadFile readahead(file.get(), &thread_pool_, /*block_size=*/256,
+                          /*max_blocks=*/8);
+  io::RecordReaderOptions options;
+  options.buffer_size = 100;
+  io::SequentialRecordReader reader(&readahead, options);
+  for (int i = 0; i < 100; ++i) {
+    tstring record;
+    TF_ASSERT_OK(reader.ReadRecord(&record));
+    EXPECT_EQ(record, Contents(i * 7));
+  }
+  tstring record;
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&record)));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/client/data_service_client.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/substitute.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/data/service/client/common.h"
@@ -54,16 +56,38 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+constexpr char kClientTagsEnvVar[] = "TF_DATA_SERVICE_CLIENT_TAGS";
+
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](std::string_view worker_tag) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
   });
 }
 
+std::vector<std::string> ClientTagsFromEnv() {
+  const char* client_tags = std::getenv(kClientTagsEnvVar);
+  if (client_tags == nullptr) {
+    return {};
+  }
+  return absl::StrSplit(client_tags, ',', absl::SkipWhitespace());
+}
+
+// Workers in the same process rank first, then by `TaskInfo::locality`.
+int64_t LocalityRank(const TaskInfo& task) {
+  if (LocalWorkers::Get(task.worker_address()) != nullptr) {
+    return 0;
+  }
+  if (task.locality() == WORKER_LOCALITY_UNSPECIFIED) {
+    return WORKER_LOCALITY_REMOTE;
+  }
+  return task.locality();
+}
+
 }  // namespace
 
 DataServiceClient::DataServiceClient(const DataServiceParams& params)
     : params_(params),
+      client_tags_(ClientTagsFromEnv()),
       max_outstanding_requests_(params.max_outstanding_requests) {}
 
 DataServiceClient::~DataServiceClient() {
@@ -311,7 +335,8 @@ Status DataServiceClient::AddTask(const TaskInfo& task_info)
                       CreateDataServiceWorkerClient(
                           task_info.transfer_address(), params_.protocol,
                           params_.data_transfer_protocol));
-  tasks_.push_back(std::make_shared<Task>(task_info, std::move(worker)));
+  tasks_.push_back(std::make_shared<Task>(task_info, std::move(worker),
+                                          LocalityRank(task_info)));
   worker_thread_cv_.notify_one();
   if (IsCoordinatedRead()) {
     VLOG(1) << "Consumer " << params_.consumer_index.value() << " adding task "
@@ -329,6 +354,7 @@ Status DataServiceClient::AddTask(const TaskInfo& task_info)
 void DataServiceClient::Heartbeat() TF_LOCKS_EXCLUDED(mu_) {
   ClientHeartbeatRequest req;
   req.set_iteration_client_id(iteration_client_id_);
+  *req.mutable_client_tags() = {client_tags_.begin(), client_tags_.end()};
   if (IsCoordinatedRead()) {
     mutex_lock l(mu_);
     req.set_current_round(current_round_);
@@ -566,6 +592,9 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   if (!ShouldProcessTask()) {
     return nullptr;
   }
+  if (!IsCoordinatedRead()) {
+    return GetClosestTaskToProcess();
+  }
 
   for (int i = 0; i < tasks_.size(); ++i) {
     std::shared_ptr<Task>& task = tasks_[next_task_index_];
@@ -597,6 +626,41 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   return nullptr;
 }
 
+std::shared_ptr<DataServiceClient::Task>
+DataServiceClient::GetClosestTaskToProcess() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  int64_t closest_unfinished_rank = std::numeric_limits<int64_t>::max();
+  std::optional<int64_t> closest_index;
+  for (int i = 0; i < tasks_.size(); ++i) {
+    const int64_t index = (next_task_index_ + i) % tasks_.size();
+    const std::shared_ptr<Task>& task = tasks_[index];
+    if (task->end_of_sequence || task->removed) {
+      continue;
+    }
+    closest_unfinished_rank =
+        std::min(closest_unfinished_rank, task->locality_rank);
+    if (task->in_use) {
+      continue;
+    }
+    if (!closest_index.has_value() ||
+        task->locality_rank < tasks_[*closest_index]->locality_rank) {
+      closest_index = index;
+    }
+  }
+  if (!closest_index.has_value()) {
+    return nullptr;
+  }
+  std::shared_ptr<Task> task = tasks_[*closest_index];
+  if (task->locality_rank > closest_unfinished_rank && !results_.empty()) {
+    VLOG(4) << "Not reading from task " << task->info.task_id()
+            << " while closer workers have buffered results.";
+    return nullptr;
+  }
+  task->round = current_round_;
+  next_task_index_ = *closest_index;
+  AdvanceTaskIndex();
+  return task;
+}
+
 // Increments the next task index, starting over if all tasks have been
 // processed.
 void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -81,12 +81,17 @@ class DataServiceClient {
 
  private:
   struct Task {
-    Task(const TaskInfo& info, std::unique_ptr<DataServiceWorkerClient> worker)
-        : info(info), worker(std::move(worker)) {}
+    Task(const TaskInfo& info, std::unique_ptr<DataServiceWorkerClient> worker,
+         int64_t locality_rank)
+        : info(info),
+          worker(std::move(worker)),
+          locality_rank(locality_rank) {}
 
     const TaskInfo info;
     // Client for fetching task elements from the tf.data service worker.
     const std::unique_ptr<DataServiceWorkerClient> worker;
+    // How close the worker is to the client. Lower is closer.
+    const int64_t locality_rank;
     // The next round to read from the task.
     int64_t round = 0;
     // Whether the task has been removed. The task will eventually be
@@ -148,6 +153,10 @@ class DataServiceClient {
   // Searches for a task to process, visiting tasks in-order and giving every
   // task a chance to proceed.
   std::shared_ptr<Task> GetTaskToProcess();
+  // For non-coordinated reads, searches for the closest task to process. Tasks
+  // farther than the closest unfinished task are only read from when no result
+  // is buffered, i.e. when the closer workers cannot keep up.
+  std::shared_ptr<Task> GetClosestTaskToProcess();
   void AdvanceTaskIndex();
   Status TryGetElement(const Task& task, GetElementResult& result);
   void ProcessGetElementResponse(bool enqueue_result,
@@ -164,6 +173,9 @@ class DataServiceClient {
   std::string DebugString() const;
 
   const DataServiceParams params_;
+  // Tags describing where the client runs, read from the
+  // TF_DATA_SERVICE_CLIENT_TAGS environment variable, e.g. "rack:r1,zone:z1".
+  const std::vector<std::string> client_tags_;
 
   mutable mutex mu_;
   condition_variable get_next_cv_ TF_GUARDED_BY(mu_);
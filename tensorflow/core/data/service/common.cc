@@ -14,9 +14,12 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/common.h"
 
+#include <optional>
 #include <string>
 
+#include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/platform/errors.h"
@@ -35,6 +38,17 @@ constexpr const char kLocal[] = "LOCAL";
 constexpr const char kColocated[] = "COLOCATED";
 constexpr const char kRemote[] = "REMOTE";
 constexpr const char kHybrid[] = "HYBRID";
+
+// Returns the value of the first tag starting with `prefix`, if any.
+std::optional<absl::string_view> FindTagValue(
+    absl::Span<const std::string> tags, absl::string_view prefix) {
+  for (absl::string_view tag : tags) {
+    if (absl::StartsWithIgnoreCase(tag, prefix)) {
+      return tag.substr(prefix.size());
+    }
+  }
+  return std::nullopt;
+}
 }  // namespace
 
 bool IsNoShard(const ProcessingModeDef& processing_mode) {
@@ -131,6 +145,33 @@ StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s) {
                                  "COLOCATED, REMOTE, and HYBRID.");
 }
 
+WorkerLocality GetWorkerLocality(absl::Span<const std::string> worker_tags,
+                                 absl::Span<const std::string> client_tags) {
+  const std::optional<absl::string_view> client_rack =
+      FindTagValue(client_tags, kRackTagPrefix);
+  const std::optional<absl::string_view> client_zone =
+      FindTagValue(client_tags, kZoneTagPrefix);
+  if (!client_rack.has_value() && !client_zone.has_value()) {
+    return WORKER_LOCALITY_UNSPECIFIED;
+  }
+  const std::optional<absl::string_view> worker_rack =
+      FindTagValue(worker_tags, kRackTagPrefix);
+  const std::optional<absl::string_view> worker_zone =
+      FindTagValue(worker_tags, kZoneTagPrefix);
+  // Rack names are only meaningful within a zone.
+  if (client_zone.has_value() && worker_zone.has_value() &&
+      *client_zone != *worker_zone) {
+    return WORKER_LOCALITY_REMOTE;
+  }
+  if (client_rack.has_value() && client_rack == worker_rack) {
+    return WORKER_LOCALITY_SAME_RACK;
+  }
+  if (client_zone.has_value() && client_zone == worker_zone) {
+    return WORKER_LOCALITY_SAME_ZONE;
+  }
+  return WORKER_LOCALITY_REMOTE;
+}
+
 bool IsPreemptedError(const Status& status) {
   return errors::IsAborted(status) || errors::IsCancelled(status) ||
          errors::IsUnavailable(status);
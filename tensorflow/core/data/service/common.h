@@ -18,6 +18,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/platform/status.h"
@@ -37,6 +38,12 @@ constexpr int kDataServiceVersion = 6;
 // workers on other TF hosts when the host runs a local tf.data service worker.
 constexpr absl::string_view kColocatedWorkerTag = "COLOCATED";
 
+// Worker and client tags with these prefixes describe where they run, e.g.
+// "rack:r12" or "zone:us-east1-b". Clients prefer reading from the workers
+// closest to them.
+constexpr absl::string_view kRackTagPrefix = "rack:";
+constexpr absl::string_view kZoneTagPrefix = "zone:";
+
 // Returns true if `processing_mode` specifies no sharding policy.
 bool IsNoShard(const ProcessingModeDef& processing_mode);
 
@@ -65,6 +72,11 @@ std::string TargetWorkersToString(TargetWorkers target_workers);
 // Returns InvalidArgument if the string is not recognized.
 StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s);
 
+// Returns how close a worker with `worker_tags` is to a client with
+// `client_tags`, based on their rack and zone tags (case-insensitive prefixes).
+WorkerLocality GetWorkerLocality(absl::Span<const std::string> worker_tags,
+                                 absl::Span<const std::string> client_tags);
+
 // Returns true if `status` is a retriable error that indicates preemption.
 bool IsPreemptedError(const Status& status);
 
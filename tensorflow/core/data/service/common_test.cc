@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/common.h"
 
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/framework/dataset_options.pb.h"
@@ -170,6 +171,21 @@ TEST(CommonTest, ParseInvalidDeploymentMode) {
               testing::StatusIs(error::INVALID_ARGUMENT));
 }
 
+TEST(CommonTest, WorkerLocality) {
+  const std::vector<std::string> client = {"rack:r1", "ZONE:z1"};
+  EXPECT_EQ(GetWorkerLocality({"rack:r1", "zone:z1"}, client),
+            WORKER_LOCALITY_SAME_RACK);
+  EXPECT_EQ(GetWorkerLocality({"COLOCATED", "rack:r2", "zone:z1"}, client),
+            WORKER_LOCALITY_SAME_ZONE);
+  EXPECT_EQ(GetWorkerLocality({"zone:z1"}, client), WORKER_LOCALITY_SAME_ZONE);
+  // Same rack name in another zone.
+  EXPECT_EQ(GetWorkerLocality({"rack:r1", "zone:z2"}, client),
+            WORKER_LOCALITY_REMOTE);
+  EXPECT_EQ(GetWorkerLocality({}, client), WORKER_LOCALITY_REMOTE);
+  EXPECT_EQ(GetWorkerLocality({"rack:r1", "zone:z1"}, {}),
+            WORKER_LOCALITY_UNSPECIFIED);
+}
+
 TEST(CommonTest, IsPreemptedError) {
   EXPECT_TRUE(IsPreemptedError(errors::Aborted("Aborted")));
   EXPECT_TRUE(IsPreemptedError(errors::Cancelled("Cancelled")));
@@ -15,13 +15,16 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_CROSS_TRAINER_CACHE_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <deque>
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/logging_utils.h"
@@ -46,6 +49,10 @@ namespace data {
 // collected when the cache becomes full. Consequently, trainers read from a
 // sliding window through the dataset and may not read the full dataset.
 //
+// Optionally, elements evicted from memory move to a `CacheSpillStore`, e.g. on
+// local disk, which has its own size budget. Trainers that fall behind the
+// in-memory window read from the spill store instead of skipping elements.
+//
 // The `CrossTrainerCache` class is thread-safe.
 //
 // Example usage:
@@ -91,6 +98,25 @@ class CachableSequence {
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
 };
 
+// Second tier of a `CrossTrainerCache`, holding elements evicted from memory.
+// Implementations must be thread-safe.
+template <class ElementType>
+class CacheSpillStore {
+ public:
+  virtual ~CacheSpillStore() = default;
+
+  // Stores `element` under `index`. Returns the number of bytes it occupies in
+  // the store.
+  virtual StatusOr<size_t> Write(size_t index, const ElementType& element) = 0;
+
+  // Reads the element stored under `index`. Returns a NotFound error if it has
+  // been erased.
+  virtual StatusOr<ElementType> Read(size_t index) = 0;
+
+  // Erases the element stored under `index`.
+  virtual Status Erase(size_t index) = 0;
+};
+
 // Sliding-window cache shared across concurrent trainers.
 template <class ElementType>
 class CrossTrainerCache {
@@ -101,6 +127,14 @@ class CrossTrainerCache {
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
       std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+
+  // Creates a `CrossTrainerCache` which moves elements evicted from memory to
+  // `spill_store`, keeping at most `max_spill_size_bytes` there.
+  CrossTrainerCache(
+      size_t max_cache_size_bytes,
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<CacheSpillStore<ElementType>> spill_store,
+      size_t max_spill_size_bytes);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -138,13 +172,26 @@ class CrossTrainerCache {
   // the cached elements).
   size_t GetElementIndex(const std::string& trainer_id);
 
-  // Returns the next element for `trainer_id`.
+  // Returns the next element for `trainer_id`. If the element has been moved
+  // to the spill store, returns nullptr and sets `spilled_index` to its index,
+  // to be read without holding `mu_`.
   StatusOr<std::shared_ptr<const ElementType>> GetElement(
-      const std::string& trainer_id);
+      const std::string& trainer_id, std::optional<size_t>& spilled_index);
 
   // Reads a new element and writes it into the cache.
   Status ExtendCache();
 
+  // Returns the number of elements to evict from memory to make room for an
+  // element of `new_element_size_bytes`.
+  size_t NumElementsToEvict(size_t new_element_size_bytes);
+
+  // Writes `elements`, starting at index `first_index`, to the spill store and
+  // erases the oldest spilled elements to keep the store within
+  // `max_spill_size_bytes_`.
+  void Spill(size_t first_index,
+             const std::vector<std::shared_ptr<const ElementType>>& elements)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
   void FreeSpace(size_t new_element_size_bytes);
@@ -158,6 +205,10 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  // Optional second tier for evicted elements, and its size budget.
+  const std::unique_ptr<CacheSpillStore<ElementType>> spill_store_;
+  const size_t max_spill_size_bytes_ = 0;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -170,6 +221,13 @@ class CrossTrainerCache {
   size_t cache_size_bytes_ TF_GUARDED_BY(mu_) = 0;
   size_t cache_start_index_ TF_GUARDED_BY(mu_) = 0;
 
+  // `spilled_sizes_` stores the sizes of the elements in the spill store, i.e.
+  // of the elements at indices `spill_start_index_` onward. While elements are
+  // being evicted, they are both in memory and in the spill store.
+  std::deque<size_t> spilled_sizes_ TF_GUARDED_BY(mu_);
+  size_t spill_size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  size_t spill_start_index_ TF_GUARDED_BY(mu_) = 0;
+
   // True if one thread is extending the cache.
   bool extending_cache_ TF_GUARDED_BY(mu_) = false;
 
@@ -192,6 +250,23 @@ CrossTrainerCache<ElementType>::CrossTrainerCache(
           << FormatBytes(max_cache_size_bytes) << " of memory.";
 }
 
+template <class ElementType>
+CrossTrainerCache<ElementType>::CrossTrainerCache(
+    size_t max_cache_size_bytes,
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<CacheSpillStore<ElementType>> spill_store,
+    size_t max_spill_size_bytes)
+    : max_cache_size_bytes_(max_cache_size_bytes),
+      cachable_sequence_(std::move(cachable_sequence)),
+      spill_store_(std::move(spill_store)),
+      max_spill_size_bytes_(max_spill_size_bytes) {
+  DCHECK_GT(max_cache_size_bytes, 0)
+      << "CrossTrainerCache size must be greater than 0.";
+  VLOG(2) << "Initialized tf.data service cross-trainer cache with "
+          << FormatBytes(max_cache_size_bytes) << " of memory and "
+          << FormatBytes(max_spill_size_bytes) << " of spill space.";
+}
+
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
 CrossTrainerCache<ElementType>::Get(const std::string& trainer_id)
@@ -212,20 +287,21 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
   bool should_extend_cache = false;
   while (true) {
+    std::optional<size_t> spilled_index;
     {
       mutex_lock l(mu_);
       TF_RETURN_IF_ERROR(status_);
       if (IsElementReady(trainer_id)) {
         TF_ASSIGN_OR_RETURN(std::shared_ptr<const ElementType> element,
-                            GetElement(trainer_id));
-        return CacheQueryResult{element,
-                                /*is_cache_hit=*/!should_extend_cache};
-      }
-
-      // Extends the cache or waits for another thread to extend the cache. When
-      // concurrent trainers wait for the next element, only one of them should
-      // extend the cache.
-      if (extending_cache_) {
+                            GetElement(trainer_id, spilled_index));
+        if (element) {
+          return CacheQueryResult{element,
+                                  /*is_cache_hit=*/!should_extend_cache};
+        }
+      } else if (extending_cache_) {
+        // Extends the cache or waits for another thread to extend the cache.
+        // When concurrent trainers wait for the next element, only one of them
+        // should extend the cache.
         should_extend_cache = false;
         cv_.wait(l);
       } else {
@@ -234,6 +310,19 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
       }
     }
 
+    if (spilled_index.has_value()) {
+      StatusOr<ElementType> element = spill_store_->Read(*spilled_index);
+      if (errors::IsNotFound(element.status())) {
+        // Erased after the trainer was pointed to it. The trainer moves on to
+        // the oldest remaining element.
+        continue;
+      }
+      TF_RETURN_IF_ERROR(element.status());
+      return CacheQueryResult{
+          std::make_shared<const ElementType>(std::move(*element)),
+          /*is_cache_hit=*/true};
+    }
+
     if (should_extend_cache) {
       Status s = ExtendCache();
       mutex_lock l(mu_);
@@ -252,7 +341,8 @@ bool CrossTrainerCache<ElementType>::IsElementReady(
 
 template <class ElementType>
 StatusOr<std::shared_ptr<const ElementType>>
-CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
+CrossTrainerCache<ElementType>::GetElement(
+    const std::string& trainer_id, std::optional<size_t>& spilled_index)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = GetElementIndex(trainer_id);
   if (element_index >= std::numeric_limits<size_t>::max()) {
@@ -261,18 +351,24 @@ CrossTrainerCache<ElementType>::GetElement(const std::string& trainer_id)
         element_index);
   }
 
-  std::shared_ptr<const ElementType> result =
-      cache_[element_index - cache_start_index_];
   trainer_to_element_index_map_[trainer_id] = element_index + 1;
-  return result;
+  if (element_index < cache_start_index_) {
+    spilled_index = element_index;
+    return std::shared_ptr<const ElementType>();
+  }
+  return cache_[element_index - cache_start_index_];
 }
 
 template <class ElementType>
 size_t CrossTrainerCache<ElementType>::GetElementIndex(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   size_t element_index = trainer_to_element_index_map_[trainer_id];
-  if (element_index < cache_start_index_) {
-    element_index = cache_start_index_;
+  const size_t oldest_index = spilled_sizes_.empty()
+                                  ? cache_start_index_
+                                  : std::min(spill_start_index_,
+                                             cache_start_index_);
+  if (element_index < oldest_index) {
+    element_index = oldest_index;
   }
   return element_index;
 }
@@ -289,6 +385,22 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
         " and cache size: ", max_cache_size_bytes_);
   }
 
+  if (spill_store_) {
+    // Only the thread extending the cache evicts elements, so the elements
+    // spilled here are still the oldest in memory when `FreeSpace` runs.
+    std::vector<std::shared_ptr<const ElementType>> evicted;
+    size_t first_evicted_index = 0;
+    {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(status_);
+      first_evicted_index = cache_start_index_;
+      evicted.assign(
+          cache_.begin(),
+          cache_.begin() + NumElementsToEvict(new_element_size_bytes));
+    }
+    Spill(first_evicted_index, evicted);
+  }
+
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(status_);
   FreeSpace(new_element_size_bytes);
@@ -297,18 +409,79 @@ Status CrossTrainerCache<ElementType>::ExtendCache() TF_LOCKS_EXCLUDED(mu_) {
   return OkStatus();
 }
 
+template <class ElementType>
+size_t CrossTrainerCache<ElementType>::NumElementsToEvict(
+    size_t new_element_size_bytes) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  size_t num_elements = 0;
+  size_t remaining_bytes = cache_size_bytes_;
+  while (num_elements < cache_.size() &&
+         remaining_bytes + new_element_size_bytes > max_cache_size_bytes_) {
+    remaining_bytes -=
+        cachable_sequence_->GetElementSizeBytes(*cache_[num_elements]);
+    ++num_elements;
+  }
+  return num_elements;
+}
+
+template <class ElementType>
+void CrossTrainerCache<ElementType>::Spill(
+    size_t first_index,
+    const std::vector<std::shared_ptr<const ElementType>>& elements)
+    TF_LOCKS_EXCLUDED(mu_) {
+  std::vector<size_t> indices_to_erase;
+  for (size_t i = 0; i < elements.size(); ++i) {
+    const size_t index = first_index + i;
+    StatusOr<size_t> size_bytes = spill_store_->Write(index, *elements[i]);
+    mutex_lock l(mu_);
+    if (!size_bytes.ok()) {
+      // Keeps the spilled indices contiguous by dropping the older ones. The
+      // trainers behind the window skip them, as without a spill store.
+      LOG(WARNING) << "Failed to spill element " << index << " of the "
+                   << "tf.data service cross-trainer cache: "
+                   << size_bytes.status();
+      for (size_t j = 0; j < spilled_sizes_.size(); ++j) {
+        indices_to_erase.push_back(spill_start_index_ + j);
+      }
+      spilled_sizes_.clear();
+      spill_size_bytes_ = 0;
+      continue;
+    }
+    if (spilled_sizes_.empty()) {
+      spill_start_index_ = index;
+    }
+    spilled_sizes_.push_back(*size_bytes);
+    spill_size_bytes_ += *size_bytes;
+    while (!spilled_sizes_.empty() &&
+           spill_size_bytes_ > max_spill_size_bytes_) {
+      indices_to_erase.push_back(spill_start_index_);
+      spill_size_bytes_ -= spilled_sizes_.front();
+      spilled_sizes_.pop_front();
+      ++spill_start_index_;
+    }
+  }
+
+  for (size_t index : indices_to_erase) {
+    Status s = spill_store_->Erase(index);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to erase spilled element " << index << " of the "
+                   << "tf.data service cross-trainer cache: " << s;
+    }
+  }
+  VLOG(3) << "Spilled " << elements.size() << " element(s) from "
+          << "tf.data service cross-trainer cache.";
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-  size_t num_elements_discarded = 0;
-  while (!cache_.empty() &&
-         cache_size_bytes_ + new_element_size_bytes > max_cache_size_bytes_) {
+  const size_t num_elements_discarded =
+      NumElementsToEvict(new_element_size_bytes);
+  for (size_t i = 0; i < num_elements_discarded; ++i) {
     size_t free_bytes =
         cachable_sequence_->GetElementSizeBytes(*cache_.front());
     cache_.pop_front();
     cache_size_bytes_ -= free_bytes;
     ++cache_start_index_;
-    ++num_elements_discarded;
   }
 
   VLOG(3) << "Freed " << num_elements_discarded << " element(s) from "
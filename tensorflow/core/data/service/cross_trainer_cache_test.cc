@@ -190,6 +190,88 @@ TEST(CrossTrainerCacheTest, SlowTrainersSkipData) {
   EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(Gt(94))));
 }
 
+// Spill store keeping the spilled elements in a map. If `fail_writes` is
+// true, writes fail.
+class MapSpillStore : public CacheSpillStore<int64_t> {
+ public:
+  explicit MapSpillStore(bool fail_writes = false)
+      : fail_writes_(fail_writes) {}
+
+  StatusOr<size_t> Write(size_t index, const int64_t& element) override {
+    if (fail_writes_) {
+      return errors::Unavailable("Disk is full.");
+    }
+    mutex_lock l(mu_);
+    elements_[index] = element;
+    return sizeof(element);
+  }
+
+  StatusOr<int64_t> Read(size_t index) override {
+    mutex_lock l(mu_);
+    auto it = elements_.find(index);
+    if (it == elements_.end()) {
+      return errors::NotFound("Element ", index, " has been erased.");
+    }
+    return it->second;
+  }
+
+  Status Erase(size_t index) override {
+    mutex_lock l(mu_);
+    elements_.erase(index);
+    return OkStatus();
+  }
+
+ private:
+  const bool fail_writes_;
+  mutex mu_;
+  absl::flat_hash_map<size_t, int64_t> elements_ TF_GUARDED_BY(mu_);
+};
+
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(), std::make_unique<MapSpillStore>(),
+      /*max_spill_size_bytes=*/10 * sizeof(int64_t));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  // 15 to 19 are in memory and 5 to 14 are spilled. The slow trainer reads all
+  // of them in order.
+  for (int i = 5; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(20)));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(20)));
+}
+
+TEST(CrossTrainerCacheTest, NewTrainersStartFromSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(), std::make_unique<MapSpillStore>(),
+      /*max_spill_size_bytes=*/10 * sizeof(int64_t));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Old trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("New trainer"), IsOkAndHolds(Pointee(85)));
+}
+
+TEST(CrossTrainerCacheTest, FailedSpillsSkipData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<MapSpillStore>(/*fail_writes=*/true),
+      /*max_spill_size_bytes=*/10 * sizeof(int64_t));
+  EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(0)));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 1; i < 20; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(15)));
+}
+
 TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   CrossTrainerCache<int64_t> cache(
       /*max_cache_size_bytes=*/5 * sizeof(int64_t),
@@ -0,0 +1,125 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/disk_spill_store.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/io/compression.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Snapshot file format version 2, i.e. TFRecords. The files are not
+// compressed: they are read back shortly after being written, usually from a
+// local SSD, so compressing them would mostly cost CPU time.
+constexpr int kFileFormatVersion = 2;
+
+}  // namespace
+
+StatusOr<std::unique_ptr<DiskSpillStore>> DiskSpillStore::Create(
+    Env* env, const std::string& directory) {
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(directory));
+  return absl::WrapUnique(new DiskSpillStore(env, directory));
+}
+
+DiskSpillStore::DiskSpillStore(Env* env, const std::string& directory)
+    : env_(env), directory_(directory) {}
+
+DiskSpillStore::~DiskSpillStore() {
+  int64_t undeleted_files = 0, undeleted_dirs = 0;
+  Status s =
+      env_->DeleteRecursively(directory_, &undeleted_files, &undeleted_dirs);
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to delete the cross-trainer cache spill directory "
+                 << directory_ << ": " << s;
+  }
+}
+
+std::string DiskSpillStore::FileName(size_t index) const {
+  return io::JoinPath(directory_, absl::StrCat("element_", index));
+}
+
+StatusOr<size_t> DiskSpillStore::Write(size_t index,
+                                       const GetElementResult& element) {
+  ElementInfo info;
+  info.element_index = element.element_index;
+  for (const Tensor& component : element.components) {
+    info.dtypes.push_back(component.dtype());
+  }
+
+  const std::string filename = FileName(index);
+  std::unique_ptr<snapshot_util::Writer> writer;
+  TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
+      env_, filename, io::compression::kNone, kFileFormatVersion, info.dtypes,
+      &writer));
+  TF_RETURN_IF_ERROR(writer->WriteTensors(element.components));
+  TF_RETURN_IF_ERROR(writer->Close());
+  uint64 file_size = 0;
+  TF_RETURN_IF_ERROR(env_->GetFileSize(filename, &file_size));
+
+  mutex_lock l(mu_);
+  elements_[index] = std::move(info);
+  return file_size;
+}
+
+StatusOr<GetElementResult> DiskSpillStore::Read(size_t index) {
+  ElementInfo info;
+  {
+    mutex_lock l(mu_);
+    auto it = elements_.find(index);
+    if (it == elements_.end()) {
+      return errors::NotFound("Element ", index,
+                              " is not in the cross-trainer cache spill "
+                              "directory ",
+                              directory_);
+    }
+    info = it->second;
+  }
+
+  // The file may be erased concurrently, in which case reading it fails with
+  // a NotFound error.
+  std::unique_ptr<snapshot_util::Reader> reader;
+  TF_RETURN_IF_ERROR(snapshot_util::Reader::Create(env_, FileName(index),
+                                                   io::compression::kNone,
+                                                   kFileFormatVersion,
+                                                   info.dtypes, &reader));
+  GetElementResult result;
+  TF_RETURN_IF_ERROR(reader->ReadTensors(&result.components));
+  result.element_index = info.element_index;
+  return result;
+}
+
+Status DiskSpillStore::Erase(size_t index) {
+  {
+    mutex_lock l(mu_);
+    if (elements_.erase(index) == 0) {
+      return OkStatus();
+    }
+  }
+  return env_->DeleteFile(FileName(index));
+}
+
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_DISK_SPILL_STORE_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_DISK_SPILL_STORE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/data/service/cross_trainer_cache.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace data {
+
+// Spill store for the cross-trainer cache which writes each element to its own
+// file in a local directory, in the snapshot TFRecord format. The directory and
+// the files in it are deleted when the store is destroyed.
+class DiskSpillStore : public CacheSpillStore<GetElementResult> {
+ public:
+  // Creates a store writing to `directory`, which is created if needed. The
+  // directory should not be shared with other stores.
+  static StatusOr<std::unique_ptr<DiskSpillStore>> Create(
+      Env* env, const std::string& directory);
+  ~DiskSpillStore() override;
+
+  StatusOr<size_t> Write(size_t index, const GetElementResult& element)
+      TF_LOCKS_EXCLUDED(mu_) override;
+  StatusOr<GetElementResult> Read(size_t index) TF_LOCKS_EXCLUDED(mu_) override;
+  Status Erase(size_t index) TF_LOCKS_EXCLUDED(mu_) override;
+
+ private:
+  // What is needed to read an element back besides its tensors.
+  struct ElementInfo {
+    DataTypeVector dtypes;
+    int64_t element_index = 0;
+  };
+
+  DiskSpillStore(Env* env, const std::string& directory);
+
+  std::string FileName(size_t index) const;
+
+  Env* const env_;
+  const std::string directory_;
+
+  mutex mu_;
+  absl::flat_hash_map<size_t, ElementInfo> elements_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_DISK_SPILL_STORE_H_
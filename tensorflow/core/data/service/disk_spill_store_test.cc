@@ -0,0 +1,92 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/disk_spill_store.h"
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+using ::testing::Gt;
+
+std::string LocalTempDir() {
+  std::string dir;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&dir));
+  return dir;
+}
+
+GetElementResult TestElement(int64_t element_index) {
+  GetElementResult element;
+  element.components = {
+      test::AsTensor<int64_t>({1, 2, 3}, TensorShape({3})),
+      test::AsTensor<tstring>({"a", "bc"}, TensorShape({2}))};
+  element.element_index = element_index;
+  return element;
+}
+
+TEST(DiskSpillStoreTest, RoundTrip) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DiskSpillStore> store,
+                          DiskSpillStore::Create(Env::Default(),
+                                                 LocalTempDir()));
+  GetElementResult element = TestElement(/*element_index=*/7);
+  TF_ASSERT_OK_AND_ASSIGN(size_t size_bytes, store->Write(3, element));
+  EXPECT_THAT(size_bytes, Gt(0));
+
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult read, store->Read(3));
+  EXPECT_EQ(read.element_index, 7);
+  ASSERT_EQ(read.components.size(), 2);
+  test::ExpectEqual(read.components[0], element.components[0]);
+  test::ExpectEqual(read.components[1], element.components[1]);
+}
+
+TEST(DiskSpillStoreTest, ReadErasedElement) {
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DiskSpillStore> store,
+                          DiskSpillStore::Create(Env::Default(),
+                                                 LocalTempDir()));
+  TF_ASSERT_OK(store->Write(0, TestElement(/*element_index=*/0)).status());
+  TF_ASSERT_OK(store->Erase(0));
+  EXPECT_THAT(store->Read(0), StatusIs(error::NOT_FOUND));
+  EXPECT_THAT(store->Read(1), StatusIs(error::NOT_FOUND));
+  TF_EXPECT_OK(store->Erase(1));
+}
+
+TEST(DiskSpillStoreTest, DeletesDirectory) {
+  const std::string directory = LocalTempDir();
+  {
+    TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DiskSpillStore> store,
+                            DiskSpillStore::Create(Env::Default(), directory));
+    TF_ASSERT_OK(store->Write(0, TestElement(/*element_index=*/0)).status());
+    TF_EXPECT_OK(Env::Default()->FileExists(directory));
+  }
+  EXPECT_THAT(Env::Default()->FileExists(directory),
+              StatusIs(error::NOT_FOUND));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -24,7 +24,9 @@ limitations under the License.
 #include "tensorflow/core/data/service/test_cluster.h"
 #include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/statusor.h"
@@ -224,6 +226,70 @@ TEST_F(DispatcherClientTest, NamedJobsDoNotMatch) {
                      HasSubstr("Existing processing mode: <>"),
                      HasSubstr("Existing cross-trainer cache: <disabled>"))));
 }
+
+TEST(DispatcherClientSplitTest, ReassignStragglerSplit) {
+  TestCluster::Config config;
+  config.num_workers = 1;
+  config.split_reassignment_timeout_ms = 1;
+  TestCluster test_cluster(config);
+  TF_ASSERT_OK(test_cluster.Initialize());
+  DataServiceDispatcherClient dispatcher_client(
+      test_cluster.DispatcherAddress(), kProtocol);
+
+  DataServiceMetadata metadata = GetDefaultMetadata();
+  metadata.set_cardinality(1);
+  std::string dataset_id;
+  TF_ASSERT_OK(dispatcher_client.RegisterDataset(
+      RangeDataset(1), metadata, /*requested_dataset_id=*/std::nullopt,
+      dataset_id));
+  ProcessingModeDef processing_mode;
+  processing_mode.set_sharding_policy(ProcessingModeDef::DYNAMIC);
+  int64_t job_id;
+  TF_ASSERT_OK(dispatcher_client.GetOrCreateJob(
+      dataset_id, processing_mode, /*job_name=*/std::nullopt,
+      /*num_consumers=*/std::nullopt,
+      /*use_cross_trainer_cache=*/false, TARGET_WORKERS_AUTO, job_id));
+  int64_t iteration_client_id;
+  TF_ASSERT_OK(dispatcher_client.GetOrCreateIteration(
+      job_id, /*repetition=*/0, iteration_client_id));
+  WorkerHeartbeatRequest worker_heartbeat_request;
+  worker_heartbeat_request.set_worker_address(test_cluster.WorkerAddress(0));
+  TF_ASSERT_OK_AND_ASSIGN(
+      WorkerHeartbeatResponse worker_heartbeat_response,
+      dispatcher_client.WorkerHeartbeat(worker_heartbeat_request));
+  ASSERT_EQ(worker_heartbeat_response.new_tasks_size(), 1);
+  const int64_t iteration_id =
+      worker_heartbeat_response.new_tasks(0).iteration_id();
+
+  // The straggler task takes the only split of the epoch.
+  const int64_t kStragglerTaskId = 1000, kIdleTaskId = 1001;
+  Tensor straggler_split;
+  bool end_of_splits = true;
+  TF_ASSERT_OK(dispatcher_client.GetSplit(
+      iteration_id, /*repetition=*/0, /*split_provider_index=*/0,
+      kStragglerTaskId, straggler_split, end_of_splits));
+  ASSERT_FALSE(end_of_splits);
+  Env::Default()->SleepForMicroseconds(10 * 1000);
+
+  // After the timeout, an idle task receives a copy of the straggler's split.
+  Tensor reassigned_split;
+  TF_ASSERT_OK(dispatcher_client.GetSplit(
+      iteration_id, /*repetition=*/0, /*split_provider_index=*/0, kIdleTaskId,
+      reassigned_split, end_of_splits));
+  ASSERT_FALSE(end_of_splits);
+  EXPECT_EQ(reassigned_split.DebugString(), straggler_split.DebugString());
+
+  // A split is only reassigned once, so the epoch ends for both tasks.
+  Tensor split;
+  TF_ASSERT_OK(dispatcher_client.GetSplit(
+      iteration_id, /*repetition=*/0, /*split_provider_index=*/0, kIdleTaskId,
+      split, end_of_splits));
+  EXPECT_TRUE(end_of_splits);
+  TF_ASSERT_OK(dispatcher_client.GetSplit(
+      iteration_id, /*repetition=*/0, /*split_provider_index=*/0,
+      kStragglerTaskId, split, end_of_splits));
+  EXPECT_TRUE(end_of_splits);
+}
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
@@ -185,6 +185,10 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
     iteration_gc_thread_cv_.notify_all();
   }
   iteration_gc_thread_.reset();
+  Status s = SyncJournal();
+  if (!s.ok()) {
+    LOG(WARNING) << "Failed to sync the dispatcher journal: " << s;
+  }
 }
 
 Status DataServiceDispatcherImpl::Start() {
@@ -329,13 +333,57 @@ Status DataServiceDispatcherImpl::FindNewTasks(
   return OkStatus();
 }
 
+StatusOr<bool> DataServiceDispatcherImpl::HandleSteadyStateHeartbeat(
+    const std::string& worker_address,
+    const absl::flat_hash_set<int64_t>& current_tasks,
+    WorkerHeartbeatResponse* response) TF_SHARED_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> assigned_tasks;
+  if (!state_.TasksForWorker(worker_address, assigned_tasks).ok()) {
+    return false;
+  }
+  absl::flat_hash_set<int64_t> assigned_iteration_ids;
+  for (const auto& task : assigned_tasks) {
+    if (!current_tasks.contains(task->task_id)) {
+      return false;
+    }
+    assigned_iteration_ids.insert(task->iteration->iteration_id);
+  }
+  for (const auto& iteration : state_.ListIterations()) {
+    if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
+        iteration->IsRoundRobin() && !iteration->finished) {
+      return false;
+    }
+  }
+  TF_RETURN_IF_ERROR(
+      FindTasksToDelete(current_tasks, assigned_tasks, response));
+  return true;
+}
+
 Status DataServiceDispatcherImpl::WorkerHeartbeat(
     const WorkerHeartbeatRequest* request, WorkerHeartbeatResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
   VLOG(4) << "Received worker heartbeat request from worker "
           << request->worker_address();
-  mutex_lock l(mu_);
   const std::string& worker_address = request->worker_address();
+  absl::flat_hash_set<int64_t> current_tasks;
+  current_tasks.insert(request->current_tasks().cbegin(),
+                       request->current_tasks().cend());
+  {
+    // Most heartbeats come from registered workers whose tasks are up to date.
+    // They are handled concurrently, under a shared lock.
+    tf_shared_lock l(mu_);
+    TF_ASSIGN_OR_RETURN(
+        bool handled,
+        HandleSteadyStateHeartbeat(worker_address, current_tasks, response));
+    if (handled) {
+      VLOG(4) << "Finished worker heartbeat for worker at address "
+              << worker_address;
+      return OkStatus();
+    }
+  }
+  response->clear_tasks_to_delete();
+
+  mutex_lock l(mu_);
   // Assigned tasks from the perspective of the dispatcher.
   std::vector<std::shared_ptr<const Task>> assigned_tasks;
   Status s = state_.TasksForWorker(worker_address, assigned_tasks);
@@ -356,9 +404,6 @@ Status DataServiceDispatcherImpl::WorkerHeartbeat(
     TF_RETURN_IF_ERROR(CreateTasksForWorker(worker_address));
     TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
   }
-  absl::flat_hash_set<int64_t> current_tasks;
-  current_tasks.insert(request->current_tasks().cbegin(),
-                       request->current_tasks().cend());
   TF_RETURN_IF_ERROR(
       FindTasksToDelete(current_tasks, assigned_tasks, response));
   TF_RETURN_IF_ERROR(
@@ -431,12 +476,24 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
             << " is greater than the requested repetition " << repetition;
     return OkStatus();
   }
+  const bool reassignment_enabled = config_.split_reassignment_timeout_ms() > 0;
+  auto& in_flight = in_flight_splits_[{iteration_id, provider_index}];
+  // Asking for another split means the task is done with its previous one.
+  in_flight.erase(request->task_id());
   SplitProvider* split_provider =
       split_providers_[iteration_id][provider_index].get();
   DCHECK(split_provider != nullptr);
   Tensor split;
   bool end_of_splits = false;
   TF_RETURN_IF_ERROR(split_provider->GetNext(&split, &end_of_splits));
+  if (end_of_splits && reassignment_enabled &&
+      ReassignStragglerSplit(iteration_id, provider_index, request->task_id(),
+                             split)) {
+    // The repetition stays open until the reassigned split is done.
+    split.AsProtoTensorContent(response->mutable_split());
+    VLOG(3) << "Returning from GetSplit with a reassigned split";
+    return OkStatus();
+  }
   TF_RETURN_IF_ERROR(RecordSplitProduced(iteration_id, repetition,
                                          request->split_provider_index(),
                                          end_of_splits));
@@ -444,13 +501,51 @@ Status DataServiceDispatcherImpl::GetSplit(const GetSplitRequest* request,
   if (end_of_splits) {
     // Reset the split provider to prepare for the next iteration.
     TF_RETURN_IF_ERROR(split_providers_[iteration_id][provider_index]->Reset());
+    in_flight.clear();
   } else {
     split.AsProtoTensorContent(response->mutable_split());
+    if (reassignment_enabled) {
+      in_flight[request->task_id()] = {split, env_->NowMicros(),
+                                       /*reassigned=*/false};
+    }
   }
   VLOG(3) << "Returning from GetSplit, end_of_splits=" << end_of_splits;
   return OkStatus();
 }
 
+bool DataServiceDispatcherImpl::ReassignStragglerSplit(
+    int64_t iteration_id, int64_t split_provider_index, int64_t task_id,
+    Tensor& split) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  auto& in_flight = in_flight_splits_[{iteration_id, split_provider_index}];
+  const int64_t now_micros = env_->NowMicros();
+  const int64_t timeout_micros =
+      config_.split_reassignment_timeout_ms() * EnvTime::kMillisToMicros;
+  // Pick the split that has been in flight the longest.
+  auto oldest = in_flight.end();
+  for (auto it = in_flight.begin(); it != in_flight.end(); ++it) {
+    if (it->first == task_id || it->second.reassigned ||
+        now_micros - it->second.assigned_time_micros < timeout_micros) {
+      continue;
+    }
+    if (oldest == in_flight.end() || it->second.assigned_time_micros <
+                                         oldest->second.assigned_time_micros) {
+      oldest = it;
+    }
+  }
+  if (oldest == in_flight.end()) {
+    return false;
+  }
+  VLOG(1) << "Reassigning split of task " << oldest->first << " for iteration "
+          << iteration_id << " to task " << task_id << " after "
+          << (now_micros - oldest->second.assigned_time_micros) /
+                 EnvTime::kMillisToMicros
+          << "ms";
+  oldest->second.reassigned = true;
+  split = oldest->second.split;
+  in_flight[task_id] = {split, now_micros, /*reassigned=*/true};
+  return true;
+}
+
 Status DataServiceDispatcherImpl::MakeSplitProviders(
     const std::string& dataset_id,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers)
@@ -1003,6 +1098,8 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     response->set_block_round(iteration->pending_tasks.front().target_round);
   }
 
+  const std::vector<std::string> client_tags(request->client_tags().begin(),
+                                             request->client_tags().end());
   std::vector<std::shared_ptr<const Task>> tasks;
   TF_RETURN_IF_ERROR(state_.TasksForIteration(iteration->iteration_id, tasks));
   for (const auto& task : tasks) {
@@ -1015,6 +1112,8 @@ Status DataServiceDispatcherImpl::ClientHeartbeat(
     task_info->set_iteration_id(iteration->iteration_id);
     task_info->set_worker_uid(task->worker_uid);
     task_info->set_starting_round(task->starting_round);
+    task_info->set_locality(
+        GetWorkerLocality(task->worker_tags, client_tags));
   }
   response->set_iteration_finished(iteration->finished);
   response->set_deployment_mode(config_.deployment_mode());
@@ -1081,7 +1180,7 @@ Status DataServiceDispatcherImpl::PopulateTaskDef(
 }
 
 Status DataServiceDispatcherImpl::CheckStarted() TF_LOCKS_EXCLUDED(mu_) {
-  mutex_lock l(mu_);
+  tf_shared_lock l(mu_);
   if (!started_) {
     return errors::Unavailable("Dispatcher has not started yet.");
   }
@@ -1108,38 +1207,93 @@ Status DataServiceDispatcherImpl::ApplyWithoutJournaling(const Update& update)
 Status DataServiceDispatcherImpl::Apply(const Update& update)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   if (journal_writer_.has_value()) {
-    TF_RETURN_IF_ERROR(journal_writer_.value()->Write(update));
+    mutex_lock l(journal_mu_);
+    TF_RETURN_IF_ERROR(journal_status_);
+    journal_queue_.push_back(update);
+    ++num_journal_updates_queued_;
   }
   return state_.Apply(update);
 }
 
-void DataServiceDispatcherImpl::IterationGcThread() {
-  int64_t next_check_micros = 0;
-  while (true) {
-    mutex_lock l(mu_);
-    while (!cancelled_ && env_->NowMicros() < next_check_micros) {
-      int64_t remaining_micros = next_check_micros - env_->NowMicros();
-      iteration_gc_thread_cv_.wait_for(
-          l, std::chrono::microseconds(remaining_micros));
-    }
-    if (cancelled_) {
-      return;
+Status DataServiceDispatcherImpl::SyncJournal()
+    TF_LOCKS_EXCLUDED(mu_, journal_mu_) {
+  JournalWriter* journal_writer = nullptr;
+  {
+    tf_shared_lock l(mu_);
+    if (!journal_writer_.has_value()) {
+      return OkStatus();
     }
+    journal_writer = journal_writer_->get();
+  }
+  int64_t target = 0;
+  {
+    mutex_lock l(journal_mu_);
+    target = num_journal_updates_queued_;
+  }
+  while (true) {
+    std::vector<Update> updates;
+    int64_t num_queued = 0;
     {
-      Status s = ReleaseMissingClients();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+      mutex_lock l(journal_mu_);
+      while (syncing_journal_ && journal_status_.ok() &&
+             num_journal_updates_synced_ < target) {
+        journal_cv_.wait(l);
       }
+      TF_RETURN_IF_ERROR(journal_status_);
+      if (num_journal_updates_synced_ >= target) {
+        return OkStatus();
+      }
+      // Becomes the thread syncing the journal, for all the updates queued so
+      // far, including those of the threads waiting above.
+      syncing_journal_ = true;
+      updates.swap(journal_queue_);
+      num_queued = num_journal_updates_queued_;
     }
+    Status s = journal_writer->WriteBatch(updates);
+    mutex_lock l(journal_mu_);
+    syncing_journal_ = false;
+    if (s.ok()) {
+      num_journal_updates_synced_ = num_queued;
+    } else {
+      journal_status_ = s;
+    }
+    journal_cv_.notify_all();
+  }
+}
 
+void DataServiceDispatcherImpl::IterationGcThread() {
+  int64_t next_check_micros = 0;
+  while (true) {
     {
-      Status s = GcOldIterations();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_check_micros) {
+        int64_t remaining_micros = next_check_micros - env_->NowMicros();
+        iteration_gc_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
+      }
+      if (cancelled_) {
+        return;
       }
+      {
+        Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
+      }
+
+      {
+        Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
+      }
+      next_check_micros =
+          env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
+    }
+    Status s = SyncJournal();
+    if (!s.ok()) {
+      LOG(WARNING) << "Error syncing the dispatcher journal: " << s;
     }
-    next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
 }
 
@@ -143,6 +143,12 @@ class DataServiceDispatcherImpl {
   // Returns the number of active iterations.
   size_t NumActiveIterations() TF_LOCKS_EXCLUDED(mu_);
 
+  // Blocks until all state updates applied so far are durable in the journal.
+  // Updates are journaled in batches: RPC handlers call this before
+  // responding, so that a response never reflects state that could be lost,
+  // and concurrent handlers share a single sync (group commit).
+  Status SyncJournal() TF_LOCKS_EXCLUDED(mu_, journal_mu_);
+
   // See dispatcher.proto for API documentation.
 
   /// Worker-facing API.
@@ -232,6 +238,13 @@ class DataServiceDispatcherImpl {
       const std::vector<std::shared_ptr<const DispatcherState::Task>>
           assigned_tasks,
       WorkerHeartbeatResponse* response);
+  // Handles a heartbeat from a registered worker whose tasks are up to date,
+  // which only reads the state and may hold `mu_` in shared mode. Returns false
+  // if the heartbeat needs to change the state, or to send new tasks.
+  StatusOr<bool> HandleSteadyStateHeartbeat(
+      const std::string& worker_address,
+      const absl::flat_hash_set<int64_t>& current_tasks,
+      WorkerHeartbeatResponse* response) TF_SHARED_LOCKS_REQUIRED(mu_);
   // Finds new tasks that should be assigned to a worker and adds them to
   // the heartbeat response.
   Status FindNewTasks(
@@ -293,7 +306,14 @@ class DataServiceDispatcherImpl {
   Status RecordSplitProduced(int64_t iteration_id, int64_t repetition,
                              int64_t split_provider_index, bool finished)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
-  // Applies a state update, updating both the journal and the in-memory state.
+  // Looks for a split which another task has held for longer than
+  // `split_reassignment_timeout_ms` and hands it to `task_id`. Returns true
+  // and stores the split in `split` if one was found.
+  bool ReassignStragglerSplit(int64_t iteration_id,
+                              int64_t split_provider_index, int64_t task_id,
+                              Tensor& split) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Applies a state update to the in-memory state, and queues it to be written
+  // to the journal by `SyncJournal`.
   Status Apply(const Update& update) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Applies a state update, but doesn't update the journal. Only meant to be
   // used when recovering state when the dispatcher starts.
@@ -331,6 +351,20 @@ class DataServiceDispatcherImpl {
   // Mapping from iteration id to the split providers for the iteration.
   absl::flat_hash_map<int64_t, std::vector<std::unique_ptr<SplitProvider>>>
       split_providers_ TF_GUARDED_BY(mu_);
+  // A split handed to a task that the task has not finished yet.
+  struct InFlightSplit {
+    Tensor split;
+    int64_t assigned_time_micros;
+    // Whether the split was handed out again after its original task fell
+    // behind. Reassigned splits are not reassigned a second time.
+    bool reassigned;
+  };
+  // Mapping from (iteration id, split provider index) to the splits in flight
+  // for the current repetition, keyed by task id. Only tracked when split
+  // reassignment is enabled.
+  absl::flat_hash_map<std::pair<int64_t, int64_t>,
+                      absl::flat_hash_map<int64_t, InFlightSplit>>
+      in_flight_splits_ TF_GUARDED_BY(mu_);
   // Mapping from round robin iteration id to the round the iteration is
   // currently on. This is based on the data provided by client heartbeats, and
   // may be stale.
@@ -342,8 +376,21 @@ class DataServiceDispatcherImpl {
   absl::flat_hash_map<int64_t, absl::Time> latest_client_heartbeats_time_
       TF_GUARDED_BY(mu_);
 
+  // Set in `Start`. Afterwards, only used by the thread syncing the journal.
   std::optional<std::unique_ptr<JournalWriter>> journal_writer_
       TF_GUARDED_BY(mu_);
+  // Group commit of journal updates. `Apply` queues updates in order, and
+  // `SyncJournal` writes everything queued with a single sync, one thread at a
+  // time. Updates are counted since the dispatcher started.
+  mutex journal_mu_ TF_ACQUIRED_AFTER(mu_);
+  condition_variable journal_cv_;
+  std::vector<Update> journal_queue_ TF_GUARDED_BY(journal_mu_);
+  int64_t num_journal_updates_queued_ TF_GUARDED_BY(journal_mu_) = 0;
+  int64_t num_journal_updates_synced_ TF_GUARDED_BY(journal_mu_) = 0;
+  bool syncing_journal_ TF_GUARDED_BY(journal_mu_) = false;
+  // Set if a journal write failed. Further updates are rejected, since the
+  // journal could no longer be replayed.
+  Status journal_status_ TF_GUARDED_BY(journal_mu_);
   DispatcherState state_ TF_GUARDED_BY(mu_);
   // Condition variable for waking up the iteration gc thread.
   condition_variable iteration_gc_thread_cv_;
@@ -47,7 +47,11 @@ DispatcherStateExport GrpcDispatcherImpl::ExportState() const {
   grpc::Status GrpcDispatcherImpl::method(ServerContext* context,         \
                                           const method##Request* request, \
                                           method##Response* response) {   \
-    return ToGrpcStatus(impl_.method(request, response));                 \
+    Status s = impl_.method(request, response);                           \
+    /* Acknowledges the request only after its updates are journaled. */  \
+    Status sync_status = impl_.SyncJournal();                             \
+    if (s.ok()) s = sync_status;                                          \
+    return ToGrpcStatus(s);                                               \
   }
 HANDLER(WorkerHeartbeat);
 HANDLER(WorkerUpdate);
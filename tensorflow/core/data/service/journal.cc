@@ -76,15 +76,27 @@ Status FileJournalWriter::EnsureInitialized() {
 }
 
 Status FileJournalWriter::Write(const Update& update) {
+  return WriteBatch({update});
+}
+
+Status FileJournalWriter::WriteBatch(const std::vector<Update>& updates) {
   TF_RETURN_IF_ERROR(EnsureInitialized());
+  for (const Update& update : updates) {
+    TF_RETURN_IF_ERROR(Append(update));
+  }
+  TF_RETURN_IF_ERROR(writer_->Flush());
+  TF_RETURN_IF_ERROR(file_->Sync());
+  VLOG(4) << "Synced " << updates.size() << " journal entries.";
+  return OkStatus();
+}
+
+Status FileJournalWriter::Append(const Update& update) {
   std::string s = update.SerializeAsString();
   if (s.empty()) {
     return errors::Internal("Failed to serialize update ", update.DebugString(),
                             " to string");
   }
   TF_RETURN_IF_ERROR(writer_->WriteRecord(s));
-  TF_RETURN_IF_ERROR(writer_->Flush());
-  TF_RETURN_IF_ERROR(file_->Sync());
   if (VLOG_IS_ON(4)) {
     VLOG(4) << "Wrote journal entry: " << update.DebugString();
   }
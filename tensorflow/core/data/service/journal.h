@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/data/service/journal.pb.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -37,6 +38,8 @@ class JournalWriter {
   virtual ~JournalWriter() = default;
   // Writes and syncs an update to the journal.
   virtual Status Write(const Update& update) = 0;
+  // Writes `updates` to the journal, in order, and syncs them once.
+  virtual Status WriteBatch(const std::vector<Update>& updates) = 0;
   // Initializes the writer if it is not yet initialized.
   virtual Status EnsureInitialized() = 0;
 };
@@ -67,9 +70,13 @@ class FileJournalWriter : public JournalWriter {
   FileJournalWriter& operator=(const FileJournalWriter&) = delete;
 
   Status Write(const Update& update) override;
+  Status WriteBatch(const std::vector<Update>& updates) override;
   Status EnsureInitialized() override;
 
  private:
+  // Appends `update` to the file without syncing it.
+  Status Append(const Update& update);
+
   Env* env_;
   const std::string journal_dir_;
   std::unique_ptr<WritableFile> file_;
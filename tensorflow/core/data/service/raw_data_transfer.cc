@@ -0,0 +1,455 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/raw_data_transfer.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // __linux__
+
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/support/channel_arguments.h"
+#include "grpcpp/support/status.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+// Shared memory segments that the client has not claimed within this time are
+// assumed to be abandoned and are unlinked by the worker.
+constexpr int64_t kUnclaimedSegmentTimeoutMicros = 60 * 1000 * 1000;
+
+size_t AlignedSize(size_t size) {
+  return (size + Allocator::kAllocatorAlignment - 1) /
+         Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+}
+
+#if defined(__linux__)
+// Tracks the shared memory segments created by this process so that segments
+// abandoned by their clients are eventually removed.
+class SharedMemorySegments {
+ public:
+  static SharedMemorySegments& Get() {
+    static auto* segments = new SharedMemorySegments();
+    return *segments;
+  }
+
+  // Returns a fresh segment name and unlinks expired segments.
+  std::string NewSegment() TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    const int64_t now = Env::Default()->NowMicros();
+    while (!segments_.empty() && segments_.front().second <= now) {
+      // Fails with ENOENT if the client already unlinked the segment.
+      shm_unlink(segments_.front().first.c_str());
+      segments_.pop_front();
+    }
+    std::string name = absl::StrCat("/tf_data_", getpid(), "_", next_id_++);
+    segments_.emplace_back(name, now + kUnclaimedSegmentTimeoutMicros);
+    return name;
+  }
+
+ private:
+  mutex mu_;
+  int64_t next_id_ TF_GUARDED_BY(mu_) = 0;
+  // Segment names and the times after which they may be unlinked, in creation
+  // order.
+  std::deque<std::pair<std::string, int64_t>> segments_ TF_GUARDED_BY(mu_);
+};
+
+// A read-write private mapping of a shared memory segment. Writes by the
+// client stay local to the client.
+class SharedMemoryMapping : public core::RefCounted {
+ public:
+  SharedMemoryMapping(void* base, size_t size) : base_(base), size_(size) {}
+  ~SharedMemoryMapping() override { munmap(base_, size_); }
+
+  char* base() const { return static_cast<char*>(base_); }
+
+ private:
+  void* const base_;
+  const size_t size_;
+};
+
+// Tensor buffer referencing a region of a shared memory mapping.
+class SharedMemoryTensorBuffer : public TensorBuffer {
+ public:
+  SharedMemoryTensorBuffer(SharedMemoryMapping* mapping, size_t offset,
+                           size_t size)
+      : TensorBuffer(mapping->base() + offset), mapping_(mapping), size_(size) {
+    mapping_->Ref();
+  }
+  ~SharedMemoryTensorBuffer() override { mapping_->Unref(); }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("tf_data_shared_memory");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  SharedMemoryMapping* const mapping_;
+  const size_t size_;
+};
+
+Status WriteSharedMemorySegment(const std::vector<Tensor>& components,
+                                const RawElement& element, size_t total_size,
+                                std::string& name) {
+  name = SharedMemorySegments::Get().NewSegment();
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    return errors::Unavailable("Failed to create shared memory segment ", name,
+                               ": ", strerror(errno));
+  }
+  auto close_fd = gtl::MakeCleanup([fd] { close(fd); });
+  if (ftruncate(fd, total_size) != 0) {
+    shm_unlink(name.c_str());
+    return errors::ResourceExhausted("Failed to resize shared memory segment ",
+                                     name, " to ", total_size,
+                                     " bytes: ", strerror(errno));
+  }
+  void* base =
+      mmap(nullptr, total_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (base == MAP_FAILED) {
+    shm_unlink(name.c_str());
+    return errors::Unavailable("Failed to map shared memory segment ", name,
+                               ": ", strerror(errno));
+  }
+  for (int i = 0; i < components.size(); ++i) {
+    const RawElement::Component& component = element.components(i);
+    if (component.has_tensor()) continue;
+    StringPiece data = components[i].tensor_data();
+    std::memcpy(static_cast<char*>(base) + component.offset(), data.data(),
+                data.size());
+  }
+  munmap(base, total_size);
+  return OkStatus();
+}
+
+Status MapSharedMemorySegment(const std::string& name,
+                              core::RefCountPtr<SharedMemoryMapping>& mapping) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return errors::NotFound("Failed to open shared memory segment ", name,
+                            ": ", strerror(errno),
+                            ". Is the worker on the same host?");
+  }
+  auto close_fd = gtl::MakeCleanup([fd] { close(fd); });
+  // The mapping keeps the memory alive after the name is removed.
+  shm_unlink(name.c_str());
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    return errors::Internal("Failed to stat shared memory segment ", name,
+                            ": ", strerror(errno));
+  }
+  void* base = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                    fd, 0);
+  if (base == MAP_FAILED) {
+    return errors::Internal("Failed to map shared memory segment ", name, ": ",
+                            strerror(errno));
+  }
+  mapping.reset(new SharedMemoryMapping(base, st.st_size));
+  return OkStatus();
+}
+#endif  // __linux__
+
+class RawTransferServiceImpl : public RawTransferService::Service {
+ public:
+  explicit RawTransferServiceImpl(DataTransferServer::GetElementT get_element)
+      : get_element_(std::move(get_element)) {}
+
+  ::grpc::Status GetElement(::grpc::ServerContext* ctx,
+                            const GetRawElementRequest* request,
+                            RawElement* response) override {
+    GetElementResult result;
+    Status s = get_element_(&request->request(), &result);
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    response->set_element_index(result.element_index);
+    response->set_end_of_sequence(result.end_of_sequence);
+    response->set_skip_task(result.skip);
+    s = EncodeRawElement(result.components, request->use_shared_memory(),
+                         *response);
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to encode element", s);
+    }
+    return ::grpc::Status::OK;
+  }
+
+ private:
+  const DataTransferServer::GetElementT get_element_;
+};
+
+// Transfer server for the "grpc_raw" and "shm" protocols. Both protocols are
+// served by the same server; the client chooses per request whether to use
+// shared memory.
+class RawDataTransferServer : public DataTransferServer {
+ public:
+  explicit RawDataTransferServer(GetElementT get_element)
+      : service_(std::move(get_element)) {}
+
+  Status Start() override {
+    ::grpc::ServerBuilder builder;
+    builder.AddListeningPort("0.0.0.0:0", ::grpc::InsecureServerCredentials(),
+                             &port_);
+    builder.SetMaxReceiveMessageSize(-1);
+    builder.SetMaxSendMessageSize(-1);
+    builder.RegisterService(&service_);
+    server_ = builder.BuildAndStart();
+    if (!server_) {
+      return errors::Internal("Could not start raw data transfer server");
+    }
+    return OkStatus();
+  }
+
+  int get_port() override { return port_; }
+
+ private:
+  RawTransferServiceImpl service_;
+  int port_ = 0;
+  std::unique_ptr<::grpc::Server> server_;
+};
+
+class RawDataTransferClient : public DataTransferClient {
+ public:
+  RawDataTransferClient(const std::string& address, bool use_shared_memory)
+      : use_shared_memory_(use_shared_memory) {
+    VLOG(2) << "Create RawDataTransferClient for worker " << address
+            << (use_shared_memory ? " using shared memory." : ".");
+    ::grpc::ChannelArguments args;
+    args.SetMaxReceiveMessageSize(-1);
+    auto channel = ::grpc::CreateCustomChannel(
+        address, ::grpc::InsecureChannelCredentials(), args);
+    stub_ = RawTransferService::NewStub(channel);
+  }
+
+  Status GetElement(const GetElementRequest& req,
+                    GetElementResult& result) override {
+    ::grpc::ClientContext ctx;
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      active_contexts_.insert(&ctx);
+    }
+    auto cleanup = gtl::MakeCleanup([this, &ctx] {
+      mutex_lock l(mu_);
+      active_contexts_.erase(&ctx);
+    });
+    GetRawElementRequest raw_req;
+    *raw_req.mutable_request() = req;
+    raw_req.set_use_shared_memory(use_shared_memory_);
+    RawElement resp;
+    ::grpc::Status s = stub_->GetElement(&ctx, raw_req, &resp);
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    result.element_index = resp.element_index();
+    result.end_of_sequence = resp.end_of_sequence();
+    result.skip = resp.skip_task();
+    return DecodeRawElement(resp, result.components);
+  }
+
+  void TryCancel() override {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+ private:
+  const bool use_shared_memory_;
+  std::unique_ptr<RawTransferService::Stub> stub_;
+
+  mutex mu_;
+  absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
+      TF_GUARDED_BY(mu_);
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+class RawTransferRegistrar {
+ public:
+  RawTransferRegistrar() {
+    for (const char* protocol :
+         {kRawGrpcTransferProtocol, kSharedMemoryTransferProtocol}) {
+      DataTransferServer::Register(protocol, [](auto get_element) {
+        return std::make_shared<RawDataTransferServer>(get_element);
+      });
+    }
+    DataTransferClient::Register(
+        kRawGrpcTransferProtocol, [](DataTransferClient::Config config,
+                                     std::unique_ptr<DataTransferClient>* out) {
+          *out = std::make_unique<RawDataTransferClient>(
+              config.address, /*use_shared_memory=*/false);
+          return OkStatus();
+        });
+    DataTransferClient::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferClient::Config config,
+           std::unique_ptr<DataTransferClient>* out) {
+#if defined(__linux__)
+          const bool use_shared_memory = IsLocalAddress(config.address);
+#else
+          const bool use_shared_memory = false;
+#endif  // __linux__
+          *out = std::make_unique<RawDataTransferClient>(config.address,
+                                                         use_shared_memory);
+          return OkStatus();
+        });
+  }
+};
+static RawTransferRegistrar raw_transfer_registrar;
+
+}  // namespace
+
+bool IsLocalAddress(absl::string_view address) {
+  absl::string_view host = address.substr(0, address.rfind(':'));
+  if (absl::StartsWith(host, "[") && absl::EndsWith(host, "]")) {
+    host = host.substr(1, host.size() - 2);
+  }
+  return host == "localhost" || host == "127.0.0.1" || host == "::1" ||
+         host == port::Hostname();
+}
+
+Status EncodeRawElement(const std::vector<Tensor>& components,
+                        bool use_shared_memory, RawElement& element) {
+  size_t total_size = 0;
+  for (const Tensor& tensor : components) {
+    RawElement::Component* component = element.add_components();
+    component->set_dtype(tensor.dtype());
+    tensor.shape().AsProto(component->mutable_shape());
+    if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+      tensor.AsProtoTensorContent(component->mutable_tensor());
+      continue;
+    }
+    // Align every component so that shared memory tensors can be used
+    // in place.
+    component->set_offset(total_size);
+    component->set_size(tensor.TotalBytes());
+    total_size += AlignedSize(tensor.TotalBytes());
+  }
+  if (total_size == 0) {
+    return OkStatus();
+  }
+  if (use_shared_memory) {
+#if defined(__linux__)
+    std::string name;
+    TF_RETURN_IF_ERROR(
+        WriteSharedMemorySegment(components, element, total_size, name));
+    element.set_shared_memory_name(name);
+    return OkStatus();
+#else
+    return errors::Unimplemented(
+        "Shared memory transfer is only supported on Linux.");
+#endif  // __linux__
+  }
+  std::string* payload = element.mutable_payload();
+  payload->resize(total_size);
+  for (int i = 0; i < components.size(); ++i) {
+    const RawElement::Component& component = element.components(i);
+    if (component.has_tensor()) continue;
+    StringPiece data = components[i].tensor_data();
+    std::memcpy(&(*payload)[component.offset()], data.data(), data.size());
+  }
+  return OkStatus();
+}
+
+Status DecodeRawElement(const RawElement& element,
+                        std::vector<Tensor>& components) {
+#if defined(__linux__)
+  core::RefCountPtr<SharedMemoryMapping> mapping;
+  if (element.data_case() == RawElement::kSharedMemoryName) {
+    TF_RETURN_IF_ERROR(
+        MapSharedMemorySegment(element.shared_memory_name(), mapping));
+  }
+#endif  // __linux__
+  components.reserve(element.components_size());
+  for (const RawElement::Component& component : element.components()) {
+    if (component.has_tensor()) {
+      components.emplace_back();
+      if (!components.back().FromProto(component.tensor())) {
+        return errors::Internal("Failed to parse tensor.");
+      }
+      continue;
+    }
+    TensorShape shape;
+    TF_RETURN_IF_ERROR(TensorShape::BuildTensorShape(component.shape(), &shape));
+    if (component.size() == 0) {
+      components.emplace_back(component.dtype(), shape);
+      continue;
+    }
+#if defined(__linux__)
+    if (mapping) {
+      auto* buffer = new SharedMemoryTensorBuffer(
+          mapping.get(), component.offset(), component.size());
+      components.emplace_back(component.dtype(), shape, buffer);
+      buffer->Unref();
+      continue;
+    }
+#endif  // __linux__
+    if (element.data_case() != RawElement::kPayload ||
+        component.offset() + component.size() > element.payload().size()) {
+      return errors::Internal("Raw element is missing tensor bytes.");
+    }
+    components.emplace_back(component.dtype(), shape);
+    std::memcpy(const_cast<char*>(components.back().tensor_data().data()),
+                element.payload().data() + component.offset(),
+                component.size());
+  }
+  return OkStatus();
+}
+
+}  // namespace data
+}  // namespace tensorflow
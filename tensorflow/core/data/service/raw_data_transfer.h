@@ -0,0 +1,58 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_RAW_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_RAW_DATA_TRANSFER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocols served by the worker's `RawTransferService`.
+//
+// "grpc_raw" sends the bytes of all components of an element in a single
+// payload, skipping per-tensor proto encoding on both ends.
+//
+// "shm" places the bytes in a POSIX shared memory segment that the client maps
+// and wraps in tensors without copying. Clients on other hosts fall back to
+// "grpc_raw". Shared memory is only available on Linux.
+constexpr const char kRawGrpcTransferProtocol[] = "grpc_raw";
+constexpr const char kSharedMemoryTransferProtocol[] = "shm";
+
+// Returns whether `address` ("host:port") refers to the local host.
+bool IsLocalAddress(absl::string_view address);
+
+// Lays out `components` in `element`. The raw bytes of the components are
+// written to a new shared memory segment if `use_shared_memory` is true, or to
+// `element.payload` otherwise. Exposed for testing.
+Status EncodeRawElement(const std::vector<Tensor>& components,
+                        bool use_shared_memory, RawElement& element);
+
+// Inverse of `EncodeRawElement`. Tensors decoded from a shared memory segment
+// reference the mapped segment, which is unmapped once they are all destroyed.
+Status DecodeRawElement(const RawElement& element,
+                        std::vector<Tensor>& components);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_RAW_DATA_TRANSFER_H_
@@ -0,0 +1,95 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/raw_data_transfer.h"
+
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+std::vector<Tensor> TestComponents() {
+  return {test::AsTensor<int64_t>({1, 2, 3}, TensorShape({3})),
+          test::AsTensor<tstring>({"a", "bc"}, TensorShape({2})),
+          Tensor(DT_FLOAT, TensorShape({0, 4})),
+          test::AsTensor<float>({1.5, 2.5, 3.5, 4.5}, TensorShape({2, 2}))};
+}
+
+void ExpectRoundTrip(bool use_shared_memory) {
+  std::vector<Tensor> components = TestComponents();
+  RawElement element;
+  TF_ASSERT_OK(EncodeRawElement(components, use_shared_memory, element));
+  EXPECT_EQ(element.data_case() == RawElement::kSharedMemoryName,
+            use_shared_memory);
+  std::vector<Tensor> decoded;
+  TF_ASSERT_OK(DecodeRawElement(element, decoded));
+  ASSERT_EQ(decoded.size(), components.size());
+  test::ExpectEqual(decoded[0], components[0]);
+  test::ExpectEqual(decoded[1], components[1]);
+  EXPECT_EQ(decoded[2].shape(), components[2].shape());
+  test::ExpectEqual(decoded[3], components[3]);
+}
+
+TEST(RawDataTransferTest, PayloadRoundTrip) {
+  ExpectRoundTrip(/*use_shared_memory=*/false);
+}
+
+#if defined(__linux__)
+TEST(RawDataTransferTest, SharedMemoryRoundTrip) {
+  ExpectRoundTrip(/*use_shared_memory=*/true);
+}
+
+TEST(RawDataTransferTest, SharedMemorySegmentIsUnlinkedAfterDecoding) {
+  RawElement element;
+  TF_ASSERT_OK(EncodeRawElement(TestComponents(), /*use_shared_memory=*/true,
+                                element));
+  std::vector<Tensor> decoded;
+  TF_ASSERT_OK(DecodeRawElement(element, decoded));
+  std::vector<Tensor> decoded_again;
+  EXPECT_FALSE(DecodeRawElement(element, decoded_again).ok());
+}
+#endif  // __linux__
+
+TEST(RawDataTransferTest, PayloadAlignsComponents) {
+  RawElement element;
+  TF_ASSERT_OK(EncodeRawElement(TestComponents(), /*use_shared_memory=*/false,
+                                element));
+  for (const RawElement::Component& component : element.components()) {
+    EXPECT_EQ(component.offset() % Allocator::kAllocatorAlignment, 0);
+  }
+  EXPECT_TRUE(element.components(1).has_tensor());
+}
+
+TEST(RawDataTransferTest, IsLocalAddress) {
+  EXPECT_TRUE(IsLocalAddress("localhost:1234"));
+  EXPECT_TRUE(IsLocalAddress("127.0.0.1:1234"));
+  EXPECT_TRUE(IsLocalAddress("[::1]:1234"));
+  EXPECT_TRUE(IsLocalAddress(absl::StrCat(port::Hostname(), ":1234")));
+  EXPECT_FALSE(IsLocalAddress("some.other.host.invalid:1234"));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -34,11 +34,13 @@ class DataServiceSplitProvider : public SplitProvider {
  public:
   DataServiceSplitProvider(const std::string& address,
                            const std::string& protocol, int64_t iteration_id,
-                           int64_t split_provider_index, int64_t timeout_ms)
+                           int64_t split_provider_index, int64_t task_id,
+                           int64_t timeout_ms)
       : address_(address),
         protocol_(protocol),
         iteration_id_(iteration_id),
         split_provider_index_(split_provider_index),
+        task_id_(task_id),
         timeout_ms_(timeout_ms) {}
 
   Status GetNext(Tensor* split, bool* end_of_splits) override;
@@ -53,6 +55,7 @@ class DataServiceSplitProvider : public SplitProvider {
   const std::string protocol_;
   const int64_t iteration_id_;
   const int64_t split_provider_index_;
+  const int64_t task_id_;
   const int64_t timeout_ms_;
 
   mutex mu_;
@@ -16,12 +16,15 @@ limitations under the License.
 
 #include <algorithm>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
 #include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/disk_spill_store.h"
 #include "tensorflow/core/data/service/logging_utils.h"
 #include "tensorflow/core/data/service/thread_safe_buffer.h"
 #include "tensorflow/core/data/service/worker.pb.h"
@@ -30,9 +33,11 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -45,6 +50,8 @@ namespace {
 constexpr int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 constexpr size_t kDefaultCrossTrainerCacheSizeBytes =
     10 * (size_t{1} << 30);  // 10GB
+constexpr size_t kDefaultCrossTrainerCacheSpillSizeBytes =
+    100 * (size_t{1} << 30);  // 100GB
 
 }  // namespace
 
@@ -84,8 +91,24 @@ Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    if (worker_config.cross_trainer_cache_spill_directory().empty()) {
+      out = std::make_unique<CachingTaskRunner>(std::move(iterator),
+                                                max_cache_size_bytes);
+      return OkStatus();
+    }
+    const size_t max_spill_size_bytes =
+        worker_config.cross_trainer_cache_spill_size_bytes() > 0
+            ? worker_config.cross_trainer_cache_spill_size_bytes()
+            : kDefaultCrossTrainerCacheSpillSizeBytes;
+    // Several workers may share the spill directory of a host.
+    const std::string spill_directory = io::JoinPath(
+        worker_config.cross_trainer_cache_spill_directory(),
+        absl::StrCat("task_", task_def.task_id(), "_", random::New64()));
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<DiskSpillStore> spill_store,
+                        DiskSpillStore::Create(Env::Default(), spill_directory));
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, std::move(spill_store),
+        max_spill_size_bytes);
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -162,6 +185,19 @@ CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
             << FormatBytes(max_cache_size_bytes) << " of memory.";
 }
 
+CachingTaskRunner::CachingTaskRunner(
+    std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+    std::unique_ptr<CacheSpillStore<GetElementResult>> spill_store,
+    size_t max_spill_size_bytes)
+    : fcfs_task_runner_(std::move(iterator)),
+      cache_(max_cache_size_bytes,
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             std::move(spill_store), max_spill_size_bytes) {
+  LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
+            << FormatBytes(max_cache_size_bytes) << " of memory and "
+            << FormatBytes(max_spill_size_bytes) << " of spill space.";
+}
+
 CachingTaskRunner::~CachingTaskRunner() { Cancel(); }
 
 Status CachingTaskRunner::GetNext(const GetElementRequest& req,
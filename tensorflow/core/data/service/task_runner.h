@@ -124,6 +124,13 @@ class CachingTaskRunner : public TaskRunner {
  public:
   explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
                              size_t max_cache_size_bytes);
+
+  // Creates a task runner whose cache moves the elements it evicts from memory
+  // to `spill_store`, keeping at most `max_spill_size_bytes` there.
+  CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      std::unique_ptr<CacheSpillStore<GetElementResult>> spill_store,
+      size_t max_spill_size_bytes);
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/worker_client.h"
 
+#include <algorithm>
 #include <functional>
 #include <memory>
 #include <string>
@@ -41,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
@@ -110,6 +112,7 @@ class GrpcDataTransferClient : public DataTransferClient {
     }
     grpc::ClientContext ctx;
     gtl::Cleanup<std::function<void()>> cleanup;
+    GetElementRequest request = req;
     {
       mutex_lock l(mu_);
       active_contexts_.insert(&ctx);
@@ -117,12 +120,24 @@ class GrpcDataTransferClient : public DataTransferClient {
         mutex_lock l(mu_);
         active_contexts_.erase(&ctx);
       });
+      request.set_previous_response_bytes(previous_response_bytes_);
+      request.set_previous_transfer_time_us(previous_transfer_time_us_);
     }
     GetElementResponse resp;
-    grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+    const uint64 start_us = Env::Default()->NowMicros();
+    grpc::Status s = stub_->GetElement(&ctx, request, &resp);
     if (!s.ok()) {
       return grpc_util::WrapError("Failed to get element", s);
     }
+    {
+      // Lets the worker measure the throughput of the link, to decide whether
+      // compressing elements pays off.
+      const int64_t latency_us = Env::Default()->NowMicros() - start_us;
+      mutex_lock l(mu_);
+      previous_response_bytes_ = resp.ByteSizeLong();
+      previous_transfer_time_us_ =
+          std::max<int64_t>(latency_us - resp.processing_time_us(), 0);
+    }
     result.end_of_sequence = resp.end_of_sequence();
     result.skip = resp.skip_task();
     switch (resp.element_case()) {
@@ -165,6 +180,10 @@ class GrpcDataTransferClient : public DataTransferClient {
   // Indicates that the client has been cancelled, so no further requests should
   // be accepted.
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // Size and transit time of the last response, reported with the next
+  // request.
+  int64_t previous_response_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64_t previous_transfer_time_us_ TF_GUARDED_BY(mu_) = 0;
 };
 
 class GrpcTransferClientRegistrar {
@@ -29,6 +29,7 @@ limitations under the License.
 #include "absl/time/time.h"
 #include "tensorflow/c/c_api_internal.h"
 #include "tensorflow/c/tf_status_helper.h"
+#include "tensorflow/core/data/adaptive_compression.h"
 #include "tensorflow/core/data/service/auto_shard_rewriter.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/common.pb.h"
@@ -166,6 +167,9 @@ Status DataServiceWorkerImpl::Start(const std::string& worker_address,
   TF_RETURN_IF_ERROR(ValidateWorkerConfig());
   worker_address_ = worker_address;
   transfer_address_ = transfer_address;
+  if (config_.adaptive_compression()) {
+    AdaptiveCompressionPolicy::Global().SetEnabled(true);
+  }
 
   dispatcher_ = std::make_unique<DataServiceDispatcherClient>(
       config_.dispatcher_address(), config_.protocol());
@@ -386,7 +390,8 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
       split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
           config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+          task_def.iteration_id(), i, task_def.task_id(),
+          config_.dispatcher_timeout_ms()));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -414,6 +419,12 @@ void DataServiceWorkerImpl::StopTask(Task& task) TF_LOCKS_EXCLUDED(mu_) {
 Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
                                          GetElementResponse* response) {
   VLOG(3) << "Received GetElement request for task " << request->task_id();
+  const uint64 start_us = Env::Default()->NowMicros();
+  if (config_.adaptive_compression()) {
+    AdaptiveCompressionPolicy::Global().RecordTransfer(
+        request->previous_response_bytes(),
+        request->previous_transfer_time_us());
+  }
   struct GetElementResult result;
   TF_RETURN_IF_ERROR(GetElementResult(request, &result));
   response->set_end_of_sequence(result.end_of_sequence);
@@ -423,6 +434,7 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
         MoveElementToResponse(std::move(result.components), *response));
     VLOG(3) << "Producing an element for task " << request->task_id();
   }
+  response->set_processing_time_us(Env::Default()->NowMicros() - start_us);
   return OkStatus();
 }
 
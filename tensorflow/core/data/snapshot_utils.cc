@@ -34,12 +34,14 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/snapshot.pb.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_inputbuffer.h"
@@ -116,6 +118,12 @@ Status Writer::Create(Env* env, const std::string& filename,
   return (*out_writer)->Initialize(env);
 }
 
+Status Writer::WriteTensors(const std::vector<Tensor>& tensors) {
+  std::vector<std::string> records;
+  TF_RETURN_IF_ERROR(EncodeTensors(tensors, &records));
+  return WriteRecords(records);
+}
+
 TFRecordWriter::TFRecordWriter(const std::string& filename,
                                const std::string& compression_type)
     : filename_(filename), compression_type_(compression_type) {}
@@ -129,23 +137,23 @@ Status TFRecordWriter::Initialize(tensorflow::Env* env) {
   return OkStatus();
 }
 
-Status TFRecordWriter::WriteTensors(const std::vector<Tensor>& tensors) {
+Status TFRecordWriter::EncodeTensors(const std::vector<Tensor>& tensors,
+                                     std::vector<std::string>* records) const {
+  // The records are compressed by `record_writer_`, which compresses the file
+  // as a stream.
+  records->clear();
+  records->reserve(tensors.size());
   for (const auto& tensor : tensors) {
     TensorProto proto;
     tensor.AsProtoTensorContent(&proto);
-#if defined(TF_CORD_SUPPORT)
-    // Creating raw pointer here because std::move() in a releases in OSS TF
-    // will result in a smart pointer being moved upon function creation, which
-    // will result in proto_buffer == nullptr when WriteRecord happens.
-    auto proto_buffer = new std::string();
-    proto.SerializeToString(proto_buffer);
-    absl::Cord proto_serialized = absl::MakeCordFromExternal(
-        *proto_buffer,
-        [proto_buffer](absl::string_view) { delete proto_buffer; });
-    TF_RETURN_IF_ERROR(record_writer_->WriteRecord(proto_serialized));
-#else   // TF_CORD_SUPPORT
-    TF_RETURN_IF_ERROR(record_writer_->WriteRecord(proto.SerializeAsString()));
-#endif  // TF_CORD_SUPPORT
+    records->push_back(proto.SerializeAsString());
+  }
+  return OkStatus();
+}
+
+Status TFRecordWriter::WriteRecords(const std::vector<std::string>& records) {
+  for (const auto& record : records) {
+    TF_RETURN_IF_ERROR(record_writer_->WriteRecord(record));
   }
   return OkStatus();
 }
@@ -214,23 +222,17 @@ Status CustomWriter::Initialize(tensorflow::Env* env) {
   return OkStatus();
 }
 
-Status CustomWriter::WriteTensors(const std::vector<Tensor>& tensors) {
+Status CustomWriter::EncodeTensors(const std::vector<Tensor>& tensors,
+                                   std::vector<std::string>* records) const {
+  records->clear();
   if (compression_type_ != io::compression::kSnappy) {
     experimental::SnapshotRecord record;
     for (const auto& tensor : tensors) {
       TensorProto* t = record.add_tensor();
       tensor.AsProtoTensorContent(t);
     }
-#if defined(TF_CORD_SUPPORT)
-    auto record_buffer = new std::string();
-    record.SerializeToString(record_buffer);
-    absl::Cord record_serialized = absl::MakeCordFromExternal(
-        *record_buffer,
-        [record_buffer](absl::string_view) { delete record_buffer; });
-    return WriteRecord(record_serialized);
-#else   // TF_CORD_SUPPORT
-    return WriteRecord(record.SerializeAsString());
-#endif  // TF_CORD_SUPPORT
+    records->push_back(record.SerializeAsString());
+    return OkStatus();
   }
 
   std::vector<const TensorBuffer*> tensor_buffers;
@@ -283,17 +285,15 @@ Status CustomWriter::WriteTensors(const std::vector<Tensor>& tensors) {
     return errors::Internal("Failed to compress using snappy.");
   }
 
-#if defined(TF_CORD_SUPPORT)
-  auto metadata_buffer = new std::string();
-  metadata.SerializeToString(metadata_buffer);
-  absl::Cord metadata_serialized = absl::MakeCordFromExternal(
-      *metadata_buffer,
-      [metadata_buffer](absl::string_view) { delete metadata_buffer; });
-#else
-  std::string metadata_serialized = metadata.SerializeAsString();
-#endif  // TF_CORD_SUPPORT
-  TF_RETURN_IF_ERROR(WriteRecord(metadata_serialized));
-  TF_RETURN_IF_ERROR(WriteRecord(output));
+  records->push_back(metadata.SerializeAsString());
+  records->push_back(std::move(output));
+  return OkStatus();
+}
+
+Status CustomWriter::WriteRecords(const std::vector<std::string>& records) {
+  for (const auto& record : records) {
+    TF_RETURN_IF_ERROR(WriteRecord(record));
+  }
   return OkStatus();
 }
 
@@ -325,15 +325,6 @@ Status CustomWriter::WriteRecord(const StringPiece& data) {
   return dest_->Append(data);
 }
 
-#if defined(TF_CORD_SUPPORT)
-Status CustomWriter::WriteRecord(const absl::Cord& data) {
-  char header[kHeaderSize];
-  core::EncodeFixed64(header, data.size());
-  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
-  return dest_->Append(data);
-}
-#endif  // TF_CORD_SUPPORT
-
 Status Reader::Create(Env* env, const std::string& filename,
                       const string& compression_type, int version,
                       const DataTypeVector& dtypes,
@@ -1037,58 +1028,133 @@ AsyncWriter::AsyncWriter(Env* env, int64_t file_index,
   thread_ = absl::WrapUnique(env->StartThread(
       ThreadOptions(), absl::StrCat("writer_thread_", file_index),
       [this, env, shard_directory, checkpoint_id, compression, version,
-       &output_types, done = std::move(done)] {
+       output_types, done = std::move(done)] {
         done(WriterThread(env, shard_directory, checkpoint_id, compression,
                           version, output_types));
       }));
 }
 
+AsyncWriter::~AsyncWriter() {
+  // Joins the writer thread, which returns once all elements are written or on
+  // the first error. In the latter case, encodes may still be in flight.
+  thread_.reset();
+  mutex_lock l(mu_);
+  mu_.Await(tensorflow::Condition(this, &AsyncWriter::NoEncodesInFlight));
+}
+
 void AsyncWriter::Write(const std::vector<Tensor>& tensors) {
   mutex_lock l(mu_);
-  ElementOrEOF element;
-  element.value = tensors;
-  deque_.push_back(std::move(element));
+  mu_.Await(tensorflow::Condition(this, &AsyncWriter::CanBufferElement));
+  if (!status_.ok()) {
+    return;
+  }
+  deque_.emplace_back(next_index_++, tensors);
+  MaybeScheduleEncodes();
 }
 
 void AsyncWriter::SignalEOF() {
   mutex_lock l(mu_);
-  ElementOrEOF be;
-  be.end_of_sequence = true;
-  deque_.push_back(std::move(be));
+  end_index_ = next_index_;
+}
+
+void AsyncWriter::MaybeScheduleEncodes() {
+  if (writer_ == nullptr) {
+    return;
+  }
+  // Encodes from all writers share one pool, sized for the available cores.
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "tf_data_snapshot_encode", port::MaxParallelism());
+  while (!deque_.empty()) {
+    auto element = std::make_shared<std::pair<int64_t, std::vector<Tensor>>>(
+        std::move(deque_.front()));
+    deque_.pop_front();
+    ++num_encodes_in_flight_;
+    pool->Schedule([this, writer = writer_.get(), element]() {
+      Encode(writer, element->first, std::move(element->second));
+    });
+  }
 }
 
-void AsyncWriter::Consume(ElementOrEOF* be) {
+void AsyncWriter::Encode(const Writer* writer, int64_t index,
+                         std::vector<Tensor> tensors) {
+  profiler::TraceMe activity("SnapshotEncode",
+                             profiler::TraceMeLevel::kVerbose);
+  Records records;
+  records.status = writer->EncodeTensors(tensors, &records.records);
   mutex_lock l(mu_);
-  mu_.Await(tensorflow::Condition(this, &AsyncWriter::ElementAvailable));
-  *be = deque_.front();
-  deque_.pop_front();
+  encoded_.emplace(index, std::move(records));
+  --num_encodes_in_flight_;
 }
 
-bool AsyncWriter::ElementAvailable() { return !deque_.empty(); }
+bool AsyncWriter::CanBufferElement() {
+  return !status_.ok() ||
+         deque_.size() + num_encodes_in_flight_ + encoded_.size() <
+             kMaxBufferedElements;
+}
+
+bool AsyncWriter::NextRecordsAvailable() {
+  return !status_.ok() || next_write_index_ == end_index_ ||
+         encoded_.contains(next_write_index_);
+}
+
+bool AsyncWriter::NoEncodesInFlight() { return num_encodes_in_flight_ == 0; }
 
 Status AsyncWriter::WriterThread(Env* env, const std::string& shard_directory,
                                  uint64 checkpoint_id,
                                  const std::string& compression,
                                  int64_t version, DataTypeVector output_types) {
-  std::unique_ptr<snapshot_util::Writer> writer;
-  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(shard_directory));
+  // Records the first error, which unblocks `Write()` and drops the buffered
+  // elements.
+  auto set_status = [this](const Status& status) {
+    mutex_lock l(mu_);
+    status_.Update(status);
+    deque_.clear();
+    return status;
+  };
 
-  TF_RETURN_IF_ERROR(snapshot_util::Writer::Create(
-      env, GetCheckpointFileName(shard_directory, checkpoint_id), compression,
-      version, std::move(output_types), &writer));
+  std::unique_ptr<snapshot_util::Writer> writer;
+  Status s = env->RecursivelyCreateDir(shard_directory);
+  if (s.ok()) {
+    s = snapshot_util::Writer::Create(
+        env, GetCheckpointFileName(shard_directory, checkpoint_id), compression,
+        version, std::move(output_types), &writer);
+  }
+  if (!s.ok()) {
+    return set_status(s);
+  }
+  snapshot_util::Writer* file_writer = writer.get();
+  {
+    mutex_lock l(mu_);
+    writer_ = std::move(writer);
+    MaybeScheduleEncodes();
+  }
 
   while (true) {
-    ElementOrEOF be;
-    Consume(&be);
-
-    if (be.end_of_sequence) {
-      TF_RETURN_IF_ERROR(writer->Close());
-      break;
+    Records records;
+    {
+      mutex_lock l(mu_);
+      mu_.Await(
+          tensorflow::Condition(this, &AsyncWriter::NextRecordsAvailable));
+      if (!status_.ok()) {
+        return status_;
+      }
+      if (next_write_index_ == end_index_) {
+        break;
+      }
+      auto it = encoded_.find(next_write_index_);
+      records = std::move(it->second);
+      encoded_.erase(it);
+      ++next_write_index_;
+    }
+    if (!records.status.ok()) {
+      return set_status(records.status);
+    }
+    s = file_writer->WriteRecords(records.records);
+    if (!s.ok()) {
+      return set_status(s);
     }
-
-    TF_RETURN_IF_ERROR(writer->WriteTensors(be.value));
   }
-  return OkStatus();
+  return set_status(file_writer->Close());
 }
 
 namespace {
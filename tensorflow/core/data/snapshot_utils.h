@@ -16,6 +16,13 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SNAPSHOT_UTILS_H_
 #define TENSORFLOW_CORE_DATA_SNAPSHOT_UTILS_H_
 
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -80,7 +87,17 @@ class Writer {
                        std::unique_ptr<Writer>* out_writer);
 
   // Writes a vector of tensors to the snapshot writer file.
-  virtual Status WriteTensors(const std::vector<Tensor>& tensors) = 0;
+  Status WriteTensors(const std::vector<Tensor>& tensors);
+
+  // Serializes `tensors` into the records that `WriteTensors()` appends to the
+  // file. The records are also compressed when the file format compresses each
+  // record, rather than the whole file. Does not access the file, so it may run
+  // concurrently with any method but `Close()`.
+  virtual Status EncodeTensors(const std::vector<Tensor>& tensors,
+                               std::vector<std::string>* records) const = 0;
+
+  // Appends records returned by `EncodeTensors()` to the file.
+  virtual Status WriteRecords(const std::vector<std::string>& records) = 0;
 
   // Flushes any in-memory buffers to disk.
   virtual Status Sync() = 0;
@@ -101,7 +118,10 @@ class TFRecordWriter : public Writer {
   TFRecordWriter(const std::string& filename,
                  const std::string& compression_type);
 
-  Status WriteTensors(const std::vector<Tensor>& tensors) override;
+  Status EncodeTensors(const std::vector<Tensor>& tensors,
+                       std::vector<std::string>* records) const override;
+
+  Status WriteRecords(const std::vector<std::string>& records) override;
 
   Status Sync() override;
 
@@ -133,7 +153,10 @@ class CustomWriter : public Writer {
   CustomWriter(const std::string& filename, const std::string& compression_type,
                const DataTypeVector& dtypes);
 
-  Status WriteTensors(const std::vector<Tensor>& tensors) override;
+  Status EncodeTensors(const std::vector<Tensor>& tensors,
+                       std::vector<std::string>* records) const override;
+
+  Status WriteRecords(const std::vector<std::string>& records) override;
 
   Status Sync() override;
 
@@ -147,10 +170,6 @@ class CustomWriter : public Writer {
  private:
   Status WriteRecord(const StringPiece& data);
 
-#if defined(TF_CORD_SUPPORT)
-  Status WriteRecord(const absl::Cord& data);
-#endif  // TF_CORD_SUPPORT
-
   std::unique_ptr<WritableFile> dest_;
   const std::string filename_;
   const std::string compression_type_;
@@ -338,6 +357,14 @@ struct ElementOrEOF {
 // AsyncWriter provides API for asynchronously writing dataset elements
 // (each represented as a vector of tensors) to a file.
 //
+// Writing is pipelined: elements are encoded (serialized, and compressed if
+// the file format compresses each record) in parallel on a thread pool shared
+// by all writers, and a dedicated thread appends the encoded records to the
+// file in the order in which the elements were written. At most
+// `kMaxBufferedElements` elements are buffered between the stages, and
+// `Write()` blocks while the buffer is full, so snapshots are written at the
+// speed of the slowest stage.
+//
 // The expected use of this API is:
 //
 // std::unique_ptr<AsyncWriter> writer = absl_make_unique<AsyncWriter>(...);
@@ -356,8 +383,16 @@ class AsyncWriter {
                        const DataTypeVector& output_types,
                        std::function<void(Status)> done);
 
-  // Writes the given tensors. The method is non-blocking and returns without
-  // waiting for the element to be written.
+  // The maximum number of elements that are waiting to be encoded, being
+  // encoded, or waiting to be written.
+  static constexpr int64_t kMaxBufferedElements = 64;
+
+  // Blocks until all elements have been encoded.
+  ~AsyncWriter();
+
+  // Writes the given tensors. The method returns without waiting for the
+  // element to be written, but blocks while `kMaxBufferedElements` elements
+  // are buffered. Elements written after an error are dropped.
   void Write(const std::vector<Tensor>& tensors) TF_LOCKS_EXCLUDED(mu_);
 
   // Signals the end of input. The method is non-blocking and returns without
@@ -365,14 +400,42 @@ class AsyncWriter {
   void SignalEOF() TF_LOCKS_EXCLUDED(mu_);
 
  private:
-  void Consume(ElementOrEOF* be) TF_LOCKS_EXCLUDED(mu_);
-  bool ElementAvailable() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // An encoded element.
+  struct Records {
+    Status status;
+    std::vector<std::string> records;
+  };
+
+  // Schedules the encoding of the elements in `deque_`, if the file writer has
+  // been created.
+  void MaybeScheduleEncodes() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void Encode(const Writer* writer, int64_t index, std::vector<Tensor> tensors)
+      TF_LOCKS_EXCLUDED(mu_);
+  bool CanBufferElement() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool NextRecordsAvailable() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  bool NoEncodesInFlight() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   Status WriterThread(Env* env, const std::string& shard_directory,
                       uint64 checkpoint_id, const std::string& compression,
                       int64_t version, DataTypeVector output_types);
 
   mutex mu_;
-  std::deque<ElementOrEOF> deque_ TF_GUARDED_BY(mu_);
+  // Set once the file is open. The encodes use it without holding `mu_`, which
+  // is safe because it is only destroyed with `this`.
+  std::unique_ptr<Writer> writer_ TF_GUARDED_BY(mu_);
+  // The first error of any stage.
+  Status status_ TF_GUARDED_BY(mu_);
+  // Elements waiting to be encoded, with their index.
+  std::deque<std::pair<int64_t, std::vector<Tensor>>> deque_
+      TF_GUARDED_BY(mu_);
+  int64_t num_encodes_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  // Encoded elements waiting to be written, keyed by index.
+  absl::flat_hash_map<int64_t, Records> encoded_ TF_GUARDED_BY(mu_);
+  // The index of the next element passed to `Write()`.
+  int64_t next_index_ TF_GUARDED_BY(mu_) = 0;
+  // The index of the next element to write to the file.
+  int64_t next_write_index_ TF_GUARDED_BY(mu_) = 0;
+  // The number of elements, once `SignalEOF()` has been called.
+  int64_t end_index_ TF_GUARDED_BY(mu_) = -1;
 
   // This has to be last. During destruction, we need to make sure that the
   // Thread object is destroyed first as its destructor blocks on thread
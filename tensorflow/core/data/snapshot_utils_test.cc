@@ -91,6 +91,50 @@ TEST(SnapshotUtilTest, CombinationRoundTripTest) {
   SnapshotRoundTrip(io::compression::kSnappy, 2);
 }
 
+void AsyncWriterRoundTrip(std::string compression_type, int version) {
+  std::string shard_directory;
+  EXPECT_TRUE(Env::Default()->LocalTempFilename(&shard_directory));
+  const int num_elements = 10 * AsyncWriter::kMaxBufferedElements;
+  Status writer_status;
+  {
+    AsyncWriter writer(Env::Default(), /*file_index=*/0, shard_directory,
+                       /*checkpoint_id=*/0, compression_type, version,
+                       {DT_INT64}, [&writer_status](Status s) {
+                         writer_status = s;
+                       });
+    for (int64_t i = 0; i < num_elements; ++i) {
+      Tensor t(i);
+      writer.Write({t});
+    }
+    writer.SignalEOF();
+  }
+  TF_ASSERT_OK(writer_status);
+
+  std::unique_ptr<Reader> reader;
+  TF_ASSERT_OK(Reader::Create(Env::Default(),
+                              GetCheckpointFileName(shard_directory, 0),
+                              compression_type, version, {DT_INT64}, &reader));
+  // The elements are written in order.
+  for (int64_t i = 0; i < num_elements; ++i) {
+    std::vector<Tensor> read_tensors;
+    TF_ASSERT_OK(reader->ReadTensors(&read_tensors));
+    ASSERT_EQ(read_tensors.size(), 1);
+    EXPECT_EQ(read_tensors[0].scalar<int64_t>()(), i);
+  }
+
+  int64_t undeleted_files, undeleted_dirs;
+  TF_ASSERT_OK(Env::Default()->DeleteRecursively(
+      shard_directory, &undeleted_files, &undeleted_dirs));
+}
+
+TEST(SnapshotUtilTest, AsyncWriterRoundTripTest) {
+  AsyncWriterRoundTrip(io::compression::kNone, 1);
+  AsyncWriterRoundTrip(io::compression::kSnappy, 1);
+
+  AsyncWriterRoundTrip(io::compression::kNone, 2);
+  AsyncWriterRoundTrip(io::compression::kSnappy, 2);
+}
+
 void SnapshotReaderBenchmarkLoop(::testing::benchmark::State& state,
                                  std::string compression_type, int version) {
   tensorflow::DataTypeVector dtypes;
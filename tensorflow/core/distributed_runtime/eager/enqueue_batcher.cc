@@ -0,0 +1,160 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace eager {
+
+struct EnqueueBatcher::Batch {
+  // A request that was coalesced into the batch.
+  struct Part {
+    int num_items;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+
+  EnqueueRequest request;
+  EnqueueResponse response;
+  std::vector<Part> parts;
+};
+
+EnqueueBatcher::EnqueueBatcher(int max_in_flight, int max_batch_size,
+                               SendFn send)
+    : max_in_flight_(max_in_flight),
+      max_batch_size_(max_batch_size),
+      send_(std::move(send)) {}
+
+EnqueueBatcher::~EnqueueBatcher() {
+  // Buffered batches hold a reference through the outstanding requests.
+  DCHECK(pending_.empty());
+}
+
+void EnqueueBatcher::Enqueue(const EnqueueRequest* request,
+                             EnqueueResponse* response, StatusCallback done) {
+  Status cancel_status;
+  {
+    mutex_lock l(mu_);
+    if (!cancel_status_.ok()) {
+      cancel_status = cancel_status_;
+    } else if (sending_ || !pending_.empty() || !CanSendLocked()) {
+      AddToBatchLocked(*request, response, std::move(done));
+      if (sending_ || !CanSendLocked()) return;
+      sending_ = true;
+      request = nullptr;
+    } else {
+      sending_ = true;
+      ++in_flight_;
+    }
+  }
+  if (!cancel_status.ok()) {
+    done(cancel_status);
+    return;
+  }
+  if (request != nullptr) {
+    Ref();
+    send_(*request, response,
+          [this, done = std::move(done)](const Status& status) {
+            done(status);
+            RequestDone();
+          });
+  }
+  SendPending();
+}
+
+void EnqueueBatcher::Cancel(const Status& status) {
+  std::deque<std::unique_ptr<Batch>> pending;
+  {
+    mutex_lock l(mu_);
+    cancel_status_ = status;
+    pending.swap(pending_);
+  }
+  for (const std::unique_ptr<Batch>& batch : pending) {
+    CompleteBatch(batch.get(), status);
+  }
+}
+
+void EnqueueBatcher::AddToBatchLocked(const EnqueueRequest& request,
+                                      EnqueueResponse* response,
+                                      StatusCallback done) {
+  if (pending_.empty() ||
+      pending_.back()->request.queue_size() >= max_batch_size_) {
+    pending_.push_back(std::make_unique<Batch>());
+    pending_.back()->request.set_context_id(request.context_id());
+  }
+  Batch* batch = pending_.back().get();
+  batch->request.mutable_queue()->MergeFrom(request.queue());
+  batch->parts.push_back({request.queue_size(), response, std::move(done)});
+}
+
+void EnqueueBatcher::SendPending() {
+  while (true) {
+    Batch* batch;
+    {
+      mutex_lock l(mu_);
+      DCHECK(sending_);
+      if (pending_.empty() || !CanSendLocked()) {
+        sending_ = false;
+        return;
+      }
+      batch = pending_.front().release();
+      pending_.pop_front();
+      ++in_flight_;
+    }
+    VLOG(3) << "Sending " << batch->parts.size()
+            << " coalesced enqueue requests with "
+            << batch->request.queue_size() << " items";
+    Ref();
+    send_(batch->request, &batch->response,
+          [this, batch](const Status& status) {
+            CompleteBatch(batch, status);
+            delete batch;
+            RequestDone();
+          });
+  }
+}
+
+void EnqueueBatcher::RequestDone() {
+  bool send;
+  {
+    mutex_lock l(mu_);
+    --in_flight_;
+    send = !sending_ && !pending_.empty() && CanSendLocked();
+    if (send) sending_ = true;
+  }
+  if (send) SendPending();
+  Unref();
+}
+
+void EnqueueBatcher::CompleteBatch(Batch* batch, const Status& status) {
+  int next = 0;
+  for (Batch::Part& part : batch->parts) {
+    if (status.ok()) {
+      for (int i = 0;
+           i < part.num_items && next < batch->response.queue_response_size();
+           ++i, ++next) {
+        part.response->add_queue_response()->Swap(
+            batch->response.mutable_queue_response(next));
+      }
+    }
+    part.done(status);
+  }
+}
+
+}  // namespace eager
+}  // namespace tensorflow
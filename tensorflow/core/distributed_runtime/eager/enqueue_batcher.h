@@ -0,0 +1,101 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Pipelines the EnqueueRequests of one remote context over a streaming call,
+// with flow control and batching.
+//
+// At most `max_in_flight` requests are outstanding at a time, which bounds
+// what the client and the remote worker buffer for a fast producer. Requests
+// issued while that limit is reached are coalesced into batches of up to
+// `max_batch_size` queue items, and each batch is sent as a single request as
+// soon as an outstanding one completes. The remote worker executes the items
+// of a batch in order, as it would for consecutive requests, and the batch
+// response is split back into the responses of the original requests. When a
+// batch fails, all of its requests receive the error, which matches the
+// streaming call failing every request after an error.
+//
+// A non-positive `max_in_flight` sends every request as soon as it is issued.
+class EnqueueBatcher : public core::RefCounted {
+ public:
+  // Sends `request` on the streaming call. `done` may be called before
+  // `send` returns.
+  using SendFn = std::function<void(const EnqueueRequest& request,
+                                    EnqueueResponse* response,
+                                    StatusCallback done)>;
+
+  EnqueueBatcher(int max_in_flight, int max_batch_size, SendFn send);
+  ~EnqueueBatcher() override;
+
+  // Sends or buffers `request`, which may be deleted once this returns.
+  // `response` must stay alive until `done` is called, which may happen
+  // before Enqueue returns.
+  void Enqueue(const EnqueueRequest* request, EnqueueResponse* response,
+               StatusCallback done) TF_LOCKS_EXCLUDED(mu_);
+
+  // Fails the buffered requests and all subsequent ones with `status`.
+  // Outstanding requests complete as usual.
+  void Cancel(const Status& status) TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Batch;
+
+  bool CanSendLocked() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return max_in_flight_ <= 0 || in_flight_ < max_in_flight_;
+  }
+  void AddToBatchLocked(const EnqueueRequest& request,
+                        EnqueueResponse* response, StatusCallback done)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Sends the buffered batches while the in-flight limit allows it.
+  // REQUIRES: the caller set `sending_`, which this resets.
+  void SendPending() TF_LOCKS_EXCLUDED(mu_);
+  void RequestDone() TF_LOCKS_EXCLUDED(mu_);
+  static void CompleteBatch(Batch* batch, const Status& status);
+
+  const int max_in_flight_;
+  const int max_batch_size_;
+  const SendFn send_;
+
+  mutex mu_;
+  int in_flight_ TF_GUARDED_BY(mu_) = 0;
+  // Set while a thread is sending, so that requests reach `send_` in the
+  // order they were enqueued.
+  bool sending_ TF_GUARDED_BY(mu_) = false;
+  std::deque<std::unique_ptr<Batch>> pending_ TF_GUARDED_BY(mu_);
+  Status cancel_status_ TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(EnqueueBatcher);
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
@@ -0,0 +1,199 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+// Records the requests sent by an EnqueueBatcher, to be completed by the test.
+class FakeStream {
+ public:
+  struct Call {
+    EnqueueRequest request;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+
+  EnqueueBatcher::SendFn Sender() {
+    return [this](const EnqueueRequest& request, EnqueueResponse* response,
+                  StatusCallback done) {
+      calls_.push_back({request, response, std::move(done)});
+    };
+  }
+
+  // Completes call `i` with one queue response per item, whose operation id
+  // is the id of the item's operation.
+  void Complete(int i, const Status& status = OkStatus()) {
+    Call& call = calls_[i];
+    if (status.ok()) {
+      for (const QueueItem& item : call.request.queue()) {
+        call.response->add_queue_response()->add_shape()->add_dim()->set_size(
+            item.operation().id());
+      }
+    }
+    // `done` may send the next request, which invalidates `call`.
+    StatusCallback done = std::move(call.done);
+    done(status);
+  }
+
+  const std::vector<Call>& calls() const { return calls_; }
+
+ private:
+  std::vector<Call> calls_;
+};
+
+EnqueueRequest Request(std::vector<int64_t> op_ids) {
+  EnqueueRequest request;
+  request.set_context_id(1);
+  for (int64_t id : op_ids) {
+    request.add_queue()->mutable_operation()->set_id(id);
+  }
+  return request;
+}
+
+int64_t OpId(const EnqueueResponse& response, int i) {
+  return response.queue_response(i).shape(0).dim(0).size();
+}
+
+TEST(EnqueueBatcherTest, SendsDirectlyBelowLimit) {
+  FakeStream stream;
+  core::RefCountPtr<EnqueueBatcher> batcher(
+      new EnqueueBatcher(/*max_in_flight=*/2, /*max_batch_size=*/16,
+                         stream.Sender()));
+  EnqueueResponse responses[2];
+  Status statuses[2] = {errors::Unknown(""), errors::Unknown("")};
+  for (int i = 0; i < 2; ++i) {
+    EnqueueRequest request = Request({i});
+    batcher->Enqueue(&request, &responses[i],
+                     [&statuses, i](const Status& s) { statuses[i] = s; });
+  }
+  ASSERT_EQ(stream.calls().size(), 2);
+  EXPECT_EQ(stream.calls()[1].request.queue(0).operation().id(), 1);
+  stream.Complete(0);
+  stream.Complete(1);
+  TF_EXPECT_OK(statuses[0]);
+  TF_EXPECT_OK(statuses[1]);
+  EXPECT_EQ(OpId(responses[1], 0), 1);
+}
+
+TEST(EnqueueBatcherTest, CoalescesRequestsAtLimit) {
+  FakeStream stream;
+  core::RefCountPtr<EnqueueBatcher> batcher(
+      new EnqueueBatcher(/*max_in_flight=*/1, /*max_batch_size=*/16,
+                         stream.Sender()));
+  EnqueueResponse responses[3];
+  int num_done = 0;
+  EnqueueRequest first = Request({0});
+  batcher->Enqueue(&first, &responses[0],
+                   [&num_done](const Status& s) { ++num_done; });
+  EnqueueRequest second = Request({1, 2});
+  batcher->Enqueue(&second, &responses[1],
+                   [&num_done](const Status& s) { ++num_done; });
+  EnqueueRequest third = Request({3});
+  batcher->Enqueue(&third, &responses[2],
+                   [&num_done](const Status& s) { ++num_done; });
+  // The last two requests wait for the first one.
+  ASSERT_EQ(stream.calls().size(), 1);
+
+  stream.Complete(0);
+  EXPECT_EQ(num_done, 1);
+  ASSERT_EQ(stream.calls().size(), 2);
+  const EnqueueRequest& batch = stream.calls()[1].request;
+  EXPECT_EQ(batch.context_id(), 1);
+  ASSERT_EQ(batch.queue_size(), 3);
+  EXPECT_EQ(batch.queue(2).operation().id(), 3);
+
+  stream.Complete(1);
+  EXPECT_EQ(num_done, 3);
+  ASSERT_EQ(responses[1].queue_response_size(), 2);
+  EXPECT_EQ(OpId(responses[1], 0), 1);
+  EXPECT_EQ(OpId(responses[1], 1), 2);
+  ASSERT_EQ(responses[2].queue_response_size(), 1);
+  EXPECT_EQ(OpId(responses[2], 0), 3);
+}
+
+TEST(EnqueueBatcherTest, LimitsBatchSize) {
+  FakeStream stream;
+  core::RefCountPtr<EnqueueBatcher> batcher(
+      new EnqueueBatcher(/*max_in_flight=*/1, /*max_batch_size=*/2,
+                         stream.Sender()));
+  EnqueueResponse responses[4];
+  for (int i = 0; i < 4; ++i) {
+    EnqueueRequest request = Request({i});
+    batcher->Enqueue(&request, &responses[i], [](const Status& s) {});
+  }
+  stream.Complete(0);
+  ASSERT_EQ(stream.calls().size(), 2);
+  EXPECT_EQ(stream.calls()[1].request.queue_size(), 2);
+  stream.Complete(1);
+  ASSERT_EQ(stream.calls().size(), 3);
+  EXPECT_EQ(stream.calls()[2].request.queue_size(), 1);
+  stream.Complete(2);
+}
+
+TEST(EnqueueBatcherTest, BatchErrorFailsAllRequests) {
+  FakeStream stream;
+  core::RefCountPtr<EnqueueBatcher> batcher(
+      new EnqueueBatcher(/*max_in_flight=*/1, /*max_batch_size=*/16,
+                         stream.Sender()));
+  EnqueueResponse responses[3];
+  std::vector<Status> statuses(3);
+  for (int i = 0; i < 3; ++i) {
+    EnqueueRequest request = Request({i});
+    batcher->Enqueue(&request, &responses[i],
+                     [&statuses, i](const Status& s) { statuses[i] = s; });
+  }
+  stream.Complete(0);
+  stream.Complete(1, errors::Internal("op failed"));
+  TF_EXPECT_OK(statuses[0]);
+  EXPECT_EQ(statuses[1].code(), error::INTERNAL);
+  EXPECT_EQ(statuses[2].code(), error::INTERNAL);
+}
+
+TEST(EnqueueBatcherTest, CancelFailsBufferedRequests) {
+  FakeStream stream;
+  core::RefCountPtr<EnqueueBatcher> batcher(
+      new EnqueueBatcher(/*max_in_flight=*/1, /*max_batch_size=*/16,
+                         stream.Sender()));
+  EnqueueResponse responses[3];
+  std::vector<Status> statuses(3);
+  for (int i = 0; i < 2; ++i) {
+    EnqueueRequest request = Request({i});
+    batcher->Enqueue(&request, &responses[i],
+                     [&statuses, i](const Status& s) { statuses[i] = s; });
+  }
+  batcher->Cancel(errors::Cancelled("closed"));
+  EXPECT_EQ(statuses[1].code(), error::CANCELLED);
+  EnqueueRequest request = Request({2});
+  batcher->Enqueue(&request, &responses[2],
+                   [&statuses](const Status& s) { statuses[2] = s; });
+  EXPECT_EQ(statuses[2].code(), error::CANCELLED);
+
+  // The outstanding request completes normally.
+  stream.Complete(0);
+  TF_EXPECT_OK(statuses[0]);
+  EXPECT_EQ(stream.calls().size(), 1);
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
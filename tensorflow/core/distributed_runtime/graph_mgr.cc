@@ -320,6 +320,32 @@ Status GraphMgr::Register(const string& handle, const GraphDef& gdef,
   return OkStatus();
 }
 
+Status GraphMgr::SetRecvKeys(const string& handle,
+                             std::vector<string> recv_keys) {
+  mutex_lock l(mu_);
+  auto iter = table_.find(handle);
+  if (iter == table_.end()) {
+    return errors::Aborted("Graph handle is not found: ", handle,
+                           ". Possibly, this worker just restarted.");
+  }
+  iter->second->recv_keys = std::move(recv_keys);
+  return OkStatus();
+}
+
+Status GraphMgr::AddRecvKeys(const string& handle, const Tensor& empty_tensor,
+                             NamedTensors* out) {
+  mutex_lock l(mu_);
+  auto iter = table_.find(handle);
+  if (iter == table_.end()) {
+    return errors::Aborted("Graph handle is not found: ", handle,
+                           ". Possibly, this worker just restarted.");
+  }
+  for (const string& key : iter->second->recv_keys) {
+    out->insert({key, empty_tensor});
+  }
+  return OkStatus();
+}
+
 Status GraphMgr::Deregister(const string& handle) {
   Item* item = nullptr;
   // Removes one item from table_.
@@ -100,6 +100,15 @@ class GraphMgr {
                     tsl::CoordinationServiceAgent* coordination_service_agent,
                     StatusCallback done);
 
+  // Stores the rendezvous keys that every run of the registered graph
+  // "handle" receives, so that runs need not list them.
+  Status SetRecvKeys(const string& handle, std::vector<string> recv_keys);
+
+  // Adds the keys stored by SetRecvKeys() for "handle" to "out", with
+  // "empty_tensor" as their values.
+  Status AddRecvKeys(const string& handle, const Tensor& empty_tensor,
+                     NamedTensors* out);
+
   Status SendInputs(const int64_t step_id, const NamedTensors& in);
   Status RecvOutputs(const int64_t step_id, NamedTensors* out);
   void RecvOutputsAsync(const int64_t step_id, NamedTensors* out,
@@ -148,6 +157,9 @@ class GraphMgr {
     GraphMgr* graph_mgr;
 
     int64_t collective_graph_key;
+
+    // Rendezvous keys received by every run. Set once after registration.
+    std::vector<string> recv_keys;
   };
 
   const WorkerEnv* worker_env_;  // Not owned.
@@ -206,6 +206,16 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
   // workers.
   Status RegisterPartitions(PartitionOptions popts);
 
+  // Returns true and sets `*status` to the result of the registration if
+  // RegisterPartitions() has completed, so that steps after the first one
+  // do not need to build the partition options.
+  bool PartitionsRegistered(Status* status) {
+    if (!init_done_.HasBeenNotified()) return false;
+    mutex_lock l(mu_);
+    *status = init_result_;
+    return true;
+  }
+
   // Runs one step of all partitions.
   Status RunPartitions(const MasterEnv* env, int64_t step_id,
                        int64_t execution_count, PerStepState* pss,
@@ -266,6 +276,14 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     // Maps rendezvous keys to fetch names. Empty most of the time.
     std::unordered_map<string, string> key_fetch;
 
+    // Maps fetch names to rendezvous keys, the inverse of key_fetch, for
+    // partial runs which fetch a subset of the fetches.
+    std::unordered_map<string, string> fetch_key;
+
+    // True if the worker stored the keys of key_fetch at registration, so
+    // that RunGraph requests need not list them.
+    bool recv_keys_registered = false;
+
     // The interface to the worker. Owned.
     WorkerInterface* worker = nullptr;
 
@@ -273,7 +291,7 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     // this partition on the worker.
     string graph_handle;
 
-    Part() : feed_key(3), key_fetch(3) {}
+    Part() : feed_key(3), key_fetch(3), fetch_key(3) {}
   };
 
   // partitions_ is immutable after RegisterPartitions() call
@@ -421,6 +439,7 @@ void MasterSession::ReffedClientGraph::TrackFeedsAndFetches(
           part->feed_key.insert({name, key});
         } else {
           part->key_fetch.insert({key, name});
+          part->fetch_key.insert({name, key});
         }
       }
     }
@@ -487,6 +506,11 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     *c->req.mutable_debug_options() =
         callable_opts_.run_options().debug_options();
     c->req.set_collective_graph_key(collective_graph_key_);
+    if (!is_partial_) {
+      for (const auto& key_fetch : part.key_fetch) {
+        c->req.add_recv_key(key_fetch.first);
+      }
+    }
     VLOG(2) << "Register " << c->req.graph_def().DebugString();
     auto cb = [c, &done](const Status& s) {
       c->status = s;
@@ -499,6 +523,7 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     Call* c = &calls[i];
     s.Update(c->status);
     partitions_[i].graph_handle = c->resp.graph_handle();
+    partitions_[i].recv_keys_registered = c->resp.recv_keys_registered();
   }
   return s;
 }
@@ -707,14 +732,10 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
         TF_RETURN_IF_ERROR(AddSendFromClientRequest(req, c->req.get(),
                                                     name_index.second, key));
       }
-      // TODO(suharshs): Make a map from feed to fetch_key to make this faster.
-      // For now, we just iterate through partitions to find the matching key.
       for (const string& req_fetch : fetches) {
-        for (const auto& key_fetch : part.key_fetch) {
-          if (key_fetch.second == req_fetch) {
-            c->req->add_recv_key(key_fetch.first);
-            break;
-          }
+        const auto iter = part.fetch_key.find(req_fetch);
+        if (iter != part.fetch_key.end()) {
+          c->req->add_recv_key(iter->second);
         }
       }
     } else {
@@ -729,9 +750,13 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
         TF_RETURN_IF_ERROR(
             AddSendFromClientRequest(req, c->req.get(), feed_index, key));
       }
-      for (const auto& key_fetch : part.key_fetch) {
-        const string& key = key_fetch.first;
-        c->req->add_recv_key(key);
+      if (part.recv_keys_registered) {
+        c->req->set_recv_registered_keys(true);
+      } else {
+        for (const auto& key_fetch : part.key_fetch) {
+          const string& key = key_fetch.first;
+          c->req->add_recv_key(key);
+        }
       }
     }
   }
@@ -1685,6 +1710,10 @@ void MasterSession::MarkRunCompletion() {
 }
 
 Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
+  Status registration_status;
+  if (rcg->PartitionsRegistered(&registration_status)) {
+    return registration_status;
+  }
   // Registers subgraphs if haven't done so.
   PartitionOptions popts;
   popts.node_to_loc = SplitByWorker;
@@ -373,6 +373,15 @@ void InMemoryRunGraphRequest::set_is_partial(bool is_partial) {
   is_partial_ = is_partial;
 }
 
+bool InMemoryRunGraphRequest::recv_registered_keys() const {
+  return recv_registered_keys_;
+}
+
+void InMemoryRunGraphRequest::set_recv_registered_keys(
+    bool recv_registered_keys) {
+  recv_registered_keys_ = recv_registered_keys;
+}
+
 bool InMemoryRunGraphRequest::is_last_partial_run() const {
   return is_last_partial_run_;
 }
@@ -414,6 +423,7 @@ const RunGraphRequest& InMemoryRunGraphRequest::ToProto() const {
     for (size_t i = 0; i < num_recvs(); ++i) {
       proto_version_->add_recv_key(recv_key(i));
     }
+    proto_version_->set_recv_registered_keys(recv_registered_keys());
     proto_version_->set_is_partial(is_partial());
     proto_version_->set_is_last_partial_run(is_last_partial_run());
   }
@@ -519,6 +529,15 @@ void MutableProtoRunGraphRequest::set_is_partial(bool is_partial) {
   request_.set_is_partial(is_partial);
 }
 
+bool MutableProtoRunGraphRequest::recv_registered_keys() const {
+  return request_.recv_registered_keys();
+}
+
+void MutableProtoRunGraphRequest::set_recv_registered_keys(
+    bool recv_registered_keys) {
+  request_.set_recv_registered_keys(recv_registered_keys);
+}
+
 bool MutableProtoRunGraphRequest::is_last_partial_run() const {
   return request_.is_last_partial_run();
 }
@@ -594,6 +613,10 @@ const string& ProtoRunGraphRequest::recv_key(size_t i) const {
 
 bool ProtoRunGraphRequest::is_partial() const { return request_->is_partial(); }
 
+bool ProtoRunGraphRequest::recv_registered_keys() const {
+  return request_->recv_registered_keys();
+}
+
 bool ProtoRunGraphRequest::is_last_partial_run() const {
   return request_->is_last_partial_run();
 }
@@ -282,6 +282,9 @@ class RunGraphRequestWrapper {
   virtual size_t num_recvs() const = 0;
   virtual const string& recv_key(size_t i) const = 0;
 
+  // True if the keys registered with the graph are fetched as well.
+  virtual bool recv_registered_keys() const = 0;
+
   // True if the RunGraphRequest is a partial run request.
   virtual bool is_partial() const = 0;
 
@@ -322,6 +325,7 @@ class MutableRunGraphRequestWrapper : public RunGraphRequestWrapper {
       const string& send_key) = 0;
 
   virtual void add_recv_key(const string& recv_key) = 0;
+  virtual void set_recv_registered_keys(bool recv_registered_keys) = 0;
   virtual void set_is_partial(bool is_partial) = 0;
   virtual void set_is_last_partial_run(bool is_last_partial_run) = 0;
   virtual void set_store_errors_in_response_body(bool store_errors) = 0;
@@ -341,6 +345,7 @@ class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
   Status SendValue(size_t i, Tensor* out_tensor) const override;
   size_t num_recvs() const override;
   const string& recv_key(size_t i) const override;
+  bool recv_registered_keys() const override;
   bool is_partial() const override;
   bool is_last_partial_run() const override;
   const RunGraphRequest& ToProto() const override;
@@ -360,6 +365,7 @@ class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
       const RunCallableRequest& run_callable_request, size_t i,
       const string& send_key) override;
   void add_recv_key(const string& recv_key) override;
+  void set_recv_registered_keys(bool recv_registered_keys) override;
   void set_is_partial(bool is_partial) override;
   void set_is_last_partial_run(bool is_last_partial_run) override;
   void set_store_errors_in_response_body(bool store_errors) override;
@@ -373,6 +379,7 @@ class InMemoryRunGraphRequest : public MutableRunGraphRequestWrapper {
   ExecutorOpts exec_opts_;
   gtl::InlinedVector<std::pair<string, Tensor>, 4> sends_;
   gtl::InlinedVector<string, 4> recvs_;
+  bool recv_registered_keys_ = false;
   bool is_partial_ = false;
   bool is_last_partial_run_ = false;
   bool store_errors_in_response_body_ = false;
@@ -401,6 +408,7 @@ class MutableProtoRunGraphRequest : public MutableRunGraphRequestWrapper {
   Status SendValue(size_t i, Tensor* out_tensor) const override;
   size_t num_recvs() const override;
   const string& recv_key(size_t i) const override;
+  bool recv_registered_keys() const override;
   bool is_partial() const override;
   bool is_last_partial_run() const override;
   bool store_errors_in_response_body() const override;
@@ -420,6 +428,7 @@ class MutableProtoRunGraphRequest : public MutableRunGraphRequestWrapper {
       const RunCallableRequest& run_callable_request, size_t i,
       const string& send_key) override;
   void add_recv_key(const string& recv_key) override;
+  void set_recv_registered_keys(bool recv_registered_keys) override;
   void set_is_partial(bool is_partial) override;
   void set_is_last_partial_run(bool is_last_partial_run) override;
   void set_store_errors_in_response_body(bool store_errors) override;
@@ -444,6 +453,7 @@ class ProtoRunGraphRequest : public RunGraphRequestWrapper {
   Status SendValue(size_t i, Tensor* out_tensor) const override;
   size_t num_recvs() const override;
   const string& recv_key(size_t i) const override;
+  bool recv_registered_keys() const override;
   bool is_partial() const override;
   bool is_last_partial_run() const override;
   bool store_errors_in_response_body() const override;
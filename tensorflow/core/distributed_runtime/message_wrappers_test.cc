@@ -80,6 +80,7 @@ void BuildRunGraphRequest(const RunStepRequestWrapper& run_step_request,
                                                             "send_1"));
   run_graph_request->add_recv_key("recv_2");
   run_graph_request->add_recv_key("recv_3");
+  run_graph_request->set_recv_registered_keys(true);
   run_graph_request->set_is_partial(true);
 }
 
@@ -95,6 +96,7 @@ void CheckRunGraphRequest(const RunGraphRequestWrapper& request) {
   test::ExpectTensorEqual<int32>(TensorA(), val);
   TF_EXPECT_OK(request.SendValue(1, &val));
   test::ExpectTensorEqual<int32>(TensorB(), val);
+  EXPECT_TRUE(request.recv_registered_keys());
   EXPECT_TRUE(request.is_partial());
   EXPECT_FALSE(request.is_last_partial_run());
 }
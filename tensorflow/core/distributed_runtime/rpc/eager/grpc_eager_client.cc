@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
+#include <memory>
 #include <string>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "tensorflow/core/distributed_runtime/call_options.h"
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -72,6 +74,22 @@ bool EnableStreaming() {
   return result;
 }
 
+// The maximum number of outstanding requests on a streaming enqueue call.
+// Requests issued beyond it are coalesced, see EnqueueBatcher. A non-positive
+// value disables the limit.
+int StreamingEnqueueMaxInFlight() {
+  static const int max_in_flight = [] {
+    int64_t result;
+    TF_CHECK_OK(ReadInt64FromEnvVar(
+        "TF_EAGER_CLIENT_STREAMING_ENQUEUE_MAX_IN_FLIGHT", 64, &result));
+    return static_cast<int>(result);
+  }();
+  return max_in_flight;
+}
+
+// The maximum number of queue items in a coalesced enqueue request.
+constexpr int kStreamingEnqueueMaxBatchSize = 256;
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -180,7 +198,10 @@ class GrpcEagerClient : public EagerClient {
     mutex_lock l(mu_);
     const auto& it = enqueue_dispatchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
-      it->second.CancelCall();
+      it->second.batcher->Cancel(
+          errors::Cancelled("Remote eager context ", request->context_id(),
+                            " was closed."));
+      it->second.dispatcher->CancelCall();
       enqueue_dispatchers_.erase(it);
     } else if (EnableStreaming()) {
       LOG(ERROR) << "Remote EagerContext with id " << request->context_id()
@@ -199,19 +220,33 @@ class GrpcEagerClient : public EagerClient {
     // 2. The flag set in the eager executor.
     // Streaming enqueue is allowed only when the both are enabled.
     if (EnableStreaming() && enable_streaming_enqueue) {
-      mutex_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
+      core::RefCountPtr<EnqueueBatcher> batcher;
+      {
+        mutex_lock l(mu_);
+        auto it = enqueue_dispatchers_.find(request->context_id());
+        if (it == enqueue_dispatchers_.end()) {
+          auto dispatcher =
+              std::make_shared<StreamingRPCDispatcher<EnqueueResponse>>(
+                  &stub_, cq_,
+                  "/tensorflow.eager.EagerService/StreamingEnqueue");
+          StreamingEnqueue streaming_enqueue;
+          streaming_enqueue.dispatcher = dispatcher;
+          streaming_enqueue.batcher.reset(new EnqueueBatcher(
+              StreamingEnqueueMaxInFlight(), kStreamingEnqueueMaxBatchSize,
+              [dispatcher](const EnqueueRequest& request,
+                           EnqueueResponse* response, StatusCallback done) {
+                dispatcher->SendNextRequest(request, response,
+                                            std::move(done));
+              }));
+          it = enqueue_dispatchers_
+                   .emplace(request->context_id(), std::move(streaming_enqueue))
+                   .first;
+        }
+        it->second.batcher->Ref();
+        batcher.reset(it->second.batcher.get());
       }
       // TODO(haoyuzhang): Consider supporting cancellation for streaming RPC?
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
+      batcher->Enqueue(request, response, std::move(done_wrapped));
     } else {
       Notification n;
       Status status;
@@ -234,8 +269,16 @@ class GrpcEagerClient : public EagerClient {
 
   mutable mutex mu_;
 
-  std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
-      enqueue_dispatchers_ TF_GUARDED_BY(mu_);
+  // The streaming enqueue call of a context. The dispatcher is shared with the
+  // sender of the batcher, which outlives the entry while requests are
+  // outstanding.
+  struct StreamingEnqueue {
+    std::shared_ptr<StreamingRPCDispatcher<EnqueueResponse>> dispatcher;
+    core::RefCountPtr<EnqueueBatcher> batcher;
+  };
+
+  std::unordered_map<uint64, StreamingEnqueue> enqueue_dispatchers_
+      TF_GUARDED_BY(mu_);
 
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
@@ -15,10 +15,54 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 
+#include <vector>
+
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 
 namespace tensorflow {
 
+namespace {
+// Keeps the slices of a received byte buffer alive while a tensor aliases
+// some of their bytes.
+class GrpcSliceTensorBuffer : public TensorBuffer {
+ public:
+  GrpcSliceTensorBuffer(::grpc::ByteBuffer buffer, const char* data,
+                        size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        buffer_(std::move(buffer)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("grpc");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const ::grpc::ByteBuffer buffer_;
+  const size_t size_;
+};
+}  // namespace
+
+TensorBuffer* GrpcByteSource::AliasBuffer(const char* data, size_t num_bytes) {
+  // The copy takes a reference on the slices of the buffer. Slices small
+  // enough to be inlined are copied along with it, so their bytes are never
+  // found in `slices`; neither are those of a decompressed message.
+  ::grpc::ByteBuffer buffer(*buffer_);
+  std::vector<::grpc::Slice> slices;
+  if (!buffer.Dump(&slices).ok()) return nullptr;
+  for (const ::grpc::Slice& slice : slices) {
+    const char* begin = reinterpret_cast<const char*>(slice.begin());
+    if (data >= begin && data + num_bytes <= begin + slice.size()) {
+      return new GrpcSliceTensorBuffer(std::move(buffer), data, num_bytes);
+    }
+  }
+  return nullptr;
+}
+
 bool GrpcMaybeParseTensorResponse(::grpc::ByteBuffer* src,
                                   TensorResponse* dst) {
   ::tensorflow::GrpcByteSource byte_source(src);
@@ -51,6 +51,10 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares `data` if it lies within one of the refcounted slices of the
+  // buffer.
+  TensorBuffer* AliasBuffer(const char* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
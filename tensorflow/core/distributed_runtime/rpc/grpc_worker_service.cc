@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -149,6 +150,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
+    SETUP_FOR_REQUEST(RecvTensors, 100, true);
 
     // TODO(ncteisen): Determine a better policy for enqueuing the
     // appropriate number of each request type.
@@ -302,6 +304,25 @@ class GrpcWorkerServiceThread {
     ENQUEUE_REQUEST(RecvBuf, true);
   }
 
+  void RecvTensorsHandler(
+      WorkerCall<RecvTensorsRequest, RecvTensorsResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorsAsync(call_opts, &call->request, &call->response,
+                                [call, call_opts](const Status& s) {
+                                  call->ClearCancelCallback();
+                                  delete call_opts;
+                                  if (!s.ok()) {
+                                    VLOG(3) << "Bad response from RecvTensors:"
+                                            << s;
+                                  }
+                                  call->SendResponse(ToGrpcStatus(s));
+                                });
+    });
+    ENQUEUE_REQUEST(RecvTensors, true);
+  }
+
   void CompleteGroupHandler(
       WorkerCall<CompleteGroupRequest, CompleteGroupResponse>* call) {
     Schedule([this, call]() {
@@ -436,6 +457,42 @@ void GrpcWorker::EnableResponseCache() {
   response_cache_ = std::make_unique<GrpcResponseCache>();
 }
 
+namespace {
+// Returns the transport that sends the content of `tensor` out of band, if
+// the receiver allowed it with `dma_ok` and can read it according to its
+// `request_options`, or nullptr to send it over gRPC.
+TensorTransport* OutOfBandTransport(
+    bool dma_ok, const ::google::protobuf::Any& request_options,
+    const Tensor& tensor, bool is_dead) {
+  if (!dma_ok || is_dead || !DataTypeCanUseMemcpy(tensor.dtype())) {
+    return nullptr;
+  }
+  TensorTransport* transport = GetTensorTransport();
+  if (transport == nullptr || tensor.TotalBytes() < transport->min_bytes() ||
+      !transport->CanSendTo(request_options)) {
+    return nullptr;
+  }
+  return transport;
+}
+
+// Encodes the metadata of `tensor` and the options to read its content with
+// `transport` into a byte buffer parseable as a RecvTensorResponse.
+Status EncodeOutOfBandTensorToByteBuffer(TensorTransport* transport,
+                                         const Tensor& tensor,
+                                         bool require_ack,
+                                         ::grpc::ByteBuffer* result) {
+  RecvTensorResponse response;
+  response.mutable_tensor()->set_dtype(tensor.dtype());
+  tensor.shape().AsProto(response.mutable_tensor()->mutable_tensor_shape());
+  TF_RETURN_IF_ERROR(transport->TransportOptionsFromTensor(
+      tensor, response.mutable_transport_options()));
+  response.set_send_start_micros(Env::Default()->NowMicros());
+  response.set_require_ack(require_ack);
+  grpc::EncodeRecvTensorResponseToByteBuffer(response, result);
+  return OkStatus();
+}
+}  // namespace
+
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
 // buffers for a response object, to avoid extra protocol buffer serialization
 // overhead we generate our response directly into a ::grpc::ByteBuffer object
@@ -449,10 +506,19 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
+  auto do_response = [response, done, cache_enabled,
+                      dma_ok = request->dma_ok(),
+                      request_options = request->transport_options()](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
     if (status.ok()) {
+      TensorTransport* transport =
+          OutOfBandTransport(dma_ok, request_options, tensor, is_dead);
+      if (transport != nullptr) {
+        done(EncodeOutOfBandTensorToByteBuffer(transport, tensor,
+                                               cache_enabled, response));
+        return;
+      }
       grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
     }
     done(status);
@@ -529,9 +595,16 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
           // i.e. it's in CPU RAM *independent of its assigned
           // device type*.
           const bool on_host = send_args.alloc_attrs.on_host();
+          // Transports with GPUDirect read the tensor in device memory.
+          TensorTransport* transport =
+              OutOfBandTransport(request->dma_ok(),
+                                 request->transport_options(), val, is_dead);
+          const bool device_memory_ok =
+              transport != nullptr && transport->supports_device_memory();
           {
             // Non-DMA cases.
-            if (src_dev->tensorflow_accelerator_device_info() && (!on_host)) {
+            if (src_dev->tensorflow_accelerator_device_info() && (!on_host) &&
+                !device_memory_ok) {
               DeviceContext* send_dev_context = send_args.device_context;
               AllocatorAttributes alloc_attrs;
               alloc_attrs.set_gpu_compatible(true);
@@ -561,6 +634,111 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
       });
 }
 
+void GrpcWorker::RecvTensorsAsync(CallOptions* opts,
+                                  const RecvTensorsRequest* request,
+                                  RecvTensorsResponse* response,
+                                  StatusCallback done) {
+  const int64_t step_id = request->step_id();
+  const int num_tensors = request->requests_size();
+  VLOG(3) << "RecvTensorsAsync: " << num_tensors << " tensors in step "
+          << step_id;
+  if (num_tensors == 0) {
+    done(OkStatus());
+    return;
+  }
+  for (int i = 0; i < num_tensors; ++i) {
+    response->add_responses();
+  }
+
+  // Counts down the tensors still to be received, and keeps the first error.
+  struct State {
+    mutex mu;
+    int pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  auto state = std::make_shared<State>();
+  {
+    mutex_lock l(state->mu);
+    state->pending = num_tensors;
+  }
+  auto tensor_done = [opts, state, done](const Status& s) {
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      state->status.Update(s);
+      if (--state->pending > 0) return;
+      status = state->status;
+    }
+    opts->ClearCancelCallback();
+    done(status);
+  };
+
+  // As in GrpcRecvTensorAsync(), a cancellation while waiting for the tensors
+  // aborts the step.
+  opts->SetCancelCallback([this, step_id]() {
+    LOG(WARNING) << "RecvTensors cancelled for " << step_id;
+    AbortStep(step_id);
+  });
+  for (int i = 0; i < num_tensors; ++i) {
+    const RecvTensorRequest& tensor_request = request->requests(i);
+    RecvTensorResponse* tensor_response = response->mutable_responses(i);
+    Status s = recent_request_ids_.TrackUnique(
+        tensor_request.request_id(), "RecvTensors (GrpcWorker)",
+        tensor_request);
+    Rendezvous::ParsedKey parsed;
+    if (s.ok()) {
+      s = Rendezvous::ParseKey(tensor_request.rendezvous_key(), &parsed);
+    }
+    Device* src_dev = nullptr;
+    if (s.ok()) {
+      s = PrepareRecvTensor(parsed, &src_dev);
+    }
+    if (!s.ok()) {
+      tensor_done(s);
+      continue;
+    }
+
+    auto fill_response = [tensor_response, tensor_done](
+                             const Tensor& tensor, bool is_dead,
+                             const Status& status) {
+      if (status.ok()) {
+        tensor_response->set_is_dead(is_dead);
+        tensor_response->set_send_start_micros(Env::Default()->NowMicros());
+        tensor.AsProtoTensorContent(tensor_response->mutable_tensor());
+      }
+      tensor_done(status);
+    };
+    env_->rendezvous_mgr->RecvLocalAsync(
+        step_id, parsed,
+        [fill_response, src_dev, key = tensor_request.rendezvous_key()](
+            const Status& status, const Rendezvous::Args& send_args,
+            const Rendezvous::Args& recv_args, const Tensor& val,
+            const bool is_dead) {
+          if (status.ok() && src_dev->tensorflow_accelerator_device_info() &&
+              !send_args.alloc_attrs.on_host()) {
+            // "val" is on an accelerator device, copy it to the host first.
+            DeviceContext* send_dev_context = send_args.device_context;
+            AllocatorAttributes alloc_attrs;
+            alloc_attrs.set_gpu_compatible(true);
+            alloc_attrs.set_on_host(true);
+            Allocator* alloc = src_dev->GetAllocator(alloc_attrs);
+            Tensor* copy = new Tensor(alloc, val.dtype(), val.shape());
+            CHECK(send_dev_context)
+                << "send dev name: " << src_dev->name() << " gpu_info: "
+                << src_dev->tensorflow_accelerator_device_info();
+            CopyDeviceToHost(&val, alloc, alloc, key, src_dev, copy,
+                             send_dev_context,
+                             [fill_response, copy, is_dead](const Status& s) {
+                               fill_response(*copy, is_dead, s);
+                               delete copy;
+                             });
+            return;
+          }
+          fill_response(val, is_dead, status);
+        });
+  }
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
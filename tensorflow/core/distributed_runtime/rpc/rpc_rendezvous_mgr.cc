@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
@@ -31,15 +34,24 @@ limitations under the License.
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+// The recvs sent in one RecvTensors RPC are capped, so that a burst of recvs
+// is not held back by the slowest of many tensors.
+constexpr int kMaxRecvTensorBatchSize = 256;
+
+class RpcRecvTensorCall;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      int64_t recv_batch_window_micros)
+      : BaseRemoteRendezvous(env, step_id),
+        recv_batch_window_micros_(recv_batch_window_micros) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +61,30 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // A recv waiting to be sent in a RecvTensors RPC.
+  struct PendingRecv {
+    RpcRecvTensorCall* call;
+    std::function<void()> recv_done;
+  };
+
+  // Queues `call` to be sent, with the other recvs from the same worker that
+  // start within the batching window, in one RecvTensors RPC.
+  void StartBatched(RpcRecvTensorCall* call, std::function<void()> recv_done);
+
+  // Sends the recvs queued for `src_worker`, if any.
+  void FlushBatch(const string& src_worker);
+
+  // Sends `batch`, which are recvs from the same worker.
+  void SendBatch(std::vector<PendingRecv> batch);
+
+  const int64_t recv_batch_window_micros_;
+
+  mutex batch_mu_;
+  absl::flat_hash_map<string, std::vector<PendingRecv>> pending_recvs_
+      TF_GUARDED_BY(batch_mu_);
+  // Workers that don't implement RecvTensors, which get one RPC per recv.
+  absl::flat_hash_set<string> unbatched_workers_ TF_GUARDED_BY(batch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
@@ -68,6 +104,12 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    // Large tensors may then be sent out of band.
+    TensorTransport* transport = GetTensorTransport();
+    req_.set_dma_ok(transport != nullptr);
+    if (transport != nullptr) {
+      transport->RequestOptions(req_.mutable_transport_options());
+    }
   }
 
   void Reset() {
@@ -141,6 +183,10 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
       // Make sure the Rendezvous abort checking is finished before running the
       // callback, which might destroy the current call object.
       abort_checked->WaitForNotification();
+      if (s.ok() && resp_.metadata().has_transport_options()) {
+        RecvOutOfBand(std::move(recv_done));
+        return;
+      }
       if (!s.ok()) {
         mutex_lock l(mu_);
         status_.Update(s);
@@ -166,6 +212,50 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Completes the call with the tensor in `response`, which is part of a
+  // RecvTensors response with status `s`.
+  void FinishBatched(Status s, RecvTensorResponse* response,
+                     std::function<void()> recv_done) {
+    if (s.ok()) {
+      resp_.InitAlloc(dst_device_, alloc_attrs_);
+      s = resp_.InitFrom(response);
+    }
+    if (!s.ok()) {
+      mutex_lock l(mu_);
+      status_.Update(s);
+    }
+    recv_done();
+  }
+
+  // Reads the content of the tensor that the sender sent out of band, into
+  // the tensor that `resp_` allocated from the received metadata.
+  void RecvOutOfBand(std::function<void()> recv_done) {
+    TensorTransport* transport = GetTensorTransport();
+    if (transport == nullptr) {
+      {
+        mutex_lock l(mu_);
+        status_.Update(errors::Internal(
+            "Received a tensor sent out of band without a tensor transport"));
+      }
+      recv_done();
+      return;
+    }
+    // Like TensorResponse, which allocated the tensor.
+    const bool on_host = alloc_attrs_.on_host() ||
+                         dst_device_->attributes().device_type() == "CPU";
+    auto* tensor = new Tensor(resp_.tensor());
+    transport->TensorFromTransportOptions(
+        resp_.metadata().transport_options(), dst_device_, on_host, tensor,
+        [this, tensor, recv_done = std::move(recv_done)](const Status& s) {
+          delete tensor;
+          if (!s.ok()) {
+            mutex_lock l(mu_);
+            status_.Update(s);
+          }
+          recv_done();
+        });
+  }
+
   string src_worker_;
   string src_rel_device_;
   WorkerInterface* wi_;  // Not owned.
@@ -287,7 +377,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call, recv_args, worker_cache]() {
+  auto recv_done = [this, call, recv_args, worker_cache]() {
     // Removes "call" from calls_. Prevent StartAbort().
     DeregisterCall(call, recv_args);
     // If StartAbort was called prior to DeregisterCall, then the
@@ -300,17 +390,162 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
     get_call_freelist()->Release(call);
     Unref();
-  });
+  };
+  if (recv_batch_window_micros_ > 0) {
+    StartBatched(call, std::move(recv_done));
+  } else {
+    call->Start(std::move(recv_done));
+  }
 }
 
+void RpcRemoteRendezvous::StartBatched(RpcRecvTensorCall* call,
+                                       std::function<void()> recv_done) {
+  const string src_worker = call->src_worker_;
+  std::vector<PendingRecv> full_batch;
+  bool schedule_flush = false;
+  {
+    mutex_lock l(batch_mu_);
+    if (!unbatched_workers_.contains(src_worker)) {
+      std::vector<PendingRecv>& batch = pending_recvs_[src_worker];
+      batch.push_back({call, std::move(recv_done)});
+      if (batch.size() >= kMaxRecvTensorBatchSize) {
+        full_batch = std::move(batch);
+        pending_recvs_.erase(src_worker);
+      } else {
+        schedule_flush = batch.size() == 1;
+      }
+      call = nullptr;
+    }
+  }
+  if (call != nullptr) {
+    call->Start(std::move(recv_done));
+    return;
+  }
+  if (!full_batch.empty()) {
+    SendBatch(std::move(full_batch));
+  }
+  if (schedule_flush) {
+    Ref();
+    env_->env->SchedClosureAfter(recv_batch_window_micros_,
+                                 [this, src_worker]() {
+                                   FlushBatch(src_worker);
+                                   Unref();
+                                 });
+  }
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker) {
+  std::vector<PendingRecv> batch;
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_recvs_.find(src_worker);
+    if (it == pending_recvs_.end()) return;
+    batch = std::move(it->second);
+    pending_recvs_.erase(it);
+  }
+  SendBatch(std::move(batch));
+}
+
+void RpcRemoteRendezvous::SendBatch(std::vector<PendingRecv> batch) {
+  if (batch.size() == 1) {
+    // A lone recv keeps the response cache and out of band transfers of
+    // RecvTensor.
+    batch[0].call->Start(std::move(batch[0].recv_done));
+    return;
+  }
+  VLOG(2) << "Sending " << batch.size() << " recvs in step " << step_id_
+          << " to " << batch[0].call->src_worker_ << " in one RPC";
+
+  struct BatchCall {
+    CallOptions opts;
+    RecvTensorsRequest req;
+    RecvTensorsResponse resp;
+    std::vector<PendingRecv> recvs;
+  };
+  auto* batch_call = new BatchCall;
+  batch_call->recvs = std::move(batch);
+  batch_call->req.set_step_id(step_id_);
+  CallOptions* batch_opts = &batch_call->opts;
+  for (PendingRecv& recv : batch_call->recvs) {
+    *batch_call->req.add_requests() = recv.call->req_;
+    // Aborting any of the recvs cancels the whole RPC.
+    recv.call->opts_.SetCancelCallback(
+        [batch_opts]() { batch_opts->StartCancel(); });
+  }
+
+  // All the calls hold the same worker, and the first one releases it only
+  // after the RPC is done.
+  RpcRecvTensorCall* first_call = batch_call->recvs[0].call;
+  const string src_worker = first_call->src_worker_;
+  auto abort_checked = std::make_shared<Notification>();
+  first_call->wi_->RecvTensorsAsync(
+      batch_opts, &batch_call->req, &batch_call->resp,
+      [this, batch_call, abort_checked, src_worker](Status s) {
+        abort_checked->WaitForNotification();
+        std::vector<PendingRecv>& recvs = batch_call->recvs;
+        for (PendingRecv& recv : recvs) {
+          recv.call->opts_.ClearCancelCallback();
+        }
+        if (errors::IsUnimplemented(s)) {
+          VLOG(1) << src_worker << " does not implement RecvTensors";
+          {
+            mutex_lock l(batch_mu_);
+            unbatched_workers_.insert(src_worker);
+          }
+          for (PendingRecv& recv : recvs) {
+            recv.call->Start(std::move(recv.recv_done));
+          }
+          delete batch_call;
+          return;
+        }
+        const int num_recvs = recvs.size();
+        if (s.ok() && batch_call->resp.responses_size() != num_recvs) {
+          s = errors::Internal("RecvTensors returned ",
+                               batch_call->resp.responses_size(),
+                               " tensors for ", num_recvs, " requests");
+        }
+        for (int i = 0; i < num_recvs; ++i) {
+          recvs[i].call->FinishBatched(
+              s, s.ok() ? batch_call->resp.mutable_responses(i) : nullptr,
+              std::move(recvs[i].recv_done));
+        }
+        delete batch_call;
+      });
+
+  // As in RpcRecvTensorCall::StartRTCall(), recvs aborted before their cancel
+  // callback was set cancel the RPC here.
+  for (const PendingRecv& recv : batch_call->recvs) {
+    if (!recv.call->status().ok()) {
+      batch_opts->StartCancel();
+      break;
+    }
+  }
+  abort_checked->Notify();
+}
+
+}  // namespace
+
+namespace {
+int64_t RecvBatchWindowMicros() {
+  int64_t window_micros;
+  Status s = ReadInt64FromEnvVar("TF_RPC_RECV_TENSOR_BATCH_WINDOW_MICROS",
+                                 /*default_val=*/0, &window_micros);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return 0;
+  }
+  return window_micros;
+}
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : BaseRendezvousMgr(env),
+      recv_batch_window_micros_(RecvBatchWindowMicros()) {}
 
 BaseRemoteRendezvous* RpcRendezvousMgr::Create(int64_t step_id,
                                                const WorkerEnv* worker_env) {
-  return new RpcRemoteRendezvous(worker_env, step_id);
+  return new RpcRemoteRendezvous(worker_env, step_id,
+                                 recv_batch_window_micros_);
 }
 
 }  // end namespace tensorflow
@@ -42,6 +42,11 @@ class DeviceMgr;
 //
 // Tensors sent and recved through rendezvous managed by this
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
+//
+// If TF_RPC_RECV_TENSOR_BATCH_WINDOW_MICROS is set to a positive value, the
+// recvs from the same remote worker that start within that many microseconds
+// of each other are sent in one RecvTensors RPC, instead of one RecvTensor RPC
+// each.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
   explicit RpcRendezvousMgr(const WorkerEnv* env);
@@ -50,6 +55,8 @@ class RpcRendezvousMgr : public BaseRendezvousMgr {
   BaseRemoteRendezvous* Create(int64_t step_id, const WorkerEnv* worker_env);
 
  private:
+  const int64_t recv_batch_window_micros_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRendezvousMgr);
 };
 
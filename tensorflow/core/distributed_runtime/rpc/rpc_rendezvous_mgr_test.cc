@@ -16,12 +16,16 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
 #include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/control_flow.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
@@ -52,11 +56,20 @@ Rendezvous::ParsedKey MakeKey(const string& s) {
 
 namespace {
 // A dummy worker interface implementation that simply triggers the callback
-// with OK status for RecvTensor request.
+// with OK status for RecvTensor request. If the request allows it, the
+// response carries the transport options of a float tensor of shape {4}.
+// RecvTensors responds with the size of the batch for each tensor.
 class DummyWorker : public TestWorkerInterface {
  public:
   void RecvTensorAsync(CallOptions* opts, const RecvTensorRequest* request,
                        TensorResponse* response, StatusCallback done) override {
+    if (request->dma_ok()) {
+      RecvTensorResponse meta;
+      meta.mutable_tensor()->set_dtype(DT_FLOAT);
+      TensorShape({4}).AsProto(meta.mutable_tensor()->mutable_tensor_shape());
+      meta.mutable_transport_options()->set_value("42");
+      response->InitPartial(meta, AllocationAttributes());
+    }
     SchedClosure([done = std::move(done)]() {
       // Simulate a random delay for RPC. This is needed to fill the entire
       // object buffer in `RpcRecvTensorFreeList` and trigger the destruction of
@@ -66,6 +79,17 @@ class DummyWorker : public TestWorkerInterface {
       done(OkStatus());
     });
   }
+
+  void RecvTensorsAsync(CallOptions* opts, const RecvTensorsRequest* request,
+                        RecvTensorsResponse* response,
+                        StatusCallback done) override {
+    const float num_tensors = request->requests_size();
+    for (int i = 0; i < request->requests_size(); ++i) {
+      test::AsScalar<float>(num_tensors).AsProtoTensorContent(
+          response->add_responses()->mutable_tensor());
+    }
+    SchedClosure([done = std::move(done)]() { done(OkStatus()); });
+  }
 };
 
 // Fake cache implementation for WorkerEnv.
@@ -104,7 +128,9 @@ static Device* CreateDevice(const char* type, const char* name) {
    public:
     explicit FakeDevice(const DeviceAttributes& attr) : Device(nullptr, attr) {}
     Status Sync() override { return OkStatus(); }
-    Allocator* GetAllocator(AllocatorAttributes) override { return nullptr; }
+    Allocator* GetAllocator(AllocatorAttributes) override {
+      return cpu_allocator();
+    }
   };
   DeviceAttributes attr;
   attr.set_name(name);
@@ -310,6 +336,92 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvOne) {
   rmgr_.Cleanup(step_id);
 }
 
+// Fills the received tensors with the value in the transport options.
+class FakeTensorTransport : public TensorTransport {
+ public:
+  Status TransportOptionsFromTensor(
+      const Tensor& tensor,
+      ::google::protobuf::Any* transport_options) override {
+    return errors::Unimplemented("Only receives");
+  }
+
+  void TensorFromTransportOptions(
+      const ::google::protobuf::Any& transport_options, Device* device,
+      bool on_host, Tensor* tensor, StatusCallback done) override {
+    float value;
+    CHECK(strings::safe_strtof(transport_options.value(), &value));
+    tensor->flat<float>().setConstant(value);
+    done(OkStatus());
+  }
+};
+
+TEST_F(RpcRendezvousMgrTest, RemoteRecvOutOfBand) {
+  SetTensorTransport(std::make_unique<FakeTensorTransport>());
+  const int64_t step_id = 123;
+  const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+      "/job:worker/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "foo", FrameAndIter(0, 0)));
+  {
+    RemoteRendezvous* rendez = rmgr_.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    core::ScopedUnref unref(rendez);
+    Rendezvous::Args args;
+
+    Tensor val;
+    bool val_dead = false;
+    TF_ASSERT_OK(rendez->Recv(key, args, &val, &val_dead));
+    EXPECT_FALSE(val_dead);
+    test::ExpectTensorEqual<float>(val,
+                                   test::AsTensor<float>({42, 42, 42, 42}));
+  }
+  rmgr_.Cleanup(step_id);
+  SetTensorTransport(nullptr);
+}
+
+TEST_F(RpcRendezvousMgrTest, RemoteRecvBatched) {
+  setenv("TF_RPC_RECV_TENSOR_BATCH_WINDOW_MICROS", "100000", 1);
+  RpcRendezvousMgr rmgr(&env);
+  unsetenv("TF_RPC_RECV_TENSOR_BATCH_WINDOW_MICROS");
+  const int64_t step_id = 123;
+  const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
+      "/job:worker/replica:1/task:2/cpu:0", 7890,
+      "/job:mnist/replica:1/task:2/cpu:1", "foo", FrameAndIter(0, 0)));
+  {
+    RemoteRendezvous* rendez = rmgr.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    core::ScopedUnref unref(rendez);
+    Rendezvous::Args args;
+
+    // The recvs start within the batching window, so they are sent in one
+    // RecvTensors RPC.
+    const int num_requests = 3;
+    mutex mu;
+    Status status = OkStatus();
+    std::vector<Tensor> vals;
+    BlockingCounter counter(num_requests);
+    for (int i = 0; i < num_requests; i++) {
+      rendez->RecvAsync(key, args,
+                        [&mu, &status, &vals, &counter](
+                            const Status& s, const Rendezvous::Args&,
+                            const Rendezvous::Args&, const Tensor& val,
+                            const bool) {
+                          {
+                            mutex_lock l(mu);
+                            status.Update(s);
+                            vals.push_back(val);
+                          }
+                          counter.DecrementCount();
+                        });
+    }
+    counter.Wait();
+    TF_ASSERT_OK(status);
+    for (const Tensor& val : vals) {
+      test::ExpectTensorEqual<float>(val, test::AsScalar<float>(num_requests));
+    }
+  }
+  rmgr.Cleanup(step_id);
+}
+
 TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   const int64_t step_id = 123;
   const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
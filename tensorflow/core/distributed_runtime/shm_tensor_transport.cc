@@ -0,0 +1,249 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shm_tensor_transport.h"
+
+#include "tensorflow/core/platform/platform.h"
+
+#if !defined(PLATFORM_WINDOWS)
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <deque>
+#include <string>
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+#endif  // !defined(PLATFORM_WINDOWS)
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+#if !defined(PLATFORM_WINDOWS)
+namespace {
+
+// A receiver unlinks the shared memory objects it reads. The ones left after
+// this long were abandoned, e.g. by a receiver that failed, and are unlinked
+// by the sender.
+constexpr int64_t kUnreadTimeoutMicros = 60 * 1000 * 1000;
+
+// Returns an identifier of this host, which processes in other containers or
+// on other hosts with the same name do not share.
+string HostId() {
+  string host_id = port::Hostname();
+  string boot_id;
+  if (ReadFileToString(Env::Default(), "/proc/sys/kernel/random/boot_id",
+                       &boot_id)
+          .ok()) {
+    absl::StrAppend(&host_id, "/", absl::StripAsciiWhitespace(boot_id));
+  }
+  return host_id;
+}
+
+Status ShmError(const char* op, const string& name) {
+  return errors::Internal(op, " of shared memory object ", name,
+                          " failed: ", strerror(errno));
+}
+
+Status WriteContent(int fd, const string& name, StringPiece content) {
+  if (ftruncate(fd, content.size()) != 0) return ShmError("ftruncate", name);
+  if (content.empty()) return OkStatus();
+  void* addr =
+      mmap(nullptr, content.size(), PROT_WRITE, MAP_SHARED, fd, /*offset=*/0);
+  if (addr == MAP_FAILED) return ShmError("mmap", name);
+  memcpy(addr, content.data(), content.size());
+  munmap(addr, content.size());
+  return OkStatus();
+}
+
+// Reads the shared memory object `name` into the host memory of `tensor` and
+// unlinks it.
+Status ReadContent(const string& name, Tensor* tensor) {
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) return ShmError("shm_open", name);
+  shm_unlink(name.c_str());
+  Status status;
+  struct stat st;
+  const size_t size = tensor->TotalBytes();
+  if (fstat(fd, &st) != 0) {
+    status = ShmError("fstat", name);
+  } else if (static_cast<size_t>(st.st_size) != size) {
+    status = errors::Internal("Shared memory object ", name, " has ",
+                              st.st_size, " bytes, expected ", size);
+  } else if (size > 0) {
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, /*offset=*/0);
+    if (addr == MAP_FAILED) {
+      status = ShmError("mmap", name);
+    } else {
+      memcpy(DMAHelper::base(tensor), addr, size);
+      munmap(addr, size);
+    }
+  }
+  close(fd);
+  return status;
+}
+
+class ShmTensorTransport : public TensorTransport {
+ public:
+  ShmTensorTransport() : host_id_(HostId()) {}
+
+  ~ShmTensorTransport() override {
+    mutex_lock l(mu_);
+    for (const auto& unread : unread_) shm_unlink(unread.first.c_str());
+  }
+
+  void RequestOptions(::google::protobuf::Any* request_options) const override {
+    ShmTransportOptions options;
+    options.set_host_id(host_id_);
+    request_options->PackFrom(options);
+  }
+
+  bool CanSendTo(
+      const ::google::protobuf::Any& request_options) const override {
+    ShmTransportOptions options;
+    return request_options.UnpackTo(&options) &&
+           options.host_id() == host_id_;
+  }
+
+  Status TransportOptionsFromTensor(
+      const Tensor& tensor,
+      ::google::protobuf::Any* transport_options) override {
+    const string name =
+        absl::StrCat("/tf_", getpid(), "_", next_id_.fetch_add(1));
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return ShmError("shm_open", name);
+    const StringPiece content = tensor.tensor_data();
+    Status status = WriteContent(fd, name, content);
+    close(fd);
+    if (!status.ok()) {
+      shm_unlink(name.c_str());
+      return status;
+    }
+    RecordUnread(name);
+    ShmTransportOptions options;
+    options.set_host_id(host_id_);
+    options.set_name(name);
+    options.set_size(content.size());
+    transport_options->PackFrom(options);
+    return OkStatus();
+  }
+
+  void TensorFromTransportOptions(
+      const ::google::protobuf::Any& transport_options, Device* device,
+      bool on_host, Tensor* tensor, StatusCallback done) override {
+    ShmTransportOptions options;
+    if (!transport_options.UnpackTo(&options)) {
+      done(errors::InvalidArgument("Expected ShmTransportOptions, got ",
+                                   transport_options.type_url()));
+      return;
+    }
+    if (options.size() != tensor->TotalBytes()) {
+      done(errors::Internal("Received ", options.size(), " bytes for a ",
+                            tensor->TotalBytes(), " byte tensor"));
+      return;
+    }
+    if (on_host) {
+      done(ReadContent(options.name(), tensor));
+      return;
+    }
+    const DeviceBase::AcceleratorDeviceInfo* device_info =
+        device->tensorflow_accelerator_device_info();
+    if (device_info == nullptr || device_info->default_context == nullptr) {
+      done(errors::Internal("Cannot copy a received tensor to device ",
+                            device->name()));
+      return;
+    }
+    AllocatorAttributes host_attrs;
+    host_attrs.set_on_host(true);
+    host_attrs.set_gpu_compatible(true);
+    auto* host_tensor = new Tensor(device->GetAllocator(host_attrs),
+                                   tensor->dtype(), tensor->shape());
+    Status status = ReadContent(options.name(), host_tensor);
+    if (!status.ok()) {
+      delete host_tensor;
+      done(status);
+      return;
+    }
+    device_info->default_context->CopyCPUTensorToDevice(
+        host_tensor, device, tensor,
+        [host_tensor, done = std::move(done)](const Status& s) {
+          delete host_tensor;
+          done(s);
+        });
+  }
+
+ private:
+  void RecordUnread(const string& name) TF_LOCKS_EXCLUDED(mu_) {
+    const int64_t now_micros = Env::Default()->NowMicros();
+    mutex_lock l(mu_);
+    while (!unread_.empty() &&
+           unread_.front().second + kUnreadTimeoutMicros < now_micros) {
+      // Fails harmlessly for the objects the receiver already unlinked.
+      shm_unlink(unread_.front().first.c_str());
+      unread_.pop_front();
+    }
+    unread_.emplace_back(name, now_micros);
+  }
+
+  const string host_id_;
+  std::atomic<int64_t> next_id_{0};
+  mutex mu_;
+  // Names of the objects written, with the time they were written.
+  std::deque<std::pair<string, int64_t>> unread_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
+
+std::unique_ptr<TensorTransport> NewShmTensorTransport() {
+  return std::make_unique<ShmTensorTransport>();
+}
+
+#else  // defined(PLATFORM_WINDOWS)
+
+std::unique_ptr<TensorTransport> NewShmTensorTransport() { return nullptr; }
+
+#endif  // !defined(PLATFORM_WINDOWS)
+
+void MaybeRegisterShmTensorTransport() {
+  bool use_shm = false;
+  TF_CHECK_OK(
+      ReadBoolFromEnvVar("TF_RPC_SHM_TENSOR_TRANSPORT", false, &use_shm));
+  if (!use_shm || GetTensorTransport() != nullptr) return;
+  std::unique_ptr<TensorTransport> transport = NewShmTensorTransport();
+  if (transport == nullptr) {
+    LOG(WARNING) << "Shared memory tensor transport is not supported on this "
+                    "platform";
+    return;
+  }
+  VLOG(1) << "Using the shared memory tensor transport";
+  SetTensorTransport(std::move(transport));
+}
+
+}  // namespace tensorflow
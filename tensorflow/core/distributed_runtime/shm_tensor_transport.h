@@ -0,0 +1,42 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHM_TENSOR_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHM_TENSOR_TRANSPORT_H_
+
+#include <memory>
+
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
+
+namespace tensorflow {
+
+// Returns a TensorTransport that passes the content of large tensors between
+// the worker processes of one host, e.g. one per GPU, through POSIX shared
+// memory instead of loopback gRPC. Receivers send the identity of their host
+// with each request, and tensors for other hosts are sent over the RPC.
+//
+// The sender writes each tensor to a new shared memory object, which the
+// receiver unlinks when it read it. Device tensors are staged in host memory
+// on both sides. Returns nullptr where POSIX shared memory is not available.
+std::unique_ptr<TensorTransport> NewShmTensorTransport();
+
+// Registers the shared memory transport if TF_RPC_SHM_TENSOR_TRANSPORT is
+// true and no other transport is registered. The variable must be set alike in
+// all the processes of a job.
+void MaybeRegisterShmTensorTransport();
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_SHM_TENSOR_TRANSPORT_H_
@@ -0,0 +1,82 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/shm_tensor_transport.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/transport_options.pb.h"
+
+namespace tensorflow {
+namespace {
+
+Status Receive(TensorTransport* transport,
+               const ::google::protobuf::Any& transport_options,
+               Tensor* tensor) {
+  Status status;
+  transport->TensorFromTransportOptions(
+      transport_options, /*device=*/nullptr, /*on_host=*/true, tensor,
+      [&status](const Status& s) { status = s; });
+  return status;
+}
+
+TEST(ShmTensorTransportTest, SendsToSameHost) {
+  std::unique_ptr<TensorTransport> transport = NewShmTensorTransport();
+  ASSERT_NE(transport, nullptr);
+  ::google::protobuf::Any request_options;
+  transport->RequestOptions(&request_options);
+  EXPECT_TRUE(transport->CanSendTo(request_options));
+
+  ShmTransportOptions other_host;
+  other_host.set_host_id("other_host");
+  request_options.PackFrom(other_host);
+  EXPECT_FALSE(transport->CanSendTo(request_options));
+  EXPECT_FALSE(transport->CanSendTo(::google::protobuf::Any()));
+}
+
+TEST(ShmTensorTransportTest, RoundTrip) {
+  std::unique_ptr<TensorTransport> transport = NewShmTensorTransport();
+  ASSERT_NE(transport, nullptr);
+  Tensor sent(DT_FLOAT, TensorShape({64, 1024}));
+  test::FillIota<float>(&sent, 1.0f);
+  ::google::protobuf::Any transport_options;
+  TF_ASSERT_OK(
+      transport->TransportOptionsFromTensor(sent, &transport_options));
+
+  Tensor received(DT_FLOAT, sent.shape());
+  TF_ASSERT_OK(Receive(transport.get(), transport_options, &received));
+  test::ExpectTensorEqual<float>(sent, received);
+
+  // The receiver unlinked the content.
+  EXPECT_FALSE(Receive(transport.get(), transport_options, &received).ok());
+}
+
+TEST(ShmTensorTransportTest, SizeMismatch) {
+  std::unique_ptr<TensorTransport> transport = NewShmTensorTransport();
+  ASSERT_NE(transport, nullptr);
+  Tensor sent(DT_FLOAT, TensorShape({16}));
+  test::FillIota<float>(&sent, 1.0f);
+  ::google::protobuf::Any transport_options;
+  TF_ASSERT_OK(
+      transport->TransportOptionsFromTensor(sent, &transport_options));
+
+  Tensor received(DT_FLOAT, TensorShape({8}));
+  EXPECT_FALSE(Receive(transport.get(), transport_options, &received).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
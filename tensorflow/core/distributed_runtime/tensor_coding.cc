@@ -141,10 +141,33 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
   return input->DecrementRecursionDepthAndPopLimit(p.first);
 }
 
+// Tensor contents smaller than this are copied out of the received data, as
+// sharing it saves little.
+constexpr int kMinAliasedTensorBytes = 64 << 10;
+
 }  // namespace
 
+// Returns a buffer that aliases the next `num_bytes` bytes of `input`, or
+// nullptr if they have to be copied.
+TensorBuffer* TensorResponse::AliasTensorContent(
+    Source* source, protobuf::io::CodedInputStream* input, int num_bytes) {
+  // Memory that the tensor may be DMA'd from is left to allocator_.
+  if (num_bytes < kMinAliasedTensorBytes || alloc_attrs_.gpu_compatible()) {
+    return nullptr;
+  }
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes ||
+      reinterpret_cast<uintptr_t>(data) % Allocator::kAllocatorAlignment !=
+          0) {
+    return nullptr;
+  }
+  return source->AliasBuffer(static_cast<const char*>(data), num_bytes);
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -195,12 +218,21 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
+        if (static_cast<size_t>(num_bytes) ==
+            shape.num_elements() * DataTypeSize(tensor_meta->dtype())) {
+          // Large contents that are contiguous and aligned in the received
+          // data are shared with the source instead of copied.
+          TensorBuffer* alias = AliasTensorContent(source, input, num_bytes);
+          if (alias != nullptr) {
+            tensor_ = Tensor(tensor_meta->dtype(), shape,
+                             core::RefCountPtr<TensorBuffer>(alias));
+            if (!input->Skip(num_bytes)) return false;
+            break;
+          }
+        }
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
         if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -233,7 +265,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
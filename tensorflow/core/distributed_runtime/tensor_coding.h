@@ -63,6 +63,14 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a new TensorBuffer that aliases the `num_bytes` bytes at `data`,
+    // which point into the stream last returned by contents(), and keeps them
+    // alive after the stream is gone. Returns nullptr if they can't be shared,
+    // in which case ParseFrom() copies them.
+    virtual TensorBuffer* AliasBuffer(const char* data, size_t num_bytes) {
+      return nullptr;
+    }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -91,8 +99,12 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  TensorBuffer* AliasTensorContent(Source* source,
+                                   protobuf::io::CodedInputStream* input,
+                                   int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
 
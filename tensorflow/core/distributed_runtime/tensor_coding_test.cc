@@ -15,13 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -156,6 +159,89 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+// A source over memory that it shares with the parsed tensors.
+class AliasingSource : public TensorResponse::Source {
+ public:
+  AliasingSource(const char* data, int size) : data_(data), size_(size) {}
+  ~AliasingSource() override { DeleteStream(); }
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    DeleteStream();
+    stream_ = new (&space_) protobuf::io::ArrayInputStream(data_, size_);
+    return stream_;
+  }
+
+  TensorBuffer* AliasBuffer(const char* data, size_t num_bytes) override {
+    ++num_aliased_;
+    return new AliasedBuffer(data, num_bytes);
+  }
+
+  int num_aliased() const { return num_aliased_; }
+
+ private:
+  class AliasedBuffer : public TensorBuffer {
+   public:
+    AliasedBuffer(const char* data, size_t size)
+        : TensorBuffer(const_cast<char*>(data)), size_(size) {}
+    size_t size() const override { return size_; }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {}
+    bool OwnsMemory() const override { return false; }
+
+   private:
+    const size_t size_;
+  };
+
+  void DeleteStream() {
+    if (stream_) {
+      stream_->~ArrayInputStream();
+    }
+  }
+
+  const char* data_;
+  const int size_;
+  protobuf::io::ArrayInputStream* stream_ = nullptr;
+  char space_[sizeof(protobuf::io::ArrayInputStream)];
+  int num_aliased_ = 0;
+};
+
+TEST_F(TensorResponseTest, AliasLargeTensorContent) {
+  DummyDevice cpu_device(Env::Default());
+  for (const int num_elems : {16, 1 << 15}) {
+    Tensor src(DT_FLOAT, TensorShape({num_elems}));
+    src.flat<float>().setConstant(3.0f);
+    RecvTensorResponse proto;
+    src.AsProtoTensorContent(proto.mutable_tensor());
+    string encoded;
+    proto.AppendToString(&encoded);
+
+    // Lay out the encoded response so that the tensor content is aligned.
+    const size_t content_offset = encoded.find(src.tensor_data());
+    ASSERT_NE(content_offset, string::npos);
+    const size_t padding =
+        (Allocator::kAllocatorAlignment -
+         content_offset % Allocator::kAllocatorAlignment) %
+        Allocator::kAllocatorAlignment;
+    char* storage = static_cast<char*>(port::AlignedMalloc(
+        padding + encoded.size(), Allocator::kAllocatorAlignment));
+    memcpy(storage + padding, encoded.data(), encoded.size());
+
+    AliasingSource source(storage + padding, encoded.size());
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    test::ExpectTensorEqual<float>(response.tensor(), src);
+    const bool aliased = response.tensor().tensor_data().data() ==
+                         storage + padding + content_offset;
+    // Only contents of at least 64KB are shared.
+    EXPECT_EQ(aliased, src.TotalBytes() >= (64 << 10));
+    EXPECT_EQ(source.num_aliased(), aliased ? 1 : 0);
+    response.Clear();
+    port::AlignedFree(storage);
+  }
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -0,0 +1,37 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_transport.h"
+
+#include <utility>
+
+namespace tensorflow {
+
+namespace {
+
+std::unique_ptr<TensorTransport>* GlobalTensorTransport() {
+  static auto* transport = new std::unique_ptr<TensorTransport>();
+  return transport;
+}
+
+}  // namespace
+
+void SetTensorTransport(std::unique_ptr<TensorTransport> transport) {
+  *GlobalTensorTransport() = std::move(transport);
+}
+
+TensorTransport* GetTensorTransport() { return GlobalTensorTransport()->get(); }
+
+}  // namespace tensorflow
@@ -0,0 +1,87 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSPORT_H_
+
+#include <memory>
+
+#include "google/protobuf/any.pb.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+
+namespace tensorflow {
+
+// A transport that moves the content of large tensors received by the
+// RecvTensor RPC out of band, e.g. with RDMA verbs, reading GPU memory
+// directly with GPUDirect where available. The RPC then only carries the
+// metadata of the tensor and the transport options, e.g. the address and key
+// of the memory region the receiver reads the content from.
+//
+// A transport is registered in both the sending and the receiving processes
+// with SetTensorTransport(), e.g. by the ServerFactory of a "grpc+verbs"
+// protocol. Receivers then set RecvTensorRequest.dma_ok, and senders answer
+// with RecvTensorResponse.transport_options instead of the content for the
+// tensors of at least min_bytes() bytes.
+class TensorTransport {
+ public:
+  virtual ~TensorTransport() = default;
+
+  // Tensors smaller than this are sent over the RPC.
+  virtual int64_t min_bytes() const { return 64 * 1024; }
+
+  // Whether the transport reads tensors in device memory, e.g. with
+  // GPUDirect. Otherwise, the sender first copies them to host memory.
+  virtual bool supports_device_memory() const { return false; }
+
+  // Called by the receiver. Fills the RecvTensorRequest.transport_options
+  // that the sender passes to CanSendTo(), e.g. with the host of the receiver.
+  virtual void RequestOptions(::google::protobuf::Any* request_options) const {}
+
+  // Called by the sender. Returns whether the receiver that sent
+  // `request_options` can read the tensors sent out of band; otherwise they
+  // are sent over the RPC.
+  virtual bool CanSendTo(const ::google::protobuf::Any& request_options) const {
+    return true;
+  }
+
+  // Called by the sender. Fills `transport_options` with what the receiver
+  // needs to read the content of `tensor`, which the transport keeps alive
+  // until it was read. An error fails the RecvTensor call.
+  virtual Status TransportOptionsFromTensor(
+      const Tensor& tensor, ::google::protobuf::Any* transport_options) = 0;
+
+  // Called by the receiver. Reads the content described by
+  // `transport_options` into the buffer of `tensor`, which is allocated for
+  // `device` with the dtype and shape of the sent tensor, in host memory if
+  // `on_host`, then calls `done`. `tensor` stays valid until `done` is called.
+  virtual void TensorFromTransportOptions(
+      const ::google::protobuf::Any& transport_options, Device* device,
+      bool on_host, Tensor* tensor, StatusCallback done) = 0;
+};
+
+// Registers the transport used by the RecvTensor calls of this process, or
+// unregisters it if `transport` is nullptr. Must not be called while tensors
+// are being received.
+void SetTensorTransport(std::unique_ptr<TensorTransport> transport);
+
+// Returns the registered transport, or nullptr if tensors are sent over the
+// RPC.
+TensorTransport* GetTensorTransport();
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_TRANSPORT_H_
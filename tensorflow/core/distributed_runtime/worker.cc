@@ -90,6 +90,12 @@ void Worker::RegisterGraphAsync(const RegisterGraphRequest* request,
         request->config_proto(), request->collective_graph_key(), session.get(),
         session->cluster_flr(), response->mutable_graph_handle());
   }
+  if (s.ok() && request->recv_key_size() > 0) {
+    s = session->graph_mgr()->SetRecvKeys(
+        response->graph_handle(),
+        {request->recv_key().begin(), request->recv_key().end()});
+    response->set_recv_keys_registered(s.ok());
+  }
   done(s);
 }
 
@@ -126,7 +132,7 @@ void Worker::AbortStep(int64_t step_id) {
 }
 
 Status Worker::PrepareRunGraph(RunGraphRequestWrapper* req,
-                               GraphMgr::NamedTensors* in,
+                               GraphMgr* graph_mgr, GraphMgr::NamedTensors* in,
                                GraphMgr::NamedTensors* out) {
   static Tensor empty_tensor(DT_FLOAT);
   if (req->num_sends() > 0) {
@@ -139,6 +145,10 @@ Status Worker::PrepareRunGraph(RunGraphRequestWrapper* req,
   for (size_t i = 0; i < req->num_recvs(); ++i) {
     out->insert({req->recv_key(i), empty_tensor});
   }
+  if (req->recv_registered_keys()) {
+    TF_RETURN_IF_ERROR(
+        graph_mgr->AddRecvKeys(req->graph_handle(), empty_tensor, out));
+  }
   return OkStatus();
 }
 
@@ -191,7 +201,7 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
   }
   GraphMgr::NamedTensors in;
   GraphMgr::NamedTensors* out = new GraphMgr::NamedTensors;
-  s = PrepareRunGraph(request, &in, out);
+  s = PrepareRunGraph(request, session->graph_mgr(), &in, out);
   if (!s.ok()) {
     delete out;
     done(s);
@@ -291,7 +301,7 @@ void Worker::DoPartialRunGraph(CallOptions* opts,
 
   GraphMgr::NamedTensors in;
   GraphMgr::NamedTensors* out = new GraphMgr::NamedTensors;
-  s = PrepareRunGraph(request, &in, out);
+  s = PrepareRunGraph(request, session->graph_mgr(), &in, out);
   auto finish = [done, out, opts](const Status& s) {
     opts->ClearCancelCallback();
     delete out;
@@ -101,6 +101,10 @@ string CollInstanceParams::ToString() const {
                       " shape=", shape.DebugString(), " devices {");
   strings::StrAppend(&v, "}, collective_name=", impl_details.collective_name,
                      ", subdiv_offsets={");
+  if (impl_details.wire_dtype != DT_INVALID) {
+    strings::StrAppend(&v, " wire_dtype=",
+                       DataTypeString(impl_details.wire_dtype));
+  }
   strings::StrAppend(&v, "}, subdiv_offsets={");
   for (const auto& d : impl_details.subdiv_offsets) {
     strings::StrAppend(&v, d, ",");
@@ -115,6 +115,9 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // If not DT_INVALID, the type in which a reduction sends its data, e.g.
+  // DT_BFLOAT16 to halve the bytes on the wire of a DT_FLOAT reduction.
+  DataType wire_dtype = DT_INVALID;
 };
 
 // Data common to all members of a collective instance.
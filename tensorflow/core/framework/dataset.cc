@@ -681,6 +681,13 @@ Status DatasetBase::Get(OpKernelContext* ctx, int64 index,
       "Random access is not implemented for this dataset.");
 }
 
+Status DatasetBase::Get(IteratorContext* ctx, int64 index,
+                        std::vector<Tensor>* out_tensors) const {
+  return errors::Unimplemented("Random access from an iterator is not "
+                               "implemented for dataset of type ",
+                               DebugString(), ".");
+}
+
 StatusOr<DatasetBase*> DatasetBase::Finalize(
     OpKernelContext* ctx,
     std::function<StatusOr<core::RefCountPtr<DatasetBase>>()>
@@ -935,6 +942,7 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
                              profiler::TraceMeLevel::kInfo);
   DVLOG(3) << prefix() << " GetNext enter";
   auto model = ctx->model();
+  int64_t start_nanos = 0;
   if (collect_resource_usage(ctx)) {
     int64_t now_nanos = EnvTime::NowNanos();
     auto output = node_->output();
@@ -942,6 +950,7 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
       output->record_stop(now_nanos);
     }
     node_->record_start(now_nanos);
+    start_nanos = now_nanos;
   }
   out_tensors->clear();
   Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
@@ -963,6 +972,7 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
   if (collect_resource_usage(ctx)) {
     int64_t now_nanos = EnvTime::NowNanos();
     node_->record_stop(now_nanos);
+    node_->record_latency(now_nanos - start_nanos);
     auto output = node_->output();
     if (output) {
       output->record_start(now_nanos);
@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -151,6 +152,20 @@ class Device : public DeviceBase {
     return OkStatus();
   }
 
+  // Fills in `device_context_map` with a DeviceContext* for executing each
+  // node of `graph`, indexed by node id, for devices that run different nodes
+  // of a graph in different contexts (e.g. on different streams). Leaves the
+  // map empty if every node should use the context returned by
+  // TryGetDeviceContext(). Entries may be nullptr for nodes that should use
+  // that context.
+  //
+  // The caller takes ownership of one reference on each non-null entry, and
+  // should call Unref().
+  virtual Status FillContextMap(const Graph* graph,
+                                std::vector<DeviceContext*>* device_context_map) {
+    return OkStatus();
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
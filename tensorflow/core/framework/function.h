@@ -885,6 +885,14 @@ class FunctionLibraryRuntime {
     // If not null, use this thread pool for intra op scheduling.
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
 
+    // If not null, indexed by retval number: allocators for the outputs that
+    // become the retvals, which lets the caller have retvals written directly
+    // into memory it owns, e.g. a slice of a batch. Null entries use the
+    // default allocator, and producers that cannot use the allocator simply
+    // get their memory elsewhere. Not owned. Ignored by multi-device
+    // functions.
+    const std::vector<Allocator*>* retval_allocators = nullptr;
+
     // Returns a human readable representation of this.
     std::string DebugString() const;
   };
@@ -0,0 +1,62 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_LATENCY_BREAKDOWN_H_
+#define TENSORFLOW_CORE_FRAMEWORK_LATENCY_BREAKDOWN_H_
+
+#include <atomic>
+#include <cstdint>
+
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+
+// Accumulates where the time of one request (e.g. one Session::Run call) is
+// spent. It is created by the session when
+// RunOptions.Experimental.collect_latency_breakdown is set, and passed to the
+// executors and the kernels of the request through Executor::Args and
+// OpKernelContext::latency_breakdown().
+//
+// Thread-safe: kernels running concurrently add to the same collector.
+class LatencyBreakdownCollector {
+ public:
+  void AddExecutorUsecs(int64_t usecs) { Add(usecs, &executor_usecs_); }
+  void AddQueueWaitUsecs(int64_t usecs) { Add(usecs, &queue_wait_usecs_); }
+  void AddKernelUsecs(int64_t usecs) { Add(usecs, &kernel_usecs_); }
+  void AddRecvWaitUsecs(int64_t usecs) { Add(usecs, &recv_wait_usecs_); }
+
+  void ToProto(RunMetadata::LatencyBreakdown* proto) const {
+    proto->set_executor_usecs(executor_usecs_.load(std::memory_order_relaxed));
+    proto->set_queue_wait_usecs(
+        queue_wait_usecs_.load(std::memory_order_relaxed));
+    proto->set_kernel_usecs(kernel_usecs_.load(std::memory_order_relaxed));
+    proto->set_recv_wait_usecs(
+        recv_wait_usecs_.load(std::memory_order_relaxed));
+  }
+
+ private:
+  static void Add(int64_t usecs, std::atomic<int64_t>* total) {
+    if (usecs > 0) total->fetch_add(usecs, std::memory_order_relaxed);
+  }
+
+  std::atomic<int64_t> executor_usecs_{0};
+  std::atomic<int64_t> queue_wait_usecs_{0};
+  std::atomic<int64_t> kernel_usecs_{0};
+  std::atomic<int64_t> recv_wait_usecs_{0};
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_LATENCY_BREAKDOWN_H_
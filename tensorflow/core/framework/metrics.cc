@@ -43,12 +43,42 @@ auto* graph_run_time_usecs_histogram = tsl::monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 20 (> 17 minutes)
     {tsl::monitoring::Buckets::Exponential(1000, 2, 20)});
 
+auto* latency_breakdown_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/latency_breakdown_usecs",
+     "Where the time of the calls that request a latency breakdown is spent, "
+     "in microseconds.",
+     "component"},
+    // Power of 2 with bucket count 30 (> 17 minutes)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 30)});
+
 auto* graph_pending_queue_length_histogram = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_pending_queue_length_histogram",
      "The number of pending (ready but not running) tasks in graph executor."},
     // Power of 1.5 with bucket count 30 (> 191k)
     {tsl::monitoring::Buckets::Exponential(1, 1.5, 30)});
 
+auto* run_handler_wait_time_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/run_handler/wait_time_usecs",
+     "The time requests wait for a free run handler in microseconds.",
+     "priority"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* run_handler_queueing_delay_usecs = tsl::monitoring::Sampler<1>::New(
+    {"/tensorflow/core/run_handler/queueing_delay_usecs",
+     "The time inter-op closures wait in the run handler queues before they "
+     "start running, in microseconds.",
+     "priority"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
+auto* event_mgr_callback_delay_usecs = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/core/event_mgr/callback_delay_usecs",
+     "The time EventMgr callbacks wait between the detection of their event "
+     "and the start of their execution in microseconds."},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {tsl::monitoring::Buckets::Exponential(1, 2, 24)});
+
 auto* graph_run_input_tensor_bytes = tsl::monitoring::Sampler<0>::New(
     {"/tensorflow/core/graph_run_input_tensor_bytes",
      "The size of input tensors in bytes."},
@@ -65,6 +95,24 @@ auto* graph_unused_outputs = tsl::monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
 
+auto* tensor_list_copies = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/tensor_list_copies",
+    "The number of times an op copied a shared TensorList instead of "
+    "updating it in place.",
+    "name");
+
+auto* resource_variable_copies = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/resource_variable_copies",
+    "The number of times the buffer of a resource variable was copied "
+    "because it was shared by a read and an update.",
+    "reason");
+
+auto* resource_variable_copied_bytes = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/core/resource_variable_copied_bytes",
+    "The number of bytes of resource variables copied because they were "
+    "shared by a read and an update.",
+    "reason");
+
 auto* tf_data_fetch_op_counter = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/fetch_op",
     "The number of times a tf.data operation that fetches output(s) of a "
@@ -181,6 +229,18 @@ auto* tf_data_model_gauge =
     tsl::monitoring::Gauge<std::function<std::string()>, 1>::New(
         "/tensorflow/data/model", "tf.data autotuning model proto.", "id");
 
+auto* tf_data_bottleneck_gauge =
+    tsl::monitoring::Gauge<std::function<std::string()>, 1>::New(
+        "/tensorflow/data/bottleneck",
+        "The node of the tf.data autotuning model with the highest stall "
+        "contribution.",
+        "id");
+
+auto* tf_data_autotune_buffered_bytes_gauge =
+    tsl::monitoring::Gauge<int64_t, 1>::New(
+        "/tensorflow/data/autotune_buffered_bytes",
+        "The number of bytes buffered by autotuned tf.data nodes.", "name");
+
 auto* tf_data_auto_shard = tsl::monitoring::Gauge<int64, 2>::New(
     "/tensorflow/data/autoshard", "tf.data autoshard statistics.", "id",
     "name");
@@ -249,6 +309,16 @@ auto* xla_compilation_time_usecs = tsl::monitoring::Counter<0>::New(
     "/tensorflow/core/xla_compilation_time_usecs",
     "The total time spent on compiling XLA graphs in microseconds.");
 
+auto* xla_recompilations = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_recompilations",
+    "The number of XLA compilations of clusters that were already compiled "
+    "for other input shapes.");
+
+auto* xla_megamorphic_clusters = tsl::monitoring::Counter<0>::New(
+    "/tensorflow/core/xla_megamorphic_clusters",
+    "The number of clusters that are no longer compiled because their input "
+    "shapes change too often.");
+
 auto* xla_tpu_spmd_cores_per_replica = tsl::monitoring::Counter<1>::New(
     "/tensorflow/tpu/xla_spmd_cores_per_replica",
     "The number of cores used by XLA SPMD-replicated models.", "cores");
@@ -314,6 +384,11 @@ tsl::monitoring::GaugeCell<std::function<std::string()>>* GetTFDataModelGauge(
   return tf_data_model_gauge->GetCell(id);
 }
 
+tsl::monitoring::GaugeCell<std::function<std::string()>>*
+GetTFDataBottleneckGauge(const string& id) {
+  return tf_data_bottleneck_gauge->GetCell(id);
+}
+
 void RecordTFDataBytesFetched(int64_t num_bytes) {
   tf_data_bytes_fetched_counter->GetCell()->IncrementBy(num_bytes);
 }
@@ -344,6 +419,10 @@ void RecordTFDataAutotuneMaxBufferBudgetRatio(const double ratio) {
   tf_data_buffered_vs_budget_ratio_histogram_cell->Add(ratio);
 }
 
+void RecordTFDataAutotuneBufferedBytes(const string& name, int64_t num_bytes) {
+  tf_data_autotune_buffered_bytes_gauge->GetCell(name)->Set(num_bytes);
+}
+
 void RecordTFDataIteratorBusy(uint64 duration_us) {
   static auto* tf_data_iterator_busy_cell =
       tf_data_iterator_busy_counter->GetCell();
@@ -485,12 +564,40 @@ void UpdateGraphExecTime(const uint64 running_time_usecs) {
   }
 }
 
+void UpdateLatencyBreakdown(int64_t executor_usecs, int64_t queue_wait_usecs,
+                            int64_t kernel_usecs, int64_t recv_wait_usecs) {
+  static auto* executor_cell = latency_breakdown_usecs->GetCell("executor");
+  static auto* queue_wait_cell =
+      latency_breakdown_usecs->GetCell("queue_wait");
+  static auto* kernel_cell = latency_breakdown_usecs->GetCell("kernel");
+  static auto* recv_wait_cell = latency_breakdown_usecs->GetCell("recv_wait");
+  executor_cell->Add(executor_usecs);
+  queue_wait_cell->Add(queue_wait_usecs);
+  kernel_cell->Add(kernel_usecs);
+  recv_wait_cell->Add(recv_wait_usecs);
+}
+
 void UpdateGraphPendingQueueLength(uint64 len) {
   static auto* graph_pending_queue_length_cell =
       graph_pending_queue_length_histogram->GetCell();
   graph_pending_queue_length_cell->Add(len);
 }
 
+tsl::monitoring::SamplerCell* GetRunHandlerWaitTimeCell(int64_t priority) {
+  return run_handler_wait_time_usecs->GetCell(absl::StrCat(priority));
+}
+
+tsl::monitoring::SamplerCell* GetRunHandlerQueueingDelayCell(
+    int64_t priority) {
+  return run_handler_queueing_delay_usecs->GetCell(absl::StrCat(priority));
+}
+
+void UpdateEventMgrCallbackDelay(uint64 delay_usecs) {
+  static auto* event_mgr_callback_delay_cell =
+      event_mgr_callback_delay_usecs->GetCell();
+  event_mgr_callback_delay_cell->Add(delay_usecs);
+}
+
 void UpdateGraphBuildTime(const uint64 running_time_usecs) {
   if (running_time_usecs > 0) {
     static auto* build_graph_calls_cell = build_graph_calls->GetCell();
@@ -527,10 +634,30 @@ void UpdateXlaCompilationTime(const uint64 compilation_time_usecs) {
   }
 }
 
+void RecordXlaRecompilation() {
+  static auto* xla_recompilations_cell = xla_recompilations->GetCell();
+  xla_recompilations_cell->IncrementBy(1);
+}
+
+void RecordXlaMegamorphicCluster() {
+  static auto* xla_megamorphic_clusters_cell =
+      xla_megamorphic_clusters->GetCell();
+  xla_megamorphic_clusters_cell->IncrementBy(1);
+}
+
 void RecordUnusedOutput(const string& op_name) {
   graph_unused_outputs->GetCell(op_name)->IncrementBy(1);
 }
 
+void RecordTensorListCopy(const string& op_name) {
+  tensor_list_copies->GetCell(op_name)->IncrementBy(1);
+}
+
+void RecordResourceVariableCopy(const string& reason, int64_t num_bytes) {
+  resource_variable_copies->GetCell(reason)->IncrementBy(1);
+  resource_variable_copied_bytes->GetCell(reason)->IncrementBy(num_bytes);
+}
+
 void IncrementTestCounter(const string& name, const string& label) {
   test_counters->GetCell(name, label)->IncrementBy(1);
 }
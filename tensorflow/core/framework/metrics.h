@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/types.h"
@@ -69,6 +70,13 @@ monitoring::CounterCell* GetTFDataElementsCounter(const string& name);
 monitoring::GaugeCell<std::function<std::string()>>* GetTFDataModelGauge(
     const string& id);
 
+// Returns a gauge than can be used to record the bottleneck of the
+// performance model.
+//
+// The `id` argument represents the (unique) model ID.
+monitoring::GaugeCell<std::function<std::string()>>* GetTFDataBottleneckGauge(
+    const string& id);
+
 // Records the number of bytes fetched from tf.data.Dataset iterator.
 void RecordTFDataBytesFetched(int64_t num_bytes);
 
@@ -87,6 +95,12 @@ void RecordTFDataAutotuneUsedRamBudgetRatio(const double ratio);
 // bytes over the ram budget.
 void RecordTFDataAutotuneMaxBufferBudgetRatio(const double ratio);
 
+// Records the number of bytes buffered by the autotuned tf.data nodes of the
+// process.
+//
+// The `name` argument identifies the Dataset type (e.g. "ParallelMapV2").
+void RecordTFDataAutotuneBufferedBytes(const string& name, int64_t num_bytes);
+
 // Records the number of times each tf.data fingerprint is used
 // to measure duplicate pre-processing.
 //
@@ -174,11 +188,42 @@ void RecordGraphOutputTensors(const size_t size);
 void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 
 void UpdateGraphExecTime(const uint64 running_time_usecs);
+
+// Records the latency breakdown of a call that requested one through
+// RunOptions.Experimental.collect_latency_breakdown, in microseconds. See
+// RunMetadata.LatencyBreakdown.
+void UpdateLatencyBreakdown(int64_t executor_usecs, int64_t queue_wait_usecs,
+                            int64_t kernel_usecs, int64_t recv_wait_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Returns a sampler cell that records how long requests with the given
+// priority wait in `RunHandlerPool::Get()` for a free run handler, in
+// microseconds.
+monitoring::SamplerCell* GetRunHandlerWaitTimeCell(int64_t priority);
+
+// Returns a sampler cell that records how long inter-op closures of requests
+// with the given priority wait in the run handler queues before they start
+// running, in microseconds.
+monitoring::SamplerCell* GetRunHandlerQueueingDelayCell(int64_t priority);
+
+// Records how long an EventMgr callback waited between the detection of its
+// event and the start of its execution, in microseconds.
+void UpdateEventMgrCallbackDelay(uint64 delay_usecs);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Records that an op of type `op_name` copied the elements of its input
+// TensorList because the list was shared and could not be updated in place.
+void RecordTensorListCopy(const string& op_name);
+
+// Records that the buffer of a resource variable, of `num_bytes`, was copied
+// because it was shared by a read and an update. The `reason` argument is one
+// of "read" (a read of a variable in copy-on-read mode), "update" (a dense
+// update while reads hold the buffer) or "sparse_access" (switching to
+// copy-on-read mode while reads hold the buffer).
+void RecordResourceVariableCopy(const string& reason, int64_t num_bytes);
+
 // Updates the metrics stored about time spent building graphs.
 //
 // By "GraphBuild", we refer to building a client graph, which is a sub-graph of
@@ -315,6 +360,14 @@ void UpdateTpuVariableDistributionTime(const uint64 distribution_time_usecs);
 // Updates the metrics stored about time XLA spents compiling graphs.
 void UpdateXlaCompilationTime(const uint64 compilation_time_usecs);
 
+// Records an XLA compilation of a cluster that was already compiled for other
+// input shapes.
+void RecordXlaRecompilation();
+
+// Records that the JIT stopped compiling a cluster because its input shapes
+// change too often.
+void RecordXlaMegamorphicCluster();
+
 // Increments (by 1) a simple integer counter that is exposed for testing.
 void IncrementTestCounter(const string& name, const string& label);
 
@@ -35,6 +35,7 @@ namespace model {
 
 constexpr int64_t Model::kOptimizationPeriodMinMs;
 constexpr int64_t Model::kOptimizationPeriodMaxMs;
+constexpr int64_t Model::kMeasurementPeriodMs;
 
 namespace {
 
@@ -47,6 +48,21 @@ constexpr uint64_t kGapDurationThresholdUsec = 10000000;  // 10 seconds
 // deviations are considered outliers.
 constexpr double kOutlierSigmas = 2.0;
 
+// The `MEASUREMENT_BASED` optimization measures a configuration for at least
+// this many elements.
+constexpr int64_t kMinMeasuredElements = 10;
+// A configuration replaces the best one if its throughput is higher by at least
+// this fraction, which filters out measurement noise.
+constexpr double kMinThroughputImprovement = 0.03;
+// Every `kRemeasurePeriod`-th step measures the best configuration again.
+constexpr int64_t kRemeasurePeriod = 10;
+// The probability that a step tries a random configuration.
+constexpr double kRandomConfigurationProbability = 0.05;
+// The number of attempts at finding a configuration within the RAM budget.
+constexpr int kMaxConfigurationAttempts = 4;
+// The arm of random configurations.
+constexpr char kRandomArm[] = "random";
+
 // A class to prune outliers given a set of points. To use it, instantiate an
 // object and call the `GetCleanPoints()` method.
 class OutlierPruner {
@@ -1947,6 +1963,8 @@ std::shared_ptr<Node> Node::SnapshotHelper(
       cloned_current->parameters_ = parameters_;
       cloned_current->previous_processing_time_ = previous_processing_time_;
       cloned_current->processing_time_ema_ = processing_time_ema_;
+      cloned_current->num_latency_samples_ = num_latency_samples_;
+      cloned_current->latency_ema_ = latency_ema_;
     }
   }
 
@@ -2112,6 +2130,46 @@ Status Node::FromProto(ModelProto::Node node_proto,
   return FromProtoHelper(node_proto, *node);
 }
 
+MemoryArbiter* MemoryArbiter::Global() {
+  static MemoryArbiter* arbiter = new MemoryArbiter();
+  return arbiter;
+}
+
+int64_t MemoryArbiter::Allowance(const Model* model, int64_t ram_budget) const {
+  double others = 0;
+  {
+    tf_shared_lock l(mu_);
+    for (const auto& pair : usage_) {
+      if (pair.first != model) others += pair.second.max_buffered_bytes;
+    }
+  }
+  return std::max<int64_t>(0, ram_budget - static_cast<int64_t>(others));
+}
+
+void MemoryArbiter::Report(const Model* model, double max_buffered_bytes,
+                           Node::NodeValues buffered_bytes) {
+  mutex_lock l(mu_);
+  Usage& usage = usage_[model];
+  usage.max_buffered_bytes = max_buffered_bytes;
+  usage.buffered_bytes = std::move(buffered_bytes);
+}
+
+void MemoryArbiter::Remove(const Model* model) {
+  mutex_lock l(mu_);
+  usage_.erase(model);
+}
+
+Node::NodeValues MemoryArbiter::BufferedBytesByNodeName() const {
+  Node::NodeValues result;
+  tf_shared_lock l(mu_);
+  for (const auto& pair : usage_) {
+    for (const auto& node : pair.second.buffered_bytes) {
+      result[node.first] += node.second;
+    }
+  }
+  return result;
+}
+
 Model::Model()
     : optimization_period_ms_(kOptimizationPeriodMinMs),
       safe_to_collect_metrics_(std::make_shared<GuardedBool>(true)) {
@@ -2124,9 +2182,19 @@ Model::Model()
         mutex_lock l(my_safe_to_collect_metrics->mu);
         return my_safe_to_collect_metrics->val ? DebugString() : std::string();
       });
+  bottleneck_gauge_cell_ = metrics::GetTFDataBottleneckGauge(
+      strings::StrCat(reinterpret_cast<uint64>(this)));
+  bottleneck_gauge_cell_->Set(
+      [this, my_safe_to_collect_metrics = this->safe_to_collect_metrics_]() {
+        mutex_lock l(my_safe_to_collect_metrics->mu);
+        if (!my_safe_to_collect_metrics->val) return std::string();
+        StatusOr<BottleneckReport> report = ComputeBottleneckReport();
+        return report.ok() ? report->DebugString() : std::string();
+      });
 }
 
 Model::~Model() {
+  MemoryArbiter::Global()->Remove(this);
   mutex_lock l(safe_to_collect_metrics_->mu);
   safe_to_collect_metrics_->val = false;
 }
@@ -2182,10 +2250,13 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
   if (!port::JobName().empty()) {
     RecordAutotuneRamUsage(ram_budget, TotalMaximumBufferedBytes(snapshot));
   }
+  // Leave the memory that the buffers of the other input pipelines may use.
+  const int64_t allowance =
+      MemoryArbiter::Global()->Allowance(this, ram_budget);
   OptimizationParams optimization_params;
   optimization_params.set_algorithm(algorithm);
   optimization_params.set_cpu_budget(cpu_budget);
-  optimization_params.set_ram_budget(ram_budget);
+  optimization_params.set_ram_budget(allowance);
   optimization_params.set_model_input_time(model_input_time);
   switch (algorithm) {
     case AutotuneAlgorithm::DEFAULT:
@@ -2203,6 +2274,9 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     case AutotuneAlgorithm::STAGE_BASED:
       OptimizeStageBased(snapshot, optimization_params, cancellation_manager);
       break;
+    case AutotuneAlgorithm::MEASUREMENT_BASED:
+      OptimizeMeasurementBased(snapshot, optimization_params);
+      break;
     default:
       VLOG(2) << "Autotuning algorithm was not recognized. Aborting "
                  "optimization.";
@@ -2211,6 +2285,12 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
   if (experiment_ == "autotune_buffer_optimization") {
     OptimizeBuffers(snapshot, optimization_params.ram_budget());
   }
+  // The algorithms only stop growing buffers at the budget. When the other
+  // pipelines have grown since, give memory back.
+  if (allowance < ram_budget) {
+    ShrinkBuffers(snapshot, allowance, model_input_time);
+  }
+  ReportMemoryUsage(snapshot);
 }
 
 void Model::RemoveNode(std::shared_ptr<Node> node) {
@@ -2328,8 +2408,13 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm, int64_t cpu_budget,
     // threshold is reached.
     {
       mutex_lock l(mu_);
-      optimization_period_ms_ =
-          std::min(optimization_period_ms_ << 1, kOptimizationPeriodMaxMs);
+      if (algorithm == AutotuneAlgorithm::MEASUREMENT_BASED) {
+        // Every step measures one configuration, so the period stays short.
+        optimization_period_ms_ = kMeasurementPeriodMs;
+      } else {
+        optimization_period_ms_ =
+            std::min(optimization_period_ms_ << 1, kOptimizationPeriodMaxMs);
+      }
     }
     current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     last_optimization_ms = current_time_ms;
@@ -2585,6 +2670,142 @@ void Model::OptimizeStageBasedParallelism(
   UpdateStateValues(&tunable_parameters);
 }
 
+void Model::OptimizeMeasurementBased(
+    std::shared_ptr<Node> snapshot,
+    const OptimizationParams& optimization_params) {
+  ModelParameters parameters = CollectTunableParameters(snapshot);
+  if (parameters.empty()) {
+    VLOG(2) << "There are no tunable parameters.";
+    return;
+  }
+  MeasurementBasedSearch& search = measurement_based_search_;
+  const int64_t now_us = EnvTime::NowMicros();
+  const int64_t num_elements = snapshot->num_elements();
+  if (search.start_time_us == 0 || num_elements < search.start_num_elements) {
+    search.start_time_us = now_us;
+    search.start_num_elements = num_elements;
+    return;
+  }
+  if (num_elements - search.start_num_elements < kMinMeasuredElements ||
+      now_us <= search.start_time_us) {
+    // Keep measuring the current configuration.
+    return;
+  }
+  const double throughput =
+      static_cast<double>(num_elements - search.start_num_elements) *
+      EnvTime::kSecondsToMicros / (now_us - search.start_time_us);
+
+  // Score the configuration that was measured.
+  MeasurementBasedSearch::Configuration current;
+  for (auto& pair : parameters) {
+    current[std::make_pair(pair.first, pair.second->name)] =
+        pair.second->value;
+  }
+  if (search.trial_arm.empty()) {
+    search.best = std::move(current);
+    search.best_throughput = throughput;
+  } else {
+    const bool success = throughput > search.best_throughput *
+                                          (1.0 + kMinThroughputImprovement);
+    if (search.trial_arm != kRandomArm) {
+      MeasurementBasedSearch::Arm& arm = search.arms[search.trial_arm];
+      ++arm.pulls;
+      ++search.num_pulls;
+      if (success) {
+        ++arm.successes;
+        arm.step *= 2;
+      } else {
+        arm.step = 1;
+      }
+    }
+    VLOG(2) << "Configuration of arm " << search.trial_arm << " has throughput "
+            << throughput << " against " << search.best_throughput;
+    if (success) {
+      search.best = std::move(current);
+      search.best_throughput = throughput;
+    }
+  }
+
+  auto apply_best = [&]() {
+    for (auto& pair : parameters) {
+      auto it = search.best.find(std::make_pair(pair.first, pair.second->name));
+      if (it != search.best.end()) pair.second->value = it->second;
+    }
+  };
+
+  // Choose the configuration to measure next.
+  apply_best();
+  search.trial_arm.clear();
+  ++search.num_steps;
+  for (int attempt = 0; search.num_steps % kRemeasurePeriod != 0 &&
+                        attempt < kMaxConfigurationAttempts;
+       ++attempt) {
+    string arm_name;
+    if (search.rng.RandDouble() < kRandomConfigurationProbability) {
+      arm_name = kRandomArm;
+      for (auto& pair : parameters) {
+        Parameter* parameter = pair.second.get();
+        parameter->value =
+            parameter->min + search.rng.Uniform64(static_cast<uint64>(
+                                 parameter->max - parameter->min + 1));
+      }
+    } else {
+      // Pick the arm with the highest upper confidence bound.
+      Parameter* best_parameter = nullptr;
+      double best_direction = 0;
+      double best_score = -1;
+      for (auto& pair : parameters) {
+        Parameter* parameter = pair.second.get();
+        for (double direction : {1.0, -1.0}) {
+          if (direction > 0 ? parameter->value >= parameter->max
+                            : parameter->value <= parameter->min) {
+            continue;
+          }
+          string name = strings::StrCat(pair.first, "::", parameter->name,
+                                        direction > 0 ? "+" : "-");
+          const MeasurementBasedSearch::Arm& arm = search.arms[name];
+          const double score =
+              arm.pulls == 0
+                  ? std::numeric_limits<double>::max()
+                  : static_cast<double>(arm.successes) / arm.pulls +
+                        std::sqrt(2.0 *
+                                  std::log(std::max<int64_t>(
+                                      search.num_pulls, 1)) /
+                                  arm.pulls);
+          if (score > best_score) {
+            best_score = score;
+            best_parameter = parameter;
+            best_direction = direction;
+            arm_name = std::move(name);
+          }
+        }
+      }
+      if (!best_parameter) break;
+      best_parameter->value = std::min(
+          best_parameter->max,
+          std::max(best_parameter->min,
+                   best_parameter->value +
+                       best_direction * search.arms[arm_name].step));
+    }
+    if (TotalMaximumBufferedBytes(snapshot) <=
+        optimization_params.ram_budget()) {
+      search.trial_arm = std::move(arm_name);
+      break;
+    }
+    // Count configurations that do not fit as failures.
+    if (arm_name != kRandomArm) {
+      MeasurementBasedSearch::Arm& arm = search.arms[arm_name];
+      ++arm.pulls;
+      ++search.num_pulls;
+      arm.step = 1;
+    }
+    apply_best();
+  }
+  UpdateStateValues(&parameters);
+  search.start_time_us = now_us;
+  search.start_num_elements = num_elements;
+}
+
 void Model::OptimizeBuffers(std::shared_ptr<Node> snapshot,
                             int64_t ram_budget) {
   VLOG(2) << "Starting optimization of buffer_size parameters.";
@@ -2654,6 +2875,70 @@ bool Model::UpsizeBuffers(std::shared_ptr<Node> snapshot, int64_t ram_budget) {
   return upsized;
 }
 
+void Model::ShrinkBuffers(std::shared_ptr<Node> snapshot, int64_t ram_budget,
+                          double model_input_time) {
+  double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  if (buffered_bytes <= ram_budget) return;
+  ModelParameters parameters;
+  for (auto& pair : CollectTunableParameters(snapshot)) {
+    if (pair.second->name == kBufferSize) parameters.push_back(pair);
+  }
+  double output_time =
+      OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+  bool shrunk = false;
+  while (buffered_bytes > ram_budget) {
+    double best_cost = std::numeric_limits<double>::max();
+    double best_buffered_bytes = 0;
+    double best_output_time = 0;
+    Parameter* best_parameter = nullptr;
+    for (auto& pair : parameters) {
+      Parameter* parameter = pair.second.get();
+      if (parameter->value <= parameter->min) continue;
+      parameter->value--;
+      const double new_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+      const double new_output_time =
+          OutputTime(snapshot, model_input_time, /*gradients=*/nullptr);
+      parameter->value++;
+      const double freed_bytes = buffered_bytes - new_buffered_bytes;
+      if (freed_bytes <= 0) continue;
+      const double cost =
+          std::max(0.0, new_output_time - output_time) / freed_bytes;
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_buffered_bytes = new_buffered_bytes;
+        best_output_time = new_output_time;
+        best_parameter = parameter;
+      }
+    }
+    if (!best_parameter) {
+      VLOG(2) << "Failed to shrink buffers to the RAM budget of " << ram_budget
+              << " bytes.";
+      break;
+    }
+    best_parameter->value--;
+    buffered_bytes = best_buffered_bytes;
+    output_time = best_output_time;
+    shrunk = true;
+  }
+  if (shrunk) {
+    UpdateStateValues(&parameters);
+  }
+}
+
+void Model::ReportMemoryUsage(std::shared_ptr<Node> snapshot) {
+  NodeValues buffered_bytes;
+  Node::NodeVector nodes =
+      snapshot->CollectNodes(TraversalOrder::BFS, IsAnyNode);
+  nodes.push_back(snapshot);
+  for (const auto& node : nodes) {
+    if (node->buffered_bytes() > 0) {
+      buffered_bytes[node->name()] += node->buffered_bytes();
+    }
+  }
+  MemoryArbiter::Global()->Report(this, TotalMaximumBufferedBytes(snapshot),
+                                  std::move(buffered_bytes));
+}
+
 void Model::ResetBufferWatermarks() {
   Node::NodeVector nodes =
       output()->CollectNodes(TraversalOrder::BFS, IsAsyncNode);
@@ -2805,6 +3090,55 @@ std::string Model::DebugString() {
   return cached_debug_string_;
 }
 
+std::string Model::BottleneckReport::DebugString() const {
+  return strings::StrCat("node: ", node_name, ", stage time: ", stage_time_nsec,
+                         "ns, self time: ", self_time_nsec,
+                         "ns, stall fraction: ", stall_fraction,
+                         ", latency: ", latency_nsec, "ns");
+}
+
+StatusOr<Model::BottleneckReport> Model::ComputeBottleneckReport() {
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock l(mu_);
+    if (!output_) return errors::Unavailable("The model has no nodes.");
+    snapshot = output_->Snapshot();
+  }
+  ModelTiming model_timing(snapshot);
+
+  // The slowest stage determines the throughput of the pipeline.
+  std::shared_ptr<Node> slowest_root;
+  double stage_time_nsec = 0.0;
+  for (const auto& root : model_timing.GetStageRoots()) {
+    const ModelTiming::NodeTiming* timing = model_timing.GetTiming(root.get());
+    const double time_nsec = timing->total_time_nsec * timing->pipeline_ratio;
+    if (time_nsec > stage_time_nsec) {
+      stage_time_nsec = time_nsec;
+      slowest_root = root;
+    }
+  }
+  if (!slowest_root) {
+    return errors::Unavailable("The model has not measured any element.");
+  }
+
+  // Within the stage, the node that spends the most time producing the inputs
+  // of one output element is the bottleneck.
+  BottleneckReport report;
+  report.stage_time_nsec = stage_time_nsec;
+  for (const auto& node : model_timing.GetStageNodes(slowest_root)) {
+    const ModelTiming::NodeTiming* timing = model_timing.GetTiming(node.get());
+    const double self_time_nsec =
+        timing->self_time_nsec * timing->pipeline_ratio;
+    if (report.node_name.empty() || self_time_nsec > report.self_time_nsec) {
+      report.node_name = node->long_name();
+      report.self_time_nsec = self_time_nsec;
+      report.latency_nsec = node->latency_ema();
+    }
+  }
+  report.stall_fraction = report.self_time_nsec / stage_time_nsec;
+  return report;
+}
+
 ModelTiming::ModelTiming(std::shared_ptr<Node> root) : root_(root) {
   DCHECK(root_.get() != nullptr);
   auto bfs_nodes = CollectNodes(root_, TraversalOrder::BFS, IsAnyNode);
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -63,6 +64,10 @@ constexpr double kRamBudgetShare = 0.5;
 // average of processing time per element.
 constexpr double kProcessingTimeEmaWeight = 0.1;
 
+// Only one in this many calls to `GetNext()` of an iterator has its latency
+// recorded, which keeps the recording cheap enough to always be on.
+constexpr int64_t kLatencySamplingPeriod = 16;
+
 enum class TraversalOrder {
   BFS = 0,
   REVERSE_BFS = 1,
@@ -354,6 +359,31 @@ class Node {
   // currently between a `record_start` and a `record_stop`.
   bool is_recording() TF_LOCKS_EXCLUDED(mu_) { return work_start_ > 0; }
 
+  // Records the wall time of a call to `GetNext()` of the iterator modeled by
+  // this node. Only one in `kLatencySamplingPeriod` calls is sampled.
+  void record_latency(int64_t latency_nanos) TF_LOCKS_EXCLUDED(mu_) {
+    if (num_latency_calls_.fetch_add(1, std::memory_order_relaxed) %
+            kLatencySamplingPeriod !=
+        0) {
+      return;
+    }
+    mutex_lock l(mu_);
+    if (num_latency_samples_ == 0) {
+      latency_ema_ = static_cast<double>(latency_nanos);
+    } else {
+      latency_ema_ = (1.0 - kProcessingTimeEmaWeight) * latency_ema_ +
+                     kProcessingTimeEmaWeight * latency_nanos;
+    }
+    ++num_latency_samples_;
+  }
+
+  // Returns the exponential moving average of the sampled `GetNext()` latency
+  // in nanoseconds, or 0 if no latency has been sampled yet.
+  double latency_ema() const TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    return latency_ema_;
+  }
+
   // Removes an input.
   void remove_input(std::shared_ptr<Node> input) TF_LOCKS_EXCLUDED(mu_) {
     mutex_lock l(mu_);
@@ -701,6 +731,12 @@ class Node {
   int64_t previous_processing_time_ TF_GUARDED_BY(mu_) = 0;
   double processing_time_ema_ TF_GUARDED_BY(mu_) = 0.0;
 
+  // The number of `record_latency()` calls, and the number and exponential
+  // moving average of the sampled latencies.
+  std::atomic<int64_t> num_latency_calls_{0};
+  int64_t num_latency_samples_ TF_GUARDED_BY(mu_) = 0;
+  double latency_ema_ TF_GUARDED_BY(mu_) = 0.0;
+
   // Inputs of this node. These can represent an iterator created from the input
   // dataset but also other input iterators (e.g. created by the user-defined
   // functions of `flat_map` or `interleave`).
@@ -752,6 +788,49 @@ std::shared_ptr<Node> MakeAsyncUnknownRatioNode(
 // as pass-through between inputs and output.
 std::shared_ptr<Node> MakeUnknownNode(Node::Args args);
 
+class Model;
+
+// Divides the memory available to input pipelines between the live `Model`s of
+// the process.
+//
+// Every model derives its RAM budget from the memory that is available when
+// its iterator is created, as if its input pipeline were the only one, so
+// pipelines that run side by side could together exceed the memory of the
+// host. Each model reports the memory its buffers may use after every
+// optimization, and optimizes against its budget minus what the other models
+// reported.
+class MemoryArbiter {
+ public:
+  // Returns the process-wide arbiter.
+  static MemoryArbiter* Global();
+
+  // Returns the part of `ram_budget` that `model` may use, i.e. what is left
+  // after the memory reported by the other models.
+  int64_t Allowance(const Model* model, int64_t ram_budget) const
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Records that the buffers of `model` may use up to `max_buffered_bytes`, and
+  // currently hold `buffered_bytes`, keyed by node name.
+  void Report(const Model* model, double max_buffered_bytes,
+              Node::NodeValues buffered_bytes) TF_LOCKS_EXCLUDED(mu_);
+
+  // Forgets the memory reported by `model`.
+  void Remove(const Model* model) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of bytes currently buffered by the nodes of all models,
+  // summed by node name.
+  Node::NodeValues BufferedBytesByNodeName() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Usage {
+    double max_buffered_bytes = 0;
+    Node::NodeValues buffered_bytes;
+  };
+
+  mutable mutex mu_;
+  absl::flat_hash_map<const Model*, Usage> usage_ TF_GUARDED_BY(mu_);
+};
+
 // Abstract representation of a TensorFlow input pipeline that can be used
 // for collecting runtime information and optimizing performance. It collects
 // runtime information about execution of the input pipeline that is used to
@@ -773,6 +852,26 @@ class Model {
   using NodeValues = Node::NodeValues;
   using ParameterGradients = Node::ParameterGradients;
 
+  // The node of the pipeline that contributes the most to the time it takes
+  // to produce an element.
+  struct BottleneckReport {
+    // The long name of the node.
+    string node_name;
+    // The time that the slowest stage of the pipeline, i.e. the sequence of
+    // synchronous nodes that contains the node, takes to produce the inputs
+    // of one output element.
+    double stage_time_nsec = 0.0;
+    // The time that the node itself spends producing the inputs of one
+    // output element.
+    double self_time_nsec = 0.0;
+    // The share of the stage time spent in the node itself.
+    double stall_fraction = 0.0;
+    // The sampled latency of a `GetNext()` call of the node.
+    double latency_nsec = 0.0;
+
+    std::string DebugString() const;
+  };
+
   Model();
   ~Model();
 
@@ -795,6 +894,11 @@ class Model {
   // recomputation, the implementation caches the result.
   std::string DebugString();
 
+  // Returns the node with the highest stall contribution, based on the
+  // measurements collected so far. Returns an `Unavailable` error if the
+  // model has not measured any element yet.
+  StatusOr<BottleneckReport> ComputeBottleneckReport() TF_LOCKS_EXCLUDED(mu_);
+
   // Uses the given algorithm and resource budgets to periodically perform the
   // autotuning optimization.
   //
@@ -805,7 +909,8 @@ class Model {
                       CancellationManager* cancellation_manager);
 
   // Uses the given algorithm and resource budgets to perform the autotuning
-  // optimization.
+  // optimization. The RAM budget is shared with the other models of the
+  // process through `MemoryArbiter::Global()`.
   void Optimize(AutotuneAlgorithm algorithm, int64_t cpu_budget,
                 int64_t ram_budget, double model_input_time,
                 CancellationManager* cancellation_manager);
@@ -858,6 +963,9 @@ class Model {
   static constexpr int64_t kOptimizationPeriodMinMs = 10;
   static constexpr int64_t kOptimizationPeriodMaxMs =
       60 * EnvTime::kSecondsToMillis;
+  // The optimization period of the `MEASUREMENT_BASED` algorithm, each step of
+  // which measures the throughput of one configuration.
+  static constexpr int64_t kMeasurementPeriodMs = 500;
 
   // Collects tunable parameters in the tree rooted in the given node, returning
   // a vector which contains pairs of node names and tunable parameters.
@@ -871,6 +979,16 @@ class Model {
   // respecting the ram budget. Returns true if any buffer is upsized.
   bool UpsizeBuffers(std::shared_ptr<Node> snapshot, int64_t ram_budget);
 
+  // Shrinks `buffer_size` parameters of the nodes rooted at `snapshot` until
+  // their buffers fit in `ram_budget`, one element at a time, each time picking
+  // the buffer that increases the output time the least per byte freed.
+  void ShrinkBuffers(std::shared_ptr<Node> snapshot, int64_t ram_budget,
+                     double model_input_time);
+
+  // Reports the memory used by the buffers of the nodes rooted at `snapshot` to
+  // `MemoryArbiter::Global()`.
+  void ReportMemoryUsage(std::shared_ptr<Node> snapshot);
+
   // Reset buffer watermarks of all asynchronous nodes to their buffered
   // elements.
   void ResetBufferWatermarks();
@@ -935,6 +1053,20 @@ class Model {
       const OptimizationParams& optimization_params,
       CancellationManager* cancellation_manager);
 
+  // This optimization measures the throughput of the input pipeline instead of
+  // estimating it with `OutputTime`, which makes it robust to inaccuracies of
+  // the model on pipelines with many stages. Every step measures the throughput
+  // of the configuration applied by the previous step, keeps it if it beats the
+  // best configuration so far, and applies the next configuration to try. A
+  // configuration moves one `parallelism` or `buffer_size` parameter away from
+  // the best one, chosen by a UCB1 bandit over (parameter, direction) pairs
+  // whose step doubles after each success. Occasionally a random configuration
+  // is tried instead, to escape local optima, and the best one is measured
+  // again, to follow changes of the workload. Configurations that exceed the
+  // RAM budget are not tried.
+  void OptimizeMeasurementBased(std::shared_ptr<Node> snapshot,
+                                const OptimizationParams& optimization_params);
+
   // Determines if we should stop the gradient descent optimization iterations
   // based on number of increasable parameters, CPU budget, RAM budget and
   // current resource usage.
@@ -973,6 +1105,9 @@ class Model {
   // Gauge cell that can be used to collect the state of the model.
   monitoring::GaugeCell<std::function<std::string()>>* model_gauge_cell_ =
       nullptr;
+  // Gauge cell that can be used to collect the bottleneck of the model.
+  monitoring::GaugeCell<std::function<std::string()>>* bottleneck_gauge_cell_ =
+      nullptr;
   // Used to synchronize metrics collection attempts against the model's
   // destruction.
   struct GuardedBool {
@@ -996,6 +1131,39 @@ class Model {
   std::deque<uint64_t> gap_times_usec_ TF_GUARDED_BY(gap_mu_);
   // The experiment that this job is part of.
   std::string experiment_ = "";
+
+  // State of the `MEASUREMENT_BASED` optimization, which persists across
+  // optimization steps. Only accessed by `Optimize()`.
+  struct MeasurementBasedSearch {
+    // Parameter values keyed by node long name and parameter name.
+    using Configuration =
+        absl::flat_hash_map<std::pair<string, string>, double>;
+
+    // A direction in which to move a parameter.
+    struct Arm {
+      int64_t pulls = 0;
+      int64_t successes = 0;
+      double step = 1;
+    };
+
+    // The start of the current measurement.
+    int64_t start_time_us = 0;
+    int64_t start_num_elements = 0;
+    // The best configuration so far and its throughput in elements per
+    // second, which is negative until the first measurement.
+    Configuration best;
+    double best_throughput = -1;
+    // The arm of the configuration being measured, empty when measuring the
+    // best configuration, or `kRandomArm` for a random configuration.
+    string trial_arm;
+    // The number of steps and arm pulls so far.
+    int64_t num_steps = 0;
+    int64_t num_pulls = 0;
+    absl::flat_hash_map<string, Arm> arms;
+    random::PhiloxRandom philox{random::New64()};
+    random::SimplePhilox rng{&philox};
+  };
+  MeasurementBasedSearch measurement_based_search_;
 };
 
 // Class to compute timing information for a model.
@@ -1321,6 +1321,41 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1, 2, 3));
 
+TEST(OptimizeMeasurementBasedTest, FollowsMeasuredThroughput) {
+  std::shared_ptr<mutex> mutex1 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv1 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 1,
+      {model::MakeParameter(
+          "parallelism",
+          std::make_shared<SharedState>(/*value=*/1, mutex1, cv1),
+          /*min=*/1, /*max=*/8)});
+  model::Model model;
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+
+  // The pipeline produces elements at a rate proportional to its parallelism.
+  CancellationManager cancellation_manager;
+  double max_recent_parallelism = 0;
+  for (int i = 0; i < 100; ++i) {
+    const double parallelism = node1->parameter_value("parallelism");
+    EXPECT_GE(parallelism, 1);
+    EXPECT_LE(parallelism, 8);
+    if (i >= 80) {
+      max_recent_parallelism = std::max(max_recent_parallelism, parallelism);
+    }
+    for (int j = 0; j < 20 * parallelism; ++j) {
+      node1->record_element();
+    }
+    Env::Default()->SleepForMicroseconds(5000);
+    model.Optimize(AutotuneAlgorithm::MEASUREMENT_BASED, /*cpu_budget=*/8,
+                   /*ram_budget=*/1 << 30, /*model_input_time=*/0,
+                   &cancellation_manager);
+  }
+  EXPECT_EQ(max_recent_parallelism, 8);
+}
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
@@ -1330,6 +1365,20 @@ TEST(RecordTimeTest, RecordTimeTest) {
   EXPECT_FALSE(source->is_recording());
 }
 
+TEST(RecordLatencyTest, SamplesLatency) {
+  std::shared_ptr<Node> source = model::MakeSourceNode({});
+  EXPECT_EQ(source->latency_ema(), 0);
+  source->record_latency(1000);
+  EXPECT_DOUBLE_EQ(source->latency_ema(), 1000);
+  // Only one in `kLatencySamplingPeriod` calls is sampled.
+  for (int i = 1; i < kLatencySamplingPeriod; ++i) {
+    source->record_latency(5000);
+  }
+  EXPECT_DOUBLE_EQ(source->latency_ema(), 1000);
+  source->record_latency(3000);
+  EXPECT_DOUBLE_EQ(source->latency_ema(), 1200);
+}
+
 TEST(ModelTest, ModelMetrics) {
   CellReader<std::string> cell_reader("/tensorflow/data/model");
   model::Model model;
@@ -2714,6 +2763,64 @@ TEST_F(ModelTimingTest, ComputeTargetTime_TestWindow) {
   EXPECT_DOUBLE_EQ(10.0, model_->ComputeTargetTimeNsec() * 1e-3);
 }
 
+TEST_F(ModelTimingTest, BottleneckReport) {
+  BuildModelFromProto(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "Map"
+        autotune: true
+        num_elements: 100
+        processing_time: 5000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 2
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "Decode"
+        autotune: true
+        num_elements: 100
+        processing_time: 50000
+        node_class: KNOWN_RATIO
+        ratio: 1
+        inputs: 3
+      }
+    }
+    nodes: {
+      key: 3
+      value: {
+        id: 3
+        name: "SSTable"
+        autotune: true
+        num_elements: 100
+        processing_time: 10000
+        node_class: KNOWN_RATIO
+        ratio: 1
+      }
+    }
+    output: 1
+  )pb");
+  MutableGetNode(/*node_id=*/2)->record_latency(700);
+
+  TF_ASSERT_OK_AND_ASSIGN(Model::BottleneckReport report,
+                          model_->ComputeBottleneckReport());
+  EXPECT_EQ(report.node_name, "Decode(id:2)");
+  EXPECT_DOUBLE_EQ(report.stage_time_nsec, 650);
+  EXPECT_DOUBLE_EQ(report.self_time_nsec, 500);
+  EXPECT_DOUBLE_EQ(report.stall_fraction, 500.0 / 650);
+  EXPECT_DOUBLE_EQ(report.latency_nsec, 700);
+
+  CellReader<std::string> cell_reader("/tensorflow/data/bottleneck");
+  std::string model_id =
+      strings::StrCat(reinterpret_cast<uintptr_t>(model_.get()));
+  EXPECT_THAT(cell_reader.Read(model_id), HasSubstr("node: Decode(id:2)"));
+}
+
 TEST_F(ModelTimingTest, SelfTime) {
   BuildModelFromProto(R"pb(
     nodes: {
@@ -2763,6 +2870,96 @@ TEST_F(ModelTimingTest, SelfTime) {
   EXPECT_DOUBLE_EQ(910, node_2->ComputeSelfTime());
 }
 
+TEST(MemoryArbiterTest, Allowance) {
+  MemoryArbiter arbiter;
+  Model model_1;
+  Model model_2;
+  EXPECT_EQ(arbiter.Allowance(&model_1, 1000), 1000);
+  arbiter.Report(&model_1, /*max_buffered_bytes=*/300,
+                 /*buffered_bytes=*/{{"Prefetch", 100}});
+  arbiter.Report(&model_2, /*max_buffered_bytes=*/500,
+                 /*buffered_bytes=*/{{"Prefetch", 200}, {"ParallelMapV2", 50}});
+  // A model's own buffers do not count against it.
+  EXPECT_EQ(arbiter.Allowance(&model_1, 1000), 500);
+  EXPECT_EQ(arbiter.Allowance(&model_2, 1000), 700);
+  EXPECT_EQ(arbiter.Allowance(&model_2, 200), 0);
+  Node::NodeValues buffered_bytes = arbiter.BufferedBytesByNodeName();
+  EXPECT_EQ(buffered_bytes["Prefetch"], 300);
+  EXPECT_EQ(buffered_bytes["ParallelMapV2"], 50);
+  arbiter.Remove(&model_2);
+  EXPECT_EQ(arbiter.Allowance(&model_1, 1000), 1000);
+}
+
+TEST_F(BufferSizeTest, OptimizeShrinksBuffersToAllowance) {
+  ReadModel(R"pb(
+    nodes: {
+      key: 1
+      value: {
+        id: 1
+        name: "Prefetch"
+        autotune: true
+        bytes_produced: 10000
+        num_elements: 100
+        processing_time: 2000
+        node_class: ASYNC_KNOWN_RATIO
+        inputs: 2
+        ratio: 1
+        parameters: {
+          name: "buffer_size"
+          value: 5
+          state_value: 5
+          min: 1
+          max: 10
+          tunable: true
+        }
+      }
+    }
+    nodes: {
+      key: 2
+      value: {
+        id: 2
+        name: "Prefetch"
+        autotune: true
+        bytes_produced: 10000
+        num_elements: 100
+        processing_time: 2000
+        node_class: ASYNC_KNOWN_RATIO
+        ratio: 1
+        parameters: {
+          name: "buffer_size"
+          value: 5
+          state_value: 5
+          min: 1
+          max: 10
+          tunable: true
+        }
+      }
+    }
+    output: 1
+  )pb");
+
+  // Each buffered element takes 100 bytes, so the buffers may take 1000 bytes.
+  CancellationManager cancellation_manager;
+  model_->Optimize(AutotuneAlgorithm::STAGE_BASED, /*cpu_budget=*/10,
+                   /*ram_budget=*/1000, /*model_input_time=*/0,
+                   &cancellation_manager);
+  EXPECT_EQ(5, GetNode(1)->parameter_value(kBufferSize));
+  EXPECT_EQ(5, GetNode(2)->parameter_value(kBufferSize));
+
+  // Another pipeline of the process takes 400 bytes of the budget.
+  Model other;
+  MemoryArbiter::Global()->Report(&other, /*max_buffered_bytes=*/400,
+                                  /*buffered_bytes=*/{});
+  model_->Optimize(AutotuneAlgorithm::STAGE_BASED, /*cpu_budget=*/10,
+                   /*ram_budget=*/1000, /*model_input_time=*/0,
+                   &cancellation_manager);
+  const double buffer_size_1 = GetNode(1)->parameter_value(kBufferSize);
+  const double buffer_size_2 = GetNode(2)->parameter_value(kBufferSize);
+  EXPECT_GE(buffer_size_1, 1);
+  EXPECT_GE(buffer_size_2, 1);
+  EXPECT_EQ(buffer_size_1 + buffer_size_2, 6);
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
@@ -92,6 +92,7 @@ class OpRegistryInterface;
 class ResourceMgr;
 class ScopedStepContainer;
 class CollectiveExecutor;
+class LatencyBreakdownCollector;
 class StepStatsCollectorInterface;
 
 // A label that is added to kernels that are JIT compiled. These labels will be
@@ -617,9 +618,22 @@ class OpKernelContext {
     bool track_allocations = false;
     bool log_memory = false;
 
+    // If not null, returned by get_allocator() in place of the device's
+    // allocator for requests that need no special memory (no scope_id, and
+    // neither GPU- nor NIC-compatible). The executor sets this to a
+    // step-scoped arena for kernels whose outputs do not outlive the step,
+    // and eager ops on the host CPU to the context's buffer cache. Not owned.
+    Allocator* step_allocator = nullptr;
+
     // Array indexed by output number for this node
     const AllocatorAttributes* output_attr_array = nullptr;
 
+    // If not null, array indexed by output number for this node of the
+    // allocators that allocate_output() uses for outputs with default
+    // attributes, in place of get_allocator(). Null entries use
+    // get_allocator(). The executor sets this to statically planned buffers.
+    Allocator* const* output_allocator_array = nullptr;
+
     // Shared resources accessible by this op kernel invocation.
     ResourceMgr* resource_manager = nullptr;
 
@@ -668,6 +682,8 @@ class OpKernelContext {
     FunctionLibraryRuntime* function_library = nullptr;
     std::function<void(std::function<void()>)>* runner = nullptr;
     StepStatsCollectorInterface* stats_collector = nullptr;
+    // Latency breakdown of the request, if it is collected.
+    LatencyBreakdownCollector* latency_breakdown = nullptr;
     GraphCollector* graph_collector = nullptr;
     bool run_all_kernels_inline = false;
     const std::string* executor_type = nullptr;
@@ -1106,6 +1122,13 @@ class OpKernelContext {
     return params_->stats_collector;
   }
 
+  // Collects where the time of the request running this kernel is spent.
+  // Returns nullptr unless RunOptions.Experimental.collect_latency_breakdown is
+  // set.
+  LatencyBreakdownCollector* latency_breakdown() const {
+    return params_->latency_breakdown;
+  }
+
   // Shared resources accessible to this kernel.
   ResourceMgr* resource_manager() const { return params_->resource_manager; }
 
@@ -1252,9 +1275,12 @@ class OpKernelContext {
                            AllocationAttributes());
   }
 
+  // If `allocator` is not null, it is used in place of
+  // get_allocator(allocator_attr).
   Status allocate_tensor(DataType type, const TensorShape& shape,
                          Tensor* out_tensor, AllocatorAttributes allocator_attr,
-                         const AllocationAttributes& allocation_attr);
+                         const AllocationAttributes& allocation_attr,
+                         Allocator* allocator = nullptr);
 
   // Helpers for `set_output()`.
 
@@ -23,6 +23,7 @@ limitations under the License.
 #include <memory>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -77,6 +78,7 @@ RunHandlerEnvironment::Task RunHandlerEnvironment::CreateTask(
           std::move(f),
           Context(ContextKind::kThread),
           id,
+          /*enqueue_time_us=*/0,
       }),
   };
 }
@@ -131,6 +133,9 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       traceme_id_(0),
+      priority_(0),
+      deadline_us_(kuint64max),
+      queueing_delay_cell_(nullptr),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
   queue_waiters_.next = &queue_waiters_;
@@ -280,6 +285,29 @@ void ThreadWorkSource::SetWaiter(uint64 version, Waiter* waiter, mutex* mutex) {
   version_ = version;
 }
 
+void ThreadWorkSource::SetSchedulingKey(int64_t priority, uint64 deadline_us) {
+  priority_.store(priority, std::memory_order_relaxed);
+  deadline_us_.store(deadline_us, std::memory_order_relaxed);
+}
+
+bool ThreadWorkSource::SchedulesBefore(const ThreadWorkSource& other) const {
+  const int64_t priority = priority_.load(std::memory_order_relaxed);
+  const int64_t other_priority = other.priority_.load(std::memory_order_relaxed);
+  if (priority != other_priority) return priority > other_priority;
+  return deadline_us_.load(std::memory_order_relaxed) <
+         other.deadline_us_.load(std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::SetQueueingDelayCell(monitoring::SamplerCell* cell) {
+  queueing_delay_cell_.store(cell, std::memory_order_relaxed);
+}
+
+void ThreadWorkSource::RecordQueueingDelay(uint64 delay_us) {
+  monitoring::SamplerCell* cell =
+      queueing_delay_cell_.load(std::memory_order_relaxed);
+  if (cell != nullptr) cell->Add(delay_us);
+}
+
 int64_t ThreadWorkSource::GetInflightTaskCount(bool is_blocking) {
   std::atomic<int64_t>* counter =
       is_blocking ? &blocking_inflight_ : &non_blocking_inflight_;
@@ -392,6 +420,9 @@ void RunHandlerThreadPool::AddWorkToQueue(ThreadWorkSource* tws,
                                           bool is_blocking,
                                           std::function<void()> fn) {
   Task t = env_.CreateTask(std::move(fn));
+  if (is_blocking) {
+    t.f->enqueue_time_us = EnvTime::NowMicros();
+  }
   t = tws->EnqueueTask(std::move(t), is_blocking);
   if (t.f) {
     VLOG(3) << "Running " << (is_blocking ? "inter" : "intra") << " work for "
@@ -587,9 +618,29 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
                      &task_from_blocking_queue, &tws);
       }
     } else {
+      // Between kernels, let a thread first run the inter-op work of requests
+      // that should be scheduled before its primary request.
+      static const bool preempt_by_priority = ParamFromEnvBoolWithDefault(
+          "TF_RUN_HANDLER_PREEMPT_BY_PRIORITY", false);
+      if (preempt_by_priority && may_steal_blocking_work &&
+          !thread_work_sources->empty()) {
+        const ThreadWorkSource* primary = (*thread_work_sources)[0];
+        for (int i = 1; i < thread_work_sources->size(); ++i) {
+          ThreadWorkSource* other = (*thread_work_sources)[i];
+          if (!other->SchedulesBefore(*primary) ||
+              other->GetInflightTaskCount(true) >= kMaxBlockingInflight) {
+            continue;
+          }
+          t = other->PopBlockingTask();
+          if (t.f) {
+            tws = other;
+            break;
+          }
+        }
+      }
       // TODO(chaox): Refactor the following code to share the logic with
       // FindTask.
-      for (int i = 0; i < thread_work_sources->size(); ++i) {
+      for (int i = 0; !t.f && i < thread_work_sources->size(); ++i) {
         tws = (*thread_work_sources)[i];
         // We want a smallish numbers of inter threads since
         // otherwise there will be contention in PropagateOutputs.
@@ -632,6 +683,11 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
           profiler::TraceMeLevel::kInfo);
       VLOG(2) << "Running " << (task_from_blocking_queue ? "inter" : "intra")
               << " work from " << tws->GetTracemeId();
+      if (task_from_blocking_queue && t.f->enqueue_time_us != 0) {
+        const uint64 now = EnvTime::NowMicros();
+        tws->RecordQueueingDelay(
+            now > t.f->enqueue_time_us ? now - t.f->enqueue_time_us : 0);
+      }
       tws->IncrementInflightTaskCount(task_from_blocking_queue);
       env_.ExecuteTask(t);
       tws->DecrementInflightTaskCount(task_from_blocking_queue);
@@ -749,6 +805,20 @@ class RunHandler::Impl {
 
   int64_t priority() { return options_.priority(); }
 
+  // The deadline of the request in microseconds since the epoch, or kuint64max
+  // if it has none.
+  uint64 deadline_us() const { return deadline_us_; }
+
+  // Returns true if the inter-op work of this request should be scheduled
+  // before that of `other`: higher priorities go first, with the earliest
+  // deadline first among requests of the same priority.
+  bool SchedulesBefore(const Impl& other) const {
+    if (options_.priority() != other.options_.priority()) {
+      return options_.priority() > other.options_.priority();
+    }
+    return deadline_us_ < other.deadline_us_;
+  }
+
  private:
   class ThreadPoolInterfaceWrapper : public thread::ThreadPoolInterface {
    public:
@@ -765,6 +835,7 @@ class RunHandler::Impl {
 
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
+  uint64 deadline_us_;
   int64_t step_id_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   internal::ThreadWorkSource tws_;
@@ -845,6 +916,7 @@ class RunHandlerPool::Impl {
     uint64 version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
+    const uint64 wait_start_us = EnvTime::NowMicros();
     {
       mutex_lock l(mu_);
       if (!has_free_handler()) {
@@ -874,12 +946,11 @@ class RunHandlerPool::Impl {
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
         if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+                                      handler_impl->SchedulesBefore(**it))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -890,6 +961,8 @@ class RunHandlerPool::Impl {
       }
       version = ++version_;
     }
+    metrics::GetRunHandlerWaitTimeCell(options.priority())
+        ->Add(EnvTime::NowMicros() - wait_start_us);
     RecomputePoolStats(num_active_requests, version, *thread_work_sources);
     return WrapUnique<RunHandler>(new RunHandler(handler_impl));
   }
@@ -935,6 +1008,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<int64_t> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
  private:
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
@@ -954,8 +1037,7 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by priority, then by deadline, then by start time.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
@@ -1079,9 +1161,15 @@ void RunHandler::Impl::Reset(
     int64_t step_id,
     const RunOptions::Experimental::RunHandlerPoolOptions& options) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
+  deadline_us_ = options.deadline_in_ms() > 0
+                     ? start_time_us_ + options.deadline_in_ms() * 1000
+                     : kuint64max;
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
+  tws_.SetSchedulingKey(options.priority(), deadline_us_);
+  tws_.SetQueueingDelayCell(
+      metrics::GetRunHandlerQueueingDelayCell(options.priority()));
 }
 
 RunHandlerPool::RunHandlerPool(int num_inter_op_threads)
@@ -1104,6 +1192,10 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64_t> RunHandlerPool::GetActiveHandlerStepIdsForTesting() const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
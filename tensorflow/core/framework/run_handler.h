@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -72,6 +73,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids for active handlers, in the order of the active handler
+  // list.
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -82,7 +87,8 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (the request priority, then the earliest deadline, then the time of the
+// Get() call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -116,6 +122,8 @@ class RunHandlerEnvironment {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // The time the task was enqueued in microseconds, or 0 if not recorded.
+    uint64 enqueue_time_us;
   };
   Env* const env_;
   const ThreadOptions thread_options_;
@@ -176,6 +184,22 @@ class ThreadWorkSource {
 
   void SetWaiter(uint64 version, Waiter* waiter, mutex* mutex);
 
+  // Sets the priority and the deadline (in microseconds since the epoch, or
+  // kuint64max if none) of the request whose work is in this source.
+  void SetSchedulingKey(int64_t priority, uint64 deadline_us);
+
+  // Returns true if the work in this source should run before the work in
+  // `other`, i.e. if it has a higher priority, or the same priority and an
+  // earlier deadline.
+  bool SchedulesBefore(const ThreadWorkSource& other) const;
+
+  // Sets the cell that RecordQueueingDelay() adds to. Not owned.
+  void SetQueueingDelayCell(monitoring::SamplerCell* cell);
+
+  // Records that a blocking task waited `delay_us` microseconds before it
+  // started running.
+  void RecordQueueingDelay(uint64 delay_us);
+
   int64_t GetInflightTaskCount(bool is_blocking);
 
   void IncrementInflightTaskCount(bool is_blocking);
@@ -205,6 +229,9 @@ class ThreadWorkSource {
   mutex waiters_mu_;
   Waiter queue_waiters_ TF_GUARDED_BY(waiters_mu_);
   std::atomic<int64_t> traceme_id_;
+  std::atomic<int64_t> priority_;
+  std::atomic<uint64> deadline_us_;
+  std::atomic<monitoring::SamplerCell*> queueing_delay_cell_;
 
   mutex run_handler_waiter_mu_;
   uint64 version_ TF_GUARDED_BY(run_handler_waiter_mu_);
@@ -113,6 +113,46 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  // Within a priority, handlers with the earliest deadline come first and
+  // handlers without a deadline come last.
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_priority(1);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  options.set_deadline_in_ms(60000);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/0, options);
+  options.set_deadline_in_ms(10);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/0, options);
+  options.set_priority(2);
+  options.set_deadline_in_ms(0);
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/0, options);
+
+  std::vector<int64_t> sorted_active_list =
+      pool->GetActiveHandlerStepIdsForTesting();
+  EXPECT_EQ(sorted_active_list.size(), 4);
+  EXPECT_EQ(sorted_active_list[0], 4);
+  EXPECT_EQ(sorted_active_list[1], 3);
+  EXPECT_EQ(sorted_active_list[2], 2);
+  EXPECT_EQ(sorted_active_list[3], 1);
+}
+
+TEST(RunHandlerThreadPool, SchedulesBefore) {
+  internal::ThreadWorkSource high, low;
+  high.SetSchedulingKey(/*priority=*/2, /*deadline_us=*/kuint64max);
+  low.SetSchedulingKey(/*priority=*/1, /*deadline_us=*/100);
+  EXPECT_TRUE(high.SchedulesBefore(low));
+  EXPECT_FALSE(low.SchedulesBefore(high));
+
+  high.SetSchedulingKey(/*priority=*/1, /*deadline_us=*/200);
+  EXPECT_TRUE(low.SchedulesBefore(high));
+  EXPECT_FALSE(high.SchedulesBefore(low));
+  EXPECT_FALSE(low.SchedulesBefore(low));
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/graph/types.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/grappler/costs/utils.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
@@ -29,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/overflow.h"
 
 namespace tensorflow {
@@ -149,11 +151,50 @@ AnalyticalCostEstimator::AnalyticalCostEstimator(
       node_manager_.get(), std::move(placer));
 }
 
+void AnalyticalCostEstimator::SetCalibration(
+    const OpCostCalibration& calibration) {
+  calibration_ = calibration;
+  calibration_set_ = true;
+}
+
 Status AnalyticalCostEstimator::Initialize(const GrapplerItem& item) {
   item_ = &item;
+  if (!calibration_set_) {
+    calibration_set_ = true;
+    string filename;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_OP_COST_CALIBRATION", "",
+                                     &filename));
+    if (!filename.empty()) {
+      Status status = ReadOpCostCalibration(filename, &calibration_);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to read op cost calibration " << filename
+                     << ": " << status;
+        calibration_.Clear();
+      }
+    }
+  }
   return OkStatus();
 }
 
+void AnalyticalCostEstimator::ApplyCalibration(const OpContext& op_context,
+                                               Costs* costs) const {
+  if (calibration_.execution_time_scale().empty() ||
+      calibration_.device().type() != op_context.op_info.device().type()) {
+    return;
+  }
+  auto it = calibration_.execution_time_scale().find(op_context.op_info.op());
+  if (it == calibration_.execution_time_scale().end()) return;
+  const double scale = it->second;
+  auto scaled = [scale](Costs::Duration duration) {
+    if (duration == Costs::Duration::max()) return duration;
+    return Costs::Duration(static_cast<int64_t>(duration.count() * scale));
+  };
+  costs->execution_time = scaled(costs->execution_time);
+  costs->compute_time = scaled(costs->compute_time);
+  costs->memory_time = scaled(costs->memory_time);
+  costs->intermediate_memory_time = scaled(costs->intermediate_memory_time);
+}
+
 Status AnalyticalCostEstimator::PredictCosts(const GraphDef& optimized_graph,
                                              RunMetadata* run_metadata,
                                              Costs* costs) const {
@@ -199,6 +240,7 @@ Status AnalyticalCostEstimator::PredictCosts(const GraphDef& optimized_graph,
     ++nodes_executed;
     OpContext op_context = scheduler_->GetCurrNode();
     node_costs = node_estimator_->PredictCosts(op_context);
+    ApplyCalibration(op_context, &node_costs);
 
     if (node_costs.inaccurate) {
       inaccurate_nodes.push_back(op_context.name);
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/grappler/costs/virtual_scheduler.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -55,6 +56,13 @@ class AnalyticalCostEstimator : public CostEstimator {
                           bool use_aggressive_shape_inference);
   ~AnalyticalCostEstimator() override {}
 
+  // Corrects the predicted execution time of ops on devices of the type of
+  // `calibration.device()` by the per-op scale of `calibration`. Without a
+  // call to this method, the calibration is read by Initialize() from the
+  // file named by the TF_GRAPPLER_OP_COST_CALIBRATION environment variable,
+  // if set.
+  void SetCalibration(const OpCostCalibration& calibration);
+
   // This implementation always returns OK.
   Status Initialize(const GrapplerItem& item) override;
 
@@ -67,6 +75,8 @@ class AnalyticalCostEstimator : public CostEstimator {
   const VirtualScheduler* GetScheduler() const { return scheduler_.get(); }
 
  private:
+  void ApplyCalibration(const OpContext& op_context, Costs* costs) const;
+
   const GrapplerItem* item_;
   std::unique_ptr<OpLevelCostEstimator> node_estimator_;
   std::unique_ptr<ReadyNodeManager> node_manager_;
@@ -74,6 +84,9 @@ class AnalyticalCostEstimator : public CostEstimator {
 
   bool use_static_shapes_;
   bool use_aggressive_shape_inference_;
+
+  bool calibration_set_ = false;
+  OpCostCalibration calibration_;
 };
 
 }  // end namespace grappler
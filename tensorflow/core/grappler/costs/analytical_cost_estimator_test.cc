@@ -115,5 +115,31 @@ TEST_F(AnalyticalCostEstimatorTest, SimpleTest) {
   EXPECT_EQ(0, summary.num_ops_with_unknown_shapes);
 }
 
+TEST_F(AnalyticalCostEstimatorTest, Calibration) {
+  GrapplerItem item = CreateMiniGraph();
+
+  auto predict = [&](const OpCostCalibration& calibration) {
+    AnalyticalCostEstimator estimator(cluster_.get(),
+                                      /*use_static_shapes=*/true,
+                                      /*use_aggressive_shape_inference=*/true);
+    estimator.SetCalibration(calibration);
+    TF_CHECK_OK(estimator.Initialize(item));
+    Costs summary;
+    TF_CHECK_OK(estimator.PredictCosts(item.graph, nullptr, &summary));
+    return summary.execution_time;
+  };
+
+  const Costs::Duration uncalibrated = predict(OpCostCalibration());
+
+  OpCostCalibration calibration;
+  (*calibration.mutable_execution_time_scale())["Conv2D"] = 4.0;
+  (*calibration.mutable_execution_time_scale())["MatMul"] = 4.0;
+  // The ops run on the GPU, so a CPU calibration doesn't apply to them.
+  calibration.mutable_device()->set_type("CPU");
+  EXPECT_EQ(uncalibrated, predict(calibration));
+  calibration.mutable_device()->set_type("GPU");
+  EXPECT_GT(predict(calibration), uncalibrated);
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
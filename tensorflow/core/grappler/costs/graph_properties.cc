@@ -36,7 +36,9 @@ limitations under the License.
 #include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 namespace grappler {
@@ -934,6 +936,54 @@ class SymbolicShapeRefiner {
       output_node->mutable_attr()->erase("index");
     }
 
+    // With the input shapes and values forwarded, the body alone determines
+    // the result of shape inference, so calls with the same input signature,
+    // and repeated updates of the same call, share it.
+    string serialized_body;
+    SerializeToStringDeterministic(grappler_function_item.graph,
+                                   &serialized_body);
+    const Fprint128 body_fingerprint = Fingerprint128(serialized_body);
+    auto cached = function_output_properties_.find(body_fingerprint);
+    if (cached == function_output_properties_.end()) {
+      std::vector<OpInfo::TensorProperties> output_properties;
+      TF_RETURN_IF_ERROR(InferFunctionOutputProperties(
+          *function_node, grappler_function_item, output_nodes,
+          &output_properties));
+      cached = function_output_properties_
+                   .emplace(body_fingerprint, std::move(output_properties))
+                   .first;
+    }
+
+    // Add return nodes for output shapes.
+    const std::vector<OpInfo::TensorProperties>& output_properties =
+        cached->second;
+    ctx->output_tensors_as_shapes.resize(output_properties.size());
+    ctx->output_tensor_protos.resize(output_properties.size(), nullptr);
+    for (int output = 0; output < output_properties.size(); ++output) {
+      const OpInfo::TensorProperties& outprop = output_properties[output];
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(ic->MakeShapeFromShapeProto(outprop.shape(), &out));
+      ic->set_output(output, out);
+      if (outprop.has_value()) {
+        // Forward tensor value to output_tensors_as_shape.
+        MaybeTensorProtoToShape(ic, outprop.value(),
+                                &ctx->output_tensors_as_shapes[output]);
+        const_tensors_to_propagate_.push_back(outprop.value());
+        ctx->output_tensor_protos[output] = &const_tensors_to_propagate_.back();
+      }
+    }
+
+    return OkStatus();
+  }
+
+  // Runs shape inference on the prepared body of the function called by
+  // `function_node`, and returns the properties of its outputs, with
+  // normalized shapes.
+  Status InferFunctionOutputProperties(
+      const NodeDef& function_node,
+      const GrapplerFunctionItem& grappler_function_item,
+      const absl::flat_hash_map<std::string, NodeDef*>& output_nodes,
+      std::vector<OpInfo::TensorProperties>* output_properties) {
     // Perform inference on function body.
     GraphProperties gp(grappler_function_item);
     TF_RETURN_IF_ERROR(gp.InferStatically(
@@ -941,46 +991,28 @@ class SymbolicShapeRefiner {
         /*aggressive_shape_inference=*/aggressive_shape_inference_,
         /*include_tensor_values=*/true));
 
-    // Add return nodes for output shapes.
-    int output = 0;
-    ctx->output_tensors_as_shapes.resize(grappler_function_item.output_size());
-    ctx->output_tensor_protos.resize(grappler_function_item.output_size(),
-                                     nullptr);
     for (auto const& out_arg : grappler_function_item.outputs()) {
       // It is guaranteed that output_tensors does not contain any control
       // inputs, so port_id >= 0.
       TensorId out_tensor = ParseTensorName(out_arg.node_name);
 
-      if (output_nodes.count(out_tensor.node()) <= 0) {
+      auto retnode = output_nodes.find(out_tensor.node());
+      if (retnode == output_nodes.end()) {
         return errors::FailedPrecondition(
             "Unable to find return function_node ", out_tensor.node(), " for ",
-            function_node->name());
+            function_node.name());
       }
-      const NodeDef* retnode = output_nodes[out_tensor.node()];
 
-      auto output_properties = gp.GetOutputProperties(retnode->name());
-      int output_properties_size = output_properties.size();
-      if (out_tensor.index() >= output_properties_size) {
+      auto properties = gp.GetOutputProperties(retnode->second->name());
+      int properties_size = properties.size();
+      if (out_tensor.index() >= properties_size) {
         return errors::InvalidArgument(
             out_tensor.ToString(), " has invalid position ", out_tensor.index(),
-            " (output_properties.size() = ", output_properties.size(), ").");
-      }
-      auto& outprop = output_properties[out_tensor.index()];
-      TensorShapeProto shape = outprop.shape();
-      NormalizeShapeForOutput(&shape);
-      ShapeHandle out;
-      TF_RETURN_IF_ERROR(ic->MakeShapeFromShapeProto(shape, &out));
-      ic->set_output(output, out);
-      if (outprop.has_value()) {
-        // Forward tensor value to output_tensors_as_shape.
-        MaybeTensorProtoToShape(ic, outprop.value(),
-                                &ctx->output_tensors_as_shapes[output]);
-        const_tensors_to_propagate_.push_back(outprop.value());
-        ctx->output_tensor_protos[output] = &const_tensors_to_propagate_.back();
+            " (output_properties.size() = ", properties.size(), ").");
       }
-      output++;
+      output_properties->push_back(std::move(properties[out_tensor.index()]));
+      NormalizeShapeForOutput(output_properties->back().mutable_shape());
     }
-
     return OkStatus();
   }
 
@@ -2049,6 +2081,11 @@ class SymbolicShapeRefiner {
   // instantiation failed it will have an `absl::nullopt`.
   absl::flat_hash_map<string, absl::optional<GrapplerFunctionItem>>
       fun_to_grappler_function_item_;
+  // The output properties of function bodies prepared by UpdateFunction(),
+  // keyed by the fingerprint of the prepared body.
+  absl::flat_hash_map<Fprint128, std::vector<OpInfo::TensorProperties>,
+                      Fprint128Hasher>
+      function_output_properties_;
   FunctionLibraryDefinition function_library_;
   const absl::flat_hash_map<string, absl::flat_hash_set<int>>& fed_ports_;
   // Store TensorProtos for tensor value propagation. Note that we use deque,
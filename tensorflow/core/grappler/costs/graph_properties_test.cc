@@ -1711,6 +1711,51 @@ TEST_F(GraphPropertiesTest, FunctionWithScalarInput) {
   EXPECT_FALSE(out_prop0.shape().unknown_rank());
 }
 
+// Returns a graph that calls a function computing Square(x) + x on
+// `num_calls` placeholders, whose shapes cycle through `shapes`.
+GrapplerItem MakeFunctionCallsItem(int num_calls,
+                                   const std::vector<TensorShape>& shapes) {
+  FunctionDefLibrary library;
+  *library.add_function() = FunctionDefHelper::Create(
+      "SquarePlusX", {"x: float"}, {"out: float"}, {},
+      {{{"square"}, "Square", {"x"}, {{"T", DataType::DT_FLOAT}}},
+       {{"add"}, "AddV2", {"square:y:0", "x"}, {{"T", DataType::DT_FLOAT}}}},
+      {{"out", "add:z:0"}});
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  TF_CHECK_OK(s.graph()->AddFunctionLibrary(library));
+  for (int i = 0; i < num_calls; ++i) {
+    Output placeholder = ops::Placeholder(
+        s.WithOpName(strings::StrCat("x", i)), DataType::DT_FLOAT,
+        ops::Placeholder::Shape(shapes[i % shapes.size()]));
+    tensorflow::Node* call;
+    TF_CHECK_OK(tensorflow::NodeBuilder(strings::StrCat("call", i),
+                                        "SquarePlusX",
+                                        s.graph()->op_registry())
+                    .Input(tensorflow::ops::AsNodeOut(s, placeholder))
+                    .Finalize(s.graph(), &call));
+  }
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  return item;
+}
+
+TEST_F(GraphPropertiesTest, FunctionCallsWithDifferentInputShapes) {
+  // Calls with the same input shapes share the result of inference on the
+  // function body, which must not leak into calls with other shapes.
+  GrapplerItem item = MakeFunctionCallsItem(
+      6, {TensorShape({2, 3}), TensorShape({7}), TensorShape({})});
+  GraphProperties properties(item);
+  TF_ASSERT_OK(properties.InferStatically(false));
+  const std::vector<string> expected = {"float: [2,3]", "float: [7]",
+                                        "float: []"};
+  for (int i = 0; i < 6; ++i) {
+    const auto out_props =
+        properties.GetOutputProperties(strings::StrCat("call", i));
+    ASSERT_EQ(1, out_props.size());
+    EXPECT_EQ(expected[i % 3], PropToString(out_props[0]));
+  }
+}
+
 TEST_F(GraphPropertiesTest, SimpleFunctionStaticShapeInference) {
   // Test graph produced in python using:
   /*
@@ -2685,6 +2730,18 @@ TEST(HelperFunctions, IsShapeFullyDefinedIntegerVectorOrScalar) {
   EXPECT_FALSE(IsShapeFullyDefinedIntegerVectorOrScalar(
       &ic, fully_defined_vector, vector_with_unknown_from_const, DT_INT32));
 }
+
+void BM_InferStaticallyFunctionCalls(::testing::benchmark::State& state) {
+  const int num_calls = state.range(0);
+  GrapplerItem item = MakeFunctionCallsItem(
+      num_calls, {TensorShape({32, 32}), TensorShape({8, 128})});
+  for (auto s : state) {
+    GraphProperties properties(item);
+    TF_CHECK_OK(properties.InferStatically(false));
+  }
+}
+BENCHMARK(BM_InferStaticallyFunctionCalls)->Arg(100)->Arg(1000)->Arg(10000);
+
 }  // namespace
 }  // namespace grappler
 }  // namespace tensorflow
@@ -0,0 +1,74 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace grappler {
+
+void OpCostCalibrator::AddMeasurements(const GraphDef& graph,
+                                       const CostGraphDef& predicted,
+                                       const StepStats& measured) {
+  absl::flat_hash_map<string, const NodeDef*> nodes;
+  for (const NodeDef& node : graph.node()) nodes[node.name()] = &node;
+
+  absl::flat_hash_map<string, int64_t> measured_micros;
+  for (const auto& dev_stats : measured.dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      // Some devices, e.g. GPUs, report the node name with a suffix such as
+      // ":Conv2D", and may report a node several times.
+      const string& node_name = node_stats.node_name();
+      const string name = node_name.substr(0, node_name.find(':'));
+      const int64_t micros =
+          node_stats.op_end_rel_micros() - node_stats.op_start_rel_micros();
+      int64_t& node_micros = measured_micros[name];
+      node_micros = std::max(node_micros, micros);
+    }
+  }
+
+  for (const auto& cost_node : predicted.node()) {
+    auto node = nodes.find(cost_node.name());
+    auto measured_it = measured_micros.find(cost_node.name());
+    if (node == nodes.end() || measured_it == measured_micros.end()) continue;
+    // A prediction or measurement of 0 carries no information about the
+    // ratio between them.
+    if (cost_node.compute_cost() <= 0 || measured_it->second <= 0) continue;
+    OpTimes& times = op_times_[node->second->op()];
+    times.predicted_micros += cost_node.compute_cost();
+    times.measured_micros += measured_it->second;
+  }
+}
+
+OpCostCalibration OpCostCalibrator::Fit() const {
+  OpCostCalibration calibration;
+  *calibration.mutable_device() = device_;
+  for (const auto& op_times : op_times_) {
+    (*calibration.mutable_execution_time_scale())[op_times.first] =
+        op_times.second.measured_micros / op_times.second.predicted_micros;
+  }
+  return calibration;
+}
+
+Status ReadOpCostCalibration(const string& filename,
+                             OpCostCalibration* calibration) {
+  return ReadTextOrBinaryProto(Env::Default(), filename, calibration);
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
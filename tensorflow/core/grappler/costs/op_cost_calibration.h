@@ -0,0 +1,67 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/cost_graph.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/protobuf/device_properties.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Fits an OpCostCalibration from the costs the analytical cost model predicted
+// for a graph and the costs measured when running it, so that later
+// predictions for the same device can be corrected. The measurements must all
+// come from devices of the type passed to the constructor.
+class OpCostCalibrator {
+ public:
+  explicit OpCostCalibrator(const DeviceProperties& device) : device_(device) {}
+
+  // Adds the costs of the nodes of `graph` predicted in `predicted`, e.g. the
+  // cost graph filled by AnalyticalCostEstimator::PredictCosts(), and measured
+  // in `measured`. Nodes missing from either are ignored.
+  void AddMeasurements(const GraphDef& graph, const CostGraphDef& predicted,
+                       const StepStats& measured);
+
+  // Returns, for each op type with measurements, the ratio of the total
+  // measured time to the total predicted time.
+  OpCostCalibration Fit() const;
+
+ private:
+  struct OpTimes {
+    double predicted_micros = 0;
+    double measured_micros = 0;
+  };
+
+  DeviceProperties device_;
+  absl::flat_hash_map<std::string, OpTimes> op_times_;
+};
+
+// Reads an OpCostCalibration in text or binary format from `filename`.
+Status ReadOpCostCalibration(const std::string& filename,
+                             OpCostCalibration* calibration);
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
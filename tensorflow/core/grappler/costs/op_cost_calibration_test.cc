@@ -0,0 +1,98 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+void AddNode(const string& name, const string& op, int64_t predicted_micros,
+             int64_t measured_micros, GraphDef* graph,
+             CostGraphDef* cost_graph, StepStats* step_stats) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  CostGraphDef::Node* cost_node = cost_graph->add_node();
+  cost_node->set_name(name);
+  cost_node->set_compute_cost(predicted_micros);
+  if (step_stats->dev_stats_size() == 0) step_stats->add_dev_stats();
+  NodeExecStats* node_stats =
+      step_stats->mutable_dev_stats(0)->add_node_stats();
+  node_stats->set_node_name(name);
+  node_stats->set_op_start_rel_micros(10);
+  node_stats->set_op_end_rel_micros(10 + measured_micros);
+}
+
+TEST(OpCostCalibrationTest, Fit) {
+  GraphDef graph;
+  CostGraphDef cost_graph;
+  StepStats step_stats;
+  AddNode("conv1", "Conv2D", 100, 300, &graph, &cost_graph, &step_stats);
+  AddNode("conv2", "Conv2D", 300, 500, &graph, &cost_graph, &step_stats);
+  AddNode("relu", "Relu", 10, 5, &graph, &cost_graph, &step_stats);
+  // Not predicted to take any time, so ignored.
+  AddNode("const", "Const", 0, 2, &graph, &cost_graph, &step_stats);
+
+  DeviceProperties device;
+  device.set_type("GPU");
+  OpCostCalibrator calibrator(device);
+  calibrator.AddMeasurements(graph, cost_graph, step_stats);
+  const OpCostCalibration calibration = calibrator.Fit();
+
+  EXPECT_EQ("GPU", calibration.device().type());
+  const auto& scale = calibration.execution_time_scale();
+  EXPECT_EQ(2, scale.size());
+  EXPECT_DOUBLE_EQ(2.0, scale.at("Conv2D"));
+  EXPECT_DOUBLE_EQ(0.5, scale.at("Relu"));
+}
+
+TEST(OpCostCalibrationTest, NodeNameWithOpSuffix) {
+  GraphDef graph;
+  CostGraphDef cost_graph;
+  StepStats step_stats;
+  AddNode("matmul", "MatMul", 100, 200, &graph, &cost_graph, &step_stats);
+  // GPU kernels are reported as "<node>:<op>".
+  step_stats.mutable_dev_stats(0)->mutable_node_stats(0)->set_node_name(
+      "matmul:MatMul");
+
+  OpCostCalibrator calibrator((DeviceProperties()));
+  calibrator.AddMeasurements(graph, cost_graph, step_stats);
+  EXPECT_DOUBLE_EQ(
+      2.0, calibrator.Fit().execution_time_scale().at("MatMul"));
+}
+
+TEST(OpCostCalibrationTest, ReadFromFile) {
+  OpCostCalibration calibration;
+  calibration.mutable_device()->set_type("CPU");
+  (*calibration.mutable_execution_time_scale())["MatMul"] = 1.5;
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "op_cost_calibration.pbtxt");
+  TF_ASSERT_OK(WriteTextProto(Env::Default(), filename, calibration));
+
+  OpCostCalibration read;
+  TF_ASSERT_OK(ReadOpCostCalibration(filename, &read));
+  EXPECT_EQ("CPU", read.device().type());
+  EXPECT_DOUBLE_EQ(1.5, read.execution_time_scale().at("MatMul"));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -345,6 +345,21 @@ class ArithmeticOptimizerStage : public GraphOptimizerStage<string> {
            tensor->FromProto(node->attr().at("value").tensor());
   }
 
+  // Returns true if input `axis_input` of `node` is a constant 0.
+  bool IsAxis0(const NodeDef& node, int axis_input) {
+    Tensor axis_tensor;
+    if (!GetTensorFromConstNode(node.input(axis_input), &axis_tensor))
+      return false;
+    if (axis_tensor.NumElements() != 1) return false;
+    if (axis_tensor.dtype() == DT_INT32) {
+      return axis_tensor.flat<int32>()(0) == 0;
+    } else if (axis_tensor.dtype() == DT_INT64) {
+      return axis_tensor.flat<int64_t>()(0) == 0;
+    } else {
+      return false;
+    }
+  }
+
  private:
   // Extended context required for ArithmeticOptimizer.
   const ArithmeticOptimizerContext ctx_ext_;
@@ -4209,19 +4224,102 @@ class SimplifyEmbeddingLookupStage : public ArithmeticOptimizerStage {
     return OkStatus();
   }
 
- private:
-  bool IsAxis0(const NodeDef& node, int axis_input) {
-    Tensor axis_tensor;
-    if (!GetTensorFromConstNode(node.input(axis_input), &axis_tensor))
-      return false;
-    if (axis_tensor.NumElements() != 1) return false;
-    if (axis_tensor.dtype() == DT_INT32) {
-      return axis_tensor.flat<int32>()(0) == 0;
-    } else if (axis_tensor.dtype() == DT_INT64) {
-      return axis_tensor.flat<int64_t>()(0) == 0;
-    } else {
-      return false;
-    }
+};
+
+// Gathers indices instead of rows ahead of sparse segment reductions.
+//
+// A sparse segment reduction gathers the rows of its data input by `indices`
+// while it reduces them. So in
+//
+//     gathered_rows = tf.gather(params, ids)
+//     result = tf.sparse.segment_<combiner>(gathered_rows, idx, segment_ids)
+//
+// the [num_ids, dim] `gathered_rows` intermediate can be avoided by gathering
+// the indices into `params` instead, and reducing `params` directly:
+//
+//     result = tf.sparse.segment_<combiner>(
+//          params, tf.gather(ids, idx), segment_ids)
+//
+// SimplifyEmbeddingLookupStage removes the gather altogether when `ids, idx`
+// come from tf.unique(); this stage handles any other `ids`. It only rewrites
+// gathers whose rows feed nothing else, and only on CPU, where the gathered
+// rows are materialized in host memory.
+class FuseGatherIntoSegmentReductionStage : public ArithmeticOptimizerStage {
+ public:
+  explicit FuseGatherIntoSegmentReductionStage(
+      const GraphOptimizerContext& ctx,
+      const ArithmeticOptimizerContext& ctx_ext)
+      : ArithmeticOptimizerStage("FuseGatherIntoSegmentReductionStage", ctx,
+                                 ctx_ext) {}
+  ~FuseGatherIntoSegmentReductionStage() override = default;
+
+  bool IsSupported(const NodeDef* node) const override {
+    return IsAnySparseSegmentReduction(*node);
+  }
+
+  Status TrySimplify(NodeDef* reduction_node,
+                     string* simplified_node_name) override {
+    if (IsInPreserveSet(*reduction_node) || !NodeIsOnCpu(*reduction_node))
+      return OkStatus();
+
+    // Input 0 (data) of the reduction node must be a tf.gather() on the 0th
+    // axis of a tensor, feeding only the reduction node.
+    NodeDef* gather_node = nullptr;
+    TF_RETURN_IF_ERROR(GetInputNode(reduction_node->input(0), &gather_node));
+    const bool is_gather_v2 = gather_node->op() == "GatherV2";
+    if ((gather_node->op() != "Gather" && !is_gather_v2) ||
+        IsInPreserveSet(*gather_node) ||
+        gather_node->device() != reduction_node->device() ||
+        NumNonControlOutputs(*gather_node, *ctx().node_map) != 1)
+      return OkStatus();
+    if (is_gather_v2 && !IsAxis0(*gather_node, 2)) return OkStatus();
+
+    DataType ids_type;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*gather_node, "Tindices", &ids_type));
+    DataType idx_type;
+    TF_RETURN_IF_ERROR(GetNodeAttr(*reduction_node, "Tidx", &idx_type));
+
+    // Gather the ids (input 1 of the gather node) by the indices of the
+    // reduction node, using the same kind of gather.
+    NodeDef* gathered_ids = AddEmptyNode(OptimizedNodeName(
+        ParseNodeScopeAndName(reduction_node->name()), "GatherIndices"));
+    gathered_ids->set_op(gather_node->op());
+    gathered_ids->set_device(gather_node->device());
+    gathered_ids->add_input(gather_node->input(1));
+    gathered_ids->add_input(reduction_node->input(1));
+    ctx().node_map->AddOutput(NodeName(gather_node->input(1)),
+                              gathered_ids->name());
+    ctx().node_map->AddOutput(NodeName(reduction_node->input(1)),
+                              gathered_ids->name());
+    if (is_gather_v2) {
+      gathered_ids->add_input(gather_node->input(2));
+      ctx().node_map->AddOutput(NodeName(gather_node->input(2)),
+                                gathered_ids->name());
+      (*gathered_ids->mutable_attr())["Taxis"] =
+          gather_node->attr().at("Taxis");
+    } else if (gather_node->attr().count("validate_indices")) {
+      (*gathered_ids->mutable_attr())["validate_indices"] =
+          gather_node->attr().at("validate_indices");
+    }
+    SetDataTypeToAttr(ids_type, "Tparams", gathered_ids);
+    SetDataTypeToAttr(idx_type, "Tindices", gathered_ids);
+    ForwardControlDependencies(gathered_ids, {gather_node});
+    AddToOptimizationQueue(gathered_ids);
+
+    // The reduction node now reduces the params of the gather node (input 0)
+    // directly, by the gathered ids.
+    const string old_data = reduction_node->input(0);
+    const string old_indices = reduction_node->input(1);
+    reduction_node->set_input(0, gather_node->input(0));
+    ctx().node_map->UpdateInput(reduction_node->name(), old_data,
+                                gather_node->input(0));
+    reduction_node->set_input(1, gathered_ids->name());
+    ctx().node_map->UpdateInput(reduction_node->name(), old_indices,
+                                gathered_ids->name());
+    SetDataTypeToAttr(ids_type, "Tidx", reduction_node);
+
+    *simplified_node_name = reduction_node->name();
+    return OkStatus();
   }
 };
 
@@ -4364,6 +4462,8 @@ Status ArithmeticOptimizer::SimplifyArithmeticOps(bool can_use_shapes) {
     pipeline.AddStage<RemoveStackSliceSameAxis>(ctx, ctx_ext);
   if (options_.simplify_embedding_lookup)
     pipeline.AddStage<SimplifyEmbeddingLookupStage>(ctx, ctx_ext);
+  if (options_.fuse_gather_into_segment_reduction)
+    pipeline.AddStage<FuseGatherIntoSegmentReductionStage>(ctx, ctx_ext);
   if (options_.remove_cast_into_segment_reduction)
     pipeline.AddStage<RemoveCastIntoSegmentReductionStage>(ctx, ctx_ext);
   if (options_.fuse_squared_diff)
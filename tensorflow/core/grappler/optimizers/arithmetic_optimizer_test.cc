@@ -4789,6 +4789,99 @@ TEST_F(ArithmeticOptimizerTest, SimplifyResourceEmbeddingLookup) {
   }
 }
 
+TEST_F(ArithmeticOptimizerTest, FuseGatherIntoSegmentReduction) {
+  for (bool gather_v2 : {false, true}) {
+    tensorflow::Scope s =
+        tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+    Output embeddings =
+        ops::Const(s.WithOpName("embeddings"),
+                   {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, {3, 2});
+    Output ids = ops::Const(s.WithOpName("ids"), {2, 0, 2});
+    Output idx =
+        ops::Const<int64_t>(s.WithOpName("idx"), {0, 1, 1, 2, 0}, {5});
+    Output segment_ids =
+        ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 2, 2});
+    Output gathered_rows;
+    if (gather_v2) {
+      gathered_rows = ops::GatherV2(s.WithOpName("gathered_rows"), embeddings,
+                                    ids, ops::Const(s.WithOpName("axis"), 0));
+    } else {
+      gathered_rows =
+          ops::Gather(s.WithOpName("gathered_rows"), embeddings, ids);
+    }
+    Output result = ops::SparseSegmentMean(s.WithOpName("result"),
+                                           gathered_rows, idx, segment_ids);
+    Output id = ops::Identity(s.WithOpName("id"), result);
+
+    GrapplerItem item;
+    TF_CHECK_OK(s.ToGraphDef(&item.graph));
+    item.fetch = {"id"};
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+    ASSERT_EQ(tensors_expected.size(), 1);
+
+    GraphDef output;
+    ArithmeticOptimizer optimizer;
+    EnableOnlyFuseGatherIntoSegmentReduction(&optimizer);
+    OptimizeAndPrune(&optimizer, &item, &output);
+
+    const string gathered_ids_name =
+        "ArithmeticOptimizer/FuseGatherIntoSegmentReductionStage_"
+        "GatherIndices_result";
+    bool gathered_ids_found = false;
+    for (const auto& node : output.node()) {
+      if (node.name() == "result") {
+        EXPECT_EQ(node.input(0), "embeddings");
+        EXPECT_EQ(node.input(1), gathered_ids_name);
+        EXPECT_EQ(node.attr().at("Tidx").type(), DT_INT32);
+      }
+      if (node.name() == gathered_ids_name) {
+        gathered_ids_found = true;
+        EXPECT_EQ(node.input(0), "ids");
+        EXPECT_EQ(node.input(1), "idx");
+      }
+      EXPECT_NE(node.name(), "gathered_rows");
+    }
+    EXPECT_TRUE(gathered_ids_found);
+
+    auto tensors = EvaluateNodes(output, item.fetch);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorEqual<float>(tensors[0], tensors_expected[0]);
+  }
+}
+
+TEST_F(ArithmeticOptimizerTest, FuseGatherIntoSegmentReductionSharedGather) {
+  tensorflow::Scope s =
+      tensorflow::Scope::NewRootScope().WithDevice("/device:CPU:0");
+  Output embeddings =
+      ops::Const(s.WithOpName("embeddings"), {1.0f, 2.0f, 3.0f, 4.0f}, {2, 2});
+  Output ids = ops::Const(s.WithOpName("ids"), {1, 0});
+  Output idx = ops::Const(s.WithOpName("idx"), {0, 1, 1});
+  Output segment_ids = ops::Const(s.WithOpName("segment_ids"), {0, 0, 1});
+  Output gathered_rows =
+      ops::Gather(s.WithOpName("gathered_rows"), embeddings, ids);
+  Output result = ops::SparseSegmentSum(s.WithOpName("result"), gathered_rows,
+                                        idx, segment_ids);
+  Output other = ops::Identity(s.WithOpName("other"), gathered_rows);
+  Output id = ops::Identity(s.WithOpName("id"), result);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"id", "other"};
+
+  GraphDef output;
+  ArithmeticOptimizer optimizer;
+  EnableOnlyFuseGatherIntoSegmentReduction(&optimizer);
+  OptimizeAndPrune(&optimizer, &item, &output);
+
+  // The gathered rows are needed anyway, so the graph is left unchanged.
+  for (const auto& node : output.node()) {
+    if (node.name() == "result") {
+      EXPECT_EQ(node.input(0), "gathered_rows");
+      EXPECT_EQ(node.input(1), "idx");
+    }
+  }
+}
+
 TEST_F(ArithmeticOptimizerTest, RemoveCastIntoSegmentReduction) {
   for (DataType indices_type : {DT_INT32, DT_INT64}) {
     for (DataType segment_ids_type : {DT_INT32, DT_INT64}) {
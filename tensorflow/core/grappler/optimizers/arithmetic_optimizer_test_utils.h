@@ -243,6 +243,12 @@ class ArithmeticOptimizerTest : public GrapplerTest {
     optimizer->options_.simplify_embedding_lookup = true;
   }
 
+  void EnableOnlyFuseGatherIntoSegmentReduction(
+      ArithmeticOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.fuse_gather_into_segment_reduction = true;
+  }
+
   void EnableOnlyRemoveCastIntoSegmentReduction(
       ArithmeticOptimizer* optimizer) {
     DisableAllStages(optimizer);
@@ -278,6 +284,7 @@ class ArithmeticOptimizerTest : public GrapplerTest {
     options.simplify_aggregation = false;
     options.unary_ops_composition = false;
     options.simplify_embedding_lookup = false;
+    options.fuse_gather_into_segment_reduction = false;
     options.remove_cast_into_segment_reduction = false;
     optimizer->options_ = options;
   }
@@ -17,7 +17,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
@@ -35,8 +37,10 @@ limitations under the License.
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/constant_folding_cache.h"
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/symbolic_shapes.h"
@@ -59,8 +63,11 @@ namespace tensorflow {
 namespace grappler {
 using TensorVector = gtl::InlinedVector<TensorValue, 4>;
 
-// We only fold/materialize constants smaller than 100kB.
+// We only fold/materialize constants smaller than 100kB, unless the compute
+// saved by folding them is worth the growth of the graph. Even then, folded
+// constants are kept under 1MB.
 const int64_t kMaxConstantSize = 100 * 1024;
+const int64_t kMaxFoldedConstantSize = 10 * kMaxConstantSize;
 
 namespace {
 template <typename T>
@@ -1026,10 +1033,12 @@ bool ConstantFolding::IsFoldableUncached(
       if (output_shape.IsFullyDefined()) {
         const int64_t num_bytes =
             output_shape.num_elements() * DataTypeSize(output_prop.dtype());
-        if (num_bytes > input_size_bytes && num_bytes > kMaxConstantSize) {
+        if (num_bytes > input_size_bytes &&
+            num_bytes > kMaxFoldedConstantSize) {
           // Do not fold nodes if the in-memory size of output is too large.
           // Notice that this is not exactly the same check used in
-          // CreateNodeDef() where the actual encoded size is checked.
+          // CreateNodeDef() where the actual encoded size and the cost of the
+          // node are checked.
           return false;
         }
       }
@@ -1236,7 +1245,8 @@ bool IsValidConstShapeForMulConvPushDown(
 // static
 Status ConstantFolding::CreateNodeDef(const string& name,
                                       const TensorValue& tensor, NodeDef* node,
-                                      size_t original_size) {
+                                      size_t original_size,
+                                      int64_t max_constant_size) {
   node->set_name(name);
   node->set_op("Const");
 
@@ -1315,10 +1325,10 @@ Status ConstantFolding::CreateNodeDef(const string& name,
   }
   node->mutable_attr()->insert({"value", attr_tensor});
 
-  if (encoded_size > original_size && encoded_size >= kMaxConstantSize) {
+  if (encoded_size > original_size && encoded_size >= max_constant_size) {
     return errors::InvalidArgument(
         strings::StrCat("Can't fold ", name, ", its size would be too large (",
-                        encoded_size, " >= ", kMaxConstantSize, " bytes)"));
+                        encoded_size, " >= ", max_constant_size, " bytes)"));
   }
   return OkStatus();
 }
@@ -1330,6 +1340,82 @@ Status ConstantFolding::EvaluateNode(const NodeDef& node,
                                               resource_mgr_.get(), output);
 }
 
+Status ConstantFolding::EvaluateNodeOrReadFromCache(
+    const NodeDef& node, const TensorVector& inputs,
+    TensorVector* output) const {
+  ConstantFoldingCache* cache = ConstantFoldingCache::Global();
+  if (cache == nullptr) return EvaluateNode(node, inputs, output);
+
+  std::vector<const Tensor*> input_tensors;
+  for (const auto& input : inputs) input_tensors.push_back(input.tensor);
+  const string key = ConstantFoldingCache::Key(node, input_tensors);
+  if (key.empty()) return EvaluateNode(node, inputs, output);
+
+  std::vector<Tensor> cached;
+  if (cache->Lookup(key, &cached)) {
+    VLOG(2) << "Read the outputs of " << node.name() << " from the cache";
+    for (const Tensor& tensor : cached) {
+      output->push_back(TensorValue(new Tensor(tensor)));
+    }
+    return OkStatus();
+  }
+
+  TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, output));
+  // Dead outputs, e.g. of a Switch, are not cached.
+  std::vector<Tensor> outputs;
+  for (const auto& tensor : *output) {
+    if (tensor.tensor == nullptr) return OkStatus();
+    outputs.push_back(*tensor.tensor);
+  }
+  cache->Insert(key, outputs);
+  return OkStatus();
+}
+
+namespace {
+
+// The bytes of folded constant worth one nanosecond of compute on a nominal
+// 1 GFLOPS core: about what a core streams from memory in that time, so that
+// reading the constant is not slower than computing it.
+constexpr double kFoldedBytesPerComputeNanosecond = 1.0;
+
+// Returns the largest constant that `node` may be folded into, given the
+// compute saved by not evaluating it on `inputs` at runtime. Nodes whose cost
+// is unknown get the fixed kMaxConstantSize.
+int64_t MaxFoldedConstantSize(const NodeDef& node, const TensorVector& inputs,
+                              const TensorVector& outputs) {
+  OpContext op_context;
+  op_context.name = node.name();
+  op_context.op_info.set_op(node.op());
+  *op_context.op_info.mutable_attr() = node.attr();
+  // A fixed device, so that the folding decisions don't depend on the machine
+  // running Grappler.
+  DeviceProperties* device = op_context.op_info.mutable_device();
+  device->set_type("CPU");
+  device->set_num_cores(1);
+  device->set_frequency(1000);
+  for (const auto& input : inputs) {
+    OpInfo::TensorProperties* properties = op_context.op_info.add_inputs();
+    properties->set_dtype(input->dtype());
+    input->shape().AsProto(properties->mutable_shape());
+  }
+  for (const auto& output : outputs) {
+    if (output.tensor == nullptr) continue;
+    OpInfo::TensorProperties* properties = op_context.op_info.add_outputs();
+    properties->set_dtype(output->dtype());
+    output->shape().AsProto(properties->mutable_shape());
+  }
+
+  static const OpLevelCostEstimator* estimator = new OpLevelCostEstimator();
+  const Costs costs = estimator->PredictCosts(op_context);
+  if (costs.inaccurate) return kMaxConstantSize;
+  const double max_size =
+      costs.compute_time.count() * kFoldedBytesPerComputeNanosecond;
+  if (max_size >= kMaxFoldedConstantSize) return kMaxFoldedConstantSize;
+  return std::max<int64_t>(max_size, kMaxConstantSize);
+}
+
+}  // namespace
+
 Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
                                             std::vector<NodeDef>* outputs,
                                             bool* result_too_large) {
@@ -1384,10 +1470,13 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     total_inputs_size += value->TotalBytes();
   }
 
-  TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+  TF_RETURN_IF_ERROR(
+      EvaluateNodeOrReadFromCache(node, inputs, &output_tensors));
   if (output_tensors.empty()) {
     return Status(error::INVALID_ARGUMENT, "Expected at least one output.");
   }
+  const int64_t max_constant_size =
+      MaxFoldedConstantSize(node, inputs, output_tensors);
 
   outputs->resize(output_tensors.size());
   for (size_t i = 0; i < output_tensors.size(); i++) {
@@ -1397,7 +1486,7 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     }
     if (output_tensors[i].tensor) {
       Status s = CreateNodeDef(node_name, output_tensors[i], &outputs->at(i),
-                               total_inputs_size);
+                               total_inputs_size, max_constant_size);
       if (!s.ok()) {
         *result_too_large = true;
         return s;
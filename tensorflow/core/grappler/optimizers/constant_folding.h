@@ -34,14 +34,16 @@ namespace grappler {
 const char kConstantFoldingConst[] = "ConstantFolding";
 const char kConstantFoldingCtrl[] = "ConstantFoldingCtrl";
 extern const int64_t kMaxConstantSize;
+extern const int64_t kMaxFoldedConstantSize;
 
 // Constant folding optimization for a graph.
 class ConstantFolding : public GraphOptimizer {
  public:
-  // The size limit will only be considered if the newly created node is greater
-  // than original_size (optional).
+  // The size limit, max_constant_size, will only be considered if the newly
+  // created node is greater than original_size (optional).
   static Status CreateNodeDef(const string& name, const TensorValue& tensor,
-                              NodeDef* node, size_t original_size = 0);
+                              NodeDef* node, size_t original_size = 0,
+                              int64_t max_constant_size = kMaxConstantSize);
   static string AddControlDependency(const string& input_name, GraphDef* graph,
                                      NodeMap* node_map);
 
@@ -92,6 +94,11 @@ class ConstantFolding : public GraphOptimizer {
                       const gtl::InlinedVector<TensorValue, 4>& inputs,
                       gtl::InlinedVector<TensorValue, 4>* output) const;
 
+  // Evaluates `node`, or reads its outputs from the constant folding cache.
+  Status EvaluateNodeOrReadFromCache(
+      const NodeDef& node, const gtl::InlinedVector<TensorValue, 4>& inputs,
+      gtl::InlinedVector<TensorValue, 4>* output) const;
+
   Status EvaluateOneFoldable(const NodeDef& node, std::vector<NodeDef>* outputs,
                              bool* result_too_large);
 
@@ -0,0 +1,133 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/constant_folding_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+constexpr int64_t kDefaultCapacityBytes = 32 * 1024 * 1024;
+
+// Appends `piece` to `material` with its length, so that different sequences
+// of pieces never produce the same material.
+void AddPiece(StringPiece piece, string* material) {
+  absl::StrAppend(material, piece.size(), ":", piece);
+}
+
+bool CallsFunction(const AttrValue& attr) {
+  return attr.has_func() || attr.list().func_size() > 0;
+}
+
+int64_t TotalBytes(const std::vector<Tensor>& tensors) {
+  int64_t bytes = 0;
+  for (const Tensor& tensor : tensors) bytes += tensor.TotalBytes();
+  return bytes;
+}
+
+}  // namespace
+
+ConstantFoldingCache::ConstantFoldingCache(int64_t capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+ConstantFoldingCache* ConstantFoldingCache::Global() {
+  static ConstantFoldingCache* cache = []() -> ConstantFoldingCache* {
+    int64_t capacity_bytes = 0;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_CONSTANT_FOLDING_CACHE_BYTES",
+                                    kDefaultCapacityBytes, &capacity_bytes));
+    if (capacity_bytes <= 0) return nullptr;
+    VLOG(1) << "Caching up to " << capacity_bytes
+            << " bytes of constant folding results";
+    return new ConstantFoldingCache(capacity_bytes);
+  }();
+  return cache;
+}
+
+string ConstantFoldingCache::Key(const NodeDef& node,
+                                 const std::vector<const Tensor*>& inputs) {
+  string material;
+  AddPiece(node.op(), &material);
+
+  // Internal attrs, e.g. _output_shapes or _class, don't change the result.
+  std::vector<std::pair<string, const AttrValue*>> attrs;
+  for (const auto& attr : node.attr()) {
+    if (CallsFunction(attr.second)) return "";
+    if (absl::StartsWith(attr.first, "_")) continue;
+    attrs.emplace_back(attr.first, &attr.second);
+  }
+  std::sort(attrs.begin(), attrs.end());
+  AddPiece(absl::StrCat(attrs.size()), &material);
+  for (const auto& attr : attrs) {
+    string serialized;
+    SerializeToStringDeterministic(*attr.second, &serialized);
+    AddPiece(attr.first, &material);
+    AddPiece(serialized, &material);
+  }
+
+  AddPiece(absl::StrCat(inputs.size()), &material);
+  for (const Tensor* input : inputs) {
+    if (!DataTypeCanUseMemcpy(input->dtype())) return "";
+    AddPiece(DataTypeString(input->dtype()), &material);
+    AddPiece(input->shape().DebugString(), &material);
+    AddPiece(input->tensor_data(), &material);
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(material);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+bool ConstantFoldingCache::Lookup(const string& key,
+                                  std::vector<Tensor>* outputs) {
+  mutex_lock lock(mu_);
+  auto it = outputs_.find(key);
+  if (it == outputs_.end()) return false;
+  *outputs = it->second;
+  return true;
+}
+
+void ConstantFoldingCache::Insert(const string& key,
+                                  const std::vector<Tensor>& outputs) {
+  const int64_t bytes = TotalBytes(outputs);
+  if (bytes > capacity_bytes_) return;
+  mutex_lock lock(mu_);
+  auto it = outputs_.find(key);
+  if (it != outputs_.end()) {
+    size_bytes_ -= TotalBytes(it->second);
+    outputs_.erase(it);
+  }
+  if (size_bytes_ + bytes > capacity_bytes_) {
+    outputs_.clear();
+    size_bytes_ = 0;
+  }
+  outputs_.emplace(key, outputs);
+  size_bytes_ += bytes;
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A process-wide cache of the tensors computed by constant folding, keyed by
+// a fingerprint of the folded node and the values of its inputs. The same
+// constant subgraphs are folded again in every function that contains them and
+// in every run of the meta optimizer, and evaluating them, e.g. large
+// initializers, can dominate the time spent in constant folding.
+//
+// The cache is bounded by the total size of the tensors it holds, 32MB by
+// default, and cleared when full. TF_CONSTANT_FOLDING_CACHE_BYTES overrides
+// the bound, 0 disables the cache.
+class ConstantFoldingCache {
+ public:
+  explicit ConstantFoldingCache(int64_t capacity_bytes);
+
+  // Returns the cache configured by the environment, or nullptr if caching is
+  // disabled.
+  static ConstantFoldingCache* Global();
+
+  // Returns the key of evaluating `node` on `inputs`, or an empty string if
+  // the evaluation can't be cached, e.g. because the node calls a function or
+  // an input isn't a plain buffer. The name and device of the node are not
+  // part of the key.
+  static string Key(const NodeDef& node,
+                    const std::vector<const Tensor*>& inputs);
+
+  // Returns true and sets `outputs` if the outputs of an evaluation are cached
+  // under `key`. The tensors share their buffers with the cache.
+  bool Lookup(const string& key, std::vector<Tensor>* outputs);
+
+  // Caches `outputs` under `key`, unless they are larger than the cache.
+  void Insert(const string& key, const std::vector<Tensor>& outputs);
+
+ private:
+  const int64_t capacity_bytes_;
+  mutex mu_;
+  int64_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<string, std::vector<Tensor>> outputs_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_CONSTANT_FOLDING_CACHE_H_
@@ -0,0 +1,88 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/constant_folding_cache.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+NodeDef MakeNode(DataType type) {
+  NodeDef node;
+  node.set_name("add");
+  node.set_op("Add");
+  (*node.mutable_attr())["T"].set_type(type);
+  return node;
+}
+
+TEST(ConstantFoldingCacheTest, KeyDependsOnNodeAndInputs) {
+  const Tensor a = test::AsTensor<float>({1, 2, 3});
+  const Tensor b = test::AsTensor<float>({4, 5, 6});
+  const NodeDef node = MakeNode(DT_FLOAT);
+  const string key = ConstantFoldingCache::Key(node, {&a, &b});
+  ASSERT_FALSE(key.empty());
+
+  // The name, device and internal attrs of the node don't matter.
+  NodeDef renamed = node;
+  renamed.set_name("other_add");
+  renamed.set_device("/device:GPU:0");
+  (*renamed.mutable_attr())["_output_shapes"].mutable_list();
+  EXPECT_EQ(key, ConstantFoldingCache::Key(renamed, {&a, &b}));
+
+  NodeDef other_op = node;
+  other_op.set_op("Sub");
+  EXPECT_NE(key, ConstantFoldingCache::Key(other_op, {&a, &b}));
+  EXPECT_NE(key, ConstantFoldingCache::Key(MakeNode(DT_INT32), {&a, &b}));
+  EXPECT_NE(key, ConstantFoldingCache::Key(node, {&b, &a}));
+  const Tensor reshaped = test::AsTensor<float>({1, 2, 3}, {3, 1});
+  EXPECT_NE(key, ConstantFoldingCache::Key(node, {&reshaped, &b}));
+
+  // Functions and strings are not cached.
+  NodeDef call = node;
+  (*call.mutable_attr())["f"].mutable_func()->set_name("f");
+  EXPECT_TRUE(ConstantFoldingCache::Key(call, {&a, &b}).empty());
+  const Tensor s = test::AsTensor<tstring>({"a"});
+  EXPECT_TRUE(ConstantFoldingCache::Key(node, {&s}).empty());
+}
+
+TEST(ConstantFoldingCacheTest, LookupAndInsert) {
+  ConstantFoldingCache cache(/*capacity_bytes=*/16);
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(cache.Lookup("a", &outputs));
+
+  cache.Insert("a", {test::AsTensor<float>({1, 2})});
+  ASSERT_TRUE(cache.Lookup("a", &outputs));
+  ASSERT_EQ(outputs.size(), 1);
+  test::ExpectTensorEqual<float>(outputs[0], test::AsTensor<float>({1, 2}));
+
+  // Too large to be cached.
+  cache.Insert("b", {test::AsTensor<float>({1, 2, 3, 4, 5})});
+  EXPECT_FALSE(cache.Lookup("b", &outputs));
+
+  // Clears the cache when full.
+  cache.Insert("c", {test::AsTensor<float>({1, 2, 3})});
+  EXPECT_FALSE(cache.Lookup("a", &outputs));
+  EXPECT_TRUE(cache.Lookup("c", &outputs));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -2929,6 +2929,51 @@ TEST_F(ConstantFoldingTest, LargeConstantNoSizeIncrease) {
   EXPECT_LT(output.ByteSizeLong(), sizeof(float) * large_constant_size + 500);
 }
 
+TEST_F(ConstantFoldingTest, LargeConstantWorthTheCompute) {
+  // Both nodes produce a 400x400 matrix larger than kMaxConstantSize and than
+  // their inputs. Folding the MatMul saves enough compute to be worth it,
+  // folding the Add doesn't.
+  tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
+  Output a = ops::Const(scope.WithOpName("a"),
+                        GenerateRandomTensor<DT_FLOAT>({400, 64}));
+  Output b = ops::Const(scope.WithOpName("b"),
+                        GenerateRandomTensor<DT_FLOAT>({64, 400}));
+  Output matmul = ops::MatMul(scope.WithOpName("matmul"), a, b);
+  Output c = ops::Const(scope.WithOpName("c"),
+                        GenerateRandomTensor<DT_FLOAT>({400, 1}));
+  Output d = ops::Const(scope.WithOpName("d"),
+                        GenerateRandomTensor<DT_FLOAT>({1, 400}));
+  Output add = ops::Add(scope.WithOpName("add"), c, d);
+
+  GrapplerItem item;
+  item.fetch = {"matmul", "add"};
+  TF_CHECK_OK(scope.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "matmul") {
+      EXPECT_EQ(node.op(), "Const");
+      ++found;
+    } else if (node.name() == "add") {
+      EXPECT_EQ(node.op(), "Add");
+      ++found;
+    }
+  }
+  EXPECT_EQ(found, 2);
+  EXPECT_LT(kMaxConstantSize, 400 * 400 * 4);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 2);
+  ASSERT_EQ(tensors.size(), 2);
+  test::ExpectClose(tensors_expected[0], tensors[0]);
+  test::ExpectTensorEqual<float>(tensors_expected[1], tensors[1]);
+}
+
 TEST_F(ConstantFoldingTest, MaterializeBroadcastGradientArgs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a =
@@ -442,6 +442,8 @@ const auto* kDeterministicAttrOps = new absl::flat_hash_set<string>{
     "ParallelInterleaveDatasetV4",
     "ParallelMapDatasetV2",
     "ParallelBatchDataset",
+    "ShuffleDatasetV3",
+    "ShuffleAndRepeatDatasetV2",
 };
 }  // anonymous namespace
 
@@ -0,0 +1,223 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/op_types.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDataset[] = "ParallelMapDatasetV2";
+constexpr char kMapDefun[] = "MapDefun";
+constexpr char kMapDefunNodeName[] = "map_defun";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+
+bool IsMap(const NodeDef& node) {
+  return node.op() == kMapDataset || node.op() == kParallelMapDataset;
+}
+
+bool IsBatch(const NodeDef& node) {
+  return node.op() == "BatchDataset" || node.op() == "BatchDatasetV2";
+}
+
+// Returns true if the elements produced by `node` can be batched before the
+// map, i.e. all of their components are dense tensors of a static shape.
+bool CanBatchElements(const NodeDef& node) {
+  const AttrValue* types = gtl::FindOrNull(node.attr(), kOutputTypes);
+  const AttrValue* shapes = gtl::FindOrNull(node.attr(), kOutputShapes);
+  if (types == nullptr || shapes == nullptr ||
+      types->list().type_size() == 0 ||
+      types->list().type_size() != shapes->list().shape_size()) {
+    return false;
+  }
+  for (int i = 0; i < types->list().type_size(); ++i) {
+    const DataType type = types->list().type(i);
+    if (type == DT_VARIANT || type == DT_RESOURCE) return false;
+    if (!PartialTensorShape(shapes->list().shape(i)).IsFullyDefined()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Creates a function with the signature of `map_node`'s function, except that
+// its component arguments and return values have an extra leading dimension,
+// which applies the function to every slice along that dimension.
+FunctionDef MakeVectorizedFunction(const NodeDef& map_node,
+                                   const AttrValue& input_types,
+                                   const FunctionDefLibrary& library) {
+  FunctionDef vectorized;
+  graph_utils::SetUniqueGraphFunctionName(
+      strings::StrCat("vectorized_", map_node.attr().at("f").func().name()),
+      &library, &vectorized);
+  OpDef* signature = vectorized.mutable_signature();
+
+  NodeDef* map_defun = vectorized.add_node_def();
+  map_defun->set_name(kMapDefunNodeName);
+  map_defun->set_op(kMapDefun);
+
+  DataTypeVector arguments;
+  for (int i = 0; i < input_types.list().type_size(); ++i) {
+    OpDef::ArgDef* arg = signature->add_input_arg();
+    arg->set_name(strings::StrCat("args_", i));
+    arg->set_type(input_types.list().type(i));
+    map_defun->add_input(arg->name());
+    arguments.push_back(arg->type());
+  }
+  DataTypeVector captured;
+  const AttrValue& targuments = map_node.attr().at("Targuments");
+  for (int i = 0; i < targuments.list().type_size(); ++i) {
+    OpDef::ArgDef* arg = signature->add_input_arg();
+    arg->set_name(strings::StrCat("captured_", i));
+    arg->set_type(targuments.list().type(i));
+    map_defun->add_input(arg->name());
+    captured.push_back(arg->type());
+  }
+  AddNodeAttr("Targuments", arguments, map_defun);
+  AddNodeAttr("Tcaptured", captured, map_defun);
+  for (auto key : {"f", kOutputShapes, kOutputTypes}) {
+    graph_utils::CopyAttribute(key, map_node, map_defun);
+  }
+
+  const AttrValue& output_types = map_node.attr().at(kOutputTypes);
+  for (int i = 0; i < output_types.list().type_size(); ++i) {
+    OpDef::ArgDef* ret = signature->add_output_arg();
+    ret->set_name(strings::StrCat("output_", i));
+    ret->set_type(output_types.list().type(i));
+    (*vectorized.mutable_ret())[ret->name()] =
+        strings::StrCat(kMapDefunNodeName, ":output:", i);
+  }
+  return vectorized;
+}
+
+// Creates a copy of `batch_node` that batches the input of `map_node`.
+NodeDef MakeBatchNode(const NodeDef& map_node, const NodeDef& batch_node,
+                      const NodeDef& input_node, MutableGraphView* graph) {
+  NodeDef new_batch = batch_node;
+  graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph->graph(),
+                                      &new_batch);
+  new_batch.set_input(0, map_node.input(0));
+
+  // The batch dimension is the same for every component.
+  const TensorShapeProto& batch_shape =
+      batch_node.attr().at(kOutputShapes).list().shape(0);
+  const int64_t batch_dim =
+      batch_shape.unknown_rank() || batch_shape.dim_size() == 0
+          ? -1
+          : batch_shape.dim(0).size();
+  AttrValue output_shapes;
+  for (const TensorShapeProto& shape :
+       input_node.attr().at(kOutputShapes).list().shape()) {
+    TensorShapeProto* batched = output_shapes.mutable_list()->add_shape();
+    batched->add_dim()->set_size(batch_dim);
+    for (const auto& dim : shape.dim()) *batched->add_dim() = dim;
+  }
+  (*new_batch.mutable_attr())[kOutputShapes] = std::move(output_shapes);
+  graph_utils::CopyAttribute(kOutputTypes, input_node, &new_batch);
+  return new_batch;
+}
+
+// Creates a copy of `map_node` that applies `function` to the output of
+// `new_batch` and produces the elements of `batch_node`.
+NodeDef MakeMapNode(const NodeDef& map_node, const NodeDef& batch_node,
+                    const NodeDef& new_batch, const FunctionDef& function,
+                    MutableGraphView* graph) {
+  NodeDef new_map = map_node;
+  graph_utils::SetUniqueGraphNodeName(map_node.op(), graph->graph(), &new_map);
+  new_map.set_input(0, new_batch.name());
+  (*new_map.mutable_attr())["f"].mutable_func()->set_name(
+      function.signature().name());
+  (*new_map.mutable_attr())["f"].mutable_func()->clear_attr();
+  graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map);
+  graph_utils::MaybeSetFusedMetadata(map_node, batch_node, &new_map);
+  return new_map;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+
+  // Functions of dataset ops are optimized when the pipeline is, so only the
+  // main dataset pipeline is rewritten.
+  if (graph_utils::IsItemDerivedFromFunctionDef(item, graph)) return OkStatus();
+
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+  for (const NodeDef& node : item.graph.node()) {
+    if (!IsBatch(node)) continue;
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || !IsMap(*map_node) ||
+        graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true).size() !=
+            1) {
+      continue;
+    }
+    const FunctionDef* function =
+        function_library.Find(map_node->attr().at("f").func().name());
+    if (function == nullptr ||
+        function_utils::IsFunctionStateful(function_library, *function, true)) {
+      continue;
+    }
+    NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    if (input_node == nullptr || !CanBatchElements(*input_node) ||
+        batch_node.attr().at(kOutputShapes).list().shape_size() == 0) {
+      continue;
+    }
+
+    FunctionDef vectorized = MakeVectorizedFunction(
+        *map_node, input_node->attr().at(kOutputTypes), output->library());
+    NodeDef* new_batch = graph.AddNode(
+        MakeBatchNode(*map_node, batch_node, *input_node, &graph));
+    NodeDef* new_map = graph.AddNode(
+        MakeMapNode(*map_node, batch_node, *new_batch, vectorized, &graph));
+    *output->mutable_library()->add_function() = std::move(vectorized);
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(batch_node.name(), new_map->name()));
+
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
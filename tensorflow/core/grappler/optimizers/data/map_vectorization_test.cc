@@ -0,0 +1,161 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+NodeDef MakeRangeNode(StringPiece name, const PartialTensorShape& shape) {
+  return NDef(name, "RangeDataset", {"start", "stop", "step"},
+              {{"output_shapes", gtl::ArraySlice<PartialTensorShape>{shape}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}});
+}
+
+NodeDef MakeMapNode(StringPiece name, StringPiece input_node_name,
+                    StringPiece function_name) {
+  return NDef(name, "MapDataset", {string(input_node_name)},
+              {{"f", FunctionDefHelper::FunctionRef(string(function_name),
+                                                     {{"T", DT_INT64}})},
+               {"Targuments", gtl::ArraySlice<DataType>{}},
+               {"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                     PartialTensorShape({})}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}});
+}
+
+NodeDef MakeBatchNode(StringPiece name, StringPiece input_node_name) {
+  return NDef(name, "BatchDatasetV2",
+              {string(input_node_name), "batch_size", "drop_remainder"},
+              {{"parallel_copy", false},
+               {"output_shapes", gtl::ArraySlice<PartialTensorShape>{
+                                     PartialTensorShape({-1})}},
+               {"output_types", gtl::ArraySlice<DataType>{DT_INT64}}});
+}
+
+GraphDef MakeGraph(const PartialTensorShape& range_shape,
+                   StringPiece function_name) {
+  return test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       MakeRangeNode("range", range_shape),
+       MakeMapNode("map", "range", function_name),
+       MakeBatchNode("batch", "map"), NDef("Sink", "Identity", {"batch"}, {})},
+      // FunctionLib
+      {
+          test::function::XTimesTwo(),
+          test::function::RandomUniform(),
+      });
+}
+
+TEST(MapVectorizationTest, VectorizesMap) {
+  GrapplerItem item;
+  item.graph = MakeGraph(PartialTensorShape({}), "XTimesTwo");
+  item.fetch.push_back("Sink");
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+
+  // The batch now reads from the range and the map from the batch.
+  const NodeDef& new_batch = output.node(
+      graph_utils::FindGraphNodeWithOp("BatchDatasetV2", output));
+  const NodeDef& new_map =
+      output.node(graph_utils::FindGraphNodeWithOp("MapDataset", output));
+  EXPECT_EQ(new_batch.input(0), "range");
+  EXPECT_EQ(new_batch.input(1), "batch_size");
+  EXPECT_EQ(new_map.input(0), new_batch.name());
+  EXPECT_EQ(PartialTensorShape(
+                new_batch.attr().at("output_shapes").list().shape(0))
+                .DebugString(),
+            "[?]");
+  const NodeDef& sink =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  EXPECT_EQ(sink.input(0), new_map.name());
+
+  // The map function applies the original function with MapDefun.
+  const string& function_name = new_map.attr().at("f").func().name();
+  const int function_index =
+      graph_utils::FindGraphFunctionWithName(function_name, output.library());
+  ASSERT_NE(function_index, -1);
+  const FunctionDef& function = output.library().function(function_index);
+  ASSERT_EQ(function.node_def_size(), 1);
+  const NodeDef& map_defun = function.node_def(0);
+  EXPECT_EQ(map_defun.op(), "MapDefun");
+  EXPECT_EQ(map_defun.attr().at("f").func().name(), "XTimesTwo");
+  EXPECT_EQ(function.signature().input_arg_size(), 1);
+  EXPECT_EQ(function.signature().input_arg(0).type(), DT_INT64);
+  EXPECT_EQ(function.ret().at(function.signature().output_arg(0).name()),
+            "map_defun:output:0");
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeStatefulFunction) {
+  GrapplerItem item;
+  item.graph = MakeGraph(PartialTensorShape({}), "RandomUniformFn");
+  item.fetch.push_back("Sink");
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeUnknownShapes) {
+  // Elements of different shapes cannot be batched before the map.
+  GrapplerItem item;
+  item.graph = MakeGraph(PartialTensorShape({-1}), "XTimesTwo");
+  item.fetch.push_back("Sink");
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, DoesNotVectorizeMapWithOtherConsumers) {
+  GrapplerItem item;
+  item.graph = MakeGraph(PartialTensorShape({}), "XTimesTwo");
+  *item.graph.add_node() = NDef("Sink2", "Identity", {"map"}, {});
+  item.fetch.push_back("Sink");
+  item.fetch.push_back("Sink2");
+
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -40,6 +40,7 @@ constexpr char kShuffleAndRepeatDataset[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
 constexpr char kReshuffleEachIteration[] = "reshuffle_each_iteration";
+constexpr char kDeterministic[] = "deterministic";
 
 Status FuseShuffleV1AndRepeat(const NodeDef& shuffle_node,
                               const NodeDef& repeat_node,
@@ -146,6 +147,11 @@ Status FuseShuffleV3AndRepeat(const NodeDef& shuffle_node,
   graph_utils::CopyShapesAndTypesAttrs(shuffle_node, fused_node);
   graph_utils::CopyAttribute(kReshuffleEachIteration, shuffle_node, fused_node);
 
+  // Optionally set the `deterministic` attribute.
+  if (shuffle_node.attr().contains(kDeterministic)) {
+    graph_utils::CopyAttribute(kDeterministic, shuffle_node, fused_node);
+  }
+
   // Optionally set the `metadata` attribute.
   graph_utils::MaybeSetFusedMetadata(shuffle_node, repeat_node, fused_node);
 
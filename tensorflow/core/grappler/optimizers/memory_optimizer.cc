@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 
 #include <algorithm>
+#include <map>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -440,9 +441,136 @@ void RecomputeSubgraph(
   }
 }
 
+// Runs `item` on a virtual cluster with the devices of `cluster`, and returns
+// the simulated step stats in `metadata`.
+bool SimulateStep(Cluster* cluster, const GrapplerItem& item,
+                  RunMetadata* metadata) {
+  VirtualCluster vcluster(cluster->GetDevices());
+  if (!vcluster.Provision().ok()) {
+    return false;
+  }
+  if (!vcluster.Initialize(item).ok()) {
+    return false;
+  }
+  Status s = vcluster.Run(item.graph, item.feed, item.fetch, metadata);
+  return s.ok() || s.code() == error::RESOURCE_EXHAUSTED;
+}
+
+// A node whose outputs are live at the peak memory usage of a device, and are
+// read by target nodes.
+struct RecomputeCandidate {
+  string node;
+  int64_t memory_saved = 0;
+  Costs::NanoSeconds compute_cost;
+};
+
+// Chooses the nodes to recompute from the memory timeline and op costs of a
+// simulated step, so that the peak memory usage of each GPU fits in its memory
+// with as little recomputation as possible. Candidates are the nodes accepted
+// by `is_candidate` whose outputs are live at the peak and read by target
+// nodes, picked in order of compute cost per byte of memory saved. Returns
+// false if the memory usage or the op costs can not be inferred, and true with
+// no nodes if every device already fits.
+bool SelectNodesToRecompute(
+    Cluster* cluster, const GrapplerItem& item,
+    const std::function<bool(const NodeDef&)>& is_candidate,
+    const std::function<bool(const NodeDef&)>& is_target,
+    std::unordered_set<string>* nodes_to_recompute) {
+  if (item.fetch.empty()) {
+    return false;
+  }
+  GraphMemory memory(item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return false;
+  }
+  RunMetadata metadata;
+  if (!SimulateStep(cluster, item, &metadata)) {
+    return false;
+  }
+  std::unordered_map<string, Costs::NanoSeconds> compute_costs;
+  for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+    for (const auto& node_stats : dev_stats.node_stats()) {
+      compute_costs.emplace(
+          node_stats.node_name(),
+          Costs::MicroSeconds(node_stats.op_end_rel_micros() -
+                              node_stats.op_start_rel_micros()));
+    }
+  }
+
+  ImmutableNodeMap node_map(&item.graph);
+  bool inferred = false;
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU" || prop.memory_size() <= 0) {
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (mem_usage.used_memory < 0) {
+      continue;
+    }
+    inferred = true;
+    int64_t required_savings = mem_usage.used_memory - prop.memory_size();
+    if (required_savings <= 0) {
+      continue;
+    }
+
+    std::map<string, RecomputeCandidate> candidates;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      const NodeDef* node = node_map.GetNode(live_tensor.node);
+      if (node == nullptr || live_tensor.memory_used == 0 ||
+          !is_candidate(*node) ||
+          nodes_to_recompute->count(node->name()) > 0) {
+        continue;
+      }
+      auto cost = compute_costs.find(node->name());
+      if (cost == compute_costs.end()) {
+        continue;
+      }
+      const auto& outputs = node_map.GetOutputs(node->name());
+      if (std::none_of(outputs.begin(), outputs.end(),
+                       [&](const NodeDef* output) {
+                         return is_target(*output);
+                       })) {
+        continue;
+      }
+      RecomputeCandidate& candidate = candidates[node->name()];
+      candidate.node = node->name();
+      candidate.memory_saved += live_tensor.memory_used;
+      candidate.compute_cost = cost->second;
+    }
+
+    std::vector<RecomputeCandidate> sorted_candidates;
+    for (auto& candidate : candidates) {
+      sorted_candidates.push_back(std::move(candidate.second));
+    }
+    // Ties keep the order of the names, for deterministic results.
+    std::stable_sort(
+        sorted_candidates.begin(), sorted_candidates.end(),
+        [](const RecomputeCandidate& a, const RecomputeCandidate& b) {
+          return static_cast<double>(a.compute_cost.count()) / a.memory_saved <
+                 static_cast<double>(b.compute_cost.count()) / b.memory_saved;
+        });
+    for (const RecomputeCandidate& candidate : sorted_candidates) {
+      if (required_savings <= 0) {
+        break;
+      }
+      VLOG(1) << "Will recompute " << candidate.node << " to save "
+              << candidate.memory_saved << " bytes at a cost of "
+              << candidate.compute_cost.count() << "ns on " << device.first;
+      nodes_to_recompute->insert(candidate.node);
+      required_savings -= candidate.memory_saved;
+    }
+  }
+  return inferred;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
-                                GraphDef* graph, const GrapplerItem& item) {
+                                Cluster* cluster, GraphDef* graph,
+                                const GrapplerItem& item) {
   // The topological numberings and NodeMap will be stale as soon as we start
   // modifying the graph in RecomputeSubgraph. However, RecomputeSubgraph only
   // looks up nodes which were in the original graph, and preserves the graph
@@ -474,20 +602,42 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
       optimization_level == RewriterConfig::HEURISTICS) {
-    // TODO(allenl): Handle ResNet-like architectures better. Right now all of
-    // the cheap forward ops get grouped into a single subgraph which must
-    // execute before gradients start executing (unless layers are manually
-    // separated by identity ops).
-    std::unordered_set<string> cheap_to_recompute_ops =
-        GetCheapToRecomputeOps();
-    recomputed_subgraphs = GetOpGroupsToRecompute(
-        graph, node_map,
-        [&cheap_to_recompute_ops, &feeds, &is_target](const NodeDef& node) {
-          return !is_target(node) && feeds.count(node.name()) == 0 &&
-                 (cheap_to_recompute_ops.count(node.op()) > 0 ||
-                  node.attr().count(kRecomputeHint) > 0);
-        },
-        is_target);
+    // With a cluster, recompute the stateless nodes that bring the peak
+    // memory usage of each GPU within its memory at the least compute cost.
+    std::unordered_set<string> nodes_to_recompute;
+    const auto is_recomputable = [&feeds, &is_target](const NodeDef& node) {
+      return !is_target(node) && feeds.count(node.name()) == 0 &&
+             !IsVariable(node) && !IsPlaceholder(node) &&
+             !IsControlFlow(node) && !IsStateful(node);
+    };
+    if (cluster != nullptr &&
+        SelectNodesToRecompute(cluster, item.WithGraph(GraphDef(*graph)),
+                               is_recomputable, is_target,
+                               &nodes_to_recompute)) {
+      recomputed_subgraphs = GetOpGroupsToRecompute(
+          graph, node_map,
+          [&nodes_to_recompute, &feeds, &is_target](const NodeDef& node) {
+            return !is_target(node) && feeds.count(node.name()) == 0 &&
+                   (nodes_to_recompute.count(node.name()) > 0 ||
+                    node.attr().count(kRecomputeHint) > 0);
+          },
+          is_target);
+    } else {
+      // TODO(allenl): Handle ResNet-like architectures better. Right now all
+      // of the cheap forward ops get grouped into a single subgraph which must
+      // execute before gradients start executing (unless layers are manually
+      // separated by identity ops).
+      std::unordered_set<string> cheap_to_recompute_ops =
+          GetCheapToRecomputeOps();
+      recomputed_subgraphs = GetOpGroupsToRecompute(
+          graph, node_map,
+          [&cheap_to_recompute_ops, &feeds, &is_target](const NodeDef& node) {
+            return !is_target(node) && feeds.count(node.name()) == 0 &&
+                   (cheap_to_recompute_ops.count(node.op()) > 0 ||
+                    node.attr().count(kRecomputeHint) > 0);
+          },
+          is_target);
+    }
   } else if (optimization_level == RewriterConfig::MANUAL) {
     recomputed_subgraphs = GetOpGroupsToRecompute(
         graph, node_map,
@@ -1013,16 +1163,8 @@ static bool IdentifySwappingCandidates(
 
     std::unordered_map<string, Costs::NanoSeconds> op_completion_times;
     {
-      VirtualCluster vcluster(cluster->GetDevices());
-      if (!vcluster.Provision().ok()) {
-        return false;
-      }
-      if (!vcluster.Initialize(*item).ok()) {
-        return false;
-      }
       RunMetadata metadata;
-      Status s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
-      if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+      if (!SimulateStep(cluster, *item, &metadata)) {
         return false;
       }
 
@@ -1396,7 +1538,7 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
 
   if (run_recomputation_pass) {
     RecomputationRewritingPass(optimization_level_,
-                               recomputation_targets_name_scope_,
+                               recomputation_targets_name_scope_, cluster,
                                &optimized_item.graph, item);
   }
 
@@ -203,7 +203,8 @@ TEST_F(RecomputeSubgraphTest, MultiNode) {
 
 class MemoryOptimizerTest : public GrapplerTest {
  public:
-  static std::unique_ptr<VirtualCluster> CreateVirtualCluster() {
+  static std::unique_ptr<VirtualCluster> CreateVirtualCluster(
+      int64_t gpu_memory_size = 1024 * 1024) {
     DeviceProperties cpu_device;
     cpu_device.set_type("CPU");
     cpu_device.set_frequency(1000);
@@ -215,7 +216,7 @@ class MemoryOptimizerTest : public GrapplerTest {
     gpu_device.set_frequency(1000);
     gpu_device.set_num_cores(24);
     gpu_device.set_bandwidth(128);
-    gpu_device.set_memory_size(1024 * 1024);
+    gpu_device.set_memory_size(gpu_memory_size);
     gpu_device.mutable_environment()->insert({"architecture", "6"});
     std::unordered_map<string, DeviceProperties> devices;
     devices["/job:localhost/replica:0/task:0/cpu:0"] = cpu_device;
@@ -393,6 +394,52 @@ TEST_F(MemoryOptimizerTest, UnswappableInputs) {
 #endif
 }
 
+// Returns a graph where gradients/g2 reads the activation act, and
+// gradients/g1 reads the more expensive y.
+GrapplerItem MakeRecomputationItem() {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice("/gpu:0");
+  Output x = ops::Variable(s.WithOpName("x"), {256, 256}, DT_FLOAT);
+  Output act = ops::Sqrt(s.WithOpName("act"), x);
+  Output y = ops::MatMul(s.WithOpName("y"), act, act);
+  Output g1 = ops::AddN(s.WithOpName("gradients/g1"), {y});
+  Output g2 = ops::Mul(s.WithOpName("gradients/g2"), g1, act);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/g2"};
+  return item;
+}
+
+TEST_F(MemoryOptimizerTest, RecomputationWithinMemoryBudget) {
+  GrapplerItem item = MakeRecomputationItem();
+  // The peak memory usage fits, so nothing is recomputed, even though Sqrt is
+  // cheap to recompute.
+  std::unique_ptr<VirtualCluster> cluster(
+      CreateVirtualCluster(/*gpu_memory_size=*/1LL << 30));
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+  NodeMap node_map(&output);
+  EXPECT_EQ(nullptr, node_map.GetNode("Recomputed/act"));
+}
+
+TEST_F(MemoryOptimizerTest, RecomputationOverMemoryBudget) {
+  GrapplerItem item = MakeRecomputationItem();
+  std::unique_ptr<VirtualCluster> cluster(
+      CreateVirtualCluster(/*gpu_memory_size=*/64 * 1024));
+  MemoryOptimizer optimizer(RewriterConfig::RECOMPUTATION_HEURISTICS);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  ASSERT_NE(nullptr, node_map.GetNode("Recomputed/act"));
+  const NodeDef* g2 = node_map.GetNode("gradients/g2");
+  ASSERT_NE(nullptr, g2);
+  EXPECT_EQ("Recomputed/act", g2->input(1));
+}
+
 TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
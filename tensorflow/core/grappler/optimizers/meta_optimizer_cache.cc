@@ -0,0 +1,237 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+// Appends `piece` to `material` with its length, so that different sequences
+// of pieces never produce the same material.
+void AddPiece(StringPiece piece, string* material) {
+  absl::StrAppend(material, piece.size(), ":", piece);
+}
+
+void AddProto(const protobuf::MessageLite& proto, string* material) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AddPiece(serialized, material);
+}
+
+void AddSorted(std::vector<string> pieces, string* material) {
+  std::sort(pieces.begin(), pieces.end());
+  AddPiece(absl::StrCat(pieces.size()), material);
+  for (const string& piece : pieces) AddPiece(piece, material);
+}
+
+constexpr char kGraphSuffix[] = ".graph.pb";
+
+string GraphFilename(const string& dir, const string& key) {
+  return io::JoinPath(dir, absl::StrCat(key, kGraphSuffix));
+}
+
+}  // namespace
+
+MetaOptimizerCache::MetaOptimizerCache(const string& cache_dir)
+    : cache_dir_(cache_dir) {}
+
+MetaOptimizerCache* MetaOptimizerCache::Global() {
+  static MetaOptimizerCache* cache = []() -> MetaOptimizerCache* {
+    string cache_dir;
+    TF_CHECK_OK(ReadStringFromEnvVar("TF_GRAPPLER_CACHE_DIR", "", &cache_dir));
+    bool enabled = false;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_GRAPPLER_ENABLE_CACHE", false, &enabled));
+    if (cache_dir.empty() && !enabled) return nullptr;
+    VLOG(1) << "Caching optimized graphs"
+            << (cache_dir.empty() ? " in memory" : " in " + cache_dir);
+    return new MetaOptimizerCache(cache_dir);
+  }();
+  return cache;
+}
+
+string MetaOptimizerCache::Key(const GrapplerItem& item,
+                               const ConfigProto& cfg,
+                               const Cluster* cluster) {
+  string material;
+  AddPiece(TF_VERSION_STRING, &material);
+  AddPiece(absl::StrCat(TF_GRAPH_DEF_VERSION), &material);
+  AddProto(item.graph, &material);
+  AddProto(cfg, &material);
+
+  std::vector<string> feeds;
+  for (const auto& feed : item.feed) {
+    feeds.push_back(absl::StrCat(feed.first, ":",
+                                 DataTypeString(feed.second.dtype()), ":",
+                                 feed.second.shape().DebugString()));
+  }
+  AddSorted(std::move(feeds), &material);
+  AddSorted(item.fetch, &material);
+  AddSorted(item.init_ops, &material);
+  AddSorted(item.keep_ops, &material);
+  AddPiece(item.save_op, &material);
+  AddPiece(item.restore_op, &material);
+  AddPiece(item.save_restore_loc_tensor, &material);
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    AddProto(queue_runner, &material);
+  }
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  for (bool option : {options.allow_non_differentiable_rewrites,
+                      options.allow_pruning_stateful_and_dataset_ops,
+                      options.optimize_function_library,
+                      options.is_eager_mode}) {
+    AddPiece(option ? "1" : "0", &material);
+  }
+
+  AddSorted(std::vector<string>(item.devices().begin(), item.devices().end()),
+            &material);
+  if (cluster != nullptr) {
+    std::vector<std::pair<string, const DeviceProperties*>> devices;
+    for (const auto& device : cluster->GetDevices()) {
+      devices.emplace_back(device.first, &device.second);
+    }
+    std::sort(devices.begin(), devices.end());
+    for (const auto& device : devices) {
+      AddPiece(device.first, &material);
+      AddProto(*device.second, &material);
+    }
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(material);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+string MetaOptimizerCache::Filename(const string& key) const {
+  return GraphFilename(cache_dir_, key);
+}
+
+bool MetaOptimizerCache::Lookup(const string& key, GraphDef* optimized_graph) {
+  {
+    mutex_lock lock(mu_);
+    auto it = graphs_.find(key);
+    if (it != graphs_.end()) {
+      *optimized_graph = *it->second;
+      return true;
+    }
+  }
+  if (cache_dir_.empty()) return false;
+
+  Env* env = Env::Default();
+  const string filename = Filename(key);
+  if (!env->FileExists(filename).ok()) return false;
+  auto graph = std::make_shared<GraphDef>();
+  Status status = ReadBinaryProto(env, filename, graph.get());
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to read cached optimized graph " << filename << ": "
+                 << status;
+    return false;
+  }
+  *optimized_graph = *graph;
+  mutex_lock lock(mu_);
+  if (graphs_.size() >= kMaxEntries) graphs_.clear();
+  graphs_.emplace(key, std::move(graph));
+  return true;
+}
+
+void MetaOptimizerCache::Insert(const string& key,
+                                const GraphDef& optimized_graph) {
+  auto graph = std::make_shared<const GraphDef>(optimized_graph);
+  {
+    mutex_lock lock(mu_);
+    if (graphs_.size() >= kMaxEntries) graphs_.clear();
+    graphs_[key] = graph;
+  }
+  if (cache_dir_.empty()) return;
+
+  // Write to a temporary file and rename it, so that concurrent processes
+  // never read a partially written graph.
+  Env* env = Env::Default();
+  const string filename = Filename(key);
+  string temp_filename = filename;
+  Status status = env->RecursivelyCreateDir(cache_dir_);
+  if (status.ok() && !env->CreateUniqueFileName(&temp_filename, ".tmp")) {
+    status = errors::Internal("Failed to create a temporary file name");
+  }
+  if (status.ok()) status = WriteBinaryProto(env, temp_filename, *graph);
+  if (status.ok()) status = env->RenameFile(temp_filename, filename);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to cache optimized graph in " << filename << ": "
+                 << status;
+    if (temp_filename != filename) {
+      env->DeleteFile(temp_filename).IgnoreError();
+    }
+  }
+}
+
+Status MetaOptimizerCache::Export(const string& dir) {
+  std::vector<std::pair<string, std::shared_ptr<const GraphDef>>> graphs;
+  {
+    mutex_lock lock(mu_);
+    graphs.assign(graphs_.begin(), graphs_.end());
+  }
+  Env* env = Env::Default();
+  TF_RETURN_IF_ERROR(env->RecursivelyCreateDir(dir));
+  for (const auto& graph : graphs) {
+    TF_RETURN_IF_ERROR(
+        WriteBinaryProto(env, GraphFilename(dir, graph.first), *graph.second));
+  }
+  VLOG(1) << "Exported " << graphs.size() << " optimized graphs to " << dir;
+  return OkStatus();
+}
+
+Status MetaOptimizerCache::Import(const string& dir) {
+  Env* env = Env::Default();
+  std::vector<string> filenames;
+  TF_RETURN_IF_ERROR(
+      env->GetMatchingPaths(GraphFilename(dir, "*"), &filenames));
+  int num_imported = 0;
+  for (const string& filename : filenames) {
+    StringPiece key = io::Basename(filename);
+    key.remove_suffix(strlen(kGraphSuffix));
+    auto graph = std::make_shared<GraphDef>();
+    TF_RETURN_IF_ERROR(ReadBinaryProto(env, filename, graph.get()));
+    mutex_lock lock(mu_);
+    // Keeps the graphs already cached rather than clearing them.
+    if (graphs_.size() >= kMaxEntries) break;
+    graphs_.emplace(string(key), std::move(graph));
+    ++num_imported;
+  }
+  VLOG(1) << "Imported " << num_imported << " optimized graphs from " << dir;
+  return OkStatus();
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,88 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// A content-addressed cache of the graphs produced by RunMetaOptimizer(). The
+// optimized graph, including its optimized function library, is stored under
+// a fingerprint of everything the optimization depends on: the input graph and
+// its fetch, feed and preserved nodes, the session config, the available
+// devices and their properties, and the TensorFlow version.
+//
+// The cache is disabled by default, since custom optimizers are not required
+// to be deterministic. Setting TF_GRAPPLER_ENABLE_CACHE=true caches the graphs
+// in memory for the life of the process. Setting TF_GRAPPLER_CACHE_DIR to a
+// directory, e.g. one next to a SavedModel, also persists them there so that
+// later processes loading the same model skip Grappler.
+class MetaOptimizerCache {
+ public:
+  // Graphs are only kept in memory if `cache_dir` is empty.
+  explicit MetaOptimizerCache(const string& cache_dir);
+
+  // Returns the cache configured by the environment, or nullptr if caching is
+  // disabled.
+  static MetaOptimizerCache* Global();
+
+  // Returns the key of optimizing `item` with `cfg` for the devices of
+  // `cluster`, which may be nullptr.
+  static string Key(const GrapplerItem& item, const ConfigProto& cfg,
+                    const Cluster* cluster);
+
+  // Returns true and sets `optimized_graph` if a graph is cached under `key`.
+  bool Lookup(const string& key, GraphDef* optimized_graph);
+
+  // Caches `optimized_graph` under `key`. Failures to persist the graph are
+  // logged and otherwise ignored.
+  void Insert(const string& key, const GraphDef& optimized_graph);
+
+  // Writes the graphs cached in memory to `dir`, in the format of the on-disk
+  // cache, e.g. to ship them with a SavedModel after it was warmed up.
+  Status Export(const string& dir);
+
+  // Caches in memory the graphs that Export() wrote to `dir`.
+  Status Import(const string& dir);
+
+ private:
+  // The in-memory cache is cleared rather than allowed to grow past this.
+  static constexpr int kMaxEntries = 64;
+
+  string Filename(const string& key) const;
+
+  const string cache_dir_;
+  mutex mu_;
+  absl::flat_hash_map<string, std::shared_ptr<const GraphDef>> graphs_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
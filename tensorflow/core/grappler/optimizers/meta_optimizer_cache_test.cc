@@ -0,0 +1,107 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kDevice[] = "/device:CPU:0";
+
+GrapplerItem MakeItem() {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {kDevice});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  return item;
+}
+
+TEST(MetaOptimizerCacheTest, KeyDependsOnInputs) {
+  const GrapplerItem item = MakeItem();
+  ConfigProto cfg;
+  const string key = MetaOptimizerCache::Key(item, cfg, nullptr);
+  EXPECT_EQ(key, MetaOptimizerCache::Key(MakeItem(), cfg, nullptr));
+
+  GrapplerItem other_graph = item;
+  other_graph.graph.mutable_node(0)->set_name("renamed");
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_graph, cfg, nullptr));
+
+  GrapplerItem other_fetch = item;
+  other_fetch.fetch.push_back("extra");
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_fetch, cfg, nullptr));
+
+  GrapplerItem other_options = item;
+  other_options.optimization_options().is_eager_mode = true;
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_options, cfg, nullptr));
+
+  ConfigProto other_cfg;
+  other_cfg.mutable_graph_options()->mutable_rewrite_options()->set_remapping(
+      RewriterConfig::OFF);
+  EXPECT_NE(key, MetaOptimizerCache::Key(item, other_cfg, nullptr));
+}
+
+TEST(MetaOptimizerCacheTest, InMemory) {
+  MetaOptimizerCache cache("");
+  const GrapplerItem item = MakeItem();
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup("key", &graph));
+  cache.Insert("key", item.graph);
+  ASSERT_TRUE(cache.Lookup("key", &graph));
+  EXPECT_EQ(graph.DebugString(), item.graph.DebugString());
+}
+
+TEST(MetaOptimizerCacheTest, PersistsToDisk) {
+  const string cache_dir =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_cache_test");
+  const GrapplerItem item = MakeItem();
+  {
+    MetaOptimizerCache cache(cache_dir);
+    cache.Insert("key", item.graph);
+  }
+  // A new cache, as in a new process, finds the graph on disk.
+  MetaOptimizerCache cache(cache_dir);
+  GraphDef graph;
+  ASSERT_TRUE(cache.Lookup("key", &graph));
+  EXPECT_EQ(graph.DebugString(), item.graph.DebugString());
+  EXPECT_FALSE(cache.Lookup("other", &graph));
+}
+
+TEST(MetaOptimizerCacheTest, ExportAndImport) {
+  const string dir =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_cache_export");
+  const GrapplerItem item = MakeItem();
+  {
+    MetaOptimizerCache cache("");
+    cache.Insert("key", item.graph);
+    TF_ASSERT_OK(cache.Export(dir));
+  }
+  MetaOptimizerCache cache("");
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup("key", &graph));
+  TF_ASSERT_OK(cache.Import(dir));
+  ASSERT_TRUE(cache.Lookup("key", &graph));
+  EXPECT_EQ(graph.DebugString(), item.graph.DebugString());
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include <atomic>
 
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -420,6 +421,82 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibrary) {
   test::ExpectTensorEqual<int>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeIndependentFunctionsDeterministically) {
+  using test::function::NDef;
+
+  // Enable only function optimization.
+  ConfigProto config_proto;
+  auto& rewriter_config =
+      *config_proto.mutable_graph_options()->mutable_rewrite_options();
+
+  rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+  rewriter_config.set_function_optimization(RewriterConfig::ON);
+  rewriter_config.add_optimizers("function");
+  rewriter_config.set_min_graph_nodes(-1);
+
+  // Define function library:
+  //
+  //   MyMul(x, y)     = x * y
+  //  *MySquare_i(x)   = MyMul(x, x)  for i in [0, kNumCalls)
+  //
+  //  * - marked as noinline
+  //
+  // The graph calls every MySquare_i once. Their specializations do not call
+  // each other, so they are optimized concurrently.
+  constexpr int kNumCalls = 16;
+  std::vector<FunctionDef> funcs = {FunctionDefHelper::Create(
+      "MyMul", {"x:T", "y:T"}, {"z:T"}, {"T: {float, double}"},
+      {{{"mul"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z", "mul:z:0"}})};
+  std::vector<NodeDef> nodes = {
+      NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice)};
+  GrapplerItem item;
+  item.id = "tf_graph";
+  for (int i = 0; i < kNumCalls; ++i) {
+    const string func = absl::StrCat("MySquare_", i);
+    funcs.push_back(FunctionDefHelper::Create(
+        func, {"x:T"}, {"z:T"}, {"T: {float, double}"},
+        {{{"my_mul"}, "MyMul", {"x", "x"}, {{"T", "$T"}}}},
+        /*ret_def=*/
+        {{"z", "my_mul:z:0"}}));
+    (*funcs.back().mutable_attr())["_noinline"].set_b(true);
+
+    const string square = absl::StrCat("square_", i);
+    const string out = absl::StrCat("out_", i);
+    nodes.push_back(NDef(square, func, {"a"}, {{"T", DT_FLOAT}}, kDevice));
+    nodes.push_back(NDef(out, "Identity", {absl::StrCat(square, ":0")},
+                         {{"T", DT_FLOAT}}, kDevice));
+    item.fetch.push_back(out);
+  }
+  item.graph = test::function::GDef(nodes, funcs);
+
+  GraphDef output;
+  {
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &output));
+  }
+  FunctionLibraryDefinition optimized_flib(OpRegistry::Global(),
+                                           output.library());
+  EXPECT_EQ(kNumCalls, optimized_flib.num_functions());
+
+  for (int run = 0; run < 3; ++run) {
+    GraphDef other_output;
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, &other_output));
+    EXPECT_EQ(output.DebugString(), other_output.DebugString());
+  }
+
+  item.feed.emplace_back("a", test::AsScalar<float>(3.0f));
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  ASSERT_EQ(kNumCalls, tensors.size());
+  for (int i = 0; i < kNumCalls; ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneUnusedOutputs) {
   using test::function::NDef;
 
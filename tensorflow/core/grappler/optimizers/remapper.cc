@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include <algorithm>
 #include <set>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -62,6 +64,8 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// Chains of element-wise ops on CPU -> _FusedElementwise, e.g.
+//   Mul + AddV2 + Tanh + Mul
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -76,6 +80,7 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
@@ -85,6 +90,9 @@ constexpr char kFill[] = "fill";
 
 constexpr int kMissingIndex = -1;
 
+// Shorter chains of element-wise ops are left to the individual kernels.
+constexpr int kMinFusedElementwiseOps = 3;
+
 struct RemapperContext {
   explicit RemapperContext(GrapplerItem* item, Status* status,
                            RewriterConfig::CpuLayout cpu_layout_conversion,
@@ -146,6 +154,16 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// Chain of element-wise ops, where each op reads the output of the previous op.
+struct ElementwiseChain {
+  ElementwiseChain() = default;
+
+  // The ops of the chain from first to last, and for each of them the input
+  // port reading the output of the previous op, or the input of the chain.
+  std::vector<int> nodes;
+  std::vector<int> chain_ports;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -2062,6 +2080,115 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool IsFusableUnaryElementwise(const NodeDef& node) {
+  return node.op() == "Abs" || IsExp(node) || IsLog(node) || IsNeg(node) ||
+         node.op() == "Reciprocal" || IsRelu(node) || IsRsqrt(node) ||
+         IsSigmoid(node) || IsSqrt(node) || IsSquare(node) || IsTanh(node);
+}
+
+// The output of the previous op of a chain may be either input of commutative
+// ops, and only the first input of the others.
+bool IsFusableBinaryElementwise(const NodeDef& node, bool* commutative) {
+  *commutative =
+      IsAdd(node) || IsMul(node) || IsMaximum(node) || IsMinimum(node);
+  return *commutative || IsSub(node) || IsRealDiv(node);
+}
+
+// Returns true if _FusedElementwise can run `node`.
+bool IsFusableElementwise(const NodeDef& node) {
+  bool commutative;
+  if (!IsFusableUnaryElementwise(node) &&
+      !IsFusableBinaryElementwise(node, &commutative)) {
+    return false;
+  }
+  return (HasDataType(&node, DT_FLOAT) || HasDataType(&node, DT_DOUBLE)) &&
+         NodeIsOnCpu(&node);
+}
+
+// Returns true if the regular fanin of `node_view` at `port` can be the
+// previous op of `node_view` in a fused chain.
+bool IsFusableElementwiseFanin(const RemapperContext& ctx,
+                               const utils::MutableNodeView& node_view,
+                               int port) {
+  const auto& fanin = node_view.GetRegularFanin(port);
+  const auto* fanin_node_view = fanin.node_view();
+  const auto* fanin_node_def = fanin_node_view->node();
+  return fanin.index() == 0 && IsFusableElementwise(*fanin_node_def) &&
+         HaveSameDataType(node_view.node(), fanin_node_def) &&
+         fanin_node_def->device() == node_view.node()->device() &&
+         !HasControlFaninOrFanout(*fanin_node_view) &&
+         HasAtMostOneFanoutAtPort0(*fanin_node_view) &&
+         !IsInPreserveSet(ctx, fanin_node_def);
+}
+
+// Returns the input port of the element-wise `node_view` that reads the output
+// of the previous op of a chain, or kMissingIndex if it can not be fused. The
+// other input of a binary op must be a scalar or have the shape of the chain,
+// since _FusedElementwise does not broadcast.
+int FindElementwiseChainPort(const RemapperContext& ctx,
+                             const utils::MutableNodeView& node_view) {
+  const auto* node_def = node_view.node();
+  if (IsFusableUnaryElementwise(*node_def)) return 0;
+
+  bool commutative = false;
+  if (!IsFusableBinaryElementwise(*node_def, &commutative) ||
+      node_view.NumRegularFanins() != 2) {
+    return kMissingIndex;
+  }
+  const auto& props = ctx.graph_properties.GetInputProperties(node_def->name());
+  if (props.size() != 2) return kMissingIndex;
+  const auto is_chain_port = [&](int port) -> bool {
+    const TensorShapeProto& arg_shape = props[1 - port].shape();
+    return (!arg_shape.unknown_rank() && arg_shape.dim_size() == 0) ||
+           ShapesSymbolicallyEqual(props[port].shape(), arg_shape);
+  };
+
+  if (!commutative) return is_chain_port(0) ? 0 : kMissingIndex;
+  // Prefer the input that extends the chain.
+  for (int port : {0, 1}) {
+    if (is_chain_port(port) &&
+        IsFusableElementwiseFanin(ctx, node_view, port)) {
+      return port;
+    }
+  }
+  for (int port : {0, 1}) {
+    if (is_chain_port(port)) return port;
+  }
+  return kMissingIndex;
+}
+
+bool FindElementwiseChain(const RemapperContext& ctx, int node_index,
+                          ElementwiseChain* matched) {
+  // XLA clusters element-wise ops itself, and can not compile the fused op.
+  if (ctx.xla_auto_clustering_on) return false;
+
+  // Root of the pattern must be the last op of the chain.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  if (!IsFusableElementwise(*node_view->node()) ||
+      node_view->NumControllingFanins() > 0) {
+    return false;
+  }
+
+  // Walk the chain backwards from its last op.
+  std::vector<int> nodes;
+  std::vector<int> chain_ports;
+  int port = FindElementwiseChainPort(ctx, *node_view);
+  while (port != kMissingIndex) {
+    nodes.push_back(node_view->node_index());
+    chain_ports.push_back(port);
+    if (!IsFusableElementwiseFanin(ctx, *node_view, port)) break;
+    node_view = node_view->GetRegularFanin(port).node_view();
+    port = FindElementwiseChainPort(ctx, *node_view);
+  }
+  if (nodes.size() < kMinFusedElementwiseOps) return false;
+
+  std::reverse(nodes.begin(), nodes.end());
+  std::reverse(chain_ports.begin(), chain_ports.end());
+  matched->nodes = std::move(nodes);
+  matched->chain_ports = std::move(chain_ports);
+  return true;
+}
+
 bool FindFusedBatchMatMul(RemapperContext* ctx, int node_index,
                           std::map<string, int>* matched_nodes_map,
                           std::set<int>* remove_node_indices) {
@@ -3232,6 +3359,51 @@ Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return OkStatus();
 }
 
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const ElementwiseChain& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& first = graph->node(matched.nodes.front());
+  const NodeDef& last = graph->node(matched.nodes.back());
+  VLOG(2) << "Fuse " << matched.nodes.size()
+          << " element-wise ops: first=" << first.name()
+          << " last=" << last.name() << " on device=" << last.device();
+
+  NodeDef fused_op;
+  fused_op.set_name(last.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(last.device());
+  fused_op.add_input(first.input(matched.chain_ports.front()));  // 0: x
+
+  std::vector<string> fused_ops;
+  for (int i = 0; i < matched.nodes.size(); ++i) {
+    const NodeDef& node = graph->node(matched.nodes[i]);
+    fused_ops.push_back(node.op());
+    if (!IsFusableUnaryElementwise(node)) {
+      fused_op.add_input(node.input(1 - matched.chain_ports[i]));  // args
+    }
+  }
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = last.attr().at("T");
+  SetAttrValue(fused_op.input_size() - 1, &(*attr)["num_args"]);
+  SetAttrValue(fused_ops, &(*attr)["fused_ops"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.nodes.back()] = true;
+  for (int i = 0; i + 1 < matched.nodes.size(); ++i) {
+    (*nodes_to_delete)[matched.nodes[i]] = true;
+  }
+
+  return OkStatus();
+}
+
 Status AddFusedBatchMatMul(RemapperContext* ctx,
                            const std::map<string, int>& matched_nodes_map,
                            const std::set<int>& remove_node_indices,
@@ -3574,16 +3746,28 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // Candidate for a fused chain of element-wise ops, which needs the shapes of
+  // binary ops to avoid broadcasting.
+  const auto is_elementwise_chain_candidate = [&]() -> bool {
+    if (!IsFusableElementwise(*node_def)) return false;
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      const auto* fanin_node_def =
+          node_view->GetRegularFanin(i).node_view()->node();
+      if (IsFusableElementwise(*fanin_node_def)) return true;
+    }
+    return false;
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
-           is_act_biasadd_conv_candidate();
+           is_act_biasadd_conv_candidate() || is_elementwise_chain_candidate();
 
   return is_act_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() || is_elementwise_chain_candidate();
 }
 }  // namespace
 
@@ -3816,6 +4000,15 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap chains of element-wise ops into the _FusedElementwise.
+    ElementwiseChain elementwise_chain;
+    if (allow_non_differentiable_rewrites &&
+        FindElementwiseChain(ctx, i, &elementwise_chain)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+          &ctx, elementwise_chain, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -2506,5 +2506,105 @@ class RemapperLeakyReluTest : public GrapplerTest {
 TEST_F(RemapperLeakyReluTest, F32) { RunTest<DT_FLOAT>(); }
 TEST_F(RemapperLeakyReluTest, BF16) { RunTest<DT_BFLOAT16>(); }
 
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  auto shape = ops::Placeholder::Shape({8, 64});
+
+  // y = tanh(x * a + b) * c
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT, shape);
+  auto b = Placeholder(s.WithOpName("b"), DT_FLOAT, shape);
+  auto a = ops::Const(s.WithOpName("a"), 0.5f, {});
+  auto c = ops::Const(s.WithOpName("c"), 3.0f, {});
+  auto mul = ops::Mul(s.WithOpName("mul"), x, a);
+  auto add = ops::AddV2(s.WithOpName("add"), b, mul);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  auto y = ops::Mul(s.WithOpName("y"), tanh, c);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), y);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({8, 64});
+  auto b_t = GenerateRandomTensor<DT_FLOAT>({8, 64});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"b", b_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "mul");
+    EXPECT_NE(node.name(), "add");
+    EXPECT_NE(node.name(), "tanh");
+    if (node.name() == "y") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "a");
+      EXPECT_EQ(node.input(2), "b");
+      EXPECT_EQ(node.input(3), "c");
+      EXPECT_EQ(node.attr().at("num_args").i(), 3);
+      const auto& fused_ops = node.attr().at("fused_ops").list().s();
+      ASSERT_EQ(fused_ops.size(), 4);
+      EXPECT_EQ(fused_ops[0], "Mul");
+      EXPECT_EQ(fused_ops[1], "AddV2");
+      EXPECT_EQ(fused_ops[2], "Tanh");
+      EXPECT_EQ(fused_ops[3], "Mul");
+      ++found;
+    }
+  }
+  EXPECT_EQ(found, 1);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, DoNotFuseElementwiseChainWithBroadcast) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // The add broadcasts x * a, so only tanh and the last mul could be fused,
+  // which is too short a chain.
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({64}));
+  auto b = Placeholder(s.WithOpName("b"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 64}));
+  auto a = ops::Const(s.WithOpName("a"), 0.5f, {});
+  auto c = ops::Const(s.WithOpName("c"), 3.0f, {});
+  auto mul = ops::Mul(s.WithOpName("mul"), x, a);
+  auto add = ops::AddV2(s.WithOpName("add"), mul, b);
+  auto tanh = ops::Tanh(s.WithOpName("tanh"), add);
+  auto y = ops::Mul(s.WithOpName("y"), tanh, c);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), y);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedElementwise");
+  }
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
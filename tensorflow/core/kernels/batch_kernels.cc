@@ -48,6 +48,8 @@ constexpr char kMinInflightBatchesAttr[] = "_min_inflight_batches";
 constexpr char kInitialInflightBatchesAttr[] = "_initial_inflight_batches";
 constexpr char kMaxInflightBatchesAttr[] = "_max_inflight_batches";
 constexpr char kBatchesToAverageOverAttr[] = "_batches_to_average_over";
+constexpr char kBatchLatencySloMicrosAttr[] = "_batch_latency_slo_micros";
+constexpr char kAliasBatchOutputsAttr[] = "_alias_batch_outputs";
 
 // Default thread count in the per-process batching thread pool.
 constexpr int64_t kBatchThreadPoolSize = 128;
@@ -257,6 +259,20 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
     has_attribute_enable_large_batch_splitting_ = false;
   }
 
+  if (c->HasAttr(kBatchLatencySloMicrosAttr)) {
+    OP_REQUIRES_OK(c, c->GetAttr(kBatchLatencySloMicrosAttr,
+                                 &batch_latency_slo_micros_));
+    OP_REQUIRES(
+        c, batch_latency_slo_micros_ >= 0,
+        errors::InvalidArgument(kBatchLatencySloMicrosAttr,
+                                " must be non-negative, got ",
+                                batch_latency_slo_micros_));
+  }
+  if (c->HasAttr(kAliasBatchOutputsAttr)) {
+    OP_REQUIRES_OK(c,
+                   c->GetAttr(kAliasBatchOutputsAttr, &alias_batch_outputs_));
+  }
+
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
   // So validate status of `op-kernel-construction`.
@@ -333,6 +349,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           adaptive_shared_batch_scheduler_options, max_batch_size_,
           batch_timeout_micros_, max_enqueued_batches_, allowed_batch_sizes_,
           handle, flib_, &new_resource));
+      new_resource->SetAliasBatchOutputs(alias_batch_outputs_);
       *r = new_resource.release();
       return OkStatus();
     };
@@ -343,6 +360,8 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
           max_enqueued_batches_, allowed_batch_sizes_, handle, flib_,
           enable_large_batch_splitting_, &new_resource));
+      new_resource->SetLatencySlo(batch_latency_slo_micros_);
+      new_resource->SetAliasBatchOutputs(alias_batch_outputs_);
       *r = new_resource.release();
       return OkStatus();
     };
@@ -95,6 +95,12 @@ class BatchFunctionKernel : public AsyncOpKernel {
   bool enable_large_batch_splitting_;
   bool has_attribute_enable_large_batch_splitting_;
   bool enable_adaptive_batch_threads_ = false;
+  // If positive, the batch timeout is tuned online toward this p99 latency,
+  // with `batch_timeout_micros_` as its upper bound. Not supported by the
+  // adaptive batch scheduler.
+  int64_t batch_latency_slo_micros_ = 0;
+  // If true, the outputs of each call are slices of the batch's outputs.
+  bool alias_batch_outputs_ = false;
 
   mutex mu_;
 
@@ -0,0 +1,72 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_latency_controller.h"
+
+#include <algorithm>
+#include <cstddef>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+// The timeout grows only while the p99 latency is below this fraction of the
+// target, which leaves headroom for noise between windows.
+constexpr double kIncreaseThreshold = 0.8;
+
+}  // namespace
+
+BatchLatencyController::BatchLatencyController(const Options& options)
+    : options_(options),
+      batch_timeout_micros_(std::max<int64_t>(options.max_batch_timeout_micros,
+                                              0)) {
+  DCHECK_GT(options_.latency_slo_micros, 0);
+  DCHECK_GT(options_.window_size, 0);
+  window_.reserve(options_.window_size);
+}
+
+bool BatchLatencyController::RecordTaskLatency(int64_t latency_micros) {
+  mutex_lock l(mu_);
+  window_.push_back(latency_micros);
+  if (window_.size() < static_cast<size_t>(options_.window_size)) {
+    return false;
+  }
+  auto p99_it = window_.begin() + (window_.size() * 99) / 100;
+  std::nth_element(window_.begin(), p99_it, window_.end());
+  const int64_t p99 = *p99_it;
+  window_.clear();
+
+  const int64_t timeout = batch_timeout_micros();
+  int64_t new_timeout = timeout;
+  if (p99 > options_.latency_slo_micros) {
+    new_timeout = timeout / 2;
+  } else if (p99 < kIncreaseThreshold * options_.latency_slo_micros) {
+    new_timeout = std::min(
+        options_.max_batch_timeout_micros,
+        timeout +
+            std::max<int64_t>(options_.max_batch_timeout_micros / 16, 1));
+  }
+  p99_latency_micros_.store(p99, std::memory_order_relaxed);
+  batch_timeout_micros_.store(new_timeout, std::memory_order_relaxed);
+  VLOG(2) << "Batch latency controller: p99 latency " << p99 << "us, target "
+          << options_.latency_slo_micros << "us, batch timeout " << timeout
+          << "us -> " << new_timeout << "us.";
+  return true;
+}
+
+}  // namespace serving
+}  // namespace tensorflow
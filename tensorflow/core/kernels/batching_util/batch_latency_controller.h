@@ -0,0 +1,80 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_CONTROLLER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_CONTROLLER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace serving {
+
+// Tunes the batch timeout of a batching queue online, so that the 99th
+// percentile latency of its tasks (time spent waiting for a batch plus the
+// time to process the batch) stays below a target.
+//
+// The controller is additive-increase/multiplicative-decrease: after every
+// window of `window_size` tasks, the timeout is halved if the window's p99
+// latency exceeds the target, and grown by 1/16th of `max_batch_timeout_micros`
+// if the p99 latency is comfortably below the target. Longer timeouts form
+// larger batches, which improves throughput at the cost of latency.
+//
+// This class is thread-safe.
+class BatchLatencyController {
+ public:
+  struct Options {
+    // The target p99 latency of a task. Must be positive.
+    int64_t latency_slo_micros = 0;
+    // The timeout never grows past this, and starts at this value.
+    int64_t max_batch_timeout_micros = 0;
+    // The number of task latencies the p99 latency is computed from.
+    int window_size = 256;
+  };
+
+  explicit BatchLatencyController(const Options& options);
+
+  // Records the latency of one task. Returns true if this completed a window
+  // and the timeout was recomputed.
+  bool RecordTaskLatency(int64_t latency_micros) TF_LOCKS_EXCLUDED(mu_);
+
+  // The current batch timeout.
+  int64_t batch_timeout_micros() const {
+    return batch_timeout_micros_.load(std::memory_order_relaxed);
+  }
+
+  // The p99 latency of the last complete window, or -1 before the first one.
+  int64_t p99_latency_micros() const {
+    return p99_latency_micros_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const Options options_;
+
+  std::atomic<int64_t> batch_timeout_micros_;
+  std::atomic<int64_t> p99_latency_micros_{-1};
+
+  mutex mu_;
+  std::vector<int64_t> window_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_LATENCY_CONTROLLER_H_
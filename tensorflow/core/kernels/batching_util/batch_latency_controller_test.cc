@@ -0,0 +1,82 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_latency_controller.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+BatchLatencyController::Options TestOptions() {
+  BatchLatencyController::Options options;
+  options.latency_slo_micros = 10000;
+  options.max_batch_timeout_micros = 1600;
+  options.window_size = 100;
+  return options;
+}
+
+// Records a window of latencies, one of which is `p99_latency_micros`.
+bool RecordWindow(BatchLatencyController& controller,
+                  int64_t p99_latency_micros) {
+  for (int i = 0; i < 98; ++i) {
+    EXPECT_FALSE(controller.RecordTaskLatency(/*latency_micros=*/1));
+  }
+  EXPECT_FALSE(controller.RecordTaskLatency(p99_latency_micros));
+  return controller.RecordTaskLatency(p99_latency_micros);
+}
+
+TEST(BatchLatencyControllerTest, StartsAtMaxTimeout) {
+  BatchLatencyController controller(TestOptions());
+  EXPECT_EQ(controller.batch_timeout_micros(), 1600);
+  EXPECT_EQ(controller.p99_latency_micros(), -1);
+}
+
+TEST(BatchLatencyControllerTest, HalvesTimeoutAboveSlo) {
+  BatchLatencyController controller(TestOptions());
+  EXPECT_TRUE(RecordWindow(controller, /*p99_latency_micros=*/20000));
+  EXPECT_EQ(controller.p99_latency_micros(), 20000);
+  EXPECT_EQ(controller.batch_timeout_micros(), 800);
+  EXPECT_TRUE(RecordWindow(controller, /*p99_latency_micros=*/20000));
+  EXPECT_EQ(controller.batch_timeout_micros(), 400);
+}
+
+TEST(BatchLatencyControllerTest, GrowsTimeoutBelowSlo) {
+  BatchLatencyController controller(TestOptions());
+  EXPECT_TRUE(RecordWindow(controller, /*p99_latency_micros=*/20000));
+  EXPECT_EQ(controller.batch_timeout_micros(), 800);
+  EXPECT_TRUE(RecordWindow(controller, /*p99_latency_micros=*/5000));
+  EXPECT_EQ(controller.batch_timeout_micros(), 900);
+}
+
+TEST(BatchLatencyControllerTest, HoldsTimeoutNearSlo) {
+  BatchLatencyController controller(TestOptions());
+  EXPECT_TRUE(RecordWindow(controller, /*p99_latency_micros=*/20000));
+  EXPECT_TRUE(RecordWindow(controller, /*p99_latency_micros=*/9000));
+  EXPECT_EQ(controller.batch_timeout_micros(), 800);
+}
+
+TEST(BatchLatencyControllerTest, NeverExceedsMaxTimeout) {
+  BatchLatencyController controller(TestOptions());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(RecordWindow(controller, /*p99_latency_micros=*/1000));
+    EXPECT_EQ(controller.batch_timeout_micros(), 1600);
+  }
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/cost_util.h"
 #include "tensorflow/core/common_runtime/request_cost_accessor.h"
 #include "tensorflow/core/common_runtime/request_cost_accessor_registry.h"
+#include "tensorflow/core/framework/latency_breakdown.h"
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/kernels/batching_util/concat_split_util.h"
@@ -43,6 +44,26 @@ namespace tensorflow {
 namespace serving {
 namespace {
 
+// The maximum number of input shapes batched separately for each batcher
+// queue. Each bucket is a separate queue, with its own batches.
+constexpr int kMaxShapeBucketsPerQueue = 16;
+
+// Records the fraction of a processed batch's rows which are padding, i.e. the
+// fraction of the computation spent on padding.
+void RecordPaddingWasteRatio(int32_t padding_size, int32_t execution_batch_size,
+                             const string& model_name, const string& op_name) {
+  static auto* cell = tensorflow::monitoring::Sampler<2>::New(
+      {"/tensorflow/serving/batching/padding_waste_ratio",
+       "Tracks the fraction of the processed batch size which is padding, by "
+       "model_name (if available).",
+       "model_name", "op_name"},
+      monitoring::Buckets::Explicit(
+          {0.01, 0.05, 0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9}));
+  if (execution_batch_size <= 0) return;
+  cell->GetCell(model_name, op_name)
+      ->Add(static_cast<double>(padding_size) / execution_batch_size);
+}
+
 // TODO(b/181883417): Replace with RecordPaddingSizeV2.
 void RecordPaddingSize(int32_t padding_size, const string& model_name,
                        int32_t execution_batch_size, const string& op_name) {
@@ -161,6 +182,17 @@ void RecordBatchDelayUsV2(int64_t batch_delay_us, const string& model_name,
       ->Add(static_cast<double>(batch_delay_us));
 }
 
+// Adds the time `task` waited in the batching queue to the latency breakdown of
+// its call, if that call collects one. A task split across several batches
+// only counts the wait of its first split.
+void RecordQueueWait(const BatchResourceBase::BatchTask& task,
+                     uint64 now_nanos) {
+  LatencyBreakdownCollector* latency_breakdown =
+      task.context->latency_breakdown();
+  if (latency_breakdown == nullptr || task.split_index != 0) return;
+  latency_breakdown->AddQueueWaitUsecs((now_nanos - task.start_time) / 1000);
+}
+
 void RecordBatchParamBatchTimeoutMicros(int64_t batch_timeout_micros,
                                         const string& model_name,
                                         const string& op_name) {
@@ -200,6 +232,28 @@ void RecordBatchParamAllowedBatchSizes(const string& allowed_batch_sizes,
   cell->GetCell(model_name, op_name)->Set(allowed_batch_sizes);
 }
 
+void RecordAdaptiveBatchTimeoutMicros(int64_t batch_timeout_micros,
+                                      const string& model_name,
+                                      const string& op_name) {
+  static auto* cell = monitoring::Gauge<int64_t, 2>::New(
+      "/tensorflow/serving/batching/adaptive_batch_timeout_micros",
+      "Tracks the batch timeout chosen to meet the latency SLO, by model_name "
+      "(if available).",
+      "model_name", "op_name");
+  cell->GetCell(model_name, op_name)->Set(batch_timeout_micros);
+}
+
+void RecordObservedP99LatencyMicros(int64_t latency_micros,
+                                    const string& model_name,
+                                    const string& op_name) {
+  static auto* cell = monitoring::Gauge<int64_t, 2>::New(
+      "/tensorflow/serving/batching/observed_p99_latency_micros",
+      "Tracks the p99 latency of batched tasks, including queueing, that the "
+      "batch timeout is tuned from, by model_name (if available).",
+      "model_name", "op_name");
+  cell->GetCell(model_name, op_name)->Set(latency_micros);
+}
+
 const string& GetModelName(OpKernelContext* ctx) {
   static string* kModelNameUnset = new string("model_name_unset");
   if (!ctx->session_metadata()) return *kModelNameUnset;
@@ -232,6 +286,7 @@ BatchResourceBase::BatchTask::CreateSplitTask(
 
 using ::tensorflow::concat_split_util::Concat;
 using ::tensorflow::concat_split_util::Split;
+using ::tensorflow::concat_split_util::SplitIntoAlignedSlices;
 using TensorMatrix = std::vector<std::vector<Tensor>>;
 
 string GetTensorNamesAndShapesString(const OpKernelContext* context,
@@ -337,11 +392,48 @@ Status BatchResourceBase::RegisterInput(
   }
 
   BatcherQueueT* batcher_queue;
-  TF_RETURN_IF_ERROR(
-      LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+  TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
+      ShapeBucketQueueName(batcher_queue_name, tensors), &batcher_queue));
   return batcher_queue->Schedule(&batch_components);
 }
 
+void BatchResourceBase::SetLatencySlo(int64_t latency_slo_micros) {
+  if (latency_slo_micros <= 0 || batcher_ == nullptr) return;
+  BatchLatencyController::Options options;
+  options.latency_slo_micros = latency_slo_micros;
+  options.max_batch_timeout_micros =
+      batcher_queue_options_.batch_timeout_micros;
+  latency_controller_ = std::make_unique<BatchLatencyController>(options);
+  // A task's batch is due once the task has waited for the current timeout,
+  // or earlier if the batch fills up.
+  batcher_queue_options_.task_deadline_micros_func =
+      [controller = latency_controller_.get()](const BatchTask& task) {
+        return static_cast<int64_t>(task.start_time / 1000) +
+               controller->batch_timeout_micros();
+      };
+}
+
+string BatchResourceBase::ShapeBucketQueueName(
+    const string& batcher_queue_name, const OpInputList& tensors) {
+  string queue_name = absl::StrCat(batcher_queue_name, "/shape");
+  for (const Tensor& tensor : tensors) {
+    absl::StrAppend(&queue_name, "[");
+    for (int d = 1; d < tensor.dims(); ++d) {
+      absl::StrAppend(&queue_name, d > 1 ? "," : "", tensor.dim_size(d));
+    }
+    absl::StrAppend(&queue_name, "]");
+  }
+  mutex_lock l(batcher_queues_mu_);
+  absl::flat_hash_set<string>& shape_buckets =
+      shape_buckets_[batcher_queue_name];
+  if (!shape_buckets.contains(queue_name) &&
+      shape_buckets.size() >= kMaxShapeBucketsPerQueue) {
+    return batcher_queue_name;
+  }
+  shape_buckets.insert(queue_name);
+  return queue_name;
+}
+
 /*static*/ BatchResourceBase::BatcherT::QueueOptions
 BatchResourceBase::GetBatcherQueueOptions(
     int32_t num_batch_threads, int32_t max_batch_size,
@@ -452,6 +544,8 @@ Status BatchResourceBase::ConcatInputTensors(
                     context->op_kernel().name());
   RecordPaddingSizeV2(padding_amount, GetModelName(context), padded_batch_size,
                       context->op_kernel().name());
+  RecordPaddingWasteRatio(padding_amount, padded_batch_size,
+                          GetModelName(context), context->op_kernel().name());
   RecordProcessedBatchSize(padded_batch_size, GetModelName(context),
                            context->op_kernel().name());
   RecordProcessedBatchSizeV2(padded_batch_size, GetModelName(context),
@@ -640,8 +734,14 @@ Status BatchResourceBase::SplitOutputTensors(
     }
 
     std::vector<Tensor> split_tensor;
-    const Status split_status = tensor::Split(
-        output_tensor, task_sizes_plus_optional_padding, &split_tensor);
+    Status split_status;
+    if (!alias_batch_outputs_ ||
+        !SplitIntoAlignedSlices(output_tensor, task_sizes_plus_optional_padding,
+                                &split_tensor)) {
+      split_status = tensor::Split(output_tensor,
+                                   task_sizes_plus_optional_padding,
+                                   &split_tensor);
+    }
     DCHECK(split_status.ok()) << split_status.ToString();
     if (!split_status.ok()) {
       return errors::Internal("Tensor split operation failed: ",
@@ -695,11 +795,14 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
   Status status;
   bool cleanup_done = false;
   int64_t processed_size = batch->size();
-  auto cleanup_fn = [&cleanup_done, &batch, &processed_size,
+  auto cleanup_fn = [this, &cleanup_done, &batch, &processed_size,
                      &batch_cost_measurements](const Status& status) {
     if (cleanup_done) {
       return;
     }
+    if (latency_controller_ != nullptr) {
+      RecordTaskLatencies(*batch);
+    }
     SplitBatchCosts(batch_cost_measurements, processed_size, *batch);
     // Clear the measurements before unblocking the batch task, as measurements
     // are associated with the task's thread context.
@@ -747,6 +850,7 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
     RecordBatchDelayUsV2((current_time - batch->task(i).start_time) * 1e-3,
                          model_name, last_task_context->op_kernel().name(),
                          processed_size);
+    RecordQueueWait(batch->task(i), current_time);
   }
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
@@ -771,6 +875,25 @@ void BatchResourceBase::ProcessFuncBatch(std::unique_ptr<BatchT> batch) const {
       });
 }
 
+void BatchResourceBase::RecordTaskLatencies(const BatchT& batch) const {
+  const uint64 now = EnvTime::NowNanos();
+  bool updated = false;
+  for (int i = 0; i < batch.num_tasks(); ++i) {
+    const int64_t latency_micros = (now - batch.task(i).start_time) / 1000;
+    updated |= latency_controller_->RecordTaskLatency(latency_micros);
+  }
+  if (!updated) return;
+
+  OpKernelContext* last_task_context =
+      batch.task(batch.num_tasks() - 1).context;
+  const string& model_name = GetModelName(last_task_context);
+  const string& op_name = last_task_context->op_kernel().name();
+  RecordAdaptiveBatchTimeoutMicros(latency_controller_->batch_timeout_micros(),
+                                   model_name, op_name);
+  RecordObservedP99LatencyMicros(latency_controller_->p99_latency_micros(),
+                                 model_name, op_name);
+}
+
 // Processes a batch of one or more BatchTask entries.
 void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   if (batch->empty()) {
@@ -800,6 +923,10 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
 
   OP_REQUIRES_OK_ASYNC(last_task_context, ValidateBatch(*batch),
                        last_task_callback);
+  const uint64 current_time = EnvTime::NowNanos();
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    RecordQueueWait(batch->task(i), current_time);
+  }
 
   // All tasks should have the same number of input edges.
   const int num_input_edges = batch->task(0).inputs.size();
@@ -919,6 +1046,7 @@ Status BatchResourceBase::CreateBatchTask(
 void BatchResourceBase::SplitBatchCosts(
     std::vector<std::unique_ptr<CostMeasurement>>& batch_cost_measurements,
     const int64_t processed_size, BatchT& batch) {
+  absl::flat_hash_map<std::string, absl::Duration> batch_costs;
   for (auto& batch_cost_measurement : batch_cost_measurements) {
     if (batch_cost_measurement->GetTotalCost() <= absl::ZeroDuration()) {
       continue;
@@ -936,25 +1064,44 @@ void BatchResourceBase::SplitBatchCosts(
     }
     const absl::string_view cost_type = batch_cost_measurement->GetCostType();
     const absl::Duration total_cost = batch_cost_measurement->GetTotalCost();
+    batch_costs[std::string(cost_type)] += total_cost;
 
+    // Each task is charged the cost of the rows preceding it and its own,
+    // minus the cost of the rows preceding it. Rounding errors thus don't
+    // accumulate, and the charges add up to exactly the batch's cost.
+    int64_t preceding_size = 0;
     for (int i = 0; i < batch.num_tasks(); i++) {
+      const int64_t task_size = batch.task(i).size();
+      const int64_t size = preceding_size + task_size;
       RequestCost* request_cost = batch.task(i).request_cost;
       // Skip recording the cost if the request_cost is null.
-      if (!request_cost) continue;
-
-      // Smeared cost: cost of paddings are assigned to each task.
-      const auto cost_with_smear =
-          total_cost / batch.size() * batch.task(i).size();
-
-      // Non-smeared cost: cost of paddings are not assigned to any tasks.
-      const auto cost_no_smear =
-          total_cost / processed_size * batch.task(i).size();
-
-      request_cost->RecordCost(
-          {{absl::StrCat(cost_type, kWithSmearSuffix), cost_with_smear},
-           {absl::StrCat(cost_type, kNoSmearSuffix), cost_no_smear}});
+      if (request_cost) {
+        // Smeared cost: cost of paddings are assigned to each task.
+        const auto cost_with_smear =
+            total_cost * size / batch.size() -
+            total_cost * preceding_size / batch.size();
+
+        // Non-smeared cost: cost of paddings are not assigned to any tasks.
+        const auto cost_no_smear =
+            total_cost * size / processed_size -
+            total_cost * preceding_size / processed_size;
+
+        request_cost->RecordCost(
+            {{absl::StrCat(cost_type, kWithSmearSuffix), cost_with_smear},
+             {absl::StrCat(cost_type, kNoSmearSuffix), cost_no_smear}});
+      }
+      preceding_size = size;
     }
   }
+
+  // Record what the costs were split from, for each request.
+  for (int i = 0; i < batch.num_tasks(); i++) {
+    RequestCost* request_cost = batch.task(i).request_cost;
+    if (!request_cost) continue;
+    request_cost->RecordBatchMetrics(
+        {{processed_size, static_cast<int64_t>(batch.task(i).size()),
+          processed_size - static_cast<int64_t>(batch.size()), batch_costs}});
+  }
 }
 
 }  // namespace serving
@@ -17,7 +17,10 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_RESOURCE_BASE_H_
 
 #include <map>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost.h"
@@ -26,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/batch_latency_controller.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/threadsafe_status.h"
@@ -52,6 +56,21 @@ class BatchResourceBase : public ResourceBase {
                        const string& batcher_queue_name,
                        AsyncOpKernel::DoneCallback done_callback);
 
+  // Tunes the batch timeout of the queues online, so that the p99 latency of
+  // the tasks stays below 'latency_slo_micros'. The configured batch timeout
+  // becomes the upper bound of the tuned one. Only applies to resources using
+  // a `SharedBatchScheduler`, and must be called before the first input is
+  // registered.
+  void SetLatencySlo(int64_t latency_slo_micros);
+
+  // If set, each task of a batch function gets its outputs as slices aliasing
+  // the outputs of the batch, when those are suitably aligned, rather than as
+  // copies. Saves a copy per output, but every task's outputs then keep the
+  // whole batch's outputs alive.
+  void SetAliasBatchOutputs(bool alias_batch_outputs) {
+    alias_batch_outputs_ = alias_batch_outputs;
+  }
+
  public:
   // One task to be batched, corresponds to a `slice` of input from one batch-op
   // invocation.
@@ -225,6 +244,10 @@ class BatchResourceBase : public ResourceBase {
 
   void ProcessFuncBatch(std::unique_ptr<BatchT> batch) const;
 
+  // Feeds the latencies of the tasks in 'batch', which are about to be marked
+  // done, to 'latency_controller_', and records its decisions.
+  void RecordTaskLatencies(const BatchT& batch) const;
+
   // Processes a batch of one or more BatchTask entries.
   void ProcessBatch(std::unique_ptr<BatchT> batch) const;
 
@@ -243,11 +266,23 @@ class BatchResourceBase : public ResourceBase {
   Status LookupOrCreateBatcherQueue(const string& queue_name,
                                     BatcherQueueT** queue);
 
+  // Returns the name of the queue to batch 'tensors' in. Tasks are bucketed by
+  // the shapes of their inputs besides the 0th dimension, so that tasks of
+  // e.g. different sequence lengths are batched separately, without padding
+  // or failing to concatenate. Past 'kMaxShapeBucketsPerQueue' shapes, tasks
+  // go to 'batcher_queue_name' itself.
+  string ShapeBucketQueueName(const string& batcher_queue_name,
+                              const OpInputList& tensors);
+
   // True if user specified a batch processing function for this resource.
   const bool has_process_batch_function_;
   // A batch scheduler, and options for creating queues.
   std::shared_ptr<BatcherT> batcher_;
   BatcherT::QueueOptions batcher_queue_options_;
+  // Tunes the batch timeout of the queues, if a latency SLO is set. Declared
+  // before the queues, which call into it until they are destroyed.
+  std::unique_ptr<BatchLatencyController> latency_controller_;
+  bool alias_batch_outputs_ = false;
 
   // A batch scheduler, and options for creating queues.
   std::shared_ptr<AdaptiveBatcherT> adaptive_batcher_;
@@ -259,6 +294,9 @@ class BatchResourceBase : public ResourceBase {
   mutable mutex batcher_queues_mu_;
   std::map<string, std::unique_ptr<BatcherQueueT>> batcher_queues_
       TF_GUARDED_BY(batcher_queues_mu_);
+  // The shape bucket queue names of each batcher queue name.
+  absl::flat_hash_map<string, absl::flat_hash_set<string>> shape_buckets_
+      TF_GUARDED_BY(batcher_queues_mu_);
 
   std::vector<int32> allowed_batch_sizes_;
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
@@ -190,6 +190,52 @@ TEST(SplitBatchCostTest, SplitOnlyNonZeroCostTypes) {
                            Pair("test_tpu_no_smear", absl::Milliseconds(45))));
 }
 
+TEST(SplitBatchCostTest, SplitCostsAddUpToBatchCost) {
+  BatchResourceBase::BatchT batch;
+  RequestCost cost1, cost2, cost3;
+  batch.AddTask(MakeBatchTask(/*task_size=*/1, &cost1));
+  batch.AddTask(MakeBatchTask(/*task_size=*/1, &cost2));
+  batch.AddTask(MakeBatchTask(/*task_size=*/1, &cost3));
+  batch.Close();
+
+  CostMeasurement::Context context{/*is_per_query=*/false};
+  std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements;
+  batch_cost_measurements.push_back(
+      CostMeasurementRegistry::CreateByNameOrNull("test_tpu", context));
+  BatchResourceBase::SplitBatchCosts(batch_cost_measurements,
+                                     /*processed_size=*/3, batch);
+
+  absl::Duration total = absl::ZeroDuration();
+  for (RequestCost* cost : {&cost1, &cost2, &cost3}) {
+    total += cost->GetCosts()["test_tpu_with_smear"];
+  }
+  EXPECT_EQ(total, absl::Milliseconds(100));
+}
+
+TEST(SplitBatchCostTest, RecordBatchMetrics) {
+  BatchResourceBase::BatchT batch;
+  RequestCost cost1, cost2;
+  batch.AddTask(MakeBatchTask(/*task_size=*/1, &cost1));
+  batch.AddTask(MakeBatchTask(/*task_size=*/9, &cost2));
+  batch.Close();
+
+  CostMeasurement::Context context{/*is_per_query=*/false};
+  std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements;
+  batch_cost_measurements.push_back(
+      CostMeasurementRegistry::CreateByNameOrNull("test_tpu", context));
+  BatchResourceBase::SplitBatchCosts(batch_cost_measurements,
+                                     /*processed_size=*/16, batch);
+
+  const std::vector<RequestCost::BatchMetrics> metrics =
+      cost2.GetBatchMetrics();
+  ASSERT_EQ(metrics.size(), 1);
+  EXPECT_EQ(metrics[0].processed_size, 16);
+  EXPECT_EQ(metrics[0].input_size, 9);
+  EXPECT_EQ(metrics[0].padding_size, 6);
+  EXPECT_THAT(metrics[0].batch_costs,
+              UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))));
+}
+
 }  // namespace
 }  // namespace serving
 }  // namespace tensorflow
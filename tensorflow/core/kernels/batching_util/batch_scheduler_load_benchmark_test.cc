@@ -0,0 +1,407 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Benchmarks the latency, batch fill ratio and throughput of the shared batch
+// schedulers under Poisson, bursty and trace-driven task arrivals.
+//
+// Time is simulated with a FakeClockEnv: tasks arrive at their scheduled fake
+// times, and every batch occupies a simulated serial device (e.g. a GPU) for a
+// fake duration that grows with the batch size. Results are thus reported in
+// simulated time and mostly independent of the machine running them.
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/core/kernels/batching_util/adaptive_shared_batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
+#include "tensorflow/core/kernels/batching_util/serial_device_batch_scheduler.h"
+#include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::tensorflow::histogram::Histogram;
+
+// Simulated duration of the load of each benchmark.
+static int load_duration_secs = 10;
+// File with one task arrival time, in microseconds, per line.
+static string arrival_trace_file;  // NOLINT
+
+constexpr int kMaxBatchSize = 64;
+constexpr int64_t kBatchTimeoutMicros = 1000;
+constexpr int kNumBatchThreads = 4;
+// A batch occupies the device for a fixed cost plus a cost per task.
+constexpr int64_t kBatchFixedCostMicros = 2000;
+constexpr int64_t kTaskCostMicros = 20;
+// Bursts last kBurstFraction of each kBurstPeriodMicros, at kBurstFactor times
+// the average rate.
+constexpr int64_t kBurstPeriodMicros = 100 * 1000;
+constexpr double kBurstFraction = 0.2;
+constexpr double kBurstFactor = 4;
+// The fake clock advances by at most this much per real kClockTickMicros, so
+// that scheduler threads observe the clock between advances.
+constexpr int kClockStepMicros = 50;
+constexpr int kClockTickMicros = 20;
+
+enum ArrivalProcess { kPoisson = 0, kBursty = 1, kTrace = 2 };
+
+// Returns the arrival times of tasks arriving at 'rate_per_micro' (on average)
+// from 'start_micros' until 'end_micros', with exponential interarrival times.
+void AppendPoissonArrivals(double rate_per_micro, int64_t start_micros,
+                           int64_t end_micros, std::mt19937_64* rng,
+                           std::vector<int64_t>* arrivals) {
+  std::exponential_distribution<double> interarrival(rate_per_micro);
+  double t = start_micros;
+  for (;;) {
+    t += interarrival(*rng);
+    if (t >= end_micros) return;
+    arrivals->push_back(static_cast<int64_t>(t));
+  }
+}
+
+std::vector<int64_t> PoissonArrivals(int64_t qps, int64_t duration_micros) {
+  std::mt19937_64 rng(/*seed=*/42);
+  std::vector<int64_t> arrivals;
+  AppendPoissonArrivals(qps / 1e6, 0, duration_micros, &rng, &arrivals);
+  return arrivals;
+}
+
+// Poisson arrivals alternating between bursts and quieter periods, with an
+// average rate of 'qps'.
+std::vector<int64_t> BurstyArrivals(int64_t qps, int64_t duration_micros) {
+  std::mt19937_64 rng(/*seed=*/42);
+  const double burst_rate = kBurstFactor * qps / 1e6;
+  const double quiet_rate =
+      (1 - kBurstFraction * kBurstFactor) / (1 - kBurstFraction) * qps / 1e6;
+  const int64_t burst_micros = kBurstFraction * kBurstPeriodMicros;
+  std::vector<int64_t> arrivals;
+  for (int64_t start = 0; start < duration_micros;
+       start += kBurstPeriodMicros) {
+    const int64_t end = std::min(start + kBurstPeriodMicros, duration_micros);
+    AppendPoissonArrivals(burst_rate, start,
+                          std::min(start + burst_micros, end), &rng,
+                          &arrivals);
+    AppendPoissonArrivals(quiet_rate, start + burst_micros, end, &rng,
+                          &arrivals);
+  }
+  return arrivals;
+}
+
+// Reads the arrival times in 'arrival_trace_file', relative to the first one.
+Status TraceArrivals(std::vector<int64_t>* arrivals) {
+  string contents;
+  TF_RETURN_IF_ERROR(
+      ReadFileToString(Env::Default(), arrival_trace_file, &contents));
+  for (absl::string_view line :
+       absl::StrSplit(contents, '\n', absl::SkipWhitespace())) {
+    int64_t arrival;
+    if (!absl::SimpleAtoi(line, &arrival)) {
+      return errors::InvalidArgument("Bad arrival time in ",
+                                     arrival_trace_file, ": ", line);
+    }
+    arrivals->push_back(arrival);
+  }
+  if (arrivals->empty()) {
+    return errors::InvalidArgument("No arrivals in ", arrival_trace_file);
+  }
+  std::sort(arrivals->begin(), arrivals->end());
+  const int64_t first = arrivals->front();
+  for (int64_t& arrival : *arrivals) {
+    arrival -= first;
+  }
+  return OkStatus();
+}
+
+class LoadTask : public BatchTask {
+ public:
+  explicit LoadTask(uint64 arrival_time_micros)
+      : arrival_time_micros_(arrival_time_micros) {}
+
+  size_t size() const override { return 1; }
+
+  uint64 arrival_time_micros() const { return arrival_time_micros_; }
+
+ private:
+  const uint64 arrival_time_micros_;
+};
+
+// Replays task arrivals against a batch scheduler queue, processes the batches
+// on a simulated serial device, and collects statistics.
+class LoadReplayer {
+ public:
+  LoadReplayer() : env_(Env::Default()) {}
+
+  test_util::FakeClockEnv* env() { return &env_; }
+
+  // The number of batches waiting for the simulated device.
+  int64_t pending_on_device() const { return pending_on_device_; }
+
+  // Processes 'batch' on the simulated device. Runs on a batch thread.
+  void ProcessBatch(std::unique_ptr<Batch<LoadTask>> batch) {
+    ++pending_on_device_;
+    {
+      mutex_lock l(device_mu_);
+      --pending_on_device_;
+      env_.SleepForMicroseconds(kBatchFixedCostMicros +
+                                kTaskCostMicros * batch->size());
+    }
+    const uint64 now = env_.NowMicros();
+    mutex_lock l(mu_);
+    fill_ratio_.Add(static_cast<double>(batch->size()) / kMaxBatchSize);
+    for (int i = 0; i < batch->num_tasks(); ++i) {
+      latency_micros_.Add(now - batch->task(i).arrival_time_micros());
+    }
+    num_completed_ += batch->num_tasks();
+    last_completion_micros_ = now;
+  }
+
+  // Schedules tasks in 'queue' at 'arrivals', then waits for all of them to
+  // complete and destroys 'queue'.
+  void Replay(const std::vector<int64_t>& arrivals,
+              std::unique_ptr<BatchScheduler<LoadTask>> queue) {
+    for (const int64_t arrival : arrivals) {
+      AdvanceClockTo(arrival);
+      auto task = std::make_unique<LoadTask>(env_.NowMicros());
+      const Status status = queue->Schedule(&task);
+      if (!status.ok()) ++num_rejected_;
+    }
+    while (num_completed() + num_rejected_ < arrivals.size()) {
+      AdvanceClockTo(env_.NowMicros() + kClockStepMicros);
+    }
+    // Queues and schedulers may sleep on the fake clock while shutting down.
+    Notification stop;
+    std::unique_ptr<Thread> clock_advancer(Env::Default()->StartThread(
+        {}, "FakeClockAdvancer", [this, &stop] {
+          while (!stop.HasBeenNotified()) {
+            env_.AdvanceByMicroseconds(kClockStepMicros);
+            Env::Default()->SleepForMicroseconds(kClockTickMicros);
+          }
+        }));
+    queue.reset();
+    stop.Notify();
+  }
+
+  string Report() {
+    mutex_lock l(mu_);
+    const double throughput =
+        last_completion_micros_ > 0
+            ? num_completed_ * 1e6 / last_completion_micros_
+            : 0;
+    return absl::StrCat(
+        "lat_p50=", latency_micros_.Percentile(50) / 1000,
+        "ms,lat_p99=", latency_micros_.Percentile(99) / 1000,
+        "ms,fill_avg=", fill_ratio_.Average(), ",qps=", throughput,
+        ",rejected=", num_rejected_);
+  }
+
+ private:
+  void AdvanceClockTo(uint64 time_micros) {
+    uint64 now = env_.NowMicros();
+    while (now < time_micros) {
+      const int step = std::min<uint64>(time_micros - now, kClockStepMicros);
+      env_.AdvanceByMicroseconds(step);
+      Env::Default()->SleepForMicroseconds(kClockTickMicros);
+      now += step;
+    }
+  }
+
+  size_t num_completed() {
+    mutex_lock l(mu_);
+    return num_completed_;
+  }
+
+  test_util::FakeClockEnv env_;
+  // Held while a batch occupies the simulated device.
+  mutex device_mu_;
+  std::atomic<int64_t> pending_on_device_{0};
+  size_t num_rejected_ = 0;
+
+  mutex mu_;
+  Histogram latency_micros_ TF_GUARDED_BY(mu_);
+  Histogram fill_ratio_ TF_GUARDED_BY(mu_);
+  size_t num_completed_ TF_GUARDED_BY(mu_) = 0;
+  uint64 last_completion_micros_ TF_GUARDED_BY(mu_) = 0;
+};
+
+// Returns the arrivals of 'process' at 'qps', or false if there are none.
+bool GetArrivals(::testing::benchmark::State& state,
+                 std::vector<int64_t>* arrivals) {
+  const int64_t duration_micros = load_duration_secs * int64_t{1000000};
+  switch (state.range(0)) {
+    case kPoisson:
+      *arrivals = PoissonArrivals(state.range(1), duration_micros);
+      return true;
+    case kBursty:
+      *arrivals = BurstyArrivals(state.range(1), duration_micros);
+      return true;
+    case kTrace: {
+      if (arrival_trace_file.empty()) {
+        state.SkipWithError("--arrival_trace_file is not set");
+        return false;
+      }
+      const Status status = TraceArrivals(arrivals);
+      if (!status.ok()) {
+        state.SkipWithError(status.ToString().c_str());
+        return false;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+void BM_SharedBatchScheduler(::testing::benchmark::State& state) {
+  std::vector<int64_t> arrivals;
+  if (!GetArrivals(state, &arrivals)) return;
+  for (auto s : state) {
+    LoadReplayer replayer;
+    SharedBatchScheduler<LoadTask>::Options options;
+    options.num_batch_threads = kNumBatchThreads;
+    options.env = replayer.env();
+    std::shared_ptr<SharedBatchScheduler<LoadTask>> scheduler;
+    TF_CHECK_OK(SharedBatchScheduler<LoadTask>::Create(options, &scheduler));
+    SharedBatchScheduler<LoadTask>::QueueOptions queue_options;
+    queue_options.input_batch_size_limit = kMaxBatchSize;
+    queue_options.batch_timeout_micros = kBatchTimeoutMicros;
+    queue_options.max_enqueued_batches = INT_MAX;
+    std::unique_ptr<BatchScheduler<LoadTask>> queue;
+    TF_CHECK_OK(scheduler->AddQueue(
+        queue_options,
+        [&replayer](std::unique_ptr<Batch<LoadTask>> batch) {
+          replayer.ProcessBatch(std::move(batch));
+        },
+        &queue));
+    scheduler.reset();
+    replayer.Replay(arrivals, std::move(queue));
+    state.SetLabel(replayer.Report());
+  }
+}
+
+void BM_AdaptiveSharedBatchScheduler(::testing::benchmark::State& state) {
+  std::vector<int64_t> arrivals;
+  if (!GetArrivals(state, &arrivals)) return;
+  for (auto s : state) {
+    LoadReplayer replayer;
+    AdaptiveSharedBatchScheduler<LoadTask>::Options options;
+    options.num_batch_threads = kNumBatchThreads;
+    options.env = replayer.env();
+    std::shared_ptr<AdaptiveSharedBatchScheduler<LoadTask>> scheduler;
+    TF_CHECK_OK(
+        AdaptiveSharedBatchScheduler<LoadTask>::Create(options, &scheduler));
+    AdaptiveSharedBatchScheduler<LoadTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = kMaxBatchSize;
+    queue_options.batch_timeout_micros = kBatchTimeoutMicros;
+    queue_options.max_enqueued_batches = INT_MAX;
+    std::unique_ptr<BatchScheduler<LoadTask>> queue;
+    TF_CHECK_OK(scheduler->AddQueue(
+        queue_options,
+        [&replayer](std::unique_ptr<Batch<LoadTask>> batch) {
+          replayer.ProcessBatch(std::move(batch));
+        },
+        &queue));
+    scheduler.reset();
+    replayer.Replay(arrivals, std::move(queue));
+    state.SetLabel(replayer.Report());
+  }
+}
+
+void BM_SerialDeviceBatchScheduler(::testing::benchmark::State& state) {
+  std::vector<int64_t> arrivals;
+  if (!GetArrivals(state, &arrivals)) return;
+  for (auto s : state) {
+    LoadReplayer replayer;
+    SerialDeviceBatchScheduler<LoadTask>::Options options;
+    options.num_batch_threads = kNumBatchThreads;
+    options.initial_in_flight_batches_limit = 1;
+    options.batches_to_average_over = 100;
+    options.env = replayer.env();
+    options.get_pending_on_serial_device = [&replayer]() {
+      return replayer.pending_on_device();
+    };
+    std::shared_ptr<SerialDeviceBatchScheduler<LoadTask>> scheduler;
+    TF_CHECK_OK(
+        SerialDeviceBatchScheduler<LoadTask>::Create(options, &scheduler));
+    SerialDeviceBatchScheduler<LoadTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = kMaxBatchSize;
+    queue_options.max_enqueued_batches = INT_MAX;
+    std::unique_ptr<BatchScheduler<LoadTask>> queue;
+    TF_CHECK_OK(scheduler->AddQueue(
+        queue_options,
+        [&replayer](std::unique_ptr<Batch<LoadTask>> batch) {
+          replayer.ProcessBatch(std::move(batch));
+        },
+        &queue));
+    scheduler.reset();
+    replayer.Replay(arrivals, std::move(queue));
+    state.SetLabel(replayer.Report());
+  }
+}
+
+// The trace ignores the qps argument.
+#define LOAD_BENCHMARK(name)                            \
+  BENCHMARK(name)                                       \
+      ->UseRealTime()                                   \
+      ->Iterations(1)                                   \
+      ->ArgNames({"arrivals", "qps"})                   \
+      ->ArgsProduct({{kPoisson, kBursty}, {2000, 8000}}) \
+      ->Args({kTrace, 0})
+
+LOAD_BENCHMARK(BM_SharedBatchScheduler);
+LOAD_BENCHMARK(BM_AdaptiveSharedBatchScheduler);
+LOAD_BENCHMARK(BM_SerialDeviceBatchScheduler);
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
+
+int main(int argc, char** argv) {
+  const std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("load_duration_secs",
+                       &tensorflow::serving::load_duration_secs,
+                       "Simulated duration of the load of each benchmark."),
+      tensorflow::Flag("arrival_trace_file",
+                       &tensorflow::serving::arrival_trace_file,
+                       "File with one task arrival time, in microseconds, "
+                       "per line, replayed by the trace benchmarks.")};
+  if (!tensorflow::Flags::Parse(&argc, argv, flag_list)) {
+    std::cout << tensorflow::Flags::Usage(argv[0], flag_list);
+    return -1;
+  }
+
+  ::benchmark::Initialize(&argc, argv);
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONCAT_SPLIT_UTIL_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONCAT_SPLIT_UTIL_H_
 
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -30,6 +31,62 @@ namespace concat_split_util {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+// Returns the number of bytes in one row, i.e. one zeroth-dimension entry, of
+// 't'.
+inline int64_t RowBytes(const Tensor& t) {
+  int64_t row_elements = 1;
+  for (int i = 1; i < t.dims(); ++i) {
+    row_elements *= t.dim_size(i);
+  }
+  return row_elements * DataTypeSize(t.dtype());
+}
+
+// If 'inputs' are adjacent slices, in order, along the zeroth dimension of a
+// single buffer (e.g. rows reserved one after the other from a
+// `ContiguousBatchBuffer`), sets 'output' to a tensor aliasing those rows and
+// returns true. Concatenating such inputs needs no copy. Otherwise returns
+// false and leaves 'output' untouched.
+inline bool ConcatAdjacentSlices(const gtl::ArraySlice<Tensor> inputs,
+                                 Tensor* output) {
+  if (inputs.empty()) return false;
+  Tensor first = inputs[0];
+  if (!DataTypeCanUseMemcpy(first.dtype()) || first.dims() == 0 ||
+      DMAHelper::buffer(&first) == nullptr) {
+    return false;
+  }
+  const int64_t row_bytes = RowBytes(first);
+  if (row_bytes == 0) return false;
+  TensorBuffer* root = DMAHelper::buffer(&first)->root_buffer();
+
+  const char* next_row = first.tensor_data().data();
+  int64_t num_rows = 0;
+  for (Tensor input : inputs) {
+    if (input.dtype() != first.dtype() || input.dims() != first.dims() ||
+        input.dim_size(0) == 0 || DMAHelper::buffer(&input) == nullptr ||
+        DMAHelper::buffer(&input)->root_buffer() != root ||
+        input.tensor_data().data() != next_row) {
+      return false;
+    }
+    for (int j = 1; j < first.dims(); ++j) {
+      if (input.dim_size(j) != first.dim_size(j)) return false;
+    }
+    next_row += input.tensor_data().size();
+    num_rows += input.dim_size(0);
+  }
+
+  const int64_t offset =
+      first.tensor_data().data() - static_cast<const char*>(root->data());
+  if (offset % row_bytes != 0) return false;
+  TensorShape root_shape(first.shape());
+  root_shape.set_dim(0, root->size() / row_bytes);
+  const int64_t start_row = offset / row_bytes;
+  Tensor rows = Tensor(first.dtype(), root_shape, root)
+                    .Slice(start_row, start_row + num_rows);
+  if (!rows.IsAligned()) return false;
+  *output = std::move(rows);
+  return true;
+}
+
 // Concatenates 'inputs' into a single tensor along the zeroth dimension.
 // Requires that all elements of 'inputs' have element type T. Writes to
 // 'output' using 'context' for the allocation to ensure proper device
@@ -37,6 +94,10 @@ typedef Eigen::GpuDevice GPUDevice;
 template <typename T>
 Status Concat(OpKernelContext* context, const gtl::ArraySlice<Tensor> inputs,
               Tensor* output) {
+  if (ConcatAdjacentSlices(inputs, output)) {
+    return OkStatus();
+  }
+
   const int input_dims = inputs[0].dims();
   const TensorShape& input_shape = inputs[0].shape();
 
@@ -109,6 +170,35 @@ inline Status Concat(OpKernelContext* context,
   return concat_status;
 }
 
+// Splits 'input' into 'sizes.size()' tensors along the zeroth dimension, as
+// slices aliasing 'input' rather than copies. Returns false, leaving 'outputs'
+// untouched, unless 'sizes' add up to the zeroth-dimension size of 'input' and
+// every slice is aligned, which holds if the size of a row is a multiple of
+// EIGEN_MAX_ALIGN_BYTES.
+inline bool SplitIntoAlignedSlices(const Tensor& input,
+                                   const gtl::ArraySlice<int64_t> sizes,
+                                   std::vector<Tensor>* outputs) {
+  if (!DataTypeCanUseMemcpy(input.dtype()) || input.dims() == 0 ||
+      !input.IsAligned()) {
+    return false;
+  }
+#if EIGEN_MAX_ALIGN_BYTES > 0
+  if (RowBytes(input) % EIGEN_MAX_ALIGN_BYTES != 0) return false;
+#endif
+  int64_t total_size = 0;
+  for (const int64_t size : sizes) {
+    total_size += size;
+  }
+  if (total_size != input.dim_size(0)) return false;
+
+  int64_t position = 0;
+  for (const int64_t size : sizes) {
+    outputs->push_back(input.Slice(position, position + size));
+    position += size;
+  }
+  return true;
+}
+
 // The Split*() functions split 'input' with element type T into 'sizes.size()'
 // tensors along the zeroth dimension, with the ith split having zeroth-
 // dimension size 'sizes[i]'. They allocate the output tensors using 'context',
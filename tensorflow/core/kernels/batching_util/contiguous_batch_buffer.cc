@@ -0,0 +1,85 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/contiguous_batch_buffer.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace serving {
+
+/*static*/ Status ContiguousBatchBuffer::Create(
+    Allocator* allocator, DataType dtype, const TensorShape& row_shape,
+    int64_t capacity, std::unique_ptr<ContiguousBatchBuffer>* buffer) {
+  if (!DataTypeCanUseMemcpy(dtype)) {
+    return errors::InvalidArgument(
+        "Contiguous batch buffers do not support data type ",
+        DataTypeString(dtype));
+  }
+  if (capacity <= 0) {
+    return errors::InvalidArgument(
+        "Contiguous batch buffer capacity must be positive; was ", capacity);
+  }
+  TensorShape shape({capacity});
+  shape.AppendShape(row_shape);
+  Tensor tensor(allocator, dtype, shape);
+  if (!tensor.IsInitialized()) {
+    return errors::ResourceExhausted(
+        "Failed to allocate a contiguous batch buffer of shape ",
+        shape.DebugString());
+  }
+  buffer->reset(new ContiguousBatchBuffer(std::move(tensor)));
+  return OkStatus();
+}
+
+ContiguousBatchBuffer::ContiguousBatchBuffer(Tensor buffer)
+    : buffer_(std::move(buffer)),
+      row_bytes_(buffer_.TotalBytes() / buffer_.dim_size(0)) {}
+
+Status ContiguousBatchBuffer::Reserve(int64_t num_rows, Tensor* rows) {
+  mutex_lock l(mu_);
+  int64_t start = next_row_;
+  while (start < capacity() && !IsRowAligned(start)) {
+    ++start;
+  }
+  if (num_rows <= 0 || start + num_rows > capacity()) {
+    return errors::ResourceExhausted("Cannot reserve ", num_rows,
+                                     " rows in a contiguous batch buffer with ",
+                                     capacity() - start, " rows left");
+  }
+  *rows = buffer_.Slice(start, start + num_rows);
+  next_row_ = start + num_rows;
+  return OkStatus();
+}
+
+int64_t ContiguousBatchBuffer::num_used_rows() const {
+  mutex_lock l(mu_);
+  return next_row_;
+}
+
+bool ContiguousBatchBuffer::IsRowAligned(int64_t row) const {
+#if EIGEN_MAX_ALIGN_BYTES == 0
+  return true;
+#else
+  const char* data = buffer_.tensor_data().data() + row * row_bytes_;
+  return reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0;
+#endif
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,80 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTIGUOUS_BATCH_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTIGUOUS_BATCH_BUFFER_H_
+
+#include <memory>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace serving {
+
+// A host buffer that the producers of batched inputs allocate their requests'
+// tensors from, so that batching them needs no copy.
+//
+// Each call to Reserve() hands out the rows following those of the previous
+// call. When tasks whose inputs were reserved one after the other end up in
+// the same batch in the same order, `concat_split_util::Concat` returns a
+// tensor aliasing their rows instead of copying them.
+//
+// Reserved tensors are always aligned, so rows are skipped when a reservation
+// would not be. Reservations are therefore only adjacent if the size of a row
+// is a multiple of EIGEN_MAX_ALIGN_BYTES, e.g. 16 floats.
+//
+// This class is thread-safe.
+class ContiguousBatchBuffer {
+ public:
+  // Allocates room for 'capacity' rows, each a tensor of 'row_shape' with
+  // elements of 'dtype', from 'allocator'. 'dtype' must be memcpy-able.
+  static Status Create(Allocator* allocator, DataType dtype,
+                       const TensorShape& row_shape, int64_t capacity,
+                       std::unique_ptr<ContiguousBatchBuffer>* buffer);
+
+  // Sets 'rows' to a tensor of shape [num_rows] + row_shape, aliasing the
+  // next unused rows of the buffer. Returns a ResourceExhausted error if the
+  // buffer does not have enough rows left, in which case the caller should
+  // move on to a new buffer.
+  Status Reserve(int64_t num_rows, Tensor* rows) TF_LOCKS_EXCLUDED(mu_);
+
+  int64_t capacity() const { return buffer_.dim_size(0); }
+
+  // The number of rows reserved or skipped so far.
+  int64_t num_used_rows() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  explicit ContiguousBatchBuffer(Tensor buffer);
+
+  // Returns true if a tensor starting at 'row' would be aligned.
+  bool IsRowAligned(int64_t row) const;
+
+  const Tensor buffer_;
+  const int64_t row_bytes_;
+
+  mutable mutex mu_;
+  int64_t next_row_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_CONTIGUOUS_BATCH_BUFFER_H_
@@ -0,0 +1,128 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/contiguous_batch_buffer.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/batching_util/concat_split_util.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/error_codes.pb.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+using ::tensorflow::testing::StatusIs;
+
+// 16 floats make 64 bytes, a multiple of any EIGEN_MAX_ALIGN_BYTES.
+constexpr int kRowSize = 16;
+
+std::unique_ptr<ContiguousBatchBuffer> CreateBuffer(int64_t capacity) {
+  std::unique_ptr<ContiguousBatchBuffer> buffer;
+  TF_CHECK_OK(ContiguousBatchBuffer::Create(cpu_allocator(), DT_FLOAT,
+                                            TensorShape({kRowSize}), capacity,
+                                            &buffer));
+  return buffer;
+}
+
+Tensor Reserve(ContiguousBatchBuffer& buffer, int64_t num_rows, float value) {
+  Tensor rows;
+  TF_CHECK_OK(buffer.Reserve(num_rows, &rows));
+  rows.flat<float>().setConstant(value);
+  return rows;
+}
+
+TEST(ContiguousBatchBufferTest, ReservesAdjacentRows) {
+  std::unique_ptr<ContiguousBatchBuffer> buffer = CreateBuffer(8);
+  Tensor first = Reserve(*buffer, 2, 1.0);
+  Tensor second = Reserve(*buffer, 3, 2.0);
+  EXPECT_EQ(first.shape(), TensorShape({2, kRowSize}));
+  EXPECT_EQ(second.shape(), TensorShape({3, kRowSize}));
+  EXPECT_TRUE(first.IsAligned());
+  EXPECT_TRUE(second.IsAligned());
+  EXPECT_EQ(first.tensor_data().data() + first.TotalBytes(),
+            second.tensor_data().data());
+  EXPECT_EQ(buffer->num_used_rows(), 5);
+}
+
+TEST(ContiguousBatchBufferTest, Exhausted) {
+  std::unique_ptr<ContiguousBatchBuffer> buffer = CreateBuffer(4);
+  Reserve(*buffer, 3, 1.0);
+  Tensor rows;
+  EXPECT_THAT(buffer->Reserve(2, &rows),
+              StatusIs(error::RESOURCE_EXHAUSTED));
+  TF_EXPECT_OK(buffer->Reserve(1, &rows));
+}
+
+TEST(ContiguousBatchBufferTest, UnsupportedDataType) {
+  std::unique_ptr<ContiguousBatchBuffer> buffer;
+  EXPECT_THAT(ContiguousBatchBuffer::Create(cpu_allocator(), DT_STRING,
+                                            TensorShape({}), 4, &buffer),
+              StatusIs(error::INVALID_ARGUMENT));
+}
+
+TEST(ContiguousBatchBufferTest, ConcatAliasesAdjacentRows) {
+  std::unique_ptr<ContiguousBatchBuffer> buffer = CreateBuffer(8);
+  Tensor first = Reserve(*buffer, 2, 1.0);
+  Tensor second = Reserve(*buffer, 3, 2.0);
+
+  Tensor batch;
+  ASSERT_TRUE(concat_split_util::ConcatAdjacentSlices({first, second}, &batch));
+  EXPECT_EQ(batch.shape(), TensorShape({5, kRowSize}));
+  EXPECT_TRUE(batch.SharesBufferWith(first));
+  EXPECT_EQ(batch.tensor_data().data(), first.tensor_data().data());
+  EXPECT_EQ(batch.flat<float>()(0), 1.0);
+  EXPECT_EQ(batch.flat<float>()(4 * kRowSize), 2.0);
+}
+
+TEST(ContiguousBatchBufferTest, ConcatCopiesOutOfOrderRows) {
+  std::unique_ptr<ContiguousBatchBuffer> buffer = CreateBuffer(8);
+  Tensor first = Reserve(*buffer, 2, 1.0);
+  Tensor second = Reserve(*buffer, 3, 2.0);
+  Tensor other = test::AsTensor<float>(std::vector<float>(kRowSize, 3.0),
+                                       TensorShape({1, kRowSize}));
+
+  Tensor batch;
+  EXPECT_FALSE(
+      concat_split_util::ConcatAdjacentSlices({second, first}, &batch));
+  EXPECT_FALSE(concat_split_util::ConcatAdjacentSlices({first, other}, &batch));
+}
+
+TEST(ContiguousBatchBufferTest, SplitIntoAlignedSlices) {
+  std::unique_ptr<ContiguousBatchBuffer> buffer = CreateBuffer(8);
+  Tensor batch = Reserve(*buffer, 5, 1.0);
+
+  std::vector<Tensor> outputs;
+  ASSERT_TRUE(
+      concat_split_util::SplitIntoAlignedSlices(batch, {2, 3}, &outputs));
+  ASSERT_EQ(outputs.size(), 2);
+  EXPECT_EQ(outputs[0].shape(), TensorShape({2, kRowSize}));
+  EXPECT_EQ(outputs[1].shape(), TensorShape({3, kRowSize}));
+  EXPECT_TRUE(outputs[1].SharesBufferWith(batch));
+
+  outputs.clear();
+  EXPECT_FALSE(
+      concat_split_util::SplitIntoAlignedSlices(batch, {2, 2}, &outputs));
+  EXPECT_TRUE(outputs.empty());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -20,6 +20,7 @@ limitations under the License.
 #include <memory>
 #include <random>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
@@ -61,6 +62,11 @@ class SDBSQueue;
 // processing thread becomes available. SDBS prioritizes batches primarily by
 // age (i.e. the batch's oldest request) along with a configurable preference
 // for scheduling larger batches first.
+//
+// SDBS can also spread the batches of each model over several serial devices
+// (e.g. all GPUs of a host). Each batch is then assigned to the device with the
+// fewest batches in flight, and the in-flight batches limit applies to each
+// device, so that one queue per model keeps all devices busy.
 
 
 template <typename TaskType>
@@ -72,7 +78,7 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
   struct Options {
     // The name to use for the pool of batch threads.
     string thread_pool_name = {"batch_threads"};
-    // Maximum number of batch processing threads.
+    // Maximum number of batch processing threads, shared by all devices.
     int64_t num_batch_threads = port::NumSchedulableCPUs();
     // Although batch selection is primarily based on age, this parameter
     // specifies a preference for larger batches.  A full batch will be
@@ -83,13 +89,23 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
     int64_t full_batch_scheduling_boost_micros = 0;
     // The environment to use (typically only overridden by test code).
     Env* env = Env::Default();
-    // Initial limit for number of batches being concurrently processed.
+    // Initial limit for number of batches being concurrently processed, per
+    // device.
     int64_t initial_in_flight_batches_limit = 3;
     // Returns the current number of batches directly waiting to be processed
-    // by the serial device (i.e. GPU, TPU).
+    // by the serial device (i.e. GPU, TPU). Only used with a single device.
     std::function<int64()> get_pending_on_serial_device;
-    // Desired average number of batches directly waiting to be processed by the
-    // serial device. Small numbers of O(1) should deliver the best latency.
+    // Number of serial devices batches are assigned to. Batches are processed
+    // by callbacks added with the `DeviceBatchProcessor` overload of
+    // AddQueue(), which learn the device they should run on.
+    int64_t num_devices = 1;
+    // Returns the current number of batches directly waiting to be processed
+    // by the given serial device, in [0, num_devices). Required if there is
+    // more than one device; takes the place of get_pending_on_serial_device.
+    std::function<int64(int64_t device)> get_pending_on_device;
+    // Desired average number of batches directly waiting to be processed by
+    // each serial device. Small numbers of O(1) should deliver the best
+    // latency.
     double target_pending = 2;
     // Number of batches between potential adjustments of
     // in_flight_batches_limit.  Larger numbers will reduce noise, but will be
@@ -111,11 +127,23 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
+  // Processes a batch on the given device, in [0, num_devices).
+  using DeviceBatchProcessor =
+      std::function<void(std::unique_ptr<Batch<TaskType>>, int64_t device)>;
 
   // Adds queue (and its callback) to be managed by this scheduler.
   Status AddQueue(const QueueOptions& options,
                   BatchProcessor process_batch_callback,
                   std::unique_ptr<BatchScheduler<TaskType>>* queue);
+  Status AddQueue(const QueueOptions& options,
+                  DeviceBatchProcessor process_batch_callback,
+                  std::unique_ptr<BatchScheduler<TaskType>>* queue);
+
+  // The number of batches currently being processed for 'device'.
+  int64_t in_flight_batches(int64_t device) {
+    mutex_lock l(mu_);
+    return in_flight_batches_[device];
+  }
 
   double in_flight_batches_limit() {
     mutex_lock l(mu_);
@@ -144,6 +172,13 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
 
   Env* env() const { return options_.env; }
 
+  // Returns the number of batches directly waiting on 'device'.
+  int64_t GetPendingOnDevice(int64_t device) const;
+
+  // Returns the device with the fewest batches in flight, breaking ties by the
+  // number of batches pending on the devices.
+  int64_t LeastLoadedDevice() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   const Options options_;
 
   // Collection of batches added by AddBatch. Owned by scheduler until they are
@@ -151,13 +186,17 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
   std::vector<const internal::SDBSBatch<TaskType>*> batches_ TF_GUARDED_BY(mu_);
 
   // Unowned queues and callbacks added by AddQueue.
-  std::unordered_map<const internal::SDBSQueue<TaskType>*, BatchProcessor>
+  std::unordered_map<const internal::SDBSQueue<TaskType>*, DeviceBatchProcessor>
       queues_and_callbacks_ TF_GUARDED_BY(mu_);
 
+  // Number of batches being processed for each device.
+  std::vector<int64_t> in_flight_batches_ TF_GUARDED_BY(mu_);
+
   // Responsible for running the batch processing callbacks.
   std::unique_ptr<thread::ThreadPool> batch_thread_pool_;
 
-  // Limit on number of batches which can be concurrently processed.
+  // Limit on number of batches which can be concurrently processed, per
+  // device.
   int64_t in_flight_batches_limit_ TF_GUARDED_BY(mu_);
 
   // Number of batch processing threads.
@@ -171,8 +210,8 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
   // processing thread was available but there were no batches to process.
   int64_t no_batch_count_ TF_GUARDED_BY(mu_) = 0;
 
-  // Sum of batches pending on the serial device since the last
-  // in_flight_batches_limit_ adjustment.
+  // Sum of batches pending on the serial devices, as seen by each processed
+  // batch on its device, since the last in_flight_batches_limit_ adjustment.
   int64_t pending_sum_ = 0;
 
   // Sum of batch latencies since the last in_flight_batches_limit_ adjustment.
@@ -271,11 +310,16 @@ Status SerialDeviceBatchScheduler<TaskType>::Create(
         "initial_in_flight_batches_limit must be positive; was ",
         options.initial_in_flight_batches_limit);
   }
-  if (options.initial_in_flight_batches_limit > options.num_batch_threads) {
+  if (options.num_devices < 1) {
+    return errors::InvalidArgument("num_devices must be positive; was ",
+                                   options.num_devices);
+  }
+  if (options.initial_in_flight_batches_limit * options.num_devices >
+      options.num_batch_threads) {
     return errors::InvalidArgument(
         "initial_in_flight_batches_limit (",
-        options.initial_in_flight_batches_limit,
-        ") should not be larger than num_batch_threads (",
+        options.initial_in_flight_batches_limit, ") times num_devices (",
+        options.num_devices, ") should not be larger than num_batch_threads (",
         options.num_batch_threads, ")");
   }
   if (options.full_batch_scheduling_boost_micros < 0) {
@@ -294,7 +338,11 @@ Status SerialDeviceBatchScheduler<TaskType>::Create(
         "target_pending should be larger than zero; was ",
         options.target_pending);
   }
-  if (!options.get_pending_on_serial_device) {
+  if (options.num_devices > 1 && !options.get_pending_on_device) {
+    return errors::InvalidArgument(
+        "get_pending_on_device must be specified with more than one device");
+  }
+  if (!options.get_pending_on_serial_device && !options.get_pending_on_device) {
     return errors::InvalidArgument(
         "get_pending_on_serial_device must be "
         "specified");
@@ -307,8 +355,10 @@ template <typename TaskType>
 SerialDeviceBatchScheduler<TaskType>::SerialDeviceBatchScheduler(
     const Options& options)
     : options_(options),
+      in_flight_batches_(options.num_devices, 0),
       in_flight_batches_limit_(options.initial_in_flight_batches_limit),
-      processing_threads_(options.initial_in_flight_batches_limit) {
+      processing_threads_(options.initial_in_flight_batches_limit *
+                          options.num_devices) {
   batch_thread_pool_.reset(new thread::ThreadPool(
       env(), options.thread_pool_name, options.num_batch_threads));
   for (int i = 0; i < processing_threads_; i++) {
@@ -332,6 +382,20 @@ template <typename TaskType>
 Status SerialDeviceBatchScheduler<TaskType>::AddQueue(
     const QueueOptions& options, BatchProcessor process_batch_callback,
     std::unique_ptr<BatchScheduler<TaskType>>* queue) {
+  return AddQueue(
+      options,
+      DeviceBatchProcessor(
+          [process_batch_callback](std::unique_ptr<Batch<TaskType>> batch,
+                                   int64_t device) {
+            process_batch_callback(std::move(batch));
+          }),
+      queue);
+}
+
+template <typename TaskType>
+Status SerialDeviceBatchScheduler<TaskType>::AddQueue(
+    const QueueOptions& options, DeviceBatchProcessor process_batch_callback,
+    std::unique_ptr<BatchScheduler<TaskType>>* queue) {
   if (options.max_batch_size <= 0) {
     return errors::InvalidArgument("max_batch_size must be positive; was ",
                                    options.max_batch_size);
@@ -363,6 +427,34 @@ void SerialDeviceBatchScheduler<TaskType>::RemoveQueue(
   queues_and_callbacks_.erase(queue);
 }
 
+template <typename TaskType>
+int64_t SerialDeviceBatchScheduler<TaskType>::GetPendingOnDevice(
+    int64_t device) const {
+  if (options_.get_pending_on_device) {
+    return options_.get_pending_on_device(device);
+  }
+  return options_.get_pending_on_serial_device();
+}
+
+template <typename TaskType>
+int64_t SerialDeviceBatchScheduler<TaskType>::LeastLoadedDevice() {
+  int64_t best_device = 0;
+  int64_t best_pending = -1;
+  for (int64_t device = 1; device < options_.num_devices; ++device) {
+    if (in_flight_batches_[device] > in_flight_batches_[best_device]) continue;
+    if (in_flight_batches_[device] == in_flight_batches_[best_device]) {
+      if (best_pending < 0) best_pending = GetPendingOnDevice(best_device);
+      const int64_t pending = GetPendingOnDevice(device);
+      if (pending >= best_pending) continue;
+      best_pending = pending;
+    } else {
+      best_pending = -1;
+    }
+    best_device = device;
+  }
+  return best_device;
+}
+
 template <typename TaskType>
 void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
   const int64_t kIdleThreadSleepTimeMicros = 1000;
@@ -371,7 +463,7 @@ void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
   for (;;) {
     mu_.lock();
     if (processing_threads_ < 1 ||
-        processing_threads_ > in_flight_batches_limit_) {
+        processing_threads_ > in_flight_batches_limit_ * options_.num_devices) {
       processing_threads_--;
       mu_.unlock();
       break;
@@ -404,15 +496,19 @@ void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
     // Queue may destroy itself after ReleaseBatch is called.
     batch->queue()->ReleaseBatch(batch);
     auto callback = queues_and_callbacks_[batch->queue()];
+    const int64_t device = LeastLoadedDevice();
+    in_flight_batches_[device]++;
     mu_.unlock();
     int64_t start_time = env()->NowMicros();
     callback(std::unique_ptr<Batch<TaskType>>(
-        const_cast<internal::SDBSBatch<TaskType>*>(batch)));
+                 const_cast<internal::SDBSBatch<TaskType>*>(batch)),
+             device);
     int64_t end_time = env()->NowMicros();
     mu_.lock();
+    in_flight_batches_[device]--;
     batch_count_++;
     batch_latency_sum_ += end_time - start_time;
-    pending_sum_ += options_.get_pending_on_serial_device();
+    pending_sum_ += GetPendingOnDevice(device);
     if (batch_count_ == options_.batches_to_average_over) {
       recent_low_traffic_ratio_ *= (1 - kLowTrafficMovingAverageFactor);
       // Only adjust in_flight_batches_limit_ if external load is large enough
@@ -424,8 +520,8 @@ void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
         // Avg processing time / # of concurrent batches gives the avg period
         // between which two consecutive batches begin processing. Used to set a
         // reasonable sleep time for idle batch processing threads.
-        batch_period_micros_ =
-            batch_latency_sum_ / batch_count_ / in_flight_batches_limit_;
+        batch_period_micros_ = batch_latency_sum_ / batch_count_ /
+                               in_flight_batches_limit_ / options_.num_devices;
         // When the processing pipeline is consistently busy, the average number
         // of pending batches differs from in_flight_batches_limit_ by a
         // load-dependent offset. Adjust in_flight_batches_limit_to maintain
@@ -434,17 +530,20 @@ void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
             std::round(options_.target_pending - avg_pending);
         in_flight_batches_limit_ =
             std::max(in_flight_batches_limit_, int64_t{1});
-        in_flight_batches_limit_ =
-            std::min(in_flight_batches_limit_, options_.num_batch_threads);
+        in_flight_batches_limit_ = std::min(
+            in_flight_batches_limit_,
+            std::max(options_.num_batch_threads / options_.num_devices,
+                     int64_t{1}));
         // Add extra processing threads if necessary.
-        if (processing_threads_ > 0 &&
-            processing_threads_ < in_flight_batches_limit_) {
-          int extra_threads = in_flight_batches_limit_ - processing_threads_;
+        const int64_t target_threads =
+            in_flight_batches_limit_ * options_.num_devices;
+        if (processing_threads_ > 0 && processing_threads_ < target_threads) {
+          int extra_threads = target_threads - processing_threads_;
           for (int i = 0; i < extra_threads; i++) {
             batch_thread_pool_->Schedule(std::bind(
                 &SerialDeviceBatchScheduler<TaskType>::ProcessBatches, this));
           }
-          processing_threads_ = in_flight_batches_limit_;
+          processing_threads_ = target_threads;
         }
       } else {
         recent_low_traffic_ratio_ += kLowTrafficMovingAverageFactor;
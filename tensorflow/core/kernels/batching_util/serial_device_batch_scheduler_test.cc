@@ -193,6 +193,57 @@ TEST(SerialDeviceBatchSchedulerTest, PendingOnSerialDevice) {
   start_processing.Notify();
 }
 
+TEST(SerialDeviceBatchSchedulerTest, SpreadsBatchesOverDevices) {
+  SerialDeviceBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 4;
+  options.initial_in_flight_batches_limit = 1;
+  options.num_devices = 2;
+  options.get_pending_on_device = [](int64_t device) { return 0; };
+  mutex mu;
+  std::vector<int64_t> devices;
+  Notification finish_processing;
+  auto queue_callback = [&mu, &devices, &finish_processing](
+                            std::unique_ptr<Batch<FakeTask>> batch,
+                            int64_t device) {
+    bool all_started;
+    {
+      mutex_lock l(mu);
+      devices.push_back(device);
+      all_started = devices.size() == 2;
+    }
+    // Keep the first batch in flight while the second one is assigned.
+    if (all_started) finish_processing.Notify();
+    finish_processing.WaitForNotification();
+  };
+  std::shared_ptr<SerialDeviceBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(
+      SerialDeviceBatchScheduler<FakeTask>::Create(options, &scheduler));
+  std::unique_ptr<BatchScheduler<FakeTask>> queue1;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue2;
+  TF_ASSERT_OK(scheduler->AddQueue({}, queue_callback, &queue1));
+  TF_ASSERT_OK(scheduler->AddQueue({}, queue_callback, &queue2));
+  TF_ASSERT_OK(ScheduleTask(100, queue1.get()));
+  TF_ASSERT_OK(ScheduleTask(100, queue2.get()));
+  finish_processing.WaitForNotification();
+  mutex_lock l(mu);
+  EXPECT_THAT(devices, ::testing::UnorderedElementsAre(0, 1));
+}
+
+TEST(SerialDeviceBatchSchedulerTest, MultipleDevicesNeedPendingPerDevice) {
+  using Scheduler = SerialDeviceBatchScheduler<FakeTask>;
+  std::shared_ptr<Scheduler> scheduler;
+  Scheduler::Options options;
+  options.num_batch_threads = 4;
+  options.initial_in_flight_batches_limit = 1;
+  options.num_devices = 2;
+  options.get_pending_on_serial_device = []() { return 0; };
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options.get_pending_on_device = [](int64_t device) { return 0; };
+  TF_EXPECT_OK(Scheduler::Create(options, &scheduler));
+  options.initial_in_flight_batches_limit = 3;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+}
+
 TEST(SerialDeviceBatchSchedulerTest, FullBatchSchedulingBoostMicros) {
   test_util::FakeClockEnv env(Env::Default());
   Notification start_teardown, stop_teardown;
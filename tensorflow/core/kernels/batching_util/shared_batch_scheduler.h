@@ -18,10 +18,13 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
+#include <limits>
 #include <list>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -84,6 +87,12 @@ namespace serving {
 // BasicBatchScheduler instance, in the sense that it has maximum batch size and
 // timeout parameters, which govern when a batch is eligible to be processed.
 //
+// Queues may be given different priorities, in which case the batch threads
+// only run a batch from a queue when no queue of a higher priority has a batch
+// eligible to be processed. Several queues sharing one process-batch callback
+// thus act as priority lanes in front of the same model, letting e.g.
+// latency-sensitive and bulk traffic share a model replica.
+//
 // Each queue is independently configured with a maximum size (in terms of the
 // maximum number of batches worth of enqueued tasks). For online serving, it is
 // recommended that the queue sizes be configured such that the sum of the sizes
@@ -100,9 +109,10 @@ namespace serving {
 // For bulk processing jobs and throughput-oriented benchmarks, you may want to
 // set the maximum queue size to a large value.
 //
-// TODO(b/26539183): Support queue servicing policies other than round-robin.
-// E.g. let each queue specify a "share" (an int >= 1), so e.g. with queues A
-// and B having shares 1 and 2 respectively, the servicing pattern is ABBABB...
+// TODO(b/26539183): Support queue servicing policies other than round-robin
+// within a priority. E.g. let each queue specify a "share" (an int >= 1), so
+// e.g. with queues A and B having shares 1 and 2 respectively, the servicing
+// pattern is ABBABB...
 //
 //
 // PERFORMANCE TUNING: See README.md.
@@ -218,6 +228,18 @@ class SharedBatchScheduler
     // submit batches whose size is in a small set of allowed sizes, that can be
     // done by adding padding in the process-batch callback.
     size_t max_execution_batch_size = 1000;
+
+    // The priority of the queue. A batch is only taken from this queue when no
+    // queue with a higher priority has a batch ready to be processed. Queues of
+    // equal priority are served round-robin.
+    int priority = 0;
+
+    // If set, returns the time (in microseconds, as given by `Options::env`)
+    // by which the batch containing `task` should be processed. The open batch
+    // then becomes eligible for processing at the earliest deadline of its
+    // tasks, or after `batch_timeout_micros`, whichever comes first. Tasks
+    // without a deadline may return `std::numeric_limits<int64_t>::max()`.
+    std::function<int64_t(const TaskType& task)> task_deadline_micros_func;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -231,6 +253,12 @@ class SharedBatchScheduler
                               BatchUniquePtr* batch_to_process_out)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Same as GetNextWorkItem_Locked(), but only considers the queues with the
+  // given `priority`.
+  void GetNextWorkItemWithPriority_Locked(
+      int priority, internal::Queue<TaskType>** queue_for_batch_out,
+      BatchUniquePtr* batch_to_process_out) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
   // queue pointed to by 'next_queue_to_schedule_', and processes it. If that
   // queue declines to provide a batch to process, moves onto the next queue. If
@@ -339,6 +367,9 @@ class Queue {
   // Returns the maximum allowed size of tasks submitted to the queue.
   size_t max_task_size() const { return options_.input_batch_size_limit; }
 
+  // Returns the priority of the queue.
+  int priority() const { return options_.priority; }
+
   // Returns the maximum allowed size of tasks to be executed.
   // Returned value would be less than or equal to the maximum allowed input
   // size that's provided by caller of batch scheduler.
@@ -386,6 +417,18 @@ class Queue {
   // Same as IsEmpty(), but assumes the caller already holds a lock on 'mu_'.
   bool IsEmptyInternal() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns the deadline of `task`, as given by
+  // `options_.task_deadline_micros_func`.
+  int64_t TaskDeadlineMicros(const TaskType& task) const;
+
+  // Records that a task with the given deadline is added to the open batch.
+  void UpdateOpenBatchDeadline(int64_t task_deadline_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Returns the time at which the open batch becomes schedulable even if it
+  // is not full.
+  uint64 OpenBatchDeadlineMicros() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Closes the open batch residing at the back of std::deque, and inserts a
   // fresh open batch behind it.
   void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
@@ -469,6 +512,10 @@ class Queue {
   // in 'batches_'. Valid iff that batch contains at least one task.
   uint64 open_batch_start_time_micros_ TF_GUARDED_BY(mu_);
 
+  // The earliest deadline of the tasks in the open batch. Valid iff that batch
+  // contains at least one task.
+  int64_t open_batch_earliest_task_deadline_micros_ TF_GUARDED_BY(mu_);
+
   // Whether this queue contains a batch that is eligible to be scheduled.
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
@@ -663,6 +710,24 @@ template <typename TaskType>
 void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     internal::Queue<TaskType>** queue_for_batch_out,
     BatchUniquePtr* batch_to_process_out) {
+  std::set<int, std::greater<int>> priorities;
+  for (const auto& queue : queues_) {
+    priorities.insert(queue->priority());
+  }
+  *queue_for_batch_out = nullptr;
+  for (const int priority : priorities) {
+    GetNextWorkItemWithPriority_Locked(priority, queue_for_batch_out,
+                                       batch_to_process_out);
+    if (BatchExists(*batch_to_process_out)) {
+      return;
+    }
+  }
+}
+
+template <typename TaskType>
+void SharedBatchScheduler<TaskType>::GetNextWorkItemWithPriority_Locked(
+    int priority, internal::Queue<TaskType>** queue_for_batch_out,
+    BatchUniquePtr* batch_to_process_out) {
   BatchUniquePtr batch_to_process;
   internal::Queue<TaskType>* queue_for_batch = nullptr;
   const int num_queues = queues_.size();
@@ -671,6 +736,14 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
        ++num_queues_tried) {
     DCHECK(next_queue_to_schedule_ != queues_.end());
 
+    if ((*next_queue_to_schedule_)->priority() != priority) {
+      ++next_queue_to_schedule_;
+      if (next_queue_to_schedule_ == queues_.end()) {
+        next_queue_to_schedule_ = queues_.begin();
+      }
+      continue;
+    }
+
     // If a closed queue responds to ScheduleBatch() with nullptr, the queue
     // will never yield any further batches so we can drop it. To avoid a
     // race, we take a snapshot of the queue's closedness state *before*
@@ -820,6 +893,7 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
 
     TF_RETURN_IF_ERROR(ValidateBatchTaskQueueCapacity((*task).get()));
 
+    const int64_t task_deadline_micros = TaskDeadlineMicros(**task);
     const int64 open_batch_capacity =
         max_execution_batch_size - this->tail_batch_task_size();
 
@@ -837,6 +911,8 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
       }
       if (task_handle_batches_.back()->empty()) {
         open_batch_start_time_micros_ = env_->NowMicros();
+        open_batch_earliest_task_deadline_micros_ =
+            std::numeric_limits<int64_t>::max();
       }
       profiler::TraceMeProducer trace_me(
           [&task_handles, i] {
@@ -847,6 +923,7 @@ Status Queue<TaskType>::ScheduleWithLazySplit(std::unique_ptr<TaskType>* task) {
           task_handle_batches_.back()->traceme_context_id());
 
       task_handle_batches_.back()->AddTask(std::move(task_handles[i]));
+      UpdateOpenBatchDeadline(task_deadline_micros);
     }
 
     if (!schedulable_batch_) {
@@ -895,6 +972,7 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
         max_execution_batch_size() - batches_.back()->size();
 
     const int64_t input_task_size = (*task)->size();
+    const int64_t task_deadline_micros = TaskDeadlineMicros(**task);
 
     std::vector<std::unique_ptr<TaskType>> output_tasks;
 
@@ -913,6 +991,8 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
       }
       if (batches_.back()->empty()) {
         open_batch_start_time_micros_ = env_->NowMicros();
+        open_batch_earliest_task_deadline_micros_ =
+            std::numeric_limits<int64_t>::max();
       }
       profiler::TraceMeProducer trace_me(
           [&output_tasks, i] {
@@ -922,6 +1002,7 @@ Status Queue<TaskType>::ScheduleWithoutOrEagerSplit(
           profiler::ContextType::kSharedBatchScheduler,
           batches_.back()->traceme_context_id());
       batches_.back()->AddTask(std::move(output_tasks[i]));
+      UpdateOpenBatchDeadline(task_deadline_micros);
     }
 
     if (!schedulable_batch_) {
@@ -1161,8 +1242,7 @@ bool Queue<TaskType>::IsOpenBatchSchedulableAfterEagerSplit() const {
     return false;
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
-         env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+         env_->NowMicros() >= OpenBatchDeadlineMicros();
 }
 
 template <typename TaskType>
@@ -1176,8 +1256,33 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
     return false;
   }
   return closed_ || open_batch->size() >= max_execution_batch_size() ||
-         env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+         env_->NowMicros() >= OpenBatchDeadlineMicros();
+}
+
+template <typename TaskType>
+int64_t Queue<TaskType>::TaskDeadlineMicros(const TaskType& task) const {
+  if (!options_.task_deadline_micros_func) {
+    return std::numeric_limits<int64_t>::max();
+  }
+  return options_.task_deadline_micros_func(task);
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UpdateOpenBatchDeadline(int64_t task_deadline_micros) {
+  open_batch_earliest_task_deadline_micros_ =
+      std::min(open_batch_earliest_task_deadline_micros_, task_deadline_micros);
+}
+
+template <typename TaskType>
+uint64 Queue<TaskType>::OpenBatchDeadlineMicros() const {
+  const uint64 timeout_micros =
+      open_batch_start_time_micros_ + options_.batch_timeout_micros;
+  if (open_batch_earliest_task_deadline_micros_ < 0) {
+    // A deadline before the epoch has passed already.
+    return 0;
+  }
+  return std::min<uint64>(timeout_micros,
+                          open_batch_earliest_task_deadline_micros_);
 }
 
 template <typename TaskType>
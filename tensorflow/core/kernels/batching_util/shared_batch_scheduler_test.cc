@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/batching_util/shared_batch_scheduler.h"
 
+#include <limits>
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT(build/c++11)
@@ -793,6 +794,103 @@ TEST_P(SharedBatchSchedulerTest, ZeroQueueRewrittenToOneQueue) {
   }
 }
 
+TEST_P(SharedBatchSchedulerTest, HigherPriorityQueueServedFirst) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification low_0_batch_scheduled, low_0_batch_proceed;
+    auto low_0_callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      low_0_batch_scheduled.Notify();
+      low_0_batch_proceed.WaitForNotification();
+    };
+    Notification low_1_batch_scheduled;
+    bool high_batch_processed = false;
+    auto low_1_callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      // Round-robin alone would process this batch before the high priority
+      // one.
+      EXPECT_TRUE(high_batch_processed);
+      low_1_batch_scheduled.Notify();
+    };
+    auto high_callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      high_batch_processed = true;
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    const size_t input_batch_size_limit = 10;
+    QueueOptions low_options = CreateQueueOptions(
+        input_batch_size_limit, input_batch_size_limit,
+        1 /* batch_timeout_micros */, 100 /* give plenty of room */);
+    QueueOptions high_options = low_options;
+    high_options.priority = 1;
+    std::unique_ptr<Queue> low_0 =
+        CreateQueue(scheduler, low_options, low_0_callback);
+    std::unique_ptr<Queue> low_1 =
+        CreateQueue(scheduler, low_options, low_1_callback);
+    std::unique_ptr<Queue> high =
+        CreateQueue(scheduler, high_options, high_callback);
+
+    // Occupy the only batch thread with a batch from the first low priority
+    // queue.
+    TF_ASSERT_OK(ScheduleTask(10, low_0.get()));
+    low_0_batch_scheduled.WaitForNotification();
+
+    // Make a batch ready in each of the other queues.
+    TF_ASSERT_OK(ScheduleTask(10, low_1.get()));
+    TF_ASSERT_OK(ScheduleTask(10, high.get()));
+    low_0_batch_proceed.Notify();
+    low_1_batch_scheduled.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST_P(SharedBatchSchedulerTest, ObeysEarliestTaskDeadline) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification batch_processed;
+    auto callback = [&batch_processed](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      EXPECT_EQ(2, batch->num_tasks());
+      batch_processed.Notify();
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    const size_t input_batch_size_limit = 4;
+    QueueOptions options = CreateQueueOptions(
+        input_batch_size_limit, input_batch_size_limit,
+        1000 /* batch_timeout_micros */, 2 /* max_enqueued_batches */);
+    // Tasks of size 2 must be processed within 10us of the start, the others
+    // have no deadline.
+    const int64_t start_micros = env.NowMicros();
+    options.task_deadline_micros_func = [start_micros](const FakeTask& task) {
+      return task.size() == 2 ? start_micros + 10
+                              : std::numeric_limits<int64_t>::max();
+    };
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    TF_ASSERT_OK(ScheduleTask(2, queue.get()));
+    env.AdvanceByMicroseconds(9);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(batch_processed.HasBeenNotified());
+    // The batch is processed at the deadline of its second task, well before
+    // the timeout.
+    env.AdvanceByMicroseconds(1);
+    batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(
@@ -0,0 +1,133 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BUCKETED_SCATTER_H_
+#define TENSORFLOW_CORE_KERNELS_BUCKETED_SCATTER_H_
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace tensorflow {
+namespace scatter_internal {
+
+// Scatters with fewer updates than this are not worth parallelizing.
+constexpr int64_t kMinBucketedScatterUpdates = 1024;
+
+// Returns true if BucketedScatter() is expected to beat a serial loop.
+inline bool UseBucketedScatter(const Eigen::ThreadPoolDevice& d,
+                               int64_t num_updates, int64_t num_rows) {
+  return d.numThreads() > 1 && num_rows > 1 &&
+         num_updates >= kMinBucketedScatterUpdates;
+}
+
+// Applies `num_updates` updates to the rows of a destination with `num_rows`
+// rows in parallel, with the same result as applying them serially in order.
+//
+// The rows are split into contiguous ranges, one per bucket. The updates are
+// counting-sorted by bucket, preserving their order within each bucket, and
+// each bucket is then applied by a single thread. Updates to the same row
+// are thus applied in their original order without any locking, and each
+// thread works on its own block of the destination.
+//
+// `get_row(i)` returns the destination row of update i, or -1 if it is out
+// of bounds. It is called exactly once per update, so it may copy an index
+// that the caller does not trust to stay unchanged. `apply(i, row)` applies
+// update i to `row` and must not use `d`.
+//
+// Returns -1 on success, or the position of the first out-of-bounds update,
+// in which case no update has been applied.
+template <typename Index, typename GetRow, typename Apply>
+Index BucketedScatter(const Eigen::ThreadPoolDevice& d, Index num_updates,
+                      Index num_rows, double cost_per_update, GetRow get_row,
+                      Apply apply) {
+  const Index num_chunks = d.numThreads();
+  const Index chunk_size = (num_updates + num_chunks - 1) / num_chunks;
+  // More buckets than threads lets the pool balance hot row ranges.
+  const Index num_buckets = std::min<Index>(4 * d.numThreads(), num_rows);
+  const Index rows_per_bucket = (num_rows + num_buckets - 1) / num_buckets;
+
+  std::vector<Index> rows(num_updates);
+  std::vector<Index> order(num_updates);
+  std::vector<Index> offsets(num_chunks * num_buckets, 0);
+  std::vector<Index> first_bad(num_chunks, -1);
+  auto ForEachChunk = [&](double cost_per_element, auto fn) {
+    d.parallelFor(num_chunks,
+                  Eigen::TensorOpCost(0, 0, cost_per_element * chunk_size),
+                  [&](Eigen::Index first, Eigen::Index last) {
+                    for (Index c = first; c < last; ++c) {
+                      fn(c, c * chunk_size,
+                         std::min(num_updates, (c + 1) * chunk_size));
+                    }
+                  });
+  };
+
+  // Resolve and count the destination of every update.
+  ForEachChunk(10, [&](Index c, Index begin, Index end) {
+    Index* counts = &offsets[c * num_buckets];
+    for (Index i = begin; i < end; ++i) {
+      const Index row = get_row(i);
+      if (row < 0) {
+        first_bad[c] = i;
+        return;
+      }
+      rows[i] = row;
+      ++counts[row / rows_per_bucket];
+    }
+  });
+  for (Index c = 0; c < num_chunks; ++c) {
+    if (first_bad[c] >= 0) return first_bad[c];
+  }
+
+  // Lay the buckets out one after another, each in update order.
+  std::vector<Index> bucket_begin(num_buckets + 1);
+  Index offset = 0;
+  for (Index b = 0; b < num_buckets; ++b) {
+    bucket_begin[b] = offset;
+    for (Index c = 0; c < num_chunks; ++c) {
+      const Index count = offsets[c * num_buckets + b];
+      offsets[c * num_buckets + b] = offset;
+      offset += count;
+    }
+  }
+  bucket_begin[num_buckets] = offset;
+  ForEachChunk(2, [&](Index c, Index begin, Index end) {
+    Index* next = &offsets[c * num_buckets];
+    for (Index i = begin; i < end; ++i) {
+      order[next[rows[i] / rows_per_bucket]++] = i;
+    }
+  });
+
+  d.parallelFor(
+      num_buckets,
+      Eigen::TensorOpCost(0, 0, cost_per_update * num_updates / num_buckets),
+      [&](Eigen::Index first, Eigen::Index last) {
+        for (Index b = first; b < last; ++b) {
+          for (Index j = bucket_begin[b]; j < bucket_begin[b + 1]; ++j) {
+            const Index i = order[j];
+            apply(i, rows[i]);
+          }
+        }
+      });
+  return -1;
+}
+
+}  // namespace scatter_internal
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BUCKETED_SCATTER_H_
@@ -26,7 +26,9 @@ limitations under the License.
 
 #include <string.h>
 
+#include <algorithm>
 #include <atomic>
+#include <limits>
 #include <map>
 #include <utility>
 #include <vector>
@@ -50,13 +52,20 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
 
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/core/kernels/conv_ops_direct.h"
+#include "tensorflow/core/util/autotune_maps/cpu_conv_autotune_map.h"
+#endif  // !IS_MOBILE_PLATFORM
+
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/kernels/cast_op.h"
 #include "tensorflow/core/kernels/conv_ops_gpu.h"
@@ -413,6 +422,154 @@ class LaunchDeepConvOp<CPUDevice, float> {
   }
 };
 
+// Chooses among the CPU Conv2D algorithms for each convolution shape by
+// timing them, the way the GPU kernels autotune cuDNN algorithms. The fastest
+// algorithm is cached in CpuConvAutotuneMap. Returns false if the convolution
+// has to run with the default algorithm instead.
+template <typename Device, typename T>
+class LaunchAutotunedConvOp {
+ public:
+  static bool Run(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, const Conv2DParameters& params,
+                  const Conv2DDimensions& dimensions, Tensor* output) {
+    return false;
+  }
+};
+
+#if !defined(IS_MOBILE_PLATFORM)
+// Winograd convolution is only implemented for float.
+template <typename T>
+bool CanUseWinogradConv(const Conv2DDimensions& dimensions) {
+  return false;
+}
+
+template <>
+bool CanUseWinogradConv<float>(const Conv2DDimensions& dimensions) {
+  return dimensions.filter_rows == 3 && dimensions.filter_cols == 3 &&
+         dimensions.stride_rows == 1 && dimensions.stride_cols == 1 &&
+         dimensions.dilation_rows == 1 && dimensions.dilation_cols == 1;
+}
+
+template <typename T>
+void LaunchWinogradConv(OpKernelContext* ctx, const Tensor& input,
+                        const Tensor& filter,
+                        const Conv2DDimensions& dimensions, Tensor* output) {
+  ctx->SetStatus(errors::Internal("Winograd convolution is not supported"));
+}
+
+template <>
+void LaunchWinogradConv<float>(OpKernelContext* ctx, const Tensor& input,
+                               const Tensor& filter,
+                               const Conv2DDimensions& dimensions,
+                               Tensor* output) {
+  Conv2DArgs args;
+  args.batch = dimensions.batch;
+  args.in_rows = dimensions.input_rows;
+  args.in_cols = dimensions.input_cols;
+  args.in_depth = dimensions.in_depth;
+  args.filter_rows = dimensions.filter_rows;
+  args.filter_cols = dimensions.filter_cols;
+  args.pad_rows = dimensions.pad_rows_before;
+  args.pad_cols = dimensions.pad_cols_before;
+  args.out_rows = dimensions.out_rows;
+  args.out_cols = dimensions.out_cols;
+  args.out_depth = dimensions.out_depth;
+  functor::DeepConv2D<CPUDevice, float>()(
+      ctx, args, input.flat<float>().data(), filter.flat<float>().data(),
+      output->flat<float>().data());
+}
+
+template <typename T>
+class LaunchAutotunedCpuConvOp {
+ public:
+  static bool Run(OpKernelContext* ctx, const Tensor& input,
+                  const Tensor& filter, const Conv2DParameters& params,
+                  const Conv2DDimensions& dimensions, Tensor* output) {
+    if (params.data_format != FORMAT_NHWC ||
+        dimensions.in_depth != dimensions.patch_depth) {
+      return false;
+    }
+
+    std::vector<CpuConvAlgorithm> algorithms = {CpuConvAlgorithm::kEigen};
+    if (params.padding != EXPLICIT && CanUseWinogradConv<T>(dimensions)) {
+      algorithms.push_back(CpuConvAlgorithm::kWinograd);
+    }
+    if (CanUseDirectConv2D(dimensions.in_depth, dimensions.out_depth)) {
+      algorithms.push_back(CpuConvAlgorithm::kDirect);
+    }
+    if (algorithms.size() == 1) return false;
+
+    auto launch = [&](CpuConvAlgorithm algorithm) {
+      switch (algorithm) {
+        case CpuConvAlgorithm::kEigen:
+          LaunchGeneric<CPUDevice, T>()(
+              ctx, input, filter, dimensions.stride_rows,
+              dimensions.stride_cols, dimensions.dilation_rows,
+              dimensions.dilation_cols, params.padding,
+              params.explicit_paddings, output, params.data_format);
+          break;
+        case CpuConvAlgorithm::kWinograd:
+          LaunchWinogradConv<T>(ctx, input, filter, dimensions, output);
+          break;
+        case CpuConvAlgorithm::kDirect:
+          functor::DirectConv2D<CPUDevice, T>()(
+              ctx, dimensions, input.flat<T>().data(),
+              filter.flat<T>().data(), output->flat<T>().data());
+          break;
+      }
+    };
+
+    const int num_threads =
+        ctx->device()->tensorflow_cpu_worker_threads()->num_threads;
+    CpuConvParameters conv_parameters(
+        dimensions.batch, dimensions.in_depth,
+        {dimensions.input_rows, dimensions.input_cols}, dimensions.out_depth,
+        {dimensions.filter_rows, dimensions.filter_cols},
+        {dimensions.dilation_rows, dimensions.dilation_cols},
+        {dimensions.stride_rows, dimensions.stride_cols},
+        {dimensions.pad_rows_before, dimensions.pad_rows_after,
+         dimensions.pad_cols_before, dimensions.pad_cols_after},
+        DataTypeToEnum<T>::value, num_threads);
+    CpuConvAlgorithm best_algorithm = CpuConvAlgorithm::kEigen;
+    if (CpuConvAutotuneMap::GetInstance()->Find(conv_parameters,
+                                                &best_algorithm)) {
+      launch(best_algorithm);
+      return true;
+    }
+
+    // Every algorithm computes the whole output, so whichever runs last
+    // leaves the result in place. The first run of each one warms it up.
+    constexpr int kNumRuns = 2;
+    uint64 best_time = std::numeric_limits<uint64>::max();
+    for (CpuConvAlgorithm algorithm : algorithms) {
+      uint64 time = std::numeric_limits<uint64>::max();
+      for (int run = 0; run < kNumRuns; ++run) {
+        const uint64 start = Env::Default()->NowMicros();
+        launch(algorithm);
+        if (!ctx->status().ok()) return true;
+        time = std::min(time, Env::Default()->NowMicros() - start);
+      }
+      VLOG(2) << "Conv2D autotune: " << CpuConvAlgorithmName(algorithm)
+              << " took " << time << "us";
+      if (time < best_time) {
+        best_time = time;
+        best_algorithm = algorithm;
+      }
+    }
+    CpuConvAutotuneMap::GetInstance()->Insert(conv_parameters, best_algorithm);
+    return true;
+  }
+};
+
+template <>
+class LaunchAutotunedConvOp<CPUDevice, float>
+    : public LaunchAutotunedCpuConvOp<float> {};
+
+template <>
+class LaunchAutotunedConvOp<CPUDevice, double>
+    : public LaunchAutotunedCpuConvOp<double> {};
+#endif  // !IS_MOBILE_PLATFORM
+
 #define TF_REQUIRES(EXP, STATUS)                \
   do {                                          \
     if (!TF_PREDICT_TRUE(EXP)) return (STATUS); \
@@ -602,6 +759,10 @@ class Conv2DOp : public BinaryOp<T> {
 
     OP_REQUIRES_OK(context, context->GetAttr("use_cudnn_on_gpu", &use_cudnn_));
     cudnn_use_autotune_ = CudnnUseAutotune();
+    // NOTE: If this environment variable name changes, update conv_ops_test.cc.
+    OP_REQUIRES_OK(context, ReadBoolFromEnvVar("TF_CPU_CONV_AUTOTUNE",
+                                               /*default_val=*/false,
+                                               &cpu_use_autotune_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -666,6 +827,12 @@ class Conv2DOp : public BinaryOp<T> {
       return;
     }
 
+    if (cpu_use_autotune_ &&
+        LaunchAutotunedConvOp<Device, T>::Run(context, input, filter, params_,
+                                              dimensions, output)) {
+      return;
+    }
+
     launcher_(context, use_cudnn_, cudnn_use_autotune_, input, filter,
               dimensions.dilation_rows, dimensions.dilation_cols,
               dimensions.stride_rows, dimensions.stride_cols, params_.padding,
@@ -676,6 +843,7 @@ class Conv2DOp : public BinaryOp<T> {
   Conv2DParameters params_;
   bool use_cudnn_;
   bool cudnn_use_autotune_;
+  bool cpu_use_autotune_;
 
   LaunchConv2DOp<Device, T> launcher_;
 
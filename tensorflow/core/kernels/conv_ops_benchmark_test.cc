@@ -571,6 +571,23 @@ BM_FusedConv2DWithBatchNormAndRelu(16, 32, 32, 128, 3, 3, 1024, cpu,
 BM_FusedConv2DWithBatchNormAndRelu(32, 32, 32, 128, 3, 3, 1024, cpu,
                                    "3x3 /b 32");
 
+// -------------------------------------------------------------------------- //
+// Mobile-sized convolutions. With USE_GEMM_FOR_CONV these run the im2col and
+// GEMM kernels from conv_ops_using_gemm.cc, which apply the fused epilogue in
+// the output stage of the GEMM.
+// -------------------------------------------------------------------------- //
+
+BM_Conv2DWithBiasAndRelu(1, 112, 112, 32, 1, 1, 64, cpu, "1x1 /b 1");
+BM_Conv2DWithBiasAndRelu(1, 56, 56, 64, 3, 3, 64, cpu, "3x3 /b 1");
+BM_Conv2DWithBiasAndRelu(1, 7, 7, 256, 7, 7, 1024, cpu, "7x7 /b 1");
+
+BM_FusedConv2DWithBiasAndRelu(1, 112, 112, 32, 1, 1, 64, cpu, "1x1 /b 1");
+BM_FusedConv2DWithBiasAndRelu(1, 56, 56, 64, 3, 3, 64, cpu, "3x3 /b 1");
+BM_FusedConv2DWithBiasAndRelu(1, 7, 7, 256, 7, 7, 1024, cpu, "7x7 /b 1");
+
+BM_Conv2DWithBatchNormAndRelu(1, 56, 56, 64, 3, 3, 64, cpu, "3x3 /b 1");
+BM_FusedConv2DWithBatchNormAndRelu(1, 56, 56, 64, 3, 3, 64, cpu, "3x3 /b 1");
+
 #if GOOGLE_CUDA
 // -------------------------------------------------------------------------- //
 // 1x1 Convolution
@@ -0,0 +1,101 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/core/kernels/conv_ops_direct.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+// Above this many multiply-adds per input value, im2col and GEMM reuse the
+// filter well enough to win.
+static constexpr int64_t kMaxDirectConvDepthProduct = 64 * 64;
+
+bool CanUseDirectConv2D(int64_t in_depth, int64_t out_depth) {
+  return in_depth * out_depth <= kMaxDirectConvDepthProduct;
+}
+
+namespace functor {
+
+template <typename T>
+struct DirectConv2D<CPUDevice, T> {
+  void operator()(OpKernelContext* ctx, const Conv2DDimensions& dimensions,
+                  const T* input, const T* filter, T* output) {
+    const int64_t in_rows = dimensions.input_rows;
+    const int64_t in_cols = dimensions.input_cols;
+    const int64_t in_depth = dimensions.in_depth;
+    const int64_t out_rows = dimensions.out_rows;
+    const int64_t out_cols = dimensions.out_cols;
+    const int64_t out_depth = dimensions.out_depth;
+    const int64_t filter_rows = dimensions.filter_rows;
+    const int64_t filter_cols = dimensions.filter_cols;
+
+    // Each unit of work is one row of the output of one image.
+    auto shard = [&](int64_t start, int64_t limit) {
+      for (int64_t unit = start; unit < limit; ++unit) {
+        const int64_t b = unit / out_rows;
+        const int64_t out_r = unit % out_rows;
+        const T* input_image = input + b * in_rows * in_cols * in_depth;
+        T* output_row = output + unit * out_cols * out_depth;
+        std::fill(output_row, output_row + out_cols * out_depth, T(0));
+        const int64_t in_r_origin =
+            out_r * dimensions.stride_rows - dimensions.pad_rows_before;
+        for (int64_t f_r = 0; f_r < filter_rows; ++f_r) {
+          const int64_t in_r = in_r_origin + f_r * dimensions.dilation_rows;
+          if (in_r < 0 || in_r >= in_rows) continue;
+          for (int64_t f_c = 0; f_c < filter_cols; ++f_c) {
+            const T* filter_window =
+                filter + (f_r * filter_cols + f_c) * in_depth * out_depth;
+            for (int64_t out_c = 0; out_c < out_cols; ++out_c) {
+              const int64_t in_c = out_c * dimensions.stride_cols -
+                                   dimensions.pad_cols_before +
+                                   f_c * dimensions.dilation_cols;
+              if (in_c < 0 || in_c >= in_cols) continue;
+              const T* in = input_image + (in_r * in_cols + in_c) * in_depth;
+              T* out = output_row + out_c * out_depth;
+              for (int64_t d = 0; d < in_depth; ++d) {
+                const T value = in[d];
+                const T* filter_row = filter_window + d * out_depth;
+                for (int64_t k = 0; k < out_depth; ++k) {
+                  out[k] += value * filter_row[k];
+                }
+              }
+            }
+          }
+        }
+      }
+    };
+
+    auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
+    const int64_t shard_cost =
+        out_cols * filter_rows * filter_cols * in_depth * out_depth;
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          dimensions.batch * out_rows, shard_cost, shard);
+  }
+};
+
+}  // namespace functor
+
+template struct functor::DirectConv2D<CPUDevice, float>;
+template struct functor::DirectConv2D<CPUDevice, double>;
+
+}  // namespace tensorflow
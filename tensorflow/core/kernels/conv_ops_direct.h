@@ -0,0 +1,44 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_CONV_OPS_DIRECT_H_
+#define TENSORFLOW_CORE_KERNELS_CONV_OPS_DIRECT_H_
+
+#include "tensorflow/core/kernels/conv_ops.h"
+
+namespace tensorflow {
+
+class OpKernelContext;
+
+// Returns true if DirectConv2D is worth trying for a convolution with these
+// channel counts. It computes the convolution straight from the NHWC input,
+// which beats packing patches for a GEMM only when the GEMM would be small.
+bool CanUseDirectConv2D(int64_t in_depth, int64_t out_depth);
+
+namespace functor {
+
+// Computes an NHWC Conv2D without grouping by accumulating, for every output
+// pixel, the products of each input value in its window with the
+// corresponding row of the filter, which is contiguous along out_depth.
+template <typename Device, typename T>
+struct DirectConv2D {
+  void operator()(OpKernelContext* ctx, const Conv2DDimensions& dimensions,
+                  const T* input, const T* filter, T* output);
+};
+
+}  // namespace functor
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_CONV_OPS_DIRECT_H_
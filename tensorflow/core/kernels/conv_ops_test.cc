@@ -468,12 +468,97 @@ class ConvOpTest : public OpsTestBase {
     const Tensor& output = *GetOutput(0);
     test::ExpectTensorNear<float>(expected, output, 1e-5);
   }
+
+  // Runs Conv2D with CPU algorithm autotuning enabled, once to autotune and
+  // once with the cached algorithm, and compares both results to a reference.
+  template <typename T>
+  void AutotunedConv(int batch, int rows, int cols, int in_depth,
+                     int filter_size, int out_depth, int stride, int dilation,
+                     const string& padding) {
+    setenv("TF_CPU_CONV_AUTOTUNE", "1", /*overwrite=*/1);
+    TF_EXPECT_OK(NodeDefBuilder("conv_op", "Conv2D")
+                     .Input(FakeInput(DataTypeToEnum<T>::value))
+                     .Input(FakeInput(DataTypeToEnum<T>::value))
+                     .Attr("T", DataTypeToEnum<T>::value)
+                     .Attr("strides", {1, stride, stride, 1})
+                     .Attr("dilations", {1, dilation, dilation, 1})
+                     .Attr("padding", padding)
+                     .Finalize(node_def()));
+    TF_EXPECT_OK(InitOp());
+    unsetenv("TF_CPU_CONV_AUTOTUNE");
+
+    Tensor image(DataTypeToEnum<T>::value, {batch, rows, cols, in_depth});
+    image.flat<T>().setRandom();
+    Tensor filter(DataTypeToEnum<T>::value,
+                  {filter_size, filter_size, in_depth, out_depth});
+    filter.flat<T>().setRandom();
+    AddInputFromArray<T>(image.shape(), image.flat<T>());
+    AddInputFromArray<T>(filter.shape(), filter.flat<T>());
+
+    const int window = (filter_size - 1) * dilation + 1;
+    int64_t out_rows, out_cols, pad_rows, pad_cols;
+    TF_ASSERT_OK(GetWindowedOutputSize(
+        rows, window, stride, padding == "SAME" ? SAME : VALID, &out_rows,
+        &pad_rows));
+    TF_ASSERT_OK(GetWindowedOutputSize(
+        cols, window, stride, padding == "SAME" ? SAME : VALID, &out_cols,
+        &pad_cols));
+    Tensor expected(DataTypeToEnum<T>::value,
+                    {batch, out_rows, out_cols, out_depth});
+    auto in = image.tensor<T, 4>();
+    auto f = filter.tensor<T, 4>();
+    auto out = expected.tensor<T, 4>();
+    for (int b = 0; b < batch; ++b) {
+      for (int r = 0; r < out_rows; ++r) {
+        for (int c = 0; c < out_cols; ++c) {
+          for (int k = 0; k < out_depth; ++k) {
+            double sum = 0;
+            for (int fr = 0; fr < filter_size; ++fr) {
+              for (int fc = 0; fc < filter_size; ++fc) {
+                const int in_r = r * stride - pad_rows + fr * dilation;
+                const int in_c = c * stride - pad_cols + fc * dilation;
+                if (in_r < 0 || in_r >= rows || in_c < 0 || in_c >= cols) {
+                  continue;
+                }
+                for (int d = 0; d < in_depth; ++d) {
+                  sum += static_cast<double>(in(b, in_r, in_c, d)) *
+                         static_cast<double>(f(fr, fc, d, k));
+                }
+              }
+            }
+            out(b, r, c, k) = static_cast<T>(sum);
+          }
+        }
+      }
+    }
+
+    for (int run = 0; run < 2; ++run) {
+      TF_ASSERT_OK(RunOpKernel());
+      test::ExpectTensorNear<T>(expected, *GetOutput(0), 1e-3);
+    }
+  }
 };
 
 TEST_F(ConvOpTest, HandwrittenConv) { HandwrittenConv(); }
 
 TEST_F(ConvOpTest, AnisotropicStride) { AnisotropicStrides(); }
 
+TEST_F(ConvOpTest, AutotunedSmallChannelsSame) {
+  AutotunedConv<float>(2, 17, 13, 8, 3, 8, 1, 1, "SAME");
+}
+
+TEST_F(ConvOpTest, AutotunedSmallChannelsValid) {
+  AutotunedConv<float>(1, 16, 16, 3, 3, 16, 1, 1, "VALID");
+}
+
+TEST_F(ConvOpTest, AutotunedStridedDilated) {
+  AutotunedConv<float>(1, 20, 20, 4, 3, 4, 2, 2, "SAME");
+}
+
+TEST_F(ConvOpTest, AutotunedDouble) {
+  AutotunedConv<double>(2, 9, 11, 4, 3, 6, 1, 1, "SAME");
+}
+
 template <typename T>
 class FusedConv2DOpTest : public OpsTestBase {
  protected:
@@ -48,7 +48,9 @@ limitations under the License.
 
 #include <string.h>
 
+#include <functional>
 #include <map>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
@@ -61,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_slice.h"
 #include "tensorflow/core/kernels/conv_ops.h"
+#include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
 #include "tensorflow/core/kernels/gemm_functors.h"
 #include "tensorflow/core/util/image_resizer_state.h"
 #include "tensorflow/core/util/mirror_pad_mode.h"
@@ -207,15 +210,22 @@ const size_t kMaxChunkSize = (16 * 1024 * 1024);
 // Implements convolution as a two stage process, first packing the patches of
 // the input image into columns (im2col) and then running GEMM to produce the
 // final result.
+//
+// The optional output kernel is passed on to the GEMM, which applies it to
+// the output while it's still in cache. Each chunk of patches is a separate
+// GEMM, so the column offsets it sees are relative to the start of the chunk,
+// but its row offsets are always output channels.
 template <class T1, class T2, class T3, class TGemmFunctor>
 class Im2ColConvFunctor {
  public:
+  template <class OutputKernel = Eigen::NoOpOutputKernel>
   void operator()(OpKernelContext* context, const T1* input_data,
                   int input_batches, int input_height, int input_width,
                   int input_depth, const T2* filter_data, int filter_height,
                   int filter_width, int filter_count, int stride_rows,
                   int stride_cols, Padding padding, T3* output_data,
-                  int output_height, int output_width) {
+                  int output_height, int output_width,
+                  const OutputKernel& output_kernel = OutputKernel()) {
     if ((input_batches <= 0) || (input_width <= 0) || (input_height <= 0) ||
         (input_depth <= 0)) {
       LOG(WARNING) << "Conv2D was called with bad input dimensions: "
@@ -248,7 +258,7 @@ class Im2ColConvFunctor {
       const int ldc = filter_count;
       TGemmFunctor gemm_functor;
       gemm_functor(context, m, n, k, input_data, lda, filter_data, ldb,
-                   output_data, ldc);
+                   output_data, ldc, output_kernel);
       return;
     } else if (filter_height == input_height && filter_width == input_width &&
                padding == VALID) {
@@ -261,7 +271,7 @@ class Im2ColConvFunctor {
       const int ldc = filter_count;
       TGemmFunctor gemm_functor;
       gemm_functor(context, m, n, k, input_data, lda, filter_data, ldb,
-                   output_data, ldc);
+                   output_data, ldc, output_kernel);
       return;
     }
 
@@ -416,7 +426,7 @@ class Im2ColConvFunctor {
       T3* chunk_output_data = output_data + (patch_index_start * filter_count);
       TGemmFunctor gemm_functor;
       gemm_functor(context, m, n, k, im2col_buffer, lda, filter_data, ldb,
-                   chunk_output_data, ldc);
+                   chunk_output_data, ldc, output_kernel);
     }
   }
 };
@@ -564,6 +574,202 @@ class Conv2DUsingGemmOp : public BinaryOp<T> {
   TF_DISALLOW_COPY_AND_ASSIGN(Conv2DUsingGemmOp);
 };
 
+// The _FusedConv2D counterpart of Conv2DUsingGemmOp. The fused BiasAdd or
+// FusedBatchNorm and activation run as an output kernel of the GEMM, instead
+// of as separate ops that read the whole convolution output back from memory.
+template <class T, class TConvFunctor>
+class FusedConv2DUsingGemmOp : public OpKernel {
+ public:
+  explicit FusedConv2DUsingGemmOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, InitConv2DParameters(context, &params_));
+    OP_REQUIRES(context, params_.data_format == FORMAT_NHWC,
+                errors::Unimplemented("Fused conv implementation only supports "
+                                      "NHWC tensor format for now."));
+    OP_REQUIRES(context, params_.padding != EXPLICIT,
+                errors::Unimplemented("Fused conv implementation does not "
+                                      "support explicit padding."));
+    const int dilation_rows =
+        GetTensorDim(params_.dilations, params_.data_format, 'H');
+    const int dilation_cols =
+        GetTensorDim(params_.dilations, params_.data_format, 'W');
+    OP_REQUIRES(context, dilation_rows == 1 && dilation_cols == 1,
+                errors::Unimplemented("Fused conv implementation does not "
+                                      "support dilations."));
+
+    using FCT = FusedComputationType;
+    std::vector<FusedComputationPattern> patterns = {
+        {FCT::kBiasAdd, {"BiasAdd"}},
+        {FCT::kBiasAddWithRelu, {"BiasAdd", "Relu"}},
+        {FCT::kBiasAddWithRelu6, {"BiasAdd", "Relu6"}},
+        {FCT::kBiasAddWithElu, {"BiasAdd", "Elu"}},
+        {FCT::kBiasAddWithLeakyRelu, {"BiasAdd", "LeakyRelu"}},
+        {FCT::kFusedBatchNorm, {"FusedBatchNorm"}},
+        {FCT::kFusedBatchNormWithRelu, {"FusedBatchNorm", "Relu"}},
+        {FCT::kFusedBatchNormWithRelu6, {"FusedBatchNorm", "Relu6"}},
+        {FCT::kFusedBatchNormWithElu, {"FusedBatchNorm", "Elu"}},
+        {FCT::kFusedBatchNormWithLeakyRelu, {"FusedBatchNorm", "LeakyRelu"}},
+    };
+    OP_REQUIRES_OK(context, InitializeFusedComputation(
+                                context, "Conv2D", patterns,
+                                &fused_computation_, &fused_computation_args_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    // Input tensor is of the following dimensions:
+    // [ batch, in_rows, in_cols, in_depth ]
+    const Tensor& input = context->input(0);
+
+    // Input filter is of the following dimensions:
+    // [ filter_rows, filter_cols, in_depth, out_depth]
+    const Tensor& filter = context->input(1);
+
+    Conv2DDimensions dimensions;
+    OP_REQUIRES_OK(context,
+                   ComputeConv2DDimension(params_, input, filter, &dimensions));
+    OP_REQUIRES(context, dimensions.in_depth == filter.dim_size(2),
+                errors::Unimplemented("Fused conv implementation does not "
+                                      "support grouped convolutions for now."));
+
+    TensorShape out_shape;
+    OP_REQUIRES_OK(
+        context, ShapeFromFormatWithStatus(
+                     params_.data_format, dimensions.batch, dimensions.out_rows,
+                     dimensions.out_cols, dimensions.out_depth, &out_shape));
+
+    // Output tensor is of the following dimensions:
+    // [ in_batch, out_rows, out_cols, out_depth ]
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, out_shape, &output));
+
+    // If there is nothing to compute, return.
+    if (out_shape.num_elements() == 0) {
+      return;
+    }
+
+    const FusedComputationType fusion = fused_computation_;
+    const FusedComputationArgs& fusion_args = fused_computation_args_;
+
+    BiasAddArgs<T> bias_add_args;
+    if (BiasAddArgs<T>::IsSupported(fusion)) {
+      if (fusion == FusedComputationType::kBiasAddWithLeakyRelu) {
+        OP_REQUIRES_OK(context, InitBiasAddArgs(context, &bias_add_args,
+                                                &fusion_args.leakyrelu_alpha));
+      } else {
+        OP_REQUIRES_OK(context, InitBiasAddArgs(context, &bias_add_args));
+      }
+    }
+
+    FusedBatchNormArgs<T> fused_batch_norm_args;
+    if (FusedBatchNormArgs<T>::IsSupported(fusion)) {
+      if (fusion == FusedComputationType::kFusedBatchNormWithLeakyRelu) {
+        OP_REQUIRES_OK(context,
+                       InitFusedBatchNormArgs(context, fusion_args.epsilon,
+                                              &fused_batch_norm_args,
+                                              &fusion_args.leakyrelu_alpha));
+      } else {
+        OP_REQUIRES_OK(context,
+                       InitFusedBatchNormArgs(context, fusion_args.epsilon,
+                                              &fused_batch_norm_args));
+      }
+    }
+
+    auto conv2d = [&](const auto& output_kernel) {
+      Launch(context, input, filter, dimensions, output_kernel, output);
+    };
+    switch (fusion) {
+      case FusedComputationType::kBiasAdd:
+        conv2d(WithBiasAdd<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithRelu:
+        conv2d(WithBiasAddAndRelu<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithRelu6:
+        conv2d(WithBiasAddAndRelu6<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithLeakyRelu:
+        conv2d(WithBiasAddAndLeakyRelu<T>(bias_add_args));
+        break;
+      case FusedComputationType::kBiasAddWithElu:
+        conv2d(WithBiasAddAndElu<T>(bias_add_args));
+        break;
+      case FusedComputationType::kFusedBatchNorm:
+        conv2d(
+            WithFusedBatchNorm<T>(fusion_args.epsilon, fused_batch_norm_args));
+        break;
+      case FusedComputationType::kFusedBatchNormWithRelu:
+        conv2d(WithFusedBatchNormAndRelu<T>(fusion_args.epsilon,
+                                            fused_batch_norm_args));
+        break;
+      case FusedComputationType::kFusedBatchNormWithRelu6:
+        conv2d(WithFusedBatchNormAndRelu6<T>(fusion_args.epsilon,
+                                             fused_batch_norm_args));
+        break;
+      case FusedComputationType::kFusedBatchNormWithLeakyRelu:
+        conv2d(WithFusedBatchNormAndLeakyRelu<T>(fusion_args.epsilon,
+                                                 fused_batch_norm_args));
+        break;
+      case FusedComputationType::kFusedBatchNormWithElu:
+        conv2d(WithFusedBatchNormAndElu<T>(fusion_args.epsilon,
+                                           fused_batch_norm_args));
+        break;
+      default:
+        OP_REQUIRES_OK(context, errors::Internal("Fusion type is unsupported"));
+        break;
+    }
+  }
+
+ private:
+  // Wraps the output kernels into a single type, so that the convolution and
+  // the GEMM underneath it are only instantiated once per T.
+  struct OutputKernelWrapper {
+    using OutputKernelFn =
+        std::function<void(const ContractionOutputMapper<T, Eigen::Index>&,
+                           const Eigen::TensorContractionParams&, Eigen::Index,
+                           Eigen::Index, Eigen::Index, Eigen::Index)>;
+
+    explicit OutputKernelWrapper(OutputKernelFn fn)
+        : output_kernel_fn(std::move(fn)) {}
+
+    void operator()(
+        const ContractionOutputMapper<T, Eigen::Index>& output_mapper,
+        const Eigen::TensorContractionParams& params, Eigen::Index i,
+        Eigen::Index j, Eigen::Index num_rows, Eigen::Index num_cols) const {
+      output_kernel_fn(output_mapper, params, i, j, num_rows, num_cols);
+    }
+
+    OutputKernelFn output_kernel_fn;
+  };
+
+  template <class OutputKernel>
+  void Launch(OpKernelContext* context, const Tensor& input,
+              const Tensor& filter, const Conv2DDimensions& dimensions,
+              const OutputKernel& output_kernel, Tensor* output) {
+    OutputKernelWrapper output_kernel_wrapper(
+        [&output_kernel](
+            const ContractionOutputMapper<T, Eigen::Index>& output_mapper,
+            const Eigen::TensorContractionParams& params, Eigen::Index i,
+            Eigen::Index j, Eigen::Index num_rows, Eigen::Index num_cols) {
+          output_kernel(output_mapper, params, i, j, num_rows, num_cols);
+        });
+    TConvFunctor conv_functor;
+    conv_functor(context, input.flat<T>().data(), dimensions.batch,
+                 dimensions.input_rows, dimensions.input_cols,
+                 dimensions.in_depth, filter.flat<T>().data(),
+                 dimensions.filter_rows, dimensions.filter_cols,
+                 dimensions.out_depth, dimensions.stride_rows,
+                 dimensions.stride_cols, params_.padding,
+                 output->flat<T>().data(), dimensions.out_rows,
+                 dimensions.out_cols, output_kernel_wrapper);
+  }
+
+  Conv2DParameters params_;
+  FusedComputationType fused_computation_ = FusedComputationType::kUndefined;
+  FusedComputationArgs fused_computation_args_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedConv2DUsingGemmOp);
+};
+
 #define REGISTER_CPU(T)                                         \
   REGISTER_KERNEL_BUILDER(                                      \
       Name("Conv2D").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
@@ -581,4 +787,17 @@ TF_CALL_double(REGISTER_CPU);
 TF_CALL_int32(REGISTER_CPU);
 #endif  // USE_GEMM_FOR_CONV
 
+#define REGISTER_FUSED_CPU(T)                                         \
+  REGISTER_KERNEL_BUILDER(                                            \
+      Name("_FusedConv2D").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedConv2DUsingGemmOp<                                         \
+          T, Im2ColConvFunctor<T, T, T, FastGemmFunctor<T, T, T>>>);
+
+// Like Conv2D above, this replaces the EigenTensor-based _FusedConv2D kernels
+// in conv_ops_fused_*.cc, which aren't registered with USE_GEMM_FOR_CONV.
+#if defined(USE_GEMM_FOR_CONV)
+TF_CALL_float(REGISTER_FUSED_CPU);
+TF_CALL_double(REGISTER_FUSED_CPU);
+#endif  // USE_GEMM_FOR_CONV
+
 }  // namespace tensorflow
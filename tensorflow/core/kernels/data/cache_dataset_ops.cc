@@ -19,6 +19,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
 #include "tensorflow/core/framework/dataset.h"
@@ -30,9 +31,13 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/iterator_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/protobuf/tensor_bundle.pb.h"
+#include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/tensor_bundle/naming.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
@@ -70,6 +75,102 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+
+// A buffer that aliases part of a read-only memory mapping. It never owns its
+// memory, so kernels cannot forward it to an output and write to it.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mmap");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// Memory maps the data files of a cache bundle, so that cached elements can be
+// returned as tensors that alias the mapping instead of being read into new
+// allocations.
+class MappedCacheFiles {
+ public:
+  // Maps the data files of the bundle read by `reader`, which must be
+  // positioned at the header entry. Returns nullptr if the files cannot be
+  // mapped, in which case the reader should be used for all entries.
+  static std::unique_ptr<MappedCacheFiles> Create(Env* env,
+                                                  const string& prefix,
+                                                  const BundleReader& reader) {
+    if (!reader.Valid() || reader.key() != kHeaderEntryKey) return nullptr;
+    BundleHeaderProto header;
+    if (!header.ParseFromArray(reader.value().data(), reader.value().size())) {
+      return nullptr;
+    }
+    if ((header.endianness() == BundleHeaderProto::BIG) ==
+        port::kLittleEndian) {
+      return nullptr;
+    }
+    auto files = absl::WrapUnique(new MappedCacheFiles());
+    for (int i = 0; i < header.num_shards(); ++i) {
+      std::unique_ptr<ReadOnlyMemoryRegion> region;
+      Status s = env->NewReadOnlyMemoryRegionFromFile(
+          DataFilename(prefix, i, header.num_shards()), &region);
+      if (!s.ok()) {
+        VLOG(1) << "Not memory mapping the cache files of " << prefix << ": "
+                << s;
+        return nullptr;
+      }
+      files->shards_.push_back(std::move(region));
+    }
+    return files;
+  }
+
+  // Sets `*tensor` to a tensor that aliases the contents of the entry whose
+  // serialized `BundleEntryProto` is `entry_value`, and returns true. Returns
+  // false if the entry cannot be aliased, e.g. because its dtype is not
+  // trivially copyable or its data is not aligned.
+  //
+  // Unlike `BundleReader::ReadCurrent()`, this does not validate the checksum
+  // of the data.
+  bool Read(StringPiece entry_value, Tensor* tensor) const {
+    BundleEntryProto entry;
+    if (!entry.ParseFromArray(entry_value.data(), entry_value.size()) ||
+        entry.slices_size() > 0 || !DataTypeCanUseMemcpy(entry.dtype()) ||
+        entry.shard_id() < 0 || entry.shard_id() >= shards_.size() ||
+        entry.offset() % EIGEN_MAX_ALIGN_BYTES != 0) {
+      return false;
+    }
+    const std::shared_ptr<ReadOnlyMemoryRegion>& shard =
+        shards_[entry.shard_id()];
+    if (entry.offset() + entry.size() > shard->length()) return false;
+    TensorShape shape;
+    if (!TensorShape::BuildTensorShape(entry.shape(), &shape).ok() ||
+        shape.num_elements() * DataTypeSize(entry.dtype()) != entry.size()) {
+      return false;
+    }
+    const char* data =
+        static_cast<const char*>(shard->data()) + entry.offset();
+    core::RefCountPtr<MappedTensorBuffer> buffer(
+        new MappedTensorBuffer(shard, data, entry.size()));
+    *tensor = Tensor(entry.dtype(), shape, buffer.get());
+    return true;
+  }
+
+ private:
+  MappedCacheFiles() = default;
+
+  std::vector<std::shared_ptr<ReadOnlyMemoryRegion>> shards_;
+};
+
 }  // namespace
 
 class PartialCache {
@@ -139,6 +240,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         input_(input),
         filename_(std::move(filename)),
         env_(env),
+        mmap_reads_(MmapReadsEnabled()),
         num_tensors_(input->output_dtypes().size()),
         tensor_index_padding_size_(StringPaddingSize(num_tensors_)),
         item_index_padding_size_(StringPaddingSize(kMaxItems)),
@@ -189,10 +291,31 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   const tstring filename_;
 
  private:
+  // Whether the cache files are written with aligned tensors and read through
+  // a memory mapping, which is enabled by setting the environment variable
+  // TF_DATA_CACHE_MMAP to true. Elements are then returned without copies,
+  // so repeated epochs are limited by the page cache bandwidth.
+  static bool MmapReadsEnabled() {
+    bool enabled = false;
+    Status s = ReadBoolFromEnvVar("TF_DATA_CACHE_MMAP", false, &enabled);
+    if (!s.ok()) {
+      LOG(WARNING) << "Not memory mapping the cache files: " << s;
+      return false;
+    }
+    return enabled;
+  }
+
   static size_t StringPaddingSize(size_t num_tensors) {
     return strings::Printf(kPaddingSizeStrFormat, num_tensors - 1).size();
   }
 
+  BundleWriter::Options WriterOptions() const {
+    BundleWriter::Options options;
+    // Aligned tensors can be aliased by the memory mapping of the files.
+    if (mmap_reads_) options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    return options;
+  }
+
   string FormatName(size_t item_index, size_t tensor_index) const {
     return strings::Printf(tensor_format_string_.c_str(), item_index,
                            tensor_index);
@@ -438,7 +561,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = std::make_unique<BundleWriter>(
+            dataset()->env_, filename_, dataset()->WriterOptions());
         return OkStatus();
       }
 
@@ -500,7 +624,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = std::make_unique<BundleWriter>(
+            dataset()->env_, filename_, dataset()->WriterOptions());
         lockfile_created_ = true;
         return OkStatus();
       }
@@ -557,6 +682,15 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
             reader_(dataset()->env_, dataset()->filename_),
             iterator_restored_(false) {}
 
+      Status Initialize(IteratorContext* ctx) override {
+        mutex_lock l(mu_);
+        if (dataset()->mmap_reads_ && reader_.status().ok()) {
+          mapped_files_ = MappedCacheFiles::Create(
+              dataset()->env_, dataset()->filename_, reader_);
+        }
+        return OkStatus();
+      }
+
       Status GetNextInternal(IteratorContext* ctx,
                              std::vector<Tensor>* out_tensors,
                              bool* end_of_sequence) override {
@@ -586,7 +720,10 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
           }
           StringPiece key = reader_.key();
           DCHECK_EQ(key, dataset()->FormatName(cur_index_, i));
-          TF_RETURN_IF_ERROR(reader_.ReadCurrent(&(*out_tensors)[i]));
+          if (mapped_files_ == nullptr ||
+              !mapped_files_->Read(reader_.value(), &(*out_tensors)[i])) {
+            TF_RETURN_IF_ERROR(reader_.ReadCurrent(&(*out_tensors)[i]));
+          }
           TF_RETURN_IF_ERROR(reader_.status());
         }
         cur_index_++;
@@ -635,6 +772,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       mutex mu_;
       size_t cur_index_ TF_GUARDED_BY(mu_);
       BundleReader reader_ TF_GUARDED_BY(mu_);
+      // Set if the cache files are memory mapped.
+      std::unique_ptr<MappedCacheFiles> mapped_files_ TF_GUARDED_BY(mu_);
       bool iterator_restored_ TF_GUARDED_BY(mu_);
     };  // FileReaderIterator
 
@@ -670,6 +809,7 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
   };  // FileIterator
 
   Env* const env_;
+  const bool mmap_reads_;
   const size_t num_tensors_;
   const size_t tensor_index_padding_size_;
   static constexpr size_t kMaxItems = 10000000;  // 10 million
@@ -0,0 +1,74 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/csv_scanner.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "absl/numeric/bits.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+inline bool IsFieldEnd(char ch, char delim, bool use_quote_delim) {
+  return ch == delim || ch == '\n' || ch == '\r' ||
+         (use_quote_delim && ch == '"');
+}
+
+}  // namespace
+
+size_t FindCsvFieldEnd(const char* data, size_t size, char delim,
+                       bool use_quote_delim) {
+  size_t pos = 0;
+#if defined(__SSE2__)
+  const __m128i delim_v = _mm_set1_epi8(delim);
+  const __m128i lf_v = _mm_set1_epi8('\n');
+  const __m128i cr_v = _mm_set1_epi8('\r');
+  // When quotes are not special, compare against the delimiter a second time
+  // so that the loop body stays branch free.
+  const __m128i quote_v = _mm_set1_epi8(use_quote_delim ? '"' : delim);
+  for (; pos + sizeof(__m128i) <= size; pos += sizeof(__m128i)) {
+    const __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+    const __m128i matches = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, delim_v),
+                     _mm_cmpeq_epi8(chunk, quote_v)),
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, lf_v), _mm_cmpeq_epi8(chunk, cr_v)));
+    const unsigned int mask =
+        static_cast<unsigned int>(_mm_movemask_epi8(matches));
+    if (mask != 0) {
+      return pos + absl::countr_zero(mask);
+    }
+  }
+#endif  // __SSE2__
+  for (; pos < size; ++pos) {
+    if (IsFieldEnd(data[pos], delim, use_quote_delim)) return pos;
+  }
+  return size;
+}
+
+size_t FindCsvQuote(const char* data, size_t size) {
+  // `memchr` is vectorized by every libc we build against.
+  const void* found = std::memchr(data, '"', size);
+  if (found == nullptr) return size;
+  return static_cast<const char*>(found) - data;
+}
+
+}  // namespace data
+}  // namespace tensorflow
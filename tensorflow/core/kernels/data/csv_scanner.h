@@ -0,0 +1,39 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_CSV_SCANNER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_CSV_SCANNER_H_
+
+#include <cstddef>
+
+namespace tensorflow {
+namespace data {
+
+// Returns the offset of the first byte in `[data, data + size)` that may end
+// an unquoted CSV field: `delim`, '\n', '\r', or, if `use_quote_delim` is
+// true, '"'. Returns `size` if there is no such byte.
+//
+// On x86 the bytes are compared 16 at a time with SSE2; other platforms fall
+// back to a scalar loop.
+size_t FindCsvFieldEnd(const char* data, size_t size, char delim,
+                       bool use_quote_delim);
+
+// Returns the offset of the first '"' in `[data, data + size)`, or `size` if
+// there is none. Used to skip over the body of a quoted field.
+size_t FindCsvQuote(const char* data, size_t size);
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_CSV_SCANNER_H_
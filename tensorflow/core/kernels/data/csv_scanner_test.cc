@@ -0,0 +1,97 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/csv_scanner.h"
+
+#include <string>
+
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+TEST(CsvScannerTest, FindFieldEndEmpty) {
+  EXPECT_EQ(FindCsvFieldEnd("", 0, ',', true), 0);
+}
+
+TEST(CsvScannerTest, FindFieldEndNoMatch) {
+  std::string s(100, 'a');
+  EXPECT_EQ(FindCsvFieldEnd(s.data(), s.size(), ',', true), s.size());
+}
+
+TEST(CsvScannerTest, FindFieldEndEverySpecialCharAtEveryOffset) {
+  // Covers matches in the vectorized body as well as in the scalar tail.
+  for (char special : {',', '\n', '\r', '"'}) {
+    for (size_t offset = 0; offset < 40; ++offset) {
+      std::string s(40, 'x');
+      s[offset] = special;
+      EXPECT_EQ(FindCsvFieldEnd(s.data(), s.size(), ',', true), offset)
+          << "special=" << static_cast<int>(special) << " offset=" << offset;
+    }
+  }
+}
+
+TEST(CsvScannerTest, FindFieldEndIgnoresQuoteWithoutQuoteDelim) {
+  std::string s = "abc\"defghijklmnopqrstuvwxyz|tail";
+  EXPECT_EQ(FindCsvFieldEnd(s.data(), s.size(), '|', false), s.find('|'));
+  EXPECT_EQ(FindCsvFieldEnd(s.data(), s.size(), '|', true), 3);
+}
+
+TEST(CsvScannerTest, FindFieldEndReturnsFirstMatch) {
+  std::string s = "0123456789abcdef,0123\n";
+  EXPECT_EQ(FindCsvFieldEnd(s.data(), s.size(), ',', true), 16);
+  EXPECT_EQ(FindCsvFieldEnd(s.data() + 17, s.size() - 17, ',', true), 4);
+}
+
+TEST(CsvScannerTest, FindQuote) {
+  std::string s = "abc,def\"ghi";
+  EXPECT_EQ(FindCsvQuote(s.data(), s.size()), 7);
+  EXPECT_EQ(FindCsvQuote(s.data(), 7), 7);
+  EXPECT_EQ(FindCsvQuote("", 0), 0);
+}
+
+std::string MakeCsv(int num_records, int num_fields, int field_len) {
+  std::string csv;
+  for (int r = 0; r < num_records; ++r) {
+    for (int f = 0; f < num_fields; ++f) {
+      if (f > 0) csv += ',';
+      csv.append(field_len, 'a' + (f % 26));
+    }
+    csv += '\n';
+  }
+  return csv;
+}
+
+void BM_ScanCsvFields(::testing::benchmark::State& state) {
+  const int field_len = state.range(0);
+  const std::string csv = MakeCsv(/*num_records=*/1000, /*num_fields=*/10,
+                                  field_len);
+  for (auto s : state) {
+    size_t pos = 0;
+    while (pos < csv.size()) {
+      pos += FindCsvFieldEnd(csv.data() + pos, csv.size() - pos, ',', true) + 1;
+    }
+    ::testing::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          csv.size());
+}
+
+BENCHMARK(BM_ScanCsvFields)->Arg(1)->Arg(8)->Arg(32)->Arg(128);
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
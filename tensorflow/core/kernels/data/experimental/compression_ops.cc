@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/data/experimental/compression_ops.h"
 
+#include "tensorflow/core/data/adaptive_compression.h"
 #include "tensorflow/core/data/compression_utils.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/errors.h"
 
 namespace tensorflow {
@@ -32,8 +34,24 @@ void CompressElementOp::Compute(OpKernelContext* ctx) {
   for (size_t i = 0; i < ctx->num_inputs(); ++i) {
     components.push_back(ctx->input(i));
   }
+  // Lets a tf.data service worker running this op skip compression when it
+  // is not expected to pay off. The element is then stored as is and still
+  // read with `UncompressElement`.
+  AdaptiveCompressionPolicy& policy = AdaptiveCompressionPolicy::Global();
+  const bool compress = policy.ShouldCompress();
+  const int64_t start_micros = EnvTime::NowMicros();
   CompressedElement compressed;
-  OP_REQUIRES_OK(ctx, CompressElement(components, &compressed));
+  OP_REQUIRES_OK(ctx, CompressElement(components, compress, &compressed));
+  if (compress) {
+    int64_t uncompressed_bytes = 0;
+    for (const auto& metadata : compressed.component_metadata()) {
+      for (uint64 bytes : metadata.uncompressed_bytes()) {
+        uncompressed_bytes += bytes;
+      }
+    }
+    policy.RecordCompression(uncompressed_bytes, compressed.data().size(),
+                             EnvTime::NowMicros() - start_micros);
+  }
 
   Tensor* output;
   OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/kernels/data/csv_scanner.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
@@ -508,7 +509,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         pos_++;  // Starting quotation mark
 
         Status parse_result;
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter scans a run of chars, filling buffer
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             if (errors::IsOutOfRange(s)) {
@@ -520,6 +521,10 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          // Skip the body of the field up to the next quotation mark.
+          pos_ += FindCsvQuote(&buffer_[pos_], buffer_.size() - pos_);
+          if (pos_ >= buffer_.size()) continue;
+
           char ch = buffer_[pos_];
           if (ch == '"') {
             // When we encounter a quote, we look ahead to the next character to
@@ -641,7 +646,7 @@ class CSVDatasetOp : public DatasetOpKernel {
         size_t start = pos_;
         Status parse_result;
 
-        while (true) {  // Each iter reads 1 char, filling buffer if necessary
+        while (true) {  // Each iter scans a run of chars, filling buffer
           if (pos_ >= buffer_.size()) {
             Status s = SaveAndFillBuffer(&earlier_pieces, &start, include);
             // Handle errors
@@ -657,6 +662,13 @@ class CSVDatasetOp : public DatasetOpKernel {
             }
           }
 
+          // Skip ordinary characters until the next delimiter, line break or
+          // quotation mark.
+          pos_ += FindCsvFieldEnd(&buffer_[pos_], buffer_.size() - pos_,
+                                  dataset()->delim_,
+                                  dataset()->use_quote_delim_);
+          if (pos_ >= buffer_.size()) continue;
+
           char ch = buffer_[pos_];
 
           if (ch == dataset()->delim_) {
@@ -0,0 +1,336 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/random_index_shuffle.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// Constants declared in global_shuffle_dataset_op.h and used both here and in
+// test cases.
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kDatasetType;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kInputDataset;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeed2;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kSeedGenerator;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputTypes;
+/* static */ constexpr const char* const GlobalShuffleDatasetOp::kOutputShapes;
+/* static */ constexpr const char* const
+    GlobalShuffleDatasetOp::kReshuffleEachIteration;
+
+namespace {
+
+constexpr char kSeedGeneratorResource[] = "SeedGenerator";
+constexpr char kEpochNumRandomSamples[] = "epoch_num_random_samples";
+constexpr char kNextIndex[] = "next_index";
+// The number of rounds of the block cipher behind `random::index_shuffle`.
+constexpr int32_t kShuffleRounds = 8;
+
+// Returns the position of `index` in the permutation of [0, cardinality)
+// selected by the seeds.
+int64_t PermuteIndex(int64_t index, int64_t cardinality, int64_t seed,
+                     int64_t seed2) {
+  if (cardinality <= 1) return index;
+  const std::array<uint32_t, 3> key = {
+      static_cast<uint32_t>(seed), static_cast<uint32_t>(seed2),
+      static_cast<uint32_t>((static_cast<uint64_t>(seed) >> 32) ^
+                            (static_cast<uint64_t>(seed2) >> 32))};
+  return static_cast<int64_t>(random::index_shuffle(
+      static_cast<uint64_t>(index), key,
+      static_cast<uint64_t>(cardinality - 1), kShuffleRounds));
+}
+
+}  // namespace
+
+class GlobalShuffleDatasetOp::Dataset : public DatasetBase {
+ public:
+  Dataset(OpKernelContext* ctx, const DatasetBase* input, RandomSeeds&& seeds,
+          SeedGeneratorManager* manager, ResourceHandle&& resource_handle,
+          bool owns_resource)
+      : DatasetBase(DatasetContext(ctx)),
+        input_(input),
+        seeds_(std::move(seeds)),
+        manager_(manager),
+        resource_handle_(std::move(resource_handle)),
+        resource_mgr_(ctx->resource_manager()),
+        owns_resource_(owns_resource) {
+    input_->Ref();
+  }
+
+  ~Dataset() override {
+    input_->Unref();
+    manager_->Unref();
+    if (owns_resource_) {
+      Status s = resource_mgr_->Delete<SeedGeneratorManager>(
+          resource_handle_.container(), resource_handle_.name());
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to delete RNG resource: " << s.ToString();
+      }
+    }
+  }
+
+  std::unique_ptr<IteratorBase> MakeIteratorInternal(
+      const string& prefix) const override {
+    return std::make_unique<Iterator>(
+        Iterator::Params{this, name_utils::IteratorPrefix(kDatasetType, prefix)},
+        manager_->get().get());
+  }
+
+  Status MakeSplitProviders(std::vector<std::unique_ptr<SplitProvider>>*
+                                split_providers) const override {
+    // The iterator reads its input by index, so it cannot consume splits.
+    return errors::Unimplemented(
+        "Split providers are not implemented for ", DebugString(), ".");
+  }
+
+  const DataTypeVector& output_dtypes() const override {
+    return input_->output_dtypes();
+  }
+
+  const std::vector<PartialTensorShape>& output_shapes() const override {
+    return input_->output_shapes();
+  }
+
+  string DebugString() const override {
+    name_utils::DatasetDebugStringParams params;
+    params.set_args(seeds_.input_seed(), seeds_.input_seed2());
+    return name_utils::DatasetDebugString(kDatasetType, params);
+  }
+
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    return input_->Cardinality(options);
+  }
+
+  Status InputDatasets(std::vector<const DatasetBase*>* inputs) const override {
+    inputs->push_back(input_);
+    return OkStatus();
+  }
+
+  Status CheckExternalState() const override {
+    return input_->CheckExternalState();
+  }
+
+  // Random access uses the permutation selected by the dataset seeds, which
+  // does not change between calls.
+  Status Get(OpKernelContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return input_->Get(ctx,
+                       PermuteIndex(index, Cardinality(), seeds_.seed(),
+                                    seeds_.seed2()),
+                       out_tensors);
+  }
+
+  Status Get(IteratorContext* ctx, int64 index,
+             std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    return input_->Get(ctx,
+                       PermuteIndex(index, Cardinality(), seeds_.seed(),
+                                    seeds_.seed2()),
+                       out_tensors);
+  }
+
+ protected:
+  Status AsGraphDefInternal(SerializationContext* ctx,
+                            DatasetGraphDefBuilder* b,
+                            Node** output) const override {
+    Node* input_graph_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddInputDataset(ctx, input_, &input_graph_node));
+    Node* seed_node = nullptr;
+    Node* seed2_node = nullptr;
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed(), &seed_node));
+    TF_RETURN_IF_ERROR(b->AddScalar(seeds_.input_seed2(), &seed2_node));
+    Node* resource_handle_node = nullptr;
+    Tensor handle(DT_RESOURCE, TensorShape({}));
+    handle.scalar<ResourceHandle>()() = resource_handle_;
+    TF_RETURN_IF_ERROR(b->AddTensor(handle, &resource_handle_node));
+    AttrValue reshuffle_each_iteration;
+    b->BuildAttrValue(manager_->get()->reshuffle_each_iteration(),
+                      &reshuffle_each_iteration);
+    return b->AddDataset(
+        this, {input_graph_node, seed_node, seed2_node, resource_handle_node},
+        {std::make_pair(kReshuffleEachIteration, reshuffle_each_iteration)},
+        output);
+  }
+
+ private:
+  class Iterator : public DatasetIterator<Dataset> {
+   public:
+    Iterator(const Params& params, SeedGenerator* seed_generator)
+        : DatasetIterator<Dataset>(params), seed_generator_(seed_generator) {}
+
+    bool SymbolicCheckpointCompatible() const override { return true; }
+
+    Status Initialize(IteratorContext* ctx) override {
+      mutex_lock l(mu_);
+      cardinality_ = dataset()->input_->Cardinality();
+      if (cardinality_ == kInfiniteCardinality ||
+          cardinality_ == kUnknownCardinality) {
+        return errors::FailedPrecondition(
+            "`global_shuffle` requires an input with a known, finite "
+            "cardinality, but the cardinality of ",
+            dataset()->input_->DebugString(), " is ",
+            cardinality_ == kInfiniteCardinality ? "infinite" : "unknown",
+            ".");
+      }
+      seed_generator_->GenerateSeeds(&seed_, &seed2_);
+      return OkStatus();
+    }
+
+    Status GetNextInternal(IteratorContext* ctx,
+                           std::vector<Tensor>* out_tensors,
+                           bool* end_of_sequence) override {
+      mutex_lock l(mu_);
+      if (next_index_ >= cardinality_) {
+        *end_of_sequence = true;
+        return OkStatus();
+      }
+      TF_RETURN_IF_ERROR(dataset()->input_->Get(
+          ctx, PermuteIndex(next_index_, cardinality_, seed_, seed2_),
+          out_tensors));
+      ++next_index_;
+      *end_of_sequence = false;
+      return OkStatus();
+    }
+
+   protected:
+    std::shared_ptr<model::Node> CreateNode(
+        IteratorContext* ctx, model::Node::Args args) const override {
+      return model::MakeKnownRatioNode(std::move(args), /*ratio=*/1);
+    }
+
+    Status SaveInternal(SerializationContext* ctx,
+                        IteratorStateWriter* writer) override {
+      mutex_lock l(mu_);
+      TF_RETURN_IF_ERROR(
+          writer->WriteScalar(full_name(kEpochNumRandomSamples),
+                              seed_generator_->num_random_samples()));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed), seed_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kSeed2), seed2_));
+      TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kNextIndex), next_index_));
+      return OkStatus();
+    }
+
+    Status RestoreInternal(IteratorContext* ctx,
+                           IteratorStateReader* reader) override {
+      mutex_lock l(mu_);
+      int64_t num_random_samples;
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kEpochNumRandomSamples),
+                                            &num_random_samples));
+      seed_generator_->set_num_random_samples(num_random_samples);
+      seed_generator_->Reset();
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed), &seed_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kSeed2), &seed2_));
+      TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kNextIndex), &next_index_));
+      return OkStatus();
+    }
+
+   private:
+    mutex mu_;
+    SeedGenerator* const seed_generator_ TF_GUARDED_BY(mu_);  // Not owned.
+    int64_t cardinality_ TF_GUARDED_BY(mu_) = 0;
+    // The seeds of the permutation of this iterator.
+    int64_t seed_ TF_GUARDED_BY(mu_) = 0;
+    int64_t seed2_ TF_GUARDED_BY(mu_) = 0;
+    // The position in the permutation of the next element to produce.
+    int64_t next_index_ TF_GUARDED_BY(mu_) = 0;
+  };
+
+  const DatasetBase* const input_;
+  const RandomSeeds seeds_;
+  SeedGeneratorManager* const manager_;  // Owned.
+  const ResourceHandle resource_handle_;
+  ResourceMgr* const resource_mgr_;  // Not owned.
+  const bool owns_resource_;
+};
+
+GlobalShuffleDatasetOp::GlobalShuffleDatasetOp(OpKernelConstruction* ctx)
+    : UnaryDatasetOpKernel(ctx) {
+  OP_REQUIRES_OK(ctx, ctx->GetAttr(kReshuffleEachIteration,
+                                   &reshuffle_each_iteration_));
+}
+
+void GlobalShuffleDatasetOp::MakeDataset(OpKernelContext* ctx,
+                                         DatasetBase* input,
+                                         DatasetBase** output) {
+  int64_t seed;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed, &seed));
+  int64_t seed2;
+  OP_REQUIRES_OK(ctx, ParseScalarArgument<int64_t>(ctx, kSeed2, &seed2));
+  RandomSeeds seeds(seed, seed2);
+
+  static std::atomic<int64_t> resource_id_counter(0);
+  const string& container = ctx->resource_manager()->default_container();
+  auto name = strings::StrCat(ctx->op_kernel().name(), "/",
+                              kSeedGeneratorResource, "_",
+                              resource_id_counter.fetch_add(1));
+  ResourceHandle handle = HandleFromInput(ctx, 3);
+  SeedGeneratorManager* manager = nullptr;
+  Status s = ctx->resource_manager()->Lookup<SeedGeneratorManager>(
+      handle.container(), handle.name(), &manager);
+  bool owns_resource = false;
+  if (errors::IsNotFound(s)) {
+    owns_resource = true;
+    OP_REQUIRES_OK(
+        ctx, ctx->resource_manager()->LookupOrCreate<SeedGeneratorManager>(
+                 container, name, &manager,
+                 [reshuffle = reshuffle_each_iteration_,
+                  &seeds](SeedGeneratorManager** manager) {
+                   if (reshuffle) {
+                     *manager = new SeedGeneratorManager(
+                         new RandomSeedGenerator(seeds));
+                   } else {
+                     *manager = new SeedGeneratorManager(
+                         new FixedSeedGenerator(seeds));
+                   }
+                   return OkStatus();
+                 }));
+    handle = MakeResourceHandle<SeedGenerator>(ctx, container, name);
+  } else {
+    OP_REQUIRES_OK(ctx, s);
+  }
+
+  // Ownership of `manager` is transferred onto `Dataset`.
+  *output = new Dataset(ctx, input, std::move(seeds), manager,
+                        std::move(handle), owns_resource);
+}
+
+namespace {
+REGISTER_KERNEL_BUILDER(Name("GlobalShuffleDataset").Device(DEVICE_CPU),
+                        GlobalShuffleDatasetOp);
+}  // namespace
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
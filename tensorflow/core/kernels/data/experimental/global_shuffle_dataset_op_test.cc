@@ -0,0 +1,172 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/global_shuffle_dataset_op.h"
+
+#include "tensorflow/core/data/dataset_test_base.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kNodeName[] = "global_shuffle_dataset";
+constexpr int64_t kNumElements = 100;
+
+class GlobalShuffleDatasetParams : public DatasetParams {
+ public:
+  template <typename T>
+  GlobalShuffleDatasetParams(T input_dataset_params, int64_t seed,
+                             int64_t seed2, bool reshuffle_each_iteration,
+                             DataTypeVector output_dtypes,
+                             std::vector<PartialTensorShape> output_shapes,
+                             string node_name)
+      : DatasetParams(std::move(output_dtypes), std::move(output_shapes),
+                      std::move(node_name)),
+        seed_(seed),
+        seed2_(seed2),
+        reshuffle_each_iteration_(reshuffle_each_iteration) {
+    input_dataset_params_.push_back(std::make_unique<T>(input_dataset_params));
+    iterator_prefix_ =
+        name_utils::IteratorPrefix(input_dataset_params.dataset_type(),
+                                   input_dataset_params.iterator_prefix());
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    return {CreateTensor<int64_t>(TensorShape({}), {seed_}),
+            CreateTensor<int64_t>(TensorShape({}), {seed2_}),
+            CreateTensor<ResourceHandle>(TensorShape({}), {ResourceHandle()})};
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    *input_names = {GlobalShuffleDatasetOp::kInputDataset,
+                    GlobalShuffleDatasetOp::kSeed,
+                    GlobalShuffleDatasetOp::kSeed2,
+                    GlobalShuffleDatasetOp::kSeedGenerator};
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    *attr_vector = {{GlobalShuffleDatasetOp::kReshuffleEachIteration,
+                     reshuffle_each_iteration_},
+                    {GlobalShuffleDatasetOp::kOutputTypes, output_dtypes_},
+                    {GlobalShuffleDatasetOp::kOutputShapes, output_shapes_},
+                    {"metadata", ""}};
+    return OkStatus();
+  }
+
+  string dataset_type() const override {
+    return GlobalShuffleDatasetOp::kDatasetType;
+  }
+
+ private:
+  int64_t seed_;
+  int64_t seed2_;
+  bool reshuffle_each_iteration_;
+};
+
+class GlobalShuffleDatasetOpTest : public DatasetOpsTestBase {
+ protected:
+  // Returns all remaining elements of `iterator`.
+  std::vector<Tensor> GetAll(IteratorBase* iterator) {
+    std::vector<Tensor> out_tensors;
+    bool end_of_sequence = false;
+    while (!end_of_sequence) {
+      std::vector<Tensor> next;
+      TF_CHECK_OK(
+          iterator->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+      out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+    }
+    return out_tensors;
+  }
+
+  std::vector<Tensor> GetAllFromNewIterator(const DatasetParams& params) {
+    std::unique_ptr<IteratorBase> iterator;
+    TF_CHECK_OK(dataset_->MakeIterator(iterator_ctx_.get(), /*parent=*/nullptr,
+                                       params.iterator_prefix(), &iterator));
+    return GetAll(iterator.get());
+  }
+};
+
+GlobalShuffleDatasetParams ShuffledRangeParams(bool reshuffle_each_iteration) {
+  return GlobalShuffleDatasetParams(RangeDatasetParams(0, kNumElements, 1),
+                                    /*seed=*/1,
+                                    /*seed2=*/2, reshuffle_each_iteration,
+                                    /*output_dtypes=*/{DT_INT64},
+                                    /*output_shapes=*/{PartialTensorShape({})},
+                                    /*node_name=*/kNodeName);
+}
+
+std::vector<Tensor> Range() {
+  std::vector<Tensor> range;
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    range.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+  }
+  return range;
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ProducesPermutation) {
+  auto dataset_params = ShuffledRangeParams(/*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors = GetAll(iterator_.get());
+  TF_EXPECT_OK(ExpectEqual(out_tensors, Range(), /*compare_order=*/false));
+  EXPECT_FALSE(ExpectEqual(out_tensors, Range(), /*compare_order=*/true).ok());
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, FixedSeedsRepeatPermutation) {
+  auto dataset_params = ShuffledRangeParams(/*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> first = GetAll(iterator_.get());
+  std::vector<Tensor> second = GetAllFromNewIterator(dataset_params);
+  TF_EXPECT_OK(ExpectEqual(first, second, /*compare_order=*/true));
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, ReshuffleEachIteration) {
+  auto dataset_params = ShuffledRangeParams(/*reshuffle_each_iteration=*/true);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> first = GetAll(iterator_.get());
+  std::vector<Tensor> second = GetAllFromNewIterator(dataset_params);
+  TF_EXPECT_OK(ExpectEqual(second, Range(), /*compare_order=*/false));
+  EXPECT_FALSE(ExpectEqual(first, second, /*compare_order=*/true).ok());
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, RandomAccess) {
+  auto dataset_params = ShuffledRangeParams(/*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> out_tensors;
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    std::vector<Tensor> element;
+    TF_ASSERT_OK(dataset_->Get(iterator_ctx_.get(), i, &element));
+    out_tensors.insert(out_tensors.end(), element.begin(), element.end());
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, Range(), /*compare_order=*/false));
+  std::vector<Tensor> element;
+  EXPECT_EQ(dataset_->Get(iterator_ctx_.get(), kNumElements, &element).code(),
+            error::OUT_OF_RANGE);
+}
+
+TEST_F(GlobalShuffleDatasetOpTest, SaveAndRestore) {
+  auto dataset_params = ShuffledRangeParams(/*reshuffle_each_iteration=*/false);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  std::vector<Tensor> expected_outputs =
+      GetAllFromNewIterator(dataset_params);
+  TF_ASSERT_OK(CheckIteratorSaveAndRestore(
+      dataset_params.iterator_prefix(), expected_outputs,
+      /*breakpoints=*/{0, 4, 50, kNumElements}, /*compare_order=*/true));
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
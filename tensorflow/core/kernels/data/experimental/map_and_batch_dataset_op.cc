@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/function.h"
 #include "tensorflow/core/common_runtime/input_colocation_exemption_registry.h"
+#include "tensorflow/core/data/batch_slice_allocator.h"
 #include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/stats_utils.h"
@@ -103,6 +104,21 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
               strings::Printf("%lld", static_cast<long long>(batch_size))},
              {"drop_remainder", drop_remainder ? "true" : "false"}}) {
     input_->Ref();
+    for (size_t i = 0; i < output_shapes_.size(); ++i) {
+      if (!DataTypeCanUseMemcpy(output_types_[i]) ||
+          output_shapes_[i].dims() < 1) {
+        element_shapes_.clear();
+        break;
+      }
+      PartialTensorShape partial_shape = output_shapes_[i];
+      partial_shape.RemoveDim(0);
+      TensorShape element_shape;
+      if (!partial_shape.AsTensorShape(&element_shape)) {
+        element_shapes_.clear();
+        break;
+      }
+      element_shapes_.push_back(element_shape);
+    }
   }
 
   ~Dataset() override { input_->Unref(); }
@@ -354,6 +370,18 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // The slices of the batch that one function call writes its results
+    // into, one per component.
+    struct BatchSlices {
+      ~BatchSlices() {
+        for (BatchSliceAllocator* allocator : allocators) allocator->Release();
+      }
+
+      std::vector<BatchSliceAllocator*> allocators;
+      // The same allocators, as passed to the function.
+      std::vector<Allocator*> retval_allocators;
+    };
+
     // BatchResult encapsulates the output batch, as well as ancillary
     // metadata required to execute the fused map-and-batch operation.
     struct BatchResult {
@@ -437,9 +465,25 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
         return;
       }
 
+      // When the element shapes are known statically, the batch is allocated
+      // before the function runs, so that it writes its results directly into
+      // the batch.
+      std::shared_ptr<BatchSlices> slices;
+      if (!dataset()->element_shapes_.empty() &&
+          EnsureOutputAllocated(ctx, result, /*return_values=*/nullptr).ok()) {
+        slices = std::make_shared<BatchSlices>();
+        Allocator* fallback = ctx->allocator(AllocatorAttributes());
+        for (const Tensor& batch : result->output) {
+          slices->allocators.push_back(
+              new BatchSliceAllocator(batch, offset, fallback));
+          slices->retval_allocators.push_back(slices->allocators.back());
+        }
+      }
+
       std::shared_ptr<std::vector<Tensor>> return_values =
           std::make_shared<std::vector<Tensor>>();
-      auto done = [this, ctx, result, return_values, offset](Status status) {
+      auto done = [this, ctx, result, return_values, slices,
+                   offset](Status status) {
         if (dataset()->preserve_cardinality_ && errors::IsOutOfRange(status)) {
           // To guarantee that the transformation preserves the cardinality of
           // the dataset, we convert `OutOfRange` to `InvalidArgument` as the
@@ -458,6 +502,11 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
             for (size_t i = 0; i < return_values->size(); ++i) {
               Tensor& tensor = return_values->at(i);
               Tensor* batch = &(result->output)[i];
+              if (slices && slices->allocators[i]->Holds(tensor)) {
+                // Already in place.
+                tensor = Tensor();
+                continue;
+              }
               if (tensor.NumElements() !=
                   (batch->NumElements() / batch->dim_size(0))) {
                 TensorShape batch_shape = batch->shape();
@@ -492,9 +541,10 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
 
       // Apply the map function on `input_element`, storing the result in
       // `return_values`, and invoking `done` when finished.
-      instantiated_captured_func_->RunAsync(ctx.get(), std::move(input_element),
-                                            return_values.get(),
-                                            std::move(done), model_node());
+      instantiated_captured_func_->RunAsync(
+          ctx.get(), std::move(input_element), return_values.get(),
+          std::move(done), model_node(),
+          slices ? &slices->retval_allocators : nullptr);
     }
 
     void CancelThreads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
@@ -518,6 +568,8 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Allocates the batch with the element shapes of `return_values`, or the
+    // static element shapes of the dataset if `return_values` is null.
     Status EnsureOutputAllocated(
         const std::shared_ptr<IteratorContext>& ctx,
         const std::shared_ptr<BatchResult>& result,
@@ -526,15 +578,21 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
       if (result->output_allocated) {
         return OkStatus();
       }
-      const size_t num_components = return_values->size();
+      const size_t num_components = return_values
+                                        ? return_values->size()
+                                        : dataset()->element_shapes_.size();
       result->output.reserve(num_components);
       for (size_t i = 0; i < num_components; ++i) {
         TensorShape component_shape({dataset()->batch_size_});
-        component_shape.AppendShape(return_values->at(i).shape());
+        component_shape.AppendShape(return_values
+                                        ? return_values->at(i).shape()
+                                        : dataset()->element_shapes_[i]);
         AllocatorAttributes attr;
         attr.set_gpu_compatible(true);
         result->output.emplace_back(ctx->allocator(attr),
-                                    return_values->at(i).dtype(),
+                                    return_values
+                                        ? return_values->at(i).dtype()
+                                        : dataset()->output_types_[i],
                                     component_shape);
         if (!result->output.back().IsInitialized()) {
           return errors::ResourceExhausted(
@@ -725,6 +783,9 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
   const std::unique_ptr<CapturedFunction> captured_func_;
   const bool preserve_cardinality_;
   const TraceMeMetadata traceme_metadata_;
+  // The shapes of the elements of the batch, if they are all fully defined
+  // and of a type that can be copied with memcpy, and empty otherwise.
+  std::vector<TensorShape> element_shapes_;
 };
 
 MapAndBatchDatasetOp::MapAndBatchDatasetOp(OpKernelConstruction* ctx)
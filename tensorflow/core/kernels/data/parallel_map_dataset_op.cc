@@ -495,7 +495,14 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
 
       // Apply the map function on `input_element`, storing the result in
       // `result->return_values`, and invoking `done` when finished.
-      if (dataset()->captured_func_->use_inter_op_parallelism()) {
+      if (dataset()->captured_func_->is_cheap()) {
+        // Running a cheap function inline on the runner thread is faster than
+        // handing it to another thread. The runner thread is already
+        // recording, so it is safe to pass `model_node()`.
+        done(instantiated_captured_func_->Run(
+            ctx.get(), std::move(input_element), &result->return_values,
+            model_node()));
+      } else if (dataset()->captured_func_->use_inter_op_parallelism()) {
         instantiated_captured_func_->RunAsync(
             ctx.get(), std::move(input_element), &result->return_values,
             std::move(done), model_node());
@@ -251,6 +251,41 @@ ParallelMapDatasetParams ParallelMapDatasetParams8() {
       /*node_name=*/kNodeName);
 }
 
+// A function that is cheap enough to run inline.
+FunctionDef CastToFloat() {
+  return FunctionDefHelper::Define(
+      // Name
+      "CastToFloat",
+      // Args
+      {"x: T"},
+      // Return values
+      {"y: float"},
+      // Attr def
+      {"T: {int32, int64}"},
+      // Nodes
+      {
+          {{"y"}, "Cast", {"x"}, {{"SrcT", "$T"}, {"DstT", DT_FLOAT}}},
+      });
+}
+
+// test case 9: num_parallel_calls = 2, use_inter_op_parallelism = true,
+// deterministic = true, preserve_cardinality = true, MapFunc = CastToFloat
+ParallelMapDatasetParams ParallelMapDatasetParams9() {
+  return ParallelMapDatasetParams(
+      RangeDatasetParams(0, 10, 3),
+      /*other_arguments=*/{},
+      /*num_parallel_calls=*/2,
+      /*func=*/MapFunc("CastToFloat", DT_INT64),
+      /*func_lib*/ {CastToFloat()},
+      /*type_arguments=*/{},
+      /*output_dtypes=*/{DT_FLOAT},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*use_inter_op_parallelism=*/true,
+      /*deterministic=*/DeterminismPolicy::kDeterministic,
+      /*preserve_cardinality=*/true,
+      /*node_name=*/kNodeName);
+}
+
 ParallelMapDatasetParams ParallelMapDatasetParamsWithInvalidNumParallelCalls() {
   return ParallelMapDatasetParams(
       RangeDatasetParams(0, 10, 3),
@@ -292,6 +327,10 @@ std::vector<GetNextTestCase<ParallelMapDatasetParams>> GetNextTestCases() {
            ParallelMapDatasetParams6(),
            /*expected_outputs=*/
            CreateTensors<int64_t>(TensorShape{}, {{0}, {12}, {24}, {36}}),
+           /*compare_order=*/true},
+          {/*dataset_params=*/ParallelMapDatasetParams9(),
+           /*expected_outputs=*/
+           CreateTensors<float>(TensorShape{}, {{0}, {3}, {6}, {9}}),
            /*compare_order=*/true}};
 }
 
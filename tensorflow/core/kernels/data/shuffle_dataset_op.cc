@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/shuffle_dataset_op.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <memory>
@@ -35,6 +37,8 @@ limitations under the License.
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
@@ -52,6 +56,7 @@ namespace data {
 /* static */ constexpr const char* const ShuffleDatasetOpBase::kOutputShapes;
 /* static */ constexpr const char* const
     ShuffleDatasetOpBase::kReshuffleEachIteration;
+/* static */ constexpr const char* const ShuffleDatasetOpBase::kDeterministic;
 
 /* static */ constexpr const char* const ShuffleDatasetOp::kDatasetType;
 
@@ -61,6 +66,10 @@ namespace data {
 
 const int64_t kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 const int64_t kMaxEpochsInBuffer = 3;
+// When determinism is not required, the buffer is filled on multiple threads
+// if at least this many elements are missing.
+const int64_t kMinParallelFillElements = 1024;
+const int kMaxParallelFillThreads = 16;
 
 constexpr char kNumRandomSamples[] = "num_random_samples";
 constexpr char kDataProduced[] = "data_produced";
@@ -79,7 +88,14 @@ constexpr char kShuffleAndRepeatDatasetV1[] = "ShuffleAndRepeatDataset";
 constexpr char kShuffleAndRepeatDatasetV2[] = "ShuffleAndRepeatDatasetV2";
 
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
-    : UnaryDatasetOpKernel(ctx) {}
+    : UnaryDatasetOpKernel(ctx) {
+  if (ctx->HasAttr(kDeterministic)) {
+    std::string deterministic;
+    OP_REQUIRES_OK(ctx, ctx->GetAttr(kDeterministic, &deterministic));
+    OP_REQUIRES_OK(
+        ctx, DeterminismPolicy::FromString(deterministic, &deterministic_));
+  }
+}
 
 // Abstract base dataset that implements a shuffling iterator.
 class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
@@ -87,12 +103,14 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   ShuffleDatasetBase(OpKernelContext* ctx, const DatasetBase* input,
                      int64_t buffer_size,
                      std::shared_ptr<SeedGenerator> seed_generator,
-                     int64_t count)
+                     int64_t count,
+                     DeterminismPolicy deterministic = DeterminismPolicy())
       : DatasetBase(DatasetContext(ctx)),
         input_(input),
         buffer_size_(buffer_size),
         seed_generator_(std::move(seed_generator)),
         count_(count),
+        deterministic_(deterministic),
         traceme_metadata_(
             {{"buffer_size",
               strings::Printf("%lld", static_cast<long long>(buffer_size))}}) {
@@ -395,12 +413,19 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         if (!input_impl_) {
           TF_RETURN_IF_ERROR(PrepareNextEpoch(ctx));
         }
-        std::vector<Tensor> input_element;
         bool end_of_input_sequence = false;
-        TF_RETURN_IF_ERROR(
-            input_impl_->GetNext(ctx, &input_element, &end_of_input_sequence));
+        if (dataset()->deterministic_.IsNondeterministic() &&
+            buffer_->size() - num_elements_ >= kMinParallelFillElements) {
+          TF_RETURN_IF_ERROR(FillBufferInParallel(ctx, &end_of_input_sequence));
+        } else {
+          std::vector<Tensor> input_element;
+          TF_RETURN_IF_ERROR(input_impl_->GetNext(ctx, &input_element,
+                                                  &end_of_input_sequence));
+          if (!end_of_input_sequence) {
+            AddToShuffleBuffer(ctx, std::move(input_element));
+          }
+        }
         if (!end_of_input_sequence) {
-          AddToShuffleBuffer(ctx, std::move(input_element));
           continue;
         }
         input_impl_.reset();
@@ -419,6 +444,65 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
       return OkStatus();
     }
 
+    // Fetches elements from `input_impl_` on multiple threads until the
+    // buffer is full or the input is exhausted. Each thread collects its
+    // elements separately, and the shards are then appended to the buffer one
+    // after the other, so which element ends up where depends on the thread
+    // timing. Sampling is still uniform over the whole buffer.
+    Status FillBufferInParallel(IteratorContext* ctx,
+                                bool* end_of_input_sequence)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (!fill_thread_pool_) {
+        fill_thread_pool_ = ctx->CreateThreadPool(
+            "shuffle_fill",
+            std::min(port::MaxParallelism(), kMaxParallelFillThreads));
+      }
+      const int num_threads = fill_thread_pool_->NumThreads();
+      const int64_t num_missing = buffer_->size() - num_elements_;
+      std::vector<std::vector<std::vector<Tensor>>> shards(num_threads);
+      std::vector<Status> statuses(num_threads);
+      std::atomic<int64_t> num_claimed(0);
+      std::atomic<bool> stop(false);
+      std::atomic<bool> end_of_input(false);
+      IteratorBase* input = input_impl_.get();
+      BlockingCounter counter(num_threads);
+      for (int i = 0; i < num_threads; ++i) {
+        fill_thread_pool_->Schedule([&, i]() {
+          RecordStart(ctx);
+          while (!stop.load(std::memory_order_relaxed) &&
+                 num_claimed.fetch_add(1, std::memory_order_relaxed) <
+                     num_missing) {
+            std::vector<Tensor> element;
+            bool end_of_sequence = false;
+            statuses[i] = input->GetNext(ctx, &element, &end_of_sequence);
+            if (!statuses[i].ok() || end_of_sequence) {
+              if (end_of_sequence) {
+                end_of_input.store(true, std::memory_order_relaxed);
+              }
+              stop.store(true, std::memory_order_relaxed);
+              break;
+            }
+            shards[i].push_back(std::move(element));
+          }
+          RecordStop(ctx);
+          counter.DecrementCount();
+        });
+      }
+      RecordStop(ctx);
+      counter.Wait();
+      RecordStart(ctx);
+      for (auto& shard : shards) {
+        for (auto& element : shard) {
+          AddToShuffleBuffer(ctx, std::move(element));
+        }
+      }
+      *end_of_input_sequence = end_of_input.load();
+      for (const Status& status : statuses) {
+        TF_RETURN_IF_ERROR(status);
+      }
+      return OkStatus();
+    }
+
     bool ShouldFillBuffer() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!input_impl_ && dataset()->count_ != -1 &&
           epoch_ >= dataset()->count_) {
@@ -486,6 +570,8 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     std::unique_ptr<std::vector<std::vector<Tensor>>> buffer_
         TF_GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_) = nullptr;
+    // Created on the first parallel fill of the buffer.
+    std::unique_ptr<thread::ThreadPool> fill_thread_pool_ TF_GUARDED_BY(mu_);
     int64_t epoch_ TF_GUARDED_BY(mu_) = 0;
     int64_t num_elements_ TF_GUARDED_BY(mu_) = 0;
     int64_t seed_ TF_GUARDED_BY(mu_) = 0;
@@ -509,6 +595,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
   // fuse shuffle and repeat together, and make the shuffle dataset op
   // responsible for repeating as well.
   const int64_t count_;
+  // Whether the buffer has to be filled in the order of the input. The default
+  // policy requires it.
+  const DeterminismPolicy deterministic_;
   const TraceMeMetadata traceme_metadata_;
   mutable mutex mu_;
   mutable std::vector<std::int64_t> shuffled_indices_ TF_GUARDED_BY(mu_);
@@ -634,8 +723,10 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
  public:
   DatasetV3(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            DeterminismPolicy deterministic)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           deterministic),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -674,12 +765,15 @@ class ShuffleDatasetOp::DatasetV3 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue deterministic;
+    b->BuildAttrValue(deterministic_.String(), &deterministic);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, resource_handle_node},  // Inputs
                       {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
+                                      reshuffle_each_iteration),
+                       std::make_pair(kDeterministic, deterministic)},  // Attrs
                       output));
     return OkStatus();
   }
@@ -756,9 +850,9 @@ void ShuffleDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
     }
 
     // Ownership of manager is transferred onto `DatasetV3`.
-    *output = new ShuffleDatasetOp::DatasetV3(ctx, input, buffer_size, count,
-                                              std::move(seeds), manager,
-                                              std::move(handle), owns_resource);
+    *output = new ShuffleDatasetOp::DatasetV3(
+        ctx, input, buffer_size, count, std::move(seeds), manager,
+        std::move(handle), owns_resource, deterministic_);
   } else if (op_version_ == 2) {
     auto handle = HandleFromInput(ctx, 2);
     SeedGeneratorManager* manager = nullptr;
@@ -883,8 +977,10 @@ class ShuffleAndRepeatDatasetOp::DatasetV2 : public ShuffleDatasetBase {
  public:
   DatasetV2(OpKernelContext* ctx, const DatasetBase* input, int64_t buffer_size,
             int64_t count, RandomSeeds&& seeds, SeedGeneratorManager* manager,
-            ResourceHandle&& resource_handle, bool owns_resource)
-      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count),
+            ResourceHandle&& resource_handle, bool owns_resource,
+            DeterminismPolicy deterministic)
+      : ShuffleDatasetBase(ctx, input, buffer_size, manager->get(), count,
+                           deterministic),
         manager_(manager),
         owns_resource_(owns_resource),
         resource_handle_(std::move(resource_handle)),
@@ -925,12 +1021,15 @@ class ShuffleAndRepeatDatasetOp::DatasetV2 : public ShuffleDatasetBase {
     AttrValue reshuffle_each_iteration;
     b->BuildAttrValue(seed_generator_->reshuffle_each_iteration(),
                       &reshuffle_each_iteration);
+    AttrValue deterministic;
+    b->BuildAttrValue(deterministic_.String(), &deterministic);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this,
                       {input_graph_node, buffer_size_node, seed_node,
                        seed2_node, count_node, resource_handle_node},  // Inputs
                       {std::make_pair(kReshuffleEachIteration,
-                                      reshuffle_each_iteration)},  // Attrs
+                                      reshuffle_each_iteration),
+                       std::make_pair(kDeterministic, deterministic)},  // Attrs
                       output));
     return OkStatus();
   }
@@ -1017,7 +1116,7 @@ void ShuffleAndRepeatDatasetOp::MakeDataset(OpKernelContext* ctx,
     // Ownership of manager is transferred onto `DatasetV2`.
     *output = new ShuffleAndRepeatDatasetOp::DatasetV2(
         ctx, input, buffer_size, count, std::move(seeds), manager,
-        std::move(handle), owns_resource);
+        std::move(handle), owns_resource, deterministic_);
   } else {
     if (op_version_ != 1) {
       LOG(WARNING) << "Unsupported version of shuffle dataset op: "
@@ -90,7 +90,7 @@ class ShuffleDatasetParams : public DatasetParams {
 
   int64_t count() const { return count_; }
 
- private:
+ protected:
   int64_t buffer_size_;
   int64_t seed_;
   int64_t seed2_;
@@ -98,6 +98,54 @@ class ShuffleDatasetParams : public DatasetParams {
   bool reshuffle_each_iteration_;
 };
 
+// Parameters for `ShuffleDatasetV3`, which takes a seed generator resource and
+// a `deterministic` attribute.
+class ShuffleDatasetV3Params : public ShuffleDatasetParams {
+ public:
+  template <typename T>
+  ShuffleDatasetV3Params(T input_dataset_params, int64_t buffer_size,
+                         int64_t seed, int64_t seed2,
+                         std::string deterministic,
+                         DataTypeVector output_dtypes,
+                         std::vector<PartialTensorShape> output_shapes,
+                         string node_name)
+      : ShuffleDatasetParams(std::move(input_dataset_params), buffer_size,
+                             seed, seed2, /*count=*/1,
+                             /*reshuffle_each_iteration=*/false,
+                             std::move(output_dtypes), std::move(output_shapes),
+                             std::move(node_name)),
+        deterministic_(std::move(deterministic)) {
+    op_version_ = 3;
+  }
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> input_tensors =
+        ShuffleDatasetParams::GetInputTensors();
+    // A handle to a resource that does not exist, so that the dataset creates
+    // its own seed generator.
+    Tensor handle(DT_RESOURCE, TensorShape({}));
+    handle.scalar<ResourceHandle>()() = ResourceHandle();
+    input_tensors.push_back(std::move(handle));
+    return input_tensors;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    TF_RETURN_IF_ERROR(ShuffleDatasetParams::GetInputNames(input_names));
+    input_names->emplace_back("seed_generator");
+    return OkStatus();
+  }
+
+  Status GetAttributes(AttributeVector* attr_vector) const override {
+    TF_RETURN_IF_ERROR(ShuffleDatasetParams::GetAttributes(attr_vector));
+    attr_vector->emplace_back(ShuffleDatasetOpBase::kDeterministic,
+                              deterministic_);
+    return OkStatus();
+  }
+
+ private:
+  std::string deterministic_;
+};
+
 class ShuffleDatasetOpTest : public DatasetOpsTestBase {};
 
 // Test case 1: test shuffle_dataset with reshuffle_each_iteration = false.
@@ -554,6 +602,38 @@ INSTANTIATE_TEST_CASE_P(ShuffleDatasetOpTest,
                         ParameterizedIteratorSaveAndRestoreTest,
                         ::testing::ValuesIn(IteratorSaveAndRestoreTestCases()));
 
+TEST_F(ShuffleDatasetOpTest, NondeterministicParallelFill) {
+  // The buffer is large enough to be filled on multiple threads.
+  constexpr int64_t kNumElements = 5000;
+  ShuffleDatasetV3Params dataset_params(
+      RangeDatasetParams(0, kNumElements, 1),
+      /*buffer_size=*/2000,
+      /*seed=*/1,
+      /*seed2=*/2,
+      /*deterministic=*/"false",
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({})},
+      /*node_name=*/kShuffleNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+
+  std::vector<Tensor> out_tensors;
+  bool end_of_sequence = false;
+  while (!end_of_sequence) {
+    std::vector<Tensor> next;
+    TF_ASSERT_OK(
+        iterator_->GetNext(iterator_ctx_.get(), &next, &end_of_sequence));
+    out_tensors.insert(out_tensors.end(), next.begin(), next.end());
+  }
+
+  // Every input element is produced exactly once.
+  std::vector<Tensor> expected_outputs;
+  for (int64_t i = 0; i < kNumElements; ++i) {
+    expected_outputs.push_back(CreateTensor<int64_t>(TensorShape({}), {i}));
+  }
+  TF_EXPECT_OK(ExpectEqual(out_tensors, expected_outputs,
+                           /*compare_order=*/false));
+}
+
 TEST_F(ShuffleDatasetOpTest, InvalidArguments) {
   std::vector<ShuffleDatasetParams> dataset_params_vec(
       {ShuffleDatasetParamsWithInvalidBufferSize(),
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/data/name_utils.h"
+#include "tensorflow/core/data/readahead_file.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -25,6 +28,8 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -43,6 +48,32 @@ constexpr char kGcsFsPrefix[] = "gs://";
 constexpr char kS3FsPrefix[] = "s3://";
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// The number of blocks of each file that are read ahead. 0 disables
+// read-ahead.
+constexpr char kReadAheadBlocksEnvVar[] = "TF_DATA_TFRECORD_READAHEAD_BLOCKS";
+// The read-ahead block size if the dataset does not buffer its reads.
+constexpr int64_t kDefaultReadAheadBlockSize = 256 << 10;  // 256KB.
+constexpr int kReadAheadThreads = 64;
+
+int64_t ReadAheadBlocks() {
+  static const int64_t readahead_blocks = []() {
+    int64_t blocks = 0;
+    Status s = ReadInt64FromEnvVar(kReadAheadBlocksEnvVar, 0, &blocks);
+    if (!s.ok()) {
+      LOG(WARNING) << "Ignoring " << kReadAheadBlocksEnvVar << ": " << s;
+      return int64_t{0};
+    }
+    return std::max(blocks, int64_t{0});
+  }();
+  return readahead_blocks;
+}
+
+// Shared by all files that are read ahead, which mostly wait for I/O.
+thread::ThreadPool* ReadAheadThreadPool() {
+  static thread::ThreadPool* thread_pool = new thread::ThreadPool(
+      Env::Default(), "tf_record_readahead", kReadAheadThreads);
+  return thread_pool;
+}
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -60,7 +91,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+            compression_type)),
+        readahead_blocks_(ReadAheadBlocks()) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
@@ -250,14 +282,25 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
           TranslateFileName(dataset()->filenames_[current_file_index_]),
           &file_));
+      RandomAccessFile* file = file_.get();
+      if (dataset()->readahead_blocks_ > 0) {
+        const int64_t block_size = dataset()->options_.buffer_size > 0
+                                       ? dataset()->options_.buffer_size
+                                       : kDefaultReadAheadBlockSize;
+        readahead_file_ = std::make_unique<ReadAheadFile>(
+            file, ReadAheadThreadPool(), block_size,
+            dataset()->readahead_blocks_);
+        file = readahead_file_.get();
+      }
       reader_ = std::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+          file, dataset()->options_);
       return OkStatus();
     }
 
     // Resets all reader streams.
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
+      readahead_file_.reset();
       file_.reset();
     }
 
@@ -265,14 +308,17 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
 
     // `reader_` will borrow the object that `file_` points to, so
-    // we must destroy `reader_` before `file_`.
+    // we must destroy `reader_` before `file_`. The same goes for
+    // `readahead_file_`, which reads from `file_` when read-ahead is enabled.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<RandomAccessFile> readahead_file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
   };
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  const int64_t readahead_blocks_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
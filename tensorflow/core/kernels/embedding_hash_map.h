@@ -0,0 +1,471 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_EMBEDDING_HASH_MAP_H_
+#define TENSORFLOW_CORE_KERNELS_EMBEDDING_HASH_MAP_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A hash map from integer ids to fixed-size vectors, meant for embedding
+// tables of sparse id features with more distinct ids than fit in memory.
+//
+// Entries are stored in open-addressing slots with linear probing, each slot
+// holding the key, its access statistics and the vector inline. Slots are
+// padded so that none straddles a cache line, so a lookup touches as few
+// lines as the vector needs. Unlike MutableDenseHashTable no empty or deleted
+// key is reserved: deletion shifts the following entries back instead of
+// leaving tombstones.
+//
+// The map is split by key hash into shards, each guarded by its own mutex and
+// growing independently. Finds take their shard's lock in shared mode.
+//
+// If `max_memory_bytes` is set, a shard that cannot grow without exceeding
+// its share of the budget makes room for a new key by evicting an entry: the
+// least recently (kLru) or least frequently (kLfu) found one among a small
+// sample of entries, which approximates true LRU/LFU at constant cost.
+//
+// Shards can be exported one at a time, so that checkpointing a large map
+// copies and locks a bounded part of it at once.
+template <class K, class V>
+class EmbeddingHashMap {
+ public:
+  static_assert(std::is_integral<K>::value, "Keys must be integers");
+  static_assert(std::is_trivially_copyable<V>::value,
+                "Values must be trivially copyable");
+
+  enum class EvictionPolicy { kLru, kLfu };
+
+  struct Options {
+    // The number of elements of each value.
+    int64_t value_dim = 1;
+
+    int num_shards = 16;
+
+    // The initial number of slots of each shard. Must be a power of 2.
+    int64_t initial_slots_per_shard = 64;
+
+    // The most memory the slots of all shards may take, or 0 for no limit.
+    int64_t max_memory_bytes = 0;
+
+    EvictionPolicy eviction_policy = EvictionPolicy::kLru;
+  };
+
+  static Status Create(const Options& options,
+                       std::unique_ptr<EmbeddingHashMap>* map) {
+    if (options.value_dim <= 0) {
+      return errors::InvalidArgument("value_dim must be positive, got: ",
+                                     options.value_dim);
+    }
+    if (options.num_shards <= 0) {
+      return errors::InvalidArgument("num_shards must be positive, got: ",
+                                     options.num_shards);
+    }
+    const int64_t slots = options.initial_slots_per_shard;
+    if (slots < kMinSlots || (slots & (slots - 1)) != 0) {
+      return errors::InvalidArgument(
+          "initial_slots_per_shard must be a power of 2 of at least ",
+          kMinSlots, ", got: ", slots);
+    }
+    if (options.max_memory_bytes < 0) {
+      return errors::InvalidArgument(
+          "max_memory_bytes must not be negative, got: ",
+          options.max_memory_bytes);
+    }
+    const int64_t min_bytes =
+        options.num_shards * slots * SlotBytes(options.value_dim);
+    if (options.max_memory_bytes > 0 && options.max_memory_bytes < min_bytes) {
+      return errors::InvalidArgument(
+          "max_memory_bytes must allow for the initial slots of all shards (",
+          min_bytes, " bytes), got: ", options.max_memory_bytes);
+    }
+    map->reset(new EmbeddingHashMap(options));
+    return OkStatus();
+  }
+
+  ~EmbeddingHashMap() {
+    for (int s = 0; s < num_shards(); ++s) {
+      mutex_lock l(shards_[s].mu);
+      port::AlignedFree(shards_[s].slots);
+    }
+  }
+
+  int num_shards() const { return options_.num_shards; }
+  int64_t value_dim() const { return options_.value_dim; }
+
+  // Returns the shard holding `key`.
+  int ShardOf(K key) const { return (HashKey(key) >> 32) % num_shards(); }
+
+  // Copies the value of `key` to `value`, which must have room for
+  // `value_dim()` elements, and returns true. Returns false if `key` is not in
+  // the map.
+  bool Find(K key, V* value) const {
+    const uint64 hash = HashKey(key);
+    const Shard& shard = shards_[ShardOf(key)];
+    tf_shared_lock l(shard.mu);
+    const int64_t slot = FindSlot(shard, key, hash);
+    if (slot < 0) return false;
+    char* data = SlotAt(shard, slot);
+    RecordAccess(shard, Header(data));
+    std::memcpy(value, ValueOf(data), value_bytes_);
+    return true;
+  }
+
+  // Sets the value of `key` to the `value_dim()` elements at `value`, evicting
+  // another entry of its shard if needed to stay within the memory budget.
+  void Insert(K key, const V* value) {
+    const uint64 hash = HashKey(key);
+    Shard& shard = shards_[ShardOf(key)];
+    mutex_lock l(shard.mu);
+    int64_t slot = FindSlot(shard, key, hash);
+    if (slot < 0) {
+      if ((shard.size + 1) * kMaxLoadDenominator >
+          shard.num_slots * kMaxLoadNumerator) {
+        if (CanGrow(shard)) {
+          Resize(shard, shard.num_slots * 2);
+        } else {
+          EvictOne(shard);
+        }
+      }
+      slot = EmptySlotFor(shard, hash);
+      SlotHeader* header = Header(SlotAt(shard, slot));
+      header->key = key;
+      header->occupied = 1;
+      header->stat.store(InitialStat(shard), std::memory_order_relaxed);
+      ++shard.size;
+    }
+    char* data = SlotAt(shard, slot);
+    std::memcpy(ValueOf(data), value, value_bytes_);
+  }
+
+  // Removes `key` from the map. Returns false if it was not in the map.
+  bool Remove(K key) {
+    const uint64 hash = HashKey(key);
+    Shard& shard = shards_[ShardOf(key)];
+    mutex_lock l(shard.mu);
+    const int64_t slot = FindSlot(shard, key, hash);
+    if (slot < 0) return false;
+    EraseSlot(shard, slot);
+    return true;
+  }
+
+  // Removes all entries and releases the memory of grown shards.
+  void Clear() {
+    for (int s = 0; s < num_shards(); ++s) {
+      Shard& shard = shards_[s];
+      mutex_lock l(shard.mu);
+      port::AlignedFree(shard.slots);
+      Allocate(shard, options_.initial_slots_per_shard);
+      shard.size = 0;
+    }
+  }
+
+  int64_t size() const {
+    int64_t size = 0;
+    for (int s = 0; s < num_shards(); ++s) {
+      size += ShardSize(s);
+    }
+    return size;
+  }
+
+  int64_t ShardSize(int shard) const {
+    tf_shared_lock l(shards_[shard].mu);
+    return shards_[shard].size;
+  }
+
+  // The number of bytes taken by the slots of all shards.
+  int64_t MemoryUsed() const {
+    int64_t bytes = 0;
+    for (int s = 0; s < num_shards(); ++s) {
+      tf_shared_lock l(shards_[s].mu);
+      bytes += shards_[s].num_slots * slot_bytes_;
+    }
+    return bytes;
+  }
+
+  // The number of entries evicted to stay within the memory budget.
+  int64_t num_evictions() const {
+    return num_evictions_.load(std::memory_order_relaxed);
+  }
+
+  // Appends the keys of shard `shard` to `keys` and their values to `values`,
+  // holding only that shard's lock.
+  void ExportShard(int shard, std::vector<K>* keys,
+                   std::vector<V>* values) const {
+    const Shard& s = shards_[shard];
+    tf_shared_lock l(s.mu);
+    keys->reserve(keys->size() + s.size);
+    values->reserve(values->size() + s.size * value_dim());
+    for (int64_t i = 0; i < s.num_slots; ++i) {
+      const char* data = SlotAt(s, i);
+      const SlotHeader* header = Header(data);
+      if (!header->occupied) continue;
+      keys->push_back(header->key);
+      const V* value = reinterpret_cast<const V*>(data + value_offset_);
+      values->insert(values->end(), value, value + value_dim());
+    }
+  }
+
+ private:
+  // The header of each slot. `stat` is the shard's clock at the last access
+  // for kLru and the number of accesses for kLfu. Finds update it with relaxed
+  // atomics while holding the shard's lock in shared mode.
+  struct SlotHeader {
+    K key;
+    uint32 occupied;
+    std::atomic<uint32> stat;
+  };
+
+  struct Shard {
+    mutable mutex mu;
+    char* slots TF_GUARDED_BY(mu) = nullptr;
+    int64_t num_slots TF_GUARDED_BY(mu) = 0;
+    int64_t size TF_GUARDED_BY(mu) = 0;
+    // Advances on every insert, and so orders the accesses seen by kLru.
+    mutable std::atomic<uint32> clock{0};
+    // State of the generator picking where eviction samples start.
+    uint64 rng TF_GUARDED_BY(mu) = 0x9E3779B97F4A7C15ull;
+  };
+
+  static constexpr int64_t kCacheLineBytes = 64;
+  static constexpr int64_t kMinSlots = 8;
+  // Shards grow, or evict, when more than 3/4 of their slots are used.
+  static constexpr int64_t kMaxLoadNumerator = 3;
+  static constexpr int64_t kMaxLoadDenominator = 4;
+  // The number of entries sampled to pick the one to evict.
+  static constexpr int kEvictionSamples = 8;
+
+  static int64_t ValueOffset() {
+    return (sizeof(SlotHeader) + alignof(V) - 1) / alignof(V) * alignof(V);
+  }
+
+  // Slots smaller than a cache line are rounded up to a power of 2 so that
+  // they tile lines exactly, larger ones to a whole number of lines.
+  static int64_t SlotBytes(int64_t value_dim) {
+    const int64_t bytes = ValueOffset() + value_dim * sizeof(V);
+    if (bytes >= kCacheLineBytes) {
+      return (bytes + kCacheLineBytes - 1) / kCacheLineBytes * kCacheLineBytes;
+    }
+    int64_t rounded = alignof(SlotHeader);
+    while (rounded < bytes) rounded *= 2;
+    return rounded;
+  }
+
+  // Finalizer of MurmurHash3, so that sequential ids spread over shards and
+  // slots. Shards use the high bits and slots the low bits.
+  static uint64 HashKey(K key) {
+    uint64 h = static_cast<uint64>(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+  }
+
+  explicit EmbeddingHashMap(const Options& options)
+      : options_(options),
+        value_offset_(ValueOffset()),
+        value_bytes_(options.value_dim * sizeof(V)),
+        slot_bytes_(SlotBytes(options.value_dim)),
+        max_shard_bytes_(options.max_memory_bytes / options.num_shards),
+        shards_(new Shard[options.num_shards]) {
+    for (int s = 0; s < num_shards(); ++s) {
+      mutex_lock l(shards_[s].mu);
+      Allocate(shards_[s], options_.initial_slots_per_shard);
+    }
+  }
+
+  // Points `shard` to `num_slots` new, empty slots.
+  void Allocate(Shard& shard, int64_t num_slots)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    shard.slots = static_cast<char*>(
+        port::AlignedMalloc(num_slots * slot_bytes_, kCacheLineBytes));
+    std::memset(shard.slots, 0, num_slots * slot_bytes_);
+    for (int64_t i = 0; i < num_slots; ++i) {
+      new (shard.slots + i * slot_bytes_) SlotHeader();
+    }
+    shard.num_slots = num_slots;
+  }
+
+  char* SlotAt(const Shard& shard, int64_t slot) const
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) {
+    return shard.slots + slot * slot_bytes_;
+  }
+
+  static SlotHeader* Header(char* data) {
+    return reinterpret_cast<SlotHeader*>(data);
+  }
+  static const SlotHeader* Header(const char* data) {
+    return reinterpret_cast<const SlotHeader*>(data);
+  }
+  char* ValueOf(char* data) const { return data + value_offset_; }
+
+  // Returns the slot of `key`, or -1 if it is not in `shard`.
+  int64_t FindSlot(const Shard& shard, K key, uint64 hash) const
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) {
+    const int64_t mask = shard.num_slots - 1;
+    for (int64_t i = hash & mask;; i = (i + 1) & mask) {
+      const SlotHeader* header = Header(SlotAt(shard, i));
+      if (!header->occupied) return -1;
+      if (header->key == key) return i;
+    }
+  }
+
+  // Returns the first free slot of the probe sequence of `hash`.
+  int64_t EmptySlotFor(const Shard& shard, uint64 hash) const
+      TF_SHARED_LOCKS_REQUIRED(shard.mu) {
+    const int64_t mask = shard.num_slots - 1;
+    int64_t i = hash & mask;
+    while (Header(SlotAt(shard, i))->occupied) i = (i + 1) & mask;
+    return i;
+  }
+
+  uint32 InitialStat(const Shard& shard) const {
+    if (options_.eviction_policy == EvictionPolicy::kLfu) return 1;
+    return shard.clock.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  void RecordAccess(const Shard& shard, SlotHeader* header) const {
+    if (options_.eviction_policy == EvictionPolicy::kLfu) {
+      const uint32 count = header->stat.load(std::memory_order_relaxed);
+      if (count != ~uint32{0}) {
+        header->stat.store(count + 1, std::memory_order_relaxed);
+      }
+    } else {
+      header->stat.store(shard.clock.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+    }
+  }
+
+  bool CanGrow(const Shard& shard) const TF_SHARED_LOCKS_REQUIRED(shard.mu) {
+    return max_shard_bytes_ == 0 ||
+           shard.num_slots * 2 * slot_bytes_ <= max_shard_bytes_;
+  }
+
+  void Resize(Shard& shard, int64_t num_slots)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    char* old_slots = shard.slots;
+    const int64_t old_num_slots = shard.num_slots;
+    Allocate(shard, num_slots);
+    for (int64_t i = 0; i < old_num_slots; ++i) {
+      char* data = old_slots + i * slot_bytes_;
+      const SlotHeader* header = Header(data);
+      if (!header->occupied) continue;
+      char* target = SlotAt(shard, EmptySlotFor(shard, HashKey(header->key)));
+      MoveSlot(data, target);
+    }
+    port::AlignedFree(old_slots);
+  }
+
+  void MoveSlot(char* from, char* to) const {
+    SlotHeader* from_header = Header(from);
+    SlotHeader* to_header = Header(to);
+    to_header->key = from_header->key;
+    to_header->occupied = 1;
+    to_header->stat.store(from_header->stat.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    std::memcpy(ValueOf(to), ValueOf(from), value_bytes_);
+  }
+
+  // Removes the entry of `slot`, moving back the entries after it whose probe
+  // sequence passes through it so that lookups still find them.
+  void EraseSlot(Shard& shard, int64_t slot)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    const int64_t mask = shard.num_slots - 1;
+    int64_t hole = slot;
+    for (int64_t i = (hole + 1) & mask;; i = (i + 1) & mask) {
+      char* data = SlotAt(shard, i);
+      const SlotHeader* header = Header(data);
+      if (!header->occupied) break;
+      const int64_t home = HashKey(header->key) & mask;
+      // The entry can move to the hole if its home slot is not cyclically
+      // within (hole, i].
+      const bool home_in_range =
+          hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+      if (!home_in_range) {
+        MoveSlot(data, SlotAt(shard, hole));
+        hole = i;
+      }
+    }
+    Header(SlotAt(shard, hole))->occupied = 0;
+    --shard.size;
+  }
+
+  // Evicts the entry with the smallest access statistic among
+  // kEvictionSamples entries following a pseudo-random slot.
+  void EvictOne(Shard& shard) TF_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    if (shard.size == 0) return;
+    shard.rng ^= shard.rng << 13;
+    shard.rng ^= shard.rng >> 7;
+    shard.rng ^= shard.rng << 17;
+    const int64_t mask = shard.num_slots - 1;
+    int64_t victim = -1;
+    uint32 victim_stat = 0;
+    int sampled = 0;
+    for (int64_t i = shard.rng & mask; sampled < kEvictionSamples &&
+                                       sampled < shard.size;
+         i = (i + 1) & mask) {
+      const SlotHeader* header = Header(SlotAt(shard, i));
+      if (!header->occupied) continue;
+      const uint32 stat = header->stat.load(std::memory_order_relaxed);
+      if (victim < 0 || StatIsOlder(shard, stat, victim_stat)) {
+        victim = i;
+        victim_stat = stat;
+      }
+      ++sampled;
+    }
+    EraseSlot(shard, victim);
+    num_evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Returns true if an entry with statistic `a` should be evicted before one
+  // with `b`. kLru compares clock values relative to the current clock, so
+  // that comparisons stay right when the clock wraps around.
+  bool StatIsOlder(const Shard& shard, uint32 a, uint32 b) const {
+    if (options_.eviction_policy == EvictionPolicy::kLfu) return a < b;
+    const uint32 now = shard.clock.load(std::memory_order_relaxed);
+    return now - a > now - b;
+  }
+
+  const Options options_;
+  const int64_t value_offset_;
+  const int64_t value_bytes_;
+  const int64_t slot_bytes_;
+  const int64_t max_shard_bytes_;
+  std::unique_ptr<Shard[]> shards_;
+  std::atomic<int64_t> num_evictions_{0};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(EmbeddingHashMap);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_EMBEDDING_HASH_MAP_H_
@@ -0,0 +1,209 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/embedding_hash_map.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using Map = EmbeddingHashMap<int64_t, float>;
+
+constexpr int kValueDim = 4;
+
+std::unique_ptr<Map> CreateMap(Map::Options options) {
+  options.value_dim = kValueDim;
+  std::unique_ptr<Map> map;
+  TF_CHECK_OK(Map::Create(options, &map));
+  return map;
+}
+
+void Insert(Map& map, int64_t key) {
+  std::vector<float> value(kValueDim, static_cast<float>(key));
+  map.Insert(key, value.data());
+}
+
+// Returns true if `key` is in `map` with the value inserted by Insert().
+bool Contains(const Map& map, int64_t key) {
+  std::vector<float> value(kValueDim);
+  if (!map.Find(key, value.data())) return false;
+  EXPECT_EQ(value, std::vector<float>(kValueDim, static_cast<float>(key)));
+  return true;
+}
+
+// Returns the most bytes a single-shard map can use without growing past
+// `num_slots` slots.
+int64_t BudgetForSlots(int64_t num_slots) {
+  Map::Options options;
+  options.num_shards = 1;
+  options.initial_slots_per_shard = num_slots;
+  return CreateMap(options)->MemoryUsed();
+}
+
+TEST(EmbeddingHashMapTest, InsertFindRemove) {
+  std::unique_ptr<Map> map = CreateMap(Map::Options());
+  for (int64_t key = 0; key < 10000; ++key) {
+    Insert(*map, key);
+  }
+  EXPECT_EQ(map->size(), 10000);
+  for (int64_t key = 0; key < 10000; key += 2) {
+    EXPECT_TRUE(map->Remove(key));
+  }
+  EXPECT_FALSE(map->Remove(0));
+  EXPECT_EQ(map->size(), 5000);
+  for (int64_t key = 0; key < 10000; ++key) {
+    EXPECT_EQ(Contains(*map, key), key % 2 == 1) << key;
+  }
+  EXPECT_EQ(map->num_evictions(), 0);
+}
+
+TEST(EmbeddingHashMapTest, InsertOverwrites) {
+  std::unique_ptr<Map> map = CreateMap(Map::Options());
+  std::vector<float> value(kValueDim, 1.0);
+  map->Insert(7, value.data());
+  Insert(*map, 7);
+  EXPECT_EQ(map->size(), 1);
+  EXPECT_TRUE(Contains(*map, 7));
+}
+
+TEST(EmbeddingHashMapTest, ClearReleasesMemory) {
+  std::unique_ptr<Map> map = CreateMap(Map::Options());
+  const int64_t initial_bytes = map->MemoryUsed();
+  for (int64_t key = 0; key < 10000; ++key) {
+    Insert(*map, key);
+  }
+  EXPECT_GT(map->MemoryUsed(), initial_bytes);
+  map->Clear();
+  EXPECT_EQ(map->size(), 0);
+  EXPECT_EQ(map->MemoryUsed(), initial_bytes);
+  EXPECT_FALSE(Contains(*map, 1));
+}
+
+TEST(EmbeddingHashMapTest, StaysWithinMemoryBudget) {
+  Map::Options options;
+  options.num_shards = 4;
+  options.initial_slots_per_shard = 16;
+  options.max_memory_bytes = 4 * BudgetForSlots(64);
+  std::unique_ptr<Map> map = CreateMap(options);
+  for (int64_t key = 0; key < 10000; ++key) {
+    Insert(*map, key);
+    ASSERT_LE(map->MemoryUsed(), options.max_memory_bytes);
+  }
+  // Each shard holds at most 3/4 of its 64 slots.
+  EXPECT_LE(map->size(), 4 * 48);
+  EXPECT_EQ(map->num_evictions(), 10000 - map->size());
+  // The most recent key is never evicted.
+  EXPECT_TRUE(Contains(*map, 9999));
+}
+
+// Fills a single shard of 64 slots with keys [0, 48), finds keys [0, 24)
+// `num_finds` times each, then inserts 24 new keys. Returns how many of the
+// found keys, and of the other keys, survived.
+std::pair<int, int> SurvivorsAfterEviction(Map::EvictionPolicy policy,
+                                           int num_finds) {
+  Map::Options options;
+  options.num_shards = 1;
+  options.initial_slots_per_shard = 64;
+  options.max_memory_bytes = BudgetForSlots(64);
+  options.eviction_policy = policy;
+  std::unique_ptr<Map> map = CreateMap(options);
+  for (int64_t key = 0; key < 48; ++key) {
+    Insert(*map, key);
+  }
+  for (int i = 0; i < num_finds; ++i) {
+    for (int64_t key = 0; key < 24; ++key) {
+      EXPECT_TRUE(Contains(*map, key));
+    }
+  }
+  for (int64_t key = 48; key < 72; ++key) {
+    Insert(*map, key);
+  }
+  EXPECT_EQ(map->size(), 48);
+  EXPECT_EQ(map->num_evictions(), 24);
+
+  std::pair<int, int> survivors(0, 0);
+  for (int64_t key = 0; key < 48; ++key) {
+    if (Contains(*map, key)) {
+      ++(key < 24 ? survivors.first : survivors.second);
+    }
+  }
+  return survivors;
+}
+
+TEST(EmbeddingHashMapTest, LruEvictsLeastRecentlyFound) {
+  std::pair<int, int> survivors =
+      SurvivorsAfterEviction(Map::EvictionPolicy::kLru, /*num_finds=*/1);
+  EXPECT_GT(survivors.first, survivors.second);
+}
+
+TEST(EmbeddingHashMapTest, LfuEvictsLeastFrequentlyFound) {
+  std::pair<int, int> survivors =
+      SurvivorsAfterEviction(Map::EvictionPolicy::kLfu, /*num_finds=*/3);
+  EXPECT_GT(survivors.first, survivors.second);
+}
+
+TEST(EmbeddingHashMapTest, ExportShard) {
+  Map::Options options;
+  options.num_shards = 3;
+  std::unique_ptr<Map> map = CreateMap(options);
+  for (int64_t key = 0; key < 100; ++key) {
+    Insert(*map, key);
+  }
+
+  std::vector<int64_t> keys;
+  std::vector<float> values;
+  for (int shard = 0; shard < map->num_shards(); ++shard) {
+    const size_t num_keys = keys.size();
+    map->ExportShard(shard, &keys, &values);
+    EXPECT_EQ(keys.size() - num_keys, map->ShardSize(shard));
+    for (size_t i = num_keys; i < keys.size(); ++i) {
+      EXPECT_EQ(map->ShardOf(keys[i]), shard);
+    }
+  }
+  ASSERT_EQ(keys.size(), 100);
+  ASSERT_EQ(values.size(), 100 * kValueDim);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_EQ(values[i * kValueDim], static_cast<float>(keys[i]));
+  }
+  std::sort(keys.begin(), keys.end());
+  for (int64_t key = 0; key < 100; ++key) {
+    EXPECT_EQ(keys[key], key);
+  }
+}
+
+TEST(EmbeddingHashMapTest, InvalidOptions) {
+  std::unique_ptr<Map> map;
+  Map::Options options;
+  options.initial_slots_per_shard = 100;
+  EXPECT_FALSE(Map::Create(options, &map).ok());
+
+  options = Map::Options();
+  options.max_memory_bytes = 1;
+  EXPECT_FALSE(Map::Create(options, &map).ok());
+
+  options = Map::Options();
+  options.value_dim = 0;
+  EXPECT_FALSE(Map::Create(options, &map).ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
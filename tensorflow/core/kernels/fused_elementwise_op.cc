@@ -0,0 +1,268 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the _FusedElementwise op, which Grappler's remapper creates from
+// chains of element-wise ops. Every op of the chain is applied to a block of
+// elements before moving on to the next block, so the intermediate results
+// stay in cache and the chain makes a single pass over memory.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+enum class FusedElementwiseOp {
+  kAbs,
+  kExp,
+  kLog,
+  kNeg,
+  kReciprocal,
+  kRelu,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+  // Binary ops, whose second input is the next tensor in `args`.
+  kAdd,
+  kMaximum,
+  kMinimum,
+  kMul,
+  kRealDiv,
+  kSub,
+};
+
+bool IsBinary(FusedElementwiseOp op) {
+  return op >= FusedElementwiseOp::kAdd;
+}
+
+bool ParseFusedElementwiseOp(const string& name, FusedElementwiseOp* op) {
+  static const auto* ops =
+      new absl::flat_hash_map<string, FusedElementwiseOp>({
+          {"Abs", FusedElementwiseOp::kAbs},
+          {"Exp", FusedElementwiseOp::kExp},
+          {"Log", FusedElementwiseOp::kLog},
+          {"Neg", FusedElementwiseOp::kNeg},
+          {"Reciprocal", FusedElementwiseOp::kReciprocal},
+          {"Relu", FusedElementwiseOp::kRelu},
+          {"Rsqrt", FusedElementwiseOp::kRsqrt},
+          {"Sigmoid", FusedElementwiseOp::kSigmoid},
+          {"Sqrt", FusedElementwiseOp::kSqrt},
+          {"Square", FusedElementwiseOp::kSquare},
+          {"Tanh", FusedElementwiseOp::kTanh},
+          {"Add", FusedElementwiseOp::kAdd},
+          {"AddV2", FusedElementwiseOp::kAdd},
+          {"Maximum", FusedElementwiseOp::kMaximum},
+          {"Minimum", FusedElementwiseOp::kMinimum},
+          {"Mul", FusedElementwiseOp::kMul},
+          {"RealDiv", FusedElementwiseOp::kRealDiv},
+          {"Sub", FusedElementwiseOp::kSub},
+      });
+  auto it = ops->find(name);
+  if (it == ops->end()) return false;
+  *op = it->second;
+  return true;
+}
+
+// Elements processed by every op of the chain before moving on to the next
+// block. The block of the output and of each argument fit in the L1 cache.
+constexpr int64_t kBlockSize = 1024;
+
+}  // namespace
+
+template <typename T>
+class FusedElementwiseOpKernel : public OpKernel {
+ public:
+  explicit FusedElementwiseOpKernel(OpKernelConstruction* context)
+      : OpKernel(context) {
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    OP_REQUIRES(context, !fused_ops.empty(),
+                errors::InvalidArgument("fused_ops must not be empty"));
+
+    int num_binary_ops = 0;
+    for (const string& name : fused_ops) {
+      FusedElementwiseOp op;
+      OP_REQUIRES(context, ParseFusedElementwiseOp(name, &op),
+                  errors::Unimplemented("Unsupported fused op: ", name));
+      ops_.push_back(op);
+      if (IsBinary(op)) ++num_binary_ops;
+    }
+    OP_REQUIRES(context, num_binary_ops == num_args,
+                errors::InvalidArgument(
+                    "Fused ops must have one argument per binary op, got ",
+                    num_args, " arguments for ", num_binary_ops,
+                    " binary ops"));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    OpInputList args;
+    OP_REQUIRES_OK(context, context->input_list("args", &args));
+    for (int i = 0; i < args.size(); ++i) {
+      OP_REQUIRES(
+          context,
+          TensorShapeUtils::IsScalar(args[i].shape()) ||
+              args[i].shape() == x.shape(),
+          errors::InvalidArgument("Argument ", i,
+                                  " must be a scalar or have the shape of x ",
+                                  x.shape().DebugString(), ", got ",
+                                  args[i].shape().DebugString()));
+    }
+
+    // x is only forwarded if no other tensor, such as one of the arguments,
+    // shares its buffer, which matters since the output is overwritten op by
+    // op.
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    const int64_t num_elements = x.NumElements();
+    if (num_elements == 0) return;
+
+    const T* x_data = x.flat<T>().data();
+    T* y_data = y->flat<T>().data();
+    const int64_t num_blocks = (num_elements + kBlockSize - 1) / kBlockSize;
+    const auto compute_blocks = [&](int64_t first, int64_t last) {
+      for (int64_t block = first; block < last; ++block) {
+        const int64_t start = block * kBlockSize;
+        const int64_t size = std::min(kBlockSize, num_elements - start);
+        ComputeBlock(x_data, args, start, size, y_data);
+      }
+    };
+    // A rough cost of each op, per element, in cycles.
+    const int64_t cost_per_block = kBlockSize * 5 * ops_.size();
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          cost_per_block, compute_blocks);
+  }
+
+ private:
+  using Block = Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>>;
+  using ConstBlock =
+      Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>>;
+
+  void ComputeBlock(const T* x_data, const OpInputList& args, int64_t start,
+                    int64_t size, T* y_data) const {
+    Block y(y_data + start, size);
+    y = ConstBlock(x_data + start, size);
+    int arg_index = 0;
+    for (FusedElementwiseOp op : ops_) {
+      if (IsBinary(op)) {
+        const Tensor& arg = args[arg_index++];
+        if (arg.NumElements() == 1) {
+          ApplyBinary(op, arg.flat<T>()(0), &y);
+        } else {
+          ApplyBinary(op, ConstBlock(arg.flat<T>().data() + start, size), &y);
+        }
+        continue;
+      }
+      switch (op) {
+        case FusedElementwiseOp::kAbs:
+          y = y.abs();
+          break;
+        case FusedElementwiseOp::kExp:
+          y = y.exp();
+          break;
+        case FusedElementwiseOp::kLog:
+          y = y.log();
+          break;
+        case FusedElementwiseOp::kNeg:
+          y = -y;
+          break;
+        case FusedElementwiseOp::kReciprocal:
+          y = y.inverse();
+          break;
+        case FusedElementwiseOp::kRelu:
+          y = y.template cwiseMax<Eigen::PropagateNaN>(static_cast<T>(0));
+          break;
+        case FusedElementwiseOp::kRsqrt:
+          y = y.rsqrt();
+          break;
+        case FusedElementwiseOp::kSigmoid:
+          y = y.sigmoid();
+          break;
+        case FusedElementwiseOp::kSqrt:
+          y = y.sqrt();
+          break;
+        case FusedElementwiseOp::kSquare:
+          y = y.square();
+          break;
+        case FusedElementwiseOp::kTanh:
+          y = y.tanh();
+          break;
+        default:
+          break;
+      }
+    }
+  }
+
+  // Applies the binary `op` to `y` and `arg`, which is either a scalar or a
+  // block of the same size.
+  template <typename Arg, typename Y>
+  static void ApplyBinary(FusedElementwiseOp op, const Arg& arg, Y* y) {
+    switch (op) {
+      case FusedElementwiseOp::kAdd:
+        *y = *y + arg;
+        break;
+      case FusedElementwiseOp::kMaximum:
+        *y = y->template cwiseMax<Eigen::PropagateNaN>(arg);
+        break;
+      case FusedElementwiseOp::kMinimum:
+        *y = y->template cwiseMin<Eigen::PropagateNaN>(arg);
+        break;
+      case FusedElementwiseOp::kMul:
+        *y = *y * arg;
+        break;
+      case FusedElementwiseOp::kRealDiv:
+        *y = *y / arg;
+        break;
+      case FusedElementwiseOp::kSub:
+        *y = *y - arg;
+        break;
+      default:
+        break;
+    }
+  }
+
+  std::vector<FusedElementwiseOp> ops_;
+};
+
+#define REGISTER_CPU(T)                                                       \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOpKernel<T>);
+
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_double(REGISTER_CPU);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
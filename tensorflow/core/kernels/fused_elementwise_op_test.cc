@@ -0,0 +1,102 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status Init(const std::vector<string>& fused_ops, int num_args) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedElementwise")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(num_args, DT_FLOAT))
+                           .Attr("fused_ops", fused_ops)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, Chain) {
+  // Spans several blocks, the last of them partial.
+  const int size = 3000;
+  std::vector<float> x(size), b(size);
+  for (int i = 0; i < size; ++i) {
+    x[i] = (i % 97) / 10.0f - 4.0f;
+    b[i] = (i % 13) / 4.0f - 1.5f;
+  }
+  // tanh(x * 0.5 + b) * 3
+  TF_ASSERT_OK(Init({"Mul", "AddV2", "Tanh", "Mul"}, 3));
+  AddInputFromArray<float>(TensorShape({3, 1000}), x);
+  AddInputFromArray<float>(TensorShape({}), {0.5f});
+  AddInputFromArray<float>(TensorShape({3, 1000}), b);
+  AddInputFromArray<float>(TensorShape({}), {3.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({3, 1000}));
+  for (int i = 0; i < size; ++i) {
+    expected.flat<float>()(i) = std::tanh(x[i] * 0.5f + b[i]) * 3.0f;
+  }
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedElementwiseOpTest, UnaryOps) {
+  TF_ASSERT_OK(Init({"Relu", "Sqrt", "Neg", "Exp"}, 0));
+  AddInputFromArray<float>(TensorShape({4}), {-1.0f, 0.0f, 1.0f, 4.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({4}));
+  test::FillValues<float>(&expected, {1.0f, 1.0f, std::exp(-1.0f),
+                                      std::exp(-2.0f)});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(FusedElementwiseOpTest, NonCommutativeOps) {
+  // (x - a) / b
+  TF_ASSERT_OK(Init({"Sub", "RealDiv"}, 2));
+  AddInputFromArray<float>(TensorShape({3}), {1.0f, 2.0f, 3.0f});
+  AddInputFromArray<float>(TensorShape({3}), {3.0f, 2.0f, 1.0f});
+  AddInputFromArray<float>(TensorShape({}), {2.0f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(DT_FLOAT, TensorShape({3}));
+  test::FillValues<float>(&expected, {-1.0f, 0.0f, 1.0f});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, IncompatibleArgument) {
+  TF_ASSERT_OK(Init({"Mul"}, 1));
+  AddInputFromArray<float>(TensorShape({4}), {1.0f, 2.0f, 3.0f, 4.0f});
+  AddInputFromArray<float>(TensorShape({2}), {1.0f, 2.0f});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(FusedElementwiseOpTest, UnsupportedOp) {
+  EXPECT_TRUE(errors::IsUnimplemented(Init({"Cumsum"}, 0)));
+}
+
+}  // namespace
+}  // namespace tensorflow
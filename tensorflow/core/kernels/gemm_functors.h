@@ -55,6 +55,27 @@ limitations under the License.
 #define USE_CBLAS_GEMM
 #endif
 
+// All of the functors below accept an optional Eigen contraction output kernel
+// (see TensorContraction.h), which is applied to the result of the GEMM before
+// it returns. This lets callers fuse cheap element-wise epilogues such as
+// BiasAdd and Relu into the matrix multiply. Since the matrices are row major,
+// the output kernel sees them the way Eigen's row major contractions present
+// them: with swapped arguments, so the rows of the output mapper are the
+// columns of c.
+//
+// Applies `output_kernel` to all of c at once, for GEMM implementations that
+// can't apply it per tile.
+template <class T3, class OutputKernel>
+void ApplyGemmOutputKernel(const OutputKernel& output_kernel, size_t m,
+                           size_t n, T3* c, size_t ldc) {
+  const Eigen::internal::blas_data_mapper<T3, Eigen::Index, Eigen::ColMajor>
+      output_mapper(c, ldc);
+  Eigen::TensorContractionParams params;
+  params.swapped_arguments = true;
+  output_kernel(output_mapper, params, Eigen::Index(0), Eigen::Index(0),
+                static_cast<Eigen::Index>(n), static_cast<Eigen::Index>(m));
+}
+
 // A readable but slow implementation of matrix multiplication, useful for
 // debugging and understanding the algorithm. Use instead of FastGemmFunctor in
 // the Im2ColConvFunctor template definition inside the op registration to
@@ -62,9 +83,11 @@ limitations under the License.
 template <class T1, class T2, class T3>
 class ReferenceGemmFunctor {
  public:
+  template <class OutputKernel = Eigen::NoOpOutputKernel>
   void operator()(tensorflow::OpKernelContext* ctx, size_t m, size_t n,
                   size_t k, const T1* a, size_t lda, const T2* b, size_t ldb,
-                  T3* c, size_t ldc) {
+                  T3* c, size_t ldc,
+                  const OutputKernel& output_kernel = OutputKernel()) {
     const size_t a_i_stride = lda;
     const size_t a_l_stride = 1;
     const size_t b_j_stride = 1;
@@ -86,6 +109,7 @@ class ReferenceGemmFunctor {
         c[c_index] = total;
       }
     }
+    ApplyGemmOutputKernel(output_kernel, m, n, c, ldc);
   }
 };
 
@@ -96,9 +120,11 @@ class ReferenceGemmFunctor {
 template <class T1, class T2, class T3>
 class FastGemmFunctor {
  public:
+  template <class OutputKernel = Eigen::NoOpOutputKernel>
   void operator()(tensorflow::OpKernelContext* ctx, size_t m, size_t n,
                   size_t k, const T1* a, size_t lda, const T2* b, size_t ldb,
-                  T3* c, size_t ldc) {
+                  T3* c, size_t ldc,
+                  const OutputKernel& output_kernel = OutputKernel()) {
     typename tensorflow::TTypes<const T1>::Matrix a_matrix(a, m, k);
     typename tensorflow::TTypes<const T2>::Matrix b_matrix(b, k, n);
     typename tensorflow::TTypes<T3>::Matrix c_matrix(c, m, n);
@@ -106,8 +132,10 @@ class FastGemmFunctor {
     Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> dim_pair;
     dim_pair[0].first = 1;
     dim_pair[0].second = 0;
+    // Eigen runs the output kernel on each block of c as soon as the block is
+    // done, while it's still in cache.
     c_matrix.device(ctx->eigen_device<Eigen::ThreadPoolDevice>()) =
-        a_matrix.contract(b_matrix, dim_pair);
+        a_matrix.contract(b_matrix, dim_pair, output_kernel);
   }
 };
 
@@ -116,10 +144,12 @@ class FastGemmFunctor {
 template <>
 class FastGemmFunctor<Eigen::bfloat16, Eigen::bfloat16, Eigen::bfloat16> {
  public:
+  template <class OutputKernel = Eigen::NoOpOutputKernel>
   void operator()(tensorflow::OpKernelContext* ctx, size_t m, size_t n,
                   size_t k, const Eigen::bfloat16* a, size_t lda,
                   const Eigen::bfloat16* b, size_t ldb, Eigen::bfloat16* c,
-                  size_t ldc) {
+                  size_t ldc,
+                  const OutputKernel& output_kernel = OutputKernel()) {
     using ConstMatrix =
         typename tensorflow::TTypes<const Eigen::bfloat16>::Matrix;
     ConstMatrix a_matrix(a, m, k);
@@ -133,6 +163,9 @@ class FastGemmFunctor<Eigen::bfloat16, Eigen::bfloat16, Eigen::bfloat16> {
         a_matrix.cast<float>()
             .contract(b_matrix.cast<float>(), dim_pair)
             .template cast<Eigen::bfloat16>();
+    // The contraction produces float blocks, so the bfloat16 output kernel
+    // can only run once they have been cast.
+    ApplyGemmOutputKernel(output_kernel, m, n, c, ldc);
   }
 };
 
@@ -141,11 +174,14 @@ class FastGemmFunctor<Eigen::bfloat16, Eigen::bfloat16, Eigen::bfloat16> {
 template <>
 class FastGemmFunctor<float, float, float> {
  public:
+  template <class OutputKernel = Eigen::NoOpOutputKernel>
   void operator()(tensorflow::OpKernelContext* ctx, size_t m, size_t n,
                   size_t k, const float* a, size_t lda, const float* b,
-                  size_t ldb, float* c, size_t ldc) {
+                  size_t ldb, float* c, size_t ldc,
+                  const OutputKernel& output_kernel = OutputKernel()) {
     cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, m, n, k, 1.0f, a,
                 lda, b, ldb, 0.0f, c, ldc);
+    ApplyGemmOutputKernel(output_kernel, m, n, c, ldc);
   }
 };
 #endif  // USE_CBLAS_GEMM
@@ -19,11 +19,15 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include <tuple>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/compiler/xla/stream_executor/stream.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/gpu_prim.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/gpu_kernel_helper.h"
 
 namespace tensorflow {
@@ -47,6 +51,42 @@ Status RangeInit(const Eigen::GpuDevice& d, const T start, const T delta,
                          size, out);
 }
 
+// The temporary storage bytes that gpuprim::DeviceRadixSort needs for sorts of
+// one key and index type, keyed by (device ordinal, size, num_bits). The
+// sizing query only depends on these, so repeated sorts of the same shape, as
+// in input pipelines, look the size up here instead of asking gpuprim again.
+// The cache is cleared rather than allowed to grow past kMaxEntries entries.
+template <bool Descending, typename Tkey, typename Tindex>
+class RadixSortTempStorageCache {
+ public:
+  using Key = std::tuple<int, int, int>;
+
+  static RadixSortTempStorageCache* Global() {
+    static RadixSortTempStorageCache* cache = new RadixSortTempStorageCache;
+    return cache;
+  }
+
+  bool Find(const Key& key, size_t* temp_storage_bytes) {
+    mutex_lock lock(mu_);
+    auto it = bytes_.find(key);
+    if (it == bytes_.end()) return false;
+    *temp_storage_bytes = it->second;
+    return true;
+  }
+
+  void Insert(const Key& key, size_t temp_storage_bytes) {
+    mutex_lock lock(mu_);
+    if (bytes_.size() >= kMaxEntries) bytes_.clear();
+    bytes_[key] = temp_storage_bytes;
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 1024;
+
+  mutex mu_;
+  absl::flat_hash_map<Key, size_t> bytes_ TF_GUARDED_BY(mu_);
+};
+
 // Computes keys_out = sorted(keys_in), and indices_out = argsort(keys_in).
 // If keys_out is not required, it can be set to nullptr.
 // If indices_in is nullptr, the range of input indices [0, size) will be used.
@@ -109,20 +149,31 @@ Status GpuRadixSortImpl(OpKernelContext* context, int size, const Tkey* keys_in,
   size_t temp_storage_bytes = 0;
   const auto& cu_stream = GetGpuStream(context);
   gpuError_t err;
-  if constexpr (Descending) {
-    err = gpuprim::DeviceRadixSort::SortPairsDescending(
-        nullptr, temp_storage_bytes, keys_in, keys_out, indices_in, indices_out,
-        size, /*begin_bit=*/0, /*end_bit=*/num_bits, cu_stream);
-  } else {
-    err = gpuprim::DeviceRadixSort::SortPairs(
-        nullptr, temp_storage_bytes, keys_in, keys_out, indices_in, indices_out,
-        size, /*begin_bit=*/0, /*end_bit=*/num_bits, cu_stream);
-  }
-  if (err != 0) {
-    return errors::Internal(
-        "Failed to launch gpuprim::DeviceRadixSort::SortPairs to calculate "
-        "temp_storage_bytes, status: ",
-        cudaGetErrorString(err));
+  using TempStorageCache = RadixSortTempStorageCache<Descending, Tkey, Tindex>;
+  const int device_ordinal =
+      context->op_device_context()->stream()->parent()->device_ordinal();
+  const typename TempStorageCache::Key cache_key(device_ordinal, size,
+                                                 num_bits);
+  TempStorageCache* temp_storage_cache = TempStorageCache::Global();
+  if (!temp_storage_cache->Find(cache_key, &temp_storage_bytes)) {
+    if constexpr (Descending) {
+      err = gpuprim::DeviceRadixSort::SortPairsDescending(
+          nullptr, temp_storage_bytes, keys_in, keys_out, indices_in,
+          indices_out, size, /*begin_bit=*/0, /*end_bit=*/num_bits,
+          cu_stream);
+    } else {
+      err = gpuprim::DeviceRadixSort::SortPairs(
+          nullptr, temp_storage_bytes, keys_in, keys_out, indices_in,
+          indices_out, size, /*begin_bit=*/0, /*end_bit=*/num_bits,
+          cu_stream);
+    }
+    if (err != 0) {
+      return errors::Internal(
+          "Failed to launch gpuprim::DeviceRadixSort::SortPairs to calculate "
+          "temp_storage_bytes, status: ",
+          cudaGetErrorString(err));
+    }
+    temp_storage_cache->Insert(cache_key, temp_storage_bytes);
   }
   // Allocate temporary storage.
   TF_RETURN_IF_ERROR(context->allocate_temp(
@@ -318,6 +318,24 @@ TEST_F(GpuPrimHelpersTest, GpuRadixSort_KeysAndIndices) {
   test::ExpectTensorEqual<int32>(expected_indices_out, *GetOutput(1));
 }
 
+TEST_F(GpuPrimHelpersTest, GpuRadixSort_Repeated) {
+  // The second sort reuses the cached temporary storage size.
+  MakeRadixSort(DT_FLOAT, DT_INT32);
+  AddInputFromArray<float>(TensorShape({8}), {4, 2, 6, 7, 1, 3, 0, 5});  // keys
+  AddInputFromArray<int32>(TensorShape({8}), {7, 6, 5, 4, 3, 2, 1, 0});  // inds
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected_keys_out(allocator(), DT_FLOAT, TensorShape({8}));
+    test::FillValues<float>(&expected_keys_out, {0, 1, 2, 3, 4, 5, 6, 7});
+    test::ExpectTensorEqual<float>(expected_keys_out, *GetOutput(0));
+
+    Tensor expected_indices_out(allocator(), DT_INT32, TensorShape({8}));
+    test::FillValues<int32>(&expected_indices_out, {1, 3, 6, 2, 7, 0, 5, 4});
+    test::ExpectTensorEqual<int32>(expected_indices_out, *GetOutput(1));
+  }
+}
+
 TEST_F(GpuPrimHelpersTest, GpuRadixSort_NoKeysOut) {
   MakeRadixSort(DT_FLOAT, DT_INT32, /*need_keys_out=*/false);
   AddInputFromArray<float>(TensorShape({8}), {4, 2, 6, 7, 1, 3, 0, 5});  // keys
@@ -29,6 +29,7 @@ limitations under the License.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -120,7 +121,9 @@ Status ForwardInputOrCreateNewList(OpKernelContext* c, int32_t input_index,
   }
 
   // If forwarding is not possible allocate a new output tensor and copy
-  // the `input_list` to it.
+  // the `input_list` to it. This makes updates of the list O(n), so inside
+  // loops the list should be owned by a single tensor.
+  metrics::RecordTensorListCopy(c->op_kernel().type_string());
   AllocatorAttributes attr;
   attr.set_on_host(true);
   TF_RETURN_IF_ERROR(
@@ -397,6 +400,7 @@ class TensorListResize : public OpKernel {
     }
 
     // We were not able to forward the input.  Will have to resize from scratch.
+    metrics::RecordTensorListCopy(c->op_kernel().type_string());
     Tensor* result;
     AllocatorAttributes attr;
     attr.set_on_host(true);
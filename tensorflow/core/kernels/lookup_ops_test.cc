@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -100,5 +101,55 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+TEST_F(LookupOpsTest, MutableHashTable_LockStriped) {
+  TF_ASSERT_OK(NodeDefBuilder("table", "AnonymousMutableHashTable")
+                   .Attr("key_dtype", DT_INT64)
+                   .Attr("value_dtype", DT_FLOAT)
+                   .Attr("_num_shards", 4)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  TF_ASSERT_OK(RunOpKernel());
+  auto table_or =
+      GetOutput(0)->scalar<ResourceHandle>()().GetResource<
+          lookup::LookupInterface>();
+  TF_ASSERT_OK(table_or.status());
+  lookup::LookupInterface* table = table_or.value().get();
+
+  Tensor keys = test::AsTensor<int64_t>({1, 2, 3, 4, 5, 6, 7, 8});
+  Tensor values = test::AsTensor<float>({1, 2, 3, 4, 5, 6, 7, 8});
+  TF_ASSERT_OK(table->Insert(context_.get(), keys, values));
+  EXPECT_EQ(table->size(), 8);
+  TF_ASSERT_OK(
+      table->Remove(context_.get(), test::AsTensor<int64_t>({2, 7})));
+  EXPECT_EQ(table->size(), 6);
+
+  Tensor lookup_keys = test::AsTensor<int64_t>({8, 7, 1, 9});
+  Tensor found(DT_FLOAT, TensorShape({4}));
+  TF_ASSERT_OK(table->Find(context_.get(), lookup_keys, &found,
+                           test::AsScalar<float>(-1)));
+  test::ExpectTensorEqual<float>(found,
+                                 test::AsTensor<float>({8, -1, 1, -1}));
+
+  // Importing replaces the contents of all shards.
+  TF_ASSERT_OK(table->ImportValues(context_.get(),
+                                   test::AsTensor<int64_t>({9, 10}),
+                                   test::AsTensor<float>({9, 10})));
+  EXPECT_EQ(table->size(), 2);
+  TF_ASSERT_OK(table->Find(context_.get(), lookup_keys, &found,
+                           test::AsScalar<float>(-1)));
+  test::ExpectTensorEqual<float>(found,
+                                 test::AsTensor<float>({-1, -1, -1, 9}));
+}
+
+TEST_F(LookupOpsTest, MutableHashTable_InvalidNumShards) {
+  TF_ASSERT_OK(NodeDefBuilder("table", "AnonymousMutableHashTable")
+                   .Attr("key_dtype", DT_INT64)
+                   .Attr("value_dtype", DT_FLOAT)
+                   .Attr("_num_shards", 0)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  EXPECT_EQ(RunOpKernel().code(), error::INVALID_ARGUMENT);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -17,13 +17,19 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <string>
+#include <algorithm>
+#include <memory>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/kernels/embedding_hash_map.h"
 #include "tensorflow/core/kernels/initializable_lookup_table.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/random.h"
@@ -36,11 +42,179 @@ std::string UniqueNodeName(const std::string& base) {
   return strings::StrCat(base, "/", counter.fetch_add(1), "/", random::New64());
 }
 
+namespace {
+
+// Private attr of the MutableHashTable ops setting the number of lock stripes
+// of the table, see LockStripedMap.
+constexpr char kNumShardsAttr[] = "_num_shards";
+
+// Returns the value of the optional `_num_shards` attr of `kernel`, or 1 if it
+// is not set. Fails `ctx` if the value is not positive.
+int64_t GetNumShards(OpKernelContext* ctx, OpKernel* kernel) {
+  int64_t num_shards = 1;
+  if (TryGetNodeAttr(kernel->def(), kNumShardsAttr, &num_shards) &&
+      num_shards < 1) {
+    ctx->SetStatus(errors::InvalidArgument(
+        kNumShardsAttr, " must be positive, got: ", num_shards));
+    return 1;
+  }
+  return num_shards;
+}
+
+// An unordered_map split by key hash into shards, each guarded by its own
+// mutex. Finds and inserts of keys in different shards do not contend, which
+// lets read-mostly tables such as embedding lookups scale with the number of
+// threads. With a single shard this is one map behind one mutex.
+//
+// Operations on individual keys lock one shard at a time. Operations on the
+// whole table lock all shards in index order, so they see, and produce, a
+// consistent state.
+template <class K, class V>
+class LockStripedMap {
+ public:
+  using Map = std::unordered_map<K, V>;
+
+  explicit LockStripedMap(int64_t num_shards)
+      : num_shards_(num_shards), shards_(new Shard[num_shards]) {}
+
+  int64_t num_shards() const { return num_shards_; }
+
+  // Returns the index of the shard holding `key`, i.e. of its map in the
+  // arguments of WithAllShared and WithAll.
+  int64_t ShardOf(const K& key) const {
+    if (num_shards_ == 1) return 0;
+    // The map of each shard hashes its keys with the same function, so mix
+    // the hash to keep the keys of a shard spread over its buckets.
+    const uint64 hash = std::hash<K>()(key) * 0x9E3779B97F4A7C15ull;
+    return (hash >> 32) % num_shards_;
+  }
+
+  size_t size() const {
+    size_t size = 0;
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      tf_shared_lock l(shards_[s].mu);
+      size += shards_[s].map.size();
+    }
+    return size;
+  }
+
+  // Calls `fn(i, keys[i], map)` for each `i` in [0, n), where `map` is the map
+  // of the shard of `keys[i]`, holding that shard's lock in shared mode.
+  // Consecutive keys of the same shard share one lock acquisition.
+  template <typename Fn>
+  void ForEachKeyShared(int64_t n, const K* keys, Fn fn) const
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    const Shard* locked = nullptr;
+    for (int64_t i = 0; i < n; ++i) {
+      const auto& k = SubtleMustCopyIfIntegral(keys[i]);
+      const Shard* shard = &shards_[ShardOf(k)];
+      if (shard != locked) {
+        if (locked != nullptr) locked->mu.unlock_shared();
+        shard->mu.lock_shared();
+        locked = shard;
+      }
+      fn(i, k, shard->map);
+    }
+    if (locked != nullptr) locked->mu.unlock_shared();
+  }
+
+  // Like ForEachKeyShared, but holds the shard locks exclusively.
+  template <typename Fn>
+  void ForEachKey(int64_t n, const K* keys, Fn fn)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    Shard* locked = nullptr;
+    for (int64_t i = 0; i < n; ++i) {
+      const auto& k = SubtleMustCopyIfIntegral(keys[i]);
+      Shard* shard = &shards_[ShardOf(k)];
+      if (shard != locked) {
+        if (locked != nullptr) locked->mu.unlock();
+        shard->mu.lock();
+        locked = shard;
+      }
+      fn(i, k, shard->map);
+    }
+    if (locked != nullptr) locked->mu.unlock();
+  }
+
+  // Returns `fn(maps)`, where `maps` are the maps of all shards, holding all
+  // shard locks in shared mode.
+  template <typename Fn>
+  auto WithAllShared(Fn fn) const TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<const Map*> maps(num_shards_);
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      shards_[s].mu.lock_shared();
+      maps[s] = &shards_[s].map;
+    }
+    auto unlock = gtl::MakeCleanup([this]() TF_NO_THREAD_SAFETY_ANALYSIS {
+      for (int64_t s = num_shards_ - 1; s >= 0; --s) {
+        shards_[s].mu.unlock_shared();
+      }
+    });
+    return fn(maps);
+  }
+
+  // Like WithAllShared, but holds the shard locks exclusively.
+  template <typename Fn>
+  auto WithAll(Fn fn) TF_NO_THREAD_SAFETY_ANALYSIS {
+    std::vector<Map*> maps(num_shards_);
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      shards_[s].mu.lock();
+      maps[s] = &shards_[s].map;
+    }
+    auto unlock = gtl::MakeCleanup([this]() TF_NO_THREAD_SAFETY_ANALYSIS {
+      for (int64_t s = num_shards_ - 1; s >= 0; --s) {
+        shards_[s].mu.unlock();
+      }
+    });
+    return fn(maps);
+  }
+
+  // Returns the number of buckets of the shard maps, counting the elements of
+  // non-empty buckets instead.
+  int64_t BucketUsage() const {
+    int64_t ret = 0;
+    for (int64_t s = 0; s < num_shards_; ++s) {
+      tf_shared_lock l(shards_[s].mu);
+      const Map& map = shards_[s].map;
+      for (unsigned i = 0; i < map.bucket_count(); ++i) {
+        size_t bucket_size = map.bucket_size(i);
+        if (bucket_size == 0) {
+          ret++;
+        } else {
+          ret += bucket_size;
+        }
+      }
+    }
+    return ret;
+  }
+
+ private:
+  struct Shard {
+    mutable mutex mu;
+    Map map TF_GUARDED_BY(mu);
+  };
+
+  const int64_t num_shards_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+// Adds the `_num_shards` attr to a table node built by AsGraphDef, so that the
+// restored table keeps the lock striping of the original.
+GraphDefBuilder::Options WithNumShards(GraphDefBuilder::Options opts,
+                                       int64_t num_shards) {
+  if (num_shards == 1) return opts;
+  return opts.WithAttr(kNumShardsAttr, num_shards);
+}
+
+}  // namespace
+
 // Lookup table that wraps an unordered_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The optional `_num_shards` attr of the op stripes the table over several
+// locks, see LockStripedMap.
 //
 // Sample use case:
 //
@@ -53,12 +227,10 @@ std::string UniqueNodeName(const std::string& base) {
 template <class K, class V>
 class MutableHashTableOfScalars final : public LookupInterface {
  public:
-  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
+  MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel)
+      : table_(GetNumShards(ctx, kernel)) {}
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -70,18 +242,19 @@ class MutableHashTableOfScalars final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      // is_full_size_default is true:
-      //   Each key has an independent default value, key_values(i)
-      //   corresponding uses default_flat(i) as its default value.
-      //
-      // is_full_size_default is false:
-      //   All keys will share the default_flat(0) as default value.
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)),
-          is_full_size_default ? default_flat(i) : default_flat(0));
-    }
+    table_.ForEachKeyShared(
+        key_values.size(), key_values.data(),
+        [&](int64_t i, const K& key, const std::unordered_map<K, V>& table) {
+          // is_full_size_default is true:
+          //   Each key has an independent default value, key_values(i)
+          //   corresponding uses default_flat(i) as its default value.
+          //
+          // is_full_size_default is false:
+          //   All keys will share the default_flat(0) as default value.
+          value_values(i) = gtl::FindWithDefault(
+              table, key,
+              is_full_size_default ? default_flat(i) : default_flat(0));
+        });
 
     return OkStatus();
   }
@@ -90,15 +263,28 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
+    auto insert = [&](int64_t i, const K& key,
+                      std::unordered_map<K, V>& table) {
+      gtl::InsertOrUpdate(&table, key,
                           SubtleMustCopyIfIntegral(value_values(i)));
+    };
+    if (!clear) {
+      table_.ForEachKey(key_values.size(), key_values.data(), insert);
+      return OkStatus();
     }
-    return OkStatus();
+    // Hold all shards while replacing the contents, so that no reader sees a
+    // partially imported table.
+    return table_.WithAll([&](const std::vector<std::unordered_map<K, V>*>&
+                                  tables) {
+      for (std::unordered_map<K, V>* table : tables) {
+        table->clear();
+      }
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        const auto& key = SubtleMustCopyIfIntegral(key_values(i));
+        insert(i, key, *tables[table_.ShardOf(key)]);
+      }
+      return OkStatus();
+    });
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& keys,
@@ -109,10 +295,11 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.ForEachKey(
+        key_values.size(), key_values.data(),
+        [&](int64_t i, const K& key, std::unordered_map<K, V>& table) {
+          table.erase(key);
+        });
     return OkStatus();
   }
 
@@ -122,17 +309,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-    ExportKeysAndValues(keys, values);
-    return OkStatus();
+    return table_.WithAllShared([&](const Tables& tables) -> Status {
+      int64_t size = TotalSize(tables);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("values", TensorShape({size}), &values));
+      ExportKeysAndValues(tables, keys, values);
+      return OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -144,25 +332,18 @@ class MutableHashTableOfScalars final : public LookupInterface {
   TensorShape value_shape() const override { return TensorShape(); }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfScalars) + ret;
+    return sizeof(MutableHashTableOfScalars) + table_.BucketUsage();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    table_.WithAllShared([&](const Tables& tables) {
+      int64_t size = TotalSize(tables);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values = Tensor(value_dtype(), TensorShape({size}));
+      ExportKeysAndValues(tables, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableV2 kernel. This means that the lifetime
@@ -172,11 +353,13 @@ class MutableHashTableOfScalars final : public LookupInterface {
     // earlier when appropriate.
     Node* table = ops::SourceOp(
         "MutableHashTableV2",
-        builder->opts()
-            .WithName(UniqueNodeName("MutableHashTableFromGraphDef"))
-            .WithAttr("use_node_name_sharing", true)
-            .WithAttr("key_dtype", key_dtype())
-            .WithAttr("value_dtype", value_dtype()));
+        WithNumShards(
+            builder->opts()
+                .WithName(UniqueNodeName("MutableHashTableFromGraphDef"))
+                .WithAttr("use_node_name_sharing", true)
+                .WithAttr("key_dtype", key_dtype())
+                .WithAttr("value_dtype", value_dtype()),
+            table_.num_shards()));
     Node* keys_node = ops::SourceOp(
         "Const",
         builder->opts().WithAttr("dtype", key_dtype()).WithAttr("value", keys));
@@ -195,21 +378,32 @@ class MutableHashTableOfScalars final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  using Tables = std::vector<const std::unordered_map<K, V>*>;
+
+  static int64_t TotalSize(const Tables& tables) {
+    int64_t size = 0;
+    for (const auto* table : tables) {
+      size += table->size();
+    }
+    return size;
+  }
+
+  // Writes all keys and values of `tables` into `keys` and `values`. `keys`
+  // and `values` must point to tensors of size `TotalSize(tables)`.
+  static void ExportKeysAndValues(const Tables& tables, Tensor* keys,
+                                  Tensor* values) {
     auto keys_data = keys->flat<K>();
     auto values_data = values->flat<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    for (const auto* table : tables) {
+      for (auto it = table->begin(); it != table->end(); ++it, ++i) {
+        keys_data(i) = it->first;
+        values_data(i) = it->second;
+      }
     }
   }
 
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  LockStripedMap<K, V> table_;
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -217,7 +411,8 @@ class MutableHashTableOfScalars final : public LookupInterface {
 template <class K, class V>
 class MutableHashTableOfTensors final : public LookupInterface {
  public:
-  MutableHashTableOfTensors(OpKernelContext* ctx, OpKernel* kernel) {
+  MutableHashTableOfTensors(OpKernelContext* ctx, OpKernel* kernel)
+      : table_(GetNumShards(ctx, kernel)) {
     OP_REQUIRES_OK(ctx,
                    GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
     OP_REQUIRES(
@@ -226,10 +421,7 @@ class MutableHashTableOfTensors final : public LookupInterface {
                                 value_shape_.DebugString()));
   }
 
-  size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
-  }
+  size_t size() const override { return table_.size(); }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
               const Tensor& default_value) override {
@@ -242,27 +434,27 @@ class MutableHashTableOfTensors final : public LookupInterface {
     int64_t default_total = default_flat.size();
     bool is_full_size_default = (total == default_total);
 
-    tf_shared_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      ValueArray* value_vec =
-          gtl::FindOrNull(table_, SubtleMustCopyIfIntegral(key_values(i)));
-      if (value_vec != nullptr) {
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) = value_vec->at(j);
-        }
-      } else {
-        // is_full_size_default is true:
-        //   Each key has an independent default value, key_values(i)
-        //   corresponding uses default_flat(i) as its default value.
-        //
-        // is_full_size_default is false:
-        //   All keys will share the default_flat(0) as default value.
-        for (int64_t j = 0; j < value_dim; j++) {
-          value_values(i, j) =
-              is_full_size_default ? default_flat(i, j) : default_flat(0, j);
-        }
-      }
-    }
+    table_.ForEachKeyShared(
+        key_values.size(), key_values.data(),
+        [&](int64_t i, const K& key, const Table& table) {
+          const ValueArray* value_vec = gtl::FindOrNull(table, key);
+          if (value_vec != nullptr) {
+            for (int64_t j = 0; j < value_dim; j++) {
+              value_values(i, j) = value_vec->at(j);
+            }
+          } else {
+            // is_full_size_default is true:
+            //   Each key has an independent default value, key_values(i)
+            //   corresponding uses default_flat(i) as its default value.
+            //
+            // is_full_size_default is false:
+            //   All keys will share the default_flat(0) as default value.
+            for (int64_t j = 0; j < value_dim; j++) {
+              value_values(i, j) = is_full_size_default ? default_flat(i, j)
+                                                        : default_flat(0, j);
+            }
+          }
+        });
 
     return OkStatus();
   }
@@ -272,20 +464,30 @@ class MutableHashTableOfTensors final : public LookupInterface {
     const auto value_values = values.flat_inner_dims<V, 2>();
     int64_t value_dim = value_shape_.dim_size(0);
 
-    mutex_lock l(mu_);
-    if (clear) {
-      table_.clear();
-    }
-    for (int64_t i = 0; i < key_values.size(); ++i) {
+    auto insert = [&](int64_t i, const K& key, Table& table) {
       ValueArray value_vec;
       for (int64_t j = 0; j < value_dim; j++) {
         V value = value_values(i, j);
         value_vec.push_back(value);
       }
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          value_vec);
+      gtl::InsertOrUpdate(&table, key, value_vec);
+    };
+    if (!clear) {
+      table_.ForEachKey(key_values.size(), key_values.data(), insert);
+      return OkStatus();
     }
-    return OkStatus();
+    // Hold all shards while replacing the contents, so that no reader sees a
+    // partially imported table.
+    return table_.WithAll([&](const std::vector<Table*>& tables) {
+      for (Table* table : tables) {
+        table->clear();
+      }
+      for (int64_t i = 0; i < key_values.size(); ++i) {
+        const auto& key = SubtleMustCopyIfIntegral(key_values(i));
+        insert(i, key, *tables[table_.ShardOf(key)]);
+      }
+      return OkStatus();
+    });
   }
 
   Status Insert(OpKernelContext* ctx, const Tensor& keys,
@@ -296,10 +498,9 @@ class MutableHashTableOfTensors final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64_t i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
-    }
+    table_.ForEachKey(
+        key_values.size(), key_values.data(),
+        [&](int64_t i, const K& key, Table& table) { table.erase(key); });
     return OkStatus();
   }
 
@@ -309,18 +510,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
   Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    int64_t value_dim = value_shape_.dim_size(0);
-
-    Tensor* keys;
-    Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        "values", TensorShape({size, value_dim}), &values));
-    ExportKeysAndValues(keys, values);
-    return OkStatus();
+    return table_.WithAllShared([&](const Tables& tables) -> Status {
+      int64_t size = TotalSize(tables);
+      int64_t value_dim = value_shape_.dim_size(0);
+
+      Tensor* keys;
+      Tensor* values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_output("keys", TensorShape({size}), &keys));
+      TF_RETURN_IF_ERROR(ctx->allocate_output(
+          "values", TensorShape({size, value_dim}), &values));
+      ExportKeysAndValues(tables, keys, values);
+      return OkStatus();
+    });
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -332,25 +534,19 @@ class MutableHashTableOfTensors final : public LookupInterface {
   TensorShape value_shape() const override { return value_shape_; }
 
   int64_t MemoryUsed() const override {
-    int64_t ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
-    }
-    return sizeof(MutableHashTableOfTensors) + ret;
+    return sizeof(MutableHashTableOfTensors) + table_.BucketUsage();
   }
 
   Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
-    tf_shared_lock l(mu_);
-    int64_t size = table_.size();
-    Tensor keys(key_dtype(), TensorShape({size}));
-    Tensor values(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
-    ExportKeysAndValues(&keys, &values);
+    Tensor keys;
+    Tensor values;
+    table_.WithAllShared([&](const Tables& tables) {
+      int64_t size = TotalSize(tables);
+      keys = Tensor(key_dtype(), TensorShape({size}));
+      values =
+          Tensor(value_dtype(), TensorShape({size, value_shape_.dim_size(0)}));
+      ExportKeysAndValues(tables, &keys, &values);
+    });
 
     // We set use_node_name_sharing with a unique node name so that the resource
     // can outlive the MutableHashTableOfTensorsV2 kernel. This means that the
@@ -360,12 +556,15 @@ class MutableHashTableOfTensors final : public LookupInterface {
     // earlier when appropriate.
     Node* table =
         ops::SourceOp("MutableHashTableOfTensorsV2",
-                      builder->opts()
-                          .WithName(UniqueNodeName("MutableHashTableOfTensors"))
-                          .WithAttr("use_node_name_sharing", true)
-                          .WithAttr("key_dtype", key_dtype())
-                          .WithAttr("value_dtype", value_dtype())
-                          .WithAttr("value_shape", value_shape_));
+                      WithNumShards(
+                          builder->opts()
+                              .WithName(
+                                  UniqueNodeName("MutableHashTableOfTensors"))
+                              .WithAttr("use_node_name_sharing", true)
+                              .WithAttr("key_dtype", key_dtype())
+                              .WithAttr("value_dtype", value_dtype())
+                              .WithAttr("value_shape", value_shape_),
+                          table_.num_shards()));
     Node* keys_node = ops::SourceOp(
         "Const",
         builder->opts().WithAttr("dtype", key_dtype()).WithAttr("value", keys));
@@ -384,28 +583,40 @@ class MutableHashTableOfTensors final : public LookupInterface {
   }
 
  private:
-  // Writes all keys and values into `keys` and `values`. `keys` and `values`
-  // must point to tensors of size `table_.size()`.
-  void ExportKeysAndValues(Tensor* keys, Tensor* values) const
-      TF_SHARED_LOCKS_REQUIRED(mu_) {
+  typedef gtl::InlinedVector<V, 4> ValueArray;
+  using Table = std::unordered_map<K, ValueArray>;
+  using Tables = std::vector<const Table*>;
+
+  static int64_t TotalSize(const Tables& tables) {
+    int64_t size = 0;
+    for (const Table* table : tables) {
+      size += table->size();
+    }
+    return size;
+  }
+
+  // Writes all keys and values of `tables` into `keys` and `values`. `keys`
+  // and `values` must point to tensors of size `TotalSize(tables)`.
+  void ExportKeysAndValues(const Tables& tables, Tensor* keys,
+                           Tensor* values) const {
     int64_t value_dim = value_shape_.dim_size(0);
     auto keys_data = keys->flat<K>();
     auto values_data = values->matrix<V>();
     int64_t i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      K key = it->first;
-      ValueArray value = it->second;
-      keys_data(i) = key;
-      for (int64_t j = 0; j < value_dim; j++) {
-        values_data(i, j) = value[j];
+    for (const Table* table : tables) {
+      for (auto it = table->begin(); it != table->end(); ++it, ++i) {
+        K key = it->first;
+        const ValueArray& value = it->second;
+        keys_data(i) = key;
+        for (int64_t j = 0; j < value_dim; j++) {
+          values_data(i, j) = value[j];
+        }
       }
     }
   }
 
   TensorShape value_shape_;
-  mutable mutex mu_;
-  typedef gtl::InlinedVector<V, 4> ValueArray;
-  std::unordered_map<K, ValueArray> table_ TF_GUARDED_BY(mu_);
+  LockStripedMap<K, ValueArray> table_;
 };
 
 namespace {
@@ -878,6 +1089,184 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 deleted_key_hash_;
 };
 
+// Lookup table for embeddings of integer ids, backed by an EmbeddingHashMap.
+// Values are stored inline in cache-line-padded slots, and the table can be
+// given a memory budget, within which it stays by evicting the least recently
+// or least frequently found entries.
+//
+// ExportValues copies one shard at a time, so exporting a large table never
+// holds more than one shard's lock.
+template <class K, class V>
+class MutableEmbeddingHashTable final : public LookupInterface {
+ public:
+  MutableEmbeddingHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(ctx,
+                   GetNodeAttr(kernel->def(), "value_shape", &value_shape_));
+    OP_REQUIRES(ctx,
+                TensorShapeUtils::IsScalar(value_shape_) ||
+                    TensorShapeUtils::IsVector(value_shape_),
+                errors::InvalidArgument(
+                    "Value shape must be a scalar or a vector, got shape ",
+                    value_shape_.DebugString()));
+
+    typename Map::Options options;
+    options.value_dim = value_shape_.num_elements();
+    OP_REQUIRES_OK(
+        ctx, GetNodeAttr(kernel->def(), "num_shards", &options.num_shards));
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "max_memory_bytes",
+                                    &options.max_memory_bytes));
+    std::string eviction_policy;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "eviction_policy",
+                                    &eviction_policy));
+    options.eviction_policy = eviction_policy == "lfu"
+                                  ? Map::EvictionPolicy::kLfu
+                                  : Map::EvictionPolicy::kLru;
+    max_memory_bytes_ = options.max_memory_bytes;
+    eviction_policy_ = eviction_policy;
+    OP_REQUIRES_OK(ctx, Map::Create(options, &map_));
+  }
+
+  size_t size() const override { return map_->size(); }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const int64_t value_dim = map_->value_dim();
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat_inner_dims<V, 2>();
+    const auto default_flat = default_value.flat<V>();
+    // Each key has its own default value if `default_value` holds one value
+    // per key. Otherwise all keys share the first one.
+    const bool is_full_size_default =
+        default_flat.size() == value_values.size();
+
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      V* row = &value_values(i, 0);
+      if (!map_->Find(SubtleMustCopyIfIntegral(key_values(i)), row)) {
+        const V* default_row =
+            &default_flat(is_full_size_default ? i * value_dim : 0);
+        std::copy_n(default_row, value_dim, row);
+      }
+    }
+    return OkStatus();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    const auto key_values = keys.flat<K>();
+    const auto value_values = values.flat_inner_dims<V, 2>();
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      map_->Insert(SubtleMustCopyIfIntegral(key_values(i)),
+                   &value_values(i, 0));
+    }
+    return OkStatus();
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    const auto key_values = keys.flat<K>();
+    for (int64_t i = 0; i < key_values.size(); ++i) {
+      map_->Remove(SubtleMustCopyIfIntegral(key_values(i)));
+    }
+    return OkStatus();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    map_->Clear();
+    return Insert(ctx, keys, values);
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    std::vector<K> keys;
+    std::vector<V> values;
+    ExportKeysAndValues(&keys, &values);
+
+    const int64_t size = keys.size();
+    Tensor* keys_tensor;
+    Tensor* values_tensor;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys_tensor));
+    TF_RETURN_IF_ERROR(ctx->allocate_output("values", ValuesShape(size),
+                                            &values_tensor));
+    std::copy(keys.begin(), keys.end(), keys_tensor->flat<K>().data());
+    std::copy(values.begin(), values.end(), values_tensor->flat<V>().data());
+    return OkStatus();
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const final { return TensorShape(); }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64_t MemoryUsed() const override {
+    return sizeof(MutableEmbeddingHashTable) + map_->MemoryUsed();
+  }
+
+  Status AsGraphDef(GraphDefBuilder* builder, Node** out) const override {
+    std::vector<K> key_vector;
+    std::vector<V> value_vector;
+    ExportKeysAndValues(&key_vector, &value_vector);
+    const int64_t size = key_vector.size();
+    Tensor keys(key_dtype(), TensorShape({size}));
+    Tensor values(value_dtype(), ValuesShape(size));
+    std::copy(key_vector.begin(), key_vector.end(), keys.flat<K>().data());
+    std::copy(value_vector.begin(), value_vector.end(),
+              values.flat<V>().data());
+
+    // We set use_node_name_sharing with a unique node name so that the resource
+    // can outlive the kernel, as for MutableHashTableV2.
+    Node* table = ops::SourceOp(
+        "MutableEmbeddingHashTable",
+        builder->opts()
+            .WithName(UniqueNodeName("MutableEmbeddingHashTableFromGraphDef"))
+            .WithAttr("use_node_name_sharing", true)
+            .WithAttr("key_dtype", key_dtype())
+            .WithAttr("value_dtype", value_dtype())
+            .WithAttr("value_shape", value_shape_)
+            .WithAttr("num_shards", map_->num_shards())
+            .WithAttr("max_memory_bytes", max_memory_bytes_)
+            .WithAttr("eviction_policy", eviction_policy_));
+    Node* keys_node = ops::SourceOp(
+        "Const",
+        builder->opts().WithAttr("dtype", key_dtype()).WithAttr("value", keys));
+    Node* values_node =
+        ops::SourceOp("Const", builder->opts()
+                                   .WithAttr("dtype", value_dtype())
+                                   .WithAttr("value", values));
+    Node* import_table =
+        ops::TernaryOp("LookupTableImportV2", table, keys_node, values_node,
+                       builder->opts()
+                           .WithAttr("Tin", key_dtype())
+                           .WithAttr("Tout", value_dtype()));
+    *out = ops::UnaryOp("Identity", table,
+                        builder->opts().WithControlInput(import_table));
+    return OkStatus();
+  }
+
+ private:
+  using Map = EmbeddingHashMap<K, V>;
+
+  // Exports the table shard by shard.
+  void ExportKeysAndValues(std::vector<K>* keys, std::vector<V>* values) const {
+    for (int shard = 0; shard < map_->num_shards(); ++shard) {
+      map_->ExportShard(shard, keys, values);
+    }
+  }
+
+  TensorShape ValuesShape(int64_t size) const {
+    TensorShape shape({size});
+    shape.AppendShape(value_shape_);
+    return shape;
+  }
+
+  TensorShape value_shape_;
+  int64_t max_memory_bytes_ = 0;
+  std::string eviction_policy_;
+  std::unique_ptr<Map> map_;
+};
+
 }  // namespace lookup
 
 // Base class for kernels that take a LookupTable handle as the 0th input.
@@ -1244,4 +1633,25 @@ REGISTER_KERNEL(tstring, ResourceHandle);
 
 #undef REGISTER_KERNEL
 
+// Register the MutableEmbeddingHashTable op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                               \
+  REGISTER_KERNEL_BUILDER(                                                    \
+      Name("MutableEmbeddingHashTable")                                       \
+          .Device(DEVICE_CPU)                                                 \
+          .TypeConstraint<key_dtype>("key_dtype")                             \
+          .TypeConstraint<value_dtype>("value_dtype"),                        \
+      LookupTableOp<lookup::MutableEmbeddingHashTable<key_dtype, value_dtype>, \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int32, int64_t);
+REGISTER_KERNEL(int64_t, double);
+REGISTER_KERNEL(int64_t, float);
+REGISTER_KERNEL(int64_t, int32);
+REGISTER_KERNEL(int64_t, int64_t);
+
+#undef REGISTER_KERNEL
+
 }  // namespace tensorflow
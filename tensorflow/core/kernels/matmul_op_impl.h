@@ -25,6 +25,7 @@ limitations under the License.
 #include <vector>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -35,6 +36,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/matmul_autotune.h"
 #include "tensorflow/core/util/matmul_bcast.h"
@@ -662,6 +665,11 @@ struct LaunchBatchMatMul<GPUDevice, Scalar> {
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+// Private attr that marks In[1] as constant across steps (e.g. the weights of
+// an inference graph). CPU kernels with this attr set prepare the right-hand
+// side once per input buffer, see BaseBatchMatMulOp::GetPreparedRhs().
+constexpr char kCacheConstantRhsAttr[] = "_cache_constant_rhs";
+
 template <typename Device, typename Ta, typename Tb, typename Tout>
 class BaseBatchMatMulOp : public OpKernel {
  public:
@@ -680,6 +688,10 @@ class BaseBatchMatMulOp : public OpKernel {
       trans_x_ = false;
       trans_y_ = false;
     }
+    if (std::is_same_v<Device, CPUDevice>) {
+      TryGetNodeAttr(context->def(), kCacheConstantRhsAttr,
+                     &cache_constant_rhs_);
+    }
   }
 
   ~BaseBatchMatMulOp() override {}
@@ -743,13 +755,15 @@ class BaseBatchMatMulOp : public OpKernel {
                 out_reshaped.CopyFrom(*out, TensorShape({batch_size, d0, d3})),
                 errors::Internal("Failed to reshape output from ",
                                  out->shape().DebugString()));
-    if (std::is_same_v<Device, CPUDevice> && std::is_same_v<Ta, bfloat16> &&
-        std::is_same_v<Tb, bfloat16>) {
+    // A prepared right-hand side is already adjointed or transposed.
+    const bool adj_y = adj_y_ && !cache_constant_rhs_;
+    const bool trans_y = trans_y_ && !cache_constant_rhs_;
+    if constexpr (std::is_same_v<Device, CPUDevice> &&
+                  std::is_same_v<Ta, bfloat16> &&
+                  std::is_same_v<Tb, bfloat16>) {
       Tensor in0_reshaped_float, in1_reshaped_float, out_reshaped_float;
       OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, in0_reshaped.shape(),
                                              &in0_reshaped_float));
-      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, in1_reshaped.shape(),
-                                             &in1_reshaped_float));
       OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, out_reshaped.shape(),
                                              &out_reshaped_float));
 
@@ -757,13 +771,20 @@ class BaseBatchMatMulOp : public OpKernel {
       BFloat16ToFloat(in0_reshaped.flat<bfloat16>().data(),
                       in0_reshaped_float.flat<float>().data(),
                       in0_reshaped.NumElements());
-      BFloat16ToFloat(in1_reshaped.flat<bfloat16>().data(),
-                      in1_reshaped_float.flat<float>().data(),
-                      in1_reshaped.NumElements());
+      if (cache_constant_rhs_) {
+        OP_REQUIRES_OK(ctx, GetPreparedRhs<float>(ctx, in1, in1_reshaped,
+                                                  &in1_reshaped_float));
+      } else {
+        OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, in1_reshaped.shape(),
+                                               &in1_reshaped_float));
+        BFloat16ToFloat(in1_reshaped.flat<bfloat16>().data(),
+                        in1_reshaped_float.flat<float>().data(),
+                        in1_reshaped.NumElements());
+      }
 
       LaunchBatchMatMul<Device, float>::Launch(
-          ctx, in0_reshaped_float, in1_reshaped_float, adj_x_, adj_y_, trans_x_,
-          trans_y_, bcast, &out_reshaped_float);
+          ctx, in0_reshaped_float, in1_reshaped_float, adj_x_, adj_y, trans_x_,
+          trans_y, bcast, &out_reshaped_float);
       FloatToBFloat16(out_reshaped_float.flat<float>().data(),
                       out_reshaped.flat<bfloat16>().data(), out->NumElements());
     } else {
@@ -772,12 +793,17 @@ class BaseBatchMatMulOp : public OpKernel {
       if (!std::is_same<Ta, Tout>::value) {
         in0_reshaped = CastTensor<Ta, Tout>(in0_reshaped);
       }
-      if (!std::is_same<Tb, Tout>::value) {
+      if (cache_constant_rhs_) {
+        Tensor prepared_rhs;
+        OP_REQUIRES_OK(
+            ctx, GetPreparedRhs<Tout>(ctx, in1, in1_reshaped, &prepared_rhs));
+        in1_reshaped = std::move(prepared_rhs);
+      } else if (!std::is_same<Tb, Tout>::value) {
         in1_reshaped = CastTensor<Tb, Tout>(in1_reshaped);
       }
       LaunchBatchMatMul<Device, Tout>::Launch(ctx, in0_reshaped, in1_reshaped,
-                                              adj_x_, adj_y_, trans_x_,
-                                              trans_y_, bcast, &out_reshaped);
+                                              adj_x_, adj_y, trans_x_, trans_y,
+                                              bcast, &out_reshaped);
     }
   }
 
@@ -792,6 +818,68 @@ class BaseBatchMatMulOp : public OpKernel {
   bool trans_x_ = false;
   bool trans_y_ = false;
 
+  // Set from kCacheConstantRhsAttr; always false on devices other than CPU.
+  bool cache_constant_rhs_ = false;
+  mutex mu_;
+  // The In[1] tensor that `prepared_rhs_` was computed from. Holding a
+  // reference keeps its buffer alive, so a matching data pointer identifies
+  // the same weights rather than a recycled allocation.
+  Tensor prepared_rhs_source_ TF_GUARDED_BY(mu_);
+  Tensor prepared_rhs_ TF_GUARDED_BY(mu_);
+
+  // Sets `*rhs` to `in1_reshaped`, of shape [batch, d2, d3], cast to `T` and,
+  // if the op adjoints or transposes In[1], materialized as the
+  // [batch, d3, d2] adjoint or transpose. The result is computed once and
+  // reused for as long as `in1` keeps the same buffer and shape, which saves
+  // the per-step conversion of constant weights.
+  template <typename T>
+  Status GetPreparedRhs(OpKernelContext* ctx, const Tensor& in1,
+                        const Tensor& in1_reshaped, Tensor* rhs) {
+    mutex_lock l(mu_);
+    if (prepared_rhs_source_.IsInitialized() &&
+        prepared_rhs_source_.tensor_data().data() ==
+            in1.tensor_data().data() &&
+        prepared_rhs_source_.shape() == in1.shape()) {
+      *rhs = prepared_rhs_;
+      return OkStatus();
+    }
+
+    Tensor cast;
+    if constexpr (std::is_same_v<Tb, T>) {
+      cast = in1_reshaped;
+    } else if constexpr (std::is_same_v<Tb, bfloat16> &&
+                         std::is_same_v<T, float>) {
+      cast = Tensor(DT_FLOAT, in1_reshaped.shape());
+      BFloat16ToFloat(in1_reshaped.flat<bfloat16>().data(),
+                      cast.flat<float>().data(), in1_reshaped.NumElements());
+    } else {
+      cast = CastTensor<Tb, T>(in1_reshaped);
+    }
+    if (adj_y_ || trans_y_) {
+      Tensor transposed(DataTypeToEnum<T>::v(),
+                        TensorShape({cast.dim_size(0), cast.dim_size(2),
+                                     cast.dim_size(1)}));
+      const Eigen::array<int, 3> perm = {0, 2, 1};
+      auto x = cast.tensor<T, 3>().shuffle(perm);
+      auto y = transposed.tensor<T, 3>();
+      const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+      if (adj_y_) {
+        y.device(d) = x.conjugate();
+      } else {
+        y.device(d) = x;
+      }
+      cast = std::move(transposed);
+    } else if (std::is_same_v<Tb, T>) {
+      // Nothing to prepare; avoid pinning the weights for no benefit.
+      *rhs = in1_reshaped;
+      return OkStatus();
+    }
+    prepared_rhs_source_ = in1;
+    prepared_rhs_ = cast;
+    *rhs = std::move(cast);
+    return OkStatus();
+  }
+
   // Cast `t` from `SrcT` to `DstT`.
   template <typename SrcT, typename DstT>
   Tensor CastTensor(const Tensor& t) {
@@ -17,6 +17,8 @@ limitations under the License.
 #include "tensorflow/cc/ops/nn_ops_internal.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -345,6 +347,51 @@ using FusedBiasAddDataTypes = ::testing::Types<float>;
 INSTANTIATE_TYPED_TEST_SUITE_P(Test, FusedMatMulWithBiasOpTest,
                                FusedBiasAddDataTypes);
 
+class MatMulCacheConstantRhsTest : public OpsTestBase {
+ protected:
+  void MakeOp(const string& op, DataType dtype, const string& adj_attr) {
+    TF_ASSERT_OK(NodeDefBuilder("matmul", op)
+                     .Input(FakeInput(dtype))
+                     .Input(FakeInput(dtype))
+                     .Attr(adj_attr, true)
+                     .Attr("_cache_constant_rhs", true)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(MatMulCacheConstantRhsTest, TransposedRhs) {
+  MakeOp("MatMul", DT_FLOAT, "transpose_b");
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 0, 1, 0, 1, 0});
+  Tensor expected = test::AsTensor<float>({4, 2, 10, 5}, TensorShape({2, 2}));
+  for (int step = 0; step < 2; ++step) {
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+  }
+
+  // New weights live in a different buffer and are prepared again.
+  inputs_.clear();
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2, 3}), {0, 0, 1, 1, 1, 1});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({3, 6, 6, 15}, TensorShape({2, 2})),
+      *GetOutput(0));
+}
+
+TEST_F(MatMulCacheConstantRhsTest, AdjointRhs) {
+  MakeOp("BatchMatMulV2", DT_COMPLEX64, "adj_y");
+  AddInputFromArray<complex64>(TensorShape({1, 1, 2}), {{1, 1}, {0, 1}});
+  AddInputFromArray<complex64>(TensorShape({1, 1, 2}), {{0, 1}, {2, 0}});
+  // (1 + i) * conj(i) + i * conj(2) = 1 + i.
+  Tensor expected = test::AsTensor<complex64>({{1, 1}}, TensorShape({1, 1, 1}));
+  for (int step = 0; step < 2; ++step) {
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorEqual<complex64>(expected, *GetOutput(0));
+  }
+}
+
 //----------------------------------------------------------------------------//
 // Performance benchmarks are below.                                          //
 //----------------------------------------------------------------------------//
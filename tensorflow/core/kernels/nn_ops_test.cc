@@ -1527,4 +1527,13 @@ BM_TopKCPU(128, 70000, 70000, 16, "topk_nmt_r_128_c_70000_k_70000_th_16");
 BM_TopKCPU(128, 175000, 175000, 16, "topk_nmt_r_128_c_175000_k_175000_th_16");
 BM_TopKCPU(128, 350000, 350000, 16, "topk_nmt_r_128_c_350000_k_350000_th_16");
 
+// Retrieval over a large candidate set: few rows, many columns.
+BM_TopKCPU(1, 10000000, 1, 16, "topk_retrieval_r_1_c_10000000_k_1_th_16");
+BM_TopKCPU(1, 10000000, 10, 16, "topk_retrieval_r_1_c_10000000_k_10_th_16");
+BM_TopKCPU(1, 10000000, 100, 16, "topk_retrieval_r_1_c_10000000_k_100_th_16");
+BM_TopKCPU(1, 10000000, 1000, 16, "topk_retrieval_r_1_c_10000000_k_1000_th_16");
+BM_TopKCPU(1, 10000000, 10000, 16, "topk_retrieval_r_1_c_10000000_k_10000_th_16");
+BM_TopKCPU(4, 1000000, 10, 16, "topk_retrieval_r_4_c_1000000_k_10_th_16");
+BM_TopKCPU(4, 1000000, 1000, 16, "topk_retrieval_r_4_c_1000000_k_1000_th_16");
+
 }  // namespace tensorflow
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/reference_gemm.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -393,4 +394,64 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+// Multiplies matrices whose sizes are not multiples of any kernel tile size,
+// with every combination of transposes, and compares against the reference
+// implementation.
+TEST_F(QuantizedMatMulTest, Large_AllTransposes) {
+  const int m = 37;
+  const int n = 70;
+  const int k = 130;
+  const float a_min = -1.0f;
+  const float a_max = 2.0f;
+  const float b_min = -3.0f;
+  const float b_max = 0.5f;
+  for (const bool transpose_a : {false, true}) {
+    for (const bool transpose_b : {false, true}) {
+      TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op", "QuantizedMatMul")
+                       .Input(FakeInput(DT_QUINT8))
+                       .Input(FakeInput(DT_QUINT8))
+                       .Input(FakeInput(DT_FLOAT))
+                       .Input(FakeInput(DT_FLOAT))
+                       .Input(FakeInput(DT_FLOAT))
+                       .Input(FakeInput(DT_FLOAT))
+                       .Attr("Toutput", DataTypeToEnum<qint32>::v())
+                       .Attr("transpose_a", transpose_a)
+                       .Attr("transpose_b", transpose_b)
+                       .Finalize(node_def()));
+      TF_ASSERT_OK(InitOp());
+
+      Tensor a(DT_QUINT8,
+               transpose_a ? TensorShape({k, m}) : TensorShape({m, k}));
+      Tensor b(DT_QUINT8,
+               transpose_b ? TensorShape({n, k}) : TensorShape({k, n}));
+      auto a_flat = a.flat<quint8>();
+      for (int i = 0; i < a_flat.size(); ++i) {
+        a_flat(i) = static_cast<uint8>((i * 37 + 11) % 256);
+      }
+      auto b_flat = b.flat<quint8>();
+      for (int i = 0; i < b_flat.size(); ++i) {
+        b_flat(i) = static_cast<uint8>((i * 101 + 7) % 256);
+      }
+      inputs_.clear();
+      AddInputFromArray<quint8>(a.shape(), a_flat);
+      AddInputFromArray<quint8>(b.shape(), b_flat);
+      AddInputFromArray<float>(TensorShape({}), {a_min});
+      AddInputFromArray<float>(TensorShape({}), {a_max});
+      AddInputFromArray<float>(TensorShape({}), {b_min});
+      AddInputFromArray<float>(TensorShape({}), {b_max});
+      TF_ASSERT_OK(RunOpKernel());
+
+      Tensor expected(DT_QINT32, {m, n});
+      ReferenceGemm<quint8, quint8, qint32>(
+          transpose_a, transpose_b, /*transpose_c=*/false, m, n, k,
+          a_flat.data(), FloatToQuantizedUnclamped<quint8>(0.0f, a_min, a_max),
+          a.dim_size(1), b_flat.data(),
+          FloatToQuantizedUnclamped<quint8>(0.0f, b_min, b_max), b.dim_size(1),
+          expected.flat<qint32>().data(), /*shift_c=*/0, /*offset_c=*/0,
+          /*mult_c=*/1, /*ldc=*/n);
+      test::ExpectTensorEqual<qint32>(expected, *GetOutput(0));
+    }
+  }
+}
+
 }  // namespace tensorflow
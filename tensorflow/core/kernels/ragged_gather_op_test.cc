@@ -234,6 +234,36 @@ TEST_F(RaggedGatherOpTest, InvalidSplitsTooBig) {
             RunOpKernel().error_message());
 }
 
+TEST_F(RaggedGatherOpTest, RaggedGather_ManyRows) {
+  // params[i] = [i, i, ...] with i % 5 values, gathered in reverse order.
+  const int num_rows = 1000;
+  std::vector<int64_t> splits = {0};
+  std::vector<int32> values;
+  for (int i = 0; i < num_rows; ++i) {
+    for (int j = 0; j < i % 5; ++j) values.push_back(i);
+    splits.push_back(values.size());
+  }
+  std::vector<int32> indices(num_rows);
+  for (int i = 0; i < num_rows; ++i) indices[i] = num_rows - 1 - i;
+  const int64_t num_values = values.size();
+  BuildRaggedGatherGraph<int32, int32>(TensorShape({num_rows}), indices,
+                                       {splits}, TensorShape({num_values}),
+                                       values);
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<int64_t> expected_splits = {0};
+  std::vector<int32> expected_values;
+  for (int i = num_rows - 1; i >= 0; --i) {
+    for (int j = 0; j < i % 5; ++j) expected_values.push_back(i);
+    expected_splits.push_back(expected_values.size());
+  }
+  test::ExpectTensorEqual<int64_t>(*GetOutput(0),
+                                   test::AsTensor<int64_t>(expected_splits));
+  test::ExpectTensorEqual<int32>(*GetOutput(1),
+                                 test::AsTensor<int32>(expected_values));
+}
+
 TEST_F(RaggedGatherOpTest, BadValuesShape) {
   BuildRaggedGatherGraph<float, int32>(
       TensorShape({0}),  // indices.shape
@@ -72,6 +72,99 @@ struct FillPhiloxRandom {
   }
 };
 
+// Converts blocks of raw PhiloxRandom output into the samples of a
+// distribution that uses one group of PhiloxRandom output per group of
+// results. Convert() produces exactly the values the distribution itself
+// would, in loops over whole blocks that the compiler can vectorize.
+// Distributions without a specialization are not converted in bulk.
+template <class Distribution>
+struct PhiloxBulkConversion {
+  static constexpr bool kSupported = false;
+};
+
+template <>
+struct PhiloxBulkConversion<random::UniformDistribution<PhiloxRandom, float>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType* samples,
+                      int64_t num_groups, float* data) {
+    for (int64_t g = 0; g < num_groups; ++g) {
+      for (int i = 0; i < PhiloxRandom::kResultElementCount; ++i) {
+        data[g * PhiloxRandom::kResultElementCount + i] =
+            random::Uint32ToFloat(samples[g][i]);
+      }
+    }
+  }
+};
+
+template <>
+struct PhiloxBulkConversion<random::UniformDistribution<PhiloxRandom, double>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType* samples,
+                      int64_t num_groups, double* data) {
+    for (int64_t g = 0; g < num_groups; ++g) {
+      data[2 * g] = random::Uint64ToDouble(samples[g][0], samples[g][1]);
+      data[2 * g + 1] = random::Uint64ToDouble(samples[g][2], samples[g][3]);
+    }
+  }
+};
+
+template <>
+struct PhiloxBulkConversion<
+    random::UniformDistribution<PhiloxRandom, Eigen::half>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType* samples,
+                      int64_t num_groups, Eigen::half* data) {
+    for (int64_t g = 0; g < num_groups; ++g) {
+      for (int i = 0; i < PhiloxRandom::kResultElementCount; ++i) {
+        data[g * PhiloxRandom::kResultElementCount + i] =
+            random::Uint16ToHalf(samples[g][i]);
+      }
+    }
+  }
+};
+
+template <>
+struct PhiloxBulkConversion<
+    random::UniformDistribution<PhiloxRandom, bfloat16>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType* samples,
+                      int64_t num_groups, bfloat16* data) {
+    for (int64_t g = 0; g < num_groups; ++g) {
+      for (int i = 0; i < PhiloxRandom::kResultElementCount; ++i) {
+        data[g * PhiloxRandom::kResultElementCount + i] =
+            random::Uint16ToGfloat16(samples[g][i]);
+      }
+    }
+  }
+};
+
+// The Box-Muller transforms stay scalar, since vectorized log and sincos would
+// not round the same way, but they still run over whole blocks of samples.
+template <>
+struct PhiloxBulkConversion<random::NormalDistribution<PhiloxRandom, float>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType* samples,
+                      int64_t num_groups, float* data) {
+    for (int64_t g = 0; g < num_groups; ++g) {
+      float* out = data + g * PhiloxRandom::kResultElementCount;
+      random::BoxMullerFloat(samples[g][0], samples[g][1], &out[0], &out[1]);
+      random::BoxMullerFloat(samples[g][2], samples[g][3], &out[2], &out[3]);
+    }
+  }
+};
+
+template <>
+struct PhiloxBulkConversion<random::NormalDistribution<PhiloxRandom, double>> {
+  static constexpr bool kSupported = true;
+  static void Convert(const PhiloxRandom::ResultType* samples,
+                      int64_t num_groups, double* data) {
+    for (int64_t g = 0; g < num_groups; ++g) {
+      random::BoxMullerDouble(samples[g][0], samples[g][1], samples[g][2],
+                              samples[g][3], &data[2 * g], &data[2 * g + 1]);
+    }
+  }
+};
+
 // A class to fill a specified range of random groups
 template <class Distribution, bool VariableSamplesPerOutput>
 struct FillPhiloxRandomTask;
@@ -90,10 +183,26 @@ struct FillPhiloxRandomTask<Distribution, false> {
 
     // First fill all the full-size groups
     int64_t limit_group_full = std::min(limit_group, size / kGroupSize);
-    for (int64_t index = start_group; index < limit_group_full; ++index) {
-      auto samples = dist(&gen);
-      std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
-      offset += kGroupSize;
+    if constexpr (PhiloxBulkConversion<Distribution>::kSupported) {
+      // Generate the raw samples a block at a time with
+      // PhiloxRandom::GenerateBatch(), then convert the whole block.
+      constexpr int64_t kBlockGroups = 4 * PhiloxRandom::kBatchSize;
+      PhiloxRandom::ResultType samples[kBlockGroups];
+      for (int64_t index = start_group; index < limit_group_full;) {
+        const int64_t num_groups =
+            std::min(kBlockGroups, limit_group_full - index);
+        gen.GenerateBatch(samples, num_groups);
+        PhiloxBulkConversion<Distribution>::Convert(samples, num_groups,
+                                                    data + offset);
+        offset += num_groups * kGroupSize;
+        index += num_groups;
+      }
+    } else {
+      for (int64_t index = start_group; index < limit_group_full; ++index) {
+        auto samples = dist(&gen);
+        std::copy(&samples[0], &samples[0] + kGroupSize, data + offset);
+        offset += kGroupSize;
+      }
     }
 
     // If there are any remaining elements that need to be filled, process them
@@ -18,6 +18,8 @@ limitations under the License.
 
 // Functor definitions for Reduction ops, must be compilable by nvcc.
 
+#include <type_traits>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
@@ -25,9 +27,21 @@ limitations under the License.
 namespace tensorflow {
 namespace functor {
 
+// CanReduceInStages is true if reducing some of the axes and then the rest
+// gives the same result as reducing all of them at once, up to rounding.
 template <typename Reducer>
 struct ReducerTraits {
-  enum { IsScalarIdentity = true };
+  enum { IsScalarIdentity = true, CanReduceInStages = true };
+};
+
+// Half-precision sums accumulate in float, which staging would defeat.
+template <typename Scalar>
+struct ReducerTraits<Eigen::internal::SumReducer<Scalar>> {
+  enum {
+    IsScalarIdentity = true,
+    CanReduceInStages = !std::is_same<Scalar, bfloat16>::value &&
+                        !std::is_same<Scalar, Eigen::half>::value
+  };
 };
 
 // Dummy class used for template specialization for mean reduction, which is
@@ -43,9 +57,21 @@ struct EuclideanNormReducer {
   Scalar initialize() const { return Scalar(0); }
 };
 
+// The mean of equally sized groups is the mean of their means, but only
+// without integer truncation.
+template <typename Scalar>
+struct ReducerTraits<MeanReducer<Scalar>> {
+  enum {
+    IsScalarIdentity = true,
+    CanReduceInStages = !Eigen::NumTraits<Scalar>::IsInteger &&
+                        !std::is_same<Scalar, bfloat16>::value &&
+                        !std::is_same<Scalar, Eigen::half>::value
+  };
+};
+
 template <typename Scalar>
 struct ReducerTraits<EuclideanNormReducer<Scalar>> {
-  enum { IsScalarIdentity = false };
+  enum { IsScalarIdentity = false, CanReduceInStages = false };
 };
 
 template <typename Device, typename OUT_T, typename IN_T,
@@ -23,6 +23,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <functional>
+#include <numeric>
+#include <type_traits>
+
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
@@ -214,6 +218,10 @@ class ReductionOp : public OpKernel {
         // Can be viewed as a reduction of a 3D tensor along 2nd dimension.
         Functor::Reduce(ctx, helper.out<T, 2>(&tmp_out), helper.in<T, 3>(data),
                         constants.kOne, reducer);
+      } else if constexpr (std::is_same<Device, CPUDevice>::value &&
+                           functor::ReducerTraits<Reducer>::CanReduceInStages) {
+        OP_REQUIRES_OK(ctx,
+                       ReduceInStages(ctx, data, helper, reducer, &tmp_out));
       } else {
         // If we don't hit one of the cases above, transpose the data so that
         // all reduced dimensions are last and reuse the 2-D -> 1-D case.
@@ -245,6 +253,69 @@ class ReductionOp : public OpKernel {
   }
 
  private:
+  // Reduces `data` into `out` without transposing it, for simplified shapes
+  // of rank 4 or more. The innermost reduced dimension is reduced on its own
+  // with the 2-D or 3-D kernels until at most three dimensions are left.
+  // Every stage shrinks the data, so this reads the input only once.
+  Status ReduceInStages(OpKernelContext* ctx, const Tensor& data,
+                        const ReductionHelper& helper, const Reducer& reducer,
+                        Tensor* out) {
+    typedef functor::ReduceFunctor<Device, Reducer> Functor;
+    Constants<Device> constants;
+    gtl::InlinedVector<int64_t, 8> dims;
+    for (const int64_t dim : helper.data_reshape().dim_sizes()) {
+      dims.push_back(dim);
+    }
+    Tensor in = data;
+    while (dims.size() > 3) {
+      // Reduced and kept dimensions alternate, so the innermost reduced
+      // dimension is one of the last two.
+      const int n = dims.size();
+      const bool last_is_reduced =
+          ((n - 1) % 2 == 0) == helper.reduce_first_axis();
+      const int64_t outer = std::accumulate(
+          dims.begin(), dims.end() - (last_is_reduced ? 1 : 2), int64_t{1},
+          std::multiplies<int64_t>());
+      const Tensor& const_in = in;
+      Tensor staged;
+      if (last_is_reduced) {
+        TF_RETURN_IF_ERROR(ctx->allocate_temp(
+            DataTypeToEnum<T>::value, TensorShape({outer}), &staged));
+        Functor::Reduce(ctx, staged.flat<T>(),
+                        const_in.shaped<T, 2>({outer, dims[n - 1]}),
+                        constants.kOne, reducer);
+        dims.pop_back();
+      } else {
+        const int64_t inner = dims[n - 1];
+        TF_RETURN_IF_ERROR(ctx->allocate_temp(
+            DataTypeToEnum<T>::value, TensorShape({outer, inner}), &staged));
+        Functor::Reduce(ctx, staged.matrix<T>(),
+                        const_in.shaped<T, 3>({outer, dims[n - 2], inner}),
+                        constants.kOne, reducer);
+        // The kept dimensions on either side are now adjacent.
+        dims.resize(n - 2);
+        dims.back() *= inner;
+      }
+      in = staged;
+    }
+
+    const Tensor& const_in = in;
+    if (dims.size() == 3 && helper.reduce_first_axis()) {
+      Functor::Reduce(ctx, out->flat<T>(), const_in.shaped<T, 3>(dims),
+                      constants.kZeroTwo, reducer);
+    } else if (dims.size() == 3) {
+      Functor::Reduce(ctx, out->shaped<T, 2>({dims[0], dims[2]}),
+                      const_in.shaped<T, 3>(dims), constants.kOne, reducer);
+    } else if (helper.reduce_first_axis()) {
+      Functor::Reduce(ctx, out->flat<T>(), const_in.shaped<T, 2>(dims),
+                      constants.kZero, reducer);
+    } else {
+      Functor::Reduce(ctx, out->flat<T>(), const_in.shaped<T, 2>(dims),
+                      constants.kOne, reducer);
+    }
+    return OkStatus();
+  }
+
   // True if the number of dimensions should be maintained.
   bool keep_dims_;
 };
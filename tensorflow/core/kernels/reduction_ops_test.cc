@@ -81,6 +81,33 @@ static Graph* ThreeDXZReduce(const string& reduce, int num_y, int num_z) {
   return g;
 }
 
+// Reduces dimensions 1 and 3 of a [4, num_y, 4, num_z] tensor, which does not
+// simplify to three or fewer dimensions.
+static Graph* FourDYWReduce(const string& reduce, int num_y, int num_z) {
+  auto* g = new Graph(OpRegistry::Global());
+  Tensor data(DT_FLOAT, TensorShape({4, num_y, 4, num_z}));
+  data.flat<float>().setRandom();
+  Tensor axes(DT_INT32, TensorShape({2}));
+  axes.flat<int32>()(0) = 1;
+  axes.flat<int32>()(1) = 3;
+  test::graph::Reduce(g, reduce, test::graph::Constant(g, data),
+                      test::graph::Constant(g, axes));
+  return g;
+}
+
+// Reduces dimensions 0 and 2 of a [4, num_y, 4, num_z] tensor.
+static Graph* FourDXZReduce(const string& reduce, int num_y, int num_z) {
+  auto* g = new Graph(OpRegistry::Global());
+  Tensor data(DT_FLOAT, TensorShape({4, num_y, 4, num_z}));
+  data.flat<float>().setRandom();
+  Tensor axes(DT_INT32, TensorShape({2}));
+  axes.flat<int32>()(0) = 0;
+  axes.flat<int32>()(1) = 2;
+  test::graph::Reduce(g, reduce, test::graph::Constant(g, data),
+                      test::graph::Constant(g, axes));
+  return g;
+}
+
 // Creates a bench which reduces a 3D tensor with total "num" floats
 // into a scalar on a "device". Runs the bench for "iters" times.
 template <typename T>
@@ -144,6 +171,30 @@ static void Do3DXZReduce(::testing::benchmark::State& state,
                           num_y * sizeof(float));
 }
 
+static void Do4DYWReduce(::testing::benchmark::State& state,
+                         const string& device, const string& reduce, int num_y,
+                         int num_z) {
+  test::Benchmark(device, FourDYWReduce(reduce, num_y, num_z),
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 16 *
+                          num_y * num_z);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * 16 *
+                          num_y * num_z * sizeof(float));
+}
+
+static void Do4DXZReduce(::testing::benchmark::State& state,
+                         const string& device, const string& reduce, int num_y,
+                         int num_z) {
+  test::Benchmark(device, FourDXZReduce(reduce, num_y, num_z),
+                  /*old_benchmark_api*/ false)
+      .Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * 16 *
+                          num_y * num_z);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * 16 *
+                          num_y * num_z * sizeof(float));
+}
+
 static void BM_Sum2DToScalarGPU(::testing::benchmark::State& state) {
   const int num_x = state.range(0);
   const int num_y = state.range(1);
@@ -248,4 +299,28 @@ static void BM_Bool2DToScalarGPU(::testing::benchmark::State& state) {
 }
 BENCHMARK(BM_Bool2DToScalarGPU)->RangePair(2048, 8192, 2048, 8192);
 
+static void BM_Sum4DYWReduceCPU(::testing::benchmark::State& state) {
+  const int num_y = state.range(0);
+  const int num_z = state.range(1);
+
+  Do4DYWReduce(state, "cpu", "Sum", num_y, num_z);
+}
+BENCHMARK(BM_Sum4DYWReduceCPU)->RangePair(64, 4096, 64, 4096);
+
+static void BM_Sum4DXZReduceCPU(::testing::benchmark::State& state) {
+  const int num_y = state.range(0);
+  const int num_z = state.range(1);
+
+  Do4DXZReduce(state, "cpu", "Sum", num_y, num_z);
+}
+BENCHMARK(BM_Sum4DXZReduceCPU)->RangePair(64, 4096, 64, 4096);
+
+static void BM_Mean4DYWReduceCPU(::testing::benchmark::State& state) {
+  const int num_y = state.range(0);
+  const int num_z = state.range(1);
+
+  Do4DYWReduce(state, "cpu", "Mean", num_y, num_z);
+}
+BENCHMARK(BM_Mean4DYWReduceCPU)->RangePair(64, 4096, 64, 4096);
+
 }  // end namespace tensorflow
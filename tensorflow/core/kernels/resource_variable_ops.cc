@@ -57,9 +57,11 @@ limitations under the License.
 #include <type_traits>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/resource_mgr.h"
@@ -81,6 +83,7 @@ limitations under the License.
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/util.h"
 
 namespace tensorflow {
@@ -95,6 +98,7 @@ ReadVariableOp::ReadVariableOp(OpKernelConstruction* c) : OpKernel(c) {
 namespace {
 
 Status CopyVariable(int output_idx, OpKernelContext* ctx, const Tensor* t) {
+  metrics::RecordResourceVariableCopy("read", t->TotalBytes());
   Tensor* output;
   Notification n;
   Status status;
@@ -1071,34 +1075,118 @@ class ResourceScatterUpdateOp : public OpKernel {
     if (!s.ok()) {
       use_exclusive_lock_ = false;
     }
+    OP_REQUIRES_OK(c, ReadBoolFromEnvVar("TF_SCATTER_COMBINE_DUPLICATE_INDICES",
+                                         false, &combine_duplicates_));
   }
 
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
     OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    const Tensor* indices = &c->input(1);
+    const Tensor* updates = &c->input(2);
+    Tensor unique_indices;
+    Tensor combined_updates;
+    if (CombineDuplicates(c, v.get(), *indices, *updates, &unique_indices,
+                          &combined_updates)) {
+      indices = &unique_indices;
+      updates = &combined_updates;
+    }
     const bool is_non_pod_dtype = c->input_dtype(0) == DT_RESOURCE ||
                                   c->input_dtype(0) == DT_STRING ||
                                   c->input_dtype(0) == DT_VARIANT;
     if (is_non_pod_dtype || use_exclusive_lock_) {
       mutex_lock ml(*v->mu());
-      DoCompute(c);
+      DoCompute(c, v.get(), *indices, *updates);
     } else {
       // For POD dtypes, we can safely run the update without the mutex.
       tf_shared_lock ml(*v->mu());
-      DoCompute(c);
+      DoCompute(c, v.get(), *indices, *updates);
     }
   }
 
  private:
   bool use_exclusive_lock_;
+  bool combine_duplicates_;
+
+  // For additive updates on the CPU, sums the rows of `updates` whose indices
+  // are equal into `combined_updates`, with the distinct indices in
+  // `unique_indices`. This runs before the variable is locked, so that hot
+  // rows which many workers update are written once per update while the
+  // lock is held. Returns false, and leaves the update as given, if there are
+  // no duplicates or if the inputs are invalid, for DoCompute() to report.
+  bool CombineDuplicates(OpKernelContext* c, Var* v, const Tensor& indices,
+                         const Tensor& updates, Tensor* unique_indices,
+                         Tensor* combined_updates) {
+    if constexpr (std::is_same<Device, CPUDevice>::value &&
+                  (op == scatter_op::UpdateOp::ADD ||
+                   op == scatter_op::UpdateOp::SUB)) {
+      const int64_t num_indices = indices.NumElements();
+      if (!combine_duplicates_ || num_indices < 2 ||
+          num_indices > std::numeric_limits<Index>::max() ||
+          TensorShapeUtils::IsScalar(updates.shape()) ||
+          !TensorShapeUtils::StartsWith(updates.shape(), indices.shape())) {
+        return false;
+      }
+      int64_t limit;
+      {
+        tf_shared_lock ml(*v->mu());
+        const Tensor* params = v->tensor();
+        if (params->dims() < 1 ||
+            updates.dims() != indices.dims() + params->dims() - 1) {
+          return false;
+        }
+        limit = params->dim_size(0);
+      }
+      // Out of range indices are left to DoCompute(), which reports them
+      // with their position in the original `indices`.
+      const auto indices_flat = indices.flat<Index>();
+      absl::flat_hash_map<Index, Index> slots;
+      slots.reserve(num_indices);
+      std::vector<Index> slot_of(num_indices);
+      for (int64_t i = 0; i < num_indices; ++i) {
+        const Index index = internal::SubtleMustCopy(indices_flat(i));
+        if (!FastBoundsCheck(index, limit)) return false;
+        slot_of[i] = slots.emplace(index, slots.size()).first->second;
+      }
+      const Index num_unique = slots.size();
+      if (num_unique == num_indices) return false;
 
-  void DoCompute(OpKernelContext* c) {
-    core::RefCountPtr<Var> v;
-    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
+      TensorShape combined_shape({num_unique});
+      for (int d = indices.dims(); d < updates.dims(); ++d) {
+        combined_shape.AddDim(updates.dim_size(d));
+      }
+      if (!c->allocate_temp(DataTypeToEnum<Index>::v(),
+                            TensorShape({num_unique}), unique_indices)
+               .ok() ||
+          !c->allocate_temp(DataTypeToEnum<T>::v(), combined_shape,
+                            combined_updates)
+               .ok()) {
+        return false;
+      }
+      auto unique_flat = unique_indices->flat<Index>();
+      for (const auto& index_slot : slots) {
+        unique_flat(index_slot.second) = index_slot.first;
+      }
+      const int64_t row_size = updates.NumElements() / num_indices;
+      const auto updates_rows =
+          updates.shaped<T, 2>({num_indices, row_size});
+      auto combined_rows =
+          combined_updates->shaped<T, 2>({num_unique, row_size});
+      combined_rows.setZero();
+      for (int64_t i = 0; i < num_indices; ++i) {
+        combined_rows.template chip<0>(slot_of[i]) +=
+            updates_rows.template chip<0>(i);
+      }
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  void DoCompute(OpKernelContext* c, Var* v, const Tensor& indices,
+                 const Tensor& updates) {
     Tensor* params = v->tensor();
-    const Tensor& indices = c->input(1);
-    const Tensor& updates = c->input(2);
 
     // Check that rank(updates.shape) = rank(indices.shape + params.shape[1:])
     OP_REQUIRES(c,
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
@@ -247,13 +248,28 @@ void RestoreTensor(OpKernelContext* context,
 
 namespace {
 
-// Tensors larger than this threshold will be restored from a thread-pool.
+// Slices of tensors larger than this threshold will be restored from a
+// thread-pool.
 const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 
-// A restore operation for a single tensor.  Small tensors may be restored
-// directly from the op thread to improve read locality.  Large tensors can be
-// restored from a thread pool: this requires creating a separate BundleReader
-// for each restore.
+// Whether full tensors are restored as read-only tensors aliasing the
+// memory-mapped checkpoint, for serving models whose variables are never
+// updated. Set by the TF_RESTORE_MEMMAPPED_TENSORS environment variable.
+bool RestoreMemmappedTensors() {
+  static const bool restore_memmapped = []() {
+    bool value;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_RESTORE_MEMMAPPED_TENSORS", false, &value));
+    return value;
+  }();
+  return restore_memmapped;
+}
+
+// A restore operation for a single tensor or slice.  Small slices may be
+// restored directly from the op thread to improve read locality.  Large slices
+// can be restored from a thread pool: this requires creating a separate
+// BundleReader for each restore.  Full tensors are restored together by
+// BundleReader::LookupTensors() instead.
 struct RestoreOp {
   RestoreOp(OpKernelContext* context, int idx, const string& tensor_name,
             const string& shape_and_slice, const string& reader_prefix,
@@ -402,10 +418,31 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     return errors::InvalidArgument(error_msg);
   }
 
+  // Full tensors are read in a single batch, which reads the large ones
+  // concurrently and shares the reader's buffers and open files between them.
+  // In memory-mapped mode they alias the data files instead.
+  const bool restore_memmapped = RestoreMemmappedTensors();
+  std::vector<string> full_tensor_names;
+  std::vector<Tensor*> full_tensors;
   std::vector<RestoreOp*> pool_restore_ops;
   std::vector<RestoreOp*> direct_restore_ops;
   for (RestoreOp& restore_op : restore_ops) {
-    if (restore_op.should_run_in_pool(&default_reader)) {
+    if (restore_op.shape_and_slice.empty() && restore_memmapped) {
+      Tensor restored_tensor;
+      TF_RETURN_IF_ERROR(default_reader.LookupMemmapped(
+          restore_op.tensor_name, /*verify_checksum=*/false,
+          &restored_tensor));
+      context->set_output(restore_op.idx, restored_tensor);
+    } else if (restore_op.shape_and_slice.empty()) {
+      TensorShape restored_full_shape;
+      TF_RETURN_IF_ERROR(default_reader.LookupTensorShape(
+          restore_op.tensor_name, &restored_full_shape));
+      Tensor* restored_tensor;
+      TF_RETURN_IF_ERROR(context->allocate_output(
+          restore_op.idx, restored_full_shape, &restored_tensor));
+      full_tensor_names.push_back(restore_op.tensor_name);
+      full_tensors.push_back(restored_tensor);
+    } else if (restore_op.should_run_in_pool(&default_reader)) {
       pool_restore_ops.push_back(&restore_op);
     } else {
       direct_restore_ops.push_back(&restore_op);
@@ -424,7 +461,9 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
       }
     }
 
-    // Read small tensors from the op thread
+    // Read full and small sliced tensors from the op thread
+    TF_RETURN_IF_ERROR(
+        default_reader.LookupTensors(full_tensor_names, full_tensors));
     for (auto* op : direct_restore_ops) {
       TF_RETURN_IF_ERROR(op->run(&default_reader));
     }
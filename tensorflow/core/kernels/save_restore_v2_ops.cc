@@ -15,21 +15,28 @@ limitations under the License.
 
 // See docs in ../ops/io_ops.cc.
 
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/checkpoint_callback_manager.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
@@ -87,6 +94,100 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
   }
 }
 
+// Writes the named `tensors` to the V2 checkpoint at `prefix_string` using the
+// tensor bundle library.
+Status WriteTensorsV2(const string& prefix_string, const Tensor& tensor_names,
+                      const Tensor& shape_and_slices,
+                      const std::vector<Tensor>& tensors) {
+  const auto& tensor_names_flat = tensor_names.flat<tstring>();
+  const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
+
+  BundleWriter writer(Env::Default(), prefix_string);
+  TF_RETURN_IF_ERROR(writer.status());
+  VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
+
+  for (int i = 0; i < tensors.size(); ++i) {
+    const string& tensor_name = tensor_names_flat(i);
+    const Tensor& tensor = tensors[i];
+    VLOG(2) << "Starting save of " << tensor_name;
+
+    if (!shape_and_slices_flat(i).empty()) {
+      const string& shape_spec = shape_and_slices_flat(i);
+      TensorShape shape;
+      TensorSlice slice(tensor.dims());
+      TensorShape slice_shape;
+
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_spec, &shape,
+                                                        &slice, &slice_shape));
+      if (!slice_shape.IsSameSize(tensor.shape())) {
+        return errors::InvalidArgument(
+            "Slice in shape_and_slice "
+            "specification does not match the "
+            "shape of the tensor to  save: ",
+            shape_spec, ", tensor: ", tensor.shape().DebugString());
+      }
+
+      TF_RETURN_IF_ERROR(writer.AddSlice(tensor_name, shape, slice, tensor));
+    } else {
+      TF_RETURN_IF_ERROR(writer.Add(tensor_name, tensor));
+    }
+
+    if (VLOG_IS_ON(5)) {
+      if (tensor.dtype() == DT_FLOAT) {
+        const float* t_data = tensor.flat<float>().data();
+        float min = std::numeric_limits<float>::infinity();
+        float max = -std::numeric_limits<float>::infinity();
+        double avg = 0.0;
+        for (int i = 0; i < tensor.NumElements(); ++i) {
+          if (t_data[i] < min) min = t_data[i];
+          if (t_data[i] > max) max = t_data[i];
+          avg += t_data[i];
+        }
+        VLOG(5) << " min " << min << " max " << max << " avg "
+                << avg / tensor.NumElements() << " total elts "
+                << tensor.NumElements();
+      }
+    }
+
+    VLOG(2) << "Done save of " << tensor_name;
+  }
+  TF_RETURN_IF_ERROR(writer.Finish());
+  VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
+  return OkStatus();
+}
+
+// Notifies the checkpoint callbacks registered in the resource manager of the
+// op that the checkpoint at `prefix_string` was saved.
+Status NotifyCheckpointSaved(OpKernelContext* context,
+                             const string& prefix_string) {
+  ResourceMgr* resource_manager = context->resource_manager();
+  if (resource_manager == nullptr) return OkStatus();
+  checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
+  TF_RETURN_IF_ERROR(
+      resource_manager->LookupOrCreate<checkpoint::CheckpointCallbackManager>(
+          resource_manager->default_container(),
+          std::string(checkpoint::kCheckpointCallbackManagerResourceName),
+          &checkpoint_callback_manager,
+          [](checkpoint::CheckpointCallbackManager** out) {
+            *out = new checkpoint::CheckpointCallbackManager();
+            return OkStatus();
+          }));
+  checkpoint_callback_manager->Save(prefix_string);
+  checkpoint_callback_manager->Unref();
+  return OkStatus();
+}
+
+// Returns the tensors to save, the inputs of a SaveV2 or AsyncSaveV2 op.
+std::vector<Tensor> TensorsToSave(OpKernelContext* context) {
+  const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
+  std::vector<Tensor> tensors;
+  tensors.reserve(context->num_inputs() - kFixedInputs);
+  for (int i = kFixedInputs; i < context->num_inputs(); ++i) {
+    tensors.push_back(context->input(i));
+  }
+  return tensors;
+}
+
 }  // namespace
 
 // Saves a list of named tensors using the tensor bundle library.
@@ -102,85 +203,152 @@ class SaveV2 : public OpKernel {
                    shape_and_slices);
     if (!context->status().ok()) return;
 
-    const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
-    const int num_tensors = static_cast<int>(tensor_names.NumElements());
     const string& prefix_string = prefix.scalar<tstring>()();
-    const auto& tensor_names_flat = tensor_names.flat<tstring>();
-    const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
-
-    BundleWriter writer(Env::Default(), prefix_string);
-    OP_REQUIRES_OK(context, writer.status());
-    VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
-
-    for (int i = 0; i < num_tensors; ++i) {
-      const string& tensor_name = tensor_names_flat(i);
-      const Tensor& tensor = context->input(i + kFixedInputs);
-      VLOG(2) << "Starting save of " << tensor_name;
-
-      if (!shape_and_slices_flat(i).empty()) {
-        const string& shape_spec = shape_and_slices_flat(i);
-        TensorShape shape;
-        TensorSlice slice(tensor.dims());
-        TensorShape slice_shape;
-
-        OP_REQUIRES_OK(context, checkpoint::ParseShapeAndSlice(
-                                    shape_spec, &shape, &slice, &slice_shape));
-        OP_REQUIRES(context, slice_shape.IsSameSize(tensor.shape()),
-                    errors::InvalidArgument("Slice in shape_and_slice "
-                                            "specification does not match the "
-                                            "shape of the tensor to  save: ",
-                                            shape_spec, ", tensor: ",
-                                            tensor.shape().DebugString()));
-
-        OP_REQUIRES_OK(context,
-                       writer.AddSlice(tensor_name, shape, slice, tensor));
-      } else {
-        OP_REQUIRES_OK(context, writer.Add(tensor_name, tensor));
-      }
+    OP_REQUIRES_OK(context,
+                   WriteTensorsV2(prefix_string, tensor_names,
+                                  shape_and_slices, TensorsToSave(context)));
+    OP_REQUIRES_OK(context, NotifyCheckpointSaved(context, prefix_string));
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
-      if (VLOG_IS_ON(5)) {
-        if (tensor.dtype() == DT_FLOAT) {
-          const float* t_data = tensor.flat<float>().data();
-          float min = std::numeric_limits<float>::infinity();
-          float max = -std::numeric_limits<float>::infinity();
-          double avg = 0.0;
-          for (int i = 0; i < tensor.NumElements(); ++i) {
-            if (t_data[i] < min) min = t_data[i];
-            if (t_data[i] > max) max = t_data[i];
-            avg += t_data[i];
-          }
-          VLOG(5) << " min " << min << " max " << max << " avg "
-                  << avg / tensor.NumElements() << " total elts "
-                  << tensor.NumElements();
-        }
+namespace {
+
+// Writes the checkpoints of AsyncSaveV2 ops in the background, and keeps the
+// status of each write until an AwaitAsyncSaveV2 op collects it.
+class AsyncCheckpointWriter {
+ public:
+  static AsyncCheckpointWriter* Global() {
+    static AsyncCheckpointWriter* writer = new AsyncCheckpointWriter();
+    return writer;
+  }
+
+  // Runs `write` in the background. Fails if a write to `prefix` is pending.
+  Status Start(const string& prefix, std::function<Status()> write) {
+    auto pending = std::make_shared<PendingWrite>();
+    {
+      mutex_lock l(mu_);
+      auto it = writes_.find(prefix);
+      if (it != writes_.end() && !it->second->done) {
+        return errors::FailedPrecondition(
+            "A checkpoint is already being written to ", prefix,
+            "; await it with AwaitAsyncSaveV2 first");
       }
+      writes_[prefix] = pending;
+    }
+    pool_.Schedule([this, pending, write = std::move(write)]() {
+      Status status = write();
+      mutex_lock l(mu_);
+      pending->status = std::move(status);
+      pending->done = true;
+      done_.notify_all();
+    });
+    return OkStatus();
+  }
+
+  // Blocks until the write to `prefix` is done, and returns its status. Only
+  // the first call after a write finds it; other calls set `*found` to false
+  // and return OK.
+  Status Await(const string& prefix, bool* found) {
+    mutex_lock l(mu_);
+    auto it = writes_.find(prefix);
+    *found = it != writes_.end();
+    if (!*found) return OkStatus();
+    std::shared_ptr<PendingWrite> pending = it->second;
+    while (!pending->done) done_.wait(l);
+    // A new write to `prefix` may have started while waiting.
+    it = writes_.find(prefix);
+    if (it != writes_.end() && it->second == pending) writes_.erase(it);
+    return pending->status;
+  }
+
+ private:
+  struct PendingWrite {
+    bool done = false;
+    Status status;
+  };
+
+  // Checkpoints are typically written by one AsyncSaveV2 op per device, and
+  // the threads are mostly blocked on the file system.
+  AsyncCheckpointWriter()
+      : pool_(Env::Default(), "async_checkpoint_writer",
+              /*num_threads=*/8) {}
+
+  thread::ThreadPool pool_;
+  mutex mu_;
+  condition_variable done_;
+  absl::flat_hash_map<string, std::shared_ptr<PendingWrite>> writes_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace
 
-      VLOG(2) << "Done save of " << tensor_name;
+// Saves a list of named tensors like SaveV2, but writes them in the
+// background so that the step does not wait for the file system. The tensors
+// are snapshotted without copies: resource variables are copy-on-write, so
+// their later updates don't change the snapshot. Other inputs may be updated
+// in place, e.g. the values of reference variables, and are copied if the
+// `deep_copy` attr is set.
+class AsyncSaveV2 : public OpKernel {
+ public:
+  explicit AsyncSaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("deep_copy", &deep_copy_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& prefix = context->input(0);
+    const Tensor& tensor_names = context->input(1);
+    const Tensor& shape_and_slices = context->input(2);
+    ValidateInputs(true /* is save op */, context, prefix, tensor_names,
+                   shape_and_slices);
+    if (!context->status().ok()) return;
+
+    std::vector<Tensor> tensors = TensorsToSave(context);
+    if (deep_copy_) {
+      for (Tensor& tensor : tensors) tensor = tensor::DeepCopy(tensor);
     }
-    OP_REQUIRES_OK(context, writer.Finish());
-    VLOG(1) << "Done BundleWriter, prefix_string: " << prefix_string;
+    const string prefix_string = prefix.scalar<tstring>()();
+    OP_REQUIRES_OK(
+        context,
+        AsyncCheckpointWriter::Global()->Start(
+            prefix_string,
+            [prefix_string, tensor_names, shape_and_slices,
+             tensors = std::move(tensors)]() {
+              return WriteTensorsV2(prefix_string, tensor_names,
+                                    shape_and_slices, tensors);
+            }));
+  }
 
-    ResourceMgr* resource_manager = context->resource_manager();
-    if (resource_manager != nullptr) {
-      checkpoint::CheckpointCallbackManager* checkpoint_callback_manager;
-      OP_REQUIRES_OK(
-          context,
-          resource_manager
-              ->LookupOrCreate<checkpoint::CheckpointCallbackManager>(
-                  resource_manager->default_container(),
-                  std::string(
-                      checkpoint::kCheckpointCallbackManagerResourceName),
-                  &checkpoint_callback_manager,
-                  [](checkpoint::CheckpointCallbackManager** out) {
-                    *out = new checkpoint::CheckpointCallbackManager();
-                    return OkStatus();
-                  }));
-      checkpoint_callback_manager->Save(prefix_string);
-      checkpoint_callback_manager->Unref();
+ private:
+  bool deep_copy_;
+};
+REGISTER_KERNEL_BUILDER(Name("AsyncSaveV2").Device(DEVICE_CPU), AsyncSaveV2);
+
+// Waits for the checkpoint written by an AsyncSaveV2 op to `prefix` to be
+// complete, and fails if writing it failed. Does nothing if no checkpoint is
+// being written to `prefix`.
+class AwaitAsyncSaveV2 : public OpKernel {
+ public:
+  explicit AwaitAsyncSaveV2(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& prefix = context->input(0);
+    OP_REQUIRES(
+        context, TensorShapeUtils::IsScalar(prefix.shape()),
+        errors::InvalidArgument("Input prefix should be a scalar, got ",
+                                prefix.shape().DebugString(), " instead."));
+    const string& prefix_string = prefix.scalar<tstring>()();
+    bool found;
+    OP_REQUIRES_OK(context, AsyncCheckpointWriter::Global()->Await(
+                                prefix_string, &found));
+    if (found) {
+      OP_REQUIRES_OK(context, NotifyCheckpointSaved(context, prefix_string));
     }
   }
 };
-REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
+REGISTER_KERNEL_BUILDER(Name("AwaitAsyncSaveV2").Device(DEVICE_CPU),
+                        AwaitAsyncSaveV2);
 
 // Restores a list of named tensors from a tensor bundle (V2 checkpoint format).
 class RestoreV2 : public OpKernel {
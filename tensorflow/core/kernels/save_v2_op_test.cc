@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -340,5 +341,66 @@ TEST_F(SaveV2OpTest, Simple) {
   }
 }
 
+class AsyncSaveV2OpTest : public OpsTestBase {
+ protected:
+  void MakeSaveOp(const string& prefix, const string& shape_and_slice) {
+    TF_ASSERT_OK(NodeDefBuilder("save", "AsyncSaveV2")
+                     .Input(FakeInput())                     // prefix
+                     .Input(FakeInput())                     // tensor_names
+                     .Input(FakeInput())                     // shape_and_slices
+                     .Input(FakeInput({DT_FLOAT, DT_INT32}))  // tensors
+                     .Attr("deep_copy", true)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInputFromArray<tstring>(TensorShape({}), {prefix});
+    AddInputFromArray<tstring>(TensorShape({2}), {"floats", "ints"});
+    AddInputFromArray<tstring>(TensorShape({2}), {shape_and_slice, ""});
+    AddInputFromArray<float>(TensorShape({3}), {1.0f, 2.0f, 3.0f});
+    AddInputFromArray<int32>(TensorShape({2}), {4, 5});
+  }
+
+  Status Await(const string& prefix) {
+    inputs_.clear();
+    TF_RETURN_IF_ERROR(NodeDefBuilder("await", "AwaitAsyncSaveV2")
+                           .Input(FakeInput())  // prefix
+                           .Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    AddInputFromArray<tstring>(TensorShape({}), {prefix});
+    return RunOpKernel();
+  }
+};
+
+TEST_F(AsyncSaveV2OpTest, Simple) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "async_save_simple");
+  MakeSaveOp(prefix, "");
+  TF_ASSERT_OK(RunOpKernel());
+  // The tensors were snapshotted, so updating them doesn't change the
+  // checkpoint.
+  mutable_input(3).tensor->flat<float>()(0) = 100.0f;
+  TF_ASSERT_OK(Await(prefix));
+
+  BundleReader reader(Env::Default(), prefix);
+  TF_ASSERT_OK(reader.status());
+  Tensor floats;
+  TF_ASSERT_OK(reader.Lookup("floats", &floats));
+  test::ExpectTensorEqual<float>(
+      floats, test::AsTensor<float>({1.0f, 2.0f, 3.0f}, TensorShape({3})));
+  Tensor ints;
+  TF_ASSERT_OK(reader.Lookup("ints", &ints));
+  test::ExpectTensorEqual<int32>(
+      ints, test::AsTensor<int32>({4, 5}, TensorShape({2})));
+
+  // The write was awaited already.
+  TF_EXPECT_OK(Await(prefix));
+}
+
+TEST_F(AsyncSaveV2OpTest, WriteError) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "async_save_error");
+  MakeSaveOp(prefix, "not a slice spec");
+  // The slice spec is only parsed when the tensors are written.
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_TRUE(errors::IsInvalidArgument(Await(prefix)));
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/kernels/bucketed_scatter.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/scatter_nd_op.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -128,6 +129,32 @@ struct ScatterNdFunctor<CPUDevice, T, Index, OP, IXDIM> {
       }
     }
 
+    if (scatter_internal::UseBucketedScatter(d, batch_size,
+                                             Toutput.dimension(0))) {
+      return scatter_internal::BucketedScatter<Index>(
+          d, batch_size, Toutput.dimension(0), 2.5 * slice_size,
+          [&](Index loc) -> Index {
+            Index i = 0;
+            for (int dim = 0; dim < IXDIM; ++dim) {
+              const Index ix_d = internal::SubtleMustCopy(Tindices(loc, dim));
+              if (!FastBoundsCheck(ix_d, output_shape_prefix[dim])) return -1;
+              i += ix_d * batch_strides[dim];
+            }
+            return i;
+          },
+          [&](Index loc, Index i) {
+            // Each bucket runs on a single thread of `d`.
+            auto input_chip = Toutput.template chip<0>(i);
+            auto output_chip = input_chip;
+            auto update_chip = Tupdates.template chip<0>(loc);
+            update_executor::UpdateExecutor<
+                Eigen::DefaultDevice, decltype(input_chip),
+                decltype(update_chip), decltype(output_chip),
+                OP>::Execute(Eigen::DefaultDevice(), input_chip, update_chip,
+                             output_chip);
+          });
+    }
+
     for (Eigen::DenseIndex loc = 0; loc < batch_size; ++loc) {
       Index i = 0;
       bool out_of_bounds = false;
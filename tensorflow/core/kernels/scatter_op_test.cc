@@ -217,6 +217,31 @@ TEST_F(ScatterSubOpTest, StressIndexTest) {
   test::ExpectTensorEqual<int32>(expected, params_tensor);
 }
 
+TEST_F(ScatterUpdateOpTest, ManyDuplicateIndices) {
+  MakeOp(DT_INT32_REF, DT_INT32);
+  // Feed and run
+  const int kRows = 10;
+  const int kNumUpdates = 100000;
+  std::vector<int32> indices(kNumUpdates);
+  std::vector<int32> updates(kNumUpdates);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices[i] = (i * 7) % kRows;
+    updates[i] = i;
+  }
+  AddInputFromArray<int32>(TensorShape({kRows}), std::vector<int32>(kRows));
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+
+  // The last update to each row wins.
+  Tensor params_tensor = *mutable_input(0).tensor;
+  Tensor expected(allocator(), DT_INT32, TensorShape({kRows}));
+  for (int i = kNumUpdates - kRows; i < kNumUpdates; ++i) {
+    expected.flat<int32>()(indices[i]) = i;
+  }
+  test::ExpectTensorEqual<int32>(expected, params_tensor);
+}
+
 TEST_F(ScatterUpdateOpTest, Error_WrongDimsIndices) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
@@ -273,6 +273,62 @@ __device__ T ReduceBlockAlongCols(ReduceOp reduce_op, const T& value,
   return reduced;
 }
 
+// Reduces rows [begin, end) of the input within a thread block, returning the
+// result in the first row of threads. The x dimension of the block maps to the
+// inner dimension, and y threads cooperate to reduce over the rows. Must be
+// called by all threads of the block.
+template <typename Treducevec, typename Tvec, typename Tindex,
+          typename ReduceOp, typename Tinit>
+__device__ Treducevec ReduceRowsInBlock(
+    Tindex ninner_vec, Tindex x, bool x_ok, Tindex begin, Tindex end,
+    ReduceOp reduce_op, Tinit initial_value,
+    const Tvec* __restrict__ input_vec,  // [nouter or any, ninner_vec]
+    const Tindex* __restrict__ indices,  // [nouter] (optional)
+    const Tinit* __restrict__ weights) {  // [nouter or any] (optional)
+  const Tindex y = threadIdx.y;
+  Treducevec result = Treducevec(initial_value);
+  // Loop over the rows, reducing blockDim.y of them at a time.
+  for (Tindex y_offset = begin; y_offset < end; y_offset += blockDim.y) {
+    const bool y_ok = (y_offset + y) < end;
+    // Perform indirect lookup if required.
+    const Tindex y_idx = indices && y_ok ? indices[y_offset + y] : y_offset + y;
+    const int64_t input_idx = static_cast<int64_t>(y_idx) * ninner_vec + x;
+    // Load the input row from global mem.
+    Treducevec block_result =
+        x_ok && y_ok ? input_vec[input_idx] : Tvec(initial_value);
+    // Apply weights if provided.
+    if (weights && y_ok) block_result *= Tvec(weights[y_idx]);
+    // Reduce along the columns of the block, returning result in first row.
+    block_result = ReduceBlockAlongCols(reduce_op, block_result, x_ok);
+    if (y == 0 && x_ok) {
+      result = reduce_op(result, block_result);
+    }
+  }
+  return result;
+}
+
+// Returns the output value of a segment of `segment_size` rows whose reduction
+// is `result`.
+template <typename Tvec, typename Treducevec, typename Tindex, typename Tinit>
+__device__ Tvec FinalizeSegmentResult(Treducevec result, Tindex segment_size,
+                                      Tinit empty_segment_value, bool is_mean,
+                                      bool is_sqrtn) {
+  if (segment_size == 0) {
+    // Empty segment.
+    result = Treducevec(empty_segment_value);
+  } else {
+    typename RealTypeIfComplex<Tinit>::type total_weight(segment_size);
+    // Normalize the results if necessary.
+    if (is_mean) {
+      result /= Treducevec(total_weight);
+    } else if (is_sqrtn) {
+      result /= Treducevec(sqrt(total_weight));
+    }
+  }
+  // Cast from Treducevec to Tvec.
+  return static_cast<Tvec>(result);
+}
+
 // This kernel uses a 2D thread decomposition. The x dimension maps to the inner
 // dimension of the input/output. The y grid dimension maps to segments, and y
 // threads within a block cooperate to reduce over the block's segment.
@@ -304,47 +360,39 @@ __global__ void SegmentReduceVectorKernel(
       const Tindex begin = segment_offsets[seg];
       const Tindex end = segment_offsets[seg + 1];
       // Reduce over the segment.
-      Treducevec result = Treducevec(initial_value);
-      // Loop over the segment, reducing blockDim.y elements at a time.
-      for (Tindex y_offset = begin; y_offset < end; y_offset += blockDim.y) {
-        const bool y_ok = (y_offset + y) < end;
-        // Perform indirect lookup if required.
-        const Tindex y_idx =
-            indices && y_ok ? indices[y_offset + y] : y_offset + y;
-        const int64_t input_idx = static_cast<int64_t>(y_idx) * ninner_vec + x;
-        // Load the input row from global mem.
-        Treducevec block_result =
-            x_ok && y_ok ? input_vec[input_idx] : Tvec(initial_value);
-        // Apply weights if provided.
-        if (weights && y_ok) block_result *= Tvec(weights[y_idx]);
-        // Reduce along the columns of the block, returning result in first row.
-        block_result = ReduceBlockAlongCols(reduce_op, block_result, x_ok);
-        if (y == 0 && x_ok) {
-          result = reduce_op(result, block_result);
-        }
-      }
+      Treducevec result = ReduceRowsInBlock<Treducevec>(
+          ninner_vec, x, x_ok, begin, end, reduce_op, initial_value, input_vec,
+          indices, weights);
       // First row of the block stores the result to global memory.
       if (y == 0 && x_ok) {
-        if (begin == end) {
-          // Empty segment.
-          result = Treducevec(empty_segment_value);
-        } else {
-          typename RealTypeIfComplex<Tinit>::type total_weight(end - begin);
-          // Normalize the results if necessary.
-          if (is_mean) {
-            result /= Treducevec(total_weight);
-          } else if (is_sqrtn) {
-            result /= Treducevec(sqrt(total_weight));
-          }
-        }
-        // Cast from Treducevec to Tvec.
         const int64_t output_idx = static_cast<int64_t>(seg) * ninner_vec + x;
-        output_vec[output_idx] = static_cast<Tvec>(result);
+        output_vec[output_idx] = FinalizeSegmentResult<Tvec>(
+            result, end - begin, empty_segment_value, is_mean, is_sqrtn);
       }
     }
   }
 }
 
+// Returns the block shape used to reduce segments of about `avg_reduce_size`
+// rows with an inner dimension of `ninner_vec`.
+template <typename Tindex>
+dim3 SegmentReduceBlockDim(Tindex ninner_vec, Tindex avg_reduce_size) {
+  const int max_block_size = 1024;  // Can be tuned for perf (<= 1024)
+  const int min_block_size = 64;    // Can be tuned for perf
+  const Tindex ninner_pow2 = Tindex(1) << Log2Ceiling64(ninner_vec);
+  // This is a heuristic that first allocates threads in the block to the inner
+  // (x) dimension (which is most efficient) and then allocates the rest to the
+  // reduction (y) dimension (which is less efficient but increases
+  // parallelism).
+  int block_x = std::min(ninner_pow2, static_cast<Tindex>(max_block_size));
+  const Tindex avg_reduce_size_pow2 = Tindex(1)
+                                      << Log2Ceiling64(avg_reduce_size);
+  return dim3(
+      block_x,
+      std::min(static_cast<Tindex>(Eigen::divup(min_block_size, block_x)),
+               avg_reduce_size_pow2));
+}
+
 // Reduces input matrix within segments over the outer dimension. Empty segments
 // always output empty_segment_value.
 // If is_mean or is_sqrtn is true, the results are normalized using the
@@ -365,22 +413,9 @@ Status LaunchSegmentReduceVectorKernel(
     Tvec* output_vec) {             // [nsegments, ninner_vec]
   static constexpr const int kMaxGridX = (1u << 31) - 1;
   static constexpr const int kMaxGridY = (1u << 16) - 1;
-  const int max_block_size = 1024;  // Can be tuned for perf (<= 1024)
-  const int min_block_size = 64;    // Can be tuned for perf
-  const Tindex ninner_pow2 = Tindex(1) << Log2Ceiling64(ninner_vec);
-  // This is a heuristic that first allocates threads in the block to the inner
-  // (x) dimension (which is most efficient) and then allocates the rest to the
-  // reduction (y) dimension (which is less efficient but increases
-  // parallelism).
-  int block_x = std::min(ninner_pow2, static_cast<Tindex>(max_block_size));
   const Tindex avg_reduce_size =
       Eigen::divup(nouter, static_cast<Tindex>(nsegments));
-  const Tindex avg_reduce_size_pow2 = Tindex(1)
-                                      << Log2Ceiling64(avg_reduce_size);
-  dim3 block(
-      block_x,
-      std::min(static_cast<Tindex>(Eigen::divup(min_block_size, block_x)),
-               avg_reduce_size_pow2));
+  dim3 block = SegmentReduceBlockDim(ninner_vec, avg_reduce_size);
   dim3 grid(std::min(Eigen::divup(ninner_vec, static_cast<Tindex>(block.x)),
                      static_cast<Tindex>(kMaxGridX)),
             std::min(nsegments, static_cast<Tsegmentids>(kMaxGridY)));
@@ -393,6 +428,205 @@ Status LaunchSegmentReduceVectorKernel(
       is_sqrtn, input_vec, segment_offsets, indices, weights, output_vec);
 }
 
+// The balanced segment reduction never splits segments smaller than this.
+constexpr int kMinRowsPerSegmentPiece = 256;
+
+// Returns the index of the first piece of segment `seg` in the decomposition
+// used by SegmentReduceBalancedKernel. Pieces are numbered so that segment
+// `seg` owns pieces [first(seg), first(seg + 1)), which is at least one piece
+// per segment plus one per tile of `rows_per_piece` rows that it reaches.
+template <typename Tindex, typename Tsegmentids>
+__device__ int64_t FirstPieceOfSegment(const Tindex* segment_offsets,
+                                       Tsegmentids seg, Tindex rows_per_piece) {
+  return static_cast<int64_t>(seg) + segment_offsets[seg] / rows_per_piece;
+}
+
+// Load-balanced variant of SegmentReduceVectorKernel for skewed segment sizes.
+// The rows are split into tiles of `rows_per_piece` rows. Segments of at most
+// `rows_per_piece` rows are reduced by a single block as in
+// SegmentReduceVectorKernel. Larger segments are split at tile boundaries, and
+// each block reduces one of the pieces into `partials` so that no block does
+// more than `rows_per_piece` rows of work; SegmentReduceCombinePiecesKernel
+// then combines the pieces. A tile intersects at most two large segments: one
+// that started before it, whose partial goes to slot 2 * tile, and one that
+// starts in it, whose partial goes to slot 2 * tile + 1.
+template <typename Treducevec, typename Tvec, typename Tindex,
+          typename Tsegmentids, typename ReduceOp, typename Tinit>
+__global__ void SegmentReduceBalancedKernel(
+    Tindex ninner_vec, Tsegmentids nsegments, int64_t npieces,
+    Tindex rows_per_piece, ReduceOp reduce_op, Tinit initial_value,
+    Tinit empty_segment_value, bool is_mean, bool is_sqrtn,
+    const Tvec* __restrict__ input_vec,          // [nouter or any, ninner_vec]
+    const Tindex* __restrict__ segment_offsets,  // [nsegments + 1]
+    const Tindex* __restrict__ indices,          // [nouter] (optional)
+    const Tinit* __restrict__ weights,           // [nouter or any] (optional)
+    Treducevec* __restrict__ partials,           // [2 * ntiles, ninner_vec]
+    Tvec* __restrict__ output_vec) {             // [nsegments, ninner_vec]
+  const int num_blocks_x = (ninner_vec - 1) / blockDim.x + 1;
+  // Grid-stride loop over inner dimension blocks.
+  for (Tindex blk_x = blockIdx.x; blk_x < num_blocks_x; blk_x += gridDim.x) {
+    const Tindex x = threadIdx.x + blk_x * blockDim.x;
+    const Tindex y = threadIdx.y;
+    const bool x_ok = x < ninner_vec;
+    // Grid-stride loop over pieces.
+    for (int64_t piece = blockIdx.y; piece < npieces; piece += gridDim.y) {
+      // Find the segment that owns this piece.
+      Tsegmentids lo = 0;
+      Tsegmentids hi = nsegments - 1;
+      while (lo < hi) {
+        const Tsegmentids mid = lo + (hi - lo + 1) / 2;
+        if (FirstPieceOfSegment(segment_offsets, mid, rows_per_piece) <=
+            piece) {
+          lo = mid;
+        } else {
+          hi = mid - 1;
+        }
+      }
+      const Tsegmentids seg = lo;
+      const int64_t first_piece =
+          FirstPieceOfSegment(segment_offsets, seg, rows_per_piece);
+      const Tindex begin = segment_offsets[seg];
+      const Tindex end = segment_offsets[seg + 1];
+      if (end - begin <= rows_per_piece) {
+        // Small segments are reduced directly by their first piece.
+        if (piece != first_piece) continue;
+        Treducevec result = ReduceRowsInBlock<Treducevec>(
+            ninner_vec, x, x_ok, begin, end, reduce_op, initial_value,
+            input_vec, indices, weights);
+        if (y == 0 && x_ok) {
+          const int64_t output_idx = static_cast<int64_t>(seg) * ninner_vec + x;
+          output_vec[output_idx] = FinalizeSegmentResult<Tvec>(
+              result, end - begin, empty_segment_value, is_mean, is_sqrtn);
+        }
+        continue;
+      }
+      const Tindex first_tile = begin / rows_per_piece;
+      const Tindex tile = first_tile + static_cast<Tindex>(piece - first_piece);
+      const Tindex piece_begin = max(begin, tile * rows_per_piece);
+      const Tindex piece_end = min(end, (tile + 1) * rows_per_piece);
+      if (piece_begin >= piece_end) continue;
+      Treducevec result = ReduceRowsInBlock<Treducevec>(
+          ninner_vec, x, x_ok, piece_begin, piece_end, reduce_op,
+          initial_value, input_vec, indices, weights);
+      if (y == 0 && x_ok) {
+        const int64_t slot =
+            2 * static_cast<int64_t>(tile) + (tile == first_tile);
+        partials[slot * ninner_vec + x] = result;
+      }
+    }
+  }
+}
+
+// Combines the pieces of the segments that SegmentReduceBalancedKernel split,
+// in row order, and writes their output. Each split segment is handled by the
+// threads of the tile that it starts in.
+template <typename Treducevec, typename Tvec, typename Tindex,
+          typename Tsegmentids, typename ReduceOp, typename Tinit>
+__global__ void SegmentReduceCombinePiecesKernel(
+    Tindex ninner_vec, Tsegmentids nsegments, int64_t ntiles,
+    Tindex rows_per_piece, ReduceOp reduce_op, Tinit empty_segment_value,
+    bool is_mean, bool is_sqrtn,
+    const Tindex* __restrict__ segment_offsets,  // [nsegments + 1]
+    const Treducevec* __restrict__ partials,     // [2 * ntiles, ninner_vec]
+    Tvec* __restrict__ output_vec) {             // [nsegments, ninner_vec]
+  GPU_1D_KERNEL_LOOP(i, ntiles * ninner_vec) {
+    const Tindex tile = i / ninner_vec;
+    const Tindex x = i % ninner_vec;
+    // Only the last segment that starts in a tile can extend past it. Find
+    // the number of segments that start before the end of this tile.
+    const Tindex tile_end = (tile + 1) * rows_per_piece;
+    Tsegmentids lo = 0;
+    Tsegmentids hi = nsegments;
+    while (lo < hi) {
+      const Tsegmentids mid = lo + (hi - lo) / 2;
+      if (segment_offsets[mid] < tile_end) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (lo == 0) continue;
+    const Tsegmentids seg = lo - 1;
+    const Tindex begin = segment_offsets[seg];
+    const Tindex end = segment_offsets[seg + 1];
+    if (begin / rows_per_piece != tile || end - begin <= rows_per_piece) {
+      continue;
+    }
+    const Tindex last_tile = (end - 1) / rows_per_piece;
+    Treducevec result =
+        partials[(2 * static_cast<int64_t>(tile) + 1) * ninner_vec + x];
+    for (Tindex t = tile + 1; t <= last_tile; ++t) {
+      result = reduce_op(
+          result, partials[2 * static_cast<int64_t>(t) * ninner_vec + x]);
+    }
+    const int64_t output_idx = static_cast<int64_t>(seg) * ninner_vec + x;
+    output_vec[output_idx] = FinalizeSegmentResult<Tvec>(
+        result, end - begin, empty_segment_value, is_mean, is_sqrtn);
+  }
+}
+
+// Same as LaunchSegmentReduceVectorKernel, but splits segments of more than
+// `rows_per_piece` rows across thread blocks so that a few very large
+// segments do not leave the rest of the GPU idle. The extra pass over partial
+// results only does work for the segments that were split.
+template <typename Treducevec, typename Tvec, typename Tindex,
+          typename Tsegmentids, typename ReduceOp, typename Tinit>
+Status LaunchSegmentReduceBalancedKernels(
+    OpKernelContext* ctx, Tindex nouter, Tindex ninner_vec,
+    Tsegmentids nsegments, Tindex rows_per_piece, ReduceOp reduce_op,
+    Tinit initial_value, Tinit empty_segment_value, bool is_mean,
+    bool is_sqrtn,
+    const Tvec* input_vec,          // [nouter or any, ninner_vec]
+    const Tindex* segment_offsets,  // [nsegments + 1]
+    const Tindex* indices,          // [nouter] (optional)
+    const Tinit* weights,           // [nouter or any] (optional)
+    Tvec* output_vec) {             // [nsegments, ninner_vec]
+  static constexpr const int kMaxGridX = (1u << 31) - 1;
+  static constexpr const int kMaxGridY = (1u << 16) - 1;
+  const GPUDevice& d = ctx->eigen_gpu_device();
+  const int64_t ntiles = Eigen::divup(nouter, rows_per_piece);
+  // Note: We must allocate and reinterpret as bytes because Treducevec may
+  // be a vector type and they are not supported as Tensor dtypes.
+  Tensor partials;
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(
+      DT_INT8,
+      TensorShape({static_cast<int64_t>(2 * ntiles * ninner_vec *
+                                        sizeof(Treducevec))}),
+      &partials));
+  Treducevec* partials_ptr =
+      reinterpret_cast<Treducevec*>(partials.flat<int8>().data());
+
+  const int64_t npieces =
+      static_cast<int64_t>(nsegments) + nouter / rows_per_piece;
+  const Tindex avg_reduce_size =
+      Eigen::divup(nouter, static_cast<Tindex>(nsegments));
+  dim3 block = SegmentReduceBlockDim(ninner_vec,
+                                     std::min(rows_per_piece, avg_reduce_size));
+  dim3 grid(std::min(Eigen::divup(ninner_vec, static_cast<Tindex>(block.x)),
+                     static_cast<Tindex>(kMaxGridX)),
+            std::min(npieces, static_cast<int64_t>(kMaxGridY)));
+  unsigned shared_memory_bytes = block.x * block.y * sizeof(Treducevec);
+  TF_RETURN_IF_ERROR(GpuLaunchKernel(
+      SegmentReduceBalancedKernel<Treducevec, Tvec, Tindex, Tsegmentids,
+                                  ReduceOp, Tinit>,
+      grid, block, shared_memory_bytes, d.stream(), ninner_vec, nsegments,
+      npieces, rows_per_piece, reduce_op, initial_value, empty_segment_value,
+      is_mean, is_sqrtn, input_vec, segment_offsets, indices, weights,
+      partials_ptr, output_vec));
+
+  GpuLaunchConfig config = GetGpuLaunchConfig(
+      ntiles * ninner_vec, d,
+      &SegmentReduceCombinePiecesKernel<Treducevec, Tvec, Tindex, Tsegmentids,
+                                        ReduceOp, Tinit>,
+      /*dynamic_shared_memory_size=*/0, /*block_size_limit=*/0);
+  return GpuLaunchKernel(
+      SegmentReduceCombinePiecesKernel<Treducevec, Tvec, Tindex, Tsegmentids,
+                                       ReduceOp, Tinit>,
+      config.block_count, config.thread_per_block, 0, d.stream(), ninner_vec,
+      nsegments, ntiles, rows_per_piece, reduce_op, empty_segment_value,
+      is_mean, is_sqrtn, segment_offsets, partials_ptr, output_vec);
+}
+
 template <typename Tvec, typename Treducevec, typename Tindex,
           typename Tsegmentids, typename Tinit>
 __global__ void SegmentReduceEpilogueKernel(
@@ -581,6 +815,20 @@ Status SegmentReduceGPUImpl(
         is_mean, is_sqrtn, input_vec, segment_offsets_ptr, indices, weights,
         output_vec);
   }
+  // Segments much larger than the average would serialize the custom kernel
+  // below on a few thread blocks, so when there are enough rows for such
+  // segments to exist, the balanced variant splits them. Whether a segment is
+  // split is decided on the device from its size, so this does not need to
+  // read the segment sizes back to the host.
+  const Tindex rows_per_piece =
+      std::max<Tindex>(kMinRowsPerSegmentPiece,
+                       Tindex(4) << Log2Ceiling64(avg_reduce_size));
+  if (nouter > rows_per_piece) {
+    return LaunchSegmentReduceBalancedKernels<Treducevec>(
+        ctx, nouter, ninner_vec, nsegments, rows_per_piece, reduce_op,
+        initial_value, empty_segment_value, is_mean, is_sqrtn, input_vec,
+        segment_offsets_ptr, indices, weights, output_vec);
+  }
   // Here we use a custom kernel that is optimized for ninner_vec >= ~64 and
   // gives decent performance for smaller cases. It also handles indices,
   // casting to/from Treducevec, and normalizing the output.
@@ -19,17 +19,150 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_tensor_dense_matmul_op.h"
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+// Private attr that marks a_indices as constant across steps (e.g. a fixed
+// sparsity pattern). CPU kernels with this attr set group the nonzeros by
+// output row once per input buffer instead of on every call.
+constexpr char kCacheConstantIndicesAttr[] = "_cache_constant_a_indices";
+
+namespace {
+
+Status KOutOfBoundsError(int64_t k, std::size_t i, int rhs_index_a,
+                         std::size_t lhs_right) {
+  return errors::InvalidArgument("k (", k, ") from index[", i, ",", rhs_index_a,
+                                 "] out of bounds (>=", lhs_right, ")");
+}
+
+Status MOutOfBoundsError(int64_t m, std::size_t i, int lhs_index_a,
+                         int64_t out_dim0) {
+  return errors::InvalidArgument("m (", m, ") from index[", i, ",", lhs_index_a,
+                                 "] out of bounds (>=", out_dim0, ")");
+}
+
+// Products with fewer multiply-adds than this run the serial COO loop.
+constexpr int64_t kMinSparseRowsProduct = 1 << 16;
+
+// Output columns updated together, so that the block of an output row stays
+// in L1 while the matching rows of B stream through.
+constexpr int64_t kSparseRowsColumnBlock = 256;
+
+// The nonzeros of the sparse operand in CSR form: grouped by output row, and
+// in their original order within each row.
+struct SparseRows {
+  int64_t num_rows = 0;
+  int64_t num_cols = 0;
+  // Entries of row r are [row_starts[r], row_starts[r + 1]).
+  std::vector<int64_t> row_starts;
+  // For each entry, its position in a_indices and a_values.
+  std::vector<int64_t> positions;
+  // For each entry, its column, i.e. the row of B it is multiplied with.
+  std::vector<int64_t> cols;
+};
+
+// Groups `a_indices` into `rows`, validating it against an output with
+// `num_rows` rows and an inner dimension of `num_cols`.
+template <typename Tindices>
+Status BuildSparseRows(typename TTypes<Tindices>::ConstMatrix a_indices,
+                       bool adjoint_a, int64_t num_rows, int64_t num_cols,
+                       SparseRows* rows) {
+  const int lhs_index_a = adjoint_a ? 1 : 0;
+  const int rhs_index_a = adjoint_a ? 0 : 1;
+  const int64_t nnz = a_indices.dimension(0);
+  rows->num_rows = num_rows;
+  rows->num_cols = num_cols;
+  rows->row_starts.assign(num_rows + 1, 0);
+  rows->positions.resize(nnz);
+  rows->cols.resize(nnz);
+
+  std::vector<int64_t> entry_rows(nnz);
+  std::vector<int64_t> entry_cols(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const Tindices m = internal::SubtleMustCopy(a_indices(i, lhs_index_a));
+    const Tindices k = internal::SubtleMustCopy(a_indices(i, rhs_index_a));
+    if (!FastBoundsCheck(k, num_cols)) {
+      return KOutOfBoundsError(k, i, rhs_index_a, num_cols);
+    }
+    if (!FastBoundsCheck(m, num_rows)) {
+      return MOutOfBoundsError(m, i, lhs_index_a, num_rows);
+    }
+    entry_rows[i] = m;
+    entry_cols[i] = k;
+    ++rows->row_starts[m + 1];
+  }
+  for (int64_t r = 0; r < num_rows; ++r) {
+    rows->row_starts[r + 1] += rows->row_starts[r];
+  }
+  std::vector<int64_t> next(rows->row_starts.begin(),
+                            rows->row_starts.end() - 1);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const int64_t entry = next[entry_rows[i]]++;
+    rows->positions[entry] = i;
+    rows->cols[entry] = entry_cols[i];
+  }
+  return OkStatus();
+}
+
+// Computes out = A * B, where A is given by `rows` and `a_values`, and B is
+// a row-major [rows.num_cols, out.dimension(1)] matrix at `b`. Output rows
+// are split across the CPU worker threads, so no two threads touch the same
+// row, and each output element sums its terms in the order of a_indices.
+template <typename T, typename Tsum>
+void SparseRowsDenseMatMul(OpKernelContext* ctx, const SparseRows& rows,
+                           typename TTypes<T>::ConstVec a_values,
+                           bool adjoint_a, const T* b,
+                           typename TTypes<Tsum>::Matrix out) {
+  const int64_t num_out_cols = out.dimension(1);
+  auto compute_rows = [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; ++r) {
+      Tsum* out_row = &out(r, 0);
+      std::fill(out_row, out_row + num_out_cols, Tsum(0));
+      for (int64_t n_begin = 0; n_begin < num_out_cols;
+           n_begin += kSparseRowsColumnBlock) {
+        const int64_t n_end =
+            std::min(n_begin + kSparseRowsColumnBlock, num_out_cols);
+        for (int64_t j = rows.row_starts[r]; j < rows.row_starts[r + 1]; ++j) {
+          const T a_value = a_values(rows.positions[j]);
+          const Tsum a =
+              static_cast<Tsum>(adjoint_a ? functor::MaybeConj(a_value)
+                                          : a_value);
+          const T* b_row = b + rows.cols[j] * num_out_cols;
+          for (int64_t n = n_begin; n < n_end; ++n) {
+            out_row[n] += a * static_cast<Tsum>(b_row[n]);
+          }
+        }
+      }
+    }
+  };
+  const double avg_row_nnz =
+      static_cast<double>(rows.positions.size()) / rows.num_rows;
+  const int64_t cost_per_row =
+      static_cast<int64_t>((avg_row_nnz + 1) * num_out_cols * 2);
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *(ctx->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers, rows.num_rows,
+        cost_per_row, compute_rows);
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Tindices>
 class SparseTensorDenseMatMulOp : public OpKernel {
  public:
@@ -37,6 +170,10 @@ class SparseTensorDenseMatMulOp : public OpKernel {
       : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("adjoint_a", &adjoint_a_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("adjoint_b", &adjoint_b_));
+    if (std::is_same<Device, CPUDevice>::value) {
+      TryGetNodeAttr(ctx->def(), kCacheConstantIndicesAttr,
+                     &cache_constant_indices_);
+    }
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -133,6 +270,15 @@ class SparseTensorDenseMatMulOp : public OpKernel {
       return;
     }
 
+    if constexpr (std::is_same<Device, CPUDevice>::value) {
+      if (cache_constant_indices_ ||
+          nnz * outer_right >= kMinSparseRowsProduct) {
+        OP_REQUIRES_OK(ctx, ComputeWithSparseRows(ctx, *a_indices, *a_values,
+                                                  *b, inner_left, out));
+        return;
+      }
+    }
+
 #define MAYBE_ADJOINT(ADJ_A, ADJ_B)                                           \
   if (adjoint_a_ == ADJ_A && adjoint_b_ == ADJ_B) {                           \
     Status functor_status = functor::SparseTensorDenseMatMulFunctor<          \
@@ -151,8 +297,78 @@ class SparseTensorDenseMatMulOp : public OpKernel {
   }
 
  private:
+  // Computes `out` from the CSR form of a_indices, which is cached if
+  // cache_constant_indices_ is set. CPU only.
+  Status ComputeWithSparseRows(OpKernelContext* ctx, const Tensor& a_indices,
+                               const Tensor& a_values, const Tensor& b,
+                               int64_t inner, Tensor* out) {
+    const int64_t num_rows = out->dim_size(0);
+    std::shared_ptr<const SparseRows> rows;
+    if (cache_constant_indices_) {
+      mutex_lock l(mu_);
+      if (sparse_rows_ == nullptr ||
+          sparse_rows_source_.data() != a_indices.data() ||
+          sparse_rows_source_.shape() != a_indices.shape() ||
+          sparse_rows_->num_rows != num_rows ||
+          sparse_rows_->num_cols != inner) {
+        auto new_rows = std::make_shared<SparseRows>();
+        TF_RETURN_IF_ERROR(BuildSparseRows<Tindices>(
+            a_indices.matrix<Tindices>(), adjoint_a_, num_rows, inner,
+            new_rows.get()));
+        sparse_rows_ = std::move(new_rows);
+        sparse_rows_source_ = a_indices;
+      }
+      rows = sparse_rows_;
+    } else {
+      auto new_rows = std::make_shared<SparseRows>();
+      TF_RETURN_IF_ERROR(BuildSparseRows<Tindices>(
+          a_indices.matrix<Tindices>(), adjoint_a_, num_rows, inner,
+          new_rows.get()));
+      rows = std::move(new_rows);
+    }
+
+    // Each entry of A reads a whole row of op(B), so materialize the
+    // adjoint of B once.
+    const T* b_data = b.flat<T>().data();
+    Tensor b_adjoint;
+    if (adjoint_b_) {
+      TF_RETURN_IF_ERROR(ctx->allocate_temp(
+          DataTypeToEnum<T>::value, TensorShape({b.dim_size(1), b.dim_size(0)}),
+          &b_adjoint));
+      Eigen::array<int, 2> shuffle{1, 0};
+      b_adjoint.matrix<T>().device(ctx->eigen_device<CPUDevice>()) =
+          b.matrix<T>().shuffle(shuffle).conjugate();
+      b_data = b_adjoint.flat<T>().data();
+    }
+
+    using Tsum = typename functor::SumType<T>::type;
+    if constexpr (std::is_same<T, Tsum>::value) {
+      SparseRowsDenseMatMul<T, Tsum>(ctx, *rows, a_values.vec<T>(), adjoint_a_,
+                                     b_data, out->matrix<T>());
+    } else {
+      Tensor sum;
+      TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<Tsum>::value,
+                                            out->shape(), &sum));
+      SparseRowsDenseMatMul<T, Tsum>(ctx, *rows, a_values.vec<T>(), adjoint_a_,
+                                     b_data, sum.matrix<Tsum>());
+      out->matrix<T>().device(ctx->eigen_device<CPUDevice>()) =
+          sum.matrix<Tsum>().template cast<T>();
+    }
+    return OkStatus();
+  }
+
   bool adjoint_a_;
   bool adjoint_b_;
+
+  // Set from kCacheConstantIndicesAttr; always false on devices other than
+  // CPU.
+  bool cache_constant_indices_ = false;
+  mutex mu_;
+  // The a_indices tensor that `sparse_rows_` was built from. Holding a
+  // reference keeps its buffer alive, so a matching data pointer identifies
+  // the same indices rather than a recycled allocation.
+  Tensor sparse_rows_source_ TF_GUARDED_BY(mu_);
+  std::shared_ptr<const SparseRows> sparse_rows_ TF_GUARDED_BY(mu_);
 };
 
 #define REGISTER_CPU(TypeT, TypeIndex)           \
@@ -238,18 +454,6 @@ REGISTER_KERNELS_GPU(complex128);
 namespace functor {
 
 namespace {
-Status KOutOfBoundsError(int64_t k, std::size_t i, int rhs_index_a,
-                         std::size_t lhs_right) {
-  return errors::InvalidArgument("k (", k, ") from index[", i, ",", rhs_index_a,
-                                 "] out of bounds (>=", lhs_right, ")");
-}
-
-Status MOutOfBoundsError(int64_t m, std::size_t i, int lhs_index_a,
-                         int64_t out_dim0) {
-  return errors::InvalidArgument("m (", m, ") from index[", i, ",", lhs_index_a,
-                                 "] out of bounds (>=", out_dim0, ")");
-}
-
 template <typename T, typename Tsum, typename Tindices, bool ADJ_A, bool ADJ_B>
 Status SparseTensorDenseMatMulImpl(
     typename TTypes<Tsum>::Matrix out,
@@ -16,13 +16,61 @@ limitations under the License.
 #include <random>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
+class SparseTensorDenseMatMulCacheIndicesTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("matmul", "SparseTensorDenseMatMul")
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("_cache_constant_a_indices", true)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(SparseTensorDenseMatMulCacheIndicesTest, NewValuesAndIndices) {
+  MakeOp();
+  // A = [[0, 2], [3, 4]].
+  AddInputFromArray<int64_t>(TensorShape({3, 2}), {0, 1, 1, 0, 1, 1});
+  AddInputFromArray<float>(TensorShape({3}), {2, 3, 4});
+  AddInputFromArray<int64_t>(TensorShape({2}), {2, 2});
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 0, 1, 0, 1, 1});
+  Tensor expected = test::AsTensor<float>({0, 2, 2, 3, 4, 7}, {2, 3});
+  for (int step = 0; step < 2; ++step) {
+    TF_ASSERT_OK(RunOpKernel());
+    test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+  }
+
+  // Only the indices are cached, not the values.
+  inputs_[1]->flat<float>().setConstant(1);
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({0, 1, 1, 1, 1, 2}, {2, 3}), *GetOutput(0));
+
+  // New indices live in a different buffer and are grouped again.
+  inputs_.clear();
+  AddInputFromArray<int64_t>(TensorShape({2, 2}), {0, 0, 1, 1});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<int64_t>(TensorShape({2}), {2, 2});
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 0, 1, 0, 1, 1});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({1, 0, 1, 0, 2, 2}, {2, 3}), *GetOutput(0));
+}
+
 Node* SparseTensorDenseMatMulNode(Graph* g, Node* a_indices, Node* a_values,
                                   Node* a_shape, Node* b, bool adjoint_a,
                                   bool adjoint_b) {
@@ -19,7 +19,11 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sparse_xent_op.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
@@ -86,10 +90,6 @@ class SparseSoftmaxXentWithLogitsOp : public OpKernel {
               " GPU-accelerated path when determinsim is enabled."));
     }
 
-    Tensor scratch;
-    OP_REQUIRES_OK(context, context->allocate_temp(DataTypeToEnum<T>::value,
-                                                   labels.shape(), &scratch));
-
     Tensor* loss_out = nullptr;
     OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
                                 {1}, 0, labels.shape(), &loss_out));
@@ -104,22 +104,116 @@ class SparseSoftmaxXentWithLogitsOp : public OpKernel {
       }
       functor::SparseXentFunctor<Device, T, Index> functor;
       functor(context, logits.matrix<T>(), labels.vec<Index>(),
-              scratch.vec<T>(), loss_out->vec<T>(), back_out->matrix<T>());
+              loss_out->vec<T>(), back_out->matrix<T>());
     }
   }
 };
 
-// Partial specialization for a CPUDevice, that uses the Eigen implementation
-// from XentEigenImpl.
+// Partial specialization for a CPUDevice. Rows are split into blocks of
+// columns that fit in cache, so that a single row with many classes is still
+// processed in parallel. The first pass computes the softmax normalizer of
+// each block, and the second combines those of each row and writes the loss
+// and backprop.
 namespace functor {
 template <typename T, typename Index>
 struct SparseXentFunctor<CPUDevice, T, Index> {
+  using Acc = typename SparseXentAccumulator<T>::type;
+  using Normalizer = SoftmaxNormalizer<Acc>;
+  using ConstBlock = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+  using Block = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+  // Columns per block.
+  static constexpr int64_t kBlockSize = 4096;
+
   void operator()(OpKernelContext* ctx, typename TTypes<T>::ConstMatrix logits,
                   typename TTypes<Index>::ConstVec labels,
-                  typename TTypes<T>::Vec scratch, typename TTypes<T>::Vec loss,
+                  typename TTypes<T>::Vec loss,
                   typename TTypes<T>::Matrix backprop) {
-    SparseXentEigenImpl<CPUDevice, T, Index>::Compute(ctx, logits, labels,
-                                                      scratch, loss, backprop);
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    const int64_t num_rows = logits.dimension(0);
+    const int64_t num_cols = logits.dimension(1);
+    const int64_t num_blocks = (num_cols + kBlockSize - 1) / kBlockSize;
+    const int64_t block_size = std::min(num_cols, kBlockSize);
+    const T* logits_data = logits.data();
+    T* backprop_data = backprop.data();
+
+    // Returns the first column and the number of columns of `block`.
+    auto block_extent = [&](int64_t block) {
+      const int64_t begin = block * kBlockSize;
+      return std::make_pair(begin, std::min(kBlockSize, num_cols - begin));
+    };
+
+    std::vector<Normalizer> normalizers(num_rows * num_blocks);
+    const Eigen::TensorOpCost normalizer_cost(
+        block_size * sizeof(T), 0,
+        block_size * (Eigen::TensorOpCost::AddCost<Acc>() +
+                      Eigen::internal::functor_traits<
+                          Eigen::internal::scalar_exp_op<Acc>>::Cost));
+    d.parallelFor(
+        num_rows * num_blocks, normalizer_cost,
+        [&](Eigen::Index first, Eigen::Index last) {
+          for (Eigen::Index unit = first; unit < last; ++unit) {
+            const auto [begin, size] = block_extent(unit % num_blocks);
+            const auto x =
+                ConstBlock(logits_data + (unit / num_blocks) * num_cols +
+                               begin,
+                           size)
+                    .template cast<Acc>();
+            const Acc max = x.maxCoeff();
+            // A block of masked out logits contributes nothing.
+            normalizers[unit] =
+                max == -Eigen::NumTraits<Acc>::infinity()
+                    ? Normalizer::Empty()
+                    : Normalizer{max, (x - max).exp().sum()};
+          }
+        });
+
+    const Eigen::TensorOpCost backprop_cost(
+        block_size * sizeof(T), block_size * sizeof(T),
+        num_blocks * 2 * Eigen::TensorOpCost::AddCost<Acc>() +
+            block_size * (Eigen::TensorOpCost::AddCost<Acc>() +
+                          Eigen::TensorOpCost::DivCost<Acc>() +
+                          Eigen::internal::functor_traits<
+                              Eigen::internal::scalar_exp_op<Acc>>::Cost));
+    d.parallelFor(
+        num_rows * num_blocks, backprop_cost,
+        [&](Eigen::Index first, Eigen::Index last) {
+          for (Eigen::Index unit = first; unit < last; ++unit) {
+            const int64_t row = unit / num_blocks;
+            const auto [begin, size] = block_extent(unit % num_blocks);
+            Normalizer normalizer = Normalizer::Empty();
+            for (int64_t b = 0; b < num_blocks; ++b) {
+              normalizer = CombineNormalizers(
+                  normalizer, normalizers[row * num_blocks + b]);
+            }
+            const T* x = logits_data + row * num_cols + begin;
+            T* y = backprop_data + row * num_cols + begin;
+            const Index label = internal::SubtleMustCopy(labels(row));
+            if (!FastBoundsCheck(label, num_cols)) {
+              Block(y, size).setConstant(
+                  Eigen::NumTraits<T>::quiet_NaN());
+              if (begin == 0) loss(row) = Eigen::NumTraits<T>::quiet_NaN();
+              continue;
+            }
+            // `backprop` may alias `logits`, so the logit of the label is
+            // read before its block is overwritten.
+            const bool has_label = label >= begin && label < begin + size;
+            const Acc label_logit =
+                has_label ? static_cast<Acc>(x[label - begin]) : Acc(0);
+            Block(y, size) =
+                ((ConstBlock(x, size).template cast<Acc>() - normalizer.max)
+                     .exp() /
+                 normalizer.sum)
+                    .template cast<T>();
+            if (has_label) {
+              const Acc shifted_logit = label_logit - normalizer.max;
+              loss(row) = static_cast<T>(Eigen::numext::log(normalizer.sum) -
+                                         shifted_logit);
+              y[label - begin] = static_cast<T>(
+                  Eigen::numext::exp(shifted_logit) / normalizer.sum - Acc(1));
+            }
+          }
+        });
   }
 };
 }  // namespace functor
@@ -18,7 +18,6 @@ limitations under the License.
 // Functor definition for SparseXentOp, must be compilable by nvcc.
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
-#include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/platform/macros.h"
@@ -26,205 +25,64 @@ limitations under the License.
 
 namespace tensorflow {
 
-namespace sparse_xent_helpers {
+namespace functor {
 
-template <typename T>
-typename TTypes<const T, 1>::Tensor32Bit To32BitConst(
-    typename TTypes<T>::Vec in) {
-  return To32Bit(typename TTypes<T>::ConstVec(in.data(), in.dimensions()));
-}
+// The normalizer of a softmax over some logits: their maximum, and the sum of
+// exp(logit - max) over them. Normalizers of disjoint sets of logits can be
+// combined, so they can be computed in a single pass with a running maximum.
+template <typename Acc>
+struct SoftmaxNormalizer {
+  Acc max;
+  Acc sum;
+
+  // The normalizer of no logits.
+  static EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE SoftmaxNormalizer Empty() {
+    return {-Eigen::NumTraits<Acc>::infinity(), Acc(0)};
+  }
+};
 
-template <typename T>
-typename TTypes<const T, 2>::Tensor32Bit To32BitConst(
-    typename TTypes<T>::Matrix in) {
-  return To32Bit(typename TTypes<T>::ConstMatrix(in.data(), in.dimensions()));
+// Returns the normalizer of the union of the logits of `a` and `b`.
+template <typename Acc>
+EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE SoftmaxNormalizer<Acc> CombineNormalizers(
+    const SoftmaxNormalizer<Acc>& a, const SoftmaxNormalizer<Acc>& b) {
+  if (b.sum == Acc(0)) return a;
+  if (a.sum == Acc(0)) return b;
+  const Acc max = a.max > b.max ? a.max : b.max;
+  return {max, a.sum * Eigen::numext::exp(a.max - max) +
+                   b.sum * Eigen::numext::exp(b.max - max)};
 }
 
-}  // namespace sparse_xent_helpers
-
-namespace generator {
-
-// Generator for calculation of the sparse Xent loss.
-// This generator takes the logits, the sum of the exponentiated
-// logits, and the label indices.  For each minibatch entry, ignoring
-// the batch index b, it calculates:
-//
-//   loss[j] = (log(sum_exp_logits) - logits[j]) * 1{ j == label }
-//
-// for j = 0 .. num_classes.  This value must be summed over all j for
-// the final loss.
-template <typename T, typename Index>
-class SparseXentLossGenerator {
- public:
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE SparseXentLossGenerator(
-      typename TTypes<const T, 2>::Tensor32Bit logits,
-      typename TTypes<const T, 1>::Tensor32Bit sum_exp_logits,
-      typename TTypes<const Index, 1>::Tensor32Bit labels,
-      const Index max_depth)
-      : logits_(logits),
-        sum_exp_logits_(sum_exp_logits),
-        labels_(labels),
-        max_depth_(max_depth) {}
-
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE T
-  operator()(const Eigen::array<int, 2>& coords) const {
-    const int batch = coords[0];
-    const int depth = coords[1];
-    const Index label = tensorflow::internal::SubtleMustCopy(labels_(batch));
-    if (!FastBoundsCheck(label, max_depth_)) {
-      return Eigen::NumTraits<T>::quiet_NaN();
-    }
-    return TF_PREDICT_FALSE(label == depth)
-               ? (Eigen::numext::log(sum_exp_logits_(batch)) - logits_(coords))
-               : T(0.0);
-  };
-
- private:
-  typename TTypes<const T, 2>::Tensor32Bit logits_;
-  typename TTypes<const T, 1>::Tensor32Bit sum_exp_logits_;
-  typename TTypes<const Index, 1>::Tensor32Bit labels_;
-  const Index max_depth_;
-};
-
-// Generator for calculation of the sparse Xent gradient.
-// This generator takes the exponentiated logits, their sums, and the label
-// indices. For each minibatch entry, ignoring the batch index b, it calculates:
-//
-//   exp_logits[j] / sum_exp_logits - 1{ j == label }
-//
-// for j = 0 .. num_classes.
-template <typename T, typename Index>
-class SparseXentGradGenerator {
- public:
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE SparseXentGradGenerator(
-      typename TTypes<const T, 2>::Tensor32Bit exp_logits,
-      typename TTypes<const T, 1>::Tensor32Bit sum_exp_logits,
-      typename TTypes<const Index, 1>::Tensor32Bit labels,
-      const Index max_depth)
-      : exp_logits_(exp_logits),
-        sum_exp_logits_(sum_exp_logits),
-        labels_(labels),
-        max_depth_(max_depth) {}
-
-  EIGEN_DEVICE_FUNC EIGEN_ALWAYS_INLINE T
-  operator()(const Eigen::array<int, 2>& coords) const {
-    const int batch = coords[0];
-    const int depth = coords[1];
-    const Index label = tensorflow::internal::SubtleMustCopy(labels_(batch));
-    if (!FastBoundsCheck(label, max_depth_)) {
-      return Eigen::NumTraits<T>::quiet_NaN();
-    }
-    T subtract = TF_PREDICT_FALSE(depth == label) ? T(1.0) : T(0.0);
-    return exp_logits_(coords) / sum_exp_logits_(batch) - subtract;
-  };
-
- private:
-  typename TTypes<const T, 2>::Tensor32Bit exp_logits_;
-  typename TTypes<const T, 1>::Tensor32Bit sum_exp_logits_;
-  typename TTypes<const Index, 1>::Tensor32Bit labels_;
-  const Index max_depth_;
+// Type used to accumulate softmax normalizers of T.
+template <typename T>
+struct SparseXentAccumulator {
+  using type = float;
 };
 
-}  // namespace generator
-
-namespace functor {
-
-template <typename Device, typename T>
-struct RowMaxReduction {
-  // Computes the maximum across the rows of logits
-  //
-  // logits: batch_size, num_classes.
-  // maximum: temporary tensor, dims: batch_size, 1
-  static inline void Compute(OpKernelContext* ctx,
-                             typename TTypes<T>::ConstMatrix logits,
-                             typename TTypes<T>::Vec maximum) {
-    Eigen::IndexList<Eigen::type2index<1> > along_row;
-    Device d = ctx->eigen_device<Device>();
-    To32Bit(maximum).device(d) = To32Bit(logits).maximum(along_row);
-  }
+template <>
+struct SparseXentAccumulator<double> {
+  using type = double;
 };
 
-// Functor used by SparseXentOp to do the computations.
+// Functor used by SparseXentOp to do the computations. Each row of logits is
+// read once to compute its softmax normalizer, and once more to write the
+// backprop, which also gives the loss.
 template <typename Device, typename T, typename Index>
 struct SparseXentFunctor {
   // Computes Cross Entropy loss and backprop.
   //
   // logits: batch_size, num_classes.
-  // labels: num_classes.
-  // scratch: temporary tensor, dims: batch_size, 1
+  // labels: batch_size.
   // loss: output tensor for the loss, dims: batch_size.
   // backprop: output tensor for the backprop, dims: batch_size, num_classes.
+  //
+  // The loss and backprop of rows with an out of range label are NaN.
+  // `backprop` may alias `logits`.
   void operator()(OpKernelContext* ctx, typename TTypes<T>::ConstMatrix logits,
                   typename TTypes<Index>::ConstVec labels,
-                  typename TTypes<T>::Vec scratch, typename TTypes<T>::Vec loss,
+                  typename TTypes<T>::Vec loss,
                   typename TTypes<T>::Matrix backprop);
 };
 
-// Eigen code implementing SparseXentFunctor::operator().
-// This code works for both CPU and GPU and is used by the functor
-// specializations for both device types.
-template <typename Device, typename T, typename Index>
-struct SparseXentEigenImpl {
-  static void Compute(OpKernelContext* ctx,
-                      typename TTypes<T>::ConstMatrix logits,
-                      typename TTypes<Index>::ConstVec labels,
-                      typename TTypes<T>::Vec scratch,
-                      typename TTypes<T>::Vec loss,
-                      typename TTypes<T>::Matrix backprop) {
-    // NOTE(touts): This duplicates some of the computations in softmax_op
-    // because we need the intermediate (logits -max(logits)) values to
-    // avoid a log(exp()) in the computation of the loss.
-
-    const int kBatchDim = 0;
-    const int kClassDim = 1;
-
-    const int batch_size = logits.dimension(kBatchDim);
-    const int num_classes = logits.dimension(kClassDim);
-
-// These arrays are used to reduce along the class dimension, and broadcast
-// the resulting value to all classes.
-    Eigen::IndexList<Eigen::type2index<kClassDim> > along_class;
-    Eigen::IndexList<int, Eigen::type2index<1> > batch_by_one;
-    batch_by_one.set(0, batch_size);
-    Eigen::IndexList<int> batch_only;
-    batch_only.set(0, batch_size);
-    Eigen::IndexList<Eigen::type2index<1>, int> one_by_class;
-    one_by_class.set(1, num_classes);
-
-    // scratch = max_logits along classes.
-    RowMaxReduction<Device, T>::Compute(ctx, logits, scratch);
-
-    Device d = ctx->eigen_device<Device>();
-    // backprop = logits - max_logits.
-    To32Bit(backprop).device(d) =
-        To32Bit(logits) -
-        To32Bit(scratch).reshape(batch_by_one).broadcast(one_by_class);
-
-    // scratch = sum(exp(logits - max_logits)) along classes.
-    To32Bit(scratch).device(d) = To32Bit(backprop).exp().sum(along_class);
-
-    //  sum(-labels *
-    //     ((logits - max_logits) - log(sum(exp(logits - max_logits)))))
-    //  along classes
-    generator::SparseXentLossGenerator<T, Index> sparse_xent_loss_gen(
-        sparse_xent_helpers::To32BitConst<T>(backprop),
-        sparse_xent_helpers::To32BitConst<T>(scratch), To32Bit(labels),
-        backprop.dimension(1) /* max_depth */);
-    To32Bit(loss).device(d) =
-        To32Bit(backprop).generate(sparse_xent_loss_gen).sum(along_class);
-
-    // backprop: prob - labels, where
-    //   prob = exp(logits - max_logits) / sum(exp(logits - max_logits))
-    To32Bit(backprop).device(d) = To32Bit(backprop).exp();
-    generator::SparseXentGradGenerator<T, Index> sparse_xent_grad_gen(
-        sparse_xent_helpers::To32BitConst<T>(backprop),
-        sparse_xent_helpers::To32BitConst<T>(scratch), To32Bit(labels),
-        backprop.dimension(1) /* max_depth */);
-    To32Bit(backprop).device(d) =
-        To32Bit(backprop).generate(sparse_xent_grad_gen);
-  }
-};
-
 }  // namespace functor
 
 }  // namespace tensorflow
@@ -17,67 +17,115 @@ limitations under the License.
 
 #define EIGEN_USE_GPU
 
+#include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/kernels/gpu_prim.h"
-#include "tensorflow/core/kernels/reduction_gpu_kernels.cu.h"
-#include "tensorflow/core/kernels/reduction_ops_common.h"
 #include "tensorflow/core/kernels/sparse_xent_op.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/gpu_kernel_helper.h"
 
 namespace tensorflow {
 
 typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
+namespace {
 
-// Partial specialization for a GPUDevice, that uses the CUB implementation
-// from reduction_gpu_kernels.cu.h.
-template <typename T>
-struct RowMaxReduction<GPUDevice, T> {
-  // Computes the maximum across the rows of logits
-  //
-  // logits: batch_size, num_classes.
-  // maximum: temporary tensor, dims: batch_size, 1
-  static inline void Compute(OpKernelContext* ctx,
-                             typename TTypes<T>::ConstMatrix logits,
-                             typename TTypes<T>::Vec maximum) {
-    const int kBatchDim = 0;
-    const int kClassDim = 1;
-    const int rows = logits.dimension(kBatchDim);
-    const int cols = logits.dimension(kClassDim);
-
-    typedef const Eigen::array<TTypes<float>::Tensor::Index, 1>& ReductionAxes;
-    Constants<GPUDevice> constants;
-    gpuprim::Max op;
-    functor::ReduceImpl<T, gpuprim::Max, T*, const T*, ReductionAxes>(
-        ctx, maximum.data(), logits.data(), 2, rows, cols, 1, 1, constants.kOne,
-        op);
+constexpr int kThreadsPerRow = 256;
+
+template <typename Acc>
+struct CombineNormalizersOp {
+  __device__ SoftmaxNormalizer<Acc> operator()(
+      const SoftmaxNormalizer<Acc>& a, const SoftmaxNormalizer<Acc>& b) const {
+    return CombineNormalizers(a, b);
   }
 };
 
-// Partial specialization for a GPUDevice, that uses the Eigen implementation
-// from XentEigenImpl.
+// Computes the loss and backprop of one row per block. Each thread keeps the
+// softmax normalizer of its columns with a running maximum, so the logits are
+// read once to normalize and once more to write the backprop.
+template <typename T, typename Index>
+__global__ __launch_bounds__(kThreadsPerRow) void SparseXentKernel(
+    const T* logits, const Index* __restrict__ labels, const int64_t num_cols,
+    T* __restrict__ loss, T* backprop) {
+  using Acc = typename SparseXentAccumulator<T>::type;
+  using Normalizer = SoftmaxNormalizer<Acc>;
+  typedef gpuprim::BlockReduce<Normalizer, kThreadsPerRow> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  __shared__ Normalizer row_normalizer;
+
+  // `backprop` may alias `logits`, but each logit is only overwritten by the
+  // thread that read it last.
+  const int64_t row = blockIdx.x;
+  const T* row_logits = logits + row * num_cols;
+  T* row_backprop = backprop + row * num_cols;
+
+  Normalizer normalizer = Normalizer::Empty();
+  for (int64_t col = threadIdx.x; col < num_cols; col += kThreadsPerRow) {
+    const Acc x = static_cast<Acc>(ldg(row_logits + col));
+    if (x > normalizer.max) {
+      normalizer.sum =
+          normalizer.sum * Eigen::numext::exp(normalizer.max - x) + Acc(1);
+      normalizer.max = x;
+    } else if (x != -Eigen::NumTraits<Acc>::infinity()) {
+      normalizer.sum += Eigen::numext::exp(x - normalizer.max);
+    }
+  }
+  normalizer =
+      BlockReduce(temp_storage).Reduce(normalizer, CombineNormalizersOp<Acc>());
+
+  const Index label = ldg(labels + row);
+  const bool valid_label = FastBoundsCheck(label, num_cols);
+  if (threadIdx.x == 0) {
+    row_normalizer = normalizer;
+    loss[row] = valid_label
+                    ? static_cast<T>(
+                          Eigen::numext::log(normalizer.sum) + normalizer.max -
+                          static_cast<Acc>(row_logits[label]))
+                    : Eigen::NumTraits<T>::quiet_NaN();
+  }
+  __syncthreads();
+  normalizer = row_normalizer;
+
+  for (int64_t col = threadIdx.x; col < num_cols; col += kThreadsPerRow) {
+    if (!valid_label) {
+      row_backprop[col] = Eigen::NumTraits<T>::quiet_NaN();
+      continue;
+    }
+    const Acc x = static_cast<Acc>(row_logits[col]);
+    const Acc prob = Eigen::numext::exp(x - normalizer.max) / normalizer.sum;
+    row_backprop[col] = static_cast<T>(col == label ? prob - Acc(1) : prob);
+  }
+}
+
+}  // namespace
+
+// Partial specialization for a GPUDevice, that normalizes each row of logits
+// in a single pass with one block per row.
 template <typename T, typename Index>
 struct SparseXentFunctor<GPUDevice, T, Index> {
   void operator()(OpKernelContext* ctx, typename TTypes<T>::ConstMatrix logits,
                   typename TTypes<Index>::ConstVec labels,
-                  typename TTypes<T>::Vec scratch, typename TTypes<T>::Vec loss,
+                  typename TTypes<T>::Vec loss,
                   typename TTypes<T>::Matrix backprop) {
-    SparseXentEigenImpl<GPUDevice, T, Index>::Compute(ctx, logits, labels,
-                                                      scratch, loss, backprop);
+    const GPUDevice& d = ctx->eigen_device<GPUDevice>();
+    const int num_rows = logits.dimension(0);
+    const int64_t num_cols = logits.dimension(1);
+    OP_REQUIRES_OK(
+        ctx, GpuLaunchKernel(SparseXentKernel<T, Index>, num_rows,
+                             kThreadsPerRow, 0, d.stream(), logits.data(),
+                             labels.data(), num_cols, loss.data(),
+                             backprop.data()));
   }
 };
 }  // end namespace functor
 
-// Instantiate the GPU implementation for float.
+// Instantiate the GPU implementation for float, half and bfloat16.
 #define REGISTER(Index)                                                      \
   template struct functor::SparseXentFunctor<GPUDevice, float, Index>;       \
-  template class generator::SparseXentGradGenerator<float, Index>;           \
   template struct functor::SparseXentFunctor<GPUDevice, Eigen::half, Index>; \
-  template class generator::SparseXentGradGenerator<Eigen::half, Index>;     \
   template struct functor::SparseXentFunctor<GPUDevice, Eigen::bfloat16,     \
-                                             Index>;                         \
-  template class generator::SparseXentGradGenerator<Eigen::bfloat16, Index>;
+                                             Index>;
 REGISTER(int32)
 REGISTER(int64)
 #undef REGISTER
@@ -74,6 +74,7 @@ BM_SparseXentDev(64, 100000, gpu, float, DT_FLOAT);
 
 // CPU
 #define BM_SparseXentDev_CPU(C_TYPE, TF_TYPE)         \
+  BM_SparseXentDev(1, 1000000, cpu, C_TYPE, TF_TYPE); \
   BM_SparseXentDev(8, 1000000, cpu, C_TYPE, TF_TYPE); \
   BM_SparseXentDev(16, 10000, cpu, C_TYPE, TF_TYPE);  \
   BM_SparseXentDev(16, 100000, cpu, C_TYPE, TF_TYPE); \
@@ -36,6 +36,68 @@ namespace tensorflow {
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Orders the column indices of a row by decreasing value, breaking ties in
+// favor of the lower index.
+template <typename T>
+struct StableGreater {
+  bool operator()(const int32_t a, const int32_t b) const {
+    if (input_data[b] < input_data[a]) {
+      return true;
+    } else if (input_data[b] > input_data[a]) {
+      return false;
+    } else {
+      return a < b;
+    }
+  }
+
+  const T* input_data;
+};
+
+template <typename T>
+using TopKFilter = gtl::TopN<int32, StableGreater<T>>;
+
+// Pushes columns [begin, end) of a row into `filter`. Columns are visited in
+// increasing order, so once the filter is full a column can only enter it if
+// its value is strictly greater than the k-th largest value seen so far. The
+// scan compares against that threshold and leaves the heap alone for
+// everything else.
+template <typename T>
+void PushColumns(const T* input_data, int32_t begin, int32_t end,
+                 TopKFilter<T>* filter) {
+  int32_t c = begin;
+  for (; c < end && filter->size() < filter->limit(); ++c) {
+    filter->push(c);
+  }
+  if (c == end) return;
+  T threshold = input_data[filter->peek_bottom()];
+  for (; c < end; ++c) {
+    if (input_data[c] > threshold) {
+      filter->push(c);
+      threshold = input_data[filter->peek_bottom()];
+    }
+  }
+}
+
+// Rows are only split into blocks of at least this many columns.
+constexpr int64_t kMinColsPerTopKBlock = 1 << 15;
+
+// Returns how many blocks to split each row into so that there is enough
+// work for `num_threads`, or 1 if rows should be processed whole. Blocks are
+// kept at least 16 * k columns wide so that merging the k candidates of each
+// block is cheap compared to selecting them.
+int64_t NumTopKBlocks(int64_t num_rows, int64_t num_cols, int k,
+                      int num_threads) {
+  if (num_rows >= num_threads || k == num_cols) return 1;
+  const int64_t max_blocks =
+      num_cols / std::max<int64_t>(kMinColsPerTopKBlock, 16 * int64_t{k});
+  const int64_t blocks_per_row = (num_threads + num_rows - 1) / num_rows;
+  return std::max<int64_t>(1, std::min(max_blocks, blocks_per_row));
+}
+
+}  // namespace
+
 template <typename Device, typename T>
 class TopK : public OpKernel {
  public:
@@ -141,19 +203,18 @@ struct TopKFunctor<CPUDevice, T> {
       return OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    const int64_t num_blocks =
+        NumTopKBlocks(num_rows, num_cols, k, worker_threads.num_threads);
+    if (num_blocks > 1) {
+      return ComputeInBlocks(context, sorted, k, input, num_rows, num_cols,
+                             num_blocks, values, indices);
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
-        const auto stable_comp = [input_data](const int32_t a,
-                                              const int32_t b) {
-          if (input_data[b] < input_data[a]) {
-            return true;
-          } else if (input_data[b] > input_data[a]) {
-            return false;
-          } else {
-            return a < b;
-          }
-        };
+        const StableGreater<T> stable_comp{input_data};
         const auto comp = [input_data](const int32_t a, const int32_t b) {
           return input_data[b] < input_data[a];
         };
@@ -186,11 +247,9 @@ struct TopKFunctor<CPUDevice, T> {
           }
         } else {
           // Use the TopN heap object to sort.
-          gtl::TopN<int32, decltype(stable_comp)> filter(k, stable_comp);
+          TopKFilter<T> filter(k, stable_comp);
           filter.reserve(num_cols);
-          for (int32_t c = 0; c < num_cols; ++c) {
-            filter.push(c);
-          }
+          PushColumns(input_data, 0, num_cols, &filter);
 
           int32_t i = 0;
           if (sorted) {
@@ -228,12 +287,77 @@ struct TopKFunctor<CPUDevice, T> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
     return OkStatus();
   }
+
+ private:
+  // Splits each row into `num_blocks` blocks, selects the top k of all
+  // blocks in parallel, then selects the top k of each row from the
+  // num_blocks * k candidates of its blocks. The indices match those of the
+  // whole-row selection because StableGreater is a total order on columns of
+  // non-NaN values.
+  static Status ComputeInBlocks(
+      OpKernelContext* context, bool sorted, int k,
+      const typename TTypes<T, 2>::ConstTensor& input, const int64_t num_rows,
+      const int64_t num_cols, const int64_t num_blocks,
+      typename TTypes<T, 2>::Tensor values,
+      typename TTypes<int, 2>::Tensor indices) {
+    Tensor candidates_t;
+    TF_RETURN_IF_ERROR(context->allocate_temp(
+        DT_INT32, TensorShape({num_rows, num_blocks * k}), &candidates_t));
+    auto candidates = candidates_t.matrix<int32>();
+    const int64_t block_cols = (num_cols + num_blocks - 1) / num_blocks;
+
+    auto SelectBlocks = [&](int64_t start_block, int64_t limit_block) {
+      for (int64_t i = start_block; i < limit_block; ++i) {
+        const int64_t b = i / num_blocks;
+        const int64_t block = i % num_blocks;
+        const int64_t begin = block * block_cols;
+        const int64_t end = std::min(num_cols, begin + block_cols);
+        DCHECK_GE(end - begin, k);
+        const T* input_data = &input(b, 0);
+        TopKFilter<T> filter(k, StableGreater<T>{input_data});
+        filter.reserve(k);
+        PushColumns(input_data, begin, end, &filter);
+        std::copy(filter.unsorted_begin(), filter.unsorted_end(),
+                  &candidates(b, block * k));
+      }
+    };
+
+    auto MergeBlocks = [&](int64_t start_batch, int64_t limit_batch) {
+      for (int64_t b = start_batch; b < limit_batch; ++b) {
+        const StableGreater<T> stable_comp{&input(b, 0)};
+        int32* begin = &candidates(b, 0);
+        int32* end = begin + num_blocks * k;
+        std::nth_element(begin, begin + k - 1, end, stable_comp);
+        if (sorted) {
+          std::sort(begin, begin + k, stable_comp);
+        }
+        std::copy(begin, begin + k, &indices(b, 0));
+        std::transform(
+            &indices(b, 0), &indices(b, k), &values(b, 0),
+            [b, &input](const int32_t loc) { return input(b, loc); });
+      }
+    };
+
+    // Most columns of a block fail the threshold test, so selecting a block
+    // costs about one comparison per column.
+    const double cmp_cost = Eigen::TensorOpCost::AddCost<T>();
+    const double log_k = Eigen::numext::log2(static_cast<float>(k + 1));
+    const int64_t select_cost =
+        static_cast<int64_t>(cmp_cost * (block_cols + 4 * k * log_k));
+    const int64_t merge_cost = static_cast<int64_t>(
+        cmp_cost * (num_blocks * k + (sorted ? k * log_k : 0)));
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_rows * num_blocks, select_cost, SelectBlocks);
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          merge_cost, MergeBlocks);
+    return OkStatus();
+  }
 };
 
 }  // namespace functor
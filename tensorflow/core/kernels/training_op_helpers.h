@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 #define TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
 
+#include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/variant_op_registry.h"
@@ -41,6 +42,8 @@ Status EnsureSparseVariableAccess(OpKernelContext* ctx, Var* var) {
     var->copy_on_read_mode.store(true);
     return OkStatus();
   }
+  metrics::RecordResourceVariableCopy("sparse_access",
+                                      var->tensor()->TotalBytes());
   Tensor tmp;
   if (std::is_same<T, Variant>::value) {
     AllocatorAttributes attr;
@@ -197,6 +200,7 @@ Status PrepareToUpdateVariable(OpKernelContext* ctx, Tensor* tensor,
   if (copy_on_read_mode || !tensor->RefCountIsOne()) {
     // Tensor's buffer is in use by some read, so we need to copy before
     // updating.
+    metrics::RecordResourceVariableCopy("update", tensor->TotalBytes());
     Tensor tmp;
     if (std::is_same<T, Variant>::value) {
       AllocatorAttributes attr;
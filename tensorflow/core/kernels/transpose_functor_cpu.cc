@@ -25,12 +25,70 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/platform/platform.h"
+
+#if !defined(IS_MOBILE_PLATFORM)
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+#include "tensorflow/compiler/xla/pjrt/transpose.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#endif  // !defined(IS_MOBILE_PLATFORM)
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
 namespace tensorflow {
 namespace {
 
+#if !defined(IS_MOBILE_PLATFORM)
+// Smaller transposes are not worth a plan lookup.
+constexpr int64_t kMinPlannedTransposeSize = 1 << 15;
+
+// Transpose plans for recently seen shapes, shared by all CPU devices.
+struct TransposePlanCache {
+  mutex mu;
+  xla::TransposePlanCache cache TF_GUARDED_BY(mu){/*capacity=*/64};
+};
+
+// Transposes `in` into `out` with the tiled, vectorized transpose that PjRt
+// uses for host buffers. Returns false if it cannot handle this transpose.
+template <typename T>
+bool TransposeUsingPlan(const CPUDevice& device, const Tensor& in,
+                        const gtl::ArraySlice<int32> perm, Tensor* out) {
+  if (!std::is_trivially_copyable<T>::value ||
+      in.NumElements() < kMinPlannedTransposeSize) {
+    return false;
+  }
+  static TransposePlanCache* plans = new TransposePlanCache;
+  const gtl::InlinedVector<int64_t, 4> dims = in.shape().dim_sizes();
+  const gtl::InlinedVector<int64_t, 8> permutation(perm.begin(), perm.end());
+  std::shared_ptr<xla::TransposePlan> plan;
+  {
+    mutex_lock l(plans->mu);
+    auto plan_or = plans->cache.GetOrCreate(
+        sizeof(T), dims, permutation, xla::TransposePlan::Tiling{},
+        xla::TransposePlan::Tiling{}, xla::TransposePlan::Transformation::kNone,
+        device.numThreads());
+    if (!plan_or.ok()) return false;
+    plan = *std::move(plan_or);
+  }
+  plan->Execute(in.tensor_data().data(),
+                const_cast<char*>(out->tensor_data().data()),
+                [&device](std::function<void()> fn) {
+                  // Execute() blocks until all its work is done, so run it
+                  // inline rather than wait on the pool from inside it.
+                  if (device.currentThreadId() >= 0) {
+                    fn();
+                  } else {
+                    device.enqueueNoNotification(std::move(fn));
+                  }
+                });
+  return true;
+}
+#endif  // !defined(IS_MOBILE_PLATFORM)
+
 template <typename T, bool conjugate>
 void TransposeSimple(const CPUDevice& device, const Tensor& in,
                      const gtl::ArraySlice<int32> perm, Tensor* out) {
@@ -74,6 +132,9 @@ template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+#if !defined(IS_MOBILE_PLATFORM)
+    if (!conjugate && TransposeUsingPlan<T>(d, in, perm, out)) return;
+#endif  // !defined(IS_MOBILE_PLATFORM)
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <vector>
+
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/kernels/uniform_quant_ops/math_utils.h"
 #include "tensorflow/core/kernels/uniform_quant_ops/tensor_utils.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -53,9 +57,14 @@ Status DotInputShapeValid(const TensorShape& lhs_shape,
 //     int64_t output_channel_idx)
 // for each output element, accumulate value using acc_f along the contracting
 // dimension and writes the accumulated value using output_f.
+//
+// A row of lhs is accumulated into a whole row of output at a time, so that
+// the innermost loop reads rhs and writes the accumulators contiguously. Rows
+// are sharded across the intra-op thread pool.
 template <typename Tlhs, typename Trhs, typename Tout, typename AccF,
           typename OutputF>
-void DotWithAccFunctionAndOutputFunction(const Tensor& lhs, const Tensor& rhs,
+void DotWithAccFunctionAndOutputFunction(OpKernelContext* context,
+                                         const Tensor& lhs, const Tensor& rhs,
                                          Tensor& output, const AccF& acc_f,
                                          const OutputF& output_f) {
   const int64_t batches = output.dim_size(0);
@@ -66,24 +75,36 @@ void DotWithAccFunctionAndOutputFunction(const Tensor& lhs, const Tensor& rhs,
   const Trhs* rhs_data = rhs.flat<Trhs>().data();
   Tout* output_data = output.flat<Tout>().data();
 
-  for (int64_t b = 0; b < batches; ++b) {
-    for (int64_t out_c = 0; out_c < output_depth; ++out_c) {
-      int32_t acc = 0;
+  auto compute_rows = [&](int64_t start, int64_t limit) {
+    std::vector<int32_t> acc(output_depth);
+    for (int64_t b = start; b < limit; ++b) {
+      std::fill(acc.begin(), acc.end(), 0);
+      const Tlhs* lhs_row = lhs_data + b * accum_depth;
       for (int64_t d = 0; d < accum_depth; ++d) {
-        acc += acc_f(lhs_data[b * accum_depth + d],
-                     rhs_data[d * output_depth + out_c], b, out_c);
+        const Tlhs lhs_val = lhs_row[d];
+        const Trhs* rhs_row = rhs_data + d * output_depth;
+        for (int64_t out_c = 0; out_c < output_depth; ++out_c) {
+          acc[out_c] += acc_f(lhs_val, rhs_row[out_c], b, out_c);
+        }
+      }
+      Tout* output_row = output_data + b * output_depth;
+      for (int64_t out_c = 0; out_c < output_depth; ++out_c) {
+        output_row[out_c] = output_f(acc[out_c], b, out_c);
       }
-      output_data[b * output_depth + out_c] = output_f(acc, b, out_c);
     }
-  }
+  };
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, batches,
+        /*cost_per_unit=*/std::max<int64_t>(1, accum_depth * output_depth),
+        compute_rows);
 }
 
 // Performs dot on per-tensor quantized lhs and per-tensor quantized rhs.
 template <typename Tin, typename Tout>
 Status EvalLhsPerTensorAndRhsPerTensorQuantizedDot(
-    const Tensor& lhs, const Tensor& rhs, float lhs_scale,
-    int32_t lhs_zero_point, float rhs_scale, int32_t rhs_zero_point,
-    float output_scale, int32_t output_zero_point,
+    OpKernelContext* context, const Tensor& lhs, const Tensor& rhs,
+    float lhs_scale, int32_t lhs_zero_point, float rhs_scale,
+    int32_t rhs_zero_point, float output_scale, int32_t output_zero_point,
     int output_quantization_min_val, int output_quantization_max_val,
     Tensor& output) {
   const double effective_multiplier =
@@ -94,7 +115,7 @@ Status EvalLhsPerTensorAndRhsPerTensorQuantizedDot(
       effective_multiplier, effective_quantized_multiplier, effective_shift));
 
   DotWithAccFunctionAndOutputFunction<Tin, Tin, Tout>(
-      lhs, rhs, output,
+      context, lhs, rhs, output,
       [lhs_zero_point, rhs_zero_point](Tin lhs_val, Tin rhs_val, int64_t b,
                                        int64_t out_c) {
         return static_cast<Tout>(
@@ -161,7 +182,7 @@ Status EvalLhsPerTensorAndRhsPerChannelQuantizedDot(
   const int32_t* output_zero_points_data =
       output_zero_points.flat<int32_t>().data();
   DotWithAccFunctionAndOutputFunction<Tin, Tin, Tout>(
-      lhs, rhs, output,
+      context, lhs, rhs, output,
       [lhs_zero_point, rhs_zero_points_data](Tin lhs_val, Tin rhs_val,
                                              int64_t b, int64_t out_c) {
         return (static_cast<int32_t>(lhs_val) - lhs_zero_point) *
@@ -192,7 +213,7 @@ void EvalLhsPerBatchAndRhsPerTensorQuantizedDot(
   const int32_t* lhs_zero_points_data = lhs_zero_points.flat<int32_t>().data();
 
   DotWithAccFunctionAndOutputFunction<Tlhs, Trhs, float>(
-      lhs, rhs, output,
+      context, lhs, rhs, output,
       [lhs_zero_points_data, rhs_zero_point](Tlhs lhs_val, Trhs rhs_val,
                                              int64_t b, int64_t out_c) {
         return (static_cast<int32_t>(lhs_val) - lhs_zero_points_data[b]) *
@@ -207,16 +228,16 @@ void EvalLhsPerBatchAndRhsPerTensorQuantizedDot(
 // (dimension 1) quantized rhs.
 template <typename Tlhs, typename Trhs>
 void EvalLhsPerBatchAndRhsPerChannelQuantizedDot(
-    const Tensor& lhs, const Tensor& rhs, const Tensor& lhs_scales,
-    const Tensor& lhs_zero_points, const Tensor& rhs_scales,
-    const Tensor& rhs_zero_points, Tensor& output) {
+    OpKernelContext* context, const Tensor& lhs, const Tensor& rhs,
+    const Tensor& lhs_scales, const Tensor& lhs_zero_points,
+    const Tensor& rhs_scales, const Tensor& rhs_zero_points, Tensor& output) {
   const float* lhs_scales_data = lhs_scales.flat<float>().data();
   const int32_t* lhs_zero_points_data = lhs_zero_points.flat<int32_t>().data();
   const float* rhs_scales_data = rhs_scales.flat<float>().data();
   const int32_t* rhs_zero_points_data = rhs_zero_points.flat<int32_t>().data();
 
   DotWithAccFunctionAndOutputFunction<Tlhs, Trhs, float>(
-      lhs, rhs, output,
+      context, lhs, rhs, output,
       [lhs_zero_points_data, rhs_zero_points_data](Tlhs lhs_val, Trhs rhs_val,
                                                    int64_t b, int64_t out_c) {
         return (static_cast<int32_t>(lhs_val) - lhs_zero_points_data[b]) *
@@ -253,7 +274,7 @@ Status EvalQuantizedDot(OpKernelContext* context, const Tensor& lhs,
     const float output_scale = output_scales.scalar<float>()();
     const int32_t output_zero_point = output_zero_points.scalar<int32_t>()();
     return EvalLhsPerTensorAndRhsPerTensorQuantizedDot<Tin, Tout>(
-        lhs, rhs, lhs_scale, lhs_zero_point, rhs_scale, rhs_zero_point,
+        context, lhs, rhs, lhs_scale, lhs_zero_point, rhs_scale, rhs_zero_point,
         output_scale, output_zero_point, output_quantization_min_val,
         output_quantization_max_val, output);
   }
@@ -292,7 +313,7 @@ Status EvalHybridDot(OpKernelContext* context, const Tensor& lhs,
   }
   if (rhs_scales.dims() != 0) {
     EvalLhsPerBatchAndRhsPerChannelQuantizedDot<qint8, Trhs>(
-        lhs_quantized, rhs, lhs_scales, lhs_zero_points, rhs_scales,
+        context, lhs_quantized, rhs, lhs_scales, lhs_zero_points, rhs_scales,
         rhs_zero_points, output);
   } else {
     EvalLhsPerBatchAndRhsPerTensorQuantizedDot<qint8, Trhs>(
@@ -13,9 +13,11 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -68,6 +71,20 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
   using map_type = std::unordered_map<bfloat16, TIndex>;
 };
 
+// Inputs with at least this many elements are uniquified in parallel on CPU.
+constexpr int64_t kMinParallelUniqueSize = 1 << 16;
+
+// The partition of an element is stored in a byte.
+constexpr int kMaxUniquePartitions = 256;
+
+// Maps the hash `h` of an element to one of `num_partitions` partitions.
+// The hash is scrambled first so that the elements of a partition do not
+// share the hash bits that the per-partition map relies on.
+inline int UniquePartition(size_t h, int num_partitions) {
+  const uint64 top_bits = (uint64{h} * 0x9E3779B97F4A7C15ULL) >> 56;
+  return static_cast<int>((top_bits * num_partitions) >> 8);
+}
+
 // `UniqueOp` computes the unique elements in the input tensor.
 //
 // * `T` is the element type.
@@ -76,7 +93,9 @@ struct UniqueOpHashMap<bfloat16, TIndex> {
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
-  explicit UniqueOp(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit UniqueOp(OpKernelConstruction* context)
+      : OpKernel(context),
+        is_cpu_device_(context->device_type() == DEVICE_CPU) {}
 
   void Compute(OpKernelContext* context) override {
     const Tensor& input = context->input(0);
@@ -143,7 +162,18 @@ class UniqueOp : public OpKernel {
     auto idx_vec = idx->template vec<TIndex>();
 
     int64_t uniq_size;
-    if (new_sizes[0] == 1 && new_sizes[2] == 1) {
+    int num_partitions = 1;
+    if (is_cpu_device_ && new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        new_sizes[1] >= kMinParallelUniqueSize) {
+      const int num_threads =
+          context->device()->tensorflow_cpu_worker_threads()->num_threads;
+      num_partitions = std::min(num_threads, kMaxUniquePartitions);
+    }
+    if (num_partitions > 1) {
+      OP_REQUIRES_OK(context, ComputeInPartitions(context, input, axis,
+                                                  num_partitions, idx_vec,
+                                                  &uniq_size));
+    } else if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
       // elements. Here we put T directly into the map rather than ints pointing
       // to them as in the general case.
@@ -237,6 +267,136 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  using HashMap = typename UniqueOpHashMap<T, TIndex>::map_type;
+
+  // Uniquifies the 1-D `input` like the serial single-element path, but in
+  // parallel:
+  //
+  // 1. The positions of the input are scattered by the hash of their element
+  //    into `num_partitions` lists, each in increasing position order.
+  // 2. Each partition is uniquified on its own, recording for every position
+  //    the position of the first occurrence of its element.
+  // 3. A prefix sum over the first occurrences assigns the output indices,
+  //    so the output keeps the first-occurrence order of the serial path.
+  Status ComputeInPartitions(OpKernelContext* context, const Tensor& input,
+                             int64_t axis, int num_partitions,
+                             typename TTypes<TIndex>::Vec idx_vec,
+                             int64_t* uniq_size) {
+    auto Tin = input.flat<T>();
+    const int64_t N = Tin.size();
+    const int num_chunks = num_partitions;
+    const int64_t chunk_size = (N + num_chunks - 1) / num_chunks;
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    // The cost of hashing an element and touching a map entry, roughly.
+    const int64_t cost_per_element = 50;
+    auto ForEachChunk = [&](const std::function<void(int, int64_t, int64_t)>&
+                                fn) {
+      Shard(worker_threads.num_threads, worker_threads.workers, num_chunks,
+            cost_per_element * chunk_size, [&](int64_t start, int64_t limit) {
+              for (int64_t c = start; c < limit; ++c) {
+                fn(c, c * chunk_size, std::min(N, (c + 1) * chunk_size));
+              }
+            });
+    };
+
+    Tensor partition_t, positions_t, first_t;
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(DT_UINT8, TensorShape({N}), &partition_t));
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(DT_INT32, TensorShape({N}), &positions_t));
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(DT_INT32, TensorShape({N}), &first_t));
+    auto partition = partition_t.flat<uint8>();
+    auto positions = positions_t.flat<int32>();
+    auto first = first_t.flat<int32>();
+
+    // 1. Count the elements of each partition in each chunk, then scatter
+    // the positions so that partition p occupies
+    // [partition_begin[p], partition_begin[p + 1]).
+    std::vector<int64_t> offsets(num_chunks * num_partitions, 0);
+    ForEachChunk([&](int c, int64_t begin, int64_t end) {
+      int64_t* counts = &offsets[c * num_partitions];
+      typename HashMap::hasher hasher;
+      for (int64_t i = begin; i < end; ++i) {
+        const typename HashMap::key_type key = Tin(i);
+        partition(i) = UniquePartition(hasher(key), num_partitions);
+        ++counts[partition(i)];
+      }
+    });
+    std::vector<int64_t> partition_begin(num_partitions + 1, 0);
+    int64_t offset = 0;
+    for (int p = 0; p < num_partitions; ++p) {
+      partition_begin[p] = offset;
+      for (int c = 0; c < num_chunks; ++c) {
+        const int64_t count = offsets[c * num_partitions + p];
+        offsets[c * num_partitions + p] = offset;
+        offset += count;
+      }
+    }
+    partition_begin[num_partitions] = offset;
+    ForEachChunk([&](int c, int64_t begin, int64_t end) {
+      int64_t* next = &offsets[c * num_partitions];
+      for (int64_t i = begin; i < end; ++i) {
+        positions(next[partition(i)]++) = static_cast<int32>(i);
+      }
+    });
+
+    // 2. Uniquify each partition.
+    Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+          cost_per_element * chunk_size, [&](int64_t start, int64_t limit) {
+            for (int64_t p = start; p < limit; ++p) {
+              HashMap uniq;
+              uniq.reserve(2 * (partition_begin[p + 1] - partition_begin[p]));
+              for (int64_t j = partition_begin[p]; j < partition_begin[p + 1];
+                   ++j) {
+                const int32 i = positions(j);
+                first(i) =
+                    static_cast<int32>(uniq.emplace(Tin(i), i).first->second);
+              }
+            }
+          });
+
+    // 3. Number the first occurrences in position order, then point every
+    // other position at the index of its first occurrence.
+    std::vector<int64_t> chunk_uniques(num_chunks + 1, 0);
+    ForEachChunk([&](int c, int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        chunk_uniques[c + 1] += first(i) == i;
+      }
+    });
+    for (int c = 0; c < num_chunks; ++c) {
+      chunk_uniques[c + 1] += chunk_uniques[c];
+    }
+    *uniq_size = chunk_uniques[num_chunks];
+
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, *uniq_size);
+    Tensor* output = nullptr;
+    TF_RETURN_IF_ERROR(context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    ForEachChunk([&](int c, int64_t begin, int64_t end) {
+      TIndex j = chunk_uniques[c];
+      for (int64_t i = begin; i < end; ++i) {
+        if (first(i) == i) {
+          idx_vec(i) = j;
+          Tout(j) = Tin(i);
+          ++j;
+        }
+      }
+    });
+    ForEachChunk([&](int c, int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        if (first(i) != i) {
+          idx_vec(i) = idx_vec(first(i));
+        }
+      }
+    });
+    return OkStatus();
+  }
+
+  const bool is_cpu_device_;
 };
 
 #define REGISTER_UNIQUE(type)                                      \
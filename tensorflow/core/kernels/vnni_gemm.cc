@@ -0,0 +1,268 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/vnni_gemm.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(TENSORFLOW_DISABLE_VNNI_GEMM)
+#define TENSORFLOW_USE_VNNI_GEMM (1)
+#include <immintrin.h>
+#endif
+
+namespace tensorflow {
+namespace vnni {
+
+namespace {
+
+#ifdef TENSORFLOW_USE_VNNI_GEMM
+
+// The kernels are compiled for AVX512-VNNI regardless of the build flags, and
+// only run after IsSupported() has checked the CPU.
+#define TF_VNNI_TARGET __attribute__((target("avx512f,avx512bw,avx512vnni")))
+
+// vpdpbusd multiplies and adds groups of this many bytes.
+constexpr int kDepthGroup = 4;
+// Lhs rows and rhs columns computed by one call to ComputeTile().
+constexpr int kTileRows = 4;
+constexpr int kPanelCols = 32;
+
+// The lhs in row major order, with each row padded with zeros to a whole
+// number of depth groups.
+struct PackedLhs {
+  int row_stride;
+  std::vector<uint8_t> data;      // [m, row_stride]
+  std::vector<int32_t> row_sums;  // [m]
+};
+
+// The rhs in panels of kPanelCols columns. Within a panel, the kDepthGroup
+// values of a column for a depth group are adjacent, as vpdpbusd expects.
+// vpdpbusd multiplies unsigned bytes by signed bytes, so the values are
+// stored minus 128; the error this introduces is corrected with the row sums
+// of the lhs. Padding is zero.
+struct PackedRhs {
+  int num_groups;
+  int num_panels;
+  std::vector<int8_t> data;       // [num_panels, num_groups, kPanelCols, 4]
+  std::vector<int32_t> col_sums;  // [num_panels * kPanelCols]
+};
+
+void PackLhs(bool transpose_a, const uint8_t* a, int m, int k, int lda,
+             PackedLhs* packed) {
+  packed->row_stride = (k + kDepthGroup - 1) / kDepthGroup * kDepthGroup;
+  packed->data.assign(static_cast<size_t>(m) * packed->row_stride, 0);
+  packed->row_sums.assign(m, 0);
+  for (int i = 0; i < m; ++i) {
+    uint8_t* row = packed->data.data() + static_cast<size_t>(i) *
+                                             packed->row_stride;
+    int32_t sum = 0;
+    for (int l = 0; l < k; ++l) {
+      const uint8_t value = transpose_a
+                                ? a[static_cast<size_t>(l) * lda + i]
+                                : a[static_cast<size_t>(i) * lda + l];
+      row[l] = value;
+      sum += value;
+    }
+    packed->row_sums[i] = sum;
+  }
+}
+
+void PackRhsPanels(bool transpose_b, const uint8_t* b, int n, int k, int ldb,
+                   int64_t first_panel, int64_t last_panel,
+                   PackedRhs* packed) {
+  const size_t panel_size =
+      static_cast<size_t>(packed->num_groups) * kPanelCols * kDepthGroup;
+  for (int64_t panel = first_panel; panel < last_panel; ++panel) {
+    int8_t* out = packed->data.data() + panel * panel_size;
+    const int first_col = panel * kPanelCols;
+    const int num_cols = std::min(kPanelCols, n - first_col);
+    for (int c = 0; c < num_cols; ++c) {
+      const int j = first_col + c;
+      int32_t sum = 0;
+      for (int l = 0; l < k; ++l) {
+        const uint8_t value = transpose_b
+                                  ? b[static_cast<size_t>(j) * ldb + l]
+                                  : b[static_cast<size_t>(l) * ldb + j];
+        out[(l / kDepthGroup * kPanelCols + c) * kDepthGroup +
+            l % kDepthGroup] = static_cast<int8_t>(value ^ 0x80);
+        sum += value;
+      }
+      packed->col_sums[j] = sum;
+    }
+  }
+}
+
+// Returns the mask of the valid lanes of a vector of 16 columns starting at
+// column `first` of a panel with `num_cols` valid columns.
+inline __mmask16 ColumnMask(int first, int num_cols) {
+  const int valid = std::min(16, std::max(0, num_cols - first));
+  return static_cast<__mmask16>((1u << valid) - 1);
+}
+
+// Computes rows [row, row + kRows) of a panel of the result:
+//
+//   c[i, j] = sum(a[i, l] * (b[l, j] - 128)) + row_terms[i] + col_terms[j]
+template <int kRows>
+TF_VNNI_TARGET void ComputeTile(const PackedLhs& lhs, int row,
+                                const PackedRhs& rhs, int panel, int num_cols,
+                                const int32_t* row_terms,
+                                const int32_t* col_terms, int32_t* c,
+                                int ldc) {
+  __m512i acc[kRows][2];
+  const uint8_t* a[kRows];
+  for (int r = 0; r < kRows; ++r) {
+    acc[r][0] = _mm512_setzero_si512();
+    acc[r][1] = _mm512_setzero_si512();
+    a[r] = lhs.data.data() + static_cast<size_t>(row + r) * lhs.row_stride;
+  }
+  const int8_t* b =
+      rhs.data.data() +
+      static_cast<size_t>(panel) * rhs.num_groups * kPanelCols * kDepthGroup;
+  for (int g = 0; g < rhs.num_groups; ++g) {
+    const __m512i b0 = _mm512_loadu_si512(b);
+    const __m512i b1 = _mm512_loadu_si512(b + 64);
+    b += kPanelCols * kDepthGroup;
+    for (int r = 0; r < kRows; ++r) {
+      int32_t a_group;
+      std::memcpy(&a_group, a[r] + g * kDepthGroup, sizeof(a_group));
+      const __m512i a_vec = _mm512_set1_epi32(a_group);
+      acc[r][0] = _mm512_dpbusd_epi32(acc[r][0], a_vec, b0);
+      acc[r][1] = _mm512_dpbusd_epi32(acc[r][1], a_vec, b1);
+    }
+  }
+  const int first_col = panel * kPanelCols;
+  const __m512i col0 = _mm512_loadu_si512(col_terms + first_col);
+  const __m512i col1 = _mm512_loadu_si512(col_terms + first_col + 16);
+  const __mmask16 mask0 = ColumnMask(0, num_cols);
+  const __mmask16 mask1 = ColumnMask(16, num_cols);
+  for (int r = 0; r < kRows; ++r) {
+    const __m512i row_term = _mm512_set1_epi32(row_terms[row + r]);
+    int32_t* out = c + static_cast<size_t>(row + r) * ldc + first_col;
+    _mm512_mask_storeu_epi32(
+        out, mask0,
+        _mm512_add_epi32(_mm512_add_epi32(acc[r][0], row_term), col0));
+    _mm512_mask_storeu_epi32(
+        out + 16, mask1,
+        _mm512_add_epi32(_mm512_add_epi32(acc[r][1], row_term), col1));
+  }
+}
+
+// Wraps `value` to int32 the way int32 accumulation would.
+inline int32_t WrapToInt32(int64_t value) {
+  return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+#endif  // TENSORFLOW_USE_VNNI_GEMM
+
+}  // namespace
+
+bool IsSupported() {
+#ifdef TENSORFLOW_USE_VNNI_GEMM
+  static const bool supported =
+      port::TestCPUFeature(port::CPUFeature::AVX512F) &&
+      port::TestCPUFeature(port::CPUFeature::AVX512BW) &&
+      port::TestCPUFeature(port::CPUFeature::AVX512_VNNI);
+  return supported;
+#else
+  return false;
+#endif
+}
+
+void QuantizedGemm(OpKernelContext* context, bool transpose_a, bool transpose_b,
+                   const quint8* a_data, const quint8* b_data, qint32* c_data,
+                   int m, int n, int k, int offset_a, int offset_b, int lda,
+                   int ldb, int ldc) {
+#ifdef TENSORFLOW_USE_VNNI_GEMM
+  CHECK(IsSupported());
+  if (m == 0 || n == 0) return;
+  const uint8_t* a = &(a_data->value);
+  const uint8_t* b = &(b_data->value);
+  int32_t* c = &(c_data->value);
+  auto& worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+
+  PackedLhs lhs;
+  PackLhs(transpose_a, a, m, k, lda, &lhs);
+  PackedRhs rhs;
+  rhs.num_groups = lhs.row_stride / kDepthGroup;
+  rhs.num_panels = (n + kPanelCols - 1) / kPanelCols;
+  rhs.data.assign(static_cast<size_t>(rhs.num_panels) * rhs.num_groups *
+                      kPanelCols * kDepthGroup,
+                  0);
+  rhs.col_sums.assign(static_cast<size_t>(rhs.num_panels) * kPanelCols, 0);
+  Shard(worker_threads.num_threads, worker_threads.workers, rhs.num_panels,
+        static_cast<int64_t>(kPanelCols) * k,
+        [&](int64_t first, int64_t last) {
+          PackRhsPanels(transpose_b, b, n, k, ldb, first, last, &rhs);
+        });
+
+  // Expanding the sum of (a + offset_a) * (b + offset_b) in terms of the
+  // product that vpdpbusd computes, a * (b - 128), gives one term per row and
+  // one per column.
+  std::vector<int32_t> row_terms(m);
+  for (int i = 0; i < m; ++i) {
+    row_terms[i] =
+        WrapToInt32(static_cast<int64_t>(128 + offset_b) * lhs.row_sums[i]);
+  }
+  std::vector<int32_t> col_terms(rhs.col_sums.size());
+  for (size_t j = 0; j < col_terms.size(); ++j) {
+    col_terms[j] = WrapToInt32(
+        offset_a * (rhs.col_sums[j] + static_cast<int64_t>(k) * offset_b));
+  }
+
+  // Consecutive units share a panel of the rhs, which stays in cache.
+  const int num_row_tiles = (m + kTileRows - 1) / kTileRows;
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        static_cast<int64_t>(num_row_tiles) * rhs.num_panels,
+        static_cast<int64_t>(kTileRows) * kPanelCols * k / 16,
+        [&](int64_t first, int64_t last) {
+          for (int64_t unit = first; unit < last; ++unit) {
+            const int panel = unit / num_row_tiles;
+            const int row = unit % num_row_tiles * kTileRows;
+            const int num_cols = std::min(kPanelCols, n - panel * kPanelCols);
+            switch (std::min(kTileRows, m - row)) {
+              case 4:
+                ComputeTile<4>(lhs, row, rhs, panel, num_cols,
+                               row_terms.data(), col_terms.data(), c, ldc);
+                break;
+              case 3:
+                ComputeTile<3>(lhs, row, rhs, panel, num_cols,
+                               row_terms.data(), col_terms.data(), c, ldc);
+                break;
+              case 2:
+                ComputeTile<2>(lhs, row, rhs, panel, num_cols,
+                               row_terms.data(), col_terms.data(), c, ldc);
+                break;
+              case 1:
+                ComputeTile<1>(lhs, row, rhs, panel, num_cols,
+                               row_terms.data(), col_terms.data(), c, ldc);
+                break;
+            }
+          }
+        });
+#else
+  LOG(FATAL) << "VNNI quantized gemm is not supported on this platform.";
+#endif
+}
+
+}  // namespace vnni
+}  // namespace tensorflow
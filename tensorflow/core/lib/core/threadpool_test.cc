@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/threadpool.h"
 
+#include <algorithm>
 #include <atomic>
+#include <vector>
 
 #include "absl/synchronization/barrier.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/types/optional.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -315,6 +319,56 @@ TEST(ThreadPool, ParallelForWithAdaptiveSchedulingStrategy) {
   }
 }
 
+TEST(ThreadPool, ParallelForWithDynamicSchedulingStrategy) {
+  Context outer_context(ContextKind::kThread);
+  for (int num_threads = 1; num_threads < kNumThreads; num_threads++) {
+    fprintf(stderr, "Testing with %d threads\n", num_threads);
+    ThreadPool pool(Env::Default(), "test", num_threads);
+    for (const absl::optional<int64_t> cost_per_unit :
+         {absl::optional<int64_t>(), absl::optional<int64_t>(1 << 20)}) {
+      for (const int64_t total : {0, 1, 15, 1000}) {
+        std::vector<std::atomic<bool>> work(total);
+        pool.ParallelFor(
+            total,
+            ThreadPool::SchedulingParams(
+                ThreadPool::SchedulingStrategy::kDynamic /* strategy */,
+                cost_per_unit, absl::nullopt /* block_size */),
+            [&outer_context, &work](int64_t begin, int64_t end) {
+              Context inner_context(ContextKind::kThread);
+              ASSERT_EQ(outer_context, inner_context);
+              for (int64_t i = begin; i < end; ++i) {
+                // Makes the cost per unit uneven.
+                if (i % 100 == 0) Env::Default()->SleepForMicroseconds(100);
+                ASSERT_FALSE(work[i].exchange(true));
+              }
+            });
+        for (int64_t i = 0; i < total; i++) {
+          ASSERT_TRUE(work[i]);
+        }
+      }
+    }
+  }
+}
+
+TEST(ThreadPool, ParallelForWithDynamicSchedulingMinBlockSize) {
+  ThreadPool pool(Env::Default(), "test", kNumThreads);
+  const int64_t kBlockSize = 7;
+  std::atomic<int64_t> num_units(0);
+  pool.ParallelFor(
+      1000,
+      ThreadPool::SchedulingParams(
+          ThreadPool::SchedulingStrategy::kDynamic /* strategy */,
+          absl::nullopt /* cost_per_unit */, kBlockSize /* block_size */),
+      [&num_units](int64_t begin, int64_t end) {
+        // Only the last block may be smaller.
+        if (end != 1000) {
+          EXPECT_GE(end - begin, kBlockSize);
+        }
+        num_units += end - begin;
+      });
+  EXPECT_EQ(1000, num_units);
+}
+
 TEST(ThreadPool, ParallelForWithWorkerId) {
   // Make ParallelForWithWorkerId use as many threads as possible.
   int64_t kHugeCost = 1 << 30;
@@ -371,6 +425,31 @@ TEST(ThreadPool, Parallelism) {
   }
 }
 
+TEST(ThreadPool, PhysicalCoresFirstAffinity) {
+  int num_physical_cores = 0;
+  const std::vector<int> cpus =
+      port::CPUsByPhysicalCore(port::kNUMANoAffinity, &num_physical_cores);
+  ThreadPool pool(Env::Default(), ThreadOptions(), "test", kNumThreads,
+                  /*low_latency_hint=*/true, /*allocator=*/nullptr,
+                  ThreadPool::CpuAffinity::kPhysicalCoresFirst);
+  if (cpus.empty()) {
+    EXPECT_EQ(kNumThreads, pool.NumEigenDeviceThreads());
+  } else {
+    EXPECT_EQ(std::min(kNumThreads, num_physical_cores),
+              pool.NumEigenDeviceThreads());
+  }
+  std::atomic<int64_t> sum(0);
+  pool.ParallelFor(1000, 100, [&sum](int64_t start, int64_t limit) {
+    for (int64_t i = start; i < limit; ++i) sum += i;
+  });
+  EXPECT_EQ(999 * 1000 / 2, sum);
+}
+
+TEST(ThreadPool, NoAffinityUsesAllThreads) {
+  ThreadPool pool(Env::Default(), "test", kNumThreads);
+  EXPECT_EQ(kNumThreads, pool.NumEigenDeviceThreads());
+}
+
 static void BM_Sequential(::testing::benchmark::State& state) {
   for (auto s : state) {
     state.PauseTiming();
@@ -26,6 +26,8 @@ using tsl::io::compression::kGzip;
 using tsl::io::compression::kNone;
 using tsl::io::compression::kSnappy;
 using tsl::io::compression::kZlib;
+using tsl::io::compression::kZlibBlock;
+using tsl::io::compression::kZstd;
 // NOLINTEND(misc-unused-using-decls)
 }  // namespace compression
 }  // namespace io
@@ -334,12 +334,19 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
     }
     // This is an instance of multi-node collective.  We have previously
     // created a NCCL unique id and shared with all workers.  Now we find the
-    // `Communicator` corresponding to this id.
-    for (auto& comm : communicators_) {
-      if (comm->key == collective->communicator_key) {
-        *communicator = comm.get();
+    // `Communicator` corresponding to this id, waiting if another collective
+    // is initializing it.
+    while (true) {
+      auto it = keyed_communicators_.find(collective->communicator_key);
+      if (it == keyed_communicators_.end()) break;
+      if (it->second != nullptr) {
+        *communicator = it->second;
         return OkStatus();
       }
+      communicator_initialized_.wait(l);
+      if (!status_.ok()) {
+        return status_;
+      }
     }
   }
 
@@ -347,8 +354,8 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
   std::set<NcclStream*> used_streams;
 
   // Create and initialize a new communicator.
-  // Note that this is done under the lock; performance is not expected to
-  // matter as this happens a very small number of times.
+  // Note that streams are assigned under the lock; performance is not expected
+  // to matter as this happens a very small number of times.
   std::vector<CommunicatorMember> members(collective->num_local_devices);
   std::vector<int> devices(collective->num_local_devices);
   for (int i = 0; i < collective->num_local_devices; ++i) {
@@ -396,26 +403,69 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
                  std::vector<int>{collective->communicator_key.begin(),
                                   collective->communicator_key.end()},
                  " ");
+  Status init_status;
+  if (collective->communicator_key.empty()) {
+    init_status = InitializeNcclComms(*collective, devices, &nccl_comms);
+  } else {
+    // Multi-node initialization blocks until every worker has joined, so run
+    // it without the lock. Collectives that need the same communicator wait
+    // for it above.
+    const string& key = collective->communicator_key;
+    const int64_t num_aborts = num_aborts_;
+    keyed_communicators_[key] = nullptr;
+    mu_.unlock();
+    init_status = InitializeNcclComms(*collective, devices, &nccl_comms);
+    mu_.lock();
+    keyed_communicators_.erase(key);
+    communicator_initialized_.notify_all();
+    if (init_status.ok() && num_aborts != num_aborts_) {
+      // The manager was aborted while the communicator was initialized.
+      for (ncclComm_t nccl_comm : nccl_comms) {
+        ncclCommAbort(nccl_comm);
+      }
+      init_status = status_.ok() ? errors::Aborted(
+                                       "NCCL communicator initialization was "
+                                       "interrupted by an abort")
+                                 : status_;
+    }
+  }
+  TF_RETURN_IF_ERROR(init_status);
+
+  for (int i = 0; i < collective->num_local_devices; ++i) {
+    members[i].nccl_comm = nccl_comms[i];
+  }
+  communicators_.emplace_back(
+      new Communicator(std::move(members), collective->communicator_key));
+  *communicator = communicators_.back().get();
+  if (!collective->communicator_key.empty()) {
+    keyed_communicators_[collective->communicator_key] = *communicator;
+  }
+  return OkStatus();
+}
+
+Status NcclManager::InitializeNcclComms(const Collective& collective,
+                                        const std::vector<int>& devices,
+                                        std::vector<ncclComm_t>* nccl_comms) {
 #if NCCL_MAJOR >= 2
   // For NCCL 2, we always initialize using ncclCommInitRank guarded by NCCL
   // group primitives.
   ncclUniqueId nccl_id;
-  if (collective->single_node) {
+  if (collective.single_node) {
     NCCL_RETURN_IF_ERROR(ncclGetUniqueId(&nccl_id));
   } else {
-    StringToNcclUniqueId(collective->communicator_key, &nccl_id);
+    StringToNcclUniqueId(collective.communicator_key, &nccl_id);
   }
   int saved_device = 0;
   CUDA_RETURN_IF_ERROR(cudaGetDevice(&saved_device));
   NCCL_RETURN_IF_ERROR(ncclGroupStart());
-  for (int i = 0; i < collective->num_local_devices; ++i) {
+  for (int i = 0; i < collective.num_local_devices; ++i) {
     // Set rank to `participant->global_rank` if provided, else `i`.
-    const int rank = collective->participants[i]->global_rank >= 0
-                         ? collective->participants[i]->global_rank
+    const int rank = collective.participants[i]->global_rank >= 0
+                         ? collective.participants[i]->global_rank
                          : i;
     CUDA_RETURN_IF_ERROR(cudaSetDevice(devices[i]));
     NCCL_RETURN_IF_ERROR(ncclCommInitRank(
-        nccl_comms.data() + i, collective->num_global_devices, nccl_id, rank));
+        nccl_comms->data() + i, collective.num_global_devices, nccl_id, rank));
   }
   NCCL_RETURN_IF_ERROR(ncclGroupEnd());
   CUDA_RETURN_IF_ERROR(cudaSetDevice(saved_device));
@@ -425,15 +475,9 @@ Status NcclManager::GetCommunicator(NcclManager::Collective* collective,
   // issue each init call from a different thread
   // (https://docs.nvidia.com/deeplearning/sdk/nccl-developer-guide/docs/nccl1.html).
   NCCL_RETURN_IF_ERROR(ncclCommInitAll(
-      nccl_comms.data(), collective->num_local_devices, devices.data()));
+      nccl_comms->data(), collective.num_local_devices, devices.data()));
 #endif
 
-  for (int i = 0; i < collective->num_local_devices; ++i) {
-    members[i].nccl_comm = nccl_comms[i];
-  }
-  communicators_.emplace_back(
-      new Communicator(std::move(members), collective->communicator_key));
-  *communicator = communicators_.back().get();
   return OkStatus();
 }
 
@@ -869,8 +913,11 @@ void NcclManager::StartAbort(const Status& s) {
       return;
     }
     status_ = s;
+    ++num_aborts_;
     collectives.swap(collectives_);
     communicators.swap(communicators_);
+    keyed_communicators_.clear();
+    communicator_initialized_.notify_all();
   }
   VLOG(2) << "Aborted NcclManager " << this << " with " << collectives.size()
           << " collectives and " << communicators.size()
@@ -224,6 +224,12 @@ class NcclManager {
   // the corresponding NCCL/CUDA error string.
   Status GetCommunicator(Collective* collective, Communicator** communicator);
 
+  // Initializes the NCCL communicators of the local participants of
+  // `collective` on `devices`, into `nccl_comms`.
+  static Status InitializeNcclComms(const Collective& collective,
+                                    const std::vector<int>& devices,
+                                    std::vector<ncclComm_t>* nccl_comms);
+
   // Adds a participant device to the local `Collective` instance corresponding
   // to `collective_key`.  Launches the `Collective` if it is ready, which it
   // checks by calling `CheckReady()`.  Also performs consistency and sanity
@@ -259,6 +265,18 @@ class NcclManager {
 
   std::vector<std::unique_ptr<Communicator>> communicators_ TF_GUARDED_BY(mu_);
 
+  // Maps `communicator_key` to the communicator of multi-node collectives, or
+  // to nullptr while the communicator is initialized. Initialization waits
+  // for the other workers, so it runs without holding mu_, and communicators
+  // with different keys are initialized in parallel.
+  absl::flat_hash_map<string, Communicator*> keyed_communicators_
+      TF_GUARDED_BY(mu_);
+  // Notified when the initialization of a keyed communicator finishes.
+  condition_variable communicator_initialized_;
+  // Incremented by StartAbort(), to discard communicators whose
+  // initialization was in progress.
+  int64_t num_aborts_ TF_GUARDED_BY(mu_) = 0;
+
   Status status_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(NcclManager);
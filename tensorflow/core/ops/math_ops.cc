@@ -1015,6 +1015,32 @@ _FusedConv2D output.
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("x: T")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 0")
+    .Attr("fused_ops: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Performs a chain of element-wise operations in a single pass over memory.
+
+The chain is specified by the `fused_ops` attribute, which is a list of TF op
+names specified as strings (e.g. "Tanh"). They are performed in order, where
+the input to the first op is `x`, and the (first) input to each following op is
+the output of the preceding op.
+
+Supported unary ops are "Abs", "Exp", "Log", "Neg", "Reciprocal", "Relu",
+"Rsqrt", "Sigmoid", "Sqrt", "Square" and "Tanh". Supported binary ops are
+"Add", "AddV2", "Maximum", "Minimum", "Mul", "RealDiv" and "Sub". The second
+input to each binary op is the next tensor in `args`, which must be a scalar or
+have the shape of `x`.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
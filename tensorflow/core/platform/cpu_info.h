@@ -55,6 +55,7 @@ using tsl::port::CPUFamily;
 using tsl::port::CPUFeature;
 using tsl::port::CPUIDNumSMT;
 using tsl::port::CPUModelNum;
+using tsl::port::CPUsByPhysicalCore;
 using tsl::port::CPUVendorIDString;
 using tsl::port::F16C;
 using tsl::port::FMA;
@@ -73,6 +74,7 @@ using tsl::port::PREFETCHW;
 using tsl::port::PREFETCHWT1;
 using tsl::port::RDRAND;
 using tsl::port::RDSEED;
+using tsl::port::SetCurrentThreadCPUAffinity;
 using tsl::port::SMAP;
 using tsl::port::SSE;
 using tsl::port::SSE2;
@@ -15,9 +15,14 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/convert/multi_xplanes_to_op_stats.h"
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/profiler/convert/op_stats_combiner.h"
 #include "tensorflow/core/profiler/convert/preprocess_single_host_xplane.h"
 #include "tensorflow/core/profiler/convert/repository.h"
@@ -28,21 +33,56 @@ limitations under the License.
 
 namespace tensorflow {
 namespace profiler {
+namespace {
+
+// Maximum number of XSpaces converted concurrently. An XSpace is released as
+// soon as it's converted, so this bounds the number of XSpaces in memory.
+constexpr int kMaxConcurrentXSpaceConversions = 8;
+
+// Reads the XSpace at `index` and converts it to `op_stats`.
+Status ReadAndConvertXSpaceToOpStats(const SessionSnapshot& session_snapshot,
+                                     int index, const OpStatsOptions& options,
+                                     OpStats* op_stats) {
+  TF_ASSIGN_OR_RETURN(std::unique_ptr<XSpace> xspace,
+                      session_snapshot.GetXSpace(index));
+  PreprocessSingleHostXSpace(xspace.get(), /*step_grouping=*/true,
+                             /*derived_timeline=*/false);
+  *op_stats = ConvertXSpaceToOpStats(*xspace, options);
+  return OkStatus();
+}
+
+}  // namespace
 
 Status ConvertMultiXSpacesToCombinedOpStats(
     const SessionSnapshot& session_snapshot, const OpStatsOptions& options,
     OpStats* combined_op_stats) {
-  // Read multiple XSpaces and convert to multiple OpStats.
-  // TODO(profiler): Change the combiner to convert and combine one OpStats at a
-  // time, to reduce peak memory usage.
-  std::vector<OpStats> all_op_stats;
-  all_op_stats.reserve(session_snapshot.XSpaceSize());
-  for (int i = 0; i < session_snapshot.XSpaceSize(); i++) {
-    TF_ASSIGN_OR_RETURN(std::unique_ptr<XSpace> xspace,
-                        session_snapshot.GetXSpace(i));
-    PreprocessSingleHostXSpace(xspace.get(), /*step_grouping=*/true,
-                               /*derived_timeline=*/false);
-    all_op_stats.push_back(ConvertXSpaceToOpStats(*xspace, options));
+  // Read multiple XSpaces and convert to multiple OpStats, in parallel. The
+  // OpStats are kept until all of them are converted, since combining them
+  // requires the intersection of their steps.
+  const int num_xspaces = session_snapshot.XSpaceSize();
+  std::vector<OpStats> all_op_stats(num_xspaces);
+  const int num_threads = std::min(
+      {num_xspaces, port::MaxParallelism(), kMaxConcurrentXSpaceConversions});
+  if (num_threads <= 1) {
+    for (int i = 0; i < num_xspaces; i++) {
+      TF_RETURN_IF_ERROR(ReadAndConvertXSpaceToOpStats(
+          session_snapshot, i, options, &all_op_stats[i]));
+    }
+  } else {
+    std::vector<Status> statuses(num_xspaces);
+    {
+      thread::ThreadPool thread_pool(Env::Default(), "convert_xspaces",
+                                     num_threads);
+      for (int i = 0; i < num_xspaces; i++) {
+        thread_pool.Schedule([&, i] {
+          statuses[i] = ReadAndConvertXSpaceToOpStats(
+              session_snapshot, i, options, &all_op_stats[i]);
+        });
+      }
+    }  // Waits for the conversions to finish.
+    for (const Status& status : statuses) {
+      TF_RETURN_IF_ERROR(status);
+    }
   }
 
   // Combine OpStats.
@@ -80,6 +80,17 @@ void CombineOpMetrics(const OpMetrics& src, OpMetrics* dst,
   CombineMemoryAccessedBreakdown(src.memory_accessed_breakdown(),
                                  dst->mutable_memory_accessed_breakdown());
   dst->set_dma_stall_ps(src.dma_stall_ps() + dst->dma_stall_ps());
+  if (src.has_hardware_counters()) {
+    CombineHardwareCounters(src.hardware_counters(),
+                            dst->mutable_hardware_counters());
+  }
+}
+
+void CombineHardwareCounters(const OpMetrics::HardwareCounters& src,
+                             OpMetrics::HardwareCounters* dst) {
+  dst->set_cpu_cycles(src.cpu_cycles() + dst->cpu_cycles());
+  dst->set_cpu_instructions(src.cpu_instructions() + dst->cpu_instructions());
+  dst->set_llc_misses(src.llc_misses() + dst->llc_misses());
 }
 
 void CombineMemoryAccessedBreakdown(
@@ -37,6 +37,10 @@ void CombineMemoryAccessedBreakdown(
     const protobuf::RepeatedPtrField<OpMetrics_MemoryAccessed>& src,
     protobuf::RepeatedPtrField<OpMetrics_MemoryAccessed>* dst);
 
+// Combines the hardware performance counters.
+void CombineHardwareCounters(const OpMetrics::HardwareCounters& src,
+                             OpMetrics::HardwareCounters* dst);
+
 // Helper to combine op metrics databases.
 class OpMetricsDbCombiner : public OpMetricsDbBuilder {
  public:
@@ -215,6 +215,14 @@ void PopulateOpMetricsNode(const OpMetrics& op_metrics,
 
   metrics->set_raw_hbm_bytes_accessed(GibiToGiga(mem_bw_gibibytes_per_second) *
                                       PicoToNano(op_metrics.time_ps()));
+
+  if (op_metrics.has_hardware_counters()) {
+    const OpMetrics::HardwareCounters& counters =
+        op_metrics.hardware_counters();
+    metrics->set_raw_cpu_cycles(counters.cpu_cycles());
+    metrics->set_raw_cpu_instructions(counters.cpu_instructions());
+    metrics->set_raw_llc_misses(counters.llc_misses());
+  }
 }
 
 // Sets the total time on the root node metrics.
@@ -239,6 +239,21 @@ InputPipelineAnalysisResult ComputeGenericInputPipelineAnalysisResult(
     details.set_host_compute_ms(GetTimeInMs(type_ps, HOST_COMPUTE));
     details.set_host_prepare_ms(GetTimeInMs(type_ps, HOST_PREPARE));
     details.set_host_compile_ms(GetTimeInMs(type_ps, HOST_COMPILE));
+    // Blames the iterator that accounts for most of the device idle time due
+    // to input in this step.
+    absl::string_view blamed_iterator;
+    uint64_t blamed_iterator_ps = 0;
+    for (const auto& [iterator_name, ps] :
+         generic.input_wait_ps_per_iterator()) {
+      if (ps > blamed_iterator_ps) {
+        blamed_iterator = iterator_name;
+        blamed_iterator_ps = ps;
+      }
+    }
+    if (blamed_iterator_ps > 0) {
+      details.set_input_wait_iterator(std::string(blamed_iterator));
+      details.set_input_wait_iterator_ms(PicoToMilli(blamed_iterator_ps));
+    }
     result.add_step_details()->PackFrom(details);
 
     const double input_percent_of_step_time =
@@ -36,6 +36,37 @@ const uint32 kDefaultGpuLocalCoreId = 1;
 
 namespace {
 
+// Attributes the HOST_WAIT_INPUT time of a non-overlapped step to the tf.data
+// iterators that the host spent this time in.
+void AttributeInputWaitToIterators(const StepDetails& step_details,
+                                   Timespan step_time,
+                                   GenericStepBreakdown* generic) {
+  if (step_details.IteratorSelfSpans().empty()) return;
+  // Non-overlapped events are disjoint and sorted by time.
+  std::vector<Timespan> input_waits;
+  for (const auto& event : step_details.Events()) {
+    if (event.type == HOST_WAIT_INPUT && step_time.Overlaps(event.span)) {
+      input_waits.push_back(event.span);
+    }
+  }
+  if (input_waits.empty()) return;
+  auto& input_wait_ps = *generic->mutable_input_wait_ps_per_iterator();
+  for (const auto& self_span : step_details.IteratorSelfSpans()) {
+    auto it = absl::c_lower_bound(
+        input_waits, self_span.span.begin_ps(),
+        [](const Timespan& wait, uint64 begin_ps) {
+          return wait.end_ps() <= begin_ps;
+        });
+    uint64 overlap_ps = 0;
+    for (; it != input_waits.end() &&
+           it->begin_ps() < self_span.span.end_ps();
+         ++it) {
+      overlap_ps += self_span.span.OverlappedDurationPs(*it);
+    }
+    if (overlap_ps > 0) input_wait_ps[self_span.iterator_name] += overlap_ps;
+  }
+}
+
 // Converts from StepDetails to StepInfoResult.
 StepInfoResult ConvertStepDetailsToStepInfo(bool has_device, int64_t step_num,
                                             const StepDetails& step_details) {
@@ -54,6 +85,7 @@ StepInfoResult ConvertStepDetailsToStepInfo(bool has_device, int64_t step_num,
     // "unknown time".
     type_ps[UNKNOWN_TIME] += step_time.duration_ps() - total_event_duration;
   }
+  AttributeInputWaitToIterators(step_details, step_time, &generic);
   // Determines if this particular step is a well-formed one.
   bool well_formed_step = has_device ? (type_ps.contains(DEVICE_COMPUTE_16) ||
                                         type_ps.contains(DEVICE_COMPUTE_32))
@@ -66,6 +66,8 @@ struct TfActivity {
   TfOp tf_op;
   // Whether it is eagerly executed.
   bool is_eager;
+  // Hardware performance counters of this Op, if profiled with them.
+  std::optional<OpMetrics::HardwareCounters> hardware_counters;
 };
 
 // TF Op metrics stored as element in OpStack.
@@ -102,7 +104,8 @@ void ProcessOneTfActivity(const TfActivity& activity,
           PicoSpan(info->start_timestamp_ps, activity.timestamp_ps);
       tf_metrics_data->tf_metrics_db_builder.EnterOp(
           activity.tf_op.name, activity.tf_op.type, activity.is_eager,
-          tf_op_span.duration_ps(), info->children_duration_ps);
+          tf_op_span.duration_ps(), info->children_duration_ps,
+          activity.hardware_counters ? &*activity.hardware_counters : nullptr);
       TfOpInfo* parent_info = tf_op_stack->Top();
       if (parent_info != nullptr) {
         parent_info->children_duration_ps += tf_op_span.duration_ps();
@@ -144,15 +147,34 @@ void CollectTfActivities(const XLineVisitor& line,
     if (tf_op != nullptr) {
       ++tf_op_id;
       bool is_eager = false;
-      if (absl::optional<XStatVisitor> stat =
-              event.GetStat(StatType::kIsEager)) {
-        is_eager = stat->IntValue();
-      }
+      std::optional<OpMetrics::HardwareCounters> hardware_counters;
+      event.ForEachStat([&](const XStatVisitor& stat) {
+        if (!stat.Type().has_value()) return;
+        switch (static_cast<StatType>(*stat.Type())) {
+          case StatType::kIsEager:
+            is_eager = stat.IntValue();
+            break;
+          case StatType::kCpuCycles:
+            if (!hardware_counters) hardware_counters.emplace();
+            hardware_counters->set_cpu_cycles(stat.IntOrUintValue());
+            break;
+          case StatType::kCpuInstructions:
+            if (!hardware_counters) hardware_counters.emplace();
+            hardware_counters->set_cpu_instructions(stat.IntOrUintValue());
+            break;
+          case StatType::kLlcMisses:
+            if (!hardware_counters) hardware_counters.emplace();
+            hardware_counters->set_llc_misses(stat.IntOrUintValue());
+            break;
+          default:
+            break;
+        }
+      });
       Timespan span = event.GetTimespan();
       tf_activities->push_back(
           {span.begin_ps(), tf_op_id, kTfOpBegin, *tf_op, is_eager});
-      tf_activities->push_back(
-          {span.end_ps(), tf_op_id, kTfOpEnd, *tf_op, is_eager});
+      tf_activities->push_back({span.end_ps(), tf_op_id, kTfOpEnd, *tf_op,
+                                is_eager, std::move(hardware_counters)});
     }
   });
 }
@@ -16,7 +16,10 @@ limitations under the License.
 #include "tensorflow/core/profiler/convert/xplane_to_step_events.h"
 
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_split.h"
@@ -120,11 +123,63 @@ EventType ClassifyCpuEvent(absl::string_view event_name, bool has_device,
   }
 }
 
+bool IsIteratorEvent(const XEventVisitor& event) {
+  return event.Type() == HostEventType::kIterator ||
+         event.Type() == HostEventType::kDeviceInputPipelineSecondIterator;
+}
+
+// A tf.data iterator event of a step.
+struct IteratorEvent {
+  int64_t group_id;
+  absl::string_view name;
+  Timespan span;
+};
+
+// Adds the self time of the iterator events of a thread to their steps. The
+// events of a thread are either disjoint or nested, with an iterator event
+// nesting the events of the iterators it calls.
+void AddIteratorSelfSpans(std::vector<IteratorEvent> events,
+                          StepEvents* step_events) {
+  absl::c_sort(events, [](const IteratorEvent& a, const IteratorEvent& b) {
+    if (a.span.begin_ps() != b.span.begin_ps()) {
+      return a.span.begin_ps() < b.span.begin_ps();
+    }
+    return a.span.duration_ps() > b.span.duration_ps();
+  });
+  // Events enclosing the current one, with the start of their self time not
+  // added yet.
+  std::vector<std::pair<const IteratorEvent*, uint64>> stack;
+  auto add_self_span = [step_events](const IteratorEvent& event,
+                                     uint64 begin_ps, uint64 end_ps) {
+    if (end_ps <= begin_ps) return;
+    (*step_events)[event.group_id].AddIteratorSelfSpan(IteratorSelfSpan(
+        event.name, Timespan::FromEndPoints(begin_ps, end_ps)));
+  };
+  for (const IteratorEvent& event : events) {
+    while (!stack.empty() && !stack.back().first->span.Includes(event.span)) {
+      add_self_span(*stack.back().first, stack.back().second,
+                    stack.back().first->span.end_ps());
+      stack.pop_back();
+    }
+    if (!stack.empty()) {
+      add_self_span(*stack.back().first, stack.back().second,
+                    event.span.begin_ps());
+      stack.back().second = event.span.end_ps();
+    }
+    stack.emplace_back(&event, event.span.begin_ps());
+  }
+  for (; !stack.empty(); stack.pop_back()) {
+    add_self_span(*stack.back().first, stack.back().second,
+                  stack.back().first->span.end_ps());
+  }
+}
+
 }  // namespace
 
 StepEvents ConvertHostThreadsXLineToStepEvents(
     const XLineVisitor& line, const StepEvents* device_step_events) {
   StepEvents result;
+  std::vector<IteratorEvent> iterator_events;
   line.ForEachEvent([&](const XEventVisitor& event) {
     int64_t correlation_id = -1;
     int64_t group_id = -1;
@@ -150,6 +205,9 @@ StepEvents ConvertHostThreadsXLineToStepEvents(
     // correspond to any steps executed on the device.
     bool has_device = (device_step_events != nullptr);
     if (has_device && !device_step_events->contains(group_id)) return;
+    if (IsIteratorEvent(event)) {
+      iterator_events.push_back({group_id, event.Name(), event.GetTimespan()});
+    }
     if (IsExplicitHostStepMarker(event.Name())) {
       result[group_id].AddMarker(
           StepMarker(StepMarkerType::kExplicitHostStepMarker, event.Name(),
@@ -168,6 +226,7 @@ StepEvents ConvertHostThreadsXLineToStepEvents(
       result[group_id].SetStepName(std::string(step_name));
     }
   });
+  AddIteratorSelfSpans(std::move(iterator_events), &result);
   return result;
 }
 
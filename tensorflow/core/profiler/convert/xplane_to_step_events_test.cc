@@ -94,6 +94,36 @@ TEST(ConvertXPlaneToOpStats, CpuOnlyStepDbTest) {
   EXPECT_EQ(host_step_events[0].Events().size(), 2);
 }
 
+// Tests that the time spent in a tf.data iterator is split into the self time
+// of the iterator and of the iterators it calls.
+TEST(ConvertXPlaneToStepEvents, IteratorSelfSpans) {
+  constexpr int64_t kGroupId = 0;
+
+  XSpace space;
+  XPlane* host_plane = GetOrCreateHostXPlane(&space);
+  XPlaneBuilder host_plane_builder(host_plane);
+  host_plane_builder.ReserveLines(1);
+
+  auto tf_data_thread = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &tf_data_thread, "Iterator::Prefetch", 0,
+               100, {{StatType::kGroupId, kGroupId}});
+  CreateXEvent(&host_plane_builder, &tf_data_thread,
+               "Iterator::Prefetch::Map", 20, 40,
+               {{StatType::kGroupId, kGroupId}});
+
+  StepEvents host_step_events =
+      ConvertHostThreadsXPlaneToStepEvents(*host_plane, nullptr);
+  ASSERT_EQ(host_step_events.size(), 1);
+  const auto& self_spans = host_step_events[kGroupId].IteratorSelfSpans();
+  ASSERT_EQ(self_spans.size(), 3);
+  EXPECT_EQ(self_spans[0].iterator_name, "Iterator::Prefetch");
+  EXPECT_EQ(self_spans[0].span, Timespan(0, 20));
+  EXPECT_EQ(self_spans[1].iterator_name, "Iterator::Prefetch::Map");
+  EXPECT_EQ(self_spans[1].span, Timespan(20, 40));
+  EXPECT_EQ(self_spans[2].iterator_name, "Iterator::Prefetch");
+  EXPECT_EQ(self_spans[2].span, Timespan(60, 40));
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace tensorflow
@@ -20,10 +20,14 @@ limitations under the License.
 #include <algorithm>
 #include <iterator>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/trace_events.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
@@ -38,6 +42,10 @@ namespace profiler {
 
 namespace {
 
+// Trace viewer (non-streaming) has scalability issues, we need to drop
+// events to avoid loading failure for trace viewer.
+constexpr uint64 kMaxEvents = 1000000;
+
 void BuildDeviceAndResources(uint32 device_id, const XPlaneVisitor& plane,
                              Device* device) {
   device->set_name(std::string(plane.Name()));
@@ -124,10 +132,11 @@ void MaybeDropEventsForTraceViewer(Trace* trace, uint32 limit) {
 }
 
 void ConvertXSpaceToTraceEvents(const XSpace& xspace, Trace* trace) {
+  // Planes to convert, with their device ids.
+  std::vector<std::pair<uint32, const XPlane*>> planes;
   const XPlane* host_plane = FindPlaneWithName(xspace, kHostThreadsPlaneName);
   if (host_plane != nullptr) {
-    XPlaneVisitor xplane = CreateTfXPlaneVisitor(host_plane);
-    ConvertXPlaneToTraceEvents(kHostThreadsDeviceId, xplane, trace);
+    planes.emplace_back(kHostThreadsDeviceId, host_plane);
   }
   std::vector<const XPlane*> device_planes =
       FindPlanesWithPrefix(xspace, kGpuPlanePrefix);
@@ -140,14 +149,46 @@ void ConvertXSpaceToTraceEvents(const XSpace& xspace, Trace* trace) {
     device_planes = FindPlanesWithPrefix(xspace, kCustomPlanePrefix);
   }
   for (const XPlane* device_plane : device_planes) {
-    XPlaneVisitor xplane = CreateTfXPlaneVisitor(device_plane);
-    uint32 device_id = kFirstDeviceId + xplane.Id();
-    ConvertXPlaneToTraceEvents(device_id, xplane, trace);
+    planes.emplace_back(kFirstDeviceId + device_plane->id(), device_plane);
   }
 
-  // Trace viewer (non-streaming) has scalability issues, we need to drop
-  // events to avoid loading failure for trace viewer.
-  constexpr uint64 kMaxEvents = 1000000;
+  // Convert the planes in parallel, each into its own trace. Events beyond
+  // the limit are dropped from each plane before merging, so that the merged
+  // trace is never larger than the limit times the number of planes.
+  std::vector<Trace> plane_traces(planes.size());
+  auto convert_plane = [&](int i) {
+    XPlaneVisitor xplane = CreateTfXPlaneVisitor(planes[i].second);
+    ConvertXPlaneToTraceEvents(planes[i].first, xplane, &plane_traces[i]);
+    MaybeDropEventsForTraceViewer(&plane_traces[i], kMaxEvents);
+  };
+  const int num_threads = std::min<int>(planes.size(), port::MaxParallelism());
+  if (num_threads <= 1) {
+    for (int i = 0; i < planes.size(); ++i) convert_plane(i);
+  } else {
+    thread::ThreadPool thread_pool(Env::Default(), "convert_xplanes",
+                                   num_threads);
+    for (int i = 0; i < planes.size(); ++i) {
+      thread_pool.Schedule([&convert_plane, i] { convert_plane(i); });
+    }
+  }  // Waits for the conversions to finish.
+
+  // Move the events of each plane into the trace, without copying them.
+  int num_events = trace->trace_events_size();
+  for (const Trace& plane_trace : plane_traces) {
+    num_events += plane_trace.trace_events_size();
+  }
+  trace->mutable_trace_events()->Reserve(num_events);
+  for (Trace& plane_trace : plane_traces) {
+    for (auto& device : *plane_trace.mutable_devices()) {
+      (*trace->mutable_devices())[device.first] = std::move(device.second);
+    }
+    auto* events = plane_trace.mutable_trace_events();
+    std::vector<TraceEvent*> released_events(events->size());
+    events->ExtractSubrange(0, events->size(), released_events.data());
+    for (TraceEvent* event : released_events) {
+      trace->mutable_trace_events()->AddAllocated(event);
+    }
+  }
   MaybeDropEventsForTraceViewer(trace, kMaxEvents);
 }
 
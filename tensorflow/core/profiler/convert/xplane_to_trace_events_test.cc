@@ -72,6 +72,30 @@ TEST(ConvertXPlaneToTraceEvents, Convert) {
   EXPECT_EQ(trace.trace_events_size(), 3);
 }
 
+TEST(ConvertXPlaneToTraceEvents, KeepsPlaneOrder) {
+  constexpr int kNumDevices = 8;
+  XSpace xspace;
+  for (int i = 0; i < kNumDevices; ++i) {
+    XPlaneBuilder device_plane(xspace.add_planes());
+    device_plane.SetName(GpuPlaneName(i));
+    device_plane.SetId(i);
+    XLineBuilder stream = device_plane.GetOrCreateLine(1);
+    XEventBuilder event =
+        stream.AddEvent(*device_plane.GetOrCreateEventMetadata("kernel"));
+    event.SetTimestampNs(1000);
+    event.SetDurationNs(10);
+  }
+
+  Trace trace;
+  ConvertXSpaceToTraceEvents(xspace, &trace);
+
+  ASSERT_EQ(trace.devices_size(), kNumDevices);
+  ASSERT_EQ(trace.trace_events_size(), kNumDevices);
+  for (int i = 0; i < kNumDevices; ++i) {
+    EXPECT_EQ(trace.trace_events(i).device_id(), kFirstDeviceId + i);
+  }
+}
+
 TEST(ConvertXPlaneToTraceEvents, Drop) {
   Trace trace;
   for (int i = 0; i < 100; i++) {
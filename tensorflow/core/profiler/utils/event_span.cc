@@ -264,6 +264,10 @@ void StepDetails::AddMarker(const StepMarker& m) { markers_.push_back(m); }
 
 void StepDetails::AddEvent(const EventTypeSpan& e) { events_.push_back(e); }
 
+void StepDetails::AddIteratorSelfSpan(const IteratorSelfSpan& s) {
+  iterator_self_spans_.push_back(s);
+}
+
 void StepDetails::AggregateDeviceMemoryTransfers(
     const std::vector<DeviceMemoryTransfer> device_memory_transfers) {
   if (device_memory_transfers.size() != device_memory_transfers_.size()) {
@@ -344,6 +348,7 @@ StepDetails StepDetails::ToNonOverlapped() const {
   non_overlapped_step_details.collectives_ = collectives_;
   non_overlapped_step_details.device_memory_transfers_ =
       device_memory_transfers_;
+  non_overlapped_step_details.iterator_self_spans_ = iterator_self_spans_;
   non_overlapped_step_details.step_name_ = step_name_;
   return non_overlapped_step_details;
 }
@@ -353,6 +358,9 @@ void StepDetails::Combine(const StepDetails& other) {
   events_.insert(events_.end(), other.events_.begin(), other.events_.end());
   collectives_.insert(other.collectives_.begin(), other.collectives_.end());
   AggregateDeviceMemoryTransfers(other.device_memory_transfers_);
+  iterator_self_spans_.insert(iterator_self_spans_.end(),
+                              other.iterator_self_spans_.begin(),
+                              other.iterator_self_spans_.end());
   if (step_name_.empty()) step_name_ = other.step_name_;
 }
 
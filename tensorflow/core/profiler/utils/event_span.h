@@ -115,6 +115,15 @@ struct EventTypeSpan {
   }
 };
 
+// A span of time that a host thread spent in a tf.data iterator itself, i.e.
+// excluding the iterators it called.
+struct IteratorSelfSpan {
+  std::string iterator_name;  // long name, e.g. "Iterator::Root::Prefetch".
+  Timespan span;              // timespan of this self time.
+  IteratorSelfSpan(absl::string_view name, Timespan s)
+      : iterator_name(name), span(s) {}
+};
+
 enum class StepMarkerType {
   // "TraceContext" TraceMe events.
   kExplicitHostStepMarker,
@@ -158,12 +167,17 @@ class StepDetails {
   const std::vector<DeviceMemoryTransfer>& DeviceMemoryTransfers() const {
     return device_memory_transfers_;
   }
+  const std::vector<IteratorSelfSpan>& IteratorSelfSpans() const {
+    return iterator_self_spans_;
+  }
   // Returns the step time.
   Timespan StepTime() const;
   // Adds a step-marker to this step.
   void AddMarker(const StepMarker& m);
   // Adds an EventTypeSpan to this step.
   void AddEvent(const EventTypeSpan& e);
+  // Adds the self time of a tf.data iterator to this step.
+  void AddIteratorSelfSpan(const IteratorSelfSpan& s);
   // Adds a collective op to this step.
   void AddCollectiveOpEvent(uint64 core_id, const AllReduceInfo& e);
   // Appends device memory transfer events to this step.
@@ -209,6 +223,9 @@ class StepDetails {
   // TODO(jiesun): Consider to use IntervalSet instead of just sum up the event
   // durations.
   std::vector<DeviceMemoryTransfer> device_memory_transfers_;
+  // Self time of the tf.data iterators called in this step, used to attribute
+  // the time waiting for input to iterators.
+  std::vector<IteratorSelfSpan> iterator_self_spans_;
   std::string step_name_;
 };
 
@@ -42,7 +42,9 @@ double GetCappedPerf(double perf, uint64 time, double rate_limit) {
 
 void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
                                      absl::string_view category, bool is_eager,
-                                     uint64 time_ps, uint64 children_time_ps) {
+                                     uint64 time_ps, uint64 children_time_ps,
+                                     const OpMetrics::HardwareCounters*
+                                         hardware_counters) {
   uint64 self_time_ps = time_ps - children_time_ps;
   DCHECK_GE(time_ps, self_time_ps);
   OpMetrics* op_metrics = LookupOrInsertNewOpMetrics(/*hlo_module_id=*/0, name);
@@ -53,6 +55,10 @@ void HostOpMetricsDbBuilder::EnterOp(absl::string_view name,
   op_metrics->set_occurrences(op_metrics->occurrences() + 1);
   op_metrics->set_time_ps(op_metrics->time_ps() + time_ps);
   op_metrics->set_self_time_ps(op_metrics->self_time_ps() + self_time_ps);
+  if (hardware_counters != nullptr) {
+    CombineHardwareCounters(*hardware_counters,
+                            op_metrics->mutable_hardware_counters());
+  }
   db()->set_total_op_time_ps(db()->total_op_time_ps() + self_time_ps);
 }
 
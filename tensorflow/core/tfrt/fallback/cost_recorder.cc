@@ -18,6 +18,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
@@ -38,7 +39,7 @@ size_t CostRecorder::size() {
   return op_cost_map_.size();
 }
 
-Status CostRecorder::WriteToFile() {
+Status CostRecorder::WriteToFile(absl::string_view path) {
   OpCostMapProto op_cost_map_proto;
   {
     tf_shared_lock l(op_cost_map_mutex_);
@@ -48,11 +49,15 @@ Status CostRecorder::WriteToFile() {
     }
   }
 
+  return tensorflow::WriteTextProto(tensorflow::Env::Default(),
+                                    std::string(path), op_cost_map_proto);
+}
+
+Status CostRecorder::WriteToFile() {
   std::string measured_cost_path;
   TF_RETURN_IF_ERROR(ReadStringFromEnvVar("TF_TFRT_MEASURED_COST_PATH", "",
                                           &measured_cost_path));
-  return tensorflow::WriteTextProto(tensorflow::Env::Default(),
-                                    measured_cost_path, op_cost_map_proto);
+  return WriteToFile(measured_cost_path);
 }
 
 }  // namespace tfrt_stub
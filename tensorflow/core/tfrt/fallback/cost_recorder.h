@@ -22,6 +22,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -41,6 +42,13 @@ class CostRecorder : public tfrt::SharedContext {
   void RecordCost(int64_t op_key, const uint64_t execution_time);
 
   size_t size();
+
+  // Writes the average cost of every op as an OpCostMapProto to `path`, which
+  // can be passed as TfrtCompileOptions::measured_cost_path when the model is
+  // loaded again.
+  Status WriteToFile(absl::string_view path);
+
+  // Same as above, with the path in TF_TFRT_MEASURED_COST_PATH.
   Status WriteToFile();
 
  private:
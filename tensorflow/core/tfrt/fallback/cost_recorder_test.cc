@@ -56,6 +56,21 @@ TEST(CostRecorderTest, WriteToFileTest) {
   EXPECT_EQ(op_cost_map_proto.op_cost_map_size(), 0);
 }
 
+TEST(CostRecorderTest, WriteToPathTest) {
+  CostRecorder recorder = CostRecorder(nullptr);
+  recorder.RecordCost(kTestOpKey, kTestCost);
+
+  std::string measured_cost_path;
+  tensorflow::Env::Default()->LocalTempFilename(&measured_cost_path);
+  TF_CHECK_OK(recorder.WriteToFile(measured_cost_path));
+
+  OpCostMapProto op_cost_map_proto;
+  TF_CHECK_OK(tensorflow::ReadTextProto(
+      tensorflow::Env::Default(), measured_cost_path, &op_cost_map_proto));
+
+  EXPECT_EQ(op_cost_map_proto.op_cost_map().at(kTestOpKey), kTestCost);
+}
+
 TEST(CostRecorderTest, ProtoRecordsTest) {
   CostRecorder recorder = CostRecorder(nullptr);
 
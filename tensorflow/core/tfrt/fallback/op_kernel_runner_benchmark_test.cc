@@ -0,0 +1,118 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Compares the per-op overhead of running kernels through OpKernelRunner, as
+// the TFRT fallback does, with the classic executor.
+
+#include <utility>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/tfrt/fallback/fallback_state.h"
+#include "tensorflow/core/tfrt/fallback/op_kernel_runner.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kCpuDeviceName[] = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+// We focus on the single thread performance of running ops.
+SessionOptions* GetOptions() {
+  static SessionOptions* opts = [] {
+    auto* opts = new SessionOptions;
+    opts->config.set_intra_op_parallelism_threads(1);
+    opts->config.set_inter_op_parallelism_threads(1);
+    return opts;
+  }();
+  return opts;
+}
+
+Tensor Zeros() {
+  Tensor data(DT_FLOAT, TensorShape({1}));
+  data.flat<float>().setZero();
+  return data;
+}
+
+// Runs a chain of `Mul` ops on a one-element tensor with the classic
+// executor.
+void BM_ExecutorMulChain(::testing::benchmark::State& state) {
+  const int chain_length = state.range(0);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* cur = test::graph::Constant(g, Zeros());
+  for (int i = 0; i < chain_length; ++i) {
+    cur = test::graph::Multi(g, "Mul", {cur, cur});
+  }
+  test::Benchmark("cpu", g, GetOptions(), nullptr, nullptr, "",
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  state.SetItemsProcessed(state.iterations() * chain_length);
+}
+BENCHMARK(BM_ExecutorMulChain)->Arg(1 << 10);
+
+// Runs the same chain of `Mul` ops by calling the OpKernelRunner of the
+// kernel with a reused OpKernelRunState, as the TFRT fallback does.
+void BM_OpKernelRunnerMulChain(::testing::benchmark::State& state) {
+  const int chain_length = state.range(0);
+
+  auto fallback_state =
+      tfrt_stub::FallbackState::Create(*GetOptions(), FunctionDefLibrary());
+  TF_CHECK_OK(fallback_state.status());
+  auto runner = tfrt_stub::OpKernelRunner::Create(
+      "Mul", kCpuDeviceName, /*num_args=*/2,
+      [](AttrValueMap* attr_value_map) {
+        (*attr_value_map)["T"].set_type(DT_FLOAT);
+        return OkStatus();
+      },
+      (*fallback_state)->device_manager(),
+      (*fallback_state)->process_function_library_runtime());
+  TF_CHECK_OK(runner.status());
+
+  tfrt_stub::OpKernelRunState run_state;
+  run_state.input_tf_tensor_values.resize(2);
+  auto& params = run_state.params;
+  params.device = runner->device();
+  params.op_kernel = runner->op_kernel();
+  params.resource_manager = runner->resource_manager();
+  params.input_alloc_attrs = runner->input_alloc_attrs();
+  params.output_attr_array = runner->output_alloc_attrs().data();
+  params.function_library = runner->function_library_runtime();
+
+  const Tensor zeros = Zeros();
+  for (auto s : state) {
+    Tensor cur = zeros;
+    for (int i = 0; i < chain_length; ++i) {
+      run_state.input_tf_tensor_values[0].tensor = &cur;
+      run_state.input_tf_tensor_values[1].tensor = &cur;
+      params.inputs = run_state.input_tf_tensor_values;
+      OpKernelContext context(&params, /*num_outputs=*/1);
+      runner->Run(&context);
+      TF_CHECK_OK(context.status());
+      cur = std::move(*context.mutable_output(0));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * chain_length);
+}
+BENCHMARK(BM_OpKernelRunnerMulChain)->Arg(1 << 10);
+
+}  // namespace
+}  // namespace tensorflow
@@ -25,8 +25,12 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/check.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
@@ -42,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -78,6 +83,8 @@ namespace {
 
 constexpr absl::string_view kSignatureJoiningDelimiter = "+";
 constexpr absl::string_view kTensorNameJoiningDelimiter = "-";
+// Delimits the C-escaped signature names of a line of the traffic file.
+constexpr char kTrafficNameDelimiter = '\t';
 constexpr absl::string_view kArgumentTypeJoiningDelimiter = "^";
 
 using SignatureMap = absl::flat_hash_map<std::string, internal::Signature>;
@@ -443,6 +450,31 @@ StatusOr<tensorflow::MetaGraphDef> ReadSavedModel(
   return std::move(meta_graph_def);
 }
 
+// Reads the signature combinations recorded in the traffic file `filename`.
+StatusOr<std::vector<std::vector<std::string>>> ReadTraffic(
+    const std::string& filename) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(
+      tensorflow::ReadFileToString(tensorflow::Env::Default(), filename,
+                                   &contents));
+  std::vector<std::vector<std::string>> traffic;
+  for (absl::string_view line :
+       absl::StrSplit(contents, '\n', absl::SkipEmpty())) {
+    std::vector<std::string> names;
+    for (absl::string_view escaped_name :
+         absl::StrSplit(line, kTrafficNameDelimiter)) {
+      std::string name;
+      if (!absl::CUnescape(escaped_name, &name)) {
+        return tensorflow::errors::DataLoss("Malformed line in ", filename,
+                                            ": ", line);
+      }
+      names.push_back(std::move(name));
+    }
+    traffic.push_back(std::move(names));
+  }
+  return traffic;
+}
+
 }  // namespace
 
 tensorflow::StatusOr<std::unique_ptr<SavedModel>>
@@ -575,11 +607,16 @@ SavedModelImpl::LoadSavedModel(Options options,
                             std::move(*meta_graph_def.mutable_graph_def())));
 
   // Finally, create the saved model.
-  return {std::make_unique<SavedModelImpl>(
+  auto saved_model = std::make_unique<SavedModelImpl>(
       std::move(options), std::move(meta_graph_def), std::move(bef),
       std::move(bef_file), std::move(initializers_and_signatures.signature_map),
       std::move(fallback_state), std::move(tpu_model_resource),
-      std::move(resource_context), std::move(graph_executor))};
+      std::move(resource_context), std::move(graph_executor));
+  if (saved_model->options_.enable_lazy_loading &&
+      !saved_model->options_.lazy_loading_traffic_file.empty()) {
+    saved_model->StartPrewarming();
+  }
+  return {std::move(saved_model)};
 }
 
 SavedModelImpl::SavedModelImpl(
@@ -603,6 +640,11 @@ SavedModelImpl::SavedModelImpl(
       resource_context_(std::move(resource_context)),
       graph_executor_(std::move(graph_executor)) {}
 
+SavedModelImpl::~SavedModelImpl() {
+  stop_prewarming_ = true;
+  prewarming_thread_.reset();
+}
+
 std::vector<std::string> SavedModelImpl::GetFunctionNames() const {
   std::vector<std::string> result;
   for (const auto& entry : signatures_) {
@@ -999,7 +1041,76 @@ SavedModelImpl::GetOrCreateLoadingResult(const RunOptions& run_options,
       const auto joined_signature,
       JoinSignatures(names, signatures_, meta_graph_def_.signature_def()));
 
-  return LoadJoinedSignature(joined_signature);
+  TF_ASSIGN_OR_RETURN(const LoadingResult& loading_result,
+                      LoadJoinedSignature(joined_signature));
+  RecordTraffic(names);
+  return {loading_result};
+}
+
+void SavedModelImpl::RecordTraffic(absl::Span<const std::string> names) {
+  const std::string& filename = options_.lazy_loading_traffic_file;
+  if (filename.empty()) return;
+  const auto joined_name = absl::StrJoin(names, kSignatureJoiningDelimiter);
+  if (!recorded_traffic_.insert(joined_name).second) return;
+
+  const std::string line = absl::StrCat(
+      absl::StrJoin(names, std::string(1, kTrafficNameDelimiter),
+                    [](std::string* out, const std::string& name) {
+                      out->append(absl::CEscape(name));
+                    }),
+      "\n");
+  std::unique_ptr<tensorflow::WritableFile> file;
+  auto status = tensorflow::Env::Default()->NewAppendableFile(filename, &file);
+  if (status.ok()) status = file->Append(line);
+  if (status.ok()) status = file->Close();
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to record the traffic of " << joined_name << " in "
+                 << filename << ": " << status;
+  }
+}
+
+void SavedModelImpl::StartPrewarming() {
+  const std::string& filename = options_.lazy_loading_traffic_file;
+  // No traffic was recorded yet.
+  if (!tensorflow::Env::Default()->FileExists(filename).ok()) return;
+  auto traffic = ReadTraffic(filename);
+  if (!traffic.ok()) {
+    LOG(WARNING) << "TFRT is not pre-warming signatures: " << traffic.status();
+    return;
+  }
+  {
+    tensorflow::mutex_lock l(loading_result_cache_mu_);
+    for (const auto& names : *traffic) {
+      recorded_traffic_.insert(
+          absl::StrJoin(names, kSignatureJoiningDelimiter));
+    }
+  }
+
+  LOG(INFO) << "TFRT pre-warming " << traffic->size()
+            << " signatures recorded in " << filename;
+  prewarming_thread_.reset(tensorflow::Env::Default()->StartThread(
+      tensorflow::ThreadOptions(), "tfrt_saved_model_prewarming",
+      [this, traffic = std::move(*traffic)]() {
+        const auto start_time = absl::Now();
+        for (const auto& names : traffic) {
+          if (stop_prewarming_) return;
+          // Skips the signatures the model no longer has.
+          if (!absl::c_all_of(names, [this](const std::string& name) {
+                return signatures_.contains(name);
+              })) {
+            continue;
+          }
+          auto loading_result = GetOrCreateLoadingResult(RunOptions(), names);
+          if (!loading_result.ok()) {
+            LOG(WARNING) << "TFRT failed to pre-warm signatures "
+                         << absl::StrJoin(names, kSignatureJoiningDelimiter)
+                         << ": " << loading_result.status();
+          }
+        }
+        LOG(INFO) << "TFRT finished pre-warming signatures. Took "
+                  << absl::ToInt64Milliseconds(absl::Now() - start_time)
+                  << " ms.";
+      }));
 }
 
 }  // namespace tfrt_stub
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_H_
 #define TENSORFLOW_CORE_TFRT_SAVED_MODEL_SAVED_MODEL_H_
 
+#include <atomic>
 #include <functional>
 #include <limits>
 #include <memory>
@@ -25,9 +26,11 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/tfrt/fallback/fallback_state.h"
@@ -118,6 +121,14 @@ class SavedModel {
     // the individual signatures will be loaded along with the saved model.
     bool enable_lazy_loading = false;
 
+    // With lazy loading, the file recording the traffic: each signature (or
+    // signature combination) is appended to it when it is first loaded. When
+    // the saved model is loaded, the signatures already recorded are loaded
+    // in the background, so that a restarted server doesn't compile the
+    // signatures that served its previous traffic on the request path. Empty
+    // to disable the recording and the pre-warming.
+    std::string lazy_loading_traffic_file;
+
     // If true, we'll attempt to find MLArchive within the given loading path.
     // If not found, will use the path as a normal SavedModel directory.
     bool maybe_load_from_mla = false;
@@ -220,7 +231,7 @@ class SavedModelImpl final : public SavedModel {
       std::unique_ptr<tfrt::ResourceContext> resource_context,
       std::unique_ptr<GraphExecutor> graph_executor);
 
-  ~SavedModelImpl() override = default;
+  ~SavedModelImpl() override;
 
   SavedModelImpl(const SavedModelImpl&) = delete;
   SavedModelImpl& operator=(const SavedModelImpl&) = delete;
@@ -278,6 +289,15 @@ class SavedModelImpl final : public SavedModel {
                            absl::Span<const std::string> names)
       TF_LOCKS_EXCLUDED(loading_result_cache_mu_);
 
+  // Appends `names` to `options_.lazy_loading_traffic_file` unless they are
+  // already recorded in it.
+  void RecordTraffic(absl::Span<const std::string> names)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(loading_result_cache_mu_);
+
+  // Starts loading the signatures recorded in
+  // `options_.lazy_loading_traffic_file` in the background.
+  void StartPrewarming();
+
   Options options_;
   // `meta_graph_def_` only contains metadata of the model. The graph_def field
   // is removed.
@@ -301,7 +321,14 @@ class SavedModelImpl final : public SavedModel {
   absl::flat_hash_map<std::string /*joined_name*/,
                       std::unique_ptr<LoadingResult>>
       loading_result_cache_ TF_GUARDED_BY(loading_result_cache_mu_);
+  // Joined names of the signatures in `options_.lazy_loading_traffic_file`.
+  absl::flat_hash_set<std::string> recorded_traffic_
+      TF_GUARDED_BY(loading_result_cache_mu_);
   std::unique_ptr<GraphExecutor> graph_executor_;
+  // Set to stop the pre-warming when the saved model is destroyed.
+  std::atomic<bool> stop_prewarming_{false};
+  // Last, so that it's joined before the other members are destroyed.
+  std::unique_ptr<tensorflow::Thread> prewarming_thread_;
 };
 
 class SavedModelMiraImpl;
@@ -23,6 +23,8 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/resource_loader.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
 #include "tensorflow/core/tfrt/mla/mla_test_utils.h"
@@ -1079,6 +1081,64 @@ TEST(SavedModelTest, DisableCompilation) {
   TF_ASSERT_OK((*saved_model)->Run(run_options, "toy", inputs, &outputs));
 }
 
+TEST(SavedModelTest, LazyLoadingPrewarmsRecordedTraffic) {
+  // SavedModel toy contains a graph of a single 'tf.AddV2' op. It is generated
+  // using the following python code:
+  //  x = tf.placeholder(tf.int32, shape=(3))
+  //  y = tf.compat.v1.get_variable(name='y', initializer=[1, 2, 3])
+  //  r = tf.matmul(x, y)
+  std::string saved_model_dir = tensorflow::GetDataDependencyFilepath(
+      "tensorflow/core/tfrt/saved_model/tests/toy_v1");
+
+  auto runtime = DefaultTfrtRuntime(/*num_threads=*/1);
+  auto options = DefaultSavedModelOptions(runtime.get());
+  options.enable_lazy_loading = true;
+  options.lazy_loading_traffic_file =
+      tensorflow::io::JoinPath(tensorflow::testing::TmpDir(), "toy_traffic");
+  tensorflow::Env::Default()
+      ->DeleteFile(options.lazy_loading_traffic_file)
+      .IgnoreError();
+
+  // Set input 'x' to [[1, 1, 1]]
+  std::vector<tensorflow::Tensor> inputs;
+  inputs.push_back(
+      CreateTfTensor<int32_t>(/*shape=*/{1, 3}, /*data=*/{1, 1, 1}));
+  std::vector<tensorflow::Tensor> outputs;
+  tfrt::SavedModel::RunOptions run_options;
+
+  {
+    auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                      /*tags=*/{"serve"});
+    TF_CHECK_OK(saved_model.status());
+    TF_ASSERT_OK((*saved_model)->Run(run_options, "toy", inputs, &outputs));
+  }
+  std::string traffic;
+  TF_ASSERT_OK(tensorflow::ReadFileToString(
+      tensorflow::Env::Default(), options.lazy_loading_traffic_file, &traffic));
+  EXPECT_EQ(traffic, "toy\n");
+
+  // A new saved model loads the recorded signature in the background, so it
+  // eventually runs without compilation.
+  auto saved_model = SavedModelImpl::LoadSavedModel(options, saved_model_dir,
+                                                    /*tags=*/{"serve"});
+  TF_CHECK_OK(saved_model.status());
+  run_options.disable_compilation = true;
+  tensorflow::Status status;
+  for (int i = 0; i < 6000; ++i) {
+    status = (*saved_model)->Run(run_options, "toy", inputs, &outputs);
+    if (status.ok()) break;
+    tensorflow::Env::Default()->SleepForMicroseconds(10 * 1000);
+  }
+  TF_ASSERT_OK(status);
+  EXPECT_THAT(GetTfTensorData<int32_t>(outputs[0]),
+              ::testing::ElementsAreArray({6}));
+
+  // The signature isn't recorded twice.
+  TF_ASSERT_OK(tensorflow::ReadFileToString(
+      tensorflow::Env::Default(), options.lazy_loading_traffic_file, &traffic));
+  EXPECT_EQ(traffic, "toy\n");
+}
+
 }  // namespace
 }  // namespace tfrt_stub
 }  // namespace tensorflow
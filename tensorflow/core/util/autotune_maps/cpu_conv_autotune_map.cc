@@ -0,0 +1,90 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_maps/cpu_conv_autotune_map.h"
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/tsl/lib/strings/proto_serialization.h"
+
+namespace tensorflow {
+
+string CpuConvAlgorithmName(CpuConvAlgorithm algorithm) {
+  switch (algorithm) {
+    case CpuConvAlgorithm::kEigen:
+      return "Eigen";
+    case CpuConvAlgorithm::kWinograd:
+      return "Winograd";
+    case CpuConvAlgorithm::kDirect:
+      return "Direct";
+  }
+  return absl::StrCat("Unknown(", static_cast<int>(algorithm), ")");
+}
+
+CpuConvParameters::CpuConvParameters(
+    int64_t batch, int64_t in_depths, absl::Span<const int64_t> in,
+    int64_t out_depths, absl::Span<const int64_t> filter,
+    absl::Span<const int64_t> dilation, absl::Span<const int64_t> stride,
+    absl::Span<const int64_t> padding, DataType dtype, int num_threads) {
+  proto_.set_batch(batch);
+  proto_.set_in_depths(in_depths);
+  *proto_.mutable_in() = {in.begin(), in.end()};
+  proto_.set_out_depths(out_depths);
+  *proto_.mutable_filter() = {filter.begin(), filter.end()};
+  *proto_.mutable_dilation() = {dilation.begin(), dilation.end()};
+  *proto_.mutable_stride() = {stride.begin(), stride.end()};
+  *proto_.mutable_padding() = {padding.begin(), padding.end()};
+  proto_.set_dtype(dtype);
+  proto_.set_group_count(1);
+  proto_.set_device_identifier(absl::StrCat("CPU threads=", num_threads));
+  proto_.set_version(kVersion);
+  hash_code_ = tsl::DeterministicProtoHash64(proto_);
+}
+
+bool CpuConvParameters::operator==(const CpuConvParameters& other) const {
+  return hash_code_ == other.hash_code_ &&
+         tsl::protobuf::util::MessageDifferencer::Equals(proto_, other.proto_);
+}
+
+string CpuConvParameters::ToString() const { return proto_.DebugString(); }
+
+CpuConvAutotuneMap* CpuConvAutotuneMap::GetInstance() {
+  static CpuConvAutotuneMap* instance = new CpuConvAutotuneMap();
+  return instance;
+}
+
+bool CpuConvAutotuneMap::Find(const CpuConvParameters& params,
+                              CpuConvAlgorithm* algorithm) const {
+  mutex_lock lock(mu_);
+  auto iter = map_.find(params);
+  if (iter == map_.end()) return false;
+  *algorithm = iter->second;
+  return true;
+}
+
+void CpuConvAutotuneMap::Insert(const CpuConvParameters& params,
+                                CpuConvAlgorithm algorithm) {
+  VLOG(1) << "cpu conv autotune map accepts " << params.ToString() << ": -> "
+          << CpuConvAlgorithmName(algorithm);
+  mutex_lock lock(mu_);
+  map_[params] = algorithm;
+}
+
+void CpuConvAutotuneMap::ClearMap() {
+  mutex_lock lock(mu_);
+  map_.clear();
+}
+
+}  // namespace tensorflow
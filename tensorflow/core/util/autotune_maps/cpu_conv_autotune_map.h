@@ -0,0 +1,116 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// This file defines the map data structure for storing autotuning results for
+// Conv2D on CPU.
+//
+// The key of the map uniquely identifies a convolution running on a CPU thread
+// pool of a particular size, while the value is the algorithm chosen for it.
+
+#ifndef TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CPU_CONV_AUTOTUNE_MAP_H_
+#define TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CPU_CONV_AUTOTUNE_MAP_H_
+
+#include <string>
+#include <unordered_map>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+
+namespace tensorflow {
+
+// The algorithms that Conv2D can run on CPU.
+enum class CpuConvAlgorithm {
+  // Eigen's SpatialConvolution, or a single matrix multiplication when the
+  // convolution reduces to one. Both pack patches and run a GEMM (im2col).
+  kEigen = 0,
+  // Winograd F(2x2, 3x3) minimal filtering, see deep_conv2d.h.
+  kWinograd = 1,
+  // Direct convolution without any patch packing, for small channel counts.
+  kDirect = 2,
+};
+
+string CpuConvAlgorithmName(CpuConvAlgorithm algorithm);
+
+// Uniquely identifies a convolution running on a CPU thread pool. The data is
+// stored in a ConvParametersProto, like for GPU convolutions, with the number
+// of threads as the device identifier.
+class CpuConvParameters {
+ public:
+  // A positive number that denotes the version of this class. Should be
+  // incremented everytime this class is updated in a way that may invalidate
+  // autotune results, for example when an algorithm is added.
+  static constexpr int kVersion = 1;
+
+  CpuConvParameters(int64_t batch, int64_t in_depths,
+                    absl::Span<const int64_t> in, int64_t out_depths,
+                    absl::Span<const int64_t> filter,
+                    absl::Span<const int64_t> dilation,
+                    absl::Span<const int64_t> stride,
+                    absl::Span<const int64_t> padding, DataType dtype,
+                    int num_threads);
+
+  bool operator==(const CpuConvParameters& other) const;
+
+  bool operator!=(const CpuConvParameters& other) const {
+    return !(*this == other);
+  }
+  uint64 hash() const { return hash_code_; }
+
+  string ToString() const;
+
+  const ConvParametersProto& proto() const { return proto_; }
+
+ private:
+  ConvParametersProto proto_;
+  uint64 hash_code_;
+};
+
+// Process-wide map from CPU convolutions to the fastest algorithm measured for
+// them. Unlike the GPU autotune maps, results are accepted after a single
+// measurement, since the CPU algorithms differ by large factors when they
+// differ at all.
+class CpuConvAutotuneMap {
+ public:
+  static CpuConvAutotuneMap* GetInstance();
+
+  bool Find(const CpuConvParameters& params, CpuConvAlgorithm* algorithm) const;
+  void Insert(const CpuConvParameters& params, CpuConvAlgorithm algorithm);
+
+  // Only for testing
+  void ClearMap();
+
+ private:
+  CpuConvAutotuneMap() = default;
+
+  struct Hasher {
+    std::size_t operator()(const CpuConvParameters& params) const {
+      return params.hash();
+    }
+  };
+
+  mutable mutex mu_;
+  std::unordered_map<CpuConvParameters, CpuConvAlgorithm, Hasher> map_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CpuConvAutotuneMap);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CPU_CONV_AUTOTUNE_MAP_H_
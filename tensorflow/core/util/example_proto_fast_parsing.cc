@@ -1010,46 +1010,39 @@ void CopyOrMoveBlock(const tstring* b, const tstring* e, tstring* t) {
 }
 
 template <typename T>
-void FillAndCopyVarLen(
-    const int d, const size_t num_elements,
-    const size_t num_elements_per_minibatch, const Config& config,
-    const std::vector<std::vector<SparseBuffer>>& varlen_dense_buffers,
-    Tensor* values) {
-  const Tensor& default_value = config.dense[d].default_value;
-
-  // Copy-fill the tensors (creating the zero/fill-padding)
-  std::fill(values->flat<T>().data(), values->flat<T>().data() + num_elements,
-            default_value.flat<T>()(0));
+void FillAndCopyVarLen(const int d, const size_t first_example,
+                       const size_t num_elements_per_example,
+                       const Config& config, const SparseBuffer& buffer,
+                       Tensor* values) {
+  const T& default_value = config.dense[d].default_value.flat<T>()(0);
 
   // Data is [batch_size, max_num_elements, data_stride_size]
-  //   and num_elements_per_minibatch = max_num_elements * data_stride_size
-  auto data = values->flat<T>().data();
-
-  // Iterate over minibatch elements
-  for (size_t i = 0; i < varlen_dense_buffers.size(); ++i) {
-    const SparseBuffer& buffer = varlen_dense_buffers[i][d];
-    // Number of examples being stored in this buffer
-    const auto& end_indices = buffer.example_end_indices;
-    const size_t examples_in_buffer = end_indices.size();
-    // const size_t stride_size = config.dense[d].elements_per_stride;
-
-    const auto& list = GetListFromBuffer<T>(buffer);
-    auto list_ptr = list.begin();
-
-    size_t elements_tally = 0;
-    // Iterate through all the examples stored in this buffer.
-    for (size_t j = 0; j < examples_in_buffer; ++j) {
-      // Number of elements stored for this example.
-      const size_t num_elems = end_indices[j] - elements_tally;
-      CopyOrMoveBlock(list_ptr, list_ptr + num_elems, data);
-      // Move forward this many elements in the varlen buffer.
-      list_ptr += num_elems;
-      // Move forward to the next minibatch entry in the values output.
-      data += num_elements_per_minibatch;
-      elements_tally = end_indices[j];
-    }
-    DCHECK(elements_tally == list.size());
-  }
+  //   and num_elements_per_example = max_num_elements * data_stride_size
+  T* data = values->flat<T>().data() + first_example * num_elements_per_example;
+
+  // Number of examples being stored in this buffer
+  const auto& end_indices = buffer.example_end_indices;
+  const size_t examples_in_buffer = end_indices.size();
+
+  const auto& list = GetListFromBuffer<T>(buffer);
+  auto list_ptr = list.begin();
+
+  size_t elements_tally = 0;
+  // Iterate through all the examples stored in this buffer.
+  for (size_t j = 0; j < examples_in_buffer; ++j) {
+    // Number of elements stored for this example.
+    const size_t num_elems = end_indices[j] - elements_tally;
+    CopyOrMoveBlock(list_ptr, list_ptr + num_elems, data);
+    // Fill the rest of the example's row with the default value.
+    std::fill(data + num_elems, data + num_elements_per_example,
+              default_value);
+    // Move forward this many elements in the varlen buffer.
+    list_ptr += num_elems;
+    // Move forward to the next example in the values output.
+    data += num_elements_per_example;
+    elements_tally = end_indices[j];
+  }
+  DCHECK(elements_tally == list.size());
 }
 
 // Thin vector like interface wrapper around a Tensor. This enable us to
@@ -1087,19 +1080,27 @@ class TensorVector {
   T* data_ = nullptr;
 };
 
-void CountSparseFeatures(
-    const std::vector<std::vector<SparseBuffer>>& sparse_buffers, size_t d,
-    size_t* total_num_features, size_t* max_num_features) {
-  for (auto& sparse_values_tmp : sparse_buffers) {
+// Returns the offset of the first value of each minibatch for feature `d` in
+// the merged values tensor, followed by the total number of values. Also
+// returns the largest number of values in any single example.
+std::vector<size_t> MinibatchValueOffsets(
+    const std::vector<std::vector<SparseBuffer>>& buffers, size_t d,
+    size_t* max_num_features) {
+  std::vector<size_t> offsets;
+  offsets.reserve(buffers.size() + 1);
+  offsets.push_back(0);
+  *max_num_features = 0;
+  for (const auto& minibatch_buffers : buffers) {
     const std::vector<size_t>& end_indices =
-        sparse_values_tmp[d].example_end_indices;
-    *total_num_features += end_indices.back();
+        minibatch_buffers[d].example_end_indices;
+    offsets.push_back(offsets.back() + end_indices.back());
     *max_num_features = std::max(*max_num_features, end_indices[0]);
     for (size_t i = 1; i < end_indices.size(); ++i) {
       size_t example_size = end_indices[i] - end_indices[i - 1];
       *max_num_features = std::max(*max_num_features, example_size);
     }
   }
+  return offsets;
 }
 
 void CopySparseBufferToTensor(DataType dtype, size_t offset, SparseBuffer* src,
@@ -1263,40 +1264,125 @@ Status FastParseExample(const Config& config,
     result->dense_values.push_back(std::move(fixed_dense_values[d]));
   }
 
-  // Merge SparseBuffers from all minibatches for every config.sparse.
-  auto MergeSparseMinibatches = [&](size_t d) {
-    // Loop over minibatches
-    size_t total_num_features = 0;
+  // The minibatch buffers are merged in two passes. The first pass sizes and
+  // allocates every output of the batch. The second pass lets each minibatch
+  // write its slice of every output in parallel, directly at its final offset.
+
+  // Size and allocate the outputs of every config.dense having
+  // variable_length.
+  std::vector<size_t> num_elements_per_example(config.dense.size(), 0);
+  for (size_t d = 0; d < config.dense.size(); ++d) {
+    if (!config.dense[d].variable_length) continue;
+
+    size_t max_num_features = 0;
+    MinibatchValueOffsets(varlen_dense_buffers, d, &max_num_features);
+
+    const size_t stride_size = config.dense[d].elements_per_stride;
+    const size_t max_num_elements = max_num_features / stride_size;
+    TensorShape values_shape;
+    DCHECK_EQ(max_num_features % config.dense[d].elements_per_stride, 0);
+    const size_t batch_size = serialized.size();
+    values_shape.AddDim(batch_size);
+    values_shape.AddDim(max_num_elements);
+    for (int i = 1; i < config.dense[d].shape.dims(); ++i) {
+      values_shape.AddDim(config.dense[d].shape.dim_size(i));
+    }
+    result->dense_values[d] = Tensor(config.dense[d].dtype, values_shape);
+    const size_t num_elements = result->dense_values[d].NumElements();
+    if (num_elements > 0) {
+      num_elements_per_example[d] = num_elements / batch_size;
+    }
+  }
+
+  // Size and allocate the outputs of every config.sparse.
+  std::vector<std::vector<size_t>> sparse_offsets(config.sparse.size());
+  for (size_t d = 0; d < config.sparse.size(); ++d) {
     size_t max_num_features = 0;
-    CountSparseFeatures(sparse_buffers, d, &total_num_features,
-                        &max_num_features);
+    sparse_offsets[d] =
+        MinibatchValueOffsets(sparse_buffers, d, &max_num_features);
+    const size_t total_num_features = sparse_offsets[d].back();
 
     TensorShape indices_shape;
     indices_shape.AddDim(total_num_features);
     indices_shape.AddDim(2);
     result->sparse_indices.emplace_back(DT_INT64, indices_shape);
-    Tensor* indices = &result->sparse_indices.back();
 
     TensorShape values_shape;
     values_shape.AddDim(total_num_features);
     result->sparse_values.emplace_back(config.sparse[d].dtype, values_shape);
-    Tensor* values = &result->sparse_values.back();
 
     result->sparse_shapes.emplace_back(DT_INT64, TensorShape({2}));
     auto shapes_shape_t = result->sparse_shapes.back().vec<int64_t>();
     shapes_shape_t(0) = serialized.size();
     shapes_shape_t(1) = max_num_features;
+  }
+
+  // Size and allocate the outputs of every config.ragged.
+  std::vector<std::vector<size_t>> ragged_offsets(config.ragged.size());
+  for (size_t d = 0; d < config.ragged.size(); ++d) {
+    size_t max_num_features = 0;
+    ragged_offsets[d] =
+        MinibatchValueOffsets(ragged_buffers, d, &max_num_features);
+
+    TensorShape row_splits_shape;
+    row_splits_shape.AddDim(serialized.size() + 1);
+    result->ragged_splits.emplace_back(config.ragged[d].splits_dtype,
+                                       row_splits_shape);
+    Tensor* row_splits = &result->ragged_splits.back();
+    if (config.ragged[d].splits_dtype == DT_INT64) {
+      row_splits->flat<int64_t>()(0) = 0;
+    } else {
+      row_splits->flat<int32>()(0) = 0;
+    }
+
+    TensorShape values_shape;
+    values_shape.AddDim(ragged_offsets[d].back());
+    result->ragged_values.emplace_back(config.ragged[d].dtype, values_shape);
+  }
+
+  // Write the values of one minibatch into every output.
+  auto MergeMinibatch = [&](size_t i) {
+    const size_t first_example = first_example_of_minibatch(i);
+
+    for (size_t d = 0; d < config.dense.size(); ++d) {
+      // Nothing to write for fixed length or empty outputs.
+      if (num_elements_per_example[d] == 0) continue;
+      const SparseBuffer& buffer = varlen_dense_buffers[i][d];
+      Tensor* values = &result->dense_values[d];
+      switch (config.dense[d].dtype) {
+        case DT_INT64: {
+          FillAndCopyVarLen<int64_t>(d, first_example,
+                                     num_elements_per_example[d], config,
+                                     buffer, values);
+          break;
+        }
+        case DT_FLOAT: {
+          FillAndCopyVarLen<float>(d, first_example,
+                                   num_elements_per_example[d], config,
+                                   buffer, values);
+          break;
+        }
+        case DT_STRING: {
+          FillAndCopyVarLen<tstring>(d, first_example,
+                                     num_elements_per_example[d], config,
+                                     buffer, values);
+          break;
+        }
+        default:
+          ReportUnexpectedDataType(config.dense[d].dtype);
+      }
+    }
 
-    size_t offset = 0;
-    for (size_t i = 0; i < sparse_buffers.size(); ++i) {
+    for (size_t d = 0; d < config.sparse.size(); ++d) {
       SparseBuffer& buffer = sparse_buffers[i][d];
+      const size_t offset = sparse_offsets[d][i];
+      Tensor* indices = &result->sparse_indices[d];
 
       // Update indices.
-      size_t delta = 0;
-
-      if (indices->NumElements() > 0) {
+      if (sparse_offsets[d][i + 1] > offset) {
         int64* ix_p = &indices->matrix<int64_t>()(offset, 0);
-        size_t example_index = first_example_of_minibatch(i);
+        size_t example_index = first_example;
+        size_t delta = 0;
         for (size_t example_end_index : buffer.example_end_indices) {
           size_t feature_index = 0;
           for (; delta < example_end_index; ++delta) {
@@ -1311,132 +1397,35 @@ Status FastParseExample(const Config& config,
         }
       }
 
-      CopySparseBufferToTensor(config.sparse[d].dtype, offset, &buffer, values);
-      offset += delta;
+      CopySparseBufferToTensor(config.sparse[d].dtype, offset, &buffer,
+                               &result->sparse_values[d]);
     }
-  };
 
-  // Merge SparseBuffers from all minibatches for every config.ragged.
-  auto MergeRaggedMinibatches = [&](size_t d) {
-    // Loop over minibatches
-    size_t total_num_features = 0;
-    size_t max_num_features = 0;
-    CountSparseFeatures(ragged_buffers, d, &total_num_features,
-                        &max_num_features);
-
-    TensorShape row_splits_shape;
-    row_splits_shape.AddDim(serialized.size() + 1);
-    result->ragged_splits.emplace_back(config.ragged[d].splits_dtype,
-                                       row_splits_shape);
-    Tensor* row_splits = &result->ragged_splits.back();
-    if (config.ragged[d].splits_dtype == DT_INT64) {
-      row_splits->flat<int64_t>()(0) = 0;
-    } else {
-      row_splits->flat<int32>()(0) = 0;
-    }
-
-    TensorShape values_shape;
-    values_shape.AddDim(total_num_features);
-    result->ragged_values.emplace_back(config.ragged[d].dtype, values_shape);
-    Tensor* values = &result->ragged_values.back();
-
-    size_t values_offset = 0;
-    size_t splits_offset = 0;
-    for (size_t i = 0; i < ragged_buffers.size(); ++i) {
+    for (size_t d = 0; d < config.ragged.size(); ++d) {
       SparseBuffer& buffer = ragged_buffers[i][d];
-      if (buffer.example_end_indices.empty()) continue;
+      const size_t values_offset = ragged_offsets[d][i];
+      Tensor* row_splits = &result->ragged_splits[d];
 
       // Update row_splits.  row_splits are formed by concatenating the example
       // end_indices (adjusting each to start after the previous one ends).
       if (config.ragged[d].splits_dtype == DT_INT64) {
-        int64* row_splits_out = &row_splits->flat<int64_t>()(splits_offset);
-        int64_t start = *row_splits_out;
+        int64* row_splits_out = &row_splits->flat<int64_t>()(first_example);
         for (size_t example_end_index : buffer.example_end_indices) {
-          *++row_splits_out = start + example_end_index;
+          *++row_splits_out = values_offset + example_end_index;
         }
       } else {
-        int32* row_splits_out = &row_splits->flat<int32>()(splits_offset);
-        int32_t start = *row_splits_out;
+        int32* row_splits_out = &row_splits->flat<int32>()(first_example);
         for (size_t example_end_index : buffer.example_end_indices) {
-          *++row_splits_out = start + example_end_index;
+          *++row_splits_out = values_offset + example_end_index;
         }
       }
 
       CopySparseBufferToTensor(config.ragged[d].dtype, values_offset, &buffer,
-                               values);
-      values_offset += buffer.example_end_indices.back();
-      splits_offset += buffer.example_end_indices.size();
+                               &result->ragged_values[d]);
     }
   };
 
-  // Merge SparseBuffers from all minibatches for every config.dense having
-  // variable_length.
-  auto MergeDenseVarLenMinibatches = [&](size_t d) {
-    if (!config.dense[d].variable_length) return;
-
-    // Loop over minibatches
-    size_t max_num_features = 0;
-    for (auto& dense_values_tmp : varlen_dense_buffers) {
-      std::vector<size_t>& end_indices =
-          dense_values_tmp[d].example_end_indices;
-      max_num_features = std::max(max_num_features, end_indices[0]);
-      for (size_t i = 1; i < end_indices.size(); ++i) {
-        size_t example_size = end_indices[i] - end_indices[i - 1];
-        max_num_features = std::max(max_num_features, example_size);
-      }
-    }
-
-    const size_t stride_size = config.dense[d].elements_per_stride;
-    const size_t max_num_elements = max_num_features / stride_size;
-    TensorShape values_shape;
-    DCHECK_EQ(max_num_features % config.dense[d].elements_per_stride, 0);
-    const size_t batch_size = serialized.size();
-    values_shape.AddDim(batch_size);
-    values_shape.AddDim(max_num_elements);
-    for (int i = 1; i < config.dense[d].shape.dims(); ++i) {
-      values_shape.AddDim(config.dense[d].shape.dim_size(i));
-    }
-    Tensor values(config.dense[d].dtype, values_shape);
-    result->dense_values[d] = values;
-    const size_t num_elements = values.NumElements();
-
-    // Nothing to write, exit early.
-    if (num_elements == 0) return;
-
-    const size_t num_elements_per_minibatch = num_elements / batch_size;
-
-    switch (config.dense[d].dtype) {
-      case DT_INT64: {
-        FillAndCopyVarLen<int64_t>(d, num_elements, num_elements_per_minibatch,
-                                   config, varlen_dense_buffers, &values);
-        break;
-      }
-      case DT_FLOAT: {
-        FillAndCopyVarLen<float>(d, num_elements, num_elements_per_minibatch,
-                                 config, varlen_dense_buffers, &values);
-        break;
-      }
-      case DT_STRING: {
-        FillAndCopyVarLen<tstring>(d, num_elements, num_elements_per_minibatch,
-                                   config, varlen_dense_buffers, &values);
-        break;
-      }
-      default:
-        ReportUnexpectedDataType(config.dense[d].dtype);
-    }
-  };
-
-  for (size_t d = 0; d < config.dense.size(); ++d) {
-    MergeDenseVarLenMinibatches(d);
-  }
-
-  for (size_t d = 0; d < config.sparse.size(); ++d) {
-    MergeSparseMinibatches(d);
-  }
-
-  for (size_t d = 0; d < config.ragged.size(); ++d) {
-    MergeRaggedMinibatches(d);
-  }
+  ParallelFor(MergeMinibatch, num_minibatches, thread_pool);
 
   return OkStatus();
 }
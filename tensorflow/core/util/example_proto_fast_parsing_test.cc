@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/example_proto_fast_parsing_test.pb.h"
 
 namespace tensorflow {
@@ -427,6 +428,62 @@ TEST(TestFastParseExample, Empty) {
   EXPECT_TRUE(status.ok()) << status;
 }
 
+TEST(TestFastParseExample, MergesMinibatchesInParallel) {
+  // Enough examples to be split into several minibatches, with a varying
+  // number of values per example (including none).
+  const int kNumExamples = 37;
+  std::vector<tstring> serialized;
+  for (int i = 0; i < kNumExamples; ++i) {
+    Example example;
+    for (const char* key : {"sparse", "ragged", "dense"}) {
+      auto& feature = (*example.mutable_features()->mutable_feature())[key];
+      auto* int64_list = feature.mutable_int64_list();
+      for (int j = 0; j < i % 4; ++j) {
+        int64_list->add_value(i * 10 + j);
+      }
+    }
+    serialized.push_back(example.SerializeAsString());
+  }
+
+  FastParseExampleConfig config;
+  config.sparse.push_back({"sparse", DT_INT64});
+  config.ragged.push_back({"ragged", DT_INT64, DT_INT32});
+  Tensor default_value(DT_INT64, TensorShape({}));
+  default_value.scalar<int64_t>()() = -1;
+  config.dense.push_back({"dense", DT_INT64, PartialTensorShape({-1}),
+                          default_value, true, 1});
+
+  thread::ThreadPool thread_pool(Env::Default(), "test", 4);
+  Result result;
+  TF_ASSERT_OK(
+      FastParseExample(config, serialized, {}, &thread_pool, &result));
+
+  const Tensor& indices = result.sparse_indices[0];
+  const Tensor& sparse_values = result.sparse_values[0];
+  const Tensor& splits = result.ragged_splits[0];
+  const Tensor& ragged_values = result.ragged_values[0];
+  const Tensor& dense_values = result.dense_values[0];
+  EXPECT_EQ(result.sparse_shapes[0].vec<int64_t>()(0), kNumExamples);
+  EXPECT_EQ(result.sparse_shapes[0].vec<int64_t>()(1), 3);
+  ASSERT_EQ(dense_values.shape(), TensorShape({kNumExamples, 3}));
+  EXPECT_EQ(splits.vec<int32>()(0), 0);
+  int64_t n = 0;
+  for (int i = 0; i < kNumExamples; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      const int64_t expected = j < i % 4 ? i * 10 + j : -1;
+      EXPECT_EQ(dense_values.matrix<int64_t>()(i, j), expected);
+      if (j >= i % 4) continue;
+      EXPECT_EQ(indices.matrix<int64_t>()(n, 0), i);
+      EXPECT_EQ(indices.matrix<int64_t>()(n, 1), j);
+      EXPECT_EQ(sparse_values.vec<int64_t>()(n), expected);
+      EXPECT_EQ(ragged_values.vec<int64_t>()(n), expected);
+      ++n;
+    }
+    EXPECT_EQ(splits.vec<int32>()(i + 1), n);
+  }
+  EXPECT_EQ(sparse_values.NumElements(), n);
+}
+
 }  // namespace
 }  // namespace example
 }  // namespace tensorflow
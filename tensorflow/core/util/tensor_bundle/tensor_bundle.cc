@@ -21,6 +21,7 @@ limitations under the License.
 #include <memory>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -79,6 +80,30 @@ const int64_t kMinSectionSize = static_cast<int64_t>(1) << 31;
 
 namespace {
 
+// A read-only tensor buffer aliasing part of a memory-mapped data file. Keeps
+// the file mapped for as long as a tensor uses it.
+class MemmappedTensorBuffer : public TensorBuffer {
+ public:
+  MemmappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                        int64_t offset, size_t size)
+      : TensorBuffer(const_cast<char*>(
+                         static_cast<const char*>(region->data()) + offset)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("MemmappedTensorBundle");
+  }
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 // Reads "num_elements" string elements from file[offset, offset+size) into the
 // length-N "destination".  Discards the original content of "destination".
 //
@@ -418,8 +443,45 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64_t* size) {
   return status;
 }
 
+// Appends "val" to "out", whose current size is "size", and records its offset,
+// size and checksum in "entry".
+Status AppendTensor(const Tensor& val, FileOutputBuffer* out, int alignment,
+                    int64_t* size, BundleEntryProto* entry) {
+  entry->set_offset(*size);
+  size_t data_bytes_written = 0;
+  uint32 crc32c = 0;
+  out->clear_crc32c();
+  Status status;
+  if (val.dtype() == DT_STRING) {
+    status = WriteStringTensor(val, out, &data_bytes_written, &crc32c);
+  } else if (val.dtype() == DT_VARIANT) {
+    status = WriteVariantTensor(val, out, &data_bytes_written, &crc32c);
+  } else {
+    status = WriteTensor(val, out, &data_bytes_written);
+    crc32c = out->crc32c();
+  }
+  if (!status.ok()) return status;
+
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(crc32c));
+  *size += data_bytes_written;
+  return PadAlignment(out, alignment, size);
+}
+
 }  // namespace
 
+struct BundleWriter::DataShard {
+  string path;  // Temporary, renamed by FinishDataShards().
+  std::unique_ptr<FileOutputBuffer> out;
+  // Only accessed by "thread" until it is joined.
+  int64_t size = 0;
+  Status status;
+  // Bytes queued to this shard, which Add() balances across shards.
+  int64_t queued_bytes = 0;
+  // Writes the queued tensors in order.
+  std::unique_ptr<thread::ThreadPool> thread;
+};
+
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     : env_(env), options_(options), prefix_(prefix), out_(nullptr), size_(0) {
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
@@ -438,6 +500,11 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     return;
   }
 
+  if (options_.num_shards > 1) {
+    status_ = OpenDataShards();
+    return;
+  }
+
   std::unique_ptr<WritableFile> wrapper;
   status_ = env_->NewWritableFile(data_path_, &wrapper);
   if (!status_.ok()) return;
@@ -447,6 +514,95 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
   VLOG(1) << "Writing to file " << data_path_;
 }
 
+BundleWriter::~BundleWriter() {
+  // Joins the threads of the data shards before their files are closed.
+  for (auto& shard : data_shards_) shard->thread.reset();
+}
+
+Status BundleWriter::OpenDataShards() {
+  const int num_shards = options_.num_shards;
+  for (int i = 0; i < num_shards; ++i) {
+    auto shard = std::make_unique<DataShard>();
+    // The final names depend on the number of shards that receive tensors, so
+    // the data files always start under a temporary name.
+    shard->path = strings::StrCat(DataFilename(prefix_, i, num_shards),
+                                  ".tempstate", random::New64());
+    std::unique_ptr<WritableFile> wrapper;
+    TF_RETURN_IF_ERROR(env_->NewWritableFile(shard->path, &wrapper));
+    shard->out = std::make_unique<FileOutputBuffer>(
+        wrapper.release(), 8 << 20 /* 8MB write buffer */);
+    shard->thread = std::make_unique<thread::ThreadPool>(
+        env_, "bundle_writer_shard", /*num_threads=*/1);
+    VLOG(1) << "Writing to file " << shard->path;
+    data_shards_.push_back(std::move(shard));
+  }
+  return OkStatus();
+}
+
+void BundleWriter::AddToDataShard(const Tensor& val, BundleEntryProto* entry) {
+  int shard_id = 0;
+  for (int i = 1; i < data_shards_.size(); ++i) {
+    if (data_shards_[i]->queued_bytes < data_shards_[shard_id]->queued_bytes) {
+      shard_id = i;
+    }
+  }
+  DataShard* shard = data_shards_[shard_id].get();
+  shard->queued_bytes += val.TotalBytes();
+  entry->set_shard_id(shard_id);
+  // "entry" stays valid since elements of the std::map are never moved, and
+  // its fields are only written here until the thread is joined.
+  const int alignment = options_.data_alignment;
+  shard->thread->Schedule([shard, val, alignment, entry]() {
+    if (!shard->status.ok()) return;
+    shard->status =
+        AppendTensor(val, shard->out.get(), alignment, &shard->size, entry);
+  });
+}
+
+Status BundleWriter::FinishDataShards() {
+  // The data files are deleted if any Add() failed.
+  Status status = status_;
+  for (auto& shard : data_shards_) {
+    shard->thread.reset();
+    status.Update(shard->status);
+    status.Update(shard->out->Close());
+  }
+  // Renumbers the shards that received tensors, or keeps the first one of an
+  // empty bundle, like a writer with a single shard.
+  std::vector<int32> shard_ids(data_shards_.size(), -1);
+  int num_data_shards = 0;
+  for (int i = 0; i < data_shards_.size(); ++i) {
+    if (data_shards_[i]->queued_bytes > 0 || (i == 0 && entries_.empty())) {
+      shard_ids[i] = num_data_shards++;
+    }
+  }
+  for (auto& p : entries_) {
+    BundleEntryProto& entry = p.second;
+    if (entry.slices().empty() && shard_ids[entry.shard_id()] < 0) {
+      // Only tensors without bytes, e.g. of an empty shape, can be here.
+      shard_ids[entry.shard_id()] = num_data_shards++;
+    }
+  }
+  for (int i = 0; i < data_shards_.size(); ++i) {
+    const string& path = data_shards_[i]->path;
+    if (status.ok() && shard_ids[i] >= 0) {
+      status = env_->RenameFile(
+          path, DataFilename(prefix_, shard_ids[i], num_data_shards));
+    } else {
+      env_->DeleteFile(path).IgnoreError();
+    }
+  }
+  data_shards_.clear();
+  if (!status.ok()) return status;
+
+  for (auto& p : entries_) {
+    BundleEntryProto& entry = p.second;
+    if (entry.slices().empty()) entry.set_shard_id(shard_ids[entry.shard_id()]);
+  }
+  num_data_shards_ = num_data_shards;
+  return OkStatus();
+}
+
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   if (!status_.ok()) return status_;
   CHECK_NE(key, kHeaderEntryKey);
@@ -459,28 +615,15 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
+  if (!data_shards_.empty()) {
+    AddToDataShard(val, entry);
+    return status_;
+  }
   entry->set_shard_id(0);
-  entry->set_offset(size_);
 
   // Updates the data file.
-  size_t data_bytes_written = 0;
-  uint32 crc32c = 0;
-  out_->clear_crc32c();
-  if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32c();
-  }
-
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
-  }
+  status_ = AppendTensor(val, out_.get(), options_.data_alignment, &size_,
+                         entry);
   return status_;
 }
 
@@ -540,6 +683,7 @@ Status BundleWriter::Finish() {
       Env::Default()->DeleteFile(data_path_).IgnoreError();
     }
   }
+  if (!data_shards_.empty()) status_.Update(FinishDataShards());
   if (!status_.ok()) return status_;
   // Build key -> BundleEntryProto table.
   std::unique_ptr<WritableFile> file;
@@ -553,7 +697,7 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(num_data_shards_);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -790,9 +934,27 @@ BundleReader::BundleReader(
   Status s =
       ReadInt64FromEnvVar("TF_TABLE_INDEX_CACHE_SIZE_IN_MB", 0, &cache_size);
   if (s.ok() && cache_size > 0) {
-    index_cache_ = table::NewLRUCache(cache_size << 20);
+    // More shards reduce the contention between threads that look up
+    // tensors concurrently.
+    int64_t num_shard_bits;
+    s = ReadInt64FromEnvVar("TF_TABLE_INDEX_CACHE_NUM_SHARD_BITS", 4,
+                            &num_shard_bits);
+    if (s.ok() && num_shard_bits >= 0 &&
+        num_shard_bits <= table::kMaxNumShardBits) {
+      index_cache_ = table::NewLRUCache(cache_size << 20, num_shard_bits);
+    } else {
+      index_cache_ = table::NewLRUCache(cache_size << 20);
+    }
     o.block_cache = index_cache_;
   }
+  // Sequential scans of the index, e.g. over the slices of a partitioned
+  // variable, read it in large chunks instead of one block at a time.
+  int64_t readahead_size;
+  s = ReadInt64FromEnvVar("TF_TABLE_INDEX_READAHEAD_SIZE_IN_KB", 1024,
+                          &readahead_size);
+  if (s.ok() && readahead_size > 0) {
+    o.readahead_size = readahead_size << 10;
+  }
 
   status_ = table::Table::Open(o, metadata_, file_size, &table_);
   if (!status_.ok()) return;
@@ -865,6 +1027,20 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return OkStatus();
 }
 
+Status BundleReader::GetDataFile(int32_t shard_id,
+                                 io::InputBuffer** buffered_file) {
+  io::InputBuffer*& data = data_[shard_id];
+  if (data == nullptr) {
+    std::unique_ptr<RandomAccessFile> file = nullptr;
+    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+        DataFilename(prefix_, shard_id, num_shards_), &file));
+    // The InputBuffer and RandomAccessFile objects are both released in dtor.
+    data = new io::InputBuffer(file.release(), kBufferSize);
+  }
+  *buffered_file = data;
+  return OkStatus();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
@@ -894,17 +1070,8 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
     }
   }
 
-  // Open the data file if it has not been opened.
-  io::InputBuffer* buffered_file = data_[entry.shard_id()];
-  if (buffered_file == nullptr) {
-    std::unique_ptr<RandomAccessFile> file = nullptr;
-    TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
-    buffered_file = new io::InputBuffer(file.release(), kBufferSize);
-    // The InputBuffer and RandomAccessFile objects are both released in dtor.
-    data_[entry.shard_id()] = buffered_file;
-  }
-  CHECK(buffered_file != nullptr);
+  io::InputBuffer* buffered_file;
+  TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
 
   TF_RETURN_IF_ERROR(buffered_file->Seek(entry.offset()));
   uint32 actual_crc32c = 0;
@@ -1020,6 +1187,193 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   }
 }
 
+Status BundleReader::ReadMemcpyableValue(StringPiece key,
+                                         const BundleEntryProto& entry,
+                                         RandomAccessFile* file,
+                                         Tensor* val) const {
+  Tensor allocated;
+  Tensor* ret = val;
+  if (val->NumElements() == 0) {
+    allocated = Tensor(entry.dtype(), TensorShape(entry.shape()));
+    ret = &allocated;
+  }
+  if (entry.size() != ret->TotalBytes()) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(),
+                            "; expected size ", ret->TotalBytes());
+  }
+
+  char* backing_buffer = const_cast<char*>(ret->tensor_data().data());
+  StringPiece sp;
+  TF_RETURN_IF_ERROR(
+      file->Read(entry.offset(), entry.size(), &sp, backing_buffer));
+  if (sp.size() != entry.size()) {
+    return errors::DataLoss("Requested ", entry.size(), " bytes but read ",
+                            sp.size(), " bytes for key ", key);
+  }
+  if (sp.data() != backing_buffer) {
+    memmove(backing_buffer, sp.data(), entry.size());
+  }
+  // The checksum is on the bytes in the order they appear in the file.
+  const uint32 actual_crc32c = crc32c::Value(backing_buffer, entry.size());
+  if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+    return errors::DataLoss(
+        "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+        entry.size(), " bytes): Checksum does not match: stored ",
+        strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+        " vs. calculated on the restored bytes ", actual_crc32c);
+  }
+  if (need_to_swap_bytes_) {
+    TF_RETURN_IF_ERROR(ByteSwapTensor(ret));
+  }
+  if (ret != val) *val = *ret;
+  return OkStatus();
+}
+
+Status BundleReader::LookupTensors(gtl::ArraySlice<string> keys,
+                                   gtl::ArraySlice<Tensor*> vals) {
+  if (keys.size() != vals.size()) {
+    return errors::InvalidArgument("Got ", keys.size(), " keys but ",
+                                   vals.size(), " tensors");
+  }
+  struct TensorRead {
+    size_t index;
+    BundleEntryProto entry;
+    RandomAccessFile* file = nullptr;
+    Status status;
+  };
+  std::vector<TensorRead> reads(keys.size());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    CHECK(vals[i] != nullptr);
+    reads[i].index = i;
+    TF_RETURN_IF_ERROR(GetBundleEntryProto(keys[i], &reads[i].entry));
+  }
+  std::sort(reads.begin(), reads.end(),
+            [](const TensorRead& a, const TensorRead& b) {
+              if (a.entry.shard_id() != b.entry.shard_id()) {
+                return a.entry.shard_id() < b.entry.shard_id();
+              }
+              return a.entry.offset() < b.entry.offset();
+            });
+
+  // Tensors larger than the read buffer gain nothing from buffering, so they
+  // are read with one read each, concurrently. Tensors at or above
+  // kLargeTensorThreshold are split across threads by GetValue() instead.
+  std::vector<TensorRead*> concurrent_reads;
+  for (TensorRead& read : reads) {
+    const BundleEntryProto& entry = read.entry;
+    if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+        entry.size() <= kBufferSize || entry.size() >= kLargeTensorThreshold ||
+        enable_multi_threading_for_testing_) {
+      continue;
+    }
+    io::InputBuffer* buffered_file;
+    TF_RETURN_IF_ERROR(GetDataFile(entry.shard_id(), &buffered_file));
+    read.file = buffered_file->file();
+    concurrent_reads.push_back(&read);
+  }
+
+  {
+    std::unique_ptr<thread::ThreadPool> reader_pool;
+    if (!concurrent_reads.empty()) {
+      reader_pool = std::make_unique<thread::ThreadPool>(
+          env_, "lookup_tensors",
+          std::min<int>(kMaxFileReadThreads, concurrent_reads.size()));
+      for (TensorRead* read : concurrent_reads) {
+        reader_pool->Schedule([this, read, &keys, &vals]() {
+          read->status = ReadMemcpyableValue(keys[read->index], read->entry,
+                                             read->file, vals[read->index]);
+        });
+      }
+    }
+    // Reads the other tensors while the concurrent reads are in flight.
+    for (TensorRead& read : reads) {
+      if (read.file != nullptr) continue;
+      if (read.entry.slices().empty()) {
+        read.status = GetValue(read.entry, vals[read.index]);
+      } else {
+        read.status = GetSliceValue(
+            keys[read.index], read.entry,
+            /* a full slice */
+            TensorSlice(TensorShape(read.entry.shape()).dims()),
+            vals[read.index]);
+      }
+      if (!read.status.ok()) break;
+    }
+  }
+  // The reader pool has been joined, so all the reads are done.
+  for (const TensorRead& read : reads) {
+    TF_RETURN_IF_ERROR(read.status);
+  }
+  return OkStatus();
+}
+
+Status BundleReader::LookupMemmapped(StringPiece key, bool verify_checksum,
+                                     Tensor* val) {
+  CHECK(val != nullptr);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  const TensorShape shape(entry.shape());
+  const auto lookup_copy = [&]() {
+    *val = Tensor(entry.dtype(), shape);
+    return Lookup(key, val);
+  };
+  if (!entry.slices().empty() || !DataTypeCanUseMemcpy(entry.dtype()) ||
+      need_to_swap_bytes_ || entry.size() == 0) {
+    return lookup_copy();
+  }
+
+  auto region_it = memmapped_data_.find(entry.shard_id());
+  if (region_it == memmapped_data_.end()) {
+    const string filename =
+        DataFilename(prefix_, entry.shard_id(), num_shards_);
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    Status status = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+    if (!status.ok()) {
+      VLOG(1) << "Reading copies of the tensors of " << filename
+              << ", which cannot be memory-mapped: " << status;
+    }
+    region_it =
+        memmapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  if (region_it->second == nullptr) return lookup_copy();
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = region_it->second;
+
+  const int64_t expected_size =
+      shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != expected_size) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key,
+                            "; stored size ", entry.size(),
+                            "; expected size ", expected_size);
+  }
+  if (entry.offset() < 0 ||
+      static_cast<uint64>(entry.offset() + entry.size()) > region->length()) {
+    return errors::DataLoss("Bundle entry of key ", key, " at offset ",
+                            entry.offset(), " (", entry.size(),
+                            " bytes) is past the end of its data file of ",
+                            region->length(), " bytes");
+  }
+  auto* buffer =
+      new MemmappedTensorBuffer(region, entry.offset(), entry.size());
+  Tensor aliased(entry.dtype(), shape, buffer);
+  buffer->Unref();
+  if (!aliased.IsAligned()) return lookup_copy();
+
+  if (verify_checksum) {
+    const uint32 actual_crc32c = crc32c::Value(
+        static_cast<const char*>(buffer->data()), entry.size());
+    if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+      return errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+          entry.size(), " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+          " vs. calculated on the restored bytes ", actual_crc32c);
+    }
+  }
+  *val = std::move(aliased);
+  return OkStatus();
+}
+
 Status BundleReader::ReadCurrent(Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
@@ -62,8 +62,10 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
@@ -116,12 +118,23 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Number of data files the tensors are spread across.  With more than one,
+    // each data file is written by its own thread: Add() only queues the
+    // tensor, whose checksum, buffering and I/O overlap with the next Add()
+    // calls and with the writes to the other data files.  Data files that
+    // receive no tensor are dropped by Finish(), so the bundle may have fewer
+    // shards.  Must be >= 1.
+    int num_shards{1};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
+  ~BundleWriter();
 
   // Adds the tensor "val" under key "key".
   // Across calls "key" must be unique but can be added in any order.
+  //
+  // With several shards, "val" is written after Add() returns, so its buffer
+  // must not be modified until Finish(), which also reports the write errors.
   Status Add(StringPiece key, const Tensor& val);
 
   // Partitioned variables support.
@@ -150,6 +163,17 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  // A data file of a writer with several shards.
+  struct DataShard;
+
+  // Opens the data files of a writer with several shards.
+  Status OpenDataShards();
+  // Queues the write of "val", described by "entry", to the least loaded shard.
+  void AddToDataShard(const Tensor& val, BundleEntryProto* entry);
+  // Waits for the writes to the data files, then gives them their final names
+  // and sets "num_data_shards_".
+  Status FinishDataShards();
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
@@ -158,6 +182,9 @@ class BundleWriter {
   bool use_temp_file_;
   std::unique_ptr<FileOutputBuffer> out_;
   int64_t size_;  // Number of bytes written into out_.
+  // Only used with more than one shard, instead of out_.
+  std::vector<std::unique_ptr<DataShard>> data_shards_;
+  int num_data_shards_ = 1;  // Recorded in the header.
   std::map<string, BundleEntryProto> entries_;
   Status status_;
 
@@ -246,6 +273,34 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Looks up the tensors keyed by "keys" into the corresponding "vals", as
+  // Lookup() does for each of them.  The tensors are read in file order, and
+  // tensors larger than the read buffer are read concurrently, across all
+  // data shards, while the smaller ones are read on the calling thread.
+  //
+  // Much faster than calling Lookup() for each key when restoring many large
+  // tensors, e.g. all the variables of a model.
+  // REQUIRES: status().ok() && keys.size() == vals.size()
+  Status LookupTensors(gtl::ArraySlice<string> keys,
+                       gtl::ArraySlice<Tensor*> vals) TF_MUST_USE_RESULT;
+
+  // Looks up the tensor keyed by "key" as a read-only tensor aliasing the
+  // memory-mapped data file, without copying it.  Processes restoring the same
+  // bundle share the physical pages of its tensors.  Writing to "val", e.g. by
+  // updating a variable restored from it in place, crashes, so this is only
+  // suitable for tensors that are never modified, as when serving a model.
+  //
+  // Falls back to reading a copy, as Lookup() does, for tensors that cannot
+  // be aliased: partitioned tensors, dtypes that cannot be memcpy-ed, data
+  // that is misaligned for Eigen (see BundleWriter::Options::data_alignment)
+  // or of the wrong endianness, and data files that cannot be memory-mapped.
+  //
+  // Validates the stored crc32c checksum only if "verify_checksum", which
+  // reads all the pages of the tensor.
+  // REQUIRES: status().ok()
+  Status LookupMemmapped(StringPiece key, bool verify_checksum,
+                         Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -302,6 +357,17 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Opens the data file of shard "shard_id" if it has not been opened yet.
+  Status GetDataFile(int32_t shard_id,
+                     io::InputBuffer** buffered_file) TF_MUST_USE_RESULT;
+
+  // Reads the value of the tensor keyed by "key", whose dtype can be
+  // memcpy-ed, with a single read of "file".  Usage for "val" follows the
+  // comment of "Lookup()".  Thread-safe, as it doesn't use the read buffers.
+  Status ReadMemcpyableValue(StringPiece key, const BundleEntryProto& entry,
+                             RandomAccessFile* file,
+                             Tensor* val) const TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -321,6 +387,11 @@ class BundleReader {
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
 
+  // Memory-mapped data files, by shard id, shared with the tensors aliasing
+  // them.  Null for the data files that cannot be memory-mapped.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>>
+      memmapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -951,6 +951,173 @@ TEST(TensorBundleTest, SortForSequentialAccess) {
                           "tensor-1-2", "tensor-1-1", "tensor-1-0"));
 }
 
+TEST(TensorBundleTest, LookupTensors) {
+  Env* env = Env::Default();
+  const std::vector<string> kBundlePrefixes = {Prefix("lookup0"),
+                                               Prefix("lookup1")};
+  // Tensors larger than the 1MB read buffer, which are read concurrently, and
+  // smaller tensors of several dtypes, which are read on the calling thread.
+  const TensorShape kLargeShape({1 << 19});
+  BundleWriter writer0(env, kBundlePrefixes[0]);
+  TF_EXPECT_OK(writer0.Add("large0", Constant(1.5f, kLargeShape)));
+  TF_EXPECT_OK(writer0.Add("small0", Constant_2x3<int32>(7)));
+  TF_EXPECT_OK(writer0.Add("string0", Constant_2x3<tstring>("hello")));
+  TF_ASSERT_OK(writer0.Finish());
+  BundleWriter writer1(env, kBundlePrefixes[1]);
+  TF_EXPECT_OK(writer1.Add("large1", Constant(2.5, kLargeShape)));
+  TF_EXPECT_OK(writer1.Add("small1", Constant_2x3<float>(3.f)));
+  TF_ASSERT_OK(writer1.Finish());
+  const string kMerged = Prefix("lookup_merged");
+  TF_ASSERT_OK(MergeBundles(env, kBundlePrefixes, kMerged));
+
+  BundleReader reader(env, kMerged);
+  TF_ASSERT_OK(reader.status());
+  const std::vector<string> keys = {"small1", "large1", "string0", "large0",
+                                    "small0"};
+  // Preallocated outputs are filled in place, empty ones are allocated.
+  Tensor large1(DT_DOUBLE, kLargeShape);
+  std::vector<Tensor> vals = {Tensor(), large1, Tensor(), Tensor(),
+                              Tensor(DT_INT32, TensorShape({2, 3}))};
+  std::vector<Tensor*> val_ptrs;
+  for (Tensor& val : vals) val_ptrs.push_back(&val);
+  TF_ASSERT_OK(reader.LookupTensors(keys, val_ptrs));
+
+  test::ExpectTensorEqual<float>(vals[0], Constant_2x3<float>(3.f));
+  test::ExpectTensorEqual<double>(vals[1], Constant(2.5, kLargeShape));
+  EXPECT_EQ(vals[1].tensor_data().data(), large1.tensor_data().data());
+  test::ExpectTensorEqual<tstring>(vals[2], Constant_2x3<tstring>("hello"));
+  test::ExpectTensorEqual<float>(vals[3], Constant(1.5f, kLargeShape));
+  test::ExpectTensorEqual<int32>(vals[4], Constant_2x3<int32>(7));
+
+  Tensor missing;
+  Tensor* missing_ptr = &missing;
+  EXPECT_EQ(reader.LookupTensors({"missing"}, {missing_ptr}).code(),
+            error::NOT_FOUND);
+}
+
+TEST(TensorBundleTest, LookupMemmapped) {
+  BundleWriter::Options opts;
+  opts.data_alignment = 64;
+  {
+    BundleWriter writer(Env::Default(), Prefix("memmapped"), opts);
+    TF_EXPECT_OK(writer.Add("floats", Constant_100x100<float>(1.5f)));
+    TF_EXPECT_OK(writer.Add("strings", Constant_2x3<tstring>("hello")));
+    TF_EXPECT_OK(writer.Add("ints", Constant_2x3<int32>(7)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("memmapped"));
+  TF_ASSERT_OK(reader.status());
+
+  Tensor floats, floats_again;
+  TF_ASSERT_OK(reader.LookupMemmapped("floats", /*verify_checksum=*/true,
+                                      &floats));
+  TF_ASSERT_OK(reader.LookupMemmapped("floats", /*verify_checksum=*/false,
+                                      &floats_again));
+  test::ExpectTensorEqual<float>(floats, Constant_100x100<float>(1.5f));
+  // Both tensors alias the same memory-mapped data.
+  EXPECT_EQ(floats.tensor_data().data(), floats_again.tensor_data().data());
+
+  // Strings cannot be aliased, and are read as copies.
+  Tensor strings;
+  TF_ASSERT_OK(reader.LookupMemmapped("strings", /*verify_checksum=*/true,
+                                      &strings));
+  test::ExpectTensorEqual<tstring>(strings, Constant_2x3<tstring>("hello"));
+
+  Tensor ints;
+  TF_ASSERT_OK(
+      reader.LookupMemmapped("ints", /*verify_checksum=*/true, &ints));
+  test::ExpectTensorEqual<int32>(ints, Constant_2x3<int32>(7));
+}
+
+TEST(TensorBundleTest, LookupMemmappedUnaligned) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("memmapped_unaligned"));
+    TF_EXPECT_OK(writer.Add("byte", Constant(static_cast<int8>(1),
+                                             TensorShape({1}))));
+    TF_EXPECT_OK(writer.Add("floats", Constant_2x3<float>(2.5f)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("memmapped_unaligned"));
+  TF_ASSERT_OK(reader.status());
+  // "floats" is misaligned for Eigen, so a copy is read instead.
+  Tensor floats;
+  TF_ASSERT_OK(reader.LookupMemmapped("floats", /*verify_checksum=*/true,
+                                      &floats));
+  EXPECT_TRUE(floats.IsAligned());
+  test::ExpectTensorEqual<float>(floats, Constant_2x3<float>(2.5f));
+}
+
+TEST(TensorBundleTest, ShardedWriter) {
+  Env* env = Env::Default();
+  BundleWriter::Options opts;
+  opts.num_shards = 4;
+  opts.data_alignment = 8;
+  {
+    BundleWriter writer(env, Prefix("sharded"), opts);
+    TF_EXPECT_OK(writer.Add("large", Constant(1.5f, TensorShape({1 << 16}))));
+    TF_EXPECT_OK(writer.Add("floats", Constant_100x100<float>(2.5f)));
+    TF_EXPECT_OK(writer.Add("strings", Constant_2x3<tstring>("hello")));
+    TF_EXPECT_OK(writer.Add("empty", Constant(1, TensorShape({0}))));
+    TF_EXPECT_OK(writer.AddSlice("sliced", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("0,2"),
+                                 Constant(3.0, TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Each shard received a tensor.
+  for (int i = 0; i < 4; ++i) {
+    TF_EXPECT_OK(env->FileExists(DataFilename(Prefix("sharded"), i, 4)));
+  }
+  {
+    // Shards without tensors are dropped.
+    BundleWriter writer(env, Prefix("sharded_small"), opts);
+    TF_EXPECT_OK(writer.Add("ints", Constant_2x3<int32>(7)));
+    TF_EXPECT_OK(writer.Add("doubles", Constant_2x3<double>(1.0)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  const string kSmallPrefix = Prefix("sharded_small");
+  TF_EXPECT_OK(env->FileExists(DataFilename(kSmallPrefix, 0, 2)));
+  TF_EXPECT_OK(env->FileExists(DataFilename(kSmallPrefix, 1, 2)));
+  EXPECT_FALSE(env->FileExists(DataFilename(kSmallPrefix, 0, 4)).ok());
+
+  // Sharded bundles merge like any other.
+  const string kMerged = Prefix("sharded_merged");
+  TF_ASSERT_OK(MergeBundles(env, {Prefix("sharded"), Prefix("sharded_small")},
+                            kMerged));
+  BundleReader reader(env, kMerged);
+  TF_ASSERT_OK(reader.status());
+  Tensor val;
+  TF_ASSERT_OK(reader.Lookup("large", &val));
+  test::ExpectTensorEqual<float>(val, Constant(1.5f, TensorShape({1 << 16})));
+  TF_ASSERT_OK(reader.Lookup("floats", &val));
+  test::ExpectTensorEqual<float>(val, Constant_100x100<float>(2.5f));
+  TF_ASSERT_OK(reader.Lookup("strings", &val));
+  test::ExpectTensorEqual<tstring>(val, Constant_2x3<tstring>("hello"));
+  TF_ASSERT_OK(reader.Lookup("empty", &val));
+  EXPECT_EQ(val.NumElements(), 0);
+  TF_ASSERT_OK(reader.Lookup("ints", &val));
+  test::ExpectTensorEqual<int32>(val, Constant_2x3<int32>(7));
+  TF_ASSERT_OK(reader.Lookup("doubles", &val));
+  test::ExpectTensorEqual<double>(val, Constant_2x3<double>(1.0));
+  Tensor slice(DT_DOUBLE, TensorShape({2}));
+  TF_ASSERT_OK(reader.LookupSlice("sliced", TensorSlice::ParseOrDie("0,2"),
+                                  &slice));
+  test::ExpectTensorEqual<double>(slice, Constant(3.0, TensorShape({2})));
+}
+
+TEST(TensorBundleTest, ShardedWriterEmpty) {
+  BundleWriter::Options opts;
+  opts.num_shards = 3;
+  {
+    BundleWriter writer(Env::Default(), Prefix("sharded_empty"), opts);
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Like a writer with a single shard, an empty bundle has one data file.
+  TF_EXPECT_OK(Env::Default()->FileExists(
+      DataFilename(Prefix("sharded_empty"), 0, 1)));
+  BundleReader reader(Env::Default(), Prefix("sharded_empty"));
+  TF_EXPECT_OK(reader.status());
+}
+
 TEST(TensorBundleTest, Error) {
   {  // Dup keys.
     BundleWriter writer(Env::Default(), Prefix("dup"));
@@ -1220,6 +1387,33 @@ static void BM_BundleAlignment(::testing::benchmark::State& state) {
   }
 }
 
+static void BM_BundleLookupTensors(::testing::benchmark::State& state) {
+  const int num_tensors = state.range(0);
+  const int64_t tensor_bytes = state.range(1);
+  std::vector<string> keys;
+  {
+    BundleWriter writer(Env::Default(), Prefix("lookup_tensors"));
+    for (int i = 0; i < num_tensors; ++i) {
+      keys.push_back(strings::StrCat("tensor", i));
+      TF_CHECK_OK(writer.Add(keys.back(), Constant(static_cast<int8>(i),
+                                                   TensorShape{tensor_bytes})));
+    }
+    TF_CHECK_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("lookup_tensors"));
+  TF_CHECK_OK(reader.status());
+  std::vector<Tensor> vals(num_tensors);
+  std::vector<Tensor*> val_ptrs;
+  for (Tensor& val : vals) val_ptrs.push_back(&val);
+  for (auto s : state) {
+    TF_CHECK_OK(reader.LookupTensors(keys, val_ptrs));
+  }
+  state.SetBytesProcessed(state.iterations() * num_tensors * tensor_bytes);
+}
+
+BENCHMARK(BM_BundleLookupTensors)->ArgPair(1000, 1 << 10);
+BENCHMARK(BM_BundleLookupTensors)->ArgPair(64, 16 << 20);
+
 BENCHMARK(BM_BundleAlignment)->ArgPair(1, 512);
 BENCHMARK(BM_BundleAlignment)->ArgPair(1, 4096);
 BENCHMARK(BM_BundleAlignment)->ArgPair(1, 1048576);
@@ -1252,4 +1446,23 @@ static void BM_BundleWriterLargeTensor(::testing::benchmark::State& state) {
 BENCHMARK(BM_BundleWriterLargeTensor)->Arg(1 << 10);
 BENCHMARK(BM_BundleWriterLargeTensor)->Arg(4 << 10);
 
+static void BM_BundleWriterSharded(::testing::benchmark::State& state) {
+  const int num_shards = state.range(0);
+  const int num_tensors = 64;
+  const int64_t tensor_bytes = 16 << 20;
+  Tensor t = Constant(static_cast<int8>('a'), TensorShape{tensor_bytes});
+  BundleWriter::Options opts;
+  opts.num_shards = num_shards;
+  for (auto s : state) {
+    BundleWriter writer(Env::Default(), Prefix("sharded_writer"), opts);
+    for (int i = 0; i < num_tensors; ++i) {
+      TF_CHECK_OK(writer.Add(strings::StrCat("tensor", i), t));
+    }
+    TF_CHECK_OK(writer.Finish());
+  }
+  state.SetBytesProcessed(state.iterations() * num_tensors * tensor_bytes);
+}
+
+BENCHMARK(BM_BundleWriterSharded)->Arg(1)->Arg(4)->Arg(8);
+
 }  // namespace tensorflow
@@ -84,6 +84,13 @@ bool DoNotFuseReduceScatter() {
   return true;
 }
 
+bool EnableCollectiveScheduling() {
+  char* dtensor_enable_collective_scheduling_str =
+      std::getenv("DTENSOR_ENABLE_COLLECTIVE_SCHEDULING");
+  if (dtensor_enable_collective_scheduling_str == nullptr) return false;
+  return true;
+}
+
 int ReduceInBfloat16MaxGroupSize() {
   char* dtensor_reduce_in_bfloat16_max_group_size_str =
       std::getenv("DTENSOR_REDUCE_IN_BFLOAT16_MAX_GROUP_SIZE");
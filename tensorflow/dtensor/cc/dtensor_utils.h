@@ -46,6 +46,10 @@ bool EnableMixedPrecisionReduce();
 // which can be more efficiently implemented.
 bool DoNotFuseReduceScatter();
 
+// Returns whether to move collectives as early as their operands allow, so
+// that they overlap with independent compute.
+bool EnableCollectiveScheduling();
+
 // Returns the maximum reduction group size for bfloat16 reduction. If the
 // group size exceeds this, then tensors are upcasted to float32 before the
 // reduce op.
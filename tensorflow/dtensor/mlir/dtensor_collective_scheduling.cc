@@ -0,0 +1,114 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "llvm/ADT/SmallVector.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"  // from @llvm-project
+#include "mlir/IR/Block.h"  // from @llvm-project
+#include "mlir/IR/Operation.h"  // from @llvm-project
+#include "mlir/IR/OpDefinition.h"  // from @llvm-project
+#include "mlir/IR/Visitors.h"  // from @llvm-project
+#include "mlir/Pass/Pass.h"  // from @llvm-project
+#include "tensorflow/compiler/mlir/tensorflow/ir/tf_device.h"
+#include "tensorflow/compiler/mlir/tensorflow/ir/tf_ops.h"
+#include "tensorflow/dtensor/mlir/dtensor_mlir_passes.h"
+#include "tensorflow/dtensor/mlir/ir/tf_dtensor.h"
+
+namespace tensorflow {
+namespace dtensor {
+
+namespace {
+#define GEN_PASS_DEF_DTENSORCOLLECTIVESCHEDULING
+#include "tensorflow/dtensor/mlir/dtensor_passes.h.inc"
+
+bool IsScheduledCollective(mlir::Operation* op) {
+  return llvm::isa<mlir::TF::DTensorAllReduceOp,
+                   mlir::TF::DTensorReduceScatterOp,
+                   mlir::TF::DTensorAllGatherOp>(op);
+}
+
+// Moves `collective` up to just after the last op of its block that defines
+// one of its operands. Constant operands that only `collective` uses, such as
+// its group assignment, move along with it.
+void HoistCollective(mlir::Operation* collective) {
+  mlir::Block* block = collective->getBlock();
+  mlir::Operation* last_def = nullptr;
+  llvm::SmallVector<mlir::Operation*, 2> constants;
+  for (mlir::Value operand : collective->getOperands()) {
+    mlir::Operation* def = operand.getDefiningOp();
+    if (def == nullptr || def->getBlock() != block) continue;
+    if (def->hasTrait<mlir::OpTrait::ConstantLike>() && def->hasOneUse()) {
+      constants.push_back(def);
+      continue;
+    }
+    if (last_def == nullptr || last_def->isBeforeInBlock(def)) last_def = def;
+  }
+  if (last_def != nullptr) {
+    collective->moveAfter(last_def);
+  } else if (&block->front() != collective) {
+    collective->moveBefore(&block->front());
+  }
+  for (mlir::Operation* constant : constants) constant->moveBefore(collective);
+}
+
+// Issues every DTensor collective as early as its operands allow, so that
+// collectives whose inputs are ready early do not wait behind ones that
+// depend on long computations, and so that independent compute placed
+// after them in program order can overlap with them.
+//
+// For example, this program:
+//
+// clang-format off
+// NOLINTBEGIN(whitespace/line_length)
+// %0 = "tf.MatMul"(%arg0, %arg1) : (tensor<128x128xf32>, tensor<128x128xf32>) -> tensor<128x128xf32>
+// %1 = "tf.Const"() {value = dense<[[0, 1]]> : tensor<1x2xi32>} : () -> tensor<1x2xi32>
+// %2 = "tf.DTensorAllReduce"(%0, %1) {reduce_op = "Add"} : (tensor<128x128xf32>, tensor<1x2xi32>) -> tensor<128x128xf32>
+// %3 = "tf.Const"() {value = dense<[[0, 1]]> : tensor<1x2xi32>} : () -> tensor<1x2xi32>
+// %4 = "tf.DTensorAllReduce"(%arg2, %3) {reduce_op = "Add"} : (tensor<4xf32>, tensor<1x2xi32>) -> tensor<4xf32>
+// NOLINTEND
+// clang-format on
+//
+// issues the second all-reduce before the MatMul, on which it does not
+// depend.
+struct DTensorCollectiveScheduling
+    : public impl::DTensorCollectiveSchedulingBase<
+          DTensorCollectiveScheduling> {
+  void runOnOperation() override {
+    mlir::func::FuncOp function = getOperation();
+    function.walk([&](mlir::tf_device::ClusterOp cluster) {
+      std::vector<mlir::Operation*> collectives;
+      cluster.GetBody().walk([&](mlir::Operation* op) {
+        if (IsScheduledCollective(op)) collectives.push_back(op);
+      });
+      // Hoisting in program order lets a collective that consumes the
+      // result of another one follow it up.
+      for (mlir::Operation* collective : collectives) {
+        HoistCollective(collective);
+      }
+    });
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<mlir::OperationPass<mlir::func::FuncOp>>
+CreateDTensorCollectiveScheduling() {
+  return std::make_unique<DTensorCollectiveScheduling>();
+}
+
+}  // namespace dtensor
+}  // namespace tensorflow
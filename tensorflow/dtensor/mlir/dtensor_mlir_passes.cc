@@ -183,6 +183,12 @@ void CreateDTensorMLIRPass(const mlir::TF::StandardPipelineOptions &options,
   // const only had one usage) as part of layout propagation.
   pm->addPass(mlir::createCSEPass());
 
+  // Issue relayout AllGathers as early as possible, before lowering turns
+  // them into side-effecting collectives that keep their program order.
+  if (EnableCollectiveScheduling()) {
+    pm->addNestedPass<mlir::func::FuncOp>(CreateDTensorCollectiveScheduling());
+  }
+
   // Lower the AllGather collectives. This has to happen before the all reduce
   // optimizations and AllGather may emit an AllReduce.
   pm->addPass(CreateDTensorAllGatherLoweringPass());
@@ -200,6 +206,12 @@ void CreateDTensorMLIRPass(const mlir::TF::StandardPipelineOptions &options,
 
   AddDTensorAllReduceCombineOptimization(pm);
 
+  // Combining places each combined AllReduce at its last member, so schedule
+  // the reductions again afterwards.
+  if (EnableCollectiveScheduling()) {
+    pm->addNestedPass<mlir::func::FuncOp>(CreateDTensorCollectiveScheduling());
+  }
+
   // DTensorReduceScatter lowering should come before DTensorAllReduce
   // and DTensorAllScatter lowerings since for some devices DTensorReduceScatter
   // will be decomposed into an DTensorAllReduce+DTensorScatter.
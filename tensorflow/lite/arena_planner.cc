@@ -270,9 +270,42 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   }
   // Note that graph outputs will never be scheduled for deallocation. We
   // could do that here for completeness, but it won't have any effect.
+  ExtendLifetimesToStages();
+  plan_cache_.clear();
   return kTfLiteOk;
 }
 
+void ArenaPlanner::SetConcurrentStages(std::vector<int> stage_first_node,
+                                       std::vector<int> stage_last_node) {
+  stage_first_node_ = std::move(stage_first_node);
+  stage_last_node_ = std::move(stage_last_node);
+}
+
+void ArenaPlanner::ExtendLifetimesToStages() {
+  if (stage_first_node_.empty()) return;
+  for (int i = 0; i < static_cast<int>(alloc_node_.size()); ++i) {
+    const int alloc_node = alloc_node_[i];
+    if (alloc_node == kNodeNotAssigned ||
+        alloc_node >= static_cast<int>(stage_first_node_.size())) {
+      continue;
+    }
+    // A tensor produced by a stage must not overlap with the tensors freed by
+    // the nodes running alongside its producer.
+    if (stage_first_node_[alloc_node] != alloc_node) {
+      nodes_to_tensors_[alloc_node].erase(i);
+      alloc_node_[i] = stage_first_node_[alloc_node];
+      nodes_to_tensors_[alloc_node_[i]].insert(i);
+    }
+    // Likewise a tensor can only be reused once all readers of its stage are
+    // done.
+    const int dealloc_node = dealloc_node_[i];
+    if (dealloc_node != kNodeNotAssigned &&
+        dealloc_node < static_cast<int>(stage_last_node_.size())) {
+      dealloc_node_[i] = stage_last_node_[dealloc_node];
+    }
+  }
+}
+
 TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   // Grow the size of `allocs_` if necessary. This allows allocating temporary
   // tensors in op's `prepare` function.
@@ -281,30 +314,65 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   alloc_node_.resize(num_tensors, kNodeNotAssigned);
   dealloc_node_.resize(num_tensors, kNodeNotAssigned);
   allocs_.resize(num_tensors);
+  // Tensors of a stage are all allocated at its first node.
+  if (first_node >= 0 &&
+      first_node < static_cast<int>(stage_first_node_.size())) {
+    first_node = stage_first_node_[first_node];
+  }
   // Set allocation and deallocation for temporary tensors.
   for (size_t i = first_node; i <= static_cast<size_t>(last_node) &&
                               i < graph_info_->num_execution_nodes();
        ++i) {
     const TfLiteNode& node = graph_info_->node(i);
     TfLiteIntArray* node_temporaries = node.temporaries;
+    // Temporaries of concurrently running nodes live for their whole stage.
+    const int alloc_node = i < stage_first_node_.size()
+                               ? stage_first_node_[i]
+                               : static_cast<int>(i);
+    const int dealloc_node = i < stage_last_node_.size()
+                                 ? stage_last_node_[i]
+                                 : static_cast<int>(i);
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
-      nodes_to_tensors_[i].insert(tensor_index);
+      alloc_node_[tensor_index] = alloc_node;
+      nodes_to_tensors_[alloc_node].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = dealloc_node;
       }
     }
   }
 
+  // Only plans of the whole graph from scratch, as done by AllocateTensors(),
+  // are cached.
+  const bool use_plan_cache =
+      plan_cache_size_ > 0 && first_node == 0 &&
+      last_node >= static_cast<int>(graph_info_->num_execution_nodes()) - 1 &&
+      last_active_node_ == kLastActiveNodeUndefined;
+  std::vector<size_t> plan_cache_key;
+  bool plan_restored = false;
+  if (use_plan_cache) {
+    plan_cache_key = PlanCacheKey();
+    plan_restored = RestoreCachedPlan(plan_cache_key, last_node);
+  }
+
   std::vector<int32_t> tensors_allocated;
-  TF_LITE_ENSURE_STATUS(
-      CalculateAllocations(first_node, last_node, &tensors_allocated));
+  if (!plan_restored) {
+    TF_LITE_ENSURE_STATUS(
+        CalculateAllocations(first_node, last_node, &tensors_allocated));
+    if (use_plan_cache) {
+      if (static_cast<int>(plan_cache_.size()) >= plan_cache_size_) {
+        plan_cache_.erase(plan_cache_.begin());
+      }
+      plan_cache_.push_back({std::move(plan_cache_key), allocs_,
+                             arena_.high_water_mark(),
+                             persistent_arena_.high_water_mark()});
+    }
+  }
   bool arena_reallocated = false;
   TF_LITE_ENSURE_STATUS(Commit(&arena_reallocated));
 
   TfLiteTensor* tensors = graph_info_->tensors();
-  if (arena_reallocated) {
+  if (arena_reallocated || plan_restored) {
     for (int i = 0; i < static_cast<int>(num_tensors); ++i) {
       TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i, tensors));
     }
@@ -318,6 +386,47 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   return kTfLiteOk;
 }
 
+std::vector<size_t> ArenaPlanner::PlanCacheKey() const {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  const size_t num_tensors = graph_info_->num_tensors();
+  std::vector<size_t> key;
+  key.reserve(4 * num_tensors);
+  for (size_t i = 0; i < num_tensors; ++i) {
+    key.push_back(tensors[i].allocation_type);
+    key.push_back(tensors[i].bytes);
+    key.push_back(alloc_node_[i]);
+    key.push_back(dealloc_node_[i]);
+  }
+  return key;
+}
+
+bool ArenaPlanner::RestoreCachedPlan(const std::vector<size_t>& key,
+                                     int last_node) {
+  auto it = std::find_if(
+      plan_cache_.begin(), plan_cache_.end(),
+      [&key](const CachedPlan& plan) { return plan.key == key; });
+  if (it == plan_cache_.end()) return false;
+  allocs_ = it->allocs;
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  std::vector<ArenaAllocWithUsageInterval> arena_allocs;
+  std::vector<ArenaAllocWithUsageInterval> persistent_arena_allocs;
+  for (const ArenaAllocWithUsageInterval& alloc : allocs_) {
+    if (alloc.tensor < 0 || alloc.size == 0) continue;
+    if (tensors[alloc.tensor].allocation_type == kTfLiteArenaRw) {
+      arena_allocs.push_back(alloc);
+    } else if (tensors[alloc.tensor].allocation_type ==
+               kTfLiteArenaRwPersistent) {
+      persistent_arena_allocs.push_back(alloc);
+    }
+  }
+  arena_.RestorePlan(arena_allocs, it->arena_high_water_mark, last_node);
+  persistent_arena_.RestorePlan(persistent_arena_allocs,
+                                it->persistent_arena_high_water_mark,
+                                last_node);
+  last_active_node_ = last_node;
+  return true;
+}
+
 TfLiteStatus ArenaPlanner::ReleaseNonPersistentMemory() {
   // Clear non-persistent arena's buffer.
   TF_LITE_ENSURE_STATUS(arena_.ReleaseBuffer());
@@ -405,6 +514,71 @@ void ArenaPlanner::CreateTensorAllocationVector(
             tensor_compare);
 }
 
+void ArenaPlanner::ChooseTensorAllocationOrder(
+    std::vector<int32_t>* tensors_to_allocate) {
+  const TfLiteTensor* tensors = graph_info_->tensors();
+  const int32_t num_nodes =
+      static_cast<int32_t>(graph_info_->num_execution_nodes());
+  auto lifetime = [&](int idx) -> int64_t {
+    const int32_t last_node = dealloc_node_[idx] == kNodeNotAssigned
+                                  ? num_nodes
+                                  : dealloc_node_[idx];
+    return static_cast<int64_t>(last_node) - alloc_node_[idx] + 1;
+  };
+  auto lives_throughout = [&](int idx) {
+    return alloc_node_[idx] == 0 && dealloc_node_[idx] == kNodeNotAssigned;
+  };
+
+  // Candidate orders besides the default one, which is by decreasing size.
+  // Like the default order they keep the tensors living throughout the whole
+  // inference first.
+  std::vector<int32_t> by_area = *tensors_to_allocate;
+  std::stable_sort(by_area.begin(), by_area.end(), [&](int idx1, int idx2) {
+    if (lives_throughout(idx1) || lives_throughout(idx2)) {
+      return lives_throughout(idx1) && !lives_throughout(idx2);
+    }
+    return static_cast<int64_t>(tensors[idx1].bytes) * lifetime(idx1) >
+           static_cast<int64_t>(tensors[idx2].bytes) * lifetime(idx2);
+  });
+  std::vector<int32_t> by_lifetime = *tensors_to_allocate;
+  std::stable_sort(
+      by_lifetime.begin(), by_lifetime.end(), [&](int idx1, int idx2) {
+        if (lives_throughout(idx1) || lives_throughout(idx2)) {
+          return lives_throughout(idx1) && !lives_throughout(idx2);
+        }
+        return lifetime(idx1) > lifetime(idx2);
+      });
+
+  // Packs the kTfLiteArenaRw tensors which own their buffer in `order` into a
+  // scratch arena and returns the size it needs.
+  auto arena_size = [&](const std::vector<int32_t>& order) -> size_t {
+    SimpleMemoryArena scratch(kDefaultArenaAlignment);
+    ArenaAllocWithUsageInterval alloc;
+    for (int32_t tensor_index : order) {
+      if (tensors[tensor_index].allocation_type != kTfLiteArenaRw ||
+          actual_tensor_id_.count(tensor_index) != 0) {
+        continue;
+      }
+      if (scratch.Allocate(context_, tensor_alignment_,
+                           tensors[tensor_index].bytes, tensor_index,
+                           alloc_node_[tensor_index],
+                           dealloc_node_[tensor_index], &alloc) != kTfLiteOk) {
+        return std::numeric_limits<size_t>::max();
+      }
+    }
+    return scratch.RequiredBufferSize();
+  };
+
+  size_t best_size = arena_size(*tensors_to_allocate);
+  for (std::vector<int32_t>* order : {&by_area, &by_lifetime}) {
+    const size_t size = arena_size(*order);
+    if (size < best_size) {
+      best_size = size;
+      tensors_to_allocate->swap(*order);
+    }
+  }
+}
+
 std::vector<int32_t> ArenaPlanner::GetTensorsToAllocate(int first_node,
                                                         int last_node) {
   int num_tensors = static_cast<int>(graph_info_->num_tensors());
@@ -443,15 +617,20 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
+  bool arena_reset = false;
   if (first_node < last_active_node_) {
     arena_.ResetAllocs();
     last_active_node_ = first_node;
+    arena_reset = true;
   } else {
     // NOMUTANTS -- This function has no impact on the results, it only makes
     // exection faster.
     arena_.PurgeActiveAllocs(first_node);
   }
   CreateTensorAllocationVector(tensors_allocated);
+  if (optimize_packing_ && arena_reset && !preserve_all_tensors_) {
+    ChooseTensorAllocationOrder(tensors_allocated);
+  }
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
     TfLiteTensor& tensor = tensors[tensor_index];
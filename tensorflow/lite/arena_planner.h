@@ -62,6 +62,8 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus ResetAllocationsAfter(int node) override;
   TfLiteStatus PlanAllocations() override;
   TfLiteStatus ExecuteAllocations(int first_node, int last_node) override;
+  void SetConcurrentStages(std::vector<int> stage_first_node,
+                           std::vector<int> stage_last_node) override;
   TfLiteStatus ReleaseNonPersistentMemory() override;
   TfLiteStatus AcquireNonPersistentMemory() override;
   bool HasNonPersistentMemory() override;
@@ -72,6 +74,22 @@ class ArenaPlanner : public MemoryPlanner {
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
 
+  // If true, whenever the whole arena is planned again the tensors are placed
+  // in several orders, as XLA's heap simulator does, and the order needing the
+  // smallest arena is kept. This trades planning time for a smaller arena.
+  void SetOptimizePacking(bool optimize_packing) {
+    optimize_packing_ = optimize_packing;
+  }
+
+  // Keeps the plans of the last `size` full plannings of the arena, keyed by
+  // the sizes and lifetimes of all tensors, so that switching back and forth
+  // between input shapes doesn't compute the same plan again. 0 disables the
+  // cache.
+  void SetPlanCacheSize(int size) {
+    plan_cache_size_ = size;
+    plan_cache_.clear();
+  }
+
  private:
   // Identify tensors which may share memory.
   void IdentifySharedTensors();
@@ -87,6 +105,12 @@ class ArenaPlanner : public MemoryPlanner {
   // first goes first.
   void CreateTensorAllocationVector(std::vector<int32_t>* tensors_to_allocate);
 
+  // Reorders `tensors_to_allocate`, sorted by CreateTensorAllocationVector,
+  // into the order among a few candidate orders which packs the kTfLiteArenaRw
+  // tensors into the smallest arena. Must only be called when `arena_` has no
+  // active allocations.
+  void ChooseTensorAllocationOrder(std::vector<int32_t>* tensors_to_allocate);
+
   // Returns vector containing the indices of all tensors allocated between
   // `first_node` and `last_node`.
   std::vector<int32_t> GetTensorsToAllocate(int first_node, int last_node);
@@ -112,6 +136,16 @@ class ArenaPlanner : public MemoryPlanner {
   // Return the index of the tensor owing `tensor_index's` buffer.
   int FindSharedTensor(int tensor_index);
 
+  // Widens the lifetime of all planned tensors to the stages of their first
+  // and last nodes.
+  void ExtendLifetimesToStages();
+
+  // Returns the key of the current planning problem in `plan_cache_`.
+  std::vector<size_t> PlanCacheKey() const;
+
+  // Restores the plan cached under `key`, returning false if there is none.
+  bool RestoreCachedPlan(const std::vector<size_t>& key, int last_node);
+
   TfLiteContext* context_;
   std::unique_ptr<GraphInfo> graph_info_;
 
@@ -130,6 +164,11 @@ class ArenaPlanner : public MemoryPlanner {
   // the node's operation.
   std::vector<int32_t> dealloc_node_;
 
+  // First and last node of the stage of each node, if the nodes of a stage
+  // may run concurrently. Empty for sequential execution.
+  std::vector<int> stage_first_node_;
+  std::vector<int> stage_last_node_;
+
   // Raw memory buffer that is allocated for all temporary and graph outputs
   // that are declared kTfLiteArenaRw.
   SimpleMemoryArena arena_;
@@ -149,6 +188,20 @@ class ArenaPlanner : public MemoryPlanner {
   // Index of the last node whose tensors were allocated.
   int last_active_node_;
 
+  // See SetOptimizePacking().
+  bool optimize_packing_ = false;
+
+  // A plan of both arenas computed by CalculateAllocations().
+  struct CachedPlan {
+    std::vector<size_t> key;
+    std::vector<ArenaAllocWithUsageInterval> allocs;
+    size_t arena_high_water_mark;
+    size_t persistent_arena_high_water_mark;
+  };
+  // See SetPlanCacheSize(). The most recently computed plan comes last.
+  int plan_cache_size_ = 0;
+  std::vector<CachedPlan> plan_cache_;
+
   // Holds index of original tensor if the tensor is sharing underlined
   // data with another tensor.
   // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
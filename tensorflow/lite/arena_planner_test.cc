@@ -950,6 +950,46 @@ TEST_F(ArenaPlannerTest, DebugTensors) {
   EXPECT_EQ(tensorOffsets.size(), 8);
 }
 
+TEST_F(ArenaPlannerTest, OptimizePackingFindsSmallerArena) {
+  TestGraph graph({},
+                  {
+                      /* in, out, tmp */
+                      {{}, {1}, {0}},      // First op
+                      {{}, {2, 3}, {}},    // Second op
+                      {{3}, {4}, {}},      // Third op
+                      {{1, 4}, {5}, {}},   // Fourth op
+                      {{2, 5}, {6}, {}}},  // Fifth op
+                  {6});
+  // Usage intervals: 0 in [0, 0], 1 in [0, 3], 2 in [1, 4], 3 in [1, 2].
+  const size_t sizes[] = {16, 12, 12, 8, 0, 0, 0};
+  for (int i = 0; i < 7; ++i) {
+    (*graph.tensors())[i].bytes = sizes[i];
+  }
+
+  // By decreasing size, 3 doesn't fit in the gap left between 2 and 1.
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_EQ(GetOffset(1), 16);
+  EXPECT_EQ(GetOffset(2), 0);
+  EXPECT_EQ(GetOffset(3), 28);
+  size_t default_arena_size, persistent_arena_size;
+  planner_->GetAllocInfo(&default_arena_size, &persistent_arena_size);
+
+  // Placing the tensors with the largest size * lifetime first needs 4 bytes
+  // less.
+  SetGraph(&graph);
+  planner_->SetOptimizePacking(true);
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(2), 12);
+  EXPECT_EQ(GetOffset(0), 12);
+  EXPECT_EQ(GetOffset(3), 24);
+  size_t optimized_arena_size;
+  planner_->GetAllocInfo(&optimized_arena_size, &persistent_arena_size);
+  EXPECT_EQ(optimized_arena_size + 4, default_arena_size);
+}
+
 TEST_F(ArenaPlannerTest, SimpleProfilerTest) {
   gNumAlloc = 0;
   gNumDealloc = 0;
@@ -0,0 +1,265 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/pipelined_runner.h"
+
+#include <algorithm>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace async {
+
+namespace {
+
+size_t AlignTo(size_t alignment, size_t offset) {
+  return offset % alignment == 0 ? offset
+                                 : offset + (alignment - offset % alignment);
+}
+
+// Returns false if `tensor` can't be backed by a buffer owned by the runner.
+bool CanBindToSlot(const TfLiteTensor* tensor) {
+  return tensor != nullptr && (tensor->allocation_type == kTfLiteArenaRw ||
+                               tensor->allocation_type == kTfLiteCustom);
+}
+
+// Carves one kDefaultTensorAlignment-aligned buffer per size in `bytes` out of
+// a single allocation owned by `storage`.
+std::vector<TfLiteCustomAllocation> AllocateBuffers(
+    const std::vector<size_t>& bytes, std::unique_ptr<char[]>* storage) {
+  std::vector<size_t> offsets;
+  size_t total = 0;
+  for (size_t size : bytes) {
+    total = AlignTo(kDefaultTensorAlignment, total);
+    offsets.push_back(total);
+    total += size;
+  }
+  storage->reset(new char[total + kDefaultTensorAlignment]);
+  char* base = storage->get();
+  base += AlignTo(kDefaultTensorAlignment, reinterpret_cast<uintptr_t>(base)) -
+          reinterpret_cast<uintptr_t>(base);
+  std::vector<TfLiteCustomAllocation> buffers;
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    buffers.push_back({base + offsets[i], bytes[i]});
+  }
+  return buffers;
+}
+
+}  // namespace
+
+std::unique_ptr<PipelinedRunner> PipelinedRunner::Create(
+    Interpreter* interpreter, const char* signature_key, int depth) {
+  if (interpreter == nullptr || depth < 1) return nullptr;
+  SignatureRunner* signature_runner = nullptr;
+  if (signature_key != nullptr) {
+    signature_runner = interpreter->GetSignatureRunner(signature_key);
+    if (signature_runner == nullptr) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Signature %s was not found.",
+                      signature_key);
+      return nullptr;
+    }
+  }
+  std::unique_ptr<PipelinedRunner> runner(
+      new PipelinedRunner(interpreter, signature_runner));
+  if (runner->AllocateTensors() != kTfLiteOk) return nullptr;
+
+  std::vector<const TfLiteTensor*> inputs;
+  std::vector<const TfLiteTensor*> outputs;
+  if (signature_runner != nullptr) {
+    for (const char* name : signature_runner->input_names()) {
+      inputs.push_back(signature_runner->input_tensor(name));
+    }
+    for (const char* name : signature_runner->output_names()) {
+      outputs.push_back(signature_runner->output_tensor(name));
+    }
+  } else {
+    for (int index : interpreter->inputs()) {
+      inputs.push_back(interpreter->tensor(index));
+    }
+    for (int index : interpreter->outputs()) {
+      outputs.push_back(interpreter->tensor(index));
+    }
+  }
+  std::vector<size_t> input_bytes;
+  std::vector<size_t> output_bytes;
+  for (const TfLiteTensor* tensor : inputs) {
+    if (!CanBindToSlot(tensor)) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Input tensor can't be bound to a pipeline buffer.");
+      return nullptr;
+    }
+    input_bytes.push_back(tensor->bytes);
+  }
+  for (const TfLiteTensor* tensor : outputs) {
+    if (!CanBindToSlot(tensor) ||
+        std::find(inputs.begin(), inputs.end(), tensor) != inputs.end()) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "Output tensor can't be bound to a pipeline buffer.");
+      return nullptr;
+    }
+    output_bytes.push_back(tensor->bytes);
+  }
+
+  std::vector<size_t> bytes = input_bytes;
+  bytes.insert(bytes.end(), output_bytes.begin(), output_bytes.end());
+  runner->slots_.resize(depth);
+  for (Slot& slot : runner->slots_) {
+    std::vector<TfLiteCustomAllocation> buffers =
+        AllocateBuffers(bytes, &slot.storage);
+    slot.inputs.assign(buffers.begin(), buffers.begin() + inputs.size());
+    slot.outputs.assign(buffers.begin() + inputs.size(), buffers.end());
+  }
+  // All slots have buffers of the same sizes, so validating the first one is
+  // enough. AllocateTensors() also re-plans the arena without the bound
+  // tensors.
+  if (runner->BindSlot(runner->slots_[0]) != kTfLiteOk ||
+      runner->AllocateTensors() != kTfLiteOk) {
+    return nullptr;
+  }
+  return runner;
+}
+
+TfLiteStatus PipelinedRunner::AllocateTensors() {
+  return signature_runner_ != nullptr ? signature_runner_->AllocateTensors()
+                                      : interpreter_->AllocateTensors();
+}
+
+TfLiteStatus PipelinedRunner::BindSlot(const Slot& slot) {
+  if (signature_runner_ != nullptr) {
+    const std::vector<const char*>& input_names =
+        signature_runner_->input_names();
+    const std::vector<const char*>& output_names =
+        signature_runner_->output_names();
+    for (size_t i = 0; i < slot.inputs.size(); ++i) {
+      TF_LITE_ENSURE_STATUS(
+          signature_runner_->SetCustomAllocationForInputTensor(
+              input_names[i], slot.inputs[i]));
+    }
+    for (size_t i = 0; i < slot.outputs.size(); ++i) {
+      TF_LITE_ENSURE_STATUS(
+          signature_runner_->SetCustomAllocationForOutputTensor(
+              output_names[i], slot.outputs[i]));
+    }
+    return kTfLiteOk;
+  }
+  for (size_t i = 0; i < slot.inputs.size(); ++i) {
+    TF_LITE_ENSURE_STATUS(interpreter_->SetCustomAllocationForTensor(
+        interpreter_->inputs()[i], slot.inputs[i]));
+  }
+  for (size_t i = 0; i < slot.outputs.size(); ++i) {
+    TF_LITE_ENSURE_STATUS(interpreter_->SetCustomAllocationForTensor(
+        interpreter_->outputs()[i], slot.outputs[i]));
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus PipelinedRunner::Invoke() {
+  return signature_runner_ != nullptr ? signature_runner_->Invoke()
+                                      : interpreter_->Invoke();
+}
+
+TfLiteStatus PipelinedRunner::Run(int num_invocations,
+                                  const PreprocessFn& preprocess,
+                                  const PostprocessFn& postprocess) {
+  // Slots move from `free` to `ready` once preprocessed, from `ready` to
+  // `done` once invoked and back to `free` once postprocessed. Each queue has
+  // a single producer and a single consumer, so invocations stay in order.
+  std::mutex mutex;
+  std::condition_variable slot_available;
+  std::deque<int> free;
+  std::deque<int> ready;
+  std::deque<int> done;
+  bool failed = false;
+  for (int i = 0; i < depth(); ++i) free.push_back(i);
+
+  // Blocks until `queue` has a slot and returns it, or returns -1 once a
+  // stage has failed.
+  auto pop = [&](std::deque<int>* queue) {
+    std::unique_lock<std::mutex> lock(mutex);
+    slot_available.wait(lock, [&]() { return failed || !queue->empty(); });
+    if (failed) return -1;
+    const int slot = queue->front();
+    queue->pop_front();
+    return slot;
+  };
+  auto push = [&](std::deque<int>* queue, int slot) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      queue->push_back(slot);
+    }
+    slot_available.notify_all();
+  };
+  auto fail = [&]() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      failed = true;
+    }
+    slot_available.notify_all();
+  };
+
+  std::thread preprocessing_thread([&]() {
+    for (int invocation = 0; invocation < num_invocations; ++invocation) {
+      const int slot = pop(&free);
+      if (slot < 0) return;
+      slots_[slot].invocation = invocation;
+      if (preprocess &&
+          preprocess(invocation, slots_[slot].inputs) != kTfLiteOk) {
+        fail();
+        return;
+      }
+      push(&ready, slot);
+    }
+  });
+  std::thread postprocessing_thread([&]() {
+    for (int invocation = 0; invocation < num_invocations; ++invocation) {
+      const int slot = pop(&done);
+      if (slot < 0) return;
+      if (postprocess &&
+          postprocess(slots_[slot].invocation, slots_[slot].outputs) !=
+              kTfLiteOk) {
+        fail();
+        return;
+      }
+      push(&free, slot);
+    }
+  });
+
+  for (int invocation = 0; invocation < num_invocations; ++invocation) {
+    const int slot = pop(&ready);
+    if (slot < 0) break;
+    if (BindSlot(slots_[slot]) != kTfLiteOk || Invoke() != kTfLiteOk) {
+      fail();
+      break;
+    }
+    push(&done, slot);
+  }
+
+  preprocessing_thread.join();
+  postprocessing_thread.join();
+  return failed ? kTfLiteError : kTfLiteOk;
+}
+
+}  // namespace async
+}  // namespace tflite
@@ -0,0 +1,122 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_ASYNC_PIPELINED_RUNNER_H_
+#define TENSORFLOW_LITE_CORE_ASYNC_PIPELINED_RUNNER_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+namespace async {
+
+// WARNING: Experimental interface, subject to change
+//
+// Runs successive invocations of a model as a three stage pipeline: while
+// invocation N runs on the calling thread, the inputs of invocation N+1 are
+// filled in on a preprocessing thread and the outputs of invocation N-1 are
+// consumed on a postprocessing thread. Unlike AsyncSignatureRunner this works
+// with any kernel, CPU or delegated, since every invocation is a regular
+// synchronous Invoke().
+//
+// The runner owns `depth` slots, each holding one buffer per input and output
+// tensor. The buffers of a slot are bound to the tensors as custom allocations
+// (see Interpreter::SetCustomAllocationForTensor) right before the slot is
+// invoked, so no data is copied between the stages. A depth of 3 is enough
+// for all three stages to be busy at the same time.
+//
+// Example:
+//  std::unique_ptr<PipelinedRunner> runner =
+//      PipelinedRunner::Create(interpreter.get(), "serving_default");
+//  runner->Run(
+//      num_frames,
+//      [&](int i, const std::vector<TfLiteCustomAllocation>& inputs) {
+//        DecodeFrame(i, inputs[0].data, inputs[0].bytes);
+//        return kTfLiteOk;
+//      },
+//      [&](int i, const std::vector<TfLiteCustomAllocation>& outputs) {
+//        ReportDetections(i, outputs[0].data);
+//        return kTfLiteOk;
+//      });
+class PipelinedRunner {
+ public:
+  // Fills in the input buffers of the given invocation, in the order of
+  // Interpreter::inputs() or SignatureRunner::input_names().
+  using PreprocessFn = std::function<TfLiteStatus(
+      int invocation, const std::vector<TfLiteCustomAllocation>& inputs)>;
+  // Consumes the output buffers of the given invocation, in the order of
+  // Interpreter::outputs() or SignatureRunner::output_names().
+  using PostprocessFn = std::function<TfLiteStatus(
+      int invocation, const std::vector<TfLiteCustomAllocation>& outputs)>;
+
+  static constexpr int kDefaultDepth = 3;
+
+  // Creates a runner for the signature `signature_key` of `interpreter`, or
+  // for its primary subgraph if `signature_key` is nullptr. Input tensors must
+  // already have their final shapes. Returns nullptr if an input or output
+  // tensor can't be bound to a caller-owned buffer, e.g. because its size is
+  // only known during Invoke(), or if it is both an input and an output.
+  // `interpreter` must outlive the runner and must not be invoked by other
+  // means while the runner exists, since the runner keeps its tensors bound
+  // to the slot buffers.
+  static std::unique_ptr<PipelinedRunner> Create(
+      Interpreter* interpreter, const char* signature_key = nullptr,
+      int depth = kDefaultDepth);
+
+  PipelinedRunner(const PipelinedRunner&) = delete;
+  PipelinedRunner& operator=(const PipelinedRunner&) = delete;
+
+  // Runs `num_invocations` invocations through the pipeline and returns once
+  // the last one has been postprocessed. `preprocess` is called on the
+  // preprocessing thread and `postprocess` on the postprocessing thread, each
+  // in invocation order; either may be empty. If any stage fails, the
+  // invocations in flight are abandoned and kTfLiteError is returned.
+  TfLiteStatus Run(int num_invocations, const PreprocessFn& preprocess,
+                   const PostprocessFn& postprocess);
+
+  int depth() const { return static_cast<int>(slots_.size()); }
+
+ private:
+  struct Slot {
+    // Backing memory of all buffers below.
+    std::unique_ptr<char[]> storage;
+    std::vector<TfLiteCustomAllocation> inputs;
+    std::vector<TfLiteCustomAllocation> outputs;
+    // Index of the invocation currently using this slot.
+    int invocation = -1;
+  };
+
+  PipelinedRunner(Interpreter* interpreter, SignatureRunner* signature_runner)
+      : interpreter_(interpreter), signature_runner_(signature_runner) {}
+
+  TfLiteStatus AllocateTensors();
+  // Binds the buffers of `slot` to the input and output tensors.
+  TfLiteStatus BindSlot(const Slot& slot);
+  TfLiteStatus Invoke();
+
+  Interpreter* interpreter_;
+  // Set when running a signature, nullptr for the primary subgraph.
+  SignatureRunner* signature_runner_;
+  std::vector<Slot> slots_;
+};
+
+}  // namespace async
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_ASYNC_PIPELINED_RUNNER_H_
@@ -0,0 +1,109 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/async/pipelined_runner.h"
+
+#include <memory>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/interpreter_builder.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model_builder.h"
+
+namespace tflite {
+namespace async {
+namespace {
+
+class PipelinedRunnerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    model_ = FlatBufferModel::BuildFromFile(
+        "tensorflow/lite/testdata/multi_signatures.bin");
+    ASSERT_NE(model_, nullptr);
+    ops::builtin::BuiltinOpResolver resolver;
+    ASSERT_EQ(InterpreterBuilder(*model_, resolver)(&interpreter_), kTfLiteOk);
+    // The "add" signature computes x + 2.
+    SignatureRunner* add_runner = interpreter_->GetSignatureRunner("add");
+    ASSERT_NE(add_runner, nullptr);
+    ASSERT_EQ(add_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+  }
+
+  std::unique_ptr<FlatBufferModel> model_;
+  std::unique_ptr<Interpreter> interpreter_;
+};
+
+TEST_F(PipelinedRunnerTest, RunsInvocationsInOrder) {
+  std::unique_ptr<PipelinedRunner> runner =
+      PipelinedRunner::Create(interpreter_.get(), "add");
+  ASSERT_NE(runner, nullptr);
+  EXPECT_EQ(runner->depth(), PipelinedRunner::kDefaultDepth);
+
+  std::vector<float> results;
+  ASSERT_EQ(
+      runner->Run(
+          /*num_invocations=*/10,
+          [](int invocation,
+             const std::vector<TfLiteCustomAllocation>& inputs) {
+            EXPECT_EQ(inputs.size(), 1);
+            EXPECT_EQ(inputs[0].bytes, 2 * sizeof(float));
+            float* x = static_cast<float*>(inputs[0].data);
+            x[0] = invocation;
+            x[1] = -invocation;
+            return kTfLiteOk;
+          },
+          [&](int invocation,
+              const std::vector<TfLiteCustomAllocation>& outputs) {
+            EXPECT_EQ(outputs.size(), 1);
+            const float* output = static_cast<const float*>(outputs[0].data);
+            EXPECT_EQ(output[1], -invocation + 2);
+            results.push_back(output[0]);
+            return kTfLiteOk;
+          }),
+      kTfLiteOk);
+  EXPECT_THAT(results, ::testing::ElementsAre(2, 3, 4, 5, 6, 7, 8, 9, 10, 11));
+}
+
+TEST_F(PipelinedRunnerTest, FailingStageStopsThePipeline) {
+  std::unique_ptr<PipelinedRunner> runner =
+      PipelinedRunner::Create(interpreter_.get(), "add", /*depth=*/2);
+  ASSERT_NE(runner, nullptr);
+
+  int num_postprocessed = 0;
+  EXPECT_EQ(
+      runner->Run(
+          /*num_invocations=*/100,
+          [](int invocation, const std::vector<TfLiteCustomAllocation>&) {
+            return invocation < 5 ? kTfLiteOk : kTfLiteError;
+          },
+          [&](int, const std::vector<TfLiteCustomAllocation>&) {
+            ++num_postprocessed;
+            return kTfLiteOk;
+          }),
+      kTfLiteError);
+  EXPECT_LE(num_postprocessed, 5);
+}
+
+TEST_F(PipelinedRunnerTest, RejectsUnknownSignature) {
+  EXPECT_EQ(PipelinedRunner::Create(interpreter_.get(), "dummy"), nullptr);
+  EXPECT_EQ(PipelinedRunner::Create(interpreter_.get(), "add", /*depth=*/0),
+            nullptr);
+}
+
+}  // namespace
+}  // namespace async
+}  // namespace tflite
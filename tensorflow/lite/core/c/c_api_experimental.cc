@@ -192,6 +192,22 @@ const TfLiteTensor* TfLiteSignatureRunnerGetOutputTensor(
   return signature_runner->impl->output_tensor(output_name);
 }
 
+TfLiteStatus TfLiteSignatureRunnerSetCustomAllocationForInputTensor(
+    TfLiteSignatureRunner* signature_runner, const char* input_name,
+    const TfLiteCustomAllocation* allocation, int64_t flags) {
+  if (allocation == nullptr) return kTfLiteError;
+  return signature_runner->impl->SetCustomAllocationForInputTensor(
+      input_name, *allocation, flags);
+}
+
+TfLiteStatus TfLiteSignatureRunnerSetCustomAllocationForOutputTensor(
+    TfLiteSignatureRunner* signature_runner, const char* output_name,
+    const TfLiteCustomAllocation* allocation, int64_t flags) {
+  if (allocation == nullptr) return kTfLiteError;
+  return signature_runner->impl->SetCustomAllocationForOutputTensor(
+      output_name, *allocation, flags);
+}
+
 TfLiteStatus TfLiteSignatureRunnerCancel(
     TfLiteSignatureRunner* signature_runner) {
   return signature_runner->impl->Cancel();
@@ -385,6 +385,33 @@ TFL_CAPI_EXPORT extern const char* TfLiteSignatureRunnerGetOutputName(
 TFL_CAPI_EXPORT extern const TfLiteTensor* TfLiteSignatureRunnerGetOutputTensor(
     const TfLiteSignatureRunner* signature_runner, const char* output_name);
 
+/// Binds the caller-owned buffer described by `allocation` as the memory of
+/// the input tensor identified by `input_name`, so that the runner reads it
+/// without a copy. The buffer stays bound across invocations until another
+/// one is bound to the same tensor.
+///
+/// NOTE: `allocation->data` must outlive `signature_runner` and, unless
+/// `flags` contains kTfLiteCustomAllocationFlagsSkipAlignCheck, be aligned to
+/// 64 bytes. `allocation->bytes` is validated against the tensor size by the
+/// next call to TfLiteSignatureRunnerAllocateTensors(), which must happen
+/// before TfLiteSignatureRunnerInvoke().
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus
+TfLiteSignatureRunnerSetCustomAllocationForInputTensor(
+    TfLiteSignatureRunner* signature_runner, const char* input_name,
+    const TfLiteCustomAllocation* allocation, int64_t flags);
+
+/// Like TfLiteSignatureRunnerSetCustomAllocationForInputTensor(), but binds
+/// the buffer to the output tensor identified by `output_name`, into which
+/// TfLiteSignatureRunnerInvoke() then writes its result directly.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus
+TfLiteSignatureRunnerSetCustomAllocationForOutputTensor(
+    TfLiteSignatureRunner* signature_runner, const char* output_name,
+    const TfLiteCustomAllocation* allocation, int64_t flags);
+
 /// Attempts to cancel in flight invocation if any.
 /// This will not affect calls to `Invoke` that happend after this.
 /// Non blocking and thread safe.
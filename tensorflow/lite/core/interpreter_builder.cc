@@ -22,6 +22,7 @@ limitations under the License.
 #include <algorithm>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -667,6 +668,28 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
   return status;
 }
 
+TfLiteStatus InterpreterBuilder::ParseSubgraph(
+    const ::tflite::SubGraph* subgraph, Subgraph* modified_subgraph) {
+  // Parse tensors before nodes as ParseNodes checks input tensors for the
+  // nodes.
+  TF_LITE_ENSURE_STATUS(
+      ParseTensors(model_->buffers(), subgraph->tensors(), modified_subgraph));
+  if (subgraph->operators()) {
+    TF_LITE_ENSURE_STATUS(
+        ParseNodes(subgraph->operators(), modified_subgraph));
+  }
+
+  std::vector<int> variables;
+  for (int i = 0; i < modified_subgraph->tensors_size(); ++i) {
+    auto* tensor = modified_subgraph->tensor(i);
+    if (tensor->is_variable) {
+      variables.push_back(i);
+    }
+  }
+  modified_subgraph->SetVariables(std::move(variables));
+  return kTfLiteOk;
+}
+
 TfLiteStatus InterpreterBuilder::ApplyDelegates(Interpreter* interpreter) {
   // Apply Flex delegate if applicable.
   if (has_flex_op_) {
@@ -770,12 +793,23 @@ TfLiteStatus InterpreterBuilder::operator()(
   (*interpreter)
       ->SetProfilerImpl(tflite::profiling::MaybeCreatePlatformProfiler());
 
+  // Subgraphs of signatures other than the primary one whose parsing is
+  // deferred until the signature is used.
+  std::set<int> lazy_subgraph_indices;
+  std::shared_ptr<InterpreterBuilder> lazy_builder;
+  if (options_.GetLazySubgraphInitialization() && model_->signature_defs()) {
+    for (const SignatureDef* signature_def : *model_->signature_defs()) {
+      if (signature_def->subgraph_index() > 0) {
+        lazy_subgraph_indices.insert(signature_def->subgraph_index());
+      }
+    }
+  }
+
   for (int subgraph_index = 0; subgraph_index < subgraphs->size();
        ++subgraph_index) {
     const tflite::SubGraph* subgraph = (*subgraphs)[subgraph_index];
     tflite::Subgraph* modified_subgraph =
         (*interpreter)->subgraph(subgraph_index);
-    auto operators = subgraph->operators();
     auto tensors = subgraph->tensors();
     if (!tensors) {
       TF_LITE_REPORT_ERROR(error_reporter_,
@@ -791,26 +825,31 @@ TfLiteStatus InterpreterBuilder::operator()(
         FlatBufferIntArrayToVector(subgraph->inputs()));
     modified_subgraph->SetOutputs(
         FlatBufferIntArrayToVector(subgraph->outputs()));
-
-    // Finally setup nodes and tensors
-    // Parse tensors before nodes as ParseNodes checks input tensors for the
-    // nodes.
-    if (ParseTensors(buffers, tensors, modified_subgraph) != kTfLiteOk)
-      return cleanup_and_error();
-    if (operators && ParseNodes(operators, modified_subgraph) != kTfLiteOk)
-      return cleanup_and_error();
-
-    std::vector<int> variables;
-    for (int i = 0; i < modified_subgraph->tensors_size(); ++i) {
-      auto* tensor = modified_subgraph->tensor(i);
-      if (tensor->is_variable) {
-        variables.push_back(i);
-      }
-    }
-    modified_subgraph->SetVariables(std::move(variables));
     if (subgraph->name()) {
       modified_subgraph->SetName(subgraph->name()->c_str());
     }
+
+    if (lazy_subgraph_indices.count(subgraph_index)) {
+      // The builder used to parse the subgraph later may outlive this one, so
+      // it gets its own copy of the op registrations.
+      if (!lazy_builder) {
+        lazy_builder = std::make_shared<InterpreterBuilder>(
+            model_, op_resolver_, error_reporter_, &options_);
+        lazy_builder->allocation_ = allocation_;
+        if (lazy_builder->BuildLocalIndexToRegistrationMapping() !=
+            kTfLiteOk) {
+          return cleanup_and_error();
+        }
+      }
+      modified_subgraph->SetLazyInitializer(
+          [lazy_builder, subgraph, modified_subgraph]() {
+            return lazy_builder->ParseSubgraph(subgraph, modified_subgraph);
+          });
+      continue;
+    }
+
+    if (ParseSubgraph(subgraph, modified_subgraph) != kTfLiteOk)
+      return cleanup_and_error();
   }
 
   if (ParseSignatureDefs(model_->signature_defs(), interpreter->get()) !=
@@ -120,6 +120,10 @@ class InterpreterBuilder {
       const flatbuffers::Vector<flatbuffers::Offset<Buffer>>* buffers,
       const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors,
       Subgraph* subgraph);
+  // Parses the tensors and nodes of `subgraph` into `modified_subgraph`, whose
+  // tensors have already been added.
+  TfLiteStatus ParseSubgraph(const ::tflite::SubGraph* subgraph,
+                             Subgraph* modified_subgraph);
   TfLiteStatus ApplyDelegates(Interpreter* interpreter);
   TfLiteStatus ParseQuantization(const QuantizationParameters* src_quantization,
                                  TfLiteQuantization* quantization,
@@ -188,6 +188,11 @@ SignatureRunner* Interpreter::GetSignatureRunner(const char* signature_key) {
 
   for (const auto& signature : signature_defs_) {
     if (signature.signature_key == signature_key) {
+      // Builds the subgraph if its initialization was deferred.
+      if (subgraph(signature.subgraph_index)->EnsureInitialized() !=
+          kTfLiteOk) {
+        return nullptr;
+      }
       auto status = signature_runner_map_.insert(
           {signature_key,
            SignatureRunner(&signature, subgraph(signature.subgraph_index))});
@@ -0,0 +1,94 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/node_worker_pool.h"
+
+namespace tflite {
+
+NodeWorkerPool::NodeWorkerPool(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back([this, i]() { WorkerLoop(i); });
+  }
+}
+
+NodeWorkerPool::~NodeWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void NodeWorkerPool::ParallelFor(int num_tasks,
+                                 const std::function<void(int, int)>& task) {
+  if (num_tasks <= 0) return;
+  if (workers_.empty() || num_tasks == 1) {
+    for (int i = 0; i < num_tasks; ++i) task(i, 0);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_ = 0;
+    num_tasks_done_ = 0;
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunTasks(/*thread_index=*/0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this]() { return num_tasks_done_ == num_tasks_; });
+  task_ = nullptr;
+}
+
+void NodeWorkerPool::WorkerLoop(int thread_index) {
+  int seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [&]() {
+        return shutting_down_ || generation_ != seen_generation;
+      });
+      if (shutting_down_) return;
+      seen_generation = generation_;
+    }
+    RunTasks(thread_index);
+  }
+}
+
+void NodeWorkerPool::RunTasks(int thread_index) {
+  while (true) {
+    const std::function<void(int, int)>* task;
+    int task_index;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (task_ == nullptr || next_task_ >= num_tasks_) return;
+      task = task_;
+      task_index = next_task_++;
+    }
+    (*task)(task_index, thread_index);
+    bool all_done;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      all_done = ++num_tasks_done_ == num_tasks_;
+    }
+    if (all_done) work_done_.notify_one();
+  }
+}
+
+}  // namespace tflite
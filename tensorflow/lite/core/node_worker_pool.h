@@ -0,0 +1,69 @@
+/* Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_NODE_WORKER_POOL_H_
+#define TENSORFLOW_LITE_CORE_NODE_WORKER_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+namespace tflite {
+
+// A fixed set of threads used by Subgraph to run independent nodes of its
+// execution plan concurrently. The calling thread takes part in the work, so
+// a pool of `num_threads` threads spawns `num_threads - 1` workers.
+//
+// WARNING: This is an experimental interface that is subject to change.
+class NodeWorkerPool {
+ public:
+  explicit NodeWorkerPool(int num_threads);
+  ~NodeWorkerPool();
+  NodeWorkerPool(const NodeWorkerPool&) = delete;
+  NodeWorkerPool& operator=(const NodeWorkerPool&) = delete;
+
+  // Number of threads running tasks, including the calling thread.
+  int num_threads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  // Calls `task(task_index, thread_index)` for every task_index in
+  // [0, num_tasks) and returns once all calls have finished. `thread_index` is
+  // in [0, num_threads()) and identifies the thread making the call; the
+  // calling thread has index 0. Must not be called concurrently.
+  void ParallelFor(int num_tasks, const std::function<void(int, int)>& task);
+
+ private:
+  void WorkerLoop(int thread_index);
+  // Runs tasks of the current batch until there are none left.
+  void RunTasks(int thread_index);
+
+  std::vector<std::thread> workers_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // Incremented for each call to ParallelFor, so that workers can tell a new
+  // batch of tasks from one they already took part in.
+  int generation_ = 0;
+  bool shutting_down_ = false;
+  const std::function<void(int, int)>* task_ = nullptr;
+  int num_tasks_ = 0;
+  int next_task_ = 0;
+  int num_tasks_done_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_NODE_WORKER_POOL_H_
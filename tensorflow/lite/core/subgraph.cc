@@ -39,8 +39,10 @@ limitations under the License.
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/core/node_worker_pool.h"
 #include "tensorflow/lite/experimental/remat/metadata_util.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -77,6 +79,27 @@ struct TfLiteSparsityDeleter {
 using ScopedTfLiteSparsity =
     std::unique_ptr<TfLiteSparsity, TfLiteSparsityDeleter>;
 
+// CPU backend context used by the kernels running on this thread instead of
+// the one of their subgraph, while a worker of a NodeWorkerPool runs a node.
+thread_local TfLiteExternalContext* cpu_backend_context_override = nullptr;
+
+class ScopedCpuBackendContextOverride {
+ public:
+  explicit ScopedCpuBackendContextOverride(TfLiteExternalContext* context)
+      : previous_(cpu_backend_context_override) {
+    cpu_backend_context_override = context;
+  }
+  ~ScopedCpuBackendContextOverride() {
+    cpu_backend_context_override = previous_;
+  }
+
+ private:
+  TfLiteExternalContext* previous_;
+};
+
+// Number of arena plans kept when resizing incrementally.
+constexpr int kNumCachedAllocationPlans = 8;
+
 TfLiteStatus ReportOpError(TfLiteContext* context, const TfLiteNode& node,
                            const TfLiteRegistration& registration,
                            int node_index, const char* message) {
@@ -559,6 +582,9 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext && cpu_backend_context_override) {
+    return cpu_backend_context_override;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -827,6 +853,7 @@ TfLiteStatus Subgraph::BytesRequired(TfLiteType type, const int* dims,
 }
 
 TfLiteStatus Subgraph::AllocateTensors() {
+  TF_LITE_ENSURE_STATUS(EnsureInitialized());
   if (!consistent_) {
     ReportError("AllocateTensors() called on inconsistent model.");
     return kTfLiteError;
@@ -863,6 +890,14 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // Profile "AllocateTensors" only when memory planning is needed.
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "AllocateTensors");
 
+  // Nodes whose inputs kept their shape don't need to be prepared again if
+  // nothing but input tensors changed since the last preparation.
+  skip_unresized_nodes_in_prepare_ =
+      ShouldResizeIncrementally() && only_inputs_resized_ &&
+      delegates_applied_.empty() && !has_dynamic_tensors_ &&
+      prepared_tensor_dims_.size() == tensors_.size();
+  only_inputs_resized_ = false;
+
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
@@ -870,10 +905,24 @@ TfLiteStatus Subgraph::AllocateTensors() {
     TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
   }
 
-  TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+  const TfLiteStatus prepare_status = PrepareOpsAndTensors();
+  skip_unresized_nodes_in_prepare_ = false;
+  TF_LITE_ENSURE_STATUS(prepare_status);
 
   state_ = kStateInvokable;
 
+  if (ShouldResizeIncrementally()) {
+    prepared_tensor_dims_.resize(tensors_.size());
+    for (size_t i = 0; i < tensors_.size(); ++i) {
+      const TfLiteIntArray* dims = tensors_[i].dims;
+      if (dims == nullptr) {
+        prepared_tensor_dims_[i].clear();
+      } else {
+        prepared_tensor_dims_[i].assign(dims->data, dims->data + dims->size);
+      }
+    }
+  }
+
   // Reset the variable tensors to zero after (re)allocating the tensors.
   // Developers shouldn't rely on the side effect of this function to reset
   // variable tensors. They should call `ResetVariableTensors` directly
@@ -1011,6 +1060,7 @@ bool Subgraph::OpMightHaveSideEffect(
 
 TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
                                          const std::vector<int>& dims) {
+  TF_LITE_ENSURE_STATUS(EnsureInitialized());
   const bool delegates_applied = !delegates_applied_.empty();
   const bool graph_is_immutable = state_ == kStateInvokableAndImmutable;
   if (graph_is_immutable && !delegates_applied) {
@@ -1037,12 +1087,16 @@ TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
     // Undo delegation if it resulted in the graph being immutable.
     TF_LITE_ENSURE_STATUS(UndoAllDelegates());
   }
+  // Remember whether the tensors were allocated, and only inputs were resized
+  // since, for AllocateTensors() to only prepare the nodes using them.
+  only_inputs_resized_ = state_ != kStateUninvokable || only_inputs_resized_;
   state_ = kStateUninvokable;
   return ResizeTensorImpl(tensor, ConvertVectorToTfLiteIntArray(dims));
 }
 
 TfLiteStatus Subgraph::ResizeInputTensorStrict(int tensor_index,
                                                const std::vector<int>& dims) {
+  TF_LITE_ENSURE_STATUS(EnsureInitialized());
   TF_LITE_ENSURE(&context_,
                  tensor_index < context_.tensors_size && tensor_index >= 0);
   TfLiteTensor* tensor = &context_.tensors[tensor_index];
@@ -1214,6 +1268,10 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
+    if (skip_unresized_nodes_in_prepare_ && !HasResizedInput(node)) {
+      *last_execution_plan_index_prepared = execution_plan_index;
+      continue;
+    }
     EnsureTensorsVectorCapacity();
 #ifdef TF_LITE_TENSORFLOW_PROFILER
     tflite::OnTfLiteOpPrepare(GetTFLiteOpName(registration), subgraph_index_,
@@ -1239,16 +1297,37 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
   return kTfLiteOk;
 }
 
+bool Subgraph::HasResizedInput(const TfLiteNode& node) const {
+  for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    if (tensor_index >= static_cast<int>(prepared_tensor_dims_.size())) {
+      return true;
+    }
+    const std::vector<int>& prepared_dims = prepared_tensor_dims_[tensor_index];
+    if (!EqualArrayAndTfLiteIntArray(tensors_[tensor_index].dims,
+                                     static_cast<int>(prepared_dims.size()),
+                                     prepared_dims.data())) {
+      return true;
+    }
+  }
+  return false;
+}
+
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
   if (!memory_planner_) {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
-    memory_planner_ = std::make_unique<ArenaPlanner>(
+    auto arena_planner = std::make_unique<ArenaPlanner>(
         &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
         kDefaultTensorAlignment, subgraph_index_);
+    arena_planner->SetOptimizePacking(ShouldOptimizeMemoryPacking());
+    if (ShouldResizeIncrementally()) {
+      arena_planner->SetPlanCacheSize(kNumCachedAllocationPlans);
+    }
+    memory_planner_ = std::move(arena_planner);
 #endif
-    memory_planner_->PlanAllocations();
+    PlanAllocations();
   }
 
   // Prepare original execution plan if any applied delegate wants it.
@@ -1371,6 +1450,14 @@ TfLiteStatus Subgraph::Invoke() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
+  if (CanInvokeInParallel()) {
+    status = InvokeInParallel();
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    return status;
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1492,6 +1579,230 @@ TfLiteStatus Subgraph::Invoke() {
   return status;
 }
 
+TfLiteStatus Subgraph::PlanAllocations() {
+  PlanParallelStages();
+  std::vector<int> stage_first_node;
+  std::vector<int> stage_last_node;
+  if (!parallel_stages_.empty()) {
+    stage_first_node.resize(execution_plan_.size());
+    stage_last_node.resize(execution_plan_.size());
+    for (const auto& [first, end] : parallel_stages_) {
+      for (int i = first; i < end; ++i) {
+        stage_first_node[i] = first;
+        stage_last_node[i] = end - 1;
+      }
+    }
+  }
+  memory_planner_->SetConcurrentStages(std::move(stage_first_node),
+                                       std::move(stage_last_node));
+  return memory_planner_->PlanAllocations();
+}
+
+void Subgraph::PlanParallelStages() {
+  parallel_stages_.clear();
+  const int num_threads = NumParallelNodeThreads();
+  if (num_threads <= 1) {
+    node_worker_pool_.reset();
+    worker_cpu_backend_contexts_.clear();
+    return;
+  }
+  for (int node_index : execution_plan_) {
+    const auto& [node, registration] = nodes_and_registration_[node_index];
+    // Delegate kernels manage their own threads, and the nodes of control
+    // flow subgraphs share the state of their subgraphs.
+    if (node.delegate != nullptr ||
+        registration.builtin_code == kTfLiteBuiltinIf ||
+        registration.builtin_code == kTfLiteBuiltinWhile ||
+        registration.builtin_code == kTfLiteBuiltinCallOnce) {
+      return;
+    }
+  }
+
+  // Each node goes into the stage after the latest stage it depends on. The
+  // graph is in SSA form except for variable tensors, so nodes which might
+  // have side effects or access variables keep their relative order.
+  std::vector<int> tensor_stage(tensors_.size(), -1);
+  std::vector<int> node_stage(nodes_and_registration_.size(), 0);
+  std::vector<std::vector<int>> control_dependencies;
+  if (control_edges_ != nullptr) {
+    control_dependencies.resize(nodes_and_registration_.size());
+    for (const auto& [from, to] : *control_edges_) {
+      if (to >= 0 && to < static_cast<int>(control_dependencies.size())) {
+        control_dependencies[to].push_back(from);
+      }
+    }
+  }
+  auto accesses_variable = [this](const TfLiteIntArray* tensor_indices) {
+    for (int tensor_index : TfLiteIntArrayView(tensor_indices)) {
+      if (tensor_index != kTfLiteOptionalTensor &&
+          tensors_[tensor_index].is_variable) {
+        return true;
+      }
+    }
+    return false;
+  };
+  int last_side_effect_stage = -1;
+  int num_stages = 0;
+  for (int node_index : execution_plan_) {
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    int stage = 0;
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index != kTfLiteOptionalTensor) {
+        stage = std::max(stage, tensor_stage[tensor_index] + 1);
+      }
+    }
+    if (!control_dependencies.empty()) {
+      for (int from : control_dependencies[node_index]) {
+        stage = std::max(stage, node_stage[from] + 1);
+      }
+    }
+    if (node.might_have_side_effect || accesses_variable(node.inputs) ||
+        accesses_variable(node.outputs)) {
+      stage = std::max(stage, last_side_effect_stage + 1);
+      last_side_effect_stage = stage;
+    }
+    node_stage[node_index] = stage;
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index != kTfLiteOptionalTensor) {
+        tensor_stage[tensor_index] = stage;
+      }
+    }
+    num_stages = std::max(num_stages, stage + 1);
+  }
+  if (num_stages == static_cast<int>(execution_plan_.size())) {
+    // No two nodes can run concurrently.
+    return;
+  }
+
+  std::stable_sort(execution_plan_.begin(), execution_plan_.end(),
+                   [&node_stage](int lhs, int rhs) {
+                     return node_stage[lhs] < node_stage[rhs];
+                   });
+  for (int first = 0; first < static_cast<int>(execution_plan_.size());) {
+    int end = first + 1;
+    while (end < static_cast<int>(execution_plan_.size()) &&
+           node_stage[execution_plan_[end]] ==
+               node_stage[execution_plan_[first]]) {
+      ++end;
+    }
+    parallel_stages_.emplace_back(first, end);
+    first = end;
+  }
+
+  if (!node_worker_pool_ || node_worker_pool_->num_threads() != num_threads) {
+    node_worker_pool_ = std::make_unique<NodeWorkerPool>(num_threads);
+    worker_cpu_backend_contexts_.clear();
+    for (int i = 1; i < num_threads; ++i) {
+      worker_cpu_backend_contexts_.push_back(
+          std::make_unique<ExternalCpuBackendContext>());
+    }
+  }
+}
+
+bool Subgraph::CanInvokeInParallel() const {
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+  // The TensorFlow profiler traces nodes in the order they are invoked.
+  return false;
+#else
+  if (parallel_stages_.empty() || !node_worker_pool_ || profiler_) {
+    return false;
+  }
+  // Preparing nodes and allocating dynamic tensors may change the memory plan
+  // during the invocation, which is only done sequentially.
+  if (next_execution_plan_index_to_prepare_ !=
+      static_cast<int>(execution_plan_.size())) {
+    return false;
+  }
+  for (const TfLiteTensor& tensor : tensors_) {
+    if (tensor.allocation_type == kTfLiteDynamic) return false;
+  }
+  return true;
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+}
+
+TfLiteStatus Subgraph::InvokeInParallel() {
+  const int recommended_num_threads = context_.recommended_num_threads;
+  std::vector<TfLiteStatus> statuses;
+  for (const std::pair<int, int>& stage : parallel_stages_) {
+    const int first = stage.first;
+    const int end = stage.second;
+    EnsureTensorsVectorCapacity();
+    tensor_resized_since_op_invoke_ = false;
+    const int num_nodes = end - first;
+    if (num_nodes == 1) {
+      TF_LITE_ENSURE_STATUS(InvokeNodeInStage(first));
+      continue;
+    }
+
+    // Split the threads of the CPU backend between the nodes running
+    // concurrently. Worker contexts created by a kernel during this stage
+    // start with `recommended_num_threads` and are adjusted from the next one.
+    const int num_concurrent_nodes =
+        std::min(num_nodes, node_worker_pool_->num_threads());
+    const int threads_per_node =
+        std::max(1, recommended_num_threads / num_concurrent_nodes);
+    for (const auto& context : worker_cpu_backend_contexts_) {
+      if (context->internal_backend_context() != nullptr) {
+        context->internal_backend_context()->SetMaxNumThreads(
+            threads_per_node);
+      }
+    }
+
+    statuses.assign(num_nodes, kTfLiteOk);
+    node_worker_pool_->ParallelFor(num_nodes, [&](int task, int thread) {
+      ScopedCpuBackendContextOverride context_override(
+          thread == 0 ? nullptr
+                      : worker_cpu_backend_contexts_[thread - 1].get());
+      statuses[task] = InvokeNodeInStage(first + task);
+    });
+    for (TfLiteStatus status : statuses) {
+      TF_LITE_ENSURE_STATUS(status);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::InvokeNodeInStage(int execution_plan_index) {
+  const int node_index = execution_plan_[execution_plan_index];
+  TfLiteNode& node = nodes_and_registration_[node_index].first;
+  const TfLiteRegistration& registration =
+      nodes_and_registration_[node_index].second;
+
+  for (int i = 0; i < node.inputs->size; ++i) {
+    const int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) {
+      continue;
+    }
+    const TfLiteTensor& tensor = tensors_[tensor_index];
+    // See Invoke() for the exception made for the shape input of reshape.
+    if (tensor.data.raw == nullptr && tensor.bytes > 0 &&
+        !(registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor.dims->size != 1)) {
+      ReportError("Input tensor %d lacks data", tensor_index);
+      return kTfLiteError;
+    }
+  }
+
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+    // `Cancel` is called and cancellation flag is flipped.
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteCancelled;
+  }
+
+  if (auto s = OpInvoke(registration, &node); s != kTfLiteOk) {
+    auto err = ReportOpError(&context_, node, registration, node_index,
+                             "failed to invoke");
+    return s == kTfLiteCancelled ? s : err;
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1886,6 +2197,10 @@ TfLiteStatus Subgraph::RedoAllDelegates() {
 }
 
 TfLiteStatus Subgraph::RemoveAllDelegates() {
+  if (!IsInitialized()) {
+    pending_delegates_.clear();
+    return kTfLiteOk;
+  }
   TF_LITE_ENSURE_STATUS(UndoAllDelegates());
   delegates_applied_.clear();
   delegates_undone_ = false;
@@ -1920,7 +2235,7 @@ void Subgraph::EnsureTensorsVectorCapacity() {
 TfLiteStatus Subgraph::EnsureMemoryAllocations() {
   if (memory_planner_) {
     state_ = kStateUninvokable;
-    TF_LITE_ENSURE_OK(&context_, memory_planner_->PlanAllocations());
+    TF_LITE_ENSURE_OK(&context_, PlanAllocations());
   }
   TF_LITE_ENSURE_OK(&context_, AllocateTensors());
   TF_LITE_ENSURE_EQ(&context_, state_, kStateInvokable);
@@ -1936,6 +2251,12 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
     return kTfLiteDelegateError;
   }
 
+  // The delegate is applied once the subgraph has been built.
+  if (!IsInitialized()) {
+    pending_delegates_.push_back(delegate);
+    return kTfLiteOk;
+  }
+
   // Resets delegation & leaves graph in consistent state if delegate status is
   // not okay.
   auto reset_delegation_if_not_ok = [this](TfLiteStatus status) {
@@ -2078,6 +2399,27 @@ void Subgraph::SetName(const char* name) {
 
 const std::string& Subgraph::GetName() const { return name_; }
 
+TfLiteStatus Subgraph::EnsureInitialized() {
+  if (IsInitialized()) return kTfLiteOk;
+  std::function<TfLiteStatus()> initializer = std::move(lazy_initializer_);
+  lazy_initializer_ = nullptr;
+  if (initializer() != kTfLiteOk) {
+    ReportError("Failed to initialize subgraph %s.", name_.c_str());
+    consistent_ = false;
+    return kTfLiteError;
+  }
+  std::vector<TfLiteDelegate*> delegates = std::move(pending_delegates_);
+  pending_delegates_.clear();
+  for (TfLiteDelegate* delegate : delegates) {
+    const TfLiteStatus status = ModifyGraphWithDelegate(delegate);
+    // As for delegates applied to the interpreter, the subgraph has been
+    // restored to run without delegates after a delegate error.
+    if (status == kTfLiteDelegateError) break;
+    if (status == kTfLiteError) return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
 void Subgraph::DumpMemoryPlannerDebugInfo() const {
   if (memory_planner_ == nullptr) return;
   memory_planner_->DumpDebugInfo(execution_plan());
@@ -21,6 +21,7 @@ limitations under the License.
 #include <atomic>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
 #include <map>
 #include <memory>
 #include <set>
@@ -35,8 +36,10 @@ limitations under the License.
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/core/node_worker_pool.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -377,6 +380,21 @@ class Subgraph {
   void SetName(const char* name);
   const std::string& GetName() const;
 
+  // Defers parsing the tensors and nodes of this subgraph until it is first
+  // allocated or resized. `initializer` is run once by `EnsureInitialized()`.
+  // Delegates applied in the meantime are applied after it ran.
+  // WARNING: This is an experimental API and subject to change.
+  void SetLazyInitializer(std::function<TfLiteStatus()> initializer) {
+    lazy_initializer_ = std::move(initializer);
+  }
+
+  // Returns false while the lazy initializer of this subgraph hasn't run.
+  bool IsInitialized() const { return lazy_initializer_ == nullptr; }
+
+  // Runs the lazy initializer of this subgraph, if any, and applies the
+  // delegates that were deferred until then.
+  TfLiteStatus EnsureInitialized();
+
   // WARNING: This is an experimental API and subject to change.
   // Dumps debugging info by the underlying memory planner.
   // Note: to have minimal binary increase caused by this debug info dump for
@@ -445,6 +463,26 @@ class Subgraph {
     return (options_ && options_->GetDisableDelegateClustering());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // Number of threads which run independent nodes concurrently, see
+  // `InterpreterOptions::SetNumParallelNodeThreads`.
+  int NumParallelNodeThreads() const {
+    return options_ ? options_->GetNumParallelNodeThreads() : 1;
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if the memory planner should search for a smaller tensor packing.
+  bool ShouldOptimizeMemoryPacking() const {
+    return (options_ && options_->GetOptimizeMemoryPacking());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if AllocateTensors() should only prepare nodes whose inputs were
+  // resized. See `InterpreterOptions::SetIncrementalResize`.
+  bool ShouldResizeIncrementally() const {
+    return (options_ && options_->GetIncrementalResize());
+  }
+
  private:
 #ifndef DOXYGEN_SKIP
   friend class InterpreterBuilder;
@@ -531,6 +569,30 @@ class Subgraph {
   // to wait until Invoke() to resolve the sizes of dynamic tensors.
   TfLiteStatus PrepareOpsAndTensors();
 
+  // Returns true if the shape of an input of `node` differs from the one in
+  // `prepared_tensor_dims_`.
+  bool HasResizedInput(const TfLiteNode& node) const;
+
+  // Plans the memory allocations of the execution plan. If nodes may run
+  // concurrently, first reorders the execution plan into stages of independent
+  // nodes and declares the stages to the memory planner.
+  TfLiteStatus PlanAllocations();
+
+  // Groups the nodes of the execution plan into `parallel_stages_`, or clears
+  // them if the nodes can't run concurrently.
+  void PlanParallelStages();
+
+  // Returns true if this invocation can run the nodes of a stage concurrently.
+  bool CanInvokeInParallel() const;
+
+  // Runs the execution plan stage by stage, running the nodes of a stage
+  // concurrently on `node_worker_pool_`.
+  TfLiteStatus InvokeInParallel();
+
+  // Invokes the node at `execution_plan_index` as part of InvokeInParallel().
+  // May run concurrently with the other nodes of its stage.
+  TfLiteStatus InvokeNodeInStage(int execution_plan_index);
+
   // Call OpPrepare() for all ops starting at 'first_node'. Stop when a
   // dynamic tensors is found or all ops have been prepared. Fill
   // 'last_node_prepared' with the id of the op containing dynamic tensors, or
@@ -866,6 +928,13 @@ class Subgraph {
   // Contains a list of delegates applied by the user so far, in order.
   std::vector<TfLiteDelegate*> delegates_applied_;
 
+  // Builds the tensors and nodes of a lazily initialized subgraph, see
+  // `SetLazyInitializer()`. Null once the subgraph is initialized.
+  std::function<TfLiteStatus()> lazy_initializer_;
+
+  // Delegates applied before the lazy initializer ran, in order.
+  std::vector<TfLiteDelegate*> pending_delegates_;
+
   // Set to true if UndoAllDelegates was called, and to false during
   // RedoAllDelegates.
   bool delegates_undone_ = false;
@@ -902,6 +971,17 @@ class Subgraph {
   // The value is invalid before `PrepareOpStartingAt` is called.
   bool has_dynamic_tensors_ = true;
 
+  // True if only input tensors were resized since the last AllocateTensors().
+  bool only_inputs_resized_ = false;
+
+  // Set while AllocateTensors() prepares only the nodes with an input whose
+  // shape differs from `prepared_tensor_dims_`.
+  bool skip_unresized_nodes_in_prepare_ = false;
+
+  // Dimensions of all tensors at the end of the last AllocateTensors(), if
+  // ShouldResizeIncrementally().
+  std::vector<std::vector<int>> prepared_tensor_dims_;
+
   // WARNING: This is an experimental interface that is subject to change.
   // This is the index of dynamic tensor which was checked at
   // PrepareOpsStartingAt() when `has_dynamic_tensors_` is set. This information
@@ -971,6 +1051,16 @@ class Subgraph {
   // interpreter. The owning interpreter will keep this consistent with
   // metadata_ by appropriately parametrized SetMetadata method calls.
   const ControlEdges* control_edges_ = nullptr;
+
+  // Ranges [first, last) of execution plan indices whose nodes may run
+  // concurrently. Empty if the nodes run sequentially.
+  std::vector<std::pair<int, int>> parallel_stages_;
+
+  // Threads running the nodes of a stage, and a CPU backend context for each
+  // of them so that kernels running concurrently don't share one.
+  std::unique_ptr<NodeWorkerPool> node_worker_pool_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      worker_cpu_backend_contexts_;
 };
 
 }  // namespace tflite
@@ -20,6 +20,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/interpreter_options.h"
 
 namespace tflite {
 
@@ -71,5 +72,114 @@ TEST(RemoveUnusedInputs, BypassInputsWithoutOp) {
   ASSERT_EQ(subgraph.inputs(), std::vector<int>({0, -1, 2}));
 }
 
+TEST(ParallelNodes, IndependentBranchesRunConcurrently) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetNumParallelNodeThreads(4);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(6);
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {2},
+                                                    TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0, 1});
+  subgraph.SetOutputs({4, 5});
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  // Two chains of two nodes, added one chain after the other.
+  subgraph.AddNodeWithParameters({0}, {2}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({2}, {4}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({1}, {3}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({3}, {5}, {}, nullptr, 0, nullptr, neg_op);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+
+  // The first nodes of both chains form the first stage.
+  EXPECT_EQ(subgraph.execution_plan(), std::vector<int>({0, 2, 1, 3}));
+
+  for (int input : {0, 1}) {
+    float* data = subgraph.tensor(input)->data.f;
+    data[0] = input + 1.0f;
+    data[1] = -(input + 2.0f);
+  }
+  ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+  EXPECT_THAT(std::vector<float>(subgraph.tensor(4)->data.f,
+                                 subgraph.tensor(4)->data.f + 2),
+              ::testing::ElementsAre(1.0f, -2.0f));
+  EXPECT_THAT(std::vector<float>(subgraph.tensor(5)->data.f,
+                                 subgraph.tensor(5)->data.f + 2),
+              ::testing::ElementsAre(2.0f, -3.0f));
+}
+
+// Counts its preparations and copies its input to its output.
+int num_copy_op_prepares = 0;
+
+TfLiteRegistration* RegisterCopyOp() {
+  static TfLiteRegistration registration = {
+      /*init=*/nullptr, /*free=*/nullptr,
+      /*prepare=*/
+      [](TfLiteContext* context, TfLiteNode* node) {
+        ++num_copy_op_prepares;
+        const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+        TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+        return context->ResizeTensor(context, output,
+                                     TfLiteIntArrayCopy(input->dims));
+      },
+      /*invoke=*/
+      [](TfLiteContext* context, TfLiteNode* node) {
+        const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+        TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+        std::copy_n(input->data.raw, input->bytes, output->data.raw);
+        return kTfLiteOk;
+      }};
+  return &registration;
+}
+
+TEST(IncrementalResize, OnlyResizedNodesArePreparedAgain) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetIncrementalResize(true);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(4);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(i, kTfLiteFloat32, "", {1},
+                                                    TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0, 1});
+  subgraph.SetOutputs({2, 3});
+  subgraph.AddNodeWithParameters({0}, {2}, {}, nullptr, 0, nullptr,
+                                 RegisterCopyOp());
+  subgraph.AddNodeWithParameters({1}, {3}, {}, nullptr, 0, nullptr,
+                                 RegisterCopyOp());
+  num_copy_op_prepares = 0;
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(num_copy_op_prepares, 2);
+
+  // Only the node reading input 0 is prepared again, and output 3 keeps its
+  // shape.
+  for (int length : {3, 1, 3}) {
+    num_copy_op_prepares = 0;
+    ASSERT_EQ(subgraph.ResizeInputTensor(0, {length}), kTfLiteOk);
+    ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+    EXPECT_EQ(num_copy_op_prepares, 1);
+    ASSERT_EQ(subgraph.tensor(2)->dims->size, 1);
+    EXPECT_EQ(subgraph.tensor(2)->dims->data[0], length);
+    ASSERT_EQ(subgraph.tensor(3)->dims->size, 1);
+    EXPECT_EQ(subgraph.tensor(3)->dims->data[0], 1);
+
+    for (int i = 0; i < length; ++i) {
+      subgraph.tensor(0)->data.f[i] = i + 1.0f;
+    }
+    subgraph.tensor(1)->data.f[0] = -1.0f;
+    ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+    for (int i = 0; i < length; ++i) {
+      EXPECT_EQ(subgraph.tensor(2)->data.f[i], i + 1.0f);
+    }
+    EXPECT_EQ(subgraph.tensor(3)->data.f[0], -1.0f);
+  }
+}
+
 }  // namespace
 }  // namespace tflite
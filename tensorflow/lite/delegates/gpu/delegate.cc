@@ -104,6 +104,21 @@ class Delegate {
     }
   }
 
+  // Sets up serialization keyed by a fingerprint of the model in `context` if
+  // it's enabled without a model_token.
+  void MaybeInitSerializationFromModel(TfLiteContext* context) {
+    if (serialization_ || !options_.serialization_dir ||
+        !(options_.experimental_flags &
+          TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION)) {
+      return;
+    }
+    model_token_ = delegates::ModelFingerprint(context);
+    SerializationParams params;
+    params.model_token = model_token_.c_str();
+    params.cache_dir = options_.serialization_dir;
+    serialization_ = std::make_unique<Serialization>(params);
+  }
+
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
@@ -123,6 +138,8 @@ class Delegate {
   int num_delegate_kernels_ = 0;
 
   std::unique_ptr<Serialization> serialization_;
+  // Model token computed by MaybeInitSerializationFromModel().
+  std::string model_token_;
 
   friend class DelegateKernel;
 };
@@ -568,6 +585,7 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
   };
 
   auto* gpu_delegate = GetDelegate(delegate);
+  gpu_delegate->MaybeInitSerializationFromModel(context);
   absl::flat_hash_set<TfLiteBuiltinOperator> excluded_ops;
   if (!cl::OpenCLSupported()) {
     excluded_ops.insert(kTfLiteBuiltinSplit);
@@ -67,8 +67,12 @@ enum TfLiteGpuExperimentalFlags {
   // model or inference params. Later initializations are fast.
   // ModifyGraphWithDelegate will fail if data cannot be serialized.
   //
-  // NOTE: User also needs to set serialization_dir & model_token in
-  // TfLiteGpuDelegateOptionsV2.
+  // The serialized data holds the compiled programs and the tuned work group
+  // sizes. It records the GPU driver version, so it is rebuilt and overwritten
+  // the first time the delegate is applied after a driver update.
+  //
+  // NOTE: User also needs to set serialization_dir in
+  // TfLiteGpuDelegateOptionsV2, and optionally model_token.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
 };
@@ -133,8 +137,10 @@ typedef struct {
   // For an example of how to generate this from a TFLite model, see
   // StrFingerprint() in lite/delegates/serialization.h.
   //
-  // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(), which implies the
-  // delegate will not try serialization.
+  // Set to nullptr in TfLiteGpuDelegateOptionsV2Default(). If it is still
+  // nullptr when serialization is enabled, the delegate uses a fingerprint of
+  // the model's graph and constants instead (see ModelFingerprint() in
+  // lite/delegates/serialization.h), which costs a pass over the weights.
   const char* model_token;
 } TfLiteGpuDelegateOptionsV2;
 
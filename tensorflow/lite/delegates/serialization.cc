@@ -30,6 +30,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <vector>
@@ -77,6 +79,60 @@ std::string StrFingerprint(const void* data, const size_t num_bytes) {
       ::util::Fingerprint64(reinterpret_cast<const char*>(data), num_bytes));
 }
 
+std::string ModelFingerprint(TfLiteContext* context) {
+  uint64_t fingerprint = 0;
+  auto combine_ints = [&fingerprint](const std::vector<int32_t>& data) {
+    fingerprint = CombineFingerprints(
+        fingerprint,
+        ::util::Fingerprint64(reinterpret_cast<const char*>(data.data()),
+                                data.size() * sizeof(int32_t)));
+  };
+
+  std::vector<int32_t> tensor_data;
+  for (int i = 0; i < context->tensors_size; ++i) {
+    const TfLiteTensor& tensor = context->tensors[i];
+    tensor_data.push_back(tensor.type);
+    tensor_data.push_back(tensor.allocation_type);
+    if (tensor.dims) {
+      tensor_data.push_back(tensor.dims->size);
+      tensor_data.insert(tensor_data.end(), tensor.dims->data,
+                         tensor.dims->data + tensor.dims->size);
+    }
+    if (tensor.allocation_type == kTfLiteMmapRo && tensor.data.raw) {
+      fingerprint = CombineFingerprints(
+          fingerprint, ::util::Fingerprint64(tensor.data.raw, tensor.bytes));
+    }
+  }
+  combine_ints(tensor_data);
+
+  TfLiteIntArray* execution_plan = nullptr;
+  if (context->GetExecutionPlan(context, &execution_plan) == kTfLiteOk) {
+    std::vector<int32_t> node_data;
+    for (int i = 0; i < execution_plan->size; ++i) {
+      TfLiteNode* node = nullptr;
+      TfLiteRegistration* registration = nullptr;
+      if (context->GetNodeAndRegistration(context, execution_plan->data[i],
+                                          &node, &registration) != kTfLiteOk) {
+        continue;
+      }
+      node_data.push_back(registration->builtin_code);
+      node_data.push_back(registration->version);
+      if (registration->custom_name) {
+        const char* name = registration->custom_name;
+        fingerprint = CombineFingerprints(
+            fingerprint, ::util::Fingerprint64(name, strlen(name)));
+      }
+      for (const TfLiteIntArray* tensors : {node->inputs, node->outputs}) {
+        node_data.push_back(tensors->size);
+        node_data.insert(node_data.end(), tensors->data,
+                         tensors->data + tensors->size);
+      }
+    }
+    combine_ints(node_data);
+  }
+  return std::to_string(fingerprint);
+}
+
 SerializationEntry::SerializationEntry(const std::string& cache_dir,
                                        const std::string& model_token,
                                        const uint64_t fingerprint)
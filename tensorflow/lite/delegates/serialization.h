@@ -80,6 +80,15 @@ namespace delegates {
 //    model_token.
 std::string StrFingerprint(const void* data, const size_t num_bytes);
 
+// Returns a string fingerprint of the model loaded into `context`, computed
+// from the type and shape of every tensor, the data of read-only (constant)
+// tensors and the operator and connectivity of every node in the execution
+// plan. Delegates can use it as a model_token when the client doesn't provide
+// one. Must be called before the graph is modified by any delegate, i.e. from
+// the first delegate's TfLiteDelegate::Prepare, for the token to be stable.
+// Hashes all constant data, so the cost is linear in the model size.
+std::string ModelFingerprint(TfLiteContext* context);
+
 // Encapsulates a unique blob of data serialized by a delegate.
 // Needs to be initialized with a Serialization instance.
 // Any data set with this entry is 'keyed' by a 64-bit fingerprint unique to the
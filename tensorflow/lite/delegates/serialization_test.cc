@@ -232,6 +232,33 @@ TEST_F(SerializationTest, ModelTokenFingerprint) {
   ASSERT_EQ(entry1.GetFingerprint(), entry3.GetFingerprint());
 }
 
+TEST_F(SerializationTest, ModelFingerprint) {
+  // An empty execution plan, so that only the tensors are fingerprinted.
+  auto get_execution_plan = [](TfLiteContext*, TfLiteIntArray** plan) {
+    static TfLiteIntArray* empty_plan = TfLiteIntArrayCreate(0);
+    *plan = empty_plan;
+    return kTfLiteOk;
+  };
+  std::vector<float> weights1 = {1, 2, 3, 4};
+  std::vector<float> weights2 = {1, 2, 3, 5};
+  auto generate_context = [&](std::vector<float>* weights) {
+    TfLiteContext context = GenerateTfLiteContext(/*num_tensors*/ 4);
+    context.GetExecutionPlan = get_execution_plan;
+    context.tensors[0].allocation_type = kTfLiteMmapRo;
+    context.tensors[0].data.raw = reinterpret_cast<char*>(weights->data());
+    context.tensors[0].bytes = weights->size() * sizeof(float);
+    return context;
+  };
+  TfLiteContext context1 = generate_context(&weights1);
+  TfLiteContext context1_equivalent = generate_context(&weights1);
+  TfLiteContext context2 = generate_context(&weights2);
+
+  EXPECT_EQ(ModelFingerprint(&context1),
+            ModelFingerprint(&context1_equivalent));
+  // Models differing only in their constants have different fingerprints.
+  EXPECT_NE(ModelFingerprint(&context1), ModelFingerprint(&context2));
+}
+
 TEST_F(SerializationTest, SerializationData) {
   // Sample data to store in serialization.
   float value1 = 456.24;
@@ -29,7 +29,11 @@ class InterpreterOptions {
       : experimental_preserve_all_tensors_(false),
         experimental_ensure_dynamic_tensors_are_released_(false),
         experimental_optimize_memory_for_large_tensors_(0),
-        experimental_disable_delegate_clustering_(false) {}
+        experimental_disable_delegate_clustering_(false),
+        experimental_num_parallel_node_threads_(1),
+        experimental_optimize_memory_packing_(false),
+        experimental_incremental_resize_(false),
+        experimental_lazy_subgraph_initialization_(false) {}
 
   /// Preserving all intermediates tensors for debugging.
   /// WARNING: This is an experimental API and subject to change.
@@ -93,11 +97,79 @@ class InterpreterOptions {
     experimental_disable_delegate_clustering_ = value;
   }
 
+  /// Runs independent nodes of the execution plan concurrently on up to
+  /// `num_threads` threads, including the calling thread. Nodes are grouped
+  /// into stages whose nodes only depend on nodes of earlier stages, and the
+  /// memory plan keeps the tensors of a stage apart. Graphs with delegated or
+  /// control flow nodes, and invocations with dynamic tensors or a profiler,
+  /// are run sequentially. A value of 1 (the default) disables the feature.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetNumParallelNodeThreads(int num_threads) {
+    experimental_num_parallel_node_threads_ = num_threads;
+  }
+
+  /// Returns the number of threads used to run independent nodes concurrently.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetNumParallelNodeThreads() {
+    return experimental_num_parallel_node_threads_;
+  }
+
+  /// Makes the arena planner try several orders for packing tensors into the
+  /// arena and keep the one needing the least memory, at the cost of a slower
+  /// AllocateTensors(). Has no effect with the simple memory planner.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetOptimizeMemoryPacking(bool value) {
+    experimental_optimize_memory_packing_ = value;
+  }
+
+  /// Returns whether the arena planner searches for a smaller tensor packing.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetOptimizeMemoryPacking() {
+    return experimental_optimize_memory_packing_;
+  }
+
+  /// Speeds up `AllocateTensors()` after only input tensors were resized, e.g.
+  /// when the sequence length of a streaming model changes on every call.
+  /// Only nodes with an input whose shape changed since they were last
+  /// prepared are prepared again, and the arena plans of recently seen input
+  /// shapes are reused instead of being computed again.
+  /// This requires kernels whose `prepare` only depends on the shapes of their
+  /// inputs. It has no effect on subgraphs with delegates or dynamic tensors.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetIncrementalResize(bool value) {
+    experimental_incremental_resize_ = value;
+  }
+
+  /// Returns whether `AllocateTensors()` only re-prepares resized nodes.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetIncrementalResize() { return experimental_incremental_resize_; }
+
+  /// Defers parsing the tensors and nodes of the subgraphs of signatures, other
+  /// than the primary subgraph, until the signature is first used through
+  /// `GetSignatureRunner()`. This speeds up loading models with many
+  /// signatures of which only a few are run. Subgraphs which aren't the entry
+  /// point of a signature, e.g. control flow bodies, are still built eagerly.
+  /// The op resolver must outlive the interpreter when this is enabled.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetLazySubgraphInitialization(bool value) {
+    experimental_lazy_subgraph_initialization_ = value;
+  }
+
+  /// Returns whether signature subgraphs are built on first use.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetLazySubgraphInitialization() {
+    return experimental_lazy_subgraph_initialization_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_;
   bool experimental_ensure_dynamic_tensors_are_released_;
   int experimental_optimize_memory_for_large_tensors_;
   bool experimental_disable_delegate_clustering_;
+  int experimental_num_parallel_node_threads_;
+  bool experimental_optimize_memory_packing_;
+  bool experimental_incremental_resize_;
+  bool experimental_lazy_subgraph_initialization_;
 };
 
 }  // namespace tflite
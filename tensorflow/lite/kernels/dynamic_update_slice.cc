@@ -20,6 +20,8 @@ limitations under the License.
 
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/experimental/resource/resource_variable.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/internal/tensor.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
@@ -36,10 +38,32 @@ constexpr int kUpdateTensor = 1;
 constexpr int kStartIndicesTensor = 2;
 constexpr int kOutputTensor = 0;
 
+// When the operand is a resource variable, the update is written into the
+// variable's buffer in place and the output is the variable's resource id. This
+// keeps large stateful tensors, e.g. the key/value caches of autoregressive
+// decoders, from being copied in full on every invocation.
+TfLiteStatus PrepareResourceOperand(TfLiteContext* context,
+                                    const TfLiteTensor* operand,
+                                    const TfLiteTensor* start_indices,
+                                    TfLiteTensor* output) {
+  TF_LITE_ENSURE_EQ(context, NumElements(operand), 1);
+  TF_LITE_ENSURE(context, NumDimensions(start_indices) == 1);
+  TF_LITE_ENSURE_TYPES_EQ(context, start_indices->type, kTfLiteInt32);
+
+  // The output forwards the resource id, as in VAR_HANDLE.
+  output->type = kTfLiteResource;
+  const int kBytesRequired = sizeof(int32_t);
+  TfLiteTensorRealloc(kBytesRequired, output);
+  output->bytes = kBytesRequired;
+  return kTfLiteOk;
+}
+
 // TFLite DynamicUpdateSlice op follows the semantics of XLA DynamicUpdateSlice
 // op. See https://www.tensorflow.org/xla/operation_semantics#dynamicupdateslice
 // for details.
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
   const TfLiteTensor* operand;
   TF_LITE_ENSURE_OK(context,
                     GetInputSafe(context, node, kOperandTensor, &operand));
@@ -53,6 +77,10 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   TF_LITE_ENSURE_OK(context,
                     GetOutputSafe(context, node, kOutputTensor, &output));
 
+  if (operand->type == kTfLiteResource) {
+    return PrepareResourceOperand(context, operand, start_indices, output);
+  }
+
   // The shape of start_indices must be rank == 1, with dimension size equal to
   // the rank of operand.
   TF_LITE_ENSURE(context, NumDimensions(start_indices) == 1);
@@ -67,8 +95,6 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
                    SizeOfDimension(update, i) <= SizeOfDimension(operand, i));
   }
 
-  TF_LITE_ENSURE_EQ(context, NumInputs(node), 3);
-  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
   TF_LITE_ENSURE_TYPES_EQ(context, operand->type, update->type);
   TF_LITE_ENSURE_TYPES_EQ(context, start_indices->type, kTfLiteInt32);
 
@@ -120,8 +146,10 @@ void DynamicUpdateSlice(const TfLiteTensor* input, const TfLiteTensor* update,
   std::vector<int> clamped_start_indices =
       ClampStartIndices(input_dims, indices_data, input_shape, update_shape);
 
-  // Copies input to output first.
-  memcpy(output->data.raw, input->data.raw, input->bytes);
+  // Copies input to output first, unless the update happens in place.
+  if (output->data.raw != input->data.raw) {
+    memcpy(output->data.raw, input->data.raw, input->bytes);
+  }
 
   // Update tensor has no elements. Skip.
   if (update_shape.FlatSize() == 0) {
@@ -142,20 +170,9 @@ void DynamicUpdateSlice(const TfLiteTensor* input, const TfLiteTensor* update,
                      current_dim.data()));
 }
 
-TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
-  const TfLiteTensor* operand;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kOperandTensor, &operand));
-  const TfLiteTensor* update;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kUpdateTensor, &update));
-  const TfLiteTensor* indice;
-  TF_LITE_ENSURE_OK(context,
-                    GetInputSafe(context, node, kStartIndicesTensor, &indice));
-  TfLiteTensor* output;
-  TF_LITE_ENSURE_OK(context,
-                    GetOutputSafe(context, node, kOutputTensor, &output));
-
+TfLiteStatus EvalImpl(TfLiteContext* context, const TfLiteTensor* operand,
+                      const TfLiteTensor* update, const TfLiteTensor* indice,
+                      TfLiteTensor* output) {
   switch (operand->type) {
     case kTfLiteFloat32:
       DynamicUpdateSlice<float>(operand, update, indice, output);
@@ -183,6 +200,55 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
 
   return kTfLiteOk;
 }
+
+TfLiteStatus EvalResourceOperand(TfLiteContext* context,
+                                 const TfLiteTensor* operand,
+                                 const TfLiteTensor* update,
+                                 const TfLiteTensor* indice,
+                                 TfLiteTensor* output) {
+  Subgraph* subgraph = reinterpret_cast<Subgraph*>(context->impl_);
+  const int resource_id = operand->data.i32[0];
+  auto* variable =
+      resource::GetResourceVariable(&subgraph->resources(), resource_id);
+  TF_LITE_ENSURE(context, variable != nullptr);
+  // The variable has to be assigned first, e.g. with a zero-filled cache.
+  TfLiteTensor* variable_tensor = variable->GetTensor();
+  TF_LITE_ENSURE(context, variable_tensor != nullptr);
+
+  TF_LITE_ENSURE_TYPES_EQ(context, variable_tensor->type, update->type);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(update),
+                    NumDimensions(variable_tensor));
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(indice, 0),
+                    NumDimensions(variable_tensor));
+  for (int i = 0; i < NumDimensions(variable_tensor); i++) {
+    TF_LITE_ENSURE(context, SizeOfDimension(update, i) <=
+                                SizeOfDimension(variable_tensor, i));
+  }
+  TF_LITE_ENSURE_OK(context, EvalImpl(context, variable_tensor, update, indice,
+                                      variable_tensor));
+  output->data.i32[0] = resource_id;
+  return kTfLiteOk;
+}
+
+TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* operand;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kOperandTensor, &operand));
+  const TfLiteTensor* update;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kUpdateTensor, &update));
+  const TfLiteTensor* indice;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kStartIndicesTensor, &indice));
+  TfLiteTensor* output;
+  TF_LITE_ENSURE_OK(context,
+                    GetOutputSafe(context, node, kOutputTensor, &output));
+
+  if (operand->type == kTfLiteResource) {
+    return EvalResourceOperand(context, operand, update, indice, output);
+  }
+  return EvalImpl(context, operand, update, indice, output);
+}
 }  // namespace dynamic_update_slice
 
 TfLiteRegistration* Register_DYNAMIC_UPDATE_SLICE() {
@@ -165,6 +165,12 @@ inline TfLiteStatus CheckTypes(TfLiteContext* context,
                                   output->type == kTfLiteInt16);
       TF_LITE_ENSURE_EQ(context, is_optional_bias_int, true);
     }
+  } else if (filter->type == kTfLiteInt4) {
+    // Int4 weights are only supported for float activations, i.e. weight-only
+    // quantization.
+    TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_TYPES_EQ(context, output->type, kTfLiteFloat32);
+    TF_LITE_ENSURE_EQ(context, is_optional_bias_float, true);
   } else {
     // Only float32 is supported currently
     TF_LITE_ENSURE_TYPES_EQ(context, input->type, kTfLiteFloat32);
@@ -176,6 +182,35 @@ inline TfLiteStatus CheckTypes(TfLiteContext* context,
   return kTfLiteOk;
 }
 
+// Checks that int4 `filter` is symmetrically quantized with either a single
+// scale or `num_groups` scales per output channel, laid out as
+// [num_units, num_groups], where `num_groups` divides the accumulation depth.
+TfLiteStatus CheckInt4WeightQuantization(TfLiteContext* context,
+                                         const TfLiteTensor* filter) {
+  TF_LITE_ENSURE(context, filter->sparsity == nullptr);
+  TF_LITE_ENSURE_EQ(context, filter->quantization.type,
+                    kTfLiteAffineQuantization);
+  const auto* affine_quantization =
+      reinterpret_cast<const TfLiteAffineQuantization*>(
+          filter->quantization.params);
+  TF_LITE_ENSURE(context, affine_quantization);
+  TF_LITE_ENSURE(context, affine_quantization->scale);
+  const int num_scales = affine_quantization->scale->size;
+  if (num_scales > 1) {
+    const int num_units = SizeOfDimension(filter, 0);
+    const int accum_depth = SizeOfDimension(filter, 1);
+    TF_LITE_ENSURE_EQ(context, affine_quantization->quantized_dimension, 0);
+    TF_LITE_ENSURE_EQ(context, num_scales % num_units, 0);
+    TF_LITE_ENSURE_EQ(context, accum_depth % (num_scales / num_units), 0);
+  }
+  if (affine_quantization->zero_point) {
+    for (int i = 0; i < affine_quantization->zero_point->size; ++i) {
+      TF_LITE_ENSURE_EQ(context, affine_quantization->zero_point->data[i], 0);
+    }
+  }
+  return kTfLiteOk;
+}
+
 void* Init(TfLiteContext* context, const char* buffer, size_t length) {
   // This is a builtin op, so we don't use the contents in 'buffer', if any.
   // Instead, we allocate a new object to carry information from Prepare() to
@@ -258,6 +293,10 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node) {
     TF_LITE_ENSURE_EQ(context, NumElements(bias), SizeOfDimension(filter, 0));
   }
 
+  if (filter->type == kTfLiteInt4) {
+    TF_LITE_ENSURE_STATUS(CheckInt4WeightQuantization(context, filter));
+  }
+
   // Note that quantized inference requires that all tensors have their
   // parameters set. This is usually done during quantized training.
   if (input->type == kTfLiteUInt8 || input->type == kTfLiteInt8 ||
@@ -1021,8 +1060,17 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                 "Invalid quantized and sparse fully-connected format.");
             return kTfLiteError;
           }
-          if (sparsity.dim_metadata_size == kDimMetadataSizeBlockSparse &&
-              sparsity.dim_metadata[2].dense_size == 16) {
+          if (sparsity.dim_metadata_size == kDimMetadataSizeRandomSparse) {
+            // Random sparse, which includes 2:4 structured sparsity.
+            optimized_ops::FullyConnectedSparseWeight(
+                sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
+                filter_shape, GetTensorData<int8_t>(filter), bias_shape,
+                GetTensorData<int32_t>(bias), output_shape,
+                GetTensorData<int8_t>(output),
+                CpuBackendContext::GetFromContext(context));
+          } else if (sparsity.dim_metadata_size ==
+                         kDimMetadataSizeBlockSparse &&
+                     sparsity.dim_metadata[2].dense_size == 16) {
             // Block sparse with block size of 1x16.
             optimized_ops::FullyConnectedSparseWeight1x16(
                 sparsity, op_params, input_shape, GetTensorData<int8_t>(input),
@@ -1242,6 +1290,27 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
   return kTfLiteOk;
 }
 
+TfLiteStatus EvalInt4WeightOnly(TfLiteContext* context,
+                                TfLiteFullyConnectedParams* params,
+                                const TfLiteTensor* input,
+                                const TfLiteTensor* filter,
+                                const TfLiteTensor* bias,
+                                TfLiteTensor* output) {
+  FullyConnectedParams op_params;
+  CalculateActivationRange(params->activation, &op_params.float_activation_min,
+                           &op_params.float_activation_max);
+  const auto* affine_quantization =
+      reinterpret_cast<const TfLiteAffineQuantization*>(
+          filter->quantization.params);
+  reference_ops::FullyConnectedWithPackedInt4Weights(
+      op_params, GetTensorShape(input), GetTensorData<float>(input),
+      GetTensorShape(filter), GetTensorData<int8_t>(filter),
+      affine_quantization->scale->data, affine_quantization->scale->size,
+      GetTensorShape(bias), GetTensorData<float>(bias), GetTensorShape(output),
+      GetTensorData<float>(output));
+  return kTfLiteOk;
+}
+
 template <KernelType kernel_type>
 TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
   auto* params =
@@ -1300,6 +1369,13 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         TF_LITE_KERNEL_LOG(context, "Unhandled fully-connected weights format");
         return kTfLiteError;
       }
+    case kTfLiteInt4:
+      if (params->weights_format == kTfLiteFullyConnectedWeightsFormatDefault) {
+        return EvalInt4WeightOnly(context, params, input, filter, bias, output);
+      } else {
+        TF_LITE_KERNEL_LOG(context, "Unhandled fully-connected weights format");
+        return kTfLiteError;
+      }
     default:
       TF_LITE_KERNEL_LOG(context,
                          "Filter data type %s currently not supported.",
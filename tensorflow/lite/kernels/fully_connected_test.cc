@@ -1535,6 +1535,96 @@ TEST_P(FloatFullyConnectedOpTest, BlackBoxTest) {
   }
 }
 
+class Int4WeightOnlyFullyConnectedOpModel : public SingleOpModel {
+ public:
+  // `packed_weights` holds the int4 weights two to a byte, even elements in
+  // the low nibble. The buffer is padded to one byte per element, which is how
+  // int4 tensors are sized.
+  Int4WeightOnlyFullyConnectedOpModel(TfLiteRegistration* registration,
+                                      int units, int batches, int input_size,
+                                      std::vector<int8_t> packed_weights,
+                                      const std::vector<float>& scales) {
+    input_ = AddInput({TensorType_FLOAT32, {batches, input_size}});
+    packed_weights.resize(units * input_size);
+    AddConstInput({TensorType_INT4,
+                   {units, input_size},
+                   0,
+                   0,
+                   0,
+                   0,
+                   /*per_channel_quantization=*/true,
+                   scales,
+                   std::vector<int64_t>(scales.size(), 0),
+                   /*channel_index=*/0},
+                  packed_weights);
+    bias_ = AddInput({TensorType_FLOAT32, {units}});
+    output_ = AddOutput({TensorType_FLOAT32});
+    SetBuiltinOp(BuiltinOperator_FULLY_CONNECTED,
+                 BuiltinOptions_FullyConnectedOptions,
+                 CreateFullyConnectedOptions(builder_,
+                                             ActivationFunctionType_NONE)
+                     .Union());
+    resolver_ = std::make_unique<SingleOpResolver>(
+        BuiltinOperator_FULLY_CONNECTED, registration);
+    BuildInterpreter({GetShape(input_), {units, input_size}, GetShape(bias_)});
+  }
+
+  void SetBias(const std::vector<float>& f) { PopulateTensor(bias_, f); }
+  void SetInput(const std::vector<float>& f) { PopulateTensor(input_, f); }
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+  std::vector<int> GetOutputShape() { return GetTensorShape(output_); }
+
+ private:
+  int input_;
+  int bias_;
+  int output_;
+};
+
+// Weights, row by row, are {1, -2, 3, -8} and {7, 0, -1, 2}.
+const std::vector<int8_t>* const kPackedInt4Weights =
+    new std::vector<int8_t>({static_cast<int8_t>(0xE1),
+                             static_cast<int8_t>(0x83), 0x07, 0x2F});
+
+TEST_P(FloatFullyConnectedOpTest, Int4WeightOnlyPerChannel) {
+  Int4WeightOnlyFullyConnectedOpModel m(GetRegistration(), /*units=*/2,
+                                        /*batches=*/2, /*input_size=*/4,
+                                        *kPackedInt4Weights,
+                                        /*scales=*/{0.5, 0.25});
+  m.SetBias({1, -1});
+  m.SetInput({
+      1, 2, 3, 4,   // b = 0
+      -1, 0, 2, 1,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 2));
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 -12, 2,       //
+                                 -0.5, -2.75,  //
+                             })));
+}
+
+TEST_P(FloatFullyConnectedOpTest, Int4WeightOnlyPerGroup) {
+  // Groups of two weights per row, scaled by {0.5, 1} and {0.25, 2}.
+  Int4WeightOnlyFullyConnectedOpModel m(GetRegistration(), /*units=*/2,
+                                        /*batches=*/2, /*input_size=*/4,
+                                        *kPackedInt4Weights,
+                                        /*scales=*/{0.5, 1, 0.25, 2});
+  m.SetBias({1, -1});
+  m.SetInput({
+      1, 2, 3, 4,   // b = 0
+      -1, 0, 2, 1,  // b = 1
+  });
+
+  ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+  EXPECT_THAT(m.GetOutput(), ElementsAreArray(ArrayFloatNear({
+                                 -23.5, 10.75,  //
+                                 -1.5, -2.75,   //
+                             })));
+}
+
 template <typename T>
 class SparseFullyConnectedOpModel : public SingleOpModel {
  public:
@@ -2145,6 +2235,70 @@ TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestScaledInputOutput) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(-52, -50, -52));
 }
 
+TEST_P(SparseQuantizedFullyConnectedOpTest, Simple1x16TestMultiThreaded) {
+  std::vector<float> weight_data = {
+      1,  2,  3,  4,  -1, -2, -3, -4, 1,  2,  3,  4, -4, -3, -2, -1,  // u = 0
+      0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 0,  0,  0,  0,   // u = 1
+      -1, -2, -3, -4, 4,  3,  2,  1,  -1, -2, -3, 4, 1,  2,  3,  4,   // u = 2
+  };
+  TensorData weight = {TensorType_INT8, {3, 16}, 0, 0, 1};
+  weight.traversal_order = {0, 1, 2};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  weight.block_map = {1};
+  weight.block_size = {16};
+  for (int num_threads = 1; num_threads <= 4; num_threads++) {
+    SparseQuantizedFullyConnectedOpModel m(
+        GetRegistration(),
+        /*units=*/3, /*batches=*/3,
+        /*input=*/{TensorType_INT8, {3, 16}, 0, 0, 1}, weight, weight_data,
+        /*output=*/{TensorType_INT8, {}, 0, 0, 1},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+
+    m.SetBias({1, 2, 3});
+    m.SetInput({
+        1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,  // b = 0
+        4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1, 4, 3, 2, 1,  // b = 1
+        1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4, 1, 2, 3, 4,  // b = 2
+    });
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(3, 3));
+    EXPECT_THAT(m.GetOutput(), ElementsAre(11, 2, 25, 0, 2, 21, 11, 2, 25));
+  }
+}
+
+TEST_P(SparseQuantizedFullyConnectedOpTest, SimpleRandomSparseTest) {
+  // 2:4 structured sparsity: every group of four weights has two non-zeros.
+  std::vector<float> weight_data = {
+      1, 0,  2, 0,  0,  3, 0, -1,  // u = 0
+      0, -2, 0, 1,  1,  0, 0, 2,   // u = 1
+      0, 0,  3, -1, -2, 0, 1, 0,   // u = 2
+  };
+  TensorData weight = {TensorType_INT8, {3, 8}, 0, 0, 1};
+  weight.traversal_order = {0, 1};
+  weight.format = {kTfLiteDimDense, kTfLiteDimSparseCSR};
+  for (int num_threads = 1; num_threads <= 2; num_threads++) {
+    SparseQuantizedFullyConnectedOpModel m(
+        GetRegistration(),
+        /*units=*/3, /*batches=*/2,
+        /*input=*/{TensorType_INT8, {2, 8}, 0, 0, 1}, weight, weight_data,
+        /*output=*/{TensorType_INT8, {}, 0, 0, 1},
+        /*bias_tensor_optional=*/false, /*num_threads=*/num_threads);
+
+    m.SetBias({1, 2, 3});
+    m.SetInput({
+        1, 2, 3, 4, 5, 6, 7, 8,  // b = 0
+        8, 7, 6, 5, 4, 3, 2, 1,  // b = 1
+    });
+
+    ASSERT_EQ(m.Invoke(), kTfLiteOk);
+
+    EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+    EXPECT_THAT(m.GetOutput(), ElementsAre(18, 23, 5, 29, 0, 10));
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(
     SparseQuantizedFullyConnectedOpTest, SparseQuantizedFullyConnectedOpTest,
     ::testing::ValuesIn(SingleOpTest::GetKernelTags(*kKernelMapNoPie)));
@@ -112,6 +112,57 @@ inline void FullyConnectedSparseWeight1x16Impl(
       output_data + thread_start * output_depth);
 }
 
+// Quantized kernel for unblocked CSR weights, e.g. 2:4 structured sparsity,
+// where every group of four consecutive weights holds at most two non-zeros.
+inline void FullyConnectedSparseWeightInt8Impl(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data, int thread_start,
+    int thread_end, const CpuBackendContext& cpu_backend_context) {
+  ruy::profiler::ScopeLabel label("FullyConnected");
+  ruy::profiler::ScopeLabel inner_label("Random Sparse");
+
+  const int input_dims_count = input_shape.DimensionsCount();
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int weights_dims_count = weights_shape.DimensionsCount();
+  const int input_depth = MatchingDim(weights_shape, weights_dims_count - 1,
+                                      input_shape, input_dims_count - 1);
+  const int output_depth = MatchingDim(weights_shape, weights_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+  const int32_t input_offset = params.input_offset;
+  const int32_t output_offset = params.output_offset;
+  const int32_t output_multiplier = params.output_multiplier;
+  const int32_t output_shift = params.output_shift;
+  const int32_t output_activation_min = params.quantized_activation_min;
+  const int32_t output_activation_max = params.quantized_activation_max;
+
+  const int w0_size = sparsity.dim_metadata[0].dense_size;
+  const int* w1_segments = sparsity.dim_metadata[1].array_segments->data;
+  const int* w1_indices = sparsity.dim_metadata[1].array_indices->data;
+
+  for (int b = thread_start; b < thread_end; ++b) {
+    const int8_t* input_in_batch = input_data + b * input_depth;
+    for (int idx_0 = 0; idx_0 < w0_size; ++idx_0) {
+      int32_t acc = 0;
+      int32_t weights_sum = 0;
+      for (int pw1 = w1_segments[idx_0]; pw1 < w1_segments[idx_0 + 1]; ++pw1) {
+        const int32_t weight = weights_data[pw1];
+        acc += weight * input_in_batch[w1_indices[pw1]];
+        weights_sum += weight;
+      }
+      acc += weights_sum * input_offset;
+      if (bias_data) acc += bias_data[idx_0];
+      acc = MultiplyByQuantizedMultiplier(acc, output_multiplier, output_shift);
+      acc += output_offset;
+      output_data[b * output_depth + idx_0] = static_cast<int8_t>(
+          ActivationFunctionWithMinMax(acc, output_activation_min,
+                                       output_activation_max));
+    }
+  }
+}
+
 inline void FullyConnectedSparseWeight1x4Impl(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const float* input_data,
@@ -196,6 +247,97 @@ struct FullyConnectedSparseWeight1x4Task : cpu_backend_threadpool::Task {
   const CpuBackendContext& cpu_backend_context;
 };
 
+// Runs one of the quantized sparse kernels above on a slice of the batches.
+struct FullyConnectedSparseWeightInt8Task : cpu_backend_threadpool::Task {
+  using Impl = void (*)(const TfLiteSparsity&, const FullyConnectedParams&,
+                        const RuntimeShape&, const int8_t*,
+                        const RuntimeShape&, const int8_t*,
+                        const RuntimeShape&, const int32_t*,
+                        const RuntimeShape&, int8_t*, int, int,
+                        const CpuBackendContext&);
+
+  FullyConnectedSparseWeightInt8Task(
+      Impl impl, const TfLiteSparsity& sparsity,
+      const FullyConnectedParams& params, const RuntimeShape& input_shape,
+      const int8_t* input_data, const RuntimeShape& weights_shape,
+      const int8_t* weights_data, const RuntimeShape& bias_shape,
+      const int32_t* bias_data, const RuntimeShape& output_shape,
+      int8_t* output_data, int thread_start, int thread_end,
+      const CpuBackendContext& cpu_backend_context_x)
+      : impl(impl),
+        sparsity(sparsity),
+        params(params),
+        input_shape(input_shape),
+        input_data(input_data),
+        weights_shape(weights_shape),
+        weights_data(weights_data),
+        bias_shape(bias_shape),
+        bias_data(bias_data),
+        output_shape(output_shape),
+        output_data(output_data),
+        thread_start(thread_start),
+        thread_end(thread_end),
+        cpu_backend_context(cpu_backend_context_x) {}
+
+  void Run() override {
+    impl(sparsity, params, input_shape, input_data, weights_shape,
+         weights_data, bias_shape, bias_data, output_shape, output_data,
+         thread_start, thread_end, cpu_backend_context);
+  }
+
+ private:
+  Impl impl;
+  const TfLiteSparsity& sparsity;
+  const FullyConnectedParams& params;
+  const RuntimeShape& input_shape;
+  const int8_t* input_data;
+  const RuntimeShape& weights_shape;
+  const int8_t* weights_data;
+  const RuntimeShape& bias_shape;
+  const int32_t* bias_data;
+  const RuntimeShape& output_shape;
+  int8_t* output_data;
+  int thread_start;
+  int thread_end;
+  const CpuBackendContext& cpu_backend_context;
+};
+
+// Slices the batches of a quantized sparse fully connected op over the
+// threads of `cpu_backend_context`, like FullyConnectedSparseWeight1x4.
+inline void FullyConnectedSparseWeightInt8MultiThreaded(
+    FullyConnectedSparseWeightInt8Task::Impl impl,
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  const int max_threads = cpu_backend_context->max_num_threads();
+  const int batches =
+      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
+  const int thread_count = std::max(1, std::min(batches, max_threads));
+  if (thread_count == 1) {
+    return impl(sparsity, params, input_shape, input_data, weights_shape,
+                weights_data, bias_shape, bias_data, output_shape, output_data,
+                0, batches, *cpu_backend_context);
+  }
+  std::vector<FullyConnectedSparseWeightInt8Task> tasks;
+  tasks.reserve(thread_count);
+  int thread_start = 0;
+  for (int i = 0; i < thread_count; ++i) {
+    int thread_end = thread_start + batches / thread_count;
+    if (i < batches % thread_count) thread_end++;
+
+    tasks.emplace_back(impl, sparsity, params, input_shape, input_data,
+                       weights_shape, weights_data, bias_shape, bias_data,
+                       output_shape, output_data, thread_start, thread_end,
+                       *cpu_backend_context);
+    thread_start = thread_end;
+  }
+  cpu_backend_threadpool::Execute(tasks.size(), tasks.data(),
+                                  cpu_backend_context);
+}
+
 inline void FullyConnectedSparseWeight1x16(
     const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
     const RuntimeShape& input_shape, const int8_t* input_data,
@@ -206,14 +348,26 @@ inline void FullyConnectedSparseWeight1x16(
   const int output_elements = output_shape.FlatSize();
   memset(output_data, 0, output_elements * sizeof(int8_t));
 
-  const int batches =
-      FlatSizeSkipDim(output_shape, output_shape.DimensionsCount() - 1);
+  FullyConnectedSparseWeightInt8MultiThreaded(
+      FullyConnectedSparseWeight1x16Impl, sparsity, params, input_shape,
+      input_data, weights_shape, weights_data, bias_shape, bias_data,
+      output_shape, output_data, cpu_backend_context);
+}
+
+inline void FullyConnectedSparseWeight(
+    const TfLiteSparsity& sparsity, const FullyConnectedParams& params,
+    const RuntimeShape& input_shape, const int8_t* input_data,
+    const RuntimeShape& weights_shape, const int8_t* weights_data,
+    const RuntimeShape& bias_shape, const int32_t* bias_data,
+    const RuntimeShape& output_shape, int8_t* output_data,
+    CpuBackendContext* cpu_backend_context) {
+  const int output_elements = output_shape.FlatSize();
+  memset(output_data, 0, output_elements * sizeof(int8_t));
 
-  // TODO(b/220851507): Add multi-thread support for quantized sparse kernel.
-  return FullyConnectedSparseWeight1x16Impl(
-      sparsity, params, input_shape, input_data, weights_shape, weights_data,
-      bias_shape, bias_data, output_shape, output_data, 0, batches,
-      *cpu_backend_context);
+  FullyConnectedSparseWeightInt8MultiThreaded(
+      FullyConnectedSparseWeightInt8Impl, sparsity, params, input_shape,
+      input_data, weights_shape, weights_data, bias_shape, bias_data,
+      output_shape, output_data, cpu_backend_context);
 }
 
 // The multi-threaded kernel slices the workload along the batch dimension. If
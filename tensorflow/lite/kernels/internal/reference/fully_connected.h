@@ -317,6 +317,65 @@ inline void ShuffledFullyConnected(
   }
 }
 
+// Weight-only quantized fully connected layer: float activations times int4
+// weights packed two to a byte, with the even element of each pair in the low
+// nibble (see tensor_utils::UnpackDenseInt4IntoInt8). The weights are
+// symmetrically quantized in groups of `accum_depth / num_groups` consecutive
+// elements of a row, where `num_groups` is `num_filter_scales / output_depth`,
+// and group `g` of row `c` has scale `filter_scales[c * num_groups + g]`. A
+// single scale applies to all weights. Weights are dequantized on the fly, so
+// they are read from memory at half a byte per element.
+inline void FullyConnectedWithPackedInt4Weights(
+    const FullyConnectedParams& params, const RuntimeShape& input_shape,
+    const float* input_data, const RuntimeShape& filter_shape,
+    const int8_t* filter_data, const float* filter_scales,
+    int num_filter_scales, const RuntimeShape& bias_shape,
+    const float* bias_data, const RuntimeShape& output_shape,
+    float* output_data) {
+  const float output_activation_min = params.float_activation_min;
+  const float output_activation_max = params.float_activation_max;
+  const int output_dims_count = output_shape.DimensionsCount();
+  const int filter_dims_count = filter_shape.DimensionsCount();
+  const int batches = FlatSizeSkipDim(output_shape, output_dims_count - 1);
+  const int output_depth = MatchingDim(filter_shape, filter_dims_count - 2,
+                                       output_shape, output_dims_count - 1);
+  const int accum_depth = filter_shape.Dims(filter_dims_count - 1);
+  const bool is_per_tensor = num_filter_scales == 1;
+  const int num_groups = is_per_tensor ? 1 : num_filter_scales / output_depth;
+  const int group_size = accum_depth / num_groups;
+  TFLITE_DCHECK_EQ(num_groups * group_size, accum_depth);
+  for (int b = 0; b < batches; ++b) {
+    const float* input_row = input_data + b * accum_depth;
+    for (int out_c = 0; out_c < output_depth; ++out_c) {
+      float total = 0.f;
+      for (int g = 0; g < num_groups; ++g) {
+        const int begin = g * group_size;
+        // Accumulate the integer weights of the group and apply its scale
+        // once.
+        float group_total = 0.f;
+        for (int d = begin; d < begin + group_size; ++d) {
+          const int index = out_c * accum_depth + d;
+          const int8_t packed = filter_data[index >> 1];
+          // Shift left first so that the sign of the low nibble is extended.
+          const int8_t weight = (index & 1)
+                                    ? static_cast<int8_t>(packed >> 4)
+                                    : static_cast<int8_t>(
+                                          static_cast<int8_t>(packed << 4) >> 4);
+          group_total += input_row[d] * weight;
+        }
+        total += group_total *
+                 filter_scales[is_per_tensor ? 0 : out_c * num_groups + g];
+      }
+      float bias_value = 0.0f;
+      if (bias_data) {
+        bias_value = bias_data[out_c];
+      }
+      output_data[out_c + output_depth * b] = ActivationFunctionWithMinMax(
+          total + bias_value, output_activation_min, output_activation_max);
+    }
+  }
+}
+
 }  // namespace reference_ops
 }  // namespace tflite
 
@@ -178,6 +178,9 @@ inline float GetTensorScale(const TfLiteTensor* tensor) {
 //   activation                                 - activation to use.
 //   is_input_all_zeros, is_aux_input_all_zeros - if input vectors are all zero.
 //   use_layer_norm                             - if doing layer norm LSTM.
+//   input_projection - if not null, the precomputed W_input * input (+ bias
+//                      without layer norm), size n_batch * n_cell. The input
+//                      and auxiliary input are then ignored.
 inline void CalculateLstmGateFloat(
     const float* input, const float* input_to_gate_weights,
     const float* aux_input, const float* aux_input_to_gate_weights,
@@ -188,21 +191,24 @@ inline void CalculateLstmGateFloat(
     const int n_output, const int n_cell,
     const TfLiteFusedActivation activation, float* gate,
     const bool is_input_all_zeros, const bool is_aux_input_all_zeros,
-    float* output, CpuBackendContext* context) {
+    const float* input_projection, float* output, CpuBackendContext* context) {
   const bool use_peephole = (cell_to_gate_weights != nullptr);
   const bool use_layer_norm = (layer_norm_coefficients != nullptr);
+  const bool use_input_projection = (input_projection != nullptr);
 
-  // Initialize scratch buffers with bias for regular lstm or initialize with
-  // zero for layer norm lstm.
-  if (use_layer_norm) {
+  // Initialize scratch buffers with the precomputed input contribution, with
+  // bias for regular lstm or with zero for layer norm lstm.
+  if (use_input_projection) {
+    std::copy_n(input_projection, n_cell * n_batch, gate);
+  } else if (use_layer_norm) {
     std::fill_n(gate, n_cell * n_batch, 0.0f);
   } else {
     tensor_utils::VectorBatchVectorAssign(gate_bias, n_cell, n_batch, gate);
   }
   // For each batch and cell: compute input_weight * input.
-  // Skip if input is all zeros.
+  // Skip if input is all zeros or already accounted for.
   float* accumulation_buffer = gate;
-  if (!is_input_all_zeros) {
+  if (!is_input_all_zeros && !use_input_projection) {
     MatrixBatchVectorMultiplyAccumulate(input_to_gate_weights, input,
                                         accumulation_buffer, output, n_cell,
                                         n_input, n_batch, context);
@@ -210,7 +216,7 @@ inline void CalculateLstmGateFloat(
   }
   // For each batch and cell: compute aux_input_weight * aux_input.
   // Skip if auxiliary input is not available or all zeros.
-  if (!is_aux_input_all_zeros) {
+  if (!is_aux_input_all_zeros && !use_input_projection) {
     MatrixBatchVectorMultiplyAccumulate(aux_input_to_gate_weights, aux_input,
                                         accumulation_buffer, output, n_cell,
                                         n_aux_input, n_batch, context);
@@ -237,6 +243,33 @@ inline void CalculateLstmGateFloat(
                                         gate);
 }
 
+// Calculates the input contribution to a single LSTM gate for `n_rows` input
+// vectors at once, e.g. for all steps of a sequence:
+//   input_projection = W_input * input + bias
+// The bias is left out with layer norm, where it's added after normalization.
+//
+// Parameters:
+//  - input: input vectors, size n_rows * n_input.
+//  - input_to_gate_weights: size n_cell * n_input.
+//  - gate_bias: size n_cell, ignored with layer norm.
+//  - input_projection: output vectors, size n_rows * n_cell.
+void CalculateLstmGateInputProjectionFloat(
+    const float* input, const float* input_to_gate_weights,
+    const float* gate_bias, const bool use_layer_norm, const int n_rows,
+    const int n_input, const int n_cell, float* input_projection,
+    CpuBackendContext* context) {
+  tflite::FullyConnectedParams float_fc_params;
+  float_fc_params.float_activation_min = std::numeric_limits<float>::lowest();
+  float_fc_params.float_activation_max = std::numeric_limits<float>::max();
+  float_fc_params.lhs_cacheable = true;
+  float_fc_params.rhs_cacheable = false;
+  tflite::optimized_ops::FullyConnected(
+      float_fc_params, tflite::RuntimeShape({n_rows, n_input}), input,
+      tflite::RuntimeShape({n_cell, n_input}), input_to_gate_weights,
+      tflite::RuntimeShape({n_cell}), use_layer_norm ? nullptr : gate_bias,
+      tflite::RuntimeShape({n_rows, n_cell}), input_projection, context);
+}
+
 // Updates the LSTM cell state, used by both float and hybrid LSTM versions.
 //
 // Implements the following formula:
@@ -850,6 +883,12 @@ void CalculateLstmOutputInteger8x8_8(
 // for bidirectional LSTMs with merge_outputs. In this case, the batched
 // operations cannot be used since they assume that the batched outputs are
 // contiguous, and we manually loop over the batched outputs.
+//
+// If input_projection_ptr is not null, it points to the precomputed input
+// contributions to the gates of this step, see
+// CalculateLstmGateInputProjectionFloat, for the forget, cell, output and
+// (without CIFG) input gates, input_projection_gate_stride apart. The input
+// and auxiliary input are then not used.
 // LINT.IfChange
 inline void LstmStepFloat(
     const float* input_ptr, const float* input_to_input_weights_ptr,
@@ -878,7 +917,8 @@ inline void LstmStepFloat(
     int n_aux_input, int n_output, int output_batch_leading_dim,
     float* output_state_ptr, float* cell_state_ptr, float* scratch0,
     float* scratch1, float* scratch2, float* scratch3, float* scratch4,
-    float* output_ptr, CpuBackendContext* context) {
+    float* output_ptr, const float* input_projection_ptr,
+    int input_projection_gate_stride, CpuBackendContext* context) {
   ruy::profiler::ScopeLabel label("LstmStepFloat");
   // Since we have already checked that weights are all there or none, we can
   // check the existence of only one to the get the condition.
@@ -891,12 +931,20 @@ inline void LstmStepFloat(
   float* output_gate_scratch = scratch3;
   float* accumulation_scratch_buffer = scratch4;
 
-  // Check if inputs are all zeros so we can skip some computations.
+  // Check if inputs are all zeros so we can skip some computations. The inputs
+  // aren't used at all if their contributions were precomputed.
+  const bool use_input_projection = (input_projection_ptr != nullptr);
   const bool is_input_all_zeros =
+      use_input_projection ||
       tensor_utils::IsZeroVector(input_ptr, n_batch * n_input);
   const bool is_aux_input_all_zeros =
-      (aux_input_ptr == nullptr ||
+      (use_input_projection || aux_input_ptr == nullptr ||
        tensor_utils::IsZeroVector(aux_input_ptr, n_batch * n_aux_input));
+  auto gate_input_projection = [&](int gate) -> const float* {
+    return use_input_projection
+               ? input_projection_ptr + gate * input_projection_gate_stride
+               : nullptr;
+  };
 
   if (!use_cifg) {
     // Calculate the input gate. (If not CIFG.)
@@ -910,6 +958,7 @@ inline void LstmStepFloat(
                            n_output, n_cell,
                            /*activation=*/kTfLiteActSigmoid, input_gate_scratch,
                            is_input_all_zeros, is_aux_input_all_zeros,
+                           gate_input_projection(3),
                            accumulation_scratch_buffer, context);
   }
   // Calculate the forget gate.
@@ -922,7 +971,8 @@ inline void LstmStepFloat(
       forget_layer_norm_coefficients_ptr, forget_gate_bias_ptr, n_batch,
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, forget_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros, accumulation_scratch_buffer, context);
+      is_aux_input_all_zeros, gate_input_projection(0),
+      accumulation_scratch_buffer, context);
   // Calculate the cell update gate.
   CalculateLstmGateFloat(
       input_ptr, input_to_cell_weights_ptr, aux_input_ptr,
@@ -933,7 +983,8 @@ inline void LstmStepFloat(
       /*cell_to_gate_weights=*/nullptr, cell_layer_norm_coefficients_ptr,
       cell_gate_bias_ptr, n_batch, n_input, n_aux_input, n_output, n_cell,
       params->activation, cell_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros, accumulation_scratch_buffer, context);
+      is_aux_input_all_zeros, gate_input_projection(1),
+      accumulation_scratch_buffer, context);
   // Update the cell state.
   UpdateLstmCellFloat(n_batch, n_cell, cell_state_ptr, input_gate_scratch,
                       forget_gate_scratch, cell_gate_scratch, use_cifg,
@@ -948,7 +999,8 @@ inline void LstmStepFloat(
       output_layer_norm_coefficients_ptr, output_gate_bias_ptr, n_batch,
       n_input, n_aux_input, n_output, n_cell,
       /*activation=*/kTfLiteActSigmoid, output_gate_scratch, is_input_all_zeros,
-      is_aux_input_all_zeros, accumulation_scratch_buffer, context);
+      is_aux_input_all_zeros, gate_input_projection(2),
+      accumulation_scratch_buffer, context);
   // Update the output state.
   CalculateLstmOutputFloat(n_batch, n_cell, n_output, cell_state_ptr,
                            output_gate_scratch, params->activation,
@@ -1814,6 +1866,40 @@ TfLiteStatus EvalFloat(
     accumulation_scratch_buffer = scratch_buffer_ptr + 4 * n_cell * n_batch;
   }
 
+  // If the scratch buffer has room for them after the gate and accumulation
+  // buffers, compute the input contributions to the gates of all steps upfront,
+  // with one large matrix multiplication per gate. The i-th input vector, in
+  // memory order, contributes to row i of each gate's projection.
+  const int input_projection_size =
+      InputProjectionScratchSize(n_batch, n_cell, max_time, use_cifg);
+  const int input_projection_gate_stride = max_time * n_batch * n_cell;
+  const int gates_and_accumulation_size =
+      n_batch * ((use_cifg ? 3 : 4) * n_cell + std::max(n_cell, n_output));
+  const int scratch_buffer_size = scratch_buffer->bytes / sizeof(float);
+  float* input_projection = nullptr;
+  if (aux_input == nullptr && max_time > 1 &&
+      scratch_buffer_size >=
+          gates_and_accumulation_size + input_projection_size) {
+    input_projection =
+        scratch_buffer_ptr + scratch_buffer_size - input_projection_size;
+    const float* gate_weights[] = {
+        GetTensorData<float>(input_to_forget_weights),
+        GetTensorData<float>(input_to_cell_weights),
+        GetTensorData<float>(input_to_output_weights),
+        GetTensorData<float>(input_to_input_weights)};
+    const float* gate_biases[] = {GetTensorData<float>(forget_gate_bias),
+                                  GetTensorData<float>(cell_gate_bias),
+                                  GetTensorData<float>(output_gate_bias),
+                                  GetTensorData<float>(input_gate_bias)};
+    for (int gate = 0; gate < (use_cifg ? 3 : 4); ++gate) {
+      CalculateLstmGateInputProjectionFloat(
+          GetTensorData<float>(input), gate_weights[gate], gate_biases[gate],
+          /*use_layer_norm=*/forget_layer_norm_coefficients != nullptr,
+          max_time * n_batch, n_input, n_cell,
+          input_projection + gate * input_projection_gate_stride, context);
+    }
+  }
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1831,6 +1917,9 @@ TfLiteStatus EvalFloat(
       }
       float* output_ptr =
           GetTensorData<float>(output) + t_rel * output_step + output_offset;
+      const float* input_projection_ptr =
+          input_projection ? input_projection + t_rel * n_batch * n_cell
+                           : nullptr;
 
       LstmStepFloat(
           input_ptr, GetTensorData<float>(input_to_input_weights),
@@ -1862,7 +1951,7 @@ TfLiteStatus EvalFloat(
           GetTensorData<float>(output_state), GetTensorData<float>(cell_state),
           input_gate_scratch, forget_gate_scratch, cell_gate_scratch,
           output_gate_scratch, accumulation_scratch_buffer, output_ptr,
-          context);
+          input_projection_ptr, input_projection_gate_stride, context);
     }
   } else {
     for (int b = 0; b < n_batch; b++) {
@@ -1882,6 +1971,9 @@ TfLiteStatus EvalFloat(
         }
         float* output_ptr = GetTensorData<float>(output) +
                             time_offset * output_step + output_offset;
+        const float* input_projection_ptr =
+            input_projection ? input_projection + time_offset * n_cell
+                             : nullptr;
 
         // Offset the {output,cell}_state pointers to the right batch.
         float* output_state_ptr =
@@ -1924,7 +2016,7 @@ TfLiteStatus EvalFloat(
             output_state_ptr, cell_state_ptr, input_gate_scratch_ptr,
             forget_gate_scratch_ptr, cell_gate_scratch_ptr,
             output_gate_scratch_ptr, accumulation_scratch_buffer, output_ptr,
-            context);
+            input_projection_ptr, input_projection_gate_stride, context);
       }
     }
   }
@@ -95,6 +95,16 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// Returns the number of floats that EvalFloat needs at the end of its scratch
+// buffer, in addition to the gate buffers, to compute the input contribution
+// to the gates for all `max_time` steps upfront: one matrix multiplication per
+// gate for the whole sequence instead of one per gate and step. EvalFloat
+// only does so when the scratch buffer is large enough.
+inline int InputProjectionScratchSize(int n_batch, int n_cell, int max_time,
+                                      bool use_cifg) {
+  return (use_cifg ? 3 : 4) * max_time * n_batch * n_cell;
+}
+
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
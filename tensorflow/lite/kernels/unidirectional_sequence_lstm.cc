@@ -980,6 +980,17 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     // accumulation buffer and an extra 16 bytes to avoid internal ruy copies.
     scratch_buffer_size->data[1] = n_cell * 5 + 16;
   }
+  if (input->type == kTfLiteFloat32 &&
+      input_to_output_weights->type == kTfLiteFloat32) {
+    // Reserve space for the input contributions to the gates of all steps,
+    // which lstm_eval::EvalFloat then computes in one go.
+    const int max_time =
+        time_major ? input->dims->data[0] : input->dims->data[1];
+    if (max_time > 1) {
+      scratch_buffer_size->data[1] += lstm_eval::InputProjectionScratchSize(
+          /*n_batch=*/1, n_cell, max_time, use_cifg);
+    }
+  }
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
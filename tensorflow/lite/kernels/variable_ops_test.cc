@@ -14,12 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include <stdint.h>
 
+#include <algorithm>
 #include <memory>
 
 #include <gtest/gtest.h>
 #include "flatbuffers/flexbuffers.h"  // from @flatbuffers
 #include "tensorflow/lite/core/c/builtin_op_data.h"
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/experimental/resource/resource_variable.h"
 #include "tensorflow/lite/kernels/builtin_op_kernels.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 
@@ -140,6 +142,45 @@ class VariableOpsTest : public ::testing::Test {
                                         read_registration_, &node_index);
   }
 
+  // Constructs a graph that updates a [4, 2] cache in place:
+  //   Input: %0 (initial cache), %2 (update), %3 (start indices)
+  //   Output: %5
+  //   %1 = var_handle()
+  //   variable_assign(%1, %0)
+  //   %4 = dynamic_update_slice(%1, %2, %3)
+  //   %5 = read(%4)
+  void ConstructInPlaceUpdateGraph() {
+    interpreter_ = std::make_unique<Interpreter>();
+    int first_new_tensor_index;
+    ASSERT_EQ(interpreter_->AddTensors(6, &first_new_tensor_index), kTfLiteOk);
+    ASSERT_EQ(interpreter_->SetInputs({0, 2, 3}), kTfLiteOk);
+    ASSERT_EQ(interpreter_->SetOutputs({5}), kTfLiteOk);
+    interpreter_->SetTensorParametersReadWrite(0, kTfLiteFloat32, "", {4, 2},
+                                               TfLiteQuantization());
+    interpreter_->SetTensorParametersReadWrite(1, kTfLiteResource, "", 0,
+                                               nullptr, {}, false);
+    interpreter_->SetTensorParametersReadWrite(2, kTfLiteFloat32, "", {1, 2},
+                                               TfLiteQuantization());
+    interpreter_->SetTensorParametersReadWrite(3, kTfLiteInt32, "", {2},
+                                               TfLiteQuantization());
+    interpreter_->SetTensorParametersReadWrite(4, kTfLiteResource, "", 0,
+                                               nullptr, {}, false);
+    interpreter_->SetTensorParametersReadWrite(5, kTfLiteFloat32, "", {4, 2},
+                                               TfLiteQuantization());
+    int node_index;
+
+    TfLiteVarHandleParams* var_handle_params = GetVarHandleParams();
+    interpreter_->AddNodeWithParameters({}, {1}, nullptr, 0, var_handle_params,
+                                        var_handle_registration_, &node_index);
+    interpreter_->AddNodeWithParameters({1, 0}, {}, nullptr, 0, nullptr,
+                                        assign_registration_, &node_index);
+    interpreter_->AddNodeWithParameters(
+        {1, 2, 3}, {4}, nullptr, 0, nullptr,
+        ::tflite::ops::builtin::Register_DYNAMIC_UPDATE_SLICE(), &node_index);
+    interpreter_->AddNodeWithParameters({4}, {5}, nullptr, 0, nullptr,
+                                        read_registration_, &node_index);
+  }
+
   TfLiteRegistration* assign_registration_;
   TfLiteRegistration* read_registration_;
   TfLiteRegistration* var_handle_registration_;
@@ -221,5 +262,33 @@ TEST_F(VariableOpsTest, TestReassignToDifferentSize) {
   }
 }
 
+TEST_F(VariableOpsTest, TestDynamicUpdateSliceInPlace) {
+  ConstructInPlaceUpdateGraph();
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  float* cache = GetTensorData<float>(interpreter_->tensor(0));
+  std::fill(cache, cache + 8, 0.0f);
+  float* update = GetTensorData<float>(interpreter_->tensor(2));
+  update[0] = 1;
+  update[1] = 2;
+  int32_t* start_indices = GetTensorData<int32_t>(interpreter_->tensor(3));
+  start_indices[0] = 2;
+  start_indices[1] = 0;
+  ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+
+  TfLiteTensor* output = interpreter_->tensor(5);
+  ASSERT_EQ(output->dims->size, 2);
+  EXPECT_EQ(GetTensorData<float>(output)[4], 1);
+  EXPECT_EQ(GetTensorData<float>(output)[5], 2);
+
+  // The updated row is written into the variable's own buffer.
+  const int resource_id = GetTensorData<int32_t>(interpreter_->tensor(1))[0];
+  auto* variable = resource::GetResourceVariable(
+      &interpreter_->primary_subgraph().resources(), resource_id);
+  ASSERT_NE(variable, nullptr);
+  EXPECT_EQ(GetTensorData<float>(variable->GetTensor())[4], 1);
+  EXPECT_EQ(GetTensorData<float>(variable->GetTensor())[5], 2);
+  EXPECT_EQ(GetTensorData<float>(variable->GetTensor())[0], 0);
+}
+
 }  // namespace
 }  // namespace tflite
@@ -36,6 +36,15 @@ class MemoryPlanner {
   // [first_node, last_node].
   virtual TfLiteStatus ExecuteAllocations(int first_node, int last_node) = 0;
 
+  // Declares that the nodes of the execution plan may run concurrently within
+  // stages: `stage_first_node[i]` and `stage_last_node[i]` are the first and
+  // last node of the stage of node i, and stages are contiguous. Tensors used
+  // by a stage must then stay allocated for the whole stage. An empty vector
+  // means sequential execution. Takes effect at the next PlanAllocations().
+  // Planners which never share memory between tensors can ignore this.
+  virtual void SetConcurrentStages(std::vector<int> stage_first_node,
+                                   std::vector<int> stage_last_node) {}
+
   // Invalidates allocations made earlier. This is called when tensors sizes
   // have changed. All planned allocations remain, but can't be used until
   // ExecuteAllocations() is called.
@@ -0,0 +1,232 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/profiling/roofline_summarizer.h"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/builtin_op_data.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+const TfLiteTensor* GetTensor(const Subgraph& subgraph,
+                              const TfLiteIntArray* indices, int i) {
+  if (indices == nullptr || i >= indices->size) return nullptr;
+  const int tensor_index = indices->data[i];
+  if (tensor_index == kTfLiteOptionalTensor) return nullptr;
+  return subgraph.tensor(tensor_index);
+}
+
+int64_t NumElements(const TfLiteTensor* tensor) {
+  if (tensor == nullptr || tensor->dims == nullptr) return 0;
+  int64_t count = 1;
+  for (int i = 0; i < tensor->dims->size; ++i) count *= tensor->dims->data[i];
+  return count;
+}
+
+// Returns dimension `i` of `tensor`, counting from the end if `i` is negative.
+int64_t Dim(const TfLiteTensor* tensor, int i) {
+  if (tensor == nullptr || tensor->dims == nullptr) return 0;
+  const int rank = tensor->dims->size;
+  if (i < 0) i += rank;
+  if (i < 0 || i >= rank) return 0;
+  return tensor->dims->data[i];
+}
+
+int64_t EstimateFlops(const Subgraph& subgraph, const TfLiteNode& node,
+                      const TfLiteRegistration& registration) {
+  const TfLiteTensor* input = GetTensor(subgraph, node.inputs, 0);
+  const TfLiteTensor* weights = GetTensor(subgraph, node.inputs, 1);
+  const TfLiteTensor* output = GetTensor(subgraph, node.outputs, 0);
+  const int64_t output_elements = NumElements(output);
+  switch (registration.builtin_code) {
+    case BuiltinOperator_CONV_2D:
+      // Filter is [output_channels, height, width, input_channels / groups].
+      return 2 * output_elements * Dim(weights, 1) * Dim(weights, 2) *
+             Dim(weights, 3);
+    case BuiltinOperator_CONV_3D:
+      // Filter is [depth, height, width, input_channels, output_channels].
+      return 2 * output_elements * Dim(weights, 0) * Dim(weights, 1) *
+             Dim(weights, 2) * Dim(weights, 3);
+    case BuiltinOperator_DEPTHWISE_CONV_2D:
+      // Filter is [1, height, width, output_channels].
+      return 2 * output_elements * Dim(weights, 1) * Dim(weights, 2);
+    case BuiltinOperator_TRANSPOSE_CONV: {
+      // Inputs are the output shape, the filter laid out like CONV_2D's with
+      // output and input channels swapped, and the input.
+      const TfLiteTensor* conv_input = GetTensor(subgraph, node.inputs, 2);
+      return 2 * NumElements(conv_input) * Dim(weights, 0) * Dim(weights, 1) *
+             Dim(weights, 2);
+    }
+    case BuiltinOperator_FULLY_CONNECTED:
+      // Weights are [units, accumulation depth].
+      return 2 * output_elements * Dim(weights, -1);
+    case BuiltinOperator_BATCH_MATMUL: {
+      const auto* params =
+          reinterpret_cast<const TfLiteBatchMatMulParams*>(node.builtin_data);
+      const bool adj_x = params != nullptr && params->adj_x;
+      return 2 * output_elements * Dim(input, adj_x ? -2 : -1);
+    }
+    case BuiltinOperator_AVERAGE_POOL_2D:
+    case BuiltinOperator_MAX_POOL_2D:
+    case BuiltinOperator_L2_POOL_2D: {
+      const auto* params =
+          reinterpret_cast<const TfLitePoolParams*>(node.builtin_data);
+      if (params == nullptr) return output_elements;
+      return output_elements * params->filter_width * params->filter_height;
+    }
+    case BuiltinOperator_MEAN:
+    case BuiltinOperator_SUM:
+    case BuiltinOperator_REDUCE_MAX:
+    case BuiltinOperator_REDUCE_MIN:
+    case BuiltinOperator_REDUCE_PROD:
+    case BuiltinOperator_SOFTMAX:
+    case BuiltinOperator_LOG_SOFTMAX:
+    case BuiltinOperator_L2_NORMALIZATION:
+      return NumElements(input);
+    case BuiltinOperator_ADD:
+    case BuiltinOperator_SUB:
+    case BuiltinOperator_MUL:
+    case BuiltinOperator_DIV:
+    case BuiltinOperator_SQUARED_DIFFERENCE:
+    case BuiltinOperator_MAXIMUM:
+    case BuiltinOperator_MINIMUM:
+    case BuiltinOperator_RELU:
+    case BuiltinOperator_RELU6:
+    case BuiltinOperator_RELU_N1_TO_1:
+    case BuiltinOperator_LEAKY_RELU:
+    case BuiltinOperator_PRELU:
+    case BuiltinOperator_LOGISTIC:
+    case BuiltinOperator_TANH:
+    case BuiltinOperator_HARD_SWISH:
+    case BuiltinOperator_ELU:
+    case BuiltinOperator_EXP:
+    case BuiltinOperator_LOG:
+    case BuiltinOperator_SQRT:
+    case BuiltinOperator_RSQRT:
+    case BuiltinOperator_SQUARE:
+    case BuiltinOperator_ABS:
+    case BuiltinOperator_NEG:
+    case BuiltinOperator_QUANTIZE:
+    case BuiltinOperator_DEQUANTIZE:
+      return output_elements;
+    default:
+      return 0;
+  }
+}
+
+std::string FormatRatio(double numerator, double denominator) {
+  if (denominator <= 0) return "";
+  std::ostringstream stream;
+  stream << numerator / denominator;
+  return stream.str();
+}
+
+}  // namespace
+
+OpCost EstimateOpCost(const Subgraph& subgraph, int node_index) {
+  OpCost cost;
+  const auto* node_and_registration =
+      subgraph.node_and_registration(node_index);
+  if (node_and_registration == nullptr) return cost;
+  const TfLiteNode& node = node_and_registration->first;
+  for (const TfLiteIntArray* indices : {node.inputs, node.outputs}) {
+    for (int i = 0; indices != nullptr && i < indices->size; ++i) {
+      const TfLiteTensor* tensor = GetTensor(subgraph, indices, i);
+      if (tensor != nullptr) cost.bytes += tensor->bytes;
+    }
+  }
+  // Delegate kernels replace arbitrary subgraphs, so their work is unknown.
+  if (node.delegate == nullptr) {
+    cost.flops = EstimateFlops(subgraph, node, node_and_registration->second);
+  }
+  return cost;
+}
+
+void RooflineSummarizer::ProcessProfiles(
+    const std::vector<const ProfileEvent*>& profile_events,
+    const Interpreter& interpreter) {
+  for (const ProfileEvent* event : profile_events) {
+    if (event->event_type != Profiler::EventType::OPERATOR_INVOKE_EVENT) {
+      continue;
+    }
+    // See TFLITE_SCOPED_TAGGED_OPERATOR_PROFILE for how the indices are
+    // recorded.
+    const int subgraph_index = static_cast<int>(event->extra_event_metadata);
+    const int node_index = static_cast<int>(event->event_metadata);
+    if (subgraph_index < 0 ||
+        static_cast<size_t>(subgraph_index) >= interpreter.subgraphs_size()) {
+      continue;
+    }
+    OpStats& stats = op_stats_[{subgraph_index, node_index}];
+    if (stats.runs == 0) stats.op_name = event->tag;
+    // Shapes may change between runs, so keep the cost of the latest one.
+    stats.cost =
+        EstimateOpCost(*interpreter.subgraph(subgraph_index), node_index);
+    stats.runs++;
+    stats.total_us += event->elapsed_time;
+  }
+}
+
+std::string RooflineSummarizer::GetCsvOutput() const {
+  std::ostringstream stream;
+  stream << "subgraph,node,op,runs,avg_us,flops,bytes,arithmetic_intensity,"
+            "gflops_per_s,gb_per_s,compute_utilization,bandwidth_utilization,"
+            "bound\n";
+  // Arithmetic intensity, in FLOPs per byte, above which the device is
+  // compute bound.
+  const double ridge_point =
+      peak_memory_bandwidth_gbps_ > 0
+          ? peak_gflops_ / peak_memory_bandwidth_gbps_
+          : 0;
+  for (const auto& entry : op_stats_) {
+    const OpStats& stats = entry.second;
+    const double avg_us =
+        static_cast<double>(stats.total_us) / static_cast<double>(stats.runs);
+    const double flops = static_cast<double>(stats.cost.flops);
+    const double bytes = static_cast<double>(stats.cost.bytes);
+    // Work per microsecond divided by 1000 gives G(FLOP|B)/s.
+    const double gb_per_s = avg_us > 0 ? bytes / avg_us / 1000 : 0;
+    stream << entry.first.first << "," << entry.first.second << ","
+           << stats.op_name << "," << stats.runs << "," << avg_us << ","
+           << stats.cost.flops << "," << stats.cost.bytes << ",";
+    // Columns derived from the FLOPs are left empty for ops whose FLOPs are
+    // unknown.
+    if (stats.cost.flops > 0) {
+      const double gflops_per_s = avg_us > 0 ? flops / avg_us / 1000 : 0;
+      stream << FormatRatio(flops, bytes) << "," << gflops_per_s << ","
+             << gb_per_s << "," << FormatRatio(gflops_per_s, peak_gflops_)
+             << ",";
+    } else {
+      stream << ",," << gb_per_s << ",,";
+    }
+    stream << FormatRatio(gb_per_s, peak_memory_bandwidth_gbps_) << ",";
+    if (ridge_point > 0 && stats.cost.flops > 0 && stats.cost.bytes > 0) {
+      stream << (flops / bytes < ridge_point ? "memory" : "compute");
+    }
+    stream << "\n";
+  }
+  return stream.str();
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,91 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_PROFILING_ROOFLINE_SUMMARIZER_H_
+#define TENSORFLOW_LITE_PROFILING_ROOFLINE_SUMMARIZER_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/profiling/profile_buffer.h"
+
+namespace tflite {
+namespace profiling {
+
+// Work done by one invocation of an operator, estimated from the shapes of its
+// tensors.
+struct OpCost {
+  // Floating point or integer arithmetic operations, counting a multiply-add
+  // as two. Zero when the op is not known to the cost model, e.g. for
+  // delegate kernels and pure data movement ops.
+  int64_t flops = 0;
+  // Bytes of all input and output tensors, i.e. the data an op has to move at
+  // least once.
+  int64_t bytes = 0;
+};
+
+// Returns the estimated cost of the node `node_index` of `subgraph`.
+OpCost EstimateOpCost(const Subgraph& subgraph, int node_index);
+
+// Accumulates per-operator timings from profile events and reports, for every
+// operator, the achieved throughput against the roofline of a device given by
+// its peak compute and memory bandwidth.
+class RooflineSummarizer {
+ public:
+  // Peaks of zero are treated as unknown: the report then omits the
+  // utilization columns and doesn't classify ops.
+  RooflineSummarizer(double peak_gflops, double peak_memory_bandwidth_gbps)
+      : peak_gflops_(peak_gflops),
+        peak_memory_bandwidth_gbps_(peak_memory_bandwidth_gbps) {}
+
+  // Accumulates the OPERATOR_INVOKE_EVENTs in `profile_events`, which must
+  // have been recorded while running `interpreter`.
+  void ProcessProfiles(const std::vector<const ProfileEvent*>& profile_events,
+                       const Interpreter& interpreter);
+
+  bool HasProfiles() const { return !op_stats_.empty(); }
+
+  // Returns one CSV row per operator, in subgraph and node order, with the
+  // columns:
+  //   subgraph, node, op, runs, avg_us, flops, bytes, arithmetic_intensity,
+  //   gflops_per_s, gb_per_s, compute_utilization, bandwidth_utilization,
+  //   bound
+  // `bound` is "memory" when the op's arithmetic intensity is below the ridge
+  // point of the roofline and "compute" otherwise.
+  std::string GetCsvOutput() const;
+
+ private:
+  struct OpStats {
+    std::string op_name;
+    OpCost cost;
+    int64_t runs = 0;
+    int64_t total_us = 0;
+  };
+
+  const double peak_gflops_;
+  const double peak_memory_bandwidth_gbps_;
+  // Keyed by subgraph and node index.
+  std::map<std::pair<int, int>, OpStats> op_stats_;
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_ROOFLINE_SUMMARIZER_H_
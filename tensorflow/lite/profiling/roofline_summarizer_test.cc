@@ -0,0 +1,109 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/profiling/roofline_summarizer.h"
+
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using ::testing::HasSubstr;
+
+class RooflineSummarizerTest : public ::testing::Test {
+ protected:
+  // Builds a single fully connected node computing [2, 8] x [4, 8]^T + [4].
+  void SetUp() override {
+    ASSERT_EQ(interpreter_.AddTensors(4), kTfLiteOk);
+    TfLiteQuantizationParams quant = {};
+    ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(0, kTfLiteFloat32, "x",
+                                                        {2, 8}, quant),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(1, kTfLiteFloat32, "w",
+                                                        {4, 8}, quant),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(2, kTfLiteFloat32, "b",
+                                                        {4}, quant),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetTensorParametersReadWrite(3, kTfLiteFloat32, "y",
+                                                        {2, 4}, quant),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetInputs({0, 1, 2}), kTfLiteOk);
+    ASSERT_EQ(interpreter_.SetOutputs({3}), kTfLiteOk);
+    registration_.builtin_code = BuiltinOperator_FULLY_CONNECTED;
+    registration_.invoke = [](TfLiteContext*, TfLiteNode*) {
+      return kTfLiteOk;
+    };
+    ASSERT_EQ(interpreter_.AddNodeWithParameters({0, 1, 2}, {3}, nullptr, 0,
+                                                 nullptr, &registration_),
+              kTfLiteOk);
+  }
+
+  ProfileEvent OperatorEvent(uint64_t elapsed_us) {
+    ProfileEvent event = {};
+    event.tag = "FULLY_CONNECTED";
+    event.elapsed_time = elapsed_us;
+    event.event_type = Profiler::EventType::OPERATOR_INVOKE_EVENT;
+    event.event_metadata = 0;
+    event.extra_event_metadata = 0;
+    return event;
+  }
+
+  Interpreter interpreter_;
+  TfLiteRegistration registration_ = {};
+};
+
+TEST_F(RooflineSummarizerTest, EstimatesFullyConnectedCost) {
+  const OpCost cost = EstimateOpCost(*interpreter_.subgraph(0), 0);
+  // One multiply-add per output element and accumulation step.
+  EXPECT_EQ(cost.flops, 2 * 8 * 8);
+  EXPECT_EQ(cost.bytes, (16 + 32 + 4 + 8) * sizeof(float));
+}
+
+TEST_F(RooflineSummarizerTest, ReportsThroughputAgainstPeaks) {
+  RooflineSummarizer summarizer(/*peak_gflops=*/1,
+                                /*peak_memory_bandwidth_gbps=*/1);
+  EXPECT_FALSE(summarizer.HasProfiles());
+  const ProfileEvent run1 = OperatorEvent(2);
+  const ProfileEvent run2 = OperatorEvent(4);
+  summarizer.ProcessProfiles({&run1}, interpreter_);
+  summarizer.ProcessProfiles({&run2}, interpreter_);
+  ASSERT_TRUE(summarizer.HasProfiles());
+
+  const std::string csv = summarizer.GetCsvOutput();
+  EXPECT_THAT(csv, HasSubstr("0,0,FULLY_CONNECTED,2,3,128,240,"));
+  // 128 FLOPs over 240 bytes is below the ridge point of 1 FLOP per byte.
+  EXPECT_THAT(csv, HasSubstr(",0.08,0.0426667,0.08,memory\n"));
+}
+
+TEST_F(RooflineSummarizerTest, OmitsUtilizationWithoutPeaks) {
+  RooflineSummarizer summarizer(/*peak_gflops=*/0,
+                                /*peak_memory_bandwidth_gbps=*/0);
+  const ProfileEvent run = OperatorEvent(3);
+  summarizer.ProcessProfiles({&run}, interpreter_);
+  EXPECT_THAT(summarizer.GetCsvOutput(), HasSubstr(",0.08,,,\n"));
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
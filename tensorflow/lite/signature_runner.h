@@ -128,6 +128,27 @@ class SignatureRunner {
   TfLiteStatus ResizeInputTensorStrict(const char* input_name,
                                        const std::vector<int>& new_size);
 
+  /// Binds the caller-owned buffer `allocation` as the memory of the input
+  /// tensor identified by `input_name`, so that writes to the buffer are seen
+  /// by Invoke() without a copy. The buffer stays bound across invocations
+  /// until another one is bound.
+  /// `allocation.data` must outlive the runner and, unless `flags` contains
+  /// kTfLiteCustomAllocationFlagsSkipAlignCheck, be aligned to
+  /// kDefaultTensorAlignment. Its size is validated by the next call to
+  /// AllocateTensors(), which must happen before Invoke().
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetCustomAllocationForInputTensor(
+      const char* input_name, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
+  /// Like SetCustomAllocationForInputTensor(), but binds the buffer to the
+  /// output tensor identified by `output_name`, into which Invoke() then
+  /// writes its result directly.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetCustomAllocationForOutputTensor(
+      const char* output_name, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
   /// Updates allocations for all tensors, related to the given signature.
   TfLiteStatus AllocateTensors() { return subgraph_->AllocateTensors(); }
 
@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/lite/interpreter_builder.h"
 #include "tensorflow/lite/kernels/register.h"
 #include "tensorflow/lite/testing/util.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 namespace {
@@ -93,5 +94,80 @@ TEST(SignatureRunnerTest, TestMultiSignatures) {
   ASSERT_EQ(sub_output->data.f[2], 3);
 }
 
+TEST(SignatureRunnerTest, CustomAllocationsStayBoundAcrossInvokes) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  InterpreterBuilder builder(*model, resolver);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  SignatureRunner* add_runner = interpreter->GetSignatureRunner("add");
+  ASSERT_NE(add_runner, nullptr);
+  ASSERT_EQ(add_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+
+  alignas(kDefaultTensorAlignment) float input[16];
+  alignas(kDefaultTensorAlignment) float output[16];
+  ASSERT_EQ(add_runner->SetCustomAllocationForInputTensor(
+                "x", {input, sizeof(input)}),
+            kTfLiteOk);
+  ASSERT_EQ(add_runner->SetCustomAllocationForOutputTensor(
+                "output_0", {output, sizeof(output)}),
+            kTfLiteOk);
+  ASSERT_NE(add_runner->SetCustomAllocationForInputTensor(
+                "dummy", {input, sizeof(input)}),
+            kTfLiteOk);
+  ASSERT_EQ(add_runner->AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(add_runner->input_tensor("x")->data.f, input);
+  EXPECT_EQ(add_runner->output_tensor("output_0")->data.f, output);
+
+  for (float value : {2.0f, 5.0f}) {
+    input[0] = value;
+    input[1] = -value;
+    ASSERT_EQ(add_runner->Invoke(), kTfLiteOk);
+    EXPECT_EQ(output[0], value + 2);
+    EXPECT_EQ(output[1], -value + 2);
+  }
+
+  // Buffers which are too small are rejected by AllocateTensors().
+  ASSERT_EQ(add_runner->SetCustomAllocationForOutputTensor(
+                "output_0", {output, sizeof(float)}),
+            kTfLiteOk);
+  EXPECT_NE(add_runner->AllocateTensors(), kTfLiteOk);
+}
+
+TEST(SignatureRunnerTest, LazySubgraphInitialization) {
+  TestErrorReporter reporter;
+  auto model = FlatBufferModel::BuildFromFile(
+      "tensorflow/lite/testdata/multi_signatures.bin", &reporter);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolver resolver;
+  InterpreterOptions options;
+  options.SetLazySubgraphInitialization(true);
+  InterpreterBuilder builder(*model, resolver, &options);
+  std::unique_ptr<Interpreter> interpreter;
+  ASSERT_EQ(builder(&interpreter), kTfLiteOk);
+  ASSERT_EQ(interpreter->subgraphs_size(), 2);
+  EXPECT_TRUE(interpreter->subgraph(0)->IsInitialized());
+  EXPECT_FALSE(interpreter->subgraph(1)->IsInitialized());
+  EXPECT_EQ(interpreter->subgraph(1)->nodes_size(), 0);
+
+  // The "sub" signature computes x - 3 in the second subgraph.
+  SignatureRunner* sub_runner = interpreter->GetSignatureRunner("sub");
+  ASSERT_NE(sub_runner, nullptr);
+  EXPECT_TRUE(interpreter->subgraph(1)->IsInitialized());
+  EXPECT_GT(interpreter->subgraph(1)->nodes_size(), 0);
+  ASSERT_EQ(sub_runner->ResizeInputTensor("x", {2}), kTfLiteOk);
+  ASSERT_EQ(sub_runner->AllocateTensors(), kTfLiteOk);
+  TfLiteTensor* sub_input = sub_runner->input_tensor("x");
+  sub_input->data.f[0] = 2;
+  sub_input->data.f[1] = 4;
+  ASSERT_EQ(sub_runner->Invoke(), kTfLiteOk);
+  const TfLiteTensor* sub_output = sub_runner->output_tensor("output_0");
+  EXPECT_EQ(sub_output->data.f[0], -1);
+  EXPECT_EQ(sub_output->data.f[1], 1);
+}
+
 }  // namespace
 }  // namespace tflite
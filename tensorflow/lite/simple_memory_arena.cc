@@ -87,6 +87,13 @@ void SimpleMemoryArena::CalculateActiveAllocs(
 
 void SimpleMemoryArena::ResetAllocs() { active_allocs_.clear(); }
 
+void SimpleMemoryArena::RestorePlan(
+    const std::vector<ArenaAllocWithUsageInterval>& allocs,
+    size_t high_water_mark, int32_t node) {
+  high_water_mark_ = std::max(high_water_mark_, high_water_mark);
+  CalculateActiveAllocs(allocs, node);
+}
+
 TfLiteStatus SimpleMemoryArena::Allocate(
     TfLiteContext* context, size_t alignment, size_t size, int32_t tensor,
     int32_t first_node, int32_t last_node,
@@ -99,6 +99,14 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Replaces the current plan by one computed earlier, in which `allocs` were
+  // allocated and `high_water_mark` bytes were needed. Keeps the allocations
+  // active at `node` for further calls to Allocate().
+  void RestorePlan(const std::vector<ArenaAllocWithUsageInterval>& allocs,
+                   size_t high_water_mark, int32_t node);
+
+  size_t high_water_mark() const { return high_water_mark_; }
+
   inline size_t RequiredBufferSize() {
     // Add in a small amount of padding to reduce the chance of resize events
     // for small allocations.
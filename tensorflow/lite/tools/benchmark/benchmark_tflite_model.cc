@@ -15,9 +15,11 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -34,6 +36,7 @@ limitations under the License.
 #include "absl/strings/str_replace.h"
 #include "absl/strings/str_split.h"
 #include "ruy/profiler/profiler.h"  // from @ruy
+#include "tensorflow/lite/core/async/pipelined_runner.h"
 #include "tensorflow/lite/core/c/c_api_types.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/model.h"
@@ -363,6 +366,11 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("profiling_output_csv_file",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("op_roofline_output_csv_file",
+                          BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("peak_gflops", BenchmarkParam::Create<float>(0.0f));
+  default_params.AddParam("peak_memory_bandwidth_gbps",
+                          BenchmarkParam::Create<float>(0.0f));
 
   default_params.AddParam("print_preinvoke_state",
                           BenchmarkParam::Create<bool>(false));
@@ -376,6 +384,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("output_filepath",
                           BenchmarkParam::Create<std::string>(""));
+  default_params.AddParam("pipelined_invocations",
+                          BenchmarkParam::Create<int32_t>(0));
 
   tools::ProvidedDelegateList delegate_providers(&default_params);
   delegate_providers.AddAllDelegateParams();
@@ -438,6 +448,17 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "profiling_output_csv_file", &params_,
           "File path to export profile data as CSV, if not set "
           "prints to stdout."),
+      CreateFlag<std::string>(
+          "op_roofline_output_csv_file", &params_,
+          "File path to export, as CSV, the estimated FLOPs and bytes moved "
+          "of every op together with the achieved GFLOP/s and GB/s. Requires "
+          "--enable_op_profiling."),
+      CreateFlag<float>("peak_gflops", &params_,
+                        "Peak compute throughput of the device in GFLOP/s, "
+                        "used by the op roofline report."),
+      CreateFlag<float>("peak_memory_bandwidth_gbps", &params_,
+                        "Peak memory bandwidth of the device in GB/s, used by "
+                        "the op roofline report."),
       CreateFlag<bool>(
           "print_preinvoke_state", &params_,
           "print out the interpreter internals just before calling Invoke. The "
@@ -457,7 +478,13 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
                        "Disable delegate clustering."),
       CreateFlag<std::string>(
           "output_filepath", &params_,
-          "File path to export outputs layer as binary data.")};
+          "File path to export outputs layer as binary data."),
+      CreateFlag<int32_t>(
+          "pipelined_invocations", &params_,
+          "If > 0, each run pushes this many invocations through a pipeline "
+          "which copies in the inputs of the next invocation and releases the "
+          "outputs of the previous one on other threads while the current "
+          "one runs.")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -492,6 +519,11 @@ void BenchmarkTfLiteModel::LogParams() {
                       verbose);
   LOG_BENCHMARK_PARAM(std::string, "profiling_output_csv_file",
                       "CSV File to export profiling data to", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "op_roofline_output_csv_file",
+                      "CSV File to export the op roofline report to", verbose);
+  LOG_BENCHMARK_PARAM(float, "peak_gflops", "Peak GFLOP/s", verbose);
+  LOG_BENCHMARK_PARAM(float, "peak_memory_bandwidth_gbps",
+                      "Peak memory bandwidth in GB/s", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_preinvoke_state",
                       "Print pre-invoke interpreter state", verbose);
   LOG_BENCHMARK_PARAM(bool, "print_postinvoke_state",
@@ -504,6 +536,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Disable delegate clustering", verbose);
   LOG_BENCHMARK_PARAM(std::string, "output_filepath",
                       "File path to export outputs layer to", verbose);
+  LOG_BENCHMARK_PARAM(int32_t, "pipelined_invocations",
+                      "Pipelined invocations per run", verbose);
 
   for (const auto& delegate_provider :
        tools::GetRegisteredDelegateProviders()) {
@@ -847,6 +881,16 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
     return kTfLiteError;
   }
 
+  pipelined_runner_.reset();
+  if (params_.Get<int32_t>("pipelined_invocations") > 0) {
+    pipelined_runner_ = async::PipelinedRunner::Create(interpreter_.get());
+    if (pipelined_runner_ == nullptr) {
+      TFLITE_LOG(ERROR) << "The model's inputs and outputs can't be bound to "
+                           "pipeline buffers.";
+      return kTfLiteError;
+    }
+  }
+
   AddOwnedListener(
       std::unique_ptr<BenchmarkListener>(new RuyProfileListener()));
   AddOwnedListener(
@@ -895,15 +939,38 @@ std::unique_ptr<BenchmarkListener>
 BenchmarkTfLiteModel::MayCreateProfilingListener() const {
   if (!params_.Get<bool>("enable_op_profiling")) return nullptr;
 
-  return std::unique_ptr<BenchmarkListener>(new ProfilingListener(
+  auto listener = std::make_unique<ProfilingListener>(
       interpreter_.get(), params_.Get<int32_t>("max_profiling_buffer_entries"),
       params_.Get<bool>("allow_dynamic_profiling_buffer_increase"),
       params_.Get<std::string>("profiling_output_csv_file"),
       CreateProfileSummaryFormatter(
-          !params_.Get<std::string>("profiling_output_csv_file").empty())));
+          !params_.Get<std::string>("profiling_output_csv_file").empty()));
+  const std::string roofline_csv_file =
+      params_.Get<std::string>("op_roofline_output_csv_file");
+  if (!roofline_csv_file.empty()) {
+    listener->EnableRooflineReport(
+        roofline_csv_file, params_.Get<float>("peak_gflops"),
+        params_.Get<float>("peak_memory_bandwidth_gbps"));
+  }
+  return listener;
 }
 
-TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
+TfLiteStatus BenchmarkTfLiteModel::RunImpl() {
+  if (pipelined_runner_ == nullptr) return interpreter_->Invoke();
+
+  // Every invocation gets the same inputs, copied in while the previous
+  // invocation runs. The outputs are left unread.
+  return pipelined_runner_->Run(
+      params_.Get<int32_t>("pipelined_invocations"),
+      [this](int, const std::vector<TfLiteCustomAllocation>& inputs) {
+        for (size_t i = 0; i < inputs.size(); ++i) {
+          std::memcpy(inputs[i].data, inputs_data_[i].data.get(),
+                      std::min(inputs[i].bytes, inputs_data_[i].bytes));
+        }
+        return kTfLiteOk;
+      },
+      /*postprocess=*/nullptr);
+}
 
 }  // namespace benchmark
 }  // namespace tflite
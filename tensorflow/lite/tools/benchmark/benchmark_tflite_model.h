@@ -24,6 +24,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "tensorflow/lite/core/async/pipelined_runner.h"
 #include "tensorflow/lite/core/model.h"
 #include "tensorflow/lite/profiling/profiler.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -130,6 +131,8 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
   std::unique_ptr<tools::ModelLoader> model_loader_;
+  // Set when --pipelined_invocations is positive.
+  std::unique_ptr<async::PipelinedRunner> pipelined_runner_;
 };
 
 }  // namespace benchmark
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/tools/benchmark/profiling_listener.h"
 
 #include <fstream>
+#include <memory>
 #include <string>
 
 #include "tensorflow/lite/tools/logging.h"
@@ -63,6 +64,17 @@ void ProfilingListener::OnSingleRunEnd() {
   profiler_.StopProfiling();
   auto profile_events = profiler_.GetProfileEvents();
   run_summarizer_.ProcessProfiles(profile_events, *interpreter_);
+  if (roofline_summarizer_ != nullptr) {
+    roofline_summarizer_->ProcessProfiles(profile_events, *interpreter_);
+  }
+}
+
+void ProfilingListener::EnableRooflineReport(
+    const std::string& csv_file_path, double peak_gflops,
+    double peak_memory_bandwidth_gbps) {
+  roofline_csv_file_path_ = csv_file_path;
+  roofline_summarizer_ = std::make_unique<profiling::RooflineSummarizer>(
+      peak_gflops, peak_memory_bandwidth_gbps);
 }
 
 void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
@@ -81,6 +93,15 @@ void ProfilingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
                 run_summarizer_.GetOutputString(),
                 output_stream == nullptr ? &TFLITE_LOG(INFO) : output_stream);
   }
+  if (roofline_summarizer_ != nullptr && roofline_summarizer_->HasProfiles()) {
+    std::ofstream roofline_file(roofline_csv_file_path_);
+    if (roofline_file.good()) {
+      roofline_file << roofline_summarizer_->GetCsvOutput();
+    } else {
+      TFLITE_LOG(ERROR) << "Failed to open " << roofline_csv_file_path_
+                        << " for the operator roofline report.";
+    }
+  }
 }
 
 void ProfilingListener::WriteOutput(const std::string& header,
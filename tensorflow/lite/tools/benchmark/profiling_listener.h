@@ -22,6 +22,7 @@ limitations under the License.
 #include "tensorflow/lite/profiling/buffered_profiler.h"
 #include "tensorflow/lite/profiling/profile_summarizer.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/roofline_summarizer.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
 
 namespace tflite {
@@ -44,6 +45,12 @@ class ProfilingListener : public BenchmarkListener {
 
   void OnBenchmarkEnd(const BenchmarkResults& results) override;
 
+  // Additionally writes a per-operator roofline report of the regular runs,
+  // as CSV, to `csv_file_path`. See RooflineSummarizer for the peaks.
+  void EnableRooflineReport(const std::string& csv_file_path,
+                            double peak_gflops,
+                            double peak_memory_bandwidth_gbps);
+
  protected:
   profiling::ProfileSummarizer run_summarizer_;
   profiling::ProfileSummarizer init_summarizer_;
@@ -54,6 +61,8 @@ class ProfilingListener : public BenchmarkListener {
                    std::ostream* stream);
   Interpreter* interpreter_;
   profiling::BufferedProfiler profiler_;
+  std::unique_ptr<profiling::RooflineSummarizer> roofline_summarizer_;
+  std::string roofline_csv_file_path_;
 };
 
 }  // namespace benchmark
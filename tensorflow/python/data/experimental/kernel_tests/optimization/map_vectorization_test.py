@@ -0,0 +1,63 @@
+# Copyright 2022 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for the `MapVectorization` optimization."""
+from absl.testing import parameterized
+
+from tensorflow.python.data.experimental.ops import testing
+from tensorflow.python.data.kernel_tests import test_base
+from tensorflow.python.data.ops import dataset_ops
+from tensorflow.python.data.ops import options as options_lib
+from tensorflow.python.framework import combinations
+from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import dtypes
+from tensorflow.python.ops import random_ops
+from tensorflow.python.platform import test
+
+
+class MapVectorizationTest(test_base.DatasetTestBase, parameterized.TestCase):
+
+  def _with_map_vectorization(self, dataset):
+    options = options_lib.Options()
+    options.experimental_optimization.apply_default_optimizations = False
+    options.experimental_optimization.map_vectorization = True
+    return dataset.with_options(options)
+
+  @combinations.generate(
+      combinations.times(test_base.default_test_combinations(),
+                         combinations.combine(drop_remainder=[True, False])))
+  def testMapVectorization(self, drop_remainder):
+    captured_t = constant_op.constant(42, dtype=dtypes.int64)
+    dataset = dataset_ops.Dataset.range(10).apply(
+        testing.assert_next(["Batch", "Map"])).map(
+            lambda x: x * x + captured_t).batch(
+                4, drop_remainder=drop_remainder)
+    dataset = self._with_map_vectorization(dataset)
+    expected_output = [[x * x + 42 for x in range(i, min(i + 4, 10))]
+                       for i in range(0, 10, 4)]
+    if drop_remainder:
+      expected_output = expected_output[:-1]
+    self.assertDatasetProduces(dataset, expected_output=expected_output)
+
+  @combinations.generate(test_base.default_test_combinations())
+  def testStatefulFunctionNotVectorized(self):
+    dataset = dataset_ops.Dataset.range(10).apply(
+        testing.assert_next(["Map", "Batch"])).map(
+            lambda _: random_ops.random_uniform([])).batch(4)
+    dataset = self._with_map_vectorization(dataset)
+    self.assertLen(self.getDatasetOutput(dataset), 3)
+
+
+if __name__ == "__main__":
+  test.main()
@@ -166,6 +166,20 @@ class UniqueTest(test.TestCase):
     self.assertAllEqual(tf_y, true_y)
     self.assertAllEqual(tf_idx, true_idx)
 
+  def testOrderedByAppearanceLarge(self):
+    # Inputs this large are uniquified in parallel on CPU.
+    x = np.random.randint(10000, size=1 << 18)
+    _, first, inverse = np.unique(x, return_index=True, return_inverse=True)
+    order = np.argsort(first)
+    rank = np.empty_like(order)
+    rank[order] = np.arange(len(order))
+    for values in [x, x.astype(np.bytes_)]:
+      with self.subTest(dtype=values.dtype):
+        y, idx = array_ops.unique(values)
+        tf_y, tf_idx = self.evaluate([y, idx])
+        self.assertAllEqual(tf_y, values[first[order]])
+        self.assertAllEqual(tf_idx, rank[inverse])
+
 
 class UniqueWithCountsTest(test.TestCase):
 
@@ -1191,8 +1191,8 @@ class CountNonzeroReductionTest(test.TestCase):
     self._compareAll(np_arr, [2])
     self._compareAll(np_arr, [0, 1])
     self._compareAll(np_arr, [1, 2])
-    # Need specialization for reduce(4D, [0, 2])
-    # self._compareAll(np_arr, [0, 2])
+    self._compareAll(np_arr, [0, 2])
+    self._compareAll(np_arr, [1, 3])
     self._compareAll(np_arr, [0, 1, 2])
     self._compareAll(np_arr, [1, 2, 3])
     self._compareAll(np_arr, [0, 1, 2, 3])
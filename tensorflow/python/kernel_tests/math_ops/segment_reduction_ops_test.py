@@ -631,6 +631,27 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
                 # and may therefore vary dynamically.
                 self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testSkewedSegments(self):
+    # A few segments much larger than the others, as with hub nodes in a
+    # graph. The GPU implem splits those segments across thread blocks.
+    np.random.seed(0)
+    segment_sizes = [3, 5000, 0, 700] + [1, 2] * 100 + [1000, 4]
+    segment_ids = np.repeat(np.arange(len(segment_sizes)), segment_sizes)
+    num_indices = len(segment_ids)
+    for inner_size in [1, 3, 32]:
+      np_x = np.random.rand(100, inner_size).astype(np.float32)
+      np_indices = np.random.randint(0, 100, size=num_indices)
+      np_sum = np.zeros((len(segment_sizes), inner_size), dtype=np.float32)
+      np.add.at(np_sum, segment_ids, np_x[np_indices])
+      np_mean = np_sum / np.maximum(segment_sizes, 1)[:, np.newaxis]
+      with self.cached_session():
+        tf_sum = math_ops.sparse_segment_sum(
+            data=np_x, indices=np_indices, segment_ids=segment_ids)
+        tf_mean = math_ops.sparse_segment_mean(
+            data=np_x, indices=np_indices, segment_ids=segment_ids)
+        self.assertAllClose(np_sum, self.evaluate(tf_sum), rtol=1e-4)
+        self.assertAllClose(np_mean, self.evaluate(tf_mean), rtol=1e-4)
+
   def testSegmentIdsHole(self):
     tf_x, np_x = self._input([10, 4], dtype=dtypes_lib.float32)
     ops_list = [(np.add, None, math_ops.sparse_segment_sum), (
@@ -434,6 +434,17 @@ class TransposeTest(test.TestCase):
     self._testBoth(
         np.arange(0, 1260).reshape([2, 3, 5, 7, 2, 3]).astype(np.int64))
 
+  def testLargeSizeCPU(self):
+    # Large enough for the tiled CPU transpose.
+    shape = [16, 33, 65, 3]
+    for dtype in [np.int8, np.int16, np.float32, np.float64, np.complex128]:
+      x = np.arange(np.prod(shape)).reshape(shape).astype(dtype)
+      for perm in [[1, 0, 2, 3], [3, 2, 1, 0], [0, 3, 1, 2], [2, 0, 3, 1]]:
+        with self.subTest(dtype=dtype, perm=perm):
+          with self.cached_session(use_gpu=False):
+            y = self.evaluate(array_ops.transpose(x, perm))
+          self.assertAllEqual(np.transpose(x, perm), y)
+
   def testTranspose2DAuto(self):
     x_np = [[1, 2, 3], [4, 5, 6]]
     for use_gpu in [False, True]:
@@ -238,6 +238,23 @@ class SparseTensorDenseMatMulTest(test.TestCase):
     self._testLarge(np.complex64)
     self._testLarge(np.complex128)
 
+  # Tests products large enough to be split across threads by output row.
+  def testManyNonzerosWideDense(self):
+    np.random.seed(127)  # Repeatable results
+    for np_dtype in [np.float32, np.float64, np.complex64]:
+      for indices_dtype in [np.int32, np.int64]:
+        x = _maybe_complex(np.random.rand(300, 200).astype(np_dtype))
+        x[np.abs(x) < 0.8] = 0
+        y = _maybe_complex(np.random.randn(200, 300).astype(np_dtype))
+        for adjoint_a in [True, False]:
+          for adjoint_b in [True, False]:
+            self._testMatmul(
+                x.transpose() if adjoint_a else x,
+                y.transpose() if adjoint_b else y,
+                adjoint_a,
+                adjoint_b,
+                indices_dtype=indices_dtype)
+
   # Tests random sized matrices.
   def testFloatRandom(self):
     np.random.seed(127)  # Repeatable results
@@ -206,6 +206,14 @@ class SparseXentOpTestBase(test.TestCase):
     self._testXent(
         np_labels=np.zeros((0,), dtype=np.int32), np_logits=np.zeros((0, 3)))
 
+  def testManyClasses(self):
+    # Enough classes for the rows to be normalized in several blocks, one of
+    # which is entirely masked out.
+    np.random.seed(0)
+    logits = np.random.randn(3, 10000).astype(np.float32)
+    logits[:, 4096:8192] = -np.inf
+    self._testXent(np_labels=np.array([1, 9999, 4095]), np_logits=logits)
+
   @test_util.run_in_graph_and_eager_modes()
   def testGradient(self):
     with self.session() as sess:
@@ -567,6 +567,30 @@ class ResourceVariableOpsTest(test_util.TensorFlowTestCase,
     read = resource_variable_ops.read_variable_op(handle, dtype=dtypes.int32)
     self.assertEqual(self.evaluate(read), [[6]])
 
+  def testScatterAddSubCombineDuplicateIndices(self):
+    with test.mock.patch.dict(
+        os.environ, {"TF_SCATTER_COMBINE_DUPLICATE_INDICES": "true"}):
+      with ops.Graph().as_default(), self.session():
+        v = resource_variable_ops.ResourceVariable(
+            [[1.0, 2.0], [3.0, 4.0], [5.0, 6.0]])
+        self.evaluate(v.initializer)
+        self.evaluate(
+            resource_variable_ops.resource_scatter_add(
+                v.handle, [2, 0, 2, 2],
+                [[1.0, 1.0], [2.0, 2.0], [3.0, 3.0], [4.0, 4.0]]))
+        self.assertAllEqual(
+            self.evaluate(v), [[3.0, 4.0], [3.0, 4.0], [13.0, 14.0]])
+        self.evaluate(
+            resource_variable_ops.resource_scatter_sub(
+                v.handle, [1, 1], [[1.0, 2.0], [2.0, 2.0]]))
+        self.assertAllEqual(
+            self.evaluate(v), [[3.0, 4.0], [0.0, 0.0], [13.0, 14.0]])
+        with self.assertRaisesRegex(errors.InvalidArgumentError,
+                                    r"indices\[2\] = 3 is not in \[0, 3\)"):
+          self.evaluate(
+              resource_variable_ops.resource_scatter_add(
+                  v.handle, [0, 0, 3], [[1.0, 1.0], [1.0, 1.0], [1.0, 1.0]]))
+
   @test_util.run_in_graph_and_eager_modes
   def testScatterAddScalar(self):
     handle = _eager_safe_var_handle_op(dtype=dtypes.int32, shape=[1, 1])
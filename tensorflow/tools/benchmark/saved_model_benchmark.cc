@@ -0,0 +1,325 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A C++ binary to benchmark the serving latency and throughput of a
+// SavedModel under concurrent synthetic requests.
+//
+// See README.md for usage instructions.
+
+#include "tensorflow/tools/benchmark/saved_model_benchmark.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/time.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/loader.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/threadpool.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/command_line_flags.h"
+#include "tensorflow/core/util/reporter.h"
+
+namespace tensorflow {
+namespace saved_model_benchmark {
+
+namespace {
+
+// Resource usage of the process, left at -1 where it is not known.
+struct ProcessUsage {
+  int64_t cpu_time_us = -1;
+  int64_t peak_memory_kb = -1;
+};
+
+ProcessUsage GetProcessUsage() {
+  ProcessUsage usage;
+#ifdef __linux__
+  rusage res;
+  if (getrusage(RUSAGE_SELF, &res) == 0) {
+    usage.cpu_time_us = (res.ru_utime.tv_sec + res.ru_stime.tv_sec) * 1000000 +
+                        res.ru_utime.tv_usec + res.ru_stime.tv_usec;
+    usage.peak_memory_kb = res.ru_maxrss;
+  }
+#endif
+  return usage;
+}
+
+// Returns the latency below which `quantile` of the sorted `latencies_us` are.
+int64_t Percentile(const std::vector<int64_t>& latencies_us, double quantile) {
+  const size_t index = static_cast<size_t>(
+      std::ceil(quantile * latencies_us.size()));
+  return latencies_us[std::max<size_t>(index, 1) - 1];
+}
+
+Status RunRequest(Session* session,
+                  const std::vector<std::pair<string, Tensor>>& inputs,
+                  const std::vector<string>& outputs, int64_t* latency_us) {
+  std::vector<Tensor> output_tensors;
+  const int64_t start_us = Env::Default()->NowMicros();
+  Status s = session->Run(inputs, outputs, {}, &output_tensors);
+  *latency_us = Env::Default()->NowMicros() - start_us;
+  return s;
+}
+
+}  // namespace
+
+Status CreateSignatureInputs(
+    const SignatureDef& signature_def, int batch_size,
+    std::vector<std::pair<string, Tensor>>* input_tensors) {
+  input_tensors->clear();
+  for (const auto& input : signature_def.inputs()) {
+    const TensorInfo& info = input.second;
+    if (info.name().empty()) {
+      return errors::Unimplemented("Input '", input.first,
+                                   "' is not a dense tensor.");
+    }
+    if (info.tensor_shape().unknown_rank()) {
+      return errors::InvalidArgument("Input '", input.first,
+                                     "' has an unknown rank.");
+    }
+    TensorShape shape;
+    for (const auto& dim : info.tensor_shape().dim()) {
+      TF_RETURN_IF_ERROR(
+          shape.AddDimWithStatus(dim.size() < 0 ? batch_size : dim.size()));
+    }
+    Tensor tensor(info.dtype(), shape);
+    switch (info.dtype()) {
+#define CASE(T)                   \
+  case DataTypeToEnum<T>::value:  \
+    tensor.flat<T>().setZero();   \
+    break;
+      TF_CALL_POD_TYPES(CASE)
+#undef CASE
+      case DT_STRING:
+        // Strings are already empty.
+        break;
+      default:
+        return errors::Unimplemented("Input '", input.first, "' has type ",
+                                     DataTypeString(info.dtype()),
+                                     ", which is not supported.");
+    }
+    input_tensors->emplace_back(info.name(), std::move(tensor));
+  }
+  return OkStatus();
+}
+
+Status BenchmarkSavedModel(const SavedModelBenchmarkOptions& options,
+                           SavedModelBenchmarkResult* result) {
+  if (options.num_clients <= 0 || options.num_requests <= 0) {
+    return errors::InvalidArgument(
+        "The number of clients and requests must be positive.");
+  }
+  *result = SavedModelBenchmarkResult();
+
+  SessionOptions session_options;
+  if (options.num_threads > 0) {
+    session_options.config.set_intra_op_parallelism_threads(
+        options.num_threads);
+    session_options.config.set_inter_op_parallelism_threads(
+        options.num_threads);
+  }
+  SavedModelBundle bundle;
+  const int64_t load_start_us = Env::Default()->NowMicros();
+  TF_RETURN_IF_ERROR(LoadSavedModel(session_options, RunOptions(),
+                                    options.export_dir, options.tags,
+                                    &bundle));
+  result->load_time_s =
+      (Env::Default()->NowMicros() - load_start_us) / 1000000.0;
+
+  const auto& signatures = bundle.GetSignatures();
+  auto signature_it = signatures.find(options.signature);
+  if (signature_it == signatures.end()) {
+    return errors::NotFound("No signature '", options.signature,
+                            "' in the SavedModel at ", options.export_dir);
+  }
+  std::vector<std::pair<string, Tensor>> inputs;
+  TF_RETURN_IF_ERROR(
+      CreateSignatureInputs(signature_it->second, options.batch_size, &inputs));
+  std::vector<string> outputs;
+  for (const auto& output : signature_it->second.outputs()) {
+    outputs.push_back(output.second.name());
+  }
+  Session* session = bundle.GetSession();
+
+  for (int i = 0; i < options.warmup_requests; ++i) {
+    int64_t latency_us;
+    TF_RETURN_IF_ERROR(RunRequest(session, inputs, outputs, &latency_us));
+  }
+
+  // Each client takes the next request until all of them have been sent,
+  // so that the clients keep the session busy until the end.
+  std::atomic<int64_t> next_request(0);
+  std::vector<std::vector<int64_t>> client_latencies_us(options.num_clients);
+  mutex mu;
+  Status status;
+  const ProcessUsage start_usage = GetProcessUsage();
+  const int64_t start_us = Env::Default()->NowMicros();
+  {
+    thread::ThreadPool clients(Env::Default(), "saved_model_benchmark",
+                               options.num_clients);
+    BlockingCounter counter(options.num_clients);
+    for (int c = 0; c < options.num_clients; ++c) {
+      clients.Schedule([&, c]() {
+        std::vector<int64_t>* latencies_us = &client_latencies_us[c];
+        while (next_request++ < options.num_requests) {
+          int64_t latency_us;
+          Status s = RunRequest(session, inputs, outputs, &latency_us);
+          if (!s.ok()) {
+            mutex_lock l(mu);
+            status.Update(s);
+            break;
+          }
+          latencies_us->push_back(latency_us);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  const int64_t wall_time_us = Env::Default()->NowMicros() - start_us;
+  const ProcessUsage end_usage = GetProcessUsage();
+  TF_RETURN_IF_ERROR(status);
+
+  std::vector<int64_t> latencies_us;
+  latencies_us.reserve(options.num_requests);
+  for (const auto& client : client_latencies_us) {
+    latencies_us.insert(latencies_us.end(), client.begin(), client.end());
+  }
+  std::sort(latencies_us.begin(), latencies_us.end());
+  int64_t total_latency_us = 0;
+  for (int64_t latency_us : latencies_us) total_latency_us += latency_us;
+
+  result->num_requests = latencies_us.size();
+  result->wall_time_s = wall_time_us / 1000000.0;
+  result->throughput =
+      result->num_requests / std::max(result->wall_time_s, 1e-6);
+  result->mean_latency_us =
+      static_cast<double>(total_latency_us) / result->num_requests;
+  result->p50_latency_us = Percentile(latencies_us, 0.5);
+  result->p90_latency_us = Percentile(latencies_us, 0.9);
+  result->p99_latency_us = Percentile(latencies_us, 0.99);
+  result->max_latency_us = latencies_us.back();
+  result->peak_memory_kb = end_usage.peak_memory_kb;
+  if (start_usage.cpu_time_us >= 0 && end_usage.cpu_time_us >= 0) {
+    result->cpu_utilization =
+        static_cast<double>(end_usage.cpu_time_us - start_usage.cpu_time_us) /
+        (std::max<int64_t>(wall_time_us, 1) * port::NumSchedulableCPUs());
+  }
+  return OkStatus();
+}
+
+int Main(int argc, char** argv) {
+  SavedModelBenchmarkOptions options;
+  string tags_string = kSavedModelTagServe;
+  string benchmark_name = "";
+  string output_prefix = "";
+
+  std::vector<Flag> flag_list = {
+      Flag("export_dir", &options.export_dir, "SavedModel directory"),
+      Flag("tags", &tags_string, "comma-separated tags of the MetaGraphDef"),
+      Flag("signature", &options.signature, "signature to run"),
+      Flag("batch_size", &options.batch_size,
+           "size of the unknown dimensions of the inputs"),
+      Flag("num_clients", &options.num_clients,
+           "number of threads sending requests concurrently"),
+      Flag("num_requests", &options.num_requests, "number of timed requests"),
+      Flag("warmup_requests", &options.warmup_requests,
+           "number of requests to initialize the model"),
+      Flag("num_threads", &options.num_threads, "number of session threads"),
+      Flag("benchmark_name", &benchmark_name, "benchmark name"),
+      Flag("output_prefix", &output_prefix, "benchmark output prefix"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  if (!parse_result || options.export_dir.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+  options.tags.clear();
+  for (const string& tag : str_util::Split(tags_string, ',')) {
+    options.tags.insert(tag);
+  }
+
+  ::tensorflow::port::InitMain(argv[0], &argc, &argv);
+  if (argc > 1) {
+    LOG(ERROR) << "Unknown argument " << argv[1] << "\n" << usage;
+    return -1;
+  }
+
+  LOG(INFO) << "SavedModel: [" << options.export_dir << "]";
+  LOG(INFO) << "Tags: [" << tags_string << "]";
+  LOG(INFO) << "Signature: [" << options.signature << "]";
+  LOG(INFO) << "Batch size: [" << options.batch_size << "]";
+  LOG(INFO) << "Num clients: [" << options.num_clients << "]";
+  LOG(INFO) << "Num requests: [" << options.num_requests << "]";
+  LOG(INFO) << "Num threads: [" << options.num_threads << "]";
+
+  SavedModelBenchmarkResult result;
+  Status s = BenchmarkSavedModel(options, &result);
+  if (!s.ok()) {
+    LOG(ERROR) << "Benchmark failed with " << s;
+    return -1;
+  }
+
+  LOG(INFO) << "Loaded SavedModel in " << result.load_time_s << "s";
+  LOG(INFO) << "Ran " << result.num_requests << " requests in "
+            << result.wall_time_s << "s: " << result.throughput
+            << " requests/s";
+  LOG(INFO) << "Latency in us: mean " << result.mean_latency_us << ", p50 "
+            << result.p50_latency_us << ", p90 " << result.p90_latency_us
+            << ", p99 " << result.p99_latency_us << ", max "
+            << result.max_latency_us;
+  LOG(INFO) << "Peak memory: " << result.peak_memory_kb / 1024.0 << " MB";
+  LOG(INFO) << "CPU utilization: " << result.cpu_utilization * 100 << "%";
+
+  if (!benchmark_name.empty() && !output_prefix.empty()) {
+    TestReporter reporter(output_prefix, benchmark_name);
+    TF_QCHECK_OK(reporter.Initialize());
+    TF_QCHECK_OK(reporter.Benchmark(result.num_requests, -1.0,
+                                    result.wall_time_s, result.throughput));
+    TF_QCHECK_OK(reporter.AddMetric("load_time_s", result.load_time_s));
+    TF_QCHECK_OK(
+        reporter.AddMetric("mean_latency_us", result.mean_latency_us));
+    TF_QCHECK_OK(reporter.AddMetric("p50_latency_us", result.p50_latency_us));
+    TF_QCHECK_OK(reporter.AddMetric("p90_latency_us", result.p90_latency_us));
+    TF_QCHECK_OK(reporter.AddMetric("p99_latency_us", result.p99_latency_us));
+    TF_QCHECK_OK(reporter.AddMetric("peak_memory_kb", result.peak_memory_kb));
+    TF_QCHECK_OK(
+        reporter.AddMetric("cpu_utilization", result.cpu_utilization));
+    TF_QCHECK_OK(reporter.Close());
+  }
+
+  return 0;
+}
+
+}  // namespace saved_model_benchmark
+}  // namespace tensorflow
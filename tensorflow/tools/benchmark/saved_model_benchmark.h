@@ -0,0 +1,87 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
+#define TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/cc/saved_model/signature_constants.h"
+#include "tensorflow/cc/saved_model/tag_constants.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/meta_graph.pb.h"
+
+namespace tensorflow {
+namespace saved_model_benchmark {
+
+struct SavedModelBenchmarkOptions {
+  string export_dir;
+  std::unordered_set<string> tags = {kSavedModelTagServe};
+  string signature = kDefaultServingSignatureDefKey;
+  // Size of the unknown dimensions of the signature inputs.
+  int batch_size = 1;
+  // Number of threads sending requests concurrently.
+  int num_clients = 1;
+  // Number of requests timed, shared by all the clients.
+  int num_requests = 1000;
+  // Number of requests sent before the timed ones, to initialize the model.
+  int warmup_requests = 1;
+  // Number of intra-op and inter-op threads of the session, or the session
+  // defaults if not positive.
+  int num_threads = -1;
+};
+
+struct SavedModelBenchmarkResult {
+  double load_time_s = 0;
+  int64_t num_requests = 0;
+  double wall_time_s = 0;
+  // Requests per second.
+  double throughput = 0;
+  double mean_latency_us = 0;
+  int64_t p50_latency_us = 0;
+  int64_t p90_latency_us = 0;
+  int64_t p99_latency_us = 0;
+  int64_t max_latency_us = 0;
+  // Peak resident set size of the process, including the loading of the
+  // model. -1 on platforms where it is not known.
+  int64_t peak_memory_kb = -1;
+  // CPU time of the process during the timed requests, as a fraction of the
+  // CPU time available on all the cores. -1 on platforms where it is not
+  // known.
+  double cpu_utilization = -1;
+};
+
+// Creates zero-filled tensors for the inputs of `signature_def`, with the
+// unknown dimensions set to `batch_size`.
+Status CreateSignatureInputs(
+    const SignatureDef& signature_def, int batch_size,
+    std::vector<std::pair<string, Tensor>>* input_tensors);
+
+// Loads the SavedModel and runs synthetic requests on its session from
+// concurrent clients.
+Status BenchmarkSavedModel(const SavedModelBenchmarkOptions& options,
+                           SavedModelBenchmarkResult* result);
+
+// Handles all setup and argument parsing.
+int Main(int argc, char** argv);
+
+}  // namespace saved_model_benchmark
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_TOOLS_BENCHMARK_SAVED_MODEL_BENCHMARK_H_
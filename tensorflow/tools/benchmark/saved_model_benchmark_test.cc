@@ -0,0 +1,76 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tools/benchmark/saved_model_benchmark.h"
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr char kTestData[] = "cc/saved_model/testdata/half_plus_two_pbtxt/00000123";
+
+TEST(SavedModelBenchmarkTest, CreateSignatureInputs) {
+  SignatureDef signature_def;
+  TensorInfo& info = (*signature_def.mutable_inputs())["x"];
+  info.set_name("x:0");
+  info.set_dtype(DT_FLOAT);
+  info.mutable_tensor_shape()->add_dim()->set_size(-1);
+  info.mutable_tensor_shape()->add_dim()->set_size(3);
+
+  std::vector<std::pair<string, Tensor>> inputs;
+  TF_ASSERT_OK(
+      saved_model_benchmark::CreateSignatureInputs(signature_def, 8, &inputs));
+  ASSERT_EQ(1, inputs.size());
+  EXPECT_EQ("x:0", inputs[0].first);
+  EXPECT_EQ(TensorShape({8, 3}), inputs[0].second.shape());
+  EXPECT_EQ(0, inputs[0].second.matrix<float>()(7, 2));
+
+  info.mutable_tensor_shape()->set_unknown_rank(true);
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      saved_model_benchmark::CreateSignatureInputs(signature_def, 8, &inputs)));
+}
+
+TEST(SavedModelBenchmarkTest, ConcurrentClients) {
+  saved_model_benchmark::SavedModelBenchmarkOptions options;
+  options.export_dir = io::JoinPath(testing::TensorFlowSrcRoot(), kTestData);
+  options.batch_size = 4;
+  options.num_clients = 4;
+  options.num_requests = 50;
+
+  saved_model_benchmark::SavedModelBenchmarkResult result;
+  TF_ASSERT_OK(saved_model_benchmark::BenchmarkSavedModel(options, &result));
+  EXPECT_EQ(50, result.num_requests);
+  EXPECT_GT(result.throughput, 0);
+  EXPECT_LE(result.p50_latency_us, result.p90_latency_us);
+  EXPECT_LE(result.p90_latency_us, result.p99_latency_us);
+  EXPECT_LE(result.p99_latency_us, result.max_latency_us);
+}
+
+TEST(SavedModelBenchmarkTest, MissingSignature) {
+  saved_model_benchmark::SavedModelBenchmarkOptions options;
+  options.export_dir = io::JoinPath(testing::TensorFlowSrcRoot(), kTestData);
+  options.signature = "not_a_signature";
+
+  saved_model_benchmark::SavedModelBenchmarkResult result;
+  EXPECT_TRUE(errors::IsNotFound(
+      saved_model_benchmark::BenchmarkSavedModel(options, &result)));
+}
+
+}  // namespace
+}  // namespace tensorflow
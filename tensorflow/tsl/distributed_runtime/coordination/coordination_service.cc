@@ -380,7 +380,10 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
           // Heartbeat check.
           Status status = OkStatus();
           {
-            mutex_lock l(state_mu_);
+            // The scan runs under a shared lock so that it does not stall the
+            // heartbeats of large clusters; the exclusive lock is only taken
+            // when some task has timed out.
+            tf_shared_lock l(state_mu_);
             for (const auto& [task_name, task_state] : cluster_state_) {
               // Skip tasks that are not registered or in error state
               if (task_state->GetState() !=
@@ -393,14 +396,35 @@ void CoordinationServiceStandaloneImpl::StartCheckStaleness() {
                       << " stale?=" << is_stale;
               if (is_stale) {
                 stale_task_names.push_back(task_name);
-                status = MakeCoordinationError(errors::Unavailable(
-                    "Task ", task_name,
-                    " heartbeat timeout. This indicates that the remote task "
-                    "has failed, got preempted, or crashed unexpectedly."));
-                SetTaskError(task_name, status);
               }
             }
           }
+          if (!stale_task_names.empty()) {
+            mutex_lock l(state_mu_);
+            // Keep the tasks that are still stale, since they may have
+            // heartbeated or changed state since the scan.
+            auto still_stale = [this](absl::string_view task_name) {
+              TaskState* task_state = cluster_state_[task_name].get();
+              return task_state->GetState() ==
+                         CoordinatedTaskState::TASKSTATE_CONNECTED &&
+                     task_state->TimeSinceLastHeartbeatMs() >
+                         heartbeat_timeout_ms_;
+            };
+            stale_task_names.erase(
+                std::remove_if(stale_task_names.begin(),
+                               stale_task_names.end(),
+                               [&](absl::string_view task_name) {
+                                 return !still_stale(task_name);
+                               }),
+                stale_task_names.end());
+            for (absl::string_view task_name : stale_task_names) {
+              status = MakeCoordinationError(errors::Unavailable(
+                  "Task ", task_name,
+                  " heartbeat timeout. This indicates that the remote task "
+                  "has failed, got preempted, or crashed unexpectedly."));
+              SetTaskError(task_name, status);
+            }
+          }
           // Propagate heartbeat timeout errors to other connected tasks.
           if (!stale_task_names.empty()) {
             if (!has_service_to_client_connection) {
@@ -688,26 +712,30 @@ Status CoordinationServiceStandaloneImpl::RecordHeartbeat(
   const std::string& task_name = GetTaskName(task);
   Status s = OkStatus();
   {
-    mutex_lock l(state_mu_);
-    if (!cluster_state_.contains(task_name)) {
+    // Heartbeats only read the task states, and record the heartbeat time
+    // under a per-task lock, so that the heartbeats of many tasks do not
+    // serialize on the service.
+    tf_shared_lock l(state_mu_);
+    auto it = cluster_state_.find(task_name);
+    if (it == cluster_state_.end()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Unexpected task request with task_name=", task_name));
     }
-    if (!cluster_state_[task_name]->GetStatus().ok()) {
-      return cluster_state_[task_name]->GetStatus();
-    } else if (cluster_state_[task_name]->GetState() ==
+    TaskState* task_state = it->second.get();
+    if (!task_state->GetStatus().ok()) {
+      return task_state->GetStatus();
+    } else if (task_state->GetState() ==
                    CoordinatedTaskState::TASKSTATE_DISCONNECTED &&
                // We accept heartbeats for a short grace period to account for
                // the lag time between the service recording the state change
                // and the agent stopping heartbeats.
                Env::Default()->NowMicros() >
-                   cluster_state_[task_name]
-                       ->GetDisconnectedGracePeriodMicros()) {
+                   task_state->GetDisconnectedGracePeriodMicros()) {
       return MakeCoordinationError(errors::InvalidArgument(
           "Task with task_name=", task_name,
           " must be registered before sending heartbeat messages"));
     }
-    s = cluster_state_[task_name]->RecordHeartbeat(incarnation);
+    s = task_state->RecordHeartbeat(incarnation);
   }
 
   // Set and propagate any heartbeat errors.
@@ -886,7 +914,7 @@ void CoordinationServiceStandaloneImpl::GetKeyValueAsync(
 StatusOr<std::string> CoordinationServiceStandaloneImpl::TryGetKeyValue(
     const std::string& key) {
   const std::string& norm_key = NormalizeKey(key);
-  mutex_lock l(kv_mu_);
+  tf_shared_lock l(kv_mu_);
   const auto& iter = kv_store_.find(norm_key);
   if (iter == kv_store_.end()) {
     return errors::NotFound("Config key ", key, " not found.");
@@ -900,10 +928,12 @@ std::vector<KeyValueEntry> CoordinationServiceStandaloneImpl::GetKeyValueDir(
   const std::string norm_key = NormalizeKey(directory_key);
   const std::string dir = absl::StrCat(norm_key, "/");
 
-  mutex_lock l(kv_mu_);
+  // Reads of a directory, e.g. of the keys that every task of a large job
+  // inserted at startup, do not block each other.
+  tf_shared_lock l(kv_mu_);
   // Find first key in ordered map that has the directory prefix.
   auto begin = kv_store_.lower_bound(dir);
-  std::map<std::string, std::string>::iterator it;
+  std::map<std::string, std::string>::const_iterator it;
   // Iterate through key range that match directory prefix.
   for (it = begin; it != kv_store_.end(); ++it) {
     // Stop once the next key does not have the directory prefix. Since keys are
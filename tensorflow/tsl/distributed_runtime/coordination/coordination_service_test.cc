@@ -436,6 +436,21 @@ TEST_F(CoordinateTwoTasksTest, TestTaskHeartbeatTimeout) {
       coord_service_->RecordHeartbeat(task_1_, incarnation_1_)));
 }
 
+TEST_F(CoordinateTwoTasksTest, TestOnlyStaleTaskTimesOut) {
+  EnableCoordinationService();
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_0_, incarnation_0_));
+  TF_ASSERT_OK(coord_service_->RegisterTask(task_1_, incarnation_1_));
+
+  // Only task 0 keeps sending heartbeats.
+  for (int i = 0; i < 8; ++i) {
+    Env::Default()->SleepForMicroseconds(
+        absl::ToInt64Microseconds(kHeartbeatTimeout / 4));
+    TF_ASSERT_OK(coord_service_->RecordHeartbeat(task_0_, incarnation_0_));
+  }
+  EXPECT_TRUE(errors::IsUnavailable(
+      coord_service_->RecordHeartbeat(task_1_, incarnation_1_)));
+}
+
 TEST_F(CoordinateTwoTasksTest,
        HeartbeatTimeoutWithoutServerToClientConnection) {
   EnableCoordinationService(/*has_service_to_client_connection=*/false);
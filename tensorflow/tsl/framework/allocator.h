@@ -86,12 +86,20 @@ struct AllocatorStats {
   std::optional<int64_t> bytes_reservable_limit;
 
   int64_t largest_free_block_bytes;  // Largest free block's size in heap.
+  // The fraction of the free bytes in the heap that are not in the largest
+  // free block, or 0 if there are none.
+  double fragmentation;
 
   // Number of bytes of memory held by the allocator.  This may be higher than
   // bytes_in_use if the allocator holds a pool of memory (e.g. BFCAllocator).
   std::optional<int64_t> pool_bytes;
   std::optional<int64_t> peak_pool_bytes;
 
+  // Stats for allocators with a cache of free chunks in front of their pool,
+  // e.g. BFCAllocator's small-allocation cache.
+  int64_t num_cache_hits;    // Allocations served from the cache.
+  int64_t num_cache_misses;  // Cacheable allocations not served from it.
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
@@ -99,7 +107,10 @@ struct AllocatorStats {
         largest_alloc_size(0),
         bytes_reserved(0),
         peak_bytes_reserved(0),
-        largest_free_block_bytes(0) {}
+        largest_free_block_bytes(0),
+        fragmentation(0),
+        num_cache_hits(0),
+        num_cache_misses(0) {}
 
   std::string DebugString() const;
 };
@@ -86,6 +86,17 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  if (opts.small_allocation_cache_max_bytes > 0) {
+    const size_t num_sizes =
+        RoundedBytes(opts.small_allocation_cache_max_bytes) /
+        kMinAllocationSize;
+    cache_shards_ = std::make_unique<CacheShard[]>(kNumCacheShards);
+    for (int i = 0; i < kNumCacheShards; ++i) {
+      mutex_lock l(cache_shards_[i].mu);
+      cache_shards_[i].free_chunks.resize(num_sizes);
+    }
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -246,6 +257,14 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
   }
   void* r =
       AllocateRawInternal(unused_alignment, num_bytes, false, freed_by_count);
+  if (r == nullptr && FlushSmallAllocationCache()) {
+    r = AllocateRawInternal(unused_alignment, num_bytes, false,
+                            freed_by_count);
+  }
+  if (r == nullptr && RelieveMemoryPressure(num_bytes)) {
+    r = AllocateRawInternal(unused_alignment, num_bytes, false,
+                            freed_by_count);
+  }
   if (r != nullptr) {
     return r;
   } else {
@@ -266,6 +285,15 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes;
+  const bool cacheable = IsCacheable(num_bytes, allocation_attr);
+  if (cacheable) {
+    void* cached = AllocateFromCache(RoundedBytes(num_bytes));
+    if (cached != nullptr) {
+      VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " "
+              << cached << " (cached)";
+      return cached;
+    }
+  }
   void* result = [&] {
     if (!opts_.allow_retry_on_failure || !allocation_attr.retry_on_failure) {
       // If we have globally disabled retry-on-failure and fail to allocate an
@@ -291,6 +319,15 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
       }
       void* res = AllocateRawInternal(unused_alignment, num_bytes,
                                       dump_log_on_failure, freed_by_count);
+      if (res == nullptr && FlushSmallAllocationCache()) {
+        res = AllocateRawInternal(unused_alignment, num_bytes,
+                                  dump_log_on_failure, freed_by_count);
+      }
+      if (res == nullptr && allocation_attr.retry_on_failure &&
+          RelieveMemoryPressure(num_bytes)) {
+        res = AllocateRawInternal(unused_alignment, num_bytes,
+                                  dump_log_on_failure, freed_by_count);
+      }
       if (res == nullptr) {
         int32 counter_value = log_counter.load(std::memory_order_relaxed);
         if (counter_value < kMaxFailureLogs) {
@@ -313,9 +350,135 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
     }
   }();
   VLOG(3) << "AllocateRaw " << Name() << "  " << num_bytes << " " << result;
+  if (cacheable && result != nullptr) {
+    AddCacheableChunk(result, RoundedBytes(num_bytes));
+  }
   return result;
 }
 
+BFCAllocator::CacheShard* BFCAllocator::CacheShardForThread() {
+  // Each thread sticks to one shard, assigned round-robin on first use.
+  static std::atomic<int> next_thread_shard{0};
+  thread_local const int thread_shard =
+      next_thread_shard.fetch_add(1, std::memory_order_relaxed) %
+      kNumCacheShards;
+  return &cache_shards_[thread_shard];
+}
+
+void* BFCAllocator::AllocateFromCache(size_t rounded_bytes) {
+  CacheShard* shard = CacheShardForThread();
+  {
+    mutex_lock l(shard->mu);
+    std::vector<std::pair<void*, size_t>>& free_chunks =
+        shard->free_chunks[rounded_bytes / kMinAllocationSize - 1];
+    if (!free_chunks.empty()) {
+      const std::pair<void*, size_t> chunk = free_chunks.back();
+      free_chunks.pop_back();
+      cached_bytes_.fetch_sub(chunk.second, std::memory_order_relaxed);
+      cache_hits_.fetch_add(1, std::memory_order_relaxed);
+      return chunk.first;
+    }
+  }
+  cache_misses_.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+}
+
+void BFCAllocator::AddCacheableChunk(void* ptr, size_t rounded_bytes) {
+  const size_t chunk_bytes = AllocatedSize(ptr);
+  CacheShard* shard = CacheShardForPtr(ptr);
+  mutex_lock l(shard->mu);
+  shard->cacheable_chunks[ptr] = {rounded_bytes, chunk_bytes};
+}
+
+bool BFCAllocator::DeallocateToCache(void* ptr) {
+  CacheShard* chunk_shard = CacheShardForPtr(ptr);
+  CacheShard::CacheableChunk chunk;
+  {
+    mutex_lock l(chunk_shard->mu);
+    auto it = chunk_shard->cacheable_chunks.find(ptr);
+    if (it == chunk_shard->cacheable_chunks.end()) return false;
+    chunk = it->second;
+  }
+  if (timing_counter_ == nullptr) {
+    CacheShard* shard = CacheShardForThread();
+    mutex_lock l(shard->mu);
+    std::vector<std::pair<void*, size_t>>& free_chunks =
+        shard->free_chunks[chunk.rounded_bytes / kMinAllocationSize - 1];
+    if (free_chunks.size() < kMaxCachedChunksPerSize) {
+      free_chunks.emplace_back(ptr, chunk.chunk_bytes);
+      cached_bytes_.fetch_add(chunk.chunk_bytes, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  // The chunk goes back to the bins, where it may be reused for a request of
+  // a different size, so it must no longer be treated as cacheable.
+  mutex_lock l(chunk_shard->mu);
+  chunk_shard->cacheable_chunks.erase(ptr);
+  return false;
+}
+
+bool BFCAllocator::FlushSmallAllocationCache() {
+  if (cache_shards_ == nullptr) return false;
+  std::vector<void*> to_free;
+  for (int i = 0; i < kNumCacheShards; ++i) {
+    mutex_lock l(cache_shards_[i].mu);
+    for (auto& free_chunks : cache_shards_[i].free_chunks) {
+      for (const std::pair<void*, size_t>& chunk : free_chunks) {
+        cached_bytes_.fetch_sub(chunk.second, std::memory_order_relaxed);
+        to_free.push_back(chunk.first);
+      }
+      free_chunks.clear();
+    }
+  }
+  for (void* ptr : to_free) {
+    {
+      CacheShard* shard = CacheShardForPtr(ptr);
+      mutex_lock l(shard->mu);
+      shard->cacheable_chunks.erase(ptr);
+    }
+    DeallocateRawInternal(ptr);
+  }
+  return !to_free.empty();
+}
+
+int BFCAllocator::RegisterMemoryPressureCallback(
+    MemoryPressureCallback callback) {
+  mutex_lock l(memory_pressure_mu_);
+  const int id = next_memory_pressure_callback_id_++;
+  memory_pressure_callbacks_.emplace_back(id, std::move(callback));
+  return id;
+}
+
+void BFCAllocator::UnregisterMemoryPressureCallback(int id) {
+  mutex_lock l(memory_pressure_mu_);
+  for (auto it = memory_pressure_callbacks_.begin();
+       it != memory_pressure_callbacks_.end(); ++it) {
+    if (it->first == id) {
+      memory_pressure_callbacks_.erase(it);
+      return;
+    }
+  }
+  LOG(ERROR) << "Unknown memory pressure callback id " << id;
+}
+
+bool BFCAllocator::RelieveMemoryPressure(size_t num_bytes) {
+  mutex_lock l(memory_pressure_mu_);
+  size_t released = 0;
+  for (const auto& callback : memory_pressure_callbacks_) {
+    if (released >= num_bytes) break;
+    released += callback.second(num_bytes - released);
+  }
+  if (released > 0) {
+    // Small buffers released by the callbacks may have been cached.
+    FlushSmallAllocationCache();
+    VLOG(1) << "Memory pressure callbacks released "
+            << strings::HumanReadableNumBytes(released) << " from " << Name()
+            << " for an allocation of "
+            << strings::HumanReadableNumBytes(num_bytes);
+  }
+  return released > 0;
+}
+
 // static
 size_t BFCAllocator::RoundedBytes(size_t bytes) {
   size_t rounded_bytes =
@@ -416,6 +579,90 @@ void BFCAllocator::DeallocateRegions(
   }
 }
 
+std::vector<void*> BFCAllocator::ReserveFreeGranules() {
+  std::vector<void*> reserved;
+  const size_t granularity = opts_.defragmentation_granularity;
+  if (granularity == 0 || !coalesce_regions_) return reserved;
+  DCHECK_EQ(granularity % kMinAllocationSize, 0);
+
+  mutex_lock l(lock_);
+  // Collect the candidates first, since splitting changes the chunk lists.
+  // Timestamped chunks may still be used by pending work.
+  std::vector<ChunkHandle> free_chunks;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (!c->in_use() && c->bin_num != kInvalidBinNum &&
+          c->freed_at_count == 0 && c->size >= granularity) {
+        free_chunks.push_back(h);
+      }
+      h = c->next;
+    }
+  }
+
+  size_t reserved_bytes = 0;
+  for (ChunkHandle h : free_chunks) {
+    const Chunk* c = ChunkFromHandle(h);
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(c->ptr);
+    const uintptr_t end = begin + c->size;
+    const uintptr_t aligned_begin =
+        (begin + granularity - 1) / granularity * granularity;
+    const uintptr_t aligned_end = end / granularity * granularity;
+    if (aligned_end <= aligned_begin) continue;
+
+    // Split off the unaligned head and tail, which stay in the bins.
+    RemoveFreeChunkFromBin(h);
+    if (aligned_begin > begin) {
+      SplitChunk(h, aligned_begin - begin);
+      const ChunkHandle h_aligned = ChunkFromHandle(h)->next;
+      InsertFreeChunkIntoBin(h);
+      h = h_aligned;
+      RemoveFreeChunkFromBin(h);
+    }
+    if (aligned_end < end) {
+      SplitChunk(h, aligned_end - aligned_begin);
+    }
+
+    // Mark the chunk in use so that it is neither allocated nor merged.
+    Chunk* aligned = ChunkFromHandle(h);
+    aligned->allocation_id = next_allocation_id_++;
+    aligned->requested_size = aligned->size;
+    reserved.push_back(aligned->ptr);
+    reserved_bytes += aligned->size;
+  }
+  VLOG(1) << "Reserved " << reserved.size() << " free ranges of "
+          << strings::HumanReadableNumBytes(reserved_bytes) << " in total for "
+          << Name() << ".";
+  return reserved;
+}
+
+size_t BFCAllocator::ReleaseReservedGranules(const std::vector<void*>& ptrs) {
+  mutex_lock l(lock_);
+  size_t released_bytes = 0;
+  for (void* ptr : ptrs) {
+    const ChunkHandle h = region_manager_.get_handle(ptr);
+    const Chunk* c = ChunkFromHandle(h);
+    DCHECK(c->in_use());
+    const size_t size = c->size;
+    // The neighbors of the chunk end up in different regions.
+    if (c->prev != kInvalidChunkHandle) {
+      ChunkFromHandle(c->prev)->next = kInvalidChunkHandle;
+    }
+    if (c->next != kInvalidChunkHandle) {
+      ChunkFromHandle(c->next)->prev = kInvalidChunkHandle;
+    }
+    DeleteChunk(h);
+    region_manager_.RemoveRange(ptr, size);
+    sub_allocator_->Free(ptr, size);
+    *stats_.pool_bytes -= size;
+    released_bytes += size;
+  }
+  VLOG(1) << "Released " << strings::HumanReadableNumBytes(released_bytes)
+          << " of free memory of " << Name() << ".";
+  return released_bytes;
+}
+
 void* BFCAllocator::AllocateRawInternal(size_t unused_alignment,
                                         size_t num_bytes,
                                         bool dump_log_on_failure,
@@ -611,6 +858,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
             std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
         stats_.largest_alloc_size =
             std::max<std::size_t>(stats_.largest_alloc_size, chunk->size);
+        if (opts_.peak_allocation_report_size > 0) {
+          RecordAllocationSite(chunk);
+        }
 
 #ifdef TENSORFLOW_MEM_DEBUG
         if (ShouldRecordOpName()) {
@@ -686,6 +936,9 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(3) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
+  if (ptr != nullptr && cache_shards_ != nullptr && DeallocateToCache(ptr)) {
+    return;
+  }
   DeallocateRawInternal(ptr);
   retry_helper_.NotifyDealloc();
 }
@@ -806,6 +1059,11 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
     c->freed_at_count = timing_counter_->next();
   }
 
+  // The usage is about to leave its peak, if it is at one.
+  if (at_unrecorded_peak_) {
+    MaybeRecordPeakAllocations();
+  }
+
   // Updates the stats.
   stats_.bytes_in_use -= c->size;
 
@@ -818,6 +1076,89 @@ void BFCAllocator::MarkFree(BFCAllocator::ChunkHandle h) {
 #endif
 }
 
+void BFCAllocator::RecordAllocationSite(Chunk* chunk) {
+  const auto& annotation =
+      tsl::profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  if (annotation.pending_op_name != nullptr) {
+    chunk->site_op_name.assign(annotation.pending_op_name);
+  } else {
+    chunk->site_op_name.clear();
+  }
+  chunk->site_shape = annotation.pending_shape_func();
+  chunk->site_data_type = annotation.pending_data_type;
+  chunk->site_step_id = annotation.pending_step_id;
+  if (stats_.bytes_in_use == stats_.peak_bytes_in_use) {
+    at_unrecorded_peak_ = true;
+  }
+}
+
+void BFCAllocator::MaybeRecordPeakAllocations() {
+  at_unrecorded_peak_ = false;
+  // Recording scans all chunks, so skip peaks that barely grew.
+  if (!peak_allocations_.empty() &&
+      stats_.bytes_in_use - peak_allocations_bytes_in_use_ <=
+          peak_allocations_bytes_in_use_ / 64) {
+    return;
+  }
+  std::vector<const Chunk*> in_use;
+  for (const auto& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (h != kInvalidChunkHandle) {
+      const Chunk* c = ChunkFromHandle(h);
+      if (c->in_use()) in_use.push_back(c);
+      h = c->next;
+    }
+  }
+  const size_t num_reported = std::min<size_t>(
+      in_use.size(), static_cast<size_t>(opts_.peak_allocation_report_size));
+  std::partial_sort(in_use.begin(), in_use.begin() + num_reported,
+                    in_use.end(), [](const Chunk* a, const Chunk* b) {
+                      return a->size > b->size;
+                    });
+  peak_allocations_.resize(num_reported);
+  for (size_t i = 0; i < num_reported; ++i) {
+    const Chunk* c = in_use[i];
+    PeakAllocation& allocation = peak_allocations_[i];
+    allocation.op_name = c->site_op_name;
+    allocation.shape = c->site_shape;
+    allocation.data_type = c->site_data_type;
+    allocation.step_id = c->site_step_id;
+    allocation.requested_bytes = c->requested_size;
+    allocation.allocated_bytes = c->size;
+  }
+  peak_allocations_bytes_in_use_ = stats_.bytes_in_use;
+}
+
+std::vector<BFCAllocator::PeakAllocation> BFCAllocator::GetPeakAllocations() {
+  mutex_lock l(lock_);
+  if (at_unrecorded_peak_) {
+    MaybeRecordPeakAllocations();
+  }
+  return peak_allocations_;
+}
+
+string BFCAllocator::PeakAllocationReport() {
+  mutex_lock l(lock_);
+  if (at_unrecorded_peak_) {
+    MaybeRecordPeakAllocations();
+  }
+  string report = strings::StrCat(
+      "Largest allocations of ", Name(), " at a peak usage of ",
+      strings::HumanReadableNumBytes(peak_allocations_bytes_in_use_), ":\n");
+  for (const PeakAllocation& allocation : peak_allocations_) {
+    strings::StrAppend(
+        &report, "  ",
+        strings::HumanReadableNumBytes(allocation.allocated_bytes),
+        " (requested ",
+        strings::HumanReadableNumBytes(allocation.requested_bytes), ") by op ",
+        allocation.op_name.empty() ? "(unknown)" : allocation.op_name,
+        ", step ", allocation.step_id, ", data type ", allocation.data_type,
+        ", shape ", allocation.shape.empty() ? "(unknown)" : allocation.shape,
+        "\n");
+  }
+  return report;
+}
+
 BFCAllocator::ChunkHandle BFCAllocator::TryToCoalesce(ChunkHandle h,
                                                       bool ignore_freed_at) {
   Chunk* c = ChunkFromHandle(h);
@@ -1090,6 +1431,10 @@ void BFCAllocator::DumpMemoryLog(size_t num_bytes) {
                            c->action_count, " step ", c->step_id);
       }
 #endif
+      if (opts_.peak_allocation_report_size > 0 && c->in_use()) {
+        strings::StrAppend(&buf, " by op ", c->site_op_name, " of shape ",
+                           c->site_shape, " step ", c->site_step_id);
+      }
       strings::StrAppend(&buf, " next ", c->next);
       if (timing_counter_) {
         strings::StrAppend(&buf, " freed_at_count ", c->freed_at_count);
@@ -1209,14 +1554,33 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
   mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = LargestFreeChunk();
+  if (*stats_.pool_bytes > stats_.bytes_in_use) {
+    stats.fragmentation = GetFragmentation();
+  }
+  if (cache_shards_ != nullptr) {
+    // Cached chunks are in use as far as the bins are concerned, but they are
+    // available to callers.
+    const int64_t cache_hits = cache_hits_.load(std::memory_order_relaxed);
+    stats.num_allocs += cache_hits;
+    stats.bytes_in_use -= cached_bytes_.load(std::memory_order_relaxed);
+    stats.num_cache_hits = cache_hits;
+    stats.num_cache_misses = cache_misses_.load(std::memory_order_relaxed);
+  }
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
   mutex_lock l(lock_);
+  cache_hits_.store(0, std::memory_order_relaxed);
+  cache_misses_.store(0, std::memory_order_relaxed);
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
+  peak_allocations_.clear();
+  peak_allocations_bytes_in_use_ = 0;
+  at_unrecorded_peak_ = opts_.peak_allocation_report_size > 0;
   return true;
 }
 
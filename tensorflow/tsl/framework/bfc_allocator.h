@@ -18,11 +18,14 @@ limitations under the License.
 
 #include <array>
 #include <deque>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/tsl/framework/allocator.h"
 #include "tensorflow/tsl/framework/allocator_retry.h"
@@ -68,6 +71,28 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If greater than zero, freed chunks for allocations of at most this many
+    // bytes are kept in a lock-sharded cache in front of the bins, so that
+    // later allocations of the same rounded size are served without taking
+    // the allocator-wide lock. Cached chunks stay reserved and are only merged
+    // back into the bins when an allocation would otherwise fail. The cache is
+    // bypassed for allocations that depend on a timing counter.
+    size_t small_allocation_cache_max_bytes = 0;
+
+    // If greater than zero and the sub-allocator supports coalescing,
+    // ReserveFreeGranules() takes the parts of free chunks that are aligned to
+    // this many bytes out of the pool. The sub-allocator must be able to Free()
+    // any range of its memory that is aligned to this granularity.
+    size_t defragmentation_granularity = 0;
+
+    // If greater than zero, every allocation records the op name, data type,
+    // shape and step id of the current ScopedMemoryDebugAnnotation, and the
+    // allocator keeps this many of the largest allocations that were live at
+    // its peak memory usage, see GetPeakAllocations(). Allocations then
+    // bypass the small-allocation cache, whose hits don't take the lock that
+    // guards the recorded annotations.
+    int peak_allocation_report_size = 0;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -107,6 +132,59 @@ class BFCAllocator : public Allocator {
 
   MemoryDump RecordMemoryMap();
 
+  // Called with the requested size when an allocation that may be retried
+  // cannot be satisfied, before the allocator waits for memory to be freed.
+  // A callback may release memory that its owner can recreate later, e.g. by
+  // moving cold buffers to host memory, and returns the number of bytes it
+  // deallocated from this allocator. Callbacks run without the allocator lock
+  // held, so they may call DeallocateRaw(), but they must not allocate from
+  // this allocator or register or unregister callbacks.
+  using MemoryPressureCallback = std::function<size_t(size_t num_bytes)>;
+
+  // Registers 'callback' and returns an id for
+  // UnregisterMemoryPressureCallback().
+  int RegisterMemoryPressureCallback(MemoryPressureCallback callback);
+
+  // Unregisters the callback with the given id. Once this returns, the
+  // callback is not running and will not be called again.
+  void UnregisterMemoryPressureCallback(int id);
+
+  // Defragmentation for sub-allocators that map physical memory into a
+  // virtual address range, see Options::defragmentation_granularity.
+  // Returning the memory under the free chunks that are scattered between live
+  // allocations lets the pool grow at its end again, which turns scattered
+  // free memory into contiguous free memory without moving live allocations.
+  //
+  // ReserveFreeGranules() takes the granularity-aligned parts of all free
+  // chunks out of the pool and returns their addresses. Work that was enqueued
+  // on a device before a chunk was freed may still access it, so the caller
+  // passes the addresses to ReleaseReservedGranules() once that work has
+  // completed. It returns the memory to the sub-allocator and returns the
+  // number of bytes released.
+  std::vector<void*> ReserveFreeGranules();
+  size_t ReleaseReservedGranules(const std::vector<void*>& ptrs);
+
+  // An allocation that was live when the allocator reached its peak memory
+  // usage, with the annotation that was current when it was allocated.
+  struct PeakAllocation {
+    std::string op_name;
+    std::string shape;
+    int32 data_type = 0;  // A DataType, or 0 if unknown.
+    int64_t step_id = 0;
+    size_t requested_bytes = 0;
+    size_t allocated_bytes = 0;
+  };
+
+  // Returns the Options::peak_allocation_report_size largest allocations that
+  // were live at the peak memory usage since construction or the last
+  // ClearStats(), largest first. To bound the cost while the usage keeps
+  // growing, the allocations are only recorded again once the peak grew by
+  // more than 1/64, so they may be those of a usage slightly below the peak.
+  std::vector<PeakAllocation> GetPeakAllocations();
+
+  // Returns GetPeakAllocations() as a human readable table.
+  std::string PeakAllocationReport();
+
  private:
   struct Bin;
 
@@ -120,6 +198,34 @@ class BFCAllocator : public Allocator {
 
   void DeallocateRawInternal(void* ptr);
 
+  // Returns a cached chunk for an allocation of 'rounded_bytes', or nullptr if
+  // the calling thread's cache shard has none.
+  void* AllocateFromCache(size_t rounded_bytes);
+
+  // Records that 'ptr', allocated from the bins for a request of
+  // 'rounded_bytes', may be cached when it is freed.
+  void AddCacheableChunk(void* ptr, size_t rounded_bytes);
+
+  // Caches 'ptr' if it was registered with AddCacheableChunk(). Returns false
+  // if the caller must return 'ptr' to the bins instead.
+  bool DeallocateToCache(void* ptr);
+
+  // Returns all cached chunks to the bins. Returns true if any chunk was
+  // returned.
+  bool FlushSmallAllocationCache();
+
+  // Runs the memory pressure callbacks until they have released at least
+  // 'num_bytes'. Returns true if any memory was released.
+  bool RelieveMemoryPressure(size_t num_bytes);
+
+  bool IsCacheable(size_t num_bytes,
+                   const AllocationAttributes& allocation_attr) const {
+    return cache_shards_ != nullptr && timing_counter_ == nullptr &&
+           opts_.peak_allocation_report_size <= 0 &&
+           allocation_attr.freed_by_func == nullptr && num_bytes > 0 &&
+           RoundedBytes(num_bytes) <= opts_.small_allocation_cache_max_bytes;
+  }
+
   // Chunks whose freed_at_count is later than the safe frontier value are kept
   // on a special list and not subject to merging immediately upon being freed.
   //
@@ -210,6 +316,14 @@ class BFCAllocator : public Allocator {
 
     bool in_use() const { return allocation_id != -1; }
 
+    // The annotation of the allocation using this chunk, only recorded if
+    // Options::peak_allocation_report_size is positive. Chunks are recycled,
+    // so the strings rarely need to allocate.
+    std::string site_op_name;
+    std::string site_shape;
+    int32 site_data_type = 0;
+    int64_t site_step_id = 0;
+
 #ifdef TENSORFLOW_MEM_DEBUG
     // optional debugging info
     const char* op_name = nullptr;
@@ -326,6 +440,17 @@ class BFCAllocator : public Allocator {
     void set_handle(const void* p, ChunkHandle h) { handles_[IndexFor(p)] = h; }
     void erase(const void* p) { set_handle(p, kInvalidChunkHandle); }
 
+    // Returns a region for the part [ptr, ptr + memory_size) of this region,
+    // with the same chunk handles.
+    AllocationRegion Slice(void* ptr, size_t memory_size) const {
+      AllocationRegion slice(ptr, memory_size);
+      const size_t first = IndexFor(ptr);
+      std::copy(handles_.begin() + first,
+                handles_.begin() + first + slice.handles_.size(),
+                slice.handles_.begin());
+      return slice;
+    }
+
    private:
     void Swap(AllocationRegion* other) {
       std::swap(ptr_, other->ptr_);
@@ -408,6 +533,31 @@ class BFCAllocator : public Allocator {
       return regions_.erase(it);
     }
 
+    // Removes [ptr, ptr + memory_size) from the region that contains it, which
+    // leaves the parts of the region before and after the range as separate
+    // regions. The range must not contain chunk handles.
+    void RemoveRange(void* ptr, size_t memory_size) {
+      auto it =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      CHECK(it != regions_.end()) << "Could not find Region for " << ptr;
+      char* begin = static_cast<char*>(it->ptr());
+      char* end = static_cast<char*>(it->end_ptr());
+      char* range_begin = static_cast<char*>(ptr);
+      char* range_end = range_begin + memory_size;
+      DCHECK_LE(range_end, end);
+      std::vector<AllocationRegion> parts;
+      if (range_begin > begin) {
+        parts.push_back(it->Slice(begin, range_begin - begin));
+      }
+      if (end > range_end) {
+        parts.push_back(it->Slice(range_end, end - range_end));
+      }
+      it = regions_.erase(it);
+      for (AllocationRegion& part : parts) {
+        it = regions_.insert(it, std::move(part)) + 1;
+      }
+    }
+
     ChunkHandle get_handle(const void* p) const {
       return RegionFor(p)->get_handle(p);
     }
@@ -510,6 +660,14 @@ class BFCAllocator : public Allocator {
 
   void MarkFree(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Records the current ScopedMemoryDebugAnnotation in 'chunk', and whether
+  // its allocation reached a new peak memory usage.
+  void RecordAllocationSite(Chunk* chunk) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Records the largest in-use chunks into peak_allocations_ if the current
+  // memory usage is a new peak that wasn't recorded yet.
+  void MaybeRecordPeakAllocations() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   ChunkHandle TryToCoalesce(ChunkHandle h, bool ignore_freed_at)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -594,8 +752,58 @@ class BFCAllocator : public Allocator {
   SharedCounter* timing_counter_ = nullptr;
   std::deque<ChunkHandle> timestamped_chunks_;
 
+  // See Options::peak_allocation_report_size.
+  std::vector<PeakAllocation> peak_allocations_ TF_GUARDED_BY(lock_);
+  // The memory usage at which peak_allocations_ were recorded.
+  int64_t peak_allocations_bytes_in_use_ TF_GUARDED_BY(lock_) = 0;
+  // True if the memory usage reached a peak that may need to be recorded.
+  bool at_unrecorded_peak_ TF_GUARDED_BY(lock_) = false;
+
   std::atomic<uint64> safe_frontier_ = {0};
 
+  // A shard of the small-allocation cache. Chunk metadata is sharded by
+  // address, while the free lists are sharded by thread: each thread frees to
+  // and allocates from a fixed shard, so that threads contend on different
+  // locks instead of on 'lock_'.
+  struct CacheShard {
+    mutex mu;
+    struct CacheableChunk {
+      size_t rounded_bytes;  // Rounded size of the request that created it.
+      size_t chunk_bytes;    // Full size of the chunk.
+    };
+    // Every chunk whose address maps to this shard that has been handed out
+    // through the cache path, whether it is in use or cached.
+    absl::flat_hash_map<void*, CacheableChunk> cacheable_chunks
+        TF_GUARDED_BY(mu);
+    // Cached free chunks, indexed by rounded request size in units of
+    // kMinAllocationSize.
+    std::vector<std::vector<std::pair<void*, size_t>>> free_chunks
+        TF_GUARDED_BY(mu);
+  };
+  static constexpr int kNumCacheShards = 16;
+  static constexpr size_t kMaxCachedChunksPerSize = 64;
+
+  CacheShard* CacheShardForPtr(const void* ptr) {
+    return &cache_shards_[(reinterpret_cast<uintptr_t>(ptr) >>
+                           kMinAllocationBits) %
+                          kNumCacheShards];
+  }
+  CacheShard* CacheShardForThread();
+
+  // Null if the small-allocation cache is disabled.
+  std::unique_ptr<CacheShard[]> cache_shards_;
+  std::atomic<int64_t> cache_hits_{0};
+  std::atomic<int64_t> cache_misses_{0};
+  // Bytes held in cached free chunks. These are counted as in use by 'stats_'.
+  std::atomic<int64_t> cached_bytes_{0};
+
+  // Held while memory pressure callbacks run, so that concurrent allocations
+  // do not evict more than needed. Never acquired while holding 'lock_'.
+  mutex memory_pressure_mu_;
+  std::vector<std::pair<int, MemoryPressureCallback>>
+      memory_pressure_callbacks_ TF_GUARDED_BY(memory_pressure_mu_);
+  int next_memory_pressure_callback_id_ TF_GUARDED_BY(memory_pressure_mu_) = 0;
+
   // Structures mutable after construction
   mutable mutex lock_;
   RegionManager region_manager_ TF_GUARDED_BY(lock_);
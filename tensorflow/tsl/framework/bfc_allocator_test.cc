@@ -0,0 +1,294 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/framework/bfc_allocator.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/tsl/platform/mem.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+#include "tensorflow/tsl/profiler/lib/scoped_memory_debug_annotation.h"
+
+namespace tsl {
+namespace {
+
+class HostSubAllocator : public SubAllocator {
+ public:
+  HostSubAllocator() : SubAllocator({}, {}) {}
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    *bytes_received = num_bytes;
+    return port::AlignedMalloc(num_bytes, Allocator::kAllocatorAlignment);
+  }
+  void Free(void* ptr, size_t num_bytes) override { port::AlignedFree(ptr); }
+  bool SupportsCoalescing() const override { return false; }
+};
+
+// Hands out consecutive ranges of a buffer, like a sub-allocator that maps
+// physical memory into a virtual address range, and can free any part of them.
+class VirtualSubAllocator : public SubAllocator {
+ public:
+  VirtualSubAllocator(size_t granularity, size_t size)
+      : SubAllocator({}, {}),
+        base_(static_cast<char*>(port::AlignedMalloc(size, granularity))),
+        size_(size) {}
+  ~VirtualSubAllocator() override { port::AlignedFree(base_); }
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override {
+    if (next_ + num_bytes > size_) return nullptr;
+    void* ptr = base_ + next_;
+    next_ += num_bytes;
+    *bytes_received = num_bytes;
+    return ptr;
+  }
+  void Free(void* ptr, size_t num_bytes) override { freed_bytes_ += num_bytes; }
+  bool SupportsCoalescing() const override { return true; }
+
+  size_t freed_bytes() const { return freed_bytes_; }
+
+ private:
+  char* const base_;
+  const size_t size_;
+  size_t next_ = 0;
+  size_t freed_bytes_ = 0;
+};
+
+BFCAllocator::Options CacheOptions(size_t max_bytes) {
+  BFCAllocator::Options opts;
+  opts.small_allocation_cache_max_bytes = max_bytes;
+  return opts;
+}
+
+TEST(BFCAllocatorTest, SmallAllocationCacheDisabledByDefault) {
+  BFCAllocator a(std::make_unique<HostSubAllocator>(), 1 << 20, "bfc", {});
+  void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  a.DeallocateRaw(p);
+  a.DeallocateRaw(a.AllocateRaw(Allocator::kAllocatorAlignment, 100));
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_cache_hits, 0);
+  EXPECT_EQ(stats->num_cache_misses, 0);
+  EXPECT_EQ(stats->num_allocs, 2);
+}
+
+TEST(BFCAllocatorTest, SmallAllocationCacheReusesChunks) {
+  BFCAllocator a(std::make_unique<HostSubAllocator>(), 1 << 20, "bfc",
+                 CacheOptions(1024));
+  void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  a.DeallocateRaw(p);
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+
+  // Same rounded size: served from the cache.
+  void* q = a.AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  EXPECT_EQ(p, q);
+  // Larger than the cache limit: served from the bins.
+  void* large = a.AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+  stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_cache_hits, 1);
+  EXPECT_EQ(stats->num_cache_misses, 1);
+  EXPECT_EQ(stats->num_allocs, 3);
+  EXPECT_EQ(stats->bytes_in_use, 256 + 4096);
+
+  a.DeallocateRaw(q);
+  a.DeallocateRaw(large);
+  stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+}
+
+TEST(BFCAllocatorTest, SmallAllocationCacheFlushedWhenOutOfMemory) {
+  BFCAllocator::Options opts = CacheOptions(1024);
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  BFCAllocator a(std::make_unique<HostSubAllocator>(), 1 << 16, "bfc", opts);
+  // Fill the whole pool with cached chunks.
+  std::vector<void*> ptrs;
+  for (int i = 0; i < (1 << 16) / 256; ++i) {
+    ptrs.push_back(a.AllocateRaw(Allocator::kAllocatorAlignment, 256));
+    ASSERT_NE(ptrs.back(), nullptr);
+  }
+  for (void* p : ptrs) a.DeallocateRaw(p);
+  // The cached chunks must be merged back to satisfy a large request.
+  void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, 1 << 15);
+  EXPECT_NE(p, nullptr);
+  a.DeallocateRaw(p);
+}
+
+TEST(BFCAllocatorTest, PeakAllocationsAreAttributedToOps) {
+  BFCAllocator::Options opts;
+  opts.peak_allocation_report_size = 2;
+  BFCAllocator a(std::make_unique<HostSubAllocator>(), 1 << 20, "bfc", opts);
+  void* small;
+  void* large;
+  {
+    profiler::ScopedMemoryDebugAnnotation annotation(
+        "small_op", /*step_id=*/1, "output", /*data_type=*/1,
+        [] { return "[64]"; });
+    small = a.AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  }
+  {
+    profiler::ScopedMemoryDebugAnnotation annotation(
+        "large_op", /*step_id=*/1, "output", /*data_type=*/1,
+        [] { return "[1024]"; });
+    large = a.AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+  }
+  // Leaving the peak records the allocations that were live at it.
+  a.DeallocateRaw(large);
+  void* later = a.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+
+  std::vector<BFCAllocator::PeakAllocation> peak = a.GetPeakAllocations();
+  ASSERT_EQ(peak.size(), 2);
+  EXPECT_EQ(peak[0].op_name, "large_op");
+  EXPECT_EQ(peak[0].shape, "[1024]");
+  EXPECT_EQ(peak[0].allocated_bytes, 4096);
+  EXPECT_EQ(peak[1].op_name, "small_op");
+  EXPECT_EQ(peak[1].requested_bytes, 256);
+  EXPECT_NE(a.PeakAllocationReport().find("large_op"), std::string::npos);
+
+  // After clearing the stats, the current usage is the peak.
+  a.ClearStats();
+  peak = a.GetPeakAllocations();
+  ASSERT_EQ(peak.size(), 2);
+  EXPECT_EQ(peak[0].allocated_bytes, 1024);
+  EXPECT_EQ(peak[0].op_name, "");
+  EXPECT_EQ(peak[1].op_name, "small_op");
+
+  a.DeallocateRaw(small);
+  a.DeallocateRaw(later);
+}
+
+TEST(BFCAllocatorTest, MemoryPressureCallbackReleasesMemory) {
+  BFCAllocator::Options opts = CacheOptions(1024);
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  BFCAllocator a(std::make_unique<HostSubAllocator>(), 1 << 16, "bfc", opts);
+  // Fill the whole pool with "cold" buffers that the callback may evict.
+  std::vector<void*> cold;
+  for (int i = 0; i < (1 << 16) / 256; ++i) {
+    cold.push_back(a.AllocateRaw(Allocator::kAllocatorAlignment, 256));
+    ASSERT_NE(cold.back(), nullptr);
+  }
+  EXPECT_EQ(a.AllocateRaw(Allocator::kAllocatorAlignment, 1 << 14), nullptr);
+
+  std::vector<size_t> requests;
+  const int id = a.RegisterMemoryPressureCallback([&](size_t num_bytes) {
+    requests.push_back(num_bytes);
+    size_t released = 0;
+    while (released < num_bytes && !cold.empty()) {
+      a.DeallocateRaw(cold.back());
+      cold.pop_back();
+      released += 256;
+    }
+    return released;
+  });
+  void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, 1 << 14);
+  EXPECT_NE(p, nullptr);
+  ASSERT_EQ(requests.size(), 1);
+  EXPECT_EQ(requests[0], 1 << 14);
+  EXPECT_EQ(cold.size(), ((1 << 16) - (1 << 14)) / 256);
+
+  // Allocations that tolerate failure do not evict.
+  AllocationAttributes no_retry;
+  no_retry.retry_on_failure = false;
+  EXPECT_EQ(a.AllocateRaw(Allocator::kAllocatorAlignment, 1 << 16, no_retry),
+            nullptr);
+  EXPECT_EQ(requests.size(), 1);
+
+  a.UnregisterMemoryPressureCallback(id);
+  a.DeallocateRaw(p);
+  for (void* ptr : cold) a.DeallocateRaw(ptr);
+}
+
+TEST(BFCAllocatorTest, DefragmentationReleasesFreeGranules) {
+  constexpr size_t kGranularity = 1 << 16;
+  constexpr size_t kLimit = 16 * kGranularity;
+  BFCAllocator::Options opts;
+  opts.allow_growth = false;
+  opts.allow_retry_on_failure = false;
+  opts.defragmentation_granularity = kGranularity;
+  auto sub_allocator =
+      std::make_unique<VirtualSubAllocator>(kGranularity, 4 * kLimit);
+  VirtualSubAllocator* sub_allocator_ptr = sub_allocator.get();
+  BFCAllocator a(std::move(sub_allocator), kLimit, "bfc", opts);
+
+  // Free every other block, so that no two free blocks are adjacent.
+  std::vector<void*> live;
+  for (int i = 0; i < 16; ++i) {
+    void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, kGranularity);
+    ASSERT_NE(p, nullptr);
+    if (i % 2 == 0) {
+      a.DeallocateRaw(p);
+    } else {
+      live.push_back(p);
+    }
+  }
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->largest_free_block_bytes, kGranularity);
+  EXPECT_DOUBLE_EQ(stats->fragmentation, 7.0 / 8.0);
+  EXPECT_EQ(a.AllocateRaw(Allocator::kAllocatorAlignment, 2 * kGranularity),
+            nullptr);
+
+  std::vector<void*> reserved = a.ReserveFreeGranules();
+  EXPECT_EQ(reserved.size(), 8);
+  EXPECT_EQ(a.ReleaseReservedGranules(reserved), 8 * kGranularity);
+  EXPECT_EQ(sub_allocator_ptr->freed_bytes(), 8 * kGranularity);
+  stats = a.GetStats();
+  EXPECT_EQ(*stats->pool_bytes, 8 * kGranularity);
+
+  // The released memory is available again, at the end of the pool.
+  void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, 8 * kGranularity);
+  EXPECT_NE(p, nullptr);
+  for (void* ptr : live) EXPECT_EQ(a.RequestedSize(ptr), kGranularity);
+  a.DeallocateRaw(p);
+  for (void* ptr : live) a.DeallocateRaw(ptr);
+}
+
+TEST(BFCAllocatorTest, SmallAllocationCacheConcurrentAccess) {
+  BFCAllocator a(std::make_unique<HostSubAllocator>(), 1 << 24, "bfc",
+                 CacheOptions(4096));
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; ++i) {
+          ptrs.push_back(a.AllocateRaw(Allocator::kAllocatorAlignment,
+                                       1 + (i * 37 + t) % 4096));
+          if (ptrs.size() > 16) {
+            a.DeallocateRaw(ptrs.front());
+            ptrs.erase(ptrs.begin());
+          }
+        }
+        for (void* p : ptrs) a.DeallocateRaw(p);
+      });
+    }
+  }
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+  EXPECT_EQ(stats->num_allocs, 8000);
+  EXPECT_EQ(stats->num_cache_hits + stats->num_cache_misses, 8000);
+}
+
+}  // namespace
+}  // namespace tsl
@@ -43,6 +43,14 @@ class Cache;
 // of Cache uses a least-recently-used eviction policy.
 Cache* NewLRUCache(size_t capacity);
 
+// Same as above, but splits the cache into 2^num_shard_bits independently
+// locked shards (16 by default). Each shard holds capacity / 2^num_shard_bits
+// bytes, so more shards reduce lock contention between threads at the price
+// of a less precise eviction order. num_shard_bits must be in
+// [0, kMaxNumShardBits].
+constexpr int kMaxNumShardBits = 10;
+Cache* NewLRUCache(size_t capacity, int num_shard_bits);
+
 class Cache {
  public:
   Cache() = default;
@@ -235,5 +235,34 @@ TEST_F(CacheTest, ZeroSizeCache) {
   ASSERT_EQ(-1, Lookup(1));
 }
 
+TEST_F(CacheTest, SingleShardIsExactLRU) {
+  delete cache_;
+  cache_ = NewLRUCache(3, /*num_shard_bits=*/0);
+
+  Insert(1, 100);
+  Insert(2, 200);
+  Insert(3, 300);
+  ASSERT_EQ(100, Lookup(1));
+  Insert(4, 400);
+  // 2 is the least recently used entry.
+  ASSERT_EQ(-1, Lookup(2));
+  ASSERT_EQ(100, Lookup(1));
+  ASSERT_EQ(300, Lookup(3));
+  ASSERT_EQ(400, Lookup(4));
+}
+
+TEST_F(CacheTest, ManyShards) {
+  delete cache_;
+  cache_ = NewLRUCache(kCacheSize << kMaxNumShardBits, kMaxNumShardBits);
+
+  for (int i = 0; i < kCacheSize; i++) {
+    Insert(i, 1000 + i);
+  }
+  for (int i = 0; i < kCacheSize; i++) {
+    ASSERT_EQ(1000 + i, Lookup(i));
+  }
+  ASSERT_EQ(kCacheSize, cache_->TotalCharge());
+}
+
 }  // namespace table
 }  // namespace tsl
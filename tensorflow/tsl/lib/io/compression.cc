@@ -23,6 +23,8 @@ const char kNone[] = "";
 const char kGzip[] = "GZIP";
 const char kSnappy[] = "SNAPPY";
 const char kZlib[] = "ZLIB";
+const char kZlibBlock[] = "ZLIB_BLOCK";
+const char kZstd[] = "ZSTD";
 
 }  // namespace compression
 }  // namespace io
@@ -24,6 +24,8 @@ extern const char kNone[];
 extern const char kGzip[];
 extern const char kSnappy[];
 extern const char kZlib[];
+extern const char kZlibBlock[];
+extern const char kZstd[];
 
 }  // namespace compression
 }  // namespace io
@@ -0,0 +1,43 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
+#define TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
+
+#include <string>
+
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// A TFRecord index file lets a reader find the i-th record of a TFRecord
+// file without scanning it. It is written next to the TFRecord file by
+// RecordWriter and read by IndexedRecordReader.
+//
+// Format of an index file, with one entry per record in order:
+//  uint64    offset of the record, as passed to RecordReader::ReadRecord()
+//
+// For compressed TFRecord files the offsets are in the uncompressed data.
+constexpr size_t kRecordIndexEntrySize = sizeof(uint64);
+
+// Returns the name of the index file of the TFRecord file `filename`.
+std::string RecordIndexFilename(StringPiece filename);
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_RECORD_INDEX_H_
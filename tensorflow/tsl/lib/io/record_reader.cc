@@ -17,10 +17,13 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <utility>
+
 #include "tensorflow/tsl/lib/hash/crc32c.h"
 #include "tensorflow/tsl/lib/io/buffered_inputstream.h"
 #include "tensorflow/tsl/lib/io/compression.h"
 #include "tensorflow/tsl/lib/io/random_inputstream.h"
+#include "tensorflow/tsl/lib/io/record_index.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/raw_coding.h"
@@ -46,6 +49,11 @@ RecordReaderOptions RecordReaderOptions::CreateRecordReaderOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordReaderOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZlibBlock) {
+    options.compression_type = io::RecordReaderOptions::ZLIB_BLOCK_COMPRESSION;
+    options.zlib_options = io::ZlibCompressionOptions::DEFAULT();
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -77,6 +85,14 @@ RecordReader::RecordReader(RandomAccessFile* file,
     input_stream_.reset(
         new SnappyInputStream(input_stream_.release(),
                               options.snappy_options.output_buffer_size, true));
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZLIB_BLOCK_COMPRESSION) {
+    input_stream_.reset(new ZlibBlockInputStream(
+        input_stream_.release(), options.zlib_options, true));
+  } else if (options.compression_type ==
+             RecordReaderOptions::ZSTD_COMPRESSION) {
+    input_stream_.reset(new ZstdInputStream(input_stream_.release(),
+                                            options.zstd_options, true));
   } else if (options.compression_type == RecordReaderOptions::NONE) {
     // Nothing to do.
   } else {
@@ -259,5 +275,56 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+Status IndexedRecordReader::Create(
+    Env* env, const string& filename, const RecordReaderOptions& options,
+    std::unique_ptr<IndexedRecordReader>* reader) {
+  const std::string index_filename = RecordIndexFilename(filename);
+  uint64 index_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(index_filename, &index_size));
+  if (index_size % kRecordIndexEntrySize != 0) {
+    return errors::DataLoss("Truncated record index ", index_filename);
+  }
+  std::vector<uint64> offsets(index_size / kRecordIndexEntrySize);
+  if (!offsets.empty()) {
+    std::unique_ptr<RandomAccessFile> index_file;
+    TF_RETURN_IF_ERROR(env->NewRandomAccessFile(index_filename, &index_file));
+    std::string scratch(index_size, '\0');
+    StringPiece index_data;
+    TF_RETURN_IF_ERROR(
+        index_file->Read(0, index_size, &index_data, &scratch[0]));
+    if (index_data.size() != index_size) {
+      return errors::DataLoss("Truncated record index ", index_filename);
+    }
+    for (size_t i = 0; i < offsets.size(); ++i) {
+      offsets[i] =
+          core::DecodeFixed64(index_data.data() + i * kRecordIndexEntrySize);
+      if (i > 0 && offsets[i] <= offsets[i - 1]) {
+        return errors::DataLoss("Corrupted record index ", index_filename);
+      }
+    }
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  reader->reset(
+      new IndexedRecordReader(std::move(file), options, std::move(offsets)));
+  return OkStatus();
+}
+
+IndexedRecordReader::IndexedRecordReader(std::unique_ptr<RandomAccessFile> file,
+                                         const RecordReaderOptions& options,
+                                         std::vector<uint64> offsets)
+    : file_(std::move(file)),
+      underlying_(file_.get(), options),
+      offsets_(std::move(offsets)) {}
+
+Status IndexedRecordReader::ReadRecord(int64_t index, tstring* record) {
+  if (index < 0 || index >= NumRecords()) {
+    return errors::OutOfRange("Record index ", index, " is out of range [0, ",
+                              NumRecords(), ")");
+  }
+  uint64 offset = offsets_[index];
+  return underlying_.ReadRecord(&offset, record);
+}
+
 }  // namespace io
 }  // namespace tsl
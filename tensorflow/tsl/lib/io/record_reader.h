@@ -16,19 +16,26 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_TSL_LIB_IO_RECORD_READER_H_
 
+#include <memory>
+#include <vector>
+
 #include "tensorflow/tsl/lib/io/inputstream_interface.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/tsl/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_inputstream.h"
+#include "tensorflow/tsl/lib/io/zlib_block_inputstream.h"
 #include "tensorflow/tsl/lib/io/zlib_compression_options.h"
 #include "tensorflow/tsl/lib/io/zlib_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/tsl/platform/macros.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
+class Env;
 class RandomAccessFile;
 
 namespace io {
@@ -37,7 +44,11 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Zlib compression of independent blocks, which are decompressed in
+    // parallel, see ZlibBlockInputStream.
+    ZLIB_BLOCK_COMPRESSION = 3,
+    ZSTD_COMPRESSION = 4
   };
   CompressionType compression_type = NONE;
 
@@ -53,6 +64,7 @@ struct RecordReaderOptions {
   // Options specific to compression.
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
+  ZstdCompressionOptions zstd_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -173,6 +185,43 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+// Interface to read the records of a TFRecord file by position, using the
+// index file written along with it by RecordWriter (see record_index.h).
+//
+// Reading a record takes a constant number of reads of the file if it is not
+// compressed and `options.buffer_size` is 0. Otherwise, reading a record
+// before the last one read restarts reading from the beginning of the file.
+//
+// Note: this class is not thread safe; external synchronization required.
+class IndexedRecordReader {
+ public:
+  // Opens the TFRecord file `filename` and loads its index file
+  // RecordIndexFilename(filename).
+  static Status Create(Env* env, const string& filename,
+                       const RecordReaderOptions& options,
+                       std::unique_ptr<IndexedRecordReader>* reader);
+
+  // Returns the number of records of the file.
+  int64_t NumRecords() const { return offsets_.size(); }
+
+  // Read the record at position `index` into *record. Returns OK on success,
+  // OUT_OF_RANGE if `index` is not in [0, NumRecords()), or something else
+  // for an error.
+  Status ReadRecord(int64_t index, tstring* record);
+
+ private:
+  IndexedRecordReader(std::unique_ptr<RandomAccessFile> file,
+                      const RecordReaderOptions& options,
+                      std::vector<uint64> offsets);
+
+  std::unique_ptr<RandomAccessFile> file_;
+  RecordReader underlying_;
+  // Offset of each record.
+  std::vector<uint64> offsets_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(IndexedRecordReader);
+};
+
 }  // namespace io
 }  // namespace tsl
 
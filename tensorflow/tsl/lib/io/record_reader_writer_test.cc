@@ -45,6 +45,13 @@ io::RecordReaderOptions GetMatchingReaderOptions(
   if (options.compression_type == io::RecordWriterOptions::ZLIB_COMPRESSION) {
     return io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
   }
+  if (options.compression_type ==
+      io::RecordWriterOptions::ZLIB_BLOCK_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB_BLOCK");
+  }
+  if (options.compression_type == io::RecordWriterOptions::ZSTD_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("ZSTD");
+  }
   return io::RecordReaderOptions::CreateRecordReaderOptions("");
 }
 
@@ -121,6 +128,18 @@ TEST(RecordReaderWriterTest, TestZlibSyncFlush) {
   VerifyFlush(options);
 }
 
+TEST(RecordReaderWriterTest, TestZlibBlockFlush) {
+  io::RecordWriterOptions options =
+      io::RecordWriterOptions::CreateRecordWriterOptions("ZLIB_BLOCK");
+  VerifyFlush(options);
+}
+
+TEST(RecordReaderWriterTest, TestZstdFlush) {
+  io::RecordWriterOptions options =
+      io::RecordWriterOptions::CreateRecordWriterOptions("ZSTD");
+  VerifyFlush(options);
+}
+
 TEST(RecordReaderWriterTest, TestBasics) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_test";
@@ -343,6 +362,142 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestZlibBlock) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zlib_block_test";
+  constexpr int kNumRecords = 1000;
+
+  for (auto block_size : BufferSizes()) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options;
+      options.compression_type =
+          io::RecordWriterOptions::ZLIB_BLOCK_COMPRESSION;
+      options.zlib_options.block_size = block_size;
+      io::RecordWriter writer(file.get(), options);
+      for (int i = 0; i < kNumRecords; ++i) {
+        TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record ", i)));
+      }
+      TF_CHECK_OK(writer.Close());
+    }
+
+    for (int num_threads : {1, 4}) {
+      std::unique_ptr<RandomAccessFile> read_file;
+      // Read it back with the RecordReader.
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options;
+      options.compression_type =
+          io::RecordReaderOptions::ZLIB_BLOCK_COMPRESSION;
+      options.zlib_options.num_decompression_threads = num_threads;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      uint64 second_record_offset = 0;
+      tstring record;
+      for (int i = 0; i < kNumRecords; ++i) {
+        TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ(strings::StrCat("record ", i), record);
+        if (i == 0) second_record_offset = offset;
+      }
+      EXPECT_EQ(reader.ReadRecord(&offset, &record).code(),
+                error::OUT_OF_RANGE);
+
+      // Seeking backwards restarts decompression from the first block.
+      TF_CHECK_OK(reader.ReadRecord(&second_record_offset, &record));
+      EXPECT_EQ("record 1", record);
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestZstd) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zstd_test";
+  constexpr int kNumRecords = 1000;
+
+  for (auto buf_size : BufferSizes()) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options;
+      options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
+      options.zstd_options.input_buffer_size = buf_size;
+      options.zstd_options.output_buffer_size = buf_size;
+      io::RecordWriter writer(file.get(), options);
+      for (int i = 0; i < kNumRecords; ++i) {
+        TF_EXPECT_OK(writer.WriteRecord(strings::StrCat("record ", i)));
+        if (i % 100 == 0) TF_EXPECT_OK(writer.Flush());
+      }
+      TF_CHECK_OK(writer.Close());
+    }
+
+    {
+      std::unique_ptr<RandomAccessFile> read_file;
+      // Read it back with the RecordReader.
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options;
+      options.compression_type = io::RecordReaderOptions::ZSTD_COMPRESSION;
+      options.zstd_options.input_buffer_size = buf_size;
+      options.zstd_options.output_buffer_size = buf_size;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      tstring record;
+      for (int i = 0; i < kNumRecords; ++i) {
+        TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+        EXPECT_EQ(strings::StrCat("record ", i), record);
+      }
+      EXPECT_EQ(reader.ReadRecord(&offset, &record).code(),
+                error::OUT_OF_RANGE);
+    }
+  }
+}
+
+TEST(RecordReaderWriterTest, TestIndex) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_index_test";
+  constexpr int kNumRecords = 100;
+
+  for (const char* compression_type : {"", "ZLIB", "ZLIB_BLOCK", "ZSTD"}) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+      std::unique_ptr<WritableFile> index_file;
+      TF_CHECK_OK(
+          env->NewWritableFile(io::RecordIndexFilename(fname), &index_file));
+
+      io::RecordWriter writer(
+          file.get(),
+          io::RecordWriterOptions::CreateRecordWriterOptions(compression_type),
+          index_file.get());
+      for (int i = 0; i < kNumRecords; ++i) {
+        TF_EXPECT_OK(
+            writer.WriteRecord(strings::StrCat("record ", i, string(i, 'x'))));
+      }
+      TF_CHECK_OK(writer.Close());
+      TF_CHECK_OK(file->Close());
+      TF_CHECK_OK(index_file->Close());
+    }
+
+    {
+      std::unique_ptr<io::IndexedRecordReader> reader;
+      TF_ASSERT_OK(io::IndexedRecordReader::Create(
+          env, fname,
+          io::RecordReaderOptions::CreateRecordReaderOptions(compression_type),
+          &reader));
+      EXPECT_EQ(kNumRecords, reader->NumRecords());
+      tstring record;
+      for (int i : {42, 7, 99, 0, 7}) {
+        TF_CHECK_OK(reader->ReadRecord(i, &record));
+        EXPECT_EQ(strings::StrCat("record ", i, string(i, 'x')), record);
+      }
+      EXPECT_EQ(reader->ReadRecord(kNumRecords, &record).code(),
+                error::OUT_OF_RANGE);
+      EXPECT_EQ(reader->ReadRecord(-1, &record).code(), error::OUT_OF_RANGE);
+    }
+  }
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -30,6 +30,15 @@ bool IsZlibCompressed(const RecordWriterOptions& options) {
 bool IsSnappyCompressed(const RecordWriterOptions& options) {
   return options.compression_type == RecordWriterOptions::SNAPPY_COMPRESSION;
 }
+
+bool IsZlibBlockCompressed(const RecordWriterOptions& options) {
+  return options.compression_type ==
+         RecordWriterOptions::ZLIB_BLOCK_COMPRESSION;
+}
+
+bool IsZstdCompressed(const RecordWriterOptions& options) {
+  return options.compression_type == RecordWriterOptions::ZSTD_COMPRESSION;
+}
 }  // namespace
 
 RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
@@ -49,6 +58,11 @@ RecordWriterOptions RecordWriterOptions::CreateRecordWriterOptions(
     options.zlib_options = io::ZlibCompressionOptions::GZIP();
   } else if (compression_type == compression::kSnappy) {
     options.compression_type = io::RecordWriterOptions::SNAPPY_COMPRESSION;
+  } else if (compression_type == compression::kZlibBlock) {
+    options.compression_type = io::RecordWriterOptions::ZLIB_BLOCK_COMPRESSION;
+    options.zlib_options = io::ZlibCompressionOptions::DEFAULT();
+  } else if (compression_type == compression::kZstd) {
+    options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
   } else if (compression_type != compression::kNone) {
     LOG(ERROR) << "Unsupported compression_type:" << compression_type
                << ". No compression will be used.";
@@ -79,6 +93,24 @@ RecordWriter::RecordWriter(WritableFile* dest,
     dest_ =
         new SnappyOutputBuffer(dest, options.snappy_options.input_buffer_size,
                                options.snappy_options.output_buffer_size);
+  } else if (IsZlibBlockCompressed(options)) {
+    ZlibBlockOutputBuffer* zlib_block_output_buffer =
+        new ZlibBlockOutputBuffer(dest, options.zlib_options);
+    Status s = zlib_block_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize Zlib block outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = zlib_block_output_buffer;
+  } else if (IsZstdCompressed(options)) {
+    ZstdOutputBuffer* zstd_output_buffer =
+        new ZstdOutputBuffer(dest, options.zstd_options);
+    Status s = zstd_output_buffer->Init();
+    if (!s.ok()) {
+      LOG(FATAL) << "Failed to initialize Zstd outputbuffer. Error: "
+                 << s.ToString();
+    }
+    dest_ = zstd_output_buffer;
   } else if (options.compression_type == RecordWriterOptions::NONE) {
     // Nothing to do
   } else {
@@ -87,6 +119,13 @@ RecordWriter::RecordWriter(WritableFile* dest,
 #endif
 }
 
+RecordWriter::RecordWriter(WritableFile* dest,
+                           const RecordWriterOptions& options,
+                           WritableFile* index_dest)
+    : RecordWriter(dest, options) {
+  index_dest_ = index_dest;
+}
+
 RecordWriter::~RecordWriter() {
   if (dest_ != nullptr) {
     Status s = Close();
@@ -112,7 +151,8 @@ Status RecordWriter::WriteRecord(StringPiece data) {
   PopulateFooter(footer, data.data(), data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return AppendIndexEntry(data.size());
 }
 
 #if defined(TF_CORD_SUPPORT)
@@ -132,19 +172,35 @@ Status RecordWriter::WriteRecord(const absl::Cord& data) {
   PopulateFooter(footer, data);
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
   TF_RETURN_IF_ERROR(dest_->Append(data));
-  return dest_->Append(StringPiece(footer, sizeof(footer)));
+  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(footer, sizeof(footer))));
+  return AppendIndexEntry(data.size());
 }
 #endif
 
+Status RecordWriter::AppendIndexEntry(size_t length) {
+  if (index_dest_ != nullptr) {
+    char entry[kRecordIndexEntrySize];
+    core::EncodeFixed64(entry, offset_);
+    TF_RETURN_IF_ERROR(index_dest_->Append(StringPiece(entry, sizeof(entry))));
+  }
+  offset_ += kHeaderSize + length + kFooterSize;
+  return OkStatus();
+}
+
 Status RecordWriter::Close() {
   if (dest_ == nullptr) return OkStatus();
-  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_)) {
-    Status s = dest_->Close();
+  Status s;
+  if (IsZlibCompressed(options_) || IsSnappyCompressed(options_) ||
+      IsZlibBlockCompressed(options_) || IsZstdCompressed(options_)) {
+    s = dest_->Close();
     delete dest_;
     dest_ = nullptr;
-    return s;
   }
-  return OkStatus();
+  if (index_dest_ != nullptr) {
+    s.Update(index_dest_->Flush());
+    index_dest_ = nullptr;
+  }
+  return s;
 }
 
 Status RecordWriter::Flush() {
@@ -152,7 +208,12 @@ Status RecordWriter::Flush() {
     return Status(::tensorflow::error::FAILED_PRECONDITION,
                   "Writer not initialized or previously closed");
   }
-  return dest_->Flush();
+  // Flushes the data first so that the index never refers to missing records.
+  TF_RETURN_IF_ERROR(dest_->Flush());
+  if (index_dest_ != nullptr) {
+    return index_dest_->Flush();
+  }
+  return OkStatus();
 }
 
 }  // namespace io
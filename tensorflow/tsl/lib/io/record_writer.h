@@ -17,14 +17,18 @@ limitations under the License.
 #define TENSORFLOW_TSL_LIB_IO_RECORD_WRITER_H_
 
 #include "tensorflow/tsl/lib/hash/crc32c.h"
+#include "tensorflow/tsl/lib/io/record_index.h"
 #include "tensorflow/tsl/platform/coding.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
 #if !defined(IS_SLIM_BUILD)
 #include "tensorflow/tsl/lib/io/snappy/snappy_compression_options.h"
 #include "tensorflow/tsl/lib/io/snappy/snappy_outputbuffer.h"
+#include "tensorflow/tsl/lib/io/zlib_block_outputbuffer.h"
 #include "tensorflow/tsl/lib/io/zlib_compression_options.h"
 #include "tensorflow/tsl/lib/io/zlib_outputbuffer.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_outputbuffer.h"
 #endif  // IS_SLIM_BUILD
 #include "tensorflow/tsl/platform/cord.h"
 #include "tensorflow/tsl/platform/macros.h"
@@ -41,7 +45,10 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    // Zlib compression of independent blocks, see ZlibBlockOutputBuffer.
+    ZLIB_BLOCK_COMPRESSION = 3,
+    ZSTD_COMPRESSION = 4
   };
   CompressionType compression_type = NONE;
 
@@ -52,6 +59,7 @@ struct RecordWriterOptions {
   // Options specific to compression.
   io::ZlibCompressionOptions zlib_options;
   io::SnappyCompressionOptions snappy_options;
+  io::ZstdCompressionOptions zstd_options;
 #endif  // IS_SLIM_BUILD
 };
 
@@ -71,6 +79,14 @@ class RecordWriter {
   explicit RecordWriter(WritableFile* dest, const RecordWriterOptions& options =
                                                 RecordWriterOptions());
 
+  // Create a writer that will append data to "*dest" and the index of the
+  // records to "*index_dest", see record_index.h. The index file is usually
+  // named RecordIndexFilename() of the data file.
+  // "*dest" and "*index_dest" must be initially empty.
+  // "*dest" and "*index_dest" must remain live while this Writer is in use.
+  RecordWriter(WritableFile* dest, const RecordWriterOptions& options,
+               WritableFile* index_dest);
+
   // Calls Close() and logs if an error occurs.
   //
   // TODO(jhseu): Require that callers explicitly call Close() and remove the
@@ -85,7 +101,7 @@ class RecordWriter {
 
   // Flushes any buffered data held by underlying containers of the
   // RecordWriter to the WritableFile. Does *not* flush the
-  // WritableFile.
+  // WritableFile. Flushes the index file, if any.
   Status Flush();
 
   // Writes all output to the file. Does *not* close the WritableFile.
@@ -111,9 +127,18 @@ class RecordWriter {
 #endif
 
  private:
+  // Appends the index entry of the next record, of `length` bytes, if this
+  // writer writes an index.
+  Status AppendIndexEntry(size_t length);
+
   WritableFile* dest_;
   RecordWriterOptions options_;
 
+  // Not owned, null if no index is written.
+  WritableFile* index_dest_ = nullptr;
+  // Offset of the next record in the uncompressed data.
+  uint64 offset_ = 0;
+
   inline static uint32 MaskedCrc(const char* data, size_t n) {
     return crc32c::Mask(crc32c::Value(data, n));
   }
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/tsl/lib/io/table.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+
 #include "tensorflow/tsl/lib/io/block.h"
 #include "tensorflow/tsl/lib/io/cache.h"
 #include "tensorflow/tsl/lib/io/format.h"
@@ -26,6 +31,75 @@ limitations under the License.
 
 namespace tsl {
 namespace table {
+namespace {
+
+// A RandomAccessFile that detects sequential reads of a single iterator and
+// reads ahead of them. Data blocks are laid out back to back in the file, so
+// after two adjacent block reads, the next read fetches `readahead_size`
+// bytes and the following blocks are copied from memory.
+//
+// Not thread-safe: each iterator owns its own instance.
+class ReadaheadFile : public RandomAccessFile {
+ public:
+  ReadaheadFile(RandomAccessFile* file, size_t readahead_size)
+      : file_(file), readahead_size_(readahead_size) {}
+
+  Status Name(StringPiece* result) const override {
+    return file_->Name(result);
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    if (offset >= buffer_offset_ &&
+        offset + n <= buffer_offset_ + buffer_.size()) {
+      memcpy(scratch, buffer_.data() + (offset - buffer_offset_), n);
+      *result = StringPiece(scratch, n);
+      last_read_end_ = offset + n;
+      return OkStatus();
+    }
+    const bool sequential = offset == last_read_end_;
+    last_read_end_ = offset + n;
+    if (!sequential || n >= readahead_size_) {
+      return file_->Read(offset, n, result, scratch);
+    }
+
+    buffer_.resize(readahead_size_);
+    StringPiece data;
+    Status s = file_->Read(offset, readahead_size_, &data, &buffer_[0]);
+    // Reading past the end of the file is expected near the end of the
+    // data blocks.
+    if (!s.ok() && !errors::IsOutOfRange(s)) {
+      buffer_.clear();
+      return s;
+    }
+    if (data.data() != buffer_.data()) {
+      buffer_.assign(data.data(), data.size());
+    } else {
+      buffer_.resize(data.size());
+    }
+    buffer_offset_ = offset;
+
+    const size_t available = std::min(n, buffer_.size());
+    memcpy(scratch, buffer_.data(), available);
+    *result = StringPiece(scratch, available);
+    if (available < n) {
+      return errors::OutOfRange("Read less bytes than requested");
+    }
+    return OkStatus();
+  }
+
+ private:
+  RandomAccessFile* file_;  // Not owned.
+  const size_t readahead_size_;
+
+  // Bytes [buffer_offset_, buffer_offset_ + buffer_.size()) of the file.
+  mutable std::string buffer_;
+  mutable uint64 buffer_offset_ = 0;
+  // End of the previous read, to detect sequential reads.
+  mutable uint64 last_read_end_ = std::numeric_limits<uint64>::max();
+};
+
+}  // namespace
 
 struct Table::Rep {
   ~Rep() { delete index_block; }
@@ -83,6 +157,14 @@ Status Table::Open(const Options& options, RandomAccessFile* file, uint64 size,
 
 Table::~Table() { delete rep_; }
 
+struct Table::IteratorState {
+  IteratorState(Table* table, size_t readahead_size)
+      : table(table), file(table->rep_->file, readahead_size) {}
+
+  Table* table;
+  ReadaheadFile file;
+};
+
 static void DeleteBlock(void* arg, void* ignored) {
   delete reinterpret_cast<Block*>(arg);
 }
@@ -102,7 +184,18 @@ static void ReleaseBlock(void* arg, void* h) {
 // into an iterator over the contents of the corresponding block.
 Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
   Table* table = reinterpret_cast<Table*>(arg);
-  Cache* block_cache = table->rep_->options.block_cache;
+  return table->ReadBlockIterator(table->rep_->file, index_value);
+}
+
+Iterator* Table::IteratorBlockReader(void* arg,
+                                     const StringPiece& index_value) {
+  IteratorState* state = reinterpret_cast<IteratorState*>(arg);
+  return state->table->ReadBlockIterator(&state->file, index_value);
+}
+
+Iterator* Table::ReadBlockIterator(RandomAccessFile* file,
+                                   const StringPiece& index_value) {
+  Cache* block_cache = rep_->options.block_cache;
   Block* block = nullptr;
   Cache::Handle* cache_handle = nullptr;
 
@@ -116,14 +209,14 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
     BlockContents contents;
     if (block_cache != nullptr) {
       char cache_key_buffer[16];
-      core::EncodeFixed64(cache_key_buffer, table->rep_->cache_id);
+      core::EncodeFixed64(cache_key_buffer, rep_->cache_id);
       core::EncodeFixed64(cache_key_buffer + 8, handle.offset());
       absl::string_view key(cache_key_buffer, sizeof(cache_key_buffer));
       cache_handle = block_cache->Lookup(key);
       if (cache_handle != nullptr) {
         block = reinterpret_cast<Block*>(block_cache->Value(cache_handle));
       } else {
-        s = ReadBlock(table->rep_->file, handle, &contents);
+        s = ReadBlock(file, handle, &contents);
         if (s.ok()) {
           block = new Block(contents);
           cache_handle = block_cache->Insert(key, block, block->size(),
@@ -131,7 +224,7 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
         }
       }
     } else {
-      s = ReadBlock(table->rep_->file, handle, &contents);
+      s = ReadBlock(file, handle, &contents);
       if (s.ok()) {
         block = new Block(contents);
       }
@@ -153,8 +246,21 @@ Iterator* Table::BlockReader(void* arg, const StringPiece& index_value) {
 }
 
 Iterator* Table::NewIterator() const {
-  return NewTwoLevelIterator(rep_->index_block->NewIterator(),
-                             &Table::BlockReader, const_cast<Table*>(this));
+  if (rep_->options.readahead_size == 0) {
+    return NewTwoLevelIterator(rep_->index_block->NewIterator(),
+                               &Table::BlockReader, const_cast<Table*>(this));
+  }
+  IteratorState* state = new IteratorState(const_cast<Table*>(this),
+                                           rep_->options.readahead_size);
+  Iterator* iter = NewTwoLevelIterator(rep_->index_block->NewIterator(),
+                                       &Table::IteratorBlockReader, state);
+  // Cleanup functions run after the data block iterator has been deleted.
+  iter->RegisterCleanup(
+      [](void* arg, void* ignored) {
+        delete reinterpret_cast<IteratorState*>(arg);
+      },
+      state, nullptr);
+  return iter;
 }
 
 Status Table::InternalGet(const StringPiece& k, void* arg,
@@ -66,7 +66,13 @@ class Table {
   Rep* rep_;
 
   explicit Table(Rep* rep) { rep_ = rep; }
+  struct IteratorState;
+
   static Iterator* BlockReader(void*, const StringPiece&);
+  // Same as BlockReader, with an IteratorState as the first argument.
+  static Iterator* IteratorBlockReader(void*, const StringPiece&);
+  Iterator* ReadBlockIterator(RandomAccessFile* file,
+                              const StringPiece& index_value);
 
   // Calls (*handle_result)(arg, ...) with the entry found after a call
   // to Seek(key).  May not make such a call if filter policy says
@@ -68,6 +68,12 @@ struct Options {
 
   // If non-null, use the specified cache for blocks.
   Cache* block_cache = nullptr;
+
+  // If non-zero, an iterator that reads two adjacent blocks from the file
+  // reads the following blocks in chunks of this many bytes, which speeds up
+  // sequential scans on file systems with a high per-read latency. Lookups
+  // of single keys are not affected.
+  size_t readahead_size = 0;
 };
 
 }  // namespace table
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/snappy.h"
+#include "tensorflow/tsl/platform/stringprintf.h"
 #include "tensorflow/tsl/platform/test.h"
 
 namespace tsl {
@@ -118,7 +119,9 @@ class StringSink : public WritableFile {
 class StringSource : public RandomAccessFile {
  public:
   explicit StringSource(const StringPiece& contents)
-      : contents_(contents.data(), contents.size()), bytes_read_(0) {}
+      : contents_(contents.data(), contents.size()),
+        bytes_read_(0),
+        num_reads_(0) {}
 
   ~StringSource() override {}
 
@@ -139,14 +142,17 @@ class StringSource : public RandomAccessFile {
     memcpy(scratch, &contents_[offset], n);
     *result = StringPiece(scratch, n);
     bytes_read_ += n;
+    num_reads_++;
     return OkStatus();
   }
 
   uint64 BytesRead() const { return bytes_read_; }
+  uint64 NumReads() const { return num_reads_; }
 
  private:
   string contents_;
   mutable uint64 bytes_read_;
+  mutable uint64 num_reads_;
 };
 
 typedef std::map<string, string, STLLessThan> KVMap;
@@ -236,6 +242,7 @@ class TableConstructor : public Constructor {
     // Open the table
     source_ = new StringSource(sink.contents());
     Options table_options;
+    table_options.readahead_size = options.readahead_size;
     return Table::Open(table_options, source_, sink.contents().size(), &table_);
   }
 
@@ -246,6 +253,7 @@ class TableConstructor : public Constructor {
   }
 
   uint64 BytesRead() const { return source_->BytesRead(); }
+  uint64 NumReads() const { return source_->NumReads(); }
 
  private:
   void Reset() {
@@ -633,5 +641,47 @@ TEST(TableTest, SeekToFirstKeyDoesNotReadTooMuch) {
   EXPECT_LT(c.BytesRead(), 200);
 }
 
+TEST(TableTest, ReadaheadForSequentialScans) {
+  constexpr int kNumKeys = 1000;
+  for (size_t readahead_size : {0, 1 << 16}) {
+    TableConstructor c;
+    for (int i = 0; i < kNumKeys; i++) {
+      c.Add(strings::Printf("k%04d", i), string(100, 'a' + i % 26));
+    }
+    std::vector<string> keys;
+    KVMap kvmap;
+    Options options;
+    options.block_size = 1024;
+    options.compression = kNoCompression;
+    options.readahead_size = readahead_size;
+    c.Finish(options, &keys, &kvmap);
+
+    // A single lookup does not read ahead.
+    uint64 bytes_read = c.BytesRead();
+    Iterator* iter = c.NewIterator();
+    iter->Seek("k0500");
+    ASSERT_TRUE(iter->Valid());
+    EXPECT_LT(c.BytesRead() - bytes_read, 2000);
+    delete iter;
+
+    const uint64 num_reads = c.NumReads();
+    iter = c.NewIterator();
+    int i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+      EXPECT_EQ(strings::Printf("k%04d", i), iter->key());
+      EXPECT_EQ(string(100, 'a' + i % 26), iter->value());
+    }
+    EXPECT_TRUE(iter->status().ok());
+    EXPECT_EQ(kNumKeys, i);
+    delete iter;
+    // The table has about 100 data blocks.
+    if (readahead_size == 0) {
+      EXPECT_GT(c.NumReads() - num_reads, 50);
+    } else {
+      EXPECT_LT(c.NumReads() - num_reads, 10);
+    }
+  }
+}
+
 }  // namespace table
 }  // namespace tsl
@@ -0,0 +1,236 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/zlib_block_inputstream.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/tsl/lib/hash/crc32c.h"
+#include "tensorflow/tsl/platform/coding.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/notification.h"
+#include "tensorflow/tsl/platform/strcat.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// See ZlibBlockOutputBuffer for the format of a block.
+constexpr size_t kBlockHeaderSize = 3 * sizeof(uint32);
+
+}  // namespace
+
+struct ZlibBlockInputStream::Block {
+  tstring compressed;
+  uint32 uncompressed_size;
+  // Valid once `decompressed` is notified.
+  tstring data;
+  Status status;
+  Notification decompressed;
+};
+
+namespace {
+
+Status Decompress(int window_bits, tstring* compressed,
+                  uint32 uncompressed_size, tstring* data) {
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  stream.zalloc = Z_NULL;
+  stream.zfree = Z_NULL;
+  stream.opaque = Z_NULL;
+  int error = inflateInit2(&stream, window_bits);
+  if (error != Z_OK) {
+    return errors::DataLoss("inflateInit failed with status ", error);
+  }
+  data->resize_uninitialized(uncompressed_size);
+  stream.next_in = reinterpret_cast<Bytef*>(compressed->mdata());
+  stream.avail_in = compressed->size();
+  stream.next_out = reinterpret_cast<Bytef*>(data->mdata());
+  stream.avail_out = uncompressed_size;
+  error = inflate(&stream, Z_FINISH);
+  Status status;
+  if (error != Z_STREAM_END || stream.avail_out != 0) {
+    string error_string =
+        strings::StrCat("inflate() failed with error ", error);
+    if (stream.msg != nullptr) {
+      strings::StrAppend(&error_string, ": ", stream.msg);
+    }
+    status = errors::DataLoss(error_string);
+  }
+  inflateEnd(&stream);
+  // The compressed data is not needed anymore.
+  compressed->clear();
+  return status;
+}
+
+}  // namespace
+
+ZlibBlockInputStream::ZlibBlockInputStream(
+    InputStreamInterface* input_stream,
+    const ZlibCompressionOptions& zlib_options, bool owns_input_stream)
+    : input_stream_(input_stream),
+      zlib_options_(zlib_options),
+      owns_input_stream_(owns_input_stream) {
+  if (zlib_options_.num_decompression_threads > 1) {
+    thread_pool_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "zlib_block_decompress",
+        zlib_options_.num_decompression_threads);
+  }
+}
+
+ZlibBlockInputStream::ZlibBlockInputStream(
+    InputStreamInterface* input_stream,
+    const ZlibCompressionOptions& zlib_options)
+    : ZlibBlockInputStream(input_stream, zlib_options, false) {}
+
+ZlibBlockInputStream::~ZlibBlockInputStream() {
+  ClearBlocks();
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZlibBlockInputStream::ReadCompressedBlock(
+    std::unique_ptr<Block>* block) {
+  block->reset();
+  tstring header;
+  Status s = input_stream_->ReadNBytes(kBlockHeaderSize, &header);
+  if (errors::IsOutOfRange(s)) {
+    if (header.empty()) return OkStatus();
+    return errors::DataLoss("Truncated block header. Possible data "
+                            "corruption.");
+  }
+  TF_RETURN_IF_ERROR(s);
+  const uint32 masked_crc =
+      core::DecodeFixed32(header.data() + 2 * sizeof(uint32));
+  if (crc32c::Unmask(masked_crc) !=
+      crc32c::Value(header.data(), 2 * sizeof(uint32))) {
+    return errors::DataLoss("Corrupted block header. Is this a ZLIB_BLOCK "
+                            "compressed file?");
+  }
+  const uint32 compressed_size = core::DecodeFixed32(header.data());
+
+  auto new_block = std::make_unique<Block>();
+  new_block->uncompressed_size =
+      core::DecodeFixed32(header.data() + sizeof(uint32));
+  s = input_stream_->ReadNBytes(compressed_size, &new_block->compressed);
+  if (errors::IsOutOfRange(s)) {
+    return errors::DataLoss("Failed to read ", compressed_size,
+                            " bytes from file. Possible data corruption.");
+  }
+  TF_RETURN_IF_ERROR(s);
+  *block = std::move(new_block);
+  return OkStatus();
+}
+
+Status ZlibBlockInputStream::ReadAhead() {
+  // Keeps every decompression thread busy in addition to the block being
+  // consumed.
+  const size_t max_blocks =
+      thread_pool_ ? thread_pool_->NumThreads() + 1 : size_t{1};
+  while (!input_exhausted_ && blocks_.size() < max_blocks) {
+    std::unique_ptr<Block> block;
+    TF_RETURN_IF_ERROR(ReadCompressedBlock(&block));
+    if (block == nullptr) {
+      input_exhausted_ = true;
+      break;
+    }
+    Block* block_ptr = block.get();
+    auto decompress = [block_ptr, window_bits = zlib_options_.window_bits]() {
+      block_ptr->status =
+          Decompress(window_bits, &block_ptr->compressed,
+                     block_ptr->uncompressed_size, &block_ptr->data);
+      block_ptr->decompressed.Notify();
+    };
+    blocks_.push_back(std::move(block));
+    if (thread_pool_) {
+      thread_pool_->Schedule(std::move(decompress));
+    } else {
+      decompress();
+    }
+  }
+  return OkStatus();
+}
+
+void ZlibBlockInputStream::ClearBlocks() {
+  for (const auto& block : blocks_) {
+    block->decompressed.WaitForNotification();
+  }
+  blocks_.clear();
+  pos_in_block_ = 0;
+}
+
+Status ZlibBlockInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->resize_uninitialized(bytes_to_read);
+  char* result_ptr = result->mdata();
+  int64_t bytes_remaining = bytes_to_read;
+  while (bytes_remaining > 0) {
+    TF_RETURN_IF_ERROR(ReadAhead());
+    if (blocks_.empty()) {
+      result->resize(bytes_to_read - bytes_remaining);
+      return errors::OutOfRange("EOF reached");
+    }
+    Block* block = blocks_.front().get();
+    block->decompressed.WaitForNotification();
+    TF_RETURN_IF_ERROR(block->status);
+    const size_t bytes_to_copy = std::min<size_t>(
+        bytes_remaining, block->data.size() - pos_in_block_);
+    memcpy(result_ptr, block->data.data() + pos_in_block_, bytes_to_copy);
+    result_ptr += bytes_to_copy;
+    bytes_remaining -= bytes_to_copy;
+    bytes_read_ += bytes_to_copy;
+    pos_in_block_ += bytes_to_copy;
+    if (pos_in_block_ == block->data.size()) {
+      blocks_.pop_front();
+      pos_in_block_ = 0;
+    }
+  }
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZlibBlockInputStream::ReadNBytes(int64_t bytes_to_read,
+                                        absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(absl::string_view(buf.data(), buf.size()));
+  return OkStatus();
+}
+#endif
+
+int64_t ZlibBlockInputStream::Tell() const { return bytes_read_; }
+
+Status ZlibBlockInputStream::Reset() {
+  ClearBlocks();
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  input_exhausted_ = false;
+  bytes_read_ = 0;
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,113 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_INPUTSTREAM_H_
+
+#include <deque>
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/inputstream_interface.h"
+#include "tensorflow/tsl/lib/io/zlib_compression_options.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// An InputStream that reads data in the zlib block format written by
+// ZlibBlockOutputBuffer.
+//
+// The compressed blocks are read ahead from `input_stream` on the calling
+// thread and decompressed on up to `zlib_options.num_decompression_threads`
+// threads, so that decompression does not limit the read throughput of a
+// single file.
+class ZlibBlockInputStream : public InputStreamInterface {
+ public:
+  // Create a ZlibBlockInputStream for `input_stream`.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  ZlibBlockInputStream(InputStreamInterface* input_stream,
+                       const ZlibCompressionOptions& zlib_options,
+                       bool owns_input_stream);
+
+  // Equivalent to the previous constructor with owns_input_stream = false.
+  ZlibBlockInputStream(InputStreamInterface* input_stream,
+                       const ZlibCompressionOptions& zlib_options);
+
+  ~ZlibBlockInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If a block is corrupted or truncated.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status ReadNBytes(int64_t bytes_to_read, absl::Cord* result) override;
+#endif
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  struct Block;
+
+  // Reads compressed blocks from `input_stream_` and schedules their
+  // decompression until enough blocks are in flight or the input is
+  // exhausted.
+  Status ReadAhead();
+
+  // Reads the next compressed block from `input_stream_` into *block. Sets
+  // *block to null at the end of the input.
+  Status ReadCompressedBlock(std::unique_ptr<Block>* block);
+
+  // Waits for the decompression of all blocks in flight and drops them.
+  void ClearBlocks();
+
+  InputStreamInterface* input_stream_;
+  const ZlibCompressionOptions zlib_options_;
+  const bool owns_input_stream_;
+
+  // Null if blocks are decompressed on the reading thread.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  // Blocks read from `input_stream_` in order. The front block is the one
+  // being consumed, the others are being decompressed.
+  std::deque<std::unique_ptr<Block>> blocks_;
+
+  // Number of bytes of the front block already consumed.
+  size_t pos_in_block_ = 0;
+
+  // Whether all blocks of `input_stream_` have been read.
+  bool input_exhausted_ = false;
+
+  // Specifies the number of decompressed bytes currently read.
+  int64_t bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZlibBlockInputStream);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_INPUTSTREAM_H_
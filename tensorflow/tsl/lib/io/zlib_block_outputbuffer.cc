@@ -0,0 +1,170 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/zlib_block_outputbuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "tensorflow/tsl/lib/hash/crc32c.h"
+#include "tensorflow/tsl/platform/coding.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/strcat.h"
+
+namespace tsl {
+namespace io {
+
+ZlibBlockOutputBuffer::ZlibBlockOutputBuffer(
+    WritableFile* file, const ZlibCompressionOptions& zlib_options)
+    : file_(file), zlib_options_(zlib_options) {}
+
+ZlibBlockOutputBuffer::~ZlibBlockOutputBuffer() {
+  if (z_stream_) {
+    if (!buffer_.empty()) {
+      LOG(WARNING) << "ZlibBlockOutputBuffer::Close() not called. Possible "
+                      "data loss";
+    }
+    deflateEnd(z_stream_.get());
+  }
+}
+
+Status ZlibBlockOutputBuffer::Init() {
+  if (zlib_options_.block_size <= 0 ||
+      zlib_options_.block_size > std::numeric_limits<int32>::max()) {
+    return errors::InvalidArgument(
+        "block_size should be positive and less than 2GB, got ",
+        zlib_options_.block_size);
+  }
+  z_stream_.reset(new z_stream);
+  memset(z_stream_.get(), 0, sizeof(z_stream));
+  z_stream_->zalloc = Z_NULL;
+  z_stream_->zfree = Z_NULL;
+  z_stream_->opaque = Z_NULL;
+  int status =
+      deflateInit2(z_stream_.get(), zlib_options_.compression_level,
+                   zlib_options_.compression_method, zlib_options_.window_bits,
+                   zlib_options_.mem_level, zlib_options_.compression_strategy);
+  if (status != Z_OK) {
+    z_stream_.reset(nullptr);
+    return errors::InvalidArgument("deflateInit failed with status ", status);
+  }
+  buffer_.reserve(zlib_options_.block_size);
+  return OkStatus();
+}
+
+Status ZlibBlockOutputBuffer::Append(StringPiece data) {
+  if (!z_stream_) {
+    return errors::FailedPrecondition(
+        "ZlibBlockOutputBuffer not initialized or previously closed");
+  }
+  const size_t block_size = zlib_options_.block_size;
+  // Completes the partially buffered block first.
+  if (!buffer_.empty()) {
+    const size_t n = std::min(block_size - buffer_.size(), data.size());
+    buffer_.append(data.data(), n);
+    data.remove_prefix(n);
+    if (buffer_.size() < block_size) return OkStatus();
+    TF_RETURN_IF_ERROR(WriteBlock(buffer_));
+    buffer_.clear();
+  }
+  // Whole blocks are compressed directly from `data`.
+  while (data.size() >= block_size) {
+    TF_RETURN_IF_ERROR(WriteBlock(data.substr(0, block_size)));
+    data.remove_prefix(block_size);
+  }
+  buffer_.append(data.data(), data.size());
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZlibBlockOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return OkStatus();
+}
+#endif
+
+Status ZlibBlockOutputBuffer::WriteBlock(StringPiece data) {
+  int error = deflateReset(z_stream_.get());
+  if (error != Z_OK) {
+    return errors::DataLoss("deflateReset() failed with error ", error);
+  }
+  const size_t max_compressed_size =
+      deflateBound(z_stream_.get(), data.size());
+  compressed_.resize(kBlockHeaderSize + max_compressed_size);
+  z_stream_->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  z_stream_->avail_in = data.size();
+  z_stream_->next_out =
+      reinterpret_cast<Bytef*>(&compressed_[kBlockHeaderSize]);
+  z_stream_->avail_out = max_compressed_size;
+  // The output buffer is large enough to compress the block in one call.
+  error = deflate(z_stream_.get(), Z_FINISH);
+  if (error != Z_STREAM_END) {
+    string error_string =
+        strings::StrCat("deflate() failed with error ", error);
+    if (z_stream_->msg != nullptr) {
+      strings::StrAppend(&error_string, ": ", z_stream_->msg);
+    }
+    return errors::DataLoss(error_string);
+  }
+  const size_t compressed_size = max_compressed_size - z_stream_->avail_out;
+
+  char* header = &compressed_[0];
+  core::EncodeFixed32(header, compressed_size);
+  core::EncodeFixed32(header + sizeof(uint32), data.size());
+  core::EncodeFixed32(header + 2 * sizeof(uint32),
+                      crc32c::Mask(crc32c::Value(header, 2 * sizeof(uint32))));
+  return file_->Append(
+      StringPiece(compressed_.data(), kBlockHeaderSize + compressed_size));
+}
+
+Status ZlibBlockOutputBuffer::Flush() {
+  if (z_stream_ && !buffer_.empty()) {
+    TF_RETURN_IF_ERROR(WriteBlock(buffer_));
+    buffer_.clear();
+  }
+  return file_->Flush();
+}
+
+Status ZlibBlockOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZlibBlockOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZlibBlockOutputBuffer::Close() {
+  if (z_stream_) {
+    if (!buffer_.empty()) {
+      TF_RETURN_IF_ERROR(WriteBlock(buffer_));
+      buffer_.clear();
+    }
+    deflateEnd(z_stream_.get());
+    z_stream_.reset(nullptr);
+  }
+  return OkStatus();
+}
+
+Status ZlibBlockOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
+}  // namespace io
+}  // namespace tsl
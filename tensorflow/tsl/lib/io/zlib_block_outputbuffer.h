@@ -0,0 +1,111 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_OUTPUTBUFFER_H_
+#define TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_OUTPUTBUFFER_H_
+
+#include <zlib.h>
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/tsl/lib/io/zlib_compression_options.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Provides support for writing data in the zlib block format, in which the
+// data is split into blocks of `zlib_options.block_size` uncompressed bytes
+// and each block is compressed independently. Unlike a single zlib stream,
+// this lets a reader decompress several blocks in parallel (see
+// ZlibBlockInputStream).
+//
+// Format of a single block:
+//  uint32    length of the compressed data
+//  uint32    length of the uncompressed data
+//  uint32    masked crc of the two lengths
+//  byte      compressed data[length]
+//
+// The compressed data of a block is a complete zlib stream, written with the
+// compression parameters in `zlib_options`. The block headers are the index
+// of the file: a reader can locate every block without decompressing any.
+class ZlibBlockOutputBuffer : public WritableFile {
+ public:
+  static constexpr size_t kBlockHeaderSize = 3 * sizeof(uint32);
+
+  // Create a ZlibBlockOutputBuffer for `file`. `file` must outlive this
+  // buffer and is not owned.
+  ZlibBlockOutputBuffer(WritableFile* file,
+                        const ZlibCompressionOptions& zlib_options);
+
+  ~ZlibBlockOutputBuffer() override;
+
+  // Initializes the compression stream. Must be called before any other
+  // method.
+  Status Init();
+
+  // Buffers `data` and writes out every block that is complete.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Writes out the buffered data as a (possibly short) block and flushes the
+  // underlying file.
+  Status Flush() override;
+
+  // Writes out the buffered data as a (possibly short) block. Does *not*
+  // close the underlying file.
+  //
+  // After calling Close(), any further calls to `Append()` or `Flush()` are
+  // invalid.
+  Status Close() override;
+
+  Status Name(StringPiece* result) const override;
+
+  Status Sync() override;
+
+  Status Tell(int64_t* position) override;
+
+ private:
+  // Compresses `data` as a single block and appends it to the file.
+  Status WriteBlock(StringPiece data);
+
+  WritableFile* file_;  // Not owned
+  ZlibCompressionOptions const zlib_options_;
+
+  // Reset for every block. Null before Init() and after Close().
+  std::unique_ptr<z_stream> z_stream_;
+
+  // Uncompressed data not yet written as a block.
+  std::string buffer_;
+
+  // Scratch space for the compressed data of a block.
+  std::string compressed_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZlibBlockOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZLIB_BLOCK_OUTPUTBUFFER_H_
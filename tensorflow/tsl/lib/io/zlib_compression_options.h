@@ -117,6 +117,19 @@ class ZlibCompressionOptions {
   //
   // This option is ignored for `ZlibOutputBuffer`.
   bool soft_fail_on_error = false;  // NOLINT
+
+  // Options for the block format written by `ZlibBlockOutputBuffer` and read
+  // by `ZlibBlockInputStream`, in which the data is split into independently
+  // compressed blocks that can be decompressed in parallel.
+
+  // Size of the uncompressed data of a block, must be less than 2GB.
+  int64_t block_size = 1 << 20;
+
+  // Number of threads decompressing blocks ahead of the reader. Blocks are
+  // decompressed on the reading thread if this is at most 1.
+  //
+  // This option is ignored for `ZlibBlockOutputBuffer`.
+  int32 num_decompression_threads = 4;
 };
 
 inline ZlibCompressionOptions ZlibCompressionOptions::DEFAULT() {
@@ -0,0 +1,58 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+#define TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
+
+#include <string>
+
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+struct ZstdCompressionOptions {
+  // Size of the buffer used for caching the compressed data read from the
+  // source file.
+  int64_t input_buffer_size = 128 << 10;
+
+  // Size of the sink buffer where the compressed/decompressed data produced by
+  // zstd is cached.
+  int64_t output_buffer_size = 128 << 10;
+
+  // From the zstd manual (http://facebook.github.io/zstd/zstd_manual.html):
+  // Compression levels range from 1 (fastest) to 22 (strongest). Negative
+  // levels are faster still and trade ratio for speed. Level 3 is zstd's
+  // default.
+  //
+  // This option is ignored for `ZstdInputStream`.
+  int32 compression_level = 3;
+
+  // Base two logarithm of the largest back-reference distance. 0 lets zstd
+  // pick it from `compression_level`. Windows larger than 2^27 require the
+  // same value to be set when reading.
+  int32 window_log = 0;
+
+  // Optional dictionary, either raw content or a dictionary trained with
+  // `zstd --train`. Data compressed with a dictionary must be decompressed
+  // with the same dictionary. Dictionaries improve the ratio of small,
+  // similar records, e.g. when each record is flushed on its own.
+  std::string dictionary;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_COMPRESSION_OPTIONS_H_
@@ -0,0 +1,194 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace tsl {
+namespace io {
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 const ZstdCompressionOptions& zstd_options,
+                                 bool owns_input_stream)
+    : input_stream_(input_stream),
+      zstd_options_(zstd_options),
+      owns_input_stream_(owns_input_stream),
+      output_buffer_(new char[zstd_options.output_buffer_size]) {}
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 const ZstdCompressionOptions& zstd_options)
+    : ZstdInputStream(input_stream, zstd_options, false) {}
+
+ZstdInputStream::~ZstdInputStream() {
+  if (dctx_ != nullptr) {
+    ZSTD_freeDCtx(dctx_);
+  }
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+Status ZstdInputStream::Init() {
+  if (zstd_options_.input_buffer_size <= 0 ||
+      zstd_options_.output_buffer_size <= 0) {
+    return errors::InvalidArgument(
+        "input_buffer_size and output_buffer_size should be positive");
+  }
+  dctx_ = ZSTD_createDCtx();
+  if (dctx_ == nullptr) {
+    return errors::ResourceExhausted("Failed to create a zstd context");
+  }
+  size_t result = 0;
+  if (zstd_options_.window_log != 0) {
+    result = ZSTD_DCtx_setParameter(dctx_, ZSTD_d_windowLogMax,
+                                    zstd_options_.window_log);
+  }
+  if (!ZSTD_isError(result) && !zstd_options_.dictionary.empty()) {
+    result = ZSTD_DCtx_loadDictionary(dctx_, zstd_options_.dictionary.data(),
+                                      zstd_options_.dictionary.size());
+  }
+  if (ZSTD_isError(result)) {
+    ZSTD_freeDCtx(dctx_);
+    dctx_ = nullptr;
+    return errors::InvalidArgument("Invalid zstd options: ",
+                                   ZSTD_getErrorName(result));
+  }
+  return OkStatus();
+}
+
+Status ZstdInputStream::Decompress() {
+  DCHECK_EQ(avail_out_, 0);
+  while (true) {
+    if (input_pos_ == input_buffer_.size() && !output_pending_) {
+      if (input_exhausted_) {
+        if (frame_in_progress_) {
+          return errors::DataLoss(
+              "Truncated zstd stream. Possible data corruption.");
+        }
+        return errors::OutOfRange("EOF reached");
+      }
+      Status s = input_stream_->ReadNBytes(zstd_options_.input_buffer_size,
+                                           &input_buffer_);
+      if (errors::IsOutOfRange(s)) {
+        input_exhausted_ = true;
+      } else {
+        TF_RETURN_IF_ERROR(s);
+      }
+      input_pos_ = 0;
+      continue;
+    }
+    ZSTD_inBuffer input = {input_buffer_.data(), input_buffer_.size(),
+                           input_pos_};
+    ZSTD_outBuffer output = {
+        output_buffer_.get(),
+        static_cast<size_t>(zstd_options_.output_buffer_size), 0};
+    const size_t result = ZSTD_decompressStream(dctx_, &output, &input);
+    if (ZSTD_isError(result)) {
+      return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                              ZSTD_getErrorName(result));
+    }
+    // Once a frame is done, a call without progress returns the size hint of
+    // the next frame, which does not mean that a frame was started.
+    if (input.pos != input_pos_ || output.pos > 0) {
+      frame_in_progress_ = result != 0;
+    }
+    input_pos_ = input.pos;
+    output_pending_ = output.pos == output.size;
+    if (output.pos > 0) {
+      next_out_ = 0;
+      avail_out_ = output.pos;
+      return OkStatus();
+    }
+  }
+}
+
+size_t ZstdInputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                           char* result) {
+  size_t can_read_bytes = std::min(bytes_to_read, avail_out_);
+  if (can_read_bytes) {
+    memcpy(result, output_buffer_.get() + next_out_, can_read_bytes);
+    next_out_ += can_read_bytes;
+    avail_out_ -= can_read_bytes;
+  }
+  bytes_read_ += can_read_bytes;
+  return can_read_bytes;
+}
+
+Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read, tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  if (dctx_ == nullptr) {
+    TF_RETURN_IF_ERROR(Init());
+  }
+  result->clear();
+  result->resize_uninitialized(bytes_to_read);
+  char* result_ptr = result->mdata();
+
+  // Read as many bytes as possible from the cache.
+  size_t bytes_read = ReadBytesFromCache(bytes_to_read, result_ptr);
+  bytes_to_read -= bytes_read;
+  result_ptr += bytes_read;
+
+  while (bytes_to_read > 0) {
+    // Fill the cache with more data.
+    Status s = Decompress();
+    if (!s.ok()) {
+      result->resize(result_ptr - result->data());
+      return s;
+    }
+    size_t bytes_read = ReadBytesFromCache(bytes_to_read, result_ptr);
+    bytes_to_read -= bytes_read;
+    result_ptr += bytes_read;
+  }
+  return OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read, absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(absl::string_view(buf.data(), buf.size()));
+  return OkStatus();
+}
+#endif
+
+int64_t ZstdInputStream::Tell() const { return bytes_read_; }
+
+Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  if (dctx_ != nullptr) {
+    // Keeps the parameters and the dictionary.
+    ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_only);
+  }
+  input_buffer_.clear();
+  input_pos_ = 0;
+  input_exhausted_ = false;
+  output_pending_ = false;
+  frame_in_progress_ = false;
+  next_out_ = 0;
+  avail_out_ = 0;
+  bytes_read_ = 0;
+  return OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
@@ -0,0 +1,114 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+#define TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+
+#include <zstd.h>
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/inputstream_interface.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// An ZstdInputStream provides support for reading from a stream compressed
+// using Zstandard (https://github.com/facebook/zstd), e.g. by
+// ZstdOutputBuffer. Concatenated zstd frames are read as one stream.
+class ZstdInputStream : public InputStreamInterface {
+ public:
+  // Create a ZstdInputStream for `input_stream` with a buffer of size
+  // `zstd_options.input_buffer_size` for the compressed data and a buffer of
+  // size `zstd_options.output_buffer_size` for the decompressed data.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  ZstdInputStream(InputStreamInterface* input_stream,
+                  const ZstdCompressionOptions& zstd_options,
+                  bool owns_input_stream);
+
+  // Equivalent to the previous constructor with owns_input_stream = false.
+  ZstdInputStream(InputStreamInterface* input_stream,
+                  const ZstdCompressionOptions& zstd_options);
+
+  ~ZstdInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If the compressed data is corrupted or truncated.
+  // others:       If reading from stream failed.
+  Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status ReadNBytes(int64_t bytes_to_read, absl::Cord* result) override;
+#endif
+
+  int64_t Tell() const override;
+
+  Status Reset() override;
+
+ private:
+  // Creates the decompression context on first use.
+  Status Init();
+
+  // Decompresses the next chunk of data into the output buffer.
+  Status Decompress();
+
+  // Attempt to read `bytes_to_read` from the decompressed data cache. Returns
+  // the actual number of bytes read.
+  size_t ReadBytesFromCache(size_t bytes_to_read, char* result);
+
+  InputStreamInterface* input_stream_;
+  const ZstdCompressionOptions zstd_options_;
+  const bool owns_input_stream_;
+
+  ZSTD_DCtx* dctx_ = nullptr;
+
+  // Compressed data read from `input_stream_` and the part of it consumed.
+  tstring input_buffer_;
+  size_t input_pos_ = 0;
+  bool input_exhausted_ = false;
+
+  // Whether the last decompression call filled the output buffer, in which
+  // case zstd may hold more output without needing more input.
+  bool output_pending_ = false;
+
+  // Whether the data decompressed so far ends in the middle of a zstd frame.
+  bool frame_in_progress_ = false;
+
+  // Decompressed data not yet read by the client, in
+  // output_buffer_[next_out_, next_out_ + avail_out_).
+  std::unique_ptr<char[]> output_buffer_;
+  size_t next_out_ = 0;
+  size_t avail_out_ = 0;
+
+  // Specifies the number of decompressed bytes currently read.
+  int64_t bytes_read_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdInputStream);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
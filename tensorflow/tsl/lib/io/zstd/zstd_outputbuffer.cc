@@ -0,0 +1,139 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/lib/io/zstd/zstd_outputbuffer.h"
+
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/logging.h"
+
+namespace tsl {
+namespace io {
+
+ZstdOutputBuffer::ZstdOutputBuffer(WritableFile* file,
+                                   const ZstdCompressionOptions& zstd_options)
+    : file_(file),
+      zstd_options_(zstd_options),
+      output_buffer_(new char[zstd_options.output_buffer_size]) {}
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {
+  if (cctx_ != nullptr) {
+    LOG(WARNING) << "ZstdOutputBuffer::Close() not called. Possible data loss";
+    ZSTD_freeCCtx(cctx_);
+  }
+}
+
+Status ZstdOutputBuffer::Init() {
+  if (zstd_options_.output_buffer_size <= 0) {
+    return errors::InvalidArgument(
+        "output_buffer_size should be positive, got ",
+        zstd_options_.output_buffer_size);
+  }
+  cctx_ = ZSTD_createCCtx();
+  if (cctx_ == nullptr) {
+    return errors::ResourceExhausted("Failed to create a zstd context");
+  }
+  size_t result = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel,
+                                         zstd_options_.compression_level);
+  if (!ZSTD_isError(result)) {
+    result = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_windowLog,
+                                    zstd_options_.window_log);
+  }
+  if (!ZSTD_isError(result)) {
+    result = ZSTD_CCtx_setParameter(cctx_, ZSTD_c_checksumFlag, 1);
+  }
+  if (!ZSTD_isError(result) && !zstd_options_.dictionary.empty()) {
+    result = ZSTD_CCtx_loadDictionary(cctx_, zstd_options_.dictionary.data(),
+                                      zstd_options_.dictionary.size());
+  }
+  if (ZSTD_isError(result)) {
+    ZSTD_freeCCtx(cctx_);
+    cctx_ = nullptr;
+    return errors::InvalidArgument("Invalid zstd options: ",
+                                   ZSTD_getErrorName(result));
+  }
+  return OkStatus();
+}
+
+Status ZstdOutputBuffer::Compress(StringPiece data, ZSTD_EndDirective end_op) {
+  if (cctx_ == nullptr) {
+    return errors::FailedPrecondition(
+        "ZstdOutputBuffer not initialized or previously closed");
+  }
+  ZSTD_inBuffer input = {data.data(), data.size(), 0};
+  while (true) {
+    ZSTD_outBuffer output = {output_buffer_.get(),
+                             static_cast<size_t>(
+                                 zstd_options_.output_buffer_size),
+                             0};
+    const size_t remaining =
+        ZSTD_compressStream2(cctx_, &output, &input, end_op);
+    if (ZSTD_isError(remaining)) {
+      return errors::DataLoss("ZSTD_compressStream2() failed: ",
+                              ZSTD_getErrorName(remaining));
+    }
+    if (output.pos > 0) {
+      TF_RETURN_IF_ERROR(
+          file_->Append(StringPiece(output_buffer_.get(), output.pos)));
+    }
+    // Flushing and ending are done once zstd has no output left, continuing
+    // once all input is consumed.
+    if (end_op == ZSTD_e_continue ? input.pos == input.size : remaining == 0) {
+      return OkStatus();
+    }
+  }
+}
+
+Status ZstdOutputBuffer::Append(StringPiece data) {
+  return Compress(data, ZSTD_e_continue);
+}
+
+#if defined(TF_CORD_SUPPORT)
+Status ZstdOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return OkStatus();
+}
+#endif
+
+Status ZstdOutputBuffer::Flush() {
+  TF_RETURN_IF_ERROR(Compress(StringPiece(), ZSTD_e_flush));
+  return file_->Flush();
+}
+
+Status ZstdOutputBuffer::Name(StringPiece* result) const {
+  return file_->Name(result);
+}
+
+Status ZstdOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+Status ZstdOutputBuffer::Close() {
+  if (cctx_ != nullptr) {
+    TF_RETURN_IF_ERROR(Compress(StringPiece(), ZSTD_e_end));
+    ZSTD_freeCCtx(cctx_);
+    cctx_ = nullptr;
+  }
+  return OkStatus();
+}
+
+Status ZstdOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
+}  // namespace io
+}  // namespace tsl
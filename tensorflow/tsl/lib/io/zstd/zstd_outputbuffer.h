@@ -0,0 +1,101 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+#define TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+
+#include <zstd.h>
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Compresses input data using Zstandard (https://github.com/facebook/zstd)
+// and writes it to `file` as a single zstd frame, which can be read with
+// ZstdInputStream or the `zstd` command line tool.
+//
+// zstd buffers the input internally and compresses it in blocks. The
+// compressed output is cached in a buffer of size
+// `zstd_options.output_buffer_size` before being written to `file`.
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Create a ZstdOutputBuffer for `file`. Does not take ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file,
+                   const ZstdCompressionOptions& zstd_options);
+
+  // Per convention, the dtor does not call Flush() or Close(). We expect the
+  // caller to call those manually when done.
+  ~ZstdOutputBuffer() override;
+
+  // Initializes the compression context. Must be called before any other
+  // method.
+  Status Init();
+
+  // Adds `data` to the compression pipeline.
+  Status Append(StringPiece data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any buffered input, writes all output to file and flushes it.
+  // The written data can be decompressed before the frame is ended.
+  Status Flush() override;
+
+  // Ends the zstd frame and writes all output to file. Does *not* close the
+  // underlying file.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  Status Close() override;
+
+  // Returns the name of the underlying file.
+  Status Name(StringPiece* result) const override;
+
+  // Flushes any buffered input and syncs the underlying file.
+  Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  Status Tell(int64_t* position) override;
+
+ private:
+  // Feeds `data` to zstd with `end_op` and writes the output to file.
+  Status Compress(StringPiece data, ZSTD_EndDirective end_op);
+
+  WritableFile* file_;  // Not owned
+  const ZstdCompressionOptions zstd_options_;
+
+  // Null before Init() and after Close().
+  ZSTD_CCtx* cctx_ = nullptr;
+
+  std::unique_ptr<char[]> output_buffer_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ZstdOutputBuffer);
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
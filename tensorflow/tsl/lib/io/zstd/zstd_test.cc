@@ -0,0 +1,138 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/lib/io/random_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_inputstream.h"
+#include "tensorflow/tsl/lib/io/zstd/zstd_outputbuffer.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/strcat.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+string GenTestString(int copies) {
+  string result;
+  for (int i = 0; i < copies; ++i) {
+    strings::StrAppend(&result, "Lorem ipsum dolor sit amet, consectetur ",
+                       "adipiscing elit. Record ", i, ". ");
+  }
+  return result;
+}
+
+// Writes `num_writes` copies of `data` to `fname`, optionally flushing after
+// every write so that the file is made of several zstd frames.
+Status WriteFile(const string& fname, const string& data, int num_writes,
+                 bool with_flush, const ZstdCompressionOptions& options) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(fname, &file));
+  ZstdOutputBuffer out(file.get(), options);
+  TF_RETURN_IF_ERROR(out.Init());
+  for (int i = 0; i < num_writes; ++i) {
+    TF_RETURN_IF_ERROR(out.Append(data));
+    if (with_flush) {
+      TF_RETURN_IF_ERROR(out.Flush());
+    }
+  }
+  TF_RETURN_IF_ERROR(out.Close());
+  return file->Close();
+}
+
+Status ReadFile(const string& fname, int64_t bytes_to_read,
+                const ZstdCompressionOptions& options, tstring* result) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewRandomAccessFile(fname, &file));
+  ZstdInputStream in(new RandomAccessInputStream(file.get()), options,
+                     /*owns_input_stream=*/true);
+  return in.ReadNBytes(bytes_to_read, result);
+}
+
+void TestRoundTrip(size_t buffer_size, bool with_flush,
+                   const ZstdCompressionOptions& base_options) {
+  ZstdCompressionOptions options = base_options;
+  options.input_buffer_size = buffer_size;
+  options.output_buffer_size = buffer_size;
+  const string fname = testing::TmpDir() + "/zstd_round_trip";
+  const string data = GenTestString(100);
+  constexpr int kNumWrites = 10;
+  TF_ASSERT_OK(WriteFile(fname, data, kNumWrites, with_flush, options));
+
+  string expected;
+  for (int i = 0; i < kNumWrites; ++i) expected += data;
+  tstring result;
+  TF_ASSERT_OK(ReadFile(fname, expected.size(), options, &result));
+  EXPECT_EQ(result, expected);
+  EXPECT_TRUE(errors::IsOutOfRange(ReadFile(fname, expected.size() + 1,
+                                            options, &result)));
+}
+
+TEST(ZstdBuffers, RoundTrip) {
+  for (size_t buffer_size : {1, 37, 1024, 128 << 10}) {
+    for (bool with_flush : {false, true}) {
+      TestRoundTrip(buffer_size, with_flush, ZstdCompressionOptions());
+    }
+  }
+}
+
+TEST(ZstdBuffers, RoundTripWithDictionary) {
+  ZstdCompressionOptions options;
+  options.dictionary = GenTestString(20);
+  options.compression_level = 19;
+  TestRoundTrip(1024, /*with_flush=*/true, options);
+}
+
+TEST(ZstdBuffers, Reset) {
+  ZstdCompressionOptions options;
+  const string fname = testing::TmpDir() + "/zstd_reset";
+  const string data = GenTestString(10);
+  TF_ASSERT_OK(WriteFile(fname, data, 1, false, options));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  ZstdInputStream in(new RandomAccessInputStream(file.get()), options, true);
+  tstring first;
+  TF_ASSERT_OK(in.ReadNBytes(data.size() / 2, &first));
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(in.Tell(), 0);
+  tstring second;
+  TF_ASSERT_OK(in.ReadNBytes(data.size(), &second));
+  EXPECT_EQ(second, data);
+}
+
+TEST(ZstdBuffers, TruncatedFile) {
+  ZstdCompressionOptions options;
+  const string fname = testing::TmpDir() + "/zstd_truncated";
+  const string data = GenTestString(100);
+  TF_ASSERT_OK(WriteFile(fname, data, 1, false, options));
+
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), fname, &contents));
+  contents.resize(contents.size() - 1);
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), fname, contents));
+
+  tstring result;
+  Status s = ReadFile(fname, data.size(), options, &result);
+  EXPECT_TRUE(errors::IsDataLoss(s)) << s;
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
@@ -190,6 +190,54 @@ class PhiloxRandom {
     return counter;
   }
 
+  // The number of groups GenerateBatch() computes together.
+  static constexpr int kBatchSize = 16;
+
+  // Writes the next `count` groups of four random numbers to `results`, the
+  // same numbers that `count` calls to operator() would return. The rounds of
+  // up to kBatchSize consecutive counters are computed together, with the
+  // counter words in separate arrays, so that the compiler can vectorize the
+  // multiplications across groups.
+  PHILOX_DEVICE_INLINE void GenerateBatch(ResultType* results, int64_t count) {
+    while (count > 0) {
+      const int n = count < kBatchSize ? static_cast<int>(count) : kBatchSize;
+      uint32_t c0[kBatchSize], c1[kBatchSize], c2[kBatchSize], c3[kBatchSize];
+      for (int i = 0; i < kBatchSize; ++i) {
+        c0[i] = counter_[0];
+        c1[i] = counter_[1];
+        c2[i] = counter_[2];
+        c3[i] = counter_[3];
+        if (i < n) SkipOne();
+      }
+      Key key = key_;
+      for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < kBatchSize; ++i) {
+          const uint64_t product0 =
+              static_cast<uint64_t>(kPhiloxM4x32A) * c0[i];
+          const uint64_t product1 =
+              static_cast<uint64_t>(kPhiloxM4x32B) * c2[i];
+          const uint32_t next0 =
+              static_cast<uint32_t>(product1 >> 32) ^ c1[i] ^ key[0];
+          const uint32_t next2 =
+              static_cast<uint32_t>(product0 >> 32) ^ c3[i] ^ key[1];
+          c1[i] = static_cast<uint32_t>(product1);
+          c3[i] = static_cast<uint32_t>(product0);
+          c0[i] = next0;
+          c2[i] = next2;
+        }
+        RaiseKey(&key);
+      }
+      for (int i = 0; i < n; ++i) {
+        results[i][0] = c0[i];
+        results[i][1] = c1[i];
+        results[i][2] = c2[i];
+        results[i][3] = c3[i];
+      }
+      results += n;
+      count -= n;
+    }
+  }
+
  private:
   // We use the same constants as recommended by the original paper.
   static constexpr uint32_t kPhiloxW32A = 0x9E3779B9;
@@ -69,6 +69,33 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that GenerateBatch() returns the same samples as calling
+// operator() repeatedly, and leaves the generator in the same state.
+TEST(PhiloxRandomTest, GenerateBatchMatchTest) {
+  uint64 test_seed = GetTestSeed();
+  constexpr int kBatchSize = PhiloxRandom::kBatchSize;
+  for (int count : {0, 1, kBatchSize - 1, kBatchSize, kBatchSize + 1, 100}) {
+    PhiloxRandom batch_gen(test_seed, test_seed);
+    // Start just below a carry into the second counter word.
+    batch_gen.Skip(0xfffffff0u);
+    PhiloxRandom gen = batch_gen;
+
+    std::vector<PhiloxRandom::ResultType> batch(count);
+    batch_gen.GenerateBatch(batch.data(), count);
+    for (int i = 0; i < count; ++i) {
+      PhiloxRandom::ResultType samples = gen();
+      for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+        ASSERT_EQ(batch[i][j], samples[j]) << count << " " << i;
+      }
+    }
+    PhiloxRandom::ResultType next_batch = batch_gen();
+    PhiloxRandom::ResultType next = gen();
+    for (int j = 0; j < PhiloxRandom::kResultElementCount; ++j) {
+      ASSERT_EQ(next_batch[j], next[j]) << count;
+    }
+  }
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tsl
@@ -94,6 +94,15 @@ class FileBlockCache {
   virtual Status Read(const string& filename, size_t offset, size_t n,
                       char* buffer, size_t* bytes_transferred) = 0;
 
+  /// Like Read(), for a file that is known to be `file_size` bytes long. A
+  /// cache that reads ahead may start fetching the blocks that follow the read,
+  /// but never past `file_size`. The default implementation calls Read().
+  virtual Status ReadWithReadahead(const string& filename, size_t offset,
+                                   size_t n, size_t file_size, char* buffer,
+                                   size_t* bytes_transferred) {
+    return Read(filename, offset, n, buffer, bytes_transferred);
+  }
+
   // Validate the given file signature with the existing file signature in the
   // cache. Returns true if the signature doesn't change or the file did not
   // exist before. If the signature changes, update the existing signature with
@@ -142,6 +142,14 @@ constexpr char kRetryConfigMaxDelayTimeUs[] =
 // The environment variable that controls the number of retries in GCS
 // exponential retries (format: <int32_t>)
 constexpr char kRetryConfigMaxRetries[] = "GCS_RETRY_CONFIG_MAX_RETRIES";
+// The environment variable that enables hedged reads: the maximum fraction of
+// reads that are duplicated because they are slower than recent reads
+// (format: <double>, e.g. 0.05). Hedged reads are disabled by default.
+constexpr char kHedgedReadsMaxFraction[] = "GCS_HEDGED_READS_MAX_FRACTION";
+// The environment variable for the latency quantile of recent reads after
+// which a read is duplicated (format: <double>, default 0.95).
+constexpr char kHedgedReadsLatencyQuantile[] =
+    "GCS_HEDGED_READS_LATENCY_QUANTILE";
 
 // The environment variable to customize which GCS bucket locations are allowed,
 // if the list is empty defaults to using the region of the zone (format, comma
@@ -308,6 +316,22 @@ RetryConfig GetGcsRetryConfig() {
   return retryConfig;
 }
 
+/// Get GCS hedged reads config from the environment. Disabled by default.
+HedgingConfig GetGcsHedgingConfig() {
+  HedgingConfig hedging_config;
+  double value;
+  if (GetEnvVar(kHedgedReadsMaxFraction, strings::safe_strtod, &value)) {
+    hedging_config.max_hedged_fraction = value;
+  }
+  if (GetEnvVar(kHedgedReadsLatencyQuantile, strings::safe_strtod, &value)) {
+    hedging_config.latency_quantile = value;
+  }
+  VLOG(1) << "GCS HedgingConfig: "
+          << "max_hedged_fraction = " << hedging_config.max_hedged_fraction
+          << " ; latency_quantile = " << hedging_config.latency_quantile;
+  return hedging_config;
+}
+
 /// A GCS-based implementation of a random access file with an LRU block cache.
 class GcsRandomAccessFile : public RandomAccessFile {
  public:
@@ -846,12 +870,16 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+  if (GetEnvVar(kReadCacheReadaheadBlocks, strings::safe_strtou64, &value)) {
+    max_readahead_blocks_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "readahead blocks = " << max_readahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -1030,8 +1058,8 @@ Status GcsFileSystem::NewRandomAccessFile(
       }
       *result = StringPiece();
       size_t bytes_transferred;
-      TF_RETURN_IF_ERROR(file_block_cache_->Read(fname, offset, n, scratch,
-                                                 &bytes_transferred));
+      TF_RETURN_IF_ERROR(file_block_cache_->ReadWithReadahead(
+          fname, offset, n, stat.base.length, scratch, &bytes_transferred));
       *result = StringPiece(scratch, bytes_transferred);
       if (bytes_transferred < n) {
         return errors::OutOfRange("EOF reached, ", result->size(),
@@ -1081,7 +1109,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), max_readahead_blocks_));
 
   // Check if cache is enabled here to avoid unnecessary mutex contention.
   cache_enabled_ = file_block_cache->IsCacheEnabled();
@@ -2176,7 +2205,8 @@ Status GcsFileSystem::CreateHttpRequest(std::unique_ptr<HttpRequest>* request) {
 
 RetryingGcsFileSystem::RetryingGcsFileSystem()
     : RetryingFileSystem(std::make_unique<GcsFileSystem>(),
-                         RetryConfig(GetGcsRetryConfig())) {}
+                         RetryConfig(GetGcsRetryConfig()),
+                         GetGcsHedgingConfig()) {}
 
 }  // namespace tsl
 
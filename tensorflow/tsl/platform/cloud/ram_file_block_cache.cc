@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
 
@@ -169,6 +170,74 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
 
 Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
                                char* buffer, size_t* bytes_transferred) {
+  bool waited = false;
+  return ReadBlocks(filename, offset, n, buffer, bytes_transferred, &waited);
+}
+
+Status RamFileBlockCache::ReadWithReadahead(const string& filename,
+                                            size_t offset, size_t n,
+                                            size_t file_size, char* buffer,
+                                            size_t* bytes_transferred) {
+  bool waited = false;
+  Status status =
+      ReadBlocks(filename, offset, n, buffer, bytes_transferred, &waited);
+  if (readahead_pool_ && status.ok() && n <= max_bytes_) {
+    ReadAhead(filename, offset, offset + *bytes_transferred, file_size, waited);
+  }
+  return status;
+}
+
+void RamFileBlockCache::ReadAhead(const string& filename, size_t offset,
+                                  size_t end, size_t file_size, bool waited) {
+  size_t window;
+  {
+    mutex_lock lock(readahead_mu_);
+    if (readahead_states_.size() >= kMaxReadaheadFiles &&
+        readahead_states_.find(filename) == readahead_states_.end()) {
+      readahead_states_.clear();
+    }
+    ReadaheadState& state = readahead_states_[filename];
+    // Small forward skips, e.g. over record headers, still count as
+    // sequential.
+    if (offset >= state.next_offset &&
+        offset < state.next_offset + block_size_) {
+      if (waited || state.window == 0) {
+        state.window = std::min(std::max<size_t>(1, 2 * state.window),
+                                max_readahead_blocks_);
+      }
+    } else {
+      state.window = 0;
+    }
+    state.next_offset = end;
+    window = state.window;
+  }
+  if (window == 0 || end == 0) {
+    return;
+  }
+  // Start after the last block touched by the read.
+  size_t pos = block_size_ * ((end - 1) / block_size_ + 1);
+  for (size_t i = 0; i < window && pos < file_size; ++i, pos += block_size_) {
+    Key key = std::make_pair(filename, pos);
+    {
+      mutex_lock lock(mu_);
+      if (block_map_.find(key) != block_map_.end()) {
+        // Already cached, or being fetched.
+        continue;
+      }
+    }
+    std::shared_ptr<Block> block = Lookup(key);
+    readahead_pool_->Schedule([this, key, block] {
+      // Errors are left for the reader to retry.
+      if (MaybeFetch(key, block).ok()) {
+        UpdateLRU(key, block).IgnoreError();
+      }
+    });
+  }
+}
+
+Status RamFileBlockCache::ReadBlocks(const string& filename, size_t offset,
+                                     size_t n, char* buffer,
+                                     size_t* bytes_transferred, bool* waited) {
   *bytes_transferred = 0;
   if (n == 0) {
     return OkStatus();
@@ -192,6 +261,12 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
     // LRU iterator for the key and block.
     std::shared_ptr<Block> block = Lookup(key);
     DCHECK(block) << "No block for key " << key.first << "@" << key.second;
+    {
+      mutex_lock l(block->mu);
+      if (block->state != FetchState::FINISHED) {
+        *waited = true;
+      }
+    }
     TF_RETURN_IF_ERROR(MaybeFetch(key, block));
     TF_RETURN_IF_ERROR(UpdateLRU(key, block));
     // Copy the relevant portion of the block into the result buffer.
@@ -269,16 +344,24 @@ void RamFileBlockCache::Prune() {
 }
 
 void RamFileBlockCache::Flush() {
-  mutex_lock lock(mu_);
-  block_map_.clear();
-  lru_list_.clear();
-  lra_list_.clear();
-  cache_size_ = 0;
+  {
+    mutex_lock lock(mu_);
+    block_map_.clear();
+    lru_list_.clear();
+    lra_list_.clear();
+    cache_size_ = 0;
+  }
+  mutex_lock readahead_lock(readahead_mu_);
+  readahead_states_.clear();
 }
 
 void RamFileBlockCache::RemoveFile(const string& filename) {
-  mutex_lock lock(mu_);
-  RemoveFile_Locked(filename);
+  {
+    mutex_lock lock(mu_);
+    RemoveFile_Locked(filename);
+  }
+  mutex_lock readahead_lock(readahead_mu_);
+  readahead_states_.erase(filename);
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
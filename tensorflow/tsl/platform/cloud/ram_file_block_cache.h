@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 #define TENSORFLOW_TSL_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
+#include <algorithm>
 #include <functional>
 #include <list>
 #include <map>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/platform/stringpiece.h"
 #include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/platform/threadpool.h"
 #include "tensorflow/tsl/platform/types.h"
 
 namespace tsl {
@@ -50,17 +52,32 @@ class RamFileBlockCache : public FileBlockCache {
                                size_t* bytes_transferred)>
       BlockFetcher;
 
+  /// If `max_readahead_blocks` is positive, sequential reads through
+  /// ReadWithReadahead() fetch up to that many of the following blocks in
+  /// parallel in the background. The readahead window starts at one block and
+  /// doubles every time a sequential read has to wait for a fetch, so it grows
+  /// until the background fetches keep up with the reader. The window is
+  /// capped so that the blocks read ahead fill at most half of the cache.
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t max_readahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        max_readahead_blocks_(
+            block_size > 0
+                ? std::min(max_readahead_blocks, max_bytes / 2 / block_size)
+                : 0) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (max_readahead_blocks_ > 0) {
+      readahead_pool_.reset(new thread::ThreadPool(env_, "TF_readahead_FBC",
+                                                   max_readahead_blocks_));
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
@@ -91,6 +108,13 @@ class RamFileBlockCache : public FileBlockCache {
   Status Read(const string& filename, size_t offset, size_t n, char* buffer,
               size_t* bytes_transferred) override;
 
+  /// Like Read(), and if `filename` is read sequentially, also fetches the
+  /// blocks that follow the read in the background (see the constructor).
+  Status ReadWithReadahead(const string& filename, size_t offset, size_t n,
+                           size_t file_size, char* buffer,
+                           size_t* bytes_transferred) override
+      TF_LOCKS_EXCLUDED(mu_, readahead_mu_);
+
   // Validate the given file signature with the existing file signature in the
   // cache. Returns true if the signature doesn't change or the file doesn't
   // exist before. If the signature changes, update the existing signature with
@@ -100,10 +124,11 @@ class RamFileBlockCache : public FileBlockCache {
       TF_LOCKS_EXCLUDED(mu_);
 
   /// Remove all cached blocks for `filename`.
-  void RemoveFile(const string& filename) override TF_LOCKS_EXCLUDED(mu_);
+  void RemoveFile(const string& filename) override
+      TF_LOCKS_EXCLUDED(mu_, readahead_mu_);
 
   /// Remove all cached data.
-  void Flush() override TF_LOCKS_EXCLUDED(mu_);
+  void Flush() override TF_LOCKS_EXCLUDED(mu_, readahead_mu_);
 
   /// Accessors for cache parameters.
   size_t block_size() const override { return block_size_; }
@@ -131,6 +156,8 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks fetched ahead of a sequential read.
+  const size_t max_readahead_blocks_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -200,6 +227,17 @@ class RamFileBlockCache : public FileBlockCache {
   Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
+  /// Implements Read(). Sets `*waited` to true if a block was not yet fetched.
+  Status ReadBlocks(const string& filename, size_t offset, size_t n,
+                    char* buffer, size_t* bytes_transferred, bool* waited)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// Updates the readahead window of `filename` after a read of [offset, end),
+  /// and schedules the fetches of the blocks in the window.
+  void ReadAhead(const string& filename, size_t offset, size_t end,
+                 size_t file_size, bool waited)
+      TF_LOCKS_EXCLUDED(mu_, readahead_mu_);
+
   /// Trim the block cache to make room for another entry.
   void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -243,6 +281,26 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// \brief The readahead state of a file.
+  struct ReadaheadState {
+    /// The offset at which the next read is considered sequential.
+    size_t next_offset = 0;
+    /// The number of blocks fetched ahead of a sequential read.
+    size_t window = 0;
+  };
+
+  /// The maximum number of files whose readahead state is kept.
+  static constexpr size_t kMaxReadaheadFiles = 1024;
+
+  /// Guards the readahead states. Never held together with mu_.
+  mutex readahead_mu_;
+  std::map<string, ReadaheadState> readahead_states_
+      TF_GUARDED_BY(readahead_mu_);
+
+  /// Runs the readahead fetches. Declared last so that it is destroyed, and
+  /// waits for the pending fetches, before the state they use.
+  std::unique_ptr<thread::ThreadPool> readahead_pool_;
 };
 
 }  // namespace tsl
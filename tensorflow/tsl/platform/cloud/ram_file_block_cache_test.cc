@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
+#include <map>
 
 #include "tensorflow/tsl/lib/core/status_test_util.h"
 #include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/cloud/now_seconds_env.h"
 #include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/notification.h"
 #include "tensorflow/tsl/platform/test.h"
 
@@ -39,6 +42,19 @@ Status ReadCache(RamFileBlockCache* cache, const string& filename,
   return status;
 }
 
+Status ReadCacheWithReadahead(RamFileBlockCache* cache, const string& filename,
+                              size_t offset, size_t n, size_t file_size,
+                              std::vector<char>* out) {
+  out->clear();
+  out->resize(n, 0);
+  size_t bytes_transferred = 0;
+  Status status = cache->ReadWithReadahead(filename, offset, n, file_size,
+                                           out->data(), &bytes_transferred);
+  EXPECT_LE(bytes_transferred, n);
+  out->resize(bytes_transferred, n);
+  return status;
+}
+
 TEST(RamFileBlockCacheTest, IsCacheEnabled) {
   auto fetcher = [](const string& filename, size_t offset, size_t n,
                     char* buffer, size_t* bytes_transferred) {
@@ -566,5 +582,68 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, ReadaheadSequentialReads) {
+  const size_t block_size = 16;
+  const size_t file_size = 6 * block_size;
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      fetches[offset]++;
+    }
+    *bytes_transferred = offset < file_size ? std::min(n, file_size - offset)
+                                            : 0;
+    memset(buffer, 'x', *bytes_transferred);
+    return OkStatus();
+  };
+  {
+    RamFileBlockCache cache(block_size, 32 * block_size, 0, fetcher,
+                            Env::Default(), /*max_readahead_blocks=*/4);
+    std::vector<char> out;
+    for (size_t pos = 0; pos < file_size; pos += block_size) {
+      TF_EXPECT_OK(ReadCacheWithReadahead(&cache, "a", pos, block_size,
+                                          file_size, &out));
+      EXPECT_EQ(out, std::vector<char>(block_size, 'x'));
+    }
+    // Destroying the cache waits for the pending readahead fetches.
+  }
+  // Every block was fetched exactly once, either ahead of the read or by the
+  // read itself, and nothing was fetched past the end of the file.
+  std::map<size_t, int> expected;
+  for (size_t pos = 0; pos < file_size; pos += block_size) expected[pos] = 1;
+  EXPECT_EQ(fetches, expected);
+}
+
+TEST(RamFileBlockCacheTest, NoReadaheadForRandomReads) {
+  const size_t block_size = 16;
+  const size_t file_size = 4 * block_size;
+  mutex mu;
+  std::map<size_t, int> fetches;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    {
+      mutex_lock l(mu);
+      fetches[offset]++;
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return OkStatus();
+  };
+  {
+    RamFileBlockCache cache(block_size, 32 * block_size, 0, fetcher,
+                            Env::Default(), /*max_readahead_blocks=*/4);
+    std::vector<char> out;
+    for (size_t block : {3, 0, 2}) {
+      TF_EXPECT_OK(ReadCacheWithReadahead(&cache, "a", block * block_size,
+                                          block_size, file_size, &out));
+    }
+  }
+  std::map<size_t, int> expected = {
+      {0, 1}, {2 * block_size, 1}, {3 * block_size, 1}};
+  EXPECT_EQ(fetches, expected);
+}
+
 }  // namespace
 }  // namespace tsl
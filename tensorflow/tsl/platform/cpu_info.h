@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_TSL_PLATFORM_CPU_INFO_H_
 
 #include <string>
+#include <vector>
 
 // TODO(ahentz): This is not strictly required here but, for historical
 // reasons, many people depend on cpu_info.h in order to use kLittleEndian.
@@ -68,6 +69,18 @@ int GetCurrentCPU();
 // on the CPU
 int NumHyperthreadsPerCore();
 
+// Returns the CPUs this process may run on, ordered so that CPUs on distinct
+// physical cores come first: the first hyperthread of every core, then the
+// second hyperthread of every core, and so on. If `numa_node` is not
+// kNUMANoAffinity, only the CPUs of that NUMA node are returned. Sets
+// `*num_physical_cores` to the number of distinct physical cores of the
+// returned CPUs. Returns an empty vector if the CPU topology is unknown.
+std::vector<int> CPUsByPhysicalCore(int numa_node, int* num_physical_cores);
+
+// Pins the current thread to `cpu`. Returns false if thread affinity is not
+// supported or `cpu` is not available.
+bool SetCurrentThreadCPUAffinity(int cpu);
+
 // Mostly ISA related features that we care about
 enum CPUFeature {
   // Do not change numeric assignments.
@@ -37,6 +37,11 @@ limitations under the License.
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 #ifdef TF_USE_SNAPPY
 #include "snappy.h"
 #endif
@@ -167,6 +172,73 @@ int NumHyperthreadsPerCore() {
   return (ht_per_core > 0) ? ht_per_core : 1;
 }
 
+#if defined(__linux__) && !defined(__ANDROID__)
+namespace {
+
+// Returns the integer in the sysfs file `path`, or -1 on failure.
+int ReadSysfsInt(const std::string& path) {
+  FILE* f = fopen(path.c_str(), "r");
+  if (f == nullptr) return -1;
+  int value = -1;
+  if (fscanf(f, "%d", &value) != 1) value = -1;
+  fclose(f);
+  return value;
+}
+
+}  // namespace
+#endif
+
+std::vector<int> CPUsByPhysicalCore(int numa_node, int* num_physical_cores) {
+  *num_physical_cores = 0;
+  std::vector<int> result;
+#if defined(__linux__) && !defined(__ANDROID__)
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  if (sched_getaffinity(0, sizeof(mask), &mask) != 0) return result;
+
+  // The hyperthreads of every physical core, in the order of their first CPU.
+  std::vector<std::vector<int>> cores;
+  std::map<std::pair<int, int>, size_t> core_index;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (!CPU_ISSET(cpu, &mask)) continue;
+    const std::string cpu_dir =
+        "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    if (numa_node != kNUMANoAffinity &&
+        access((cpu_dir + "/node" + std::to_string(numa_node)).c_str(),
+               F_OK) != 0) {
+      continue;
+    }
+    const int package = ReadSysfsInt(cpu_dir + "/topology/physical_package_id");
+    const int core = ReadSysfsInt(cpu_dir + "/topology/core_id");
+    if (package < 0 || core < 0) return {};
+    auto it = core_index.emplace(std::make_pair(package, core), cores.size());
+    if (it.second) cores.emplace_back();
+    cores[it.first->second].push_back(cpu);
+  }
+  *num_physical_cores = cores.size();
+  for (size_t i = 0;; ++i) {
+    const size_t size = result.size();
+    for (const std::vector<int>& hyperthreads : cores) {
+      if (i < hyperthreads.size()) result.push_back(hyperthreads[i]);
+    }
+    if (result.size() == size) break;
+  }
+#endif
+  return result;
+}
+
+bool SetCurrentThreadCPUAffinity(int cpu) {
+#if defined(__linux__) && !defined(__ANDROID__)
+  if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu, &mask);
+  return sched_setaffinity(0, sizeof(mask), &mask) == 0;
+#else
+  return false;
+#endif
+}
+
 #ifdef TENSORFLOW_USE_NUMA
 namespace {
 static hwloc_topology_t hwloc_topology_handle;
@@ -0,0 +1,168 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/platform/hedged_reads.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstring>
+#include <utility>
+
+#include "tensorflow/tsl/platform/errors.h"
+
+namespace tsl {
+namespace {
+
+// Number of recent read latencies the hedging delay is computed from.
+constexpr size_t kNumLatencySamples = 1000;
+
+// The latency quantile is recomputed every this many reads.
+constexpr int64_t kQuantileUpdatePeriod = 100;
+
+// Maximum number of hedge tokens saved up, i.e. the largest burst of
+// duplicate reads.
+constexpr double kMaxHedgeTokens = 10;
+
+}  // namespace
+
+struct HedgedReader::ReadState {
+  size_t n;
+  // Destination of the caller, only written by the first read to complete
+  // and only while `done` is false.
+  StringPiece* result;
+  char* scratch;
+
+  mutex mu;
+  condition_variable cv;
+  bool done TF_GUARDED_BY(mu) = false;
+  int pending TF_GUARDED_BY(mu) = 0;
+  Status status TF_GUARDED_BY(mu);
+};
+
+HedgedReader::HedgedReader(const HedgingConfig& config)
+    : config_(config),
+      thread_pool_(std::make_unique<thread::ThreadPool>(
+          Env::Default(), "hedged_reads", std::max(config.num_threads, 2))) {
+  latencies_us_.reserve(kNumLatencySamples);
+}
+
+HedgedReader::~HedgedReader() {
+  // Joins the threads, which completes the reads in flight before the
+  // latency statistics are destroyed.
+  thread_pool_.reset();
+}
+
+Status HedgedReader::Read(size_t n, ReadFn read_fn, StringPiece* result,
+                          char* scratch) {
+  auto state = std::make_shared<ReadState>();
+  state->n = n;
+  state->result = result;
+  state->scratch = scratch;
+  const int64_t hedge_delay_us = HedgeDelayUs();
+
+  mutex_lock l(state->mu);
+  ++state->pending;
+  StartRead(state, read_fn);
+  if (hedge_delay_us >= 0) {
+    const uint64 deadline_us = Env::Default()->NowMicros() + hedge_delay_us;
+    for (uint64 now_us = Env::Default()->NowMicros();
+         !state->done && now_us < deadline_us;
+         now_us = Env::Default()->NowMicros()) {
+      state->cv.wait_for(l, std::chrono::microseconds(deadline_us - now_us));
+    }
+    if (!state->done && TryAcquireHedgeToken()) {
+      ++state->pending;
+      StartRead(state, read_fn);
+    }
+  }
+  while (!state->done) {
+    state->cv.wait(l);
+  }
+  return state->status;
+}
+
+void HedgedReader::StartRead(const std::shared_ptr<ReadState>& state,
+                             const ReadFn& read_fn) {
+  thread_pool_->Schedule([this, state, read_fn]() {
+    const uint64 start_us = Env::Default()->NowMicros();
+    // The caller's scratch may be reused as soon as the other read
+    // completes, so every read has a buffer of its own.
+    std::unique_ptr<char[]> buffer(new char[state->n]);
+    StringPiece data;
+    Status s = read_fn(buffer.get(), &data);
+    const bool completed = s.ok() || errors::IsOutOfRange(s);
+    if (completed) {
+      RecordLatency(Env::Default()->NowMicros() - start_us);
+    }
+
+    mutex_lock l(state->mu);
+    --state->pending;
+    if (state->done || (!completed && state->pending > 0)) return;
+    if (completed) {
+      if (!data.empty()) memcpy(state->scratch, data.data(), data.size());
+      *state->result = StringPiece(state->scratch, data.size());
+    } else {
+      *state->result = StringPiece();
+    }
+    state->status = std::move(s);
+    state->done = true;
+    state->cv.notify_all();
+  });
+}
+
+int64_t HedgedReader::HedgeDelayUs() {
+  if (config_.max_hedged_fraction <= 0) return -1;
+  mutex_lock l(mu_);
+  hedge_tokens_ =
+      std::min(kMaxHedgeTokens, hedge_tokens_ + config_.max_hedged_fraction);
+  if (quantile_latency_us_ < 0) return -1;
+  return std::max(config_.min_delay_us, quantile_latency_us_);
+}
+
+void HedgedReader::RecordLatency(int64_t latency_us) {
+  mutex_lock l(mu_);
+  if (latencies_us_.size() < kNumLatencySamples) {
+    latencies_us_.push_back(latency_us);
+  } else {
+    latencies_us_[next_latency_] = latency_us;
+  }
+  next_latency_ = (next_latency_ + 1) % kNumLatencySamples;
+  ++num_samples_;
+  if (num_samples_ < config_.min_samples) return;
+  if (quantile_latency_us_ >= 0 && num_samples_ % kQuantileUpdatePeriod != 0) {
+    return;
+  }
+  std::vector<int64_t> sorted = latencies_us_;
+  const size_t k = std::min(
+      sorted.size() - 1,
+      static_cast<size_t>(config_.latency_quantile * sorted.size()));
+  std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+  quantile_latency_us_ = sorted[k];
+}
+
+bool HedgedReader::TryAcquireHedgeToken() {
+  mutex_lock l(mu_);
+  if (hedge_tokens_ < 1) return false;
+  hedge_tokens_ -= 1;
+  ++num_hedged_reads_;
+  return true;
+}
+
+int64_t HedgedReader::NumHedgedReads() const {
+  mutex_lock l(mu_);
+  return num_hedged_reads_;
+}
+
+}  // namespace tsl
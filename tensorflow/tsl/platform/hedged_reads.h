@@ -0,0 +1,121 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_HEDGED_READS_H_
+#define TENSORFLOW_TSL_PLATFORM_HEDGED_READS_H_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/status.h"
+#include "tensorflow/tsl/platform/stringpiece.h"
+#include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/platform/threadpool.h"
+#include "tensorflow/tsl/platform/types.h"
+
+namespace tsl {
+
+struct HedgingConfig {
+  // Upper bound on the number of duplicate reads, as a fraction of all
+  // reads. This bounds the extra load put on the storage system. Hedging is
+  // disabled if zero.
+  double max_hedged_fraction = 0.0;
+
+  // A read is duplicated once it has been running for longer than this
+  // quantile of the latencies of recent reads.
+  double latency_quantile = 0.95;
+
+  // Reads are never duplicated before this delay.
+  int64_t min_delay_us = 5 * 1000;
+
+  // Number of reads whose latency is observed before any read is duplicated.
+  int min_samples = 100;
+
+  // Number of threads issuing reads. Reads beyond this number of
+  // concurrent reads are queued.
+  int num_threads = 64;
+};
+
+// Issues reads and duplicates those that are slower than most recent reads,
+// returning the result of whichever completes first. This cuts the tail
+// latency of object stores, where a few requests are much slower than the
+// others even when nothing fails.
+//
+// Thread-safe. All reads go through an internal thread pool, so hedging is
+// only worth it for storage systems with a high per-read latency.
+class HedgedReader {
+ public:
+  // Reads into `scratch`, which has room for the requested number of bytes,
+  // and sets `*result` as RandomAccessFile::Read() does. Must be safe to
+  // call concurrently, and must keep the file it reads alive on its own:
+  // the losing read keeps running after HedgedReader::Read() returns.
+  using ReadFn = std::function<Status(char* scratch, StringPiece* result)>;
+
+  explicit HedgedReader(const HedgingConfig& config);
+
+  // Waits for the reads in flight.
+  ~HedgedReader();
+
+  // Reads up to `n` bytes with `read_fn` into `scratch`. Calls `read_fn` a
+  // second time if the first call is slow and the hedging budget allows it.
+  //
+  // Returns the status of the first call that completes with OK or
+  // OUT_OF_RANGE, or the last error if both calls fail.
+  Status Read(size_t n, ReadFn read_fn, StringPiece* result, char* scratch);
+
+  // Number of reads that were duplicated, for monitoring and tests.
+  int64_t NumHedgedReads() const;
+
+ private:
+  struct ReadState;
+
+  // Runs `read_fn` on the thread pool for `state`.
+  void StartRead(const std::shared_ptr<ReadState>& state,
+                 const ReadFn& read_fn);
+
+  // Returns the delay after which a read is duplicated, or a negative value
+  // if reads should not be duplicated yet.
+  int64_t HedgeDelayUs();
+
+  // Records the latency of a completed read.
+  void RecordLatency(int64_t latency_us);
+
+  // Spends a token of the hedging budget. Returns false if there is none.
+  bool TryAcquireHedgeToken();
+
+  const HedgingConfig config_;
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
+
+  mutable mutex mu_;
+  // Latencies of the most recent reads, used as a ring buffer.
+  std::vector<int64_t> latencies_us_ TF_GUARDED_BY(mu_);
+  size_t next_latency_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_samples_ TF_GUARDED_BY(mu_) = 0;
+  // `latency_quantile` of latencies_us_, recomputed periodically.
+  int64_t quantile_latency_us_ TF_GUARDED_BY(mu_) = -1;
+  // Every read adds `max_hedged_fraction` tokens, every hedge spends one.
+  double hedge_tokens_ TF_GUARDED_BY(mu_) = 0;
+  int64_t num_hedged_reads_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(HedgedReader);
+};
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_HEDGED_READS_H_
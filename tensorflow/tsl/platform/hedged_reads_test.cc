@@ -0,0 +1,145 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/tsl/platform/hedged_reads.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "tensorflow/tsl/lib/core/status_test_util.h"
+#include "tensorflow/tsl/platform/env.h"
+#include "tensorflow/tsl/platform/errors.h"
+#include "tensorflow/tsl/platform/test.h"
+
+namespace tsl {
+namespace {
+
+constexpr char kData[] = "0123456789";
+
+HedgingConfig TestConfig() {
+  HedgingConfig config;
+  config.max_hedged_fraction = 1.0;
+  config.min_delay_us = 1000;
+  config.min_samples = 10;
+  return config;
+}
+
+// Reads kData, sleeping for `sleep_us` on the call number `slow_call`.
+HedgedReader::ReadFn SlowRead(std::atomic<int>* calls, int slow_call,
+                              int64_t sleep_us, Status status = OkStatus()) {
+  return [calls, slow_call, sleep_us, status](char* scratch,
+                                              StringPiece* result) {
+    const int call = (*calls)++;
+    if (call == slow_call) {
+      Env::Default()->SleepForMicroseconds(sleep_us);
+      if (!status.ok()) return status;
+    }
+    memcpy(scratch, kData, sizeof(kData) - 1);
+    *result = StringPiece(scratch, sizeof(kData) - 1);
+    return OkStatus();
+  };
+}
+
+void WarmUp(HedgedReader* reader, int num_reads) {
+  char scratch[sizeof(kData)];
+  StringPiece result;
+  std::atomic<int> calls(0);
+  for (int i = 0; i < num_reads; ++i) {
+    TF_ASSERT_OK(reader->Read(sizeof(kData) - 1, SlowRead(&calls, -1, 0),
+                              &result, scratch));
+    EXPECT_EQ(kData, result);
+  }
+}
+
+TEST(HedgedReaderTest, SlowReadIsHedged) {
+  HedgedReader reader(TestConfig());
+  WarmUp(&reader, 20);
+  EXPECT_EQ(0, reader.NumHedgedReads());
+
+  char scratch[sizeof(kData)];
+  StringPiece result;
+  std::atomic<int> calls(0);
+  const uint64 start_us = Env::Default()->NowMicros();
+  TF_ASSERT_OK(reader.Read(sizeof(kData) - 1,
+                           SlowRead(&calls, 0, 2 * 1000 * 1000), &result,
+                           scratch));
+  EXPECT_LT(Env::Default()->NowMicros() - start_us, 1000 * 1000);
+  EXPECT_EQ(kData, result);
+  EXPECT_EQ(result.data(), scratch);
+  EXPECT_EQ(1, reader.NumHedgedReads());
+}
+
+TEST(HedgedReaderTest, NoHedgingBeforeMinSamples) {
+  HedgedReader reader(TestConfig());
+  WarmUp(&reader, 5);
+
+  char scratch[sizeof(kData)];
+  StringPiece result;
+  std::atomic<int> calls(0);
+  TF_ASSERT_OK(reader.Read(sizeof(kData) - 1, SlowRead(&calls, 0, 100 * 1000),
+                           &result, scratch));
+  EXPECT_EQ(kData, result);
+  EXPECT_EQ(0, reader.NumHedgedReads());
+  EXPECT_EQ(1, calls);
+}
+
+TEST(HedgedReaderTest, BudgetLimitsHedgedReads) {
+  HedgingConfig config = TestConfig();
+  config.max_hedged_fraction = 0.01;
+  HedgedReader reader(config);
+  // 20 reads earn 0.2 tokens, less than a hedged read.
+  WarmUp(&reader, 20);
+
+  char scratch[sizeof(kData)];
+  StringPiece result;
+  std::atomic<int> calls(0);
+  TF_ASSERT_OK(reader.Read(sizeof(kData) - 1, SlowRead(&calls, 0, 100 * 1000),
+                           &result, scratch));
+  EXPECT_EQ(0, reader.NumHedgedReads());
+}
+
+TEST(HedgedReaderTest, FailedReadWaitsForHedge) {
+  HedgedReader reader(TestConfig());
+  WarmUp(&reader, 20);
+
+  char scratch[sizeof(kData)];
+  StringPiece result;
+  std::atomic<int> calls(0);
+  // The first call fails after the second one has been issued: the result
+  // of the second one is returned.
+  TF_ASSERT_OK(reader.Read(sizeof(kData) - 1,
+                           SlowRead(&calls, 0, 100 * 1000,
+                                    errors::Unavailable("slow and failed")),
+                           &result, scratch));
+  EXPECT_EQ(kData, result);
+  EXPECT_EQ(1, reader.NumHedgedReads());
+}
+
+TEST(HedgedReaderTest, ErrorWithoutHedging) {
+  HedgingConfig config = TestConfig();
+  HedgedReader reader(config);
+
+  char scratch[sizeof(kData)];
+  StringPiece result;
+  EXPECT_TRUE(errors::IsUnavailable(reader.Read(
+      sizeof(kData) - 1,
+      [](char* scratch, StringPiece* result) {
+        return errors::Unavailable("failed");
+      },
+      &result, scratch)));
+}
+
+}  // namespace
+}  // namespace tsl
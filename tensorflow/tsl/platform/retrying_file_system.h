@@ -17,12 +17,14 @@ limitations under the License.
 #define TENSORFLOW_TSL_PLATFORM_RETRYING_FILE_SYSTEM_H_
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/errors.h"
 #include "tensorflow/tsl/platform/file_system.h"
+#include "tensorflow/tsl/platform/hedged_reads.h"
 #include "tensorflow/tsl/platform/random.h"
 #include "tensorflow/tsl/platform/retrying_utils.h"
 #include "tensorflow/tsl/platform/status.h"
@@ -30,13 +32,22 @@ limitations under the License.
 namespace tsl {
 
 /// A wrapper to add retry logic to another file system.
+///
+/// If `hedging_config` allows it, slow reads of random access files are also
+/// duplicated, see HedgedReader. The underlying random access files must
+/// then support concurrent reads.
 template <typename Underlying>
 class RetryingFileSystem : public FileSystem {
  public:
   RetryingFileSystem(std::unique_ptr<Underlying> base_file_system,
-                     const RetryConfig& retry_config)
+                     const RetryConfig& retry_config,
+                     const HedgingConfig& hedging_config = HedgingConfig())
       : base_file_system_(std::move(base_file_system)),
-        retry_config_(retry_config) {}
+        retry_config_(retry_config) {
+    if (hedging_config.max_hedged_fraction > 0) {
+      hedged_reader_ = std::make_shared<HedgedReader>(hedging_config);
+    }
+  }
 
   TF_USE_FILESYSTEM_METHODS_WITH_NO_TRANSACTION_SUPPORT;
 
@@ -164,6 +175,9 @@ class RetryingFileSystem : public FileSystem {
  private:
   std::unique_ptr<Underlying> base_file_system_;
   const RetryConfig retry_config_;
+  // Null if reads are not hedged. Shared with the random access files, which
+  // may outlive the file system.
+  std::shared_ptr<HedgedReader> hedged_reader_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(RetryingFileSystem);
 };
@@ -172,9 +186,13 @@ namespace retrying_internals {
 
 class RetryingRandomAccessFile : public RandomAccessFile {
  public:
-  RetryingRandomAccessFile(std::unique_ptr<RandomAccessFile> base_file,
-                           const RetryConfig& retry_config)
-      : base_file_(std::move(base_file)), retry_config_(retry_config) {}
+  RetryingRandomAccessFile(
+      std::unique_ptr<RandomAccessFile> base_file,
+      const RetryConfig& retry_config,
+      std::shared_ptr<HedgedReader> hedged_reader = nullptr)
+      : base_file_(std::move(base_file)),
+        retry_config_(retry_config),
+        hedged_reader_(std::move(hedged_reader)) {}
 
   Status Name(StringPiece* result) const override {
     return base_file_->Name(result);
@@ -184,14 +202,25 @@ class RetryingRandomAccessFile : public RandomAccessFile {
               char* scratch) const override {
     return RetryingUtils::CallWithRetries(
         [this, offset, n, result, scratch]() {
-          return base_file_->Read(offset, n, result, scratch);
+          if (hedged_reader_ == nullptr) {
+            return base_file_->Read(offset, n, result, scratch);
+          }
+          // The read that completes last holds on to the file.
+          return hedged_reader_->Read(
+              n,
+              [base_file = base_file_, offset, n](char* buffer,
+                                                  StringPiece* data) {
+                return base_file->Read(offset, n, data, buffer);
+              },
+              result, scratch);
         },
         retry_config_);
   }
 
  private:
-  std::unique_ptr<RandomAccessFile> base_file_;
+  std::shared_ptr<RandomAccessFile> base_file_;
   const RetryConfig retry_config_;
+  std::shared_ptr<HedgedReader> hedged_reader_;
 };
 
 class RetryingWritableFile : public WritableFile {
@@ -249,7 +278,7 @@ Status RetryingFileSystem<Underlying>::NewRandomAccessFile(
       },
       retry_config_));
   result->reset(new retrying_internals::RetryingRandomAccessFile(
-      std::move(base_file), retry_config_));
+      std::move(base_file), retry_config_, hedged_reader_));
   return OkStatus();
 }
 
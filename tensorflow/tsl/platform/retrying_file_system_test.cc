@@ -250,6 +250,38 @@ TEST(RetryingFileSystemTest, NewRandomAccessFile_SuccessWith3rdTry) {
   TF_EXPECT_OK(random_access_file->Read(0, 10, &result, scratch));
 }
 
+TEST(RetryingFileSystemTest, NewRandomAccessFile_HedgedReadsAreRetried) {
+  // Configure the mock base random access file.
+  ExpectedCalls expected_file_calls(
+      {std::make_tuple("Read", errors::Unavailable("Something is wrong")),
+       std::make_tuple("Read", errors::Unavailable("Wrong again")),
+       std::make_tuple("Read", OkStatus())});
+  std::unique_ptr<RandomAccessFile> base_file(
+      new MockRandomAccessFile(expected_file_calls));
+
+  // Configure the mock base file system.
+  ExpectedCalls expected_fs_calls(
+      {std::make_tuple("NewRandomAccessFile", OkStatus())});
+  std::unique_ptr<MockFileSystem> base_fs(
+      new MockFileSystem(expected_fs_calls));
+  base_fs->random_access_file_to_return = std::move(base_file);
+  HedgingConfig hedging_config;
+  hedging_config.max_hedged_fraction = 0.1;
+  RetryingFileSystem<MockFileSystem> fs(std::move(base_fs),
+                                        RetryConfig(0 /* init_delay_time_us */),
+                                        hedging_config);
+
+  // Retrieve the wrapped random access file.
+  std::unique_ptr<RandomAccessFile> random_access_file;
+  TF_EXPECT_OK(
+      fs.NewRandomAccessFile("filename.txt", nullptr, &random_access_file));
+
+  // Use it and check the results.
+  StringPiece result;
+  char scratch[10];
+  TF_EXPECT_OK(random_access_file->Read(0, 10, &result, scratch));
+}
+
 TEST(RetryingFileSystemTest, NewRandomAccessFile_AllRetriesFailed) {
   // Configure the mock base random access file.
   ExpectedCalls expected_file_calls = CreateRetriableErrors("Read", 11);
@@ -17,11 +17,18 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/tsl/platform/blocking_counter.h"
 #include "tensorflow/tsl/platform/context.h"
+#include "tensorflow/tsl/platform/cpu_info.h"
 #include "tensorflow/tsl/platform/denormal.h"
+#include "tensorflow/tsl/platform/env_time.h"
 #include "tensorflow/tsl/platform/logging.h"
 #include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/numa.h"
@@ -46,12 +53,23 @@ struct EigenEnvironment {
   Env* const env_;
   const ThreadOptions thread_options_;
   const string name_;
+  // CPUs the threads are pinned to, in order of creation. Empty if the
+  // threads are not pinned.
+  const std::vector<int> cpus_;
+  size_t num_threads_created_ = 0;
 
   EigenEnvironment(Env* env, const ThreadOptions& thread_options,
-                   const string& name)
-      : env_(env), thread_options_(thread_options), name_(name) {}
+                   const string& name, std::vector<int> cpus = {})
+      : env_(env),
+        thread_options_(thread_options),
+        name_(name),
+        cpus_(std::move(cpus)) {}
 
   EnvThread* CreateThread(std::function<void()> f) {
+    const int cpu = cpus_.empty()
+                        ? -1
+                        : cpus_[num_threads_created_ % cpus_.size()];
+    ++num_threads_created_;
     return env_->StartThread(thread_options_, name_, [=]() {
       // Set the processor flag to flush denormals to zero.
       port::ScopedFlushDenormal flush;
@@ -60,6 +78,10 @@ struct EigenEnvironment {
       if (thread_options_.numa_node != port::kNUMANoAffinity) {
         port::NUMASetThreadNodeAffinity(thread_options_.numa_node);
       }
+      if (cpu >= 0 && !port::SetCurrentThreadCPUAffinity(cpu)) {
+        LOG(WARNING) << "Failed to pin a thread of " << name_ << " to CPU "
+                     << cpu;
+      }
       f();
     });
   }
@@ -96,14 +118,28 @@ ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
 
 ThreadPool::ThreadPool(Env* env, const ThreadOptions& thread_options,
                        const string& name, int num_threads,
-                       bool low_latency_hint, Eigen::Allocator* allocator) {
+                       bool low_latency_hint, Eigen::Allocator* allocator,
+                       CpuAffinity cpu_affinity) {
   CHECK_GE(num_threads, 1);
+  std::vector<int> cpus;
+  int num_device_threads = num_threads;
+  if (cpu_affinity == CpuAffinity::kPhysicalCoresFirst) {
+    int num_physical_cores = 0;
+    cpus = port::CPUsByPhysicalCore(thread_options.numa_node,
+                                    &num_physical_cores);
+    if (cpus.empty()) {
+      LOG(WARNING) << "The CPU topology is unknown, the threads of " << name
+                   << " are not pinned to physical cores.";
+    } else {
+      num_device_threads = std::min(num_threads, num_physical_cores);
+    }
+  }
   eigen_threadpool_.reset(new Eigen::ThreadPoolTempl<EigenEnvironment>(
       num_threads, low_latency_hint,
-      EigenEnvironment(env, thread_options, "tf_" + name)));
+      EigenEnvironment(env, thread_options, "tf_" + name, std::move(cpus))));
   underlying_threadpool_ = eigen_threadpool_.get();
-  threadpool_device_.reset(new Eigen::ThreadPoolDevice(underlying_threadpool_,
-                                                       num_threads, allocator));
+  threadpool_device_.reset(new Eigen::ThreadPoolDevice(
+      underlying_threadpool_, num_device_threads, allocator));
 }
 
 ThreadPool::ThreadPool(thread::ThreadPoolInterface* user_threadpool) {
@@ -150,6 +186,12 @@ void ThreadPool::ParallelFor(int64_t total,
       }
       break;
     }
+    case SchedulingStrategy::kDynamic: {
+      ParallelForDynamicScheduling(
+          total, scheduling_params.cost_per_unit().value_or(0),
+          scheduling_params.block_size().value_or(1), fn);
+      break;
+    }
   }
 }
 
@@ -201,6 +243,64 @@ void ThreadPool::ParallelForFixedBlockSizeScheduling(
   counter.Wait();
 }
 
+void ThreadPool::ParallelForDynamicScheduling(
+    const int64_t total, const int64_t cost_per_unit,
+    const int64_t min_block_size,
+    const std::function<void(int64_t, int64_t)>& fn) {
+  CHECK_GE(total, 0);
+  // A block should take long enough to amortize grabbing it, and be short
+  // enough to balance the load between threads.
+  constexpr double kTargetBlockNanos = 20 * 1000;
+  const int64_t min_block = std::max<int64_t>(min_block_size, 1);
+  const int num_workers = static_cast<int>(std::min<int64_t>(
+      NumEigenDeviceThreads(), (total + min_block - 1) / min_block));
+  if (num_workers <= 1 ||
+      (cost_per_unit > 0 &&
+       static_cast<double>(total) * cost_per_unit <= kTargetBlockNanos)) {
+    fn(0, total);
+    return;
+  }
+
+  std::atomic<int64_t> next(0);
+  // Estimated nanoseconds per unit, updated after every block. Concurrent
+  // updates may be lost, which only delays the adaptation.
+  std::atomic<double> nanos_per_unit(std::max<int64_t>(cost_per_unit, 0));
+  auto work = [&]() {
+    for (;;) {
+      const int64_t remaining = total - next.load(std::memory_order_relaxed);
+      if (remaining <= 0) return;
+      const double cost = nanos_per_unit.load(std::memory_order_relaxed);
+      int64_t block_size =
+          cost > 0 ? static_cast<int64_t>(kTargetBlockNanos / cost) : min_block;
+      // Leaves at least two blocks per thread in the remaining range, so that
+      // no thread is left with a long block once the others are done.
+      block_size = std::min(block_size, remaining / (2 * num_workers));
+      block_size = std::max(block_size, min_block);
+      const int64_t first = next.fetch_add(block_size);
+      if (first >= total) return;
+      const int64_t last = std::min(total, first + block_size);
+      const uint64 start_nanos = EnvTime::NowNanos();
+      fn(first, last);
+      const double measured =
+          static_cast<double>(EnvTime::NowNanos() - start_nanos) /
+          (last - first);
+      const double previous = nanos_per_unit.load(std::memory_order_relaxed);
+      nanos_per_unit.store(previous > 0 ? (previous + measured) / 2 : measured,
+                           std::memory_order_relaxed);
+    }
+  };
+
+  BlockingCounter counter(num_workers - 1);
+  for (int i = 0; i < num_workers - 1; ++i) {
+    Schedule([&work, &counter]() {
+      work();
+      counter.DecrementCount();
+    });
+  }
+  work();
+  counter.Wait();
+}
+
 void ThreadPool::ParallelFor(int64_t total, int64_t cost_per_unit,
                              const std::function<void(int64_t, int64_t)>& fn) {
   CHECK_GE(total, 0);
@@ -246,6 +346,10 @@ int ThreadPool::NumThreads() const {
   return underlying_threadpool_->NumThreads();
 }
 
+int ThreadPool::NumEigenDeviceThreads() const {
+  return threadpool_device_->numThreads();
+}
+
 int ThreadPool::CurrentThreadId() const {
   return underlying_threadpool_->CurrentThreadId();
 }
@@ -66,11 +66,21 @@ class ThreadPool {
     // on the number of threads available in the pool. Note that when there
     // aren't enough threads in the pool to achieve full parallelism, function
     // calls will be automatically queued.
-    kFixedBlockSize
+    kFixedBlockSize,
+    // The Dynamic scheduling strategy is meant for work whose cost varies a
+    // lot between units, e.g. ragged or string data, where a static partition
+    // leaves some shards running long after the others are done. Every
+    // participating thread repeatedly grabs the next block of remaining units
+    // until none are left. Block sizes are derived from the cost per unit
+    // measured while running, starting from 'cost_per_unit' if given and from
+    // blocks of 'block_size' (1 if not given) otherwise, and shrink towards
+    // the end of the range so that all threads finish at about the same time.
+    // 'block_size' is the minimum block size.
+    kDynamic
   };
 
-  // Contains additional parameters for either the Adaptive or the Fixed Block
-  // Size scheduling strategy.
+  // Contains additional parameters for the Adaptive, the Fixed Block Size or
+  // the Dynamic scheduling strategy.
   class SchedulingParams {
    public:
     explicit SchedulingParams(SchedulingStrategy strategy,
@@ -90,27 +100,43 @@ class ThreadPool {
     SchedulingStrategy strategy_;
 
     // The estimated cost per unit of work in number of CPU cycles (or
-    // nanoseconds if not CPU-bound). Only applicable for Adaptive scheduling
-    // strategy.
+    // nanoseconds if not CPU-bound). Only applicable for Adaptive and Dynamic
+    // scheduling strategies.
     absl::optional<int64_t> cost_per_unit_;
 
     // The block size of each shard. Only applicable for Fixed Block Size
-    // scheduling strategy.
+    // scheduling strategy, and the minimum block size for Dynamic scheduling
+    // strategy.
     absl::optional<int64_t> block_size_;
   };
 
+  // How the threads of a pool are placed on CPUs.
+  enum class CpuAffinity {
+    // Threads may run on any CPU the process may run on.
+    kNone,
+    // Thread i is pinned to the i-th CPU of port::CPUsByPhysicalCore(), so
+    // that threads are spread over the physical cores before two of them
+    // share a core. Eigen kernels split their work over at most one thread
+    // per physical core, since compute-bound kernels gain little from the
+    // second hyperthread of a core.
+    kPhysicalCoresFirst,
+  };
+
   // Constructs a pool that contains "num_threads" threads with specified
   // "name". env->StartThread() is used to create individual threads with the
   // given ThreadOptions. If "low_latency_hint" is true the thread pool
   // implementation may use it as a hint that lower latency is preferred at the
   // cost of higher CPU usage, e.g. by letting one or more idle threads spin
   // wait. Conversely, if the threadpool is used to schedule high-latency
-  // operations like I/O the hint should be set to false.
+  // operations like I/O the hint should be set to false. Threads are pinned
+  // to CPUs as specified by "cpu_affinity"; threads are not pinned if the CPU
+  // topology is unknown.
   //
   // REQUIRES: num_threads > 0
   ThreadPool(Env* env, const ThreadOptions& thread_options,
              const std::string& name, int num_threads, bool low_latency_hint,
-             Eigen::Allocator* allocator = nullptr);
+             Eigen::Allocator* allocator = nullptr,
+             CpuAffinity cpu_affinity = CpuAffinity::kNone);
 
   // Constructs a pool for low-latency ops that contains "num_threads" threads
   // with specified "name". env->StartThread() is used to create individual
@@ -207,6 +233,11 @@ class ThreadPool {
   // Returns the number of threads in the pool.
   int NumThreads() const;
 
+  // Returns the number of threads Eigen kernels split their work over. This
+  // is NumThreads() unless the threads are pinned with
+  // CpuAffinity::kPhysicalCoresFirst.
+  int NumEigenDeviceThreads() const;
+
   // Returns current thread id between 0 and NumThreads() - 1, if called from a
   // thread in the pool. Returns -1 otherwise.
   int CurrentThreadId() const;
@@ -228,6 +259,15 @@ class ThreadPool {
       const int64_t total, const int64_t block_size,
       const std::function<void(int64_t, int64_t)>& fn);
 
+  // Calls fn(first, last) for consecutive blocks of [0, total) grabbed by up
+  // to NumThreads() threads including the calling thread, until the range is
+  // covered. See SchedulingStrategy::kDynamic. A non-positive 'cost_per_unit'
+  // means that the cost is unknown.
+  void ParallelForDynamicScheduling(
+      const int64_t total, const int64_t cost_per_unit,
+      const int64_t min_block_size,
+      const std::function<void(int64_t, int64_t)>& fn);
+
   // underlying_threadpool_ is the user_threadpool if user_threadpool is
   // provided in the constructor. Otherwise it is the eigen_threadpool_.
   Eigen::ThreadPoolInterface* underlying_threadpool_;
@@ -198,6 +198,14 @@ int NumHyperthreadsPerCore() {
   return (ht_per_core > 0) ? ht_per_core : 1;
 }
 
+std::vector<int> CPUsByPhysicalCore(int numa_node, int* num_physical_cores) {
+  // TODO: Read the topology with GetLogicalProcessorInformationEx.
+  *num_physical_cores = 0;
+  return {};
+}
+
+bool SetCurrentThreadCPUAffinity(int cpu) { return false; }
+
 }  // namespace port
 }  // namespace tsl
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/tsl/profiler/utils/parse_annotation.h"
 #include "tensorflow/tsl/profiler/utils/tf_op_utils.h"
 #include "tensorflow/tsl/profiler/utils/xplane_builder.h"
+#include "tensorflow/tsl/profiler/utils/xplane_schema.h"
 #include "tensorflow/tsl/profiler/utils/xplane_utils.h"
 
 namespace tsl {
@@ -44,7 +45,9 @@ void ConvertCompleteEventsToXPlane(uint64 start_timestamp_ns,
                                    TraceMeRecorder::Events&& events,
                                    XPlane* raw_plane) {
   XPlaneBuilder xplane(raw_plane);
+  uint64 num_dropped_events = 0;
   for (auto& thread : events) {
+    num_dropped_events += thread.num_dropped_events;
     XLineBuilder xline = xplane.GetOrCreateLine(thread.thread.tid);
     xline.SetName(thread.thread.name);
     xline.SetTimestampNs(start_timestamp_ns);
@@ -78,6 +81,11 @@ void ConvertCompleteEventsToXPlane(uint64 start_timestamp_ns,
       }
     }
   }
+  if (num_dropped_events > 0) {
+    xplane.AddStatValue(*xplane.GetOrCreateStatMetadata(GetStatTypeStr(
+                            StatType::kDroppedTraceMeEvents)),
+                        num_dropped_events);
+  }
   SortXLinesBy(raw_plane, XLinesComparatorByName());
 }
 
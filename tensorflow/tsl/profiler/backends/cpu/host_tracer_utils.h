@@ -22,7 +22,8 @@ limitations under the License.
 namespace tsl {
 namespace profiler {
 
-// Convert complete events to XPlane format.
+// Convert complete events to XPlane format. The number of events dropped
+// because of full thread buffers, if any, is added as a plane stat.
 void ConvertCompleteEventsToXPlane(uint64 start_timestamp_ns,
                                    TraceMeRecorder::Events&& events,
                                    tensorflow::profiler::XPlane* raw_plane);
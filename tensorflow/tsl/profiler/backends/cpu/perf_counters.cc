@@ -0,0 +1,148 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/tsl/profiler/backends/cpu/perf_counters.h"
+
+#include <atomic>
+#include <cstdint>
+
+#include "tensorflow/tsl/platform/logging.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace tsl {
+namespace profiler {
+namespace internal {
+
+std::atomic<bool> g_perf_counters_active(false);
+
+}  // namespace internal
+
+#if defined(__linux__)
+namespace {
+
+// The counters of a thread, read together as a group so that their values
+// cover the same time range.
+class ThreadPerfCounters {
+ public:
+  ThreadPerfCounters() {
+    const uint64_t configs[kNumCounters] = {PERF_COUNT_HW_CPU_CYCLES,
+                                            PERF_COUNT_HW_INSTRUCTIONS,
+                                            PERF_COUNT_HW_CACHE_MISSES};
+    for (int i = 0; i < kNumCounters; ++i) {
+      fds_[i] = Open(configs[i], /*group_fd=*/i == 0 ? -1 : fds_[0]);
+      if (fds_[i] < 0) {
+        VLOG(1) << "perf_event_open failed: " << strerror(errno);
+        Close();
+        return;
+      }
+    }
+    ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+
+  ~ThreadPerfCounters() { Close(); }
+
+  bool Read(PerfCounterValues* values) const {
+    if (fds_[0] < 0) return false;
+    // Layout of a group read without PERF_FORMAT_ID.
+    struct {
+      uint64_t nr;
+      uint64_t values[kNumCounters];
+    } data;
+    if (read(fds_[0], &data, sizeof(data)) != sizeof(data) ||
+        data.nr != kNumCounters) {
+      return false;
+    }
+    values->cycles = data.values[0];
+    values->instructions = data.values[1];
+    values->llc_misses = data.values[2];
+    return true;
+  }
+
+ private:
+  static constexpr int kNumCounters = 3;
+
+  static int Open(uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // The leader is enabled once the whole group is open.
+    attr.disabled = group_fd == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                   group_fd, /*flags=*/0);
+  }
+
+  void Close() {
+    for (int i = kNumCounters - 1; i >= 0; --i) {
+      if (fds_[i] >= 0) close(fds_[i]);
+      fds_[i] = -1;
+    }
+  }
+
+  int fds_[kNumCounters] = {-1, -1, -1};
+};
+
+bool ReadThreadPerfCounters(PerfCounterValues* values) {
+  static thread_local ThreadPerfCounters counters;
+  return counters.Read(values);
+}
+
+}  // namespace
+
+bool PerfCounters::Start() {
+  PerfCounterValues values;
+  if (!ReadThreadPerfCounters(&values)) {
+    LOG(WARNING) << "Hardware performance counters are unavailable, check "
+                    "/proc/sys/kernel/perf_event_paranoid";
+    return false;
+  }
+  internal::g_perf_counters_active.store(true, std::memory_order_release);
+  return true;
+}
+
+bool PerfCounters::Read(PerfCounterValues* values) {
+  return Active() && ReadThreadPerfCounters(values);
+}
+
+#else  // !defined(__linux__)
+
+bool PerfCounters::Start() {
+  LOG(WARNING) << "Hardware performance counters are only supported on Linux";
+  return false;
+}
+
+bool PerfCounters::Read(PerfCounterValues* values) { return false; }
+
+#endif  // defined(__linux__)
+
+void PerfCounters::Stop() {
+  internal::g_perf_counters_active.store(false, std::memory_order_release);
+}
+
+}  // namespace profiler
+}  // namespace tsl
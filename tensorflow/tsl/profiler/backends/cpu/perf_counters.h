@@ -0,0 +1,111 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
+#define TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "tensorflow/tsl/platform/macros.h"
+#include "tensorflow/tsl/profiler/lib/traceme_encode.h"
+
+namespace tsl {
+namespace profiler {
+namespace internal {
+
+// Whether hardware counters are being collected.
+// Static atomic so PerfCounters::Active can be fast and non-blocking.
+// Modified by PerfCounters::Start and PerfCounters::Stop.
+TF_EXPORT extern std::atomic<bool> g_perf_counters_active;
+
+}  // namespace internal
+
+// Values of the hardware performance counters of a thread, counting user space
+// events since the counters were opened.
+struct PerfCounterValues {
+  uint64_t cycles = 0;
+  uint64_t instructions = 0;
+  // Last level cache misses. Each of them loads a cache line from memory, so
+  // they approximate the memory traffic of a memory-bound op.
+  uint64_t llc_misses = 0;
+};
+
+// PerfCounters reads the hardware performance counters of the calling thread
+// through perf_event_open(2). The counters of a thread are opened the first
+// time it reads them while collection is active, and stay open until the
+// thread exits.
+//
+// Collection is only supported on Linux, and requires the kernel to allow
+// perf events for unprivileged processes (see
+// /proc/sys/kernel/perf_event_paranoid) unless running with CAP_PERFMON.
+class PerfCounters {
+ public:
+  // Starts collection. Returns false if the counters can't be opened, in
+  // which case collection stays inactive.
+  static bool Start();
+
+  // Stops collection.
+  static void Stop();
+
+  // Returns whether collection is active.
+  static inline bool Active() {
+    return internal::g_perf_counters_active.load(std::memory_order_acquire);
+  }
+
+  // Reads the counters of the calling thread. Returns false if collection is
+  // inactive or the counters of this thread can't be opened.
+  static bool Read(PerfCounterValues* values);
+};
+
+// Reads the counters of the calling thread at construction, and encodes the
+// counts since then as TraceMe metadata, e.g. to attach the counters of an op
+// to its TraceMe:
+//
+//   ScopedPerfCounters perf_counters;
+//   Compute();
+//   trace_me.AppendMetadata([&] { return perf_counters.EncodeDeltas(); });
+class ScopedPerfCounters {
+ public:
+  ScopedPerfCounters()
+      : valid_(PerfCounters::Active() && PerfCounters::Read(&start_)) {}
+
+  // Returns whether the counters were read at construction.
+  bool valid() const { return valid_; }
+
+  // Returns the counts since construction, encoded as TraceMe metadata with
+  // the names of the corresponding XStats, or an empty string if the counters
+  // can't be read.
+  std::string EncodeDeltas() const {
+    PerfCounterValues end;
+    if (!valid_ || !PerfCounters::Read(&end)) return std::string();
+    return TraceMeEncode({{"cpu_cycles", end.cycles - start_.cycles},
+                          {"cpu_instructions",
+                           end.instructions - start_.instructions},
+                          {"llc_misses", end.llc_misses - start_.llc_misses}});
+  }
+
+ private:
+  ScopedPerfCounters(const ScopedPerfCounters&) = delete;
+  void operator=(const ScopedPerfCounters&) = delete;
+
+  PerfCounterValues start_;
+  const bool valid_;
+};
+
+}  // namespace profiler
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PROFILER_BACKENDS_CPU_PERF_COUNTERS_H_
@@ -45,6 +45,10 @@ static_assert(ATOMIC_INT_LOCK_FREE == 2, "Assumed atomic<int> was lock free");
 
 namespace {
 
+// Maximum number of events buffered per thread, or kUnboundedEvents.
+// Modified by TraceMeRecorder::StartRecording before tracing starts.
+std::atomic<size_t> g_max_events_per_thread(TraceMeRecorder::kUnboundedEvents);
+
 // Track events created by ActivityStart and merge their data into events
 // created by ActivityEnd. TraceMe records events in its destructor, so this
 // results in complete events sorted by their end_time in the thread they ended.
@@ -105,7 +109,8 @@ class SplitEventTracker {
 // Push writes at end_, and then advances it, allocating a block if needed.
 // Consume takes ownership of events in the range [start_, end_).
 // Clear removes events in the range [start_, end_).
-// The end_ pointer is atomic so Push and Consume can be concurrent.
+// The end_ pointer is atomic so Push and Consume can be concurrent. The start_
+// pointer is atomic so the producer can read the size of the queue.
 //
 // Push and Consume are lock free and each might be called from at most one
 // thread. Push is only called by the owner thread. Consume is only called by
@@ -122,7 +127,7 @@ class EventQueue {
       : start_block_(new Block{/*start=*/0, /*next=*/nullptr}),
         start_(start_block_->start),
         end_block_(start_block_),
-        end_(start_) {}
+        end_(start_block_->start) {}
 
   // Memory should be deallocated and trace events destroyed on destruction.
   // This doesn't require global lock as this discards all the stored trace
@@ -147,10 +152,17 @@ class EventQueue {
     end_.store(end, std::memory_order_release);  // Write index after contents.
   }
 
+  // Returns the number of events in the queue. Only called by the producer.
+  // Events removed by a concurrent Consume may still be counted.
+  size_t Size() const {
+    return end_.load(std::memory_order_relaxed) -
+           start_.load(std::memory_order_acquire);
+  }
+
   // Removes all events from the queue.
   void Clear() {
     size_t end = end_.load(std::memory_order_acquire);
-    while (start_ != end) {
+    while (start_.load(std::memory_order_relaxed) != end) {
       Pop();
     }
   }
@@ -166,7 +178,7 @@ class EventQueue {
     // Read index before contents.
     size_t end = end_.load(std::memory_order_acquire);
     std::deque<TraceMeRecorder::Event> result;
-    while (start_ != end) {
+    while (start_.load(std::memory_order_relaxed) != end) {
       TraceMeRecorder::Event event = Pop();
       // Copy data from start events to end events. TraceMe records events in
       // its destructor, so this results in complete events sorted by their
@@ -187,7 +199,8 @@ class EventQueue {
  private:
   // Returns true if the queue is empty at the time of invocation.
   bool Empty() const {
-    return (start_ == end_.load(std::memory_order_acquire));
+    return (start_.load(std::memory_order_relaxed) ==
+            end_.load(std::memory_order_acquire));
   }
 
   // Remove one event off the front of the queue and return it.
@@ -195,17 +208,19 @@ class EventQueue {
   TraceMeRecorder::Event Pop() {
     DCHECK(!Empty());
     // Move the next event into the output.
-    auto& event = start_block_->events[start_++ - start_block_->start].event;
+    size_t start = start_.load(std::memory_order_relaxed);
+    auto& event = start_block_->events[start++ - start_block_->start].event;
     TraceMeRecorder::Event out = std::move(event);
     event.~Event();  // Events must be individually destroyed.
     // If we reach the end of a block, we own it and should delete it.
     // The next block is present: end always points to something.
-    if (TF_PREDICT_FALSE(start_ - start_block_->start == Block::kNumSlots)) {
+    if (TF_PREDICT_FALSE(start - start_block_->start == Block::kNumSlots)) {
       auto* next_block = start_block_->next;
       delete start_block_;
       start_block_ = next_block;
-      DCHECK_EQ(start_, start_block_->start);
+      DCHECK_EQ(start, start_block_->start);
     }
+    start_.store(start, std::memory_order_release);
     return out;
   }
 
@@ -231,7 +246,7 @@ class EventQueue {
 
   // Head of list for reading. Only accessed by consumer thread.
   Block* start_block_;
-  size_t start_;
+  std::atomic<size_t> start_;  // Atomic: also read by producer thread.
   // Tail of list for writing. Accessed by producer thread.
   Block* end_block_;
   std::atomic<size_t> end_;  // Atomic: also read by consumer thread.
@@ -258,22 +273,35 @@ class TraceMeRecorder::ThreadLocalRecorder {
   // SetInactive is called when the owner thread is destroyed.
   void SetInactive() { active_.store(0, std::memory_order_release); }
 
-  // Record is only called from the owner thread.
-  void Record(TraceMeRecorder::Event&& event) { queue_.Push(std::move(event)); }
+  // Record is only called from the owner thread. Drops the event if the queue
+  // holds max_events events already.
+  void Record(TraceMeRecorder::Event&& event, size_t max_events) {
+    if (TF_PREDICT_FALSE(max_events != TraceMeRecorder::kUnboundedEvents &&
+                         queue_.Size() >= max_events)) {
+      num_dropped_events_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    queue_.Push(std::move(event));
+  }
 
   // Clear is called from the control thread when tracing starts to remove any
   // elements added due to Record racing with Consume.
-  void Clear() { queue_.Clear(); }
+  void Clear() {
+    queue_.Clear();
+    num_dropped_events_.store(0, std::memory_order_relaxed);
+  }
 
   // Consume is called from the control thread when tracing stops.
   TF_MUST_USE_RESULT TraceMeRecorder::ThreadEvents Consume(
       SplitEventTracker* split_event_tracker) {
-    return {info_, queue_.Consume(split_event_tracker)};
+    return {info_, queue_.Consume(split_event_tracker),
+            num_dropped_events_.exchange(0, std::memory_order_relaxed)};
   }
 
  private:
   TraceMeRecorder::ThreadInfo info_;
   EventQueue queue_;
+  std::atomic<uint64_t> num_dropped_events_{0};
   std::atomic<int> active_{1};  // std::atomic<bool> is not always lock-free.
 };
 
@@ -289,7 +317,8 @@ class TraceMeRecorder::ThreadLocalRecorderWrapper {
   }
 
   void Record(TraceMeRecorder::Event&& event) {
-    recorder_->Record(std::move(event));
+    recorder_->Record(std::move(event),
+                      g_max_events_per_thread.load(std::memory_order_relaxed));
   }
 
   ~ThreadLocalRecorderWrapper() {
@@ -350,7 +379,7 @@ TraceMeRecorder::Events TraceMeRecorder::Consume() {
     auto& recorder = iter->second;
     TraceMeRecorder::ThreadEvents events =
         recorder->Consume(&split_event_tracker);
-    if (!events.events.empty()) {
+    if (!events.events.empty() || events.num_dropped_events > 0) {
       result.push_back(std::move(events));
     }
     // We can have an active thread here. If a thread is destroyed while tracing
@@ -365,9 +394,15 @@ TraceMeRecorder::Events TraceMeRecorder::Consume() {
   return result;
 }
 
-bool TraceMeRecorder::StartRecording(int level) {
+bool TraceMeRecorder::StartRecording(int level, size_t max_events_per_thread) {
   level = std::max(0, level);
   mutex_lock lock(mutex_);
+  if (internal::g_trace_level.load(std::memory_order_acquire) !=
+      kTracingDisabled) {
+    return false;
+  }
+  g_max_events_per_thread.store(max_events_per_thread,
+                                std::memory_order_relaxed);
   // Change trace_level_ while holding mutex_.
   int expected = kTracingDisabled;
   bool started = internal::g_trace_level.compare_exchange_strong(
@@ -77,13 +77,25 @@ class TraceMeRecorder {
   struct ThreadEvents {
     ThreadInfo thread;
     std::deque<Event> events;
+    // Number of events the thread recorded while its buffer was full.
+    uint64_t num_dropped_events = 0;
   };
   using Events = std::vector<ThreadEvents>;
 
   // Starts recording of TraceMe().
   // Only traces <= level will be recorded.
   // Level must be >= 0. If level is 0, no traces will be recorded.
-  static bool Start(int level) { return Get()->StartRecording(level); }
+  static bool Start(int level) {
+    return Get()->StartRecording(level, kUnboundedEvents);
+  }
+
+  // Same as above, but each thread buffers at most `max_events_per_thread`
+  // events until Stop(), so that long captures use a bounded amount of memory.
+  // Once a thread's buffer is full, its new events are dropped and counted in
+  // ThreadEvents::num_dropped_events. Zero means unbounded.
+  static bool Start(int level, size_t max_events_per_thread) {
+    return Get()->StartRecording(level, max_events_per_thread);
+  }
 
   // Stops recording and returns events recorded since Start().
   // Events passed to Record after Stop has started will be dropped.
@@ -97,6 +109,9 @@ class TraceMeRecorder {
   // Default value for trace_level_ when tracing is disabled
   static constexpr int kTracingDisabled = -1;
 
+  // Value of max_events_per_thread for buffers without a size limit.
+  static constexpr size_t kUnboundedEvents = 0;
+
   // Records an event. Non-blocking.
   static void Record(Event&& event);
 
@@ -117,7 +132,7 @@ class TraceMeRecorder {
   void RegisterThread(uint32 tid, std::shared_ptr<ThreadLocalRecorder> thread);
   void UnregisterThread(uint32 tid);
 
-  bool StartRecording(int level);
+  bool StartRecording(int level, size_t max_events_per_thread);
   Events StopRecording();
 
   // Clears events from all active threads that were added due to Record
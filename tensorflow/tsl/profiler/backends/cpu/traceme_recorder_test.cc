@@ -56,6 +56,34 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, BoundedBuffer) {
+  int64_t start_time = GetCurrentTimeNanos();
+  int64_t end_time = start_time + UniToNano(1);
+
+  TraceMeRecorder::Start(/*level=*/1, /*max_events_per_thread=*/2);
+  TraceMeRecorder::Record({"event1", start_time, end_time});
+  TraceMeRecorder::Record({"event2", start_time, end_time});
+  TraceMeRecorder::Record({"event3", start_time, end_time});
+  TraceMeRecorder::Record({"event4", start_time, end_time});
+  auto results = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events,
+              ElementsAre(Named("event1"), Named("event2")));
+  EXPECT_EQ(results[0].num_dropped_events, 2);
+
+  // The limit and the drop counter don't carry over to the next session.
+  TraceMeRecorder::Start(/*level=*/1);
+  TraceMeRecorder::Record({"event5", start_time, end_time});
+  TraceMeRecorder::Record({"event6", start_time, end_time});
+  TraceMeRecorder::Record({"event7", start_time, end_time});
+  results = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_EQ(results[0].events.size(), 3);
+  EXPECT_EQ(results[0].num_dropped_events, 0);
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //
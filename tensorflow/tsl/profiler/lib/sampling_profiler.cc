@@ -0,0 +1,210 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/tsl/profiler/lib/sampling_profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "tensorflow/tsl/platform/logging.h"
+#include "tensorflow/tsl/platform/random.h"
+#include "tensorflow/tsl/profiler/utils/math_utils.h"
+#include "tensorflow/tsl/profiler/utils/time_utils.h"
+#include "tensorflow/tsl/profiler/utils/xplane_schema.h"
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+using tensorflow::ProfileOptions;
+using tensorflow::profiler::XPlane;
+using tensorflow::profiler::XSpace;
+
+void AddEvent(uint64_t duration_ps, SampledEventStats* stats) {
+  stats->count++;
+  stats->total_duration_ps += duration_ps;
+  stats->max_duration_ps = std::max(stats->max_duration_ps, duration_ps);
+}
+
+void MergeStats(const SampledEventStats& src, SampledEventStats* dst) {
+  dst->count += src.count;
+  dst->total_duration_ps += src.total_duration_ps;
+  dst->max_duration_ps = std::max(dst->max_duration_ps, src.max_duration_ps);
+}
+
+}  // namespace
+
+ProfileOptions DefaultSamplingProfileOptions() {
+  ProfileOptions options = ProfilerSession::DefaultOptions();
+  options.set_device_type(ProfileOptions::CPU);
+  options.set_device_tracer_level(0);
+  options.set_host_tracer_level(1);
+  options.set_enable_hlo_proto(false);
+  options.set_include_dataset_ops(false);
+  return options;
+}
+
+SamplingProfiler* SamplingProfiler::Get() {
+  static SamplingProfiler* profiler = new SamplingProfiler();
+  return profiler;
+}
+
+void SamplingProfiler::Enable(const Options& options) {
+  mutex_lock lock(mutex_);
+  enabled_ = true;
+  options_ = options;
+  windows_.clear();
+}
+
+void SamplingProfiler::Disable() {
+  mutex_lock lock(mutex_);
+  enabled_ = false;
+}
+
+bool SamplingProfiler::enabled() const {
+  mutex_lock lock(mutex_);
+  return enabled_;
+}
+
+ProfileOptions SamplingProfiler::GetProfileOptions() const {
+  mutex_lock lock(mutex_);
+  return options_.profile_options;
+}
+
+bool SamplingProfiler::ShouldSample() const {
+  double sample_rate;
+  {
+    mutex_lock lock(mutex_);
+    if (!enabled_) return false;
+    sample_rate = options_.sample_rate;
+  }
+  if (sample_rate <= 0) return false;
+  if (sample_rate >= 1) return true;
+  return static_cast<double>(random::ThreadLocalNew64()) <
+         sample_rate * static_cast<double>(std::numeric_limits<uint64_t>::max());
+}
+
+void SamplingProfiler::AddSampledStep(const XSpace& space, uint64_t time_ns) {
+  const XPlane* host_plane = nullptr;
+  for (const XPlane& plane : space.planes()) {
+    if (plane.name() == kHostThreadsPlaneName) {
+      host_plane = &plane;
+      break;
+    }
+  }
+
+  mutex_lock lock(mutex_);
+  if (!enabled_ || options_.window_duration_ns == 0) return;
+  const uint64_t start_ns = time_ns - time_ns % options_.window_duration_ns;
+  if (windows_.empty() || windows_.back().start_ns < start_ns) {
+    windows_.emplace_back();
+    windows_.back().start_ns = start_ns;
+  }
+  // Steps finishing out of order are added to the latest window.
+  Window& window = windows_.back();
+  window.num_steps++;
+  if (host_plane != nullptr) {
+    for (const auto& line : host_plane->lines()) {
+      for (const auto& event : line.events()) {
+        auto it = host_plane->event_metadata().find(event.metadata_id());
+        if (it == host_plane->event_metadata().end()) continue;
+        AddEvent(event.duration_ps(), &window.stats[it->second.name()]);
+      }
+    }
+  }
+  const size_t max_windows = std::max(options_.num_windows, 1);
+  while (windows_.size() > max_windows) {
+    windows_.pop_front();
+  }
+}
+
+absl::flat_hash_map<std::string, SampledEventStats> SamplingProfiler::GetStats(
+    uint64_t since_ns) const {
+  absl::flat_hash_map<std::string, SampledEventStats> stats;
+  mutex_lock lock(mutex_);
+  for (const Window& window : windows_) {
+    if (window.start_ns < since_ns) continue;
+    for (const auto& entry : window.stats) {
+      MergeStats(entry.second, &stats[entry.first]);
+    }
+  }
+  return stats;
+}
+
+int64_t SamplingProfiler::GetNumSampledSteps(uint64_t since_ns) const {
+  int64_t num_steps = 0;
+  mutex_lock lock(mutex_);
+  for (const Window& window : windows_) {
+    if (window.start_ns >= since_ns) num_steps += window.num_steps;
+  }
+  return num_steps;
+}
+
+std::string SamplingProfiler::Summary(uint64_t since_ns,
+                                      int max_events) const {
+  const absl::flat_hash_map<std::string, SampledEventStats> stats =
+      GetStats(since_ns);
+  std::vector<std::pair<std::string, SampledEventStats>> sorted(stats.begin(),
+                                                                stats.end());
+  std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+    if (a.second.total_duration_ps != b.second.total_duration_ps) {
+      return a.second.total_duration_ps > b.second.total_duration_ps;
+    }
+    return a.first < b.first;
+  });
+  const size_t max_sorted = std::max(max_events, 0);
+  if (sorted.size() > max_sorted) sorted.resize(max_sorted);
+
+  std::string summary =
+      absl::StrFormat("Sampled steps: %d\n", GetNumSampledSteps(since_ns));
+  absl::StrAppendFormat(&summary, "%12s %14s %14s %14s  %s\n", "count",
+                        "total_us", "avg_us", "max_us", "name");
+  for (const auto& entry : sorted) {
+    const SampledEventStats& event_stats = entry.second;
+    absl::StrAppendFormat(
+        &summary, "%12d %14.3f %14.3f %14.3f  %s\n", event_stats.count,
+        PicoToMicro(event_stats.total_duration_ps),
+        PicoToMicro(event_stats.total_duration_ps) / event_stats.count,
+        PicoToMicro(event_stats.max_duration_ps), entry.first);
+  }
+  return summary;
+}
+
+SampledStep::SampledStep(SamplingProfiler* profiler) : profiler_(profiler) {
+  if (!profiler_->ShouldSample()) return;
+  session_ = ProfilerSession::Create(profiler_->GetProfileOptions());
+  if (!session_->Status().ok()) {
+    VLOG(1) << "Skipping sampled step: " << session_->Status();
+    session_.reset();
+  }
+}
+
+SampledStep::~SampledStep() {
+  if (session_ == nullptr) return;
+  XSpace space;
+  Status status = session_->CollectData(&space);
+  if (!status.ok()) {
+    VLOG(1) << "Failed to collect sampled step: " << status;
+    return;
+  }
+  profiler_->AddSampledStep(space, GetCurrentTimeNanos());
+}
+
+}  // namespace profiler
+}  // namespace tsl
@@ -0,0 +1,150 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_TSL_PROFILER_LIB_SAMPLING_PROFILER_H_
+#define TENSORFLOW_TSL_PROFILER_LIB_SAMPLING_PROFILER_H_
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/tsl/platform/mutex.h"
+#include "tensorflow/tsl/platform/thread_annotations.h"
+#include "tensorflow/tsl/profiler/lib/profiler_session.h"
+#include "tensorflow/tsl/profiler/protobuf/profiler_options.pb.h"
+#include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
+
+namespace tsl {
+namespace profiler {
+
+// Stats of the host events sharing a name, e.g. the executions of an op.
+struct SampledEventStats {
+  int64_t count = 0;
+  // Durations include the time spent in nested events.
+  uint64_t total_duration_ps = 0;
+  uint64_t max_duration_ps = 0;
+};
+
+// Returns profile options recording host events only, with a low tracer level.
+tensorflow::ProfileOptions DefaultSamplingProfileOptions();
+
+// An always-on profiler meant for production jobs. It profiles a random
+// fraction of the steps (or requests) of a program, aggregates the host events
+// recorded in them by name, and keeps the stats of a few recent time windows.
+// Unlike a ProfilerSession capturing a whole time range, it has no cost for
+// steps that aren't sampled, so that the stats of a fleet of jobs can be
+// monitored continuously, e.g. through the Monitor RPC of the profiler
+// service.
+//
+// A sampled step is skipped if another profiler is active at that time, e.g.
+// for an on-demand capture.
+//
+// Thread-safety: SamplingProfiler is thread-safe.
+class SamplingProfiler {
+ public:
+  struct Options {
+    // Fraction of the steps that are profiled.
+    double sample_rate = 0.01;
+    // Stats are aggregated per window of this duration.
+    uint64_t window_duration_ns = 60ull * 1000 * 1000 * 1000;
+    // Number of windows kept, the oldest one being dropped first.
+    int num_windows = 10;
+    // Options of the profiler session of a sampled step. Only host events are
+    // aggregated.
+    tensorflow::ProfileOptions profile_options =
+        DefaultSamplingProfileOptions();
+  };
+
+  // Returns the profiler of this process, which is disabled until Enable() is
+  // called.
+  static SamplingProfiler* Get();
+
+  SamplingProfiler() = default;
+
+  // Starts sampling steps, discarding previously aggregated stats.
+  void Enable(const Options& options) TF_LOCKS_EXCLUDED(mutex_);
+  void Disable() TF_LOCKS_EXCLUDED(mutex_);
+  bool enabled() const TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns whether the next step should be profiled. Returns false while
+  // disabled.
+  bool ShouldSample() const TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the options of the profiler session of a sampled step.
+  tensorflow::ProfileOptions GetProfileOptions() const
+      TF_LOCKS_EXCLUDED(mutex_);
+
+  // Adds the host events of `space`, recorded during a sampled step, to the
+  // window containing `time_ns`.
+  void AddSampledStep(const tensorflow::profiler::XSpace& space,
+                      uint64_t time_ns) TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the stats of the windows that started at `since_ns` or later, or
+  // of all kept windows if `since_ns` is zero.
+  absl::flat_hash_map<std::string, SampledEventStats> GetStats(
+      uint64_t since_ns = 0) const TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns the number of steps whose events were aggregated in the windows
+  // selected as in GetStats().
+  int64_t GetNumSampledSteps(uint64_t since_ns = 0) const
+      TF_LOCKS_EXCLUDED(mutex_);
+
+  // Returns a human readable table of the `max_events` events with the
+  // largest total duration, selected as in GetStats().
+  std::string Summary(uint64_t since_ns = 0, int max_events = 20) const
+      TF_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  struct Window {
+    uint64_t start_ns = 0;
+    int64_t num_steps = 0;
+    absl::flat_hash_map<std::string, SampledEventStats> stats;
+  };
+
+  mutable mutex mutex_;
+  bool enabled_ TF_GUARDED_BY(mutex_) = false;
+  Options options_ TF_GUARDED_BY(mutex_);
+  // Ordered by start time.
+  std::deque<Window> windows_ TF_GUARDED_BY(mutex_);
+};
+
+// Profiles the enclosing scope, e.g. one step of a training loop or one request
+// of a server, if the SamplingProfiler samples it:
+//
+//   for (...) {
+//     SampledStep sampled_step;
+//     RunStep();
+//   }
+class SampledStep {
+ public:
+  explicit SampledStep(SamplingProfiler* profiler = SamplingProfiler::Get());
+  ~SampledStep();
+
+  // Returns whether this step is being profiled.
+  bool sampled() const { return session_ != nullptr; }
+
+ private:
+  SampledStep(const SampledStep&) = delete;
+  SampledStep& operator=(const SampledStep&) = delete;
+
+  SamplingProfiler* profiler_;
+  std::unique_ptr<ProfilerSession> session_;
+};
+
+}  // namespace profiler
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PROFILER_LIB_SAMPLING_PROFILER_H_
@@ -0,0 +1,120 @@
+/* Copyright 2023 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/tsl/profiler/lib/sampling_profiler.h"
+
+#include <initializer_list>
+#include <string>
+
+#include "absl/strings/match.h"
+#include "tensorflow/tsl/platform/test.h"
+#include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/tsl/profiler/utils/xplane_schema.h"
+
+namespace tsl {
+namespace profiler {
+namespace {
+
+using tensorflow::profiler::XPlane;
+using tensorflow::profiler::XSpace;
+
+constexpr uint64_t kWindowNs = 1000;
+
+// Returns a space with one host event per duration, all named `name`.
+XSpace CreateSpace(const std::string& name,
+                   std::initializer_list<uint64_t> durations_ps) {
+  XSpace space;
+  XPlane* plane = space.add_planes();
+  plane->set_name(std::string(kHostThreadsPlaneName));
+  (*plane->mutable_event_metadata())[1].set_name(name);
+  auto* line = plane->add_lines();
+  for (uint64_t duration_ps : durations_ps) {
+    auto* event = line->add_events();
+    event->set_metadata_id(1);
+    event->set_duration_ps(duration_ps);
+  }
+  return space;
+}
+
+SamplingProfiler::Options TestOptions() {
+  SamplingProfiler::Options options;
+  options.window_duration_ns = kWindowNs;
+  options.num_windows = 2;
+  return options;
+}
+
+TEST(SamplingProfilerTest, DisabledProfilerDoesNotSample) {
+  SamplingProfiler profiler;
+  EXPECT_FALSE(profiler.enabled());
+  EXPECT_FALSE(profiler.ShouldSample());
+  profiler.AddSampledStep(CreateSpace("MatMul", {10}), /*time_ns=*/0);
+  EXPECT_EQ(profiler.GetNumSampledSteps(), 0);
+}
+
+TEST(SamplingProfilerTest, SampleRate) {
+  SamplingProfiler profiler;
+  SamplingProfiler::Options options = TestOptions();
+  options.sample_rate = 0;
+  profiler.Enable(options);
+  EXPECT_FALSE(profiler.ShouldSample());
+  options.sample_rate = 1;
+  profiler.Enable(options);
+  EXPECT_TRUE(profiler.ShouldSample());
+}
+
+TEST(SamplingProfilerTest, AggregatesEventsPerWindow) {
+  SamplingProfiler profiler;
+  profiler.Enable(TestOptions());
+  profiler.AddSampledStep(CreateSpace("MatMul", {10, 30}), /*time_ns=*/100);
+  profiler.AddSampledStep(CreateSpace("MatMul", {20}), /*time_ns=*/1100);
+  profiler.AddSampledStep(CreateSpace("Conv2D", {5}), /*time_ns=*/1200);
+
+  EXPECT_EQ(profiler.GetNumSampledSteps(), 3);
+  auto stats = profiler.GetStats();
+  EXPECT_EQ(stats["MatMul"].count, 3);
+  EXPECT_EQ(stats["MatMul"].total_duration_ps, 60);
+  EXPECT_EQ(stats["MatMul"].max_duration_ps, 30);
+  EXPECT_EQ(stats["Conv2D"].count, 1);
+
+  // Only the second window.
+  EXPECT_EQ(profiler.GetNumSampledSteps(/*since_ns=*/kWindowNs), 2);
+  stats = profiler.GetStats(/*since_ns=*/kWindowNs);
+  EXPECT_EQ(stats["MatMul"].count, 1);
+  EXPECT_EQ(stats["MatMul"].total_duration_ps, 20);
+
+  // The first window is dropped when a third one starts.
+  profiler.AddSampledStep(CreateSpace("MatMul", {40}), /*time_ns=*/2000);
+  stats = profiler.GetStats();
+  EXPECT_EQ(stats["MatMul"].count, 2);
+  EXPECT_EQ(stats["MatMul"].total_duration_ps, 60);
+  EXPECT_EQ(profiler.GetNumSampledSteps(), 3);
+}
+
+TEST(SamplingProfilerTest, SummaryListsLongestEventsFirst) {
+  SamplingProfiler profiler;
+  profiler.Enable(TestOptions());
+  profiler.AddSampledStep(CreateSpace("Conv2D", {1000000}), /*time_ns=*/0);
+  profiler.AddSampledStep(CreateSpace("MatMul", {3000000}), /*time_ns=*/0);
+  const std::string summary = profiler.Summary();
+  EXPECT_TRUE(absl::StrContains(summary, "Sampled steps: 2"));
+  ASSERT_TRUE(absl::StrContains(summary, "MatMul"));
+  ASSERT_TRUE(absl::StrContains(summary, "Conv2D"));
+  EXPECT_LT(summary.find("MatMul"), summary.find("Conv2D"));
+  EXPECT_FALSE(absl::StrContains(profiler.Summary(0, /*max_events=*/1),
+                                 "Conv2D"));
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tsl
@@ -16,9 +16,12 @@ limitations under the License.
 #include "tensorflow/tsl/profiler/rpc/profiler_service_impl.h"
 
 #include <memory>
+#include <string>
+#include <utility>
 
 #include "grpcpp/support/status.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
 #include "tensorflow/tsl/platform/env.h"
 #include "tensorflow/tsl/platform/env_time.h"
@@ -28,6 +31,7 @@ limitations under the License.
 #include "tensorflow/tsl/platform/mutex.h"
 #include "tensorflow/tsl/platform/status.h"
 #include "tensorflow/tsl/profiler/lib/profiler_session.h"
+#include "tensorflow/tsl/profiler/lib/sampling_profiler.h"
 #include "tensorflow/tsl/profiler/protobuf/profiler_service.grpc.pb.h"
 #include "tensorflow/tsl/profiler/protobuf/profiler_service.pb.h"
 #include "tensorflow/tsl/profiler/protobuf/xplane.pb.h"
@@ -66,9 +70,28 @@ Status CollectDataToRepository(const ProfileRequest& request,
 
 class ProfilerServiceImpl : public tensorflow::grpc::ProfilerService::Service {
  public:
+  // Returns the stats aggregated by the SamplingProfiler over the last
+  // `duration_ms`, or over all the windows it keeps if zero.
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
                          MonitorResponse* response) override {
-    return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "unimplemented.");
+    SamplingProfiler* sampling_profiler = SamplingProfiler::Get();
+    if (!sampling_profiler->enabled()) {
+      return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED,
+                            "The sampling profiler is not enabled.");
+    }
+    const uint64 now_ns = GetCurrentTimeNanos();
+    const uint64 duration_ns = MilliToNano(req->duration_ms());
+    const uint64 since_ns =
+        duration_ns > 0 && duration_ns < now_ns ? now_ns - duration_ns : 0;
+    std::string data;
+    if (req->timestamp()) {
+      data = absl::StrCat("Timestamp: ", now_ns, " ns\n");
+    }
+    absl::StrAppend(&data, sampling_profiler->Summary(
+                               since_ns, /*max_events=*/
+                               req->monitoring_level() >= 2 ? 100 : 20));
+    response->set_data(std::move(data));
+    return ::grpc::Status::OK;
   }
 
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
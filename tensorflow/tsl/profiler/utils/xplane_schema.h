@@ -278,7 +278,13 @@ enum StatType {
   kSymbolId,
   kTfOpName,
   kDmaStallDurationPs,
-  kLastStatType = kDmaStallDurationPs
+  // Host tracing.
+  kDroppedTraceMeEvents,
+  // Hardware performance counters of host ops.
+  kCpuCycles,
+  kCpuInstructions,
+  kLlcMisses,
+  kLastStatType = kLlcMisses
 };
 
 inline std::string TpuPlaneName(int32_t device_ordinal) {